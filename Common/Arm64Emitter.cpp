@@ -3153,6 +3153,21 @@ void ARM64FloatEmitter::FMUL(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm)
 {
 	EmitThreeSame(1, size >> 6, 0x1B, Rd, Rn, Rm);
 }
+void ARM64FloatEmitter::ADD(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm)
+{
+	_assert_msg_(IsQuad(Rd) || size != 64, "%s cannot be used for scalar double", __FUNCTION__);
+	EmitThreeSame(0, EncodeSize(size), 0x10, Rd, Rn, Rm);
+}
+void ARM64FloatEmitter::SUB(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm)
+{
+	_assert_msg_(IsQuad(Rd) || size != 64, "%s cannot be used for scalar double", __FUNCTION__);
+	EmitThreeSame(1, EncodeSize(size), 0x10, Rd, Rn, Rm);
+}
+void ARM64FloatEmitter::MUL(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm)
+{
+	_assert_msg_(size != 64, "%s doesn't support 64-bit elements", __FUNCTION__);
+	EmitThreeSame(0, EncodeSize(size), 0x13, Rd, Rn, Rm);
+}
 void ARM64FloatEmitter::UMIN(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm)
 {
 	EmitThreeSame(1, EncodeSize(size), 0xD, Rd, Rn, Rm);
@@ -3231,6 +3246,14 @@ void ARM64FloatEmitter::SQXTN2(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn)
 {
 	Emit2RegMisc(true, 0, dest_size >> 4, 0x14, Rd, Rn);
 }
+void ARM64FloatEmitter::SQXTUN(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn)
+{
+	Emit2RegMisc(false, 1, dest_size >> 4, 0x12, Rd, Rn);
+}
+void ARM64FloatEmitter::SQXTUN2(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn)
+{
+	Emit2RegMisc(true, 1, dest_size >> 4, 0x12, Rd, Rn);
+}
 void ARM64FloatEmitter::UQXTN(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn)
 {
 	Emit2RegMisc(false, 1, dest_size >> 4, 0x14, Rd, Rn);
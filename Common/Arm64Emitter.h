@@ -879,6 +879,10 @@ class ARM64FloatEmitter
 		ORR(Rd, Rn, Rn);
 	}
 
+	void ADD(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm);
+	void SUB(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm);
+	void MUL(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm);
+
 	void UMIN(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm);
 	void UMAX(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm);
 	void SMIN(u8 size, ARM64Reg Rd, ARM64Reg Rn, ARM64Reg Rm);
@@ -893,6 +897,8 @@ class ARM64FloatEmitter
 	void UCVTF(u8 size, ARM64Reg Rd, ARM64Reg Rn, int scale);
 	void SQXTN(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn);
 	void SQXTN2(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn);
+	void SQXTUN(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn);
+	void SQXTUN2(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn);
 	void UQXTN(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn);
 	void UQXTN2(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn);
 	void XTN(u8 dest_size, ARM64Reg Rd, ARM64Reg Rn);
@@ -0,0 +1,219 @@
+#pragma once
+
+// A bump allocator for short-lived scratch memory, like VulkanPushPool but for the CPU.
+// Allocation is a pointer bump, and there's no free, memory is given back by rewinding.  Mark what's
+// used with a FrameArena::Scope around a draw or function, and everything allocated in it is released
+// when it goes out of scope.  EndFrame() takes care of stats, and trims memory after spikes.
+//
+// Not thread safe.  Each arena belongs to one thread, or to one thread at a time.
+// Destructors of arena allocated objects are not called, so stick to PODs, or use ArenaVector
+// (which by itself is fine, since the vector destroys its elements.)
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Common/Log.h"
+#include "Common/MemoryUtil.h"
+
+class FrameArena {
+public:
+	explicit FrameArena(size_t blockSize = 256 * 1024) : blockSize_(blockSize) {}
+	~FrameArena() {
+		for (Block &block : blocks_)
+			FreeAlignedMemory(block.data);
+	}
+
+	FrameArena(const FrameArena &) = delete;
+	FrameArena &operator =(const FrameArena &) = delete;
+
+	// Alignment must be a power of 2, up to BLOCK_ALIGNMENT.
+	void *Allocate(size_t size, size_t alignment = 16) {
+		_dbg_assert_(alignment <= BLOCK_ALIGNMENT);
+		allocsThisFrame_++;
+		bytesThisFrame_ += size;
+		if (curBlock_ < blocks_.size()) {
+			Block &block = blocks_[curBlock_];
+			size_t offset = (block.used + (alignment - 1)) & ~(alignment - 1);
+			if (offset + size <= block.size) {
+				block.used = offset + size;
+				return block.data + offset;
+			}
+		}
+		return AllocateSlow(size, alignment);
+	}
+
+	// Uninitialized, so only for trivial types.
+	template <class T>
+	T *AllocateArray(size_t count) {
+		return (T *)Allocate(sizeof(T) * count, alignof(T) > 16 ? alignof(T) : 16);
+	}
+
+	// Releases everything allocated after it was created, when it's destroyed.  Must nest.
+	class Scope {
+	public:
+		explicit Scope(FrameArena &arena) : arena_(arena), block_(arena.curBlock_), used_(arena.CurrentUsed()) {
+			arena_.scopeDepth_++;
+		}
+		~Scope() {
+			arena_.Rewind(block_, used_);
+			arena_.scopeDepth_--;
+		}
+
+		Scope(const Scope &) = delete;
+		Scope &operator =(const Scope &) = delete;
+
+	private:
+		FrameArena &arena_;
+		size_t block_;
+		size_t used_;
+	};
+
+	// Call once a frame, with no scopes active.
+	void EndFrame() {
+		_dbg_assert_msg_(scopeDepth_ == 0, "FrameArena: EndFrame inside a scope");
+		lastFrame_.allocs = allocsThisFrame_;
+		lastFrame_.bytes = bytesThisFrame_;
+		lastFrame_.blockAllocs = blockAllocsThisFrame_;
+		lastFrame_.peak = std::max(peakThisFrame_, TotalUsed());
+		allocsThisFrame_ = 0;
+		bytesThisFrame_ = 0;
+		blockAllocsThisFrame_ = 0;
+		peakThisFrame_ = 0;
+		if (scopeDepth_ != 0)
+			return;
+
+		// Everything's free now.  After a spike, shrink back to what's been needed lately.
+		Rewind(0, 0);
+		framesSinceLastGrowth_++;
+		if (framesSinceLastGrowth_ > TRIM_AFTER_FRAMES && blocks_.size() > 1) {
+			for (size_t i = 1; i < blocks_.size(); ++i)
+				FreeAlignedMemory(blocks_[i].data);
+			blocks_.resize(1);
+			framesSinceLastGrowth_ = 0;
+		}
+	}
+
+	struct Stats {
+		int allocs;
+		size_t bytes;
+		// Allocations of whole blocks from the heap.  Should be 0 most frames.
+		int blockAllocs;
+		size_t peak;
+	};
+	// For the last frame.
+	const Stats &LastFrameStats() const {
+		return lastFrame_;
+	}
+	size_t Capacity() const {
+		size_t total = 0;
+		for (const Block &block : blocks_)
+			total += block.size;
+		return total;
+	}
+
+	static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+private:
+	static constexpr int TRIM_AFTER_FRAMES = 600;
+
+	struct Block {
+		uint8_t *data;
+		size_t size;
+		size_t used;
+	};
+
+	size_t CurrentUsed() const {
+		return curBlock_ < blocks_.size() ? blocks_[curBlock_].used : 0;
+	}
+
+	size_t TotalUsed() const {
+		size_t total = 0;
+		for (size_t i = 0; i <= curBlock_ && i < blocks_.size(); ++i)
+			total += blocks_[i].used;
+		return total;
+	}
+
+	void Rewind(size_t block, size_t used) {
+		peakThisFrame_ = std::max(peakThisFrame_, TotalUsed());
+		for (size_t i = block + 1; i <= curBlock_ && i < blocks_.size(); ++i)
+			blocks_[i].used = 0;
+		curBlock_ = block;
+		if (block < blocks_.size())
+			blocks_[block].used = used;
+	}
+
+	void *AllocateSlow(size_t size, size_t alignment) {
+		// Move on to the next block that's big enough, there might be some left from a spike.
+		while (curBlock_ + 1 < blocks_.size()) {
+			curBlock_++;
+			Block &block = blocks_[curBlock_];
+			block.used = 0;
+			// Blocks start aligned, so anything fits at the start.
+			if (size <= block.size) {
+				block.used = size;
+				return block.data;
+			}
+		}
+
+		size_t newSize = blockSize_;
+		while (newSize < size)
+			newSize *= 2;
+		Block block{ (uint8_t *)AllocateAlignedMemory(newSize, BLOCK_ALIGNMENT), newSize, size };
+		_assert_msg_(block.data, "FrameArena: Out of memory allocating %d bytes", (int)newSize);
+		blocks_.push_back(block);
+		curBlock_ = blocks_.size() - 1;
+		blockAllocsThisFrame_++;
+		framesSinceLastGrowth_ = 0;
+		return block.data;
+	}
+
+	std::vector<Block> blocks_;
+	// Can be blocks_.size() before the first allocation.
+	size_t curBlock_ = 0;
+	size_t blockSize_;
+	int scopeDepth_ = 0;
+	int framesSinceLastGrowth_ = 0;
+
+	int allocsThisFrame_ = 0;
+	size_t bytesThisFrame_ = 0;
+	int blockAllocsThisFrame_ = 0;
+	size_t peakThisFrame_ = 0;
+	Stats lastFrame_{};
+};
+
+// Lets standard containers use a FrameArena.  Freeing does nothing, the memory stays until the
+// enclosing FrameArena::Scope ends, so reserve when the size is known up front.
+template <class T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	ArenaAllocator(FrameArena &arena) : arena_(&arena) {}
+	template <class U>
+	ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena_) {}
+
+	T *allocate(size_t n) {
+		return arena_->AllocateArray<T>(n);
+	}
+	void deallocate(T *, size_t) {}
+
+	template <class U>
+	bool operator ==(const ArenaAllocator<U> &other) const {
+		return arena_ == other.arena_;
+	}
+	template <class U>
+	bool operator !=(const ArenaAllocator<U> &other) const {
+		return arena_ != other.arena_;
+	}
+
+private:
+	template <class U>
+	friend class ArenaAllocator;
+
+	FrameArena *arena_;
+};
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
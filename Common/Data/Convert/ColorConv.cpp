@@ -16,6 +16,10 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Common.h"
@@ -174,26 +178,139 @@ void ConvertBGRA8888ToRGBA5551(u16 *dst, const u32 *src, u32 numPixels) {
 	}
 }
 
+// These do the same as the scalar functions in ColorConv.h, on four 32-bit lanes at once.
+// The result ends up in the low 16 bits of each lane, with the top half zero.
+#if PPSSPP_ARCH(SSE2)
+static inline __m128i RGBA8888ToRGB565Lanes(__m128i c) {
+	const __m128i r = _mm_and_si128(_mm_srli_epi32(c, 3), _mm_set1_epi32(0x001F));
+	const __m128i g = _mm_and_si128(_mm_srli_epi32(c, 5), _mm_set1_epi32(0x07E0));
+	const __m128i b = _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0xF800));
+	return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+static inline __m128i RGBA8888ToRGBA4444Lanes(__m128i c) {
+	const __m128i r = _mm_and_si128(_mm_srli_epi32(c, 4), _mm_set1_epi32(0x000F));
+	const __m128i g = _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0x00F0));
+	const __m128i b = _mm_and_si128(_mm_srli_epi32(c, 12), _mm_set1_epi32(0x0F00));
+	const __m128i a = _mm_and_si128(_mm_srli_epi32(c, 16), _mm_set1_epi32(0xF000));
+	return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+static inline __m128i BGRA8888ToRGB565Lanes(__m128i c) {
+	const __m128i r = _mm_and_si128(_mm_srli_epi32(c, 19), _mm_set1_epi32(0x001F));
+	const __m128i g = _mm_and_si128(_mm_srli_epi32(c, 5), _mm_set1_epi32(0x07E0));
+	const __m128i b = _mm_and_si128(_mm_slli_epi32(c, 8), _mm_set1_epi32(0xF800));
+	return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+static inline __m128i BGRA8888ToRGBA4444Lanes(__m128i c) {
+	const __m128i r = _mm_and_si128(_mm_srli_epi32(c, 20), _mm_set1_epi32(0x000F));
+	const __m128i g = _mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0x00F0));
+	const __m128i b = _mm_and_si128(_mm_slli_epi32(c, 4), _mm_set1_epi32(0x0F00));
+	const __m128i a = _mm_and_si128(_mm_srli_epi32(c, 16), _mm_set1_epi32(0xF000));
+	return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+// Returns the number of pixels converted, the caller does the remainder.
+template <__m128i (*Lanes)(__m128i)>
+static inline u32 Convert8888To16Lanes(u16 *dst, const u32 *src, u32 numPixels) {
+	if (((intptr_t)src & 0xF) || ((intptr_t)dst & 0xF)) {
+		return 0;
+	}
+	const __m128i *srcp = (const __m128i *)src;
+	__m128i *dstp = (__m128i *)dst;
+	const u32 sseChunks = numPixels / 8;
+	for (u32 i = 0; i < sseChunks; ++i) {
+		const __m128i c0 = Lanes(_mm_load_si128(&srcp[i * 2 + 0]));
+		const __m128i c1 = Lanes(_mm_load_si128(&srcp[i * 2 + 1]));
+		_mm_store_si128(&dstp[i], _mm_packu2_epi32_SSE2(c0, c1));
+	}
+	return sseChunks * 8;
+}
+#elif PPSSPP_ARCH(ARM_NEON)
+static inline uint32x4_t RGBA8888ToRGB565Lanes(uint32x4_t c) {
+	const uint32x4_t r = vandq_u32(vshrq_n_u32(c, 3), vdupq_n_u32(0x001F));
+	const uint32x4_t g = vandq_u32(vshrq_n_u32(c, 5), vdupq_n_u32(0x07E0));
+	const uint32x4_t b = vandq_u32(vshrq_n_u32(c, 8), vdupq_n_u32(0xF800));
+	return vorrq_u32(vorrq_u32(r, g), b);
+}
+
+static inline uint32x4_t RGBA8888ToRGBA4444Lanes(uint32x4_t c) {
+	const uint32x4_t r = vandq_u32(vshrq_n_u32(c, 4), vdupq_n_u32(0x000F));
+	const uint32x4_t g = vandq_u32(vshrq_n_u32(c, 8), vdupq_n_u32(0x00F0));
+	const uint32x4_t b = vandq_u32(vshrq_n_u32(c, 12), vdupq_n_u32(0x0F00));
+	const uint32x4_t a = vandq_u32(vshrq_n_u32(c, 16), vdupq_n_u32(0xF000));
+	return vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, a));
+}
+
+static inline uint32x4_t BGRA8888ToRGB565Lanes(uint32x4_t c) {
+	const uint32x4_t r = vandq_u32(vshrq_n_u32(c, 19), vdupq_n_u32(0x001F));
+	const uint32x4_t g = vandq_u32(vshrq_n_u32(c, 5), vdupq_n_u32(0x07E0));
+	const uint32x4_t b = vandq_u32(vshlq_n_u32(c, 8), vdupq_n_u32(0xF800));
+	return vorrq_u32(vorrq_u32(r, g), b);
+}
+
+static inline uint32x4_t BGRA8888ToRGBA4444Lanes(uint32x4_t c) {
+	const uint32x4_t r = vandq_u32(vshrq_n_u32(c, 20), vdupq_n_u32(0x000F));
+	const uint32x4_t g = vandq_u32(vshrq_n_u32(c, 8), vdupq_n_u32(0x00F0));
+	const uint32x4_t b = vandq_u32(vshlq_n_u32(c, 4), vdupq_n_u32(0x0F00));
+	const uint32x4_t a = vandq_u32(vshrq_n_u32(c, 16), vdupq_n_u32(0xF000));
+	return vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, a));
+}
+
+// Returns the number of pixels converted, the caller does the remainder.
+template <uint32x4_t (*Lanes)(uint32x4_t)>
+static inline u32 Convert8888To16Lanes(u16 *dst, const u32 *src, u32 numPixels) {
+	const u32 simdable = numPixels & ~7;
+	for (u32 i = 0; i < simdable; i += 8) {
+		const uint16x4_t lo = vmovn_u32(Lanes(vld1q_u32(src + i)));
+		const uint16x4_t hi = vmovn_u32(Lanes(vld1q_u32(src + i + 4)));
+		vst1q_u16(dst + i, vcombine_u16(lo, hi));
+	}
+	return simdable;
+}
+#endif
+
 void ConvertBGRA8888ToRGB565(u16 *dst, const u32 *src, u32 numPixels) {
-	for (u32 i = 0; i < numPixels; i++) {
+#if PPSSPP_ARCH(SSE2) || PPSSPP_ARCH(ARM_NEON)
+	u32 i = Convert8888To16Lanes<&BGRA8888ToRGB565Lanes>(dst, src, numPixels);
+#else
+	u32 i = 0;
+#endif
+	for (; i < numPixels; i++) {
 		dst[i] = BGRA8888toRGB565(src[i]);
 	}
 }
 
 void ConvertBGRA8888ToRGBA4444(u16 *dst, const u32 *src, u32 numPixels) {
-	for (u32 i = 0; i < numPixels; i++) {
+#if PPSSPP_ARCH(SSE2) || PPSSPP_ARCH(ARM_NEON)
+	u32 i = Convert8888To16Lanes<&BGRA8888ToRGBA4444Lanes>(dst, src, numPixels);
+#else
+	u32 i = 0;
+#endif
+	for (; i < numPixels; i++) {
 		dst[i] = BGRA8888toRGBA4444(src[i]);
 	}
 }
 
 void ConvertRGBA8888ToRGB565(u16 *dst, const u32 *src, u32 numPixels) {
-	for (u32 x = 0; x < numPixels; ++x) {
+#if PPSSPP_ARCH(SSE2) || PPSSPP_ARCH(ARM_NEON)
+	u32 x = Convert8888To16Lanes<&RGBA8888ToRGB565Lanes>(dst, src, numPixels);
+#else
+	u32 x = 0;
+#endif
+	for (; x < numPixels; ++x) {
 		dst[x] = RGBA8888toRGB565(src[x]);
 	}
 }
 
 void ConvertRGBA8888ToRGBA4444(u16 *dst, const u32 *src, u32 numPixels) {
-	for (u32 x = 0; x < numPixels; ++x) {
+#if PPSSPP_ARCH(SSE2) || PPSSPP_ARCH(ARM_NEON)
+	u32 x = Convert8888To16Lanes<&RGBA8888ToRGBA4444Lanes>(dst, src, numPixels);
+#else
+	u32 x = 0;
+#endif
+	for (; x < numPixels; ++x) {
 		dst[x] = RGBA8888toRGBA4444(src[x]);
 	}
 }
@@ -244,6 +361,26 @@ void ConvertRGB565ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 		_mm_store_si128(&dstp[i * 2 + 1], _mm_unpackhi_epi16(rg, ba));
 	}
 	u32 i = sseChunks * 8;
+#elif PPSSPP_ARCH(ARM_NEON)
+	const uint16x8_t mask5 = vdupq_n_u16(0x001f);
+	const uint16x8_t mask6 = vdupq_n_u16(0x003f);
+
+	u32 i = 0;
+	const u32 simdable = numPixels & ~7;
+	for (; i < simdable; i += 8) {
+		const uint16x8_t c = vld1q_u16(src + i);
+		const uint16x8_t r = vandq_u16(c, mask5);
+		const uint16x8_t g = vandq_u16(vshrq_n_u16(c, 5), mask6);
+		const uint16x8_t b = vshrq_n_u16(c, 11);
+
+		// Narrowing drops the bits the shift left pushes out of the byte.
+		uint8x8x4_t px;
+		px.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+		px.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4)));
+		px.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+		px.val[3] = vdup_n_u8(0xFF);
+		vst4_u8((u8 *)(dst32 + i), px);
+	}
 #else
 	u32 i = 0;
 #endif
@@ -298,6 +435,26 @@ void ConvertRGBA5551ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 		_mm_store_si128(&dstp[i * 2 + 1], _mm_unpackhi_epi16(rg, ba));
 	}
 	u32 i = sseChunks * 8;
+#elif PPSSPP_ARCH(ARM_NEON)
+	const uint16x8_t mask5 = vdupq_n_u16(0x001f);
+
+	u32 i = 0;
+	const u32 simdable = numPixels & ~7;
+	for (; i < simdable; i += 8) {
+		const uint16x8_t c = vld1q_u16(src + i);
+		const uint16x8_t r = vandq_u16(c, mask5);
+		const uint16x8_t g = vandq_u16(vshrq_n_u16(c, 5), mask5);
+		const uint16x8_t b = vandq_u16(vshrq_n_u16(c, 10), mask5);
+		// Arithmetic shift to spread the alpha bit.
+		const uint16x8_t a = vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(c), 15));
+
+		uint8x8x4_t px;
+		px.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+		px.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(g, 2)));
+		px.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+		px.val[3] = vmovn_u16(a);
+		vst4_u8((u8 *)(dst32 + i), px);
+	}
 #else
 	u32 i = 0;
 #endif
@@ -347,6 +504,25 @@ void ConvertRGBA4444ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 		_mm_store_si128(&dstp[i * 2 + 1], _mm_unpackhi_epi16(rg, ba));
 	}
 	u32 i = sseChunks * 8;
+#elif PPSSPP_ARCH(ARM_NEON)
+	const uint16x8_t mask4 = vdupq_n_u16(0x000f);
+
+	u32 i = 0;
+	const u32 simdable = numPixels & ~7;
+	for (; i < simdable; i += 8) {
+		const uint16x8_t c = vld1q_u16(src + i);
+		const uint16x8_t r = vandq_u16(c, mask4);
+		const uint16x8_t g = vandq_u16(vshrq_n_u16(c, 4), mask4);
+		const uint16x8_t b = vandq_u16(vshrq_n_u16(c, 8), mask4);
+		const uint16x8_t a = vshrq_n_u16(c, 12);
+
+		uint8x8x4_t px;
+		px.val[0] = vmovn_u16(vorrq_u16(r, vshlq_n_u16(r, 4)));
+		px.val[1] = vmovn_u16(vorrq_u16(g, vshlq_n_u16(g, 4)));
+		px.val[2] = vmovn_u16(vorrq_u16(b, vshlq_n_u16(b, 4)));
+		px.val[3] = vmovn_u16(vorrq_u16(a, vshlq_n_u16(a, 4)));
+		vst4_u8((u8 *)(dst32 + i), px);
+	}
 #else
 	u32 i = 0;
 #endif
@@ -642,3 +818,177 @@ void ConvertBGRA5551ToABGR1555(u16 *dst, const u16 *src, u32 numPixels) {
 		dst[i] = (c >> 15) | (c << 1);
 	}
 }
+
+// The coefficients are 2.14, applied to values shifted up by 7 taking the high half of the
+// product.  That leaves 5 fractional bits, done the same way in every path so they all match.
+enum {
+	YUV_Y = 19077,  // 255 / 219
+	YUV_RV = 26149,  // 1.596
+	YUV_GU = -6419,  // -0.392
+	YUV_GV = -13320,  // -0.813
+	YUV_BU_FRAC = 282,  // 2.017, minus the 2 which is a shift.
+};
+
+enum class YUVOutput {
+	RGBA8888,
+	RGB565,
+	RGBA5551,
+	RGBA4444,
+};
+
+static inline int YUVMulHi(int a, int b) {
+	return (a * b) >> 16;
+}
+
+template <YUVOutput fmt>
+static inline void WriteYUVPixel(void *dst, u32 i, int r, int g, int b) {
+	switch (fmt) {
+	case YUVOutput::RGBA8888:
+		((u32 *)dst)[i] = r | (g << 8) | (b << 16);
+		break;
+	case YUVOutput::RGB565:
+		((u16 *)dst)[i] = (r >> 3) | ((g >> 2) << 5) | ((b >> 3) << 11);
+		break;
+	case YUVOutput::RGBA5551:
+		((u16 *)dst)[i] = (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10);
+		break;
+	case YUVOutput::RGBA4444:
+		((u16 *)dst)[i] = (r >> 4) | ((g >> 4) << 4) | ((b >> 4) << 8);
+		break;
+	}
+}
+
+#if PPSSPP_ARCH(SSE2)
+// Takes eight pixels, each channel in 16-bit lanes, already clamped to 0-255.
+template <YUVOutput fmt>
+static inline void WriteYUVPixels(void *dst, u32 i, __m128i r, __m128i g, __m128i b) {
+	switch (fmt) {
+	case YUVOutput::RGBA8888:
+	{
+		const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+		_mm_storeu_si128((__m128i *)((u32 *)dst + i), _mm_unpacklo_epi16(rg, b));
+		_mm_storeu_si128((__m128i *)((u32 *)dst + i + 4), _mm_unpackhi_epi16(rg, b));
+		break;
+	}
+	case YUVOutput::RGB565:
+		_mm_storeu_si128((__m128i *)((u16 *)dst + i), _mm_or_si128(_mm_or_si128(_mm_srli_epi16(r, 3), _mm_slli_epi16(_mm_srli_epi16(g, 2), 5)), _mm_slli_epi16(_mm_srli_epi16(b, 3), 11)));
+		break;
+	case YUVOutput::RGBA5551:
+		_mm_storeu_si128((__m128i *)((u16 *)dst + i), _mm_or_si128(_mm_or_si128(_mm_srli_epi16(r, 3), _mm_slli_epi16(_mm_srli_epi16(g, 3), 5)), _mm_slli_epi16(_mm_srli_epi16(b, 3), 10)));
+		break;
+	case YUVOutput::RGBA4444:
+		_mm_storeu_si128((__m128i *)((u16 *)dst + i), _mm_or_si128(_mm_or_si128(_mm_srli_epi16(r, 4), _mm_slli_epi16(_mm_srli_epi16(g, 4), 4)), _mm_slli_epi16(_mm_srli_epi16(b, 4), 8)));
+		break;
+	}
+}
+#elif PPSSPP_ARCH(ARM_NEON)
+template <YUVOutput fmt>
+static inline void WriteYUVPixels(void *dst, u32 i, uint16x8_t r, uint16x8_t g, uint16x8_t b) {
+	switch (fmt) {
+	case YUVOutput::RGBA8888:
+	{
+		const uint16x8_t rg = vorrq_u16(r, vshlq_n_u16(g, 8));
+		const uint16x8x2_t pixels = vzipq_u16(rg, b);
+		vst1q_u16((u16 *)((u32 *)dst + i), pixels.val[0]);
+		vst1q_u16((u16 *)((u32 *)dst + i + 4), pixels.val[1]);
+		break;
+	}
+	case YUVOutput::RGB565:
+		vst1q_u16((u16 *)dst + i, vorrq_u16(vorrq_u16(vshrq_n_u16(r, 3), vshlq_n_u16(vshrq_n_u16(g, 2), 5)), vshlq_n_u16(vshrq_n_u16(b, 3), 11)));
+		break;
+	case YUVOutput::RGBA5551:
+		vst1q_u16((u16 *)dst + i, vorrq_u16(vorrq_u16(vshrq_n_u16(r, 3), vshlq_n_u16(vshrq_n_u16(g, 3), 5)), vshlq_n_u16(vshrq_n_u16(b, 3), 10)));
+		break;
+	case YUVOutput::RGBA4444:
+		vst1q_u16((u16 *)dst + i, vorrq_u16(vorrq_u16(vshrq_n_u16(r, 4), vshlq_n_u16(vshrq_n_u16(g, 4), 4)), vshlq_n_u16(vshrq_n_u16(b, 4), 8)));
+		break;
+	}
+}
+
+static inline int16x8_t YUVMulHi(int16x8_t a, int16x4_t b) {
+	return vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(a), b), 16), vshrn_n_s32(vmull_s16(vget_high_s16(a), b), 16));
+}
+#endif
+
+template <YUVOutput fmt>
+static void ConvertYUV420Row(void *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	u32 i = 0;
+#if PPSSPP_ARCH(SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i round = _mm_set1_epi16(16);
+	for (; i + 8 <= numPixels; i += 8) {
+		u32 u4, v4;
+		memcpy(&u4, u + i / 2, 4);
+		memcpy(&v4, v + i / 2, 4);
+		__m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(y + i)), zero);
+		__m128i uu = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero);
+		__m128i vv = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero);
+		// Each chroma sample covers two pixels.
+		uu = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi16(uu, uu), _mm_set1_epi16(128)), 7);
+		vv = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi16(vv, vv), _mm_set1_epi16(128)), 7);
+		yy = _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(yy, _mm_set1_epi16(16)), 7), _mm_set1_epi16(YUV_Y));
+		yy = _mm_add_epi16(yy, round);
+
+		__m128i r = _mm_add_epi16(yy, _mm_mulhi_epi16(vv, _mm_set1_epi16(YUV_RV)));
+		__m128i g = _mm_add_epi16(yy, _mm_add_epi16(_mm_mulhi_epi16(uu, _mm_set1_epi16(YUV_GU)), _mm_mulhi_epi16(vv, _mm_set1_epi16(YUV_GV))));
+		__m128i b = _mm_add_epi16(yy, _mm_add_epi16(_mm_srai_epi16(uu, 1), _mm_mulhi_epi16(uu, _mm_set1_epi16(YUV_BU_FRAC))));
+		r = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(r, 5), zero), max);
+		g = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(g, 5), zero), max);
+		b = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(b, 5), zero), max);
+		WriteYUVPixels<fmt>(dst, i, r, g, b);
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int16x8_t zero = vdupq_n_s16(0);
+	const int16x8_t max = vdupq_n_s16(255);
+	for (; i + 8 <= numPixels; i += 8) {
+		u32 u4, v4;
+		memcpy(&u4, u + i / 2, 4);
+		memcpy(&v4, v + i / 2, 4);
+		const uint8x8_t u8x4 = vreinterpret_u8_u32(vdup_n_u32(u4));
+		const uint8x8_t v8x4 = vreinterpret_u8_u32(vdup_n_u32(v4));
+		int16x8_t yy = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i)));
+		// Each chroma sample covers two pixels.
+		int16x8_t uu = vreinterpretq_s16_u16(vmovl_u8(vzip_u8(u8x4, u8x4).val[0]));
+		int16x8_t vv = vreinterpretq_s16_u16(vmovl_u8(vzip_u8(v8x4, v8x4).val[0]));
+		uu = vshlq_n_s16(vsubq_s16(uu, vdupq_n_s16(128)), 7);
+		vv = vshlq_n_s16(vsubq_s16(vv, vdupq_n_s16(128)), 7);
+		yy = YUVMulHi(vshlq_n_s16(vsubq_s16(yy, vdupq_n_s16(16)), 7), vdup_n_s16(YUV_Y));
+		yy = vaddq_s16(yy, vdupq_n_s16(16));
+
+		int16x8_t r = vaddq_s16(yy, YUVMulHi(vv, vdup_n_s16(YUV_RV)));
+		int16x8_t g = vaddq_s16(yy, vaddq_s16(YUVMulHi(uu, vdup_n_s16(YUV_GU)), YUVMulHi(vv, vdup_n_s16(YUV_GV))));
+		int16x8_t b = vaddq_s16(yy, vaddq_s16(vshrq_n_s16(uu, 1), YUVMulHi(uu, vdup_n_s16(YUV_BU_FRAC))));
+		r = vminq_s16(vmaxq_s16(vshrq_n_s16(r, 5), zero), max);
+		g = vminq_s16(vmaxq_s16(vshrq_n_s16(g, 5), zero), max);
+		b = vminq_s16(vmaxq_s16(vshrq_n_s16(b, 5), zero), max);
+		WriteYUVPixels<fmt>(dst, i, vreinterpretq_u16_s16(r), vreinterpretq_u16_s16(g), vreinterpretq_u16_s16(b));
+	}
+#endif
+
+	for (; i < numPixels; i++) {
+		const int yy = YUVMulHi((y[i] - 16) << 7, YUV_Y) + 16;
+		const int uu = (u[i / 2] - 128) << 7;
+		const int vv = (v[i / 2] - 128) << 7;
+		const int r = yy + YUVMulHi(vv, YUV_RV);
+		const int g = yy + YUVMulHi(uu, YUV_GU) + YUVMulHi(vv, YUV_GV);
+		const int b = yy + (uu >> 1) + YUVMulHi(uu, YUV_BU_FRAC);
+		WriteYUVPixel<fmt>(dst, i, std::clamp(r >> 5, 0, 255), std::clamp(g >> 5, 0, 255), std::clamp(b >> 5, 0, 255));
+	}
+}
+
+void ConvertYUV420ToRGBA8888(u32 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Row<YUVOutput::RGBA8888>(dst, y, u, v, numPixels);
+}
+
+void ConvertYUV420ToRGB565(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Row<YUVOutput::RGB565>(dst, y, u, v, numPixels);
+}
+
+void ConvertYUV420ToRGBA5551(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Row<YUVOutput::RGBA5551>(dst, y, u, v, numPixels);
+}
+
+void ConvertYUV420ToRGBA4444(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Row<YUVOutput::RGBA4444>(dst, y, u, v, numPixels);
+}
@@ -166,3 +166,10 @@ void ConvertRGBA4444ToABGR4444(u16 *dst, const u16 *src, u32 numPixels);
 void ConvertRGBA5551ToABGR1555(u16 *dst, const u16 *src, u32 numPixels);
 void ConvertRGB565ToBGR565(u16 *dst, const u16 *src, u32 numPixels);
 void ConvertBGRA5551ToABGR1555(u16 *dst, const u16 *src, u32 numPixels);
+
+// One row of limited range BT.601 YUV 4:2:0, as in MPEG video.  u and v are at half width, so
+// the same rows are used for two rows of y.  Alpha is left zero, the same as the PSP outputs it.
+void ConvertYUV420ToRGBA8888(u32 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+void ConvertYUV420ToRGB565(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+void ConvertYUV420ToRGBA5551(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+void ConvertYUV420ToRGBA4444(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Common/Data/Format/DDSSave.h"
+
+// Legacy DDS header flags, see DDS_HEADER on MSDN.
+enum {
+	DDSD_CAPS = 0x1,
+	DDSD_HEIGHT = 0x2,
+	DDSD_WIDTH = 0x4,
+	DDSD_PIXELFORMAT = 0x1000,
+	DDSD_MIPMAPCOUNT = 0x20000,
+	DDSD_LINEARSIZE = 0x80000,
+};
+
+static void FetchBlock(const uint8_t *rgba, int w, int h, int pitch, int bx, int by, uint8_t block[16][4]) {
+	for (int y = 0; y < 4; y++) {
+		int sy = std::min(by * 4 + y, h - 1);
+		for (int x = 0; x < 4; x++) {
+			int sx = std::min(bx * 4 + x, w - 1);
+			memcpy(block[y * 4 + x], rgba + sy * pitch + sx * 4, 4);
+		}
+	}
+}
+
+static inline uint16_t To565(const int c[3]) {
+	int r = (c[0] * 31 + 127) / 255;
+	int g = (c[1] * 63 + 127) / 255;
+	int b = (c[2] * 31 + 127) / 255;
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static inline void From565(uint16_t c, int out[3]) {
+	int r = (c >> 11) & 31;
+	int g = (c >> 5) & 63;
+	int b = c & 31;
+	out[0] = (r << 3) | (r >> 2);
+	out[1] = (g << 2) | (g >> 4);
+	out[2] = (b << 3) | (b >> 2);
+}
+
+static inline void Write16(uint8_t *p, uint16_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+// Picks endpoints along the principal axis of the block's colors, then the nearest palette entry per pixel.
+static void EncodeColorBlock(const uint8_t block[16][4], uint8_t *out) {
+	float mean[3]{};
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 3; c++)
+			mean[c] += block[i][c];
+	}
+	for (int c = 0; c < 3; c++)
+		mean[c] *= 1.0f / 16.0f;
+
+	float cov[6]{};
+	for (int i = 0; i < 16; i++) {
+		float r = block[i][0] - mean[0];
+		float g = block[i][1] - mean[1];
+		float b = block[i][2] - mean[2];
+		cov[0] += r * r;
+		cov[1] += r * g;
+		cov[2] += r * b;
+		cov[3] += g * g;
+		cov[4] += g * b;
+		cov[5] += b * b;
+	}
+
+	// A few rounds of power iteration are plenty for a 3x3 matrix.
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iter = 0; iter < 4; iter++) {
+		float x = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+		float y = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+		float z = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+		float m = std::max(std::max(fabsf(x), fabsf(y)), fabsf(z));
+		if (m == 0.0f)
+			break;
+		axis[0] = x / m;
+		axis[1] = y / m;
+		axis[2] = z / m;
+	}
+
+	float minDot = 1e30f, maxDot = -1e30f;
+	int minIndex = 0, maxIndex = 0;
+	for (int i = 0; i < 16; i++) {
+		float d = block[i][0] * axis[0] + block[i][1] * axis[1] + block[i][2] * axis[2];
+		if (d < minDot) {
+			minDot = d;
+			minIndex = i;
+		}
+		if (d > maxDot) {
+			maxDot = d;
+			maxIndex = i;
+		}
+	}
+
+	int maxColor[3] = { block[maxIndex][0], block[maxIndex][1], block[maxIndex][2] };
+	int minColor[3] = { block[minIndex][0], block[minIndex][1], block[minIndex][2] };
+	uint16_t c0 = To565(maxColor);
+	uint16_t c1 = To565(minColor);
+	// Four-color mode requires c0 > c1.
+	if (c0 < c1)
+		std::swap(c0, c1);
+
+	uint32_t indices = 0;
+	if (c0 != c1) {
+		int palette[4][3];
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (int i = 0; i < 16; i++) {
+			int best = 0;
+			int bestDist = 0x7FFFFFFF;
+			for (int p = 0; p < 4; p++) {
+				int dr = block[i][0] - palette[p][0];
+				int dg = block[i][1] - palette[p][1];
+				int db = block[i][2] - palette[p][2];
+				int dist = dr * dr + dg * dg + db * db;
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = p;
+				}
+			}
+			indices |= (uint32_t)best << (i * 2);
+		}
+	}
+
+	Write16(out, c0);
+	Write16(out + 2, c1);
+	memcpy(out + 4, &indices, 4);
+}
+
+// Eight-alpha mode between the block's min and max alpha.
+static void EncodeAlphaBlock(const uint8_t block[16][4], uint8_t *out) {
+	int a0 = 0, a1 = 255;
+	for (int i = 0; i < 16; i++) {
+		a0 = std::max(a0, (int)block[i][3]);
+		a1 = std::min(a1, (int)block[i][3]);
+	}
+
+	uint64_t indices = 0;
+	if (a0 != a1) {
+		int palette[8];
+		palette[0] = a0;
+		palette[1] = a1;
+		for (int p = 2; p < 8; p++)
+			palette[p] = ((8 - p) * a0 + (p - 1) * a1) / 7;
+		for (int i = 0; i < 16; i++) {
+			int best = 0;
+			int bestDist = 256;
+			for (int p = 0; p < 8; p++) {
+				int dist = abs(block[i][3] - palette[p]);
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = p;
+				}
+			}
+			indices |= (uint64_t)best << (i * 3);
+		}
+	}
+
+	out[0] = (uint8_t)a0;
+	out[1] = (uint8_t)a1;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (uint8_t)(indices >> (i * 8));
+}
+
+void EncodeBC1(const uint8_t *rgba, int w, int h, int pitch, uint8_t *out) {
+	uint8_t block[16][4];
+	for (int by = 0; by < (h + 3) / 4; by++) {
+		for (int bx = 0; bx < (w + 3) / 4; bx++) {
+			FetchBlock(rgba, w, h, pitch, bx, by, block);
+			EncodeColorBlock(block, out);
+			out += 8;
+		}
+	}
+}
+
+void EncodeBC3(const uint8_t *rgba, int w, int h, int pitch, uint8_t *out) {
+	uint8_t block[16][4];
+	for (int by = 0; by < (h + 3) / 4; by++) {
+		for (int bx = 0; bx < (w + 3) / 4; bx++) {
+			FetchBlock(rgba, w, h, pitch, bx, by, block);
+			EncodeAlphaBlock(block, out);
+			EncodeColorBlock(block, out + 8);
+			out += 16;
+		}
+	}
+}
+
+bool SaveDDS(FILE *f, uint32_t width, uint32_t height, uint32_t fourCC, const std::vector<std::vector<uint8_t>> &levels, const uint32_t *userData, int userDataCount) {
+	if (levels.empty())
+		return false;
+
+	DDSHeader header{};
+	memcpy(&header.dwMagic, "DDS ", 4);
+	header.dwSize = 124;
+	header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+	header.dwHeight = height;
+	header.dwWidth = width;
+	header.dwPitchOrLinearSize = (uint32_t)levels[0].size();
+	header.dwDepth = 1;
+	header.dwMipMapCount = (uint32_t)levels.size();
+	for (int i = 0; i < std::min(userDataCount, 11); i++)
+		header.dwReserved1[i] = userData[i];
+	header.ddspf.dwSize = 32;
+	header.ddspf.dwFlags = DDPF_FOURCC;
+	header.ddspf.dwFourCC = fourCC;
+	header.dwCaps = DDSCAPS_TEXTURE;
+	if (levels.size() > 1) {
+		header.dwFlags |= DDSD_MIPMAPCOUNT;
+		header.dwCaps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	}
+
+	if (fwrite(&header, sizeof(header), 1, f) != 1)
+		return false;
+	for (const auto &level : levels) {
+		if (fwrite(level.data(), 1, level.size(), f) != level.size())
+			return false;
+	}
+	return true;
+}
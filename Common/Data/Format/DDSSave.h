@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+// For the header structs.
+#include "Common/Data/Format/DDSLoad.h"
+
+// Block compression of RGBA8888 images, good enough to cache texture replacements in.
+// The block grid covers (w + 3) / 4 by (h + 3) / 4 blocks, partial blocks at the edges repeat the last row/column.
+// BC1 is written in four-color mode only, so it should only be used for opaque images.
+void EncodeBC1(const uint8_t *rgba, int w, int h, int pitch, uint8_t *out);
+void EncodeBC3(const uint8_t *rgba, int w, int h, int pitch, uint8_t *out);
+
+inline size_t BCEncodedSize(int w, int h, int blockSize) {
+	return (size_t)((w + 3) / 4) * ((h + 3) / 4) * blockSize;
+}
+
+// Writes a DDS file with a legacy fourCC (such as DXT1 or DXT5) and the given mip levels, largest first.
+// Up to 11 words of userData are stored in the reserved header fields, which readers ignore.
+bool SaveDDS(FILE *f, uint32_t width, uint32_t height, uint32_t fourCC, const std::vector<std::vector<uint8_t>> &levels, const uint32_t *userData, int userDataCount);
@@ -15,6 +15,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -187,6 +188,36 @@ void ParsedIniLine::Reconstruct(std::string *output) const {
 
 void Section::Clear() {
 	lines_.clear();
+	InvalidateKeyIndex();
+}
+
+static int CompareKeysNoCase(std::string_view a, std::string_view b) {
+	int c = strncasecmp(a.data(), b.data(), std::min(a.size(), b.size()));
+	if (c != 0)
+		return c;
+	return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+int Section::FindLine(std::string_view key) const {
+	if (!keyIndexValid_) {
+		keyIndex_.clear();
+		for (size_t i = 0; i < lines_.size(); i++) {
+			if (!lines_[i].Key().empty())
+				keyIndex_.push_back((uint32_t)i);
+		}
+		// Stable, so that with duplicate keys the first one still wins like before.
+		std::stable_sort(keyIndex_.begin(), keyIndex_.end(), [&](uint32_t a, uint32_t b) {
+			return CompareKeysNoCase(lines_[a].Key(), lines_[b].Key()) < 0;
+		});
+		keyIndexValid_ = true;
+	}
+
+	auto it = std::lower_bound(keyIndex_.begin(), keyIndex_.end(), key, [&](uint32_t index, std::string_view k) {
+		return CompareKeysNoCase(lines_[index].Key(), k) < 0;
+	});
+	if (it != keyIndex_.end() && CompareKeysNoCase(lines_[*it].Key(), key) == 0)
+		return (int)*it;
+	return -1;
 }
 
 bool Section::GetKeys(std::vector<std::string> &keys) const {
@@ -199,19 +230,13 @@ bool Section::GetKeys(std::vector<std::string> &keys) const {
 }
 
 ParsedIniLine *Section::GetLine(std::string_view key) {
-	for (auto &line : lines_) {
-		if (equalsNoCase(line.Key(), key))
-			return &line;
-	}
-	return nullptr;
+	int index = FindLine(key);
+	return index >= 0 ? &lines_[index] : nullptr;
 }
 
 const ParsedIniLine *Section::GetLine(std::string_view key) const {
-	for (auto &line : lines_) {
-		if (equalsNoCase(line.Key(), key))
-			return &line;
-	}
-	return nullptr;
+	int index = FindLine(key);
+	return index >= 0 ? &lines_[index] : nullptr;
 }
 
 void Section::Set(std::string_view key, uint32_t newValue) {
@@ -252,6 +277,14 @@ void Section::Set(std::string_view key, const char* newValue) {
 	} else {
 		// The key did not already exist in this section - let's add it.
 		lines_.emplace_back(ParsedIniLine(key, newValue));
+		if (keyIndexValid_ && !key.empty()) {
+			// Keep the index valid, saving a config adds every key this way.
+			uint32_t index = (uint32_t)(lines_.size() - 1);
+			auto it = std::lower_bound(keyIndex_.begin(), keyIndex_.end(), key, [&](uint32_t i, std::string_view k) {
+				return CompareKeysNoCase(lines_[i].Key(), k) < 0;
+			});
+			keyIndex_.insert(it, index);
+		}
 	}
 }
 
@@ -397,11 +430,7 @@ bool Section::Get(std::string_view key, double* value, double defaultValue) cons
 }
 
 bool Section::Exists(std::string_view key) const {
-	for (auto &line : lines_) {
-		if (equalsNoCase(key, line.Key()))
-			return true;
-	}
-	return false;
+	return FindLine(key) >= 0;
 }
 
 std::map<std::string, std::string> Section::ToMap() const {
@@ -419,6 +448,7 @@ bool Section::Delete(std::string_view key) {
 	for (auto liter = lines_.begin(); liter != lines_.end(); ++liter) {
 		if (line == &*liter) {
 			lines_.erase(liter);
+			InvalidateKeyIndex();
 			return true;
 		}
 	}
@@ -479,6 +509,7 @@ bool IniFile::DeleteKey(const char* sectionName, const char* key) {
 	for (auto liter = section->lines_.begin(); liter != section->lines_.end(); ++liter) {
 		if (line == &(*liter)) {
 			section->lines_.erase(liter);
+			section->InvalidateKeyIndex();
 			return true;
 		}
 	}
@@ -509,9 +540,7 @@ bool IniFile::Load(const Path &path)
 	if (!File::ReadTextFileToString(path, &data)) {
 		return false;
 	}
-	std::stringstream sstream(data);
-	bool success = Load(sstream);
-	return success;
+	return LoadFromString(data);
 }
 
 bool IniFile::LoadFromVFS(VFSInterface &vfs, const std::string &filename) {
@@ -519,22 +548,31 @@ bool IniFile::LoadFromVFS(VFSInterface &vfs, const std::string &filename) {
 	uint8_t *data = vfs.ReadFile(filename.c_str(), &size);
 	if (!data)
 		return false;
-	std::string str((const char*)data, size);
+	bool success = LoadFromString(std::string_view((const char *)data, size));
 	delete [] data;
-
-	std::stringstream sstream(str);
-	return Load(sstream);
+	return success;
 }
 
 bool IniFile::Load(std::istream &in) {
-	// Maximum number of letters in a line
-	static const int MAX_BYTES = 1024*32;
-	char *templine = new char[MAX_BYTES];  // avoid using up massive stack space
+	std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	return LoadFromString(data);
+}
 
-	while (!(in.eof() || in.fail()))
-	{
-		in.getline(templine, MAX_BYTES);
-		std::string_view line = templine;
+bool IniFile::LoadFromString(std::string_view data) {
+	// Lines are parsed straight out of the buffer, no copies until they're stored.
+	size_t pos = 0;
+	while (pos < data.size()) {
+		size_t lineEnd = data.find('\n', pos);
+		if (lineEnd == std::string_view::npos)
+			lineEnd = data.size();
+		std::string_view line = data.substr(pos, lineEnd - pos);
+		pos = lineEnd + 1;
+
+		// Like the old getline() based parsing, stop at embedded nulls.
+		size_t nullPos = line.find('\0');
+		if (nullPos != std::string_view::npos) {
+			line = line.substr(0, nullPos);
+		}
 
 		// Remove UTF-8 byte order marks.
 		if (line.substr(0, 3) == "\xEF\xBB\xBF") {
@@ -567,11 +605,11 @@ bool IniFile::Load(std::istream &in) {
 					sections.push_back(std::make_unique<Section>(""));
 				}
 				sections.back()->lines_.emplace_back(line);
+				sections.back()->InvalidateKeyIndex();
 			}
 		}
 	}
 
-	delete[] templine;
 	return true;
 }
 
@@ -116,15 +116,27 @@ class Section {
 	}
 
 protected:
+	// Returns the index in lines_ of the first line with this key, or -1.
+	int FindLine(std::string_view key) const;
+	void InvalidateKeyIndex() {
+		keyIndexValid_ = false;
+	}
+
 	std::vector<ParsedIniLine> lines_;
 	std::string name_;
 	std::string comment;
+
+	// Indices into lines_ of the lines with keys, sorted by key (case insensitive). Built on first lookup,
+	// config load and save look up hundreds of keys per section.
+	mutable std::vector<uint32_t> keyIndex_;
+	mutable bool keyIndexValid_ = false;
 };
 
 class IniFile {
 public:
 	bool Load(const Path &path);
 	bool Load(std::istream &istream);
+	bool LoadFromString(std::string_view data);
 	bool LoadFromVFS(VFSInterface &vfs, const std::string &filename);
 
 	bool Save(const Path &path);
@@ -1,6 +1,8 @@
-#include <iomanip>
 #include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <locale>
+#include <sstream>
 
 #include "Common/Data/Format/JSONReader.h"
 #include "Common/Data/Format/JSONWriter.h"
@@ -9,21 +11,61 @@ namespace json {
 
 JsonWriter::JsonWriter(int flags) {
 	pretty_ = (flags & PRETTY) != 0;
-	str_.imbue(std::locale::classic());
-	// Let's maximize precision by default.
-	str_.precision(53);
 }
 
 JsonWriter::~JsonWriter() {
 }
 
+void JsonWriter::appendInt(int value) {
+	char temp[16];
+	int len = snprintf(temp, sizeof(temp), "%d", value);
+	str_.append(temp, len);
+}
+
+void JsonWriter::appendUint(uint32_t value) {
+	char temp[16];
+	int len = snprintf(temp, sizeof(temp), "%u", value);
+	str_.append(temp, len);
+}
+
+void JsonWriter::appendFloat(double value) {
+	if (!std::isfinite(value)) {
+		str_ += "null";
+		return;
+	}
+
+	// Let's maximize precision. Same output as an ostream with precision(53).
+	char temp[128];
+	int len = snprintf(temp, sizeof(temp), "%.53g", value);
+	bool plain = len > 0 && len < (int)sizeof(temp);
+	for (int i = 0; plain && i < len; ++i) {
+		char c = temp[i];
+		if (c == ',') {
+			// Decimal comma from the C locale, JSON always wants a point.
+			temp[i] = '.';
+		} else if (!(c >= '0' && c <= '9') && c != '.' && c != '-' && c != '+' && c != 'e') {
+			plain = false;
+		}
+	}
+	if (plain) {
+		str_.append(temp, len);
+	} else {
+		// Some odd locale, let the classic one deal with it.
+		std::ostringstream stream;
+		stream.imbue(std::locale::classic());
+		stream.precision(53);
+		stream << value;
+		str_ += stream.str();
+	}
+}
+
 void JsonWriter::begin() {
-	str_ << "{";
+	str_ += "{";
 	stack_.emplace_back(DICT);
 }
 
 void JsonWriter::beginArray() {
-	str_ << "[";
+	str_ += "[";
 	stack_.emplace_back(ARRAY);
 }
 
@@ -35,7 +77,7 @@ void JsonWriter::beginRaw() {
 void JsonWriter::end() {
 	pop();
 	if (pretty_)
-		str_ << "\n";
+		str_ += "\n";
 }
 
 const char *JsonWriter::indent(int n) const {
@@ -82,140 +124,175 @@ const char *JsonWriter::arrayComma() const {
 }
 
 void JsonWriter::pushDict() {
-	str_ << arrayComma() << arrayIndent() << "{";
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	str_ += "{";
 	stack_.back().first = false;
 	stack_.emplace_back(DICT);
 }
 
 void JsonWriter::pushDict(const std::string &name) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": {" : "\":{");
+	str_ += (pretty_ ? "\": {" : "\":{");
 	stack_.back().first = false;
 	stack_.emplace_back(DICT);
 }
 
 void JsonWriter::pushArray() {
-	str_ << arrayComma() << arrayIndent() << "[";
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	str_ += "[";
 	stack_.back().first = false;
 	stack_.emplace_back(ARRAY);
 }
 
 void JsonWriter::pushArray(const std::string &name) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": [" : "\":[");
+	str_ += (pretty_ ? "\": [" : "\":[");
 	stack_.emplace_back(ARRAY);
 }
 
 void JsonWriter::writeBool(bool value) {
-	str_ << arrayComma() << arrayIndent() << (value ? "true" : "false");
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	str_ += (value ? "true" : "false");
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeBool(const std::string &name, bool value) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << (value ? "true" : "false");
+	str_ += (pretty_ ? "\": " : "\":");
+	str_ += (value ? "true" : "false");
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeInt(int value) {
-	str_ << arrayComma() << arrayIndent() << value;
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	appendInt(value);
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeInt(const std::string &name, int value) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << value;
+	str_ += (pretty_ ? "\": " : "\":");
+	appendInt(value);
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeUint(uint32_t value) {
-	str_ << arrayComma() << arrayIndent() << value;
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	appendUint(value);
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeUint(const std::string &name, uint32_t value) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << value;
+	str_ += (pretty_ ? "\": " : "\":");
+	appendUint(value);
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeFloat(double value) {
-	str_ << arrayComma() << arrayIndent();
-	if (std::isfinite(value))
-		str_ << value;
-	else
-		str_ << "null";
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	appendFloat(value);
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeFloat(const std::string &name, double value) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":");
-	if (std::isfinite(value))
-		str_ << value;
-	else
-		str_ << "null";
+	str_ += (pretty_ ? "\": " : "\":");
+	appendFloat(value);
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeString(const std::string &value) {
-	str_ << arrayComma() << arrayIndent() << "\"";
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	str_ += "\"";
 	writeEscapedString(value);
-	str_ << "\"";
+	str_ += "\"";
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeString(const std::string &name, const std::string &value) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": \"" : "\":\"");
+	str_ += (pretty_ ? "\": \"" : "\":\"");
 	writeEscapedString(value);
-	str_ << "\"";
+	str_ += "\"";
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeRaw(const std::string &value) {
-	str_ << arrayComma() << arrayIndent() << value;
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	str_ += value;
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeRaw(const std::string &name, const std::string &value) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":");
-	str_ << value;
+	str_ += (pretty_ ? "\": " : "\":");
+	str_ += value;
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeNull() {
-	str_ << arrayComma() << arrayIndent() << "null";
+	str_ += arrayComma();
+	str_ += arrayIndent();
+	str_ += "null";
 	stack_.back().first = false;
 }
 
 void JsonWriter::writeNull(const std::string &name) {
-	str_ << comma() << indent() << "\"";
+	str_ += comma();
+	str_ += indent();
+	str_ += "\"";
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << "null";
+	str_ += (pretty_ ? "\": " : "\":");
+	str_ += "null";
 	stack_.back().first = false;
 }
 
 void JsonWriter::pop() {
 	BlockType type = stack_.back().type;
 	stack_.pop_back();
-	if (pretty_)
-		str_ << "\n" << indent();
+	if (pretty_) {
+		str_ += "\n";
+		str_ += indent();
+	}
 	switch (type) {
 	case ARRAY:
-		str_ << "]";
+		str_ += "]";
 		break;
 	case DICT:
-		str_ << "}";
+		str_ += "}";
 		break;
 	case RAW:
 		break;
@@ -231,7 +308,7 @@ void JsonWriter::writeEscapedString(const std::string &str) {
 	auto update = [&](size_t current, size_t skip = 0) {
 		size_t end = current;
 		if (pos < end)
-			str_ << str.substr(pos, end - pos);
+			str_.append(str, pos, end - pos);
 		pos = end + skip;
 	};
 
@@ -241,24 +318,24 @@ void JsonWriter::writeEscapedString(const std::string &str) {
 		case '"':
 		case '/':
 			update(i);
-			str_ << '\\';
+			str_ += '\\';
 			break;
 
 		case '\r':
 			update(i, 1);
-			str_ << "\\r";
+			str_ += "\\r";
 			break;
 			break;
 
 		case '\n':
 			update(i, 1);
-			str_ << "\\n";
+			str_ += "\\n";
 			break;
 			break;
 
 		case '\t':
 			update(i, 1);
-			str_ << "\\t";
+			str_ += "\\t";
 			break;
 
 		case 1: case 2: case 3: case 4: case 5: case 6: case 7: case 8: case 11:
@@ -266,7 +343,11 @@ void JsonWriter::writeEscapedString(const std::string &str) {
 		case 21: case 22: case 23: case 24: case 25: case 26: case 27: case 28:
 		case 29: case 30: case 31:
 			update(i, 1);
-			str_ << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)str[i] << std::dec << std::setw(0);
+			{
+				char temp[8];
+				snprintf(temp, sizeof(temp), "\\u%04x", (int)str[i]);
+				str_ += temp;
+			}
 			break;
 
 		default:
@@ -277,7 +358,7 @@ void JsonWriter::writeEscapedString(const std::string &str) {
 	if (pos != 0) {
 		update(len);
 	} else {
-		str_ << str;
+		str_ += str;
 	}
 }
 
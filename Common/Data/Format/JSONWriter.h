@@ -1,6 +1,5 @@
 // Minimal-state JSON writer. Consumes almost no memory
-// apart from the string being built-up, which could easily be replaced
-// with a file stream (although I've chosen not to do that just yet).
+// apart from the string being built-up, which is appended to directly.
 //
 // Writes nicely 2-space indented output with correct comma-placement
 // in arrays and dictionaries.
@@ -11,9 +10,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <sstream>
 
 struct JsonNode;
 
@@ -47,13 +46,14 @@ class JsonWriter {
 	void writeNull();
 	void writeNull(const std::string &name);
 
-	std::string str() const {
-		return str_.str();
+	const std::string &str() const {
+		return str_;
 	}
 
+	// Keeps the buffer's capacity around for the next message.
 	std::string flush() {
-		std::string result = str_.str();
-		str_.str("");
+		std::string result = str_;
+		str_.clear();
 		return result;
 	}
 
@@ -69,6 +69,9 @@ class JsonWriter {
 	const char *indent() const;
 	const char *arrayIndent() const;
 	void writeEscapedString(const std::string &s);
+	void appendInt(int value);
+	void appendUint(uint32_t value);
+	void appendFloat(double value);
 
 	enum BlockType {
 		ARRAY,
@@ -81,7 +84,7 @@ class JsonWriter {
 		bool first;
 	};
 	std::vector<StackEntry> stack_;
-	std::ostringstream str_;
+	std::string str_;
 	bool pretty_;
 };
 
@@ -63,9 +63,11 @@
 #include "UWP/UWPHelpers/StorageManager.h"
 #endif
 #else
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -725,6 +727,35 @@ bool Rename(const Path &srcFilename, const Path &destFilename) {
 	return false;
 }
 
+Path TempPathFor(const Path &filename) {
+#ifdef _WIN32
+	unsigned long pid = (unsigned long)GetCurrentProcessId();
+#else
+	unsigned long pid = (unsigned long)getpid();
+#endif
+	return filename.WithExtraExtension(StringFromFormat(".%lu.tmp", pid));
+}
+
+bool ReplaceFile(const Path &srcFilename, const Path &destFilename) {
+	if (srcFilename.Type() == PathType::NATIVE && destFilename.Type() == PathType::NATIVE) {
+#if defined(_WIN32) && defined(UNICODE) && !PPSSPP_PLATFORM(UWP)
+		if (MoveFileExW(srcFilename.ToWString().c_str(), destFilename.ToWString().c_str(), MOVEFILE_REPLACE_EXISTING))
+			return true;
+		ERROR_LOG(Log::Common, "ReplaceFile: failed %s --> %s: %s",
+				  srcFilename.c_str(), destFilename.c_str(), GetLastErrorMsg().c_str());
+		return false;
+#elif !defined(_WIN32)
+		// rename() already replaces the destination atomically.
+		return Rename(srcFilename, destFilename);
+#endif
+	}
+
+	// No single step replace here, so there's a short window without the file.
+	if (Exists(destFilename))
+		Delete(destFilename);
+	return Rename(srcFilename, destFilename);
+}
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const Path &srcFilename, const Path &destFilename) {
 	if (LOG_IO) {
@@ -765,10 +796,9 @@ bool Copy(const Path &srcFilename, const Path &destFilename) {
 	return false;
 #else  // Non-Win32
 
-	// buffer size
-#define BSIZE 16384
-
-	char buffer[BSIZE];
+	// Large reads and writes matter a lot for content URIs, where every call has a big overhead.
+	const size_t BSIZE = 1024 * 1024;
+	std::unique_ptr<char[]> buffer(new char[BSIZE]);
 
 	// Open input file
 	FILE *input = OpenCFile(srcFilename, "rb");
@@ -787,12 +817,12 @@ bool Copy(const Path &srcFilename, const Path &destFilename) {
 		return false;
 	}
 
-	int bytesWritten = 0;
+	uint64_t bytesWritten = 0;
 
 	// copy loop
 	while (!feof(input)) {
 		// read input
-		int rnum = fread(buffer, sizeof(char), BSIZE, input);
+		size_t rnum = fread(buffer.get(), sizeof(char), BSIZE, input);
 		if (rnum != BSIZE) {
 			if (ferror(input) != 0) {
 				ERROR_LOG(Log::Common,
@@ -805,7 +835,7 @@ bool Copy(const Path &srcFilename, const Path &destFilename) {
 		}
 
 		// write output
-		int wnum = fwrite(buffer, sizeof(char), rnum, output);
+		size_t wnum = fwrite(buffer.get(), sizeof(char), rnum, output);
 		if (wnum != rnum) {
 			ERROR_LOG(Log::Common,
 					"Copy: failed writing to output, %s --> %s: %s",
@@ -1243,6 +1273,76 @@ bool IOFile::Resize(uint64_t size)
 	return m_good;
 }
 
+bool MappedFile::Open(const Path &filename) {
+	Close();
+#if PPSSPP_PLATFORM(UWP)
+	return false;
+#elif defined(_WIN32)
+	if (filename.Type() != PathType::NATIVE)
+		return false;
+	HANDLE file = CreateFileW(filename.ToWString().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || (uint64_t)fileSize.QuadPart > (uint64_t)SIZE_MAX) {
+		CloseHandle(file);
+		return false;
+	}
+	// The mapping object keeps the file open, so we can close our handle right away.
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+	const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		return false;
+	}
+	mapping_ = mapping;
+	data_ = (const uint8_t *)view;
+	size_ = (size_t)fileSize.QuadPart;
+	return true;
+#else
+	int fd;
+	if (filename.Type() == PathType::CONTENT_URI) {
+		fd = OpenFD(filename, OPEN_READ);
+	} else if (filename.Type() == PathType::NATIVE) {
+		fd = open(filename.c_str(), O_RDONLY);
+	} else {
+		return false;
+	}
+	if (fd < 0)
+		return false;
+	struct stat64 st;
+	if (fstat64(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+		close(fd);
+		return false;
+	}
+	// The mapping holds its own reference to the file, no need to keep the fd around.
+	void *ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (ptr == MAP_FAILED)
+		return false;
+	data_ = (const uint8_t *)ptr;
+	size_ = (size_t)st.st_size;
+	return true;
+#endif
+}
+
+void MappedFile::Close() {
+	if (!data_)
+		return;
+#if defined(_WIN32) && !PPSSPP_PLATFORM(UWP)
+	UnmapViewOfFile(data_);
+	CloseHandle((HANDLE)mapping_);
+	mapping_ = nullptr;
+#elif !defined(_WIN32)
+	munmap((void *)data_, size_);
+#endif
+	data_ = nullptr;
+	size_ = 0;
+}
+
 bool ReadFileToStringOptions(bool textFile, bool allowShort, const Path &filename, std::string *str) {
 	FILE *f = File::OpenCFile(filename, textFile ? "r" : "rb");
 	if (!f)
@@ -104,6 +104,14 @@ bool DeleteDirRecursively(const Path &directory);
 // so you might have to fall back to copy/delete.
 bool Rename(const Path &srcFilename, const Path &destFilename);
 
+// Returns a name next to filename that's unique to this process, for writing a new version of a
+// file that other running instances may be reading. Put it in place with ReplaceFile.
+Path TempPathFor(const Path &filename);
+
+// Like Rename, but replaces destFilename if it exists, atomically where the platform allows,
+// so other processes see either the old or the new file and never a partial one.
+bool ReplaceFile(const Path &srcFilename, const Path &destFilename);
+
 // copies file srcFilename to destFilename, returns true on success 
 bool Copy(const Path &srcFilename, const Path &destFilename);
 
@@ -205,6 +213,31 @@ class IOFile {
 	bool m_good = true;
 };
 
+// Read-only memory mapping of a whole file. The mapping stays valid until Close() or destruction.
+// Not supported on UWP, where Open() simply fails and callers have to fall back to regular reads.
+class MappedFile {
+public:
+	MappedFile() {}
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile &) = delete;
+	void operator=(const MappedFile &) = delete;
+
+	bool Open(const Path &filename);
+	void Close();
+
+	bool IsOpen() const { return data_ != nullptr; }
+	const uint8_t *data() const { return data_; }
+	size_t size() const { return size_; }
+
+private:
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+#ifdef _WIN32
+	void *mapping_ = nullptr;
+#endif
+};
+
 // TODO: Refactor, this was moved from the old file_util.cpp.
 
 // Whole-file reading/writing
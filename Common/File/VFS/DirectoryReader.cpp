@@ -40,6 +40,7 @@ bool DirectoryReader::Exists(const char *path) {
 class DirectoryReaderFileReference : public VFSFileReference {
 public:
 	Path path;
+	File::MappedFile mapping;
 };
 
 class DirectoryReaderOpenFile : public VFSOpenFile {
@@ -102,3 +103,12 @@ void DirectoryReader::CloseFile(VFSOpenFile *vfsOpenFile) {
 	openFile->file = nullptr;
 	delete openFile;
 }
+
+const uint8_t *DirectoryReader::MapFile(VFSFileReference *vfsReference, size_t *size) {
+	DirectoryReaderFileReference *reference = (DirectoryReaderFileReference *)vfsReference;
+	if (!reference->mapping.IsOpen() && !reference->mapping.Open(reference->path)) {
+		return nullptr;
+	}
+	*size = reference->mapping.size();
+	return reference->mapping.data();
+}
@@ -18,6 +18,7 @@ class DirectoryReader : public VFSBackend {
 	void Rewind(VFSOpenFile *vfsOpenFile) override;
 	size_t Read(VFSOpenFile *vfsOpenFile, void *buffer, size_t length) override;
 	void CloseFile(VFSOpenFile *vfsOpenFile) override;
+	const uint8_t *MapFile(VFSFileReference *vfsReference, size_t *size) override;
 
 	bool GetFileListing(const char *path, std::vector<File::FileInfo> *listing, const char *filter) override;
 	bool GetFileInfo(const char *path, File::FileInfo *info) override;
@@ -54,6 +54,11 @@ class VFSBackend : public VFSInterface {
 	virtual size_t Read(VFSOpenFile *vfsOpenFile, void *buffer, size_t length) = 0;
 	virtual void CloseFile(VFSOpenFile *vfsOpenFile) = 0;
 
+	// Optional zero-copy access. If the whole file can be memory mapped as-is (loose files, or files
+	// stored uncompressed in a ZIP), returns a pointer to its contents, valid until the reference is released.
+	// Returns nullptr if not possible, then use Read instead.
+	virtual const uint8_t *MapFile(VFSFileReference *vfsReference, size_t *size) { return nullptr; }
+
 	// Filter support is optional but nice to have
 	virtual bool GetFileInfo(const char *path, File::FileInfo *info) = 0;
 	virtual bool Exists(const char *path) {
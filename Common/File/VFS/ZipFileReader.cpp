@@ -44,7 +44,96 @@ ZipFileReader *ZipFileReader::Create(const Path &zipFile, const char *inZipPath,
 	if (!path.empty() && path.back() != '/') {
 		path.push_back('/');
 	}
-	return new ZipFileReader(zip_file, zipFile, path);
+	ZipFileReader *reader = new ZipFileReader(zip_file, zipFile, path);
+	reader->MapStoredEntries();
+	return reader;
+}
+
+static inline uint16_t ReadLE16(const uint8_t *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t ReadLE32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void ZipFileReader::MapStoredEntries() {
+	if (!mapping_.Open(zipPath_)) {
+		return;
+	}
+
+	const uint8_t *base = mapping_.data();
+	const size_t fileSize = mapping_.size();
+
+	// The end of central directory record is 22 bytes, followed by a comment of up to 64KB.
+	const size_t EOCD_SIZE = 22;
+	const uint8_t *eocd = nullptr;
+	if (fileSize >= EOCD_SIZE) {
+		size_t minPos = fileSize > EOCD_SIZE + 0xFFFF ? fileSize - EOCD_SIZE - 0xFFFF : 0;
+		for (size_t pos = fileSize - EOCD_SIZE + 1; pos-- > minPos; ) {
+			if (ReadLE32(base + pos) == 0x06054b50) {
+				eocd = base + pos;
+				break;
+			}
+		}
+	}
+
+	int numEntries = eocd ? ReadLE16(eocd + 10) : 0;
+	uint32_t cdirOffset = eocd ? ReadLE32(eocd + 16) : 0;
+	// Zip64 archives are left to libzip. Also bail if libzip disagrees about the contents.
+	if (!eocd || numEntries == 0xFFFF || cdirOffset == 0xFFFFFFFF || numEntries != zip_get_num_entries(zip_file_, 0)) {
+		mapping_.Close();
+		return;
+	}
+
+	std::vector<StoredEntry> entries(numEntries);
+	bool anyStored = false;
+	size_t pos = cdirOffset;
+	for (int i = 0; i < numEntries; i++) {
+		if (pos + 46 > fileSize || ReadLE32(base + pos) != 0x02014b50) {
+			mapping_.Close();
+			return;
+		}
+		const uint8_t *cdir = base + pos;
+		uint16_t flags = ReadLE16(cdir + 8);
+		uint16_t method = ReadLE16(cdir + 10);
+		uint32_t compSize = ReadLE32(cdir + 20);
+		uint32_t size = ReadLE32(cdir + 24);
+		uint16_t nameLen = ReadLE16(cdir + 28);
+		size_t entryLen = 46 + nameLen + ReadLE16(cdir + 30) + ReadLE16(cdir + 32);
+		uint32_t localOffset = ReadLE32(cdir + 42);
+		if (pos + entryLen > fileSize) {
+			mapping_.Close();
+			return;
+		}
+		pos += entryLen;
+
+		entries[i].offset = 0;
+		entries[i].size = 0;
+		// Only stored (method 0), unencrypted entries can be used directly.
+		if (method != 0 || (flags & 1) != 0 || compSize != size || size == 0xFFFFFFFF || localOffset == 0xFFFFFFFF)
+			continue;
+		const char *name = zip_get_name(zip_file_, i, ZIP_FL_ENC_RAW);
+		if (!name || strlen(name) != nameLen || memcmp(name, cdir + 46, nameLen) != 0)
+			continue;
+
+		// The local header repeats the name, but may have a different extra field.
+		if ((size_t)localOffset + 30 > fileSize || ReadLE32(base + localOffset) != 0x04034b50)
+			continue;
+		uint64_t dataOffset = (uint64_t)localOffset + 30 + ReadLE16(base + localOffset + 26) + ReadLE16(base + localOffset + 28);
+		if (dataOffset + size > fileSize)
+			continue;
+		entries[i].offset = dataOffset;
+		entries[i].size = size;
+		anyStored = true;
+	}
+
+	if (anyStored) {
+		storedEntries_ = std::move(entries);
+	} else {
+		// Everything's compressed, no need to keep the address space.
+		mapping_.Close();
+	}
 }
 
 ZipFileReader::~ZipFileReader() {
@@ -311,3 +400,14 @@ void ZipFileReader::CloseFile(VFSOpenFile *vfsOpenFile) {
 	lock_.unlock();
 	delete file;
 }
+
+const uint8_t *ZipFileReader::MapFile(VFSFileReference *vfsReference, size_t *size) {
+	ZipFileReaderFileReference *reference = (ZipFileReaderFileReference *)vfsReference;
+	if (reference->zi < 0 || (size_t)reference->zi >= storedEntries_.size())
+		return nullptr;
+	const StoredEntry &entry = storedEntries_[reference->zi];
+	if (entry.offset == 0)
+		return nullptr;
+	*size = entry.size;
+	return mapping_.data() + entry.offset;
+}
@@ -9,6 +9,7 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/FileUtil.h"
@@ -32,6 +33,7 @@ class ZipFileReader : public VFSBackend {
 	void Rewind(VFSOpenFile *vfsOpenFile) override;
 	size_t Read(VFSOpenFile *vfsOpenFile, void *buffer, size_t length) override;
 	void CloseFile(VFSOpenFile *vfsOpenFile) override;
+	const uint8_t *MapFile(VFSFileReference *vfsReference, size_t *size) override;
 
 	bool GetFileListing(const char *path, std::vector<File::FileInfo> *listing, const char *filter) override;
 	bool GetFileInfo(const char *path, File::FileInfo *info) override;
@@ -48,9 +50,20 @@ class ZipFileReader : public VFSBackend {
 	ZipFileReader(zip *zip_file, const Path &zipPath, const std::string &inZipPath) : zip_file_(zip_file), zipPath_(zipPath), inZipPath_(inZipPath) {}
 	// Path has to be either an empty string, or a string ending with a /.
 	bool GetZipListings(const std::string &path, std::set<std::string> &files, std::set<std::string> &directories);
+	// Maps the archive and locates the data of all entries that are stored without compression.
+	void MapStoredEntries();
+
+	struct StoredEntry {
+		uint64_t offset;  // 0 if the entry can't be mapped.
+		uint32_t size;
+	};
 
 	zip *zip_file_ = nullptr;
 	std::mutex lock_;
 	std::string inZipPath_;
 	Path zipPath_;
+
+	// Immutable after Create, so MapFile doesn't need the lock.
+	File::MappedFile mapping_;
+	std::vector<StoredEntry> storedEntries_;  // Indexed like libzip, by central directory order.
 };
@@ -11,6 +11,8 @@
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Data/Encoding/Utf8.h"
+#include "Common/Profiler/Tracer.h"
+#include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 #include "Common/Log.h"
 
@@ -30,6 +32,9 @@
 namespace Draw {
 
 static constexpr int MAX_BOUND_TEXTURES = 8;
+// Timestamps are read back this many frames later.
+static constexpr int TIMESTAMP_FRAMES = 4;
+static constexpr size_t MAX_TIMESTAMP_QUERIES = 128;
 
 // A problem is that we can't get the D3Dcompiler.dll without using a later SDK than 7.1, which was the last that
 // supported XP. A possible solution might be here:
@@ -93,6 +98,17 @@ class D3D11Framebuffer : public Framebuffer {
 	ID3D11Texture2D *depthStencilTex = nullptr;
 	ID3D11DepthStencilView *depthStencilRTView = nullptr;
 	DXGI_FORMAT depthStencilFormat = DXGI_FORMAT_UNKNOWN;
+
+	std::string tag;
+};
+
+// GPU timestamps for Tracer, taken between render passes.  An empty description marks the start of the frame.
+struct D3D11TimestampFrame {
+	ID3D11Query *disjoint = nullptr;
+	std::vector<ID3D11Query *> queries;
+	std::vector<std::string> descriptions;
+	// From right before the first timestamp was queued.
+	uint64_t firstTimestampNanos = 0;
 };
 
 class D3D11DrawContext : public DrawContext {
@@ -212,6 +228,10 @@ class D3D11DrawContext : public DrawContext {
 private:
 	void ApplyCurrentState();
 
+	void BeginTimestamps();
+	void WriteTimestamp(std::string &&description);
+	void EndTimestamps();
+
 	ID3D11DepthStencilState *GetCachedDepthStencilState(const D3D11DepthStencilState *state, uint8_t stencilWriteMask, uint8_t stencilCompareMask);
 
 	HWND hWnd_;
@@ -275,6 +295,12 @@ class D3D11DrawContext : public DrawContext {
 	Buffer *upBuffer_ = nullptr;
 	Buffer *upIBuffer_ = nullptr;
 
+	D3D11TimestampFrame timestampFrames_[TIMESTAMP_FRAMES];
+	int curTimestampFrame_ = 0;
+	bool timestampsActive_ = false;
+	// Name of the pass in progress, timed when the next one starts.
+	std::string timestampPassName_;
+
 	// System info
 	D3D_FEATURE_LEVEL featureLevel_;
 	std::string adapterDesc_;
@@ -405,6 +431,13 @@ D3D11DrawContext::D3D11DrawContext(ID3D11Device *device, ID3D11DeviceContext *de
 D3D11DrawContext::~D3D11DrawContext() {
 	DestroyPresets();
 
+	for (auto &frame : timestampFrames_) {
+		if (frame.disjoint)
+			frame.disjoint->Release();
+		for (ID3D11Query *query : frame.queries)
+			query->Release();
+	}
+
 	upBuffer_->Release();
 	upIBuffer_->Release();
 	packTexture_->Release();
@@ -478,6 +511,81 @@ void D3D11DrawContext::EndFrame() {
 	// Fake a submit time.
 	frameTimeHistory_[frameCount_].firstSubmit = time_now_d();
 	curPipeline_ = nullptr;
+	EndTimestamps();
+}
+
+void D3D11DrawContext::BeginTimestamps() {
+	curTimestampFrame_ = (curTimestampFrame_ + 1) % TIMESTAMP_FRAMES;
+	D3D11TimestampFrame &frame = timestampFrames_[curTimestampFrame_];
+
+	const size_t count = frame.descriptions.size();
+	if (count > 1 && Tracer::Active()) {
+		// Don't wait, if these aren't done after this many frames just skip them.
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData{};
+		bool ready = context_->GetData(frame.disjoint, &disjointData, sizeof(disjointData), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+		std::vector<uint64_t> ticks(count);
+		for (size_t i = 0; ready && i < count; ++i) {
+			ready = context_->GetData(frame.queries[i], &ticks[i], sizeof(uint64_t), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+		}
+
+		if (ready && !disjointData.Disjoint && disjointData.Frequency != 0) {
+			const double nanosPerTick = 1000000000.0 / (double)disjointData.Frequency;
+			auto toNanos = [&](size_t i) {
+				return (uint64_t)((double)ticks[i] * nanosPerTick);
+			};
+
+			std::vector<Tracer::GPUZone> zones;
+			zones.reserve(count);
+			// A zone for the whole frame goes first, since the tracer lines up the clocks using the first timestamp.
+			zones.push_back(Tracer::GPUZone{ "frame", toNanos(0), toNanos(count - 1) });
+			for (size_t i = 1; i < count; ++i) {
+				zones.push_back(Tracer::GPUZone{ frame.descriptions[i], toNanos(i - 1), toNanos(i) });
+			}
+			Tracer::RecordGPUFrame(frame.firstTimestampNanos, zones);
+		}
+	}
+	frame.descriptions.clear();
+
+	timestampsActive_ = Tracer::Active();
+	if (!timestampsActive_)
+		return;
+
+	if (!frame.disjoint) {
+		D3D11_QUERY_DESC desc{ D3D11_QUERY_TIMESTAMP_DISJOINT };
+		if (FAILED(device_->CreateQuery(&desc, &frame.disjoint))) {
+			timestampsActive_ = false;
+			return;
+		}
+	}
+	context_->Begin(frame.disjoint);
+	timestampPassName_ = "(before first pass)";
+	WriteTimestamp(std::string());
+}
+
+void D3D11DrawContext::WriteTimestamp(std::string &&description) {
+	D3D11TimestampFrame &frame = timestampFrames_[curTimestampFrame_];
+	const size_t index = frame.descriptions.size();
+	if (index >= MAX_TIMESTAMP_QUERIES)
+		return;
+	if (index >= frame.queries.size()) {
+		D3D11_QUERY_DESC desc{ D3D11_QUERY_TIMESTAMP };
+		ID3D11Query *query = nullptr;
+		if (FAILED(device_->CreateQuery(&desc, &query)))
+			return;
+		frame.queries.push_back(query);
+	}
+	if (index == 0)
+		frame.firstTimestampNanos = time_now_raw();
+	context_->End(frame.queries[index]);
+	frame.descriptions.push_back(std::move(description));
+}
+
+void D3D11DrawContext::EndTimestamps() {
+	if (!timestampsActive_)
+		return;
+	WriteTimestamp(std::move(timestampPassName_));
+	context_->End(timestampFrames_[curTimestampFrame_].disjoint);
+	timestampsActive_ = false;
 }
 
 void D3D11DrawContext::Present(PresentMode presentMode, int vblanks) {
@@ -1247,6 +1355,10 @@ void D3D11DrawContext::Invalidate(InvalidationFlags flags) {
 		curInputLayout_ = nullptr;
 		curTopology_ = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
 		curPipeline_ = nullptr;
+		// We share the context with the GPU code, which keeps its own cache of what's bound.
+		if (invalidationCallback_) {
+			invalidationCallback_(InvalidationCallbackFlags::CACHED_RENDER_STATE);
+		}
 	}
 }
 
@@ -1490,6 +1602,7 @@ uint32_t D3D11DrawContext::GetDataFormatSupport(DataFormat fmt) const {
 Framebuffer *D3D11DrawContext::CreateFramebuffer(const FramebufferDesc &desc) {
 	HRESULT hr;
 	D3D11Framebuffer *fb = new D3D11Framebuffer(desc.width, desc.height);
+	fb->tag = desc.tag ? desc.tag : "";
 
 	// We don't (yet?) support multiview for D3D11. Not sure if there's a way to do it.
 	// Texture arrays are supported but we don't have any other use cases yet.
@@ -1628,6 +1741,10 @@ void D3D11DrawContext::BeginFrame(DebugFlags debugFlags) {
 	frameTimeData.afterFenceWait = time_now_d();
 	frameTimeData.frameBegin = frameTimeData.afterFenceWait;
 
+	// In case EndFrame was skipped.
+	EndTimestamps();
+	BeginTimestamps();
+
 	context_->OMSetRenderTargets(1, &curRenderTargetView_, curDepthStencilView_);
 
 	if (curBlend_ != nullptr) {
@@ -1860,6 +1977,12 @@ bool D3D11DrawContext::CopyFramebufferToMemory(Framebuffer *src, Aspect channelB
 }
 
 void D3D11DrawContext::BindFramebufferAsRenderTarget(Framebuffer *fbo, const RenderPassInfo &rp, const char *tag) {
+	if (timestampsActive_) {
+		// This ends the previous pass, there's nothing more explicit in D3D11.
+		WriteTimestamp(std::move(timestampPassName_));
+		timestampPassName_ = StringFromFormat("%s: %s", tag ? tag : "(untagged)", fbo ? ((D3D11Framebuffer *)fbo)->tag.c_str() : "backbuffer");
+	}
+
 	// TODO: deviceContext1 can actually discard. Useful on Windows Mobile.
 	if (fbo) {
 		D3D11Framebuffer *fb = (D3D11Framebuffer *)fbo;
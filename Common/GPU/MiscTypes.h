@@ -15,6 +15,8 @@ ENUM_CLASS_BITOPS(InvalidationFlags);
 enum class InvalidationCallbackFlags {
 	RENDER_PASS_STATE = 1,
 	COMMAND_BUFFER_STATE = 2,
+	// Forwarded from Invalidate(CACHED_RENDER_STATE), for backends where the GPU code binds state directly.
+	CACHED_RENDER_STATE = 4,
 };
 ENUM_CLASS_BITOPS(InvalidationCallbackFlags);
 
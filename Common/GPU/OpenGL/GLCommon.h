@@ -58,6 +58,18 @@ typedef void (EGLAPIENTRYP PFNGLBLITFRAMEBUFFERNVPROC) (
 #endif
 extern PFNGLBLITFRAMEBUFFERNVPROC glBlitFramebufferNV;
 
+// GL_EXT_disjoint_timer_query. Own names, since not every NDK has the typedefs.
+typedef void (EGLAPIENTRYP PFNGLQUERYCOUNTERPPSSPPPROC) (GLuint id, GLenum target);
+typedef void (EGLAPIENTRYP PFNGLGETQUERYOBJECTUI64VPPSSPPPROC) (GLuint id, GLenum pname, GLuint64 *params);
+extern PFNGLQUERYCOUNTERPPSSPPPROC glQueryCounterEXT;
+extern PFNGLGETQUERYOBJECTUI64VPPSSPPPROC glGetQueryObjectui64vEXT;
+#ifndef GL_TIMESTAMP_EXT
+#define GL_TIMESTAMP_EXT 0x8E28
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
 #if PPSSPP_PLATFORM(IOS)
 extern PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebufferEXT;
 extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOES;
@@ -25,6 +25,9 @@ PFNGLDRAWTEXTURENVPROC glDrawTextureNV;
 PFNGLBLITFRAMEBUFFERNVPROC glBlitFramebufferNV;
 PFNGLMAPBUFFERPROC glMapBuffer;
 
+PFNGLQUERYCOUNTERPPSSPPPROC glQueryCounterEXT;
+PFNGLGETQUERYOBJECTUI64VPPSSPPPROC glGetQueryObjectui64vEXT;
+
 PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebufferEXT;
 PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOES;
 PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOES;
@@ -362,6 +365,7 @@ bool CheckGLExtensions() {
 	gl_extensions.OES_copy_image = g_set_gl_extensions.count("GL_OES_copy_image") != 0;
 	gl_extensions.EXT_copy_image = g_set_gl_extensions.count("GL_EXT_copy_image") != 0;
 	gl_extensions.ARB_copy_image = g_set_gl_extensions.count("GL_ARB_copy_image") != 0;
+	gl_extensions.ARB_get_program_binary = g_set_gl_extensions.count("GL_ARB_get_program_binary") != 0;
 	gl_extensions.ARB_buffer_storage = g_set_gl_extensions.count("GL_ARB_buffer_storage") != 0;
 	gl_extensions.ARB_vertex_array_object = g_set_gl_extensions.count("GL_ARB_vertex_array_object") != 0;
 	gl_extensions.ARB_texture_float = g_set_gl_extensions.count("GL_ARB_texture_float") != 0;
@@ -376,6 +380,7 @@ bool CheckGLExtensions() {
 	gl_extensions.ARB_shader_stencil_export = g_set_gl_extensions.count("GL_ARB_shader_stencil_export") != 0;
 	gl_extensions.ARB_texture_compression_bptc = g_set_gl_extensions.count("GL_ARB_texture_compression_bptc") != 0;
 	gl_extensions.ARB_texture_compression_rgtc = g_set_gl_extensions.count("GL_ARB_texture_compression_rgtc") != 0;
+	gl_extensions.ARB_timer_query = g_set_gl_extensions.count("GL_ARB_timer_query") != 0;
 	gl_extensions.KHR_texture_compression_astc_ldr = g_set_gl_extensions.count("GL_KHR_texture_compression_astc_ldr") != 0;
 	gl_extensions.EXT_texture_compression_s3tc = g_set_gl_extensions.count("GL_EXT_texture_compression_s3tc") != 0;
 	gl_extensions.OES_texture_compression_astc = g_set_gl_extensions.count("GL_OES_texture_compression_astc") != 0;
@@ -396,6 +401,7 @@ bool CheckGLExtensions() {
 		gl_extensions.EXT_buffer_storage = g_set_gl_extensions.count("GL_EXT_buffer_storage") != 0;
 		gl_extensions.EXT_clip_cull_distance = g_set_gl_extensions.count("GL_EXT_clip_cull_distance") != 0;
 		gl_extensions.EXT_depth_clamp = g_set_gl_extensions.count("GL_EXT_depth_clamp") != 0;
+		gl_extensions.EXT_disjoint_timer_query = g_set_gl_extensions.count("GL_EXT_disjoint_timer_query") != 0;
 		gl_extensions.APPLE_clip_distance = g_set_gl_extensions.count("GL_APPLE_clip_distance") != 0;
 
 #if defined(__ANDROID__)
@@ -420,6 +426,12 @@ bool CheckGLExtensions() {
 			glBlitFramebufferNV = (PFNGLBLITFRAMEBUFFERNVPROC)eglGetProcAddress("glBlitFramebufferNV");
 		}
 
+		if (gl_extensions.EXT_disjoint_timer_query) {
+			glQueryCounterEXT = (PFNGLQUERYCOUNTERPPSSPPPROC)eglGetProcAddress("glQueryCounterEXT");
+			glGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VPPSSPPPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+			gl_extensions.EXT_disjoint_timer_query = glQueryCounterEXT && glGetQueryObjectui64vEXT;
+		}
+
 		gl_extensions.OES_vertex_array_object = g_set_gl_extensions.count("GL_OES_vertex_array_object") != 0;
 		if (gl_extensions.OES_vertex_array_object) {
 			glGenVertexArraysOES = (PFNGLGENVERTEXARRAYSOESPROC)eglGetProcAddress("glGenVertexArraysOES");
@@ -538,12 +550,13 @@ bool CheckGLExtensions() {
 		if (gl_extensions.VersionGEThan(3, 3)) {
 			gl_extensions.ARB_blend_func_extended = true;
 			gl_extensions.ARB_explicit_attrib_location = true;
+			gl_extensions.ARB_timer_query = true;
 		}
 		if (gl_extensions.VersionGEThan(4, 0)) {
 			// ARB_gpu_shader5 = true;
 		}
 		if (gl_extensions.VersionGEThan(4, 1)) {
-			// ARB_get_program_binary = true;
+			gl_extensions.ARB_get_program_binary = true;
 			// ARB_separate_shader_objects = true;
 			// ARB_shader_precision = true;
 			// ARB_viewport_array = true;
@@ -611,6 +624,15 @@ bool CheckGLExtensions() {
 	}
 	delete[] compressedFormats;
 
+	// Some drivers have the entry points but no binary formats, so they can't actually save any.
+	if (gl_extensions.IsGLES)
+		gl_extensions.ARB_get_program_binary = gl_extensions.GLES3;
+	if (gl_extensions.ARB_get_program_binary) {
+		GLint numProgramBinaryFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numProgramBinaryFormats);
+		gl_extensions.ARB_get_program_binary = numProgramBinaryFormats > 0;
+	}
+
 	ProcessGPUFeatures();
 
 	int error = glGetError();
@@ -78,6 +78,8 @@ struct GLExtensions {
 	bool ARB_shader_stencil_export;
 	bool ARB_texture_compression_bptc;
 	bool ARB_texture_compression_rgtc;
+	bool ARB_timer_query;
+	bool ARB_get_program_binary;  // Also core in ES 3.0
 
 	// KHR
 	bool KHR_texture_compression_astc_ldr;
@@ -99,6 +101,7 @@ struct GLExtensions {
 	bool EXT_buffer_storage;
 	bool EXT_clip_cull_distance;
 	bool EXT_depth_clamp;
+	bool EXT_disjoint_timer_query;
 
 	// NV
 	bool NV_copy_image;
@@ -42,6 +42,18 @@ struct GLQueueProfileContext {
 	double cpuEndTime;
 	std::string passesString;
 	int commandCounts[25];  // Can't grab count from the enum as it would mean a circular include. Might clean this up later.
+	// Redundant state filtering in PerformRenderPass.
+	int uniformsIssued = 0;
+	int uniformsSkipped = 0;
+	int attribSetupsIssued = 0;
+	int attribSetupsSkipped = 0;
+
+	// GPU timestamps for Tracer, one after each step.  An empty description marks the start of a run of steps.
+	bool timestampsEnabled = false;
+	std::vector<GLuint> timestampQueries;
+	std::vector<std::string> timestampDescriptions;
+	// From right before the first timestamp was queued.
+	uint64_t firstTimestampNanos = 0;
 };
 
 
@@ -60,6 +72,9 @@ struct GLFrameData {
 	// Swapchain.
 	bool hasBegun = false;
 
+	// With persistently mapped push buffers, signals when the GPU is done with this frame's buffers.
+	GLsync bufferFence = nullptr;
+
 	GLDeleter deleter;
 	GLDeleter deleter_prev;
 	std::set<GLPushBuffer *> activePushBuffers;
@@ -4,6 +4,13 @@
 #include "Common/GPU/OpenGL/GLFeatures.h"
 #include "Common/Data/Text/Parsers.h"
 
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
 extern std::thread::id renderThreadId;
 #if MAX_LOGLEVEL >= DEBUG_LEVEL
 static bool OnRenderThread() {
@@ -21,6 +28,10 @@ void *GLRBuffer::Map(GLBufferStrategy strategy) {
 	if ((strategy & GLBufferStrategy::MASK_INVALIDATE) != 0) {
 		access |= GL_MAP_INVALIDATE_BUFFER_BIT;
 	}
+	if ((strategy & GLBufferStrategy::MASK_PERSISTENT) != 0) {
+		// Coherent, so we don't need to flush or barrier before the draws.
+		access |= GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	}
 
 	void *p = nullptr;
 	bool allowNativeBuffer = strategy != GLBufferStrategy::SUBDATA;
@@ -262,6 +273,10 @@ void GLPushBuffer::MapDevice(GLBufferStrategy strategy) {
 void GLPushBuffer::UnmapDevice() {
 	_dbg_assert_msg_(OnRenderThread(), "UnmapDevice must run on render thread");
 
+	// Persistent buffers stay mapped until deleted.
+	if ((strategy_ & GLBufferStrategy::MASK_PERSISTENT) != 0)
+		return;
+
 	for (auto &info : buffers_) {
 		if (info.deviceMemory) {
 			// TODO: Technically this can return false?
@@ -13,6 +13,7 @@ enum class GLBufferStrategy {
 
 	MASK_FLUSH = 0x10,
 	MASK_INVALIDATE = 0x20,
+	MASK_PERSISTENT = 0x40,
 
 	// Map/unmap the buffer each frame.
 	FRAME_UNMAP = 1,
@@ -22,6 +23,9 @@ enum class GLBufferStrategy {
 	FLUSH_UNMAP = MASK_FLUSH,
 	// Map/unmap, invalidate on map, and explicit flush.
 	FLUSH_INVALIDATE_UNMAP = MASK_FLUSH | MASK_INVALIDATE,
+	// Map once with coherent persistent mapping (needs buffer storage). The render manager uses fences
+	// to keep the emu thread from writing to a frame's buffers until the GPU is done with them.
+	PERSISTENT = MASK_PERSISTENT,
 };
 
 static inline int operator &(const GLBufferStrategy &lhs, const GLBufferStrategy &rhs) {
@@ -58,8 +62,7 @@ class GLRenderManager;
 // Similar to VulkanPushBuffer but is currently less efficient - it collects all the data in
 // RAM then does a big memcpy/buffer upload at the end of the frame. This is at least a lot
 // faster than the hundreds of buffer uploads or memory array buffers we used before.
-// On modern GL we could avoid the copy using glBufferStorage but not sure it's worth the
-// trouble.
+// With GLBufferStrategy::PERSISTENT, the buffers instead stay mapped and are written directly.
 // We need to manage the lifetime of this together with the other resources so its destructor
 // runs on the render thread.
 class GLPushBuffer : public GPUMemoryManager {
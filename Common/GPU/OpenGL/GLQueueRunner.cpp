@@ -10,7 +10,9 @@
 #include "Common/Log.h"
 #include "Common/LogReporting.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 
 #include "GLQueueRunner.h"
@@ -31,6 +33,7 @@
 #endif
 
 static constexpr int TEXCACHE_NAME_CACHE_SIZE = 16;
+static constexpr size_t MAX_TIMESTAMP_QUERIES = 128;
 
 #if PPSSPP_PLATFORM(IOS)
 extern void bindDefaultFBO();
@@ -88,6 +91,96 @@ void GLQueueRunner::DestroyDeviceObjects() {
 	CHECK_GL_ERROR_IF_DEBUG();
 }
 
+static bool TimestampQueriesSupported() {
+#if !defined(USING_GLES2)
+	return gl_extensions.ARB_timer_query;
+#elif defined(__ANDROID__)
+	// We only bother with GLES3, which has glGenQueries.
+	return gl_extensions.GLES3 && gl_extensions.EXT_disjoint_timer_query;
+#else
+	return false;
+#endif
+}
+
+static void QueryTimestamp(GLuint query) {
+#if !defined(USING_GLES2)
+	glQueryCounter(query, GL_TIMESTAMP);
+#elif defined(__ANDROID__)
+	glQueryCounterEXT(query, GL_TIMESTAMP_EXT);
+#endif
+}
+
+static uint64_t GetTimestampResult(GLuint query) {
+	GLuint64 result = 0;
+#if !defined(USING_GLES2)
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+#elif defined(__ANDROID__)
+	glGetQueryObjectui64vEXT(query, GL_QUERY_RESULT, &result);
+#endif
+	return result;
+}
+
+void GLQueueRunner::BeginTimestamps(GLFrameData &frameData) {
+	GLQueueProfileContext &profile = frameData.profile;
+	const size_t count = profile.timestampDescriptions.size();
+	if (profile.timestampsEnabled && count > 1 && Tracer::Active()) {
+		// This frame came around again, so these should be done.  If not, skip them rather than wait.
+		GLuint available = 0;
+		glGetQueryObjectuiv(profile.timestampQueries[count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		bool disjoint = false;
+#if defined(USING_GLES2)
+		// Something like a clock change happened, which makes the results meaningless.
+		GLint disjointValue = 0;
+		glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjointValue);
+		disjoint = disjointValue != 0;
+#endif
+		if (available && !disjoint) {
+			std::vector<Tracer::GPUZone> zones;
+			zones.reserve(count);
+			uint64_t prev = 0;
+			for (size_t i = 0; i < count; ++i) {
+				const uint64_t now = GetTimestampResult(profile.timestampQueries[i]);
+				if (!profile.timestampDescriptions[i].empty())
+					zones.push_back(Tracer::GPUZone{ profile.timestampDescriptions[i], prev, now });
+				prev = now;
+			}
+			// A zone for the whole frame goes first, since the tracer lines up the clocks using the first timestamp.
+			zones.insert(zones.begin(), Tracer::GPUZone{ "frame", GetTimestampResult(profile.timestampQueries[0]), prev });
+			Tracer::RecordGPUFrame(profile.firstTimestampNanos, zones);
+		}
+		CHECK_GL_ERROR_IF_DEBUG();
+	}
+
+	profile.timestampDescriptions.clear();
+	profile.timestampsEnabled = Tracer::Active() && TimestampQueriesSupported();
+	profile.firstTimestampNanos = 0;
+}
+
+void GLQueueRunner::DestroyTimestamps(GLFrameData &frameData, bool skipGLCalls) {
+	GLQueueProfileContext &profile = frameData.profile;
+	if (!skipGLCalls && !profile.timestampQueries.empty()) {
+		glDeleteQueries((GLsizei)profile.timestampQueries.size(), profile.timestampQueries.data());
+	}
+	profile.timestampQueries.clear();
+	profile.timestampDescriptions.clear();
+	profile.timestampsEnabled = false;
+}
+
+void GLQueueRunner::WriteTimestamp(GLQueueProfileContext &profile, std::string &&description) {
+	const size_t index = profile.timestampDescriptions.size();
+	if (index >= MAX_TIMESTAMP_QUERIES)
+		return;
+	if (index >= profile.timestampQueries.size()) {
+		GLuint query = 0;
+		glGenQueries(1, &query);
+		profile.timestampQueries.push_back(query);
+	}
+	if (index == 0)
+		profile.firstTimestampNanos = time_now_raw();
+	QueryTimestamp(profile.timestampQueries[index]);
+	profile.timestampDescriptions.push_back(std::move(description));
+}
+
 template <typename Getiv, typename GetLog>
 static std::string GetInfoLog(GLuint name, Getiv getiv, GetLog getLog) {
 	GLint bufLength = 0;
@@ -192,37 +285,16 @@ void GLQueueRunner::RunInitSteps(const FastVec<GLRInitStep> &steps, bool skipGLC
 			program->program = glCreateProgram();
 			_assert_msg_(step.create_program.num_shaders > 0, "Can't create a program with zero shaders");
 			bool anyFailed = false;
-			for (int j = 0; j < step.create_program.num_shaders; j++) {
-				_dbg_assert_msg_(step.create_program.shaders[j]->shader, "Can't create a program with a null shader");
-				anyFailed = anyFailed || step.create_program.shaders[j]->failed;
-				glAttachShader(program->program, step.create_program.shaders[j]->shader);
-			}
-
-			for (auto iter : program->semantics_) {
-				glBindAttribLocation(program->program, iter.location, iter.attrib);
-			}
-
-#if !defined(USING_GLES2)
-			if (step.create_program.support_dual_source) {
-				_dbg_assert_msg_(caps_.dualSourceBlend, "ARB/EXT_blend_func_extended required for dual src blend");
-				// Dual source alpha
-				glBindFragDataLocationIndexed(program->program, 0, 0, "fragColor0");
-				glBindFragDataLocationIndexed(program->program, 0, 1, "fragColor1");
-			} else if (gl_extensions.VersionGEThan(3, 0, 0)) {
-				glBindFragDataLocation(program->program, 0, "fragColor0");
-			}
-#elif !PPSSPP_PLATFORM(IOS)
-			if (gl_extensions.GLES3 && step.create_program.support_dual_source) {
-				// For GLES2, we use gl_SecondaryFragColorEXT as fragColor1.
-				_dbg_assert_msg_(gl_extensions.EXT_blend_func_extended, "EXT_blend_func_extended required for dual src");
-				glBindFragDataLocationIndexedEXT(program->program, 0, 0, "fragColor0");
-				glBindFragDataLocationIndexedEXT(program->program, 0, 1, "fragColor1");
+			GLint linkStatus = GL_FALSE;
+			if (!program->binary_.data.empty() && LinkProgramFromBinary(program)) {
+				linkStatus = GL_TRUE;
+			} else {
+				anyFailed = LinkProgram(step);
+				glGetProgramiv(program->program, GL_LINK_STATUS, &linkStatus);
+				if (linkStatus == GL_TRUE && program->retrieveBinary_)
+					RetrieveProgramBinary(program);
 			}
-#endif
-			glLinkProgram(program->program);
 
-			GLint linkStatus = GL_FALSE;
-			glGetProgramiv(program->program, GL_LINK_STATUS, &linkStatus);
 			if (linkStatus != GL_TRUE) {
 				std::string infoLog = GetInfoLog(program->program, glGetProgramiv, glGetProgramInfoLog);
 
@@ -451,6 +523,87 @@ void GLQueueRunner::RunInitSteps(const FastVec<GLRInitStep> &steps, bool skipGLC
 #endif
 }
 
+// Returns true if any of the shaders failed to compile.
+bool GLQueueRunner::LinkProgram(const GLRInitStep &step) {
+	GLRProgram *program = step.create_program.program;
+	bool anyFailed = false;
+	for (int j = 0; j < step.create_program.num_shaders; j++) {
+		_dbg_assert_msg_(step.create_program.shaders[j]->shader, "Can't create a program with a null shader");
+		anyFailed = anyFailed || step.create_program.shaders[j]->failed;
+		glAttachShader(program->program, step.create_program.shaders[j]->shader);
+	}
+
+	for (auto iter : program->semantics_) {
+		glBindAttribLocation(program->program, iter.location, iter.attrib);
+	}
+
+#if !defined(USING_GLES2)
+	if (step.create_program.support_dual_source) {
+		_dbg_assert_msg_(caps_.dualSourceBlend, "ARB/EXT_blend_func_extended required for dual src blend");
+		// Dual source alpha
+		glBindFragDataLocationIndexed(program->program, 0, 0, "fragColor0");
+		glBindFragDataLocationIndexed(program->program, 0, 1, "fragColor1");
+	} else if (gl_extensions.VersionGEThan(3, 0, 0)) {
+		glBindFragDataLocation(program->program, 0, "fragColor0");
+	}
+#elif !PPSSPP_PLATFORM(IOS)
+	if (gl_extensions.GLES3 && step.create_program.support_dual_source) {
+		// For GLES2, we use gl_SecondaryFragColorEXT as fragColor1.
+		_dbg_assert_msg_(gl_extensions.EXT_blend_func_extended, "EXT_blend_func_extended required for dual src");
+		glBindFragDataLocationIndexedEXT(program->program, 0, 0, "fragColor0");
+		glBindFragDataLocationIndexedEXT(program->program, 0, 1, "fragColor1");
+	}
+#endif
+	if (program->retrieveBinary_ && gl_extensions.ARB_get_program_binary)
+		glProgramParameteri(program->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(program->program);
+	return anyFailed;
+}
+
+// The attribute and output bindings are part of the binary.
+bool GLQueueRunner::LinkProgramFromBinary(GLRProgram *program) {
+	if (!gl_extensions.ARB_get_program_binary)
+		return false;
+
+	glProgramBinary(program->program, program->binary_.format, program->binary_.data.data(), (GLsizei)program->binary_.data.size());
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(program->program, GL_LINK_STATUS, &linkStatus);
+	// An unknown format is an error, not just a failed link.
+	glGetError();
+	if (linkStatus == GL_TRUE) {
+		program->binaryReady_.store(true, std::memory_order_release);
+		return true;
+	}
+
+	// Usually the driver was updated.  We'll link from the shaders, and keep the new binary instead.
+	WARN_LOG(Log::G3D, "Program binary rejected by the driver, linking from source");
+	program->binary_.data.clear();
+	glDeleteProgram(program->program);
+	program->program = glCreateProgram();
+	return false;
+}
+
+void GLQueueRunner::RetrieveProgramBinary(GLRProgram *program) {
+	if (!gl_extensions.ARB_get_program_binary)
+		return;
+
+	GLint length = 0;
+	glGetProgramiv(program->program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	GLRProgramBinary &binary = program->binary_;
+	binary.data.resize(length);
+	GLsizei written = 0;
+	glGetProgramBinary(program->program, length, &written, &binary.format, binary.data.data());
+	if (written <= 0) {
+		binary.data.clear();
+		return;
+	}
+	binary.data.resize(written);
+	program->binaryReady_.store(true, std::memory_order_release);
+}
+
 void GLQueueRunner::InitCreateFramebuffer(const GLRInitStep &step) {
 	GLRFramebuffer *fbo = step.create_framebuffer.framebuffer;
 
@@ -621,6 +774,23 @@ void GLQueueRunner::InitCreateFramebuffer(const GLRInitStep &step) {
 	currentReadHandle_ = fbo->handle;
 }
 
+bool GLQueueRunner::StepsNeedStereo(const std::vector<GLRStep *> &steps) {
+	for (const GLRStep *step : steps) {
+		if (step->stepType != GLRStepType::RENDER) {
+			continue;
+		}
+		for (const GLRRenderData &c : step->commands) {
+			if (c.cmd == GLRRenderCommand::UNIFORMSTEREOMATRIX) {
+				const float *m = c.uniformStereoMatrix4.mData;
+				if (memcmp(m, m + 16, 16 * sizeof(float)) != 0) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
 void GLQueueRunner::RunSteps(const std::vector<GLRStep *> &steps, GLFrameData &frameData, bool skipGLCalls, bool keepSteps, bool useVR) {
 	if (skipGLCalls) {
 		if (keepSteps) {
@@ -668,6 +838,11 @@ void GLQueueRunner::RunSteps(const std::vector<GLRStep *> &steps, GLFrameData &f
 	}
 
 	CHECK_GL_ERROR_IF_DEBUG();
+	if (frameData.profile.timestampsEnabled) {
+		// There might be a gap since the last run this frame (like a readback), so don't count that.
+		WriteTimestamp(frameData.profile, std::string());
+	}
+
 	size_t renderCount = 0;
 	for (size_t i = 0; i < steps.size(); i++) {
 		GLRStep &step = *steps[i];
@@ -713,6 +888,9 @@ void GLQueueRunner::RunSteps(const std::vector<GLRStep *> &steps, GLFrameData &f
 		if (frameData.profile.enabled) {
 			frameData.profile.passesString += StepToString(step);
 		}
+		if (frameData.profile.timestampsEnabled && step.stepType != GLRStepType::RENDER_SKIP) {
+			WriteTimestamp(frameData.profile, StepToString(step));
+		}
 		if (!keepSteps) {
 			delete steps[i];
 		}
@@ -795,6 +973,14 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 	int depthFunc = -1;
 	GLuint curArrayBuffer = (GLuint)0;
 	GLuint curElemArrayBuffer = (GLuint)0;
+	const GLRInputLayout *curLayout = nullptr;
+	uint32_t curVertexOffset = 0;
+	float blendColor[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+	// Counts for the filters we can't just assume are cheap, reported in the profile.
+	int uniformsIssued = 0;
+	int uniformsSkipped = 0;
+	int attribSetupsIssued = 0;
+	int attribSetupsSkipped = 0;
 	bool depthEnabled = false;
 	bool stencilEnabled = false;
 	bool blendEnabled = false;
@@ -930,6 +1116,7 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 				}
 				if (logicOp != c.logic.logicOp) {
 					glLogicOp(c.logic.logicOp);
+					logicOp = c.logic.logicOp;
 				}
 			} else if (/* !c.logic.enabled && */ logicEnabled) {
 				glDisable(GL_COLOR_LOGIC_OP);
@@ -979,7 +1166,10 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 			CHECK_GL_ERROR_IF_DEBUG();
 			break;
 		case GLRRenderCommand::BLENDCOLOR:
-			glBlendColor(c.blendColor.color[0], c.blendColor.color[1], c.blendColor.color[2], c.blendColor.color[3]);
+			if (memcmp(blendColor, c.blendColor.color, sizeof(blendColor)) != 0) {
+				glBlendColor(c.blendColor.color[0], c.blendColor.color[1], c.blendColor.color[2], c.blendColor.color[3]);
+				memcpy(blendColor, c.blendColor.color, sizeof(blendColor));
+			}
 			break;
 		case GLRRenderCommand::VIEWPORT:
 		{
@@ -1034,7 +1224,10 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 			if (c.uniform4.name) {
 				loc = curProgram->GetUniformLoc(c.uniform4.name);
 			}
-			if (loc >= 0) {
+			if (loc >= 0 && !curProgram->UniformChanged(loc, c.uniform4.v, c.uniform4.count)) {
+				uniformsSkipped++;
+			} else if (loc >= 0) {
+				uniformsIssued++;
 				_dbg_assert_(c.uniform4.count >=1 && c.uniform4.count <=4);
 				switch (c.uniform4.count) {
 				case 1: glUniform1f(loc, c.uniform4.v[0]); break;
@@ -1053,7 +1246,10 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 			if (c.uniform4.name) {
 				loc = curProgram->GetUniformLoc(c.uniform4.name);
 			}
-			if (loc >= 0) {
+			if (loc >= 0 && !curProgram->UniformChanged(loc, c.uniform4.v, c.uniform4.count)) {
+				uniformsSkipped++;
+			} else if (loc >= 0) {
+				uniformsIssued++;
 				_dbg_assert_(c.uniform4.count >=1 && c.uniform4.count <=4);
 				switch (c.uniform4.count) {
 				case 1: glUniform1uiv(loc, 1, (GLuint *)c.uniform4.v); break;
@@ -1072,7 +1268,10 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 			if (c.uniform4.name) {
 				loc = curProgram->GetUniformLoc(c.uniform4.name);
 			}
-			if (loc >= 0) {
+			if (loc >= 0 && !curProgram->UniformChanged(loc, c.uniform4.v, c.uniform4.count)) {
+				uniformsSkipped++;
+			} else if (loc >= 0) {
+				uniformsIssued++;
 				_dbg_assert_(c.uniform4.count >=1 && c.uniform4.count <=4);
 				switch (c.uniform4.count) {
 				case 1: glUniform1iv(loc, 1, (GLint *)c.uniform4.v); break;
@@ -1098,7 +1297,7 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 					glUniformMatrix4fv(loc, 1, false, c.uniformStereoMatrix4.mData + 16);
 				}
 			}
-			if (GetVRFBOIndex() == 1 || GetVRPassesCount() == 1) {
+			if (GetVRFBOIndex() == 1 || GetVRPassesCount() == 1 || IsVRSinglePass()) {
 				// Only delete the data if we're rendering the only or the second eye.
 				// If we delete during the first eye, we get a use-after-free or double delete.
 				delete[] c.uniformStereoMatrix4.mData;
@@ -1198,14 +1397,23 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 			if (buf != curArrayBuffer) {
 				glBindBuffer(GL_ARRAY_BUFFER, buf);
 				curArrayBuffer = buf;
+				// Attrib pointers capture the bound buffer.
+				curLayout = nullptr;
 			}
 			if (attrMask != layout->semanticsMask_) {
 				EnableDisableVertexArrays(attrMask, layout->semanticsMask_);
 				attrMask = layout->semanticsMask_;
 			}
-			for (size_t i = 0; i < layout->entries.size(); i++) {
-				auto &entry = layout->entries[i];
-				glVertexAttribPointer(entry.location, entry.count, entry.type, entry.normalized, layout->stride, (const void *)(c.draw.vertexOffset + entry.offset));
+			if (layout != curLayout || c.draw.vertexOffset != curVertexOffset) {
+				for (size_t i = 0; i < layout->entries.size(); i++) {
+					auto &entry = layout->entries[i];
+					glVertexAttribPointer(entry.location, entry.count, entry.type, entry.normalized, layout->stride, (const void *)(c.draw.vertexOffset + entry.offset));
+				}
+				curLayout = layout;
+				curVertexOffset = c.draw.vertexOffset;
+				attribSetupsIssued++;
+			} else {
+				attribSetupsSkipped++;
 			}
 			if (c.draw.indexBuffer) {
 				GLuint buf = c.draw.indexBuffer->buffer_;
@@ -1384,6 +1592,13 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 	}
 	CHECK_GL_ERROR_IF_DEBUG();
 
+	if (profile.enabled) {
+		profile.uniformsIssued += uniformsIssued;
+		profile.uniformsSkipped += uniformsSkipped;
+		profile.attribSetupsIssued += attribSetupsIssued;
+		profile.attribSetupsSkipped += attribSetupsSkipped;
+	}
+
 	// Wipe out the current state.
 	if (curArrayBuffer != 0)
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
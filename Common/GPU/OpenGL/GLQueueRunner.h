@@ -356,9 +356,16 @@ class GLQueueRunner {
 
 	void RunSteps(const std::vector<GLRStep *> &steps, GLFrameData &frameData, bool skipGLCalls, bool keepSteps, bool useVR);
 
+	// Returns true if any stereo matrix in the steps differs between the eyes.
+	static bool StepsNeedStereo(const std::vector<GLRStep *> &steps);
+
 	void CreateDeviceObjects();
 	void DestroyDeviceObjects();
 
+	// For Tracer.  Passes on the timestamps from the last time around, if done, and starts over.
+	void BeginTimestamps(GLFrameData &frameData);
+	void DestroyTimestamps(GLFrameData &frameData, bool skipGLCalls);
+
 	void CopyFromReadbackBuffer(GLRFramebuffer *framebuffer, int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels);
 
 	void Resize(int width, int height) {
@@ -377,6 +384,9 @@ class GLQueueRunner {
 
 private:
 	void InitCreateFramebuffer(const GLRInitStep &step);
+	bool LinkProgram(const GLRInitStep &step);
+	bool LinkProgramFromBinary(GLRProgram *program);
+	void RetrieveProgramBinary(GLRProgram *program);
 
 	void PerformBindFramebufferAsRenderTarget(const GLRStep &pass);
 	void PerformRenderPass(const GLRStep &pass, bool first, bool last, GLQueueProfileContext &profile);
@@ -391,6 +401,7 @@ class GLQueueRunner {
 	void fbo_unbind();
 
 	std::string StepToString(const GLRStep &step) const;
+	void WriteTimestamp(GLQueueProfileContext &profile, std::string &&description);
 
 	GLRFramebuffer *curFB_ = nullptr;
 
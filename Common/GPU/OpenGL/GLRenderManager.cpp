@@ -6,6 +6,7 @@
 #include "Common/VR/PPSSPPVR.h"
 
 #include "Common/Log.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/TimeUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtils.h"
@@ -75,7 +76,15 @@ void GLRenderManager::ThreadStart(Draw::DrawContext *draw) {
 	// Notes on buffer mapping:
 	// NVIDIA GTX 9xx / 2017-10 drivers - mapping improves speed, basic unmap seems best.
 	// PowerVR GX6xxx / iOS 10.3 - mapping has little improvement, explicit flush is slower.
-	if (mapBuffers) {
+	// Mesa - the per-frame map/unmap is a large part of the CPU cost, persistent mapping avoids it.
+	// Not on Android, see the note about task switching below, which would be even worse with persistent mapping.
+	bool canPersistentMap = hasBufferStorage && (!gl_extensions.IsGLES || gl_extensions.VersionGEThan(3, 0, 0));
+#if PPSSPP_PLATFORM(ANDROID) || PPSSPP_PLATFORM(IOS)
+	canPersistentMap = false;
+#endif
+	if (canPersistentMap) {
+		bufferStrategy_ = GLBufferStrategy::PERSISTENT;
+	} else if (mapBuffers) {
 		switch (gl_extensions.gpuVendor) {
 		case GPU_VENDOR_NVIDIA:
 			bufferStrategy_ = GLBufferStrategy::FRAME_UNMAP;
@@ -104,11 +113,17 @@ void GLRenderManager::ThreadEnd() {
 	queueRunner_.DestroyDeviceObjects();
 	VLOG("  PULL: Quitting");
 
+	while (!pendingBufferFrames_.empty()) {
+		ReleaseFrameAfterFence(pendingBufferFrames_.front());
+		pendingBufferFrames_.pop();
+	}
+
 	// Good time to run all the deleters to get rid of leftover objects.
 	for (int i = 0; i < MAX_INFLIGHT_FRAMES; i++) {
 		// Since we're in shutdown, we should skip the GL calls on Android.
 		frameData_[i].deleter.Perform(this, skipGLCalls_);
 		frameData_[i].deleter_prev.Perform(this, skipGLCalls_);
+		queueRunner_.DestroyTimestamps(frameData_[i], skipGLCalls_);
 	}
 	deleter_.Perform(this, skipGLCalls_);
 	for (int i = 0; i < (int)steps_.size(); i++) {
@@ -118,6 +133,28 @@ void GLRenderManager::ThreadEnd() {
 	initSteps_.clear();
 }
 
+// Render thread. Waits for the frame's buffer fence, if any, then lets the emu thread reuse the frame.
+void GLRenderManager::ReleaseFrameAfterFence(int frame) {
+	GLFrameData &frameData = frameData_[frame];
+	if (frameData.bufferFence) {
+		if (!skipGLCalls_) {
+			// One second timeout, in case of driver trouble. Not much else we can do then.
+			glClientWaitSync(frameData.bufferFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+			glDeleteSync(frameData.bufferFence);
+		}
+		frameData.bufferFence = nullptr;
+	}
+
+	VLOG("  PULL: Frame %d.readyForFence = true", frame);
+
+	{
+		std::lock_guard<std::mutex> lock(frameData.fenceMutex);
+		frameData.readyForFence = true;
+		frameData.fenceCondVar.notify_one();
+		// At this point, we're done with this framedata (for now).
+	}
+}
+
 // Unlike in Vulkan, this isn't a full independent function, instead it gets called every frame.
 //
 // This means that we have to block and run the render queue until we've presented one frame,
@@ -396,7 +433,14 @@ void GLRenderManager::Finish() {
 	frameData_[curFrame].deleter.Take(deleter_);
 
 	if (frameData.profile.enabled) {
-		profilePassesString_ = std::move(frameData.profile.passesString);
+		profilePassesString_ = StringFromFormat("Uniforms: %d set, %d redundant skipped\nVertex attrib setups: %d set, %d redundant skipped\n\n",
+			frameData.profile.uniformsIssued, frameData.profile.uniformsSkipped,
+			frameData.profile.attribSetupsIssued, frameData.profile.attribSetupsSkipped);
+		profilePassesString_ += frameData.profile.passesString;
+		frameData.profile.uniformsIssued = 0;
+		frameData.profile.uniformsSkipped = 0;
+		frameData.profile.attribSetupsIssued = 0;
+		frameData.profile.attribSetupsSkipped = 0;
 
 #ifdef _DEBUG
 		std::string cmdString;
@@ -446,6 +490,7 @@ void GLRenderManager::Present() {
 
 // Render thread. Returns true if the caller should handle a swap.
 bool GLRenderManager::Run(GLRRenderThreadTask &task) {
+	TRACE_SCOPE("gl_run");
 	_dbg_assert_(task.frame >= 0);
 
 	GLFrameData &frameData = frameData_[task.frame];
@@ -471,13 +516,18 @@ bool GLRenderManager::Run(GLRRenderThreadTask &task) {
 		}
 		frameData.hasBegun = false;
 
-		VLOG("  PULL: Frame %d.readyForFence = true", task.frame);
-
-		{
-			std::lock_guard<std::mutex> lock(frameData.fenceMutex);
-			frameData.readyForFence = true;
-			frameData.fenceCondVar.notify_one();
-			// At this point, we're done with this framedata (for now).
+		if ((bufferStrategy_ & GLBufferStrategy::MASK_PERSISTENT) != 0 && !skipGLCalls_) {
+			// The emu thread will write straight into this frame's buffers as soon as it gets it back,
+			// so we can't hand it back until the GPU is done. It can't wait on GL fences itself, so we do it here,
+			// keeping inflightFrames_ - 1 frames outstanding.
+			frameData.bufferFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			pendingBufferFrames_.push(task.frame);
+			while ((int)pendingBufferFrames_.size() >= inflightFrames_) {
+				ReleaseFrameAfterFence(pendingBufferFrames_.front());
+				pendingBufferFrames_.pop();
+			}
+		} else {
+			ReleaseFrameAfterFence(task.frame);
 		}
 		return swapRequest;
 	}
@@ -487,6 +537,10 @@ bool GLRenderManager::Run(GLRRenderThreadTask &task) {
 
 		frameData.deleter_prev.Perform(this, skipGLCalls_);
 		frameData.deleter_prev.Take(frameData.deleter);
+
+		if (!skipGLCalls_) {
+			queueRunner_.BeginTimestamps(frameData);
+		}
 	}
 
 	// queueRunner_.LogSteps(stepsOnThread);
@@ -506,6 +560,13 @@ bool GLRenderManager::Run(GLRRenderThreadTask &task) {
 
 	if (IsVREnabled()) {
 		int passes = GetVRPassesCount();
+		// If nothing in the frame differs between the eyes (2D, menus, flat scenes),
+		// render it once and let the compositor show the same image to both eyes.
+		bool singlePass = passes > 1 && !GLQueueRunner::StepsNeedStereo(task.steps);
+		if (singlePass) {
+			passes = 1;
+		}
+		SetVRSinglePass(singlePass);
 		for (int i = 0; i < passes; i++) {
 			PreVRFrameRender(i);
 			queueRunner_.RunSteps(task.steps, frameData, skipGLCalls_, i < passes - 1, true);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstring>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -103,6 +105,14 @@ struct GLRProgramFlags {
 	bool useClipDistance0 : 1;
 	bool useClipDistance1 : 1;
 	bool useClipDistance2 : 1;
+	// Keep the linked binary around, see GLRProgram::GetBinary().
+	bool retrieveBinary : 1;
+};
+
+// A linked program from glGetProgramBinary, only valid for the same driver.
+struct GLRProgramBinary {
+	GLenum format = 0;
+	std::vector<uint8_t> data;
 };
 
 // Unless you manage lifetimes in some smart way,
@@ -169,16 +179,48 @@ class GLRProgram {
 		return loc;
 	}
 
+	// Must ONLY be called from GLQueueRunner, with this program bound.
+	// Remembers uniform values set through the 4-component commands, and returns false if the value is already set.
+	// Uniform values belong to the program object, so unlike other state this stays valid across passes.
+	bool UniformChanged(int loc, const float *v, int count) {
+		if ((unsigned)loc >= ARRAY_SIZE(uniformValues_))
+			return true;
+		UniformValue &cached = uniformValues_[loc];
+		if (cached.count == count && memcmp(cached.v, v, count * sizeof(float)) == 0)
+			return false;
+		cached.count = count;
+		memcpy(cached.v, v, count * sizeof(float));
+		return true;
+	}
+
 	void SetDeleteCallback(void(*cb)(void *), void *p) {
 		deleteCallback_ = cb;
 		deleteParam_ = p;
 	}
 
+	// The binary it was created from, or retrieved after linking, once the render thread has created it.
+	// Null if there isn't one (yet.)
+	const GLRProgramBinary *GetBinary() const {
+		return binaryReady_.load(std::memory_order_acquire) ? &binary_ : nullptr;
+	}
+
+	// If set when created, the render thread tries this before linking the shaders.
+	GLRProgramBinary binary_;
+	std::atomic<bool> binaryReady_{};
+	bool retrieveBinary_ = false;
+
 private:
 	void(*deleteCallback_)(void *) = nullptr;
 	void *deleteParam_ = nullptr;
 
 	std::unordered_map<std::string, UniformInfo> uniformCache_;
+
+	struct UniformValue {
+		float v[4];
+		int count;  // 0 if unknown.
+	};
+	// Indexed by location. Most drivers hand out small consecutive locations, others just don't get the filtering.
+	UniformValue uniformValues_[32]{};
 };
 
 class GLRInputLayout {
@@ -300,7 +342,7 @@ class GLRenderManager {
 	// not be an active render pass.
 	GLRProgram *CreateProgram(
 		std::vector<GLRShader *> shaders, std::vector<GLRProgram::Semantic> semantics, std::vector<GLRProgram::UniformLocQuery> queries,
-		std::vector<GLRProgram::Initializer> initializers, GLRProgramLocData *locData, const GLRProgramFlags &flags) {
+		std::vector<GLRProgram::Initializer> initializers, GLRProgramLocData *locData, const GLRProgramFlags &flags, GLRProgramBinary *binary = nullptr) {
 		GLRInitStep &step = initSteps_.push_uninitialized();
 		step.stepType = GLRInitStepType::CREATE_PROGRAM;
 		_assert_(shaders.size() <= ARRAY_SIZE(step.create_program.shaders));
@@ -312,6 +354,9 @@ class GLRenderManager {
 		step.create_program.program->use_clip_distance[0] = flags.useClipDistance0;
 		step.create_program.program->use_clip_distance[1] = flags.useClipDistance1;
 		step.create_program.program->use_clip_distance[2] = flags.useClipDistance2;
+		step.create_program.program->retrieveBinary_ = flags.retrieveBinary;
+		if (binary)
+			step.create_program.program->binary_ = std::move(*binary);
 		step.create_program.support_dual_source = flags.supportDualSource;
 		_assert_msg_(shaders.size() > 0, "Can't create a program with zero shaders");
 		for (size_t i = 0; i < shaders.size(); i++) {
@@ -848,6 +893,7 @@ class GLRenderManager {
 
 private:
 	bool Run(GLRRenderThreadTask &task);
+	void ReleaseFrameAfterFence(int frame);
 
 	// Bad for performance but sometimes necessary for synchronous CPU readbacks (screenshots and whatnot).
 	void FlushSync();
@@ -896,6 +942,8 @@ class GLRenderManager {
 	std::function<void()> swapFunction_;
 	std::function<void(int)> swapIntervalFunction_;
 	GLBufferStrategy bufferStrategy_ = GLBufferStrategy::SUBDATA;
+	// Presented frames whose fences we haven't waited for yet, oldest first (PERSISTENT strategy only).
+	std::queue<int> pendingBufferFrames_;
 
 	int inflightFrames_ = MAX_INFLIGHT_FRAMES;
 	int newInflightFrames_ = -1;
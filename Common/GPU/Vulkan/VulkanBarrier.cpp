@@ -15,6 +15,8 @@ VulkanBarrierBatch::~VulkanBarrierBatch() {
 void VulkanBarrierBatch::Flush(VkCommandBuffer cmd) {
 	if (!imageBarriers_.empty()) {
 		vkCmdPipelineBarrier(cmd, srcStageMask_, dstStageMask_, dependencyFlags_, 0, nullptr, 0, nullptr, (uint32_t)imageBarriers_.size(), imageBarriers_.data());
+		stats_.pipelineBarriers++;
+		stats_.imageBarriers += (int)imageBarriers_.size();
 	}
 	imageBarriers_.clear();
 	srcStageMask_ = 0;
@@ -22,6 +24,17 @@ void VulkanBarrierBatch::Flush(VkCommandBuffer cmd) {
 	dependencyFlags_ = 0;
 }
 
+// Going between two read-only uses of the same layout doesn't need a barrier at all.
+static bool IsReadOnlyLayout(VkImageLayout layout) {
+	switch (layout) {
+	case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+	case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void VulkanBarrierBatch::TransitionImage(
 	VkImage image, int baseMip, int numMipLevels, int numLayers, VkImageAspectFlags aspectMask,
 	VkImageLayout oldImageLayout, VkImageLayout newImageLayout,
@@ -54,6 +67,10 @@ void VulkanBarrierBatch::TransitionImage(
 void VulkanBarrierBatch::TransitionColorImageAuto(
 	VkImage image, VkImageLayout *imageLayout, VkImageLayout newImageLayout, int baseMip, int numMipLevels, int numLayers) {
 	_dbg_assert_(image != VK_NULL_HANDLE);
+	if (*imageLayout == newImageLayout && IsReadOnlyLayout(newImageLayout)) {
+		stats_.skipped++;
+		return;
+	}
 	VkAccessFlags srcAccessMask = 0;
 	VkAccessFlags dstAccessMask = 0;
 	switch (*imageLayout) {
@@ -132,6 +149,10 @@ void VulkanBarrierBatch::TransitionColorImageAuto(
 void VulkanBarrierBatch::TransitionDepthStencilImageAuto(
 	VkImage image, VkImageLayout *imageLayout, VkImageLayout newImageLayout, int baseMip, int numMipLevels, int numLayers) {
 	_dbg_assert_(image != VK_NULL_HANDLE);
+	if (*imageLayout == newImageLayout && IsReadOnlyLayout(newImageLayout)) {
+		stats_.skipped++;
+		return;
+	}
 
 	VkAccessFlags srcAccessMask = 0;
 	VkAccessFlags dstAccessMask = 0;
@@ -172,7 +193,7 @@ void VulkanBarrierBatch::TransitionDepthStencilImageAuto(
 		dstStageMask_ |= VK_PIPELINE_STAGE_TRANSFER_BIT;
 		break;
 	case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-		dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 		dstStageMask_ |= VK_PIPELINE_STAGE_TRANSFER_BIT;
 		break;
 	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
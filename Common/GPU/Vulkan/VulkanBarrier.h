@@ -54,8 +54,19 @@ class VulkanBarrierBatch {
 
 	void Flush(VkCommandBuffer cmd);
 
+	// Debug statistics: pipeline barrier calls and image barriers actually recorded, and
+	// transitions that were skipped since nothing needed to be synchronized.
+	struct Stats {
+		int pipelineBarriers;
+		int imageBarriers;
+		int skipped;
+	};
+	const Stats &GetStats() const { return stats_; }
+	void ResetStats() { stats_ = {}; }
+
 private:
 	FastVec<VkImageMemoryBarrier> imageBarriers_;
+	Stats stats_{};
 	VkPipelineStageFlags srcStageMask_ = 0;
 	VkPipelineStageFlags dstStageMask_ = 0;
 	VkDependencyFlags dependencyFlags_ = 0;
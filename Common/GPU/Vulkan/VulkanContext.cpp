@@ -330,12 +330,41 @@ void VulkanContext::BeginFrame(VkCommandBuffer firstCommandBuffer) {
 	FrameData *frame = &frame_[curFrame_];
 	// Process pending deletes.
 	frame->deleteList.PerformDeletes(this, allocator_);
+	UpdateMemoryBudget();
 	// VK_NULL_HANDLE when profiler is disabled.
 	if (firstCommandBuffer) {
 		frame->profiler.BeginFrame(this, firstCommandBuffer);
 	}
 }
 
+void VulkanContext::UpdateMemoryBudget() {
+	// With VK_EXT_memory_budget, this makes VMA refetch the driver's numbers. Without it, VMA
+	// estimates the budget as 80% of the heap size, which is still useful.
+	vmaSetCurrentFrameIndex(allocator_, ++budgetFrameIndex_);
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetHeapBudgets(allocator_, budgets);
+
+	uint64_t usage = 0;
+	uint64_t budget = 0;
+	for (uint32_t i = 0; i < memory_properties_.memoryHeapCount; i++) {
+		// Textures and framebuffers live in device local memory, that's what we care about running out of.
+		if (memory_properties_.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+			usage += budgets[i].usage;
+			budget += budgets[i].budget;
+		}
+	}
+	deviceLocalUsage_ = usage;
+	deviceLocalBudget_ = budget;
+}
+
+bool VulkanContext::IsUnderMemoryPressure() const {
+	if (deviceLocalBudget_ == 0)
+		return false;
+	// Start trimming a bit before we hit the limit, allocations tend to come in bursts.
+	return deviceLocalUsage_ > deviceLocalBudget_ - deviceLocalBudget_ / 10;
+}
+
 void VulkanContext::EndFrame() {
 	frame_[curFrame_].deleteList.Take(globalDeleteList_);
 	curFrame_++;
@@ -355,6 +384,8 @@ void VulkanContext::UpdateInflightFrames(int n) {
 void VulkanContext::WaitUntilQueueIdle() {
 	// Should almost never be used
 	vkQueueWaitIdle(gfx_queue_);
+	if (compute_queue_ != VK_NULL_HANDLE)
+		vkQueueWaitIdle(compute_queue_);
 }
 
 bool VulkanContext::MemoryTypeFromProperties(uint32_t typeBits, VkFlags requirements_mask, uint32_t *typeIndex) {
@@ -668,6 +699,22 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 	}
 	_dbg_assert_(found);
 
+	// Prefer a family without graphics for compute, that's the one that runs in parallel with rendering.
+	VkDeviceQueueCreateInfo queue_infos[2]{ queue_info, { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO } };
+	uint32_t queueInfoCount = 1;
+	compute_queue_family_index_ = -1;
+	for (int i = 0; i < (int)queue_count; i++) {
+		VkQueueFlags flags = queueFamilyProperties_[i].queueFlags;
+		if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && queueFamilyProperties_[i].queueCount > 0) {
+			compute_queue_family_index_ = i;
+			queue_infos[1].queueFamilyIndex = i;
+			queue_infos[1].queueCount = 1;
+			queue_infos[1].pQueuePriorities = queue_priorities;
+			queueInfoCount = 2;
+			break;
+		}
+	}
+
 	// TODO: A lot of these are on by default in later Vulkan versions, should check for that, technically.
 	extensionsLookup_.KHR_maintenance1 = EnableDeviceExtension(VK_KHR_MAINTENANCE1_EXTENSION_NAME, VK_API_VERSION_1_1);
 	extensionsLookup_.KHR_maintenance2 = EnableDeviceExtension(VK_KHR_MAINTENANCE2_EXTENSION_NAME, VK_API_VERSION_1_1);
@@ -697,6 +744,8 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 	}
 
 	extensionsLookup_.EXT_provoking_vertex = EnableDeviceExtension(VK_EXT_PROVOKING_VERTEX_EXTENSION_NAME, 0);
+	extensionsLookup_.EXT_extended_dynamic_state = EnableDeviceExtension(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME, 0);
+	extensionsLookup_.EXT_memory_budget = EnableDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, 0);
 
 	// Optional features
 	if (extensionsLookup_.KHR_get_physical_device_properties2 && vkGetPhysicalDeviceFeatures2) {
@@ -706,6 +755,7 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
 		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
 		VkPhysicalDeviceProvokingVertexFeaturesEXT provokingVertexFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROVOKING_VERTEX_FEATURES_EXT };
+		VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT };
 
 		ChainStruct(features2, &multiViewFeatures);
 		if (extensionsLookup_.KHR_present_wait) {
@@ -717,6 +767,9 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 		if (extensionsLookup_.EXT_provoking_vertex) {
 			ChainStruct(features2, &provokingVertexFeatures);
 		}
+		if (extensionsLookup_.EXT_extended_dynamic_state) {
+			ChainStruct(features2, &extendedDynamicStateFeatures);
+		}
 		vkGetPhysicalDeviceFeatures2(physical_devices_[physical_device_], &features2);
 		deviceFeatures_.available.standard = features2.features;
 		deviceFeatures_.available.multiview = multiViewFeatures;
@@ -729,9 +782,13 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 		if (extensionsLookup_.EXT_provoking_vertex) {
 			deviceFeatures_.available.provokingVertex = provokingVertexFeatures;
 		}
+		if (extensionsLookup_.EXT_extended_dynamic_state) {
+			deviceFeatures_.available.extendedDynamicState = extendedDynamicStateFeatures;
+		}
 	} else {
 		vkGetPhysicalDeviceFeatures(physical_devices_[physical_device_], &deviceFeatures_.available.standard);
 		deviceFeatures_.available.multiview = {};
+		deviceFeatures_.available.extendedDynamicState = {};
 	}
 
 	deviceFeatures_.enabled = {};
@@ -768,14 +825,18 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 	if (extensionsLookup_.EXT_provoking_vertex) {
 		deviceFeatures_.enabled.provokingVertex.provokingVertexLast = true;
 	}
+	deviceFeatures_.enabled.extendedDynamicState = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT };
+	if (extensionsLookup_.EXT_extended_dynamic_state) {
+		deviceFeatures_.enabled.extendedDynamicState.extendedDynamicState = deviceFeatures_.available.extendedDynamicState.extendedDynamicState;
+	}
 
 	// deviceFeatures_.enabled.multiview.multiviewGeometryShader = deviceFeatures_.available.multiview.multiviewGeometryShader;
 
 	VkPhysicalDeviceFeatures2 features2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
 
 	VkDeviceCreateInfo device_info{ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
-	device_info.queueCreateInfoCount = 1;
-	device_info.pQueueCreateInfos = &queue_info;
+	device_info.queueCreateInfoCount = queueInfoCount;
+	device_info.pQueueCreateInfos = queue_infos;
 	device_info.enabledLayerCount = (uint32_t)device_layer_names_.size();
 	device_info.ppEnabledLayerNames = device_info.enabledLayerCount ? device_layer_names_.data() : nullptr;
 	device_info.enabledExtensionCount = (uint32_t)device_extensions_enabled_.size();
@@ -794,6 +855,9 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 		if (extensionsLookup_.EXT_provoking_vertex) {
 			ChainStruct(features2, &deviceFeatures_.enabled.provokingVertex);
 		}
+		if (extensionsLookup_.EXT_extended_dynamic_state) {
+			ChainStruct(features2, &deviceFeatures_.enabled.extendedDynamicState);
+		}
 	} else {
 		device_info.pEnabledFeatures = &deviceFeatures_.enabled.standard;
 	}
@@ -804,6 +868,11 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 		ERROR_LOG(Log::G3D, "%s", init_error_.c_str());
 	} else {
 		VulkanLoadDeviceFunctions(device_, extensionsLookup_, vulkanDeviceApiVersion_);
+		compute_queue_ = VK_NULL_HANDLE;
+		if (queueInfoCount == 2) {
+			vkGetDeviceQueue(device_, compute_queue_family_index_, 0, &compute_queue_);
+			INFO_LOG(Log::G3D, "Using queue family %d for async compute", compute_queue_family_index_);
+		}
 	}
 	INFO_LOG(Log::G3D, "Vulkan Device created: %s", physicalDeviceProperties_[physical_device_].properties.deviceName);
 
@@ -815,6 +884,10 @@ VkResult VulkanContext::CreateDevice(int physical_device) {
 	allocatorInfo.physicalDevice = physical_devices_[physical_device_];
 	allocatorInfo.device = device_;
 	allocatorInfo.instance = instance_;
+	// VMA needs vkGetPhysicalDeviceMemoryProperties2 to query the budget, which we only load on 1.1+.
+	if (extensionsLookup_.EXT_memory_budget && allocatorInfo.vulkanApiVersion >= VK_API_VERSION_1_1 && vkGetPhysicalDeviceMemoryProperties2) {
+		allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+	}
 	VkResult result = vmaCreateAllocator(&allocatorInfo, &allocator_);
 	_assert_(result == VK_SUCCESS);
 	_assert_(allocator_ != VK_NULL_HANDLE);
@@ -1556,6 +1629,7 @@ void VulkanContext::DestroyDevice() {
 
 	vkDestroyDevice(device_, nullptr);
 	device_ = nullptr;
+	compute_queue_ = VK_NULL_HANDLE;
 }
 
 bool VulkanContext::CreateShaderModule(const std::vector<uint32_t> &spirv, VkShaderModule *shaderModule, const char *tag) {
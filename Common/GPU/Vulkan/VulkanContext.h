@@ -233,6 +233,12 @@ class VulkanContext {
 	void BeginFrame(VkCommandBuffer firstCommandBuffer);
 	void EndFrame();
 
+	// Device local heap usage and budget, refreshed every frame in BeginFrame.
+	uint64_t GetDeviceLocalMemoryUsage() const { return deviceLocalUsage_; }
+	uint64_t GetDeviceLocalMemoryBudget() const { return deviceLocalBudget_; }
+	// True when we're close enough to the budget that caches should start shrinking.
+	bool IsUnderMemoryPressure() const;
+
 	VulkanProfiler *GetProfiler() {
 		return &frame_[curFrame_].profiler;
 	}
@@ -272,6 +278,17 @@ class VulkanContext {
 		return graphics_queue_family_index_;
 	}
 
+	// A compute-only queue family, if the device has one. Work on it can overlap with rendering.
+	bool HasAsyncComputeQueue() const {
+		return compute_queue_ != VK_NULL_HANDLE;
+	}
+	VkQueue GetComputeQueue() const {
+		return compute_queue_;
+	}
+	int GetComputeQueueFamilyIndex() const {
+		return compute_queue_family_index_;
+	}
+
 	struct PhysicalDeviceProps {
 		VkPhysicalDeviceProperties properties;
 		VkPhysicalDevicePushDescriptorPropertiesKHR pushDescriptorProperties;
@@ -285,6 +302,7 @@ class VulkanContext {
 		VkPhysicalDevicePresentWaitFeaturesKHR presentWait;
 		VkPhysicalDevicePresentIdFeaturesKHR presentId;
 		VkPhysicalDeviceProvokingVertexFeaturesEXT provokingVertex;
+		VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicState;
 	};
 
 	const PhysicalDeviceProps &GetPhysicalDeviceProperties(int i = -1) const {
@@ -425,6 +443,7 @@ class VulkanContext {
 
 private:
 	bool ChooseQueue();
+	void UpdateMemoryBudget();
 
 	void SetDebugNameImpl(uint64_t handle, VkObjectType type, const char *name);
 
@@ -449,6 +468,7 @@ class VulkanContext {
 	VkInstance instance_ = VK_NULL_HANDLE;
 	VkDevice device_ = VK_NULL_HANDLE;
 	VkQueue gfx_queue_ = VK_NULL_HANDLE;
+	VkQueue compute_queue_ = VK_NULL_HANDLE;
 	VkSurfaceKHR surface_ = VK_NULL_HANDLE;
 	u32 vulkanInstanceApiVersion_ = 0;
 	u32 vulkanDeviceApiVersion_ = 0;
@@ -472,6 +492,7 @@ class VulkanContext {
 	int physical_device_ = -1;
 
 	uint32_t graphics_queue_family_index_ = -1;
+	uint32_t compute_queue_family_index_ = -1;
 	std::vector<PhysicalDeviceProps> physicalDeviceProperties_;
 	std::vector<VkQueueFamilyProperties> queueFamilyProperties_;
 
@@ -496,6 +517,10 @@ class VulkanContext {
 	FrameData frame_[MAX_INFLIGHT_FRAMES];
 	int curFrame_ = 0;
 
+	uint32_t budgetFrameIndex_ = 0;
+	uint64_t deviceLocalUsage_ = 0;
+	uint64_t deviceLocalBudget_ = 0;
+
 	// At the end of the frame, this is copied into the frame's delete list, so it can be processed
 	// the next time the frame comes around again.
 	VulkanDeleteList globalDeleteList_;
@@ -3,6 +3,7 @@
 #include "VulkanFrameData.h"
 #include "Common/Log.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 
 #if 0 // def _DEBUG
 #define VLOG(...) NOTICE_LOG(Log::G3D, __VA_ARGS__)
@@ -51,6 +52,18 @@ void FrameData::Init(VulkanContext *vulkan, int index) {
 	vulkan->SetDebugName(mainCmd, VK_OBJECT_TYPE_COMMAND_BUFFER, StringFromFormat("mainCmd%d", index).c_str());
 	vulkan->SetDebugName(presentCmd, VK_OBJECT_TYPE_COMMAND_BUFFER, StringFromFormat("presentCmd%d", index).c_str());
 
+	if (vulkan->HasAsyncComputeQueue()) {
+		res = vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &computeCompleteSemaphore);
+		_dbg_assert_(res == VK_SUCCESS);
+		cmd_pool_info.queueFamilyIndex = vulkan->GetComputeQueueFamilyIndex();
+		res = vkCreateCommandPool(device, &cmd_pool_info, nullptr, &cmdPoolCompute);
+		_dbg_assert_(res == VK_SUCCESS);
+		cmd_alloc.commandPool = cmdPoolCompute;
+		res = vkAllocateCommandBuffers(device, &cmd_alloc, &computeCmd);
+		_dbg_assert_(res == VK_SUCCESS);
+		vulkan->SetDebugName(computeCmd, VK_OBJECT_TYPE_COMMAND_BUFFER, StringFromFormat("computeCmd%d", index).c_str());
+	}
+
 	// Creating the frame fence with true so they can be instantly waited on the first frame
 	fence = vulkan->CreateFence(true);
 	vulkan->SetDebugName(fence, VK_OBJECT_TYPE_FENCE, StringFromFormat("fence%d", index).c_str());
@@ -66,6 +79,20 @@ void FrameData::Destroy(VulkanContext *vulkan) {
 	VkDevice device = vulkan->GetDevice();
 	vkDestroyCommandPool(device, cmdPoolInit, nullptr);
 	vkDestroyCommandPool(device, cmdPoolMain, nullptr);
+	if (cmdPoolCompute != VK_NULL_HANDLE) {
+		vkDestroyCommandPool(device, cmdPoolCompute, nullptr);
+		vkDestroySemaphore(device, computeCompleteSemaphore, nullptr);
+		cmdPoolCompute = VK_NULL_HANDLE;
+		computeCmd = VK_NULL_HANDLE;
+		computeCompleteSemaphore = VK_NULL_HANDLE;
+	}
+	for (auto &secondary : secondaryPools) {
+		if (secondary.pool != VK_NULL_HANDLE)
+			vkDestroyCommandPool(device, secondary.pool, nullptr);
+		secondary.pool = VK_NULL_HANDLE;
+		secondary.cmds.clear();
+		secondary.used = 0;
+	}
 	vkDestroyFence(device, fence, nullptr);
 	vkDestroyQueryPool(device, profile.queryPool, nullptr);
 	vkDestroySemaphore(device, acquireSemaphore, nullptr);
@@ -76,6 +103,7 @@ void FrameData::Destroy(VulkanContext *vulkan) {
 		delete value;
 	});
 	readbacks_.Clear();
+	deferredReadbacks_.clear();
 }
 
 void FrameData::AcquireNextImage(VulkanContext *vulkan) {
@@ -169,12 +197,84 @@ VkCommandBuffer FrameData::GetInitCmd(VulkanContext *vulkan) {
 	return initCmd;
 }
 
+VkCommandBuffer FrameData::GetComputeCmd(VulkanContext *vulkan) {
+	if (computeCmd == VK_NULL_HANDLE)
+		return VK_NULL_HANDLE;
+	if (!hasComputeCommands) {
+		VkCommandBufferBeginInfo begin = {
+			VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			nullptr,
+			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+		};
+		vkResetCommandPool(vulkan->GetDevice(), cmdPoolCompute, 0);
+		VkResult res = vkBeginCommandBuffer(computeCmd, &begin);
+		if (res != VK_SUCCESS) {
+			return VK_NULL_HANDLE;
+		}
+		hasComputeCommands = true;
+	}
+	return computeCmd;
+}
+
+VkCommandBuffer FrameData::GetSecondaryCmd(VulkanContext *vulkan, int slot) {
+	_dbg_assert_(slot >= 0 && slot < MAX_SECONDARY_CMD_POOLS);
+	SecondaryCmdPool &secondary = secondaryPools[slot];
+	VkDevice device = vulkan->GetDevice();
+	if (secondary.pool == VK_NULL_HANDLE) {
+		VkCommandPoolCreateInfo cmd_pool_info = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		cmd_pool_info.queueFamilyIndex = vulkan->GetGraphicsQueueFamilyIndex();
+		cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		VkResult res = vkCreateCommandPool(device, &cmd_pool_info, nullptr, &secondary.pool);
+		_assert_msg_(res == VK_SUCCESS, "vkCreateCommandPool failed (secondary)! result=%s", VulkanResultToString(res));
+	}
+
+	// The pool might be used several times before it's reset (sync readbacks), so can't reuse buffers until then.
+	if (secondary.used == secondary.cmds.size()) {
+		VkCommandBufferAllocateInfo cmd_alloc = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		cmd_alloc.commandPool = secondary.pool;
+		cmd_alloc.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		cmd_alloc.commandBufferCount = 1;
+		VkCommandBuffer cmd = VK_NULL_HANDLE;
+		VkResult res = vkAllocateCommandBuffers(device, &cmd_alloc, &cmd);
+		_assert_msg_(res == VK_SUCCESS, "vkAllocateCommandBuffers failed (secondary)! result=%s", VulkanResultToString(res));
+		vulkan->SetDebugName(cmd, VK_OBJECT_TYPE_COMMAND_BUFFER, StringFromFormat("secondaryCmd%d_%d_%d", index, slot, (int)secondary.cmds.size()).c_str());
+		secondary.cmds.push_back(cmd);
+	}
+	return secondary.cmds[secondary.used++];
+}
+
+void FrameData::ResetSecondaryCmdPools(VulkanContext *vulkan) {
+	for (auto &secondary : secondaryPools) {
+		if (secondary.used != 0) {
+			vkResetCommandPool(vulkan->GetDevice(), secondary.pool, 0);
+			secondary.used = 0;
+		}
+	}
+}
+
 void FrameData::Submit(VulkanContext *vulkan, FrameSubmitType type, FrameDataShared &sharedData) {
 	VkCommandBuffer cmdBufs[3];
 	int numCmdBufs = 0;
 
 	VkFence fenceToTrigger = VK_NULL_HANDLE;
 
+	// Compute work goes first, on its own queue. It may overlap with the previous frame still rendering.
+	bool waitForCompute = false;
+	if (hasComputeCommands) {
+		VkResult res = vkEndCommandBuffer(computeCmd);
+		_assert_msg_(res == VK_SUCCESS, "vkEndCommandBuffer failed (compute)! result=%s", VulkanResultToString(res));
+		hasComputeCommands = false;
+
+		VkSubmitInfo compute_info{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		compute_info.commandBufferCount = 1;
+		compute_info.pCommandBuffers = &computeCmd;
+		compute_info.signalSemaphoreCount = 1;
+		compute_info.pSignalSemaphores = &computeCompleteSemaphore;
+		res = vkQueueSubmit(vulkan->GetComputeQueue(), 1, &compute_info, VK_NULL_HANDLE);
+		_assert_msg_(res == VK_SUCCESS, "vkQueueSubmit failed (compute)! result=%s", VulkanResultToString(res));
+		waitForCompute = true;
+	}
+
 	if (hasInitCommands) {
 		if (profile.enabled) {
 			// Pre-allocated query ID 1 - end of init cmdbuf.
@@ -215,18 +315,30 @@ void FrameData::Submit(VulkanContext *vulkan, FrameSubmitType type, FrameDataSha
 		fenceToTrigger = fence;
 	}
 
-	if (!numCmdBufs && fenceToTrigger == VK_NULL_HANDLE) {
+	// The compute semaphore must always be waited on, even if there's nothing else to submit.
+	if (!numCmdBufs && fenceToTrigger == VK_NULL_HANDLE && !waitForCompute) {
 		// Nothing to do.
 		return;
 	}
 
 	VkSubmitInfo submit_info{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-	VkPipelineStageFlags waitStage[1]{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	VkSemaphore waitSemaphores[2];
+	VkPipelineStageFlags waitStages[2];
+	uint32_t numWaitSemaphores = 0;
+	if (waitForCompute) {
+		// The init commands finish creating the images right away, so wait for everything.
+		waitSemaphores[numWaitSemaphores] = computeCompleteSemaphore;
+		waitStages[numWaitSemaphores++] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	}
 	if (type == FrameSubmitType::FinishFrame && !skipSwap) {
 		_dbg_assert_(hasAcquired);
-		submit_info.waitSemaphoreCount = 1;
-		submit_info.pWaitSemaphores = &acquireSemaphore;
-		submit_info.pWaitDstStageMask = waitStage;
+		waitSemaphores[numWaitSemaphores] = acquireSemaphore;
+		waitStages[numWaitSemaphores++] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	}
+	if (numWaitSemaphores) {
+		submit_info.waitSemaphoreCount = numWaitSemaphores;
+		submit_info.pWaitSemaphores = waitSemaphores;
+		submit_info.pWaitDstStageMask = waitStages;
 	}
 	submit_info.commandBufferCount = (uint32_t)numCmdBufs;
 	submit_info.pCommandBuffers = cmdBufs;
@@ -235,6 +347,10 @@ void FrameData::Submit(VulkanContext *vulkan, FrameSubmitType type, FrameDataSha
 		submit_info.pSignalSemaphores = &renderingCompleteSemaphore;
 	}
 
+	if (profile.timestampsEnabled && numCmdBufs && !profile.firstSubmitNanos) {
+		profile.firstSubmitNanos = time_now_raw();
+	}
+
 	VkResult res;
 	if (fenceToTrigger == fence) {
 		VLOG("Doing queue submit, fencing frame %d", this->index);
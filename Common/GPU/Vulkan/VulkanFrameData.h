@@ -6,10 +6,13 @@
 #include <condition_variable>
 
 #include "Common/GPU/Vulkan/VulkanContext.h"
+#include "Common/GPU/DataFormat.h"
 #include "Common/Data/Collections/Hashmaps.h"
 
 enum {
 	MAX_TIMESTAMP_QUERIES = 128,
+	// Max number of render passes recorded in parallel in one run of the queue.
+	MAX_SECONDARY_CMD_POOLS = 8,
 };
 
 enum class VKRRunType {
@@ -28,8 +31,13 @@ struct QueueProfileContext {
 	double cpuStartTime;
 	double cpuEndTime;
 	double descWriteTime;
+	// For Tracer, right before the first submit of the frame.  Can't be later than the first timestamp.
+	uint64_t firstSubmitNanos;
 	int descriptorsWritten;
 	int descriptorsDeduped;
+	int pipelineBarriers;
+	int imageBarriers;
+	int barriersSkipped;
 #ifdef _DEBUG
 	int commandCounts[11];
 #endif
@@ -52,6 +60,15 @@ struct CachedReadback {
 	void Destroy(VulkanContext *vulkan);
 };
 
+// A ReadbackMode::DEFERRED readback, copied out of the cached readback buffer once the frame's fence has been waited on.
+struct DeferredReadback {
+	ReadbackKey key;
+	Draw::DataFormat srcFormat;
+	Draw::DataFormat destFormat;
+	int pixelStride;
+	uint8_t *pixels;
+};
+
 struct FrameDataShared {
 	// For synchronous readbacks.
 	VkFence readbackFence = VK_NULL_HANDLE;
@@ -68,6 +85,13 @@ enum class FrameSubmitType {
 	FinishFrame,
 };
 
+// Command buffers for render passes recorded on worker threads. Each pool is only used by one task at a time.
+struct SecondaryCmdPool {
+	VkCommandPool pool = VK_NULL_HANDLE;
+	std::vector<VkCommandBuffer> cmds;
+	size_t used = 0;
+};
+
 // Per-frame data, round-robin so we can overlap submission with execution of the previous frame.
 struct FrameData {
 	bool skipSwap = false;
@@ -79,16 +103,24 @@ struct FrameData {
 	VkFence fence = VK_NULL_HANDLE;
 	VkSemaphore acquireSemaphore = VK_NULL_HANDLE;
 	VkSemaphore renderingCompleteSemaphore = VK_NULL_HANDLE;
+	// Signalled by the async compute submit, the graphics submit right after waits for it.
+	VkSemaphore computeCompleteSemaphore = VK_NULL_HANDLE;
 
 	// These are on different threads so need separate pools.
 	VkCommandPool cmdPoolInit = VK_NULL_HANDLE;  // Written to from main thread
 	VkCommandPool cmdPoolMain = VK_NULL_HANDLE;  // Written to from render thread, which also submits
+	VkCommandPool cmdPoolCompute = VK_NULL_HANDLE;  // Written to from main thread, only with an async compute queue
+
+	// Same lifetime as mainCmd, reset together with cmdPoolMain.
+	SecondaryCmdPool secondaryPools[MAX_SECONDARY_CMD_POOLS];
 
 	VkCommandBuffer initCmd = VK_NULL_HANDLE;
 	VkCommandBuffer mainCmd = VK_NULL_HANDLE;
 	VkCommandBuffer presentCmd = VK_NULL_HANDLE;
+	VkCommandBuffer computeCmd = VK_NULL_HANDLE;
 
 	bool hasInitCommands = false;
+	bool hasComputeCommands = false;
 	bool hasMainCommands = false;
 	bool hasPresentCommands = false;
 
@@ -109,6 +141,8 @@ struct FrameData {
 
 	// Async readback cache.
 	DenseHashMap<ReadbackKey, CachedReadback *> readbacks_;
+	// Readbacks from readbacks_ that still need to be written to their destination.
+	std::vector<DeferredReadback> deferredReadbacks_;
 
 	FrameData() : readbacks_(8) {}
 
@@ -120,6 +154,12 @@ struct FrameData {
 
 	// Generally called from the main thread, unlike most of the rest.
 	VkCommandBuffer GetInitCmd(VulkanContext *vulkan);
+	// Runs on the async compute queue before the init commands. VK_NULL_HANDLE if there's no such queue.
+	VkCommandBuffer GetComputeCmd(VulkanContext *vulkan);
+
+	// Called from the render thread, the returned command buffer can then be recorded on any thread.
+	VkCommandBuffer GetSecondaryCmd(VulkanContext *vulkan, int slot);
+	void ResetSecondaryCmdPools(VulkanContext *vulkan);
 
 	// Submits pending command buffers.
 	void Submit(VulkanContext *vulkan, FrameSubmitType type, FrameDataShared &shared);
@@ -38,7 +38,7 @@ static bool IsDepthStencilFormat(VkFormat format) {
 	}
 }
 
-bool VulkanTexture::CreateDirect(int w, int h, int depth, int numMips, VkFormat format, VkImageLayout initialLayout, VkImageUsageFlags usage, VulkanBarrierBatch *barrierBatch, const VkComponentMapping *mapping) {
+bool VulkanTexture::CreateDirect(int w, int h, int depth, int numMips, VkFormat format, VkImageLayout initialLayout, VkImageUsageFlags usage, VulkanBarrierBatch *barrierBatch, const VkComponentMapping *mapping, bool shareWithComputeQueue) {
 	if (w == 0 || h == 0 || numMips == 0) {
 		ERROR_LOG(Log::G3D, "Can't create a zero-size VulkanTexture");
 		return false;
@@ -82,6 +82,15 @@ bool VulkanTexture::CreateDirect(int w, int h, int depth, int numMips, VkFormat
 	if (vulkan_->GetFlags() & VULKAN_FLAG_VALIDATE) {
 		image_create_info.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 	}
+	// Written on the async compute queue, then finished and sampled on the graphics queue. Avoids ownership transfers.
+	uint32_t queueFamilies[2];
+	if (shareWithComputeQueue && vulkan_->HasAsyncComputeQueue()) {
+		queueFamilies[0] = vulkan_->GetGraphicsQueueFamilyIndex();
+		queueFamilies[1] = vulkan_->GetComputeQueueFamilyIndex();
+		image_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		image_create_info.queueFamilyIndexCount = 2;
+		image_create_info.pQueueFamilyIndices = queueFamilies;
+	}
 	VmaAllocationCreateInfo allocCreateInfo{};
 	allocCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 	VmaAllocationInfo allocInfo{};
@@ -241,6 +241,13 @@ PFN_vkCreateRenderPass2 vkCreateRenderPass2;
 PFN_vkWaitForPresentKHR vkWaitForPresentKHR;
 PFN_vkGetPastPresentationTimingGOOGLE vkGetPastPresentationTimingGOOGLE;
 PFN_vkGetRefreshCycleDurationGOOGLE vkGetRefreshCycleDurationGOOGLE;
+
+PFN_vkCmdSetCullModeEXT vkCmdSetCullModeEXT;
+PFN_vkCmdSetDepthTestEnableEXT vkCmdSetDepthTestEnableEXT;
+PFN_vkCmdSetDepthWriteEnableEXT vkCmdSetDepthWriteEnableEXT;
+PFN_vkCmdSetDepthCompareOpEXT vkCmdSetDepthCompareOpEXT;
+PFN_vkCmdSetStencilTestEnableEXT vkCmdSetStencilTestEnableEXT;
+PFN_vkCmdSetStencilOpEXT vkCmdSetStencilOpEXT;
 #endif
 } // namespace PPSSPP_VK
 
@@ -852,6 +859,14 @@ void VulkanLoadDeviceFunctions(VkDevice device, const VulkanExtensions &enabledE
 		LOAD_DEVICE_FUNC(device, vkGetPastPresentationTimingGOOGLE);
 		LOAD_DEVICE_FUNC(device, vkGetRefreshCycleDurationGOOGLE);
 	}
+	if (enabledExtensions.EXT_extended_dynamic_state) {
+		LOAD_DEVICE_FUNC(device, vkCmdSetCullModeEXT);
+		LOAD_DEVICE_FUNC(device, vkCmdSetDepthTestEnableEXT);
+		LOAD_DEVICE_FUNC(device, vkCmdSetDepthWriteEnableEXT);
+		LOAD_DEVICE_FUNC(device, vkCmdSetDepthCompareOpEXT);
+		LOAD_DEVICE_FUNC(device, vkCmdSetStencilTestEnableEXT);
+		LOAD_DEVICE_FUNC(device, vkCmdSetStencilOpEXT);
+	}
 	if (enabledExtensions.KHR_dedicated_allocation) {
 		LOAD_DEVICE_FUNC_CORE(device, vkGetBufferMemoryRequirements2, vkGetBufferMemoryRequirements2KHR, VK_API_VERSION_1_1);
 		LOAD_DEVICE_FUNC_CORE(device, vkGetImageMemoryRequirements2, vkGetImageMemoryRequirements2KHR, VK_API_VERSION_1_1);
@@ -5,6 +5,7 @@
 #include "Common/GPU/Vulkan/VulkanRenderManager.h"
 #include "Common/Log.h"
 #include "Common/TimeUtil.h"
+#include "Common/Thread/ThreadManager.h"
 
 using namespace PPSSPP_VK;
 
@@ -340,13 +341,17 @@ void VulkanQueueRunner::PreprocessSteps(std::vector<VKRStep *> &steps) {
 void VulkanQueueRunner::RunSteps(std::vector<VKRStep *> &steps, int curFrame, FrameData &frameData, FrameDataShared &frameDataShared, bool keepSteps) {
 	QueueProfileContext *profile = frameData.profile.enabled ? &frameData.profile : nullptr;
 
-	if (profile)
+	if (profile) {
 		profile->cpuStartTime = time_now_d();
+		recordBarrier_.ResetStats();
+	}
 
 	bool emitLabels = vulkan_->Extensions().EXT_debug_utils;
 
 	VkCommandBuffer cmd = frameData.hasPresentCommands ? frameData.presentCmd : frameData.mainCmd;
 
+	SpawnSecondaryRenderPasses(steps, curFrame, frameData);
+
 	for (size_t i = 0; i < steps.size(); i++) {
 		const VKRStep &step = *steps[i];
 		if (emitLabels) {
@@ -392,7 +397,8 @@ void VulkanQueueRunner::RunSteps(std::vector<VKRStep *> &steps, int curFrame, Fr
 					vkCmdBeginDebugUtilsLabelEXT(cmd, &labelInfo);
 				}
 			}
-			PerformRenderPass(step, cmd, curFrame, frameData.profile);
+			PerformRenderPass(step, cmd, curFrame, frameData.profile, secondaryCmds_[i]);
+			secondaryCmds_[i] = nullptr;
 			break;
 		case VKRStepType::COPY:
 			PerformCopy(step, cmd);
@@ -420,6 +426,16 @@ void VulkanQueueRunner::RunSteps(std::vector<VKRStep *> &steps, int curFrame, Fr
 		}
 	}
 
+	// All secondaries should have been consumed by their render passes.
+	for (Promise<VkCommandBuffer> *&secondary : secondaryCmds_) {
+		_dbg_assert_(secondary == nullptr);
+		if (secondary) {
+			secondary->BlockUntilReady();
+			delete secondary;
+			secondary = nullptr;
+		}
+	}
+
 	// Deleting all in one go should be easier on the instruction cache than deleting
 	// them as we go - and easier to debug because we can look backwards in the frame.
 	if (!keepSteps) {
@@ -429,8 +445,13 @@ void VulkanQueueRunner::RunSteps(std::vector<VKRStep *> &steps, int curFrame, Fr
 		steps.clear();
 	}
 
-	if (profile)
+	if (profile) {
 		profile->cpuEndTime = time_now_d();
+		const VulkanBarrierBatch::Stats &barrierStats = recordBarrier_.GetStats();
+		profile->pipelineBarriers += barrierStats.pipelineBarriers;
+		profile->imageBarriers += barrierStats.imageBarriers;
+		profile->barriersSkipped += barrierStats.skipped;
+	}
 }
 
 void VulkanQueueRunner::ApplyMGSHack(std::vector<VKRStep *> &steps) {
@@ -734,6 +755,31 @@ void VulkanQueueRunner::ApplyRenderPassMerge(std::vector<VKRStep *> &steps) {
 		// OK. Now, if it's a render, slurp up all the commands and kill the step.
 		// Also slurp up any pretransitions.
 		dst->preTransitions.append(src->preTransitions);
+		// If the merged pass started with a clear, turn its load ops into an in-pass clear instead.
+		// Clearing loads always cover the whole framebuffer (see BindFramebufferAsRenderTarget), and on tilers
+		// an in-pass clear is much cheaper than ending the pass and storing/reloading all the tiles.
+		const auto &r = src->render;
+		u32 clearMask = 0;
+		if (r.colorLoad == VKRRenderPassLoadAction::CLEAR)
+			clearMask |= VK_IMAGE_ASPECT_COLOR_BIT;
+		if (r.framebuffer && r.framebuffer->HasDepth()) {
+			if (r.depthLoad == VKRRenderPassLoadAction::CLEAR)
+				clearMask |= VK_IMAGE_ASPECT_DEPTH_BIT;
+			if (r.stencilLoad == VKRRenderPassLoadAction::CLEAR)
+				clearMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+		if (clearMask != 0) {
+			VkRenderData data{ VKRRenderCommand::CLEAR };
+			data.clear.clearColor = r.clearColor;
+			data.clear.clearZ = r.clearDepth;
+			data.clear.clearStencil = r.clearStencil;
+			data.clear.clearMask = clearMask;
+			dst->commands.push_back(data);
+			if (clearMask & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+				dst->render.pipelineFlags |= PipelineFlags::USES_DEPTH_STENCIL;
+				dst->render.renderPassType = (RenderPassType)(dst->render.renderPassType | RenderPassType::HAS_DEPTH);
+			}
+		}
 		dst->commands.insert(dst->commands.end(), src->commands.begin(), src->commands.end());
 		MergeRenderAreaRectInto(&dst->render.renderArea, src->render.renderArea);
 		// So we don't consider it for other things, maybe doesn't matter.
@@ -744,11 +790,6 @@ void VulkanQueueRunner::ApplyRenderPassMerge(std::vector<VKRStep *> &steps) {
 		dst->render.pipelineFlags |= src->render.pipelineFlags;
 		dst->render.renderPassType = MergeRPTypes(dst->render.renderPassType, src->render.renderPassType);
 	};
-	auto renderHasClear = [](const VKRStep *step) {
-		const auto &r = step->render;
-		return r.colorLoad == VKRRenderPassLoadAction::CLEAR || r.depthLoad == VKRRenderPassLoadAction::CLEAR || r.stencilLoad == VKRRenderPassLoadAction::CLEAR;
-	};
-
 	// Now, let's go through the steps. If we find one that is rendered to more than once,
 	// we'll scan forward and slurp up any rendering that can be merged across.
 	for (int i = 0; i < (int)steps.size(); i++) {
@@ -766,7 +807,7 @@ void VulkanQueueRunner::ApplyRenderPassMerge(std::vector<VKRStep *> &steps) {
 				case VKRStepType::RENDER:
 					if (steps[j]->render.framebuffer == fb) {
 						// Prevent Unknown's example case from https://github.com/hrydgard/ppsspp/pull/12242
-						if (renderHasClear(steps[j]) || steps[j]->dependencies.contains(touchedFramebuffers)) {
+						if (steps[j]->dependencies.contains(touchedFramebuffers)) {
 							goto done_fb;
 						} else {
 							// Safe to merge, great.
@@ -887,6 +928,9 @@ void VulkanQueueRunner::LogRenderPass(const VKRStep &pass, bool verbose) {
 			case VKRRenderCommand::BLEND:
 				INFO_LOG(Log::G3D, "  BlendColor(%08x)", cmd.blendColor.color);
 				break;
+			case VKRRenderCommand::DEPTH_STENCIL:
+				INFO_LOG(Log::G3D, "  DepthStencil(cull=%d, depth=%d/%d/%d, stencil=%d/%d)", cmd.depthStencil.cullMode, cmd.depthStencil.depthTestEnable, cmd.depthStencil.depthWriteEnable, cmd.depthStencil.depthCompareOp, cmd.depthStencil.stencilTestEnable, cmd.depthStencil.stencilCompareOp);
+				break;
 			case VKRRenderCommand::CLEAR:
 				INFO_LOG(Log::G3D, "  Clear");
 				break;
@@ -938,7 +982,61 @@ void VulkanQueueRunner::LogReadbackImage(const VKRStep &step) {
 	INFO_LOG(Log::G3D, "%s", StepToString(vulkan_, step).c_str());
 }
 
-void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer cmd, int curFrame, QueueProfileContext &profile) {
+// Only worth the overhead for passes with lots of draws.
+static const size_t SECONDARY_MIN_COMMANDS = 256;
+
+void VulkanQueueRunner::SpawnSecondaryRenderPasses(const std::vector<VKRStep *> &steps, int curFrame, FrameData &frameData) {
+	secondaryCmds_.assign(steps.size(), nullptr);
+	// Recording can block on pipelines that are compiled by tasks on the same thread pool, so always leave
+	// a thread free for those.
+	const int maxSlots = std::min((int)MAX_SECONDARY_CMD_POOLS, g_threadManager.GetNumLooperThreads() - 1);
+	if (maxSlots < 2)
+		return;
+
+	auto isCandidate = [](const VKRStep &step) {
+		// The backbuffer pass is left inline, it's usually light and its framebuffer isn't known yet.
+		return step.stepType == VKRStepType::RENDER && step.render.framebuffer && step.commands.size() >= SECONDARY_MIN_COMMANDS;
+	};
+
+	// With only one, the render thread would just end up waiting for it.
+	int numCandidates = 0;
+	for (const VKRStep *step : steps) {
+		if (isCandidate(*step))
+			numCandidates++;
+	}
+	if (numCandidates < 2)
+		return;
+
+	int slot = 0;
+	for (size_t i = 0; i < steps.size() && slot < maxSlots; i++) {
+		const VKRStep &step = *steps[i];
+		if (!isCandidate(step))
+			continue;
+
+		// Create the render pass and framebuffer here on the render thread, the worker only looks them up.
+		VKRFramebuffer *fb = step.render.framebuffer;
+		const RenderPassType rpType = step.render.renderPassType;
+		VKRRenderPass *renderPass = GetRenderPassForStep(step);
+		VkCommandBufferInheritanceInfo inherit{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+		inherit.renderPass = renderPass->Get(vulkan_, rpType, fb->sampleCount);
+		inherit.subpass = 0;
+		inherit.framebuffer = fb->Get(renderPass, rpType);
+
+		VkCommandBuffer secondaryCmd = frameData.GetSecondaryCmd(vulkan_, slot++);
+		secondaryCmds_[i] = Promise<VkCommandBuffer>::Spawn(&g_threadManager, [=, &step]() {
+			VkCommandBufferBeginInfo begin{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+			begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+			begin.pInheritanceInfo = &inherit;
+			vkBeginCommandBuffer(secondaryCmd, &begin);
+			RecordRenderCommands(step, secondaryCmd, renderPass, curFrame, nullptr);
+			VkResult res = vkEndCommandBuffer(secondaryCmd);
+			_assert_msg_(res == VK_SUCCESS, "vkEndCommandBuffer failed (secondary)! result=%s", VulkanResultToString(res));
+			return secondaryCmd;
+		}, TaskType::CPU_COMPUTE, TaskPriority::HIGH);
+	}
+}
+
+void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer cmd, int curFrame, QueueProfileContext &profile, Promise<VkCommandBuffer> *secondary) {
 	for (size_t i = 0; i < step.preTransitions.size(); i++) {
 		const TransitionRequest &iter = step.preTransitions[i];
 		if (iter.aspect == VK_IMAGE_ASPECT_COLOR_BIT && iter.fb->color.layout != iter.targetLayout) {
@@ -955,7 +1053,7 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 	}
 
 	// Don't execute empty renderpasses that keep the contents.
-	if (step.commands.empty() && step.render.colorLoad == VKRRenderPassLoadAction::KEEP && step.render.depthLoad == VKRRenderPassLoadAction::KEEP && step.render.stencilLoad == VKRRenderPassLoadAction::KEEP) {
+	if (!secondary && step.commands.empty() && step.render.colorLoad == VKRRenderPassLoadAction::KEEP && step.render.depthLoad == VKRRenderPassLoadAction::KEEP && step.render.stencilLoad == VKRRenderPassLoadAction::KEEP) {
 		// Flush the pending barrier
 		recordBarrier_.Flush(cmd);
 		// Nothing to do.
@@ -1008,8 +1106,35 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 	// image layouts as part of the passes.
 	//
 	// NOTE: Unconditionally flushes recordBarrier_.
-	VKRRenderPass *renderPass = PerformBindFramebufferAsRenderTarget(step, cmd);
+	VKRRenderPass *renderPass = PerformBindFramebufferAsRenderTarget(step, cmd, secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+
+	if (secondary) {
+		// Recorded on a worker thread, see SpawnSecondaryRenderPasses.
+		VkCommandBuffer secondaryCmd = secondary->BlockUntilReady();
+		delete secondary;
+		vkCmdExecuteCommands(cmd, 1, &secondaryCmd);
+	} else {
+		RecordRenderCommands(step, cmd, renderPass, curFrame, &profile);
+	}
+	vkCmdEndRenderPass(cmd);
+
+	_dbg_assert_(recordBarrier_.empty());
 
+	VKRFramebuffer *fb = step.render.framebuffer;
+	if (fb) {
+		// If the desired final layout aren't the optimal layout needed next, early-transition the image.
+		if (step.render.finalColorLayout != fb->color.layout) {
+			recordBarrier_.TransitionColorImageAuto(&fb->color, step.render.finalColorLayout);
+		}
+		if (fb->depth.image && step.render.finalDepthStencilLayout != fb->depth.layout) {
+			recordBarrier_.TransitionDepthStencilImageAuto(&fb->depth, step.render.finalDepthStencilLayout);
+		}
+	}
+}
+
+// Doesn't touch any image layouts or barriers, so this can run on a worker thread, recording into a secondary
+// command buffer. In that case, profile is null.
+void VulkanQueueRunner::RecordRenderCommands(const VKRStep &step, VkCommandBuffer cmd, VKRRenderPass *renderPass, int curFrame, QueueProfileContext *profile) {
 	int curWidth = step.render.framebuffer ? step.render.framebuffer->width : vulkan_->GetBackbufferWidth();
 	int curHeight = step.render.framebuffer ? step.render.framebuffer->height : vulkan_->GetBackbufferHeight();
 
@@ -1038,9 +1163,9 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 	for (size_t i = 0; i < commands.size(); i++) {
 		const VkRenderData &c = commands[i];
 #ifdef _DEBUG
-		if (profile.enabled) {
-			if ((size_t)step.stepType < ARRAY_SIZE(profile.commandCounts)) {
-				profile.commandCounts[(size_t)c.cmd]++;
+		if (profile && profile->enabled) {
+			if ((size_t)step.stepType < ARRAY_SIZE(profile->commandCounts)) {
+				profile->commandCounts[(size_t)c.cmd]++;
 			}
 		}
 #endif
@@ -1060,9 +1185,30 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 						"expected %d sample count, got %d", fbSampleCount, graphicsPipeline->SampleCount());
 				}
 
-				VkPipeline pipeline;
+				VkPipeline pipeline = VK_NULL_HANDLE;
+				bool usedFallback = false;
+
+				// If the pipeline is still compiling, try the fallback before blocking. Note that we don't hold
+				// both locks at once.
+				VKRGraphicsPipeline *fallback = c.graphics_pipeline.fallback;
+				if (fallback) {
+					bool primaryPending;
+					{
+						std::lock_guard<std::mutex> lock(graphicsPipeline->mutex_);
+						Promise<VkPipeline> *promise = graphicsPipeline->pipeline[(size_t)rpType];
+						primaryPending = promise && !promise->IsReady();
+					}
+					if (primaryPending && (!RenderPassTypeHasMultisample(rpType) || fallback->SampleCount() == fbSampleCount)) {
+						std::lock_guard<std::mutex> lock(fallback->mutex_);
+						Promise<VkPipeline> *promise = fallback->pipeline[(size_t)rpType];
+						if (promise && promise->IsReady()) {
+							pipeline = promise->BlockUntilReady();
+							usedFallback = pipeline != VK_NULL_HANDLE;
+						}
+					}
+				}
 
-				{
+				if (!usedFallback) {
 					std::lock_guard<std::mutex> lock(graphicsPipeline->mutex_);
 					if (!graphicsPipeline->pipeline[(size_t)rpType]) {
 						// NOTE: If render steps got merged, it can happen that, as they ended during recording,
@@ -1081,7 +1227,8 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 					descSets = &c.graphics_pipeline.pipelineLayout->frameData[curFrame].descSets_;
 					pipelineLayout = c.graphics_pipeline.pipelineLayout->pipelineLayout;
 					_dbg_assert_(pipelineLayout != VK_NULL_HANDLE);
-					lastGraphicsPipeline = graphicsPipeline;
+					// If we used the fallback, check again next time the same pipeline is bound.
+					lastGraphicsPipeline = usedFallback ? nullptr : graphicsPipeline;
 					pipelineOK = true;
 				} else {
 					pipelineOK = false;
@@ -1138,6 +1285,18 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 			break;
 		}
 
+		case VKRRenderCommand::DEPTH_STENCIL:
+		{
+			const VKRDynamicDepthStencil &ds = c.depthStencil;
+			vkCmdSetCullModeEXT(cmd, (VkCullModeFlags)ds.cullMode);
+			vkCmdSetDepthTestEnableEXT(cmd, ds.depthTestEnable);
+			vkCmdSetDepthWriteEnableEXT(cmd, ds.depthWriteEnable);
+			vkCmdSetDepthCompareOpEXT(cmd, (VkCompareOp)ds.depthCompareOp);
+			vkCmdSetStencilTestEnableEXT(cmd, ds.stencilTestEnable);
+			vkCmdSetStencilOpEXT(cmd, VK_STENCIL_FACE_FRONT_AND_BACK, (VkStencilOp)ds.stencilFailOp, (VkStencilOp)ds.stencilPassOp, (VkStencilOp)ds.stencilDepthFailOp, (VkCompareOp)ds.stencilCompareOp);
+			break;
+		}
+
 		case VKRRenderCommand::PUSH_CONSTANTS:
 			if (pipelineOK) {
 				vkCmdPushConstants(cmd, pipelineLayout, c.push.stages, c.push.offset, c.push.size, c.push.data);
@@ -1230,22 +1389,25 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 			break;
 		}
 	}
-	vkCmdEndRenderPass(cmd);
-
-	_dbg_assert_(recordBarrier_.empty());
+}
 
-	if (fb) {
-		// If the desired final layout aren't the optimal layout needed next, early-transition the image.
-		if (step.render.finalColorLayout != fb->color.layout) {
-			recordBarrier_.TransitionColorImageAuto(&fb->color, step.render.finalColorLayout);
-		}
-		if (fb->depth.image && step.render.finalDepthStencilLayout != fb->depth.layout) {
-			recordBarrier_.TransitionDepthStencilImageAuto(&fb->depth, step.render.finalDepthStencilLayout);
-		}
+VKRRenderPass *VulkanQueueRunner::GetRenderPassForStep(const VKRStep &step) {
+	if (step.render.framebuffer) {
+		RPKey key{
+			step.render.colorLoad, step.render.depthLoad, step.render.stencilLoad,
+			step.render.colorStore, step.render.depthStore, step.render.stencilStore,
+		};
+		return GetRenderPass(key);
+	} else {
+		RPKey key{
+			VKRRenderPassLoadAction::CLEAR, VKRRenderPassLoadAction::CLEAR, VKRRenderPassLoadAction::CLEAR,
+			VKRRenderPassStoreAction::STORE, VKRRenderPassStoreAction::DONT_CARE, VKRRenderPassStoreAction::DONT_CARE,
+		};
+		return GetRenderPass(key);
 	}
 }
 
-VKRRenderPass *VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKRStep &step, VkCommandBuffer cmd) {
+VKRRenderPass *VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKRStep &step, VkCommandBuffer cmd, VkSubpassContents contents) {
 	VKRRenderPass *renderPass;
 	int numClearVals = 0;
 	VkClearValue clearVal[4]{};
@@ -1264,11 +1426,7 @@ VKRRenderPass *VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKR
 		_dbg_assert_(step.render.finalColorLayout != VK_IMAGE_LAYOUT_UNDEFINED);
 		_dbg_assert_(step.render.finalDepthStencilLayout != VK_IMAGE_LAYOUT_UNDEFINED);
 
-		RPKey key{
-			step.render.colorLoad, step.render.depthLoad, step.render.stencilLoad,
-			step.render.colorStore, step.render.depthStore, step.render.stencilStore,
-		};
-		renderPass = GetRenderPass(key);
+		renderPass = GetRenderPassForStep(step);
 
 		VKRFramebuffer *fb = step.render.framebuffer;
 		framebuf = fb->Get(renderPass, step.render.renderPassType);
@@ -1321,11 +1479,7 @@ VKRRenderPass *VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKR
 		}
 		_dbg_assert_(numClearVals != 3);
 	} else {
-		RPKey key{
-			VKRRenderPassLoadAction::CLEAR, VKRRenderPassLoadAction::CLEAR, VKRRenderPassLoadAction::CLEAR,
-			VKRRenderPassStoreAction::STORE, VKRRenderPassStoreAction::DONT_CARE, VKRRenderPassStoreAction::DONT_CARE,
-		};
-		renderPass = GetRenderPass(key);
+		renderPass = GetRenderPassForStep(step);
 		framebuf = backbuffer_;
 
 		// Raw, rotated backbuffer size.
@@ -1360,7 +1514,7 @@ VKRRenderPass *VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKR
 	rp_begin.renderArea = rc;
 	rp_begin.clearValueCount = numClearVals;
 	rp_begin.pClearValues = numClearVals ? clearVal : nullptr;
-	vkCmdBeginRenderPass(cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBeginRenderPass(cmd, &rp_begin, contents);
 
 	return renderPass;
 }
@@ -1720,7 +1874,7 @@ void VulkanQueueRunner::PerformReadback(const VKRStep &step, VkCommandBuffer cmd
 		recordBarrier_.TransitionImage(backbufferImage_, 0, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT,
 			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
 			VK_ACCESS_TRANSFER_READ_BIT, 0,
-			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);  // Presentation waits on a semaphore, nothing else to block.
 		recordBarrier_.Flush(cmd);  // probably not needed
 		copyLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 	}
@@ -1820,6 +1974,16 @@ bool VulkanQueueRunner::CopyReadbackBuffer(FrameData &frameData, VKRFramebuffer
 	return true;
 }
 
+void VulkanQueueRunner::CopyDeferredReadbacks(FrameData &frameData) {
+	for (const DeferredReadback &deferred : frameData.deferredReadbacks_) {
+		const ReadbackKey &key = deferred.key;
+		if (!CopyReadbackBuffer(frameData, (VKRFramebuffer *)key.framebuf, key.width, key.height, deferred.srcFormat, deferred.destFormat, deferred.pixelStride, deferred.pixels)) {
+			WARN_LOG(Log::G3D, "Lost a deferred readback (%dx%d)", key.width, key.height);
+		}
+	}
+	frameData.deferredReadbacks_.clear();
+}
+
 const char *VKRRenderCommandToString(VKRRenderCommand cmd) {
 	const char * const str[] = {
 		"REMOVED",
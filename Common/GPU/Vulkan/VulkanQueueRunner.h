@@ -33,6 +33,7 @@ enum class VKRRenderCommand : uint8_t {
 	BIND_GRAPHICS_PIPELINE,  // async
 	STENCIL,
 	BLEND,
+	DEPTH_STENCIL,  // Only with VK_EXT_extended_dynamic_state.
 	VIEWPORT,
 	SCISSOR,
 	CLEAR,
@@ -51,15 +52,31 @@ enum class PipelineFlags : u8 {
 	USES_MULTIVIEW = (1 << 4),  // Inherited from the render pass it was created with.
 	USES_DISCARD = (1 << 5),
 	USES_FLAT_SHADING = (1 << 6),
+	// Cull mode and depth/stencil test state are dynamic, set through SetDynamicDepthStencil.
+	USES_DYNAMIC_DEPTH_STENCIL = (1 << 7),
 };
 ENUM_CLASS_BITOPS(PipelineFlags);
 
+// The state covered by VK_EXT_extended_dynamic_state that we use, values are the Vk enums.
+struct VKRDynamicDepthStencil {
+	uint8_t cullMode;
+	uint8_t depthTestEnable;
+	uint8_t depthWriteEnable;
+	uint8_t depthCompareOp;
+	uint8_t stencilTestEnable;
+	uint8_t stencilCompareOp;
+	uint8_t stencilPassOp;
+	uint8_t stencilFailOp;
+	uint8_t stencilDepthFailOp;
+};
+
 struct VkRenderData {
 	VKRRenderCommand cmd;
 	union {
 		struct {
 			VKRGraphicsPipeline *pipeline;
 			VKRPipelineLayout *pipelineLayout;
+			VKRGraphicsPipeline *fallback;  // Optional, bound instead if pipeline is still compiling.
 		} graphics_pipeline;
 		struct {
 			uint32_t descSetIndex;
@@ -101,6 +118,7 @@ struct VkRenderData {
 		struct {
 			uint32_t color;
 		} blendColor;
+		VKRDynamicDepthStencil depthStencil;
 		struct {
 			VkShaderStageFlags stages;
 			uint8_t offset;
@@ -249,6 +267,8 @@ class VulkanQueueRunner {
 
 	// src == 0 means to copy from the sync readback buffer.
 	bool CopyReadbackBuffer(FrameData &frameData, VKRFramebuffer *src, int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels);
+	// Only call after the frame's fence has been waited on.
+	void CopyDeferredReadbacks(FrameData &frameData);
 
 	VKRRenderPass *GetRenderPass(const RPKey &key);
 
@@ -271,8 +291,13 @@ class VulkanQueueRunner {
 	bool InitBackbufferFramebuffers(int width, int height);
 	bool InitDepthStencilBuffer(VkCommandBuffer cmd, VulkanBarrierBatch *barriers);  // Used for non-buffered rendering.
 
-	VKRRenderPass *PerformBindFramebufferAsRenderTarget(const VKRStep &pass, VkCommandBuffer cmd);
-	void PerformRenderPass(const VKRStep &pass, VkCommandBuffer cmd, int curFrame, QueueProfileContext &profile);
+	VKRRenderPass *GetRenderPassForStep(const VKRStep &step);
+	VKRRenderPass *PerformBindFramebufferAsRenderTarget(const VKRStep &pass, VkCommandBuffer cmd, VkSubpassContents contents);
+	// If secondary is set, the commands were already recorded into it by SpawnSecondaryRenderPasses.
+	void PerformRenderPass(const VKRStep &pass, VkCommandBuffer cmd, int curFrame, QueueProfileContext &profile, Promise<VkCommandBuffer> *secondary = nullptr);
+	void RecordRenderCommands(const VKRStep &pass, VkCommandBuffer cmd, VKRRenderPass *renderPass, int curFrame, QueueProfileContext *profile);
+	// Starts recording large render passes into secondary command buffers on worker threads.
+	void SpawnSecondaryRenderPasses(const std::vector<VKRStep *> &steps, int curFrame, FrameData &frameData);
 	void PerformCopy(const VKRStep &pass, VkCommandBuffer cmd);
 	void PerformBlit(const VKRStep &pass, VkCommandBuffer cmd);
 	void PerformReadback(const VKRStep &pass, VkCommandBuffer cmd, FrameData &frameData);
@@ -316,6 +341,9 @@ class VulkanQueueRunner {
 
 	VulkanBarrierBatch recordBarrier_;
 
+	// Indexed by step, non-null for render passes being recorded on worker threads.
+	std::vector<Promise<VkCommandBuffer> *> secondaryCmds_;
+
 	// Swap chain management
 	struct SwapchainImageData {
 		VkImage image;
@@ -2,8 +2,10 @@
 
 #include <map>
 #include <sstream>
+#include <tuple>
 
 #include "Common/Log.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 
@@ -13,6 +15,7 @@
 
 #include "Common/LogReporting.h"
 #include "Common/Thread/ThreadUtil.h"
+#include "ext/xxhash.h"
 
 #if 0 // def _DEBUG
 #define VLOG(...) NOTICE_LOG(Log::G3D, __VA_ARGS__)
@@ -28,6 +31,7 @@ using namespace PPSSPP_VK;
 
 // renderPass is an example of the "compatibility class" or RenderPassType type.
 bool VKRGraphicsPipeline::Create(VulkanContext *vulkan, VkRenderPass compatibleRenderPass, RenderPassType rpType, VkSampleCountFlagBits sampleCount, double scheduleTime, int countToCompile) {
+	TRACE_SCOPE("vk_pipeline");
 	// Good torture test to test the shutdown-while-precompiling-shaders issue on PC where it's normally
 	// hard to catch because shaders compile so fast.
 	// sleep_ms(200);
@@ -106,6 +110,16 @@ bool VKRGraphicsPipeline::Create(VulkanContext *vulkan, VkRenderPass compatibleR
 
 	VkPipelineInputAssemblyStateCreateInfo inputAssembly{ VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
 	inputAssembly.topology = desc->topology;
+	// Core Vulkan only allows restart for the strip and fan topologies. It only affects indexed draws.
+	switch (desc->topology) {
+	case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+	case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+	case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
+		inputAssembly.primitiveRestartEnable = VK_TRUE;
+		break;
+	default:
+		break;
+	}
 
 	// We will use dynamic viewport state.
 	pipe.pVertexInputState = &desc->vis;
@@ -244,11 +258,13 @@ struct SinglePipelineTask {
 	VkSampleCountFlagBits sampleCount;
 	double scheduleTime;
 	int countToCompile;
+	// Non-null for precompiles, decremented when done.
+	std::atomic<int> *precompilesPending;
 };
 
 class CreateMultiPipelinesTask : public Task {
 public:
-	CreateMultiPipelinesTask(VulkanContext *vulkan, std::vector<SinglePipelineTask> tasks) : vulkan_(vulkan), tasks_(std::move(tasks)) {
+	CreateMultiPipelinesTask(VulkanContext *vulkan, std::vector<SinglePipelineTask> tasks, TaskPriority priority) : vulkan_(vulkan), tasks_(std::move(tasks)), priority_(priority) {
 		tasksInFlight_.fetch_add(1);
 	}
 	~CreateMultiPipelinesTask() = default;
@@ -258,18 +274,21 @@ class CreateMultiPipelinesTask : public Task {
 	}
 
 	TaskPriority Priority() const override {
-		return TaskPriority::HIGH;
+		return priority_;
 	}
 
 	void Run() override {
 		for (auto &task : tasks_) {
 			task.pipeline->Create(vulkan_, task.compatibleRenderPass, task.rpType, task.sampleCount, task.scheduleTime, task.countToCompile);
+			if (task.precompilesPending)
+				task.precompilesPending->fetch_sub(1);
 		}
 		tasksInFlight_.fetch_sub(1);
 	}
 
 	VulkanContext *vulkan_;
 	std::vector<SinglePipelineTask> tasks_;
+	TaskPriority priority_;
 
 	// Use during shutdown to make sure there aren't any leftover tasks sitting queued.
 	// Could probably be done more elegantly. Like waiting for all tasks of a type, or saving pointers to them, or something...
@@ -480,7 +499,8 @@ void VulkanRenderManager::CompileThreadFunc() {
 		int countToCompile = (int)toCompile.size();
 
 		// Here we sort the pending pipelines by vertex and fragment shaders,
-		std::map<std::pair<Promise<VkShaderModule> *, Promise<VkShaderModule> *>, std::vector<SinglePipelineTask>> map;
+		// keeping precompiles from the shader cache apart so that draws never wait behind them.
+		std::map<std::tuple<bool, Promise<VkShaderModule> *, Promise<VkShaderModule> *>, std::vector<SinglePipelineTask>> map;
 
 		double scheduleTime = time_now_d();
 
@@ -492,7 +512,7 @@ void VulkanRenderManager::CompileThreadFunc() {
 			switch (entry.type) {
 			case CompileQueueEntry::Type::GRAPHICS:
 			{
-				map[std::make_pair(entry.graphics->desc->vertexShader, entry.graphics->desc->fragmentShader)].push_back(
+				map[std::make_tuple(entry.precompile, entry.graphics->desc->vertexShader, entry.graphics->desc->fragmentShader)].push_back(
 					SinglePipelineTask{
 						entry.graphics,
 						entry.compatibleRenderPass,
@@ -500,6 +520,7 @@ void VulkanRenderManager::CompileThreadFunc() {
 						entry.sampleCount,
 						scheduleTime,    // these two are for logging purposes.
 						countToCompile,
+						entry.precompile ? &precompilesPending_ : nullptr,
 					}
 				);
 				break;
@@ -513,7 +534,8 @@ void VulkanRenderManager::CompileThreadFunc() {
 
 			// NOTICE_LOG(Log::G3D, "For this shader pair, we have %d pipelines to create", (int)entries.size());
 
-			Task *task = new CreateMultiPipelinesTask(vulkan_, entries);
+			// Draw-time pipelines sort first in the map, and also get ahead in the thread pool.
+			Task *task = new CreateMultiPipelinesTask(vulkan_, entries, std::get<0>(shaders) ? TaskPriority::NORMAL : TaskPriority::HIGH);
 			g_threadManager.EnqueueTask(task);
 		}
 
@@ -531,6 +553,7 @@ void VulkanRenderManager::CompileThreadFunc() {
 
 void VulkanRenderManager::RenderThreadFunc() {
 	SetCurrentThreadName("VulkanRenderMan");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 	while (true) {
 		_dbg_assert_(useRenderThread_);
 
@@ -617,7 +640,7 @@ void VulkanRenderManager::PollPresentTiming() {
 }
 
 void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfiler) {
-	double frameBeginTime = time_now_d()
+	double frameBeginTime = time_now_d();
 	VLOG("BeginFrame");
 	VkDevice device = vulkan_->GetDevice();
 
@@ -642,6 +665,9 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 	}
 	vkResetFences(device, 1, &frameData.fence);
 
+	// The deferred readbacks queued the last time around in this frame slot are done now.
+	queueRunner_.CopyDeferredReadbacks(frameData);
+
 	uint64_t frameId = frameIdGen_++;
 
 	PollPresentTiming();
@@ -656,21 +682,33 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 	frameTimeData.afterFenceWait = time_now_d();
 
 	// Can't set this until after the fence.
-	frameData.profile.enabled = enableProfiling;
-	frameData.profile.timestampsEnabled = enableProfiling && validBits > 0;
+	// The tracer also wants the timestamps, but not the summary.
+	const bool tracing = Tracer::Active();
+	frameData.profile.enabled = enableProfiling || tracing;
+	frameData.profile.timestampsEnabled = frameData.profile.enabled && validBits > 0;
 	frameData.frameId = frameId;
 
 	uint64_t queryResults[MAX_TIMESTAMP_QUERIES];
+	int numQueries = 0;
+	bool haveQueryResults = false;
+	if (!frameData.profile.timestampDescriptions.empty() && frameData.profile.timestampsEnabled) {
+		// Pull the profiling results from last time.
+		numQueries = (int)frameData.profile.timestampDescriptions.size();
+		VkResult res = vkGetQueryPoolResults(
+			vulkan_->GetDevice(),
+			frameData.profile.queryPool, 0, numQueries, sizeof(uint64_t) * numQueries, &queryResults[0], sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT);
+		haveQueryResults = res == VK_SUCCESS;
+	}
+
+	if (tracing && haveQueryResults && frameData.profile.firstSubmitNanos) {
+		RecordGPUTrace(frameData.profile, queryResults, numQueries, validBits);
+	}
 
 	if (enableProfiling) {
-		// Pull the profiling results from last time and produce a summary!
+		// Produce a summary from the results!
 		if (!frameData.profile.timestampDescriptions.empty() && frameData.profile.timestampsEnabled) {
-			int numQueries = (int)frameData.profile.timestampDescriptions.size();
-			VkResult res = vkGetQueryPoolResults(
-				vulkan_->GetDevice(),
-				frameData.profile.queryPool, 0, numQueries, sizeof(uint64_t) * numQueries, &queryResults[0], sizeof(uint64_t),
-				VK_QUERY_RESULT_64_BIT);
-			if (res == VK_SUCCESS) {
+			if (haveQueryResults) {
 				double timestampConversionFactor = (double)vulkan_->GetPhysicalDeviceProperties().properties.limits.timestampPeriod * (1.0 / 1000000.0);
 				uint64_t timestampDiffMask = validBits == 64 ? 0xFFFFFFFFFFFFFFFFULL : ((1ULL << validBits) - 1);
 				std::stringstream str;
@@ -687,6 +725,8 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 				str << line;
 				snprintf(line, sizeof(line), "Descriptors written: %d (dedup: %d)\n", frameData.profile.descriptorsWritten, frameData.profile.descriptorsDeduped);
 				str << line;
+				snprintf(line, sizeof(line), "Barriers: %d (%d images, %d skipped)\n", frameData.profile.pipelineBarriers, frameData.profile.imageBarriers, frameData.profile.barriersSkipped);
+				str << line;
 				snprintf(line, sizeof(line), "Resource deletions: %d\n", vulkan_->GetLastDeleteCount());
 				str << line;
 				for (int i = 0; i < numQueries - 1; i++) {
@@ -719,6 +759,8 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 			str << line;
 			snprintf(line, sizeof(line), "Descriptors written: %d\n", frameData.profile.descriptorsWritten);
 			str << line;
+			snprintf(line, sizeof(line), "Barriers: %d (%d images, %d skipped)\n", frameData.profile.pipelineBarriers, frameData.profile.imageBarriers, frameData.profile.barriersSkipped);
+			str << line;
 			frameData.profile.profileSummary = str.str();
 		}
 
@@ -736,6 +778,9 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 
 	frameData.profile.descriptorsWritten = 0;
 	frameData.profile.descriptorsDeduped = 0;
+	frameData.profile.pipelineBarriers = 0;
+	frameData.profile.imageBarriers = 0;
+	frameData.profile.barriersSkipped = 0;
 
 	// Must be after the fence - this performs deletes.
 	VLOG("PUSH: BeginFrame %d", curFrame);
@@ -744,6 +789,7 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 	vulkan_->BeginFrame(enableLogProfiler ? GetInitCmd() : VK_NULL_HANDLE);
 
 	frameData.profile.timestampDescriptions.clear();
+	frameData.profile.firstSubmitNanos = 0;
 	if (frameData.profile.timestampsEnabled) {
 		// For various reasons, we need to always use an init cmd buffer in this case to perform the vkCmdResetQueryPool,
 		// unless we want to limit ourselves to only measure the main cmd buffer.
@@ -755,11 +801,34 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 	}
 }
 
+void VulkanRenderManager::RecordGPUTrace(const QueueProfileContext &profile, const uint64_t *queryResults, int numQueries, int validBits) {
+	const double nanosPerTick = (double)vulkan_->GetPhysicalDeviceProperties().properties.limits.timestampPeriod;
+	const uint64_t timestampDiffMask = validBits == 64 ? 0xFFFFFFFFFFFFFFFFULL : ((1ULL << validBits) - 1);
+	// Go by differences from the first timestamp (the start of initCmd), in case of wrapping.
+	const uint64_t base = (uint64_t)((double)queryResults[0] * nanosPerTick);
+	auto toNanos = [&](int i) {
+		return base + (uint64_t)((double)((queryResults[i] - queryResults[0]) & timestampDiffMask) * nanosPerTick);
+	};
+
+	std::vector<Tracer::GPUZone> zones;
+	zones.reserve(numQueries - 1);
+	for (int i = 0; i < numQueries - 1; i++) {
+		// Each timestamp is written at the end of its step, so the step started at the previous one.
+		zones.push_back(Tracer::GPUZone{ profile.timestampDescriptions[i + 1], toNanos(i), toNanos(i + 1) });
+	}
+	Tracer::RecordGPUFrame(profile.firstSubmitNanos, zones);
+}
+
 VkCommandBuffer VulkanRenderManager::GetInitCmd() {
 	int curFrame = vulkan_->GetCurFrame();
 	return frameData_[curFrame].GetInitCmd(vulkan_);
 }
 
+VkCommandBuffer VulkanRenderManager::GetComputeCmd() {
+	int curFrame = vulkan_->GetCurFrame();
+	return frameData_[curFrame].GetComputeCmd(vulkan_);
+}
+
 void VulkanRenderManager::ReportBadStateForDraw() {
 	const char *cause1 = "";
 	char cause2[256];
@@ -821,7 +890,9 @@ VKRGraphicsPipeline *VulkanRenderManager::CreateGraphicsPipeline(VKRGraphicsPipe
 			}
 
 			pipeline->pipeline[i] = Promise<VkPipeline>::CreateEmpty();
-			compileQueue_.emplace_back(pipeline, compatibleRenderPass->Get(vulkan_, rpType, sampleCount), rpType, sampleCount);
+			compileQueue_.emplace_back(pipeline, compatibleRenderPass->Get(vulkan_, rpType, sampleCount), rpType, sampleCount, cacheLoad);
+			if (cacheLoad)
+				precompilesPending_++;
 			needsCompile = true;
 		}
 		if (needsCompile)
@@ -1061,6 +1132,22 @@ void VulkanRenderManager::BindFramebufferAsRenderTarget(VKRFramebuffer *fb, VKRR
 bool VulkanRenderManager::CopyFramebufferToMemory(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, Draw::ReadbackMode mode, const char *tag) {
 	_dbg_assert_(insideFrame_);
 
+	FrameData &frameData = frameData_[vulkan_->GetCurFrame()];
+	if (mode != Draw::ReadbackMode::BLOCK) {
+		// Delayed readbacks of the same size from the same framebuffer share a buffer, so one that's still
+		// waiting to be written out would get overwritten. Backbuffer readbacks don't go through the cache at all.
+		bool conflict = src == nullptr;
+		for (const DeferredReadback &deferred : frameData.deferredReadbacks_) {
+			if (deferred.key.framebuf == src && deferred.key.width == w && deferred.key.height == h) {
+				conflict = true;
+				break;
+			}
+		}
+		if (conflict && mode == Draw::ReadbackMode::DEFERRED) {
+			mode = Draw::ReadbackMode::BLOCK;
+		}
+	}
+
 	for (int i = (int)steps_.size() - 1; i >= 0; i--) {
 		if (steps_[i]->stepType == VKRStepType::RENDER && steps_[i]->render.framebuffer == src) {
 			steps_[i]->render.numReads++;
@@ -1075,7 +1162,7 @@ bool VulkanRenderManager::CopyFramebufferToMemory(VKRFramebuffer *src, VkImageAs
 	step->readback.src = src;
 	step->readback.srcRect.offset = { x, y };
 	step->readback.srcRect.extent = { (uint32_t)w, (uint32_t)h };
-	step->readback.delayed = mode == Draw::ReadbackMode::OLD_DATA_OK;
+	step->readback.delayed = mode != Draw::ReadbackMode::BLOCK;
 	step->dependencies.insert(src);
 	step->tag = tag;
 	steps_.push_back(step);
@@ -1120,11 +1207,31 @@ bool VulkanRenderManager::CopyFramebufferToMemory(VKRFramebuffer *src, VkImageAs
 		_assert_(false);
 	}
 
+	if (mode == Draw::ReadbackMode::DEFERRED) {
+		// Written out in BeginFrame, after waiting for this frame slot's fence.
+		DeferredReadback deferred;
+		deferred.key.framebuf = src;
+		deferred.key.width = w;
+		deferred.key.height = h;
+		deferred.srcFormat = srcFormat;
+		deferred.destFormat = destFormat;
+		deferred.pixelStride = pixelStride;
+		deferred.pixels = pixels;
+		frameData.deferredReadbacks_.push_back(deferred);
+		return true;
+	}
+
 	// Need to call this after FlushSync so the pixels are guaranteed to be ready in CPU-accessible VRAM.
-	return queueRunner_.CopyReadbackBuffer(frameData_[vulkan_->GetCurFrame()],
+	return queueRunner_.CopyReadbackBuffer(frameData,
 		mode == Draw::ReadbackMode::OLD_DATA_OK ? src : nullptr, w, h, srcFormat, destFormat, pixelStride, pixels);
 }
 
+void VulkanRenderManager::DiscardDeferredReadbacks() {
+	for (FrameData &frameData : frameData_) {
+		frameData.deferredReadbacks_.clear();
+	}
+}
+
 void VulkanRenderManager::CopyImageToMemorySync(VkImage image, int mipLevel, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
 	_dbg_assert_(insideFrame_);
 
@@ -1172,6 +1279,7 @@ static void CleanupRenderCommands(FastVec<VkRenderData> *cmds) {
 		case VKRRenderCommand::SCISSOR:
 		case VKRRenderCommand::BLEND:
 		case VKRRenderCommand::STENCIL:
+		case VKRRenderCommand::DEPTH_STENCIL:
 			if (lastOfCmd != -1) {
 				cmds->at(lastOfCmd).cmd = VKRRenderCommand::REMOVED;
 			}
@@ -1478,6 +1586,7 @@ void VulkanRenderManager::Present() {
 //
 // Can be called again after a VKRRunType::SYNC on the same frame.
 void VulkanRenderManager::Run(VKRRenderThreadTask &task) {
+	TRACE_SCOPE(task.runType == VKRRunType::PRESENT ? "vk_present" : "vk_submit");
 	FrameData &frameData = frameData_[task.frame];
 
 	if (task.runType == VKRRunType::PRESENT) {
@@ -1520,6 +1629,7 @@ void VulkanRenderManager::Run(VKRRenderThreadTask &task) {
 		// Effectively resets both main and present command buffers, since they both live in this pool.
 		// We always record main commands first, so we don't need to reset the present command buffer separately.
 		vkResetCommandPool(vulkan_->GetDevice(), frameData.cmdPoolMain, 0);
+		frameData.ResetSecondaryCmdPools(vulkan_);
 
 		VkCommandBufferBeginInfo begin{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
 		begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
@@ -1766,12 +1876,20 @@ void VKRPipelineLayout::FlushDescSets(VulkanContext *vulkan, int frame, QueuePro
 	size_t start = data.flushedDescriptors_;
 	int writeCount = 0, dedupCount = 0;
 
+	// Recently written sets, by hash of their contents.  Collisions just overwrite, since we
+	// compare the contents before reusing anyway.  This catches draws alternating between a few
+	// textures, which the simple look-back below misses.
+	enum { RECENT_SETS_SIZE = 64 };
+	int recentSets[RECENT_SETS_SIZE];
+	for (int i = 0; i < RECENT_SETS_SIZE; i++) {
+		recentSets[i] = -1;
+	}
+
 	for (size_t index = start; index < descSets.size(); index++) {
 		auto &d = descSets[index];
 
 		// This is where we look up to see if we already have an identical descriptor previously in the array.
-		// We could do a simple custom hash map here that doesn't handle collisions, since those won't matter.
-		// Instead, for now we just check history one item backwards. Good enough, it seems.
+		// First check history one item backwards, which is the most common case.
 		if (index > start + 1) {
 			if (descSets[index - 1].count == d.count) {
 				if (!memcmp(descData.data() + d.offset, descData.data() + descSets[index - 1].offset, d.count * sizeof(PackedDescriptor))) {
@@ -1782,6 +1900,16 @@ void VKRPipelineLayout::FlushDescSets(VulkanContext *vulkan, int frame, QueuePro
 			}
 		}
 
+		const size_t dataSize = d.count * sizeof(PackedDescriptor);
+		const int slot = (int)(XXH3_64bits(descData.data() + d.offset, dataSize) & (RECENT_SETS_SIZE - 1));
+		const int recent = recentSets[slot];
+		if (recent >= 0 && descSets[recent].count == d.count && !memcmp(descData.data() + d.offset, descData.data() + descSets[recent].offset, dataSize)) {
+			d.set = descSets[recent].set;
+			dedupCount++;
+			continue;
+		}
+		recentSets[slot] = (int)index;
+
 		if (setsUsed < ARRAY_SIZE(setCache)) {
 			d.set = setCache[setsUsed++];
 		} else {
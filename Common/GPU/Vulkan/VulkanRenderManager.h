@@ -86,7 +86,7 @@ class VKRGraphicsPipelineDesc : public Draw::RefCountedObject {
 	VkPipelineColorBlendStateCreateInfo cbs{ VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
 	VkPipelineColorBlendAttachmentState blend0{};
 	VkPipelineDepthStencilStateCreateInfo dss{ VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
-	VkDynamicState dynamicStates[6]{};
+	VkDynamicState dynamicStates[12]{};
 	VkPipelineDynamicStateCreateInfo ds{ VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
 	VkPipelineRasterizationStateCreateInfo rs{ VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
 	VkPipelineRasterizationProvokingVertexStateCreateInfoEXT rs_provoking{ VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_PROVOKING_VERTEX_STATE_CREATE_INFO_EXT };
@@ -150,8 +150,8 @@ struct VKRGraphicsPipeline {
 };
 
 struct CompileQueueEntry {
-	CompileQueueEntry(VKRGraphicsPipeline *p, VkRenderPass _compatibleRenderPass, RenderPassType _renderPassType, VkSampleCountFlagBits _sampleCount)
-		: type(Type::GRAPHICS), graphics(p), compatibleRenderPass(_compatibleRenderPass), renderPassType(_renderPassType), sampleCount(_sampleCount) {}
+	CompileQueueEntry(VKRGraphicsPipeline *p, VkRenderPass _compatibleRenderPass, RenderPassType _renderPassType, VkSampleCountFlagBits _sampleCount, bool _precompile = false)
+		: type(Type::GRAPHICS), graphics(p), compatibleRenderPass(_compatibleRenderPass), renderPassType(_renderPassType), sampleCount(_sampleCount), precompile(_precompile) {}
 	enum class Type {
 		GRAPHICS,
 	};
@@ -160,6 +160,8 @@ struct CompileQueueEntry {
 	RenderPassType renderPassType;
 	VKRGraphicsPipeline* graphics = nullptr;
 	VkSampleCountFlagBits sampleCount;
+	// Queued from the shader cache rather than for a draw, so compiled at lower priority.
+	bool precompile;
 };
 
 // Pending descriptor sets.
@@ -267,6 +269,7 @@ class VulkanRenderManager {
 
 	bool CopyFramebufferToMemory(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, Draw::ReadbackMode mode, const char *tag);
 	void CopyImageToMemorySync(VkImage image, int mipLevel, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag);
+	void DiscardDeferredReadbacks();
 
 	void CopyFramebuffer(VKRFramebuffer *src, VkRect2D srcRect, VKRFramebuffer *dst, VkOffset2D dstPos, VkImageAspectFlags aspectMask, const char *tag);
 	void BlitFramebuffer(VKRFramebuffer *src, VkRect2D srcRect, VKRFramebuffer *dst, VkRect2D dstRect, VkImageAspectFlags aspectMask, VkFilter filter, const char *tag);
@@ -289,6 +292,11 @@ class VulkanRenderManager {
 		compileQueueMutex_.unlock();
 	}
 
+	// Number of pipeline variants queued with cacheLoad that haven't finished compiling yet.
+	int GetNumPrecompilesPending() const {
+		return precompilesPending_;
+	}
+
 	void AssertInRenderPass() const {
 		_dbg_assert_(curRenderStep_ && curRenderStep_->stepType == VKRStepType::RENDER);
 	}
@@ -296,7 +304,9 @@ class VulkanRenderManager {
 	// This is the first call in a draw operation. Instead of asserting like we used to, you can now check the
 	// return value and skip the draw if we're in a bad state. In that case, call ReportBadState.
 	// The old assert wasn't very helpful in figuring out what caused it anyway...
-	bool BindPipeline(VKRGraphicsPipeline *pipeline, PipelineFlags flags, VKRPipelineLayout *pipelineLayout) {
+	// If fallback is set, it's bound instead when pipeline hasn't finished compiling by the time the commands run,
+	// but the fallback has. It must be compatible with the same pipeline layout and dynamic state.
+	bool BindPipeline(VKRGraphicsPipeline *pipeline, PipelineFlags flags, VKRPipelineLayout *pipelineLayout, VKRGraphicsPipeline *fallback = nullptr) {
 		_dbg_assert_(curRenderStep_ && curRenderStep_->stepType == VKRStepType::RENDER && pipeline != nullptr);
 		if (!curRenderStep_ || curRenderStep_->stepType != VKRStepType::RENDER) {
 			return false;
@@ -304,8 +314,11 @@ class VulkanRenderManager {
 		VkRenderData &data = curRenderStep_->commands.push_uninitialized();
 		data.cmd = VKRRenderCommand::BIND_GRAPHICS_PIPELINE;
 		pipelinesToCheck_.push_back(pipeline);
+		if (fallback)
+			pipelinesToCheck_.push_back(fallback);
 		data.graphics_pipeline.pipeline = pipeline;
 		data.graphics_pipeline.pipelineLayout = pipelineLayout;
+		data.graphics_pipeline.fallback = fallback;
 		// This can be used to debug cases where depth/stencil rendering is used on color-only framebuffers.
 		// if ((flags & PipelineFlags::USES_DEPTH_STENCIL) && curRenderStep_->render.framebuffer && !curRenderStep_->render.framebuffer->HasDepth()) {
 		//     DebugBreak();
@@ -393,6 +406,14 @@ class VulkanRenderManager {
 		data.blendColor.color = color;
 	}
 
+	// Only valid with pipelines created with the extended dynamic states (USES_DYNAMIC_DEPTH_STENCIL).
+	void SetDynamicDepthStencil(const VKRDynamicDepthStencil &state) {
+		_dbg_assert_(curRenderStep_ && curRenderStep_->stepType == VKRStepType::RENDER);
+		VkRenderData &data = curRenderStep_->commands.push_uninitialized();
+		data.cmd = VKRRenderCommand::DEPTH_STENCIL;
+		data.depthStencil = state;
+	}
+
 	void PushConstants(VkShaderStageFlags stages, int offset, int size, void *constants) {
 		_dbg_assert_(curRenderStep_ && curRenderStep_->stepType == VKRStepType::RENDER);
 		_dbg_assert_(size + offset < 40);
@@ -498,6 +519,7 @@ class VulkanRenderManager {
 	}
 
 	VkCommandBuffer GetInitCmd();
+	VkCommandBuffer GetComputeCmd();
 
 	bool CreateBackbuffers();
 	void DestroyBackbuffers();
@@ -554,6 +576,7 @@ class VulkanRenderManager {
 
 	void PresentWaitThreadFunc();
 	void PollPresentTiming();
+	void RecordGPUTrace(const QueueProfileContext &profile, const uint64_t *queryResults, int numQueries, int validBits);
 
 	void ResetDescriptorLists(int frame);
 	void FlushDescriptors(int frame);
@@ -616,6 +639,7 @@ class VulkanRenderManager {
 	std::condition_variable compileCond_;
 	std::mutex compileQueueMutex_;
 	std::vector<CompileQueueEntry> compileQueue_;
+	std::atomic<int> precompilesPending_{};
 
 	// Thread for measuring presentation delay.
 	std::thread presentWaitThread_;
@@ -455,6 +455,9 @@ class VKContext : public DrawContext {
 	void CopyFramebufferImage(Framebuffer *src, int level, int x, int y, int z, Framebuffer *dst, int dstLevel, int dstX, int dstY, int dstZ, int width, int height, int depth, Aspect aspects, const char *tag) override;
 	bool BlitFramebuffer(Framebuffer *src, int srcX1, int srcY1, int srcX2, int srcY2, Framebuffer *dst, int dstX1, int dstY1, int dstX2, int dstY2, Aspect aspects, FBBlitFilter filter, const char *tag) override;
 	bool CopyFramebufferToMemory(Framebuffer *src, Aspect aspects, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, ReadbackMode mode, const char *tag) override;
+	void DiscardDeferredReadbacks() override {
+		renderManager_.DiscardDeferredReadbacks();
+	}
 	DataFormat PreferredFramebufferReadbackFormat(Framebuffer *src) override;
 
 	// These functions should be self explanatory.
@@ -1679,6 +1682,7 @@ std::vector<std::string> VKContext::GetFeatureList() const {
 	AddFeature(features, "presentId", vulkan_->GetDeviceFeatures().available.presentId.presentId, vulkan_->GetDeviceFeatures().enabled.presentId.presentId);
 	AddFeature(features, "presentWait", vulkan_->GetDeviceFeatures().available.presentWait.presentWait, vulkan_->GetDeviceFeatures().enabled.presentWait.presentWait);
 	AddFeature(features, "provokingVertexLast", vulkan_->GetDeviceFeatures().available.provokingVertex.provokingVertexLast, vulkan_->GetDeviceFeatures().enabled.provokingVertex.provokingVertexLast);
+	AddFeature(features, "extendedDynamicState", vulkan_->GetDeviceFeatures().available.extendedDynamicState.extendedDynamicState, vulkan_->GetDeviceFeatures().enabled.extendedDynamicState.extendedDynamicState);
 
 	features.emplace_back(std::string("Preferred depth buffer format: ") + VulkanFormatToString(vulkan_->GetDeviceInfo().preferredDepthStencilFormat));
 
@@ -1900,6 +1904,8 @@ uint64_t VKContext::GetNativeObject(NativeObject obj, void *srcObject) {
 		return (uint64_t)vulkan_;
 	case NativeObject::INIT_COMMANDBUFFER:
 		return (uint64_t)renderManager_.GetInitCmd();
+	case NativeObject::COMPUTE_COMMANDBUFFER:
+		return (uint64_t)renderManager_.GetComputeCmd();
 	case NativeObject::BOUND_TEXTURE0_IMAGEVIEW:
 		return (uint64_t)boundImageView_[0];
 	case NativeObject::BOUND_TEXTURE1_IMAGEVIEW:
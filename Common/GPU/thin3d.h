@@ -246,6 +246,7 @@ enum class NativeObject {
 	BACKBUFFER_DEPTH_TEX,
 	FEATURE_LEVEL,
 	INIT_COMMANDBUFFER,
+	COMPUTE_COMMANDBUFFER,  // Async compute queue, null if there's none.
 	BOUND_TEXTURE0_IMAGEVIEW,  // Layer etc depends on how you bound it...
 	BOUND_TEXTURE1_IMAGEVIEW,  // Layer etc depends on how you bound it...
 	BOUND_FRAMEBUFFER_COLOR_IMAGEVIEW_ALL_LAYERS,
@@ -301,6 +302,7 @@ enum class Event {
 enum class ReadbackMode {
 	BLOCK,
 	OLD_DATA_OK,  // Lets the backend return old results that won't need any waiting to get.
+	DEFERRED,  // Returns right away, the backend writes the pixels to the destination once the GPU is done (a few frames later.)
 };
 
 constexpr uint32_t MAX_TEXTURE_SLOTS = 3;
@@ -786,6 +788,8 @@ class DrawContext {
 	virtual DataFormat PreferredFramebufferReadbackFormat(Framebuffer *src) {
 		return DataFormat::R8G8B8A8_UNORM;
 	}
+	// Drops DEFERRED readbacks that haven't been written yet. Call before the destination memory goes away or gets replaced.
+	virtual void DiscardDeferredReadbacks() {}
 
 	// These functions should be self explanatory.
 	// Binding a zero render target means binding the backbuffer.
@@ -0,0 +1,1050 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#include <cstring>
+#include "Common/CPUDetect.h"
+#include "Common/LoongArch64Emitter.h"
+
+namespace LoongArch64Gen {
+
+static inline bool SupportsLSX() {
+	return cpu_info.LOONGARCH_LSX;
+}
+
+enum class Opcode32 {
+	// 2R
+	CLO_W = 0x00001000,
+	CLZ_W = 0x00001400,
+	CTO_W = 0x00001800,
+	CTZ_W = 0x00001C00,
+	CLZ_D = 0x00002400,
+	REVB_2H = 0x00003000,
+	REVB_2W = 0x00003800,
+	REVH_2W = 0x00004000,
+	BITREV_W = 0x00005000,
+	EXT_W_H = 0x00005800,
+	EXT_W_B = 0x00005C00,
+
+	// 3R
+	ADD_W = 0x00100000,
+	ADD_D = 0x00108000,
+	SUB_W = 0x00110000,
+	SUB_D = 0x00118000,
+	SLT = 0x00120000,
+	SLTU = 0x00128000,
+	MASKEQZ = 0x00130000,
+	MASKNEZ = 0x00138000,
+	NOR = 0x00140000,
+	AND = 0x00148000,
+	OR = 0x00150000,
+	XOR = 0x00158000,
+	ORN = 0x00160000,
+	ANDN = 0x00168000,
+	SLL_W = 0x00170000,
+	SRL_W = 0x00178000,
+	SRA_W = 0x00180000,
+	SLL_D = 0x00188000,
+	SRL_D = 0x00190000,
+	SRA_D = 0x00198000,
+	ROTR_W = 0x001B0000,
+	ROTR_D = 0x001B8000,
+	MUL_W = 0x001C0000,
+	MULH_W = 0x001C8000,
+	MULH_WU = 0x001D0000,
+	MUL_D = 0x001D8000,
+	MULH_D = 0x001E0000,
+	MULH_DU = 0x001E8000,
+	MULW_D_W = 0x001F0000,
+	MULW_D_WU = 0x001F8000,
+	DIV_W = 0x00200000,
+	MOD_W = 0x00208000,
+	DIV_WU = 0x00210000,
+	MOD_WU = 0x00218000,
+	DIV_D = 0x00220000,
+	MOD_D = 0x00228000,
+	DIV_DU = 0x00230000,
+	MOD_DU = 0x00238000,
+	BREAK = 0x002A0000,
+
+	// 3R with a 2-bit shift amount.
+	ALSL_W = 0x00040000,
+	ALSL_WU = 0x00060000,
+	ALSL_D = 0x002C0000,
+
+	// Shifts by immediate.
+	SLLI_W = 0x00408000,
+	SLLI_D = 0x00410000,
+	SRLI_W = 0x00448000,
+	SRLI_D = 0x00450000,
+	SRAI_W = 0x00488000,
+	SRAI_D = 0x00490000,
+	ROTRI_W = 0x004C8000,
+	ROTRI_D = 0x004D0000,
+
+	BSTRINS_W = 0x00600000,
+	BSTRPICK_W = 0x00608000,
+	BSTRINS_D = 0x00800000,
+	BSTRPICK_D = 0x00C00000,
+
+	// Scalar FP.
+	FADD_S = 0x01008000,
+	FSUB_S = 0x01028000,
+	FMUL_S = 0x01048000,
+	FDIV_S = 0x01068000,
+	FMAX_S = 0x01088000,
+	FMIN_S = 0x010A8000,
+	FCOPYSIGN_S = 0x01128000,
+	FABS_S = 0x01140400,
+	FNEG_S = 0x01141400,
+	FCLASS_S = 0x01143400,
+	FSQRT_S = 0x01144400,
+	FRECIP_S = 0x01145400,
+	FRSQRT_S = 0x01146400,
+	FMOV_S = 0x01149400,
+	FMOV_D = 0x01149800,
+	MOVGR2FR_W = 0x0114A400,
+	MOVFR2GR_S = 0x0114B400,
+	MOVGR2FCSR = 0x0114C000,
+	MOVFCSR2GR = 0x0114C800,
+	MOVGR2CF = 0x0114D800,
+	MOVCF2GR = 0x0114DC00,
+	FTINTRM_W_S = 0x011A0400,
+	FTINTRP_W_S = 0x011A4400,
+	FTINTRZ_W_S = 0x011A8400,
+	FTINTRNE_W_S = 0x011AC400,
+	FTINT_W_S = 0x011B0400,
+	FFINT_S_W = 0x011D1000,
+
+	// 2RI12
+	SLTI = 0x02000000,
+	SLTUI = 0x02400000,
+	ADDI_W = 0x02800000,
+	ADDI_D = 0x02C00000,
+	LU52I_D = 0x03000000,
+	ANDI = 0x03400000,
+	ORI = 0x03800000,
+	XORI = 0x03C00000,
+
+	// 4R
+	FMADD_S = 0x08100000,
+	FMSUB_S = 0x08500000,
+	VFMADD_S = 0x09100000,
+	FCMP_S = 0x0C100000,
+	VFCMP_S = 0x0C500000,
+	FSEL = 0x0D000000,
+	VBITSEL_V = 0x0D100000,
+
+	// 2RI16
+	ADDU16I_D = 0x10000000,
+
+	// 1RI20
+	LU12I_W = 0x14000000,
+	LU32I_D = 0x16000000,
+	PCADDI = 0x18000000,
+	PCADDU12I = 0x1C000000,
+	PCADDU18I = 0x1E000000,
+
+	// Loads and stores (2RI12.)
+	LD_B = 0x28000000,
+	LD_H = 0x28400000,
+	LD_W = 0x28800000,
+	LD_D = 0x28C00000,
+	ST_B = 0x29000000,
+	ST_H = 0x29400000,
+	ST_W = 0x29800000,
+	ST_D = 0x29C00000,
+	LD_BU = 0x2A000000,
+	LD_HU = 0x2A400000,
+	LD_WU = 0x2A800000,
+	FLD_S = 0x2B000000,
+	FST_S = 0x2B400000,
+	FLD_D = 0x2B800000,
+	FST_D = 0x2BC00000,
+	VLD = 0x2C000000,
+	VST = 0x2C400000,
+
+	// Indexed loads and stores (3R.)
+	LDX_B = 0x38000000,
+	LDX_H = 0x38040000,
+	LDX_W = 0x38080000,
+	LDX_D = 0x380C0000,
+	STX_B = 0x38100000,
+	STX_H = 0x38140000,
+	STX_W = 0x38180000,
+	STX_D = 0x381C0000,
+	LDX_BU = 0x38200000,
+	LDX_HU = 0x38240000,
+	LDX_WU = 0x38280000,
+	FLDX_S = 0x38300000,
+	FSTX_S = 0x38380000,
+	VLDX = 0x38400000,
+	VSTX = 0x38440000,
+	DBAR = 0x38720000,
+	IBAR = 0x38728000,
+
+	// Branches.
+	BEQZ = 0x40000000,
+	BNEZ = 0x44000000,
+	BCEQZ = 0x48000000,
+	BCNEZ = 0x48000100,
+	JIRL = 0x4C000000,
+	B = 0x50000000,
+	BL = 0x54000000,
+	BEQ = 0x58000000,
+	BNE = 0x5C000000,
+	BLT = 0x60000000,
+	BGE = 0x64000000,
+	BLTU = 0x68000000,
+	BGEU = 0x6C000000,
+
+	// LSX.
+	VADD_W = 0x700B0000,
+	VSUB_W = 0x700D0000,
+	VMAX_W = 0x70710000,
+	VMIN_W = 0x70730000,
+	VAND_V = 0x71260000,
+	VOR_V = 0x71268000,
+	VXOR_V = 0x71270000,
+	VNOR_V = 0x71278000,
+	VANDN_V = 0x71280000,
+	VFADD_S = 0x71308000,
+	VFSUB_S = 0x71328000,
+	VFMUL_S = 0x71388000,
+	VFDIV_S = 0x713A8000,
+	VFMAX_S = 0x713C8000,
+	VFMIN_S = 0x713E8000,
+	VFSQRT_S = 0x729CE400,
+	VFRECIP_S = 0x729CF400,
+	VFRSQRT_S = 0x729D0400,
+	VREPLGR2VR_W = 0x729F0800,
+	VINSGR2VR_W = 0x72EBE000,
+	VPICKVE2GR_W = 0x72EFE000,
+	VREPLVEI_W = 0x72F7E000,
+	VBITCLRI_W = 0x73108000,
+	VBITSETI_W = 0x73148000,
+	VBITREVI_W = 0x73188000,
+	VSLLI_W = 0x732C8000,
+	VSRLI_W = 0x73308000,
+	VSRAI_W = 0x73348000,
+	VEXTRINS_W = 0x73840000,
+	VSHUF4I_W = 0x73980000,
+};
+
+static inline bool IsGPR(LoongArch64Reg reg) {
+	return reg < F0;
+}
+
+static inline bool IsFPR(LoongArch64Reg reg) {
+	return reg >= F0 && reg < V0;
+}
+
+static inline bool IsVPR(LoongArch64Reg reg) {
+	return reg >= V0 && reg <= V31;
+}
+
+static inline u32 EncReg(LoongArch64Reg reg) {
+	return (u32)reg & 0x1F;
+}
+
+static inline s32 SignReduce32(s32 v, int width) {
+	int shift = 32 - width;
+	return (v << shift) >> shift;
+}
+
+static inline s64 SignReduce64(s64 v, int width) {
+	int shift = 64 - width;
+	return (v << shift) >> shift;
+}
+
+static inline u32 Encode2R(Opcode32 op, u32 d, u32 j) {
+	return (u32)op | (j << 5) | d;
+}
+
+static inline u32 Encode3R(Opcode32 op, u32 d, u32 j, u32 k) {
+	return (u32)op | (k << 10) | (j << 5) | d;
+}
+
+static inline u32 Encode4R(Opcode32 op, u32 d, u32 j, u32 k, u32 a) {
+	return (u32)op | (a << 15) | (k << 10) | (j << 5) | d;
+}
+
+static inline u32 Encode2RUI(Opcode32 op, u32 d, u32 j, u32 ui, int bits) {
+	_assert_msg_(ui < (1U << bits), "Immediate %u out of range (%d bits)", ui, bits);
+	return (u32)op | (ui << 10) | (j << 5) | d;
+}
+
+static inline u32 Encode2RI12(Opcode32 op, u32 d, u32 j, s32 si12) {
+	_assert_msg_(SignReduce32(si12, 12) == si12, "Immediate %d out of range (12 bits)", si12);
+	return (u32)op | (((u32)si12 & 0xFFF) << 10) | (j << 5) | d;
+}
+
+static inline u32 Encode2RI16(Opcode32 op, u32 d, u32 j, s32 si16) {
+	_assert_msg_(SignReduce32(si16, 16) == si16, "Immediate %d out of range (16 bits)", si16);
+	return (u32)op | (((u32)si16 & 0xFFFF) << 10) | (j << 5) | d;
+}
+
+static inline u32 Encode1RI20(Opcode32 op, u32 d, s32 si20) {
+	_assert_msg_(SignReduce32(si20, 20) == si20, "Immediate %d out of range (20 bits)", si20);
+	return (u32)op | (((u32)si20 & 0xFFFFF) << 5) | d;
+}
+
+// Offsets are in bytes here, and are stored divided by 4.
+static inline u32 EncodeOffs16(s32 offs) {
+	return (((u32)offs >> 2) & 0xFFFF) << 10;
+}
+
+static inline u32 EncodeOffs21(s32 offs) {
+	u32 v = (u32)offs >> 2;
+	return ((v & 0xFFFF) << 10) | ((v >> 16) & 0x1F);
+}
+
+static inline u32 EncodeOffs26(s32 offs) {
+	u32 v = (u32)offs >> 2;
+	return ((v & 0xFFFF) << 10) | ((v >> 16) & 0x3FF);
+}
+
+static inline bool OffsetInRange(const void *src, const void *dst, int bits) {
+	ptrdiff_t distance = (intptr_t)dst - (intptr_t)src;
+	// Get rid of bits and sign extend to validate range.
+	s64 encodable = SignReduce64((s64)distance, bits);
+	return distance == encodable && (distance & 3) == 0;
+}
+
+LoongArch64Emitter::LoongArch64Emitter(const u8 *ptr, u8 *writePtr) {
+	SetCodePointer(ptr, writePtr);
+}
+
+void LoongArch64Emitter::SetCodePointer(const u8 *ptr, u8 *writePtr) {
+	code_ = ptr;
+	writable_ = writePtr;
+	lastCacheFlushEnd_ = ptr;
+}
+
+const u8 *LoongArch64Emitter::GetCodePointer() const {
+	return code_;
+}
+
+u8 *LoongArch64Emitter::GetWritableCodePtr() {
+	return writable_;
+}
+
+void LoongArch64Emitter::ReserveCodeSpace(u32 bytes) {
+	_assert_msg_((bytes & 3) == 0, "Code space should be aligned");
+	for (u32 i = 0; i < bytes / 4; i++)
+		BREAK(0);
+}
+
+const u8 *LoongArch64Emitter::AlignCode16() {
+	int c = int((u64)code_ & 15);
+	if (c)
+		ReserveCodeSpace(16 - c);
+	return code_;
+}
+
+const u8 *LoongArch64Emitter::AlignCodePage() {
+	int page_size = GetMemoryProtectPageSize();
+	int c = int((intptr_t)code_ & ((intptr_t)page_size - 1));
+	if (c)
+		ReserveCodeSpace(page_size - c);
+	return code_;
+}
+
+void LoongArch64Emitter::FlushIcache() {
+	FlushIcacheSection(lastCacheFlushEnd_, code_);
+	lastCacheFlushEnd_ = code_;
+}
+
+void LoongArch64Emitter::FlushIcacheSection(const u8 *start, const u8 *end) {
+#if PPSSPP_ARCH(LOONGARCH64)
+	__builtin___clear_cache((char *)start, (char *)end);
+#endif
+}
+
+FixupBranch::FixupBranch(FixupBranch &&other) {
+	ptr = other.ptr;
+	type = other.type;
+	other.ptr = nullptr;
+}
+
+FixupBranch::~FixupBranch() {
+	_assert_msg_(ptr == nullptr, "FixupBranch never set (left infinite loop)");
+}
+
+FixupBranch &FixupBranch::operator =(FixupBranch &&other) {
+	ptr = other.ptr;
+	type = other.type;
+	other.ptr = nullptr;
+	return *this;
+}
+
+void LoongArch64Emitter::SetJumpTarget(FixupBranch &branch) {
+	SetJumpTarget(branch, code_);
+}
+
+void LoongArch64Emitter::SetJumpTarget(FixupBranch &branch, const void *dst) {
+	_assert_msg_(branch.ptr != nullptr, "Invalid FixupBranch (SetJumpTarget twice?)");
+
+	const intptr_t srcp = (intptr_t)branch.ptr;
+	const intptr_t dstp = (intptr_t)dst;
+	const ptrdiff_t writable_delta = writable_ - code_;
+	u32 *writableSrc = (u32 *)(branch.ptr + writable_delta);
+
+	_assert_msg_((dstp & 3) == 0, "Destination should be aligned");
+	s32 distance = (s32)(dstp - srcp);
+
+	u32 fixup;
+	memcpy(&fixup, writableSrc, sizeof(u32));
+	switch (branch.type) {
+	case FixupBranchType::B16:
+		_assert_msg_(OffsetInRange(branch.ptr, dst, 18), "B16 destination is too far away (%p -> %p)", branch.ptr, dst);
+		fixup = (fixup & 0xFC0003FF) | EncodeOffs16(distance);
+		break;
+
+	case FixupBranchType::BZ21:
+		_assert_msg_(OffsetInRange(branch.ptr, dst, 23), "BZ21 destination is too far away (%p -> %p)", branch.ptr, dst);
+		fixup = (fixup & 0xFC0003E0) | EncodeOffs21(distance);
+		break;
+
+	case FixupBranchType::J26:
+		_assert_msg_(OffsetInRange(branch.ptr, dst, 28), "J26 destination is too far away (%p -> %p)", branch.ptr, dst);
+		fixup = (fixup & 0xFC000000) | EncodeOffs26(distance);
+		break;
+	}
+	memcpy(writableSrc, &fixup, sizeof(u32));
+
+	branch.ptr = nullptr;
+}
+
+bool LoongArch64Emitter::BranchInRange(const void *func) const {
+	return OffsetInRange(code_, func, 18);
+}
+
+bool LoongArch64Emitter::BranchZeroInRange(const void *func) const {
+	return OffsetInRange(code_, func, 23);
+}
+
+bool LoongArch64Emitter::JumpInRange(const void *func) const {
+	return OffsetInRange(code_, func, 28);
+}
+
+void LoongArch64Emitter::QuickJ(LoongArch64Reg scratchreg, const u8 *dst) {
+	if (JumpInRange(dst)) {
+		B(dst);
+		return;
+	}
+
+	int64_t pcdelta = (int64_t)dst - (int64_t)GetCodePointer();
+	if (SignReduce64(pcdelta, 38) == pcdelta) {
+		// PCADDU18I + JIRL reaches +/- 128 GB.
+		int32_t lower = (int32_t)SignReduce64(pcdelta, 18);
+		PCADDU18I(scratchreg, (int32_t)((pcdelta - lower) >> 18));
+		JIRL(R_ZERO, scratchreg, lower);
+	} else {
+		LI(scratchreg, (uintptr_t)dst);
+		JIRL(R_ZERO, scratchreg, 0);
+	}
+}
+
+void LoongArch64Emitter::QuickCallFunction(const u8 *func, LoongArch64Reg scratchreg) {
+	if (JumpInRange(func)) {
+		BL(func);
+		return;
+	}
+
+	int64_t pcdelta = (int64_t)func - (int64_t)GetCodePointer();
+	if (SignReduce64(pcdelta, 38) == pcdelta) {
+		int32_t lower = (int32_t)SignReduce64(pcdelta, 18);
+		PCADDU18I(scratchreg, (int32_t)((pcdelta - lower) >> 18));
+		JIRL(R_RA, scratchreg, lower);
+	} else {
+		LI(scratchreg, (uintptr_t)func);
+		JIRL(R_RA, scratchreg, 0);
+	}
+}
+
+void LoongArch64Emitter::SetRegToImmediate(LoongArch64Reg rd, uint64_t value) {
+	int64_t svalue = (int64_t)value;
+	_assert_msg_(IsGPR(rd), "SetRegToImmediate only supports GPRs");
+
+	if (SignReduce64(svalue, 12) == svalue) {
+		// Nice and simple, small immediate fits in a single ADDI against zero.
+		ADDI_D(rd, R_ZERO, (s32)svalue);
+		return;
+	}
+
+	const uint32_t low32 = (uint32_t)value;
+	const uint32_t lo12 = low32 & 0xFFF;
+	const uint32_t hi20 = low32 >> 12;
+
+	// Track what's in the register so far, to know what's left.
+	int64_t current;
+	if (hi20 != 0) {
+		LU12I_W(rd, SignReduce32((s32)hi20, 20));
+		if (lo12 != 0)
+			ORI(rd, rd, lo12);
+		current = (int64_t)(int32_t)low32;
+	} else {
+		ORI(rd, R_ZERO, lo12);
+		current = lo12;
+	}
+
+	if (current == svalue)
+		return;
+
+	// LU32I.D sets bits 32-51, and sign extends into the top 12.
+	if (((current ^ svalue) & 0x000FFFFF00000000LL) != 0) {
+		s32 bits32 = SignReduce32((s32)((value >> 32) & 0xFFFFF), 20);
+		LU32I_D(rd, bits32);
+		current = (int64_t)(uint32_t)current | ((int64_t)bits32 << 32);
+	}
+
+	if (current != svalue)
+		LU52I_D(rd, rd, SignReduce32((s32)(value >> 52), 12));
+}
+
+FixupBranch LoongArch64Emitter::WriteFixupBranch(u32 op, FixupBranchType type) {
+	FixupBranch fixup{ GetCodePointer(), type };
+	Write32(op);
+	return fixup;
+}
+
+void LoongArch64Emitter::B(const void *dst) {
+	_assert_msg_(JumpInRange(dst), "%s destination is too far away (%p -> %p)", __func__, code_, dst);
+	Write32((u32)Opcode32::B | EncodeOffs26((s32)((intptr_t)dst - (intptr_t)code_)));
+}
+
+FixupBranch LoongArch64Emitter::B() {
+	return WriteFixupBranch((u32)Opcode32::B, FixupBranchType::J26);
+}
+
+void LoongArch64Emitter::BL(const void *dst) {
+	_assert_msg_(JumpInRange(dst), "%s destination is too far away (%p -> %p)", __func__, code_, dst);
+	Write32((u32)Opcode32::BL | EncodeOffs26((s32)((intptr_t)dst - (intptr_t)code_)));
+}
+
+FixupBranch LoongArch64Emitter::BL() {
+	return WriteFixupBranch((u32)Opcode32::BL, FixupBranchType::J26);
+}
+
+void LoongArch64Emitter::JIRL(LoongArch64Reg rd, LoongArch64Reg rj, s32 offs18) {
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__);
+	_assert_msg_((offs18 & 3) == 0 && SignReduce32(offs18, 18) == offs18, "%s offset out of range: %d", __func__, offs18);
+	Write32((u32)Opcode32::JIRL | EncodeOffs16(offs18) | (EncReg(rj) << 5) | EncReg(rd));
+}
+
+#define BRANCH16(name) \
+void LoongArch64Emitter::name(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst) { \
+	_assert_msg_(IsGPR(rj) && IsGPR(rd), "%s must use GPRs", __func__); \
+	_assert_msg_(BranchInRange(dst), "%s destination is too far away (%p -> %p)", __func__, code_, dst); \
+	Write32((u32)Opcode32::name | EncodeOffs16((s32)((intptr_t)dst - (intptr_t)code_)) | (EncReg(rj) << 5) | EncReg(rd)); \
+} \
+FixupBranch LoongArch64Emitter::name(LoongArch64Reg rj, LoongArch64Reg rd) { \
+	_assert_msg_(IsGPR(rj) && IsGPR(rd), "%s must use GPRs", __func__); \
+	return WriteFixupBranch((u32)Opcode32::name | (EncReg(rj) << 5) | EncReg(rd), FixupBranchType::B16); \
+}
+
+BRANCH16(BEQ)
+BRANCH16(BNE)
+BRANCH16(BLT)
+BRANCH16(BGE)
+BRANCH16(BLTU)
+BRANCH16(BGEU)
+
+#undef BRANCH16
+
+void LoongArch64Emitter::BEQZ(LoongArch64Reg rj, const void *dst) {
+	_assert_msg_(IsGPR(rj), "%s must use GPRs", __func__);
+	_assert_msg_(BranchZeroInRange(dst), "%s destination is too far away (%p -> %p)", __func__, code_, dst);
+	Write32((u32)Opcode32::BEQZ | EncodeOffs21((s32)((intptr_t)dst - (intptr_t)code_)) | (EncReg(rj) << 5));
+}
+
+void LoongArch64Emitter::BNEZ(LoongArch64Reg rj, const void *dst) {
+	_assert_msg_(IsGPR(rj), "%s must use GPRs", __func__);
+	_assert_msg_(BranchZeroInRange(dst), "%s destination is too far away (%p -> %p)", __func__, code_, dst);
+	Write32((u32)Opcode32::BNEZ | EncodeOffs21((s32)((intptr_t)dst - (intptr_t)code_)) | (EncReg(rj) << 5));
+}
+
+FixupBranch LoongArch64Emitter::BEQZ(LoongArch64Reg rj) {
+	_assert_msg_(IsGPR(rj), "%s must use GPRs", __func__);
+	return WriteFixupBranch((u32)Opcode32::BEQZ | (EncReg(rj) << 5), FixupBranchType::BZ21);
+}
+
+FixupBranch LoongArch64Emitter::BNEZ(LoongArch64Reg rj) {
+	_assert_msg_(IsGPR(rj), "%s must use GPRs", __func__);
+	return WriteFixupBranch((u32)Opcode32::BNEZ | (EncReg(rj) << 5), FixupBranchType::BZ21);
+}
+
+FixupBranch LoongArch64Emitter::BCEQZ(LoongArch64CFR cj) {
+	return WriteFixupBranch((u32)Opcode32::BCEQZ | ((u32)cj << 5), FixupBranchType::BZ21);
+}
+
+FixupBranch LoongArch64Emitter::BCNEZ(LoongArch64CFR cj) {
+	return WriteFixupBranch((u32)Opcode32::BCNEZ | ((u32)cj << 5), FixupBranchType::BZ21);
+}
+
+#define GPR_3R(name) \
+void LoongArch64Emitter::name(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk) { \
+	_assert_msg_(IsGPR(rd) && IsGPR(rj) && IsGPR(rk), "%s must use GPRs", __func__); \
+	Write32(Encode3R(Opcode32::name, EncReg(rd), EncReg(rj), EncReg(rk))); \
+}
+
+GPR_3R(ADD_W)
+GPR_3R(ADD_D)
+GPR_3R(SUB_W)
+GPR_3R(SUB_D)
+GPR_3R(SLT)
+GPR_3R(SLTU)
+GPR_3R(MASKEQZ)
+GPR_3R(MASKNEZ)
+GPR_3R(AND)
+GPR_3R(OR)
+GPR_3R(NOR)
+GPR_3R(XOR)
+GPR_3R(ANDN)
+GPR_3R(ORN)
+GPR_3R(MUL_W)
+GPR_3R(MULH_W)
+GPR_3R(MULH_WU)
+GPR_3R(MUL_D)
+GPR_3R(MULH_D)
+GPR_3R(MULH_DU)
+GPR_3R(MULW_D_W)
+GPR_3R(MULW_D_WU)
+GPR_3R(DIV_W)
+GPR_3R(MOD_W)
+GPR_3R(DIV_WU)
+GPR_3R(MOD_WU)
+GPR_3R(DIV_D)
+GPR_3R(MOD_D)
+GPR_3R(DIV_DU)
+GPR_3R(MOD_DU)
+GPR_3R(SLL_W)
+GPR_3R(SRL_W)
+GPR_3R(SRA_W)
+GPR_3R(ROTR_W)
+GPR_3R(SLL_D)
+GPR_3R(SRL_D)
+GPR_3R(SRA_D)
+GPR_3R(ROTR_D)
+GPR_3R(LDX_B)
+GPR_3R(LDX_H)
+GPR_3R(LDX_W)
+GPR_3R(LDX_D)
+GPR_3R(LDX_BU)
+GPR_3R(LDX_HU)
+GPR_3R(LDX_WU)
+GPR_3R(STX_B)
+GPR_3R(STX_H)
+GPR_3R(STX_W)
+GPR_3R(STX_D)
+
+#undef GPR_3R
+
+#define GPR_ALSL(name) \
+void LoongArch64Emitter::name(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk, u32 sa) { \
+	_assert_msg_(IsGPR(rd) && IsGPR(rj) && IsGPR(rk), "%s must use GPRs", __func__); \
+	_assert_msg_(sa >= 1 && sa <= 4, "%s shift out of range: %d", __func__, sa); \
+	Write32(Encode3R(Opcode32::name, EncReg(rd), EncReg(rj), EncReg(rk)) | ((sa - 1) << 15)); \
+}
+
+GPR_ALSL(ALSL_W)
+GPR_ALSL(ALSL_WU)
+GPR_ALSL(ALSL_D)
+
+#undef GPR_ALSL
+
+#define GPR_2RI12(name) \
+void LoongArch64Emitter::name(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12) { \
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__); \
+	Write32(Encode2RI12(Opcode32::name, EncReg(rd), EncReg(rj), si12)); \
+}
+
+GPR_2RI12(ADDI_W)
+GPR_2RI12(ADDI_D)
+GPR_2RI12(SLTI)
+GPR_2RI12(SLTUI)
+GPR_2RI12(LU52I_D)
+GPR_2RI12(LD_B)
+GPR_2RI12(LD_H)
+GPR_2RI12(LD_W)
+GPR_2RI12(LD_D)
+GPR_2RI12(LD_BU)
+GPR_2RI12(LD_HU)
+GPR_2RI12(LD_WU)
+GPR_2RI12(ST_B)
+GPR_2RI12(ST_H)
+GPR_2RI12(ST_W)
+GPR_2RI12(ST_D)
+
+#undef GPR_2RI12
+
+#define GPR_2RUI(name, bits) \
+void LoongArch64Emitter::name(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui) { \
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__); \
+	Write32(Encode2RUI(Opcode32::name, EncReg(rd), EncReg(rj), ui, bits)); \
+}
+
+GPR_2RUI(ANDI, 12)
+GPR_2RUI(ORI, 12)
+GPR_2RUI(XORI, 12)
+GPR_2RUI(SLLI_W, 5)
+GPR_2RUI(SRLI_W, 5)
+GPR_2RUI(SRAI_W, 5)
+GPR_2RUI(ROTRI_W, 5)
+GPR_2RUI(SLLI_D, 6)
+GPR_2RUI(SRLI_D, 6)
+GPR_2RUI(SRAI_D, 6)
+GPR_2RUI(ROTRI_D, 6)
+
+#undef GPR_2RUI
+
+#define GPR_2R(name) \
+void LoongArch64Emitter::name(LoongArch64Reg rd, LoongArch64Reg rj) { \
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__); \
+	Write32(Encode2R(Opcode32::name, EncReg(rd), EncReg(rj))); \
+}
+
+GPR_2R(EXT_W_B)
+GPR_2R(EXT_W_H)
+GPR_2R(CLO_W)
+GPR_2R(CLZ_W)
+GPR_2R(CTO_W)
+GPR_2R(CTZ_W)
+GPR_2R(CLZ_D)
+GPR_2R(REVB_2H)
+GPR_2R(REVB_2W)
+GPR_2R(REVH_2W)
+GPR_2R(BITREV_W)
+
+#undef GPR_2R
+
+void LoongArch64Emitter::ADDU16I_D(LoongArch64Reg rd, LoongArch64Reg rj, s32 si16) {
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__);
+	Write32(Encode2RI16(Opcode32::ADDU16I_D, EncReg(rd), EncReg(rj), si16));
+}
+
+#define GPR_1RI20(name) \
+void LoongArch64Emitter::name(LoongArch64Reg rd, s32 si20) { \
+	_assert_msg_(IsGPR(rd), "%s must use GPRs", __func__); \
+	Write32(Encode1RI20(Opcode32::name, EncReg(rd), si20)); \
+}
+
+GPR_1RI20(LU12I_W)
+GPR_1RI20(LU32I_D)
+GPR_1RI20(PCADDI)
+GPR_1RI20(PCADDU12I)
+GPR_1RI20(PCADDU18I)
+
+#undef GPR_1RI20
+
+void LoongArch64Emitter::BSTRINS_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbw, u32 lsbw) {
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__);
+	_assert_msg_(msbw < 32 && lsbw <= msbw, "%s invalid bit range %d-%d", __func__, msbw, lsbw);
+	Write32((u32)Opcode32::BSTRINS_W | (msbw << 16) | (lsbw << 10) | (EncReg(rj) << 5) | EncReg(rd));
+}
+
+void LoongArch64Emitter::BSTRPICK_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbw, u32 lsbw) {
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__);
+	_assert_msg_(msbw < 32 && lsbw <= msbw, "%s invalid bit range %d-%d", __func__, msbw, lsbw);
+	Write32((u32)Opcode32::BSTRPICK_W | (msbw << 16) | (lsbw << 10) | (EncReg(rj) << 5) | EncReg(rd));
+}
+
+void LoongArch64Emitter::BSTRINS_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbd, u32 lsbd) {
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__);
+	_assert_msg_(msbd < 64 && lsbd <= msbd, "%s invalid bit range %d-%d", __func__, msbd, lsbd);
+	Write32((u32)Opcode32::BSTRINS_D | (msbd << 16) | (lsbd << 10) | (EncReg(rj) << 5) | EncReg(rd));
+}
+
+void LoongArch64Emitter::BSTRPICK_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbd, u32 lsbd) {
+	_assert_msg_(IsGPR(rd) && IsGPR(rj), "%s must use GPRs", __func__);
+	_assert_msg_(msbd < 64 && lsbd <= msbd, "%s invalid bit range %d-%d", __func__, msbd, lsbd);
+	Write32((u32)Opcode32::BSTRPICK_D | (msbd << 16) | (lsbd << 10) | (EncReg(rj) << 5) | EncReg(rd));
+}
+
+void LoongArch64Emitter::DBAR(u32 hint) {
+	_assert_msg_(hint < 0x8000, "%s hint out of range", __func__);
+	Write32((u32)Opcode32::DBAR | hint);
+}
+
+void LoongArch64Emitter::IBAR(u32 hint) {
+	_assert_msg_(hint < 0x8000, "%s hint out of range", __func__);
+	Write32((u32)Opcode32::IBAR | hint);
+}
+
+void LoongArch64Emitter::BREAK(u32 code) {
+	_assert_msg_(code < 0x8000, "%s code out of range", __func__);
+	Write32((u32)Opcode32::BREAK | code);
+}
+
+#define FPR_3R(name) \
+void LoongArch64Emitter::name(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk) { \
+	_assert_msg_(IsFPR(fd) && IsFPR(fj) && IsFPR(fk), "%s must use FPRs", __func__); \
+	Write32(Encode3R(Opcode32::name, EncReg(fd), EncReg(fj), EncReg(fk))); \
+}
+
+FPR_3R(FADD_S)
+FPR_3R(FSUB_S)
+FPR_3R(FMUL_S)
+FPR_3R(FDIV_S)
+FPR_3R(FMAX_S)
+FPR_3R(FMIN_S)
+FPR_3R(FCOPYSIGN_S)
+
+#undef FPR_3R
+
+void LoongArch64Emitter::FMADD_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk, LoongArch64Reg fa) {
+	_assert_msg_(IsFPR(fd) && IsFPR(fj) && IsFPR(fk) && IsFPR(fa), "%s must use FPRs", __func__);
+	Write32(Encode4R(Opcode32::FMADD_S, EncReg(fd), EncReg(fj), EncReg(fk), EncReg(fa)));
+}
+
+void LoongArch64Emitter::FMSUB_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk, LoongArch64Reg fa) {
+	_assert_msg_(IsFPR(fd) && IsFPR(fj) && IsFPR(fk) && IsFPR(fa), "%s must use FPRs", __func__);
+	Write32(Encode4R(Opcode32::FMSUB_S, EncReg(fd), EncReg(fj), EncReg(fk), EncReg(fa)));
+}
+
+#define FPR_2R(name) \
+void LoongArch64Emitter::name(LoongArch64Reg fd, LoongArch64Reg fj) { \
+	_assert_msg_(IsFPR(fd) && IsFPR(fj), "%s must use FPRs", __func__); \
+	Write32(Encode2R(Opcode32::name, EncReg(fd), EncReg(fj))); \
+}
+
+FPR_2R(FABS_S)
+FPR_2R(FNEG_S)
+FPR_2R(FSQRT_S)
+FPR_2R(FRECIP_S)
+FPR_2R(FRSQRT_S)
+FPR_2R(FCLASS_S)
+FPR_2R(FMOV_S)
+FPR_2R(FMOV_D)
+FPR_2R(FFINT_S_W)
+FPR_2R(FTINT_W_S)
+FPR_2R(FTINTRM_W_S)
+FPR_2R(FTINTRP_W_S)
+FPR_2R(FTINTRZ_W_S)
+FPR_2R(FTINTRNE_W_S)
+
+#undef FPR_2R
+
+void LoongArch64Emitter::FSEL(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk, LoongArch64CFR ca) {
+	_assert_msg_(IsFPR(fd) && IsFPR(fj) && IsFPR(fk), "%s must use FPRs", __func__);
+	Write32(Encode4R(Opcode32::FSEL, EncReg(fd), EncReg(fj), EncReg(fk), (u32)ca));
+}
+
+void LoongArch64Emitter::FCMP_S(FCond cond, LoongArch64CFR cd, LoongArch64Reg fj, LoongArch64Reg fk) {
+	_assert_msg_(IsFPR(fj) && IsFPR(fk), "%s must use FPRs", __func__);
+	Write32(Encode4R(Opcode32::FCMP_S, (u32)cd, EncReg(fj), EncReg(fk), (u32)cond));
+}
+
+void LoongArch64Emitter::MOVGR2FR_W(LoongArch64Reg fd, LoongArch64Reg rj) {
+	_assert_msg_(IsFPR(fd) && IsGPR(rj), "%s must use FPR and GPR", __func__);
+	Write32(Encode2R(Opcode32::MOVGR2FR_W, EncReg(fd), EncReg(rj)));
+}
+
+void LoongArch64Emitter::MOVFR2GR_S(LoongArch64Reg rd, LoongArch64Reg fj) {
+	_assert_msg_(IsGPR(rd) && IsFPR(fj), "%s must use GPR and FPR", __func__);
+	Write32(Encode2R(Opcode32::MOVFR2GR_S, EncReg(rd), EncReg(fj)));
+}
+
+void LoongArch64Emitter::MOVGR2FCSR(LoongArch64FCSR fcsr, LoongArch64Reg rj) {
+	_assert_msg_(IsGPR(rj), "%s must use GPRs", __func__);
+	Write32(Encode2R(Opcode32::MOVGR2FCSR, (u32)fcsr, EncReg(rj)));
+}
+
+void LoongArch64Emitter::MOVFCSR2GR(LoongArch64Reg rd, LoongArch64FCSR fcsr) {
+	_assert_msg_(IsGPR(rd), "%s must use GPRs", __func__);
+	Write32(Encode2R(Opcode32::MOVFCSR2GR, EncReg(rd), (u32)fcsr));
+}
+
+void LoongArch64Emitter::MOVGR2CF(LoongArch64CFR cd, LoongArch64Reg rj) {
+	_assert_msg_(IsGPR(rj), "%s must use GPRs", __func__);
+	Write32(Encode2R(Opcode32::MOVGR2CF, (u32)cd, EncReg(rj)));
+}
+
+void LoongArch64Emitter::MOVCF2GR(LoongArch64Reg rd, LoongArch64CFR cj) {
+	_assert_msg_(IsGPR(rd), "%s must use GPRs", __func__);
+	Write32(Encode2R(Opcode32::MOVCF2GR, EncReg(rd), (u32)cj));
+}
+
+#define FPR_LS(name) \
+void LoongArch64Emitter::name(LoongArch64Reg fd, LoongArch64Reg rj, s32 si12) { \
+	_assert_msg_(IsFPR(fd) && IsGPR(rj), "%s must use FPR and GPR", __func__); \
+	Write32(Encode2RI12(Opcode32::name, EncReg(fd), EncReg(rj), si12)); \
+}
+
+FPR_LS(FLD_S)
+FPR_LS(FLD_D)
+FPR_LS(FST_S)
+FPR_LS(FST_D)
+
+#undef FPR_LS
+
+void LoongArch64Emitter::FLDX_S(LoongArch64Reg fd, LoongArch64Reg rj, LoongArch64Reg rk) {
+	_assert_msg_(IsFPR(fd) && IsGPR(rj) && IsGPR(rk), "%s must use FPR and GPRs", __func__);
+	Write32(Encode3R(Opcode32::FLDX_S, EncReg(fd), EncReg(rj), EncReg(rk)));
+}
+
+void LoongArch64Emitter::FSTX_S(LoongArch64Reg fd, LoongArch64Reg rj, LoongArch64Reg rk) {
+	_assert_msg_(IsFPR(fd) && IsGPR(rj) && IsGPR(rk), "%s must use FPR and GPRs", __func__);
+	Write32(Encode3R(Opcode32::FSTX_S, EncReg(fd), EncReg(rj), EncReg(rk)));
+}
+
+void LoongArch64Emitter::VLD(LoongArch64Reg vd, LoongArch64Reg rj, s32 si12) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsGPR(rj), "%s must use VPR and GPR", __func__);
+	Write32(Encode2RI12(Opcode32::VLD, EncReg(vd), EncReg(rj), si12));
+}
+
+void LoongArch64Emitter::VST(LoongArch64Reg vd, LoongArch64Reg rj, s32 si12) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsGPR(rj), "%s must use VPR and GPR", __func__);
+	Write32(Encode2RI12(Opcode32::VST, EncReg(vd), EncReg(rj), si12));
+}
+
+void LoongArch64Emitter::VLDX(LoongArch64Reg vd, LoongArch64Reg rj, LoongArch64Reg rk) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsGPR(rj) && IsGPR(rk), "%s must use VPR and GPRs", __func__);
+	Write32(Encode3R(Opcode32::VLDX, EncReg(vd), EncReg(rj), EncReg(rk)));
+}
+
+void LoongArch64Emitter::VSTX(LoongArch64Reg vd, LoongArch64Reg rj, LoongArch64Reg rk) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsGPR(rj) && IsGPR(rk), "%s must use VPR and GPRs", __func__);
+	Write32(Encode3R(Opcode32::VSTX, EncReg(vd), EncReg(rj), EncReg(rk)));
+}
+
+#define VPR_3R(name) \
+void LoongArch64Emitter::name(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk) { \
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__); \
+	_assert_msg_(IsVPR(vd) && IsVPR(vj) && IsVPR(vk), "%s must use VPRs", __func__); \
+	Write32(Encode3R(Opcode32::name, EncReg(vd), EncReg(vj), EncReg(vk))); \
+}
+
+VPR_3R(VFADD_S)
+VPR_3R(VFSUB_S)
+VPR_3R(VFMUL_S)
+VPR_3R(VFDIV_S)
+VPR_3R(VFMAX_S)
+VPR_3R(VFMIN_S)
+VPR_3R(VADD_W)
+VPR_3R(VSUB_W)
+VPR_3R(VMAX_W)
+VPR_3R(VMIN_W)
+VPR_3R(VAND_V)
+VPR_3R(VOR_V)
+VPR_3R(VXOR_V)
+VPR_3R(VNOR_V)
+VPR_3R(VANDN_V)
+
+#undef VPR_3R
+
+void LoongArch64Emitter::VFMADD_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk, LoongArch64Reg va) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsVPR(vj) && IsVPR(vk) && IsVPR(va), "%s must use VPRs", __func__);
+	Write32(Encode4R(Opcode32::VFMADD_S, EncReg(vd), EncReg(vj), EncReg(vk), EncReg(va)));
+}
+
+void LoongArch64Emitter::VBITSEL_V(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk, LoongArch64Reg va) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsVPR(vj) && IsVPR(vk) && IsVPR(va), "%s must use VPRs", __func__);
+	Write32(Encode4R(Opcode32::VBITSEL_V, EncReg(vd), EncReg(vj), EncReg(vk), EncReg(va)));
+}
+
+void LoongArch64Emitter::VFCMP_S(FCond cond, LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsVPR(vj) && IsVPR(vk), "%s must use VPRs", __func__);
+	Write32(Encode4R(Opcode32::VFCMP_S, EncReg(vd), EncReg(vj), EncReg(vk), (u32)cond));
+}
+
+#define VPR_2R(name) \
+void LoongArch64Emitter::name(LoongArch64Reg vd, LoongArch64Reg vj) { \
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__); \
+	_assert_msg_(IsVPR(vd) && IsVPR(vj), "%s must use VPRs", __func__); \
+	Write32(Encode2R(Opcode32::name, EncReg(vd), EncReg(vj))); \
+}
+
+VPR_2R(VFSQRT_S)
+VPR_2R(VFRECIP_S)
+VPR_2R(VFRSQRT_S)
+
+#undef VPR_2R
+
+#define VPR_2RUI(name, bits) \
+void LoongArch64Emitter::name(LoongArch64Reg vd, LoongArch64Reg vj, u32 ui) { \
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__); \
+	_assert_msg_(IsVPR(vd) && IsVPR(vj), "%s must use VPRs", __func__); \
+	Write32(Encode2RUI(Opcode32::name, EncReg(vd), EncReg(vj), ui, bits)); \
+}
+
+VPR_2RUI(VSLLI_W, 5)
+VPR_2RUI(VSRLI_W, 5)
+VPR_2RUI(VSRAI_W, 5)
+VPR_2RUI(VBITCLRI_W, 5)
+VPR_2RUI(VBITSETI_W, 5)
+VPR_2RUI(VBITREVI_W, 5)
+
+#undef VPR_2RUI
+
+void LoongArch64Emitter::VSHUF4I_W(LoongArch64Reg vd, LoongArch64Reg vj, u8 ui8) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsVPR(vj), "%s must use VPRs", __func__);
+	Write32(Encode2RUI(Opcode32::VSHUF4I_W, EncReg(vd), EncReg(vj), ui8, 8));
+}
+
+void LoongArch64Emitter::VEXTRINS_W(LoongArch64Reg vd, LoongArch64Reg vj, u8 destLane, u8 srcLane) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsVPR(vj), "%s must use VPRs", __func__);
+	_assert_msg_(destLane < 4 && srcLane < 4, "%s lane out of range", __func__);
+	Write32(Encode2RUI(Opcode32::VEXTRINS_W, EncReg(vd), EncReg(vj), (destLane << 4) | srcLane, 8));
+}
+
+void LoongArch64Emitter::VREPLVEI_W(LoongArch64Reg vd, LoongArch64Reg vj, u8 lane) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsVPR(vj), "%s must use VPRs", __func__);
+	Write32(Encode2RUI(Opcode32::VREPLVEI_W, EncReg(vd), EncReg(vj), lane, 2));
+}
+
+void LoongArch64Emitter::VREPLGR2VR_W(LoongArch64Reg vd, LoongArch64Reg rj) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsGPR(rj), "%s must use VPR and GPR", __func__);
+	Write32(Encode2R(Opcode32::VREPLGR2VR_W, EncReg(vd), EncReg(rj)));
+}
+
+void LoongArch64Emitter::VINSGR2VR_W(LoongArch64Reg vd, LoongArch64Reg rj, u8 lane) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsVPR(vd) && IsGPR(rj), "%s must use VPR and GPR", __func__);
+	Write32(Encode2RUI(Opcode32::VINSGR2VR_W, EncReg(vd), EncReg(rj), lane, 2));
+}
+
+void LoongArch64Emitter::VPICKVE2GR_W(LoongArch64Reg rd, LoongArch64Reg vj, u8 lane) {
+	_assert_msg_(SupportsLSX(), "%s requires LSX", __func__);
+	_assert_msg_(IsGPR(rd) && IsVPR(vj), "%s must use GPR and VPR", __func__);
+	Write32(Encode2RUI(Opcode32::VPICKVE2GR_W, EncReg(rd), EncReg(vj), lane, 2));
+}
+
+void LoongArch64CodeBlock::PoisonMemory(int offset) {
+	// So we can adjust region to writable space.  Might be zero.
+	ptrdiff_t writable = writable_ - code_;
+
+	u32 *ptr = (u32 *)(region + offset + writable);
+	u32 *maxptr = (u32 *)(region + region_size - offset + writable);
+	// LoongArch: 0x002A0000 = BREAK 0
+	while (ptr + 1 <= maxptr)
+		*ptr++ = 0x002A0000;
+}
+
+};
@@ -0,0 +1,497 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "Common/CodeBlock.h"
+#include "Common/Common.h"
+
+namespace LoongArch64Gen {
+
+enum LoongArch64Reg {
+	R0 = 0, R1, R2, R3, R4, R5, R6, R7,
+	R8, R9, R10, R11, R12, R13, R14, R15,
+	R16, R17, R18, R19, R20, R21, R22, R23,
+	R24, R25, R26, R27, R28, R29, R30, R31,
+
+	R_ZERO = 0,
+	R_RA = 1,
+	R_TP = 2,
+	R_SP = 3,
+	R_FP = 22,
+
+	F0 = 0x20, F1, F2, F3, F4, F5, F6, F7,
+	F8, F9, F10, F11, F12, F13, F14, F15,
+	F16, F17, F18, F19, F20, F21, F22, F23,
+	F24, F25, F26, F27, F28, F29, F30, F31,
+
+	// LSX registers, which alias the FPRs.  The low 32/64 bits of Vn are Fn.
+	V0 = 0x40, V1, V2, V3, V4, V5, V6, V7,
+	V8, V9, V10, V11, V12, V13, V14, V15,
+	V16, V17, V18, V19, V20, V21, V22, V23,
+	V24, V25, V26, V27, V28, V29, V30, V31,
+
+	INVALID_REG = 0xFFFFFFFF,
+};
+
+// Returns the LSX register that aliases the given FPR.
+inline LoongArch64Reg EncodeRegToV(LoongArch64Reg reg) {
+	return (LoongArch64Reg)(V0 + ((int)reg & 0x1F));
+}
+
+enum LoongArch64CFR {
+	FCC0 = 0, FCC1, FCC2, FCC3, FCC4, FCC5, FCC6, FCC7,
+};
+
+enum LoongArch64FCSR {
+	FCSR0 = 0, FCSR1, FCSR2, FCSR3,
+};
+
+// Used for both FCMP and VFCMP.  The S variants signal on quiet NaNs too.
+enum class FCond {
+	CAF = 0x00,
+	SAF = 0x01,
+	CLT = 0x02,
+	SLT = 0x03,
+	CEQ = 0x04,
+	SEQ = 0x05,
+	CLE = 0x06,
+	SLE = 0x07,
+	CUN = 0x08,
+	SUN = 0x09,
+	CULT = 0x0A,
+	SULT = 0x0B,
+	CUEQ = 0x0C,
+	SUEQ = 0x0D,
+	CULE = 0x0E,
+	SULE = 0x0F,
+	CNE = 0x10,
+	SNE = 0x11,
+	COR = 0x14,
+	SOR = 0x15,
+	CUNE = 0x18,
+	SUNE = 0x19,
+};
+
+// Bits returned by FCLASS.S.
+enum class FClass {
+	SIGNALING_NAN = 1 << 0,
+	QUIET_NAN = 1 << 1,
+	NEG_INF = 1 << 2,
+	NEG_NORMAL = 1 << 3,
+	NEG_SUBNORMAL = 1 << 4,
+	NEG_ZERO = 1 << 5,
+	POS_INF = 1 << 6,
+	POS_NORMAL = 1 << 7,
+	POS_SUBNORMAL = 1 << 8,
+	POS_ZERO = 1 << 9,
+};
+
+enum class FixupBranchType {
+	// Conditional two register branches, 16-bit offset.
+	B16,
+	// BEQZ/BNEZ/BCEQZ/BCNEZ, 21-bit offset.
+	BZ21,
+	// B/BL, 26-bit offset.
+	J26,
+};
+
+struct FixupBranch {
+	FixupBranch() {}
+	FixupBranch(const u8 *p, FixupBranchType t) : ptr(p), type(t) {}
+	FixupBranch(FixupBranch &&other);
+	FixupBranch(const FixupBranch &) = delete;
+	~FixupBranch();
+
+	FixupBranch &operator =(FixupBranch &&other);
+	FixupBranch &operator =(const FixupBranch &other) = delete;
+
+	const u8 *ptr = nullptr;
+	FixupBranchType type = FixupBranchType::B16;
+};
+
+class LoongArch64Emitter {
+public:
+	LoongArch64Emitter() {}
+	LoongArch64Emitter(const u8 *codePtr, u8 *writablePtr);
+	virtual ~LoongArch64Emitter() {}
+
+	void SetCodePointer(const u8 *ptr, u8 *writePtr);
+	const u8 *GetCodePointer() const;
+	u8 *GetWritableCodePtr();
+
+	void ReserveCodeSpace(u32 bytes);
+	const u8 *AlignCode16();
+	const u8 *AlignCodePage();
+	void FlushIcache();
+	void FlushIcacheSection(const u8 *start, const u8 *end);
+
+	void SetJumpTarget(FixupBranch &branch);
+	bool BranchInRange(const void *func) const;
+	bool BranchZeroInRange(const void *func) const;
+	bool JumpInRange(const void *func) const;
+
+	void QuickJ(LoongArch64Reg scratchreg, const u8 *dst);
+	void QuickCallFunction(const u8 *func, LoongArch64Reg scratchreg = R_RA);
+	template <typename T>
+	void QuickCallFunction(T *func, LoongArch64Reg scratchreg = R_RA) {
+		static_assert(std::is_function<T>::value, "QuickCallFunction without function");
+		QuickCallFunction((const u8 *)func, scratchreg);
+	}
+
+	// Branches.  Note that the two register forms only reach +/- 128 KB.
+	void B(const void *dst);
+	FixupBranch B();
+	void BL(const void *dst);
+	FixupBranch BL();
+	void JIRL(LoongArch64Reg rd, LoongArch64Reg rj, s32 offs18);
+	void JR(LoongArch64Reg rj, s32 offs18 = 0) {
+		JIRL(R_ZERO, rj, offs18);
+	}
+	void RET() {
+		JR(R_RA);
+	}
+
+	void BEQ(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst);
+	void BNE(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst);
+	void BLT(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst);
+	void BGE(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst);
+	void BLTU(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst);
+	void BGEU(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst);
+	FixupBranch BEQ(LoongArch64Reg rj, LoongArch64Reg rd);
+	FixupBranch BNE(LoongArch64Reg rj, LoongArch64Reg rd);
+	FixupBranch BLT(LoongArch64Reg rj, LoongArch64Reg rd);
+	FixupBranch BGE(LoongArch64Reg rj, LoongArch64Reg rd);
+	FixupBranch BLTU(LoongArch64Reg rj, LoongArch64Reg rd);
+	FixupBranch BGEU(LoongArch64Reg rj, LoongArch64Reg rd);
+	void BEQZ(LoongArch64Reg rj, const void *dst);
+	void BNEZ(LoongArch64Reg rj, const void *dst);
+	FixupBranch BEQZ(LoongArch64Reg rj);
+	FixupBranch BNEZ(LoongArch64Reg rj);
+	FixupBranch BCEQZ(LoongArch64CFR cj);
+	FixupBranch BCNEZ(LoongArch64CFR cj);
+
+	// Convenience pseudo-instructions.
+	void BGT(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst) {
+		BLT(rd, rj, dst);
+	}
+	void BLE(LoongArch64Reg rj, LoongArch64Reg rd, const void *dst) {
+		BGE(rd, rj, dst);
+	}
+	FixupBranch BGT(LoongArch64Reg rj, LoongArch64Reg rd) {
+		return BLT(rd, rj);
+	}
+	FixupBranch BLE(LoongArch64Reg rj, LoongArch64Reg rd) {
+		return BGE(rd, rj);
+	}
+
+	void NOP() {
+		ANDI(R_ZERO, R_ZERO, 0);
+	}
+	void MOVE(LoongArch64Reg rd, LoongArch64Reg rj) {
+		OR(rd, rj, R_ZERO);
+	}
+	void NOT(LoongArch64Reg rd, LoongArch64Reg rj) {
+		NOR(rd, rj, R_ZERO);
+	}
+	// Sign extends the low 32 bits.
+	void SEXT_W(LoongArch64Reg rd, LoongArch64Reg rj) {
+		ADDI_W(rd, rj, 0);
+	}
+	// Zero extends the low 32 bits.
+	void ZEXT_W(LoongArch64Reg rd, LoongArch64Reg rj) {
+		BSTRPICK_D(rd, rj, 31, 0);
+	}
+
+	template <typename T>
+	void LI(LoongArch64Reg rd, const T &v) {
+		_assert_msg_(rd != R_ZERO, "LI to R0");
+		_assert_msg_(rd < F0, "LI to non-GPR");
+
+		uint64_t value = AsImmediate<T, std::is_signed<T>::value>(v);
+		SetRegToImmediate(rd, value);
+	}
+
+	void ADD_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void ADD_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SUB_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SUB_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void ADDI_W(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void ADDI_D(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void ADDU16I_D(LoongArch64Reg rd, LoongArch64Reg rj, s32 si16);
+	// Computes rd = (rj << sa) + rk, with sa from 1 to 4.
+	void ALSL_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk, u32 sa);
+	void ALSL_WU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk, u32 sa);
+	void ALSL_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk, u32 sa);
+
+	void LU12I_W(LoongArch64Reg rd, s32 si20);
+	void LU32I_D(LoongArch64Reg rd, s32 si20);
+	void LU52I_D(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void PCADDI(LoongArch64Reg rd, s32 si20);
+	void PCADDU12I(LoongArch64Reg rd, s32 si20);
+	void PCADDU18I(LoongArch64Reg rd, s32 si20);
+
+	void SLT(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SLTU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SLTI(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	// Note: si12 is sign extended, but the comparison is unsigned.
+	void SLTUI(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	// rd = rk == 0 ? 0 : rj
+	void MASKEQZ(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	// rd = rk != 0 ? 0 : rj
+	void MASKNEZ(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+
+	void AND(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void OR(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void NOR(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void XOR(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void ANDN(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void ORN(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	// Note: unlike ADDI, these immediates are zero extended (0 - 4095.)
+	void ANDI(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui12);
+	void ORI(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui12);
+	void XORI(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui12);
+
+	void MUL_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MULH_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MULH_WU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MUL_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MULH_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MULH_DU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	// Full 64-bit product of the low 32 bits of each.
+	void MULW_D_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MULW_D_WU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	// Note: results are undefined for a zero divisor, unlike MIPS.
+	void DIV_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MOD_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void DIV_WU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MOD_WU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void DIV_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MOD_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void DIV_DU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void MOD_DU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+
+	void SLL_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SRL_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SRA_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void ROTR_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SLL_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SRL_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SRA_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void ROTR_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void SLLI_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui5);
+	void SRLI_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui5);
+	void SRAI_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui5);
+	void ROTRI_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui5);
+	void SLLI_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui6);
+	void SRLI_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui6);
+	void SRAI_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui6);
+	void ROTRI_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 ui6);
+
+	void EXT_W_B(LoongArch64Reg rd, LoongArch64Reg rj);
+	void EXT_W_H(LoongArch64Reg rd, LoongArch64Reg rj);
+	void CLO_W(LoongArch64Reg rd, LoongArch64Reg rj);
+	void CLZ_W(LoongArch64Reg rd, LoongArch64Reg rj);
+	void CTO_W(LoongArch64Reg rd, LoongArch64Reg rj);
+	void CTZ_W(LoongArch64Reg rd, LoongArch64Reg rj);
+	void CLZ_D(LoongArch64Reg rd, LoongArch64Reg rj);
+	void REVB_2H(LoongArch64Reg rd, LoongArch64Reg rj);
+	void REVB_2W(LoongArch64Reg rd, LoongArch64Reg rj);
+	void REVH_2W(LoongArch64Reg rd, LoongArch64Reg rj);
+	void BITREV_W(LoongArch64Reg rd, LoongArch64Reg rj);
+	// These keep bits outside [msb, lsb] of rd (BSTRINS) or zero them (BSTRPICK.)
+	// The .W forms sign extend the 32-bit result.
+	void BSTRINS_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbw, u32 lsbw);
+	void BSTRPICK_W(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbw, u32 lsbw);
+	void BSTRINS_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbd, u32 lsbd);
+	void BSTRPICK_D(LoongArch64Reg rd, LoongArch64Reg rj, u32 msbd, u32 lsbd);
+
+	void LD_B(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void LD_H(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void LD_W(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void LD_D(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void LD_BU(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void LD_HU(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void LD_WU(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void ST_B(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void ST_H(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void ST_W(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void ST_D(LoongArch64Reg rd, LoongArch64Reg rj, s32 si12);
+	void LDX_B(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void LDX_H(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void LDX_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void LDX_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void LDX_BU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void LDX_HU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void LDX_WU(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void STX_B(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void STX_H(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void STX_W(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void STX_D(LoongArch64Reg rd, LoongArch64Reg rj, LoongArch64Reg rk);
+
+	void DBAR(u32 hint);
+	void IBAR(u32 hint);
+	void BREAK(u32 code);
+
+	void FADD_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk);
+	void FSUB_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk);
+	void FMUL_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk);
+	void FDIV_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk);
+	void FMAX_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk);
+	void FMIN_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk);
+	void FCOPYSIGN_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk);
+	void FMADD_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk, LoongArch64Reg fa);
+	void FMSUB_S(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk, LoongArch64Reg fa);
+	void FABS_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FNEG_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FSQRT_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FRECIP_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FRSQRT_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FCLASS_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FMOV_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FMOV_D(LoongArch64Reg fd, LoongArch64Reg fj);
+	// fd = ca ? fk : fj
+	void FSEL(LoongArch64Reg fd, LoongArch64Reg fj, LoongArch64Reg fk, LoongArch64CFR ca);
+	void FCMP_S(FCond cond, LoongArch64CFR cd, LoongArch64Reg fj, LoongArch64Reg fk);
+
+	// Conversions.  The result of FTINT stays in an FPR.
+	void FFINT_S_W(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FTINT_W_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FTINTRM_W_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FTINTRP_W_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FTINTRZ_W_S(LoongArch64Reg fd, LoongArch64Reg fj);
+	void FTINTRNE_W_S(LoongArch64Reg fd, LoongArch64Reg fj);
+
+	void MOVGR2FR_W(LoongArch64Reg fd, LoongArch64Reg rj);
+	void MOVFR2GR_S(LoongArch64Reg rd, LoongArch64Reg fj);
+	void MOVGR2FCSR(LoongArch64FCSR fcsr, LoongArch64Reg rj);
+	void MOVFCSR2GR(LoongArch64Reg rd, LoongArch64FCSR fcsr);
+	void MOVGR2CF(LoongArch64CFR cd, LoongArch64Reg rj);
+	void MOVCF2GR(LoongArch64Reg rd, LoongArch64CFR cj);
+
+	void FLD_S(LoongArch64Reg fd, LoongArch64Reg rj, s32 si12);
+	void FLD_D(LoongArch64Reg fd, LoongArch64Reg rj, s32 si12);
+	void FST_S(LoongArch64Reg fd, LoongArch64Reg rj, s32 si12);
+	void FST_D(LoongArch64Reg fd, LoongArch64Reg rj, s32 si12);
+	void FLDX_S(LoongArch64Reg fd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void FSTX_S(LoongArch64Reg fd, LoongArch64Reg rj, LoongArch64Reg rk);
+
+	// LSX (128-bit SIMD) instructions.
+	void VLD(LoongArch64Reg vd, LoongArch64Reg rj, s32 si12);
+	void VST(LoongArch64Reg vd, LoongArch64Reg rj, s32 si12);
+	void VLDX(LoongArch64Reg vd, LoongArch64Reg rj, LoongArch64Reg rk);
+	void VSTX(LoongArch64Reg vd, LoongArch64Reg rj, LoongArch64Reg rk);
+
+	void VFADD_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VFSUB_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VFMUL_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VFDIV_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VFMAX_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VFMIN_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VFMADD_S(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk, LoongArch64Reg va);
+	void VFSQRT_S(LoongArch64Reg vd, LoongArch64Reg vj);
+	void VFRECIP_S(LoongArch64Reg vd, LoongArch64Reg vj);
+	void VFRSQRT_S(LoongArch64Reg vd, LoongArch64Reg vj);
+	void VFCMP_S(FCond cond, LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+
+	void VADD_W(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VSUB_W(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VMAX_W(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VMIN_W(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VAND_V(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VOR_V(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VXOR_V(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VNOR_V(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	void VANDN_V(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk);
+	// vd = (vk & va) | (vj & ~va)
+	void VBITSEL_V(LoongArch64Reg vd, LoongArch64Reg vj, LoongArch64Reg vk, LoongArch64Reg va);
+	void VSLLI_W(LoongArch64Reg vd, LoongArch64Reg vj, u32 ui5);
+	void VSRLI_W(LoongArch64Reg vd, LoongArch64Reg vj, u32 ui5);
+	void VSRAI_W(LoongArch64Reg vd, LoongArch64Reg vj, u32 ui5);
+	void VBITCLRI_W(LoongArch64Reg vd, LoongArch64Reg vj, u32 ui5);
+	void VBITSETI_W(LoongArch64Reg vd, LoongArch64Reg vj, u32 ui5);
+	void VBITREVI_W(LoongArch64Reg vd, LoongArch64Reg vj, u32 ui5);
+
+	// Same 2-bit per lane selector format as the VFPU/IR shuffle.
+	void VSHUF4I_W(LoongArch64Reg vd, LoongArch64Reg vj, u8 ui8);
+	// Copies lane srcLane of vj into lane destLane of vd.
+	void VEXTRINS_W(LoongArch64Reg vd, LoongArch64Reg vj, u8 destLane, u8 srcLane);
+	void VREPLVEI_W(LoongArch64Reg vd, LoongArch64Reg vj, u8 lane);
+	void VREPLGR2VR_W(LoongArch64Reg vd, LoongArch64Reg rj);
+	void VINSGR2VR_W(LoongArch64Reg vd, LoongArch64Reg rj, u8 lane);
+	void VPICKVE2GR_W(LoongArch64Reg rd, LoongArch64Reg vj, u8 lane);
+
+	// Writes a raw instruction word (or data) at the current position.
+	void Write32(u32 value) {
+		*(u32 *)writable_ = value;
+		code_ += 4;
+		writable_ += 4;
+	}
+
+private:
+	void SetJumpTarget(FixupBranch &branch, const void *dst);
+	FixupBranch WriteFixupBranch(u32 op, FixupBranchType type);
+
+	void SetRegToImmediate(LoongArch64Reg rd, uint64_t value);
+
+	template <typename T, bool extend>
+	uint64_t AsImmediate(const T &v) {
+		static_assert(std::is_trivial<T>::value, "Immediate argument must be a simple type");
+		static_assert(sizeof(T) <= 8, "Immediate argument size should be 8, 16, 32, or 64 bits");
+
+		// Copy the type to allow floats and avoid endian issues.
+		if (sizeof(T) == 8) {
+			uint64_t value;
+			memcpy(&value, &v, sizeof(value));
+			return value;
+		} else if (sizeof(T) == 4) {
+			uint32_t value;
+			memcpy(&value, &v, sizeof(value));
+			if (extend)
+				return (int64_t)(int32_t)value;
+			return value;
+		} else if (sizeof(T) == 2) {
+			uint16_t value;
+			memcpy(&value, &v, sizeof(value));
+			if (extend)
+				return (int64_t)(int16_t)value;
+			return value;
+		} else if (sizeof(T) == 1) {
+			uint8_t value;
+			memcpy(&value, &v, sizeof(value));
+			if (extend)
+				return (int64_t)(int8_t)value;
+			return value;
+		}
+		return (uint64_t)v;
+	}
+
+protected:
+	const u8 *code_ = nullptr;
+	u8 *writable_ = nullptr;
+	const u8 *lastCacheFlushEnd_ = nullptr;
+};
+
+class LoongArch64CodeBlock : public CodeBlock<LoongArch64Emitter> {
+private:
+	void PoisonMemory(int offset) override;
+};
+
+};
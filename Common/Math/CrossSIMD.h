@@ -143,6 +143,15 @@ struct Vec4S32 {
 	Vec4S32 Min16(Vec4S32 other) const { return Vec4S32{ _mm_min_epi16(v, other.v) }; }
 	Vec4S32 Max16(Vec4S32 other) const { return Vec4S32{ _mm_max_epi16(v, other.v) }; }
 	Vec4S32 FixupAfterMinMax() const { return SignExtend16(); }
+	// SSE2 has no 32-bit min/max, so these select using a compare.
+	Vec4S32 Min(Vec4S32 other) const {
+		__m128i lt = _mm_cmplt_epi32(v, other.v);
+		return Vec4S32{ _mm_or_si128(_mm_and_si128(lt, v), _mm_andnot_si128(lt, other.v)) };
+	}
+	Vec4S32 Max(Vec4S32 other) const {
+		__m128i gt = _mm_cmpgt_epi32(v, other.v);
+		return Vec4S32{ _mm_or_si128(_mm_and_si128(gt, v), _mm_andnot_si128(gt, other.v)) };
+	}
 
 	Vec4S32 operator +(Vec4S32 other) const { return Vec4S32{ _mm_add_epi32(v, other.v) }; }
 	Vec4S32 operator -(Vec4S32 other) const { return Vec4S32{ _mm_sub_epi32(v, other.v) }; }
@@ -473,6 +482,8 @@ struct Vec4S32 {
 	Vec4S32 Min16(Vec4S32 other) const { return Vec4S32{ vminq_s32(v, other.v) }; }
 	Vec4S32 Max16(Vec4S32 other) const { return Vec4S32{ vmaxq_s32(v, other.v) }; }
 	Vec4S32 FixupAfterMinMax() const { return Vec4S32{ v }; }
+	Vec4S32 Min(Vec4S32 other) const { return Vec4S32{ vminq_s32(v, other.v) }; }
+	Vec4S32 Max(Vec4S32 other) const { return Vec4S32{ vmaxq_s32(v, other.v) }; }
 
 	// NOTE: May be slow.
 	int operator[](size_t index) const { return ((int *)&v)[index]; }
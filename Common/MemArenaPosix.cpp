@@ -23,6 +23,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #include <cerrno>
 #include <cstring>
 #include <string>
@@ -44,7 +47,13 @@ static const std::string tmpfs_ram_temp_file = "/dev/shm/gc_mem.tmp";
 std::string ram_temp_file = "/tmp/gc_mem.tmp";
 
 size_t MemArena::roundup(size_t x) {
+#ifdef __linux__
+	// Huge pages can only back a view when its offset in the file lines up with its address, so
+	// keep every view at a multiple of the huge page size.  The file is sparse, the padding is free.
+	return (x + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+#else
 	return x;
+#endif
 }
 
 bool MemArena::NeedsProbing() {
@@ -58,7 +67,16 @@ bool MemArena::GrabMemSpace(size_t size) {
 	// Try a few times in case multiple instances are started near each other.
 	char ram_temp_filename[128]{};
 	bool is_shm = false;
-	for (int i = 0; i < 256; ++i) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+	// Unlike files in /dev/shm, memfds follow /sys/kernel/mm/transparent_hugepage/shmem_enabled, so
+	// these can get huge pages.  Also, there's no name to clash with other instances.
+	fd = (int)syscall(SYS_memfd_create, "ppsspp_ram", 1 /* MFD_CLOEXEC */);
+	if (fd >= 0) {
+		INFO_LOG(Log::MemMap, "Got memfd for ram");
+		is_shm = true;
+	}
+#endif
+	for (int i = 0; i < 256 && fd < 0; ++i) {
 		snprintf(ram_temp_filename, sizeof(ram_temp_filename), "/ppsspp_%d.ram", i);
 		// This opens atomically, so will fail if another process is starting.
 		fd = shm_open(ram_temp_filename, O_RDWR | O_CREAT | O_EXCL, mode);
@@ -125,6 +143,7 @@ void *MemArena::CreateView(s64 offset, size_t size, void *base)
 		NOTICE_LOG(Log::MemMap, "mmap on %s (fd: %d) failed: %s", ram_temp_file.c_str(), (int)fd, strerror(errno));
 		return 0;
 	}
+	AdviseHugePages(retval, size);
 	return retval;
 #endif
 }
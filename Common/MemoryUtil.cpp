@@ -194,6 +194,9 @@ void *AllocateExecutableMemory(size_t size) {
 	if (ptr == MAP_FAILED) {
 		ptr = nullptr;
 		ERROR_LOG(Log::MemMap, "Failed to allocate executable memory (%d) errno=%d", (int)size, errno);
+	} else if (!PlatformIsWXExclusive()) {
+		// With W^X, reprotecting would keep splitting the huge pages up again.
+		AdviseHugePages(ptr, size);
 	}
 
 #if PPSSPP_ARCH(AMD64)
@@ -355,4 +358,16 @@ int GetMemoryProtectPageSize() {
 #endif
 	return MEM_PAGE_SIZE;
 }
+
+void AdviseHugePages(void *ptr, size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	// Only aligned huge pages fully inside the range can be used, so smaller ones don't gain anything.
+	if (!ptr || size < HUGE_PAGE_SIZE)
+		return;
+	if (madvise(ptr, size, MADV_HUGEPAGE) != 0) {
+		// Kernels without THP say EINVAL, that's fine.
+		VERBOSE_LOG(Log::MemMap, "madvise(MADV_HUGEPAGE) failed (%p, %d): %s", ptr, (int)size, strerror(errno));
+	}
+#endif
+}
 #endif // !PPSSPP_PLATFORM(SWITCH)
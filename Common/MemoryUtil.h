@@ -52,6 +52,11 @@ void FreeAlignedMemory(void* ptr);
 
 int GetMemoryProtectPageSize();
 
+// Asks for a mapping to be backed by huge pages (transparent huge pages on Linux), for fewer TLB misses.
+// Only a hint, whether it does anything depends on the system settings.  Ignored where unsupported.
+void AdviseHugePages(void *ptr, size_t size);
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
 // A buffer that uses aligned memory. Can be useful for image processing.
 template <typename T, size_t A>
 class AlignedVector {
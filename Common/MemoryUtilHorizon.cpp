@@ -86,4 +86,8 @@ bool ProtectMemoryPages(const void* ptr, size_t size, uint32_t memProtFlags) {
 int GetMemoryProtectPageSize() {
 	return MEM_PAGE_SIZE;
 }
+
+void AdviseHugePages(void *ptr, size_t size) {
+	// Not supported on Switch
+}
 #endif // PPSSPP_PLATFORM(SWITCH)
@@ -365,7 +365,7 @@ int Client::SendRequestWithData(const char *method, const RequestParams &req, co
 		"Host: %s\r\n"
 		"User-Agent: %s\r\n"
 		"Accept: %s\r\n"
-		"Connection: close\r\n"
+		"Connection: %s\r\n"
 		"%s"
 		"\r\n";
 
@@ -374,6 +374,7 @@ int Client::SendRequestWithData(const char *method, const RequestParams &req, co
 		host_.c_str(),
 		userAgent_.c_str(),
 		req.acceptMime,
+		keepAlive_ ? "keep-alive" : "close",
 		otherHeaders ? otherHeaders : "");
 	buffer.Append(data);
 	bool flushed = buffer.FlushSocket(sock(), dataTimeout_, progress->cancelled);
@@ -441,6 +442,7 @@ int Client::ReadResponseEntity(net::Buffer *readbuf, const std::vector<std::stri
 
 	bool gzip = false;
 	bool chunked = false;
+	bool hasContentLength = false;
 	int contentLength = 0;
 	for (std::string line : responseHeaders) {
 		if (startsWithNoCase(line, "Content-Length:")) {
@@ -450,6 +452,7 @@ int Client::ReadResponseEntity(net::Buffer *readbuf, const std::vector<std::stri
 			}
 			if (size_pos != line.npos) {
 				contentLength = atoi(&line[size_pos]);
+				hasContentLength = true;
 				chunked = false;
 			}
 		} else if (startsWithNoCase(line, "Content-Encoding:")) {
@@ -471,8 +474,12 @@ int Client::ReadResponseEntity(net::Buffer *readbuf, const std::vector<std::stri
 		contentLength = 0;
 	}
 
-	if (!readbuf->ReadAllWithProgress(sock(), contentLength, progress))
+	if (keepAlive_ && hasContentLength && !chunked) {
+		if (!readbuf->ReadSizeWithProgress(sock(), contentLength, progress))
+			return -1;
+	} else if (!readbuf->ReadAllWithProgress(sock(), contentLength, progress)) {
 		return -1;
+	}
 
 	// output now contains the rest of the reply. Dechunk it.
 	if (!output->IsVoid()) {
@@ -83,9 +83,16 @@ class Client : public net::Connection {
 		userAgent_ = value;
 	}
 
+	// Asks the server to keep the connection open after each response.
+	// Entities are then read by Content-Length, since the server won't close to end them.
+	void SetKeepAlive(bool keepAlive) {
+		keepAlive_ = keepAlive;
+	}
+
 protected:
 	std::string userAgent_;
 	double dataTimeout_ = 900.0;
+	bool keepAlive_ = false;
 };
 
 // Really an asynchronous request.
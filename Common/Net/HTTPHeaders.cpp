@@ -97,6 +97,7 @@ int RequestHeader::ParseHttpHeader(const char *buffer) {
 			type = FULL;
 		else
 			type = SIMPLE;
+		http11 = strstr(buffer, "HTTP/1.1") != nullptr;
 		return 0;
 	}
 
@@ -30,6 +30,8 @@ class RequestHeader {
 		SIMPLE, FULL,
 	};
 	RequestType type = SIMPLE;
+	// HTTP/1.1 connections are kept alive unless asked not to.
+	bool http11 = false;
 	enum Method {
 		GET,
 		HEAD,
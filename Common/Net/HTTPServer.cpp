@@ -9,6 +9,9 @@
 
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#if !PPSSPP_PLATFORM(UWP)
+#include <mswsock.h>
+#endif
 #include <io.h>
 
 #else
@@ -19,6 +22,11 @@
 #include <netinet/in.h>       /*  struct sockaddr_in        */
 #include <arpa/inet.h>        /*  inet (3) funtions         */
 #include <unistd.h>           /*  misc. UNIX functions      */
+#include <cerrno>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 
 #define closesocket close
 
@@ -28,6 +36,8 @@
 #define in6addr_any IN6ADDR_ANY_INIT
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 
 #include <cstdio>
@@ -38,9 +48,12 @@
 #include "Common/Net/NetBuffer.h"
 #include "Common/Net/Sinks.h"
 #include "Common/File/FileDescriptor.h"
+#include "Common/Thread/ThreadUtil.h"
 
 #include "Common/Buffer.h"
+#include "Common/CommonFuncs.h"
 #include "Common/Log.h"
+#include "Common/StringUtils.h"
 
 
 void NewThreadExecutor::Run(std::function<void()> func) {
@@ -54,19 +67,85 @@ NewThreadExecutor::~NewThreadExecutor() {
 	threads_.clear();
 }
 
+ThreadPoolExecutor::ThreadPoolExecutor(int threads) {
+	for (int i = 0; i < threads; ++i)
+		threads_.push_back(std::thread(&ThreadPoolExecutor::WorkerFunc, this));
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		quit_ = true;
+	}
+	cond_.notify_all();
+	for (auto &thread : threads_)
+		thread.join();
+	threads_.clear();
+}
+
+void ThreadPoolExecutor::Run(std::function<void()> func) {
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		queue_.push_back(std::move(func));
+	}
+	cond_.notify_one();
+}
+
+void ThreadPoolExecutor::WorkerFunc() {
+	SetCurrentThreadName("HTTPWorker");
+
+	std::unique_lock<std::mutex> guard(lock_);
+	while (true) {
+		cond_.wait(guard, [this] { return quit_ || !queue_.empty(); });
+		// Only quit once the queue is empty, whatever is in it may own a connection.
+		if (queue_.empty())
+			break;
+
+		std::function<void()> func = std::move(queue_.front());
+		queue_.pop_front();
+		guard.unlock();
+		func();
+		guard.lock();
+	}
+}
+
 namespace http {
 
 // Note: charset here helps prevent XSS.
 const char *const DEFAULT_MIME_TYPE = "text/html; charset=utf-8";
 
+// How long a kept alive connection may wait for its next request.
+static const double KEEPALIVE_TIMEOUT = 30.0;
+// Beyond this, connections are closed after each request again, select() can only watch so many.
+static const size_t MAX_IDLE_CONNECTIONS = 32;
+
 ServerRequest::ServerRequest(int fd)
-	: fd_(fd) {
+	: fd_(fd), ownsSinks_(true) {
 	in_ = new net::InputSink(fd);
 	out_ = new net::OutputSink(fd);
+	Init();
+}
+
+ServerRequest::ServerRequest(int fd, net::InputSink *in, net::OutputSink *out)
+	: in_(in), out_(out), fd_(fd), ownsSinks_(false) {
+	Init();
+}
+
+void ServerRequest::Init() {
 	header_.ParseHeaders(in_);
 
 	if (header_.ok) {
 		VERBOSE_LOG(Log::IO, "The request carried with it %i bytes", (int)header_.content_length);
+
+		// A body the handler doesn't read would look like the next request, so don't risk it.
+		std::string connection;
+		keepAlive_ = header_.http11 && header_.content_length <= 0;
+		if (header_.GetOther("connection", &connection)) {
+			if (containsNoCase(connection, "close"))
+				keepAlive_ = false;
+			else if (containsNoCase(connection, "keep-alive"))
+				keepAlive_ = header_.content_length <= 0;
+		}
 	} else {
 	    Close();
 	}
@@ -75,6 +154,10 @@ ServerRequest::ServerRequest(int fd)
 ServerRequest::~ServerRequest() {
 	Close();
 
+	// Otherwise, they belong to the connection, and may rightly hold the next request.
+	if (!ownsSinks_)
+		return;
+
 	if (!in_->Empty()) {
 		ERROR_LOG(Log::IO, "Input not empty - invalid request?");
 	}
@@ -111,7 +194,12 @@ void ServerRequest::WriteHttpResponseHeader(const char *ver, int status, int64_t
 	buffer->Push("Server: PPSSPPServer v0.1\r\n");
 	if (!mimeType || strcmp(mimeType, "websocket") != 0) {
 		buffer->Printf("Content-Type: %s\r\n", mimeType ? mimeType : DEFAULT_MIME_TYPE);
-		buffer->Push("Connection: close\r\n");
+		// Without a length, only closing the connection tells the client where the body ends.
+		if (size < 0)
+			keepAlive_ = false;
+		buffer->Push(keepAlive_ ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+	} else {
+		keepAlive_ = false;
 	}
 	if (size >= 0) {
 		buffer->Printf("Content-Length: %llu\r\n", size);
@@ -122,6 +210,73 @@ void ServerRequest::WriteHttpResponseHeader(const char *ver, int status, int64_t
 	buffer->Push("\r\n");
 }
 
+bool ServerRequest::WriteFileRange(FILE *fp, int64_t offset, int64_t size) const {
+	// Whatever was pushed before (like the headers) goes first.
+	if (!out_->Flush())
+		return false;
+
+	int64_t left = size;
+#if defined(__linux__)
+	// Without a 64-bit off_t, only the start of large files can go this way.
+	if (sizeof(off_t) >= 8 || offset + size <= 0x7FFFFFFF) {
+		off_t pos = (off_t)offset;
+		while (left > 0) {
+			ssize_t sent = sendfile(fd_, fileno(fp), &pos, (size_t)std::min(left, (int64_t)0x7FFFF000));
+			if (sent > 0) {
+				left -= sent;
+			} else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				if (!fd_util::WaitUntilReady(fd_, 5.0, true))
+					return false;
+			} else if (sent < 0 && left == size && (errno == EINVAL || errno == ENOSYS)) {
+				// Not a kind of file it can send, read it instead.
+				break;
+			} else {
+				return false;
+			}
+		}
+	}
+#elif PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(UWP)
+	// Fetched at runtime, so there's no need to link mswsock.
+	GUID guid = WSAID_TRANSMITFILE;
+	LPFN_TRANSMITFILE transmitFile = nullptr;
+	DWORD bytes = 0;
+	HANDLE file = (HANDLE)_get_osfhandle(_fileno(fp));
+	if (file != INVALID_HANDLE_VALUE && WSAIoctl(fd_, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof(guid), &transmitFile, sizeof(transmitFile), &bytes, nullptr, nullptr) == 0 && transmitFile) {
+		// Without an OVERLAPPED, it sends from the file position and waits until done, which needs a blocking socket.
+		fd_util::SetNonBlocking(fd_, false);
+		while (left > 0) {
+			LARGE_INTEGER pos;
+			pos.QuadPart = offset + (size - left);
+			// It can't send more than 2GB - 1 at once.
+			DWORD chunk = (DWORD)std::min(left, (int64_t)0x7FFFFFFE);
+			if (!SetFilePointerEx(file, pos, nullptr, FILE_BEGIN) || !transmitFile(fd_, file, chunk, 0, nullptr, nullptr, 0))
+				break;
+			left -= chunk;
+		}
+		fd_util::SetNonBlocking(fd_, true);
+		// If nothing went out yet, reading it below might still work.
+		if (left != 0 && left != size)
+			return false;
+	}
+#endif
+
+	if (left == 0)
+		return true;
+
+	if (fseeko(fp, offset + (size - left), SEEK_SET) != 0)
+		return false;
+
+	const size_t CHUNK_SIZE = 16 * 1024;
+	char buf[CHUNK_SIZE];
+	while (left > 0) {
+		size_t chunklen = (size_t)std::min(left, (int64_t)CHUNK_SIZE);
+		if (fread(buf, chunklen, 1, fp) != 1 || !out_->Push(buf, chunklen))
+			return false;
+		left -= chunklen;
+	}
+	return out_->Flush();
+}
+
 void ServerRequest::WritePartial() const {
 	_assert_(fd_);
 	out_->Flush();
@@ -135,19 +290,56 @@ void ServerRequest::Write() {
 
 void ServerRequest::Close() {
 	if (fd_) {
-		closesocket(fd_);
+		// A borrowed connection is closed by the server, once it sees it can't be kept alive.
+		if (ownsSinks_)
+			closesocket(fd_);
 		fd_ = 0;
 	}
+	keepAlive_ = false;
 }
 
-Server::Server(NewThreadExecutor *executor)
+struct Server::Connection {
+	Connection(int fd) : fd(fd), in(fd), out(fd) {}
+
+	int fd;
+	net::InputSink in;
+	net::OutputSink out;
+	int requests = 0;
+	double idleSince = 0.0;
+};
+
+Server::Server(Executor *executor)
 	: port_(0), executor_(executor) {
 	RegisterHandler("/", std::bind(&Server::HandleListing, this, std::placeholders::_1));
 	SetFallbackHandler(std::bind(&Server::Handle404, this, std::placeholders::_1));
+
+	wakeFd_ = (int)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (wakeFd_ >= 0) {
+		struct sockaddr_in addr {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t len = sizeof(addr);
+		// It sends to itself, so it just needs any port.
+		if (bind(wakeFd_, (struct sockaddr *)&addr, sizeof(addr)) < 0 || getsockname(wakeFd_, (struct sockaddr *)&addr, &len) < 0 || connect(wakeFd_, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+			WARN_LOG(Log::IO, "Unable to create wake socket for HTTP server, polling instead");
+			closesocket(wakeFd_);
+			wakeFd_ = -1;
+		} else {
+			fd_util::SetNonBlocking(wakeFd_, true);
+		}
+	}
 }
 
 Server::~Server() {
+	// This finishes whatever is still queued, which may park more connections.
 	delete executor_;
+
+	std::lock_guard<std::mutex> guard(idleLock_);
+	for (Connection *conn : idle_)
+		CloseConnection(conn);
+	idle_.clear();
+	if (wakeFd_ >= 0)
+		closesocket(wakeFd_);
 }
 
 void Server::RegisterHandler(const char *url_path, UrlHandlerFunc handler) {
@@ -275,10 +467,70 @@ bool Server::RunSlice(double timeout) {
 	if (timeout <= 0.0) {
 		timeout = 86400.0;
 	}
-	if (!fd_util::WaitUntilReady(listener_, timeout, false)) {
+
+	fd_set readfds;
+	FD_ZERO(&readfds);
+	FD_SET(listener_, &readfds);
+	int maxfd = listener_;
+	if (wakeFd_ >= 0) {
+		FD_SET(wakeFd_, &readfds);
+		maxfd = std::max(maxfd, wakeFd_);
+	} else {
+		// Nothing interrupts the wait when a connection gets parked, so check often.
+		timeout = std::min(timeout, 0.01);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(idleLock_);
+		double now = time_now_d();
+		for (auto it = idle_.begin(); it != idle_.end(); ) {
+			Connection *conn = *it;
+			if (now - conn->idleSince > KEEPALIVE_TIMEOUT) {
+				CloseConnection(conn);
+				it = idle_.erase(it);
+				continue;
+			}
+			// The next request might already be buffered.
+			if (!conn->in.Empty())
+				timeout = 0.0;
+			FD_SET(conn->fd, &readfds);
+			maxfd = std::max(maxfd, conn->fd);
+			++it;
+		}
+	}
+
+	struct timeval tv;
+	tv.tv_sec = (long)timeout;
+	tv.tv_usec = (long)((timeout - floor(timeout)) * 1000000.0);
+	if (select(maxfd + 1, &readfds, nullptr, nullptr, &tv) < 0) {
 		return false;
 	}
 
+	if (wakeFd_ >= 0 && FD_ISSET(wakeFd_, &readfds)) {
+		char drain[16];
+		while (recv(wakeFd_, drain, sizeof(drain), 0) > 0)
+			continue;
+	}
+
+	bool handled = false;
+	{
+		std::lock_guard<std::mutex> guard(idleLock_);
+		for (auto it = idle_.begin(); it != idle_.end(); ) {
+			Connection *conn = *it;
+			if (FD_ISSET(conn->fd, &readfds) || !conn->in.Empty()) {
+				executor_->Run(std::bind(&Server::HandleConnection, this, conn));
+				it = idle_.erase(it);
+				handled = true;
+			} else {
+				++it;
+			}
+		}
+	}
+
+	if (!FD_ISSET(listener_, &readfds)) {
+		return handled;
+	}
+
 	union {
 		struct sockaddr sa;
 		struct sockaddr_in ipv4;
@@ -289,12 +541,12 @@ bool Server::RunSlice(double timeout) {
 	socklen_t client_addr_size = sizeof(client_addr);
 	int conn_fd = accept(listener_, &client_addr.sa, &client_addr_size);
 	if (conn_fd >= 0) {
-		executor_->Run(std::bind(&Server::HandleConnection, this, conn_fd));
+		executor_->Run(std::bind(&Server::HandleConnection, this, new Connection(conn_fd)));
 		return true;
 	}
 	else {
 		ERROR_LOG(Log::IO, "socket accept failed: %i", conn_fd);
-		return false;
+		return handled;
 	}
 }
 
@@ -315,19 +567,72 @@ void Server::Stop() {
 	closesocket(listener_);
 }
 
-void Server::HandleConnection(int conn_fd) {
-	ServerRequest request(conn_fd);
-	if (!request.IsOK()) {
-		WARN_LOG(Log::IO, "Bad request, ignoring.");
+void Server::HandleConnection(Connection *conn) {
+	ServerRequest *request = new ServerRequest(conn->fd, &conn->in, &conn->out);
+	if (!request->IsOK()) {
+		// Kept alive connections normally end like this, when the client is done.
+		if (conn->requests == 0)
+			WARN_LOG(Log::IO, "Bad request, ignoring.");
+		delete request;
+		CloseConnection(conn);
+		return;
+	}
+	conn->requests++;
+
+	std::string upgrade;
+	if (request->GetHeader("upgrade", &upgrade)) {
+		upgradeExecutor_.Run([this, request, conn] {
+			HandleRequest(*request);
+			request->Write();
+			delete request;
+			CloseConnection(conn);
+		});
 		return;
 	}
-	HandleRequest(request);
+
+	HandleRequest(*request);
 
 	// TODO: Way to mark the content body as read, read it here if never read.
 	// This allows the handler to stream if need be.
+	request->WritePartial();
+	bool keepAlive = request->KeepAlive();
+	delete request;
+
+	if (keepAlive)
+		ParkConnection(conn);
+	else
+		CloseConnection(conn);
+}
 
-	// TODO: Could handle keep alive here.
-	request.Write();
+void Server::ParkConnection(Connection *conn) {
+	{
+		std::lock_guard<std::mutex> guard(idleLock_);
+		// FD_SETSIZE limits the value of fds on most platforms, and their count on Windows.
+#if !PPSSPP_PLATFORM(WINDOWS)
+		bool fits = conn->fd < FD_SETSIZE;
+#else
+		bool fits = true;
+#endif
+		if (!fits || idle_.size() >= MAX_IDLE_CONNECTIONS) {
+			CloseConnection(conn);
+			return;
+		}
+		conn->idleSince = time_now_d();
+		idle_.push_back(conn);
+	}
+	Wake();
+}
+
+void Server::CloseConnection(Connection *conn) {
+	closesocket(conn->fd);
+	delete conn;
+}
+
+void Server::Wake() {
+	if (wakeFd_ >= 0) {
+		char wake = 0;
+		send(wakeFd_, &wake, 1, 0);
+	}
 }
 
 void Server::HandleRequest(const ServerRequest &request) {
@@ -1,21 +1,50 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "Common/Net/HTTPHeaders.h"
 #include "Common/Net/Resolve.h"
 
-class NewThreadExecutor {
+class Executor {
+public:
+	virtual ~Executor() {}
+	virtual void Run(std::function<void()> func) = 0;
+};
+
+class NewThreadExecutor : public Executor {
 public:
 	~NewThreadExecutor();
-	void Run(std::function<void()> func);
+	void Run(std::function<void()> func) override;
 
 private:
 	std::vector<std::thread> threads_;
 };
 
+// Runs everything on a fixed set of threads, queueing when they're all busy.
+class ThreadPoolExecutor : public Executor {
+public:
+	ThreadPoolExecutor(int threads);
+	// Finishes what's queued first.
+	~ThreadPoolExecutor();
+	void Run(std::function<void()> func) override;
+
+private:
+	void WorkerFunc();
+
+	std::vector<std::thread> threads_;
+	std::mutex lock_;
+	std::condition_variable cond_;
+	std::deque<std::function<void()>> queue_;
+	bool quit_ = false;
+};
+
 namespace net {
 
 class InputSink;
@@ -28,6 +57,8 @@ namespace http {
 class ServerRequest {
 public:
 	ServerRequest(int fd);
+	// Uses the sinks of a connection kept alive across requests, and leaves it open.
+	ServerRequest(int fd, net::InputSink *in, net::OutputSink *out);
 	~ServerRequest();
 
 	const char *resource() const {
@@ -57,22 +88,30 @@ class ServerRequest {
 	void Close();
 
 	bool IsOK() const { return fd_ > 0; }
+	// Whether the client may send another request on this connection afterward.
+	bool KeepAlive() const { return keepAlive_; }
 
-	// If size is negative, no Content-Length: line is written.
+	// If size is negative, no Content-Length: line is written (and the connection isn't kept alive.)
 	void WriteHttpResponseHeader(const char *ver, int status, int64_t size = -1, const char *mimeType = nullptr, const char *otherHeaders = nullptr) const;
+	// Sends size bytes of the file from offset as (part of) the body, without copying them where the OS can.
+	bool WriteFileRange(FILE *fp, int64_t offset, int64_t size) const;
 
 private:
+	void Init();
+
 	net::InputSink *in_;
 	net::OutputSink *out_;
 	RequestHeader header_;
 	int fd_;
+	bool ownsSinks_;
+	mutable bool keepAlive_ = false;
 };
 
 // Register handlers on this class to serve stuff.
 class Server {
 public:
 	// Takes ownership.
-	Server(NewThreadExecutor *executor);
+	Server(Executor *executor);
 	virtual ~Server();
 
 	typedef std::function<void(const ServerRequest &)> UrlHandlerFunc;
@@ -104,7 +143,12 @@ class Server {
 	bool Listen6(int port, bool ipv6_only);
 	bool Listen4(int port);
 
-	void HandleConnection(int conn_fd);
+	struct Connection;
+
+	void HandleConnection(Connection *conn);
+	void ParkConnection(Connection *conn);
+	void CloseConnection(Connection *conn);
+	void Wake();
 
 	// Things like default 404, etc.
 	void HandleRequestDefault(const ServerRequest &request);
@@ -119,7 +163,15 @@ class Server {
 	UrlHandlerMap handlers_;
 	UrlHandlerFunc fallback_;
 
-	NewThreadExecutor *executor_;
+	Executor *executor_;
+	// Upgraded connections (like websockets) stay for a long time, so they get threads of their own.
+	NewThreadExecutor upgradeExecutor_;
+
+	// Kept alive connections waiting for their next request, RunSlice hands them back to the executor.
+	std::mutex idleLock_;
+	std::vector<Connection *> idle_;
+	// Loopback socket to interrupt RunSlice's wait when a connection is parked.
+	int wakeFd_ = -1;
 };
 
 }  // namespace http
@@ -121,6 +121,46 @@ bool Buffer::ReadAllWithProgress(int fd, int knownSize, RequestProgress *progres
 	return true;
 }
 
+bool Buffer::ReadSizeWithProgress(int fd, size_t size, RequestProgress *progress) {
+	static constexpr float CANCEL_INTERVAL = 0.25f;
+	std::vector<char> buf(65536);
+
+	double st = time_now_d();
+	const size_t start = this->size();
+	while (this->size() < size) {
+		bool ready = false;
+		while (!ready && progress && progress->cancelled) {
+			if (*progress->cancelled)
+				return false;
+			ready = fd_util::WaitUntilReady(fd, CANCEL_INTERVAL, false);
+		}
+
+		int retval = recv(fd, &buf[0], (int)std::min(buf.size(), size - this->size()), MSG_NOSIGNAL);
+		if (retval == 0) {
+			// Closed before sending everything.
+			return false;
+		} else if (retval < 0) {
+#if PPSSPP_PLATFORM(WINDOWS)
+			if (WSAGetLastError() != WSAEWOULDBLOCK) {
+#else
+			if (errno != EWOULDBLOCK) {
+#endif
+				ERROR_LOG(Log::IO, "Error reading from buffer: %i", retval);
+				return false;
+			}
+			continue;
+		}
+		char *p = Append((size_t)retval);
+		memcpy(p, &buf[0], retval);
+		if (progress) {
+			const size_t total = this->size() - start;
+			progress->Update(total, size - start, false);
+			progress->kBps = (float)(total / (time_now_d() - st)) / 1024.0f;
+		}
+	}
+	return true;
+}
+
 int Buffer::Read(int fd, size_t sz) {
 	char buf[4096];
 	int retval;
@@ -24,6 +24,8 @@ class Buffer : public ::Buffer {
 	bool FlushSocket(uintptr_t sock, double timeout, bool *cancelled = nullptr);
 
 	bool ReadAllWithProgress(int fd, int knownSize, RequestProgress *progress);
+	// Reads until the buffer holds size bytes, for connections that stay open.
+	bool ReadSizeWithProgress(int fd, size_t size, RequestProgress *progress);
 
 	// < 0: error
 	// >= 0: number of bytes read
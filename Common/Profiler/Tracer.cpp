@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstring>
+
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/Log.h"
+#include "Common/Profiler/Tracer.h"
+#include "Common/StringUtils.h"
+#include "Common/Thread/ThreadUtil.h"
+
+namespace Tracer {
+
+#define TRACE_BUFFER_EVENTS (1 << 14)  // Must be power of 2, per thread.
+#define TRACE_MAX_THREADS 64
+// Shown as its own thread in the trace.
+#define TRACE_GPU_TID 0
+
+struct TraceEvent {
+	const char *name;
+	uint64_t start;
+	uint64_t end;
+};
+
+struct TraceThreadBuffer {
+	// Only the owning thread writes events and head.  Reset by the owner when the generation changes.
+	std::atomic<uint32_t> head{};
+	std::atomic<int> generation{ -1 };
+	bool inUse = false;
+	// These are protected by buffersLock.
+	int tid = 0;
+	char name[32]{};
+	TraceEvent events[TRACE_BUFFER_EVENTS];
+};
+
+std::atomic<bool> g_active{};
+static std::atomic<int> g_generation{};
+static uint64_t g_startNanos = 0;
+
+static std::mutex buffersLock;
+static std::vector<std::unique_ptr<TraceThreadBuffer>> buffers;
+
+// GPU zones arrive once per frame from the render thread, so a lock is fine here.
+static std::mutex gpuLock;
+static std::vector<GPUZone> gpuZones;
+static uint32_t gpuHead = 0;
+static int gpuGeneration = -1;
+// CPU nanoseconds minus GPU nanoseconds.
+static int64_t gpuOffset = 0;
+
+// When a thread exits, its events stay around until another thread takes over the buffer.
+struct TraceThreadHolder {
+	~TraceThreadHolder() {
+		if (buffer) {
+			std::lock_guard<std::mutex> guard(buffersLock);
+			buffer->inUse = false;
+		}
+	}
+
+	TraceThreadBuffer *buffer = nullptr;
+	bool full = false;
+};
+
+static thread_local TraceThreadHolder t_holder;
+
+static TraceThreadBuffer *AcquireBuffer() {
+	std::lock_guard<std::mutex> guard(buffersLock);
+	TraceThreadBuffer *buffer = nullptr;
+	if (buffers.size() < TRACE_MAX_THREADS) {
+		buffers.push_back(std::unique_ptr<TraceThreadBuffer>(new TraceThreadBuffer()));
+		buffer = buffers.back().get();
+	} else {
+		// Only reuse these when we have to, since that loses what the old thread recorded.
+		for (auto &it : buffers) {
+			if (!it->inUse) {
+				buffer = it.get();
+				break;
+			}
+		}
+		if (!buffer)
+			return nullptr;
+	}
+
+	buffer->inUse = true;
+	buffer->generation = -1;
+	buffer->tid = GetCurrentThreadIdForDebug();
+	const char *name = GetCurrentThreadName();
+	truncate_cpy(buffer->name, name ? name : "");
+	return buffer;
+}
+
+void Start() {
+	g_startNanos = time_now_raw();
+	g_generation++;
+	g_active = true;
+	INFO_LOG(Log::System, "Tracing started");
+}
+
+void Stop() {
+	g_active = false;
+	INFO_LOG(Log::System, "Tracing stopped");
+}
+
+void Record(const char *name, uint64_t startNanos, uint64_t endNanos) {
+	TraceThreadBuffer *buffer = t_holder.buffer;
+	if (!buffer) {
+		// If there were too many threads, don't keep taking the lock.
+		if (t_holder.full)
+			return;
+		buffer = AcquireBuffer();
+		t_holder.buffer = buffer;
+		t_holder.full = buffer == nullptr;
+		if (!buffer)
+			return;
+	}
+
+	const int generation = g_generation.load(std::memory_order_relaxed);
+	if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+		buffer->head.store(0, std::memory_order_relaxed);
+		buffer->generation.store(generation, std::memory_order_release);
+	}
+
+	const uint32_t pos = buffer->head.load(std::memory_order_relaxed);
+	TraceEvent &event = buffer->events[pos & (TRACE_BUFFER_EVENTS - 1)];
+	event.name = name;
+	event.start = startNanos;
+	event.end = endNanos;
+	buffer->head.store(pos + 1, std::memory_order_release);
+}
+
+void RecordGPUFrame(uint64_t submitNanos, const std::vector<GPUZone> &zones) {
+	if (zones.empty())
+		return;
+
+	std::lock_guard<std::mutex> guard(gpuLock);
+	const int generation = g_generation.load(std::memory_order_relaxed);
+	const int64_t offset = (int64_t)(submitNanos - zones[0].start);
+	if (gpuGeneration != generation) {
+		// Clocks might have drifted since last time, so start over.
+		gpuGeneration = generation;
+		gpuHead = 0;
+		gpuOffset = offset;
+	} else if (offset > gpuOffset) {
+		gpuOffset = offset;
+	}
+
+	if (gpuZones.size() != TRACE_BUFFER_EVENTS)
+		gpuZones.resize(TRACE_BUFFER_EVENTS);
+	for (const GPUZone &zone : zones) {
+		gpuZones[gpuHead & (TRACE_BUFFER_EVENTS - 1)] = zone;
+		gpuHead++;
+	}
+}
+
+static void WriteThreadName(json::JsonWriter &json, int tid, const char *name) {
+	json.pushDict();
+	json.writeString("name", "thread_name");
+	json.writeString("ph", "M");
+	json.writeInt("pid", 1);
+	json.writeInt("tid", tid);
+	json.pushDict("args");
+	json.writeString("name", name);
+	json.pop();
+	json.pop();
+}
+
+static void WriteZone(json::JsonWriter &json, int tid, const char *name, uint64_t start, uint64_t end) {
+	json.pushDict();
+	json.writeString("name", name);
+	json.writeInt("pid", 1);
+	json.writeInt("tid", tid);
+	// Microseconds, but the default precision would be far too much.
+	json.writeRaw("ts", StringFromFormat("%.3f", (double)(start - g_startNanos) / 1000.0));
+	if (end == start) {
+		json.writeString("ph", "i");
+		json.writeString("s", "t");
+	} else {
+		json.writeString("ph", "X");
+		json.writeRaw("dur", StringFromFormat("%.3f", (double)(end - start) / 1000.0));
+	}
+	json.pop();
+}
+
+std::string ExportChromeJSON() {
+	const int generation = g_generation;
+
+	json::JsonWriter json;
+	json.begin();
+	json.pushArray("traceEvents");
+
+	std::vector<TraceEvent> events;
+	std::lock_guard<std::mutex> guard(buffersLock);
+	for (auto &buffer : buffers) {
+		if (buffer->generation.load(std::memory_order_acquire) != generation)
+			continue;
+
+		const uint32_t head = buffer->head.load(std::memory_order_acquire);
+		const uint32_t first = head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+		events.assign(buffer->events, buffer->events + TRACE_BUFFER_EVENTS);
+
+		// Anything the owner wrote meanwhile may have replaced older events.  Drop those.
+		const uint32_t after = buffer->head.load(std::memory_order_acquire);
+		uint32_t valid = after >= TRACE_BUFFER_EVENTS ? after - TRACE_BUFFER_EVENTS + 1 : 0;
+		if (buffer->generation.load(std::memory_order_acquire) != generation)
+			continue;
+
+		WriteThreadName(json, buffer->tid, buffer->name[0] ? buffer->name : "unnamed");
+
+		for (uint32_t i = std::max(first, valid); i < head; ++i) {
+			const TraceEvent &event = events[i & (TRACE_BUFFER_EVENTS - 1)];
+			// Events from before this trace started can't be here, but be safe against torn reads.
+			if (!event.name || event.start < g_startNanos)
+				continue;
+
+			WriteZone(json, buffer->tid, event.name, event.start, event.end);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> gpuGuard(gpuLock);
+		if (gpuGeneration == generation && gpuHead != 0) {
+			WriteThreadName(json, TRACE_GPU_TID, "GPU");
+			const uint32_t first = gpuHead > TRACE_BUFFER_EVENTS ? gpuHead - TRACE_BUFFER_EVENTS : 0;
+			for (uint32_t i = first; i < gpuHead; ++i) {
+				const GPUZone &zone = gpuZones[i & (TRACE_BUFFER_EVENTS - 1)];
+				// The offset is only known well after a few frames, so it's applied here.
+				const uint64_t start = zone.start + gpuOffset;
+				const uint64_t end = zone.end + gpuOffset;
+				if (start < g_startNanos || end < start)
+					continue;
+				WriteZone(json, TRACE_GPU_TID, zone.name.c_str(), start, end);
+			}
+		}
+	}
+
+	json.pop();
+	json.writeString("displayTimeUnit", "ms");
+	json.end();
+	return json.str();
+}
+
+}  // namespace Tracer
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Common/TimeUtil.h"
+
+// Tracing of scoped zones across all threads, for finding what caused a hitch.
+// Unlike Profiler.h, this is always compiled in.  While not tracing, a zone only costs a
+// relaxed load and a branch.  While tracing, each zone reads the clock twice and writes one event
+// to a ring buffer owned by its thread, so no locks are taken.
+//
+// Only the most recent events are kept for each thread, so stop right after the hitch.
+// The export is Chrome trace JSON, which also opens in Perfetto (ui.perfetto.dev.)
+namespace Tracer {
+
+extern std::atomic<bool> g_active;
+
+inline bool Active() {
+	return g_active.load(std::memory_order_relaxed);
+}
+
+// Starting again drops everything from the last trace.
+void Start();
+void Stop();
+
+// The name must be a string constant, only the pointer is kept.
+void Record(const char *name, uint64_t startNanos, uint64_t endNanos);
+// For marking points in time, like the start of a frame.
+inline void Instant(const char *name) {
+	if (Active()) {
+		uint64_t now = time_now_raw();
+		Record(name, now, now);
+	}
+}
+
+// A span of GPU work, in nanoseconds on the GPU's own clock.
+struct GPUZone {
+	std::string name;
+	uint64_t start;
+	uint64_t end;
+};
+
+// Called by the backends with the timestamps of a finished frame.  submitNanos must be a CPU time
+// from before the GPU could have started on the first zone, like right before submitting it.
+// Since the GPU can't start early, the largest gap seen between the two is the offset between the clocks.
+void RecordGPUFrame(uint64_t submitNanos, const std::vector<GPUZone> &zones);
+
+// Can be called while tracing, though events recorded meanwhile might be left out.
+std::string ExportChromeJSON();
+
+class Zone {
+public:
+	Zone(const char *name) : name_(Active() ? name : nullptr) {
+		if (name_)
+			start_ = time_now_raw();
+	}
+	~Zone() {
+		if (name_)
+			Record(name_, start_, time_now_raw());
+	}
+
+	Zone(const Zone &) = delete;
+	Zone &operator =(const Zone &) = delete;
+
+private:
+	const char *name_;
+	uint64_t start_ = 0;
+};
+
+}  // namespace Tracer
+
+#define TRACE_SCOPE(name) Tracer::Zone _trace_scoped(name)
@@ -18,12 +18,14 @@
 
 DrawBuffer::DrawBuffer() {
 	verts_ = new Vertex[MAX_VERTS];
+	textVerts_ = new Vertex[MAX_TEXT_VERTS];
 	fontscalex = 1.0f;
 	fontscaley = 1.0f;
 }
 
 DrawBuffer::~DrawBuffer() {
 	delete [] verts_;
+	delete [] textVerts_;
 }
 
 void DrawBuffer::Init(Draw::DrawContext *t3d, Draw::Pipeline *pipeline) {
@@ -57,20 +59,26 @@ void DrawBuffer::Shutdown() {
 	pipeline_ = nullptr;
 	draw_ = nullptr;
 	count_ = 0;
+	textCount_ = 0;
+	textSource_ = nullptr;
+	textTexture_ = nullptr;
+	defaultTexture_ = nullptr;
 }
 
 void DrawBuffer::Begin(Draw::Pipeline *program) {
 	pipeline_ = program;
 	count_ = 0;
+	textCount_ = 0;
 }
 
 void DrawBuffer::Flush(bool set_blend_state) {
 	using namespace Draw;
-	if (count_ == 0)
+	if (count_ == 0 && textCount_ == 0)
 		return;
 	if (!pipeline_) {
 		ERROR_LOG(Log::G3D, "DrawBuffer: No program set, skipping flush!");
 		count_ = 0;
+		textCount_ = 0;
 		return;
 	}
 	draw_->BindPipeline(pipeline_);
@@ -80,8 +88,19 @@ void DrawBuffer::Flush(bool set_blend_state) {
 	ub.tint = tint_;
 	ub.saturation = saturation_;
 	draw_->UpdateDynamicUniformBuffer(&ub, sizeof(ub));
-	draw_->DrawUP((const void *)verts_, count_);
+	if (count_ != 0)
+		draw_->DrawUP((const void *)verts_, count_);
 	count_ = 0;
+
+	if (textCount_ != 0) {
+		// Any strings added since the last flush are only uploaded now, all at once.
+		textSource_->UploadAtlasTexture(textTexture_);
+		draw_->BindTexture(0, textTexture_);
+		draw_->DrawUP((const void *)textVerts_, textCount_);
+		if (defaultTexture_)
+			draw_->BindTexture(0, defaultTexture_);
+		textCount_ = 0;
+	}
 }
 
 void DrawBuffer::V(float x, float y, float z, uint32_t color, float u, float v) {
@@ -400,6 +419,31 @@ void DrawBuffer::DrawTexRect(float x1, float y1, float x2, float y2, float u1, f
 	V(x1,	y2, color, u1, v2);
 }
 
+void DrawBuffer::DrawTextQuad(TextDrawer *source, Draw::Texture *texture, float x1, float y1, float x2, float y2, float u1, float v1, float u2, float v2, Color color) {
+	if (texture != textTexture_ || textCount_ + 6 > MAX_TEXT_VERTS) {
+		Flush();
+		textTexture_ = texture;
+	}
+	textSource_ = source;
+
+	const uint32_t rgba = alpha_ == 1.0f ? color : alphaMul(color, alpha_);
+	auto textV = [&](float x, float y, float u, float v) {
+		Vertex *vert = &textVerts_[textCount_++];
+		vert->x = x;
+		vert->y = y;
+		vert->z = curZ_;
+		vert->rgba = rgba;
+		vert->u = u;
+		vert->v = v;
+	};
+	textV(x1, y1, u1, v1);
+	textV(x2, y1, u2, v1);
+	textV(x2, y2, u2, v2);
+	textV(x1, y1, u1, v1);
+	textV(x2, y2, u2, v2);
+	textV(x1, y2, u1, v2);
+}
+
 void DrawBuffer::DrawImage4Grid(ImageID atlas_image, float x1, float y1, float x2, float y2, Color color, float corner_scale) {
 	const AtlasImage *image = atlas->getImage(atlas_image);
 
@@ -121,6 +121,13 @@ class DrawBuffer {
 	void DrawTexRect(const Bounds &bounds, float u1, float v1, float u2, float v2, Color color) {
 		DrawTexRect(bounds.x, bounds.y, bounds.x2(), bounds.y2(), u1, v1, u2, v2, color);
 	}
+	// Text from one of TextDrawer's atlas textures.  It's kept aside and drawn on top of everything else at
+	// the next Flush(), so labels in between other drawing don't each need a flush and a texture switch.
+	void DrawTextQuad(TextDrawer *source, Draw::Texture *texture, float x1, float y1, float x2, float y2, float u1, float v1, float u2, float v2, Color color);
+	// Rebound after text quads are drawn.  Should be what's normally bound while drawing with this.
+	void SetDefaultTexture(Draw::Texture *texture) {
+		defaultTexture_ = texture;
+	}
 	// Results in 18 triangles. Kind of expensive for a button.
 	void DrawImage4Grid(ImageID atlas_image, float x1, float y1, float x2, float y2, Color color = COLOR(0xFFFFFF), float corner_scale = 1.0);
 	// This is only 6 triangles, much cheaper.
@@ -177,6 +184,7 @@ class DrawBuffer {
 	enum {
 		// TODO: Can probably shrink this. Currently consumes 1.5MB.
 		MAX_VERTS = 65536,
+		MAX_TEXT_VERTS = 8192,
 	};
 
 private:
@@ -197,6 +205,12 @@ class DrawBuffer {
 
 	Vertex *verts_;
 	int count_ = 0;
+
+	Vertex *textVerts_;
+	int textCount_ = 0;
+	TextDrawer *textSource_ = nullptr;
+	Draw::Texture *textTexture_ = nullptr;
+	Draw::Texture *defaultTexture_ = nullptr;
 	const Atlas *atlas = nullptr;
 	const Atlas *fontAtlas_ = nullptr;
 
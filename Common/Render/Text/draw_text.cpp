@@ -52,7 +52,6 @@ void TextDrawer::DrawString(DrawBuffer &target, std::string_view str, float x, f
 	}
 
 	CacheKey key{ std::string(str), fontHash_ };
-	target.Flush(true);
 
 	TextStringEntry *entry;
 
@@ -60,7 +59,7 @@ void TextDrawer::DrawString(DrawBuffer &target, std::string_view str, float x, f
 	if (iter != cache_.end()) {
 		entry = iter->second.get();
 		entry->lastUsedFrame = frameCount_;
-		if (!entry->texture) {
+		if (!entry->texture && entry->atlasPage < 0) {
 			return;
 		}
 	} else {
@@ -93,34 +92,143 @@ void TextDrawer::DrawString(DrawBuffer &target, std::string_view str, float x, f
 			return;
 		}
 
-		desc.initData.push_back(&bitmapData[0]);
+		if (!emoji && AddToAtlas(entry, bitmapData, texFormat)) {
+			cache_[key] = std::unique_ptr<TextStringEntry>(entry);
+		} else {
+			desc.initData.push_back(&bitmapData[0]);
+
+			desc.type = TextureType::LINEAR2D;
+			desc.format = texFormat;
+			desc.width = entry->bmWidth;
+			desc.height = entry->bmHeight;
+			desc.depth = 1;
+			desc.mipLevels = 1;
+			desc.tag = "TextDrawer";
+			desc.swizzle = texFormat == Draw::DataFormat::R8_UNORM ? Draw::TextureSwizzle::R8_AS_ALPHA : Draw::TextureSwizzle::DEFAULT,
+			entry->texture = draw_->CreateTexture(desc);
+			cache_[key] = std::unique_ptr<TextStringEntry>(entry);
+		}
+	}
 
-		desc.type = TextureType::LINEAR2D;
-		desc.format = texFormat;
-		desc.width = entry->bmWidth;
-		desc.height = entry->bmHeight;
-		desc.depth = 1;
-		desc.mipLevels = 1;
-		desc.tag = "TextDrawer";
-		desc.swizzle = texFormat == Draw::DataFormat::R8_UNORM ? Draw::TextureSwizzle::R8_AS_ALPHA : Draw::TextureSwizzle::DEFAULT,
-		entry->texture = draw_->CreateTexture(desc);
-		cache_[key] = std::unique_ptr<TextStringEntry>(entry);
+	float w = (float)entry->width * (fontScaleX_ * dpiScale_);
+	float h = (float)entry->height * (fontScaleY_ * dpiScale_);
+	DrawBuffer::DoAlign(align, &x, &y, &w, &h);
+
+	if (entry->atlasPage >= 0) {
+		const float invSize = 1.0f / (float)ATLAS_SIZE;
+		float u1 = (float)entry->atlasX * invSize;
+		float v1 = (float)entry->atlasY * invSize;
+		float u2 = (float)(entry->atlasX + entry->width) * invSize;
+		float v2 = (float)(entry->atlasY + entry->height) * invSize;
+		target.DrawTextQuad(this, atlas_[entry->atlasPage].texture, x, y, x + w, y + h, u1, v1, u2, v2, color);
+		return;
 	}
 
 	_dbg_assert_(entry->texture);
+	target.Flush(true);
 	draw_->BindTexture(0, entry->texture);
 
 	// Okay, the texture is bound, let's draw.
-	float w = (float)entry->width * (fontScaleX_ * dpiScale_);
-	float h = (float)entry->height * (fontScaleY_ * dpiScale_);
 	float u = (float)entry->width / (float)entry->bmWidth;
 	float v = (float)entry->height / (float)entry->bmHeight;
-	DrawBuffer::DoAlign(align, &x, &y, &w, &h);
-
 	target.DrawTexRect(x, y, x + w, y + h, 0.0f, 0.0f, u, v, color);
 	target.Flush(true);
 }
 
+bool TextDrawer::AddToAtlas(TextStringEntry *entry, const std::vector<uint8_t> &bitmapData, Draw::DataFormat texFormat) {
+	// Leave a texel between strings, so filtering doesn't pick up the neighbors.
+	const int w = entry->bmWidth + 1;
+	const int h = entry->bmHeight + 1;
+	// Big blocks of text would waste a lot of space, they can keep their own textures.
+	if (atlasFull_ || w > ATLAS_SIZE || h > ATLAS_SIZE / 8)
+		return false;
+	if (atlas_.empty())
+		atlasFormat_ = texFormat;
+	else if (texFormat != atlasFormat_)
+		return false;
+
+	AtlasPage *page = atlas_.empty() ? nullptr : &atlas_.back();
+	if (page && page->shelfX + w > ATLAS_SIZE) {
+		page->shelfY += page->shelfHeight;
+		page->shelfX = 0;
+		page->shelfHeight = 0;
+	}
+	if (!page || page->shelfY + h > ATLAS_SIZE) {
+		if (atlas_.size() >= MAX_ATLAS_PAGES) {
+			atlasFull_ = true;
+			return false;
+		}
+
+		AtlasPage newPage;
+		newPage.pixels.resize(ATLAS_SIZE * ATLAS_SIZE * DataFormatSizeInBytes(texFormat));
+		Draw::TextureDesc desc{};
+		desc.type = Draw::TextureType::LINEAR2D;
+		desc.format = texFormat;
+		desc.width = ATLAS_SIZE;
+		desc.height = ATLAS_SIZE;
+		desc.depth = 1;
+		desc.mipLevels = 1;
+		desc.tag = "TextDrawerAtlas";
+		desc.swizzle = texFormat == Draw::DataFormat::R8_UNORM ? Draw::TextureSwizzle::R8_AS_ALPHA : Draw::TextureSwizzle::DEFAULT;
+		desc.initData.push_back(newPage.pixels.data());
+		newPage.texture = draw_->CreateTexture(desc);
+		if (!newPage.texture) {
+			atlasFull_ = true;
+			return false;
+		}
+		atlas_.push_back(std::move(newPage));
+		page = &atlas_.back();
+	}
+
+	const size_t bpp = DataFormatSizeInBytes(texFormat);
+	const size_t rowSize = entry->bmWidth * bpp;
+	for (int y = 0; y < entry->bmHeight; y++) {
+		memcpy(&page->pixels[((page->shelfY + y) * ATLAS_SIZE + page->shelfX) * bpp], &bitmapData[y * rowSize], rowSize);
+	}
+
+	entry->atlasPage = (int)atlas_.size() - 1;
+	entry->atlasX = page->shelfX;
+	entry->atlasY = page->shelfY;
+	page->shelfX += w;
+	page->shelfHeight = std::max(page->shelfHeight, h);
+	page->dirty = true;
+	return true;
+}
+
+void TextDrawer::UploadAtlasTexture(Draw::Texture *texture) {
+	for (AtlasPage &page : atlas_) {
+		if (page.texture == texture && page.dirty) {
+			const uint8_t *data = page.pixels.data();
+			draw_->UpdateTextureLevels(page.texture, &data, nullptr, 1);
+			page.dirty = false;
+		}
+	}
+}
+
+void TextDrawer::ClearAtlas() {
+	for (auto iter = cache_.begin(); iter != cache_.end();) {
+		if (iter->second->atlasPage >= 0) {
+			cache_.erase(iter++);
+		} else {
+			iter++;
+		}
+	}
+	for (AtlasPage &page : atlas_) {
+		memset(page.pixels.data(), 0, page.pixels.size());
+		page.shelfX = 0;
+		page.shelfY = 0;
+		page.shelfHeight = 0;
+		page.dirty = true;
+	}
+	// Start filling from the first page again.
+	while (atlas_.size() > 1) {
+		atlas_.back().texture->Release();
+		atlas_.pop_back();
+	}
+	atlasFull_ = false;
+	atlasEvicted_ = 0;
+}
+
 void TextDrawer::MeasureString(std::string_view str, float *w, float *h) {
 	if (str.empty()) {
 		*w = 0.0f;
@@ -209,6 +317,12 @@ void TextDrawer::ClearCache() {
 	cache_.clear();
 	sizeCache_.clear();
 	fontHash_ = 0;
+
+	for (AtlasPage &page : atlas_)
+		page.texture->Release();
+	atlas_.clear();
+	atlasFull_ = false;
+	atlasEvicted_ = 0;
 }
 
 void TextDrawer::OncePerFrame() {
@@ -222,12 +336,20 @@ void TextDrawer::OncePerFrame() {
 		ClearFonts();
 	}
 
+	// Everything drawn last frame is done, so now the atlas can be cleared to make room.
+	// Unless something was dropped from it, that would just fill it with the same strings again.
+	if (atlasFull_ && atlasEvicted_ > 0) {
+		ClearAtlas();
+	}
+
 	// Drop old strings. Use a prime number to reduce clashing with other rhythms
 	if (frameCount_ % 63 == 0) {
 		for (auto iter = cache_.begin(); iter != cache_.end();) {
 			if (frameCount_ - iter->second->lastUsedFrame > 100) {
 				if (iter->second->texture)
 					iter->second->texture->Release();
+				if (iter->second->atlasPage >= 0)
+					atlasEvicted_++;
 				cache_.erase(iter++);
 			} else {
 				iter++;
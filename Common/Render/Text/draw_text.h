@@ -3,8 +3,8 @@
 // Uses system fonts to draw text. 
 // Platform support will be added over time, initially just Win32.
 
-// Caches strings in individual textures. Might later combine them into a big one
-// with dynamically allocated space but too much trouble for now.
+// Caches strings as bitmaps, packed into a few shared atlas textures when they fit, otherwise in
+// individual textures.  Strings in the atlas are batched by DrawBuffer.
 
 #pragma once
 
@@ -13,6 +13,7 @@
 #include <memory>
 #include <cstdint>
 #include <map>
+#include <vector>
 
 #include "Common/Data/Text/WrapText.h"
 #include "Common/Render/DrawBuffer.h"
@@ -30,6 +31,10 @@ struct TextStringEntry {
 	int height = 0;
 	int bmWidth = 0;
 	int bmHeight = 0;
+	// If it's in the atlas instead of its own texture.
+	int atlasPage = -1;
+	int atlasX = 0;
+	int atlasY = 0;
 	int lastUsedFrame;
 };
 
@@ -57,6 +62,8 @@ class TextDrawer {
 	bool DrawStringBitmapRect(std::vector<uint8_t> &bitmapData, TextStringEntry &entry, Draw::DataFormat texFormat, std::string_view str, const Bounds &bounds, int align, bool fullColor);
 	// Use for housekeeping like throwing out old strings.
 	void OncePerFrame();
+	// Called by DrawBuffer right before drawing with an atlas texture.
+	void UploadAtlasTexture(Draw::Texture *texture);
 
 	float CalculateDPIScale() const;
 	void SetForcedDPIScale(float dpi) {
@@ -79,6 +86,9 @@ class TextDrawer {
 
 	void WrapString(std::string &out, std::string_view str, float maxWidth, int flags);
 
+	bool AddToAtlas(TextStringEntry *entry, const std::vector<uint8_t> &bitmapData, Draw::DataFormat texFormat);
+	void ClearAtlas();
+
 	struct CacheKey {
 		bool operator < (const CacheKey &other) const {
 			if (fontHash < other.fontHash)
@@ -103,6 +113,26 @@ class TextDrawer {
 
 	std::map<CacheKey, std::unique_ptr<TextStringEntry>> cache_;
 	std::map<CacheKey, std::unique_ptr<TextMeasureEntry>> sizeCache_;
+
+	// Pages are filled a row ("shelf") at a time, and only ever added to during a frame, so that
+	// uploading a page never changes what was already drawn from it.  Space is only reclaimed by
+	// clearing everything, between frames.
+	struct AtlasPage {
+		Draw::Texture *texture = nullptr;
+		std::vector<uint8_t> pixels;
+		int shelfX = 0;
+		int shelfY = 0;
+		int shelfHeight = 0;
+		bool dirty = false;
+	};
+	static constexpr int ATLAS_SIZE = 1024;
+	static constexpr int MAX_ATLAS_PAGES = 4;
+
+	std::vector<AtlasPage> atlas_;
+	Draw::DataFormat atlasFormat_ = Draw::DataFormat::UNDEFINED;
+	bool atlasFull_ = false;
+	// Strings dropped from the atlas since it was cleared, leaving holes.
+	int atlasEvicted_ = 0;
 };
 
 class TextDrawerWordWrapper : public WordWrapper {
@@ -2555,8 +2555,9 @@ void RiscVEmitter::VSETIVLI(RiscVReg rd, u8 uimm5, VType vtype) {
 	_assert_msg_((vtype.value & ~0xFF) == 0, "%s with invalid vtype", __func__);
 	_assert_msg_(IsGPR(rd), "%s rd (VL) must be GPR", __func__);
 	_assert_msg_((u32)uimm5 <= 0x1F, "%s (AVL) can only set up to 31", __func__);
+	// The top two bits must be set, which is the sign bit and one more.
 	s32 simm12 = 0xFFFFFC00 | vtype.value;
-	Write32(EncodeI(Opcode32::OP_V, rd, Funct3::OPCFG, (RiscVReg)uimm5, (s32)vtype.value));
+	Write32(EncodeI(Opcode32::OP_V, rd, Funct3::OPCFG, (RiscVReg)uimm5, simm12));
 }
 
 void RiscVEmitter::VSETVL(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) {
@@ -3903,7 +3904,7 @@ void RiscVEmitter::VMV_X_S(RiscVReg rd, RiscVReg vs2) {
 void RiscVEmitter::VMV_S_X(RiscVReg vd, RiscVReg rs1) {
 	_assert_msg_(IsVPR(vd), "%s instruction vd must be VPR", __func__);
 	_assert_msg_(IsGPR(rs1), "%s instruction rs1 must be GPR", __func__);
-	Write32(EncodeV(vd, Funct3::OPMVV, rs1, V0, VUseMask::NONE, Funct6::VRWUNARY0));
+	Write32(EncodeV(vd, Funct3::OPMVX, rs1, V0, VUseMask::NONE, Funct6::VRWUNARY0));
 }
 
 void RiscVEmitter::VFMV_F_S(RiscVReg rd, RiscVReg vs2) {
@@ -3916,7 +3917,7 @@ void RiscVEmitter::VFMV_S_F(RiscVReg vd, RiscVReg rs1) {
 	_assert_msg_(FloatBitsSupported() >= 32, "FVV instruction requires vector float support");
 	_assert_msg_(IsVPR(vd), "%s instruction vd must be VPR", __func__);
 	_assert_msg_(IsFPR(rs1), "%s instruction rs1 must be FPR", __func__);
-	Write32(EncodeV(vd, Funct3::OPFVV, rs1, V0, VUseMask::NONE, Funct6::VRWUNARY0));
+	Write32(EncodeV(vd, Funct3::OPFVF, rs1, V0, VUseMask::NONE, Funct6::VRWUNARY0));
 }
 
 void RiscVEmitter::VSLIDEUP_VX(RiscVReg vd, RiscVReg vs2, RiscVReg rs1, VUseMask vm) {
@@ -15,8 +15,10 @@
 // Official SVN repository and contact information can be found at
 // http://code.google.com/p/dolphin-emu/
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 #include <snappy-c.h>
 #include <zstd.h>
 
@@ -24,6 +26,7 @@
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
 
 enum class SerializeCompressType {
 	NONE = 0,
@@ -33,6 +36,51 @@ enum class SerializeCompressType {
 
 static constexpr SerializeCompressType SAVE_TYPE = SerializeCompressType::ZSTD;
 
+// States are compressed as separate zstd frames of this size, in parallel.  ZSTD_decompress
+// reads concatenated frames as one, so loading (even in older versions) doesn't need to know.
+static constexpr size_t ZSTD_CHUNK_SIZE = 4 * 1024 * 1024;
+
+static size_t ZstdChunkedBound(size_t sz) {
+	size_t numChunks = std::max((size_t)1, (sz + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE);
+	return numChunks * ZSTD_compressBound(std::min(sz, ZSTD_CHUNK_SIZE));
+}
+
+// Returns the compressed size, or 0 on failure.  dest must be ZstdChunkedBound(sz) bytes.
+static size_t CompressZstdChunked(u8 *dest, const u8 *src, size_t sz) {
+	const int numChunks = (int)std::max((size_t)1, (sz + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE);
+	const size_t chunkBound = ZSTD_compressBound(std::min(sz, ZSTD_CHUNK_SIZE));
+	std::vector<size_t> sizes(numChunks);
+
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		ZSTD_CCtx *ctx = ZSTD_createCCtx();
+		for (int i = l; i < h; ++i) {
+			if (!ctx) {
+				sizes[i] = (size_t)-1;
+				continue;
+			}
+			const size_t offset = (size_t)i * ZSTD_CHUNK_SIZE;
+			const size_t len = std::min(sz - offset, ZSTD_CHUNK_SIZE);
+			// TODO: If free disk space is low, we could max this out to 22?
+			ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters);
+			ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+			ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
+			ZSTD_CCtx_setPledgedSrcSize(ctx, len);
+			sizes[i] = ZSTD_compress2(ctx, dest + i * chunkBound, chunkBound, src + offset, len);
+		}
+		ZSTD_freeCCtx(ctx);
+	}, 0, numChunks, 1);
+
+	// Now pack the frames together.  They only ever move backward.
+	size_t pos = 0;
+	for (int i = 0; i < numChunks; ++i) {
+		if (ZSTD_isError(sizes[i]))
+			return 0;
+		memmove(dest + pos, dest + i * chunkBound, sizes[i]);
+		pos += sizes[i];
+	}
+	return pos;
+}
+
 void PointerWrap::RewindForWrite(u8 *writePtr) {
 	_assert_(mode == MODE_MEASURE);
 	// Switch to writing mode, save the size for later checking and start again.
@@ -345,6 +393,42 @@ CChunkFileReader::Error CChunkFileReader::GetFileTitle(const Path &filename, std
 	return LoadFileHeader(pFile, header, title);
 }
 
+// Decompresses while reading, so the compressed data is never all in memory at once.
+static bool ReadZstdFile(File::IOFile &file, size_t compressedSize, u8 *dest, size_t destSize, size_t *written) {
+	ZSTD_DCtx *ctx = ZSTD_createDCtx();
+	if (!ctx)
+		return false;
+
+	std::vector<u8> input(std::max(ZSTD_DStreamInSize(), (size_t)1024 * 1024));
+	ZSTD_outBuffer out{ dest, destSize, 0 };
+	bool success = true;
+	size_t result = 0;
+	while (success && compressedSize != 0) {
+		size_t chunk = std::min(compressedSize, input.size());
+		if (!file.ReadBytes(input.data(), chunk)) {
+			ERROR_LOG(Log::SaveState, "ChunkReader: Error reading file");
+			success = false;
+			break;
+		}
+		compressedSize -= chunk;
+
+		ZSTD_inBuffer in{ input.data(), chunk, 0 };
+		while (in.pos < in.size) {
+			result = ZSTD_decompressStream(ctx, &out, &in);
+			// No room left with input remaining means the sizes in the header are wrong.
+			if (ZSTD_isError(result) || (out.pos == out.size && in.pos < in.size && result != 0)) {
+				success = false;
+				break;
+			}
+		}
+	}
+	ZSTD_freeDCtx(ctx);
+
+	// Anything but 0 means the last frame was cut off.
+	*written = out.pos;
+	return success && result == 0;
+}
+
 CChunkFileReader::Error CChunkFileReader::LoadFile(const Path &filename, std::string *gitVersion, u8 *&_buffer, size_t &sz, std::string *failureReason) {
 	if (!File::Exists(filename)) {
 		*failureReason = "LoadStateDoesntExist";
@@ -361,47 +445,58 @@ CChunkFileReader::Error CChunkFileReader::LoadFile(const Path &filename, std::st
 
 	// read the state
 	sz = header.ExpectedSize;
-	u8 *buffer = new u8[sz];
-	if (!pFile.ReadBytes(buffer, sz))
-	{
-		ERROR_LOG(Log::SaveState, "ChunkReader: Error reading file");
-		delete [] buffer;
-		return ERROR_BAD_FILE;
-	}
-
-	if (header.Compress) {
+	if (SerializeCompressType(header.Compress) == SerializeCompressType::ZSTD) {
 		u8 *uncomp_buffer = new u8[header.UncompressedSize];
-		size_t uncomp_size = header.UncompressedSize;
-		bool success = false;
-		if (SerializeCompressType(header.Compress) == SerializeCompressType::SNAPPY) {
-			auto status = snappy_uncompress((const char *)buffer, sz, (char *)uncomp_buffer, &uncomp_size);
-			success = status == SNAPPY_OK;
-		} else if (SerializeCompressType(header.Compress) == SerializeCompressType::ZSTD) {
-			size_t status = ZSTD_decompress((char *)uncomp_buffer, uncomp_size, (const char *)buffer, sz);
-			success = !ZSTD_isError(status);
-			if (success) {
-				uncomp_size = status;
-			}
-		} else {
-			ERROR_LOG(Log::SaveState, "ChunkReader: Unexpected compression type %d", header.Compress);
-		}
-		if (!success) {
+		size_t uncomp_size = 0;
+		if (!ReadZstdFile(pFile, sz, uncomp_buffer, header.UncompressedSize, &uncomp_size)) {
 			ERROR_LOG(Log::SaveState, "ChunkReader: Failed to decompress file");
 			delete [] uncomp_buffer;
-			delete [] buffer;
 			return ERROR_BAD_FILE;
 		}
 		if ((u32)uncomp_size != header.UncompressedSize) {
 			ERROR_LOG(Log::SaveState, "Size mismatch: file: %u  calc: %u", header.UncompressedSize, (u32)uncomp_size);
 			delete [] uncomp_buffer;
-			delete [] buffer;
 			return ERROR_BAD_FILE;
 		}
 		_buffer = uncomp_buffer;
 		sz = uncomp_size;
-		delete [] buffer;
 	} else {
-		_buffer = buffer;
+		u8 *buffer = new u8[sz];
+		if (!pFile.ReadBytes(buffer, sz))
+		{
+			ERROR_LOG(Log::SaveState, "ChunkReader: Error reading file");
+			delete [] buffer;
+			return ERROR_BAD_FILE;
+		}
+
+		if (header.Compress) {
+			u8 *uncomp_buffer = new u8[header.UncompressedSize];
+			size_t uncomp_size = header.UncompressedSize;
+			bool success = false;
+			if (SerializeCompressType(header.Compress) == SerializeCompressType::SNAPPY) {
+				auto status = snappy_uncompress((const char *)buffer, sz, (char *)uncomp_buffer, &uncomp_size);
+				success = status == SNAPPY_OK;
+			} else {
+				ERROR_LOG(Log::SaveState, "ChunkReader: Unexpected compression type %d", header.Compress);
+			}
+			if (!success) {
+				ERROR_LOG(Log::SaveState, "ChunkReader: Failed to decompress file");
+				delete [] uncomp_buffer;
+				delete [] buffer;
+				return ERROR_BAD_FILE;
+			}
+			if ((u32)uncomp_size != header.UncompressedSize) {
+				ERROR_LOG(Log::SaveState, "Size mismatch: file: %u  calc: %u", header.UncompressedSize, (u32)uncomp_size);
+				delete [] uncomp_buffer;
+				delete [] buffer;
+				return ERROR_BAD_FILE;
+			}
+			_buffer = uncomp_buffer;
+			sz = uncomp_size;
+			delete [] buffer;
+		} else {
+			_buffer = buffer;
+		}
 	}
 
 	if (header.GitVersion[31]) {
@@ -435,7 +530,7 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 		write_len = snappy_max_compressed_length(sz);
 		break;
 	case SerializeCompressType::ZSTD:
-		write_len = ZSTD_compressBound(sz);
+		write_len = ZstdChunkedBound(sz);
 		break;
 	}
 	u8 *compressed_buffer = write_len == 0 ? nullptr : (u8 *)malloc(write_len);
@@ -456,20 +551,8 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 			success = snappy_compress((const char *)buffer, sz, (char *)compressed_buffer, &write_len) == SNAPPY_OK;
 			break;
 		case SerializeCompressType::ZSTD:
-			{
-				auto ctx = ZSTD_createCCtx();
-				if (!ctx) {
-					success = false;
-				} else {
-					// TODO: If free disk space is low, we could max this out to 22?
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
-					ZSTD_CCtx_setPledgedSrcSize(ctx, sz);
-					write_len = ZSTD_compress2(ctx, compressed_buffer, write_len, buffer, sz);
-					success = !ZSTD_isError(write_len);
-				}
-				ZSTD_freeCCtx(ctx);
-			}
+			write_len = CompressZstdChunked(compressed_buffer, buffer, sz);
+			success = write_len != 0;
 			break;
 		}
 
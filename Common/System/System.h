@@ -291,9 +291,12 @@ bool System_AudioRecordingState();
 // This will be changed to take an enum. Replacement for the old NativeMessageReceived.
 void System_PostUIMessage(UIMessage message, const std::string &param = "");
 
+struct AudioDebugStats;
+
 // For these functions, most platforms will use the implementation provided in UI/AudioCommon.cpp,
 // no need to implement separately.
 void System_AudioGetDebugStats(char *buf, size_t bufSize);
+void System_AudioGetDebugStats(AudioDebugStats *stats);
 void System_AudioClear();
 
 // These samples really have 16 bits of value, but can be a little out of range.
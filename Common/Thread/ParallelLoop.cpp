@@ -4,9 +4,10 @@
 #include "Common/Thread/ParallelLoop.h"
 #include "Common/CPUDetect.h"
 
-class LoopRangeTask : public Task {
+template <class Func>
+class LoopRangeTask : public Task, public PoolAllocated {
 public:
-	LoopRangeTask(WaitableCounter *counter, const std::function<void(int, int)> &loop, int lower, int upper, TaskPriority p)
+	LoopRangeTask(WaitableCounter *counter, const Func &loop, int lower, int upper, TaskPriority p)
 		: counter_(counter), loop_(loop), lower_(lower), upper_(upper), priority_(p) {}
 
 	TaskType Type() const override {
@@ -22,15 +23,16 @@ class LoopRangeTask : public Task {
 		counter_->Count();
 	}
 
-	std::function<void(int, int)> loop_;
 	WaitableCounter *counter_;
+	Func loop_;
 
 	int lower_;
 	int upper_;
 	const TaskPriority priority_;
 };
 
-WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize, TaskPriority priority) {
+template <class Func>
+static WaitableCounter *EnqueueRangeLoop(ThreadManager *threadMan, const Func &loop, int lower, int upper, int minSize, TaskPriority priority) {
 	if (minSize == -1) {
 		minSize = 1;
 	}
@@ -43,7 +45,7 @@ WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::
 	} else if (range <= minSize) {
 		// Single background task.
 		WaitableCounter *waitableCounter = new WaitableCounter(1);
-		threadMan->EnqueueTaskOnThread(0, new LoopRangeTask(waitableCounter, loop, lower, upper, priority));
+		threadMan->EnqueueTaskOnThread(0, new LoopRangeTask<Func>(waitableCounter, loop, lower, upper, priority), true);
 		return waitableCounter;
 	} else {
 		// Split the range between threads. Allow for some fractional bits.
@@ -70,7 +72,7 @@ WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::
 				// Let's do the stragglers on the current thread.
 				break;
 			}
-			threadMan->EnqueueTaskOnThread(i, new LoopRangeTask(waitableCounter, loop, start, end, priority));
+			threadMan->EnqueueTaskOnThread(i, new LoopRangeTask<Func>(waitableCounter, loop, start, end, priority), true);
 			counter += delta;
 			if ((counter >> fractionalBits) >= upper) {
 				break;
@@ -88,7 +90,11 @@ WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::
 	}
 }
 
-void ParallelRangeLoop(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize, TaskPriority priority) {
+WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize, TaskPriority priority) {
+	return EnqueueRangeLoop(threadMan, loop, lower, upper, minSize, priority);
+}
+
+void ParallelRangeLoop(ThreadManager *threadMan, RangeLoopRef loop, int lower, int upper, int minSize, TaskPriority priority) {
 	if (cpu_info.num_cores == 1 || (minSize >= (upper - lower) && upper > lower)) {
 		// "Optimization" for single-core devices, or minSize larger than the range.
 		// No point in adding threading overhead, let's just do it inline (since this is the blocking variant).
@@ -101,7 +107,8 @@ void ParallelRangeLoop(ThreadManager *threadMan, const std::function<void(int, i
 		minSize = 1;
 	}
 
-	WaitableCounter *counter = ParallelRangeLoopWaitable(threadMan, loop, lower, upper, minSize, priority);
+	// Since we wait for it here, the tasks can just refer to the loop.
+	WaitableCounter *counter = EnqueueRangeLoop(threadMan, loop, lower, upper, minSize, priority);
 	// TODO: Optimize using minSize. We'll just compute whether there's a remainer, remove it from the call to ParallelRangeLoopWaitable,
 	// and process the remainder right here. If there's no remainer, we'll steal a whole chunk.
 	if (counter) {
@@ -130,7 +137,7 @@ void ParallelMemcpy(ThreadManager *threadMan, void *dst, const void *src, size_t
 void ParallelMemset(ThreadManager *threadMan, void *dst, uint8_t value, size_t bytes, TaskPriority priority) {
 	// This threshold can probably be a lot bigger.
 	if (bytes < 128 * 1024) {
-		memset(dst, 0, bytes);
+		memset(dst, value, bytes);
 		return;
 	}
 
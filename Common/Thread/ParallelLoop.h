@@ -3,11 +3,12 @@
 #include <functional>
 #include <mutex>
 #include <condition_variable>
+#include <type_traits>
 
 #include "Common/Thread/ThreadManager.h"
 
 // Same as the latch from C++21.
-struct WaitableCounter : public Waitable {
+struct WaitableCounter : public Waitable, public PoolAllocated {
 public:
 	WaitableCounter(int count) : count_(count) {}
 
@@ -35,11 +36,48 @@ struct WaitableCounter : public Waitable {
 	std::condition_variable cond_;
 };
 
+// Refers to a loop body without copying it, so that lambdas don't have to become a std::function,
+// which may allocate.  Only valid as long as what it refers to, which is fine for blocking loops.
+class RangeLoopRef {
+public:
+	template <class F, typename = typename std::enable_if<
+		!std::is_same<typename std::decay<F>::type, RangeLoopRef>::value && !std::is_function<typename std::remove_reference<F>::type>::value>::type>
+	RangeLoopRef(F &&func) : call_(&CallObject<typename std::remove_reference<F>::type>) {
+		target_.obj = (void *)&func;
+	}
+	RangeLoopRef(void (*func)(int, int)) : call_(&CallFunction) {
+		target_.func = func;
+	}
+
+	void operator()(int lower, int upper) const {
+		call_(target_, lower, upper);
+	}
+
+private:
+	union Target {
+		void *obj;
+		void (*func)(int, int);
+	};
+
+	template <class F>
+	static void CallObject(const Target &target, int lower, int upper) {
+		(*(F *)target.obj)(lower, upper);
+	}
+	static void CallFunction(const Target &target, int lower, int upper) {
+		target.func(lower, upper);
+	}
+
+	Target target_;
+	void (*call_)(const Target &target, int lower, int upper);
+};
+
 // Note that upper bounds are non-inclusive: range is [lower, upper)
+// The loop is copied for each task, since they may outlive the call.
 WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize, TaskPriority priority);
 
 // Note that upper bounds are non-inclusive: range is [lower, upper)
-void ParallelRangeLoop(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize, TaskPriority priority = TaskPriority::NORMAL);
+// Doesn't allocate, except the first few times, so it's fine to call for small jobs.
+void ParallelRangeLoop(ThreadManager *threadMan, RangeLoopRef loop, int lower, int upper, int minSize, TaskPriority priority = TaskPriority::NORMAL);
 
 // Common utilities for large (!) memory copies.
 // Will only fall back to threads if it seems to make sense.
@@ -49,7 +87,7 @@ void ParallelMemset(ThreadManager *threadMan, void *dst, uint8_t value, size_t b
 
 
 template<class T>
-class SimpleParallelTask : public Task {
+class SimpleParallelTask : public Task, public PoolAllocated {
 public:
 	SimpleParallelTask(WaitableCounter *counter, T func, int index, int count, TaskPriority p)
 		: counter_(counter), func_(func), index_(index), count_(count), priority_(p) {
@@ -86,7 +124,7 @@ WaitableCounter *RunParallel(ThreadManager *threadMan, T func, int count, TaskPr
 	WaitableCounter *counter = new WaitableCounter(count);
 
 	for (int i = 0; i < count; i++) {
-		threadMan->EnqueueTaskOnThread(i, new SimpleParallelTask<T>(counter, func, i, count, priority));
+		threadMan->EnqueueTaskOnThread(i, new SimpleParallelTask<T>(counter, func, i, count, priority), true);
 	}
 
 	return counter;
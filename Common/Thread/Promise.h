@@ -105,6 +105,22 @@ class Promise {
 		}
 	}
 
+	// Like Poll, but also works if T isn't nullable or null is a valid result.
+	bool IsReady() {
+		uint32_t sentinel = sentinel_;
+		_assert_msg_(sentinel == 0xffc0ffee, "%08x", sentinel);
+		std::lock_guard<std::mutex> guard(readyMutex_);
+		if (ready_) {
+			return true;
+		} else if (rx_->Poll(&data_)) {
+			rx_->Release();
+			rx_ = nullptr;
+			ready_ = true;
+			return true;
+		}
+		return false;
+	}
+
 	T BlockUntilReady() {
 		uint32_t sentinel = sentinel_;
 		_assert_msg_(sentinel == 0xffc0ffee, "%08x", sentinel);
@@ -8,8 +8,10 @@
 #include <atomic>
 
 #include "Common/Log.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Thread/ThreadManager.h"
+#include "Common/Thread/WorkStealingDeque.h"
 
 // Threads and task scheduling
 //
@@ -19,10 +21,17 @@
 //   They should always be scheduled to the first N threads.
 // * For some tasks, splitting the input values up linearly between the threads
 //   is not fair. However, we ignore that for now.
+// * Compute threads each have a deque that they push and pop their own work on without locks,
+//   which idle compute threads steal from.  Work queued from other threads lands in a compute
+//   thread's inbox, which it moves to its deque once it gets to it.  Idle threads can also
+//   take from the inbox of a busy thread.  Tasks put on a specific thread's private queue
+//   are never stolen.
 
 const int MAX_CORES_TO_USE = 16;
 const int MIN_IO_BLOCKING_THREADS = 4;
 static constexpr size_t TASK_PRIORITY_COUNT = (size_t)TaskPriority::COUNT;
+// Per priority, per compute thread.  When full, the inbox is used instead.
+static constexpr size_t TASK_DEQUE_SIZE = 256;
 
 struct GlobalThreadContext {
 	std::mutex mutex;
@@ -31,22 +40,123 @@ struct GlobalThreadContext {
 	std::deque<Task *> io_queue[TASK_PRIORITY_COUNT];
 	std::atomic<int> io_queue_size;
 	std::vector<TaskThreadContext *> threads_;
+	int numComputeThreads = 0;
 
 	std::atomic<int> roundRobin;
 };
 
 struct TaskThreadContext {
+	GlobalThreadContext *global;
+	// Everything queued on this thread, including its deque and the task it's running.
 	std::atomic<int> queue_size;
 	std::deque<Task *> private_queue[TASK_PRIORITY_COUNT];
+	std::atomic<int> private_queue_size;
+	// Compute only.
+	std::deque<Task *> inbox[TASK_PRIORITY_COUNT];
+	std::atomic<int> inbox_size;
+	WorkStealingDeque<Task *, TASK_DEQUE_SIZE> deque[TASK_PRIORITY_COUNT];
+	std::atomic<bool> sleeping;
 	std::thread thread; // the worker thread
 	std::condition_variable cond; // used to signal new work
-	std::mutex mutex; // protects the local queue.
+	std::mutex mutex; // protects the private queue and inbox.
 	int index;
 	TaskType type;
 	std::atomic<bool> cancelled;
 	char name[16];
 };
 
+static thread_local TaskThreadContext *t_currentWorker = nullptr;
+
+// Size classes for PoolAllocated.  Cache line sized, so tasks written by different threads don't share lines.
+static constexpr size_t POOL_GRANULARITY = 64;
+static constexpr size_t POOL_CLASSES = 4;
+// Free blocks kept per thread and size class, before half are handed over to the shared list.
+static constexpr int POOL_CACHE_MAX = 64;
+
+struct PoolBlock {
+	PoolBlock *next;
+};
+
+struct PoolFreeList {
+	PoolBlock *head[POOL_CLASSES]{};
+	int count[POOL_CLASSES]{};
+
+	void Push(size_t c, PoolBlock *block) {
+		block->next = head[c];
+		head[c] = block;
+		count[c]++;
+	}
+	PoolBlock *Pop(size_t c) {
+		PoolBlock *block = head[c];
+		if (block) {
+			head[c] = block->next;
+			count[c]--;
+		}
+		return block;
+	}
+	void MoveTo(PoolFreeList &dest, size_t c, int n) {
+		while (n-- > 0 && head[c])
+			dest.Push(c, Pop(c));
+	}
+};
+
+struct PoolShared : PoolFreeList {
+	~PoolShared() {
+		for (size_t c = 0; c < POOL_CLASSES; ++c) {
+			while (PoolBlock *block = Pop(c))
+				::operator delete(block);
+		}
+	}
+
+	std::mutex lock;
+};
+
+static PoolShared g_poolShared;
+
+struct PoolCache : PoolFreeList {
+	~PoolCache() {
+		std::lock_guard<std::mutex> guard(g_poolShared.lock);
+		for (size_t c = 0; c < POOL_CLASSES; ++c)
+			MoveTo(g_poolShared, c, count[c]);
+	}
+};
+
+static thread_local PoolCache t_poolCache;
+
+void *PoolAllocated::operator new(size_t size) {
+	const size_t c = (size - 1) / POOL_GRANULARITY;
+	if (c >= POOL_CLASSES)
+		return ::operator new(size);
+
+	PoolCache &cache = t_poolCache;
+	PoolBlock *block = cache.Pop(c);
+	if (!block) {
+		// Grab a batch, so we don't take the lock every time.
+		std::lock_guard<std::mutex> guard(g_poolShared.lock);
+		g_poolShared.MoveTo(cache, c, POOL_CACHE_MAX / 2);
+		block = cache.Pop(c);
+	}
+	if (!block)
+		return ::operator new((c + 1) * POOL_GRANULARITY);
+	return block;
+}
+
+void PoolAllocated::operator delete(void *ptr, size_t size) {
+	const size_t c = (size - 1) / POOL_GRANULARITY;
+	if (c >= POOL_CLASSES) {
+		::operator delete(ptr);
+		return;
+	}
+
+	// Workers mostly free what other threads allocated, so these pile up and need to go back.
+	PoolCache &cache = t_poolCache;
+	cache.Push(c, (PoolBlock *)ptr);
+	if (cache.count[c] > POOL_CACHE_MAX) {
+		std::lock_guard<std::mutex> guard(g_poolShared.lock);
+		cache.MoveTo(g_poolShared, c, POOL_CACHE_MAX / 2);
+	}
+}
+
 ThreadManager::ThreadManager() : global_(new GlobalThreadContext()) {
 	global_->compute_queue_size = 0;
 	global_->io_queue_size = 0;
@@ -86,17 +196,29 @@ void ThreadManager::Teardown() {
 			continue;
 	}
 
+	// Compute threads look at each other's queues, so they all have to stop before any are deleted.
 	for (TaskThreadContext *&threadCtx : global_->threads_) {
 		threadCtx->thread.join();
+	}
+	for (TaskThreadContext *&threadCtx : global_->threads_) {
 		// TODO: Is it better to just delete these?
 		for (size_t i = 0; i < TASK_PRIORITY_COUNT; ++i) {
 			for (Task *task : threadCtx->private_queue[i]) {
 				TeardownTask(task, true);
 			}
+			for (Task *task : threadCtx->inbox[i]) {
+				TeardownTask(task, true);
+			}
+			// The owner has stopped, so it's safe to pop from here.
+			Task *task;
+			while (threadCtx->deque[i].Pop(&task)) {
+				TeardownTask(task, true);
+			}
 		}
 		delete threadCtx;
 	}
 	global_->threads_.clear();
+	global_->numComputeThreads = 0;
 
 	if (global_->compute_queue_size > 0 || global_->io_queue_size > 0) {
 		WARN_LOG(Log::System, "ThreadManager::Teardown() with tasks still enqueued");
@@ -128,6 +250,112 @@ bool ThreadManager::TeardownTask(Task *task, bool enqueue) {
 	return false;
 }
 
+// Wakes up a sleeping compute thread, so it can steal the work that was just queued.
+static void WakeIdleComputeThread(GlobalThreadContext *global, const TaskThreadContext *except) {
+	// Pairs with the fence in ComputeThreadShouldWait(), so either we see it sleeping or it sees the work.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	for (int i = 0; i < global->numComputeThreads; ++i) {
+		TaskThreadContext *thread = global->threads_[i];
+		if (thread != except && thread->sleeping.load(std::memory_order_relaxed)) {
+			std::unique_lock<std::mutex> lock(thread->mutex);
+			thread->cond.notify_one();
+			return;
+		}
+	}
+}
+
+// Moves a task that was counted on another thread over to this one.
+static Task *TakeStolen(TaskThreadContext *thread, TaskThreadContext *victim, Task *task) {
+	thread->queue_size++;
+	victim->queue_size--;
+	return task;
+}
+
+static Task *FindComputeTask(GlobalThreadContext *global, TaskThreadContext *thread) {
+	const int numCompute = global->numComputeThreads;
+	for (size_t p = 0; p < TASK_PRIORITY_COUNT; ++p) {
+		Task *task = nullptr;
+		if (thread->deque[p].Pop(&task))
+			return task;
+
+		if (thread->private_queue_size > 0 || thread->inbox_size > 0) {
+			std::unique_lock<std::mutex> lock(thread->mutex);
+			if (!thread->private_queue[p].empty()) {
+				task = thread->private_queue[p].front();
+				thread->private_queue[p].pop_front();
+				thread->private_queue_size--;
+				return task;
+			}
+			if (!thread->inbox[p].empty()) {
+				task = thread->inbox[p].front();
+				thread->inbox[p].pop_front();
+				thread->inbox_size--;
+				// Move the rest where others can steal them without the lock.
+				while (!thread->inbox[p].empty() && thread->deque[p].Push(thread->inbox[p].front())) {
+					thread->inbox[p].pop_front();
+					thread->inbox_size--;
+				}
+				// Don't hold our lock while taking another thread's.
+				lock.unlock();
+				if (!thread->deque[p].Empty())
+					WakeIdleComputeThread(global, thread);
+				return task;
+			}
+		}
+
+		if (global->compute_queue_size > 0) {
+			std::unique_lock<std::mutex> lock(global->mutex);
+			if (!global->compute_queue[p].empty()) {
+				task = global->compute_queue[p].front();
+				global->compute_queue[p].pop_front();
+				global->compute_queue_size--;
+				thread->queue_size++;
+				return task;
+			}
+		}
+
+		// Nothing of our own at this priority, time to steal.  Start after ourselves to spread it out.
+		for (int i = 1; i < numCompute; ++i) {
+			TaskThreadContext *victim = global->threads_[(thread->index + i) % numCompute];
+			if (victim->deque[p].Steal(&task))
+				return TakeStolen(thread, victim, task);
+		}
+		for (int i = 1; i < numCompute; ++i) {
+			TaskThreadContext *victim = global->threads_[(thread->index + i) % numCompute];
+			if (victim->inbox_size == 0)
+				continue;
+			// If it's contended, the owner or another thief is on it.
+			std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+			if (lock.owns_lock() && !victim->inbox[p].empty()) {
+				task = victim->inbox[p].front();
+				victim->inbox[p].pop_front();
+				victim->inbox_size--;
+				return TakeStolen(thread, victim, task);
+			}
+		}
+	}
+	return nullptr;
+}
+
+// Must be called with the thread's mutex locked, and sleeping set.
+static bool ComputeThreadShouldWait(GlobalThreadContext *global, TaskThreadContext *thread) {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (thread->cancelled || thread->private_queue_size > 0 || thread->inbox_size > 0 || global->compute_queue_size > 0)
+		return false;
+	for (int i = 0; i < global->numComputeThreads; ++i) {
+		TaskThreadContext *other = global->threads_[i];
+		if (other == thread)
+			continue;
+		if (other->inbox_size > 0)
+			return false;
+		for (size_t p = 0; p < TASK_PRIORITY_COUNT; ++p) {
+			if (!other->deque[p].Empty())
+				return false;
+		}
+	}
+	return true;
+}
+
 static void WorkerThreadFunc(GlobalThreadContext *global, TaskThreadContext *thread) {
 	if (thread->type == TaskType::CPU_COMPUTE) {
 		snprintf(thread->name, sizeof(thread->name), "PoolW %d", thread->index);
@@ -136,76 +364,91 @@ static void WorkerThreadFunc(GlobalThreadContext *global, TaskThreadContext *thr
 		snprintf(thread->name, sizeof(thread->name), "PoolW IO %d", thread->index);
 	}
 	SetCurrentThreadName(thread->name);
+	t_currentWorker = thread;
+
+	// Tasks pinned to threads go to the first ones, like the software renderer's.
+	if (thread->type == TaskType::IO_BLOCKING)
+		SetCurrentThreadCoreClass(ThreadCoreClass::EFFICIENCY);
+	else if (thread->index < GetNumPerformanceCores())
+		SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 
 	if (thread->type == TaskType::IO_BLOCKING) {
 		AttachThreadToJNI();
 	}
 
 	const bool isCompute = thread->type == TaskType::CPU_COMPUTE;
-	const auto global_queue_size = [isCompute, &global]() -> int {
-		return isCompute ? global->compute_queue_size.load() : global->io_queue_size.load();
-	};
 
 	while (!thread->cancelled) {
 		Task *task = nullptr;
 
-		// Check the global queue first, then check the private queue and wait if there's nothing to do.
-		if (global_queue_size() > 0) {
-			// Grab one from the global queue if there is any.
-			std::unique_lock<std::mutex> lock(global->mutex);
-			auto queue = isCompute ? global->compute_queue : global->io_queue;
-			auto &queue_size = isCompute ? global->compute_queue_size : global->io_queue_size;
-
-			for (size_t p = 0; p < TASK_PRIORITY_COUNT; ++p) {
-				if (!queue[p].empty()) {
-					task = queue[p].front();
-					queue[p].pop_front();
-					queue_size--;
-
-					// We are processing one now, so mark that.
-					thread->queue_size++;
-					break;
-				} else if (thread->queue_size != 0) {
-					// Check the thread, as we prefer a HIGH thread task to a global NORMAL task.
-					std::unique_lock<std::mutex> lock(thread->mutex);
-					if (!thread->private_queue[p].empty()) {
-						task = thread->private_queue[p].front();
-						thread->private_queue[p].pop_front();
+		if (isCompute) {
+			task = FindComputeTask(global, thread);
+			if (!task) {
+				std::unique_lock<std::mutex> lock(thread->mutex);
+				thread->sleeping = true;
+				if (ComputeThreadShouldWait(global, thread))
+					thread->cond.wait(lock);
+				thread->sleeping = false;
+			}
+		} else {
+			// Check the global queue first, then check the private queue and wait if there's nothing to do.
+			if (global->io_queue_size > 0) {
+				// Grab one from the global queue if there is any.
+				std::unique_lock<std::mutex> lock(global->mutex);
+				for (size_t p = 0; p < TASK_PRIORITY_COUNT; ++p) {
+					if (!global->io_queue[p].empty()) {
+						task = global->io_queue[p].front();
+						global->io_queue[p].pop_front();
+						global->io_queue_size--;
+
+						// We are processing one now, so mark that.
+						thread->queue_size++;
 						break;
+					} else if (thread->queue_size != 0) {
+						// Check the thread, as we prefer a HIGH thread task to a global NORMAL task.
+						std::unique_lock<std::mutex> lock(thread->mutex);
+						if (!thread->private_queue[p].empty()) {
+							task = thread->private_queue[p].front();
+							thread->private_queue[p].pop_front();
+							thread->private_queue_size--;
+							break;
+						}
 					}
 				}
 			}
-		}
 
-		if (!task) {
-			// We didn't have any global, do we have anything on the thread?
-			std::unique_lock<std::mutex> lock(thread->mutex);
-			for (size_t p = 0; p < TASK_PRIORITY_COUNT; ++p) {
-				if (thread->private_queue[p].empty())
-					continue;
+			if (!task) {
+				// We didn't have any global, do we have anything on the thread?
+				std::unique_lock<std::mutex> lock(thread->mutex);
+				for (size_t p = 0; p < TASK_PRIORITY_COUNT; ++p) {
+					if (thread->private_queue[p].empty())
+						continue;
 
-				task = thread->private_queue[p].front();
-				thread->private_queue[p].pop_front();
-				break;
-			}
+					task = thread->private_queue[p].front();
+					thread->private_queue[p].pop_front();
+					thread->private_queue_size--;
+					break;
+				}
 
-			// We must check both queue and single again, while locked.
-			bool wait = !thread->cancelled && !task && global_queue_size() == 0;
+				// We must check both queue and single again, while locked.
+				bool wait = !thread->cancelled && !task && global->io_queue_size == 0;
 
-			if (wait)
-				thread->cond.wait(lock);
+				if (wait)
+					thread->cond.wait(lock);
+			}
 		}
 		// The task itself takes care of notifying anyone waiting on it. Not the
 		// responsibility of the ThreadManager (although it could be!).
 		if (task) {
+			TRACE_SCOPE(isCompute ? "task_compute" : "task_io");
 			task->Run();
 			task->Release();
 			// Reduce the queue size once complete.
 			thread->queue_size--;
-			// _dbg_assert_(thread->queue_size == thread->private_queue[0].size() + thread->private_queue[1].size() + thread->private_queue[2].size());
 		}
 	}
 
+	t_currentWorker = nullptr;
 	// In case it got attached to JNI, detach it. Don't think this has any side effects if called redundantly.
 	if (thread->type == TaskType::IO_BLOCKING) {
 		DetachThreadFromJNI();
@@ -224,20 +467,30 @@ void ThreadManager::Init(int numRealCores, int numLogicalCoresPerCpu) {
 
 	INFO_LOG(Log::System, "ThreadManager::Init(compute threads: %d, all: %d)", numComputeThreads_, numThreads_);
 
+	// All threads must exist before any start, since compute threads look at each other.
+	global_->numComputeThreads = numComputeThreads_;
 	for (int i = 0; i < numThreads; i++) {
 		TaskThreadContext *thread = new TaskThreadContext();
+		thread->global = global_;
 		thread->cancelled.store(false);
+		thread->queue_size = 0;
+		thread->private_queue_size = 0;
+		thread->inbox_size = 0;
+		thread->sleeping = false;
 		thread->type = i < numComputeThreads_ ? TaskType::CPU_COMPUTE : TaskType::IO_BLOCKING;
 		thread->index = i;
-		thread->thread = std::thread(&WorkerThreadFunc, global_, thread);
 		global_->threads_.push_back(thread);
 	}
+	for (TaskThreadContext *thread : global_->threads_) {
+		thread->thread = std::thread(&WorkerThreadFunc, global_, thread);
+	}
 }
 
 void ThreadManager::EnqueueTask(Task *task) {
 	if (task->Type() == TaskType::DEDICATED_THREAD) {
 		std::thread th([=](Task *task) {
 			SetCurrentThreadName("DedicatedThreadTask");
+			TRACE_SCOPE("task_dedicated");
 			task->Run();
 			task->Release();
 		}, task);
@@ -260,13 +513,29 @@ void ThreadManager::EnqueueTask(Task *task) {
 		maxThread = numThreads_;
 	}
 
+	if (task->Type() == TaskType::CPU_COMPUTE) {
+		// From a compute thread, keep it local and let idle threads steal it.
+		TaskThreadContext *current = t_currentWorker;
+		if (current && current->global == global_ && current->type == TaskType::CPU_COMPUTE && current->deque[queueIndex].Push(task)) {
+			current->queue_size++;
+			WakeIdleComputeThread(global_, current);
+			return;
+		}
+	}
+
 	// Find a thread with no outstanding work.
 	_assert_(maxThread <= (int)global_->threads_.size());
 	for (int threadNum = minThread; threadNum < maxThread; threadNum++) {
 		TaskThreadContext *thread = global_->threads_[threadNum];
 		if (thread->queue_size.load() == 0) {
 			std::unique_lock<std::mutex> lock(thread->mutex);
-			thread->private_queue[queueIndex].push_back(task);
+			if (task->Type() == TaskType::CPU_COMPUTE) {
+				thread->inbox[queueIndex].push_back(task);
+				thread->inbox_size++;
+			} else {
+				thread->private_queue[queueIndex].push_back(task);
+				thread->private_queue_size++;
+			}
 			thread->queue_size++;
 			thread->cond.notify_one();
 			// Found it - done.
@@ -274,42 +543,55 @@ void ThreadManager::EnqueueTask(Task *task) {
 		}
 	}
 
+	int chosenIndex = global_->roundRobin++;
+	chosenIndex = minThread + (chosenIndex % (maxThread - minThread));
+	TaskThreadContext *&chosenThread = global_->threads_[chosenIndex];
+
+	if (task->Type() == TaskType::CPU_COMPUTE) {
+		// All busy, so any thread that finishes first can steal it from the inbox.
+		EnqueueTaskOnThread(chosenIndex, task, true);
+		return;
+	}
+
 	// Still not scheduled? Put it on the global queue and notify a thread chosen by round-robin.
 	// Not particularly scientific, but hopefully we should not run into this too much.
 	{
 		std::unique_lock<std::mutex> lock(global_->mutex);
-		if (task->Type() == TaskType::CPU_COMPUTE) {
-			global_->compute_queue[queueIndex].push_back(task);
-			global_->compute_queue_size++;
-		} else if (task->Type() == TaskType::IO_BLOCKING) {
-			global_->io_queue[queueIndex].push_back(task);
-			global_->io_queue_size++;
-		} else {
-			_assert_(false);
-		}
+		_assert_(task->Type() == TaskType::IO_BLOCKING);
+		global_->io_queue[queueIndex].push_back(task);
+		global_->io_queue_size++;
 	}
 
-	int chosenIndex = global_->roundRobin++;
-	chosenIndex = minThread + (chosenIndex % (maxThread - minThread));
-	TaskThreadContext *&chosenThread = global_->threads_[chosenIndex];
-
 	// Lock the thread to ensure it gets the message.
 	std::unique_lock<std::mutex> lock(chosenThread->mutex);
 	chosenThread->cond.notify_one();
 }
 
-void ThreadManager::EnqueueTaskOnThread(int threadNum, Task *task) {
+void ThreadManager::EnqueueTaskOnThread(int threadNum, Task *task, bool allowSteal) {
 	_assert_msg_(task->Type() != TaskType::DEDICATED_THREAD, "Dedicated thread tasks can't be put on specific threads");
 
 	_assert_msg_(threadNum >= 0 && threadNum < (int)global_->threads_.size(), "Bad threadnum or not initialized");
 	TaskThreadContext *thread = global_->threads_[threadNum];
 	size_t queueIndex = (size_t)task->Priority();
 
-	thread->queue_size++;
+	const bool wasBusy = thread->queue_size++ != 0;
+	const bool stealable = allowSteal && thread->type == TaskType::CPU_COMPUTE;
+
+	{
+		std::unique_lock<std::mutex> lock(thread->mutex);
+		if (stealable) {
+			thread->inbox[queueIndex].push_back(task);
+			thread->inbox_size++;
+		} else {
+			thread->private_queue[queueIndex].push_back(task);
+			thread->private_queue_size++;
+		}
+		thread->cond.notify_one();
+	}
 
-	std::unique_lock<std::mutex> lock(thread->mutex);
-	thread->private_queue[queueIndex].push_back(task);
-	thread->cond.notify_one();
+	// It might be a while before that thread gets to it.
+	if (stealable && wasBusy)
+		WakeIdleComputeThread(global_, thread);
 }
 
 int ThreadManager::GetNumLooperThreads() const {
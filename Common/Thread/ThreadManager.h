@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 // The new threadpool.
@@ -19,6 +20,15 @@ enum class TaskPriority {
 	COUNT,
 };
 
+// Tasks and counters are usually created on one thread and freed on another, which general allocators
+// are slow at.  Inherit from this as well to allocate from free lists, cached per thread, instead.
+// Sized delete makes sure subclasses get the right size.
+class PoolAllocated {
+public:
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr, size_t size);
+};
+
 // Implement this to make something that you can run on the thread manager.
 class Task {
 public:
@@ -54,12 +64,13 @@ class ThreadManager {
 	~ThreadManager();
 
 	// The distinction here is to be able to take hyper-threading into account.
-	// It gets even trickier when you think about mobile chips with BIG/LITTLE, but we'll
-	// just ignore it and let the OS handle it.
+	// With big.LITTLE and similar, the first compute threads prefer the performance cores, and the
+	// I/O threads the efficiency cores.  The rest of the compute threads are left to the OS.
 	void Init(int numCores, int numLogicalCoresPerCpu);
 	void EnqueueTask(Task *task);
-	// Use enforceSequence if this must run after all previously queued tasks.
-	void EnqueueTaskOnThread(int threadNum, Task *task);
+	// With allowSteal, an idle compute thread may run it instead, if this thread is busy.
+	// Otherwise, it's guaranteed to run on this thread, in order with other such tasks of the same priority.
+	void EnqueueTaskOnThread(int threadNum, Task *task, bool allowSteal = false);
 	void Teardown();
 
 	bool IsInitialized() const;
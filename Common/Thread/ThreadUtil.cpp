@@ -21,6 +21,7 @@
 // TODO: Many other platforms also support TLS, in fact probably nearly all that we support
 // these days.
 
+#include <algorithm>
 #include <cstring>
 #include <cstdint>
 
@@ -60,6 +61,15 @@ void RegisterAttachDetach(AttachDetachFunc attach, AttachDetachFunc detach) {
 #include <sys/syscall.h>
 #endif
 
+#if (PPSSPP_PLATFORM(ANDROID) || PPSSPP_PLATFORM(LINUX)) && !defined(__LIBRETRO__)
+#include <sched.h>
+#include <cstdio>
+#include <mutex>
+#define CORE_AFFINITY_SUPPORTED
+#elif defined(__APPLE__)
+#include <pthread/qos.h>
+#endif
+
 #if defined(__DragonFly__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 #include <pthread_np.h>
 #elif defined(__NetBSD__)
@@ -215,6 +225,135 @@ void SetCurrentThreadNameThroughException(const char *threadName) {
 }
 #endif
 
+#ifdef CORE_AFFINITY_SUPPORTED
+struct CoreClusters {
+	cpu_set_t all;
+	cpu_set_t performance;
+	cpu_set_t efficiency;
+	int numPerformance = 0;
+	bool mixed = false;
+};
+
+static CoreClusters g_coreClusters;
+static std::once_flag g_coreClustersOnce;
+
+static uint64_t ReadCPUValue(int cpu, const char *name) {
+	char path[128];
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu, name);
+	FILE *f = fopen(path, "r");
+	if (!f)
+		return 0;
+	unsigned long long value = 0;
+	if (fscanf(f, "%llu", &value) != 1)
+		value = 0;
+	fclose(f);
+	return value;
+}
+
+static void DetectCoreClusters() {
+	CoreClusters &c = g_coreClusters;
+	CPU_ZERO(&c.all);
+	CPU_ZERO(&c.performance);
+	CPU_ZERO(&c.efficiency);
+
+	// cpu_capacity is what the scheduler itself uses, but older kernels only have the max frequency,
+	// which works for telling clusters of the same core type apart too.
+	const int numCPUs = std::min((int)sysconf(_SC_NPROCESSORS_CONF), (int)CPU_SETSIZE);
+	uint64_t capacity[CPU_SETSIZE]{};
+	uint64_t minCapacity = UINT64_MAX;
+	uint64_t maxCapacity = 0;
+	for (int cpu = 0; cpu < numCPUs; ++cpu) {
+		uint64_t value = ReadCPUValue(cpu, "cpu_capacity");
+		if (value == 0)
+			value = ReadCPUValue(cpu, "cpufreq/cpuinfo_max_freq");
+		if (value == 0)
+			continue;
+		capacity[cpu] = value;
+		CPU_SET(cpu, &c.all);
+		minCapacity = std::min(minCapacity, value);
+		maxCapacity = std::max(maxCapacity, value);
+	}
+
+	// Small differences are just binning, like a single boosting core.  Not worth splitting over.
+	if (maxCapacity == 0 || maxCapacity * 4 < minCapacity * 5)
+		return;
+
+	for (int cpu = 0; cpu < numCPUs; ++cpu) {
+		if (capacity[cpu] == 0)
+			continue;
+		if (capacity[cpu] == minCapacity) {
+			CPU_SET(cpu, &c.efficiency);
+		} else {
+			// Both "big" and "prime" cores go here.
+			CPU_SET(cpu, &c.performance);
+			c.numPerformance++;
+		}
+	}
+	c.mixed = true;
+	INFO_LOG(Log::System, "Detected %d performance cores and %d efficiency cores", c.numPerformance, CPU_COUNT(&c.efficiency));
+}
+#endif
+
+#if PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(UWP)
+// Not in older SDKs, or MinGW.
+struct PPSSPP_THREAD_POWER_THROTTLING_STATE {
+	ULONG Version;
+	ULONG ControlMask;
+	ULONG StateMask;
+};
+typedef BOOL (WINAPI *TSetThreadInformation)(HANDLE, int, LPVOID, DWORD);
+#endif
+
+void SetCurrentThreadCoreClass(ThreadCoreClass coreClass) {
+#ifdef CORE_AFFINITY_SUPPORTED
+	std::call_once(g_coreClustersOnce, &DetectCoreClusters);
+	const CoreClusters &c = g_coreClusters;
+	if (!c.mixed)
+		return;
+
+	const cpu_set_t *set = &c.all;
+	if (coreClass == ThreadCoreClass::PERFORMANCE)
+		set = &c.performance;
+	else if (coreClass == ThreadCoreClass::EFFICIENCY)
+		set = &c.efficiency;
+	// 0 means the calling thread, not the whole process.
+	if (sched_setaffinity(0, sizeof(cpu_set_t), set) != 0) {
+		WARN_LOG(Log::System, "Failed to set the affinity of thread %s", GetCurrentThreadName());
+	}
+#elif defined(__APPLE__)
+	qos_class_t qos = QOS_CLASS_DEFAULT;
+	if (coreClass == ThreadCoreClass::PERFORMANCE)
+		qos = QOS_CLASS_USER_INTERACTIVE;
+	else if (coreClass == ThreadCoreClass::EFFICIENCY)
+		qos = QOS_CLASS_UTILITY;
+	pthread_set_qos_class_self_np(qos, 0);
+#elif PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(UWP)
+	// Windows 11 schedules by this on hybrid CPUs (EcoQoS), and it's ignored elsewhere.
+	static const TSetThreadInformation pSetThreadInformation = reinterpret_cast<TSetThreadInformation>(GetProcAddress(GetModuleHandle(L"kernel32.dll"), "SetThreadInformation"));
+	if (!pSetThreadInformation)
+		return;
+	const int ThreadPowerThrottlingClass = 3;
+	const ULONG EXECUTION_SPEED = 0x1;
+	PPSSPP_THREAD_POWER_THROTTLING_STATE state{ 1, 0, 0 };
+	if (coreClass == ThreadCoreClass::PERFORMANCE) {
+		state.ControlMask = EXECUTION_SPEED;
+	} else if (coreClass == ThreadCoreClass::EFFICIENCY) {
+		state.ControlMask = EXECUTION_SPEED;
+		state.StateMask = EXECUTION_SPEED;
+	}
+	pSetThreadInformation(GetCurrentThread(), ThreadPowerThrottlingClass, &state, sizeof(state));
+#endif
+}
+
+int GetNumPerformanceCores() {
+#ifdef CORE_AFFINITY_SUPPORTED
+	std::call_once(g_coreClustersOnce, &DetectCoreClusters);
+	return g_coreClusters.mixed ? g_coreClusters.numPerformance : 0;
+#else
+	return 0;
+#endif
+}
+
 void AssertCurrentThreadName(const char *threadName) {
 #ifdef TLS_SUPPORTED
 	if (strcmp(curThreadName, threadName) != 0) {
@@ -10,6 +10,22 @@ void AssertCurrentThreadName(const char *threadName);
 // If TLS is not supported, this will return an empty string.
 const char *GetCurrentThreadName();
 
+// The kind of core a thread should run on, for CPUs that mix fast and power-efficient cores (like big.LITTLE.)
+enum class ThreadCoreClass {
+	ANY,
+	// Latency sensitive, like emulation and rendering.
+	PERFORMANCE,
+	// I/O and background work.
+	EFFICIENCY,
+};
+
+// Uses affinity on Linux and Android, and QoS on Apple platforms and Windows.
+// Does nothing if all cores are the same.
+void SetCurrentThreadCoreClass(ThreadCoreClass coreClass);
+
+// How many cores are faster than the slowest ones.  0 if they're all the same, or it's unknown.
+int GetNumPerformanceCores();
+
 // Just gets a cheap thread identifier so that you can see different threads in debug output,
 // exactly what it is is badly specified and not useful for anything.
 int GetCurrentThreadIdForDebug();
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Chase-Lev work stealing deque, with the memory ordering from "Correct and Efficient Work-Stealing
+// for Weak Memory Models" (Lê et al, 2013.)
+//
+// Only the owning thread may Push and Pop, which work on the bottom end like a stack.  Any thread may
+// Steal, which takes from the top, so thieves get the oldest work.  None of these take locks.
+// The capacity is fixed, Push fails when it's full.  T must be trivially copyable, like a pointer.
+template <typename T, size_t N>
+class WorkStealingDeque {
+	static_assert((N & (N - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+	bool Push(T item) {
+		int64_t b = bottom_.load(std::memory_order_relaxed);
+		int64_t t = top_.load(std::memory_order_acquire);
+		if (b - t >= (int64_t)N)
+			return false;
+		buffer_[b & (N - 1)].store(item, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom_.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool Pop(T *item) {
+		int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+		bottom_.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top_.load(std::memory_order_relaxed);
+		if (t > b) {
+			// Was empty.
+			bottom_.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		*item = buffer_[b & (N - 1)].load(std::memory_order_relaxed);
+		if (t == b) {
+			// The last one, a thief might be after it too.
+			bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom_.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	// Can fail spuriously when racing with another thief or the owner.
+	bool Steal(T *item) {
+		int64_t t = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom_.load(std::memory_order_acquire);
+		if (t >= b)
+			return false;
+
+		T stolen = buffer_[t & (N - 1)].load(std::memory_order_relaxed);
+		if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return false;
+		*item = stolen;
+		return true;
+	}
+
+	// Only a hint when other threads are using it.
+	bool Empty() const {
+		int64_t b = bottom_.load(std::memory_order_seq_cst);
+		int64_t t = top_.load(std::memory_order_seq_cst);
+		return b <= t;
+	}
+
+private:
+	// On separate cache lines, since the owner and thieves hammer different ends.
+	alignas(64) std::atomic<int64_t> top_{ 0 };
+	alignas(64) std::atomic<int64_t> bottom_{ 0 };
+	alignas(64) std::atomic<T> buffer_[N]{};
+};
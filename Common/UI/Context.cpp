@@ -49,6 +49,8 @@ void UIContext::BeginFrame() {
 	if (!uitexture_ || UIAtlas_ != lastUIAtlas_) {
 		uitexture_ = CreateTextureFromFile(draw_, UIAtlas_.c_str(), ImageFileType::ZIM, false);
 		lastUIAtlas_ = UIAtlas_;
+		// Text drawn from the text atlas switches back to this afterwards.
+		uidrawbuffer_->SetDefaultTexture(uitexture_);
 		if (!fontTexture_) {
 #if PPSSPP_PLATFORM(WINDOWS) || PPSSPP_PLATFORM(ANDROID)
 			// Don't bother with loading font_atlas.zim
@@ -595,6 +595,14 @@ int GetVRPassesCount() {
 	return vrStereo ? 2 : 1;
 }
 
+void SetVRSinglePass(bool singlePass) {
+	VR_SetConfig(VR_CONFIG_SINGLE_PASS, singlePass);
+}
+
+bool IsVRSinglePass() {
+	return VR_GetConfig(VR_CONFIG_SINGLE_PASS) != 0;
+}
+
 bool IsPassthroughSupported() {
 	return VR_GetPlatformFlag(VR_PLATFORM_EXTENSION_PASSTHROUGH);
 }
@@ -52,6 +52,8 @@ void PreVRFrameRender(int fboIndex);
 void PostVRFrameRender();
 int GetVRFBOIndex();
 int GetVRPassesCount();
+void SetVRSinglePass(bool singlePass);
+bool IsVRSinglePass();
 bool IsPassthroughSupported();
 bool IsFlatVRGame();
 bool IsFlatVRScene();
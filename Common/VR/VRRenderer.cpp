@@ -390,7 +390,7 @@ void VR_FinishFrame( engine_t* engine ) {
 			if (vrMode != VR_MODE_MONO_6DOF) {
 				pose = invViewTransform[eye];
 			}
-			if (vrMode == VR_MODE_STEREO_6DOF) {
+			if ((vrMode == VR_MODE_STEREO_6DOF) && !vrConfig[VR_CONFIG_SINGLE_PASS]) {
 				frameBuffer = &engine->appState.Renderer.FrameBuffer[eye];
 			}
 
@@ -478,7 +478,10 @@ void VR_FinishFrame( engine_t* engine ) {
 			cylinder_layer.eyeVisibility = XR_EYE_VISIBILITY_LEFT;
 			engine->appState.Layers[engine->appState.LayerCount++].Cylinder = cylinder_layer;
 			cylinder_layer.eyeVisibility = XR_EYE_VISIBILITY_RIGHT;
-			cylinder_layer.subImage.swapchain = engine->appState.Renderer.FrameBuffer[1].ColorSwapChain.Handle;
+			if (!vrConfig[VR_CONFIG_SINGLE_PASS]) {
+				// Both eyes got the same image if only one pass was rendered.
+				cylinder_layer.subImage.swapchain = engine->appState.Renderer.FrameBuffer[1].ColorSwapChain.Handle;
+			}
 			engine->appState.Layers[engine->appState.LayerCount++].Cylinder = cylinder_layer;
 		}
 	}
@@ -11,7 +11,7 @@ enum VRConfig {
 	//viewport setup
 	VR_CONFIG_VIEWPORT_WIDTH, VR_CONFIG_VIEWPORT_HEIGHT, VR_CONFIG_VIEWPORT_VALID,
 	//render status
-	VR_CONFIG_CURRENT_FBO,
+	VR_CONFIG_CURRENT_FBO, VR_CONFIG_SINGLE_PASS,
 
 	//end
 	VR_CONFIG_MAX
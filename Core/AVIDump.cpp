@@ -8,9 +8,14 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
 #include <cstdint>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #ifdef USE_FFMPEG
 
@@ -26,6 +31,7 @@ extern "C" {
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/Path.h"
+#include "Common/Thread/ThreadUtil.h"
 
 #include "Core/Config.h"
 #include "Core/AVIDump.h"
@@ -54,6 +60,23 @@ static AVFrame *s_src_frame = nullptr;
 static AVFrame *s_scaled_frame = nullptr;
 static SwsContext *s_sws_context = nullptr;
 
+// Frames are converted and encoded on their own thread, so the emu thread only pays for the readback.
+struct PendingFrame {
+	std::vector<u8> rgb;
+	int w;
+	int h;
+};
+
+// Enough to ride out a slow frame, while keeping the emulator from running far ahead of the encoder.
+#define MAX_QUEUED_FRAMES 4
+
+static std::thread s_encodeThread;
+static std::mutex s_queueLock;
+static std::condition_variable s_queueCond;
+static std::deque<PendingFrame> s_queue;
+static std::vector<std::vector<u8>> s_freeBuffers;
+static bool s_encodeStop = false;
+
 #endif
 
 static int s_bytes_per_pixel;
@@ -88,9 +111,81 @@ bool AVIDump::Start(int w, int h)
 	bool success = CreateAVI();
 	if (!success)
 		CloseFile();
+#ifdef USE_FFMPEG
+	else
+		StartEncodeThread();
+#endif
 	return success;
 }
 
+#ifdef USE_FFMPEG
+
+static void SetupCodecContext(AVCodecID codecID, AVPixelFormat pixFmt) {
+	s_codec_context->codec_id = codecID;
+	s_codec_context->codec_type = AVMEDIA_TYPE_VIDEO;
+	s_codec_context->bit_rate = 400000;
+	s_codec_context->width = s_width;
+	s_codec_context->height = s_height;
+	s_codec_context->time_base.num = 1001;
+	s_codec_context->time_base.den = 60000;
+	s_codec_context->gop_size = 12;
+	s_codec_context->pix_fmt = pixFmt;
+}
+
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
+
+// All of these take frames from system memory.  VAAPI isn't here, since it only takes frames that
+// were already uploaded to its own surfaces.
+static const char *const hardwareEncoders[] = {
+	"h264_nvenc",
+	"h264_amf",
+	"h264_qsv",
+	"h264_mf",
+	"h264_videotoolbox",
+};
+
+static AVPixelFormat PickHardwareEncoderFormat(AVCodec *codec) {
+	if (!codec->pix_fmts)
+		return AV_PIX_FMT_YUV420P;
+	for (const AVPixelFormat *fmt = codec->pix_fmts; *fmt != AV_PIX_FMT_NONE; ++fmt) {
+		if (*fmt == AV_PIX_FMT_NV12 || *fmt == AV_PIX_FMT_YUV420P)
+			return *fmt;
+	}
+	return AV_PIX_FMT_NONE;
+}
+
+// Being built in doesn't mean there's hardware for it, so these are tried until one opens.
+static bool OpenHardwareEncoder() {
+	for (const char *name : hardwareEncoders) {
+		AVCodec *codec = avcodec_find_encoder_by_name(name);
+		if (!codec)
+			continue;
+		AVPixelFormat pixFmt = PickHardwareEncoderFormat(codec);
+		if (pixFmt == AV_PIX_FMT_NONE)
+			continue;
+
+		s_codec_context = avcodec_alloc_context3(codec);
+		if (!s_codec_context)
+			return false;
+		SetupCodecContext(codec->id, pixFmt);
+		// Full speed at full resolution is the point, so give it enough bits: about 8 Mbit/s at 1080p.
+		s_codec_context->bit_rate = (int64_t)s_width * s_height * 4;
+		// AVI doesn't handle reordered frames well.
+		s_codec_context->max_b_frames = 0;
+		if (avcodec_open2(s_codec_context, codec, nullptr) >= 0) {
+			INFO_LOG(Log::G3D, "Recording video with hardware encoder %s", name);
+			return true;
+		}
+		avcodec_free_context(&s_codec_context);
+	}
+	WARN_LOG(Log::G3D, "No hardware video encoder available, using the software one");
+	return false;
+}
+
+#endif
+
+#endif
+
 bool AVIDump::CreateAVI() {
 #ifdef USE_FFMPEG
 	AVCodec *codec = nullptr;
@@ -125,33 +220,37 @@ bool AVIDump::CreateAVI() {
 	if (!s_stream)
 		return false;
 
+	bool hardware = false;
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
+	if (g_Config.bHardwareVideoEncoder && !g_Config.bUseFFV1) {
+		hardware = OpenHardwareEncoder();
+		// Opened first, since the parameters are only final then.
+		if (hardware && avcodec_parameters_from_context(s_stream->codecpar, s_codec_context) < 0)
+			return false;
+	}
+#endif
+
+	if (!hardware) {
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 48, 101)
-	s_codec_context = s_stream->codec;
+		s_codec_context = s_stream->codec;
 #else
-	s_codec_context = avcodec_alloc_context3(codec);
+		s_codec_context = avcodec_alloc_context3(codec);
 #endif
-	s_codec_context->codec_id = g_Config.bUseFFV1 ? AV_CODEC_ID_FFV1 : s_format_context->oformat->video_codec;
-	if (!g_Config.bUseFFV1)
-		s_codec_context->codec_tag = MKTAG('X', 'V', 'I', 'D');  // Force XVID FourCC for better compatibility
-	s_codec_context->codec_type = AVMEDIA_TYPE_VIDEO;
-	s_codec_context->bit_rate = 400000;
-	s_codec_context->width = s_width;
-	s_codec_context->height = s_height;
-	s_codec_context->time_base.num = 1001;
-	s_codec_context->time_base.den = 60000;
-	s_codec_context->gop_size = 12;
-	s_codec_context->pix_fmt = g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+		SetupCodecContext(g_Config.bUseFFV1 ? AV_CODEC_ID_FFV1 : s_format_context->oformat->video_codec, g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P);
+		if (!g_Config.bUseFFV1)
+			s_codec_context->codec_tag = MKTAG('X', 'V', 'I', 'D');  // Force XVID FourCC for better compatibility
 
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
-	if (avcodec_parameters_from_context(s_stream->codecpar, s_codec_context) < 0)
-		return false;
+		if (avcodec_parameters_from_context(s_stream->codecpar, s_codec_context) < 0)
+			return false;
 #endif
 
-	codec = avcodec_find_encoder(s_codec_context->codec_id);
-	if (!codec)
-		return false;
-	if (avcodec_open2(s_codec_context, codec, nullptr) < 0)
-		return false;
+		codec = avcodec_find_encoder(s_codec_context->codec_id);
+		if (!codec)
+			return false;
+		if (avcodec_open2(s_codec_context, codec, nullptr) < 0)
+			return false;
+	}
 
 	s_src_frame = av_frame_alloc();
 	s_scaled_frame = av_frame_alloc();
@@ -188,35 +287,53 @@ static void PreparePacket(AVPacket* pkt) {
 	pkt->size = 0;
 }
 
+static void WritePackets(AVPacket *pkt, int error, int got_packet) {
+	while (error >= 0 && got_packet) {
+		// Write the compressed frame in the media file.
+		if (pkt->pts != (s64)AV_NOPTS_VALUE) {
+			pkt->pts = av_rescale_q(pkt->pts, s_codec_context->time_base, s_stream->time_base);
+		}
+		if (pkt->dts != (s64)AV_NOPTS_VALUE) {
+			pkt->dts = av_rescale_q(pkt->dts, s_codec_context->time_base, s_stream->time_base);
+		}
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(56, 60, 100)
+		if (s_codec_context->coded_frame->key_frame)
+			pkt->flags |= AV_PKT_FLAG_KEY;
 #endif
+		pkt->stream_index = s_stream->index;
+		av_interleaved_write_frame(s_format_context, pkt);
 
-void AVIDump::AddFrame() {
-	u32 w = 0;
-	u32 h = 0;
-	if (g_Config.bDumpVideoOutput) {
-		gpuDebug->GetOutputFramebuffer(buf);
-		w = buf.GetStride();
-		h = buf.GetHeight();
-	} else {
-		gpuDebug->GetCurrentFramebuffer(buf, GPU_DBG_FRAMEBUF_RENDER);
-		w = PSP_CoreParameter().renderWidth;
-		h = PSP_CoreParameter().renderHeight;
+		// Handle delayed frames.
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
+		av_packet_unref(pkt);
+		error = avcodec_receive_packet(s_codec_context, pkt);
+		got_packet = error >= 0 ? 1 : 0;
+#else
+		PreparePacket(pkt);
+		error = avcodec_encode_video2(s_codec_context, pkt, nullptr, &got_packet);
+#endif
 	}
-	CheckResolution(w, h);
-	u8 *flipbuffer = nullptr;
-	const u8 *buffer = ConvertBufferToScreenshot(buf, false, flipbuffer, w, h);
-
-#ifdef USE_FFMPEG
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
+	av_packet_unref(pkt);
+	if (error < 0 && error != AVERROR(EAGAIN) && error != AVERROR_EOF)
+		ERROR_LOG(Log::G3D, "Error while encoding video: %d", error);
+#else
+	if (error < 0)
+		ERROR_LOG(Log::G3D, "Error while encoding video: %d", error);
+#endif
+}
 
-	s_src_frame->data[0] = const_cast<u8*>(buffer);
-	s_src_frame->linesize[0] = w * 3;
+// Runs on the encode thread.
+static void EncodeFrame(const PendingFrame &frame) {
+	s_src_frame->data[0] = const_cast<u8 *>(frame.rgb.data());
+	s_src_frame->linesize[0] = frame.w * 3;
 	s_src_frame->format = AV_PIX_FMT_RGB24;
 	s_src_frame->width = s_width;
 	s_src_frame->height = s_height;
 
 	// Convert image from BGR24 to desired pixel format, and scale to initial width and height
-	if ((s_sws_context = sws_getCachedContext(s_sws_context, w, h, AV_PIX_FMT_RGB24, s_width, s_height, s_codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr))) {
-		sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, h, s_scaled_frame->data, s_scaled_frame->linesize);
+	if ((s_sws_context = sws_getCachedContext(s_sws_context, frame.w, frame.h, AV_PIX_FMT_RGB24, s_width, s_height, s_codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr))) {
+		sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, frame.h, s_scaled_frame->data, s_scaled_frame->linesize);
 	}
 
 	s_scaled_frame->format = s_codec_context->pix_fmt;
@@ -236,45 +353,112 @@ void AVIDump::AddFrame() {
 	int got_packet;
 	int error = avcodec_encode_video2(s_codec_context, &pkt, s_scaled_frame, &got_packet);
 #endif
-	while (error >= 0 && got_packet) {
-		// Write the compressed frame in the media file.
-		if (pkt.pts != (s64)AV_NOPTS_VALUE) {
-			pkt.pts = av_rescale_q(pkt.pts, s_codec_context->time_base, s_stream->time_base);
-		}
-		if (pkt.dts != (s64)AV_NOPTS_VALUE) {
-			pkt.dts = av_rescale_q(pkt.dts, s_codec_context->time_base, s_stream->time_base);
-		}
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(56, 60, 100)
-		if (s_codec_context->coded_frame->key_frame)
-			pkt.flags |= AV_PKT_FLAG_KEY;
-#endif
-		pkt.stream_index = s_stream->index;
-		av_interleaved_write_frame(s_format_context, &pkt);
+	WritePackets(&pkt, error, got_packet);
+}
 
-		// Handle delayed frames.
+// Hardware encoders in particular hold on to several frames, write those out too.
+static void FlushEncoder() {
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
-		av_packet_unref(&pkt);
-		error = avcodec_receive_packet(s_codec_context, &pkt);
-		got_packet = error >= 0 ? 1 : 0;
-#else
-		PreparePacket(&pkt);
-		error = avcodec_encode_video2(s_codec_context, &pkt, nullptr, &got_packet);
+	AVPacket pkt;
+	PreparePacket(&pkt);
+	if (avcodec_send_frame(s_codec_context, nullptr) < 0)
+		return;
+	int error = avcodec_receive_packet(s_codec_context, &pkt);
+	WritePackets(&pkt, error, error >= 0 ? 1 : 0);
 #endif
+}
+
+static void EncodeThread() {
+	SetCurrentThreadName("AVIDump");
+
+	std::unique_lock<std::mutex> guard(s_queueLock);
+	while (true) {
+		s_queueCond.wait(guard, [] { return s_encodeStop || !s_queue.empty(); });
+		// When stopping, finish what's queued first.
+		if (s_queue.empty())
+			break;
+		PendingFrame frame = std::move(s_queue.front());
+		s_queue.pop_front();
+		guard.unlock();
+		s_queueCond.notify_all();
+
+		EncodeFrame(frame);
+
+		guard.lock();
+		s_freeBuffers.push_back(std::move(frame.rgb));
 	}
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
-	av_packet_unref(&pkt);
-	if (error < 0 && error != AVERROR(EAGAIN) && error != AVERROR_EOF)
-		ERROR_LOG(Log::G3D, "Error while encoding video: %d", error);
-#else
-	if (error < 0)
-		ERROR_LOG(Log::G3D, "Error while encoding video: %d", error);
+}
+
+static void StartEncodeThread() {
+	s_encodeStop = false;
+	s_encodeThread = std::thread(&EncodeThread);
+}
+
+static void StopEncodeThread() {
+	if (!s_encodeThread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> guard(s_queueLock);
+		s_encodeStop = true;
+	}
+	s_queueCond.notify_all();
+	s_encodeThread.join();
+	s_encodeStop = false;
+}
+
+static void QueueFrame(const u8 *buffer, int w, int h) {
+	PendingFrame frame;
+	{
+		// Wait for the encoder if it's behind, rather than dropping frames.
+		std::unique_lock<std::mutex> guard(s_queueLock);
+		s_queueCond.wait(guard, [] { return s_queue.size() < MAX_QUEUED_FRAMES; });
+		if (!s_freeBuffers.empty()) {
+			frame.rgb = std::move(s_freeBuffers.back());
+			s_freeBuffers.pop_back();
+		}
+	}
+
+	frame.rgb.assign(buffer, buffer + w * h * 3);
+	frame.w = w;
+	frame.h = h;
+
+	{
+		std::lock_guard<std::mutex> guard(s_queueLock);
+		s_queue.push_back(std::move(frame));
+	}
+	s_queueCond.notify_all();
+}
+
 #endif
+
+void AVIDump::AddFrame() {
+	u32 w = 0;
+	u32 h = 0;
+	if (g_Config.bDumpVideoOutput) {
+		gpuDebug->GetOutputFramebuffer(buf);
+		w = buf.GetStride();
+		h = buf.GetHeight();
+	} else {
+		gpuDebug->GetCurrentFramebuffer(buf, GPU_DBG_FRAMEBUF_RENDER);
+		w = PSP_CoreParameter().renderWidth;
+		h = PSP_CoreParameter().renderHeight;
+	}
+	CheckResolution(w, h);
+	u8 *flipbuffer = nullptr;
+	const u8 *buffer = ConvertBufferToScreenshot(buf, false, flipbuffer, w, h);
+
+#ifdef USE_FFMPEG
+	if (buffer && s_encodeThread.joinable())
+		QueueFrame(buffer, w, h);
 #endif
 	delete[] flipbuffer;
 }
 
 void AVIDump::Stop() {
 #ifdef USE_FFMPEG
+	StopEncodeThread();
+	if (s_codec_context)
+		FlushEncoder();
 
 	av_write_trailer(s_format_context);
 	CloseFile();
@@ -168,7 +168,7 @@ std::string CreateRandMAC() {
 }
 
 static int DefaultCpuCore() {
-#if PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(RISCV64)
+#if PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(RISCV64) || PPSSPP_ARCH(LOONGARCH64)
 	if (System_GetPropertyBool(SYSPROP_CAN_JIT))
 		return (int)CPUCore::JIT;
 	return (int)CPUCore::IR_INTERPRETER;
@@ -178,7 +178,7 @@ static int DefaultCpuCore() {
 }
 
 static bool DefaultCodeGen() {
-#if PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(RISCV64)
+#if PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(RISCV64) || PPSSPP_ARCH(LOONGARCH64)
 	return true;
 #else
 	return false;
@@ -233,6 +233,7 @@ static const ConfigSetting generalSettings[] = {
 
 	ConfigSetting("ScreenshotsAsPNG", &g_Config.bScreenshotsAsPNG, false, CfgFlag::PER_GAME),
 	ConfigSetting("UseFFV1", &g_Config.bUseFFV1, false, CfgFlag::DEFAULT),
+	ConfigSetting("HardwareVideoEncoder", &g_Config.bHardwareVideoEncoder, false, CfgFlag::DEFAULT),
 	ConfigSetting("DumpFrames", &g_Config.bDumpFrames, false, CfgFlag::DEFAULT),
 	ConfigSetting("DumpVideoOutput", &g_Config.bDumpVideoOutput, false, CfgFlag::DEFAULT),
 	ConfigSetting("DumpAudio", &g_Config.bDumpAudio, false, CfgFlag::DEFAULT),
@@ -243,6 +244,7 @@ static const ConfigSetting generalSettings[] = {
 	ConfigSetting("StateUndoLastSaveGame", &g_Config.sStateUndoLastSaveGame, "NA", CfgFlag::DEFAULT),
 	ConfigSetting("StateUndoLastSaveSlot", &g_Config.iStateUndoLastSaveSlot, -5, CfgFlag::DEFAULT), // Start with an "invalid" value
 	ConfigSetting("RewindSnapshotInterval", &g_Config.iRewindSnapshotInterval, 0, CfgFlag::PER_GAME),
+	ConfigSetting("RunAheadFrames", &g_Config.iRunAheadFrames, 0, CfgFlag::PER_GAME),
 
 	ConfigSetting("ShowOnScreenMessage", &g_Config.bShowOnScreenMessages, true, CfgFlag::DEFAULT),
 	ConfigSetting("ShowRegionOnGameIcon", &g_Config.bShowRegionOnGameIcon, false, CfgFlag::DEFAULT),
@@ -358,12 +360,18 @@ static const ConfigSetting achievementSettings[] = {
 static const ConfigSetting cpuSettings[] = {
 	ConfigSetting("CPUCore", &g_Config.iCpuCore, &DefaultCpuCore, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("SeparateSASThread", &g_Config.bSeparateSASThread, &DefaultSasThread, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("HardwareVideoDecode", &g_Config.bHardwareVideoDecode, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("IOTimingMethod", &g_Config.iIOTimingMethod, IOTIMING_FAST, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("FastMemoryAccess", &g_Config.bFastMemory, true, CfgFlag::PER_GAME),
 	ConfigSetting("FunctionReplacements", &g_Config.bFuncReplacements, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("HideSlowWarnings", &g_Config.bHideSlowWarnings, false, CfgFlag::DEFAULT),
 	ConfigSetting("HideStateWarnings", &g_Config.bHideStateWarnings, false, CfgFlag::DEFAULT),
 	ConfigSetting("PreloadFunctions", &g_Config.bPreloadFunctions, false, CfgFlag::PER_GAME),
+	ConfigSetting("PersistentJitCache", &g_Config.bPersistentJitCache, false, CfgFlag::PER_GAME),
+	ConfigSetting("JitTierUpThreshold", &g_Config.iJitTierUpThreshold, 0, CfgFlag::PER_GAME),
+	ConfigSetting("BackgroundJitCompile", &g_Config.bBackgroundJitCompile, false, CfgFlag::PER_GAME),
+	ConfigSetting("IRContinueBranches", &g_Config.bIRContinueBranches, false, CfgFlag::PER_GAME),
+	ConfigSetting("IRFunctionRegions", &g_Config.bIRFunctionRegions, false, CfgFlag::PER_GAME),
 	ConfigSetting("JitDisableFlags", &g_Config.uJitDisableFlags, (uint32_t)0, CfgFlag::PER_GAME),
 	ConfigSetting("CPUSpeed", &g_Config.iLockedCPUSpeed, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
 };
@@ -589,6 +597,8 @@ static int FastForwardModeFromString(const std::string &s) {
 		return (int)FastForwardMode::CONTINUOUS;
 	if (!strcasecmp(s.c_str(), "SKIP_FLIP"))
 		return (int)FastForwardMode::SKIP_FLIP;
+	if (!strcasecmp(s.c_str(), "SKIP_DRAW"))
+		return (int)FastForwardMode::SKIP_DRAW;
 	return DefaultFastForwardMode();
 }
 
@@ -598,6 +608,8 @@ static std::string FastForwardModeToString(int v) {
 		return "CONTINUOUS";
 	case FastForwardMode::SKIP_FLIP:
 		return "SKIP_FLIP";
+	case FastForwardMode::SKIP_DRAW:
+		return "SKIP_DRAW";
 	}
 	return "CONTINUOUS";
 }
@@ -627,11 +639,14 @@ static const ConfigSetting graphicsSettings[] = {
 	ConfigSetting("DepthRasterMode", &g_Config.iDepthRasterMode, &DefaultDepthRaster, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("SoftwareRenderer", &g_Config.bSoftwareRendering, false, CfgFlag::PER_GAME),
 	ConfigSetting("SoftwareRendererJit", &g_Config.bSoftwareRenderingJit, true, CfgFlag::PER_GAME),
+	ConfigSetting("SoftwareRenderScale", &g_Config.iSoftwareRenderScale, 0, CfgFlag::PER_GAME),
+	ConfigSetting("SoftwareRendererPipelined", &g_Config.bSoftwareRenderingPipelined, false, CfgFlag::PER_GAME),
 	ConfigSetting("HardwareTransform", &g_Config.bHardwareTransform, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("SoftwareSkinning", &g_Config.bSoftwareSkinning, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TextureFiltering", &g_Config.iTexFiltering, 1, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("Smart2DTexFiltering", &g_Config.bSmart2DTexFiltering, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("InternalResolution", &g_Config.iInternalResolution, &DefaultInternalResolution, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("DynamicResolution", &g_Config.bDynamicResolution, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("AndroidHwScale", &g_Config.iAndroidHwScale, &DefaultAndroidHwScale, CfgFlag::DEFAULT),
 	ConfigSetting("HighQualityDepth", &g_Config.bHighQualityDepth, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("FrameSkip", &g_Config.iFrameSkip, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
@@ -652,6 +667,9 @@ static const ConfigSetting graphicsSettings[] = {
 	ConfigSetting("MultiSampleLevel", &g_Config.iMultiSampleLevel, 0, CfgFlag::PER_GAME),  // Number of samples is 1 << iMultiSampleLevel
 
 	ConfigSetting("TextureBackoffCache", &g_Config.bTextureBackoffCache, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("TextureWriteTracking", &g_Config.bTextureWriteTracking, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("BatchSpriteTextures", &g_Config.bBatchSpriteTextures, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("VertexCache", &g_Config.bVertexCache, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("VertexDecJit", &g_Config.bVertexDecoderJit, &DefaultCodeGen, CfgFlag::DONT_SAVE | CfgFlag::REPORT),
 
 #ifndef MOBILE_DEVICE
@@ -678,14 +696,19 @@ static const ConfigSetting graphicsSettings[] = {
 
 	ConfigSetting("ReplaceTextures", &g_Config.bReplaceTextures, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("SaveNewTextures", &g_Config.bSaveNewTextures, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("SaveTextureCompressionLevel", &g_Config.iSaveTextureCompressionLevel, 6, CfgFlag::DEFAULT),
 	ConfigSetting("IgnoreTextureFilenames", &g_Config.bIgnoreTextureFilenames, false, CfgFlag::PER_GAME),
+	ConfigSetting("ReplaceTexturesTranscode", &g_Config.bReplaceTexturesTranscode, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("ReplaceTexturesPrefetch", &g_Config.bReplaceTexturesPrefetch, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 
 	ConfigSetting("TexScalingLevel", &g_Config.iTexScalingLevel, 1, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TexScalingType", &g_Config.iTexScalingType, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TexDeposterize", &g_Config.bTexDeposterize, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TexHardwareScaling", &g_Config.bTexHardwareScaling, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("TexCacheBudgetMB", &g_Config.iTexCacheBudgetMB, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("VSync", &g_Config.bVSync, &DefaultVSync, CfgFlag::PER_GAME),
 	ConfigSetting("BloomHack", &g_Config.iBloomHack, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("BloomHackScale", &g_Config.iBloomHackScale, 1, CfgFlag::PER_GAME | CfgFlag::REPORT),
 
 	// Not really a graphics setting...
 	ConfigSetting("SplineBezierQuality", &g_Config.iSplineBezierQuality, 2, CfgFlag::PER_GAME | CfgFlag::REPORT),
@@ -694,11 +717,14 @@ static const ConfigSetting graphicsSettings[] = {
 	ConfigSetting("ShaderChainRequires60FPS", &g_Config.bShaderChainRequires60FPS, false, CfgFlag::PER_GAME),
 
 	ConfigSetting("SkipGPUReadbackMode", &g_Config.iSkipGPUReadbackMode, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("DelayedGPUReadbacks", &g_Config.bDelayedGPUReadbacks, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("GeThread", &g_Config.bGeThread, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 
 	ConfigSetting("GfxDebugOutput", &g_Config.bGfxDebugOutput, false, CfgFlag::DONT_SAVE),
 	ConfigSetting("LogFrameDrops", &g_Config.bLogFrameDrops, false, CfgFlag::DEFAULT),
 
 	ConfigSetting("InflightFrames", &g_Config.iInflightFrames, 3, CfgFlag::DEFAULT),
+	ConfigSetting("LowLatencyPacing", &g_Config.bLowLatencyPacing, false, CfgFlag::DEFAULT),
 	ConfigSetting("RenderDuplicateFrames", &g_Config.bRenderDuplicateFrames, false, CfgFlag::PER_GAME),
 
 	ConfigSetting("MultiThreading", &g_Config.bRenderMultiThreading, true, CfgFlag::DEFAULT),
@@ -716,6 +742,7 @@ static const ConfigSetting soundSettings[] = {
 	ConfigSetting("Enable", &g_Config.bEnableSound, true, CfgFlag::PER_GAME),
 	ConfigSetting("AudioBackend", &g_Config.iAudioBackend, 0, CfgFlag::PER_GAME),
 	ConfigSetting("ExtraAudioBuffering", &g_Config.bExtraAudioBuffering, false, CfgFlag::DEFAULT),
+	ConfigSetting("LowLatencyAudio", &g_Config.bLowLatencyAudio, false, CfgFlag::DEFAULT),
 	ConfigSetting("GlobalVolume", &g_Config.iGlobalVolume, VOLUME_FULL, CfgFlag::PER_GAME),
 	ConfigSetting("ReverbVolume", &g_Config.iReverbVolume, VOLUME_FULL, CfgFlag::PER_GAME),
 	ConfigSetting("AltSpeedVolume", &g_Config.iAltSpeedVolume, -1, CfgFlag::PER_GAME),
@@ -889,6 +916,7 @@ static const ConfigSetting networkSettings[] = {
 	ConfigSetting("PortOffset", &g_Config.iPortOffset, 10000, CfgFlag::PER_GAME),
 	ConfigSetting("MinTimeout", &g_Config.iMinTimeout, 0, CfgFlag::PER_GAME),
 	ConfigSetting("ForcedFirstConnect", &g_Config.bForcedFirstConnect, false, CfgFlag::PER_GAME),
+	ConfigSetting("AdhocRelay", &g_Config.bAdhocRelay, false, CfgFlag::PER_GAME),
 	ConfigSetting("EnableUPnP", &g_Config.bEnableUPnP, false, CfgFlag::PER_GAME),
 	ConfigSetting("UPnPUseOriginalPort", &g_Config.bUPnPUseOriginalPort, false, CfgFlag::PER_GAME),
 
@@ -1597,6 +1625,7 @@ static bool TryUpdateSavedPath(Path *path) {
 void Config::CleanRecent() {
 	private_->SetRecentIsosThread([this] {
 		SetCurrentThreadName("RecentISOs");
+		SetCurrentThreadCoreClass(ThreadCoreClass::EFFICIENCY);
 
 		AndroidJNIThreadContext jniContext;  // destructor detaches
 
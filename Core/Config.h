@@ -81,6 +81,7 @@ struct Config {
 	// General
 	bool bScreenshotsAsPNG;
 	bool bUseFFV1;
+	bool bHardwareVideoEncoder;
 	bool bDumpFrames;
 	bool bDumpVideoOutput;
 	bool bDumpAudio;
@@ -115,11 +116,17 @@ struct Config {
 	bool bHideSlowWarnings;
 	bool bHideStateWarnings;
 	bool bPreloadFunctions;
+	bool bPersistentJitCache;  // Saves IR blocks per game to skip the frontend on the next boot.
+	int iJitTierUpThreshold;  // IR JIT: interpret blocks this many times before compiling natively. 0 = off.
+	bool bBackgroundJitCompile;  // IR interpreter only: compile blocks on a worker thread, interpreting until ready.
+	bool bIRContinueBranches;  // IR: compile through forward jumps and likely branches into longer blocks.
+	bool bIRFunctionRegions;  // IR: like above, but bounded by the analyzed function instead of a short window.
 	uint32_t uJitDisableFlags;
 
 	bool bDisableHTTPS;
 
 	bool bSeparateSASThread;
+	bool bHardwareVideoDecode;  // Decode FMVs through the platform's video decoder, if ffmpeg supports it.
 	int iIOTimingMethod;
 	int iLockedCPUSpeed;
 	bool bAutoSaveSymbolMap;
@@ -166,6 +173,8 @@ struct Config {
 
 	bool bSoftwareRendering;
 	bool bSoftwareRenderingJit;
+	int iSoftwareRenderScale;  // 0 = 1x, 1 = 2x, 2 = 4x
+	bool bSoftwareRenderingPipelined;
 	bool bHardwareTransform; // only used in the GLES backend
 	bool bSoftwareSkinning;
 	bool bVendorBugChecksEnabled;
@@ -215,28 +224,38 @@ struct Config {
 	float fUISaturation;
 
 	bool bTextureBackoffCache;
+	bool bTextureWriteTracking;
+	bool bBatchSpriteTextures;
+	bool bVertexCache;  // Currently only used by the Vulkan backend.
 	bool bVertexDecoderJit;
 	int iAppSwitchMode;
 	bool bFullScreen;
 	bool bFullScreenMulti;
 	int iForceFullScreen = -1; // -1 = nope, 0 = force off, 1 = force on (not saved.)
 	int iInternalResolution;  // 0 = Auto (native), 1 = 1x (480x272), 2 = 2x, 3 = 3x, 4 = 4x and so on.
+	bool bDynamicResolution;  // Lower the render scale (down to 1x) while the GPU can't keep up.
 	int iAnisotropyLevel;  // 0 - 5, powers of 2: 0 = 1x = no aniso
 	int iMultiSampleLevel;
 	int bHighQualityDepth;
 	bool bReplaceTextures;
 	bool bSaveNewTextures;
+	int iSaveTextureCompressionLevel;  // zlib level (0-9) for saved textures. Lower saves faster.
 	bool bIgnoreTextureFilenames;
+	bool bReplaceTexturesTranscode;  // Block compress PNG replacements once and cache them next to the pack.
+	bool bReplaceTexturesPrefetch;  // Record the order replacements are first used in, and load ahead from that on later runs.
 	int iTexScalingLevel; // 0 = auto, 1 = off, 2 = 2x, ..., 5 = 5x
 	int iTexScalingType; // 0 = xBRZ, 1 = Hybrid
 	bool bTexDeposterize;
 	bool bTexHardwareScaling;
+	int iTexCacheBudgetMB; // 0 = no budget, textures are evicted by age only
 	int iFpsLimit1;
 	int iFpsLimit2;
 	int iAnalogFpsLimit;
 	int iMaxRecent;
 	int iCurrentStateSlot;
 	int iRewindSnapshotInterval;
+	// Frames to emulate ahead of the one shown, then roll back.  Hides that much input lag.
+	int iRunAheadFrames;
 	bool bUISound;
 	bool bEnableStateUndo;
 	std::string sStateLoadUndoGame;
@@ -250,7 +269,10 @@ struct Config {
 	float fCwCheatScrollPosition;
 	float fGameListScrollPosition;
 	int iBloomHack; //0 = off, 1 = safe, 2 = balanced, 3 = aggressive
+	int iBloomHackScale;  // Render scale for the buffers iBloomHack lowers, normally 1x.
 	int iSkipGPUReadbackMode;  // 0 = off, 1 = skip, 2 = to texture
+	bool bDelayedGPUReadbacks;  // Let copy readbacks write their data to memory a few frames later instead of waiting.
+	bool bGeThread;  // Experimental. Process display lists on a separate thread, in parallel with the CPU.
 	int iSplineBezierQuality; // 0 = low , 1 = Intermediate , 2 = High
 	bool bHardwareTessellation;
 	bool bShaderCache;  // Hidden ini-only setting, useful for debugging shader compile times.
@@ -269,6 +291,7 @@ struct Config {
 	std::string sTextureShaderName;
 	bool bGfxDebugOutput;
 	int iInflightFrames;
+	bool bLowLatencyPacing;  // Uses present timestamps (where available) to start frames closer to vblank.
 	bool bRenderDuplicateFrames;
 	bool bRenderMultiThreading;
 
@@ -283,6 +306,7 @@ struct Config {
 	int iAltSpeedVolume;
 	int iAchievementSoundVolume;
 	bool bExtraAudioBuffering;  // For bluetooth
+	bool bLowLatencyAudio;  // Adapts the buffer to the minimum that doesn't underrun
 	std::string sAudioDevice;
 	bool bAutoAudioDevice;
 	bool bUseExperimentalAtrac;
@@ -462,6 +486,7 @@ struct Config {
 	bool bEnableUPnP;
 	bool bUPnPUseOriginalPort;
 	bool bForcedFirstConnect;
+	bool bAdhocRelay;
 	int iPortOffset;
 	int iMinTimeout;
 	int iWlanAdhocChannel;
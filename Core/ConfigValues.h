@@ -122,6 +122,7 @@ enum class AutoLoadSaveState {
 
 enum class FastForwardMode {
 	CONTINUOUS = 0,
+	SKIP_DRAW = 1,  // Like SKIP_FLIP, but also skips drawing frames that won't be shown.
 	SKIP_FLIP = 2,
 };
 
@@ -173,6 +174,7 @@ enum class DebugOverlay : int {
 	DEBUG_STATS,
 	FRAME_GRAPH,
 	FRAME_TIMING,
+	FRAME_TIMELINE,
 #ifdef USE_PROFILER
 	FRAME_PROFILE,
 #endif
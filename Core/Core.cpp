@@ -30,6 +30,7 @@
 #include "Core/Core.h"
 #include "Core/Config.h"
 #include "Core/HLE/HLE.h"
+#include "Core/HW/Display.h"
 #include "Core/MIPS/MIPSDebugInterface.h"
 #include "Core/SaveState.h"
 #include "Core/System.h"
@@ -174,7 +175,11 @@ void Core_RunLoopUntil(u64 globalticks) {
 			}
 			break;
 		case CORE_RUNNING_CPU:
+			if (coreCollectDebugStats)
+				DisplayNotifyCPURunning(true);
 			mipsr4k.RunLoopUntil(globalticks);
+			if (coreCollectDebugStats)
+				DisplayNotifyCPURunning(false);
 			if (g_breakAfterFrame && coreState == CORE_NEXTFRAME) {
 				g_breakAfterFrame = false;
 				coreState = CORE_STEPPING_CPU;
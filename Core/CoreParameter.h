@@ -86,6 +86,10 @@ struct CoreParameter {
 	bool freezeNext = false;
 	bool frozen = false;
 
+	// Set while run-ahead emulates frames that won't be shown, or heard.
+	bool runAheadHideVideo = false;
+	bool runAheadMuteAudio = false;
+
 	FileLoader *mountIsoLoader = nullptr;
 	IdentifiedFileType fileType = IdentifiedFileType::UNKNOWN;
 
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <atomic>
 #include <climits>
 #include <cstdio>
@@ -48,8 +49,32 @@ static std::set<int> usedEventTypes;
 static std::set<int> restoredEventTypes;
 static int nextEventTypeRestoreId = -1;
 
-Event *first;
-Event *eventPool = 0;
+// Pending events live in slots, so handles and the per type lists can refer to them by index.
+// The heap only holds what it needs to compare, to keep it small.  Events at the same time
+// run in the order they were scheduled, which is what order is for.
+static const u32 INVALID_SLOT = 0xFFFFFFFF;
+
+struct EventSlot {
+	BaseEvent ev;
+	// INVALID_SLOT when the slot is free.
+	u32 heapIndex;
+	u32 generation;
+	// Other pending events of the same type.  nextOfType also links the free slots.
+	u32 prevOfType;
+	u32 nextOfType;
+};
+
+struct HeapEntry {
+	s64 time;
+	u64 order;
+	u32 slot;
+};
+
+static std::vector<EventSlot> eventSlots;
+static std::vector<HeapEntry> eventHeap;
+static std::vector<u32> firstOfType;
+static u32 freeSlots = INVALID_SLOT;
+static u64 nextEventOrder = 0;
 
 // Downcount has been moved to currentMIPS, to save a couple of clocks in every ARM JIT block
 // as we can already reach that structure through a register.
@@ -106,28 +131,140 @@ u64 GetGlobalTimeUs() {
 	return lastGlobalTimeUs + usSinceLast;
 }
 
-const Event *GetFirstEvent() {
-	return first;
-}
-
 const std::vector<EventType> &GetEventTypes() {
 	return event_types;
 }
 
-Event* GetNewEvent()
-{
-	if(!eventPool)
-		return new Event;
+static inline bool EventBefore(const HeapEntry &a, const HeapEntry &b) {
+	return a.time < b.time || (a.time == b.time && a.order < b.order);
+}
 
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
+static void SiftUp(u32 index) {
+	HeapEntry entry = eventHeap[index];
+	while (index > 0) {
+		u32 parent = (index - 1) / 2;
+		if (!EventBefore(entry, eventHeap[parent]))
+			break;
+		eventHeap[index] = eventHeap[parent];
+		eventSlots[eventHeap[index].slot].heapIndex = index;
+		index = parent;
+	}
+	eventHeap[index] = entry;
+	eventSlots[entry.slot].heapIndex = index;
 }
 
-void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
+static void SiftDown(u32 index) {
+	const u32 size = (u32)eventHeap.size();
+	HeapEntry entry = eventHeap[index];
+	while (true) {
+		u32 child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && EventBefore(eventHeap[child + 1], eventHeap[child]))
+			child++;
+		if (!EventBefore(eventHeap[child], entry))
+			break;
+		eventHeap[index] = eventHeap[child];
+		eventSlots[eventHeap[index].slot].heapIndex = index;
+		index = child;
+	}
+	eventHeap[index] = entry;
+	eventSlots[entry.slot].heapIndex = index;
+}
+
+static void LinkEventType(u32 slot) {
+	EventSlot &es = eventSlots[slot];
+	es.prevOfType = INVALID_SLOT;
+	es.nextOfType = INVALID_SLOT;
+	// Bad types still run (and assert) in order, they just can't be searched for.
+	if (es.ev.type < 0)
+		return;
+	if (es.ev.type >= (int)firstOfType.size())
+		firstOfType.resize(es.ev.type + 1, INVALID_SLOT);
+	es.nextOfType = firstOfType[es.ev.type];
+	if (es.nextOfType != INVALID_SLOT)
+		eventSlots[es.nextOfType].prevOfType = slot;
+	firstOfType[es.ev.type] = slot;
+}
+
+static void UnlinkEventType(u32 slot) {
+	EventSlot &es = eventSlots[slot];
+	if (es.ev.type < 0)
+		return;
+	if (es.prevOfType != INVALID_SLOT)
+		eventSlots[es.prevOfType].nextOfType = es.nextOfType;
+	else
+		firstOfType[es.ev.type] = es.nextOfType;
+	if (es.nextOfType != INVALID_SLOT)
+		eventSlots[es.nextOfType].prevOfType = es.prevOfType;
+}
+
+static EventHandle AddEvent(s64 time, int event_type, u64 userdata) {
+	u32 slot = freeSlots;
+	if (slot != INVALID_SLOT) {
+		freeSlots = eventSlots[slot].nextOfType;
+	} else {
+		slot = (u32)eventSlots.size();
+		eventSlots.push_back(EventSlot{});
+	}
+
+	EventSlot &es = eventSlots[slot];
+	es.ev.time = time;
+	es.ev.userdata = userdata;
+	es.ev.type = event_type;
+	// Zero is never valid, so a default handle never matches.
+	if (++es.generation == 0)
+		es.generation = 1;
+	LinkEventType(slot);
+
+	eventHeap.push_back(HeapEntry{ time, nextEventOrder++, slot });
+	SiftUp((u32)eventHeap.size() - 1);
+	return EventHandle{ slot, es.generation };
+}
+
+static void FreeEventSlot(u32 slot) {
+	EventSlot &es = eventSlots[slot];
+	es.heapIndex = INVALID_SLOT;
+	es.nextOfType = freeSlots;
+	freeSlots = slot;
+}
+
+static void RemoveEventSlot(u32 slot) {
+	u32 index = eventSlots[slot].heapIndex;
+	HeapEntry last = eventHeap.back();
+	eventHeap.pop_back();
+	if (index < (u32)eventHeap.size()) {
+		eventHeap[index] = last;
+		if (index > 0 && EventBefore(last, eventHeap[(index - 1) / 2]))
+			SiftUp(index);
+		else
+			SiftDown(index);
+	}
+
+	UnlinkEventType(slot);
+	FreeEventSlot(slot);
+}
+
+static bool IsValidHandle(EventHandle handle) {
+	if (handle.slot >= (u32)eventSlots.size() || handle.generation == 0)
+		return false;
+	const EventSlot &es = eventSlots[handle.slot];
+	return es.heapIndex != INVALID_SLOT && es.generation == handle.generation;
+}
+
+// Pending events in the order they'll run.
+static void GetSortedEntries(std::vector<HeapEntry> *entries) {
+	*entries = eventHeap;
+	std::sort(entries->begin(), entries->end(), EventBefore);
+}
+
+void GetScheduledEvents(std::vector<BaseEvent> *events) {
+	std::vector<HeapEntry> entries;
+	GetSortedEntries(&entries);
+	events->clear();
+	events->reserve(entries.size());
+	for (const HeapEntry &entry : entries)
+		events->push_back(eventSlots[entry.slot].ev);
 }
 
 int RegisterEvent(const char *name, TimedCallback callback) {
@@ -173,7 +310,7 @@ void RestoreRegisterEvent(int &event_type, const char *name, TimedCallback callb
 }
 
 void UnregisterAllEvents() {
-	_dbg_assert_msg_(first == nullptr, "Unregistering events with events pending - this isn't good.");
+	_dbg_assert_msg_(eventHeap.empty(), "Unregistering events with events pending - this isn't good.");
 	event_types.clear();
 	usedEventTypes.clear();
 	restoredEventTypes.clear();
@@ -196,11 +333,11 @@ void Shutdown()
 	ClearPendingEvents();
 	UnregisterAllEvents();
 
-	while (eventPool) {
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
+	eventSlots.clear();
+	eventSlots.shrink_to_fit();
+	eventHeap.shrink_to_fit();
+	firstOfType.clear();
+	freeSlots = INVALID_SLOT;
 }
  
 u64 GetTicks()
@@ -220,86 +357,50 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-void AddEventToQueue(Event* ne)
-{
-	Event* prev = NULL;
-	Event** pNext = &first;
-	for(;;)
-	{
-		Event*& next = *pNext;
-		if(!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	for (const HeapEntry &entry : eventHeap)
+		FreeEventSlot(entry.slot);
+	eventHeap.clear();
+	std::fill(firstOfType.begin(), firstOfType.end(), INVALID_SLOT);
 }
 
 // This must be run ONLY from within the cpu thread
 // cyclesIntoFuture may be VERY inaccurate if called from anything else
 // than Advance
-void ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata)
+EventHandle ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = GetTicks() + cyclesIntoFuture;
-	AddEventToQueue(ne);
+	return AddEvent(GetTicks() + cyclesIntoFuture, event_type, userdata);
 }
 
 // Returns cycles left in timer.
 s64 UnscheduleEvent(int event_type, u64 userdata)
 {
-	s64 result = 0;
-	if (!first)
-		return result;
-	while(first)
-	{
-		if (first->type == event_type && first->userdata == userdata)
-		{
-			result = first->time - GetTicks();
-
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
-		return result;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type && ptr->userdata == userdata)
-		{
-			result = ptr->time - GetTicks();
-
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
+	if (event_type < 0 || event_type >= (int)firstOfType.size())
+		return 0;
+
+	// Like before, if there are several, report the one that would've run last.
+	bool found = false;
+	HeapEntry latest{};
+	u32 slot = firstOfType[event_type];
+	while (slot != INVALID_SLOT) {
+		u32 next = eventSlots[slot].nextOfType;
+		if (eventSlots[slot].ev.userdata == userdata) {
+			const HeapEntry &entry = eventHeap[eventSlots[slot].heapIndex];
+			if (!found || EventBefore(latest, entry))
+				latest = entry;
+			found = true;
+			RemoveEventSlot(slot);
 		}
+		slot = next;
 	}
+	return found ? latest.time - GetTicks() : 0;
+}
 
+s64 UnscheduleEvent(EventHandle handle)
+{
+	if (!IsValidHandle(handle))
+		return 0;
+	s64 result = eventSlots[handle.slot].ev.time - GetTicks();
+	RemoveEventSlot(handle.slot);
 	return result;
 }
 
@@ -309,66 +410,36 @@ void RegisterMHzChangeCallback(MHzChangeCallback callback) {
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
+	if (event_type < 0 || event_type >= (int)firstOfType.size())
 		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return firstOfType[event_type] != INVALID_SLOT;
+}
+
+bool IsScheduled(EventHandle handle)
+{
+	return IsValidHandle(handle);
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-	while(first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
+	if (event_type < 0 || event_type >= (int)firstOfType.size())
 		return;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	while (firstOfType[event_type] != INVALID_SLOT)
+		RemoveEventSlot(firstOfType[event_type]);
 }
 
 void ProcessEvents() {
-	while (first) {
-		if (first->time <= (s64)GetTicks()) {
-			// INFO_LOG(Log::CPU, "%s (%lld, %lld) ", first->name ? first->name : "?", (u64)GetTicks(), (u64)first->time);
-			Event *evt = first;
-			first = first->next;
-			if (evt->type >= 0 && evt->type < event_types.size()) {
-				event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
+	while (!eventHeap.empty()) {
+		if (eventHeap[0].time <= (s64)GetTicks()) {
+			// The callback may schedule more, so take it off the queue first.
+			BaseEvent evt = eventSlots[eventHeap[0].slot].ev;
+			RemoveEventSlot(eventHeap[0].slot);
+			// INFO_LOG(Log::CPU, "%s (%lld, %lld) ", event_types[evt.type].name, (u64)GetTicks(), (u64)evt.time);
+			if (evt.type >= 0 && evt.type < event_types.size()) {
+				event_types[evt.type].callback(evt.userdata, (int)(GetTicks() - evt.time));
 			} else {
-				_dbg_assert_msg_(false, "Bad event type %d", evt->type);
+				_dbg_assert_msg_(false, "Bad event type %d", evt.type);
 			}
-			FreeEvent(evt);
 		} else {
 			// Caught up to the current time.
 			break;
@@ -398,7 +469,7 @@ void Advance() {
 
 	ProcessEvents();
 
-	if (!first) {
+	if (eventHeap.empty()) {
 		// This should never happen in PPSSPP.
 		if (slicelength < 10000) {
 			slicelength += 10000;
@@ -406,7 +477,7 @@ void Advance() {
 		}
 	} else {
 		// Note that events can eat cycles as well.
-		int target = (int)(first->time - globalTimer);
+		int target = (int)(eventHeap[0].time - globalTimer);
 		if (target > MAX_SLICE_LENGTH)
 			target = MAX_SLICE_LENGTH;
 
@@ -417,10 +488,10 @@ void Advance() {
 }
 
 void LogPendingEvents() {
-	Event *ptr = first;
-	while (ptr) {
-		//INFO_LOG(Log::CPU, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
+	std::vector<BaseEvent> events;
+	GetScheduledEvents(&events);
+	for (const BaseEvent &ev : events) {
+		DEBUG_LOG(Log::CPU, "PENDING: Now: %lld Pending: %lld Type: %d", (long long)globalTimer, (long long)ev.time, ev.type);
 	}
 }
 
@@ -429,9 +500,9 @@ void Idle(int maxIdle) {
 	if (maxIdle != 0 && cyclesDown > maxIdle)
 		cyclesDown = maxIdle;
 
-	if (first && cyclesDown > 0) {
+	if (!eventHeap.empty() && cyclesDown > 0) {
 		int cyclesExecuted = slicelength - currentMIPS->downcount;
-		int cyclesNextEvent = (int) (first->time - globalTimer);
+		int cyclesNextEvent = (int) (eventHeap[0].time - globalTimer);
 
 		if (cyclesNextEvent < cyclesExecuted + cyclesDown)
 			cyclesDown = cyclesNextEvent - cyclesExecuted;
@@ -450,23 +521,22 @@ void Idle(int maxIdle) {
 }
 
 std::string GetScheduledEventsSummary() {
-	Event *ptr = first;
+	std::vector<BaseEvent> events;
+	GetScheduledEvents(&events);
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr) {
-		unsigned int t = ptr->type;
+	for (const BaseEvent &ev : events) {
+		unsigned int t = ev.type;
 		if (t >= event_types.size()) {
 			_dbg_assert_msg_(false, "Invalid event type %d", t);
-			ptr = ptr->next;
 			continue;
 		}
 		const char *name = event_types[t].name;
 		if (!name)
 			name = "[unknown]";
 		char temp[512];
-		snprintf(temp, sizeof(temp), "%s : %i %08x%08x\n", name, (int)ptr->time, (u32)(ptr->userdata >> 32), (u32)(ptr->userdata));
+		snprintf(temp, sizeof(temp), "%s : %i %08x%08x\n", name, (int)ev.time, (u32)(ev.userdata >> 32), (u32)(ev.userdata));
 		text += temp;
-		ptr = ptr->next;
 	}
 	return text;
 }
@@ -484,6 +554,41 @@ void Event_DoStateOld(PointerWrap &p, BaseEvent *ev) {
 	usedEventTypes.insert(ev->type);
 }
 
+// Same layout as DoLinkedList() used to write: a 1 before each event, soonest first, then a 0.
+template <void (*TDo)(PointerWrap &, BaseEvent *)>
+static void DoEventQueue(PointerWrap &p) {
+	if (p.mode == PointerWrap::MODE_READ) {
+		ClearPendingEvents();
+		while (!p.Failed()) {
+			u8 shouldExist = 0;
+			Do(p, shouldExist);
+			if (shouldExist != 1) {
+				if (shouldExist != 0) {
+					WARN_LOG(Log::SaveState, "Savestate failure: incorrect item marker %d", shouldExist);
+					p.SetError(p.ERROR_FAILURE);
+				}
+				break;
+			}
+			BaseEvent ev{};
+			TDo(p, &ev);
+			// Reading them in order keeps the order of events at the same time.
+			AddEvent(ev.time, ev.type, ev.userdata);
+		}
+		return;
+	}
+
+	std::vector<HeapEntry> entries;
+	GetSortedEntries(&entries);
+	for (const HeapEntry &entry : entries) {
+		u8 shouldExist = 1;
+		Do(p, shouldExist);
+		BaseEvent ev = eventSlots[entry.slot].ev;
+		TDo(p, &ev);
+	}
+	u8 shouldExist = 0;
+	Do(p, shouldExist);
+}
+
 void DoState(PointerWrap &p) {
 	auto s = p.Section("CoreTiming", 1, 3);
 	if (!s)
@@ -508,11 +613,11 @@ void DoState(PointerWrap &p) {
 	restoredEventTypes.clear();
 
 	if (s >= 3) {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoState>(p, first, (Event **)nullptr);
+		DoEventQueue<Event_DoState>(p);
 		// This is here because we previously stored a second queue of "threadsafe" events. Gone now. Remove in the next section version upgrade.
 		DoIgnoreUnusedLinkedList(p);
 	} else {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoStateOld>(p, first, (Event **)nullptr);
+		DoEventQueue<Event_DoStateOld>(p);
 		DoIgnoreUnusedLinkedList(p);
 	}
 
@@ -20,7 +20,6 @@
 #include <string>
 #include <vector>
 #include "Common/CommonTypes.h"
-#include "Common/Data/Collections/LinkedList.h"
 
 // This is a system to schedule events into the emulated machine's future. Time is measured
 // in main CPU clock cycles.
@@ -86,7 +85,13 @@ namespace CoreTiming {
 		u64 userdata;
 		int type;
 	};
-	typedef LinkedListItem<BaseEvent> Event;
+
+	// Refers to one scheduled event, so it can be cancelled without searching for it.
+	// Stays safe to use after the event has run, but isn't kept in save states.
+	struct EventHandle {
+		u32 slot = 0;
+		u32 generation = 0;
+	};
 
 	void Init();
 	void Shutdown();
@@ -105,13 +110,17 @@ namespace CoreTiming {
 
 	// userdata MAY NOT CONTAIN POINTERS. userdata might get written and reloaded from disk,
 	// when we implement state saves.
-	void ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata=0);
+	EventHandle ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata=0);
 	s64 UnscheduleEvent(int event_type, u64 userdata);
+	// Returns cycles left, or 0 if it already ran or was unscheduled.
+	s64 UnscheduleEvent(EventHandle handle);
 
 	const std::vector<EventType> &GetEventTypes();
-	const Event *GetFirstEvent();
+	// Copies out the pending events, soonest first.
+	void GetScheduledEvents(std::vector<BaseEvent> *events);
 	void RemoveEvent(int event_type);
 	bool IsScheduled(int event_type);
+	bool IsScheduled(EventHandle handle);
 	void Advance();
 	void ForceCheck();
 
@@ -397,6 +397,7 @@ void CWCheatEngine::ParseCheats() {
 	// TODO: Report errors.
 
 	cheats_ = parser.GetCheats();
+	CompileCheats();
 }
 
 u32 CWCheatEngine::GetAddress(u32 value) {
@@ -503,6 +504,31 @@ struct CheatOperation {
 	};
 };
 
+struct CompiledCheatOp {
+	CheatOperation op;
+	// Line after the operation, where execution continues unless the op skips.
+	size_t next;
+};
+
+CWCheatEngine::~CWCheatEngine() {}
+
+void CWCheatEngine::CompileCheats() {
+	// Conditionals can skip into the middle of a multi-line op, so decode starting from every line.
+	// Decoding doesn't depend on memory, only the execution does.
+	compiled_.clear();
+	compiled_.resize(cheats_.size());
+	for (size_t c = 0; c < cheats_.size(); c++) {
+		const CheatCode &cheat = cheats_[c];
+		std::vector<CompiledCheatOp> &ops = compiled_[c];
+		ops.resize(cheat.lines.size());
+		for (size_t line = 0; line < cheat.lines.size(); line++) {
+			size_t i = line;
+			ops[line].op = InterpretNextOp(cheat, i);
+			ops[line].next = i;
+		}
+	}
+}
+
 CheatOperation CWCheatEngine::InterpretNextCwCheat(const CheatCode &cheat, size_t &i) {
 	const CheatLine &line1 = cheat.lines[i++];
 	const uint32_t &arg = line1.part2;
@@ -806,30 +832,46 @@ CheatOperation CWCheatEngine::InterpretNextOp(const CheatCode &cheat, size_t &i)
 	}
 }
 
+// Skips the write, and more importantly the jit invalidation, if the value is already there.
+// Most cheats keep setting the same constant values every refresh.
+static bool WriteIfChanged(u32 addr, int sz, u32 value) {
+	if (sz == 1) {
+		if (Memory::ReadUnchecked_U8(addr) == (u8)value)
+			return false;
+		Memory::Write_U8((u8)value, addr);
+	} else if (sz == 2) {
+		if (Memory::ReadUnchecked_U16(addr) == (u16)value)
+			return false;
+		Memory::Write_U16((u16)value, addr);
+	} else if (sz == 4) {
+		if (Memory::ReadUnchecked_U32(addr) == value)
+			return false;
+		Memory::Write_U32(value, addr);
+	}
+	return true;
+}
+
+static u32 ReadSized(u32 addr, int sz) {
+	if (sz == 1)
+		return Memory::ReadUnchecked_U8(addr);
+	else if (sz == 2)
+		return Memory::ReadUnchecked_U16(addr);
+	else if (sz == 4)
+		return Memory::ReadUnchecked_U32(addr);
+	return 0;
+}
+
 void CWCheatEngine::ApplyMemoryOperator(const CheatOperation &op, uint32_t(*oper)(uint32_t, uint32_t)) {
 	if (Memory::IsValidRange(op.addr, op.sz)) {
-		InvalidateICache(op.addr, op.sz);
-		if (op.sz == 1)
-			Memory::Write_U8((u8)oper(Memory::Read_U8(op.addr), op.val), op.addr);
-		else if (op.sz == 2)
-			Memory::Write_U16((u16)oper(Memory::Read_U16(op.addr), op.val),op. addr);
-		else if (op.sz == 4)
-			Memory::Write_U32((u32)oper(Memory::Read_U32(op.addr), op.val), op.addr);
+		if (WriteIfChanged(op.addr, op.sz, oper(ReadSized(op.addr, op.sz), op.val)))
+			InvalidateICache(op.addr, op.sz);
 	}
 }
 
+// Reads don't modify code, so tests don't need to invalidate the jit.
 bool CWCheatEngine::TestIf(const CheatOperation &op, bool(*oper)(int, int)) {
 	if (Memory::IsValidRange(op.addr, op.sz)) {
-		InvalidateICache(op.addr, op.sz);
-
-		int memoryValue = 0;
-		if (op.sz == 1)
-			memoryValue = (int)Memory::Read_U8(op.addr);
-		else if (op.sz == 2)
-			memoryValue = (int)Memory::Read_U16(op.addr);
-		else if (op.sz == 4)
-			memoryValue = (int)Memory::Read_U32(op.addr);
-
+		int memoryValue = (int)ReadSized(op.addr, op.sz);
 		return oper(memoryValue, (int)op.val);
 	}
 	return false;
@@ -837,22 +879,8 @@ bool CWCheatEngine::TestIf(const CheatOperation &op, bool(*oper)(int, int)) {
 
 bool CWCheatEngine::TestIfAddr(const CheatOperation &op, bool(*oper)(int, int)) {
 	if (Memory::IsValidRange(op.addr, op.sz) && Memory::IsValidRange(op.ifAddrTypes.compareAddr, op.sz)) {
-		InvalidateICache(op.addr, op.sz);
-		InvalidateICache(op.addr, op.ifAddrTypes.compareAddr);
-
-		int memoryValue1 = 0;
-		int memoryValue2 = 0;
-		if (op.sz == 1) {
-			memoryValue1 = (int)Memory::Read_U8(op.addr);
-			memoryValue2 = (int)Memory::Read_U8(op.ifAddrTypes.compareAddr);
-		} else if (op.sz == 2) {
-			memoryValue1 = (int)Memory::Read_U16(op.addr);
-			memoryValue2 = (int)Memory::Read_U16(op.ifAddrTypes.compareAddr);
-		} else if (op.sz == 4) {
-			memoryValue1 = (int)Memory::Read_U32(op.addr);
-			memoryValue2 = (int)Memory::Read_U32(op.ifAddrTypes.compareAddr);
-		}
-
+		int memoryValue1 = (int)ReadSized(op.addr, op.sz);
+		int memoryValue2 = (int)ReadSized(op.ifAddrTypes.compareAddr, op.sz);
 		return oper(memoryValue1, memoryValue2);
 	}
 	return false;
@@ -869,13 +897,8 @@ void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat,
 
 	case CheatOp::Write:
 		if (Memory::IsValidRange(op.addr, op.sz)) {
-			InvalidateICache(op.addr, op.sz);
-			if (op.sz == 1)
-				Memory::Write_U8((u8)op.val, op.addr);
-			else if (op.sz == 2)
-				Memory::Write_U16((u16)op.val, op.addr);
-			else if (op.sz == 4)
-				Memory::Write_U32((u32)op.val, op.addr);
+			if (WriteIfChanged(op.addr, op.sz, op.val))
+				InvalidateICache(op.addr, op.sz);
 		}
 		break;
 
@@ -1200,11 +1223,14 @@ void CWCheatEngine::Run() {
 		return;
 	}
 
-	for (CheatCode cheat : cheats_) {
-		// InterpretNextOp and ExecuteOp move i.
+	for (size_t c = 0; c < cheats_.size(); c++) {
+		const CheatCode &cheat = cheats_[c];
+		const std::vector<CompiledCheatOp> &ops = compiled_[c];
+		// ExecuteOp may move i further, for skips.
 		for (size_t i = 0; i < cheat.lines.size(); ) {
-			CheatOperation op = InterpretNextOp(cheat, i);
-			ExecuteOp(op, cheat, i);
+			const CompiledCheatOp &compiled = ops[i];
+			i = compiled.next;
+			ExecuteOp(compiled.op, cheat, i);
 		}
 	}
 }
@@ -42,10 +42,12 @@ struct CheatFileInfo {
 };
 
 struct CheatOperation;
+struct CompiledCheatOp;
 
 class CWCheatEngine {
 public:
 	CWCheatEngine(const std::string &gameID);
+	~CWCheatEngine();
 	std::vector<CheatFileInfo> FileInfo();
 	void ParseCheats();
 	void CreateCheatFile();
@@ -55,6 +57,7 @@ class CWCheatEngine {
 	void InvalidateICache(u32 addr, int size);
 private:
 	u32 GetAddress(u32 value);
+	void CompileCheats();
 
 	CheatOperation InterpretNextOp(const CheatCode &cheat, size_t &i);
 	CheatOperation InterpretNextCwCheat(const CheatCode &cheat, size_t &i);
@@ -66,6 +69,8 @@ class CWCheatEngine {
 	bool TestIfAddr(const CheatOperation &op, bool(*oper)(int a, int b));
 
 	std::vector<CheatCode> cheats_;
+	// Per cheat, the operation decoded from each line, so Run() doesn't have to re-interpret.
+	std::vector<std::vector<CompiledCheatOp>> compiled_;
 	std::string gameID_;
 	Path filename_;
 };
@@ -402,6 +402,48 @@ void DisassemblyManager::clear()
 		delete it->second;
 	}
 	entries.clear();
+
+	std::lock_guard<std::mutex> cacheGuard(opcodeCacheLock_);
+	opcodeCache_.clear();
+}
+
+void DisassemblyManager::getCachedOpcode(u32 address, bool insertSymbols, std::string &name, std::string &params) {
+	char opcode[64], arguments[256];
+	char dizz[512];
+	if (!Memory::IsValidAddress(address)) {
+		DisAsm(address, dizz, sizeof(dizz));
+		parseDisasm(dizz, opcode, sizeof(opcode), arguments, sizeof(arguments), insertSymbols);
+		name = opcode;
+		params = arguments;
+		return;
+	}
+
+	// Look through jit blocks, so compiling or invalidating them doesn't throw away lines.
+	// Replacements are kept, since hooking one changes the output.
+	u32 encoding = Memory::Read_Instruction(address, false).encoding;
+	u32 key = (address & ~(OPCODE_CACHE_PAGE_SIZE - 1)) | (insertSymbols ? 1 : 0);
+
+	std::lock_guard<std::mutex> guard(opcodeCacheLock_);
+	auto it = opcodeCache_.find(key);
+	if (it == opcodeCache_.end()) {
+		// Scrolling through a huge range shouldn't grow this forever, just start over.
+		if (opcodeCache_.size() >= OPCODE_CACHE_MAX_PAGES)
+			opcodeCache_.clear();
+		it = opcodeCache_.emplace(key, std::make_unique<CachedOpcodePage>()).first;
+	}
+
+	CachedOpcode &line = it->second->lines[(address & (OPCODE_CACHE_PAGE_SIZE - 1)) / 4];
+	if (!line.valid || line.encoding != encoding) {
+		DisAsm(address, dizz, sizeof(dizz));
+		parseDisasm(dizz, opcode, sizeof(opcode), arguments, sizeof(arguments), insertSymbols);
+		line.encoding = encoding;
+		line.valid = true;
+		line.name = opcode;
+		line.params = arguments;
+	}
+
+	name = line.name;
+	params = line.params;
 }
 
 DisassemblyFunction::DisassemblyFunction(u32 _address, u32 _size): address(_address), size(_size)
@@ -750,13 +792,8 @@ void DisassemblyFunction::clear()
 }
 
 bool DisassemblyOpcode::disassemble(u32 address, DisassemblyLineInfo &dest, bool insertSymbols, DebugInterface *cpuDebug) {
-	char opcode[64],arguments[256];
-	char dizz[512];
-	DisAsm(address, dizz, sizeof(dizz));
-	parseDisasm(dizz, opcode, sizeof(opcode), arguments, sizeof(arguments), insertSymbols);
+	g_disassemblyManager.getCachedOpcode(address, insertSymbols, dest.name, dest.params);
 	dest.type = DISTYPE_OPCODE;
-	dest.name = opcode;
-	dest.params = arguments;
 	dest.totalSize = 4;
 	dest.info = MIPSAnalyst::GetOpcodeInfo(cpuDebug, address);
 	return true;
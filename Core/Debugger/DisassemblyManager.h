@@ -19,6 +19,8 @@
 
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <memory>
 
 #include "ppsspp_config.h"
 #include <mutex>
@@ -215,9 +217,30 @@ class DisassemblyManager {
 	DebugInterface *getCpu() { return cpu_; };
 	int getMaxParamChars() { return maxParamChars; };
 
+	// Decoded text of a single opcode, cached per page and revalidated against memory on lookup.
+	void getCachedOpcode(u32 address, bool insertSymbols, std::string &name, std::string &params);
+
 private:
+	enum {
+		OPCODE_CACHE_PAGE_SIZE = 1024,
+		OPCODE_CACHE_MAX_PAGES = 512,
+	};
+
+	struct CachedOpcode {
+		u32 encoding = 0;
+		bool valid = false;
+		std::string name;
+		std::string params;
+	};
+	struct CachedOpcodePage {
+		CachedOpcode lines[OPCODE_CACHE_PAGE_SIZE / 4];
+	};
+
 	std::map<u32,DisassemblyEntry*> entries;
 	std::recursive_mutex entriesLock_;
+	// Keyed by page address, with the low bit set for the insertSymbols variant.
+	std::unordered_map<u32, std::unique_ptr<CachedOpcodePage>> opcodeCache_;
+	std::mutex opcodeCacheLock_;
 	DebugInterface *cpu_;
 	int maxParamChars = 29;
 };
@@ -20,7 +20,10 @@
 #include <cstring>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <string>
 #include <thread>
+#include <unordered_map>
 
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
@@ -33,6 +36,29 @@
 #include "Core/MIPS/MIPS.h"
 #include "Common/StringUtils.h"
 
+// Most slabs share a handful of tags, so they just keep a counted reference to one of these.
+class MemTagTable {
+public:
+	// Zero is the empty tag.  All but that must be released once.
+	uint32_t Intern(const char *tag);
+	void AddRef(uint32_t id);
+	void Release(uint32_t id);
+	// Stays valid until the tag is released.
+	const char *Get(uint32_t id) const {
+		return entries_[id].tag.c_str();
+	}
+
+private:
+	struct Entry {
+		std::string tag;
+		uint32_t refs = 0;
+	};
+
+	std::deque<Entry> entries_{ Entry() };
+	std::unordered_map<std::string, uint32_t> lookup_;
+	std::vector<uint32_t> free_;
+};
+
 class MemSlabMap {
 public:
 	MemSlabMap();
@@ -54,7 +80,8 @@ class MemSlabMap {
 		bool allocated = false;
 		// Intentionally not save stated.
 		bool bulkStorage = false;
-		char tag[128]{};
+		// In tagTable.
+		uint32_t tag = 0;
 		Slab *prev = nullptr;
 		Slab *next = nullptr;
 
@@ -73,6 +100,7 @@ class MemSlabMap {
 	static inline bool Same(const Slab *a, const Slab *b);
 	void Merge(Slab *a, Slab *b);
 	void FillHeads(Slab *slab);
+	void Free(Slab *slab);
 
 	Slab *first_ = nullptr;
 	Slab *lastFind_ = nullptr;
@@ -93,6 +121,8 @@ struct PendingNotifyMem {
 // 160 KB.
 static constexpr size_t MAX_PENDING_NOTIFIES = 1024;
 static constexpr size_t MAX_PENDING_NOTIFIES_THREAD = 1000;
+// Must outlive the maps.
+static MemTagTable tagTable;
 static MemSlabMap allocMap;
 static MemSlabMap suballocMap;
 static MemSlabMap writeMap;
@@ -113,6 +143,48 @@ static std::atomic<bool> flushThreadPending;
 static std::mutex flushLock;
 static std::condition_variable flushCond;
 
+uint32_t MemTagTable::Intern(const char *tag) {
+	if (tag[0] == '\0')
+		return 0;
+
+	// Same as the old fixed size tags.
+	std::string key(tag, strnlen(tag, 127));
+	auto it = lookup_.find(key);
+	if (it != lookup_.end()) {
+		entries_[it->second].refs++;
+		return it->second;
+	}
+
+	uint32_t id;
+	if (!free_.empty()) {
+		id = free_.back();
+		free_.pop_back();
+	} else {
+		id = (uint32_t)entries_.size();
+		entries_.emplace_back();
+	}
+	entries_[id].tag = key;
+	entries_[id].refs = 1;
+	lookup_[std::move(key)] = id;
+	return id;
+}
+
+void MemTagTable::AddRef(uint32_t id) {
+	if (id != 0)
+		entries_[id].refs++;
+}
+
+void MemTagTable::Release(uint32_t id) {
+	if (id == 0)
+		return;
+	_dbg_assert_(entries_[id].refs != 0);
+	if (--entries_[id].refs == 0) {
+		// Keep the string until reused, in case of a concurrent debugger read.
+		lookup_.erase(entries_[id].tag);
+		free_.push_back(id);
+	}
+}
+
 MemSlabMap::MemSlabMap() {
 	Reset();
 }
@@ -138,8 +210,10 @@ bool MemSlabMap::Mark(uint32_t addr, uint32_t size, uint64_t ticks, uint32_t pc,
 			slab->ticks = ticks;
 			slab->pc = pc;
 		}
-		if (tag)
-			truncate_cpy(slab->tag, tag);
+		if (tag) {
+			tagTable.Release(slab->tag);
+			slab->tag = tagTable.Intern(tag);
+		}
 
 		// Move on to the next one.
 		if (firstMatch == nullptr)
@@ -160,8 +234,8 @@ bool MemSlabMap::Find(MemBlockFlags flags, uint32_t addr, uint32_t size, std::ve
 	Slab *slab = FindSlab(addr);
 	bool found = false;
 	while (slab != nullptr && slab->start < end) {
-		if (slab->pc != 0 || slab->tag[0] != '\0') {
-			results.push_back({ flags, slab->start, slab->end - slab->start, slab->ticks, slab->pc, slab->tag, slab->allocated });
+		if (slab->pc != 0 || slab->tag != 0) {
+			results.push_back({ flags, slab->start, slab->end - slab->start, slab->ticks, slab->pc, tagTable.Get(slab->tag), slab->allocated });
 			found = true;
 		}
 		slab = slab->next;
@@ -173,8 +247,8 @@ const char *MemSlabMap::FastFindWriteTag(MemBlockFlags flags, uint32_t addr, uin
 	uint32_t end = addr + size;
 	Slab *slab = FindSlab(addr);
 	while (slab != nullptr && slab->start < end) {
-		if (slab->pc != 0 || slab->tag[0] != '\0') {
-			return slab->tag;
+		if (slab->pc != 0 || slab->tag != 0) {
+			return tagTable.Get(slab->tag);
 		}
 		slab = slab->next;
 	}
@@ -228,8 +302,7 @@ void MemSlabMap::DoState(PointerWrap &p) {
 		// Now that it's entirely disconnected, delete the old slabs.
 		while (old != nullptr) {
 			Slab *next = old->next;
-			if (!old->bulkStorage)
-				delete old;
+			Free(old);
 			old = next;
 		}
 		delete [] oldBulk;
@@ -259,16 +332,24 @@ void MemSlabMap::Slab::DoState(PointerWrap &p) {
 	Do(p, ticks);
 	Do(p, pc);
 	Do(p, allocated);
+	// Still stored the way it used to be, as a fixed size string.
+	char tagData[128]{};
+	if (p.mode != p.MODE_READ)
+		truncate_cpy(tagData, tagTable.Get(tag));
 	if (s >= 3) {
-		Do(p, tag);
+		Do(p, tagData);
 	} else if (s >= 2) {
 		char shortTag[32];
 		Do(p, shortTag);
-		memcpy(tag, shortTag, sizeof(shortTag));
+		memcpy(tagData, shortTag, sizeof(shortTag));
 	} else {
 		std::string stringTag;
 		Do(p, stringTag);
-		truncate_cpy(tag, stringTag.c_str());
+		truncate_cpy(tagData, stringTag.c_str());
+	}
+	if (p.mode == p.MODE_READ) {
+		tagData[sizeof(tagData) - 1] = '\0';
+		tag = tagTable.Intern(tagData);
 	}
 }
 
@@ -276,8 +357,7 @@ void MemSlabMap::Clear() {
 	Slab *s = first_;
 	while (s != nullptr) {
 		Slab *next = s->next;
-		if (!s->bulkStorage)
-			delete s;
+		Free(s);
 		s = next;
 	}
 	delete [] bulkStorage_;
@@ -311,7 +391,8 @@ MemSlabMap::Slab *MemSlabMap::Split(Slab *slab, uint32_t size) {
 	next->ticks = slab->ticks;
 	next->pc = slab->pc;
 	next->allocated = slab->allocated;
-	truncate_cpy(next->tag, slab->tag);
+	next->tag = slab->tag;
+	tagTable.AddRef(next->tag);
 	next->prev = slab;
 	next->next = slab->next;
 
@@ -331,7 +412,8 @@ bool MemSlabMap::Same(const Slab *a, const Slab *b) {
 		return false;
 	if (a->pc != b->pc)
 		return false;
-	if (strcmp(a->tag, b->tag))
+	// Tags are interned, so the same string is always the same id.
+	if (a->tag != b->tag)
 		return false;
 	return true;
 }
@@ -374,8 +456,7 @@ void MemSlabMap::Merge(Slab *a, Slab *b) {
 	}
 	if (lastFind_ == b)
 		lastFind_ = a;
-	if (!b->bulkStorage)
-		delete b;
+	Free(b);
 }
 
 void MemSlabMap::FillHeads(Slab *slab) {
@@ -396,6 +477,13 @@ void MemSlabMap::FillHeads(Slab *slab) {
 	}
 }
 
+void MemSlabMap::Free(Slab *slab) {
+	tagTable.Release(slab->tag);
+	slab->tag = 0;
+	if (!slab->bulkStorage)
+		delete slab;
+}
+
 size_t FormatMemWriteTagAtNoFlush(char *buf, size_t sz, const char *prefix, uint32_t start, uint32_t size);
 
 void FlushPendingMemInfo() {
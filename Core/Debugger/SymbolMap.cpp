@@ -61,6 +61,65 @@ struct LabelDefinition {
 
 SymbolMap *g_symbolMap;
 
+// Helpers for the sorted active symbol vectors. T has an address member.
+template <typename T>
+static typename std::vector<T>::const_iterator ActiveLowerBound(const std::vector<T> &v, u32 address) {
+	return std::lower_bound(v.begin(), v.end(), address, [](const T &e, u32 addr) { return e.address < addr; });
+}
+
+template <typename T>
+static typename std::vector<T>::const_iterator ActiveUpperBound(const std::vector<T> &v, u32 address) {
+	return std::upper_bound(v.begin(), v.end(), address, [](u32 addr, const T &e) { return addr < e.address; });
+}
+
+template <typename T>
+static const T *ActiveFind(const std::vector<T> &v, u32 address) {
+	auto it = ActiveLowerBound(v, address);
+	if (it == v.end() || it->address != address)
+		return nullptr;
+	return &*it;
+}
+
+template <typename T>
+static T *ActiveFind(std::vector<T> &v, u32 address) {
+	return const_cast<T *>(ActiveFind((const std::vector<T> &)v, address));
+}
+
+// Like map::emplace, leaves an existing entry at the address alone.
+template <typename T>
+static void ActiveInsert(std::vector<T> &v, const T &e) {
+	auto it = ActiveLowerBound(v, e.address);
+	if (it != v.end() && it->address == e.address)
+		return;
+	v.insert(it, e);
+}
+
+template <typename T>
+static void ActiveErase(std::vector<T> &v, u32 address) {
+	auto it = ActiveLowerBound(v, address);
+	if (it != v.end() && it->address == address)
+		v.erase(it);
+}
+
+// Sorts entries added in bulk. Like repeated map::emplace, the first one added wins on duplicates.
+template <typename T>
+static void ActiveSort(std::vector<T> &v) {
+	std::stable_sort(v.begin(), v.end(), [](const T &a, const T &b) { return a.address < b.address; });
+	v.erase(std::unique(v.begin(), v.end(), [](const T &a, const T &b) { return a.address == b.address; }), v.end());
+}
+
+// Returns the entry that contains address, if any. Like before, only the closest preceding start is considered.
+template <typename T>
+static const T *ActiveFindContaining(const std::vector<T> &v, u32 address) {
+	auto it = ActiveUpperBound(v, address);
+	if (it == v.begin())
+		return nullptr;
+	--it;
+	if (it->address <= address && it->address + it->entry.size > address)
+		return &*it;
+	return nullptr;
+}
+
 void SymbolMap::SortSymbols() {
 	std::lock_guard<std::recursive_mutex> guard(lock_);
 
@@ -335,9 +394,9 @@ SymbolType SymbolMap::GetSymbolType(u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	if (activeFunctions.find(address) != activeFunctions.end())
+	if (ActiveFind(activeFunctions, address))
 		return ST_FUNCTION;
-	if (activeData.find(address) != activeData.end())
+	if (ActiveFind(activeData, address))
 		return ST_DATA;
 	return ST_NONE;
 }
@@ -385,14 +444,14 @@ u32 SymbolMap::GetNextSymbolAddress(u32 address, SymbolType symmask) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	const auto functionEntry = symmask & ST_FUNCTION ? activeFunctions.upper_bound(address) : activeFunctions.end();
-	const auto dataEntry = symmask & ST_DATA ? activeData.upper_bound(address) : activeData.end();
+	const auto functionEntry = symmask & ST_FUNCTION ? ActiveUpperBound(activeFunctions, address) : activeFunctions.end();
+	const auto dataEntry = symmask & ST_DATA ? ActiveUpperBound(activeData, address) : activeData.end();
 
 	if (functionEntry == activeFunctions.end() && dataEntry == activeData.end())
 		return INVALID_ADDRESS;
 
-	u32 funcAddress = (functionEntry != activeFunctions.end()) ? functionEntry->first : 0xFFFFFFFF;
-	u32 dataAddress = (dataEntry != activeData.end()) ? dataEntry->first : 0xFFFFFFFF;
+	u32 funcAddress = (functionEntry != activeFunctions.end()) ? functionEntry->address : 0xFFFFFFFF;
+	u32 dataAddress = (dataEntry != activeData.end()) ? dataEntry->address : 0xFFFFFFFF;
 
 	if (funcAddress <= dataAddress)
 		return funcAddress;
@@ -431,7 +490,7 @@ std::vector<SymbolEntry> SymbolMap::GetAllSymbols(SymbolType symmask) {
 		std::lock_guard<std::recursive_mutex> guard(lock_);
 		for (auto it = activeFunctions.begin(); it != activeFunctions.end(); it++) {
 			SymbolEntry entry;
-			entry.address = it->first;
+			entry.address = it->address;
 			entry.size = GetFunctionSize(entry.address);
 			const char* name = GetLabelName(entry.address);
 			if (name)
@@ -444,7 +503,7 @@ std::vector<SymbolEntry> SymbolMap::GetAllSymbols(SymbolType symmask) {
 		std::lock_guard<std::recursive_mutex> guard(lock_);
 		for (auto it = activeData.begin(); it != activeData.end(); it++) {
 			SymbolEntry entry;
-			entry.address = it->first;
+			entry.address = it->address;
 			entry.size = GetDataSize(entry.address);
 			const char* name = GetLabelName(entry.address);
 			if (name)
@@ -581,10 +640,9 @@ void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleI
 		}
 
 		// Refresh the active item if it exists.
-		auto active = activeFunctions.find(address);
-		if (active != activeFunctions.end() && active->second.module == moduleIndex) {
-			activeFunctions.erase(active);
-			activeFunctions.emplace(address, existing->second);
+		auto active = ActiveFind(activeFunctions, address);
+		if (active && active->entry.module == moduleIndex) {
+			active->entry = functions[symbolKey];
 		}
 	} else {
 		FunctionEntry func;
@@ -595,7 +653,7 @@ void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleI
 		functions[symbolKey] = func;
 
 		if (IsModuleActive(moduleIndex)) {
-			activeFunctions.emplace(address, func);
+			ActiveInsert(activeFunctions, { address, func });
 		}
 	}
 
@@ -607,29 +665,8 @@ u32 SymbolMap::GetFunctionStart(u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeFunctions.upper_bound(address);
-	if (it == activeFunctions.end()) {
-		// check last element
-		auto rit = activeFunctions.rbegin();
-		if (rit != activeFunctions.rend()) {
-			u32 start = rit->first;
-			u32 size = rit->second.size;
-			if (start <= address && start+size > address)
-				return start;
-		}
-		// otherwise there's no function that contains this address
-		return INVALID_ADDRESS;
-	}
-
-	if (it != activeFunctions.begin()) {
-		it--;
-		u32 start = it->first;
-		u32 size = it->second.size;
-		if (start <= address && start+size > address)
-			return start;
-	}
-
-	return INVALID_ADDRESS;
+	auto func = ActiveFindContaining(activeFunctions, address);
+	return func ? func->address : INVALID_ADDRESS;
 }
 
 u32 SymbolMap::FindPossibleFunctionAtAfter(u32 address) {
@@ -637,11 +674,11 @@ u32 SymbolMap::FindPossibleFunctionAtAfter(u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeFunctions.lower_bound(address);
+	auto it = ActiveLowerBound(activeFunctions, address);
 	if (it == activeFunctions.end()) {
 		return (u32)-1;
 	}
-	return it->first;
+	return it->address;
 }
 
 u32 SymbolMap::GetFunctionSize(u32 startAddress) {
@@ -672,11 +709,11 @@ u32 SymbolMap::GetFunctionSize(u32 startAddress) {
 	}
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeFunctions.find(startAddress);
-	if (it == activeFunctions.end())
+	auto func = ActiveFind(activeFunctions, startAddress);
+	if (!func)
 		return INVALID_ADDRESS;
 
-	return it->second.size;
+	return func->entry.size;
 }
 
 u32 SymbolMap::GetFunctionModuleAddress(u32 startAddress) {
@@ -684,11 +721,11 @@ u32 SymbolMap::GetFunctionModuleAddress(u32 startAddress) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeFunctions.find(startAddress);
-	if (it == activeFunctions.end())
+	auto func = ActiveFind(activeFunctions, startAddress);
+	if (!func)
 		return INVALID_ADDRESS;
 
-	return GetModuleAbsoluteAddr(0, it->second.module);
+	return GetModuleAbsoluteAddr(0, func->entry.module);
 }
 
 int SymbolMap::GetFunctionNum(u32 address) {
@@ -696,15 +733,11 @@ int SymbolMap::GetFunctionNum(u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	u32 start = GetFunctionStart(address);
-	if (start == INVALID_ADDRESS)
-		return INVALID_ADDRESS;
-
-	auto it = activeFunctions.find(start);
-	if (it == activeFunctions.end())
+	auto func = ActiveFindContaining(activeFunctions, address);
+	if (!func)
 		return INVALID_ADDRESS;
 
-	return it->second.index;
+	return func->entry.index;
 }
 
 void SymbolMap::AssignFunctionIndices() {
@@ -738,34 +771,42 @@ void SymbolMap::UpdateActiveSymbols() {
 		activeModuleIndexes[it->second.index] = it->second.start;
 	}
 
+	// Indices first, so the active copies get them.
+	AssignFunctionIndices();
+
+	activeFunctions.reserve(functions.size());
 	for (auto it = functions.begin(), end = functions.end(); it != end; ++it) {
 		const auto mod = activeModuleIndexes.find(it->second.module);
 		if (it->second.module == 0) {
-			activeFunctions.emplace(it->second.start, it->second);
+			activeFunctions.push_back({ it->second.start, it->second });
 		} else if (mod != activeModuleIndexes.end()) {
-			activeFunctions.emplace(mod->second + it->second.start, it->second);
+			activeFunctions.push_back({ mod->second + it->second.start, it->second });
 		}
 	}
 
+	activeLabels.reserve(labels.size());
 	for (auto it = labels.begin(), end = labels.end(); it != end; ++it) {
 		const auto mod = activeModuleIndexes.find(it->second.module);
 		if (it->second.module == 0) {
-			activeLabels.emplace(it->second.addr, it->second);
+			activeLabels.push_back({ it->second.addr, &it->second });
 		} else if (mod != activeModuleIndexes.end()) {
-			activeLabels.emplace(mod->second + it->second.addr, it->second);
+			activeLabels.push_back({ mod->second + it->second.addr, &it->second });
 		}
 	}
 
+	activeData.reserve(data.size());
 	for (auto it = data.begin(), end = data.end(); it != end; ++it) {
 		const auto mod = activeModuleIndexes.find(it->second.module);
 		if (it->second.module == 0) {
-			activeData.emplace(it->second.start, it->second);
+			activeData.push_back({ it->second.start, it->second });
 		} else if (mod != activeModuleIndexes.end()) {
-			activeData.emplace(mod->second + it->second.start, it->second);
+			activeData.push_back({ mod->second + it->second.start, it->second });
 		}
 	}
 
-	AssignFunctionIndices();
+	ActiveSort(activeFunctions);
+	ActiveSort(activeLabels);
+	ActiveSort(activeData);
 	activeNeedUpdate_ = false;
 }
 
@@ -775,14 +816,13 @@ bool SymbolMap::SetFunctionSize(u32 startAddress, u32 newSize) {
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
 
-	auto funcInfo = activeFunctions.find(startAddress);
-	if (funcInfo != activeFunctions.end()) {
-		auto symbolKey = std::make_pair(funcInfo->second.module, funcInfo->second.start);
+	auto funcInfo = ActiveFind(activeFunctions, startAddress);
+	if (funcInfo) {
+		auto symbolKey = std::make_pair(funcInfo->entry.module, funcInfo->entry.start);
 		auto func = functions.find(symbolKey);
 		if (func != functions.end()) {
 			func->second.size = newSize;
-			activeFunctions.erase(funcInfo);
-			activeFunctions.emplace(startAddress, func->second);
+			funcInfo->entry = func->second;
 		}
 	}
 
@@ -796,26 +836,27 @@ bool SymbolMap::RemoveFunction(u32 startAddress, bool removeName) {
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
 
-	auto it = activeFunctions.find(startAddress);
-	if (it == activeFunctions.end())
+	auto func = ActiveFind(activeFunctions, startAddress);
+	if (!func)
 		return false;
 
-	auto symbolKey = std::make_pair(it->second.module, it->second.start);
+	auto symbolKey = std::make_pair(func->entry.module, func->entry.start);
 	auto it2 = functions.find(symbolKey);
 	if (it2 != functions.end()) {
 		functions.erase(it2);
 	}
-	activeFunctions.erase(it);
+	ActiveErase(activeFunctions, startAddress);
 
 	if (removeName) {
-		auto labelIt = activeLabels.find(startAddress);
-		if (labelIt != activeLabels.end()) {
-			symbolKey = std::make_pair(labelIt->second.module, labelIt->second.addr);
+		auto label = ActiveFind(activeLabels, startAddress);
+		if (label) {
+			symbolKey = std::make_pair(label->entry->module, label->entry->addr);
+			// Drop the active entry first, it points at the node we're erasing.
+			ActiveErase(activeLabels, startAddress);
 			auto labelIt2 = labels.find(symbolKey);
 			if (labelIt2 != labels.end()) {
 				labels.erase(labelIt2);
 			}
-			activeLabels.erase(labelIt);
 		}
 	}
 
@@ -847,14 +888,14 @@ void SymbolMap::AddLabel(const char* name, u32 address, int moduleIndex) {
 			LabelEntry label = existing->second;
 			label.addr = relAddress;
 			label.module = moduleIndex;
+			const LabelEntry *oldEntry = &existing->second;
 			labels.erase(existing);
-			labels[symbolKey] = label;
+			const LabelEntry *newEntry = &(labels[symbolKey] = label);
 
-			// Refresh the active item if it exists.
-			auto active = activeLabels.find(address);
-			if (active != activeLabels.end() && active->second.module == moduleIndex) {
-				activeLabels.erase(active);
-				activeLabels.emplace(address, label);
+			// Refresh the active item if it pointed to the old one.
+			auto active = ActiveFind(activeLabels, address);
+			if (active && active->entry == oldEntry) {
+				active->entry = newEntry;
 			}
 		}
 	} else {
@@ -863,9 +904,9 @@ void SymbolMap::AddLabel(const char* name, u32 address, int moduleIndex) {
 		label.module = moduleIndex;
 		truncate_cpy(label.name, name);
 
-		labels[symbolKey] = label;
+		const LabelEntry *newEntry = &(labels[symbolKey] = label);
 		if (IsModuleActive(moduleIndex)) {
-			activeLabels.emplace(address, label);
+			ActiveInsert(activeLabels, { address, newEntry });
 		}
 	}
 }
@@ -875,22 +916,16 @@ void SymbolMap::SetLabelName(const char* name, u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto labelInfo = activeLabels.find(address);
-	if (labelInfo == activeLabels.end()) {
+	auto labelInfo = ActiveFind(activeLabels, address);
+	if (!labelInfo) {
 		AddLabel(name, address);
 	} else {
-		auto symbolKey = std::make_pair(labelInfo->second.module, labelInfo->second.addr);
+		auto symbolKey = std::make_pair(labelInfo->entry->module, labelInfo->entry->addr);
 		auto label = labels.find(symbolKey);
 		if (label != labels.end()) {
+			// The active entry points at this, so it sees the new name too.
 			truncate_cpy(label->second.name, name);
 			label->second.name[127] = 0;
-
-			// Refresh the active item if it exists.
-			auto active = activeLabels.find(address);
-			if (active != activeLabels.end() && active->second.module == label->second.module) {
-				activeLabels.erase(active);
-				activeLabels.emplace(address, label->second);
-			}
 		}
 	}
 }
@@ -900,11 +935,11 @@ const char *SymbolMap::GetLabelName(u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeLabels.find(address);
-	if (it == activeLabels.end())
+	auto label = ActiveFind(activeLabels, address);
+	if (!label)
 		return NULL;
 
-	return it->second.name;
+	return label->entry->name;
 }
 
 const char *SymbolMap::GetLabelNameRel(u32 relAddress, int moduleIndex) const {
@@ -930,8 +965,8 @@ bool SymbolMap::GetLabelValue(const char* name, u32& dest) {
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
 	for (auto it = activeLabels.begin(); it != activeLabels.end(); it++) {
-		if (strcasecmp(name, it->second.name) == 0) {
-			dest = it->first;
+		if (strcasecmp(name, it->entry->name) == 0) {
+			dest = it->address;
 			return true;
 		}
 	}
@@ -969,10 +1004,9 @@ void SymbolMap::AddData(u32 address, u32 size, DataType type, int moduleIndex) {
 		}
 
 		// Refresh the active item if it exists.
-		auto active = activeData.find(address);
-		if (active != activeData.end() && active->second.module == moduleIndex) {
-			activeData.erase(active);
-			activeData.emplace(address, existing->second);
+		auto active = ActiveFind(activeData, address);
+		if (active && active->entry.module == moduleIndex) {
+			active->entry = data[symbolKey];
 		}
 	} else {
 		DataEntry entry;
@@ -983,7 +1017,7 @@ void SymbolMap::AddData(u32 address, u32 size, DataType type, int moduleIndex) {
 
 		data[symbolKey] = entry;
 		if (IsModuleActive(moduleIndex)) {
-			activeData.emplace(address, entry);
+			ActiveInsert(activeData, { address, entry });
 		}
 	}
 }
@@ -993,32 +1027,8 @@ u32 SymbolMap::GetDataStart(u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeData.upper_bound(address);
-	if (it == activeData.end())
-	{
-		// check last element
-		auto rit = activeData.rbegin();
-
-		if (rit != activeData.rend())
-		{
-			u32 start = rit->first;
-			u32 size = rit->second.size;
-			if (start <= address && start+size > address)
-				return start;
-		}
-		// otherwise there's no data that contains this address
-		return INVALID_ADDRESS;
-	}
-
-	if (it != activeData.begin()) {
-		it--;
-		u32 start = it->first;
-		u32 size = it->second.size;
-		if (start <= address && start+size > address)
-			return start;
-	}
-
-	return INVALID_ADDRESS;
+	auto entry = ActiveFindContaining(activeData, address);
+	return entry ? entry->address : INVALID_ADDRESS;
 }
 
 u32 SymbolMap::GetDataSize(u32 startAddress) {
@@ -1026,10 +1036,10 @@ u32 SymbolMap::GetDataSize(u32 startAddress) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeData.find(startAddress);
-	if (it == activeData.end())
+	auto entry = ActiveFind(activeData, startAddress);
+	if (!entry)
 		return INVALID_ADDRESS;
-	return it->second.size;
+	return entry->entry.size;
 }
 
 u32 SymbolMap::GetDataModuleAddress(u32 startAddress) {
@@ -1037,10 +1047,10 @@ u32 SymbolMap::GetDataModuleAddress(u32 startAddress) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeData.find(startAddress);
-	if (it == activeData.end())
+	auto entry = ActiveFind(activeData, startAddress);
+	if (!entry)
 		return INVALID_ADDRESS;
-	return GetModuleAbsoluteAddr(0, it->second.module);
+	return GetModuleAbsoluteAddr(0, entry->entry.module);
 }
 
 DataType SymbolMap::GetDataType(u32 startAddress) {
@@ -1048,10 +1058,10 @@ DataType SymbolMap::GetDataType(u32 startAddress) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeData.find(startAddress);
-	if (it == activeData.end())
+	auto entry = ActiveFind(activeData, startAddress);
+	if (!entry)
 		return DATATYPE_NONE;
-	return it->second.type;
+	return entry->entry.type;
 }
 
 void SymbolMap::GetLabels(std::vector<LabelDefinition> &dest) {
@@ -1061,8 +1071,8 @@ void SymbolMap::GetLabels(std::vector<LabelDefinition> &dest) {
 	std::lock_guard<std::recursive_mutex> guard(lock_);
 	for (auto it = activeLabels.begin(); it != activeLabels.end(); it++) {
 		LabelDefinition entry;
-		entry.value = it->first;
-		std::string name = it->second.name;
+		entry.value = it->address;
+		std::string name = it->entry->name;
 		std::transform(name.begin(), name.end(), name.begin(), ::tolower);
 		entry.name = Identifier(name);
 		dest.push_back(entry);
@@ -1100,13 +1110,13 @@ void SymbolMap::FillSymbolListBox(HWND listbox,SymbolType symType) {
 			SendMessage(listbox, LB_INITSTORAGE, (WPARAM)activeFunctions.size(), (LPARAM)activeFunctions.size() * 30);
 
 			for (auto it = activeFunctions.begin(), end = activeFunctions.end(); it != end; ++it) {
-				const char* name = GetLabelName(it->first);
+				const char* name = GetLabelName(it->address);
 				if (name != NULL)
 					wsprintf(temp, L"%S", name);
 				else
-					wsprintf(temp, L"0x%08X", it->first);
+					wsprintf(temp, L"0x%08X", it->address);
 				int index = ListBox_AddString(listbox,temp);
-				ListBox_SetItemData(listbox,index,it->first);
+				ListBox_SetItemData(listbox,index,it->address);
 			}
 		}
 		break;
@@ -1123,15 +1133,15 @@ void SymbolMap::FillSymbolListBox(HWND listbox,SymbolType symType) {
 			}
 
 			for (auto it = activeData.begin(), end = activeData.end(); it != end; ++it) {
-				const char* name = GetLabelName(it->first);
+				const char* name = GetLabelName(it->address);
 
 				if (name != NULL)
 					wsprintf(temp, L"%S", name);
 				else
-					wsprintf(temp, L"0x%08X", it->first);
+					wsprintf(temp, L"0x%08X", it->address);
 
 				int index = ListBox_AddString(listbox,temp);
-				ListBox_SetItemData(listbox,index,it->first);
+				ListBox_SetItemData(listbox,index,it->address);
 			}
 		}
 		break;
@@ -152,10 +152,18 @@ class SymbolMap {
 		char name[128];
 	};
 
+	template <typename T>
+	struct ActiveEntry {
+		u32 address;
+		T entry;
+	};
+
 	// These are flattened, read-only copies of the actual data in active modules only.
-	std::map<u32, const FunctionEntry> activeFunctions;
-	std::map<u32, const LabelEntry> activeLabels;
-	std::map<u32, const DataEntry> activeData;
+	// Kept sorted by absolute address for binary search, see the helpers in SymbolMap.cpp.
+	std::vector<ActiveEntry<FunctionEntry>> activeFunctions;
+	// Points into labels, whose nodes are stable. Must be refreshed whenever one is erased.
+	std::vector<ActiveEntry<const LabelEntry *>> activeLabels;
+	std::vector<ActiveEntry<DataEntry>> activeData;
 	bool activeNeedUpdate_ = false;
 
 	// This is indexed by the end address of the module.
@@ -49,6 +49,7 @@
 #include "Core/Debugger/WebSocket/LogBroadcaster.h"
 #include "Core/Debugger/WebSocket/SteppingBroadcaster.h"
 
+#include "Core/Debugger/WebSocket/AudioSubscriber.h"
 #include "Core/Debugger/WebSocket/BreakpointSubscriber.h"
 #include "Core/Debugger/WebSocket/CPUCoreSubscriber.h"
 #include "Core/Debugger/WebSocket/DisasmSubscriber.h"
@@ -62,10 +63,12 @@
 #include "Core/Debugger/WebSocket/MemorySubscriber.h"
 #include "Core/Debugger/WebSocket/ReplaySubscriber.h"
 #include "Core/Debugger/WebSocket/SteppingSubscriber.h"
+#include "Core/Debugger/WebSocket/StreamSubscriber.h"
 #include "Core/Debugger/WebSocket/ClientConfigSubscriber.h"
 
 typedef DebuggerSubscriber *(*SubscriberInit)(DebuggerEventHandlerMap &map);
 static const std::vector<SubscriberInit> subscribers({
+	&WebSocketAudioInit,
 	&WebSocketBreakpointInit,
 	&WebSocketCPUCoreInit,
 	&WebSocketDisasmInit,
@@ -79,6 +82,7 @@ static const std::vector<SubscriberInit> subscribers({
 	&WebSocketMemoryInit,
 	&WebSocketReplayInit,
 	&WebSocketSteppingInit,
+	&WebSocketStreamInit,
 	&WebSocketClientConfigInit,
 });
 
@@ -0,0 +1,93 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+#include "Common/System/System.h"
+#include "Core/Debugger/WebSocket/AudioSubscriber.h"
+#include "Core/Debugger/WebSocket/WebSocketUtils.h"
+#include "Core/HLE/__sceAudio.h"
+#include "Core/System.h"
+
+DebuggerSubscriber *WebSocketAudioInit(DebuggerEventHandlerMap &map) {
+	map["audio.stats.get"] = &WebSocketAudioStatsGet;
+	map["audio.stats.reset"] = &WebSocketAudioStatsReset;
+
+	return nullptr;
+}
+
+// Get audio output stats (audio.stats.get)
+//
+// No parameters.
+//
+// Response (same event name):
+//  - buffered: number of frames waiting to be played, last time the host asked for more.
+//  - lowestBuffered: number, the fewest frames seen waiting since the last reset.
+//  - target: number of frames the buffer is kept around.
+//  - size: number of frames the buffer can hold.
+//  - hostFrames: number of frames the host asked for last, roughly its own buffer.
+//  - queuedFrames: number of frames in the fullest sceAudio channel, not mixed yet.
+//  - lowLatency: boolean, true if the target adapts to avoid underruns.
+//  - underruns: object with "count" and "frames" properties, frames which had to be padded.
+//  - overruns: object with "count" and "frames" properties, frames dropped because the buffer was full.
+//  - latency: object with properties, all in milliseconds from being mixed until played:
+//     - last: number, the latest measurement.
+//     - p50, p95, p99: numbers, percentiles since the last reset.
+//     - count: number of measurements since the last reset.
+//  - sampleRate: object with "actual" and "target" properties, in Hz.
+void WebSocketAudioStatsGet(DebuggerRequest &req) {
+	if (!PSP_IsInited())
+		return req.Fail("Game not running");
+
+	AudioDebugStats stats;
+	System_AudioGetDebugStats(&stats);
+
+	JsonWriter &json = req.Respond();
+	json.writeInt("buffered", stats.buffered);
+	json.writeInt("lowestBuffered", stats.minBuffered);
+	json.writeInt("target", stats.watermark);
+	json.writeInt("size", stats.bufsize);
+	json.writeInt("hostFrames", stats.hostFrames);
+	json.writeInt("queuedFrames", stats.queuedFrames);
+	json.writeBool("lowLatency", stats.lowLatency);
+	json.pushDict("underruns");
+	json.writeInt("count", stats.underrunCount);
+	json.writeInt("frames", stats.underrunFrames);
+	json.pop();
+	json.pushDict("overruns");
+	json.writeInt("count", stats.overrunCount);
+	json.writeInt("frames", stats.overrunFrames);
+	json.pop();
+	json.pushDict("latency");
+	json.writeFloat("last", stats.latencyMs);
+	json.writeFloat("p50", stats.latencyP50Ms);
+	json.writeFloat("p95", stats.latencyP95Ms);
+	json.writeFloat("p99", stats.latencyP99Ms);
+	json.writeInt("count", stats.latencyCount);
+	json.pop();
+	json.pushDict("sampleRate");
+	json.writeInt("actual", stats.instantSampleRate);
+	json.writeInt("target", stats.targetSampleRate);
+	json.pop();
+}
+
+// Reset audio output stats (audio.stats.reset)
+//
+// No parameters.  Use this after changing settings, so the percentiles only cover what came after.
+//
+// Response (same event name) with no extra data.
+void WebSocketAudioStatsReset(DebuggerRequest &req) {
+	System_AudioResetStatCounters();
+	req.Respond();
+}
@@ -23,6 +23,8 @@
 #include "Core/Debugger/WebSocket/CPUCoreSubscriber.h"
 #include "Core/Debugger/WebSocket/WebSocketUtils.h"
 #include "Core/HLE/sceKernelThread.h"
+#include "Core/MIPS/JitCommon/JitBlockCache.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSDebugInterface.h"
 #include "Core/Reporting.h"
@@ -36,6 +38,7 @@ DebuggerSubscriber *WebSocketCPUCoreInit(DebuggerEventHandlerMap &map) {
 	map["cpu.getReg"] = &WebSocketCPUGetReg;
 	map["cpu.setReg"] = &WebSocketCPUSetReg;
 	map["cpu.evaluate"] = &WebSocketCPUEvaluate;
+	map["cpu.jitProfile"] = &WebSocketCPUJitProfile;
 
 	return nullptr;
 }
@@ -414,3 +417,55 @@ void WebSocketCPUEvaluate(DebuggerRequest &req) {
 	json.writeUint("uintValue", val);
 	json.writeString("floatValue", RegValueAsFloat(val));
 }
+
+// Retrieve per-block jit profile stats (cpu.jitProfile)
+//
+// Parameters:
+//  - format: optional string, "csv" or "trace" to get the export as a string instead.
+//
+// Response (same event name) without format:
+//  - profiling: boolean, whether execution counts and times are being collected.
+//  - blocks: array of objects with address, size, executions, and totalNanos.
+//    Counts are floats in case they get large.
+//  - statuses: array of objects with name and samples, if the sampling profiler is running.
+//
+// Response (same event name) with format:
+//  - data: string with the CSV or Chrome trace JSON export.
+void WebSocketCPUJitProfile(DebuggerRequest &req) {
+	std::string format;
+	if (!req.ParamString("format", &format, DebuggerParamType::OPTIONAL))
+		return;
+	if (!format.empty() && format != "csv" && format != "trace")
+		return req.Fail("Unknown format, should be csv or trace");
+
+	std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+	JitBlockCacheDebugInterface *blockCache = MIPSComp::jit ? MIPSComp::jit->GetBlockCacheDebugInterface() : nullptr;
+	if (!blockCache)
+		return req.Fail("Jit not active");
+
+	JsonWriter &json = req.Respond();
+	if (!format.empty()) {
+		json.writeString("data", ExportJitBlockProfile(blockCache, format == "csv" ? JitProfileFormat::CSV : JitProfileFormat::CHROME_TRACE));
+		return;
+	}
+
+	json.writeBool("profiling", blockCache->SupportsProfiling());
+	json.pushArray("blocks");
+	for (const JitBlockProfileEntry &entry : CollectJitBlockProfile(blockCache)) {
+		json.pushDict();
+		json.writeUint("address", entry.addr);
+		json.writeUint("size", entry.sizeInBytes);
+		json.writeFloat("executions", (double)entry.stats.executions);
+		json.writeFloat("totalNanos", (double)entry.stats.totalNanos);
+		json.pop();
+	}
+	json.pop();
+	json.pushArray("statuses");
+	for (const auto &sample : blockCache->GetProfilerStatusSamples()) {
+		json.pushDict();
+		json.writeString("name", sample.first);
+		json.writeFloat("samples", (double)sample.second);
+		json.pop();
+	}
+	json.pop();
+}
@@ -20,6 +20,8 @@
 #include "Core/Debugger/WebSocket/GPUStatsSubscriber.h"
 #include "Core/HW/Display.h"
 #include "Core/System.h"
+#include "GPU/GPU.h"
+#include "GPU/ge_constants.h"
 
 struct CollectedStats {
 	float vps;
@@ -29,6 +31,7 @@ struct CollectedStats {
 	std::vector<double> frameTimes;
 	std::vector<double> sleepTimes;
 	int frameTimePos;
+	GPUStatistics gpu;
 };
 
 struct DebuggerGPUStatsEvent {
@@ -61,6 +64,27 @@ struct DebuggerGPUStatsEvent {
 		j.pop();
 		j.writeInt("pos", s.frameTimePos);
 		j.pop();
+		j.pushDict("textureCache");
+		j.writeInt("hits", s.gpu.numTextureCacheHits);
+		j.writeInt("misses", s.gpu.numTextureCacheMisses);
+		j.writeInt("rehashes", s.gpu.numTexturesHashed);
+		j.writeInt("decodes", s.gpu.numTexturesDecoded);
+		j.writeFloat("hashMs", s.gpu.msTextureHashing * 1000.0);
+		j.writeFloat("decodeMs", s.gpu.msTextureDecoding * 1000.0);
+		j.writeFloat("scaleMs", s.gpu.msTextureScaling * 1000.0);
+		j.writeInt("uploadBytes", s.gpu.numTextureBytesUploaded);
+		j.pushArray("formats");
+		for (size_t i = 0; i < ARRAY_SIZE(s.gpu.numTexturesDecodedByFormat); i++) {
+			if (s.gpu.numTexturesDecodedByFormat[i] == 0 && s.gpu.numTextureBytesUploadedByFormat[i] == 0)
+				continue;
+			j.pushDict();
+			j.writeString("format", GeTextureFormatToString((GETextureFormat)i));
+			j.writeInt("decodes", s.gpu.numTexturesDecodedByFormat[i]);
+			j.writeInt("uploadBytes", s.gpu.numTextureBytesUploadedByFormat[i]);
+			j.pop();
+		}
+		j.pop();
+		j.pop();
 		j.end();
 		return j.str();
 	}
@@ -121,6 +145,7 @@ void WebSocketGPUStatsState::FlipListener() {
 
 	__DisplayGetFPS(&stats.vps, &stats.fps, &stats.actual_fps);
 	__DisplayGetDebugStats(stats.statbuf, sizeof(stats.statbuf));
+	stats.gpu = gpuStats;
 
 	int valid;
 	double *sleepHistory;
@@ -146,6 +171,14 @@ void WebSocketGPUStatsState::FlipListener() {
 //     - frames: array of numbers, each representing the time taken for a frame.
 //     - sleep: array of numbers, each representing the delay time waiting for next frame.
 //     - pos: number, index of the current frame (not always last.)
+//  - textureCache: object with per frame texture cache counters:
+//     - hits: number of lookups that found a usable texture.
+//     - misses: number of lookups that had to create or rebuild a texture.
+//     - rehashes: number of full texture data hashes.
+//     - decodes: number of textures decoded and uploaded.
+//     - hashMs, decodeMs, scaleMs: number, CPU time spent in each step, in milliseconds.
+//     - uploadBytes: number, approximate size of the uploaded textures.
+//     - formats: array of objects with "format", "decodes", and "uploadBytes" properties, for each format seen.
 //
 // Note: stats are returned after the next flip completes (paused if CPU or GPU in break.)
 // Note: info and timing may not be accurate if certain settings are disabled.
@@ -29,6 +29,7 @@ DebuggerSubscriber *WebSocketReplayInit(DebuggerEventHandlerMap &map) {
 	map["replay.abort"] = &WebSocketReplayAbort;
 	map["replay.flush"] = &WebSocketReplayFlush;
 	map["replay.execute"] = &WebSocketReplayExecute;
+	map["replay.seek"] = &WebSocketReplaySeek;
 	map["replay.status"] = &WebSocketReplayStatus;
 	map["replay.time.get"] = &WebSocketReplayTimeGet;
 	map["replay.time.set"] = &WebSocketReplayTimeSet;
@@ -41,10 +42,17 @@ DebuggerSubscriber *WebSocketReplayInit(DebuggerEventHandlerMap &map) {
 // If a replay was previously being played back, this will keep any executed replay data up to
 // this point for the next flush.  To discard, break the CPU, abort, and then begin.
 //
-// No parameters.
+// Parameters:
+//  - keyframeInterval: optional unsigned integer, vblanks between save state keyframes, or 0
+//    for none.  Keyframes make seeking fast, but make the data larger.
 //
 // Response (same event name) with no extra data.
 void WebSocketReplayBegin(DebuggerRequest &req) {
+	uint32_t keyframeInterval = 600;
+	if (!req.ParamU32("keyframeInterval", &keyframeInterval, false, DebuggerParamType::OPTIONAL))
+		return;
+
+	ReplaySetKeyframeInterval((int)keyframeInterval);
 	ReplayBeginSave();
 	req.Respond();
 }
@@ -107,6 +115,30 @@ void WebSocketReplayExecute(DebuggerRequest &req) {
 	req.Respond();
 }
 
+// Seek during replay execution (replay.seek)
+//
+// Loads the closest keyframe before the target if that's faster, then runs hidden frames without
+// throttling until it's reached.  Afterward, the replay continues to execute normally.
+//
+// Parameters:
+//  - vcount: unsigned integer, vblank count to seek to.
+//
+// Response (same event name) with no extra data, once the seek has started.
+void WebSocketReplaySeek(DebuggerRequest &req) {
+	if (!PSP_IsInited())
+		return req.Fail("Game not running");
+	if (!ReplayIsExecuting())
+		return req.Fail("Replay not executing");
+
+	uint32_t vcount;
+	if (!req.ParamU32("vcount", &vcount))
+		return;
+	if (!ReplaySeekFrame((int)vcount))
+		return req.Fail("No keyframe to seek from");
+
+	req.Respond();
+}
+
 // Get replay status (replay.status)
 //
 // No parameters.
@@ -114,10 +146,12 @@ void WebSocketReplayExecute(DebuggerRequest &req) {
 // Response (same event name):
 //  - executing: boolean if a replay is being executed.
 //  - saving: boolean if a replay is being recorded.
+//  - seeking: boolean if frames are still being run toward a replay.seek target.
 void WebSocketReplayStatus(DebuggerRequest &req) {
 	JsonWriter &json = req.Respond();
 	json.writeBool("executing", ReplayIsExecuting());
 	json.writeBool("saving", ReplayIsSaving());
+	json.writeBool("seeking", ReplayIsSeeking());
 }
 
 // Get the base RTC (real time clock) time for replay data (replay.time.get)
@@ -25,6 +25,7 @@ void WebSocketReplayBegin(DebuggerRequest &req);
 void WebSocketReplayAbort(DebuggerRequest &req);
 void WebSocketReplayFlush(DebuggerRequest &req);
 void WebSocketReplayExecute(DebuggerRequest &req);
+void WebSocketReplaySeek(DebuggerRequest &req);
 void WebSocketReplayStatus(DebuggerRequest &req);
 void WebSocketReplayTimeGet(DebuggerRequest &req);
 void WebSocketReplayTimeSet(DebuggerRequest &req);
@@ -0,0 +1,504 @@
+// Copyright (c) 2018- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Core/Debugger/WebSocket/StreamSubscriber.h"
+#include "Core/HW/Display.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/MIPSDebugInterface.h"
+#include "Core/System.h"
+#include "GPU/GPU.h"
+#include "GPU/Common/GPUDebugInterface.h"
+
+// Streams are for tools that want the same data every frame, without stopping the CPU and
+// without paying for JSON and base64.  The emu thread only copies the data at each flip;
+// comparing and packing happens on the debugger thread.
+//
+// Each flip that has anything to send results in one binary message, all little endian:
+//    u32 magic ('PPST'), u16 version (1), u16 chunk count, u32 flip count, u32 dropped flips
+// The dropped count is how many captures were replaced before the debugger got to send them.
+//
+// Then for each chunk:
+//    u8 kind, u8 flags, u16 reserved, u32 stream id, u32 payload size, payload
+//
+// Kind 1 (memory): u32 address, then the bytes.
+// Kind 2 (registers): u32 pc, hi, lo, fcr31, then 32 GPRs, 32 FPRs, 128 VFPU, 16 VFPU control.
+// Kind 3 (framebuffer): u16 width, u16 height, u8 format, u8 pixel size, u16 tile size, u32 tile
+//    count, then each tile: u16 x, u16 y (in tiles), and its rows of pixels, clipped to the edges.
+//    Flag 1 means every tile is included (keyframe), flag 2 means rows are bottom to top.
+//    The format is a GPUDebugBufferFormat value, see DescribeFormat() in GPUBufferSubscriber.cpp.
+
+static const uint32_t STREAM_MAGIC = 0x54535050;
+static const uint16_t STREAM_VERSION = 1;
+// Keeps a careless subscription from copying all of RAM every frame.
+static const uint32_t STREAM_MAX_MEMORY = 8 * 1024 * 1024;
+static const int STREAM_REGISTER_WORDS = 4 + 32 + 32 + 128 + VFPU_CTRL_MAX;
+static const size_t STREAM_CHUNK_COUNT_OFFSET = 6;
+static const size_t STREAM_CHUNK_HEADER_SIZE = 12;
+
+enum class StreamKind : uint8_t {
+	MEMORY = 1,
+	REGISTERS = 2,
+	FRAMEBUFFER = 3,
+};
+
+enum {
+	STREAM_FLAG_KEYFRAME = 1,
+	STREAM_FLAG_FLIPPED = 2,
+};
+
+struct StreamSubscription {
+	uint32_t id;
+	StreamKind kind;
+	uint32_t address;
+	uint32_t size;
+	uint32_t interval;
+	uint32_t tileSize;
+	bool onChange;
+};
+
+// What the emu thread copied at a flip.  Memory for each stream is back to back, in order.
+struct StreamCapture {
+	int flip = 0;
+	std::vector<StreamSubscription> subs;
+	std::vector<uint8_t> memory;
+	uint32_t registers[STREAM_REGISTER_WORDS];
+	bool hasFramebuffer = false;
+	GPUDebugBuffer framebuffer;
+};
+
+struct StreamFramebufferHistory {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	GPUDebugBufferFormat format = GPU_DBG_FORMAT_INVALID;
+	std::vector<uint8_t> pixels;
+};
+
+struct WebSocketStreamState : public DebuggerSubscriber {
+	WebSocketStreamState();
+	~WebSocketStreamState();
+	void StreamMemory(DebuggerRequest &req);
+	void StreamRegisters(DebuggerRequest &req);
+	void StreamFramebuffer(DebuggerRequest &req);
+	void Stop(DebuggerRequest &req);
+
+	void Broadcast(net::WebSocketServer *ws) override;
+
+	static void FlipForwarder(void *thiz);
+	void FlipListener();
+
+protected:
+	bool Subscribe(DebuggerRequest &req, StreamSubscription &sub);
+	void Capture(StreamCapture &capture);
+	bool AddMemory(const StreamSubscription &sub, const uint8_t *data);
+	bool AddFramebuffer(const StreamSubscription &sub, const GPUDebugBuffer &buf);
+	size_t BeginChunk(StreamKind kind, uint32_t id);
+	void EndChunk(size_t pos, uint8_t flags);
+
+	template <typename T>
+	void Append(T value) {
+		size_t pos = message_.size();
+		message_.resize(pos + sizeof(T));
+		memcpy(&message_[pos], &value, sizeof(T));
+	}
+	void Append(const void *p, size_t sz) {
+		const uint8_t *bytes = (const uint8_t *)p;
+		message_.insert(message_.end(), bytes, bytes + sz);
+	}
+
+	// Shared with the emu thread, protected by pendingLock_.
+	std::mutex pendingLock_;
+	std::vector<StreamSubscription> subscriptions_;
+	StreamCapture pending_;
+	bool hasPending_ = false;
+	uint32_t dropped_ = 0;
+
+	// Only used on the debugger thread.
+	uint32_t nextId_ = 1;
+	StreamCapture sending_;
+	std::vector<uint8_t> message_;
+	uint16_t chunkCount_ = 0;
+	std::unordered_map<uint32_t, std::vector<uint8_t>> lastMemory_;
+	std::unordered_map<uint32_t, StreamFramebufferHistory> lastFramebuffer_;
+};
+
+DebuggerSubscriber *WebSocketStreamInit(DebuggerEventHandlerMap &map) {
+	auto p = new WebSocketStreamState();
+	map["stream.memory"] = std::bind(&WebSocketStreamState::StreamMemory, p, std::placeholders::_1);
+	map["stream.registers"] = std::bind(&WebSocketStreamState::StreamRegisters, p, std::placeholders::_1);
+	map["stream.framebuffer"] = std::bind(&WebSocketStreamState::StreamFramebuffer, p, std::placeholders::_1);
+	map["stream.stop"] = std::bind(&WebSocketStreamState::Stop, p, std::placeholders::_1);
+
+	return p;
+}
+
+WebSocketStreamState::WebSocketStreamState() {
+	__DisplayListenFlip(&WebSocketStreamState::FlipForwarder, this);
+}
+
+WebSocketStreamState::~WebSocketStreamState() {
+	__DisplayForgetFlip(&WebSocketStreamState::FlipForwarder, this);
+}
+
+void WebSocketStreamState::FlipForwarder(void *thiz) {
+	WebSocketStreamState *p = (WebSocketStreamState *)thiz;
+	p->FlipListener();
+}
+
+void WebSocketStreamState::FlipListener() {
+	std::lock_guard<std::mutex> guard(pendingLock_);
+	if (subscriptions_.empty())
+		return;
+
+	// If the last one wasn't sent yet, just replace it.  Better late data than a backlog.
+	if (hasPending_)
+		dropped_++;
+	Capture(pending_);
+	hasPending_ = !pending_.subs.empty();
+}
+
+void WebSocketStreamState::Capture(StreamCapture &capture) {
+	capture.flip = __DisplayGetFlipCount();
+	capture.subs.clear();
+	capture.memory.clear();
+	capture.hasFramebuffer = false;
+
+	bool hasRegisters = false;
+	for (const StreamSubscription &sub : subscriptions_) {
+		if ((capture.flip % sub.interval) != 0)
+			continue;
+
+		switch (sub.kind) {
+		case StreamKind::MEMORY:
+			if (!Memory::IsValidRange(sub.address, sub.size))
+				continue;
+			capture.memory.insert(capture.memory.end(), Memory::GetPointerUnchecked(sub.address), Memory::GetPointerUnchecked(sub.address) + sub.size);
+			break;
+
+		case StreamKind::REGISTERS:
+			if (!hasRegisters) {
+				uint32_t *regs = capture.registers;
+				*regs++ = currentMIPS->pc;
+				*regs++ = currentMIPS->hi;
+				*regs++ = currentMIPS->lo;
+				*regs++ = currentMIPS->fcr31;
+				memcpy(regs, currentMIPS->r, sizeof(currentMIPS->r));
+				regs += 32;
+				memcpy(regs, currentMIPS->fi, sizeof(currentMIPS->fi));
+				regs += 32;
+				memcpy(regs, currentMIPS->vi, sizeof(currentMIPS->vi));
+				regs += 128;
+				memcpy(regs, currentMIPS->vfpuCtrl, sizeof(currentMIPS->vfpuCtrl));
+				hasRegisters = true;
+			}
+			break;
+
+		case StreamKind::FRAMEBUFFER:
+			// At 1x, since this is a readback every frame.  Flips are synced with the GPU already.
+			if (!capture.hasFramebuffer)
+				capture.hasFramebuffer = gpuDebug && gpuDebug->GetCurrentFramebuffer(capture.framebuffer, GPU_DBG_FRAMEBUF_DISPLAY, 1);
+			if (!capture.hasFramebuffer)
+				continue;
+			break;
+		}
+
+		capture.subs.push_back(sub);
+	}
+}
+
+void WebSocketStreamState::Broadcast(net::WebSocketServer *ws) {
+	uint32_t dropped;
+	{
+		std::lock_guard<std::mutex> guard(pendingLock_);
+		if (!hasPending_)
+			return;
+		std::swap(pending_, sending_);
+		hasPending_ = false;
+		dropped = dropped_;
+		dropped_ = 0;
+	}
+
+	message_.clear();
+	chunkCount_ = 0;
+	Append(STREAM_MAGIC);
+	Append(STREAM_VERSION);
+	// Chunk count, filled in at the end.
+	Append((uint16_t)0);
+	Append((uint32_t)sending_.flip);
+	Append(dropped);
+
+	const uint8_t *memory = sending_.memory.data();
+	for (const StreamSubscription &sub : sending_.subs) {
+		switch (sub.kind) {
+		case StreamKind::MEMORY:
+			AddMemory(sub, memory);
+			memory += sub.size;
+			break;
+
+		case StreamKind::REGISTERS:
+		{
+			size_t pos = BeginChunk(sub.kind, sub.id);
+			Append(sending_.registers, sizeof(sending_.registers));
+			EndChunk(pos, 0);
+			break;
+		}
+
+		case StreamKind::FRAMEBUFFER:
+			AddFramebuffer(sub, sending_.framebuffer);
+			break;
+		}
+	}
+
+	if (chunkCount_ != 0) {
+		memcpy(&message_[STREAM_CHUNK_COUNT_OFFSET], &chunkCount_, sizeof(chunkCount_));
+		ws->Send(message_);
+	}
+}
+
+size_t WebSocketStreamState::BeginChunk(StreamKind kind, uint32_t id) {
+	size_t pos = message_.size();
+	Append((uint8_t)kind);
+	// Flags and payload size are filled in by EndChunk().
+	Append((uint8_t)0);
+	Append((uint16_t)0);
+	Append(id);
+	Append((uint32_t)0);
+	chunkCount_++;
+	return pos;
+}
+
+void WebSocketStreamState::EndChunk(size_t pos, uint8_t flags) {
+	message_[pos + 1] = flags;
+	uint32_t payloadSize = (uint32_t)(message_.size() - pos - STREAM_CHUNK_HEADER_SIZE);
+	memcpy(&message_[pos + 8], &payloadSize, sizeof(payloadSize));
+}
+
+bool WebSocketStreamState::AddMemory(const StreamSubscription &sub, const uint8_t *data) {
+	if (sub.onChange) {
+		std::vector<uint8_t> &last = lastMemory_[sub.id];
+		if (last.size() == sub.size && memcmp(last.data(), data, sub.size) == 0)
+			return false;
+		last.assign(data, data + sub.size);
+	}
+
+	size_t pos = BeginChunk(sub.kind, sub.id);
+	Append(sub.address);
+	Append(data, sub.size);
+	EndChunk(pos, 0);
+	return true;
+}
+
+bool WebSocketStreamState::AddFramebuffer(const StreamSubscription &sub, const GPUDebugBuffer &buf) {
+	const uint32_t width = buf.GetStride();
+	const uint32_t height = buf.GetHeight();
+	const uint32_t pixelSize = buf.PixelSize();
+	const uint32_t rowBytes = width * pixelSize;
+	const uint8_t *pixels = buf.GetData();
+	const size_t totalBytes = (size_t)rowBytes * height;
+
+	StreamFramebufferHistory &last = lastFramebuffer_[sub.id];
+	const bool keyframe = last.width != width || last.height != height || last.format != buf.GetFormat() || last.pixels.size() != totalBytes;
+
+	size_t pos = BeginChunk(sub.kind, sub.id);
+	Append((uint16_t)width);
+	Append((uint16_t)height);
+	Append((uint8_t)buf.GetFormat());
+	Append((uint8_t)pixelSize);
+	Append((uint16_t)sub.tileSize);
+	size_t tileCountPos = message_.size();
+	Append((uint32_t)0);
+
+	uint32_t tileCount = 0;
+	for (uint32_t ty = 0; ty * sub.tileSize < height; ++ty) {
+		const uint32_t y = ty * sub.tileSize;
+		const uint32_t h = std::min(sub.tileSize, height - y);
+		for (uint32_t tx = 0; tx * sub.tileSize < width; ++tx) {
+			const uint32_t x = tx * sub.tileSize;
+			const size_t tileRowBytes = std::min(sub.tileSize, width - x) * pixelSize;
+			const size_t offset = (size_t)y * rowBytes + x * pixelSize;
+
+			bool changed = keyframe;
+			for (uint32_t row = 0; row < h && !changed; ++row)
+				changed = memcmp(pixels + offset + row * rowBytes, last.pixels.data() + offset + row * rowBytes, tileRowBytes) != 0;
+			if (!changed)
+				continue;
+
+			Append((uint16_t)tx);
+			Append((uint16_t)ty);
+			for (uint32_t row = 0; row < h; ++row)
+				Append(pixels + offset + row * rowBytes, tileRowBytes);
+			tileCount++;
+		}
+	}
+
+	if (tileCount == 0) {
+		// Nothing changed, so just take the chunk back.
+		message_.resize(pos);
+		chunkCount_--;
+		return false;
+	}
+
+	memcpy(&message_[tileCountPos], &tileCount, sizeof(tileCount));
+	EndChunk(pos, (keyframe ? STREAM_FLAG_KEYFRAME : 0) | (buf.GetFlipped() ? STREAM_FLAG_FLIPPED : 0));
+
+	last.width = width;
+	last.height = height;
+	last.format = buf.GetFormat();
+	last.pixels.assign(pixels, pixels + totalBytes);
+	return true;
+}
+
+bool WebSocketStreamState::Subscribe(DebuggerRequest &req, StreamSubscription &sub) {
+	sub.interval = 1;
+	if (!req.ParamU32("interval", &sub.interval, false, DebuggerParamType::OPTIONAL))
+		return false;
+	if (sub.interval == 0) {
+		req.Fail("Parameter 'interval' must be at least 1");
+		return false;
+	}
+
+	sub.id = nextId_++;
+	{
+		std::lock_guard<std::mutex> guard(pendingLock_);
+		subscriptions_.push_back(sub);
+	}
+
+	JsonWriter &json = req.Respond();
+	json.writeUint("id", sub.id);
+	return true;
+}
+
+// Stream a range of memory each frame (stream.memory)
+//
+// Parameters:
+//  - address: unsigned integer address for the start of the memory range.
+//  - size: unsigned integer specifying size of memory range.
+//  - onChange: optional boolean, true to skip frames where the range didn't change.
+//  - interval: optional unsigned integer, send every this many flips (default 1.)
+//
+// Response (same event name):
+//  - id: unsigned integer identifying the stream in binary messages and for stream.stop.
+//
+// Note: the memory is captured as is, so code may show jit replacements.
+void WebSocketStreamState::StreamMemory(DebuggerRequest &req) {
+	if (!currentDebugMIPS->isAlive() || !Memory::IsActive())
+		return req.Fail("CPU not started");
+
+	StreamSubscription sub{};
+	sub.kind = StreamKind::MEMORY;
+	if (!req.ParamU32("address", &sub.address))
+		return;
+	if (!req.ParamU32("size", &sub.size))
+		return;
+	if (!req.ParamBool("onChange", &sub.onChange, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (!Memory::IsValidAddress(sub.address))
+		return req.Fail("Invalid address");
+	else if (sub.size == 0 || !Memory::IsValidRange(sub.address, sub.size))
+		return req.Fail("Invalid size");
+
+	uint32_t total = sub.size;
+	for (const StreamSubscription &other : subscriptions_) {
+		if (other.kind == StreamKind::MEMORY)
+			total += other.size;
+	}
+	if (total > STREAM_MAX_MEMORY)
+		return req.Fail("Too much memory streamed already");
+
+	Subscribe(req, sub);
+}
+
+// Stream all CPU registers each frame (stream.registers)
+//
+// Parameters:
+//  - interval: optional unsigned integer, send every this many flips (default 1.)
+//
+// Response (same event name):
+//  - id: unsigned integer identifying the stream in binary messages and for stream.stop.
+//
+// Note: the registers are those of the current thread when the flip happens.
+void WebSocketStreamState::StreamRegisters(DebuggerRequest &req) {
+	if (!currentDebugMIPS->isAlive())
+		return req.Fail("CPU not started");
+
+	StreamSubscription sub{};
+	sub.kind = StreamKind::REGISTERS;
+	Subscribe(req, sub);
+}
+
+// Stream changes to the displayed framebuffer each frame (stream.framebuffer)
+//
+// Parameters:
+//  - tileSize: optional unsigned integer, size in pixels of the squares compared (default 32.)
+//  - interval: optional unsigned integer, send every this many flips (default 1.)
+//
+// Response (same event name):
+//  - id: unsigned integer identifying the stream in binary messages and for stream.stop.
+//
+// Note: only tiles that changed since the last one sent are included, after a keyframe.
+void WebSocketStreamState::StreamFramebuffer(DebuggerRequest &req) {
+	if (!currentDebugMIPS->isAlive())
+		return req.Fail("CPU not started");
+
+	StreamSubscription sub{};
+	sub.kind = StreamKind::FRAMEBUFFER;
+	sub.tileSize = 32;
+	if (!req.ParamU32("tileSize", &sub.tileSize, false, DebuggerParamType::OPTIONAL))
+		return;
+	if (sub.tileSize < 8 || sub.tileSize > 512)
+		return req.Fail("Parameter 'tileSize' must be between 8 and 512");
+
+	Subscribe(req, sub);
+}
+
+// Stop one or all streams (stream.stop)
+//
+// Parameters:
+//  - id: optional unsigned integer, the stream to stop.  Omit to stop all of them.
+//
+// Response (same event name) with no extra data.
+void WebSocketStreamState::Stop(DebuggerRequest &req) {
+	uint32_t id = 0;
+	if (!req.ParamU32("id", &id, false, DebuggerParamType::OPTIONAL))
+		return;
+
+	std::lock_guard<std::mutex> guard(pendingLock_);
+	if (id == 0) {
+		subscriptions_.clear();
+		lastMemory_.clear();
+		lastFramebuffer_.clear();
+	} else {
+		auto it = std::find_if(subscriptions_.begin(), subscriptions_.end(), [&](const StreamSubscription &sub) {
+			return sub.id == id;
+		});
+		if (it == subscriptions_.end())
+			return req.Fail("Stream not found");
+		subscriptions_.erase(it);
+		lastMemory_.erase(id);
+		lastFramebuffer_.erase(id);
+	}
+	// Anything already captured would still mention it, so just drop that.
+	hasPending_ = false;
+
+	req.Respond();
+}
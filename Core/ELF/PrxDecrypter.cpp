@@ -4,10 +4,12 @@
 
 extern "C"
 {
+#include "ext/libkirk/AES.h"
 #include "ext/libkirk/kirk_engine.h"
 #include "ext/libkirk/SHA1.h"
 }
 #include "Common/Common.h"
+#include "Common/CPUDetect.h"
 #include "Common/Log.h"
 #include "Common/Swap.h"
 #include "Core/ELF/PrxDecrypter.h"
@@ -1017,6 +1019,7 @@ static int pspDecryptType6(const u8 *inbuf, u8 *outbuf, u32 size)
 
 int pspDecryptPRX(const u8 *inbuf, u8 *outbuf, u32 size, const u8 *seed)
 {
+	AES_set_hw_enabled(cpu_info.bAES);
 	kirk_init();
 
 	// this would be significantly better if we had a log of the tags
@@ -22,6 +22,7 @@
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/TimeUtil.h"
 #include "Core/FileLoaders/CachingFileLoader.h"
+#include "Core/FileLoaders/ReadAheadTrace.h"
 
 // Takes ownership of backend.
 CachingFileLoader::CachingFileLoader(FileLoader *backend)
@@ -93,7 +94,11 @@ size_t CachingFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flag
 			}
 		}
 
-		StartReadAhead(absolutePos + readSize);
+		if (readSize != 0) {
+			const s64 lastPos = absolutePos + readSize - 1;
+			trace_->Record((u32)(absolutePos >> BLOCK_SHIFT), (u32)(lastPos >> BLOCK_SHIFT));
+			StartReadAhead(absolutePos + readSize, lastPos);
+		}
 	}
 
 	return readSize;
@@ -103,6 +108,7 @@ void CachingFileLoader::InitCache() {
 	cacheSize_ = 0;
 	oldestGeneration_ = 0;
 	generation_ = 0;
+	trace_.reset(new ReadAheadTrace(ProxiedFileLoader::GetPath(), filesize_, ".ppra"));
 }
 
 void CachingFileLoader::ShutdownCache() {
@@ -121,6 +127,7 @@ void CachingFileLoader::ShutdownCache() {
 	}
 	blocks_.clear();
 	cacheSize_ = 0;
+	trace_.reset();
 }
 
 size_t CachingFileLoader::ReadFromCache(s64 pos, size_t bytes, void *data) {
@@ -252,7 +259,7 @@ bool CachingFileLoader::MakeCacheSpaceFor(size_t blocks, bool readingAhead) {
 	return true;
 }
 
-void CachingFileLoader::StartReadAhead(s64 pos) {
+void CachingFileLoader::StartReadAhead(s64 pos, s64 lastPos) {
 	std::lock_guard<std::recursive_mutex> guard(blocksMutex_);
 	if (aheadThreadRunning_) {
 		// Already going.
@@ -263,10 +270,14 @@ void CachingFileLoader::StartReadAhead(s64 pos) {
 		return;
 	}
 
+	// Where this game went next from here last time, if it jumped somewhere.
+	u32 predicted[BLOCK_PREDICTED];
+	int predictedCount = trace_->Predict((u32)(lastPos >> BLOCK_SHIFT), predicted, BLOCK_PREDICTED);
+
 	aheadThreadRunning_ = true;
 	if (aheadThread_.joinable())
 		aheadThread_.join();
-	aheadThread_ = std::thread([this, pos] {
+	aheadThread_ = std::thread([this, pos, predicted, predictedCount] {
 		SetCurrentThreadName("FileLoaderReadAhead");
 
 		AndroidJNIThreadContext jniContext;
@@ -280,10 +291,21 @@ void CachingFileLoader::StartReadAhead(s64 pos) {
 			if (block == blocks_.end()) {
 				guard.unlock();
 				SaveIntoCache(i << BLOCK_SHIFT, BLOCK_SIZE * BLOCK_READAHEAD, Flags::NONE, true);
+				guard.lock();
 				break;
 			}
 		}
 
+		for (int i = 0; i < predictedCount; ++i) {
+			const s64 block = predicted[i];
+			if ((block << BLOCK_SHIFT) < filesize_ && blocks_.find(block) == blocks_.end()) {
+				guard.unlock();
+				SaveIntoCache(block << BLOCK_SHIFT, BLOCK_SIZE, Flags::NONE, true);
+				guard.lock();
+			}
+		}
+
+		guard.unlock();
 		aheadThreadRunning_ = false;
 	});
 }
@@ -18,12 +18,15 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <mutex>
 #include <thread>
 
 #include "Common/CommonTypes.h"
 #include "Core/Loaders.h"
 
+class ReadAheadTrace;
+
 class CachingFileLoader : public ProxiedFileLoader {
 public:
 	CachingFileLoader(FileLoader *backend);
@@ -47,7 +50,7 @@ class CachingFileLoader : public ProxiedFileLoader {
 	// Guaranteed to read at least one block into the cache.
 	void SaveIntoCache(s64 pos, size_t bytes, Flags flags, bool readingAhead = false);
 	bool MakeCacheSpaceFor(size_t blocks, bool readingAhead);
-	void StartReadAhead(s64 pos);
+	void StartReadAhead(s64 pos, s64 lastPos);
 
 	enum {
 		BLOCK_SIZE = 65536,
@@ -55,6 +58,8 @@ class CachingFileLoader : public ProxiedFileLoader {
 		MAX_BLOCKS_PER_READ = 16,
 		MAX_BLOCKS_CACHED = 4096, // 256 MB
 		BLOCK_READAHEAD = 4,
+		// Blocks learned from earlier runs to fetch after the sequential ones.
+		BLOCK_PREDICTED = 4,
 	};
 
 	s64 filesize_ = 0;
@@ -75,6 +80,7 @@ class CachingFileLoader : public ProxiedFileLoader {
 	};
 
 	std::map<s64, BlockInfo> blocks_;
+	std::unique_ptr<ReadAheadTrace> trace_;
 	std::recursive_mutex blocksMutex_;
 	bool aheadThreadRunning_ = false;
 	std::thread aheadThread_;
@@ -86,6 +86,10 @@ class DiskCachingFileLoaderCache {
 
 	bool HasData() const;
 
+	// Where the cache for a file goes.  Other per-file caches use the same name with another extension.
+	static Path MakeCacheFilePath(const Path &filename);
+	static std::string MakeCacheFilename(const Path &path);
+
 private:
 	void InitCache(const Path &path);
 	void ShutdownCache();
@@ -99,8 +103,6 @@ class DiskCachingFileLoaderCache {
 	void WriteIndexData(u32 indexPos, BlockInfo &info);
 	s64 GetBlockOffset(u32 block);
 
-	Path MakeCacheFilePath(const Path &filename);
-	std::string MakeCacheFilename(const Path &path);
 	bool LoadCacheFile(const Path &path);
 	void LoadCacheIndex();
 	void CreateCacheFile(const Path &path);
@@ -16,19 +16,28 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <thread>
 
 #include "Common/Log.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ThreadUtil.h"
+#include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/FileLoaders/HTTPFileLoader.h"
 
 HTTPFileLoader::HTTPFileLoader(const ::Path &filename)
-	: url_(filename.ToString()), progress_(&cancel_), filename_(filename) {
+	: url_(filename.ToString()), filename_(filename) {
+	for (int i = 0; i < MAX_CONNECTIONS; ++i)
+		connections_.push_back(std::make_unique<PooledConnection>(&cancel_));
 }
 
 void HTTPFileLoader::Prepare() {
 	std::call_once(preparedFlag_, [this](){
-		client_.SetUserAgent(StringFromFormat("PPSSPP/%s", PPSSPP_GIT_VERSION));
+		for (auto &conn : connections_) {
+			conn->client.SetUserAgent(StringFromFormat("PPSSPP/%s", PPSSPP_GIT_VERSION));
+			conn->client.SetDataTimeout(20.0);
+			conn->client.SetKeepAlive(true);
+		}
 
 		std::vector<std::string> responseHeaders;
 		Url resourceURL = url_;
@@ -42,7 +51,7 @@ void HTTPFileLoader::Prepare() {
 			}
 
 			if (code == 301 || code == 302 || code == 303 || code == 307 || code == 308) {
-				Disconnect();
+				Disconnect(connections_[0].get());
 
 				std::string redirectURL;
 				if (http::GetHeaderValue(responseHeaders, "Location", &redirectURL)) {
@@ -70,13 +79,15 @@ void HTTPFileLoader::Prepare() {
 				// Leave size at 0, invalid.
 				ERROR_LOG(Log::Loader, "HTTP request failed, got %03d for %s", code, filename_.c_str());
 				latestError_ = "Could not connect (invalid response)";
-				Disconnect();
+				Disconnect(connections_[0].get());
 				return;
 			}
 
 			// We got a good, non-redirect response.
 			redirectsLeft = 0;
 			url_ = resourceURL;
+			// The rest resolve url_ when first used.
+			connections_[0]->resolved = true;
 		}
 
 		// TODO: Expire cache via ETag, etc.
@@ -101,8 +112,8 @@ void HTTPFileLoader::Prepare() {
 			}
 		}
 
-		// TODO: Keepalive instead.
-		Disconnect();
+		// The HEAD response had no body to read, so just start over for range requests.
+		Disconnect(connections_[0].get());
 
 		if (!acceptsRange) {
 			WARN_LOG(Log::Loader, "HTTP server did not advertise support for range requests.");
@@ -116,13 +127,15 @@ void HTTPFileLoader::Prepare() {
 }
 
 int HTTPFileLoader::SendHEAD(const Url &url, std::vector<std::string> &responseHeaders) {
+	PooledConnection *conn = connections_[0].get();
+	http::Client &client = conn->client;
 	if (!url.Valid()) {
 		ERROR_LOG(Log::Loader, "HTTP request failed, invalid URL: '%s'", url.ToString().c_str());
 		latestError_ = "Invalid URL";
 		return -400;
 	}
 
-	if (!client_.Resolve(url.Host().c_str(), url.Port())) {
+	if (!client.Resolve(url.Host().c_str(), url.Port())) {
 		ERROR_LOG(Log::Loader, "HTTP request failed, unable to resolve: |%s| port %d", url.Host().c_str(), url.Port());
 		latestError_ = "Could not connect (name not resolved)";
 		return -400;
@@ -130,29 +143,34 @@ int HTTPFileLoader::SendHEAD(const Url &url, std::vector<std::string> &responseH
 
 	double timeout = 20.0;
 
-	client_.SetDataTimeout(timeout);
-	Connect(10.0);
-	if (!connected_) {
+	client.SetDataTimeout(timeout);
+	Connect(conn, 10.0);
+	if (!conn->connected) {
 		ERROR_LOG(Log::Loader, "HTTP request failed, failed to connect: %s port %d (resource: '%s')", url.Host().c_str(), url.Port(), url.Resource().c_str());
 		latestError_ = "Could not connect (refused to connect)";
 		return -400;
 	}
 
 	http::RequestParams req(url.Resource(), "*/*");
-	int err = client_.SendRequest("HEAD", req, nullptr, &progress_);
+	int err = client.SendRequest("HEAD", req, nullptr, &conn->progress);
 	if (err < 0) {
 		ERROR_LOG(Log::Loader, "HTTP request failed, failed to send request: %s port %d", url.Host().c_str(), url.Port());
 		latestError_ = "Could not connect (could not request data)";
-		Disconnect();
+		Disconnect(conn);
 		return -400;
 	}
 
 	net::Buffer readbuf;
-	return client_.ReadResponseHeaders(&readbuf, responseHeaders, &progress_);
+	return client.ReadResponseHeaders(&readbuf, responseHeaders, &conn->progress);
 }
 
 HTTPFileLoader::~HTTPFileLoader() {
-	Disconnect();
+	for (auto &conn : connections_)
+		Disconnect(conn.get());
+
+	if (stats_.requests != 0) {
+		INFO_LOG(Log::Loader, "HTTP reads: %d requests, %lld KB, %0.1f KB/s, %0.1f ms per request", stats_.requests, stats_.bytes / 1024, stats_.bytes / (1024.0 * std::max(stats_.seconds, 0.001)), stats_.seconds * 1000.0 / stats_.requests);
+	}
 }
 
 bool HTTPFileLoader::Exists() {
@@ -178,47 +196,144 @@ Path HTTPFileLoader::GetPath() const {
 	return filename_;
 }
 
+HTTPFileLoader::Stats HTTPFileLoader::GetStats() {
+	std::lock_guard<std::mutex> guard(statsMutex_);
+	return stats_;
+}
+
 size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags) {
 	Prepare();
-	std::lock_guard<std::mutex> guard(readAtMutex_);
 
 	s64 absoluteEnd = std::min(absolutePos + (s64)bytes, filesize_);
 	if (absolutePos >= filesize_ || bytes == 0) {
 		// Read outside of the file or no read at all, just fail immediately.
 		return 0;
 	}
+	bytes = (size_t)(absoluteEnd - absolutePos);
+
+	// Latency dominates, so big reads are split into requests in flight at the same time.
+	const int pieces = (int)std::min(bytes / MIN_PARALLEL_READ, (size_t)MAX_CONNECTIONS);
+	if (pieces <= 1) {
+		return ReadRange(absolutePos, bytes, data);
+	}
+
+	const size_t pieceSize = (bytes + pieces - 1) / pieces;
+	size_t results[MAX_CONNECTIONS]{};
+	std::vector<std::thread> threads;
+	for (int i = 1; i < pieces; ++i) {
+		threads.emplace_back([&, i] {
+			SetCurrentThreadName("HTTPFileLoaderRead");
+			const size_t offset = pieceSize * i;
+			results[i] = ReadRange(absolutePos + offset, std::min(pieceSize, bytes - offset), (u8 *)data + offset);
+		});
+	}
+	results[0] = ReadRange(absolutePos, pieceSize, data);
+	for (std::thread &th : threads)
+		th.join();
+
+	// Only what's contiguous from the start counts.
+	size_t readBytes = 0;
+	for (int i = 0; i < pieces; ++i) {
+		readBytes += results[i];
+		if (results[i] != std::min(pieceSize, bytes - pieceSize * i))
+			break;
+	}
+	return readBytes;
+}
+
+HTTPFileLoader::PooledConnection *HTTPFileLoader::AcquireConnection() {
+	std::unique_lock<std::mutex> guard(connectionsMutex_);
+	while (true) {
+		// Prefer one that's still connected, to skip the handshake.
+		PooledConnection *found = nullptr;
+		for (auto &conn : connections_) {
+			if (!conn->busy && (!found || (conn->connected && !found->connected)))
+				found = conn.get();
+		}
+		if (found) {
+			found->busy = true;
+			return found;
+		}
+		connectionsCond_.wait(guard);
+	}
+}
+
+void HTTPFileLoader::ReleaseConnection(PooledConnection *conn) {
+	std::lock_guard<std::mutex> guard(connectionsMutex_);
+	conn->busy = false;
+	connectionsCond_.notify_one();
+}
+
+size_t HTTPFileLoader::ReadRange(s64 absolutePos, size_t bytes, void *data) {
+	PooledConnection *conn = AcquireConnection();
+	bool retry = false;
+	size_t readBytes = ReadRange(conn, absolutePos, bytes, data, &retry);
+	if (retry) {
+		// The server probably closed the idle connection, so try once more on a new one.
+		readBytes = ReadRange(conn, absolutePos, bytes, data, nullptr);
+	}
+	ReleaseConnection(conn);
+	return readBytes;
+}
+
+size_t HTTPFileLoader::ReadRange(PooledConnection *conn, s64 absolutePos, size_t bytes, void *data, bool *retry) {
+	const s64 absoluteEnd = absolutePos + (s64)bytes;
+	http::Client &client = conn->client;
 
-	Connect(10.0);
-	if (!connected_) {
+	if (!conn->resolved) {
+		if (!client.Resolve(url_.Host().c_str(), url_.Port())) {
+			latestError_ = "Could not connect (name not resolved)";
+			return 0;
+		}
+		conn->resolved = true;
+	}
+
+	const bool reused = conn->connected;
+	Connect(conn, 10.0);
+	if (!conn->connected) {
 		return 0;
 	}
 
+	// Only retry failures that happen before any response, on a connection left open from before.
+	auto failed = [&]() -> size_t {
+		Disconnect(conn);
+		if (reused && retry)
+			*retry = true;
+		else
+			latestError_ = "Invalid response reading data";
+		return 0;
+	};
+
+	const double start = time_now_d();
 	char requestHeaders[4096];
 	// Note that the Range header is *inclusive*.
 	snprintf(requestHeaders, sizeof(requestHeaders),
 		"Range: bytes=%lld-%lld\r\n", absolutePos, absoluteEnd - 1);
 
 	http::RequestParams req(url_.Resource(), "*/*");
-	int err = client_.SendRequest("GET", req, requestHeaders, &progress_);
+	int err = client.SendRequest("GET", req, requestHeaders, &conn->progress);
 	if (err < 0) {
-		latestError_ = "Invalid response reading data";
-		Disconnect();
-		return 0;
+		return failed();
 	}
 
 	net::Buffer readbuf;
 	std::vector<std::string> responseHeaders;
-	int code = client_.ReadResponseHeaders(&readbuf, responseHeaders, &progress_);
+	int code = client.ReadResponseHeaders(&readbuf, responseHeaders, &conn->progress);
+	if (code < 0) {
+		return failed();
+	}
+	const double latency = time_now_d() - start;
 	if (code != 206) {
 		ERROR_LOG(Log::Loader, "HTTP server did not respond with range, received code=%03d", code);
 		latestError_ = "Invalid response reading data";
-		Disconnect();
+		Disconnect(conn);
 		return 0;
 	}
 
 	// TODO: Expire cache via ETag, etc.
 	// We don't support multipart/byteranges responses.
 	bool supportedResponse = false;
+	bool serverCloses = false;
 	for (std::string header : responseHeaders) {
 		if (startsWithNoCase(header, "Content-Range:")) {
 			// TODO: More correctness.  Whitespace can be missing or different.
@@ -234,19 +349,25 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 			} else {
 				ERROR_LOG(Log::Loader, "Unexpected HTTP range response: %s", header.c_str());
 			}
+		} else if (startsWithNoCase(header, "Connection:")) {
+			if (header.find("close") != header.npos || header.find("Close") != header.npos)
+				serverCloses = true;
 		}
 	}
 
 	// TODO: Would be nice to read directly.
 	net::Buffer output;
-	int res = client_.ReadResponseEntity(&readbuf, responseHeaders, &output, &progress_);
+	int res = client.ReadResponseEntity(&readbuf, responseHeaders, &output, &conn->progress);
 	if (res != 0) {
 		ERROR_LOG(Log::Loader, "Unable to read HTTP response entity: %d", res);
 		// Let's take anything we got anyway.  Not worse than returning nothing?
+		serverCloses = true;
 	}
 
-	// TODO: Keepalive instead.
-	Disconnect();
+	// Keep the connection for the next request, unless the response didn't end cleanly.
+	if (serverCloses || !supportedResponse) {
+		Disconnect(conn);
+	}
 
 	if (!supportedResponse) {
 		ERROR_LOG(Log::Loader, "HTTP server did not respond with the range we wanted.");
@@ -254,15 +375,20 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 		return 0;
 	}
 
-	size_t readBytes = output.size();
+	size_t readBytes = std::min(output.size(), bytes);
 	output.Take(readBytes, (char *)data);
-	filepos_ = absolutePos + readBytes;
+
+	std::lock_guard<std::mutex> guard(statsMutex_);
+	stats_.requests++;
+	stats_.bytes += readBytes;
+	stats_.seconds += time_now_d() - start;
+	stats_.lastLatency = latency;
 	return readBytes;
 }
 
-void HTTPFileLoader::Connect(double timeout) {
-	if (!connected_) {
+void HTTPFileLoader::Connect(PooledConnection *conn, double timeout) {
+	if (!conn->connected) {
 		cancel_ = false;
-		connected_ = client_.Connect(3, timeout, &cancel_);
+		conn->connected = conn->client.Connect(3, timeout, &cancel_);
 	}
 }
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -54,29 +56,60 @@ class HTTPFileLoader : public FileLoader {
 		return latestError_;
 	}
 
+	struct Stats {
+		int requests = 0;
+		s64 bytes = 0;
+		// Total time spent on range requests, and time to the headers of the latest one.
+		double seconds = 0.0;
+		double lastLatency = 0.0;
+	};
+	Stats GetStats();
+
 private:
+	// A keep-alive connection.  Each one can have a range request in flight at once.
+	struct PooledConnection {
+		http::Client client;
+		net::RequestProgress progress;
+		bool resolved = false;
+		bool connected = false;
+		bool busy = false;
+
+		PooledConnection(bool *cancel) : progress(cancel) {}
+	};
+
 	void Prepare();
 	int SendHEAD(const Url &url, std::vector<std::string> &responseHeaders);
 
-	void Connect(double timeout);
+	PooledConnection *AcquireConnection();
+	void ReleaseConnection(PooledConnection *conn);
+	size_t ReadRange(s64 absolutePos, size_t bytes, void *data);
+	size_t ReadRange(PooledConnection *conn, s64 absolutePos, size_t bytes, void *data, bool *retry);
 
-	void Disconnect() {
-		if (connected_) {
-			client_.Disconnect();
+	void Connect(PooledConnection *conn, double timeout);
+	void Disconnect(PooledConnection *conn) {
+		if (conn->connected) {
+			conn->client.Disconnect();
 		}
-		connected_ = false;
+		conn->connected = false;
 	}
 
+	enum {
+		MAX_CONNECTIONS = 4,
+		// Reads at least this big are split between connections.
+		MIN_PARALLEL_READ = 256 * 1024,
+	};
+
 	s64 filesize_ = 0;
-	s64 filepos_ = 0;
 	Url url_;
-	http::Client client_;
-	net::RequestProgress progress_;
+	std::vector<std::unique_ptr<PooledConnection>> connections_;
+	std::mutex connectionsMutex_;
+	std::condition_variable connectionsCond_;
 	::Path filename_;
-	bool connected_ = false;
 	bool cancel_ = false;
 	const char *latestError_ = "";
 
+	std::mutex statsMutex_;
+	Stats stats_;
+
 	std::once_flag preparedFlag_;
-	std::mutex readAtMutex_;
 };
@@ -15,12 +15,20 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 
 #include "ppsspp_config.h"
 
 #include "Common/Log.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/FileLoaders/LocalFileLoader.h"
 
 #if PPSSPP_PLATFORM(ANDROID)
@@ -40,6 +48,63 @@
 #include <streams/file_stream.h>
 #endif
 
+#if !defined(HAVE_LIBRETRO_VFS) && !PPSSPP_PLATFORM(SWITCH) && !PPSSPP_PLATFORM(ANDROID)
+#define LOCALFILELOADER_PARALLEL_READS 1
+
+namespace {
+
+// Pieces of one large read.  Whoever gets to a piece first reads it, so the caller never waits on
+// tasks that haven't started yet, even if all the IO threads are busy.
+struct ParallelRead {
+	std::function<size_t(int)> readPiece;
+	std::atomic<int> next{};
+	int pieces = 0;
+	size_t done[LocalFileLoader::MAX_PARALLEL_READS]{};
+
+	std::mutex lock;
+	std::condition_variable cond;
+	int finished = 0;
+
+	// Returns false once every piece is taken.
+	bool ReadNext() {
+		int piece = next++;
+		if (piece >= pieces)
+			return false;
+		size_t result = readPiece(piece);
+		std::lock_guard<std::mutex> guard(lock);
+		done[piece] = result;
+		if (++finished == pieces)
+			cond.notify_all();
+		return true;
+	}
+
+	void WaitAll() {
+		std::unique_lock<std::mutex> guard(lock);
+		cond.wait(guard, [&] { return finished == pieces; });
+	}
+};
+
+class LocalFileReadTask : public Task {
+public:
+	LocalFileReadTask(std::shared_ptr<ParallelRead> read) : read_(std::move(read)) {}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+	TaskPriority Priority() const override {
+		return TaskPriority::HIGH;
+	}
+	void Run() override {
+		read_->ReadNext();
+	}
+
+private:
+	std::shared_ptr<ParallelRead> read_;
+};
+
+}  // namespace
+#endif
+
 #if !defined(_WIN32) && !defined(HAVE_LIBRETRO_VFS)
 
 void LocalFileLoader::DetectSizeFd() {
@@ -82,6 +147,7 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 		fd_ = fd;
 		isOpenedByFd_ = true;
 		DetectSizeFd();
+		TryMap();
 		return;
 	}
 #endif
@@ -119,6 +185,21 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 	filesize_ = end_offset.QuadPart;
 	SetFilePointerEx(handle_, zero, nullptr, FILE_BEGIN);
 #endif // _WIN32
+
+	TryMap();
+}
+
+void LocalFileLoader::TryMap() {
+	// Plain disc images are read a sector at a time, so copying out of a mapping saves lots of syscalls.
+	// Only on 64-bit, a whole image would eat too much of a 32-bit address space.
+#if PPSSPP_ARCH(64BIT) && !defined(HAVE_LIBRETRO_VFS)
+	if (filesize_ == 0 || filename_.GetFileExtension() != ".iso")
+		return;
+	if (mapped_.Open(filename_) && mapped_.size() != filesize_) {
+		WARN_LOG(Log::FileSystem, "Mapped size of %s doesn't match, not using the mapping", filename_.c_str());
+		mapped_.Close();
+	}
+#endif
 }
 
 LocalFileLoader::~LocalFileLoader() {
@@ -177,6 +258,14 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 		return 0;
 	}
 
+	if (mapped_.IsOpen()) {
+		if (absolutePos < 0 || (u64)absolutePos >= filesize_)
+			return 0;
+		const size_t avail = (size_t)std::min((u64)(bytes * count), filesize_ - absolutePos) / bytes;
+		memcpy(data, mapped_.data() + absolutePos, avail * bytes);
+		return avail;
+	}
+
 #if defined(HAVE_LIBRETRO_VFS)
     std::lock_guard<std::mutex> guard(readLock_);
 	filestream_seek(handle_, absolutePos, RETRO_VFS_SEEK_POSITION_START);
@@ -200,18 +289,58 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 		lseek64(fd_, absolutePos, SEEK_SET);
 		return read(fd_, data, bytes * count) / bytes;
 	}
-#elif !defined(_WIN32)
+#else
+	const size_t total = bytes * count;
+	if (total < PARALLEL_READ_SIZE)
+		return ReadPositional(absolutePos, total, data) / bytes;
+
+	// Split large reads so the drive sees several requests at once, which matters a lot for SSDs.
+	const int pieces = (int)std::min(total / (PARALLEL_READ_SIZE / 2), (size_t)MAX_PARALLEL_READS);
+	const size_t pieceSize = (total / pieces + 2047) & ~(size_t)2047;
+	auto pieceBytes = [=](int piece) {
+		return std::min(pieceSize, total - pieceSize * piece);
+	};
+
+	// Data is only written by a piece before it finishes, which is waited for below.
+	std::shared_ptr<ParallelRead> read = std::make_shared<ParallelRead>();
+	read->pieces = pieces;
+	read->readPiece = [=](int piece) {
+		const size_t offset = pieceSize * piece;
+		return ReadPositional(absolutePos + offset, pieceBytes(piece), (u8 *)data + offset);
+	};
+	for (int i = 1; i < pieces; ++i)
+		g_threadManager.EnqueueTask(new LocalFileReadTask(read));
+	while (read->ReadNext())
+		continue;
+	read->WaitAll();
+
+	// Only count up to the first short read, anything after it would be a hole.
+	size_t result = 0;
+	for (int i = 0; i < pieces; ++i) {
+		result += read->done[i];
+		if (read->done[i] != pieceBytes(i))
+			break;
+	}
+	return result / bytes;
+#endif
+}
+
+#ifdef LOCALFILELOADER_PARALLEL_READS
+size_t LocalFileLoader::ReadPositional(s64 absolutePos, size_t size, void *data) {
+#if !defined(_WIN32)
 #if defined(_FILE_OFFSET_BITS) && _FILE_OFFSET_BITS < 64
-	return pread64(fd_, data, bytes * count, absolutePos) / bytes;
+	ssize_t result = pread64(fd_, data, size, absolutePos);
 #else
-	return pread(fd_, data, bytes * count, absolutePos) / bytes;
+	ssize_t result = pread(fd_, data, size, absolutePos);
 #endif
+	return result < 0 ? 0 : (size_t)result;
 #else
-	DWORD read = -1;
+	DWORD read = 0;
 	OVERLAPPED offset = { 0 };
 	offset.Offset = (DWORD)(absolutePos & 0xffffffff);
 	offset.OffsetHigh = (DWORD)((absolutePos & 0xffffffff00000000) >> 32);
-	auto result = ReadFile(handle_, data, (DWORD)(bytes * count), &read, &offset);
-	return result == TRUE ? (size_t)read / bytes : -1;
+	auto result = ReadFile(handle_, data, (DWORD)size, &read, &offset);
+	return result == TRUE ? (size_t)read : 0;
 #endif
 }
+#endif
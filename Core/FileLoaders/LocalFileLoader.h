@@ -20,6 +20,7 @@
 #include <mutex>
 
 #include "Common/CommonTypes.h"
+#include "Common/File/FileUtil.h"
 #include "Common/File/Path.h"
 #include "Core/Loaders.h"
 
@@ -44,8 +45,21 @@ class LocalFileLoader : public FileLoader {
 		return filename_;
 	}
 	size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override;
+	const u8 *MappedData() override {
+		return mapped_.IsOpen() ? mapped_.data() : nullptr;
+	}
+
+	enum {
+		// Reads at least this large are split into pieces read in parallel.
+		PARALLEL_READ_SIZE = 512 * 1024,
+		MAX_PARALLEL_READS = 4,
+	};
 
 private:
+	void TryMap();
+	// Returns bytes read.  Doesn't touch the file position, so safe from any thread.
+	size_t ReadPositional(s64 absolutePos, size_t size, void *data);
+
 #if !defined(_WIN32) && !defined(HAVE_LIBRETRO_VFS)
 	void DetectSizeFd();
 	int fd_ = -1;
@@ -54,6 +68,7 @@ class LocalFileLoader : public FileLoader {
 #endif
 	u64 filesize_ = 0;
 	Path filename_;
+	File::MappedFile mapped_;
 	std::mutex readLock_;
 	bool isOpenedByFd_ = false;
 };
@@ -22,6 +22,7 @@
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/TimeUtil.h"
 #include "Core/FileLoaders/RamCachingFileLoader.h"
+#include "Core/FileLoaders/ReadAheadTrace.h"
 
 // Takes ownership of backend.
 RamCachingFileLoader::RamCachingFileLoader(FileLoader *backend)
@@ -80,6 +81,15 @@ size_t RamCachingFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, F
 			}
 		}
 
+		if (readSize != 0) {
+			const s64 lastPos = absolutePos + readSize - 1;
+			trace_->Record((u32)(absolutePos >> BLOCK_SHIFT), (u32)(lastPos >> BLOCK_SHIFT));
+			// This fills the whole file eventually, but it's best to get where the game goes next first.
+			u32 predicted[BLOCK_PREDICTED];
+			int predictedCount = trace_->Predict((u32)(lastPos >> BLOCK_SHIFT), predicted, BLOCK_PREDICTED);
+			std::lock_guard<std::mutex> guard(blocksMutex_);
+			aheadPredicted_.assign(std::reverse_iterator<u32 *>(predicted + predictedCount), std::reverse_iterator<u32 *>(predicted));
+		}
 		StartReadAhead(absolutePos + readSize);
 	}
 	return readSize;
@@ -95,6 +105,7 @@ void RamCachingFileLoader::InitCache() {
 	}
 	aheadRemaining_ = blockCount;
 	blocks_.resize(blockCount);
+	trace_.reset(new ReadAheadTrace(ProxiedFileLoader::GetPath(), filesize_, ".ppram"));
 }
 
 void RamCachingFileLoader::ShutdownCache() {
@@ -114,6 +125,7 @@ void RamCachingFileLoader::ShutdownCache() {
 		free(cache_);
 		cache_ = nullptr;
 	}
+	trace_.reset();
 }
 
 void RamCachingFileLoader::Cancel() {
@@ -258,6 +270,18 @@ u32 RamCachingFileLoader::NextAheadBlock() {
 	// But next time, start from the beginning again.
 	aheadPos_ = 0;
 
+	if (startFrom < blocks_.size() && blocks_[startFrom] == 0) {
+		return startFrom;
+	}
+	// Then wherever the game jumped to from here last time.
+	while (!aheadPredicted_.empty()) {
+		u32 block = aheadPredicted_.back();
+		aheadPredicted_.pop_back();
+		if (block < blocks_.size() && blocks_[block] == 0) {
+			return block;
+		}
+	}
+
 	for (u32 i = startFrom; i < blocks_.size(); ++i) {
 		if (blocks_[i] == 0) {
 			return i;
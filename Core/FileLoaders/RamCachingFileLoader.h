@@ -18,12 +18,15 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <mutex>
 #include <thread>
 
 #include "Common/CommonTypes.h"
 #include "Core/Loaders.h"
 
+class ReadAheadTrace;
+
 class RamCachingFileLoader : public ProxiedFileLoader {
 public:
 	RamCachingFileLoader(FileLoader *backend);
@@ -55,6 +58,8 @@ class RamCachingFileLoader : public ProxiedFileLoader {
 		BLOCK_SHIFT = 16,
 		MAX_BLOCKS_PER_READ = 16,
 		BLOCK_READAHEAD = 4,
+		// Blocks learned from earlier runs to fill after the next sequential one.
+		BLOCK_PREDICTED = 4,
 	};
 
 	s64 filesize_ = 0;
@@ -64,6 +69,9 @@ class RamCachingFileLoader : public ProxiedFileLoader {
 
 	std::vector<u8> blocks_;
 	std::mutex blocksMutex_;
+	std::unique_ptr<ReadAheadTrace> trace_;
+	// Most likely last.
+	std::vector<u32> aheadPredicted_;
 	u32 aheadRemaining_;
 	s64 aheadPos_;
 	std::thread aheadThread_;
@@ -0,0 +1,161 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Common/File/FileUtil.h"
+#include "Common/Log.h"
+#include "Core/FileLoaders/DiskCachingFileLoader.h"
+#include "Core/FileLoaders/ReadAheadTrace.h"
+#include "Core/System.h"
+
+static const char * const TRACEFILE_MAGIC = "ppssppRA";
+
+ReadAheadTrace::ReadAheadTrace(const Path &path, s64 filesize, const char *extension) : filesize_(filesize) {
+	// For headless, avoid keeping anything around, same as the disk cache.
+	if (PSP_CoreParameter().headLess)
+		return;
+
+	filePath_ = DiskCachingFileLoaderCache::MakeCacheFilePath(path).WithReplacedExtension(".ppdc", extension);
+	if (!Load())
+		jumps_.clear();
+}
+
+ReadAheadTrace::~ReadAheadTrace() {
+	if (dirty_ && !filePath_.empty())
+		Save();
+}
+
+bool ReadAheadTrace::Load() {
+	FILE *fp = File::OpenCFile(filePath_, "rb");
+	if (!fp)
+		return false;
+
+	FileHeader header;
+	bool success = fread(&header, sizeof(header), 1, fp) == 1;
+	// A different size means the file changed, so what we learned is useless.
+	if (!success || memcmp(header.magic, TRACEFILE_MAGIC, sizeof(header.magic)) != 0 || header.version != TRACE_VERSION || header.filesize != filesize_ || header.count > MAX_ENTRIES * MAX_JUMPS) {
+		fclose(fp);
+		return false;
+	}
+
+	std::vector<FileEntry> entries(header.count);
+	if (header.count != 0 && fread(&entries[0], sizeof(FileEntry), entries.size(), fp) != entries.size()) {
+		ERROR_LOG(Log::Loader, "Unable to read read ahead trace: %s", filePath_.c_str());
+		success = false;
+	}
+	fclose(fp);
+
+	if (success) {
+		for (const FileEntry &entry : entries)
+			AddJump(entry.from, entry.to, entry.hits);
+	}
+	return success;
+}
+
+void ReadAheadTrace::Save() {
+	std::vector<FileEntry> entries;
+	entries.reserve(jumps_.size());
+	for (const auto &it : jumps_) {
+		for (const Jump &jump : it.second.next) {
+			if (jump.to == INVALID_BLOCK)
+				break;
+			FileEntry entry;
+			entry.from = it.first;
+			entry.to = jump.to;
+			entry.hits = jump.hits;
+			entries.push_back(entry);
+		}
+	}
+
+	FileHeader header;
+	memcpy(header.magic, TRACEFILE_MAGIC, sizeof(header.magic));
+	header.version = TRACE_VERSION;
+	header.count = (u32)entries.size();
+	header.filesize = filesize_;
+
+	FILE *fp = File::OpenCFile(filePath_, "wb");
+	if (!fp) {
+		ERROR_LOG(Log::Loader, "Unable to create read ahead trace: %s", filePath_.c_str());
+		return;
+	}
+	bool success = fwrite(&header, sizeof(header), 1, fp) == 1;
+	if (success && !entries.empty())
+		success = fwrite(&entries[0], sizeof(FileEntry), entries.size(), fp) == entries.size();
+	fclose(fp);
+
+	if (!success) {
+		ERROR_LOG(Log::Loader, "Unable to write read ahead trace: %s", filePath_.c_str());
+		File::Delete(filePath_);
+	}
+}
+
+void ReadAheadTrace::Record(u32 firstBlock, u32 lastBlock) {
+	std::lock_guard<std::mutex> guard(lock_);
+	// Sequential reads are already handled by the usual read ahead.
+	if (lastBlock_ != INVALID_BLOCK && firstBlock != lastBlock_ && firstBlock != lastBlock_ + 1) {
+		AddJump(lastBlock_, firstBlock, 1);
+		dirty_ = true;
+	}
+	lastBlock_ = lastBlock;
+}
+
+void ReadAheadTrace::AddJump(u32 from, u32 to, u32 hits) {
+	auto it = jumps_.find(from);
+	if (it == jumps_.end()) {
+		if (jumps_.size() >= MAX_ENTRIES)
+			return;
+		it = jumps_.emplace(from, Jumps()).first;
+	}
+
+	Jump *next = it->second.next;
+	u32 pos = 0;
+	while (pos < MAX_JUMPS - 1 && next[pos].to != to && next[pos].to != INVALID_BLOCK)
+		++pos;
+	if (next[pos].to == to) {
+		next[pos].hits = std::min(next[pos].hits + hits, 0xFFFFu);
+	} else {
+		// New, or replacing the least common one.
+		next[pos].to = to;
+		next[pos].hits = std::min(hits, 0xFFFFu);
+	}
+
+	// Keep them sorted, it only ever moves forward.
+	while (pos > 0 && next[pos].hits > next[pos - 1].hits) {
+		std::swap(next[pos], next[pos - 1]);
+		--pos;
+	}
+}
+
+int ReadAheadTrace::Predict(u32 block, u32 *blocks, int maxBlocks) {
+	std::lock_guard<std::mutex> guard(lock_);
+	int count = 0;
+	while (count < maxBlocks) {
+		auto it = jumps_.find(block);
+		if (it == jumps_.end() || it->second.next[0].to == INVALID_BLOCK)
+			break;
+
+		block = it->second.next[0].to;
+		// Stop at loops, they'd just predict the same blocks again.
+		if (std::find(blocks, blocks + count, block) != blocks + count)
+			break;
+		blocks[count++] = block;
+	}
+	return count;
+}
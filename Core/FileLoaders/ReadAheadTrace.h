@@ -0,0 +1,81 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include "Common/CommonTypes.h"
+#include "Common/File/Path.h"
+#include "Common/Swap.h"
+
+// Learns which block a game reads after jumping away from each block, and keeps that per file
+// next to the disk cache.  On later runs the caching loaders prefetch those blocks along with
+// the sequential read ahead, since each miss can be a round trip for remote files.
+// Each loader learns the reads of whatever is above it, so they use separate files by extension.
+class ReadAheadTrace {
+public:
+	ReadAheadTrace(const Path &path, s64 filesize, const char *extension);
+	~ReadAheadTrace();
+
+	// Call for every read the game makes, in blocks of the loader's size.  Only jumps are learned.
+	void Record(u32 firstBlock, u32 lastBlock);
+	// Follows the most common jumps from block.  Returns how many blocks were written.
+	int Predict(u32 block, u32 *blocks, int maxBlocks);
+
+private:
+	bool Load();
+	void Save();
+	void AddJump(u32 from, u32 to, u32 hits);
+
+	enum {
+		TRACE_VERSION = 1,
+		MAX_JUMPS = 4,
+		MAX_ENTRIES = 65536,
+		INVALID_BLOCK = 0xFFFFFFFF,
+	};
+
+	struct Jump {
+		u32 to = INVALID_BLOCK;
+		u32 hits = 0;
+	};
+	// Sorted by hits, most first.
+	struct Jumps {
+		Jump next[MAX_JUMPS];
+	};
+
+	struct FileHeader {
+		char magic[8];
+		u32_le version;
+		u32_le count;
+		s64_le filesize;
+	};
+
+	struct FileEntry {
+		u32_le from;
+		u32_le to;
+		u32_le hits;
+	};
+
+	std::mutex lock_;
+	std::unordered_map<u32, Jumps> jumps_;
+	Path filePath_;
+	s64 filesize_;
+	u32 lastBlock_ = INVALID_BLOCK;
+	bool dirty_ = false;
+};
@@ -18,19 +18,24 @@
 #include <algorithm>
 #include <cstring>
 
+#include "Common/CPUDetect.h"
 #include "Common/Data/Text/I18n.h"
 #include "Common/System/OSD.h"
 #include "Common/Log.h"
 #include "Common/Swap.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Loaders.h"
 #include "Core/FileSystems/BlockDevices.h"
 #include "libchdr/chd.h"
 
+#include <zstd.h>
+
 extern "C"
 {
 #include "zlib.h"
+#include "ext/libkirk/AES.h"
 #include "ext/libkirk/amctrl.h"
 #include "ext/libkirk/kirk_engine.h"
 };
@@ -61,6 +66,8 @@ BlockDevice *constructBlockDevice(FileLoader *fileLoader) {
 			return new NPDRMDemoBlockDevice(fileLoader);
 	} else if (!memcmp(buffer, "MComprHD", 8)) {
 		return new CHDFileBlockDevice(fileLoader);
+	} else if (!memcmp(buffer, "SZST", 4)) {
+		return new SZSTFileBlockDevice(fileLoader);
 	}
 
 	// Should be just a regular ISO file. Let's open it as a plain block device and let the other systems take over.
@@ -75,9 +82,87 @@ void BlockDevice::NotifyReadError() {
 	}
 }
 
+void DecompressedFrameCache::Init(u32 frameSize, size_t maxBytes) {
+	std::lock_guard<std::mutex> guard(lock_);
+	frameSize_ = frameSize;
+	const size_t count = frameSize == 0 ? 0 : std::clamp(maxBytes / frameSize, (size_t)4, (size_t)1024);
+	slots_.clear();
+	entries_.clear();
+	entries_.reserve(count);
+	data_.resize(count * frameSize);
+}
+
+bool DecompressedFrameCache::Read(u32 frame, u32 offset, u32 size, u8 *dest) {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = slots_.find(frame);
+	if (it == slots_.end())
+		return false;
+
+	entries_[it->second].lastUse = ++useCounter_;
+	memcpy(dest, &data_[(size_t)it->second * frameSize_ + offset], size);
+	return true;
+}
+
+void DecompressedFrameCache::Insert(u32 frame, const u8 *data) {
+	std::lock_guard<std::mutex> guard(lock_);
+	if (data_.empty())
+		return;
+
+	int slot;
+	auto it = slots_.find(frame);
+	if (it != slots_.end()) {
+		slot = it->second;
+	} else if (entries_.size() * frameSize_ < data_.size()) {
+		slot = (int)entries_.size();
+		entries_.push_back(Entry{ frame, 0 });
+	} else {
+		// Full, so replace the least recently used.
+		slot = 0;
+		for (int i = 1; i < (int)entries_.size(); ++i) {
+			if (entries_[i].lastUse < entries_[slot].lastUse)
+				slot = i;
+		}
+		slots_.erase(entries_[slot].frame);
+		entries_[slot].frame = frame;
+	}
+
+	slots_[frame] = slot;
+	entries_[slot].lastUse = ++useCounter_;
+	memcpy(&data_[(size_t)slot * frameSize_], data, frameSize_);
+}
+
+bool BlockDevice::ReadBytes(u64 offset, size_t size, u8 *outPtr) {
+	const u32 blockSize = GetBlockSize();
+	const u32 firstBlockOffset = (u32)(offset & (blockSize - 1));
+	const size_t firstBlockSize = firstBlockOffset == 0 ? 0 : std::min(size, (size_t)(blockSize - firstBlockOffset));
+	const size_t lastBlockSize = (size - firstBlockSize) & (blockSize - 1);
+	const size_t middleSize = size - firstBlockSize - lastBlockSize;
+	u32 block = (u32)(offset / blockSize);
+	u8 temp[2048];
+
+	bool success = true;
+	if (firstBlockSize > 0) {
+		success = ReadBlock(block++, temp) && success;
+		memcpy(outPtr, temp + firstBlockOffset, firstBlockSize);
+		outPtr += firstBlockSize;
+	}
+	if (middleSize > 0) {
+		const u32 blocks = (u32)(middleSize / blockSize);
+		success = ReadBlocks(block, blocks, outPtr) && success;
+		block += blocks;
+		outPtr += middleSize;
+	}
+	if (lastBlockSize > 0) {
+		success = ReadBlock(block, temp) && success;
+		memcpy(outPtr, temp, lastBlockSize);
+	}
+	return success;
+}
+
 FileBlockDevice::FileBlockDevice(FileLoader *fileLoader)
 	: BlockDevice(fileLoader) {
 	filesize_ = fileLoader->FileSize();
+	mapped_ = fileLoader->MappedData();
 }
 
 FileBlockDevice::~FileBlockDevice() {
@@ -103,6 +188,17 @@ bool FileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 	return true;
 }
 
+bool FileBlockDevice::ReadBytes(u64 offset, size_t size, u8 *outPtr) {
+	// Nothing to decode, so even partial blocks can be read right where they're wanted.
+	size_t retval = fileLoader_->ReadAt(offset, size, outPtr);
+	if (retval != size) {
+		ERROR_LOG(Log::FileSystem, "Could not read %d bytes, at offset %lld. Only got %d bytes", (int)size, (long long)offset, (int)retval);
+		memset(outPtr + retval, 0, size - retval);
+		return false;
+	}
+	return true;
+}
+
 // .CSO format
 
 // compressed ISO(9660) header format
@@ -132,6 +228,34 @@ typedef struct ciso_header
 // TODO: Need much better error handling.
 
 static const u32 CSO_READ_BUFFER_SIZE = 256 * 1024;
+// Decompressed frames or hunks kept around for later reads, per device.
+static const size_t DECOMPRESSED_CACHE_SIZE = 2 * 1024 * 1024;
+
+// Inflates a whole raw deflate frame, logging any error.  Safe to call from any thread.
+static bool InflateFrame(const u8 *src, u32 srcSize, u8 *dest, u32 frameSize, u32 frame) {
+	z_stream z{};
+	if (inflateInit2(&z, -15) != Z_OK) {
+		ERROR_LOG(Log::Loader, "Unable to initialize inflate: %s\n", (z.msg) ? z.msg : "?");
+		return false;
+	}
+
+	z.avail_in = srcSize;
+	z.next_in = (Bytef *)src;
+	z.avail_out = frameSize;
+	z.next_out = dest;
+
+	bool success = true;
+	int status = inflate(&z, Z_FINISH);
+	if (status != Z_STREAM_END) {
+		ERROR_LOG(Log::Loader, "Inflate frame %d: failed - %s[%d]\n", frame, (z.msg) ? z.msg : "error", status);
+		success = false;
+	} else if (z.total_out != frameSize) {
+		ERROR_LOG(Log::Loader, "Inflate frame %d: block size error %d != %d\n", frame, (u32)z.total_out, frameSize);
+		success = false;
+	}
+	inflateEnd(&z);
+	return success;
+}
 
 CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 	: BlockDevice(fileLoader)
@@ -170,7 +294,7 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 	else
 		readBuffer = new u8[frameSize + (1 << indexShift)];
 	zlibBuffer = new u8[frameSize + (1 << indexShift)];
-	zlibBufferFrame = numFrames;
+	cache_.Init(frameSize, DECOMPRESSED_CACHE_SIZE);
 
 	const u32 indexSize = numFrames + 1;
 	const size_t headerEnd = hdr.ver > 1 ? (size_t)hdr.header_size : sizeof(hdr);
@@ -228,7 +352,6 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	const u32 idx = index[frameNumber];
 	const u32 indexPos = idx & 0x7FFFFFFF;
 	const u32 nextIndexPos = index[frameNumber + 1] & 0x7FFFFFFF;
-	z_stream z{};
 
 	const u64 compressedReadPos = (u64)indexPos << indexShift;
 	const u64 compressedReadEnd = (u64)nextIndexPos << indexShift;
@@ -244,46 +367,24 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 		int readSize = (u32)fileLoader_->ReadAt(compressedReadPos + compressedOffset, 1, GetBlockSize(), outPtr, flags);
 		if (readSize < GetBlockSize())
 			memset(outPtr + readSize, 0, GetBlockSize() - readSize);
-	} else if (zlibBufferFrame == frameNumber) {
-		// We already have it.  Just apply the offset and copy.
-		memcpy(outPtr, zlibBuffer + compressedOffset, GetBlockSize());
+	} else if (cache_.Read(frameNumber, compressedOffset, GetBlockSize(), outPtr)) {
+		// Already decompressed by an earlier read.
 	} else {
+		std::lock_guard<std::mutex> guard(readLock_);
 		const u32 readSize = (u32)fileLoader_->ReadAt(compressedReadPos, 1, compressedReadSize, readBuffer, flags);
 
-		z.zalloc = Z_NULL;
-		z.zfree = Z_NULL;
-		z.opaque = Z_NULL;
-		if (inflateInit2(&z, -15) != Z_OK) {
-			ERROR_LOG(Log::Loader, "GetBlockSize() ERROR: %s\n", (z.msg) ? z.msg : "?");
-			NotifyReadError();
-			return false;
-		}
-		z.avail_in = readSize;
-		z.next_out = frameSize == (u32)GetBlockSize() ? outPtr : zlibBuffer;
-		z.avail_out = frameSize;
-		z.next_in = readBuffer;
-
-		int status = inflate(&z, Z_FINISH);
-		if (status != Z_STREAM_END) {
-			ERROR_LOG(Log::Loader, "block %d: inflate : %s[%d]\n", blockNumber, (z.msg) ? z.msg : "error", status);
-			NotifyReadError();
-			inflateEnd(&z);
-			memset(outPtr, 0, GetBlockSize());
-			return false;
-		}
-		if (z.total_out != frameSize) {
-			ERROR_LOG(Log::Loader, "block %d: block size error %d != %d\n", blockNumber, (u32)z.total_out, frameSize);
+		u8 *frameBuffer = frameSize == (u32)GetBlockSize() ? outPtr : zlibBuffer;
+		if (!InflateFrame(readBuffer, readSize, frameBuffer, frameSize, frameNumber)) {
 			NotifyReadError();
-			inflateEnd(&z);
 			memset(outPtr, 0, GetBlockSize());
 			return false;
 		}
-		inflateEnd(&z);
 
-		if (frameSize != (u32)GetBlockSize()) {
-			zlibBufferFrame = frameNumber;
+		// Keep it for neighboring blocks, unless this is a one-off read like hashing the whole disc.
+		if (!uncached)
+			cache_.Insert(frameNumber, frameBuffer);
+		if (frameBuffer != outPtr)
 			memcpy(outPtr, zlibBuffer + compressedOffset, GetBlockSize());
-		}
 	}
 	return true;
 }
@@ -308,12 +409,47 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 	const u32 afterLastIndexPos = index[lastFrameNumber + 1] & 0x7FFFFFFF;
 	const u64 totalReadEnd = (u64)afterLastIndexPos << indexShift;
 
-	z_stream z{};
-	if (inflateInit2(&z, -15) != Z_OK) {
-		ERROR_LOG(Log::Loader, "Unable to initialize inflate: %s\n", (z.msg) ? z.msg : "?");
-		return false;
-	}
+	// Compressed frames are queued up and inflated in parallel, which is most of the work.
+	struct FrameJob {
+		u32 frame;
+		const u8 *src;
+		u32 srcSize;
+		// Either out, or a temporary for a frame only partly read, copied to out after.
+		u8 *dest;
+		u8 *out;
+		u32 offset;
+		u32 size;
+		bool success;
+	};
+	std::vector<FrameJob> jobs;
+	// Only the first and last frames can be partial.
+	std::unique_ptr<u8[]> partialBuffer;
+	int partialFrames = 0;
+
+	auto inflateJobs = [&]() {
+		if (jobs.size() > 1) {
+			ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+				for (int i = lower; i < upper; ++i)
+					jobs[i].success = InflateFrame(jobs[i].src, jobs[i].srcSize, jobs[i].dest, frameSize, jobs[i].frame);
+			}, 0, (int)jobs.size(), 1);
+		} else if (jobs.size() == 1) {
+			jobs[0].success = InflateFrame(jobs[0].src, jobs[0].srcSize, jobs[0].dest, frameSize, jobs[0].frame);
+		}
 
+		for (const FrameJob &job : jobs) {
+			if (!job.success) {
+				NotifyReadError();
+				memset(job.out, 0, job.size);
+			} else if (job.dest != job.out) {
+				memcpy(job.out, job.dest + job.offset, job.size);
+				// In case we end up reusing it in a single read later.
+				cache_.Insert(job.frame, job.dest);
+			}
+		}
+		jobs.clear();
+	};
+
+	std::lock_guard<std::mutex> guard(readLock_);
 	u64 readBufferStart = 0;
 	u64 readBufferEnd = 0;
 	u32 block = minBlock;
@@ -330,6 +466,9 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 		const u32 frameBlocks = std::min(lastBlock - block + 1, blocksPerFrame - frameBlockOffset);
 
 		if (frameReadEnd > readBufferEnd) {
+			// Queued frames point into the read buffer, so finish them first.
+			inflateJobs();
+
 			const s64 maxNeeded = totalReadEnd - frameReadPos;
 			const size_t chunkSize = (size_t)std::min(maxNeeded, (s64)std::max(frameReadSize, CSO_READ_BUFFER_SIZE));
 
@@ -344,40 +483,265 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 
 		u8 *rawBuffer = &readBuffer[frameReadPos - readBufferStart];
 		const int plain = idx & 0x80000000;
+		const u32 offset = frameBlockOffset * GetBlockSize();
+		const u32 size = frameBlocks * GetBlockSize();
 		if (plain) {
-			memcpy(outPtr, rawBuffer + frameBlockOffset * GetBlockSize(), frameBlocks * GetBlockSize());
-		} else {
-			z.avail_in = frameReadSize;
-			z.next_out = frameBlocks == blocksPerFrame ? outPtr : zlibBuffer;
-			z.avail_out = frameSize;
-			z.next_in = rawBuffer;
-
-			int status = inflate(&z, Z_FINISH);
-			if (status != Z_STREAM_END) {
-				ERROR_LOG(Log::Loader, "Inflate frame %d: failed - %s[%d]\n", frame, (z.msg) ? z.msg : "error", status);
-				NotifyReadError();
-				memset(outPtr, 0, frameBlocks * GetBlockSize());
-			} else if (z.total_out != frameSize) {
-				ERROR_LOG(Log::Loader, "Inflate frame %d: block size error %d != %d\n", frame, (u32)z.total_out, frameSize);
-				NotifyReadError();
-				memset(outPtr, 0, frameBlocks * GetBlockSize());
-			} else if (frameBlocks != blocksPerFrame) {
-				memcpy(outPtr, zlibBuffer + frameBlockOffset * GetBlockSize(), frameBlocks * GetBlockSize());
-				// In case we end up reusing it in a single read later.
-				zlibBufferFrame = frame;
+			memcpy(outPtr, rawBuffer + offset, size);
+		} else if (!cache_.Read(frame, offset, size, outPtr)) {
+			u8 *dest = outPtr;
+			if (frameBlocks != blocksPerFrame) {
+				if (!partialBuffer)
+					partialBuffer.reset(new u8[frameSize * 2]);
+				dest = partialBuffer.get() + frameSize * partialFrames++;
 			}
-
-			inflateReset(&z);
+			jobs.push_back(FrameJob{ frame, rawBuffer, frameReadSize, dest, outPtr, offset, size, false });
 		}
 
 		block += frameBlocks;
-		outPtr += frameBlocks * GetBlockSize();
+		outPtr += size;
 	}
 
-	inflateEnd(&z);
+	inflateJobs();
+	return true;
+}
+
+SZSTFileBlockDevice::SZSTFileBlockDevice(FileLoader *fileLoader)
+	: BlockDevice(fileLoader) {
+	SZSTHeader hdr;
+	if (fileLoader->ReadAt(0, sizeof(hdr), 1, &hdr) != 1 || memcmp(hdr.magic, "SZST", 4) != 0) {
+		ERROR_LOG(Log::Loader, "Invalid SZST!");
+		NotifyReadError();
+		return;
+	}
+	if (hdr.version > SZST_VERSION) {
+		WARN_LOG(Log::Loader, "SZST version too high!");
+	}
+
+	frameSize_ = hdr.frameSize;
+	if ((frameSize_ & (frameSize_ - 1)) != 0 || frameSize_ < 0x800 || frameSize_ > 0x1000000) {
+		ERROR_LOG(Log::Loader, "SZST frame size %i unsupported", frameSize_);
+		NotifyReadError();
+		frameSize_ = 0;
+		return;
+	}
+	for (u32 i = frameSize_; i > 0x800; i >>= 1)
+		++blockShift_;
+
+	totalBytes_ = hdr.totalBytes;
+	numFrames_ = (u32)((totalBytes_ + frameSize_ - 1) / frameSize_);
+	numBlocks_ = (u32)(totalBytes_ / GetBlockSize());
+	cache_.Init(frameSize_, DECOMPRESSED_CACHE_SIZE);
+
+	std::vector<u64_le> index(numFrames_ + 1);
+	const u64 indexPos = hdr.headerSize;
+	if (fileLoader->ReadAt(indexPos, sizeof(u64_le), index.size(), &index[0]) != index.size()) {
+		ERROR_LOG(Log::Loader, "SZST index truncated");
+		NotifyReadError();
+		numBlocks_ = 0;
+		return;
+	}
+	index_.assign(index.begin(), index.end());
+
+	if (hdr.dictSize != 0) {
+		std::vector<u8> dict(hdr.dictSize);
+		const u64 dictPos = indexPos + index.size() * sizeof(u64_le);
+		if (fileLoader->ReadAt(dictPos, 1, dict.size(), &dict[0]) == dict.size())
+			dict_ = ZSTD_createDDict(&dict[0], dict.size());
+		if (!dict_) {
+			ERROR_LOG(Log::Loader, "SZST dictionary unreadable");
+			NotifyReadError();
+		}
+	}
+
+	const u64 expectedFileSize = index_[numFrames_] & ~SZST_INDEX_PLAIN;
+	if (expectedFileSize > (u64)fileLoader->FileSize()) {
+		ERROR_LOG(Log::Loader, "Expected SZST to at least be %lld bytes, but file is %lld bytes. File: '%s'",
+			expectedFileSize, fileLoader->FileSize(), fileLoader->GetPath().c_str());
+		NotifyReadError();
+	}
+	VERBOSE_LOG(Log::Loader, "SZST numBlocks=%i numFrames=%i dict=%i", numBlocks_, numFrames_, (int)hdr.dictSize);
+}
+
+SZSTFileBlockDevice::~SZSTFileBlockDevice() {
+	for (ZSTD_DCtx *ctx : contexts_)
+		ZSTD_freeDCtx(ctx);
+	ZSTD_freeDDict(dict_);
+}
+
+ZSTD_DCtx *SZSTFileBlockDevice::AcquireContext() {
+	{
+		std::lock_guard<std::mutex> guard(contextLock_);
+		if (!contexts_.empty()) {
+			ZSTD_DCtx *ctx = contexts_.back();
+			contexts_.pop_back();
+			return ctx;
+		}
+	}
+	return ZSTD_createDCtx();
+}
+
+void SZSTFileBlockDevice::ReleaseContext(ZSTD_DCtx *ctx) {
+	std::lock_guard<std::mutex> guard(contextLock_);
+	contexts_.push_back(ctx);
+}
+
+bool SZSTFileBlockDevice::DecompressFrame(const u8 *src, size_t srcSize, u8 *dest, u32 frame) {
+	// Only the last frame can be short, the rest of it reads as zeros.
+	const u64 frameStart = (u64)frame * frameSize_;
+	const size_t expected = (size_t)std::min((u64)frameSize_, totalBytes_ - frameStart);
+
+	ZSTD_DCtx *ctx = AcquireContext();
+	if (!ctx)
+		return false;
+	size_t result;
+	if (dict_)
+		result = ZSTD_decompress_usingDDict(ctx, dest, frameSize_, src, srcSize, dict_);
+	else
+		result = ZSTD_decompressDCtx(ctx, dest, frameSize_, src, srcSize);
+	ReleaseContext(ctx);
+
+	if (ZSTD_isError(result) || result != expected) {
+		ERROR_LOG(Log::Loader, "SZST: Frame %d failed to decompress: %s", frame, ZSTD_isError(result) ? ZSTD_getErrorName(result) : "wrong size");
+		return false;
+	}
+	if (expected < frameSize_)
+		memset(dest + expected, 0, frameSize_ - expected);
 	return true;
 }
 
+bool SZSTFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
+	FileLoader::Flags flags = uncached ? FileLoader::Flags::HINT_UNCACHED : FileLoader::Flags::NONE;
+	if ((u32)blockNumber >= numBlocks_) {
+		memset(outPtr, 0, GetBlockSize());
+		return false;
+	}
+
+	const u32 frame = blockNumber >> blockShift_;
+	const u32 offset = (blockNumber & ((1 << blockShift_) - 1)) * GetBlockSize();
+	const u64 pos = index_[frame] & ~SZST_INDEX_PLAIN;
+	const u64 end = index_[frame + 1] & ~SZST_INDEX_PLAIN;
+
+	if (index_[frame] & SZST_INDEX_PLAIN) {
+		size_t readSize = fileLoader_->ReadAt(pos + offset, 1, GetBlockSize(), outPtr, flags);
+		if (readSize < (size_t)GetBlockSize())
+			memset(outPtr + readSize, 0, GetBlockSize() - readSize);
+		return true;
+	}
+	if (cache_.Read(frame, offset, GetBlockSize(), outPtr))
+		return true;
+
+	std::vector<u8> compressed((size_t)(end - pos));
+	const size_t readSize = fileLoader_->ReadAt(pos, 1, compressed.size(), compressed.data(), flags);
+	std::unique_ptr<u8[]> frameBuffer(new u8[frameSize_]);
+	if (!DecompressFrame(compressed.data(), readSize, frameBuffer.get(), frame)) {
+		NotifyReadError();
+		memset(outPtr, 0, GetBlockSize());
+		return false;
+	}
+
+	// Keep it for neighboring blocks, unless this is a one-off read like hashing the whole disc.
+	if (!uncached)
+		cache_.Insert(frame, frameBuffer.get());
+	memcpy(outPtr, frameBuffer.get() + offset, GetBlockSize());
+	return true;
+}
+
+bool SZSTFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
+	if (count == 1) {
+		return ReadBlock(minBlock, outPtr);
+	}
+	if (minBlock >= numBlocks_) {
+		memset(outPtr, 0, GetBlockSize() * count);
+		return false;
+	}
+
+	const u32 lastBlock = std::min(minBlock + count, numBlocks_) - 1;
+	const u32 readBlocks = lastBlock + 1 - minBlock;
+	if (readBlocks < (u32)count) {
+		memset(outPtr + GetBlockSize() * readBlocks, 0, GetBlockSize() * (count - readBlocks));
+	}
+
+	// The frames are contiguous, so it's all one read.
+	const u32 minFrame = minBlock >> blockShift_;
+	const u32 lastFrame = lastBlock >> blockShift_;
+	const u64 readStart = index_[minFrame] & ~SZST_INDEX_PLAIN;
+	const u64 readEnd = index_[lastFrame + 1] & ~SZST_INDEX_PLAIN;
+	std::vector<u8> compressed((size_t)(readEnd - readStart));
+	const size_t readSize = fileLoader_->ReadAt(readStart, 1, compressed.size(), compressed.data());
+	if (readSize < compressed.size())
+		memset(&compressed[readSize], 0, compressed.size() - readSize);
+
+	struct FrameJob {
+		u32 frame;
+		const u8 *src;
+		size_t srcSize;
+		// Either out, or a temporary for a frame only partly read, copied to out after.
+		u8 *dest;
+		u8 *out;
+		u32 offset;
+		u32 size;
+		bool success;
+	};
+	std::vector<FrameJob> jobs;
+	// Only the first and last frames can be partial.
+	std::unique_ptr<u8[]> partialBuffer;
+	int partialFrames = 0;
+
+	const u32 blocksPerFrame = 1 << blockShift_;
+	u32 block = minBlock;
+	for (u32 frame = minFrame; frame <= lastFrame; ++frame) {
+		const u64 pos = index_[frame] & ~SZST_INDEX_PLAIN;
+		const u64 end = index_[frame + 1] & ~SZST_INDEX_PLAIN;
+		const u8 *src = &compressed[(size_t)(pos - readStart)];
+		const u32 frameBlockOffset = block & (blocksPerFrame - 1);
+		const u32 frameBlocks = std::min(lastBlock - block + 1, blocksPerFrame - frameBlockOffset);
+		const u32 offset = frameBlockOffset * GetBlockSize();
+		const u32 size = frameBlocks * GetBlockSize();
+
+		if (index_[frame] & SZST_INDEX_PLAIN) {
+			// The last frame may be stored short.
+			const size_t stored = (size_t)(end - pos);
+			const size_t copySize = offset < stored ? std::min((size_t)size, stored - offset) : 0;
+			memcpy(outPtr, src + offset, copySize);
+			memset(outPtr + copySize, 0, size - copySize);
+		} else if (!cache_.Read(frame, offset, size, outPtr)) {
+			u8 *dest = outPtr;
+			if (frameBlocks != blocksPerFrame) {
+				if (!partialBuffer)
+					partialBuffer.reset(new u8[frameSize_ * 2]);
+				dest = partialBuffer.get() + frameSize_ * partialFrames++;
+			}
+			jobs.push_back(FrameJob{ frame, src, (size_t)(end - pos), dest, outPtr, offset, size, false });
+		}
+
+		block += frameBlocks;
+		outPtr += size;
+	}
+
+	auto decompressJobs = [&](int lower, int upper) {
+		for (int i = lower; i < upper; ++i)
+			jobs[i].success = DecompressFrame(jobs[i].src, jobs[i].srcSize, jobs[i].dest, jobs[i].frame);
+	};
+	if (jobs.size() > 1)
+		ParallelRangeLoop(&g_threadManager, decompressJobs, 0, (int)jobs.size(), 1);
+	else
+		decompressJobs(0, (int)jobs.size());
+
+	bool success = true;
+	for (const FrameJob &job : jobs) {
+		if (!job.success) {
+			NotifyReadError();
+			memset(job.out, 0, job.size);
+			success = false;
+		} else if (job.dest != job.out) {
+			memcpy(job.out, job.dest + job.offset, job.size);
+			// In case we end up reusing it in a single read later.
+			cache_.Insert(job.frame, job.dest);
+		}
+	}
+	return success;
+}
+
 NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 	: BlockDevice(fileLoader)
 {
@@ -404,6 +768,7 @@ NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 		return;
 	}
 
+	AES_set_hw_enabled(cpu_info.bAES);
 	kirk_init();
 
 	// getkey
@@ -438,7 +803,9 @@ NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 	blockSize_ = blockLBAs_ * 2048;
 	numBlocks_ = (lbaSize_ + blockLBAs_-1) / blockLBAs_; // total blocks;
 
-	blockBuf_ = new u8[blockSize_];
+	// Keep about a megabyte of decrypted blocks around.
+	numCachedBlocks_ = std::clamp(0x00100000 / blockSize_, 1, (int)MAX_CACHED_BLOCKS);
+	blockBuf_ = new u8[blockSize_ * numCachedBlocks_];
 	tempBuf_  = new u8[blockSize_];
 
 	tableOffset_ = *(u32*)(np_header+0x6c); // table offset
@@ -465,7 +832,8 @@ NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 		p += 8;
 	}
 
-	currentBlock_ = -1;
+	for (int i = 0; i < MAX_CACHED_BLOCKS; i++)
+		cachedBlock_[i] = -1;
 }
 
 NPDRMDemoBlockDevice::~NPDRMDemoBlockDevice() {
@@ -486,15 +854,27 @@ bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 		return false;
 	}
 
-	int lba = blockNumber - currentBlock_;
-	if (lba >= 0 && lba < blockLBAs_){
-		memcpy(outPtr, blockBuf_ + lba*2048, 2048);
-		return true;
+	int block = blockNumber / blockLBAs_;
+	int lba = blockNumber % blockLBAs_;
+
+	int slot = 0;
+	for (int i = 0; i < numCachedBlocks_; i++) {
+		if (cachedBlock_[i] == block) {
+			cachedBlockAge_[i] = ++cacheAge_;
+			memcpy(outPtr, blockBuf_ + (size_t)i * blockSize_ + lba * 2048, 2048);
+			return true;
+		}
+		if (cachedBlockAge_[i] < cachedBlockAge_[slot])
+			slot = i;
 	}
 
-	int block = blockNumber / blockLBAs_;
-	lba = blockNumber % blockLBAs_;
-	currentBlock_ = block * blockLBAs_;
+	// Evict the least recently used block. Only mark it valid again once fully decoded.
+	u8 *slotBuf = blockBuf_ + (size_t)slot * blockSize_;
+	cachedBlock_[slot] = -1;
+
+	if ((u32)block >= numBlocks_) {
+		return false;
+	}
 
 	if (table_[block].unk_1c != 0) {
 		if((u32)block == (numBlocks_ - 1))
@@ -507,7 +887,7 @@ bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	if (table_[block].size < blockSize_)
 		readBuf = tempBuf_;
 	else
-		readBuf = blockBuf_;
+		readBuf = slotBuf;
 
 	size_t readSize = fileLoader_->ReadAt(psarOffset+table_[block].offset, 1, table_[block].size, readBuf, flags);
 	if (readSize != (size_t)table_[block].size){
@@ -529,7 +909,7 @@ bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	}
 
 	if (table_[block].size < blockSize_) {
-		int lzsize = lzrc_decompress(blockBuf_, 0x00100000, readBuf, table_[block].size);
+		int lzsize = lzrc_decompress(slotBuf, blockSize_, readBuf, table_[block].size);
 		if(lzsize!=blockSize_){
 			ERROR_LOG(Log::Loader, "LZRC decompress error! lzsize=%d\n", lzsize);
 			NotifyReadError();
@@ -537,7 +917,9 @@ bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 		}
 	}
 
-	memcpy(outPtr, blockBuf_+lba*2048, 2048);
+	cachedBlock_[slot] = block;
+	cachedBlockAge_[slot] = ++cacheAge_;
+	memcpy(outPtr, slotBuf + lba * 2048, 2048);
 	return true;
 }
 
@@ -661,7 +1043,7 @@ CHDFileBlockDevice::CHDFileBlockDevice(FileLoader *fileLoader)
 	impl_->header = chd_get_header(impl_->chd);
 
 	readBuffer = new u8[impl_->header->hunkbytes];
-	currentHunk = -1;
+	cache_.Init(impl_->header->hunkbytes, DECOMPRESSED_CACHE_SIZE);
 	blocksPerHunk = impl_->header->hunkbytes / impl_->header->unitbytes;
 	numBlocks = impl_->header->unitcount;
 }
@@ -684,16 +1066,23 @@ bool CHDFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
 	}
 	u32 hunk = blockNumber / blocksPerHunk;
 	u32 blockInHunk = blockNumber % blocksPerHunk;
+	return ReadHunk(hunk, blockInHunk * impl_->header->unitbytes, GetBlockSize(), outPtr);
+}
 
-	if (currentHunk != hunk) {
-		chd_error err = chd_read(impl_->chd, hunk, readBuffer);
-		if (err != CHDERR_NONE) {
-			ERROR_LOG(Log::Loader, "CHD read failed: %d %d %s", blockNumber, hunk, chd_error_string(err));
-			NotifyReadError();
-		}
-		currentHunk = hunk;
+bool CHDFileBlockDevice::ReadHunk(u32 hunk, u32 offset, u32 size, u8 *outPtr) {
+	if (cache_.Read(hunk, offset, size, outPtr))
+		return true;
+
+	// libchdr keeps decoder state per file, so hunks can't be decompressed in parallel.
+	std::lock_guard<std::mutex> guard(readLock_);
+	chd_error err = chd_read(impl_->chd, hunk, readBuffer);
+	if (err != CHDERR_NONE) {
+		ERROR_LOG(Log::Loader, "CHD read failed: %d %s", hunk, chd_error_string(err));
+		NotifyReadError();
+	} else {
+		cache_.Insert(hunk, readBuffer);
 	}
-	memcpy(outPtr, readBuffer + blockInHunk * impl_->header->unitbytes, GetBlockSize());
+	memcpy(outPtr, readBuffer + offset, size);
 	return true;
 }
 
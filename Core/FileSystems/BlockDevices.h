@@ -19,15 +19,45 @@
 
 // Abstractions around read-only blockdevices, such as PSP UMD discs.
 // CISOFileBlockDevice implements compressed iso images, CISO format.
+// SZSTFileBlockDevice implements seekable zstd images, see SZSTHeader.
 //
 // The ISOFileSystemReader reads from a BlockDevice, so it automatically works
 // with CISO images.
 
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Swap.h"
 
 class FileLoader;
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
+// Small LRU cache of decompressed frames (CSO) or hunks (CHD).
+// Safe to use from several threads at once, so every reader of a device shares it.
+class DecompressedFrameCache {
+public:
+	void Init(u32 frameSize, size_t maxBytes);
+
+	// Copies size bytes at offset from a cached frame.  Returns false if it isn't cached.
+	bool Read(u32 frame, u32 offset, u32 size, u8 *dest);
+	void Insert(u32 frame, const u8 *data);
+
+private:
+	struct Entry {
+		u32 frame;
+		u32 lastUse;
+	};
+
+	std::mutex lock_;
+	std::unordered_map<u32, int> slots_;
+	std::vector<Entry> entries_;
+	std::vector<u8> data_;
+	u32 frameSize_ = 0;
+	u32 useCounter_ = 0;
+};
 
 class BlockDevice {
 public:
@@ -43,12 +73,19 @@ class BlockDevice {
 		}
 		return true;
 	}
+	// Reads a range that doesn't need to be block aligned, straight into outPtr as far as possible.
+	// Only partial blocks at either end go through a temporary block.
+	virtual bool ReadBytes(u64 offset, size_t size, u8 *outPtr);
 	int GetBlockSize() const { return 2048;}  // forced, it cannot be changed by subclasses
 	virtual u32 GetNumBlocks() const = 0;
 	virtual u64 GetUncompressedSize() const {
 		return (u64)GetNumBlocks() * (u64)GetBlockSize();
 	}
 	virtual bool IsDisc() const = 0;
+	// The whole uncompressed image, if it's mapped into memory.  Reads may copy straight out of it.
+	virtual const u8 *MappedData() const {
+		return nullptr;
+	}
 
 	void NotifyReadError();
 
@@ -67,10 +104,12 @@ class CISOFileBlockDevice : public BlockDevice {
 	bool IsDisc() const override { return true; }
 
 private:
+	// Guards readBuffer, the cache is safe on its own.
+	std::mutex readLock_;
+	DecompressedFrameCache cache_;
 	u32 *index = nullptr;
 	u8 *readBuffer = nullptr;
 	u8 *zlibBuffer = nullptr;
-	u32 zlibBufferFrame = 0;
 	u8 indexShift = 0;
 	u8 blockShift = 0;
 	u32 frameSize = 0;
@@ -86,13 +125,18 @@ class FileBlockDevice : public BlockDevice {
 	~FileBlockDevice();
 	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
 	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
+	bool ReadBytes(u64 offset, size_t size, u8 *outPtr) override;
 	u32 GetNumBlocks() const override {return (u32)(filesize_ / GetBlockSize());}
 	bool IsDisc() const override { return true; }
 	u64 GetUncompressedSize() const override {
 		return filesize_;
 	}
+	const u8 *MappedData() const override {
+		return mapped_;
+	}
 private:
 	u64 filesize_;
+	const u8 *mapped_;
 };
 
 
@@ -130,11 +174,64 @@ class NPDRMDemoBlockDevice : public BlockDevice {
 	u8 hkey[16]{};
 	struct table_info *table_ = nullptr;
 
-	int currentBlock_ = 0;
+	// Recently decrypted (and decompressed) blocks. Games often stream from a few places at once,
+	// which made a single block buffer redo the decryption over and over.
+	enum { MAX_CACHED_BLOCKS = 16 };
+	int numCachedBlocks_ = 0;
+	int cachedBlock_[MAX_CACHED_BLOCKS];
+	u32 cachedBlockAge_[MAX_CACHED_BLOCKS]{};
+	u32 cacheAge_ = 0;
 	u8 *blockBuf_ = nullptr;
 	u8 *tempBuf_ = nullptr;
 };
 
+// Seekable zstd image (.szst.)  Every frame is a separate zstd frame, so any frame can be
+// decompressed on its own, and in parallel.  Layout, all little endian:
+//   SZSTHeader
+//   u64 index[numFrames + 1]: file offset of each frame, top bit set if stored uncompressed.
+//   dictionary, dictSize bytes, shared by all frames (optional.)
+//   frames
+struct SZSTHeader {
+	char magic[4];  // SZST
+	u32_le headerSize;
+	u64_le totalBytes;
+	u32_le frameSize;  // Power of two, at least one sector.
+	u32_le dictSize;
+	u32_le version;
+	u32_le reserved;
+};
+
+static const u32 SZST_VERSION = 1;
+static const u64 SZST_INDEX_PLAIN = 0x8000000000000000ULL;
+
+class SZSTFileBlockDevice : public BlockDevice {
+public:
+	SZSTFileBlockDevice(FileLoader *fileLoader);
+	~SZSTFileBlockDevice();
+	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
+	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
+	u32 GetNumBlocks() const override { return numBlocks_; }
+	bool IsDisc() const override { return true; }
+	u64 GetUncompressedSize() const override { return totalBytes_; }
+
+private:
+	bool DecompressFrame(const u8 *src, size_t srcSize, u8 *dest, u32 frame);
+	ZSTD_DCtx_s *AcquireContext();
+	void ReleaseContext(ZSTD_DCtx_s *ctx);
+
+	DecompressedFrameCache cache_;
+	std::vector<u64> index_;
+	ZSTD_DDict_s *dict_ = nullptr;
+	// Contexts aren't thread safe, so each decompression borrows one.
+	std::mutex contextLock_;
+	std::vector<ZSTD_DCtx_s *> contexts_;
+	u64 totalBytes_ = 0;
+	u32 frameSize_ = 0;
+	u32 blockShift_ = 0;
+	u32 numBlocks_ = 0;
+	u32 numFrames_ = 0;
+};
+
 struct CHDImpl;
 
 struct ExtendedCoreFile;
@@ -148,10 +245,14 @@ class CHDFileBlockDevice : public BlockDevice {
 	u32 GetNumBlocks() const override { return numBlocks; }
 	bool IsDisc() const override { return true; }
 private:
+	bool ReadHunk(u32 hunk, u32 offset, u32 size, u8 *outPtr);
+
 	struct ExtendedCoreFile *core_file_ = nullptr;
 	std::unique_ptr<CHDImpl> impl_;
+	// Guards chd_read() and readBuffer, the cache is safe on its own.
+	std::mutex readLock_;
+	DecompressedFrameCache cache_;
 	u8 *readBuffer = nullptr;
-	u32 currentHunk = 0;
 	u32 blocksPerHunk = 0;
 	u32 numBlocks = 0;
 };
@@ -25,8 +25,12 @@
 #endif
 
 #include <algorithm>
+#include <condition_variable>
 #include <ctime>
+#include <deque>
+#include <functional>
 #include <limits>
+#include <mutex>
 
 #include "Common/Data/Text/I18n.h"
 #include "Common/Data/Encoding/Utf8.h"
@@ -38,6 +42,8 @@
 #include "Common/File/DiskFree.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/SysError.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Common/TimeUtil.h"
 #include "Core/FileSystems/DirectoryFileSystem.h"
 #include "Core/HLE/sceKernel.h"
 #include "Core/HW/MemoryStick.h"
@@ -69,12 +75,91 @@
 #include <fcntl.h>
 #endif
 
+namespace {
+
+// Memory stick writes run in order on an IO task, since the host can stall for a long time (SD cards,
+// Android's storage framework.)  The emulated timing doesn't change, the game just doesn't wait on the host.
+class WriteBehindQueue {
+public:
+	void Enqueue(std::function<void()> op, size_t bytes);
+	void WaitIdle();
+	void Drain();
+
+private:
+	// Past this, writers wait so a game can't queue up unlimited memory.
+	static const size_t MAX_PENDING_BYTES = 16 * 1024 * 1024;
+
+	std::mutex lock_;
+	std::condition_variable cond_;
+	std::deque<std::pair<std::function<void()>, size_t>> ops_;
+	size_t pendingBytes_ = 0;
+	bool running_ = false;
+};
+
+class WriteBehindTask : public Task {
+public:
+	WriteBehindTask(WriteBehindQueue *queue) : queue_(queue) {}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+	TaskPriority Priority() const override {
+		return TaskPriority::NORMAL;
+	}
+	void Run() override {
+		queue_->Drain();
+	}
+
+private:
+	WriteBehindQueue *queue_;
+};
+
+void WriteBehindQueue::Enqueue(std::function<void()> op, size_t bytes) {
+	std::unique_lock<std::mutex> guard(lock_);
+	cond_.wait(guard, [&] { return pendingBytes_ == 0 || pendingBytes_ + bytes <= MAX_PENDING_BYTES; });
+	ops_.emplace_back(std::move(op), bytes);
+	pendingBytes_ += bytes;
+	if (!running_) {
+		running_ = true;
+		guard.unlock();
+		g_threadManager.EnqueueTask(new WriteBehindTask(this));
+	}
+}
+
+void WriteBehindQueue::WaitIdle() {
+	std::unique_lock<std::mutex> guard(lock_);
+	cond_.wait(guard, [&] { return !running_; });
+}
+
+void WriteBehindQueue::Drain() {
+	std::unique_lock<std::mutex> guard(lock_);
+	while (!ops_.empty()) {
+		auto op = std::move(ops_.front());
+		ops_.pop_front();
+		guard.unlock();
+		op.first();
+		guard.lock();
+		pendingBytes_ -= op.second;
+		cond_.notify_all();
+	}
+	running_ = false;
+	cond_.notify_all();
+}
+
+WriteBehindQueue g_writeBehind;
+
+}  // namespace
+
 DirectoryFileSystem::DirectoryFileSystem(IHandleAllocator *_hAlloc, const Path & _basePath, FileSystemFlags _flags) : basePath(_basePath), flags(_flags) {
 	File::CreateFullPath(basePath);
 	hAlloc = _hAlloc;
 }
 
 DirectoryFileSystem::~DirectoryFileSystem() {
+	if (preload_) {
+		preload_->BlockUntilReady();
+		delete preload_;
+	}
 	CloseAll();
 }
 
@@ -301,12 +386,15 @@ bool DirectoryFileHandle::Open(const Path &basePath, std::string &fileName, File
 	if (access & (FILEACCESS_APPEND | FILEACCESS_CREATE | FILEACCESS_WRITE)) {
 		MemoryStick_NotifyWrite();
 	}
+	// Appends would need the host's idea of the end, so they stay synchronous.
+	writeBehind_ = success && (fileSystemFlags_ & FileSystemFlags::CARD) && (access & FILEACCESS_WRITE) && !(access & FILEACCESS_APPEND);
 
 	return success;
 }
 
 size_t DirectoryFileHandle::Read(u8* pointer, s64 size)
 {
+	FlushWrites();
 	size_t bytesRead = 0;
 	if (needsTrunc_ != -1) {
 		// If the file was marked to be truncated, pretend there's nothing.
@@ -329,25 +417,88 @@ size_t DirectoryFileHandle::Read(u8* pointer, s64 size)
 	return replay_ ? ReplayApplyDiskRead(pointer, (uint32_t)bytesRead, (uint32_t)size, inGameDir_, CoreTiming::GetGlobalTimeUs()) : bytesRead;
 }
 
-size_t DirectoryFileHandle::Write(const u8* pointer, s64 size)
-{
-	size_t bytesWritten = 0;
-	bool diskFull = false;
-
 #ifdef _WIN32
+static size_t HostWrite(HANDLE hFile, const u8 *pointer, s64 size, bool *diskFull) {
+	size_t bytesWritten = 0;
 	BOOL success = ::WriteFile(hFile, (LPVOID)pointer, (DWORD)size, (LPDWORD)&bytesWritten, 0);
 	if (success == FALSE) {
 		DWORD err = GetLastError();
-		diskFull = err == ERROR_DISK_FULL || err == ERROR_NOT_ENOUGH_QUOTA;
+		*diskFull = err == ERROR_DISK_FULL || err == ERROR_NOT_ENOUGH_QUOTA;
 	}
+	return bytesWritten;
+}
 #else
-	bytesWritten = write(hFile, pointer, size);
+static size_t HostWrite(int hFile, const u8 *pointer, s64 size, bool *diskFull) {
+	size_t bytesWritten = write(hFile, pointer, size);
 	if (bytesWritten == (size_t)-1) {
-		diskFull = errno == ENOSPC;
+		*diskFull = errno == ENOSPC;
 	}
+	return bytesWritten;
+}
 #endif
+
+s64 DirectoryFileHandle::HostPosition() const {
+#ifdef _WIN32
+	LARGE_INTEGER distance{};
+	LARGE_INTEGER cursor{};
+	SetFilePointerEx(hFile, distance, &cursor, FILE_CURRENT);
+	return cursor.QuadPart;
+#else
+	return lseek(hFile, 0, SEEK_CUR);
+#endif
+}
+
+size_t DirectoryFileHandle::Tell() {
+	if (writeBehindPos_ < 0)
+		return Seek(0, FILEMOVE_CURRENT);
+	// Same as a seek, without waiting for the writes.
+	return replay_ ? (size_t)ReplayApplyDisk64(ReplayAction::FILE_SEEK, writeBehindPos_, CoreTiming::GetGlobalTimeUs()) : (size_t)writeBehindPos_;
+}
+
+void DirectoryFileHandle::FlushWrites() {
+	if (writeBehindPos_ >= 0) {
+		g_writeBehind.WaitIdle();
+		writeBehindPos_ = -1;
+	}
+}
+
+void DirectoryFileHandle::WaitForAllWrites() {
+	g_writeBehind.WaitIdle();
+}
+
+size_t DirectoryFileHandle::Write(const u8* pointer, s64 size)
+{
+	size_t bytesWritten = 0;
+	bool diskFull = false;
+
+	if (writeBehind_ && size > 0) {
+		// Nothing is pending when this is unset, so the host knows where we are.
+		if (writeBehindPos_ < 0)
+			writeBehindPos_ = HostPosition();
+		writeBehindPos_ += size;
+
+		// We can't know if the disk will be full, but it's only shown as a message anyway.
+		std::vector<u8> data(pointer, pointer + size);
+		auto file = hFile;
+		g_writeBehind.Enqueue([file, data = std::move(data)] {
+			bool full = false;
+			size_t written = HostWrite(file, data.data(), (s64)data.size(), &full);
+			if (written != data.size()) {
+				ERROR_LOG(Log::FileSystem, "Delayed write failed, wrote %d of %d bytes", (int)written, (int)data.size());
+				if (full) {
+					auto err = GetI18NCategory(I18NCat::ERRORS);
+					g_OSD.Show(OSDType::MESSAGE_ERROR, err->T("Disk full while writing data"), 0.0f, "diskfull");
+				}
+			}
+		}, (size_t)size);
+		bytesWritten = (size_t)size;
+	} else {
+		FlushWrites();
+		bytesWritten = HostWrite(hFile, pointer, size, &diskFull);
+	}
+
 	if (needsTrunc_ != -1) {
-		off_t off = (off_t)Seek(0, FILEMOVE_CURRENT);
+		off_t off = (off_t)Tell();
 		if (needsTrunc_ < off) {
 			needsTrunc_ = off;
 		}
@@ -379,6 +530,7 @@ size_t DirectoryFileHandle::Write(const u8* pointer, s64 size)
 
 size_t DirectoryFileHandle::Seek(s32 position, FileMove type)
 {
+	FlushWrites();
 	if (needsTrunc_ != -1) {
 		// If the file is "currently truncated" move to the end based on that position.
 		// The actual, underlying file hasn't been truncated (yet.)
@@ -415,28 +567,53 @@ size_t DirectoryFileHandle::Seek(s32 position, FileMove type)
 	return replay_ ? (size_t)ReplayApplyDisk64(ReplayAction::FILE_SEEK, result, CoreTiming::GetGlobalTimeUs()) : result;
 }
 
-void DirectoryFileHandle::Close()
-{
-	if (needsTrunc_ != -1) {
 #ifdef _WIN32
-		Seek((s32)needsTrunc_, FILEMOVE_BEGIN);
+static void HostClose(HANDLE hFile, s64 truncateAt) {
+	if (truncateAt != -1) {
+		LARGE_INTEGER distance;
+		distance.QuadPart = truncateAt;
+		SetFilePointerEx(hFile, distance, nullptr, FILE_BEGIN);
 		if (SetEndOfFile(hFile) == 0) {
 			ERROR_LOG_REPORT(Log::FileSystem, "Failed to truncate file.");
 		}
-#elif !PPSSPP_PLATFORM(SWITCH)
-		// Note: it's not great that Switch cannot truncate appropriately...
-		if (ftruncate(hFile, (off_t)needsTrunc_) != 0) {
-			ERROR_LOG_REPORT(Log::FileSystem, "Failed to truncate file.");
-		}
-#endif
 	}
-#ifdef _WIN32
 	if (hFile != (HANDLE)-1)
 		CloseHandle(hFile);
+}
 #else
+static void HostClose(int hFile, s64 truncateAt) {
+	// Note: it's not great that Switch cannot truncate appropriately...
+#if !PPSSPP_PLATFORM(SWITCH)
+	if (truncateAt != -1) {
+		if (ftruncate(hFile, (off_t)truncateAt) != 0) {
+			ERROR_LOG_REPORT(Log::FileSystem, "Failed to truncate file.");
+		}
+	}
+#endif
 	if (hFile != -1)
 		close(hFile);
+}
+#endif
+
+void DirectoryFileHandle::Close()
+{
+#ifdef _WIN32
+	// Truncating used to go through Seek(), keep replays in sync with that.
+	if (needsTrunc_ != -1 && replay_)
+		ReplayApplyDisk64(ReplayAction::FILE_SEEK, needsTrunc_, CoreTiming::GetGlobalTimeUs());
 #endif
+
+	if (writeBehindPos_ >= 0) {
+		// Closes after the writes, and everything waits for that before looking at the file again.
+		auto file = hFile;
+		s64 truncateAt = needsTrunc_;
+		g_writeBehind.Enqueue([file, truncateAt] {
+			HostClose(file, truncateAt);
+		}, 0);
+		writeBehindPos_ = -1;
+	} else {
+		HostClose(hFile, needsTrunc_);
+	}
 }
 
 void DirectoryFileSystem::CloseAll() {
@@ -445,9 +622,11 @@ void DirectoryFileSystem::CloseAll() {
 		iter->second.hFile.Close();
 	}
 	entries.clear();
+	DirectoryFileHandle::WaitForAllWrites();
 }
 
 bool DirectoryFileSystem::MkDir(const std::string &dirname) {
+	DirectoryFileHandle::WaitForAllWrites();
 	bool result;
 #if HOST_IS_CASE_SENSITIVE
 	// Must fix case BEFORE attempting, because MkDir would create
@@ -461,16 +640,20 @@ bool DirectoryFileSystem::MkDir(const std::string &dirname) {
 #else
 	result = File::CreateFullPath(GetLocalPath(dirname));
 #endif
+	// This may create parents too, so just start over.
+	ClearCache();
 	MemoryStick_NotifyWrite();
 	return ReplayApplyDisk(ReplayAction::MKDIR, result, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
 bool DirectoryFileSystem::RmDir(const std::string &dirname) {
+	DirectoryFileHandle::WaitForAllWrites();
 	Path fullName = GetLocalPath(dirname);
 
 #if HOST_IS_CASE_SENSITIVE
 	// Maybe we're lucky?
 	if (File::DeleteDirRecursively(fullName)) {
+		ClearCache();
 		MemoryStick_NotifyWrite();
 		return (bool)ReplayApplyDisk(ReplayAction::RMDIR, true, CoreTiming::GetGlobalTimeUs());
 	}
@@ -484,11 +667,13 @@ bool DirectoryFileSystem::RmDir(const std::string &dirname) {
 #endif
 
 	bool result = File::DeleteDirRecursively(fullName);
+	ClearCache();
 	MemoryStick_NotifyWrite();
 	return ReplayApplyDisk(ReplayAction::RMDIR, result, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
 int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &to) {
+	DirectoryFileHandle::WaitForAllWrites();
 	std::string fullTo = to;
 
 	// Rename ignores the path (even if specified) on to.
@@ -532,11 +717,14 @@ int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &
 
 	// TODO: Better error codes.
 	int result = retValue ? 0 : (int)SCE_KERNEL_ERROR_ERRNO_FILE_ALREADY_EXISTS;
+	// Could be a directory, which moves everything under it.
+	ClearCache();
 	MemoryStick_NotifyWrite();
 	return ReplayApplyDisk(ReplayAction::FILE_RENAME, result, CoreTiming::GetGlobalTimeUs());
 }
 
 bool DirectoryFileSystem::RemoveFile(const std::string &filename) {
+	DirectoryFileHandle::WaitForAllWrites();
 	Path localPath = GetLocalPath(filename);
 
 	bool retValue = File::Delete(localPath);
@@ -554,11 +742,13 @@ bool DirectoryFileSystem::RemoveFile(const std::string &filename) {
 	}
 #endif
 
+	InvalidateCache(GetLocalPath(filename));
 	MemoryStick_NotifyWrite();
 	return ReplayApplyDisk(ReplayAction::FILE_REMOVE, retValue, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
 int DirectoryFileSystem::OpenFile(std::string filename, FileAccess access, const char *devicename) {
+	DirectoryFileHandle::WaitForAllWrites();
 	OpenFileEntry entry;
 	entry.hFile.fileSystemFlags_ = flags;
 	u32 err = 0;
@@ -567,6 +757,11 @@ int DirectoryFileSystem::OpenFile(std::string filename, FileAccess access, const
 		err = SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
 	}
 
+	if (access & (FILEACCESS_APPEND | FILEACCESS_CREATE | FILEACCESS_WRITE | FILEACCESS_TRUNCATE)) {
+		// After opening, so nothing can cache how it looked before.
+		InvalidateCache(GetLocalPath(filename));
+	}
+
 	err = ReplayApplyDisk(ReplayAction::FILE_OPEN, err, CoreTiming::GetGlobalTimeUs());
 	if (err != 0) {
 		std::string errorString;
@@ -605,6 +800,10 @@ void DirectoryFileSystem::CloseFile(u32 handle) {
 	if (iter != entries.end()) {
 		hAlloc->FreeHandle(handle);
 		iter->second.hFile.Close();
+		// Closing may truncate.
+		if (iter->second.access & (FILEACCESS_APPEND | FILEACCESS_WRITE)) {
+			InvalidateCache(GetLocalPath(iter->second.guestFilename));
+		}
 		entries.erase(iter);
 	} else {
 		//This shouldn't happen...
@@ -656,6 +855,7 @@ size_t DirectoryFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size, i
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter != entries.end()) {
 		size_t bytesWritten = iter->second.hFile.Write(pointer,size);
+		InvalidateCache(GetLocalPath(iter->second.guestFilename));
 		return bytesWritten;
 	} else {
 		//This shouldn't happen...
@@ -675,24 +875,35 @@ size_t DirectoryFileSystem::SeekFile(u32 handle, s32 position, FileMove type) {
 	}
 }
 
+bool DirectoryFileSystem::HostGetFileInfo(std::string filename, File::FileInfo *info) const {
+	Path fullName = GetLocalPath(filename);
+	if (File::GetFileInfo(fullName, info))
+		return true;
+#if HOST_IS_CASE_SENSITIVE
+	if (!FixPathCase(basePath, filename, FPC_FILE_MUST_EXIST))
+		return false;
+	fullName = GetLocalPath(filename);
+	return File::GetFileInfo(fullName, info);
+#else
+	return false;
+#endif
+}
+
 PSPFileInfo DirectoryFileSystem::GetFileInfo(std::string filename) {
+	DirectoryFileHandle::WaitForAllWrites();
 	PSPFileInfo x;
 	x.name = filename;
 
 	File::FileInfo info;
-	Path fullName = GetLocalPath(filename);
-	if (!File::GetFileInfo(fullName, &info)) {
-#if HOST_IS_CASE_SENSITIVE
-		if (! FixPathCase(basePath, filename, FPC_FILE_MUST_EXIST))
-			return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
-		fullName = GetLocalPath(filename);
-
-		if (!File::GetFileInfo(fullName, &info))
-			return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
-#else
-		return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
-#endif
+	const Path localPath = GetLocalPath(filename);
+	bool found;
+	if (!LookupCachedInfo(localPath, &info, &found)) {
+		const u32 generation = CacheGeneration();
+		found = HostGetFileInfo(filename, &info);
+		StoreCachedInfo(CacheKey(localPath), generation, found, info);
 	}
+	if (!found)
+		return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
 
 	x.type = info.isDirectory ? FILETYPE_DIRECTORY : FILETYPE_NORMAL;
 	x.exists = true;
@@ -786,6 +997,7 @@ static std::string SimulateVFATBug(std::string filename) {
 }
 
 bool DirectoryFileSystem::ComputeRecursiveDirSizeIfFast(const std::string &path, int64_t *size) {
+	DirectoryFileHandle::WaitForAllWrites();
 	Path localPath = GetLocalPath(path);
 
 	int64_t sizeTemp = File::ComputeRecursiveDirectorySize(localPath);
@@ -797,13 +1009,10 @@ bool DirectoryFileSystem::ComputeRecursiveDirSizeIfFast(const std::string &path,
 	}
 }
 
-std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(const std::string &path, bool *exists) {
-	std::vector<PSPFileInfo> myVector;
-
-	std::vector<File::FileInfo> files;
+bool DirectoryFileSystem::HostGetDirListing(const std::string &path, std::vector<File::FileInfo> *files) const {
 	Path localPath = GetLocalPath(path);
 	const int flags = File::GETFILES_GETHIDDEN | File::GETFILES_GET_NAVIGATION_ENTRIES;
-	bool success = File::GetFilesInDir(localPath, &files, nullptr, flags);
+	bool success = File::GetFilesInDir(localPath, files, nullptr, flags);
 #if HOST_IS_CASE_SENSITIVE
 	if (!success) {
 		// TODO: Case sensitivity should be checked on a file system basis, right?
@@ -811,10 +1020,25 @@ std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(const std::string &p
 		if (FixPathCase(basePath, fixedPath, FPC_FILE_MUST_EXIST)) {
 			// May have failed due to case sensitivity, try again
 			localPath = GetLocalPath(fixedPath);
-			success = File::GetFilesInDir(localPath, &files, nullptr, flags);
+			success = File::GetFilesInDir(localPath, files, nullptr, flags);
 		}
 	}
 #endif
+	return success;
+}
+
+std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(const std::string &path, bool *exists) {
+	DirectoryFileHandle::WaitForAllWrites();
+	std::vector<PSPFileInfo> myVector;
+
+	std::vector<File::FileInfo> files;
+	const std::string key = CacheKey(GetLocalPath(path));
+	bool success;
+	if (!LookupCachedListing(key, &files, &success)) {
+		const u32 generation = CacheGeneration();
+		success = HostGetDirListing(path, &files);
+		StoreCachedListing(key, generation, success, files);
+	}
 	if (!success) {
 		if (exists)
 			*exists = false;
@@ -832,7 +1056,7 @@ std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(const std::string &p
 			entry.name = file.name;
 		}
 		if (hideISOFiles) {
-			if (endsWithNoCase(entry.name, ".cso") || endsWithNoCase(entry.name, ".iso") || endsWithNoCase(entry.name, ".chd")) {  // chd not really necessary, but let's hide them too.
+			if (endsWithNoCase(entry.name, ".cso") || endsWithNoCase(entry.name, ".iso") || endsWithNoCase(entry.name, ".chd") || endsWithNoCase(entry.name, ".szst")) {  // chd not really necessary, but let's hide them too.
 				// Workaround for DJ Max Portable, see compat.ini.
 				continue;
 			} else if (file.isDirectory) {
@@ -873,7 +1097,118 @@ std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(const std::string &p
 	return ReplayApplyDiskListing(myVector, CoreTiming::GetGlobalTimeUs());
 }
 
+// Long enough for a savedata screen, short enough to notice changes made outside the game.
+static const double CACHE_EXPIRE_SECONDS = 10.0;
+
+std::string DirectoryFileSystem::CacheKey(const Path &localPath) {
+	std::string key = localPath.ToString();
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	return key;
+}
+
+bool DirectoryFileSystem::LookupCachedInfo(const Path &localPath, File::FileInfo *info, bool *found) {
+	const double expired = time_now_d() - CACHE_EXPIRE_SECONDS;
+	const std::string key = CacheKey(localPath);
+
+	std::lock_guard<std::mutex> guard(cacheLock_);
+	auto it = infoCache_.find(key);
+	if (it != infoCache_.end() && it->second.time > expired) {
+		*found = it->second.found;
+		*info = it->second.info;
+		return true;
+	}
+
+	// A listing of the parent answers this too, which is what makes listing then checking each file fast.
+	if (!localPath.CanNavigateUp())
+		return false;
+	auto listing = listingCache_.find(CacheKey(localPath.NavigateUp()));
+	if (listing == listingCache_.end() || listing->second.time <= expired)
+		return false;
+
+	*found = false;
+	if (listing->second.found) {
+		const std::string name = localPath.GetFilename();
+		for (const File::FileInfo &file : listing->second.files) {
+			if (file.name != "." && file.name != ".." && equalsNoCase(file.name, name)) {
+				*info = file;
+				*found = true;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+bool DirectoryFileSystem::LookupCachedListing(const std::string &key, std::vector<File::FileInfo> *files, bool *found) {
+	std::lock_guard<std::mutex> guard(cacheLock_);
+	auto it = listingCache_.find(key);
+	if (it == listingCache_.end() || it->second.time <= time_now_d() - CACHE_EXPIRE_SECONDS)
+		return false;
+	*found = it->second.found;
+	*files = it->second.files;
+	return true;
+}
+
+void DirectoryFileSystem::StoreCachedInfo(const std::string &key, u32 generation, bool found, const File::FileInfo &info) {
+	std::lock_guard<std::mutex> guard(cacheLock_);
+	if (generation == cacheGeneration_)
+		infoCache_[key] = CachedInfo{ time_now_d(), found, info };
+}
+
+void DirectoryFileSystem::StoreCachedListing(const std::string &key, u32 generation, bool found, const std::vector<File::FileInfo> &files) {
+	std::lock_guard<std::mutex> guard(cacheLock_);
+	if (generation == cacheGeneration_)
+		listingCache_[key] = CachedListing{ time_now_d(), found, files };
+}
+
+void DirectoryFileSystem::InvalidateCache(const Path &localPath) {
+	const std::string key = CacheKey(localPath);
+	const std::string parentKey = localPath.CanNavigateUp() ? CacheKey(localPath.NavigateUp()) : std::string();
+
+	std::lock_guard<std::mutex> guard(cacheLock_);
+	cacheGeneration_++;
+	infoCache_.erase(key);
+	listingCache_.erase(key);
+	if (!parentKey.empty())
+		listingCache_.erase(parentKey);
+}
+
+void DirectoryFileSystem::ClearCache() {
+	std::lock_guard<std::mutex> guard(cacheLock_);
+	cacheGeneration_++;
+	infoCache_.clear();
+	listingCache_.clear();
+}
+
+u32 DirectoryFileSystem::CacheGeneration() {
+	std::lock_guard<std::mutex> guard(cacheLock_);
+	return cacheGeneration_;
+}
+
+void DirectoryFileSystem::PreloadCache(const std::string &path, const std::string &prefix) {
+	if (preload_)
+		return;
+
+	preload_ = Promise<bool>::Spawn(&g_threadManager, [this, path, prefix]() {
+		const u32 generation = CacheGeneration();
+		std::vector<File::FileInfo> files;
+		bool found = HostGetDirListing(path, &files);
+		StoreCachedListing(CacheKey(GetLocalPath(path)), generation, found, files);
+
+		for (const File::FileInfo &file : files) {
+			if (prefix.empty() || !file.isDirectory || !startsWithNoCase(file.name, prefix))
+				continue;
+			const std::string subPath = path + "/" + file.name;
+			std::vector<File::FileInfo> subFiles;
+			bool subFound = HostGetDirListing(subPath, &subFiles);
+			StoreCachedListing(CacheKey(GetLocalPath(subPath)), generation, subFound, subFiles);
+		}
+		return true;
+	}, TaskType::IO_BLOCKING);
+}
+
 u64 DirectoryFileSystem::FreeDiskSpace(const std::string &path) {
+	DirectoryFileHandle::WaitForAllWrites();
 	int64_t result = 0;
 	if (free_disk_space(GetLocalPath(path), result)) {
 		return ReplayApplyDisk64(ReplayAction::FREESPACE, (uint64_t)result, CoreTiming::GetGlobalTimeUs());
@@ -911,6 +1246,7 @@ void DirectoryFileSystem::DoState(PointerWrap &p) {
 	Do(p, num);
 
 	if (p.mode == p.MODE_READ) {
+		ClearCache();
 		CloseAll();
 		u32 key;
 		OpenFileEntry entry;
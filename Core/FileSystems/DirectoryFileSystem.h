@@ -20,8 +20,13 @@
 // TODO: Remove the Windows-specific code, FILE is fine there too.
 
 #include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
+#include "Common/File/DirListing.h"
 #include "Common/File/Path.h"
+#include "Common/Thread/Promise.h"
 #include "Core/FileSystems/FileSystem.h"
 
 #ifdef _WIN32
@@ -40,8 +45,11 @@ struct DirectoryFileHandle {
 	int hFile = -1;
 #endif
 	s64 needsTrunc_ = -1;
+	// Where the file will be once the queued writes finish, -1 if none are queued.
+	s64 writeBehindPos_ = -1;
 	bool replay_ = true;
 	bool inGameDir_ = false;
+	bool writeBehind_ = false;
 	FileSystemFlags fileSystemFlags_ = (FileSystemFlags)0;
 
 	DirectoryFileHandle() {}
@@ -55,6 +63,15 @@ struct DirectoryFileHandle {
 	size_t Write(const u8* pointer, s64 size);
 	size_t Seek(s32 position, FileMove type);
 	void Close();
+
+	// Waits for this handle's queued writes.
+	void FlushWrites();
+	// Waits for all queued writes and closes, anything looking at the host files should call this first.
+	static void WaitForAllWrites();
+
+private:
+	size_t Tell();
+	s64 HostPosition() const;
 };
 
 class DirectoryFileSystem : public IFileSystem {
@@ -88,6 +105,9 @@ class DirectoryFileSystem : public IFileSystem {
 	bool ComputeRecursiveDirSizeIfFast(const std::string &path, int64_t *size) override;
 	void Describe(char *buf, size_t size) const override { snprintf(buf, size, "Dir: %s", basePath.c_str()); }
 
+	// Fills the metadata cache for a directory and its subdirectories starting with prefix, in the background.
+	void PreloadCache(const std::string &path, const std::string &prefix);
+
 private:
 	struct OpenFileEntry {
 		DirectoryFileHandle hFile;
@@ -95,12 +115,47 @@ class DirectoryFileSystem : public IFileSystem {
 		FileAccess access = FILEACCESS_NONE;
 	};
 
+	// Every stat and listing is a round trip to the host, which is very slow on some (like Android's
+	// storage framework.)  Anything written through this file system drops what it touched, and since
+	// the host may change things too, entries are only trusted for a while.
+	// Keys are lowercased local paths, since lookups may need a case fix anyway.
+	struct CachedInfo {
+		double time;
+		bool found;
+		File::FileInfo info;
+	};
+	struct CachedListing {
+		double time;
+		bool found;
+		std::vector<File::FileInfo> files;
+	};
+
+	bool HostGetFileInfo(std::string filename, File::FileInfo *info) const;
+	bool HostGetDirListing(const std::string &path, std::vector<File::FileInfo> *files) const;
+
+	static std::string CacheKey(const Path &localPath);
+	bool LookupCachedInfo(const Path &localPath, File::FileInfo *info, bool *found);
+	bool LookupCachedListing(const std::string &key, std::vector<File::FileInfo> *files, bool *found);
+	void StoreCachedInfo(const std::string &key, u32 generation, bool found, const File::FileInfo &info);
+	void StoreCachedListing(const std::string &key, u32 generation, bool found, const std::vector<File::FileInfo> &files);
+	// Drops a path and its parent's listing.
+	void InvalidateCache(const Path &localPath);
+	void ClearCache();
+	u32 CacheGeneration();
+
 	typedef std::map<u32, OpenFileEntry> EntryMap;
 	EntryMap entries;
 	Path basePath;
 	IHandleAllocator *hAlloc;
 	FileSystemFlags flags;
 
+	std::mutex cacheLock_;
+	std::map<std::string, CachedInfo> infoCache_;
+	std::map<std::string, CachedListing> listingCache_;
+	// Bumped on every invalidation, so slow host queries that raced with a write don't get stored.
+	u32 cacheGeneration_ = 0;
+	Promise<bool> *preload_ = nullptr;
+
 	Path GetLocalPath(std::string internalPath) const;
 };
 
@@ -530,29 +530,18 @@ size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec) {
 		const int lastBlockSize = (size - firstBlockSize) & 2047;
 		const s64 middleSize = size - firstBlockSize - lastBlockSize;
 		u32 secNum = (u32)(positionOnIso / 2048);
-		u8 theSector[2048];
-
-		if ((middleSize & 2047) != 0) {
-			ERROR_LOG(Log::FileSystem, "Remaining size should be aligned");
-		}
 
 		const u8 *const start = pointer;
-		if (firstBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector + firstBlockOffset, firstBlockSize);
-			pointer += firstBlockSize;
-		}
-		if (middleSize > 0) {
-			const u32 sectors = (u32)(middleSize / 2048);
-			blockDevice->ReadBlocks(secNum, sectors, pointer);
-			secNum += sectors;
-			pointer += middleSize;
-		}
-		if (lastBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector, lastBlockSize);
-			pointer += lastBlockSize;
+		const u8 *mapped = blockDevice->MappedData();
+		if (mapped && positionOnIso + size <= blockDevice->GetUncompressedSize()) {
+			// No need to go through sectors at all, just copy the whole thing.
+			memcpy(pointer, mapped + positionOnIso, (size_t)size);
+		} else if (size > 0) {
+			// Whole sectors land directly in the destination, usually PSP RAM.
+			blockDevice->ReadBytes(positionOnIso, (size_t)size, pointer);
 		}
+		pointer += size;
+		secNum += (firstBlockSize > 0 ? 1 : 0) + (u32)(middleSize / 2048) + (lastBlockSize > 0 ? 1 : 0);
 
 		size_t totalBytes = pointer - start;
 		if (abs((int)lastReadBlock_ - (int)secNum) > 100) {
@@ -21,6 +21,7 @@
 #include "Common/StringUtils.h"
 #include "Core/FileSystems/MetaFileSystem.h"
 #include "Core/HLE/sceKernelThread.h"
+#include "Core/MemDirtyTracker.h"
 #include "Core/Reporting.h"
 #include "Core/System.h"
 
@@ -533,6 +534,8 @@ void MetaFileSystem::CloseFile(u32 handle)
 size_t MetaFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size)
 {
 	std::lock_guard<std::recursive_mutex> guard(lock);
+	// The file system may read with system calls, which can't write to protected pages.
+	Memory::DirtyHostWriteScope hostWrite(pointer, (size_t)std::max(size, (s64)0));
 	IFileSystem *sys = GetHandleOwner(handle);
 	if (sys)
 		return sys->ReadFile(handle, pointer, size);
@@ -553,6 +556,7 @@ size_t MetaFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size)
 size_t MetaFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec)
 {
 	std::lock_guard<std::recursive_mutex> guard(lock);
+	Memory::DirtyHostWriteScope hostWrite(pointer, (size_t)std::max(size, (s64)0));
 	IFileSystem *sys = GetHandleOwner(handle);
 	if (sys)
 		return sys->ReadFile(handle, pointer, size, usec);
@@ -135,6 +135,7 @@ void PGF::DoState(PointerWrap &p) {
 	Do(p, fontDataSizeTemp);
 	fontDataSize = (size_t)fontDataSizeTemp;
 	if (p.mode == p.MODE_READ) {
+		ClearGlyphCache();
 		delete [] fontData;
 		if (fontDataSize) {
 			fontData = new u8[fontDataSize];
@@ -267,6 +268,7 @@ bool PGF::ReadPtr(const u8 *ptr, size_t dataSize) {
 	u32 fontDataOffset = (u32)(uptr - startPtr);
 
 	fontDataSize = dataSize - fontDataOffset;
+	ClearGlyphCache();
 	fontData = new u8[fontDataSize];
 	memcpy(fontData, uptr, fontDataSize);
 
@@ -574,9 +576,11 @@ void PGF::DrawCharacter(const GlyphImage *image, int clipX, int clipY, int clipW
 		return;
 	}
 
-	size_t bitPtr = glyph.ptr * 8;
-	int numberPixels = glyph.w * glyph.h;
-	int pixelIndex = 0;
+	const FontPixelFormat pixelFormat = (FontPixelFormat)(u32)image->pixelFormat;
+	if (pixelFormat < 0 || pixelFormat > PSP_FONT_PIXELFORMAT_32) {
+		ERROR_LOG_REPORT_ONCE(pfgbadformat, Log::sceFont, "Invalid image format in image: %d", (int)pixelFormat);
+		return;
+	}
 
 	int x = image->xPos64 >> 6;
 	int y = image->yPos64 >> 6;
@@ -593,10 +597,73 @@ void PGF::DrawCharacter(const GlyphImage *image, int clipX, int clipY, int clipW
 	if (clipHeight < 0)
 		clipHeight = 8192;
 
-	// Use a buffer so we can apply subpixel rendering.
-	// TODO: Cache this buffer per glyph?  Maybe even transpose it first?
-	std::vector<u8> decodedPixels;
-	decodedPixels.resize(numberPixels);
+	// Always row-major, regardless of the glyph's bitmap direction.
+	const u8 *decodedPixels = GetDecodedGlyph(glyph);
+	const int glyphW = glyph.w;
+	const int glyphH = glyph.h;
+
+	auto samplePixel = [&](int xx, int yy) -> u8 {
+		if (xx < 0 || yy < 0 || xx >= glyphW || yy >= glyphH) {
+			return 0;
+		}
+		return decodedPixels[yy * glyphW + xx];
+	};
+
+	int renderX1 = std::max(clipX, x) - x;
+	int renderY1 = std::max(clipY, y) - y;
+	// We can render up to frac beyond the glyph w/h, so add 1px if necessary.
+	int renderX2 = std::min(clipX + clipWidth - x, glyphW + (xFrac > 0 ? 1 : 0));
+	int renderY2 = std::min(clipY + clipHeight - y, glyphH + (yFrac > 0 ? 1 : 0));
+
+	// glyph.w is 7 bits, so a row never exceeds this.
+	u8 rowPixels[128 + 1];
+	if (xFrac == 0 && yFrac == 0) {
+		for (int yy = renderY1; yy < renderY2; ++yy) {
+			if (renderX1 < renderX2) {
+				// Here renderX1 >= 0 and renderX2 <= glyph.w, so the row can be used directly.
+				const u8 *row = decodedPixels + yy * glyphW + renderX1;
+				SetFontPixelRow(image->bufferPtr, image->bytesPerLine, image->bufWidth, image->bufHeight, x + renderX1, y + yy, row, renderX2 - renderX1, pixelFormat);
+			}
+		}
+	} else {
+		for (int yy = renderY1; yy < renderY2; ++yy) {
+			for (int xx = renderX1; xx < renderX2; ++xx) {
+				// First, blend horizontally.  Tests show we blend swizzled to 8 bit.
+				u32 horiz1 = samplePixel(xx - 1, yy - 1) * xFrac + samplePixel(xx, yy - 1) * (64 - xFrac);
+				u32 horiz2 = samplePixel(xx - 1, yy + 0) * xFrac + samplePixel(xx, yy + 0) * (64 - xFrac);
+				// Now blend those together vertically.
+				u32 blended = horiz1 * yFrac + horiz2 * (64 - yFrac);
+
+				// We multiplied an 8 bit value by 64 twice, so now we have a 20 bit value.
+				rowPixels[xx - renderX1] = blended >> 12;
+			}
+			if (renderX1 < renderX2) {
+				SetFontPixelRow(image->bufferPtr, image->bytesPerLine, image->bufWidth, image->bufHeight, x + renderX1, y + yy, rowPixels, renderX2 - renderX1, pixelFormat);
+			}
+		}
+	}
+
+	gpu->InvalidateCache(image->bufferPtr, image->bytesPerLine * image->bufHeight, GPU_INVALIDATE_SAFE);
+}
+
+const u8 *PGF::GetDecodedGlyph(const Glyph &glyph) const {
+	auto it = glyphCacheOffsets_.find(glyph.ptr);
+	if (it != glyphCacheOffsets_.end()) {
+		return &glyphCache_[it->second];
+	}
+
+	size_t bitPtr = glyph.ptr * 8;
+	int numberPixels = glyph.w * glyph.h;
+	int pixelIndex = 0;
+
+	// Fonts are small, but don't let a game that draws from many fonts grow this forever.
+	if (glyphCache_.size() + numberPixels > 4 * 1024 * 1024) {
+		ClearGlyphCache();
+	}
+
+	u32 offset = (u32)glyphCache_.size();
+	glyphCache_.resize(offset + numberPixels * 2);
+	u8 *decodedPixels = &glyphCache_[offset + numberPixels];
 
 	while (pixelIndex < numberPixels && bitPtr + 8 < fontDataSize * 8) {
 		// This is some kind of nibble based RLE compression.
@@ -620,51 +687,95 @@ void PGF::DrawCharacter(const GlyphImage *image, int clipX, int clipY, int clipW
 		}
 	}
 
-	auto samplePixel = [&](int xx, int yy) -> u8 {
-		if (xx < 0 || yy < 0 || xx >= glyph.w || yy >= glyph.h) {
-			return 0;
+	// Store it row by row, so drawing doesn't need to care about the direction.
+	u8 *rows = &glyphCache_[offset];
+	if ((glyph.flags & FONT_PGF_BMP_OVERLAY) == FONT_PGF_BMP_H_ROWS) {
+		memcpy(rows, decodedPixels, numberPixels);
+	} else {
+		for (int xx = 0; xx < (int)glyph.w; ++xx) {
+			for (int yy = 0; yy < (int)glyph.h; ++yy) {
+				rows[yy * glyph.w + xx] = decodedPixels[xx * glyph.h + yy];
+			}
 		}
+	}
+	glyphCache_.resize(offset + numberPixels);
 
-		int index;
-		if ((glyph.flags & FONT_PGF_BMP_OVERLAY) == FONT_PGF_BMP_H_ROWS) {
-			index = yy * glyph.w + xx;
-		} else {
-			index = xx * glyph.h + yy;
-		}
+	glyphCacheOffsets_[glyph.ptr] = offset;
+	return &glyphCache_[offset];
+}
 
-		return decodedPixels[index];
-	};
+void PGF::ClearGlyphCache() const {
+	glyphCacheOffsets_.clear();
+	glyphCache_.clear();
+}
 
-	int renderX1 = std::max(clipX, x) - x;
-	int renderY1 = std::max(clipY, y) - y;
-	// We can render up to frac beyond the glyph w/h, so add 1px if necessary.
-	int renderX2 = std::min(clipX + clipWidth - x, glyph.w + (xFrac > 0 ? 1 : 0));
-	int renderY2 = std::min(clipY + clipHeight - y, glyph.h + (yFrac > 0 ? 1 : 0));
+void PGF::SetFontPixelRow(u32 base, int bpl, int bufWidth, int bufHeight, int x, int y, const u8 *pixelColors, int count, FontPixelFormat pixelformat) const {
+	if (y < 0 || y >= bufHeight) {
+		return;
+	}
 
-	if (xFrac == 0 && yFrac == 0) {
-		for (int yy = renderY1; yy < renderY2; ++yy) {
-			for (int xx = renderX1; xx < renderX2; ++xx) {
-				u8 pixelColor = samplePixel(xx, yy);
-				SetFontPixel(image->bufferPtr, image->bytesPerLine, image->bufWidth, image->bufHeight, x + xx, y + yy, pixelColor, (FontPixelFormat)(u32)image->pixelFormat);
-			}
+	static const u8 fontPixelSizeInBytes[] = { 0, 0, 1, 3, 4 }; // 0 means 2 pixels per byte
+	int pixelBytes = fontPixelSizeInBytes[pixelformat];
+	int bufMaxWidth = (pixelBytes == 0 ? bpl * 2 : bpl / pixelBytes);
+
+	// Clip to the buffer horizontally.
+	int start = std::max(0, -x);
+	int end = std::min(count, std::min(bufWidth, bufMaxWidth) - x);
+	if (start >= end) {
+		return;
+	}
+
+	int x1 = x + start;
+	int x2 = x + end;
+	u32 rowAddr = base + (y * bpl) + (pixelBytes == 0 ? x1 / 2 : x1 * pixelBytes);
+	u32 rowBytes = pixelBytes == 0 ? (x2 - 1) / 2 - x1 / 2 + 1 : (x2 - x1) * pixelBytes;
+	if (!Memory::IsValidRange(rowAddr, rowBytes)) {
+		// Let the per pixel path deal with partially valid rows.
+		for (int xx = start; xx < end; ++xx) {
+			SetFontPixel(base, bpl, bufWidth, bufHeight, x + xx, y, pixelColors[xx], pixelformat);
 		}
-	} else {
-		for (int yy = renderY1; yy < renderY2; ++yy) {
-			for (int xx = renderX1; xx < renderX2; ++xx) {
-				// First, blend horizontally.  Tests show we blend swizzled to 8 bit.
-				u32 horiz1 = samplePixel(xx - 1, yy - 1) * xFrac + samplePixel(xx, yy - 1) * (64 - xFrac);
-				u32 horiz2 = samplePixel(xx - 1, yy + 0) * xFrac + samplePixel(xx, yy + 0) * (64 - xFrac);
-				// Now blend those together vertically.
-				u32 blended = horiz1 * yFrac + horiz2 * (64 - yFrac);
+		return;
+	}
 
-				// We multiplied an 8 bit value by 64 twice, so now we have a 20 bit value.
-				u8 pixelColor = blended >> 12;
-				SetFontPixel(image->bufferPtr, image->bytesPerLine, image->bufWidth, image->bufHeight, x + xx, y + yy, pixelColor, (FontPixelFormat)(u32)image->pixelFormat);
+	u8 *dst = Memory::GetPointerWriteUnchecked(rowAddr);
+	const u8 *src = pixelColors + start;
+	int n = end - start;
+	switch (pixelformat) {
+	case PSP_FONT_PIXELFORMAT_4:
+	case PSP_FONT_PIXELFORMAT_4_REV:
+		for (int i = 0; i < n; ++i) {
+			// We always get a 8-bit value, so take only the top 4 bits.
+			const u8 pix4 = src[i] >> 4;
+			int px = x1 + i;
+			u8 &b = dst[px / 2 - x1 / 2];
+			if ((px & 1) != pixelformat) {
+				b = (pix4 << 4) | (b & 0xF);
+			} else {
+				b = (b & 0xF0) | pix4;
+			}
+		}
+		break;
+	case PSP_FONT_PIXELFORMAT_8:
+		memcpy(dst, src, n);
+		break;
+	case PSP_FONT_PIXELFORMAT_24:
+		// Each channel has the same value.
+		for (int i = 0; i < n; ++i) {
+			dst[i * 3 + 0] = src[i];
+			dst[i * 3 + 1] = src[i];
+			dst[i * 3 + 2] = src[i];
+		}
+		break;
+	case PSP_FONT_PIXELFORMAT_32:
+		{
+			// Spread the 8 bits out, simple enough for the compiler to vectorize.
+			u32_le *dst32 = (u32_le *)dst;
+			for (int i = 0; i < n; ++i) {
+				dst32[i] = src[i] * 0x01010101U;
 			}
+			break;
 		}
 	}
-
-	gpu->InvalidateCache(image->bufferPtr, image->bytesPerLine * image->bufHeight, GPU_INVALIDATE_SAFE);
 }
 
 void PGF::SetFontPixel(u32 base, int bpl, int bufWidth, int bufHeight, int x, int y, u8 pixelColor, FontPixelFormat pixelformat) const {
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -280,7 +281,12 @@ class PGF {
 	// Unused
 	int GetCharIndex(int charCode, const std::vector<int> &charmapCompressed);
 
+	// Returns the glyph's bitmap decoded to 8 bits per pixel, row by row. Valid until the next call.
+	const u8 *GetDecodedGlyph(const Glyph &glyph) const;
+	void ClearGlyphCache() const;
+
 	void SetFontPixel(u32 base, int bpl, int bufWidth, int bufHeight, int x, int y, u8 pixelColor, FontPixelFormat pixelformat) const;
+	void SetFontPixelRow(u32 base, int bpl, int bufWidth, int bufHeight, int x, int y, const u8 *pixelColors, int count, FontPixelFormat pixelformat) const;
 
 	PGFHeaderRev3Extra rev3extra;
 
@@ -305,4 +311,8 @@ class PGF {
 	std::vector<Glyph> glyphs;
 	std::vector<Glyph> shadowGlyphs;
 	int firstGlyph;
+
+	// Decoded glyph bitmaps, keyed by the glyph's bit offset in fontData. Not savestated.
+	mutable std::unordered_map<u32, u32> glyphCacheOffsets_;
+	mutable std::vector<u8> glyphCache_;
 };
@@ -18,6 +18,13 @@
 // * Unthrottling. If vsync is off or the backend can change present mode dynamically, we can simply disable all waits during unthrottle.
 // * Frame skipping. This gets complicated.
 // * The game not actually asking for flips, like in static loading screens
+//
+// Where the backend reports when frames actually hit the display (currently Vulkan with VK_GOOGLE_display_timing
+// or VK_KHR_present_wait), we use that as the feedback: if frames keep sitting in the present queue for more
+// than a refresh, we slowly delay the frame start (shortening 5 and lengthening 1), and back off again if
+// the margin gets too thin.
+
+#include <algorithm>
 
 #include "Common/Profiler/Profiler.h"
 #include "Common/Log.h"
@@ -55,6 +62,10 @@ inline Draw::PresentMode GetBestImmediateMode(Draw::PresentMode supportedModes)
 }
 
 void FrameTiming::Reset(Draw::DrawContext *draw) {
+	hasPresentFeedback = false;
+	pacingOffset = 0.0;
+	pacingAdjustment_ = 0.0;
+
 	if (g_Config.bVSync || !(draw->GetDeviceCaps().presentModesSupported & (Draw::PresentMode::MAILBOX | Draw::PresentMode::IMMEDIATE))) {
 		presentMode = Draw::PresentMode::FIFO;
 		presentInterval = 1;
@@ -81,6 +92,67 @@ void FrameTiming::PostSubmit() {
 	}
 }
 
+void FrameTiming::UpdatePresentFeedback(Draw::DrawContext *draw) {
+	const auto &history = draw->FrameTimeHistory();
+	const size_t maxIndex = history.MaxIndex();
+	const double smoothing = 0.1;
+	if (maxIndex < 2) {
+		return;
+	}
+
+	// Present timestamps arrive a few frames late. Go from old to new, so the averages are updated in order.
+	for (size_t i = std::min(maxIndex, FRAME_TIME_HISTORY_LENGTH) - 1; i > 0; i--) {
+		const FrameTimeData &data = history.Back(i);
+		if (data.actualPresent == 0.0 || data.queuePresent == 0.0 || data.frameId <= lastFeedbackFrameId_) {
+			continue;
+		}
+		const FrameTimeData &prev = history.Back(i + 1 < maxIndex ? i + 1 : i);
+		lastFeedbackFrameId_ = data.frameId;
+
+		const double latency = data.actualPresent - data.frameBegin;
+		const double margin = data.actualPresent - data.queuePresent;
+		if (latency < 0.0 || latency > 0.5 || margin < 0.0) {
+			// Bogus data, or we were paused.
+			continue;
+		}
+
+		if (!hasPresentFeedback) {
+			presentLatency = latency;
+			presentMargin = margin;
+			hasPresentFeedback = true;
+		} else {
+			presentLatency += (latency - presentLatency) * smoothing;
+			presentMargin += (margin - presentMargin) * smoothing;
+		}
+
+		if (prev.frameId + 1 == data.frameId && prev.actualPresent != 0.0) {
+			const double period = data.actualPresent - prev.actualPresent;
+			// Ignore skipped vblanks and anything outside reasonable refresh rates.
+			if (period > 1.0 / 360.0 && period < 1.0 / 20.0) {
+				refreshPeriod = refreshPeriod == 0.0 ? period : refreshPeriod + (period - refreshPeriod) * smoothing;
+			}
+		}
+
+		if (g_Config.bLowLatencyPacing && presentMode == Draw::PresentMode::FIFO && refreshPeriod > 0.0) {
+			// Small steps, since the feedback lags behind by a few frames.
+			const double step = 0.00025;
+			if (presentMargin > refreshPeriod && pacingOffset < refreshPeriod) {
+				pacingAdjustment_ += step;
+				pacingOffset += step;
+			} else if (presentMargin < refreshPeriod * 0.25 && pacingOffset > 0.0) {
+				pacingAdjustment_ -= step;
+				pacingOffset -= step;
+			}
+		}
+	}
+}
+
+double FrameTiming::ConsumePacingAdjustment() {
+	double adjustment = pacingAdjustment_;
+	pacingAdjustment_ = 0.0;
+	return adjustment;
+}
+
 Draw::PresentMode ComputePresentMode(Draw::DrawContext *draw, int *interval) {
 	_assert_(draw);
 
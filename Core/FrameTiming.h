@@ -14,13 +14,28 @@ class FrameTiming {
 	void PostSubmit();
 	void Reset(Draw::DrawContext *draw);
 
+	// Reads back actual presentation times, where the backend reports them, and updates the averages below.
+	void UpdatePresentFeedback(Draw::DrawContext *draw);
+	// How much to shift the start of the next emulated frame by, in seconds. Resets after reading.
+	double ConsumePacingAdjustment();
+
 	// Some backends won't allow changing this willy nilly.
 	Draw::PresentMode presentMode;
 	int presentInterval;
 
+	// Averages from present feedback, in seconds. Only valid if hasPresentFeedback.
+	bool hasPresentFeedback = false;
+	double presentLatency = 0.0;  // From frame begin to the image actually reaching the display.
+	double presentMargin = 0.0;  // From queueing the present to the image actually reaching the display.
+	double refreshPeriod = 0.0;
+	double pacingOffset = 0.0;  // Total shift applied to frame starts so far.
+
 private:
 	double waitUntil_;
 	double *curTimePtr_;
+
+	uint64_t lastFeedbackFrameId_ = 0;
+	double pacingAdjustment_ = 0.0;
 };
 
 extern FrameTiming g_frameTiming;
@@ -15,6 +15,12 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ext/xxhash.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Log.h"
@@ -37,6 +43,69 @@ const int DATA_CHUNK_MAGIC = 0x61746164;
 const int SMPL_CHUNK_MAGIC = 0x6C706D73;
 const int FACT_CHUNK_MAGIC = 0x74636166;
 
+// Frames of fully loaded tracks stay the same, so decoded ones are kept for looping music and
+// sound effects that play again.  Keyed by the packet contents, so it's shared by all contexts.
+// Can be used from the sas thread too, hence the lock.
+class AtracFrameCache {
+public:
+	bool Lookup(u64 key, int16_t *outbuf, int outputChannels, int *outSamples, int *bytesConsumed) {
+		std::lock_guard<std::mutex> guard(lock_);
+		auto it = index_.find(key);
+		if (it == index_.end())
+			return false;
+		// Move to the front, it's the least recently used that gets dropped.
+		frames_.splice(frames_.begin(), frames_, it->second);
+		const Frame &frame = *it->second;
+		memcpy(outbuf, frame.samples.data(), frame.outSamples * outputChannels * sizeof(int16_t));
+		*outSamples = frame.outSamples;
+		*bytesConsumed = frame.bytesConsumed;
+		return true;
+	}
+
+	void Store(u64 key, const int16_t *outbuf, int outputChannels, int outSamples, int bytesConsumed) {
+		std::lock_guard<std::mutex> guard(lock_);
+		if (index_.find(key) != index_.end())
+			return;
+		frames_.push_front(Frame{ key, std::vector<int16_t>(outbuf, outbuf + outSamples * outputChannels), outSamples, bytesConsumed });
+		index_[key] = frames_.begin();
+		bytes_ += frames_.front().samples.size() * sizeof(int16_t);
+		while (bytes_ > MAX_BYTES) {
+			bytes_ -= frames_.back().samples.size() * sizeof(int16_t);
+			index_.erase(frames_.back().key);
+			frames_.pop_back();
+		}
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> guard(lock_);
+		frames_.clear();
+		index_.clear();
+		bytes_ = 0;
+	}
+
+private:
+	// About 45 seconds of Atrac3+ stereo.
+	static const size_t MAX_BYTES = 16 * 1024 * 1024;
+
+	struct Frame {
+		u64 key;
+		std::vector<int16_t> samples;
+		int outSamples;
+		int bytesConsumed;
+	};
+
+	std::mutex lock_;
+	std::list<Frame> frames_;
+	std::unordered_map<u64, std::list<Frame>::iterator> index_;
+	size_t bytes_ = 0;
+};
+
+static AtracFrameCache g_frameCache;
+
+void ClearAtracFrameCache() {
+	g_frameCache.Clear();
+}
+
 void Atrac::DoState(PointerWrap &p) {
 	auto s = p.Section("Atrac", 1, 9);
 	if (!s)
@@ -833,6 +902,7 @@ void Atrac::ForceSeekToSample(int sample) {
 	if (decoder_) {
 		decoder_->FlushBuffers();
 	}
+	decoderStale_ = false;
 	currentSample_ = sample;
 }
 
@@ -858,11 +928,44 @@ void Atrac::SeekToSample(int sample) {
 		for (u32 pos = start; pos < off; pos += track_.bytesPerFrame) {
 			decoder_->Decode(BufferStart() + pos, track_.bytesPerFrame, nullptr, 2, nullptr, nullptr);
 		}
+		decoderStale_ = false;
 	}
 
 	currentSample_ = sample;
 }
 
+bool Atrac::DecodeFrame(u32 off, u8 *outbuf, int *bytesConsumed, int *outSamples) {
+	const u8 *data = BufferStart();
+	// Decoders carry state between frames, so the frames it warms up from are part of the key.
+	const u32 backfill = track_.bytesPerFrame * 2;
+	const u32 start = off - track_.dataByteOffset < backfill ? track_.dataByteOffset : off - backfill;
+	const bool cacheable = bufferState_ == ATRAC_STATUS_ALL_DATA_LOADED && outbuf != nullptr && off >= start;
+	u64 key = 0;
+	if (cacheable) {
+		const u64 seed = ((u64)track_.codecType << 32) ^ ((u64)track_.jointStereo << 28) ^ ((u64)track_.channels << 24) ^ ((u64)outputChannels_ << 16) ^ (u64)*outSamples;
+		key = XXH3_64bits_withSeed(data + start, off + track_.bytesPerFrame - start, seed);
+		if (g_frameCache.Lookup(key, (int16_t *)outbuf, outputChannels_, outSamples, bytesConsumed)) {
+			decoderStale_ = true;
+			return true;
+		}
+	}
+
+	if (decoderStale_) {
+		// Skipped decoding the previous frames, so prefill the same way as seeking does.
+		decoder_->FlushBuffers();
+		for (u32 pos = start; pos < off; pos += track_.bytesPerFrame) {
+			decoder_->Decode(data + pos, track_.bytesPerFrame, nullptr, 2, nullptr, nullptr);
+		}
+		decoderStale_ = false;
+	}
+
+	if (!decoder_->Decode(data + off, track_.bytesPerFrame, bytesConsumed, outputChannels_, (int16_t *)outbuf, outSamples))
+		return false;
+	if (cacheable)
+		g_frameCache.Store(key, (const int16_t *)outbuf, outputChannels_, *outSamples, *bytesConsumed);
+	return true;
+}
+
 int Atrac::RemainingFrames() const {
 	if (bufferState_ == ATRAC_STATUS_ALL_DATA_LOADED) {
 		// Meaning, infinite I guess?  We've got it all.
@@ -957,7 +1060,6 @@ u32 Atrac::DecodeData(u8 *outbuf, u32 outbufPtr, u32 *SamplesNum, u32 *finish, i
 	bool gotFrame = false;
 	u32 off = track_.FileOffsetBySample(currentSample_ - skipSamples);
 	if (off < first_.size) {
-		uint8_t *indata = BufferStart() + off;
 		int bytesConsumed = 0;
 		int outSamples = track_.SamplesPerFrame();
 		int outBytes = outSamples * outputChannels_ * sizeof(int16_t);
@@ -973,7 +1075,7 @@ u32 Atrac::DecodeData(u8 *outbuf, u32 outbufPtr, u32 *SamplesNum, u32 *finish, i
 		numSamples = std::min(maxSamples, numSamples);
 
 		outSamples = numSamples;
-		if (!decoder_->Decode(indata, track_.bytesPerFrame, &bytesConsumed, outputChannels_, (int16_t *)outbuf, &outSamples)) {
+		if (!DecodeFrame(off, outbuf, &bytesConsumed, &outSamples)) {
 			// Decode failed.
 			*SamplesNum = 0;
 			*finish = 1;
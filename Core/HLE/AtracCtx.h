@@ -198,6 +198,8 @@ struct Track {
 
 int AnalyzeAA3Track(u32 addr, u32 size, u32 filesize, Track *track);
 int AnalyzeAtracTrack(u32 addr, u32 size, Track *track);
+// Drops the decoded frames kept for fully loaded tracks.
+void ClearAtracFrameCache();
 
 class AtracBase {
 public:
@@ -325,6 +327,8 @@ class Atrac : public AtracBase {
 	void ResetData();
 	void SeekToSample(int sample);
 	void ForceSeekToSample(int sample);
+	// Decodes the frame at off, or copies it if it was decoded before.
+	bool DecodeFrame(u32 off, u8 *outbuf, int *bytesConsumed, int *outSamples);
 	u32 StreamBufferEnd() const {
 		// The buffer is always aligned to a frame in size, not counting an optional header.
 		// The header will only initially exist after the data is first set.
@@ -343,6 +347,8 @@ class Atrac : public AtracBase {
 
 	int currentSample_ = 0;
 	u32 decodePos_ = 0;
+	// Set when frames came from the cache, so the decoder has to warm up before the next one.
+	bool decoderStale_ = false;
 	u32 bufferMaxSize_ = 0;
 
 	// Used to track streaming.
@@ -17,6 +17,8 @@
 
 #include <cstdarg>
 #include <map>
+#include <mutex>
+#include <unordered_set>
 #include <vector>
 #include <string>
 
@@ -70,6 +72,9 @@ static const char *hleAfterSyscallReschedReason;
 static const HLEFunction *latestSyscall = nullptr;
 static uint32_t latestSyscallPC = 0;
 static int idleOp;
+// HLE_FAST_CALL functions that turned out to reschedule.  The tables are const, so they're tracked here.
+static std::mutex fastCallsDemotedLock;
+static std::unordered_set<const HLEFunction *> fastCallsDemoted;
 
 // Split syscall support. NOTE: This needs to be saved in DoState somehow!
 static int splitSyscallEatCycles = 0;
@@ -717,6 +722,30 @@ inline void CallSyscallWithoutFlags(const HLEFunction *info)
 		SetDeadbeefRegs();
 }
 
+u32 CallSyscallFast(const HLEFunction *info)
+{
+	latestSyscall = info;
+	latestSyscallPC = currentMIPS->pc;
+	info->func();
+
+	if (hleAfterSyscall == HLE_AFTER_NOTHING) {
+		SetDeadbeefRegs();
+		return coreState != CORE_RUNNING_CPU ? 1 : 0;
+	}
+
+	const int switchFlags = HLE_AFTER_RESCHED | HLE_AFTER_RESCHED_CALLBACKS | HLE_AFTER_CURRENT_CALLBACKS | HLE_AFTER_RUN_INTERRUPTS | HLE_AFTER_QUEUED_CALLS;
+	if (hleAfterSyscall & switchFlags) {
+		// This one is wrongly flagged.  Future compiles will end the block after it.
+		std::lock_guard<std::mutex> guard(fastCallsDemotedLock);
+		if (fastCallsDemoted.insert(info).second)
+			ERROR_LOG_REPORT(Log::HLE, "%s can switch threads, so it can't be a fast call", info->name);
+	}
+
+	// Take the normal path, and have the block exit like any other syscall.
+	hleFinishSyscall(info);
+	return 1;
+}
+
 const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op)
 {
 	u32 callno = (op >> 6) & 0xFFFFF; //20 bits
@@ -750,11 +779,30 @@ void *GetQuickSyscallFunc(MIPSOpcode op) {
 	// TODO: Do this with a flag?
 	if (op == idleOp)
 		return (void *)info->func;
+	if (info->flags == HLE_FAST_CALL)
+		return (void *)&CallSyscallFast;
 	if (info->flags != 0)
 		return (void *)&CallSyscallWithFlags;
 	return (void *)&CallSyscallWithoutFlags;
 }
 
+bool IsFastSyscall(MIPSOpcode op) {
+	// Stats need CallSyscall, and the block exit to be accurate.
+	if (coreCollectDebugStats)
+		return false;
+#ifdef USE_PROFILER
+	return false;
+#else
+	const HLEFunction *info = GetSyscallFuncPointer(op);
+	// Combined with any other flag, it may wait or change threads, so it's not fast.
+	if (!info || !info->func || op == idleOp || info->flags != HLE_FAST_CALL)
+		return false;
+
+	std::lock_guard<std::mutex> guard(fastCallsDemotedLock);
+	return fastCallsDemoted.find(info) == fastCallsDemoted.end();
+#endif
+}
+
 void hleSetFlipTime(double t) {
 	hleFlipTime = t;
 }
@@ -775,6 +823,8 @@ void CallSyscall(MIPSOpcode op) {
 	if (info->func) {
 		if (op == idleOp)
 			info->func();
+		else if (info->flags == HLE_FAST_CALL)
+			CallSyscallFast(info);
 		else if (info->flags != 0)
 			CallSyscallWithFlags(info);
 		else
@@ -42,6 +42,10 @@ enum {
 	HLE_CLEAR_STACK_BYTES = 1 << 10,
 	// Indicates that this call operates in kernel mode.
 	HLE_KERNEL_SYSCALL = 1 << 11,
+	// Only reads state and sets return values: never waits, reschedules, or runs callbacks.
+	// The jit keeps compiling past these instead of ending the block.  Can't be combined.
+	// One that reschedules anyway still exits the block, and won't be treated as fast again.
+	HLE_FAST_CALL = 1 << 12,
 };
 
 struct HLEFunction {
@@ -160,6 +164,11 @@ void HLEReturnFromMipsCall();
 const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op);
 // For jit, takes arg: const HLEFunction *
 void *GetQuickSyscallFunc(MIPSOpcode op);
+// True if the jit can continue the block after this syscall (see HLE_FAST_CALL.)
+bool IsFastSyscall(MIPSOpcode op);
+// For jit, called instead of the quick func when IsFastSyscall().  If this returns non-zero,
+// the function needed more than a fast call (like a reschedule), and the block must exit to PC.
+u32 CallSyscallFast(const HLEFunction *info);
 
 void hleDoLogInternal(Log t, LogLevel level, u64 res, const char *file, int line, const char *reportTag, char retmask, const char *reason, const char *formatted_reason);
 
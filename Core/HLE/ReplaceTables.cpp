@@ -24,6 +24,8 @@
 #include "Common/CommonTypes.h"
 #include "Common/Log.h"
 #include "Common/Swap.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/System.h"
 #include "Core/Debugger/Breakpoints.h"
 #include "Core/Debugger/MemBlockInfo.h"
@@ -49,6 +51,29 @@ enum class GPUReplacementSkip {
 
 static int skipGPUReplacements = 0;
 
+// Copies this large (like video frames) are worth splitting across threads.
+static constexpr u32 PARALLEL_COPY_MIN_SIZE = 512 * 1024;
+
+static void CopyMemory(u32 destPtr, u32 srcPtr, u8 *dst, const u8 *src, u32 bytes) {
+	// Check the physical addresses. With fastmem, the cached and uncached mirrors have different host
+	// pointers for the same memory, and parallel chunks of an overlapping copy would race.
+	// VRAM is also mirrored every 2MB, so copies within it always take the serial path.
+	const u32 d = destPtr & 0x3FFFFFFF;
+	const u32 s = srcPtr & 0x3FFFFFFF;
+	const bool bothVRAM = Memory::IsVRAMAddress(d) && Memory::IsVRAMAddress(s);
+	if (bytes >= PARALLEL_COPY_MIN_SIZE && !bothVRAM && (d + bytes <= s || s + bytes <= d))
+		ParallelMemcpy(&g_threadManager, dst, src, bytes, TaskPriority::HIGH);
+	else
+		memmove(dst, src, bytes);
+}
+
+static void SetMemory(u8 *dst, u8 value, u32 bytes) {
+	if (bytes >= PARALLEL_COPY_MIN_SIZE)
+		ParallelMemset(&g_threadManager, dst, value, bytes, TaskPriority::HIGH);
+	else
+		memset(dst, value, bytes);
+}
+
 // I think these have to be pretty accurate as these are libc replacements,
 // but we can probably get away with approximating the VFPU vsin/vcos and vrot
 // pretty roughly.
@@ -148,7 +173,7 @@ static int Replace_memcpy() {
 				dst[offset] = src[offset];
 			}
 		} else {
-			memmove(dst, src, bytes);
+			CopyMemory(destPtr, srcPtr, dst, src, bytes);
 		}
 	}
 	RETURN(destPtr);
@@ -268,7 +293,7 @@ static int Replace_memcpy16() {
 		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
 		const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
 		if (dst && src) {
-			memmove(dst, src, bytes);
+			CopyMemory(destPtr, srcPtr, dst, src, bytes);
 		}
 	}
 	RETURN(destPtr);
@@ -336,7 +361,7 @@ static int Replace_memmove() {
 		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
 		const u8 *src = Memory::GetPointerRange(srcPtr, bytes);
 		if (dst && src) {
-			memmove(dst, src, bytes);
+			CopyMemory(destPtr, srcPtr, dst, src, bytes);
 		}
 	}
 	RETURN(destPtr);
@@ -359,7 +384,7 @@ static int Replace_memset() {
 	if (!skip && bytes != 0) {
 		u8 *dst = Memory::GetPointerWriteRange(destPtr, bytes);
 		if (dst) {
-			memset(dst, value, bytes);
+			SetMemory(dst, value, bytes);
 		}
 	}
 	RETURN(destPtr);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "Core/HLE/sceKernel.h"
+#include "Common/BitScan.h"
 #include "Common/Serialize/Serializer.h"
 
 struct ThreadQueueList {
@@ -25,10 +26,10 @@ struct ThreadQueueList {
 	static const int NUM_QUEUES = 128;
 	// Initial number of threads a single queue can handle.
 	static const int INITIAL_CAPACITY = 32;
+	// Words in the mask of non-empty queues.
+	static const int NUM_MASK_WORDS = NUM_QUEUES / 32;
 
 	struct Queue {
-		// Next ever-been-used queue (worse priority.)
-		Queue *next;
 		// First valid item in data.
 		int first;
 		// One after last valid item in data.
@@ -51,7 +52,7 @@ struct ThreadQueueList {
 
 	ThreadQueueList() {
 		memset(queues, 0, sizeof(queues));
-		first = invalid();
+		memset(readyMask, 0, sizeof(readyMask));
 	}
 
 	~ThreadQueueList() {
@@ -75,44 +76,33 @@ struct ThreadQueueList {
 	}
 
 	inline SceUID pop_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
+		int priority = first_ready();
+		if (priority < NUM_QUEUES)
+			return pop(priority);
 
 		_dbg_assert_msg_(false, "ThreadQueueList should not be empty.");
 		return 0;
 	}
 
 	inline SceUID pop_first_better(u32 priority) {
-		Queue *cur = first;
-		// Don't bother looking past (worse than) this priority.
-		Queue *stop = &queues[priority];
-		while (cur < stop) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
-
+		// Don't bother with anything at (or worse than) this priority.
+		int best = first_ready();
+		if (best < (int)priority)
+			return pop(best);
 		return 0;
 	}
 
 	inline SceUID peek_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first];
-			cur = cur->next;
-		}
-
+		int priority = first_ready();
+		if (priority < NUM_QUEUES)
+			return queues[priority].data[queues[priority].first];
 		return 0;
 	}
 
 	inline void push_front(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
 		cur->data[--cur->first] = threadID;
+		mark_ready(priority);
 		// If we ran out of room toward the front, add more room for next time.
 		if (cur->first == 0)
 			rebalance(priority);
@@ -121,13 +111,14 @@ struct ThreadQueueList {
 	inline void push_back(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
 		cur->data[cur->end++] = threadID;
+		mark_ready(priority);
 		if (cur->full())
 			rebalance(priority);
 	}
 
 	inline void remove(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
-		_dbg_assert_msg_(cur->next != nullptr, "ThreadQueueList::Queue should already be linked up.");
+		_dbg_assert_msg_(cur->data != nullptr, "ThreadQueueList::Queue should already be prepared.");
 
 		for (int i = cur->first; i < cur->end; ++i) {
 			if (cur->data[i] == threadID) {
@@ -139,6 +130,8 @@ struct ThreadQueueList {
 
 				// Now we're one shorter.
 				--cur->end;
+				if (cur->empty())
+					mark_empty(priority);
 				return;
 			}
 		}
@@ -148,7 +141,7 @@ struct ThreadQueueList {
 
 	inline void rotate(u32 priority) {
 		Queue *cur = &queues[priority];
-		_dbg_assert_msg_(cur->next != nullptr, "ThreadQueueList::Queue should already be linked up.");
+		_dbg_assert_msg_(cur->data != nullptr, "ThreadQueueList::Queue should already be prepared.");
 
 		if (cur->size() > 1) {
 			// Grab the front and push it on the end.
@@ -163,7 +156,7 @@ struct ThreadQueueList {
 			free(queues[i].data);
 		}
 		memset(queues, 0, sizeof(queues));
-		first = invalid();
+		memset(readyMask, 0, sizeof(readyMask));
 	}
 
 	inline bool empty(u32 priority) const {
@@ -173,7 +166,7 @@ struct ThreadQueueList {
 
 	inline void prepare(u32 priority) {
 		Queue *cur = &queues[priority];
-		if (cur->next == nullptr)
+		if (cur->data == nullptr)
 			link(priority, INITIAL_CAPACITY);
 	}
 
@@ -207,6 +200,8 @@ struct ThreadQueueList {
 				link(i, capacity);
 				cur->first = (cur->capacity - size) / 2;
 				cur->end = cur->first + size;
+				if (size != 0)
+					mark_ready(i);
 			}
 
 			if (size != 0)
@@ -215,11 +210,32 @@ struct ThreadQueueList {
 	}
 
 private:
-	Queue *invalid() const {
-		return (Queue *)-1;
+	// The best priority with anything queued, or NUM_QUEUES if none.
+	inline int first_ready() const {
+		for (int i = 0; i < NUM_MASK_WORDS; ++i) {
+			if (readyMask[i] != 0)
+				return i * 32 + clz32_nonzero(readyMask[i]);
+		}
+		return NUM_QUEUES;
+	}
+
+	inline void mark_ready(u32 priority) {
+		readyMask[priority >> 5] |= 0x80000000U >> (priority & 31);
+	}
+
+	inline void mark_empty(u32 priority) {
+		readyMask[priority >> 5] &= ~(0x80000000U >> (priority & 31));
 	}
 
-	// Initialize a priority level and link to other queues.
+	inline SceUID pop(int priority) {
+		Queue *cur = &queues[priority];
+		SceUID threadID = cur->data[cur->first++];
+		if (cur->empty())
+			mark_empty(priority);
+		return threadID;
+	}
+
+	// Initialize a priority level.
 	void link(u32 priority, int size) {
 		_dbg_assert_msg_(queues[priority].data == nullptr, "ThreadQueueList::Queue should only be initialized once.");
 
@@ -240,21 +256,6 @@ struct ThreadQueueList {
 		// Start smack in the middle so it can move both directions.
 		cur->first = size / 2;
 		cur->end = size / 2;
-
-		for (int i = (int)priority - 1; i >= 0; --i) {
-			// This queue is before ours, and points past us.
-			// We'll have it point to our new queue, inserting into the chain.
-			if (queues[i].next != nullptr) {
-				cur->next = queues[i].next;
-				queues[i].next = cur;
-				return;
-			}
-		}
-
-		// Never found above - that means there's no better queue yet.
-		// The new one is now first, and whoever was first is after it.
-		cur->next = first;
-		first = cur;
 	}
 
 	// Move or allocate as necessary to maintain free space on both sides.
@@ -281,8 +282,8 @@ struct ThreadQueueList {
 		}
 	}
 
-	// The first queue that's ever been used.
-	Queue *first;
 	// The priority level queues of thread ids.
 	Queue queues[NUM_QUEUES];
+	// One bit per non-empty queue, with the best priority of each word in the top bit.
+	u32 readyMask[NUM_MASK_WORDS];
 };
@@ -15,11 +15,13 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 
 #include "Common/Common.h"
 #include "Common/File/Path.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Data/Collections/FixedSizeQueue.h"
@@ -69,6 +71,8 @@ static s16 *clampedMixBuffer;
 #ifndef MOBILE_DEVICE
 WaveFileWriter g_wave_writer;
 static bool m_logAudio;
+// Only for the debug stats.
+static std::atomic<int> queuedFrames;
 #endif
 
 // High and low watermarks, basically.  For perfect emulation, the correct values are 0 and 1, respectively.
@@ -322,14 +326,20 @@ void __AudioSetSRCFrequency(int freq) {
 	srcFrequency = freq;
 }
 
+int __AudioGetQueuedFrames() {
+	return queuedFrames.load(std::memory_order_relaxed);
+}
+
 // Mix samples from the various audio channels into a single sample queue, managed by the backend implementation.
 void __AudioUpdate(bool resetRecording) {
+	TRACE_SCOPE("audio_update");
 	// AUDIO throttle doesn't really work on the PSP since the mixing intervals are so closely tied
 	// to the CPU. Much better to throttle the frame rate on frame display and just throw away audio
 	// if the buffer somehow gets full.
 	bool firstChannel = true;
 	const int16_t srcBufferSize = hwBlockSize * 2;
 	int16_t srcBuffer[srcBufferSize];
+	int mostQueued = 0;
 
 	for (u32 i = 0; i < PSP_AUDIO_CHANNEL_MAX + 1; i++)	{
 		if (!chans[i].reserved)
@@ -340,6 +350,7 @@ void __AudioUpdate(bool resetRecording) {
 		if (!chanSampleQueues[i].size()) {
 			continue;
 		}
+		mostQueued = std::max(mostQueued, (int)chanSampleQueues[i].size() / 2);
 
 		bool needsResample = i == PSP_AUDIO_CHANNEL_SRC && srcFrequency != 0 && srcFrequency != mixFrequency;
 		size_t sz = needsResample ? (srcBufferSize * srcFrequency) / mixFrequency : srcBufferSize;
@@ -408,12 +419,14 @@ void __AudioUpdate(bool resetRecording) {
 		}
 	}
 
+	queuedFrames.store(mostQueued, std::memory_order_relaxed);
+
 	if (firstChannel) {
 		// Nothing was written above, let's memset.
 		memset(mixBuffer, 0, hwBlockSize * 2 * sizeof(s32));
 	}
 
-	if (g_Config.bEnableSound) {
+	if (g_Config.bEnableSound && !PSP_CoreParameter().runAheadMuteAudio) {
 		System_AudioPushSamples(mixBuffer, hwBlockSize);
 #ifndef MOBILE_DEVICE
 		if (g_Config.bSaveLoadResetsAVdumping && resetRecording) {
@@ -27,9 +27,25 @@ struct AudioDebugStats {
 	int bufsize;
 	int underrunCount;
 	int overrunCount;
+	// Frames that were padded, or dropped because the buffer was full.
+	int underrunFrames;
+	int overrunFrames;
+	// Lowest fill seen by the audio thread.
+	int minBuffered;
 	int instantSampleRate;
 	int targetSampleRate;
 	int lastPushSize;
+	// Frames waiting in the fullest sceAudio channel, not yet mixed.
+	int queuedFrames;
+	// Frames the host asked for last, roughly its buffer size.
+	int hostFrames;
+	bool lowLatency;
+	// From being mixed until played, in milliseconds, over latencyCount measurements.
+	int latencyCount;
+	float latencyMs;
+	float latencyP50Ms;
+	float latencyP95Ms;
+	float latencyP99Ms;
 };
 
 // Easy interface for sceAudio to write to, to keep the complexity in check.
@@ -40,6 +56,8 @@ void __AudioUpdate(bool resetRecording = false);
 void __AudioShutdown();
 void __AudioSetOutputFrequency(int freq);
 void __AudioSetSRCFrequency(int freq);
+// Safe to call from any thread.
+int __AudioGetQueuedFrames();
 
 // May return SCE_ERROR_AUDIO_CHANNEL_BUSY if buffer too large
 u32 __AudioEnqueue(AudioChannel &chan, int chanNum, bool blocking);
@@ -52,6 +52,8 @@
 #endif // defined(HAVE_LIBNX) || PPSSPP_PLATFORM(SWITCH)
 
 #include <algorithm>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <cstring>
 
@@ -132,6 +134,12 @@ SockAddrIN4 g_localhostIP;
 sockaddr LocalIP;
 int defaultWlanChannel = PSP_SYSTEMPARAM_ADHOC_CHANNEL_11; // Don't put 0(Auto) here, it needed to be a valid/actual channel number
 
+// Lets other threads interrupt the Friend Finder's wait, by sending a byte to a loopback socket.
+// Unlike eventfd or pipes, that works the same everywhere, and select() can wait on it together with the metasocket.
+static std::mutex friendFinderWakeLock;
+static int friendFinderWakeSocket = (int)INVALID_SOCKET;
+static sockaddr_in friendFinderWakeAddr{};
+
 static std::mutex chatLogLock;
 static std::vector<std::string> chatLog;
 static int chatMessageGeneration = 0;
@@ -1373,6 +1381,300 @@ int GetChatMessageCount() {
 }
 
 // TODO: We should probably change this thread into PSPThread (or merging it into the existing AdhocThread PSPThread) as there are too many global vars being used here which also being used within some HLEs
+static void createFriendFinderWakeSocket() {
+	int fd = (int)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (fd < 0)
+		return;
+
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t len = sizeof(addr);
+	if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || getsockname(fd, (sockaddr *)&addr, &len) < 0) {
+		WARN_LOG(Log::sceNet, "FriendFinder: Unable to create wake socket (%i), falling back to polling", errno);
+		closesocket(fd);
+		return;
+	}
+	changeBlockingMode(fd, 1);
+
+	std::lock_guard<std::mutex> guard(friendFinderWakeLock);
+	friendFinderWakeSocket = fd;
+	friendFinderWakeAddr = addr;
+}
+
+static void closeFriendFinderWakeSocket() {
+	std::lock_guard<std::mutex> guard(friendFinderWakeLock);
+	if (friendFinderWakeSocket != (int)INVALID_SOCKET)
+		closesocket(friendFinderWakeSocket);
+	friendFinderWakeSocket = (int)INVALID_SOCKET;
+}
+
+void wakeFriendFinder() {
+	std::lock_guard<std::mutex> guard(friendFinderWakeLock);
+	if (friendFinderWakeSocket == (int)INVALID_SOCKET)
+		return;
+	uint8_t wake = 0;
+	sendto(friendFinderWakeSocket, (const char *)&wake, 1, MSG_NOSIGNAL, (sockaddr *)&friendFinderWakeAddr, sizeof(friendFinderWakeAddr));
+}
+
+// Waits until the Adhoc Server sends something, someone calls wakeFriendFinder(), or the timeout passes.
+static void waitForFriendFinderEvent(bool watchServer, int timeoutUS) {
+	// Only the Friend Finder itself closes it, so it's safe to use without the lock here.
+	int wakefd = friendFinderWakeSocket;
+	int metafd = watchServer ? (int)metasocket : (int)INVALID_SOCKET;
+	if (wakefd == (int)INVALID_SOCKET) {
+		// Without a wake socket, only wait a little at a time, like before.
+		if (metafd != (int)INVALID_SOCKET)
+			IsSocketReady(metafd, true, false, nullptr, std::min(timeoutUS, 10000));
+		else
+			sleep_ms(10, "pro-adhoc-poll-2");
+		return;
+	}
+
+	fd_set readfds;
+	FD_ZERO(&readfds);
+	FD_SET(wakefd, &readfds);
+	int maxfd = wakefd;
+#if !defined(_WIN32)
+	if (metafd >= FD_SETSIZE)
+		metafd = (int)INVALID_SOCKET;
+#endif
+	if (metafd != (int)INVALID_SOCKET) {
+		FD_SET(metafd, &readfds);
+		maxfd = std::max(maxfd, metafd);
+	}
+
+	timeval tval;
+	tval.tv_sec = timeoutUS / 1000000;
+	tval.tv_usec = timeoutUS % 1000000;
+	if (select(maxfd + 1, &readfds, nullptr, nullptr, &tval) > 0 && FD_ISSET(wakefd, &readfds)) {
+		// Several wakes may have piled up, they all mean the same.
+		uint8_t drain[16];
+		while (recv(wakefd, (char *)drain, sizeof(drain), MSG_NOSIGNAL) > 0)
+			continue;
+	}
+}
+
+// Sends the same datagram to several targets, using a single syscall where the OS supports that.
+// Returns how many of the first targets it was sent to, the rest are up to the caller.
+int sendToPeersBatched(int fd, const void *data, int len, const std::vector<sockaddr_in> &targets) {
+#if defined(__linux__) && !defined(__ANDROID__)
+	if (targets.size() < 2)
+		return 0;
+
+	iovec iov{ (void *)data, (size_t)len };
+	std::vector<mmsghdr> msgs(targets.size());
+	for (size_t i = 0; i < targets.size(); ++i) {
+		memset(&msgs[i], 0, sizeof(mmsghdr));
+		msgs[i].msg_hdr.msg_name = (void *)&targets[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		msgs[i].msg_hdr.msg_iov = &iov;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	int sent = sendmmsg(fd, msgs.data(), (unsigned int)msgs.size(), MSG_NOSIGNAL);
+	return sent < 0 ? 0 : sent;
+#else
+	return 0;
+#endif
+}
+
+// Small PDP packets to peers that support it go over the Adhoc Server connection, instead of straight over UDP,
+// so nobody needs port forwarding.  They're collected for a moment and sent along with each other.
+struct RelayedPdpPacket {
+	SceNetEtherAddr mac;
+	u16 sport;
+	std::vector<u8> data;
+};
+
+static std::mutex relayLock;
+// Set once the Adhoc Server confirmed it relays for us.
+static std::atomic<bool> relayActive{};
+// Relay Entries waiting to go out, since relayTxSince.
+static std::vector<u8> relayTx;
+static u64 relayTxSince = 0;
+// Relayed packets waiting to be received, by local PDP port.
+static std::map<u16, std::deque<RelayedPdpPacket>> relayRx;
+
+static void resetRelay() {
+	std::lock_guard<std::mutex> guard(relayLock);
+	relayActive = false;
+	relayTx.clear();
+	relayRx.clear();
+}
+
+bool queueRelayedPdp(const SceNetEtherAddr *mac, u16 sport, u16 dport, const void *data, int len) {
+	if (!relayActive || metasocket == (int)INVALID_SOCKET || len > ADHOCCTL_RELAY_MAX_DATA)
+		return false;
+
+	{
+		std::lock_guard<std::recursive_mutex> peer_guard(peerlock);
+		SceNetAdhocctlPeerInfo *peer = findFriend((SceNetEtherAddr *)mac);
+		if (peer == NULL || !peer->relay)
+			return false;
+	}
+
+	const size_t fullPacket = ADHOCCTL_RELAY_MAX_PACKET - sizeof(SceNetAdhocctlRelayPacket);
+	bool full;
+	{
+		std::lock_guard<std::mutex> guard(relayLock);
+		if (relayTx.size() + sizeof(SceNetAdhocctlRelayEntry) + len > ADHOCCTL_RELAY_MAX_QUEUED)
+			return false;
+		if (relayTx.empty())
+			relayTxSince = (u64)(time_now_d() * 1000000.0);
+
+		SceNetAdhocctlRelayEntry entry;
+		entry.mac = *mac;
+		entry.sport = sport;
+		entry.dport = dport;
+		entry.len = (uint16_t)len;
+		const size_t before = relayTx.size();
+		relayTx.insert(relayTx.end(), (const u8 *)&entry, (const u8 *)&entry + sizeof(entry));
+		relayTx.insert(relayTx.end(), (const u8 *)data, (const u8 *)data + len);
+		full = before < fullPacket && relayTx.size() >= fullPacket;
+	}
+
+	// A whole packet's worth doesn't need to wait for more.
+	if (full)
+		wakeFriendFinder();
+	return true;
+}
+
+// Sends the queued Relay Entries once they're due.  Returns how many microseconds until they are, or -1 if nothing is queued.
+static int flushRelayedPdp() {
+	const size_t maxPayload = ADHOCCTL_RELAY_MAX_PACKET - sizeof(SceNetAdhocctlRelayPacket);
+	std::vector<u8> wire;
+	{
+		std::lock_guard<std::mutex> guard(relayLock);
+		if (relayTx.empty())
+			return -1;
+		s64 due = (s64)(relayTxSince + ADHOCCTL_RELAY_FLUSH_US) - (s64)(time_now_d() * 1000000.0);
+		if (due > 0 && relayTx.size() < maxPayload)
+			return (int)due;
+
+		// Split at entry boundaries, so each Relay Packet fits the receive buffers.
+		size_t pos = 0;
+		while (pos < relayTx.size()) {
+			size_t end = pos;
+			while (end < relayTx.size()) {
+				const SceNetAdhocctlRelayEntry *entry = (const SceNetAdhocctlRelayEntry *)&relayTx[end];
+				size_t next = end + sizeof(SceNetAdhocctlRelayEntry) + entry->len;
+				if (next - pos > maxPayload)
+					break;
+				end = next;
+			}
+
+			SceNetAdhocctlRelayPacket header;
+			header.base.opcode = OPCODE_RELAY;
+			header.size = (uint16_t)(end - pos);
+			wire.insert(wire.end(), (const u8 *)&header, (const u8 *)&header + sizeof(header));
+			wire.insert(wire.end(), relayTx.begin() + pos, relayTx.begin() + end);
+			pos = end;
+		}
+		relayTx.clear();
+	}
+
+	// Has to go out whole, a partial packet would throw off the stream.
+	size_t sent = 0;
+	while (sent < wire.size()) {
+		int ret = (int)send((int)metasocket, (const char *)wire.data() + sent, (int)(wire.size() - sent), MSG_NOSIGNAL);
+		int error = errno;
+		if (ret > 0) {
+			sent += ret;
+		} else if (ret == SOCKET_ERROR && (error == EAGAIN || error == EWOULDBLOCK) && IsSocketReady((int)metasocket, false, true, nullptr, PSP_ADHOCCTL_RECV_TIMEOUT) > 0) {
+			continue;
+		} else {
+			WARN_LOG(Log::sceNet, "FriendFinder: Socket Error (%i) when relaying, dropped %d bytes", error, (int)(wire.size() - sent));
+			break;
+		}
+	}
+	return -1;
+}
+
+// Handles the Relay Entries in a Relay Packet from the Adhoc Server.
+static void handleRelayedPdp(const u8 *payload, int size) {
+	// An empty one confirms that it relays for us.
+	if (size == 0) {
+		if (!relayActive)
+			INFO_LOG(Log::sceNet, "FriendFinder: Adhoc Server relays PDP packets");
+		relayActive = true;
+		return;
+	}
+
+	int pos = 0;
+	while (pos + (int)sizeof(SceNetAdhocctlRelayEntry) <= size) {
+		SceNetAdhocctlRelayEntry entry;
+		memcpy(&entry, payload + pos, sizeof(entry));
+		const u8 *data = payload + pos + sizeof(entry);
+		pos += sizeof(entry) + entry.len;
+		if (pos > size)
+			break;
+
+		if (entry.dport == 0) {
+			std::lock_guard<std::recursive_mutex> peer_guard(peerlock);
+			SceNetAdhocctlPeerInfo *peer = findFriend(&entry.mac);
+			if (peer != NULL && !peer->relay) {
+				INFO_LOG(Log::sceNet, "FriendFinder: Relaying PDP packets for %s", mac2str(&entry.mac).c_str());
+				peer->relay = 1;
+			}
+			continue;
+		}
+
+		std::lock_guard<std::mutex> guard(relayLock);
+		std::deque<RelayedPdpPacket> &queue = relayRx[entry.dport];
+		if (queue.size() >= ADHOCCTL_RELAY_MAX_QUEUED_PACKETS) {
+			DEBUG_LOG(Log::sceNet, "FriendFinder: Dropped relayed PDP packet from %s to port %u", mac2str(&entry.mac).c_str(), entry.dport);
+			continue;
+		}
+		queue.push_back({ entry.mac, entry.sport, std::vector<u8>(data, data + entry.len) });
+	}
+}
+
+int recvRelayedPdp(u16 lport, SceNetEtherAddr *mac, u16 *sport, void *buf, int *len) {
+	int result;
+	{
+		std::lock_guard<std::mutex> guard(relayLock);
+		auto it = relayRx.find(lport);
+		if (it == relayRx.end() || it->second.empty())
+			return 0;
+
+		// Same as a peek when it doesn't fit, the packet stays and the caller learns the size.
+		const RelayedPdpPacket &packet = it->second.front();
+		const int size = (int)packet.data.size();
+		*mac = packet.mac;
+		*sport = packet.sport;
+		if (size > 0 && *len > 0)
+			memcpy(buf, packet.data.data(), std::min(size, *len));
+		result = size <= *len ? 1 : -1;
+		*len = size;
+		if (result > 0)
+			it->second.pop_front();
+	}
+
+	// Update last recv timestamp
+	std::lock_guard<std::recursive_mutex> peer_guard(peerlock);
+	SceNetAdhocctlPeerInfo *peer = findFriend(mac);
+	if (peer != NULL)
+		peer->last_recv = CoreTiming::GetGlobalTimeUsScaled();
+	return result;
+}
+
+int getRelayedPdpAvail(u16 lport) {
+	std::lock_guard<std::mutex> guard(relayLock);
+	auto it = relayRx.find(lport);
+	if (it == relayRx.end())
+		return 0;
+	int avail = 0;
+	for (const RelayedPdpPacket &packet : it->second)
+		avail += (int)packet.data.size();
+	return avail;
+}
+
+void clearRelayedPdp(u16 lport) {
+	std::lock_guard<std::mutex> guard(relayLock);
+	relayRx.erase(lport);
+}
+
 int friendFinder(){
 	SetCurrentThreadName("FriendFinder");
 	auto n = GetI18NCategory(I18NCat::NETWORKING);
@@ -1415,9 +1717,14 @@ int friendFinder(){
 	}
 	g_adhocServerIP.in.sin_port = htons(SERVER_PORT);
 
+	createFriendFinderWakeSocket();
+
 	// Finder Loop
 	friendFinderRunning = true;
 	while (friendFinderRunning) {
+		// Whether a packet was handled, in which case another one might already be waiting
+		bool handledPacket = false;
+
 		// Acquire Network Lock
 		//_acquireNetworkLock();
 
@@ -1492,7 +1799,7 @@ int friendFinder(){
 
 					// Log Incoming Traffic
 					//printf("Received %d Bytes of Data from Server\n", received);
-					INFO_LOG(Log::sceNet, "Received %d Bytes of Data from Adhoc Server", received);
+					DEBUG_LOG(Log::sceNet, "Received %d Bytes of Data from Adhoc Server", received);
 				}
 			}
 
@@ -1503,6 +1810,7 @@ int friendFinder(){
 			}
 
 			// Handle Packets
+			const int pendingRx = rxpos;
 			if (rxpos > 0) {
 				// BSSID Packet
 				if (rx[0] == OPCODE_CONNECT_BSSID) {
@@ -1777,16 +2085,49 @@ int friendFinder(){
 					// Fix RX Buffer Length
 					rxpos -= 1;
 				}
+
+				// Relay Packet
+				else if (rx[0] == OPCODE_RELAY) {
+					// Enough Data available
+					if (rxpos >= (int)sizeof(SceNetAdhocctlRelayPacket)) {
+						// Cast Packet
+						SceNetAdhocctlRelayPacket* packet = (SceNetAdhocctlRelayPacket*)rx;
+						int packetLen = (int)sizeof(SceNetAdhocctlRelayPacket) + packet->size;
+
+						// Can never fit, so nothing after it can be trusted either
+						if (packetLen > (int)sizeof(rx)) {
+							ERROR_LOG(Log::sceNet, "FriendFinder: Oversized Relay Packet (%d bytes)", packetLen);
+							rxpos = 0;
+						}
+						else if (rxpos >= packetLen) {
+							handleRelayedPdp(rx + sizeof(SceNetAdhocctlRelayPacket), packet->size);
+
+							// Move RX Buffer
+							memmove(rx, rx + packetLen, sizeof(rx) - packetLen);
+
+							// Fix RX Buffer Length
+							rxpos -= packetLen;
+						}
+					}
+				}
 			}
+			handledPacket = rxpos < pendingRx;
 		}
-		// This delay time should be 100ms when there is an event otherwise 500ms ?
-		sleep_ms(10, "pro-adhoc-poll-2"); // Using 1ms for faster response just like AdhocServer?
+
+		// Send what was queued for relaying, if it's been waiting long enough
+		int relayDueUS = networkInited ? flushRelayedPdp() : -1;
+
+		// Wait for the next packet (or anything else to do), instead of a fixed sleep that delays every reply
+		if (!handledPacket)
+			waitForFriendFinderEvent(networkInited && rxpos < (int)sizeof(rx), relayDueUS >= 0 ? std::min(relayDueUS, FRIENDFINDER_WAIT_US) : FRIENDFINDER_WAIT_US);
 
 		// Don't do anything if it's paused, otherwise the log will be flooded
 		while (Core_IsStepping() && coreState != CORE_POWERDOWN && friendFinderRunning)
 			sleep_ms(10, "pro-adhoc-paused-poll-2");
 	}
 
+	closeFriendFinderWakeSocket();
+
 	// Groups/Networks should be deallocated isn't?
 
 	// Prevent the games from having trouble to reInitiate Adhoc (the next NetInit -> PdpCreate after NetTerm)
@@ -2036,6 +2377,21 @@ int getSockNoDelay(int tcpsock) {
 	return opt;
 }
 
+bool getSockRTT(int tcpsock, u32 *rttUS, u32 *rttVarUS) {
+#if defined(__linux__)
+	// Kernel measured, so it includes whatever the relay or the other emulator adds.
+	struct tcp_info info{};
+	socklen_t optlen = sizeof(info);
+	if (getsockopt(tcpsock, IPPROTO_TCP, TCP_INFO, (char*)&info, &optlen) != 0 || info.tcpi_rtt == 0)
+		return false;
+	*rttUS = info.tcpi_rtt;
+	*rttVarUS = info.tcpi_rttvar;
+	return true;
+#else
+	return false;
+#endif
+}
+
 //#define TCP_QUICKACK     0x0c
 int setSockNoDelay(int tcpsock, int flag) {
 	int opt = flag;
@@ -2180,6 +2536,8 @@ int getPTPSocketCount() {
 int initNetwork(SceNetAdhocctlAdhocId *adhoc_id){
 	auto n = GetI18NCategory(I18NCat::NETWORKING);
 	int iResult = 0;
+	// A new connection has to ask for relaying again
+	resetRelay();
 	metasocket = (int)INVALID_SOCKET;
 	metasocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 	if (metasocket == INVALID_SOCKET){
@@ -2281,6 +2639,14 @@ int initNetwork(SceNetAdhocctlAdhocId *adhoc_id){
 	DEBUG_LOG(Log::sceNet, "InitNetwork: Sending LOGIN OPCODE %d", packet.base.opcode);
 	int sent = (int)send((int)metasocket, (char*)&packet, sizeof(packet), MSG_NOSIGNAL);
 	if (sent > 0) {
+		// Ask for relaying, the Adhoc Server confirms with an empty Relay Packet if it can
+		if (g_Config.bAdhocRelay) {
+			SceNetAdhocctlRelayPacket relay;
+			relay.base.opcode = OPCODE_RELAY;
+			relay.size = 0;
+			send((int)metasocket, (char*)&relay, sizeof(relay), MSG_NOSIGNAL);
+		}
+
 		socklen_t addrLen = sizeof(LocalIP);
 		memset(&LocalIP, 0, addrLen);
 		getsockname((int)metasocket, &LocalIP, &addrLen);
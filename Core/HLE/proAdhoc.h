@@ -218,6 +218,9 @@ inline bool isDisconnected(int errcode) { return (errcode == EPIPE || errcode ==
 // Timeouts
 #define PSP_ADHOCCTL_RECV_TIMEOUT	100000
 #define PSP_ADHOCCTL_PING_TIMEOUT	2000000
+// Longest the Friend Finder waits without anything happening, since not every state change wakes it
+#define FRIENDFINDER_WAIT_US	100000
+#define PTP_LATENCY_REPORT_INTERVAL	10000000 // How often the measured RTT of each PTP peer gets logged
 
 #ifdef _MSC_VER 
 #pragma pack(push, 1)
@@ -306,6 +309,7 @@ typedef struct SceNetAdhocctlPeerInfo {
   
   u32_le ip_addr; // internal use only
   u16_le port_offset; // IP-specific port offset (internal use only)
+  u8 relay; // accepts PDP packets relayed by the Adhoc Server (internal use only)
 } PACK SceNetAdhocctlPeerInfo;
 
 // Peer Information with u32 pointers
@@ -402,6 +406,7 @@ typedef struct AdhocSocket {
 	s32 attemptCount; // connect/accept attempts
 	u64 lastAttempt; // timestamp to retry again (attempted by the game)
 	u64 internalLastAttempt; // timestamp to retry again (internal use only)
+	u64 lastLatencyReport; // timestamp of the last logged RTT (internal use only)
 	bool isClient; // true if the game is using local port 0 when creating the socket
 	union {
 		SceNetAdhocPdpStat pdp;
@@ -794,6 +799,17 @@ enum {
 #define OPCODE_SCAN_COMPLETE 5
 #define OPCODE_CONNECT_BSSID 6
 #define OPCODE_CHAT 7
+#define OPCODE_RELAY 8
+
+// Relayed PDP Packets, they have to fit the RX Buffers on both ends. Bigger PDP Packets are still sent directly.
+#define ADHOCCTL_RELAY_MAX_PACKET 1024
+#define ADHOCCTL_RELAY_MAX_DATA 512
+// How long small PDP Packets wait for others to be sent along with them
+#define ADHOCCTL_RELAY_FLUSH_US 2000
+// Beyond this, the Adhoc Server can't keep up and PDP Packets are sent directly again
+#define ADHOCCTL_RELAY_MAX_QUEUED 65536
+// Beyond this, relayed PDP Packets nobody receives get dropped, like the socket buffer would
+#define ADHOCCTL_RELAY_MAX_QUEUED_PACKETS 256
 
 // PSP Product Code
 #define PRODUCT_CODE_LENGTH 9
@@ -833,6 +849,20 @@ typedef struct {
   char message[ADHOCCTL_MESSAGE_LEN];
 } PACK SceNetAdhocctlChatPacketC2S;
 
+// C2S/S2C Relay Packet, followed by size Bytes of Relay Entries. An empty one asks for (or confirms) relaying
+typedef struct {
+  SceNetAdhocctlPacketBase base;
+  uint16_t size;
+} PACK SceNetAdhocctlRelayPacket;
+
+// Relay Entry, followed by len Bytes of PDP Data
+typedef struct {
+  SceNetEtherAddr mac; // Destination (C2S) or Source (S2C) Player
+  uint16_t sport;
+  uint16_t dport; // 0 announces that mac accepts relayed Packets too
+  uint16_t len;
+} PACK SceNetAdhocctlRelayEntry;
+
 // S2C Connect Packet
 typedef struct {
   SceNetAdhocctlPacketBase base;
@@ -1118,6 +1148,40 @@ void timeoutFriendsRecursive(SceNetAdhocctlPeerInfo * node, int32_t* count = nul
  */
 int friendFinder();
 
+/**
+ * Wake up the Friend Finder Thread, so it notices state changes right away
+ */
+void wakeFriendFinder();
+
+/**
+ * Send the same Datagram to several Targets, in a single Syscall where supported
+ * @return Number of leading Targets it was sent to, the rest are up to the Caller
+ */
+int sendToPeersBatched(int fd, const void *data, int len, const std::vector<sockaddr_in> &targets);
+
+/**
+ * Queue a PDP Packet to be relayed by the Adhoc Server, if both sides support that
+ * @return true if queued, otherwise it should be sent directly
+ */
+bool queueRelayedPdp(const SceNetEtherAddr *mac, u16 sport, u16 dport, const void *data, int len);
+
+/**
+ * Receive a PDP Packet the Adhoc Server relayed to a local Port
+ * @param len IN: Buffer Size OUT: Packet Size
+ * @return 1 if received, -1 if the Buffer is too small (the Packet stays queued), 0 if there's none
+ */
+int recvRelayedPdp(u16 lport, SceNetEtherAddr *mac, u16 *sport, void *buf, int *len);
+
+/**
+ * Get the Number of Bytes relayed to a local Port that are waiting to be received
+ */
+int getRelayedPdpAvail(u16 lport);
+
+/**
+ * Drop the Packets relayed to a local Port, when its Socket goes away
+ */
+void clearRelayedPdp(u16 lport);
+
 /**
 * Find Free Matching ID
 * @return First unoccupied Matching ID
@@ -1355,6 +1419,11 @@ int getSockError(int sock);
  */
 int getSockNoDelay(int tcpsock);
 
+/*
+ * Get TCP Socket smoothed RTT and its variance (jitter) in microseconds, returns false if the platform can't tell
+ */
+bool getSockRTT(int tcpsock, u32 *rttUS, u32 *rttVarUS);
+
 /*
 * Set TCP Socket TCP_NODELAY (Nagle Algo)
 */
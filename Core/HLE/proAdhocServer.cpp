@@ -26,6 +26,9 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <signal.h>
 
 #if defined(HAVE_LIBNX) || PPSSPP_PLATFORM(SWITCH)
@@ -44,6 +47,7 @@ extern "C" struct hostent *gethostbyname(const char *name);
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #endif
 
 #include <fcntl.h>
@@ -75,6 +79,14 @@ SceNetAdhocctlUserNode * _db_user = NULL;
 // Game Database
 SceNetAdhocctlGameNode * _db_game = NULL;
 
+// Hash Indexes into the Databases (so lookups don't have to walk the lists)
+static std::unordered_map<int, SceNetAdhocctlUserNode *> _db_user_by_stream;
+static std::unordered_map<uint32_t, SceNetAdhocctlUserNode *> _db_user_by_ip;
+static std::unordered_multimap<uint64_t, SceNetAdhocctlUserNode *> _db_user_by_mac;
+static std::unordered_map<std::string, SceNetAdhocctlGameNode *> _db_game_by_product;
+// Keyed by Product Code + Group Name
+static std::unordered_map<std::string, SceNetAdhocctlGroupNode *> _db_group_by_name;
+
 // Server Status
 std::atomic<bool> adhocServerRunning(false);
 std::thread adhocServerThread;
@@ -496,6 +508,60 @@ void change_blocking_mode(int fd, int nonblocking);
 int create_listen_socket(uint16_t port);
 int server_loop(int server);
 
+static uint64_t mac_key(const SceNetEtherAddr &mac)
+{
+	uint64_t key = 0;
+	memcpy(&key, mac.data, sizeof(mac.data));
+	return key;
+}
+
+static std::string product_key(const SceNetAdhocctlProductCode &product)
+{
+	return std::string(product.data, strnlen(product.data, PRODUCT_CODE_LENGTH));
+}
+
+static std::string group_key(const SceNetAdhocctlGameNode *game, const SceNetAdhocctlGroupName &group)
+{
+	// Matches the strncmp() comparison, so anything after a terminator doesn't count.
+	return product_key(game->game) + std::string((const char *)group.data, strnlen((const char *)group.data, ADHOCCTL_GROUPNAME_LEN));
+}
+
+/**
+ * Send Relay Packet to User
+ * @param user Receiving User Node
+ * @param payload Relay Entries
+ * @param size Size of Relay Entries in Bytes
+ */
+static void send_relay_packet(SceNetAdhocctlUserNode * user, const uint8_t * payload, uint16_t size)
+{
+	// Build Packet
+	std::vector<uint8_t> packet(sizeof(SceNetAdhocctlRelayPacket) + size);
+	SceNetAdhocctlRelayPacket * header = (SceNetAdhocctlRelayPacket *)packet.data();
+	header->base.opcode = OPCODE_RELAY;
+	header->size = size;
+	if(size > 0) memcpy(packet.data() + sizeof(SceNetAdhocctlRelayPacket), payload, size);
+
+	// Send Data
+	int iResult = (int)send(user->stream, (const char*)packet.data(), (int)packet.size(), MSG_NOSIGNAL);
+	if (iResult < 0) ERROR_LOG(Log::sceNet, "AdhocServer: send_relay_packet (Socket error %d)", errno);
+}
+
+/**
+ * Tell User that a Peer in its Group accepts relayed PDP Packets
+ * @param user Receiving User Node
+ * @param peer Relaying Peer Node
+ */
+static void announce_relay_peer(SceNetAdhocctlUserNode * user, SceNetAdhocctlUserNode * peer)
+{
+	// Entry without Port
+	SceNetAdhocctlRelayEntry entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.mac = peer->resolver.mac;
+
+	// Send Data
+	send_relay_packet(user, (const uint8_t *)&entry, sizeof(entry));
+}
+
 void __AdhocServerInit() {
 	// Database Product name will update if new game region played on my server to list possible crosslinks
 	productids = std::vector<db_productid>(default_productids, default_productids + ARRAY_SIZE(default_productids));
@@ -513,8 +579,8 @@ void login_user_stream(int fd, uint32_t ip)
 	if(_db_user_count < SERVER_USER_MAXIMUM)
 	{
 		// Check IP Duplication
-		SceNetAdhocctlUserNode * u = _db_user;
-		while(u != NULL && u->resolver.ip != ip) u = u->next;
+		auto dup = _db_user_by_ip.find(ip);
+		SceNetAdhocctlUserNode * u = dup != _db_user_by_ip.end() ? dup->second : NULL;
 
 		if (u != NULL) { // IP Already existed
 			WARN_LOG(Log::sceNet, "AdhocServer: Already Existing IP: %s\n", ip2str(*(in_addr*)&u->resolver.ip).c_str());
@@ -542,6 +608,8 @@ void login_user_stream(int fd, uint32_t ip)
 				user->next = _db_user;
 				if(_db_user != NULL) _db_user->prev = user;
 				_db_user = user;
+				_db_user_by_stream[fd] = user;
+				_db_user_by_ip[ip] = user;
 
 				// Initialize Death Clock
 				user->last_recv = time(NULL);
@@ -586,8 +654,8 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 	if(valid_product_code == 1 && memcmp(&data->mac, "\xFF\xFF\xFF\xFF\xFF\xFF", sizeof(data->mac)) != 0 && memcmp(&data->mac, "\x00\x00\x00\x00\x00\x00", sizeof(data->mac)) != 0 && data->name.data[0] != 0)
 	{
 		// Check for duplicated MAC as most games identify Players by MAC
-		SceNetAdhocctlUserNode* u = _db_user;
-		while (u != NULL && !IsMatch(u->resolver.mac, data->mac)) u = u->next;
+		auto dup = _db_user_by_mac.find(mac_key(data->mac));
+		SceNetAdhocctlUserNode* u = dup != _db_user_by_mac.end() ? dup->second : NULL;
 
 		if (u != NULL) { // MAC Already existed
 			WARN_LOG(Log::sceNet, "AdhocServer: Already Existing MAC: %s [%s]\n", mac2str(&data->mac).c_str(), ip2str(*(in_addr*)&u->resolver.ip).c_str());
@@ -597,8 +665,8 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 		game_product_override(&data->game);
 
 		// Find existing Game
-		SceNetAdhocctlGameNode * game = _db_game;
-		while(game != NULL && strncmp(game->game.data, data->game.data, PRODUCT_CODE_LENGTH) != 0) game = game->next;
+		auto found = _db_game_by_product.find(product_key(data->game));
+		SceNetAdhocctlGameNode * game = found != _db_game_by_product.end() ? found->second : NULL;
 
 		// Game not found
 		if(game == NULL)
@@ -619,6 +687,7 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 				game->next = _db_game;
 				if(_db_game != NULL) _db_game->prev = game;
 				_db_game = game;
+				_db_game_by_product[product_key(game->game)] = game;
 			}
 		}
 
@@ -627,6 +696,7 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 		{
 			// Save MAC
 			user->resolver.mac = data->mac;
+			_db_user_by_mac.emplace(mac_key(user->resolver.mac), user);
 
 			// Save Nickname
 			user->resolver.name = data->name;
@@ -680,6 +750,10 @@ void logout_user(SceNetAdhocctlUserNode * user)
 	// Unlink Rightside
 	if(user->next != NULL) user->next->prev = user->prev;
 
+	// Remove from Indexes
+	_db_user_by_stream.erase(user->stream);
+	_db_user_by_ip.erase(user->resolver.ip);
+
 	// Close Stream
 	closesocket(user->stream);
 
@@ -692,6 +766,15 @@ void logout_user(SceNetAdhocctlUserNode * user)
 		strncpy(safegamestr, user->game->game.data, PRODUCT_CODE_LENGTH);
 		INFO_LOG(Log::sceNet, "AdhocServer: %s (MAC: %s - IP: %s) stopped playing %s", (char *)user->resolver.name.data, mac2str(&user->resolver.mac).c_str(), ip2str(*(in_addr*)&user->resolver.ip).c_str(), safegamestr);
 
+		// Remove from MAC Index
+		auto range = _db_user_by_mac.equal_range(mac_key(user->resolver.mac));
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == user) {
+				_db_user_by_mac.erase(it);
+				break;
+			}
+		}
+
 		// Fix Game Player Count
 		user->game->playercount--;
 
@@ -706,6 +789,7 @@ void logout_user(SceNetAdhocctlUserNode * user)
 
 			// Unlink Rightside
 			if(user->game->next != NULL) user->game->next->prev = user->game->prev;
+			_db_game_by_product.erase(product_key(user->game->game));
 
 			// Free Game Node Memory
 			free(user->game);
@@ -793,8 +877,8 @@ void connect_user(SceNetAdhocctlUserNode * user, SceNetAdhocctlGroupName * group
 		if(user->group == NULL)
 		{
 			// Find Group in Game Node
-			SceNetAdhocctlGroupNode * g = user->game->group;
-			while(g != NULL && strncmp((char *)g->group.data, (char *)group->data, ADHOCCTL_GROUPNAME_LEN) != 0) g = g->next;
+			auto found = _db_group_by_name.find(group_key(user->game, *group));
+			SceNetAdhocctlGroupNode * g = found != _db_group_by_name.end() ? found->second : NULL;
 
 			// BSSID Packet
 			SceNetAdhocctlConnectBSSIDPacketS2C bssid;
@@ -827,6 +911,7 @@ void connect_user(SceNetAdhocctlUserNode * user, SceNetAdhocctlGroupName * group
 
 					// Copy Group Name
 					g->group = *group;
+					_db_group_by_name[group_key(g->game, g->group)] = g;
 
 					// Increase Group Counter for Game
 					g->game->groupcount++;
@@ -875,6 +960,13 @@ void connect_user(SceNetAdhocctlUserNode * user, SceNetAdhocctlGroupName * group
 					iResult = (int)send(user->stream, (const char*)&packet, sizeof(packet), MSG_NOSIGNAL);
 					if (iResult < 0) ERROR_LOG(Log::sceNet, "AdhocServer: connect_user[send user] (Socket error %d)", errno);
 
+					// Both sides can relay for each other
+					if(user->relay && peer->relay)
+					{
+						announce_relay_peer(peer, user);
+						announce_relay_peer(user, peer);
+					}
+
 					// Set BSSID
 					if(peer->group_next == NULL) bssid.mac = peer->resolver.mac;
 
@@ -1013,6 +1105,7 @@ void disconnect_user(SceNetAdhocctlUserNode * user)
 
 			// Unlink Rightside
 			if(user->group->next != NULL) user->group->next->prev = user->group->prev;
+			_db_group_by_name.erase(group_key(user->group->game, user->group->group));
 
 			// Free Group Memory
 			free(user->group);
@@ -1872,6 +1965,246 @@ int create_listen_socket(uint16_t port)
 	return -1;
 }
 
+/**
+ * Handle the Packet at the Start of a User's RX Buffer
+ * @param user User Node
+ * @return 1 if a Packet was handled and the User is still logged in, 0 otherwise
+ */
+/**
+ * Relay PDP Packets to other Users in the Group
+ * @param user Sending User Node
+ * @param payload Relay Entries
+ * @param size Size of Relay Entries in Bytes
+ */
+static void relay_packets(SceNetAdhocctlUserNode * user, const uint8_t * payload, uint16_t size)
+{
+	// Empty Packet asks for Relaying
+	if(size == 0)
+	{
+		// Already relaying
+		if(user->relay) return;
+
+		// Confirm Relaying
+		user->relay = 1;
+		send_relay_packet(user, NULL, 0);
+		INFO_LOG(Log::sceNet, "AdhocServer: %s (MAC: %s - IP: %s) uses relaying", (char *)user->resolver.name.data, mac2str(&user->resolver.mac).c_str(), ip2str(*(in_addr*)&user->resolver.ip).c_str());
+
+		// Already in a Group (otherwise connect_user announces it)
+		if(user->group != NULL)
+		{
+			SceNetAdhocctlUserNode * peer = user->group->player;
+			for(; peer != NULL; peer = peer->group_next)
+			{
+				if(peer == user || !peer->relay) continue;
+				announce_relay_peer(peer, user);
+				announce_relay_peer(user, peer);
+			}
+		}
+		return;
+	}
+
+	// Not Relaying for User, or nobody to relay to
+	if(!user->relay || user->group == NULL) return;
+
+	// Coalesce Entries by Target, one Packet each
+	std::unordered_map<SceNetAdhocctlUserNode *, std::vector<uint8_t>> targets;
+	uint32_t pos = 0;
+	while(pos + sizeof(SceNetAdhocctlRelayEntry) <= size)
+	{
+		// Clone Entry
+		SceNetAdhocctlRelayEntry entry;
+		memcpy(&entry, payload + pos, sizeof(entry));
+		const uint8_t * data = payload + pos + sizeof(entry);
+		pos += sizeof(entry) + entry.len;
+		if(pos > size) break;
+
+		// Find Target in Group
+		SceNetAdhocctlUserNode * peer = user->group->player;
+		while(peer != NULL && (peer == user || memcmp(peer->resolver.mac.data, entry.mac.data, ETHER_ADDR_LEN) != 0)) peer = peer->group_next;
+		if(peer == NULL || !peer->relay || entry.dport == 0) continue;
+
+		// Target needs to know where it came from
+		entry.mac = user->resolver.mac;
+		std::vector<uint8_t> & buffer = targets[peer];
+		buffer.insert(buffer.end(), (const uint8_t *)&entry, (const uint8_t *)&entry + sizeof(entry));
+		buffer.insert(buffer.end(), data, data + entry.len);
+	}
+
+	// Entries keep their size, so each Target still fits into one Packet
+	for(auto & target : targets) send_relay_packet(target.first, target.second.data(), (uint16_t)target.second.size());
+}
+
+static int handle_user_packet(SceNetAdhocctlUserNode * user)
+{
+	// Remember these, since the User might get logged out
+	int stream = user->stream;
+	uint32_t rxpos = user->rxpos;
+
+	// Waiting for Login Packet
+	if(get_user_state(user) == USER_STATE_WAITING)
+	{
+		// Valid Opcode
+		if(user->rx[0] == OPCODE_LOGIN)
+		{
+			// Enough Data available
+			if(user->rxpos >= sizeof(SceNetAdhocctlLoginPacketC2S))
+			{
+				// Clone Packet
+				SceNetAdhocctlLoginPacketC2S packet = *(SceNetAdhocctlLoginPacketC2S *)user->rx;
+
+				// Remove Packet from RX Buffer
+				clear_user_rxbuf(user, sizeof(SceNetAdhocctlLoginPacketC2S));
+
+				// Login User (Data)
+				login_user_data(user, &packet);
+			}
+		}
+
+		// Invalid Opcode
+		else
+		{
+			// Notify User
+			WARN_LOG(Log::sceNet, "AdhocServer: Invalid Opcode 0x%02X in Waiting State from %s", user->rx[0], ip2str(*(in_addr*)&user->resolver.ip).c_str());
+
+			// Logout User
+			logout_user(user);
+		}
+	}
+
+	// Logged-In User
+	else if(get_user_state(user) == USER_STATE_LOGGED_IN)
+	{
+		// Ping Packet
+		if(user->rx[0] == OPCODE_PING)
+		{
+			// Delete Packet from RX Buffer
+			clear_user_rxbuf(user, 1);
+		}
+
+		// Group Connect Packet
+		else if(user->rx[0] == OPCODE_CONNECT)
+		{
+			// Enough Data available
+			if(user->rxpos >= sizeof(SceNetAdhocctlConnectPacketC2S))
+			{
+				// Cast Packet
+				SceNetAdhocctlConnectPacketC2S * packet = (SceNetAdhocctlConnectPacketC2S *)user->rx;
+
+				// Clone Group Name
+				SceNetAdhocctlGroupName group = packet->group;
+
+				// Remove Packet from RX Buffer
+				clear_user_rxbuf(user, sizeof(SceNetAdhocctlConnectPacketC2S));
+
+				// Change Game Group
+				connect_user(user, &group);
+			}
+		}
+
+		// Group Disconnect Packet
+		else if(user->rx[0] == OPCODE_DISCONNECT)
+		{
+			// Remove Packet from RX Buffer
+			clear_user_rxbuf(user, 1);
+
+			// Leave Game Group
+			disconnect_user(user);
+		}
+
+		// Network Scan Packet
+		else if(user->rx[0] == OPCODE_SCAN)
+		{
+			// Remove Packet from RX Buffer
+			clear_user_rxbuf(user, 1);
+
+			// Send Network List
+			send_scan_results(user);
+		}
+
+		// Chat Text Packet
+		else if(user->rx[0] == OPCODE_CHAT)
+		{
+			// Enough Data available
+			if(user->rxpos >= sizeof(SceNetAdhocctlChatPacketC2S))
+			{
+				// Cast Packet
+				SceNetAdhocctlChatPacketC2S * packet = (SceNetAdhocctlChatPacketC2S *)user->rx;
+
+				// Clone Buffer for Message
+				char message[64];
+				memset(message, 0, sizeof(message));
+				strncpy(message, packet->message, sizeof(message) - 1);
+
+				// Remove Packet from RX Buffer
+				clear_user_rxbuf(user, sizeof(SceNetAdhocctlChatPacketC2S));
+
+				// Spread Chat Message
+				spread_message(user, message);
+			}
+		}
+
+		// Relay Packet
+		else if(user->rx[0] == OPCODE_RELAY)
+		{
+			// Enough Data available
+			if(user->rxpos >= sizeof(SceNetAdhocctlRelayPacket))
+			{
+				// Cast Packet
+				SceNetAdhocctlRelayPacket * packet = (SceNetAdhocctlRelayPacket *)user->rx;
+				uint32_t length = sizeof(SceNetAdhocctlRelayPacket) + packet->size;
+
+				// Can never fit into the RX Buffer
+				if(length > sizeof(user->rx))
+				{
+					// Notify User
+					WARN_LOG(Log::sceNet, "AdhocServer: Oversized Relay Packet from %s (MAC: %s - IP: %s)", (char *)user->resolver.name.data, mac2str(&user->resolver.mac).c_str(), ip2str(*(in_addr*)&user->resolver.ip).c_str());
+
+					// Logout User
+					logout_user(user);
+				}
+
+				// Whole Packet available
+				else if(user->rxpos >= length)
+				{
+					// Clone Relay Entries
+					std::vector<uint8_t> payload(user->rx + sizeof(SceNetAdhocctlRelayPacket), user->rx + length);
+
+					// Remove Packet from RX Buffer
+					clear_user_rxbuf(user, length);
+
+					// Relay to Group
+					relay_packets(user, payload.data(), (uint16_t)payload.size());
+				}
+			}
+		}
+
+		// Invalid Opcode
+		else
+		{
+			// Notify User
+			WARN_LOG(Log::sceNet, "AdhocServer: Invalid Opcode 0x%02X in Logged-In State from %s (MAC: %s - IP: %s)", user->rx[0], (char *)user->resolver.name.data, mac2str(&user->resolver.mac).c_str(), ip2str(*(in_addr*)&user->resolver.ip).c_str());
+
+			// Logout User
+			logout_user(user);
+		}
+	}
+
+	// User was logged out
+	if(_db_user_by_stream.find(stream) == _db_user_by_stream.end()) return 0;
+
+	// Packet was consumed (otherwise more Data is needed)
+	return user->rxpos < rxpos;
+}
+
+static int poll_sockets(std::vector<pollfd> &fds, int timeout)
+{
+#if defined(_WIN32)
+	return WSAPoll(fds.data(), (ULONG)fds.size(), timeout);
+#else
+	return poll(fds.data(), (nfds_t)fds.size(), timeout);
+#endif
+}
+
 /**
  * Server Main Loop
  * @param server Server Listening Socket
@@ -1886,10 +2219,40 @@ int server_loop(int server)
 	// Create Empty Status Logfile
 	update_status();
 
+	// Reused for every Wait
+	std::vector<pollfd> fds;
+	std::vector<SceNetAdhocctlUserNode *> polled;
+	time_t lasttimeoutcheck = time(NULL);
+
 	// Handling Loop
 	while (adhocServerRunning) //(_status == 1)
 	{
+		// Wait for Activity, instead of polling every User
+		fds.clear();
+		polled.clear();
+		pollfd serverfd{};
+		serverfd.fd = server;
+		serverfd.events = POLLIN;
+		fds.push_back(serverfd);
+		for(SceNetAdhocctlUserNode * u = _db_user; u != NULL; u = u->next)
+		{
+			pollfd userfd{};
+			userfd.fd = u->stream;
+			userfd.events = POLLIN;
+			fds.push_back(userfd);
+			polled.push_back(u);
+		}
+
+		// Wake up regularly anyway, for Timeouts and Shutdown
+		int pollresult = poll_sockets(fds, SERVER_POLL_INTERVAL);
+		if(pollresult < 0)
+		{
+			ERROR_LOG(Log::sceNet, "AdhocServer: poll failed (Socket error %d)", errno);
+			sleep_ms(SERVER_POLL_INTERVAL, "pro-adhoc-poll-error");
+		}
+
 		// Login Block
+		if(pollresult > 0 && fds[0].revents != 0)
 		{
 			// Login Result
 			int loginresult = 0;
@@ -1931,159 +2294,57 @@ int server_loop(int server)
 			} while(loginresult != -1);
 		}
 
-		// Receive Data from Users
-		SceNetAdhocctlUserNode * user = _db_user;
-		while(user != NULL)
+		// Receive Data from Users (only they can be logged out in there, the others stay valid)
+		for(size_t i = 0; pollresult > 0 && i < polled.size(); i++)
 		{
-			// Next User (for safe delete)
-			SceNetAdhocctlUserNode * next = user->next;
+			// Nothing happened
+			if(fds[i + 1].revents == 0) continue;
+
+			SceNetAdhocctlUserNode * user = polled[i];
 
 			// Receive Data from User
 			int recvresult = (int)recv(user->stream, (char*)user->rx + user->rxpos, sizeof(user->rx) - user->rxpos, MSG_NOSIGNAL);
 
-			// Connection Closed or Timed Out
-			if(recvresult == 0 || (recvresult == -1 && errno != EAGAIN && errno != EWOULDBLOCK) || get_user_state(user) == USER_STATE_TIMED_OUT)
+			// Connection Closed
+			if(recvresult == 0 || (recvresult == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
 			{
 				// Logout User
 				logout_user(user);
 			}
 
-			// Received Data (or leftovers in RX-Buffer)
-			else if(recvresult > 0 || user->rxpos > 0)
+			// Received Data
+			else if(recvresult > 0)
 			{
-				// New Incoming Data
-				if(recvresult > 0)
-				{
-					// Move RX Pointer
-					user->rxpos += recvresult;
-
-					// Update Death Clock
-					user->last_recv = time(NULL);
-				}
-
-				// Waiting for Login Packet
-				if(get_user_state(user) == USER_STATE_WAITING)
-				{
-					// Valid Opcode
-					if(user->rx[0] == OPCODE_LOGIN)
-					{
-						// Enough Data available
-						if(user->rxpos >= sizeof(SceNetAdhocctlLoginPacketC2S))
-						{
-							// Clone Packet
-							SceNetAdhocctlLoginPacketC2S packet = *(SceNetAdhocctlLoginPacketC2S *)user->rx;
+				// Move RX Pointer
+				user->rxpos += recvresult;
 
-							// Remove Packet from RX Buffer
-							clear_user_rxbuf(user, sizeof(SceNetAdhocctlLoginPacketC2S));
-
-							// Login User (Data)
-							login_user_data(user, &packet);
-						}
-					}
-
-					// Invalid Opcode
-					else
-					{
-						// Notify User
-						WARN_LOG(Log::sceNet, "AdhocServer: Invalid Opcode 0x%02X in Waiting State from %s", user->rx[0], ip2str(*(in_addr*)&user->resolver.ip).c_str());
-
-						// Logout User
-						logout_user(user);
-					}
-				}
-
-				// Logged-In User
-				else if(get_user_state(user) == USER_STATE_LOGGED_IN)
-				{
-					// Ping Packet
-					if(user->rx[0] == OPCODE_PING)
-					{
-						// Delete Packet from RX Buffer
-						clear_user_rxbuf(user, 1);
-					}
-
-					// Group Connect Packet
-					else if(user->rx[0] == OPCODE_CONNECT)
-					{
-						// Enough Data available
-						if(user->rxpos >= sizeof(SceNetAdhocctlConnectPacketC2S))
-						{
-							// Cast Packet
-							SceNetAdhocctlConnectPacketC2S * packet = (SceNetAdhocctlConnectPacketC2S *)user->rx;
-
-							// Clone Group Name
-							SceNetAdhocctlGroupName group = packet->group;
-
-							// Remove Packet from RX Buffer
-							clear_user_rxbuf(user, sizeof(SceNetAdhocctlConnectPacketC2S));
-
-							// Change Game Group
-							connect_user(user, &group);
-						}
-					}
-
-					// Group Disconnect Packet
-					else if(user->rx[0] == OPCODE_DISCONNECT)
-					{
-						// Remove Packet from RX Buffer
-						clear_user_rxbuf(user, 1);
-
-						// Leave Game Group
-						disconnect_user(user);
-					}
-
-					// Network Scan Packet
-					else if(user->rx[0] == OPCODE_SCAN)
-					{
-						// Remove Packet from RX Buffer
-						clear_user_rxbuf(user, 1);
-
-						// Send Network List
-						send_scan_results(user);
-					}
-
-					// Chat Text Packet
-					else if(user->rx[0] == OPCODE_CHAT)
-					{
-						// Enough Data available
-						if(user->rxpos >= sizeof(SceNetAdhocctlChatPacketC2S))
-						{
-							// Cast Packet
-							SceNetAdhocctlChatPacketC2S * packet = (SceNetAdhocctlChatPacketC2S *)user->rx;
-
-							// Clone Buffer for Message
-							char message[64];
-							memset(message, 0, sizeof(message));
-							strncpy(message, packet->message, sizeof(message) - 1);
+				// Update Death Clock
+				user->last_recv = time(NULL);
 
-							// Remove Packet from RX Buffer
-							clear_user_rxbuf(user, sizeof(SceNetAdhocctlChatPacketC2S));
+				// Handle everything complete in the RX Buffer, the rest has to wait for more Data
+				while(user->rxpos > 0 && handle_user_packet(user) == 1);
+			}
+		}
 
-							// Spread Chat Message
-							spread_message(user, message);
-						}
-					}
+		// Check for Timeouts once per Second
+		time_t now = time(NULL);
+		if(now != lasttimeoutcheck)
+		{
+			lasttimeoutcheck = now;
+			SceNetAdhocctlUserNode * user = _db_user;
+			while(user != NULL)
+			{
+				// Next User (for safe delete)
+				SceNetAdhocctlUserNode * next = user->next;
 
-					// Invalid Opcode
-					else
-					{
-						// Notify User
-						WARN_LOG(Log::sceNet, "AdhocServer: Invalid Opcode 0x%02X in Logged-In State from %s (MAC: %s - IP: %s)", user->rx[0], (char *)user->resolver.name.data, mac2str(&user->resolver.mac).c_str(), ip2str(*(in_addr*)&user->resolver.ip).c_str());
+				// Logout User
+				if(get_user_state(user) == USER_STATE_TIMED_OUT) logout_user(user);
 
-						// Logout User
-						logout_user(user);
-					}
-				}
+				// Move Pointer
+				user = next;
 			}
-
-			// Move Pointer
-			user = next;
 		}
 
-		// Prevent needless CPU Overload (1ms Sleep)
-		// !!!! COMMENT NOT REFLECTING REALITY
-		sleep_ms(10, "pro-adhoc-poll");
-
 		// Don't do anything if it's paused, otherwise the log will be flooded
 		while (adhocServerRunning && Core_IsStepping() && coreState != CORE_POWERDOWN)
 			sleep_ms(10, "pro-adhot-paused-poll");
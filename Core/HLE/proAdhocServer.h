@@ -39,6 +39,9 @@
 // Server User Timeout (in seconds)
 #define SERVER_USER_TIMEOUT 15
 
+// Server Wakeup Interval without Activity (in milliseconds)
+#define SERVER_POLL_INTERVAL 100
+
 // Server SQLite3 Database
 #define SERVER_DATABASE "database.db"
 
@@ -217,6 +220,9 @@ typedef struct SceNetAdhocctlUserNode {
 	// Last Ping Update
 	time_t last_recv;
 
+	// Asked for PDP Relaying
+	int relay;
+
 	// RX Buffer
 	uint8_t rx[1024];
 	uint32_t rxpos;
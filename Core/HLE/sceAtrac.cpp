@@ -109,6 +109,7 @@ void __AtracShutdown() {
 		delete atracContexts[i];
 		atracContexts[i] = nullptr;
 	}
+	ClearAtracFrameCache();
 }
 
 void __AtracLoadModule(int version, u32 crc) {
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include "Common/CPUDetect.h"
 #include "Core/MemMapHelpers.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/FunctionWrappers.h"
@@ -23,6 +24,7 @@
 #include "Core/HLE/sceKernel.h"
 extern "C"
 {
+#include "ext/libkirk/AES.h"
 #include "ext/libkirk/kirk_engine.h"
 }
 
@@ -526,5 +528,6 @@ const HLEFunction sceChnnlsv[] =
 void Register_sceChnnlsv()
 {
 	RegisterModule("sceChnnlsv", ARRAY_SIZE(sceChnnlsv), sceChnnlsv);
+	AES_set_hw_enabled(cpu_info.bAES);
 	kirk_init();
 }
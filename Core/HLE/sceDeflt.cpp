@@ -54,8 +54,13 @@ static int CommonDecompress(int windowBits, u32 OutBuffer, int OutBufferLength,
 		return hleLogError(Log::HLE, 0, "inflate failed %08x", err);
 	}
 	if (crc32Addr.IsValid()) {
-		uLong crc = crc32(0L, Z_NULL, 0);
-		*crc32Addr = crc32(crc, outBufferPtr, stream.total_out);
+		if (windowBits > MAX_WBITS) {
+			// For gzip, inflate already computed (and verified) the crc32 of the output.
+			*crc32Addr = (u32)stream.adler;
+		} else {
+			uLong crc = crc32(0L, Z_NULL, 0);
+			*crc32Addr = crc32(crc, outBufferPtr, stream.total_out);
+		}
 	}
 
 	if (MemBlockInfoDetailed(stream.total_in, stream.total_out)) {
@@ -29,6 +29,7 @@
 
 #include "Common/Data/Text/I18n.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/System/System.h"
 #include "Common/System/OSD.h"
 #include "Common/Serialize/Serializer.h"
@@ -52,6 +53,7 @@
 #include "Core/Util/PPGeDraw.h"
 #include "Core/RetroAchievements.h"
 
+#include "GPU/GeThread.h"
 #include "GPU/GPU.h"
 #include "GPU/GPUState.h"
 #include "GPU/GPUCommon.h"
@@ -258,6 +260,7 @@ void __DisplayDoState(PointerWrap &p) {
 		ScheduleLagSync();
 	}
 
+	GeThread::Sync();
 	Do(p, gstate);
 
 	// TODO: GPU stuff is really not the responsibility of sceDisplay.
@@ -395,6 +398,7 @@ static void DoFrameDropLogging(float scaledTimestep) {
 // This is called just before we drop out of the main loop, in order to allow the submit and present to happen.
 static void DoFrameTiming(bool throttle, bool *skipFrame, float scaledTimestep, bool endOfFrame) {
 	PROFILE_THIS_SCOPE("timing");
+	TRACE_SCOPE("frame_timing");
 	*skipFrame = false;
 
 	// Check if the frameskipping code should be enabled. If neither throttling or frameskipping is on,
@@ -412,6 +416,8 @@ static void DoFrameTiming(bool throttle, bool *skipFrame, float scaledTimestep,
 
 		nextFrameTime = std::max(lastFrameTime + scaledTimestep, time_now_d() - maxFallBehindFrames * scaledTimestep);
 	}
+	// Shifts the phase of our frames relative to vblank, if present feedback says we're starting them too early.
+	nextFrameTime += g_frameTiming.ConsumePacingAdjustment();
 	curFrameTime = time_now_d();
 
 	if (g_Config.bLogFrameDrops) {
@@ -564,6 +570,7 @@ static void NotifyUserIfSlow() {
 }
 
 void __DisplayFlip(int cyclesLate) {
+	Tracer::Instant("flip");
 	__DisplaySetFramerate();
 
 	flippedThisFrame = true;
@@ -647,7 +654,8 @@ void __DisplayFlip(int cyclesLate) {
 		if (!forceNoFlip)
 			nextFrame = Core_NextFrame();
 		if (nextFrame) {
-			gpu->CopyDisplayToOutput(fbReallyDirty);
+			if (!PSP_CoreParameter().runAheadHideVideo)
+				gpu->CopyDisplayToOutput(fbReallyDirty);
 			if (fbReallyDirty) {
 				DisplayFireActualFlip();
 			}
@@ -660,33 +668,58 @@ void __DisplayFlip(int cyclesLate) {
 		gpuStats.numFlips++;
 	}
 
-	bool throttle = FrameTimingThrottled();
+	// Run-ahead times its frames once, as the one that's shown.
+	if (!PSP_CoreParameter().runAheadHideVideo) {
+		bool throttle = FrameTimingThrottled();
 
-	int fpsLimit = FrameTimingLimit();
-	float scaledTimestep = (float)numVBlanksSinceFlip * timePerVblank;
-	if (fpsLimit > 0 && fpsLimit != framerate) {
-		scaledTimestep *= (float)framerate / fpsLimit;
-	}
-	bool skipFrame;
-	DoFrameTiming(throttle, &skipFrame, scaledTimestep, nextFrame);
+		int fpsLimit = FrameTimingLimit();
+		float scaledTimestep = (float)numVBlanksSinceFlip * timePerVblank;
+		if (fpsLimit > 0 && fpsLimit != framerate) {
+			scaledTimestep *= (float)framerate / fpsLimit;
+		}
+		bool skipFrame;
+		DoFrameTiming(throttle, &skipFrame, scaledTimestep, nextFrame);
+
+		int maxFrameskip = 8;
+		int frameSkipNum = DisplayCalculateFrameSkip();
+		if (throttle) {
+			// 4 here means 1 drawn, 4 skipped - so 12 fps minimum.
+			maxFrameskip = frameSkipNum;
+		}
+		if (numSkippedFrames >= maxFrameskip || gpuDebug->GetRecorder()->IsActivePending()) {
+			skipFrame = false;
+		}
 
-	int maxFrameskip = 8;
-	int frameSkipNum = DisplayCalculateFrameSkip();
-	if (throttle) {
-		// 4 here means 1 drawn, 4 skipped - so 12 fps minimum.
-		maxFrameskip = frameSkipNum;
-	}
-	if (numSkippedFrames >= maxFrameskip || gpuDebug->GetRecorder()->IsActivePending()) {
-		skipFrame = false;
-	}
+		// When fast-forwarding, only draw about as many frames as the display can show.
+		// The framebuffer manager still draws to buffers the game reads back, see SKIPDRAW_FAST_FORWARD.
+		bool fastForwardSkipDraw = false;
+		if (g_Config.iFastForwardMode == (int)FastForwardMode::SKIP_DRAW && (!throttle || refreshRateNeedsSkip) && !gpuDebug->GetRecorder()->IsActivePending()) {
+			static double lastDrawnFrame = 0;
+			double now = time_now_d();
+			if (!skipFrame && numSkippedFrames < 60 && (now - lastDrawnFrame) < 1.0f / refreshRate) {
+				fastForwardSkipDraw = true;
+			} else if (!skipFrame) {
+				lastDrawnFrame = now;
+			}
+		}
 
-	if (skipFrame) {
-		// Tell the emulated GPU to skip the next frame.
-		gstate_c.skipDrawReason |= SKIPDRAW_SKIPFRAME;
-		numSkippedFrames++;
-	} else {
-		gstate_c.skipDrawReason &= ~SKIPDRAW_SKIPFRAME;
-		numSkippedFrames = 0;
+		if (fastForwardSkipDraw) {
+			gstate_c.skipDrawReason |= SKIPDRAW_FAST_FORWARD | SKIPDRAW_SKIPFRAME;
+			// Make sure the first draw re-evaluates its render target.
+			gstate_c.Dirty(DIRTY_FRAMEBUF);
+			numSkippedFrames++;
+		} else if (skipFrame) {
+			// Tell the emulated GPU to skip the next frame.
+			gstate_c.skipDrawReason &= ~SKIPDRAW_FAST_FORWARD;
+			gstate_c.skipDrawReason |= SKIPDRAW_SKIPFRAME;
+			numSkippedFrames++;
+		} else {
+			if (gstate_c.skipDrawReason & SKIPDRAW_FAST_FORWARD) {
+				gstate_c.Dirty(DIRTY_FRAMEBUF);
+			}
+			gstate_c.skipDrawReason &= ~(SKIPDRAW_SKIPFRAME | SKIPDRAW_FAST_FORWARD);
+			numSkippedFrames = 0;
+		}
 	}
 
 	// Returning here with coreState == CORE_NEXTFRAME causes a buffer flip to happen (next frame).
@@ -1108,8 +1141,8 @@ const HLEFunction sceDisplay[] = {
 	{0X8EB9EC49, &WrapU_V<sceDisplayWaitVblankCB>,            "sceDisplayWaitVblankCB",            'x', "",   HLE_NOT_DISPATCH_SUSPENDED },
 	{0X46F186C3, &WrapU_V<sceDisplayWaitVblankStartCB>,       "sceDisplayWaitVblankStartCB",       'x', "",   HLE_NOT_IN_INTERRUPT | HLE_NOT_DISPATCH_SUSPENDED },
 	{0X77ED8B3A, &WrapU_I<sceDisplayWaitVblankStartMultiCB>,  "sceDisplayWaitVblankStartMultiCB",  'x', "i"   },
-	{0XDBA6C4C4, &WrapF_V<sceDisplayGetFramePerSec>,          "sceDisplayGetFramePerSec",          'f', ""    },
-	{0X773DD3A3, &WrapU_V<sceDisplayGetCurrentHcount>,        "sceDisplayGetCurrentHcount",        'x', ""    },
+	{0XDBA6C4C4, &WrapF_V<sceDisplayGetFramePerSec>,          "sceDisplayGetFramePerSec",          'f', "",   HLE_FAST_CALL },
+	{0X773DD3A3, &WrapU_V<sceDisplayGetCurrentHcount>,        "sceDisplayGetCurrentHcount",        'x', "",   HLE_FAST_CALL },
 	{0X210EAB3A, &WrapI_V<sceDisplayGetAccumulatedHcount>,    "sceDisplayGetAccumulatedHcount",    'i', ""    },
 	{0XA83EF139, &WrapI_I<sceDisplayAdjustAccumulatedHcount>, "sceDisplayAdjustAccumulatedHcount", 'i', "i"   },
 	{0X9C6EAAD7, &WrapU_V<sceDisplayGetVcount>,               "sceDisplayGetVcount",               'x', ""    },
@@ -1120,7 +1153,7 @@ const HLEFunction sceDisplay[] = {
 	{0XB4F378FA, &WrapU_V<sceDisplayIsForeground>,            "sceDisplayIsForeground",            'x', ""    },
 	{0X31C4BAA8, &WrapU_UU<sceDisplayGetBrightness>,          "sceDisplayGetBrightness",           'x', "pp"  },
 	{0X9E3C6DC6, &WrapU_II<sceDisplaySetBrightness>,          "sceDisplaySetBrightness",           'x', "ii"  },
-	{0X4D4E10EC, &WrapU_V<sceDisplayIsVblank>,                "sceDisplayIsVblank",                'x', ""    },
+	{0X4D4E10EC, &WrapU_V<sceDisplayIsVblank>,                "sceDisplayIsVblank",                'x', "",   HLE_FAST_CALL },
 	{0X21038913, &WrapU_V<sceDisplayIsVsync>,                 "sceDisplayIsVsync",                 'x', ""    },
 };
 
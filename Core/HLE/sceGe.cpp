@@ -37,6 +37,7 @@
 #include "Core/HLE/sceKernelThread.h"
 #include "Core/HLE/sceKernelInterrupt.h"
 #include "Core/HLE/KernelWaitHelpers.h"
+#include "GPU/GeThread.h"
 #include "GPU/GPUState.h"
 #include "GPU/GPUCommon.h"
 
@@ -59,12 +60,37 @@ static ThreadSafeList<GeInterruptData> ge_pending_cb;
 static int geSyncEvent;
 static int geInterruptEvent;
 static int geCycleEvent;
+static int geThreadEvent;
+
+// How far the CPU may run ahead of the GE thread, before waiting for what it signals.
+static const int GE_THREAD_MAX_LEAD_US = 2000;
+
+struct GeDeferredTrigger {
+	bool interrupt;
+	int id;
+	u32 pcOrType;
+	u64 atTicks;
+};
+
+// Queued by the GE thread, which can't touch CoreTiming.  Only used while it's busy, or after a sync.
+static std::vector<GeDeferredTrigger> geDeferredTriggers;
+
+// Hands the queue to the GE thread, if it's running.  Returns false to process it here instead.
+static bool __GeKickThread() {
+	if (!GeThread::Active())
+		return false;
+	GeThread::Kick(CoreTiming::GetTicks());
+	if (!CoreTiming::IsScheduled(geThreadEvent))
+		CoreTiming::ScheduleEvent(usToCycles(GE_THREAD_MAX_LEAD_US), geThreadEvent, 0);
+	return true;
+}
 
 class GeIntrHandler : public IntrHandler {
 public:
 	GeIntrHandler() : IntrHandler(PSP_GE_INTR) {}
 
 	bool run(PendingInterrupt& pend) override {
+		GeThread::Sync();
 		if (ge_pending_cb.empty()) {
 			ERROR_LOG_REPORT(Log::sceGe, "Unable to run GE interrupt: no pending interrupt");
 			return false;
@@ -145,12 +171,15 @@ class GeIntrHandler : public IntrHandler {
 
 		// Hm. This might be really tricky to get to behave the same in both modes. Here we are in __KernelReschedule, CoreTiming::Advance, ProcessEvents, GeExecuteInterrupt, ... .... __RunOnePendingInterrupt
 		// But not sure how much it will matter. The test pause2 hits here.
-		DLResult result = gpu->ProcessDLQueue();
-		_dbg_assert_(result != DLResult::DebugBreak);
+		if (!__GeKickThread()) {
+			DLResult result = gpu->ProcessDLQueue();
+			_dbg_assert_(result != DLResult::DebugBreak);
+		}
 		return false;
 	}
 
 	void handleResult(PendingInterrupt& pend) override {
+		GeThread::Sync();
 		GeInterruptData intrdata = ge_pending_cb.front();
 		ge_pending_cb.pop_front();
 
@@ -191,7 +220,7 @@ class GeIntrHandler : public IntrHandler {
 		// So, when debugging is active, we'll just use hleSplitSyscallOverGe.
 		if (gpu->ShouldSplitOverGe()) {
 			hleSplitSyscallOverGe();
-		} else {
+		} else if (!__GeKickThread()) {
 			DLResult result = gpu->ProcessDLQueue();
 			_dbg_assert_(result != DLResult::DebugBreak);
 		}
@@ -213,6 +242,10 @@ static void __GeCheckCycles(u64 userdata, int cyclesLate) {
 	// Deprecated
 }
 
+static void __GeCatchUpThread(u64 userdata, int cyclesLate) {
+	GeThread::Sync();
+}
+
 void __GeInit() {
 	memset(&ge_used_callbacks, 0, sizeof(ge_used_callbacks));
 	memset(&ge_callback_data, 0, sizeof(ge_callback_data));
@@ -224,6 +257,8 @@ void __GeInit() {
 
 	// Deprecated
 	geCycleEvent = CoreTiming::RegisterEvent("GeCycleEvent", &__GeCheckCycles);
+	geThreadEvent = CoreTiming::RegisterEvent("GeThreadEvent", &__GeCatchUpThread);
+	geDeferredTriggers.clear();
 
 	listWaitingThreads.clear();
 	drawWaitingThreads.clear();
@@ -235,10 +270,12 @@ struct GeInterruptData_v1 {
 };
 
 void __GeDoState(PointerWrap &p) {
-	auto s = p.Section("sceGe", 1, 2);
+	auto s = p.Section("sceGe", 1, 3);
 	if (!s)
 		return;
 
+	GeThread::Sync();
+
 	DoArray(p, ge_callback_data, ARRAY_SIZE(ge_callback_data));
 	DoArray(p, ge_used_callbacks, ARRAY_SIZE(ge_used_callbacks));
 
@@ -261,6 +298,12 @@ void __GeDoState(PointerWrap &p) {
 	CoreTiming::RestoreRegisterEvent(geInterruptEvent, "GeInterruptEvent", &__GeExecuteInterrupt);
 	Do(p, geCycleEvent);
 	CoreTiming::RestoreRegisterEvent(geCycleEvent, "GeCycleEvent", &__GeCheckCycles);
+	if (s >= 3) {
+		Do(p, geThreadEvent);
+	} else {
+		geThreadEvent = -1;
+	}
+	CoreTiming::RestoreRegisterEvent(geThreadEvent, "GeThreadEvent", &__GeCatchUpThread);
 
 	Do(p, listWaitingThreads);
 	Do(p, drawWaitingThreads);
@@ -269,9 +312,16 @@ void __GeDoState(PointerWrap &p) {
 }
 
 void __GeShutdown() {
+	GeThread::Shutdown();
+	geDeferredTriggers.clear();
 }
 
 bool __GeTriggerSync(GPUSyncType type, int id, u64 atTicks) {
+	if (GeThread::OnThread()) {
+		geDeferredTriggers.push_back({ false, id, (u32)type, atTicks });
+		return true;
+	}
+
 	u64 userdata = (u64)id << 32 | (u64)type;
 	s64 future = atTicks - CoreTiming::GetTicks();
 	if (type == GPU_SYNC_DRAW) {
@@ -284,6 +334,11 @@ bool __GeTriggerSync(GPUSyncType type, int id, u64 atTicks) {
 }
 
 bool __GeTriggerInterrupt(int listid, u32 pc, u64 atTicks) {
+	if (GeThread::OnThread()) {
+		geDeferredTriggers.push_back({ true, listid, pc, atTicks });
+		return true;
+	}
+
 	GeInterruptData intrdata;
 	intrdata.listid = listid;
 	intrdata.pc = pc;
@@ -296,6 +351,17 @@ bool __GeTriggerInterrupt(int listid, u32 pc, u64 atTicks) {
 	return true;
 }
 
+void __GeRunDeferredTriggers() {
+	// Anything already due simply happens as soon as possible.
+	for (const GeDeferredTrigger &trigger : geDeferredTriggers) {
+		if (trigger.interrupt)
+			__GeTriggerInterrupt(trigger.id, trigger.pcOrType, trigger.atTicks);
+		else
+			__GeTriggerSync((GPUSyncType)trigger.pcOrType, trigger.id, trigger.atTicks);
+	}
+	geDeferredTriggers.clear();
+}
+
 void __GeWaitCurrentThread(GPUSyncType type, SceUID waitId, const char *reason) {
 	WaitType waitType;
 	if (type == GPU_SYNC_DRAW) {
@@ -363,7 +429,7 @@ u32 sceGeListEnQueue(u32 listAddress, u32 stallAddress, int callbackId, u32 optP
 	if (runList) {
 		if (gpu->ShouldSplitOverGe()) {
 			hleSplitSyscallOverGe();
-		} else {
+		} else if (!__GeKickThread()) {
 			gpu->ProcessDLQueue();
 		}
 	}
@@ -385,7 +451,7 @@ u32 sceGeListEnQueueHead(u32 listAddress, u32 stallAddress, int callbackId, u32
 	if (runList) {
 		if (gpu->ShouldSplitOverGe()) {
 			hleSplitSyscallOverGe();
-		} else {
+		} else if (!__GeKickThread()) {
 			gpu->ProcessDLQueue();
 		}
 	}
@@ -413,7 +479,7 @@ static int sceGeListUpdateStallAddr(u32 displayListID, u32 stallAddress) {
 	if (runList) {
 		if (gpu->ShouldSplitOverGe()) {
 			hleSplitSyscallOverGe();
-		} else {
+		} else if (!__GeKickThread()) {
 			gpu->ProcessDLQueue();
 		}
 	}
@@ -444,7 +510,7 @@ static int sceGeContinue() {
 	if (runList) {
 		if (gpu->ShouldSplitOverGe()) {
 			hleSplitSyscallOverGe();
-		} else {
+		} else if (!__GeKickThread()) {
 			gpu->ProcessDLQueue();
 		}
 	}
@@ -583,6 +649,7 @@ static int sceGeGetMtx(int type, u32 matrixPtr) {
 }
 
 static u32 sceGeGetCmd(int cmd) {
+	GeThread::Sync();
 	if (cmd >= 0 && cmd < (int)ARRAY_SIZE(gstate.cmdmem)) {
 		// Does not mask away the high bits.  But matrix regs don't read back.
 		u32 val = gstate.cmdmem[cmd];
@@ -633,7 +700,7 @@ static u32 sceGeEdramSetAddrTranslation(u32 new_size) {
 }
 
 const HLEFunction sceGe_user[] = {
-	{0XE47E40E4, &WrapU_V<sceGeEdramGetAddr>,            "sceGeEdramGetAddr",            'x', ""    },
+	{0XE47E40E4, &WrapU_V<sceGeEdramGetAddr>,            "sceGeEdramGetAddr",            'x', "", HLE_FAST_CALL },
 	{0XAB49E76A, &WrapU_UUIU<sceGeListEnQueue>,          "sceGeListEnQueue",             'x', "xxip"},
 	{0X1C0D95A6, &WrapU_UUIU<sceGeListEnQueueHead>,      "sceGeListEnQueueHead",         'x', "xxip"},
 	{0XE0D68148, &WrapI_UU<sceGeListUpdateStallAddr>,    "sceGeListUpdateStallAddr",     'i', "xx"  },
@@ -643,7 +710,7 @@ const HLEFunction sceGe_user[] = {
 	{0X4C06E472, &WrapI_V<sceGeContinue>,                "sceGeContinue",                'i', ""    },
 	{0XA4FC06A4, &WrapU_U<sceGeSetCallback>,             "sceGeSetCallback",             'i', "p"   },
 	{0X05DB22CE, &WrapI_U<sceGeUnsetCallback>,           "sceGeUnsetCallback",           'i', "x"   },
-	{0X1F6752AD, &WrapU_V<sceGeEdramGetSize>,            "sceGeEdramGetSize",            'x', ""    },
+	{0X1F6752AD, &WrapU_V<sceGeEdramGetSize>,            "sceGeEdramGetSize",            'x', "", HLE_FAST_CALL },
 	{0XB77905EA, &WrapU_U<sceGeEdramSetAddrTranslation>, "sceGeEdramSetAddrTranslation", 'x', "x"   },
 	{0XDC93CFEF, &WrapU_I<sceGeGetCmd>,                  "sceGeGetCmd",                  'x', "i"   },
 	{0X57C8945B, &WrapI_IU<sceGeGetMtx>,                 "sceGeGetMtx",                  'i', "ip"  },
@@ -53,6 +53,8 @@ void __GeDoState(PointerWrap &p);
 void __GeShutdown();
 bool __GeTriggerSync(GPUSyncType waitType, int id, u64 atTicks);
 bool __GeTriggerInterrupt(int listid, u32 pc, u64 atTicks);
+// Delivers what the GE thread triggered since the last call.  See GeThread.
+void __GeRunDeferredTriggers();
 void __GeWaitCurrentThread(GPUSyncType type, SceUID waitId, const char *reason);
 bool __GeTriggerWait(GPUSyncType type, SceUID waitId);
 
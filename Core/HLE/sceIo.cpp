@@ -23,6 +23,7 @@
 
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/TimeUtil.h"
 
 #include "Common/File/FileUtil.h"
@@ -673,6 +674,8 @@ void __IoInit() {
 	pspFileSystem.Mount("fatms0:", memstickSystem);
 	pspFileSystem.Mount("fatms:", memstickSystem);
 	pspFileSystem.Mount("pfat0:", memstickSystem);
+	// The savedata screens list this and stat everything in it, which can be slow on some hosts.
+	memstickSystem->PreloadCache("/PSP/SAVEDATA", g_paramSFO.GetDiscID());
 
 	pspFileSystem.Mount("flash0:", flash0System);
 
@@ -1049,6 +1052,7 @@ static u32 npdrmRead(FileNode *f, u8 *data, int size) {
 
 static bool __IoRead(int &result, int id, u32 data_addr, int size, int &us) {
 	PROFILE_THIS_SCOPE("io_rw");
+	TRACE_SCOPE("io_read");
 	// Low estimate, may be improved later from the ReadFile result.
 
 	if (PSP_CoreParameter().compat.flags().ForceUMDReadSpeed || g_Config.iIOTimingMethod == IOTIMING_UMDSLOWREALISTIC) {
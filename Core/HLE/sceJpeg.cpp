@@ -257,8 +257,14 @@ static int sceJpegMJpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int bu
 	return result;
 }
 
-static u32 convertARGBtoABGR(u32 argb) {
-	return ((argb & 0xFF00FF00)) | ((argb & 0x000000FF) << 16) | ((argb & 0x00FF0000) >> 16);
+// Returns the RGB of pixel x of a scanline from jpeg_decoder::decode() as (r << 16) | (g << 8) | b.
+static inline u32 ScanlinePixelRGB(const u8 *scanline, int components, int x) {
+	if (components == 1) {
+		u32 luma = scanline[x];
+		return (luma << 16) | (luma << 8) | luma;
+	}
+	const u8 *p = scanline + x * 4;
+	return (p[0] << 16) | (p[1] << 8) | p[2];
 }
 
 static int DecodeJpeg(u32 jpegAddr, int jpegSize, u32 imageAddr, int &usec) {
@@ -273,53 +279,62 @@ static int DecodeJpeg(u32 jpegAddr, int jpegSize, u32 imageAddr, int &usec) {
 	if (jpegSize < 2 || buf[0] != 0xFF || buf[1] != 0xD8)
 		return hleLogError(Log::ME, ERROR_JPEG_NO_SOI, "no SOI found, invalid data");
 
-	int width, height, actual_components;
-	unsigned char *jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, 3);
-
-	if (actual_components != 3 && actual_components != 1) {
-		// The assumption that the image was RGB was wrong...
-		// Try again.
-		int components = actual_components;
-		jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, components);
-	}
-
-	if (jpegBuf == nullptr) {
+	// Decode scanline by scanline straight into PSP memory, no intermediate image.
+	jpgd::jpeg_decoder_mem_stream stream(buf, jpegSize);
+	jpgd::jpeg_decoder decoder(&stream);
+	if (decoder.get_error_code() != jpgd::JPGD_SUCCESS) {
 		return hleLogError(Log::ME, ERROR_JPEG_INVALID_DATA, "unable to decompress jpeg");
 	}
 
+	const int width = decoder.get_width();
+	const int height = decoder.get_height();
+	const int components = decoder.get_num_components();
+
 	usec += (width * height) / 14;
 
 	if (!Memory::IsValidRange(imageAddr, mjpegWidth * mjpegHeight * 4)) {
-		free(jpegBuf);
 		return hleLogError(Log::ME, SCE_KERNEL_ERROR_INVALID_POINTER, "invalid output address");
 	}
 	// Note: even if you Delete, the size is still allowed.
 	if (width > mjpegWidth || height > mjpegHeight) {
-		free(jpegBuf);
 		return hleLogError(Log::ME, ERROR_JPEG_INVALID_SIZE, "invalid output address");
 	}
 	if (mjpegInited == 0) {
 		// If you finish after setting the size, then call this - you get an interesting error.
-		free(jpegBuf);
 		return hleLogError(Log::ME, 0x80000001, "mjpeg not inited");
 	}
 
 	usec += (width * height) / 110;
 
-	if (actual_components == 3 || actual_components == 1) {
-		u24_be *imageBuffer = (u24_be*)jpegBuf;
+	if (components == 3 || components == 1) {
+		if (decoder.begin_decoding() != jpgd::JPGD_SUCCESS) {
+			return hleLogError(Log::ME, ERROR_JPEG_INVALID_DATA, "unable to decompress jpeg");
+		}
+
 		u32_le *abgr = (u32_le *)Memory::GetPointerUnchecked(imageAddr);
 		for (int y = 0; y < height; ++y) {
-			for (int x = 0; x < width; x++)	{
-				abgr[x] = convertARGBtoABGR(imageBuffer[x]);
+			const u8 *scanline;
+			uint32_t scanlineLen;
+			if (decoder.decode((const void **)&scanline, &scanlineLen) != jpgd::JPGD_SUCCESS) {
+				return hleLogError(Log::ME, ERROR_JPEG_INVALID_DATA, "unable to decompress jpeg");
+			}
+			// Alpha stays zero.
+			if (components == 1) {
+				for (int x = 0; x < width; x++) {
+					u32 luma = scanline[x];
+					abgr[x] = (luma << 16) | (luma << 8) | luma;
+				}
+			} else {
+				for (int x = 0; x < width; x++) {
+					const u8 *p = scanline + x * 4;
+					abgr[x] = (p[2] << 16) | (p[1] << 8) | p[0];
+				}
 			}
-			imageBuffer += width;
 			abgr += mjpegWidth;
 		}
 		NotifyMemInfo(MemBlockFlags::WRITE, imageAddr, mjpegWidth * height, "JpegDecodeMJpeg");
 	}
 
-	free(jpegBuf);
 	return hleLogSuccessX(Log::ME, getWidthHeight(width, height));
 }
 
@@ -370,22 +385,15 @@ static int JpegGetOutputInfo(u32 jpegAddr, int jpegSize, u32 colourInfoAddr) {
 	if (jpegSize < 2 || buf[0] != 0xFF || buf[1] != 0xD8)
 		return hleLogError(Log::ME, ERROR_JPEG_NO_SOI, "no SOI found, invalid data");
 
-	int width, height, actual_components;
-	unsigned char *jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, 3);
-
-	if (actual_components != 3 && actual_components != 1) {
-		// The assumption that the image was RGB was wrong...
-		// Try again.
-		int components = actual_components;
-		jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, components);
-	}
-
-	if (jpegBuf == nullptr) {
+	// Only the size is needed, the headers are enough for that. Games usually decode right after.
+	jpgd::jpeg_decoder_mem_stream stream(buf, jpegSize);
+	jpgd::jpeg_decoder decoder(&stream);
+	if (decoder.get_error_code() != jpgd::JPGD_SUCCESS) {
 		return hleLogError(Log::ME, ERROR_JPEG_INVALID_DATA, "unable to decompress jpeg");
 	}
+	const int width = decoder.get_width();
+	const int height = decoder.get_height();
 
-	free(jpegBuf);
-	
 	// Buffer to store info about the color space in use.
 	// - Bits 24 to 32 (Always empty): 0x00
 	// - Bits 16 to 24 (Color mode): 0x00 (Unknown), 0x01 (Greyscale) or 0x02 (YCbCr) 
@@ -441,50 +449,45 @@ static u32 convertRGBToYCbCr(u32 rgb) {
 	return (y << 16) | (cb << 8) | cr;
 }
 
-static int JpegConvertRGBToYCbCr(const void *data, u8 *output, int width, int height) {
-	u24_be *imageBuffer = (u24_be *)data;
+// Same as the Y of convertRGBToYCbCr, for the pixels that don't contribute chroma.
+static u8 convertRGBToY(u32 rgb) {
+	u8  r = (rgb >> 16) & 0xFF;
+	u8  g = (rgb >>  8) & 0xFF;
+	u8  b = (rgb >>  0) & 0xFF;
+	int  y = 0.299f * r + 0.587f * g + 0.114f * b + 0;
+	if (y > 0xFF) y = 0xFF; if (y < 0) y = 0;
+	return y;
+}
+
+// Converts one decoded scanline into the planar 4:2:0 output. Chroma is taken from the top left pixel of each 2x2 block.
+static void JpegConvertScanlineToYCbCr(const u8 *scanline, int components, u8 *output, int width, int height, int y) {
 	int sizeY = width * height;
 	int sizeCb = sizeY >> 2;
 	u8 *Y = output;
 	u8 *Cb = Y + sizeY;
 	u8 *Cr = Cb + sizeCb;
 
-	if ((width & 1) == 0 && (height & 1) == 0) {
-		for (int y = 0; y < height; y += 2) {
-			for (int x = 0; x < width; x += 2) {
-				u32 rgb0 = imageBuffer[width * y + x];
-				u32 rgb1 = imageBuffer[width * y + x + 1];
-				u32 rgb2 = imageBuffer[width * (y + 1) + x];
-				u32 rgb3 = imageBuffer[width * (y + 1) + x + 1];
-
-				u32 yCbCr0 = convertRGBToYCbCr(rgb0);
-				u32 yCbCr1 = convertRGBToYCbCr(rgb1);
-				u32 yCbCr2 = convertRGBToYCbCr(rgb2);
-				u32 yCbCr3 = convertRGBToYCbCr(rgb3);
-
-				Y[width * y + x] = (yCbCr0 >> 16) & 0xFF;
-				Y[width * y + x + 1] = (yCbCr1 >> 16) & 0xFF;
-				Y[width * (y + 1) + x] = (yCbCr2 >> 16) & 0xFF;
-				Y[width * (y + 1) + x + 1] = (yCbCr3 >> 16) & 0xFF;
-				Cb[(width >> 1) * (y >> 1) + (x >> 1)] = (yCbCr0 >> 8) & 0xFF;
-				Cr[(width >> 1) * (y >> 1) + (x >> 1)] = yCbCr0 & 0xFF;
-			}
-		}
-	} else {
-		for (int y = 0; y < height; ++y) {
-			for (int x = 0; x < width; ++x) {
-				u32 rgb = imageBuffer[width * y + x];
-				u32 yCbCr = convertRGBToYCbCr(rgb);
-				Y[width * y + x] = (yCbCr >> 16) & 0xFF;
-				if ((y & 1) == 0 && (x & 1) == 0) {
-					// Ideally, would average, but I suppose these just came from a JPEG, so they ought to match.
-					Cb[(width >> 1) * (y >> 1) + (x >> 1)] = (yCbCr >> 8) & 0xFF;
-					Cr[(width >> 1) * (y >> 1) + (x >> 1)] = yCbCr & 0xFF;
-				}
-			}
+	u8 *Yrow = Y + width * y;
+	if ((y & 1) != 0) {
+		for (int x = 0; x < width; ++x)
+			Yrow[x] = convertRGBToY(ScanlinePixelRGB(scanline, components, x));
+		return;
+	}
+
+	// Ideally, would average, but I suppose these just came from a JPEG, so they ought to match.
+	u8 *CbRow = Cb + (width >> 1) * (y >> 1);
+	u8 *CrRow = Cr + (width >> 1) * (y >> 1);
+	for (int x = 0; x < width; ++x) {
+		u32 rgb = ScanlinePixelRGB(scanline, components, x);
+		if ((x & 1) == 0) {
+			u32 yCbCr = convertRGBToYCbCr(rgb);
+			Yrow[x] = (yCbCr >> 16) & 0xFF;
+			CbRow[x >> 1] = (yCbCr >> 8) & 0xFF;
+			CrRow[x >> 1] = yCbCr & 0xFF;
+		} else {
+			Yrow[x] = convertRGBToY(rgb);
 		}
 	}
-	return getWidthHeight(width, height);
 }
 
 static int JpegDecodeMJpegYCbCr(u32 jpegAddr, int jpegSize, u32 yCbCrAddr, int yCbCrSize, int &usec) {
@@ -499,29 +502,36 @@ static int JpegDecodeMJpegYCbCr(u32 jpegAddr, int jpegSize, u32 yCbCrAddr, int y
 	if (jpegSize < 2 || buf[0] != 0xFF || buf[1] != 0xD8)
 		return hleLogError(Log::ME, ERROR_JPEG_NO_SOI, "no SOI found, invalid data");
 
-	int width, height, actual_components;
-	unsigned char *jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, 3);
-
-	if (actual_components != 3 && actual_components != 1) {
-		// The assumption that the image was RGB was wrong...
-		// Try again.
-		int components = actual_components;
-		jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, components);
-	}
-
-	if (jpegBuf == nullptr) {
+	jpgd::jpeg_decoder_mem_stream stream(buf, jpegSize);
+	jpgd::jpeg_decoder decoder(&stream);
+	if (decoder.get_error_code() != jpgd::JPGD_SUCCESS) {
 		return hleLogError(Log::ME, ERROR_JPEG_INVALID_DATA, "unable to decompress jpeg");
 	}
 
+	const int width = decoder.get_width();
+	const int height = decoder.get_height();
+	const int components = decoder.get_num_components();
+
 	if (yCbCrSize < getYCbCrBufferSize(width, height)) {
-		free(jpegBuf);
 		return hleLogError(Log::ME, ERROR_JPEG_OUT_OF_MEMORY, "buffer not large enough");
 	}
 
 	// Technically, it seems like the PSP doesn't support grayscale, but we might as well.
-	if (actual_components == 3 || actual_components == 1) {
+	if (components == 3 || components == 1) {
 		if (Memory::IsValidRange(yCbCrAddr, getYCbCrBufferSize(width, height))) {
-			JpegConvertRGBToYCbCr(jpegBuf, Memory::GetPointerWriteUnchecked(yCbCrAddr), width, height);
+			if (decoder.begin_decoding() != jpgd::JPGD_SUCCESS) {
+				return hleLogError(Log::ME, ERROR_JPEG_INVALID_DATA, "unable to decompress jpeg");
+			}
+			// Converted scanline by scanline, straight into PSP memory.
+			u8 *output = Memory::GetPointerWriteUnchecked(yCbCrAddr);
+			for (int y = 0; y < height; ++y) {
+				const u8 *scanline;
+				uint32_t scanlineLen;
+				if (decoder.decode((const void **)&scanline, &scanlineLen) != jpgd::JPGD_SUCCESS) {
+					return hleLogError(Log::ME, ERROR_JPEG_INVALID_DATA, "unable to decompress jpeg");
+				}
+				JpegConvertScanlineToYCbCr(scanline, components, output, width, height, y);
+			}
 			NotifyMemInfo(MemBlockFlags::WRITE, yCbCrAddr, getYCbCrBufferSize(width, height), "JpegDecodeMJpegYCbCr");
 		} else {
 			// There's some weird behavior on the PSP where it writes data around the last passed address.
@@ -529,8 +539,6 @@ static int JpegDecodeMJpegYCbCr(u32 jpegAddr, int jpegSize, u32 yCbCrAddr, int y
 		}
 	}
 
-	free(jpegBuf);
-
 	// Rough estimate based on observed timing.
 	usec += (width * height) / 14;
 	return hleLogSuccessX(Log::ME, getWidthHeight(width, height));
@@ -486,7 +486,7 @@ void KernelObject::GetQuickInfo(char *ptr, int size) {
 }
 
 KernelObjectPool::KernelObjectPool() {
-	memset(occupied, 0, sizeof(bool)*maxCount);
+	memset(slots, 0, sizeof(slots));
 	nextID = initialNextID;
 }
 
@@ -497,10 +497,10 @@ SceUID KernelObjectPool::Create(KernelObject *obj, int rangeBottom, int rangeTop
 		rangeBottom = nextID++;
 
 	for (int i = rangeBottom; i < rangeTop; i++) {
-		if (!occupied[i]) {
-			occupied[i] = true;
-			pool[i] = obj;
-			pool[i]->uid = i + handleOffset;
+		if (slots[i].type == 0) {
+			slots[i].obj = obj;
+			slots[i].type = obj->GetIDType();
+			obj->uid = i + handleOffset;
 			return i + handleOffset;
 		}
 	}
@@ -512,21 +512,22 @@ SceUID KernelObjectPool::Create(KernelObject *obj, int rangeBottom, int rangeTop
 void KernelObjectPool::Clear() {
 	for (int i = 0; i < maxCount; i++) {
 		// brutally clear everything, no validation
-		if (occupied[i])
-			delete pool[i];
-		pool[i] = nullptr;
-		occupied[i] = false;
+		if (slots[i].type != 0)
+			delete slots[i].obj;
+		slots[i].obj = nullptr;
+		slots[i].type = 0;
 	}
 	nextID = initialNextID;
 }
 
 void KernelObjectPool::List() {
 	for (int i = 0; i < maxCount; i++) {
-		if (occupied[i]) {
+		if (slots[i].type != 0) {
 			char buffer[256];
-			if (pool[i]) {
-				pool[i]->GetQuickInfo(buffer, sizeof(buffer));
-				DEBUG_LOG(Log::sceKernel, "KO %i: %s \"%s\": %s", i + handleOffset, pool[i]->GetTypeName(), pool[i]->GetName(), buffer);
+			KernelObject *obj = slots[i].obj;
+			if (obj) {
+				obj->GetQuickInfo(buffer, sizeof(buffer));
+				DEBUG_LOG(Log::sceKernel, "KO %i: %s \"%s\": %s", i + handleOffset, obj->GetTypeName(), obj->GetName(), buffer);
 			} else {
 				ERROR_LOG(Log::sceKernel, "KO %i: bad object", i + handleOffset);
 			}
@@ -537,7 +538,7 @@ void KernelObjectPool::List() {
 int KernelObjectPool::GetCount() const {
 	int count = 0;
 	for (int i = 0; i < maxCount; i++) {
-		if (occupied[i])
+		if (slots[i].type != 0)
 			count++;
 	}
 	return count;
@@ -563,6 +564,10 @@ void KernelObjectPool::DoState(PointerWrap &p) {
 	}
 
 	Do(p, nextID);
+	// Still saved as a separate array of flags.
+	bool occupied[maxCount];
+	for (int i = 0; i < maxCount; ++i)
+		occupied[i] = slots[i].type != 0;
 	DoArray(p, occupied, maxCount);
 	for (int i = 0; i < maxCount; ++i) {
 		if (!occupied[i])
@@ -571,18 +576,20 @@ void KernelObjectPool::DoState(PointerWrap &p) {
 		int type;
 		if (p.mode == p.MODE_READ) {
 			Do(p, type);
-			pool[i] = CreateByIDType(type);
+			KernelObject *obj = CreateByIDType(type);
 
 			// Already logged an error.
-			if (pool[i] == nullptr)
+			if (obj == nullptr)
 				return;
 
-			pool[i]->uid = i + handleOffset;
+			obj->uid = i + handleOffset;
+			slots[i].obj = obj;
+			slots[i].type = obj->GetIDType();
 		} else {
-			type = pool[i]->GetIDType();
+			type = slots[i].type;
 			Do(p, type);
 		}
-		pool[i]->DoState(p);
+		slots[i].obj->DoState(p);
 		if (p.error >= p.ERROR_FAILURE)
 			break;
 	}
@@ -428,7 +428,6 @@ class KernelObject
 	}
 };
 
-// TODO: Delete the "occupied" array, rely on non-zero pool entries?
 class KernelObjectPool {
 public:
 	KernelObjectPool();
@@ -444,63 +443,55 @@ class KernelObjectPool {
 	u32 Destroy(SceUID handle) {
 		u32 error;
 		if (Get<T>(handle, error)) {
-			int index = handle - handleOffset;
-			occupied[index] = false;
-			delete pool[index];
-			pool[index] = nullptr;
+			Slot &slot = slots[handle - handleOffset];
+			delete slot.obj;
+			slot.obj = nullptr;
+			slot.type = 0;
 		}
 		return error;
 	};
 
 	bool IsValid(SceUID handle) const {
-		int index = handle - handleOffset;
-		if (index < 0 || index >= maxCount)
-			return false;
-		else
-			return occupied[index];
+		const u32 index = (u32)handle - handleOffset;
+		return index < maxCount && slots[index].type != 0;
 	}
 
 	template <class T>
 	T* Get(SceUID handle, u32 &outError) {
-		if (handle < handleOffset || handle >= handleOffset+maxCount || !occupied[handle-handleOffset]) {
+		// Checking the cached type covers both a free slot and the wrong object, in one load.
+		const u32 index = (u32)handle - handleOffset;
+		if (index < maxCount && slots[index].type == T::GetStaticIDType()) {
+			outError = SCE_KERNEL_ERROR_OK;
+			return static_cast<T *>(slots[index].obj);
+		}
+
+		if (index >= maxCount || slots[index].type == 0) {
 			// Tekken 6 spams 0x80020001 gets wrong with no ill effects, also on the real PSP
 			if (handle != 0 && (u32)handle != 0x80020001) {
 				WARN_LOG(Log::sceKernel, "Kernel: Bad %s handle %d (%08x)", T::GetStaticTypeName(), handle, handle);
 			}
-			outError = T::GetMissingErrorCode();
-			return 0;
 		} else {
-			// Previously we had a dynamic_cast here, but since RTTI was disabled traditionally,
-			// it just acted as a static cast and everything worked. This means that we will never
-			// see the Wrong type object error below, but we'll just have to live with that danger.
-			T* t = static_cast<T*>(pool[handle - handleOffset]);
-			if (t == nullptr || t->GetIDType() != T::GetStaticIDType()) {
-				WARN_LOG(Log::sceKernel, "Kernel: Wrong object type for %d (%08x), was %s, should have been %s", handle, handle, t ? t->GetTypeName() : "null", T::GetStaticTypeName());
-				outError = T::GetMissingErrorCode();
-				return 0;
-			}
-			outError = SCE_KERNEL_ERROR_OK;
-			return t;
+			KernelObject *t = slots[index].obj;
+			WARN_LOG(Log::sceKernel, "Kernel: Wrong object type for %d (%08x), was %s, should have been %s", handle, handle, t ? t->GetTypeName() : "null", T::GetStaticTypeName());
 		}
+		outError = T::GetMissingErrorCode();
+		return 0;
 	}
 
 	// ONLY use this when you KNOW the handle is valid.
 	template <class T>
 	T *GetFast(SceUID handle) {
 		const SceUID realHandle = handle - handleOffset;
-		_dbg_assert_(realHandle >= 0 && realHandle < maxCount && occupied[realHandle]);
-		return static_cast<T *>(pool[realHandle]);
+		_dbg_assert_(realHandle >= 0 && realHandle < maxCount && slots[realHandle].type != 0);
+		return static_cast<T *>(slots[realHandle].obj);
 	}
 
 	template <class T, typename ArgT>
 	void Iterate(bool func(T *, ArgT), ArgT arg) {
 		int type = T::GetStaticIDType();
 		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i])
-				continue;
-			T *t = static_cast<T *>(pool[i]);
-			if (t->GetIDType() == type) {
-				if (!func(t, arg))
+			if (slots[i].type == type) {
+				if (!func(static_cast<T *>(slots[i].obj), arg))
 					break;
 			}
 		}
@@ -509,12 +500,9 @@ class KernelObjectPool {
 	int ListIDType(int type, SceUID_le *uids, int count) const {
 		int total = 0;
 		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i]) {
-				continue;
-			}
-			if (pool[i]->GetIDType() == type) {
+			if (slots[i].type == type) {
 				if (total < count) {
-					*uids++ = pool[i]->GetUID();
+					*uids++ = slots[i].obj->GetUID();
 				}
 				++total;
 			}
@@ -523,12 +511,11 @@ class KernelObjectPool {
 	}
 
 	bool GetIDType(SceUID handle, int *type) const {
-		if (handle < handleOffset || handle >= handleOffset+maxCount || !occupied[handle-handleOffset]) {
+		if (!IsValid(handle)) {
 			ERROR_LOG(Log::sceKernel, "Kernel: Bad object handle %i (%08x)", handle, handle);
 			return false;
 		}
-		KernelObject *t = pool[handle - handleOffset];
-		*type = t->GetIDType();
+		*type = slots[handle - handleOffset].type;
 		return true;
 	}
 
@@ -542,8 +529,13 @@ class KernelObjectPool {
 		initialNextID = 0x10
 	};
 private:
-	KernelObject *pool[maxCount];
-	bool occupied[maxCount];
+	struct Slot {
+		KernelObject *obj;
+		// The object's GetIDType(), kept here to avoid a virtual call per lookup.  0 if free.
+		int type;
+	};
+
+	Slot slots[maxCount];
 	int nextID;
 };
 
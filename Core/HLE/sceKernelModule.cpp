@@ -2021,7 +2021,9 @@ int __KernelGPUReplay() {
 		Core_Stop();
 	}
 
-	if (PSP_CoreParameter().headLess && !PSP_CoreParameter().startBreak) {
+	// When benchmarking, it's run again until there are enough timings.
+	bool finished = result != GPURecord::ReplayResult::Break && !GPURecord::ReplayBenchmarkNeedsMoreRuns();
+	if (PSP_CoreParameter().headLess && !PSP_CoreParameter().startBreak && finished) {
 		PSPPointer<u8> topaddr;
 		u32 linesize = 512;
 		__DisplayGetFramebuf(&topaddr, &linesize, nullptr, 0);
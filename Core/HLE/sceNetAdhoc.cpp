@@ -479,6 +479,14 @@ int DoBlockingPdpRecv(AdhocSocketRequest& req, s64& result) {
 		return 0;
 	}
 
+	// Packets the Adhoc Server relayed are already waiting
+	int relayed = recvRelayedPdp(pdpsocket.lport, req.remoteMAC, req.remotePort, req.buffer, req.length);
+	if (relayed != 0) {
+		DEBUG_LOG(Log::sceNet, "sceNetAdhocPdpRecv[%i:%u]: Received %u relayed bytes from %s:%u\n", req.id, pdpsocket.lport, *req.length, mac2str(req.remoteMAC).c_str(), *req.remotePort);
+		result = relayed > 0 ? 0 : ERROR_NET_ADHOC_NOT_ENOUGH_SPACE;
+		return 0;
+	}
+
 	int ret;
 	int sockerr;
 	SceNetEtherAddr mac;
@@ -606,6 +614,23 @@ int DoBlockingPdpSend(AdhocSocketRequest& req, s64& result, AdhocSendTargets& ta
 
 	result = 0;
 	bool retry = false;
+
+	// Send to as many as possible at once, only the rest need the loop below
+	std::vector<sockaddr_in> targets;
+	targets.reserve(targetPeers.peers.size());
+	for (const auto &peer : targetPeers.peers) {
+		struct sockaddr_in target {};
+		target.sin_family = AF_INET;
+		target.sin_addr.s_addr = peer.ip;
+		target.sin_port = htons(peer.port + peer.portOffset);
+		targets.push_back(target);
+	}
+	int batched = sendToPeersBatched(pdpsocket.id, req.buffer, targetPeers.length, targets);
+	if (batched > 0) {
+		DEBUG_LOG(Log::sceNet, "sceNetAdhocPdpSend[%i:%u](B): Sent %u bytes to %d peers at once\n", req.id, getLocalPort(pdpsocket.id), targetPeers.length, batched);
+		targetPeers.peers.erase(targetPeers.peers.begin(), targetPeers.peers.begin() + batched);
+	}
+
 	for (auto peer = targetPeers.peers.begin(); peer != targetPeers.peers.end(); ) {
 		// Fill in Target Structure
 		struct sockaddr_in target {};
@@ -697,6 +722,19 @@ int DoBlockingPtpSend(AdhocSocketRequest& req, s64& result) {
 	return 0;
 }
 
+// Logs what the host measured the round trip to a PTP peer to be, every once in a while.
+static void ReportPtpLatency(AdhocSocket *sock) {
+	u64 now = (u64)(time_now_d() * 1000000.0);
+	if (sock->lastLatencyReport != 0 && now - sock->lastLatencyReport < PTP_LATENCY_REPORT_INTERVAL)
+		return;
+	sock->lastLatencyReport = now;
+
+	auto& ptpsocket = sock->data.ptp;
+	u32 rtt, rttVar;
+	if (getSockRTT(ptpsocket.id, &rtt, &rttVar))
+		INFO_LOG(Log::sceNet, "PTP peer %s:%u: RTT %.1fms, jitter %.1fms", mac2str(&ptpsocket.paddr).c_str(), ptpsocket.pport, rtt / 1000.0, rttVar / 1000.0);
+}
+
 int DoBlockingPtpRecv(AdhocSocketRequest& req, s64& result) {
 	auto sock = adhocSockets[req.id - 1];
 	if (!sock) {
@@ -724,6 +762,7 @@ int DoBlockingPtpRecv(AdhocSocketRequest& req, s64& result) {
 		auto peer = findFriend(&ptpsocket.paddr);
 		if (peer != NULL) peer->last_recv = CoreTiming::GetGlobalTimeUsScaled();
 		peerlock.unlock();
+		ReportPtpLatency(sock);
 
 		// Set to Established on successful Recv when an attempt to Connect was initiated
 		if (ptpsocket.state == ADHOC_PTP_STATE_SYN_SENT)
@@ -1627,6 +1666,13 @@ static int sceNetAdhocPdpSend(int id, const char *mac, u32 port, void *data, int
 								target.sin_port = htons(dport + portOffset);
 								u16 finalPortOffset;
 
+								// Small packets can go through the Adhoc Server along with others, when both sides support it
+								if (queueRelayedPdp(daddr, pdpsocket.lport, dport, data, len)) {
+									DEBUG_LOG(Log::sceNet, "sceNetAdhocPdpSend[%i:%u]: Relaying %u bytes to %s:%u\n", id, pdpsocket.lport, len, mac2str(daddr).c_str(), dport);
+									hleEatMicro(50);
+									return 0;
+								}
+
 								// Get Peer IP. Some games (ie. Vulcanus Seek and Destroy) seems to try to send to zero-MAC (ie. 00:00:00:00:00:00) first before sending to the actual destination MAC.. So may be sending to zero-MAC has a special meaning? (ie. to peek send buffer availability may be?)
 								if (resolveMAC((SceNetEtherAddr *)daddr, (uint32_t *)&target.sin_addr.s_addr, &finalPortOffset)) {
 									// Some games (ie. PSP2) might try to talk to it's self, not sure if they talked through WAN or LAN when using public Adhoc Server tho
@@ -1710,6 +1756,9 @@ static int sceNetAdhocPdpSend(int id, const char *mac, u32 port, void *data, int
 									if (peer->last_recv == 0)
 										continue;
 
+									if (queueRelayedPdp(&peer->mac_addr, pdpsocket.lport, dport, data, len))
+										continue;
+
 									dest.peers.push_back({ peer->ip_addr, dport, peer->port_offset });
 								}
 								// Free Peer Lock
@@ -1729,13 +1778,21 @@ static int sceNetAdhocPdpSend(int id, const char *mac, u32 port, void *data, int
 								}
 								// Non-blocking
 								else {
-									// Iterate Peers
+									std::vector<sockaddr_in> targets;
+									targets.reserve(dest.peers.size());
 									for (auto& peer : dest.peers) {
-										// Fill in Target Structure
 										struct sockaddr_in target {};
 										target.sin_family = AF_INET;
 										target.sin_addr.s_addr = peer.ip;
 										target.sin_port = htons(dport + peer.portOffset);
+										targets.push_back(target);
+									}
+									// Send to as many as possible at once, then the rest one by one (which also logs the errors)
+									size_t batched = sendToPeersBatched(pdpsocket.id, data, len, targets);
+
+									// Iterate Peers
+									for (size_t i = batched; i < targets.size(); i++) {
+										const sockaddr_in &target = targets[i];
 
 										int sent = sendto(pdpsocket.id, (const char*)data, len, MSG_NOSIGNAL, (struct sockaddr*)&target, sizeof(target));
 										int error = errno;
@@ -1859,6 +1916,16 @@ static int sceNetAdhocPdpRecv(int id, void *addr, void * port, void *buf, void *
 				// Acquire Network Lock
 				//_acquireNetworkLock();
 
+				// Packets the Adhoc Server relayed are already waiting
+				int relayed = recvRelayedPdp(pdpsocket.lport, saddr, sport, buf, len);
+				if (relayed < 0)
+					return hleLogSuccessVerboseX(Log::sceNet, ERROR_NET_ADHOC_NOT_ENOUGH_SPACE, "not enough space");
+				if (relayed > 0) {
+					DEBUG_LOG(Log::sceNet, "sceNetAdhocPdpRecv[%i:%u]: Received %u relayed bytes from %s:%u\n", id, pdpsocket.lport, *len, mac2str(saddr).c_str(), *sport);
+					hleEatMicro(50);
+					return 0;
+				}
+
 				SceNetEtherAddr mac;
 				int received = 0;
 				int error;
@@ -2049,6 +2116,9 @@ int PollAdhocSocket(SceNetAdhocPollSd* sds, int count, int timeout, int nonblock
 				fd = sock->data.pdp.id;
 			}
 			if (fd > maxfd) maxfd = fd;
+			// Relayed packets are already here, so don't wait for more
+			if (sock->type == SOCK_PDP && (sds[i].events & ADHOC_EV_RECV) && getRelayedPdpAvail(sock->data.pdp.lport) > 0)
+				timeout = 0;
 			FD_SET(fd, &readfds); 
 			FD_SET(fd, &writefds);
 			FD_SET(fd, &exceptfds);
@@ -2069,7 +2139,7 @@ int PollAdhocSocket(SceNetAdhocPollSd* sds, int count, int timeout, int nonblock
 				else {
 					fd = sock->data.pdp.id;
 				}
-				if ((sds[i].events & ADHOC_EV_RECV) && FD_ISSET(fd, &readfds))
+				if ((sds[i].events & ADHOC_EV_RECV) && (FD_ISSET(fd, &readfds) || (sock->type == SOCK_PDP && getRelayedPdpAvail(sock->data.pdp.lport) > 0)))
 					sds[i].revents |= ADHOC_EV_RECV;
 				if ((sds[i].events & ADHOC_EV_SEND) && FD_ISSET(fd, &writefds))
 					sds[i].revents |= ADHOC_EV_SEND;				
@@ -2216,6 +2286,9 @@ int NetAdhocPdp_Delete(int id, int unknown) {
 				shutdown(sock->data.pdp.id, SD_RECEIVE);
 				closesocket(sock->data.pdp.id);
 
+				// Nobody can receive what was relayed to it anymore
+				clearRelayedPdp(sock->data.pdp.lport);
+
 				// Remove Port Forward from Router
 				//sceNetPortClose("UDP", sock->lport);
 				//g_PortManager.Remove(IP_PROTOCOL_UDP, isOriPort ? sock->lport : sock->lport + portOffset); // Let's not remove mapping in real-time as it could cause lags/disconnection when joining a room with slow routers
@@ -2298,6 +2371,7 @@ int sceNetAdhocctlScan() {
 		if (adhocctlState == ADHOCCTL_STATE_DISCONNECTED && !isAdhocctlBusy) {
 			isAdhocctlBusy = true;
 			isAdhocctlNeedLogin = true;
+			wakeFriendFinder();
 			adhocctlState = ADHOCCTL_STATE_SCANNING;
 			adhocctlCurrentMode = ADHOCCTL_MODE_NORMAL;
 
@@ -2593,6 +2667,7 @@ int NetAdhocctl_Term() {
 
 		// Terminate Adhoc Threads
 		friendFinderRunning = false;
+		wakeFriendFinder();
 		if (friendFinderThread.joinable()) {
 			friendFinderThread.join();
 		}
@@ -2794,6 +2869,7 @@ int NetAdhocctl_Create(const char* groupName) {
 			if (adhocctlState == ADHOCCTL_STATE_DISCONNECTED && !isAdhocctlBusy) {
 				isAdhocctlBusy = true;
 				isAdhocctlNeedLogin = true;
+				wakeFriendFinder();
 
 				// Set Network Name
 				if (groupNameStruct != NULL) 
@@ -3117,7 +3193,7 @@ static int sceNetAdhocGetPdpStat(u32 structSize, u32 structAddr) {
 					// Set available bytes to be received. With FIONREAD There might be ghosting 1 byte in recv buffer when remote peer's socket got closed (ie. Warriors Orochi 2) Attempting to recv this ghost 1 byte will result to socket error 10054 (may need to disable SIO_UDP_CONNRESET error)
 					// It seems real PSP respecting the socket buffer size arg, so we may need to cap the value up to the buffer size arg since we use larger buffer, for PDP/UDP the total size must not contains partial/truncated message to avoid data loss.
 					// TODO: We may need to manage PDP messages ourself by reading each msg 1-by-1 and moving it to our internal buffer(msg array) in order to calculate the correct messages size that can fit into buffer size when there are more than 1 messages in the recv buffer (simulate FIONREAD)
-					sock->data.pdp.rcv_sb_cc = getAvailToRecv(sock->data.pdp.id, sock->buffer_size);
+					sock->data.pdp.rcv_sb_cc = getAvailToRecv(sock->data.pdp.id, sock->buffer_size) + getRelayedPdpAvail(sock->data.pdp.lport);
 					// There might be a possibility for the data to be taken by the OS, thus FIONREAD returns 0, but can be Received
 					if (sock->data.pdp.rcv_sb_cc == 0) {
 						// Let's try to peek the data size
@@ -4330,6 +4406,7 @@ static int sceNetAdhocPtpRecv(int id, u32 dataAddr, u32 dataSizeAddr, int timeou
 						auto peer = findFriend(&ptpsocket.paddr);
 						if (peer != NULL) peer->last_recv = CoreTiming::GetGlobalTimeUsScaled();
 						peerlock.unlock();
+						ReportPtpLatency(socket);
 
 						DEBUG_LOG(Log::sceNet, "sceNetAdhocPtpRecv[%i:%u]: Received %u bytes from %s:%u\n", id, ptpsocket.lport, received, mac2str(&ptpsocket.paddr).c_str(), ptpsocket.pport);
 
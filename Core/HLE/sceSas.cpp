@@ -33,6 +33,7 @@
 #include <condition_variable>
 
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Log.h"
@@ -105,7 +106,8 @@ int __SasThread() {
 
 	std::unique_lock<std::mutex> guard(sasWakeMutex);
 	while (sasThreadState != SasThreadState::DISABLED) {
-		sasWake.wait(guard);
+		// A mix might already be queued by the time this thread starts, so don't just wait.
+		sasWake.wait(guard, [] { return sasThreadState != SasThreadState::READY; });
 		if (sasThreadState == SasThreadState::QUEUED) {
 			sas->Mix(sasThreadParams.outAddr, sasThreadParams.inAddr, sasThreadParams.leftVol, sasThreadParams.rightVol);
 
@@ -123,7 +125,29 @@ static void __SasDrain() {
 		sasDone.wait(guard);
 }
 
+static void __SasDisableThread();
+
+static void __SasUpdateThread() {
+	// Old save states have no event to wait for the mix with, so those can't use the thread.
+	const bool wanted = g_Config.bSeparateSASThread && sasMixEvent != -1;
+	const bool enabled = sasThreadState != SasThreadState::DISABLED;
+	if (wanted == enabled)
+		return;
+
+	if (enabled) {
+		__SasDrain();
+		__SasDisableThread();
+	} else {
+		sasThreadState = SasThreadState::READY;
+		sasThread = new std::thread(__SasThread);
+	}
+}
+
 static void __SasEnqueueMix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int rightVol = 0) {
+	// Pick up a setting change between grains.  The guest waits on sasMixEvent for each mix,
+	// so it never sees the output before it's complete either way.
+	__SasUpdateThread();
+
 	if (sasThreadState == SasThreadState::DISABLED) {
 		// No thread, call it immediately.
 		sas->Mix(outAddr, inAddr, leftVol, rightVol);
@@ -163,6 +187,7 @@ static void __SasDisableThread() {
 
 static void sasMixFinish(u64 userdata, int cycleslate) {
 	PROFILE_THIS_SCOPE("mixer");
+	TRACE_SCOPE("sas_mix");
 
 	u32 error;
 	SceUID threadID = (SceUID)userdata;
@@ -185,12 +210,8 @@ void __SasInit() {
 
 	sasMixEvent = CoreTiming::RegisterEvent("SasMix", sasMixFinish);
 
-	if (g_Config.bSeparateSASThread) {
-		sasThreadState = SasThreadState::READY;
-		sasThread = new std::thread(__SasThread);
-	} else {
-		sasThreadState = SasThreadState::DISABLED;
-	}
+	sasThreadState = SasThreadState::DISABLED;
+	__SasUpdateThread();
 }
 
 void __SasDoState(PointerWrap &p) {
@@ -18,6 +18,7 @@
 #include <condition_variable>
 #include <mutex>
 
+#include "Common/Profiler/Tracer.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Serialize/SerializeMap.h"
@@ -132,12 +133,14 @@ void AsyncIOManager::ProcessEvent(AsyncIOEvent ev) {
 }
 
 void AsyncIOManager::Read(u32 handle, u8 *buf, size_t bytes, u32 invalidateAddr) {
+	TRACE_SCOPE("io_async_read");
 	int usec = 0;
 	s64 result = pspFileSystem.ReadFile(handle, buf, bytes, usec);
 	EventResult(handle, AsyncIOResult(result, usec, invalidateAddr));
 }
 
 void AsyncIOManager::Write(u32 handle, const u8 *buf, size_t bytes) {
+	TRACE_SCOPE("io_async_write");
 	int usec = 0;
 	s64 result = pspFileSystem.WriteFile(handle, buf, bytes, usec);
 	EventResult(handle, AsyncIOResult(result, usec));
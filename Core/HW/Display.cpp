@@ -16,6 +16,7 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <mutex>
 #include <vector>
@@ -26,6 +27,7 @@
 #include "Core/Config.h"
 #include "Core/System.h"
 #include "Core/CoreTiming.h"
+#include "Core/HLE/__sceAudio.h"
 #include "Core/HLE/sceKernel.h"
 #include "Core/HW/Display.h"
 #include "GPU/GPU.h"
@@ -69,6 +71,43 @@ static constexpr int frameTimeHistorySize = (int)ARRAY_SIZE(frameTimeHistory);
 static int frameTimeHistoryPos = 0;
 static int frameTimeHistoryValid = 0;
 static double lastFrameTimeHistory = 0.0;
+static FrameBreakdown frameBreakdownHistory[600];
+// Accumulated since the last frame.
+static double framePhaseTimes[(int)FramePhase::COUNT];
+static double cpuRunningStart = 0.0;
+static std::atomic<uint32_t> frameCauses;
+static int lastUnderrunCount = 0;
+
+static void RecordFrameBreakdown(double now, int pos) {
+	if (cpuRunningStart != 0.0) {
+		framePhaseTimes[(int)FramePhase::CPU] += now - cpuRunningStart;
+		cpuRunningStart = now;
+	}
+
+	AudioDebugStats audioStats{};
+	System_AudioGetDebugStats(&audioStats);
+	uint32_t causes = frameCauses.exchange(0);
+	if (audioStats.underrunCount > lastUnderrunCount)
+		causes |= FRAME_CAUSE_AUDIO_UNDERRUN;
+	lastUnderrunCount = audioStats.underrunCount;
+
+	const double *t = framePhaseTimes;
+	const double texture = t[(int)FramePhase::TEXTURE];
+	const double shader = t[(int)FramePhase::SHADER];
+	const double draw = std::max(t[(int)FramePhase::DRAW], texture + shader);
+	const double ge = std::max(t[(int)FramePhase::GE], draw);
+	FrameBreakdown &breakdown = frameBreakdownHistory[pos];
+	breakdown.phases[(int)FramePhase::SHADER] = (float)shader;
+	breakdown.phases[(int)FramePhase::TEXTURE] = (float)texture;
+	breakdown.phases[(int)FramePhase::DRAW] = (float)(draw - texture - shader);
+	breakdown.phases[(int)FramePhase::GE] = (float)(ge - draw);
+	// Sleeping to keep the frame rate happens in the CPU loop.
+	breakdown.phases[(int)FramePhase::CPU] = (float)std::max(0.0, t[(int)FramePhase::CPU] - frameSleepHistory[pos]);
+	breakdown.causes = causes;
+
+	for (double &phase : framePhaseTimes)
+		phase = 0.0;
+}
 
 static void CalculateFPS() {
 	double now = time_now_d();
@@ -93,6 +132,7 @@ static void CalculateFPS() {
 	}
 
 	if ((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::FRAME_GRAPH || coreCollectDebugStats) {
+		RecordFrameBreakdown(now, frameTimeHistoryPos);
 		frameTimeHistory[frameTimeHistoryPos++] = now - lastFrameTimeHistory;
 		lastFrameTimeHistory = now;
 		frameTimeHistoryPos = frameTimeHistoryPos % frameTimeHistorySize;
@@ -180,6 +220,27 @@ void DisplayNotifySleep(double t, int pos) {
 	frameSleepHistory[pos] += t;
 }
 
+const FrameBreakdown *__DisplayGetFrameBreakdown() {
+	return frameBreakdownHistory;
+}
+
+void DisplayNotifyPhase(FramePhase phase, double t) {
+	// Texture decoding is timed regardless, don't let it pile up.
+	if (coreCollectDebugStats)
+		framePhaseTimes[(int)phase] += t;
+}
+
+void DisplayNotifyCPURunning(bool running) {
+	double now = time_now_d();
+	if (!running && cpuRunningStart != 0.0)
+		framePhaseTimes[(int)FramePhase::CPU] += now - cpuRunningStart;
+	cpuRunningStart = running ? now : 0.0;
+}
+
+void DisplayNotifyCause(uint32_t causes) {
+	frameCauses.fetch_or(causes, std::memory_order_relaxed);
+}
+
 void __DisplayGetDebugStats(char *stats, size_t bufsize) {
 	char statbuf[4096];
 	if (!gpu) {
@@ -321,6 +382,10 @@ void DisplayHWInit() {
 	frameTimeHistoryValid = 0;
 	frameTimeHistoryPos = 0;
 	lastFrameTimeHistory = 0.0;
+	for (double &phase : framePhaseTimes)
+		phase = 0.0;
+	cpuRunningStart = 0.0;
+	frameCauses = 0;
 }
 
 void DisplayHWShutdown() {
@@ -19,6 +19,8 @@
 
 #include <cstdint>
 
+#include "Common/TimeUtil.h"
+
 class PointerWrap;
 
 typedef void (*VblankCallback)();
@@ -44,6 +46,60 @@ void __DisplayGetVPS(float *out_vps);
 double *__DisplayGetFrameTimes(int *out_valid, int *out_pos, double **out_sleep);
 int DisplayGetSleepPos();
 void DisplayNotifySleep(double t, int pos = -1);
+
+// Where each frame's time went, for the frame timeline overlay.  Collected along with the frame
+// times, while debug stats are collected.
+enum class FramePhase {
+	CPU,
+	GE,
+	DRAW,
+	TEXTURE,
+	SHADER,
+	COUNT,
+};
+
+// Things that can cause a hitch, marked on the frame they happened in.
+enum FrameCause : uint32_t {
+	FRAME_CAUSE_SHADER_COMPILE = 1 << 0,
+	FRAME_CAUSE_JIT_CLEAR = 1 << 1,
+	FRAME_CAUSE_READBACK = 1 << 2,
+	FRAME_CAUSE_AUDIO_UNDERRUN = 1 << 3,
+};
+
+struct FrameBreakdown {
+	// In seconds.  Nested phases (like texture decoding during a draw) are subtracted, so these add up.
+	float phases[(int)FramePhase::COUNT];
+	uint32_t causes;
+};
+
+// Indexed the same as __DisplayGetFrameTimes().
+const FrameBreakdown *__DisplayGetFrameBreakdown();
+// Only from the emu thread.  Time in GE includes draws, which include textures and shaders.
+void DisplayNotifyPhase(FramePhase phase, double t);
+// The CPU is often running when the frame ends, so this is tracked by start and stop instead.
+void DisplayNotifyCPURunning(bool running);
+// From any thread.
+void DisplayNotifyCause(uint32_t causes);
+
+// Like TimeCollector, for a FramePhase.  The cause is marked even when not timing.
+class FramePhaseTimer {
+public:
+	FramePhaseTimer(FramePhase phase, bool enable, uint32_t causes = 0) : phase_(phase), enabled_(enable) {
+		if (causes)
+			DisplayNotifyCause(causes);
+		if (enable)
+			startTime_ = time_now_d();
+	}
+	~FramePhaseTimer() {
+		if (enabled_)
+			DisplayNotifyPhase(phase_, time_now_d() - startTime_);
+	}
+
+private:
+	FramePhase phase_;
+	bool enabled_;
+	double startTime_ = 0.0;
+};
 bool DisplayIsRunningSlow();
 
 void DisplayFireVblankStart();
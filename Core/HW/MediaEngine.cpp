@@ -17,6 +17,8 @@
 
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Math/SIMDHeaders.h"
+#include "Common/Thread/ThreadUtil.h"
+#include "Core/Config.h"
 #include "Core/System.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/HW/MediaEngine.h"
@@ -25,6 +27,7 @@
 #include "GPU/GPUState.h"  // Used by TextureDecoder.h when templates get instanced
 #include "GPU/Common/TextureDecoder.h"
 #include "Core/HW/SimpleAudioDec.h"
+#include "Common/Data/Convert/ColorConv.h"
 
 #include <algorithm>
 
@@ -37,6 +40,11 @@ extern "C" {
 #include "libavutil/imgutils.h"
 #include "libswscale/swscale.h"
 
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 18, 100)
+#include "libavutil/hwcontext.h"
+#define MEDIAENGINE_HW_DECODE
+#endif
+
 }
 #endif // USE_FFMPEG
 
@@ -44,6 +52,61 @@ extern "C" {
 
 #include "Core/FFMPEGCompat.h"
 
+#ifdef MEDIAENGINE_HW_DECODE
+static AVHWDeviceType preferredHWDeviceType() {
+#if PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(UWP)
+	return AV_HWDEVICE_TYPE_D3D11VA;
+#elif PPSSPP_PLATFORM(MAC) || PPSSPP_PLATFORM(IOS)
+	return AV_HWDEVICE_TYPE_VIDEOTOOLBOX;
+#elif PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID)
+	return AV_HWDEVICE_TYPE_VAAPI;
+#else
+	// MediaCodec is a separate decoder in ffmpeg, and needs the Java VM passed in first.
+	return AV_HWDEVICE_TYPE_NONE;
+#endif
+}
+
+static AVPixelFormat getHWFormat(AVCodecContext *ctx, const AVPixelFormat *formats) {
+	const AVPixelFormat hwFormat = (AVPixelFormat)(intptr_t)ctx->opaque;
+	for (const AVPixelFormat *p = formats; *p != AV_PIX_FMT_NONE; ++p) {
+		if (*p == hwFormat)
+			return *p;
+	}
+	// Probably a size or profile the hardware can't do.  Not a problem, ffmpeg will decode it.
+	WARN_LOG(Log::ME, "Hardware video decoding unavailable for this video, using software");
+	return avcodec_default_get_format(ctx, formats);
+}
+
+// Makes the context decode through the platform's decoder, if it supports the codec.
+static bool setupHWDecode(AVCodecContext *ctx, const AVCodec *codec, AVBufferRef **device) {
+	const AVHWDeviceType type = preferredHWDeviceType();
+	if (type == AV_HWDEVICE_TYPE_NONE)
+		return false;
+
+	AVPixelFormat hwFormat = AV_PIX_FMT_NONE;
+	for (int i = 0; const AVCodecHWConfig *config = avcodec_get_hw_config(codec, i); ++i) {
+		if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) != 0 && config->device_type == type) {
+			hwFormat = config->pix_fmt;
+			break;
+		}
+	}
+	if (hwFormat == AV_PIX_FMT_NONE)
+		return false;
+
+	if (!*device && av_hwdevice_ctx_create(device, type, nullptr, nullptr, 0) < 0) {
+		WARN_LOG(Log::ME, "Unable to create %s device for video decoding", av_hwdevice_get_type_name(type));
+		*device = nullptr;
+		return false;
+	}
+
+	ctx->hw_device_ctx = av_buffer_ref(*device);
+	ctx->opaque = (void *)(intptr_t)hwFormat;
+	ctx->get_format = &getHWFormat;
+	INFO_LOG(Log::ME, "Decoding video using %s", av_hwdevice_get_type_name(type));
+	return true;
+}
+#endif
+
 static AVPixelFormat getSwsFormat(int pspFormat)
 {
 	switch (pspFormat)
@@ -144,6 +207,8 @@ void MediaEngine::DoState(PointerWrap &p) {
 	auto s = p.Section("MediaEngine", 1, 7);
 	if (!s)
 		return;
+	if (p.mode == p.MODE_READ)
+		stopDecodeAhead();
 
 	Do(p, m_videoStream);
 	Do(p, m_audioStream);
@@ -177,8 +242,20 @@ void MediaEngine::DoState(PointerWrap &p) {
 	u32 hasopencontext = false;
 #endif
 	Do(p, hasopencontext);
-	if (m_pdata)
-		m_pdata->DoState(p);
+	if (m_pdata) {
+		std::unique_lock<std::mutex> guard(m_decodeLock);
+		if (!m_aheadData.empty() && p.mode != p.MODE_READ) {
+			// Save it as if nothing was read ahead yet.
+			BufferQueue unread(m_ringbuffersize + 2048);
+			std::vector<u8> queued(m_pdata->getQueueSize());
+			m_pdata->get_front(queued.data(), (int)queued.size());
+			unread.push(m_aheadData.data(), (int)m_aheadData.size());
+			unread.push(queued.data(), (int)queued.size());
+			unread.DoState(p);
+		} else {
+			m_pdata->DoState(p);
+		}
+	}
 	if (m_demux)
 		m_demux->DoState(p);
 
@@ -217,6 +294,8 @@ int MediaEngine::MpegReadbuffer(void *opaque, uint8_t *buf, int buf_size) {
 		size = std::min(buf_size, mpeg->m_mpegheaderSize - mpeg->m_mpegheaderReadPos);
 		memcpy(buf, mpeg->m_mpegheader + mpeg->m_mpegheaderReadPos, size);
 		mpeg->m_mpegheaderReadPos += size;
+	} else if (mpeg->m_decodingAhead) {
+		size = mpeg->readAhead(buf, buf_size);
 	} else {
 		size = mpeg->m_pdata->pop_front(buf, buf_size);
 		if (size > 0)
@@ -339,6 +418,7 @@ bool MediaEngine::openContext(bool keepReadPos) {
 
 void MediaEngine::closeContext()
 {
+	stopDecodeAhead();
 #ifdef USE_FFMPEG
 	if (m_buffer)
 		av_free(m_buffer);
@@ -346,6 +426,8 @@ void MediaEngine::closeContext()
 		av_frame_free(&m_pFrameRGB);
 	if (m_pFrame)
 		av_frame_free(&m_pFrame);
+	if (m_pFrameSW)
+		av_frame_free(&m_pFrameSW);
 	if (m_pIOContext && m_pIOContext->buffer)
 		av_free(m_pIOContext->buffer);
 	if (m_pIOContext)
@@ -367,7 +449,10 @@ void MediaEngine::closeContext()
 		avformat_close_input(&m_pFormatCtx);
 	sws_freeContext(m_sws_ctx);
 	m_sws_ctx = nullptr;
+	m_sws_srcFmt = -1;
 	m_pIOContext = nullptr;
+	// After the codecs, which hold references to it.
+	av_buffer_unref(&m_hwDeviceCtx);
 #endif
 	m_buffer = nullptr;
 }
@@ -404,6 +489,7 @@ bool MediaEngine::addVideoStream(int streamNum, int streamId) {
 		AVCodec *h264_codec = avcodec_find_decoder(AV_CODEC_ID_H264);
 		if (!h264_codec)
 			return false;
+		finishDecodeAhead(nullptr);
 		AVStream *stream = avformat_new_stream(m_pFormatCtx, h264_codec);
 		if (stream) {
 			// Reference ISO/IEC 13818-1.
@@ -443,8 +529,12 @@ bool MediaEngine::addVideoStream(int streamNum, int streamId) {
 int MediaEngine::addStreamData(const u8 *buffer, int addSize) {
 	int size = addSize;
 	if (size > 0 && m_pdata) {
-		if (!m_pdata->push(buffer, size)) 
-			size  = 0;
+		std::unique_lock<std::mutex> guard(m_decodeLock);
+		// Data read ahead still counts as in the queue, or it'd accept more than it could hold.
+		if (m_pdata->getRemainSize() - (int)m_aheadData.size() < size || !m_pdata->push(buffer, size))
+			size = 0;
+		m_decodeCond.notify_all();
+		guard.unlock();
 		if (m_demux) {
 			m_demux->addStreamData(buffer, addSize);
 		}
@@ -502,6 +592,8 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 		// Yay, nothing to do.
 		return true;
 	}
+	// Not exactly what would have happened, but it can't read from the other stream meanwhile.
+	finishDecodeAhead(nullptr);
 
 #ifdef USE_FFMPEG
 	if (m_pFormatCtx && m_pCodecCtxs.find(streamNum) == m_pCodecCtxs.end()) {
@@ -534,9 +626,16 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 
 		m_pCodecCtx->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT | AV_CODEC_FLAG_LOW_DELAY;
 
+		bool hwDecode = false;
+#ifdef MEDIAENGINE_HW_DECODE
+		if (g_Config.bHardwareVideoDecode)
+			hwDecode = setupHWDecode(m_pCodecCtx, pCodec, &m_hwDeviceCtx);
+#endif
+
 		AVDictionary *opt = nullptr;
 		// Allow ffmpeg to use any number of threads it wants.  Without this, it doesn't use threads.
-		av_dict_set(&opt, "threads", "0", 0);
+		// Hardware decoders do their own thing, and frame threads would only add delay there.
+		av_dict_set(&opt, "threads", hwDecode ? "1" : "0", 0);
 		int openResult = avcodec_open2(m_pCodecCtx, pCodec, &opt);
 		av_dict_free(&opt);
 		if (openResult < 0) {
@@ -619,7 +718,7 @@ void MediaEngine::updateSwsFormat(int videoPixelMode) {
 				m_sws_ctx,
 				m_pCodecCtx->width,
 				m_pCodecCtx->height,
-				m_pCodecCtx->pix_fmt,
+				m_sws_srcFmt != -1 ? (AVPixelFormat)m_sws_srcFmt : m_pCodecCtx->pix_fmt,
 				m_desWidth,
 				m_desHeight,
 				(AVPixelFormat)m_sws_fmt,
@@ -643,18 +742,44 @@ void MediaEngine::updateSwsFormat(int videoPixelMode) {
 #endif
 }
 
-bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #ifdef USE_FFMPEG
-	auto codecIter = m_pCodecCtxs.find(m_videoStream);
-	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
-
-	if (!m_pFormatCtx)
+bool MediaEngine::convertYUV420Frame(const AVFrame *frame, int videoPixelMode) {
+	// Only the usual case: 4:2:0 at the decoded size.  Range is always treated as MPEG's, like sws.
+	if (frame->format != AV_PIX_FMT_YUV420P && frame->format != AV_PIX_FMT_YUVJ420P)
 		return false;
-	if (!m_pCodecCtx)
-		return false;
-	if (!m_pFrame)
+	if (frame->width != m_desWidth || frame->height != m_desHeight)
 		return false;
 
+	u8 *dst = m_pFrameRGB->data[0];
+	const int dstStride = m_pFrameRGB->linesize[0];
+	for (int y = 0; y < m_desHeight; ++y) {
+		const u8 *ysrc = frame->data[0] + y * frame->linesize[0];
+		const u8 *usrc = frame->data[1] + (y / 2) * frame->linesize[1];
+		const u8 *vsrc = frame->data[2] + (y / 2) * frame->linesize[2];
+		switch (videoPixelMode) {
+		case GE_CMODE_32BIT_ABGR8888:
+			ConvertYUV420ToRGBA8888((u32 *)dst, ysrc, usrc, vsrc, m_desWidth);
+			break;
+		case GE_CMODE_16BIT_BGR5650:
+			ConvertYUV420ToRGB565((u16 *)dst, ysrc, usrc, vsrc, m_desWidth);
+			break;
+		case GE_CMODE_16BIT_ABGR5551:
+			ConvertYUV420ToRGBA5551((u16 *)dst, ysrc, usrc, vsrc, m_desWidth);
+			break;
+		case GE_CMODE_16BIT_ABGR4444:
+			ConvertYUV420ToRGBA4444((u16 *)dst, ysrc, usrc, vsrc, m_desWidth);
+			break;
+		default:
+			return false;
+		}
+		dst += dstStride;
+	}
+	return true;
+}
+#endif
+
+#ifdef USE_FFMPEG
+bool MediaEngine::decodeVideoFrame(AVCodecContext *m_pCodecCtx, int streamNum, DecodedVideo *decoded) {
 	AVPacket packet;
 	av_init_packet(&packet);
 	int frameFinished;
@@ -663,7 +788,7 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 		bool dataEnd = av_read_frame(m_pFormatCtx, &packet) < 0;
 		// Even if we've read all frames, some may have been re-ordered frames at the end.
 		// Still need to decode those, so keep calling avcodec_decode_video2() / avcodec_receive_frame().
-		if (dataEnd || packet.stream_index == m_videoStream) {
+		if (dataEnd || packet.stream_index == streamNum) {
 			// avcodec_decode_video2() / avcodec_send_packet() gives us the re-ordered frames with a NULL packet.
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 12, 100)
 			if (dataEnd)
@@ -690,19 +815,6 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 			int result = avcodec_decode_video2(m_pCodecCtx, m_pFrame, &frameFinished, &packet);
 #endif
 			if (frameFinished) {
-				if (!m_pFrameRGB) {
-					setVideoDim();
-				}
-				if (m_pFrameRGB && !skipFrame) {
-					updateSwsFormat(videoPixelMode);
-					// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
-					// Update the linesize for the new format too.  We started with the largest size, so it should fit.
-					m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
-
-					sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
-						m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
-				}
-
 #if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(55, 58, 100)
 				int64_t bestPts = m_pFrame->best_effort_timestamp;
 				int64_t ptsDuration = m_pFrame->pkt_duration;
@@ -711,28 +823,27 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 				int64_t ptsDuration = av_frame_get_pkt_duration(m_pFrame);
 #endif
 				if (ptsDuration == 0) {
-					if (m_lastPts == bestPts - m_firstTimeStamp || bestPts == AV_NOPTS_VALUE) {
+					if (decoded->lastPts == bestPts - m_firstTimeStamp || bestPts == AV_NOPTS_VALUE) {
 						// TODO: Assuming 29.97 if missing.
-						m_videopts += 3003;
+						decoded->videopts += 3003;
 					} else {
-						m_videopts = bestPts - m_firstTimeStamp;
-						m_lastPts = m_videopts;
+						decoded->videopts = bestPts - m_firstTimeStamp;
+						decoded->lastPts = decoded->videopts;
 					}
 				} else if (bestPts != AV_NOPTS_VALUE) {
-					m_videopts = bestPts + ptsDuration - m_firstTimeStamp;
-					m_lastPts = m_videopts;
+					decoded->videopts = bestPts + ptsDuration - m_firstTimeStamp;
+					decoded->lastPts = decoded->videopts;
 				} else {
-					m_videopts += ptsDuration;
-					m_lastPts = m_videopts;
+					decoded->videopts += ptsDuration;
+					decoded->lastPts = decoded->videopts;
 				}
 				bGetFrame = true;
 			}
 			if (result <= 0 && dataEnd) {
 				// Sometimes, m_readSize is less than m_streamSize at the end, but not by much.
 				// This is kinda a hack, but the ringbuffer would have to be prematurely empty too.
-				m_isVideoEnd = !bGetFrame && (m_pdata->getQueueSize() == 0);
-				if (m_isVideoEnd)
-					m_decodingsize = 0;
+				decoded->reachedEnd = true;
+				decoded->videoEnd = !bGetFrame && (m_pdata->getQueueSize() == 0);
 				break;
 			}
 		}
@@ -742,7 +853,175 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 		av_free_packet(&packet);
 #endif
 	}
+	decoded->gotFrame = bGetFrame;
 	return bGetFrame;
+}
+#endif
+
+void MediaEngine::applyDecodedVideo(const DecodedVideo &decoded) {
+	m_videopts = decoded.videopts;
+	m_lastPts = decoded.lastPts;
+	if (decoded.decodingsize >= 0)
+		m_decodingsize = decoded.decodingsize;
+	if (decoded.reachedEnd) {
+		m_isVideoEnd = decoded.videoEnd;
+		if (m_isVideoEnd)
+			m_decodingsize = 0;
+	}
+}
+
+void MediaEngine::startDecodeAhead() {
+#ifdef USE_FFMPEG
+	// Another stream could be switched to before the next frame, and its packets would be gone.
+	if (m_pCodecCtxs.size() != 1 || m_pFormatCtx->nb_streams != 1 || m_mpegheaderReadPos < m_mpegheaderSize)
+		return;
+
+	std::lock_guard<std::mutex> guard(m_decodeLock);
+	_dbg_assert_(m_decodeAheadState == DecodeAheadState::IDLE);
+	m_decodedAhead = DecodedVideo();
+	m_decodedAhead.videopts = m_videopts;
+	m_decodedAhead.lastPts = m_lastPts;
+	m_aheadCodecCtx = m_pCodecCtxs.begin()->second;
+	m_aheadStream = m_videoStream;
+	m_decodeWanted = false;
+	m_decodeAheadState = DecodeAheadState::QUEUED;
+	if (!m_decodeThread.joinable()) {
+		m_decodeStop = false;
+		m_decodeThread = std::thread([this] { decodeAheadLoop(); });
+	}
+	m_decodeCond.notify_all();
+#endif
+}
+
+bool MediaEngine::finishDecodeAhead(DecodedVideo *result) {
+	std::unique_lock<std::mutex> guard(m_decodeLock);
+	if (m_decodeAheadState == DecodeAheadState::IDLE)
+		return false;
+
+	m_decodeWanted = true;
+	m_decodeCond.notify_all();
+	m_decodeCond.wait(guard, [this] { return m_decodeAheadState == DecodeAheadState::DONE; });
+	if (result) {
+		*result = m_decodedAhead;
+		m_decodeAheadState = DecodeAheadState::IDLE;
+		m_aheadData.clear();
+	}
+	return true;
+}
+
+void MediaEngine::stopDecodeAhead() {
+	if (!m_decodeThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(m_decodeLock);
+		m_decodeStop = true;
+		m_decodeCond.notify_all();
+	}
+	m_decodeThread.join();
+	// Whatever it decoded is thrown away along with the context.
+	m_decodeAheadState = DecodeAheadState::IDLE;
+	m_aheadData.clear();
+}
+
+void MediaEngine::decodeAheadLoop() {
+	SetCurrentThreadName("MediaDecode");
+
+	std::unique_lock<std::mutex> guard(m_decodeLock);
+	while (true) {
+		m_decodeCond.wait(guard, [this] { return m_decodeAheadState == DecodeAheadState::QUEUED || m_decodeStop; });
+		if (m_decodeStop)
+			break;
+
+		m_decodingAhead = true;
+		guard.unlock();
+#ifdef USE_FFMPEG
+		decodeVideoFrame(m_aheadCodecCtx, m_aheadStream, &m_decodedAhead);
+#endif
+		guard.lock();
+		m_decodingAhead = false;
+		m_decodeAheadState = DecodeAheadState::DONE;
+		m_decodeCond.notify_all();
+	}
+}
+
+int MediaEngine::readAhead(uint8_t *buf, int buf_size) {
+	std::unique_lock<std::mutex> guard(m_decodeLock);
+	// Until the game wants the frame, more data might still arrive that it would've read.
+	m_decodeCond.wait(guard, [&] { return m_pdata->getQueueSize() >= buf_size || m_decodeWanted || m_decodeStop; });
+	if (m_decodeStop)
+		return 0;
+
+	int size = m_pdata->pop_front(buf, buf_size);
+	m_aheadData.insert(m_aheadData.end(), buf, buf + size);
+	if (size > 0)
+		m_decodedAhead.decodingsize = size;
+	return size;
+}
+
+bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
+#ifdef USE_FFMPEG
+	auto codecIter = m_pCodecCtxs.find(m_videoStream);
+	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
+
+	if (!m_pFormatCtx)
+		return false;
+	if (!m_pCodecCtx)
+		return false;
+	if (!m_pFrame)
+		return false;
+
+	DecodedVideo decoded;
+	if (!finishDecodeAhead(&decoded)) {
+		decoded.videopts = m_videopts;
+		decoded.lastPts = m_lastPts;
+		decodeVideoFrame(m_pCodecCtx, m_videoStream, &decoded);
+	}
+	applyDecodedVideo(decoded);
+
+	if (decoded.gotFrame) {
+		if (!m_pFrameRGB) {
+			setVideoDim();
+		}
+		if (m_pFrameRGB && !skipFrame) {
+			AVFrame *frame = m_pFrame;
+#ifdef MEDIAENGINE_HW_DECODE
+			if (m_pFrame->hw_frames_ctx) {
+				// Skipped frames never leave the decoder, so those stay cheap.
+				if (!m_pFrameSW)
+					m_pFrameSW = av_frame_alloc();
+				av_frame_unref(m_pFrameSW);
+				if (av_hwframe_transfer_data(m_pFrameSW, m_pFrame, 0) < 0) {
+					ERROR_LOG(Log::ME, "Unable to download decoded video frame");
+					frame = nullptr;
+				} else {
+					frame = m_pFrameSW;
+				}
+			}
+#endif
+			if (frame && frame->format != m_sws_srcFmt) {
+				// Usually just the first frame, otherwise a switch to or from hardware.
+				m_sws_srcFmt = frame->format;
+				m_sws_fmt = -1;
+			}
+
+			if (frame) {
+				// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
+				// Update the linesize for the new format too.  We started with the largest size, so it should fit.
+				m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
+
+				if (!convertYUV420Frame(frame, videoPixelMode)) {
+					updateSwsFormat(videoPixelMode);
+					sws_scale(m_sws_ctx, frame->data, frame->linesize, 0,
+						m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
+				}
+			}
+		}
+
+		// The frame is converted, so m_pFrame is free for the next one.
+		startDecodeAhead();
+	}
+	return decoded.gotFrame;
 #else
 	// If video engine is not available, just add to the timestamp at least.
 	m_videopts += 3003;
@@ -1016,7 +1295,8 @@ u8 *MediaEngine::getFrameImage() {
 int MediaEngine::getRemainSize() {
 	if (!m_pdata)
 		return 0;
-	return std::max(m_pdata->getRemainSize() - m_decodingsize - 2048, 0);
+	std::lock_guard<std::mutex> guard(m_decodeLock);
+	return std::max(m_pdata->getRemainSize() - (int)m_aheadData.size() - m_decodingsize - 2048, 0);
 }
 
 int MediaEngine::getAudioRemainSize() {
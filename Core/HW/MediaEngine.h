@@ -24,7 +24,11 @@
 
 // An approximation of what the interface will look like. Similar to JPCSP's.
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "Common/CommonTypes.h"
 #include "Core/HLE/sceMpeg.h"
 #include "Core/HW/MpegDemux.h"
@@ -39,6 +43,7 @@ struct AVFrame;
 struct AVIOContext;
 struct AVFormatContext;
 struct AVCodecContext;
+struct AVBufferRef;
 #endif
 
 inline s64 getMpegTimeStamp(const u8 *buf) {
@@ -94,11 +99,45 @@ class MediaEngine {
 	void DoState(PointerWrap &p);
 
 private:
+	// What decoding one frame changes, so it can be kept aside when decoded ahead.
+	struct DecodedVideo {
+		bool gotFrame = false;
+		// Whether the end of the data was reached, and if that meant the end of the video.
+		bool reachedEnd = false;
+		bool videoEnd = false;
+		s64 videopts = 0;
+		s64 lastPts = -1;
+		// The size of the last read, or -1 if nothing was read.
+		int decodingsize = -1;
+	};
+
+	enum class DecodeAheadState {
+		IDLE,
+		QUEUED,
+		DONE,
+	};
+
 	bool SetupStreams();
 	bool setVideoDim(int width = 0, int height = 0);
 	void updateSwsFormat(int videoPixelMode);
+#ifdef USE_FFMPEG
+	// Converts straight into m_pFrameRGB without sws, if the frame is in a format we handle.
+	bool convertYUV420Frame(const AVFrame *frame, int videoPixelMode);
+	bool decodeVideoFrame(AVCodecContext *codecCtx, int streamNum, DecodedVideo *result);
+#endif
+	void applyDecodedVideo(const DecodedVideo &result);
 	int getNextAudioFrame(u8 **buf, int *headerCode1, int *headerCode2);
 
+	// The next frame is decoded on a thread while the game waits out the decode delay and
+	// feeds the ringbuffer.  Reads wait for data that a decode right away would have had,
+	// so the result is the same as decoding once the game asks for the frame.
+	void startDecodeAhead();
+	// Lets the decode finish with the data there is now, and takes the result if any.
+	bool finishDecodeAhead(DecodedVideo *result);
+	void stopDecodeAhead();
+	void decodeAheadLoop();
+	int readAhead(uint8_t *buf, int buf_size);
+
 	static int MpegReadbuffer(void *opaque, uint8_t *buf, int buf_size);
 
 public:  // TODO: Very little of this below should be public.
@@ -107,6 +146,8 @@ class MediaEngine {
 	std::map<int, AVCodecContext *> m_pCodecCtxs;
 	AVFrame *m_pFrame = nullptr;
 	AVFrame *m_pFrameRGB = nullptr;
+	// Frames from a hardware decoder are copied here first.
+	AVFrame *m_pFrameSW = nullptr;
 #endif
 
 	u8 *m_buffer = nullptr;
@@ -128,9 +169,12 @@ class MediaEngine {
 	std::vector<AVCodecContext *> m_codecsToClose;
 	AVIOContext *m_pIOContext = nullptr;
 	SwsContext *m_sws_ctx = nullptr;
+	AVBufferRef *m_hwDeviceCtx = nullptr;
 #endif
 
 	int m_sws_fmt = 0;
+	// Format of the frames going into sws, or -1 for the codec's.
+	int m_sws_srcFmt = -1;
 	int m_videoStream = -1;
 	int m_expectedVideoStreams = 0;
 
@@ -154,4 +198,22 @@ class MediaEngine {
 	u8 m_mpegheader[0x10000];  // TODO: Allocate separately
 	int m_mpegheaderReadPos = 0;
 	int m_mpegheaderSize = 0;
+
+	std::thread m_decodeThread;
+	// Protects everything below, and m_pdata while the thread is decoding.
+	std::mutex m_decodeLock;
+	std::condition_variable m_decodeCond;
+	DecodeAheadState m_decodeAheadState = DecodeAheadState::IDLE;
+	// Set when the game wants the frame, so reads stop waiting for more data.
+	bool m_decodeWanted = false;
+	bool m_decodeStop = false;
+	// Only touched by the thread while decoding.
+	bool m_decodingAhead = false;
+	DecodedVideo m_decodedAhead;
+#ifdef USE_FFMPEG
+	AVCodecContext *m_aheadCodecCtx = nullptr;
+#endif
+	int m_aheadStream = -1;
+	// Popped from m_pdata by the decode ahead, but not yet by the game's reckoning.
+	std::vector<u8> m_aheadData;
 };
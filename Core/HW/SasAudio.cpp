@@ -16,7 +16,9 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <cstring>
 
+#include "Common/Math/SIMDHeaders.h"
 #include "Common/Profiler/Profiler.h"
 
 #include "Common/Serialize/SerializeFuncs.h"
@@ -97,13 +99,48 @@ void VagDecoder::DecodeBlock(const u8 *&read_pointer) {
 	int coef1 = f[predict_nr][0];
 	int coef2 = -f[predict_nr][1];
 
-	// TODO: Unroll once more and interleave the unpacking with the decoding more?
+	// Unpack and shift all the nibbles at once, only the prediction has to go in order.
+	alignas(16) s16 nibbles[32];
+#if PPSSPP_ARCH(SSE2)
+	u8 data[16]{};
+	memcpy(data, readp, 14);
+	const __m128i d = _mm_loadu_si128((const __m128i *)data);
+	// Each nibble goes in the top of a byte, low one first, and then the top of a 16-bit lane.
+	const __m128i lo = _mm_slli_epi16(_mm_and_si128(d, _mm_set1_epi8(0x0F)), 4);
+	const __m128i hi = _mm_and_si128(d, _mm_set1_epi8((char)0xF0));
+	const __m128i first = _mm_unpacklo_epi8(lo, hi);
+	const __m128i second = _mm_unpackhi_epi8(lo, hi);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i shift = _mm_cvtsi32_si128(shift_factor);
+	_mm_store_si128((__m128i *)&nibbles[0], _mm_sra_epi16(_mm_unpacklo_epi8(zero, first), shift));
+	_mm_store_si128((__m128i *)&nibbles[8], _mm_sra_epi16(_mm_unpackhi_epi8(zero, first), shift));
+	_mm_store_si128((__m128i *)&nibbles[16], _mm_sra_epi16(_mm_unpacklo_epi8(zero, second), shift));
+	_mm_store_si128((__m128i *)&nibbles[24], _mm_sra_epi16(_mm_unpackhi_epi8(zero, second), shift));
+#elif PPSSPP_ARCH(ARM_NEON)
+	u8 data[16]{};
+	memcpy(data, readp, 14);
+	const uint8x16_t d = vld1q_u8(data);
+	const uint8x16_t lo = vshlq_n_u8(vandq_u8(d, vdupq_n_u8(0x0F)), 4);
+	const uint8x16_t hi = vandq_u8(d, vdupq_n_u8(0xF0));
+	const uint8x16x2_t interleaved = vzipq_u8(lo, hi);
+	// Negative, so it's an arithmetic shift right.
+	const int16x8_t shift = vdupq_n_s16(-shift_factor);
+	vst1q_s16(&nibbles[0], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(interleaved.val[0]), 8)), shift));
+	vst1q_s16(&nibbles[8], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(interleaved.val[0]), 8)), shift));
+	vst1q_s16(&nibbles[16], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(interleaved.val[1]), 8)), shift));
+	vst1q_s16(&nibbles[24], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(interleaved.val[1]), 8)), shift));
+#else
+	for (int i = 0; i < 14; i++) {
+		u8 d = readp[i];
+		nibbles[i * 2] = (short)((d & 0xf) << 12) >> shift_factor;
+		nibbles[i * 2 + 1] = (short)((d & 0xf0) << 8) >> shift_factor;
+	}
+#endif
+	readp += 14;
+
 	for (int i = 0; i < 28; i += 2) {
-		u8 d = *readp++;
-		int sample1 = (short)((d & 0xf) << 12) >> shift_factor;
-		int sample2 = (short)((d & 0xf0) << 8) >> shift_factor;
-		s2 = clamp_s16(sample1 + ((s1 * coef1 + s2 * coef2) >> 6));
-		s1 = clamp_s16(sample2 + ((s2 * coef1 + s1 * coef2) >> 6));
+		s2 = clamp_s16(nibbles[i] + ((s1 * coef1 + s2 * coef2) >> 6));
+		s1 = clamp_s16(nibbles[i + 1] + ((s2 * coef1 + s1 * coef2) >> 6));
 		samples[i] = s2;
 		samples[i + 1] = s1;
 	}
@@ -129,7 +166,7 @@ void VagDecoder::GetSamples(s16 *outSamples, int numSamples) {
 	const u8 *readp = Memory::GetPointerUnchecked(read_);
 	const u8 *origp = readp;
 
-	for (int i = 0; i < numSamples; i++) {
+	for (int i = 0; i < numSamples; ) {
 		if (curSample == 28) {
 			if (loopAtNextBlock_) {
 				VERBOSE_LOG(Log::SasMix, "Looping VAG from block %d/%d to %d", curBlock_, numBlocks_, loopStartBlock_);
@@ -148,7 +185,10 @@ void VagDecoder::GetSamples(s16 *outSamples, int numSamples) {
 			}
 		}
 		_dbg_assert_(curSample < 28);
-		outSamples[i] = samples[curSample++];
+		const int count = std::min(28 - curSample, numSamples - i);
+		memcpy(&outSamples[i], &samples[curSample], count * sizeof(s16));
+		curSample += count;
+		i += count;
 	}
 
 	if (readp > origp) {
@@ -520,6 +560,104 @@ bool SasVoice::HaveSamplesEnded() const {
 	}
 }
 
+static inline bool FitsS16(int v) {
+	return v >= -0x8000 && v <= 0x7FFF;
+}
+
+// Adds samples[start..end) times the volumes into the interleaved stereo dest.
+static void MixVoiceSamples(int *dest, const int *samples, int start, int end, int leftVol, int rightVol) {
+	int i = start;
+#if PPSSPP_ARCH(SSE2)
+	// Samples fit in 16 bits after the envelope, so madd gives exact products as long as the
+	// volumes do too, with the top half of each volume lane zero.
+	if (FitsS16(leftVol) && FitsS16(rightVol)) {
+		const __m128i vol = _mm_set_epi32(rightVol & 0xFFFF, leftVol & 0xFFFF, rightVol & 0xFFFF, leftVol & 0xFFFF);
+		for (; i + 4 <= end; i += 4) {
+			const __m128i s = _mm_loadu_si128((const __m128i *)&samples[i]);
+			__m128i *d = (__m128i *)&dest[i * 2];
+			const __m128i first = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi32(s, s), vol), 12);
+			const __m128i second = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi32(s, s), vol), 12);
+			_mm_storeu_si128(d, _mm_add_epi32(_mm_loadu_si128(d), first));
+			_mm_storeu_si128(d + 1, _mm_add_epi32(_mm_loadu_si128(d + 1), second));
+		}
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int32_t volValues[4] = { leftVol, rightVol, leftVol, rightVol };
+	const int32x4_t vol = vld1q_s32(volValues);
+	for (; i + 4 <= end; i += 4) {
+		const int32x4_t s = vld1q_s32(&samples[i]);
+		const int32x4x2_t pairs = vzipq_s32(s, s);
+		int *d = &dest[i * 2];
+		vst1q_s32(d, vaddq_s32(vld1q_s32(d), vshrq_n_s32(vmulq_s32(pairs.val[0], vol), 12)));
+		vst1q_s32(d + 4, vaddq_s32(vld1q_s32(d + 4), vshrq_n_s32(vmulq_s32(pairs.val[1], vol), 12)));
+	}
+#endif
+	for (; i < end; i++) {
+		dest[i * 2] += (samples[i] * leftVol) >> 12;
+		dest[i * 2 + 1] += (samples[i] * rightVol) >> 12;
+	}
+}
+
+// Writes count interleaved samples of in scaled by the volumes, plus dry and wet if not null, clamped.
+static void WriteMixedSamples(s16 *out, const s16 *in, int leftVol, int rightVol, const int *dry, const s16 *wet, int count) {
+	int i = 0;
+#if PPSSPP_ARCH(SSE2)
+	if (!in || (FitsS16(leftVol) && FitsS16(rightVol))) {
+		const __m128i vol = _mm_set_epi32(rightVol & 0xFFFF, leftVol & 0xFFFF, rightVol & 0xFFFF, leftVol & 0xFFFF);
+		for (; i + 8 <= count; i += 8) {
+			__m128i first = _mm_setzero_si128();
+			__m128i second = _mm_setzero_si128();
+			if (in) {
+				const __m128i s = _mm_loadu_si128((const __m128i *)&in[i]);
+				first = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(s, s), vol), 12);
+				second = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(s, s), vol), 12);
+			}
+			if (dry) {
+				first = _mm_add_epi32(first, _mm_loadu_si128((const __m128i *)&dry[i]));
+				second = _mm_add_epi32(second, _mm_loadu_si128((const __m128i *)&dry[i + 4]));
+			}
+			if (wet) {
+				const __m128i w = _mm_loadu_si128((const __m128i *)&wet[i]);
+				first = _mm_add_epi32(first, _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16));
+				second = _mm_add_epi32(second, _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16));
+			}
+			// Saturates, the same as clamp_s16.
+			_mm_storeu_si128((__m128i *)&out[i], _mm_packs_epi32(first, second));
+		}
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int32_t volValues[4] = { leftVol, rightVol, leftVol, rightVol };
+	const int32x4_t vol = vld1q_s32(volValues);
+	for (; i + 8 <= count; i += 8) {
+		int32x4_t first = vdupq_n_s32(0);
+		int32x4_t second = vdupq_n_s32(0);
+		if (in) {
+			const int16x8_t s = vld1q_s16(&in[i]);
+			first = vshrq_n_s32(vmulq_s32(vmovl_s16(vget_low_s16(s)), vol), 12);
+			second = vshrq_n_s32(vmulq_s32(vmovl_s16(vget_high_s16(s)), vol), 12);
+		}
+		if (dry) {
+			first = vaddq_s32(first, vld1q_s32(&dry[i]));
+			second = vaddq_s32(second, vld1q_s32(&dry[i + 4]));
+		}
+		if (wet) {
+			const int16x8_t w = vld1q_s16(&wet[i]);
+			first = vaddw_s16(first, vget_low_s16(w));
+			second = vaddw_s16(second, vget_high_s16(w));
+		}
+		vst1q_s16(&out[i], vcombine_s16(vqmovn_s32(first), vqmovn_s32(second)));
+	}
+#endif
+	for (; i < count; i++) {
+		int sample = in ? (in[i] * ((i & 1) ? rightVol : leftVol)) >> 12 : 0;
+		if (dry)
+			sample += dry[i];
+		if (wet)
+			sample += wet[i];
+		out[i] = clamp_s16(sample);
+	}
+}
+
 void SasInstance::MixVoice(SasVoice &voice) {
 	switch (voice.type) {
 	case VOICETYPE_VAG:
@@ -570,6 +708,7 @@ void SasInstance::MixVoice(SasVoice &voice) {
 			voice.envelope.Step();
 		}
 
+		// The envelope and resampling have to go in order, but the volumes are applied after.
 		const bool needsInterp = voicePitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
 		for (int i = delay; i < grainSize; i++) {
 			const int16_t *s = mixTemp_ + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
@@ -590,17 +729,15 @@ void SasInstance::MixVoice(SasVoice &voice) {
 
 			// We just scale by the envelope before we scale by volumes.
 			// Again, we round up by adding (1 << 14) first (*after* multiplying.)
-			sample = ((sample * envelopeValue) + (1 << 14)) >> 15;
-
-			// We mix into this 32-bit temp buffer and clip in a second loop
-			// Ideally, the shift right should be there too but for now I'm concerned about
-			// not overflowing.
-			mixBuffer[i * 2] += (sample * voice.volumeLeft) >> 12;
-			mixBuffer[i * 2 + 1] += (sample * voice.volumeRight) >> 12;
-			sendBuffer[i * 2] += sample * voice.effectLeft >> 12;
-			sendBuffer[i * 2 + 1] += sample * voice.effectRight >> 12;
+			voiceTemp_[i] = ((sample * envelopeValue) + (1 << 14)) >> 15;
 		}
 
+		// We mix into these 32-bit temp buffers and clip in a second pass.
+		// Ideally, the shift right should be there too but for now I'm concerned about
+		// not overflowing.
+		MixVoiceSamples(mixBuffer, voiceTemp_, delay, grainSize, voice.volumeLeft, voice.volumeRight);
+		MixVoiceSamples(sendBuffer, voiceTemp_, delay, grainSize, voice.effectLeft, voice.effectRight);
+
 		voice.resampleHist[0] = mixTemp_[tempPos - 2];
 		voice.resampleHist[1] = mixTemp_[tempPos - 1];
 
@@ -664,51 +801,7 @@ void SasInstance::WriteMixedOutput(s16 *outp, const s16 *inp, int leftVol, int r
 		ApplyWaveformEffect();
 	}
 
-	if (inp) {
-		for (int i = 0; i < grainSize * 2; i += 2) {
-			int sampleL = ((*inp++) * leftVol >> 12);
-			int sampleR = ((*inp++) * rightVol >> 12);
-			if (dry) {
-				sampleL += mixBuffer[i + 0];
-				sampleR += mixBuffer[i + 1];
-			}
-			if (wet) {
-				sampleL += sendBufferProcessed[i + 0];
-				sampleR += sendBufferProcessed[i + 1];
-			}
-			*outp++ = clamp_s16(sampleL);
-			*outp++ = clamp_s16(sampleR);
-		}
-	} else {
-		// These are the optimal cases.
-		if (dry && wet) {
-			for (int i = 0; i < grainSize * 2; i += 2) {
-				*outp++ = clamp_s16(mixBuffer[i + 0] + sendBufferProcessed[i + 0]);
-				*outp++ = clamp_s16(mixBuffer[i + 1] + sendBufferProcessed[i + 1]);
-			}
-		} else if (dry) {
-			for (int i = 0; i < grainSize * 2; i += 2) {
-				*outp++ = clamp_s16(mixBuffer[i + 0]);
-				*outp++ = clamp_s16(mixBuffer[i + 1]);
-			}
-		} else {
-			// This is another uncommon case, dry must be off but let's keep it for clarity.
-			for (int i = 0; i < grainSize * 2; i += 2) {
-				int sampleL = 0;
-				int sampleR = 0;
-				if (dry) {
-					sampleL += mixBuffer[i + 0];
-					sampleR += mixBuffer[i + 1];
-				}
-				if (wet) {
-					sampleL += sendBufferProcessed[i + 0];
-					sampleR += sendBufferProcessed[i + 1];
-				}
-				*outp++ = clamp_s16(sampleL);
-				*outp++ = clamp_s16(sampleR);
-			}
-		}
-	}
+	WriteMixedSamples(outp, inp, leftVol, rightVol, dry ? mixBuffer : nullptr, wet ? sendBufferProcessed : nullptr, grainSize * 2);
 }
 
 void SasInstance::SetWaveformEffectType(int type) {
@@ -333,6 +333,8 @@ class SasInstance {
 	SasReverb reverb_;
 	int grainSize = 0;
 	int16_t mixTemp_[PSP_SAS_MAX_GRAIN * 4 + 2 + 16];  // some extra margin for very high pitches.
+	// One voice's samples after resampling and the envelope, before volume.
+	int voiceTemp_[PSP_SAS_MAX_GRAIN];
 };
 
 const char *ADSRCurveModeAsString(SasADSRCurveMode mode);
@@ -15,10 +15,13 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
+#include "ppsspp_config.h"
 #include "Common/Math/math_util.h"
+#include "Common/Math/SIMDHeaders.h"
 #include "Core/Config.h"
 #include "Core/HW/SasReverb.h"
 #include "Core/Util/AudioFormat.h"
@@ -70,7 +73,7 @@ struct SasReverbData {
 	// int16_t vRIN;
 };
 
-static const SasReverbData presets[10] = {
+static constexpr SasReverbData presets[] = {
 	{
 		"Room",
 		0x26C0,
@@ -199,6 +202,20 @@ class BufferWrapper {
 		}
 	}
 
+	// How many samples from here all taps in [minTap, maxTap] stay clear of the wrap.
+	int DirectRun(int minTap, int maxTap) {
+		if (pos_ + minTap < base_)
+			return 0;
+		return std::max(end_ - maxTap - pos_, 0);
+	}
+	int16_t *DirectPointer() {
+		return buf_ + pos_;
+	}
+	// Only after a DirectRun, so it can't wrap.
+	void Skip(int count) {
+		pos_ += count;
+	}
+
 private:
 	int16_t *buf_;
 	int pos_;
@@ -207,6 +224,149 @@ class BufferWrapper {
 	int size_;
 };
 
+// For the stretches where nothing wraps, so the taps are just offsets.
+class DirectBuffer {
+public:
+	DirectBuffer(int16_t *buffer) : buf_(buffer) {}
+	int16_t &operator [](int index) {
+		return buf_[index];
+	}
+	void Next() {
+		buf_++;
+	}
+
+private:
+	int16_t *buf_;
+};
+
+static constexpr int MinTap(const SasReverbData &d) {
+	int m = std::min({ d.mLSAME, d.mRSAME, d.mLDIFF, d.mRDIFF, d.mLAPF1, d.mRAPF1, d.mLAPF2, d.mRAPF2 }) - 1;
+	m = std::min({ m, d.mLAPF1 - d.dAPF1, d.mRAPF1 - d.dAPF1, d.mLAPF2 - d.dAPF2, d.mRAPF2 - d.dAPF2 });
+	return std::min({ m, (int)d.dLSAME, (int)d.dRSAME, (int)d.dLDIFF, (int)d.dRDIFF, (int)d.mLCOMB1, (int)d.mRCOMB1, (int)d.mLCOMB2, (int)d.mRCOMB2, (int)d.mLCOMB3, (int)d.mRCOMB3, (int)d.mLCOMB4, (int)d.mRCOMB4 });
+}
+
+static constexpr int MaxTap(const SasReverbData &d) {
+	int m = std::max({ d.mLSAME, d.mRSAME, d.mLDIFF, d.mRDIFF, d.mLAPF1, d.mRAPF1, d.mLAPF2, d.mRAPF2 });
+	return std::max({ m, (int)d.dLSAME, (int)d.dRSAME, (int)d.dLDIFF, (int)d.dRDIFF, (int)d.mLCOMB1, (int)d.mRCOMB1, (int)d.mLCOMB2, (int)d.mRCOMB2, (int)d.mLCOMB3, (int)d.mRCOMB3, (int)d.mLCOMB4, (int)d.mRCOMB4 });
+}
+
+// One step at 22khz, straight from the description.  The preset is a template argument, so the
+// offsets are constants and the unused parts (zero volumes) drop out.
+template <int P, typename Buffer>
+static inline void ReverbStep(Buffer &b, int16_t Lin, int16_t Rin, int32_t *out) {
+	constexpr const SasReverbData &d = presets[P];
+
+	// ____Same Side Reflection(left - to - left and right - to - right)___________________
+	b[d.mLSAME] = clamp_s16(Lin + (b[d.dLSAME] * d.vWALL >> 15) - (b[d.mLSAME - 1]*d.vIIR >> 15) + b[d.mLSAME - 1]); // L - to - L
+	b[d.mRSAME] = clamp_s16(Rin + (b[d.dRSAME] * d.vWALL >> 15) - (b[d.mRSAME - 1]*d.vIIR >> 15) + b[d.mRSAME - 1]); // R - to - R
+	// ___Different Side Reflection(left - to - right and right - to - left)_______________
+	b[d.mLDIFF] = clamp_s16(Lin + (b[d.dRDIFF] * d.vWALL >> 15) - (b[d.mLDIFF - 1]*d.vIIR >> 15) + b[d.mLDIFF - 1]); // R - to - L
+	b[d.mRDIFF] = clamp_s16(Rin + (b[d.dLDIFF] * d.vWALL >> 15) - (b[d.mRDIFF - 1]*d.vIIR >> 15) + b[d.mRDIFF - 1]); // L - to - R
+	// ___Early Echo(Comb Filter, with input from buffer)__________________________
+	int32_t Lout = ((d.vCOMB1*b[d.mLCOMB1] + d.vCOMB2*b[d.mLCOMB2] + d.vCOMB3*b[d.mLCOMB3] + d.vCOMB4*b[d.mLCOMB4]) >> 15);
+	int32_t Rout = ((d.vCOMB1*b[d.mRCOMB1] + d.vCOMB2*b[d.mRCOMB2] + d.vCOMB3*b[d.mRCOMB3] + d.vCOMB4*b[d.mRCOMB4]) >> 15);
+	// ___Late Reverb APF1(All Pass Filter 1, with input from COMB)________________
+	b[d.mLAPF1] = clamp_s16(Lout - (d.vAPF1*b[(d.mLAPF1 - d.dAPF1)] >> 15));
+	Lout = b[(d.mLAPF1 - d.dAPF1)] + (b[d.mLAPF1] * d.vAPF1 >> 15);
+	b[d.mRAPF1] = clamp_s16(Rout - (d.vAPF1*b[(d.mRAPF1 - d.dAPF1)] >> 15));
+	Rout = b[(d.mRAPF1 - d.dAPF1)] + (b[d.mRAPF1] * d.vAPF1 >> 15);
+	// ___Late Reverb APF2(All Pass Filter 2, with input from APF1)________________
+	b[d.mLAPF2] = clamp_s16(Lout - (d.vAPF2*b[(d.mLAPF2 - d.dAPF2)] >> 15));
+	Lout = b[(d.mLAPF2 - d.dAPF2)] + (b[d.mLAPF2] * d.vAPF2 >> 15);
+	b[d.mRAPF2] = clamp_s16(Rout - (d.vAPF2*b[(d.mRAPF2 - d.dAPF2)] >> 15));
+	Rout = b[(d.mRAPF2 - d.dAPF2)] + (b[d.mRAPF2] * d.vAPF2 >> 15);
+
+	out[0] = Lout;
+	out[1] = Rout;
+}
+
+// Runs the reverb over a block, leaving the unscaled output in out as left/right pairs.
+template <int P>
+static int ReverbBlock(int16_t *workspace, int pos, int32_t *out, const int16_t *input, size_t inputSize) {
+	constexpr const SasReverbData &d = presets[P];
+	constexpr int minTap = MinTap(d);
+	constexpr int maxTap = MaxTap(d);
+
+	BufferWrapper<SasReverb::BUFSIZE> b(workspace, pos, d.size);
+	size_t i = 0;
+	while (i < inputSize) {
+		// Dividing by two here is an incorrect hack. Some multiplication factor is needed to prevent the reverb from getting too loud, though.
+		size_t run = std::min((size_t)b.DirectRun(minTap, maxTap), inputSize - i);
+		if (run == 0) {
+			ReverbStep<P>(b, input[i * 2] >> 1, input[i * 2 + 1] >> 1, &out[i * 2]);
+			b.Next();
+			i++;
+			continue;
+		}
+
+		// Most of the time, nothing wraps and the taps are simple loads.
+		DirectBuffer direct(b.DirectPointer());
+		for (size_t end = i + run; i < end; ++i) {
+			ReverbStep<P>(direct, input[i * 2] >> 1, input[i * 2 + 1] >> 1, &out[i * 2]);
+			direct.Next();
+		}
+		b.Skip((int)run);
+	}
+	return b.GetPosition();
+}
+
+typedef int (*ReverbBlockFunc)(int16_t *workspace, int pos, int32_t *out, const int16_t *input, size_t inputSize);
+static const ReverbBlockFunc reverbBlockFuncs[] = {
+	&ReverbBlock<0>,
+	&ReverbBlock<1>,
+	&ReverbBlock<2>,
+	&ReverbBlock<3>,
+	&ReverbBlock<4>,
+	&ReverbBlock<5>,
+	&ReverbBlock<6>,
+	&ReverbBlock<7>,
+	&ReverbBlock<8>,
+};
+static_assert(ARRAY_SIZE(reverbBlockFuncs) == ARRAY_SIZE(presets), "Each preset needs a block func");
+
+// Applies the volume and writes the pairs to 44khz, with every other frame zero.
+static void WriteReverbOutput(int16_t *output, const int32_t *in, size_t count, int volLeft, int volRight, int shift) {
+	size_t i = 0;
+#if PPSSPP_ARCH(SSE2)
+	const __m128i vol = _mm_setr_epi32(volLeft, volRight, volLeft, volRight);
+	const __m128i volOdd = _mm_srli_epi64(vol, 32);
+	const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+	auto scale = [&](__m128i v) {
+		// No 32-bit mullo in SSE2, but the low halves of unsigned products are the same.
+		__m128i even = _mm_mul_epu32(v, vol);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(v, 32), volOdd);
+		v = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+		return _mm_sra_epi32(v, shiftCount);
+	};
+	for (; i + 4 <= count; i += 4) {
+		__m128i lo = scale(_mm_loadu_si128((const __m128i *)(in + i * 2)));
+		__m128i hi = scale(_mm_loadu_si128((const __m128i *)(in + i * 2 + 4)));
+		// Each pair is 32 bits, so this puts a zero frame after each.
+		__m128i packed = _mm_packs_epi32(lo, hi);
+		_mm_storeu_si128((__m128i *)(output + i * 4), _mm_unpacklo_epi32(packed, _mm_setzero_si128()));
+		_mm_storeu_si128((__m128i *)(output + i * 4 + 8), _mm_unpackhi_epi32(packed, _mm_setzero_si128()));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	const int32x2_t volPair = vset_lane_s32(volRight, vdup_n_s32(volLeft), 1);
+	const int32x4_t vol = vcombine_s32(volPair, volPair);
+	const int32x4_t shiftCount = vdupq_n_s32(-shift);
+	for (; i + 4 <= count; i += 4) {
+		int32x4_t lo = vshlq_s32(vmulq_s32(vld1q_s32(in + i * 2), vol), shiftCount);
+		int32x4_t hi = vshlq_s32(vmulq_s32(vld1q_s32(in + i * 2 + 4), vol), shiftCount);
+		uint32x4_t packed = vreinterpretq_u32_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+		uint32x4x2_t frames = vzipq_u32(packed, vdupq_n_u32(0));
+		vst1q_u32((uint32_t *)(output + i * 4), frames.val[0]);
+		vst1q_u32((uint32_t *)(output + i * 4 + 8), frames.val[1]);
+	}
+#endif
+	for (; i < count; ++i) {
+		output[i * 4 + 0] = clamp_s16((in[i * 2 + 0] * volLeft) >> shift);
+		output[i * 4 + 1] = clamp_s16((in[i * 2 + 1] * volRight) >> shift);
+		output[i * 4 + 2] = 0;
+		output[i * 4 + 3] = 0;
+	}
+}
+
 void SasReverb::ProcessReverb(int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight) {
 	// This means replicate the input signal in the processed buffer.
 	// Can also be used to verify that the error is in here...
@@ -230,51 +390,11 @@ void SasReverb::ProcessReverb(int16_t *output, const int16_t *input, size_t inpu
 		return;
 	}
 
-	const SasReverbData &d = presets[preset_];
-
-	// We put this on the stack instead of in the object to let the compiler optimize better (avoid mem r/w).
-	BufferWrapper<BUFSIZE> b(workspace_, pos_, d.size);
-
-	// This runs at 22khz.
-	// Very unoptimized, straight from the description. Can probably be reformulated into something way more efficient.
-	// Or we could actually template the whole thing with the parameters as template arguments, as the presets are fixed.
-	for (size_t i = 0; i < inputSize; i++) {
-		// Dividing by two here is an incorrect hack. Some multiplication factor is needed to prevent the reverb from getting too loud, though.
-		int16_t LeftInput = input[i * 2] >> 1;
-		int16_t RightInput = input[i * 2 + 1] >> 1;
-
-		int16_t Lin = LeftInput; //  (d.vLIN * LeftInput) >> 15;
-		int16_t Rin = RightInput; // (d.vRIN * RightInput) >> 15;
-
-		// ____Same Side Reflection(left - to - left and right - to - right)___________________
-		b[d.mLSAME] = clamp_s16(Lin + (b[d.dLSAME] * d.vWALL >> 15) - (b[d.mLSAME - 1]*d.vIIR >> 15) + b[d.mLSAME - 1]); // L - to - L
-		b[d.mRSAME] = clamp_s16(Rin + (b[d.dRSAME] * d.vWALL >> 15) - (b[d.mRSAME - 1]*d.vIIR >> 15) + b[d.mRSAME - 1]); // R - to - R
-		// ___Different Side Reflection(left - to - right and right - to - left)_______________
-		b[d.mLDIFF] = clamp_s16(Lin + (b[d.dRDIFF] * d.vWALL >> 15) - (b[d.mLDIFF - 1]*d.vIIR >> 15) + b[d.mLDIFF - 1]); // R - to - L
-		b[d.mRDIFF] = clamp_s16(Rin + (b[d.dLDIFF] * d.vWALL >> 15) - (b[d.mRDIFF - 1]*d.vIIR >> 15) + b[d.mRDIFF - 1]); // L - to - R
-		// ___Early Echo(Comb Filter, with input from buffer)__________________________
-		int32_t Lout = ((d.vCOMB1*b[d.mLCOMB1] + d.vCOMB2*b[d.mLCOMB2] + d.vCOMB3*b[d.mLCOMB3] + d.vCOMB4*b[d.mLCOMB4]) >> 15);
-		int32_t Rout = ((d.vCOMB1*b[d.mRCOMB1] + d.vCOMB2*b[d.mRCOMB2] + d.vCOMB3*b[d.mRCOMB3] + d.vCOMB4*b[d.mRCOMB4]) >> 15);
-		// ___Late Reverb APF1(All Pass Filter 1, with input from COMB)________________
-		b[d.mLAPF1] = clamp_s16(Lout - (d.vAPF1*b[(d.mLAPF1 - d.dAPF1)] >> 15));
-		Lout = b[(d.mLAPF1 - d.dAPF1)] + (b[d.mLAPF1] * d.vAPF1 >> 15);
-		b[d.mRAPF1] = clamp_s16(Rout - (d.vAPF1*b[(d.mRAPF1 - d.dAPF1)] >> 15));
-		Rout = b[(d.mRAPF1 - d.dAPF1)] + (b[d.mRAPF1] * d.vAPF1 >> 15);
-		// ___Late Reverb APF2(All Pass Filter 2, with input from APF1)________________
-		b[d.mLAPF2] = clamp_s16(Lout - (d.vAPF2*b[(d.mLAPF2 - d.dAPF2)] >> 15));
-		Lout = b[(d.mLAPF2 - d.dAPF2)] + (b[d.mLAPF2] * d.vAPF2 >> 15);
-		b[d.mRAPF2] = clamp_s16(Rout - (d.vAPF2*b[(d.mRAPF2 - d.dAPF2)] >> 15));
-		Rout = b[(d.mRAPF2 - d.dAPF2)] + (b[d.mRAPF2] * d.vAPF2 >> 15);
-		// ___Output to Mixer(Output volume multiplied with input from APF2)___________
-		output[i * 4 + 0] = clamp_s16((Lout * volLeft) >> finalShift);
-		output[i * 4 + 1] = clamp_s16((Rout * volRight) >> finalShift);
-		output[i * 4 + 2] = 0;
-		output[i * 4 + 3] = 0;
-
-		b.Next();
+	// A grain at a time at most, the volume is applied after each block.
+	int32_t processed[512 * 2];
+	for (size_t i = 0; i < inputSize; i += 512) {
+		const size_t count = std::min(inputSize - i, (size_t)512);
+		pos_ = reverbBlockFuncs[preset_](workspace_, pos_, processed, input + i * 2, count);
+		WriteReverbOutput(output + i * 4, processed, count, volLeft, volRight, finalShift);
 	}
-
-	// Save the state in the object.
-	pos_ = b.GetPosition();
 }
-
@@ -33,11 +33,11 @@ class SasReverb {
 	// Output is written back at 44khz.
 	void ProcessReverb(int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight);
 
-private:
 	enum {
 		BUFSIZE = 0x20000,
 	};
 
+private:
 	int16_t *workspace_;
 	int preset_;
 	int pos_;
@@ -28,12 +28,25 @@
 #define TARGET_BUFSIZE_DEFAULT 1680 // 40 ms
 #define TARGET_BUFSIZE_EXTRA 3360 // 80 ms
 
+// In low latency mode, the target starts here and grows on underruns.
+#define TARGET_BUFSIZE_LOW_LATENCY 512 // 12 ms
+#define TARGET_BUFSIZE_LOW_LATENCY_MIN 256
+// How often, in frames of output, to try a smaller target if there was room to spare.
+#define LOW_LATENCY_ADAPT_FRAMES (44100 * 2)
+// Spare frames to keep above the lowest fill seen.
+#define LOW_LATENCY_SLACK 128
+
 #define MAX_FREQ_SHIFT  600.0f  // how far off can we be from 44100 Hz
 #define CONTROL_FACTOR  0.2f // in freq_shift per fifo size offset
 #define CONTROL_AVG     32.0f
+// Below this, just keep the rate and copy the samples as is.
+#define PASSTHROUGH_FREQ_SHIFT 2.0f
+// Of the lower Nyquist frequency.  With so few taps, some room is needed for the transition.
+#define FILTER_CUTOFF   0.9
 
 #include "ppsspp_config.h"
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <atomic>
 
@@ -44,6 +57,7 @@
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
+#include "Core/HLE/__sceAudio.h"
 #include "Core/HW/StereoResampler.h"
 #include "Core/Util/AudioFormat.h"  // for clamp_u8
 #include "Core/System.h"
@@ -52,7 +66,13 @@ StereoResampler::StereoResampler() noexcept
 		: m_maxBufsize(MAX_BUFSIZE_DEFAULT)
 	  , m_targetBufsize(TARGET_BUFSIZE_DEFAULT) {
 	// Need to have space for the worst case in case it changes.
-	m_buffer = new int16_t[MAX_BUFSIZE_EXTRA * 2]();
+	m_buffer = new int16_t[MAX_BUFSIZE_EXTRA * 2 + FILTER_TAPS * 2]();
+	filterBank_ = new FilterPhase[FILTER_PHASES];
+	minBufSize_ = MAX_BUFSIZE_EXTRA;
+	lowLatencyTarget_ = TARGET_BUFSIZE_LOW_LATENCY;
+	adaptMinBufSize_ = MAX_BUFSIZE_EXTRA;
+	for (auto &count : latencyHistogram_)
+		count = 0;
 
 	// Some Android devices are v-synced to non-60Hz framerates. We simply timestretch audio to fit.
 	// TODO: should only do this if auto frameskip is off?
@@ -71,12 +91,19 @@ StereoResampler::StereoResampler() noexcept
 StereoResampler::~StereoResampler() {
 	delete[] m_buffer;
 	m_buffer = nullptr;
+	delete[] filterBank_;
+	filterBank_ = nullptr;
 }
 
 void StereoResampler::UpdateBufferSize() {
+	lowLatency_.store(!g_Config.bExtraAudioBuffering && g_Config.bLowLatencyAudio, std::memory_order_relaxed);
 	if (g_Config.bExtraAudioBuffering) {
 		m_maxBufsize = MAX_BUFSIZE_EXTRA;
 		m_targetBufsize = TARGET_BUFSIZE_EXTRA;
+	} else if (g_Config.bLowLatencyAudio) {
+		// The audio thread picks the target, since it's the one that sees how close it gets to running out.
+		m_maxBufsize = MAX_BUFSIZE_DEFAULT;
+		m_targetBufsize = lowLatencyTarget_.load(std::memory_order_relaxed);
 	} else {
 		m_maxBufsize = MAX_BUFSIZE_DEFAULT;
 		m_targetBufsize = TARGET_BUFSIZE_DEFAULT;
@@ -149,17 +176,87 @@ inline void ClampBufferToS16WithVolume(s16 *out, const s32 *in, size_t size) {
 }
 
 void StereoResampler::Clear() {
-	memset(m_buffer, 0, m_maxBufsize * 2 * sizeof(int16_t));
+	// The audio thread might be reading, so let it do it.  Until then, pushes will likely overrun.
+	clearRequested_.store(true, std::memory_order_release);
 }
 
-inline int16_t MixSingleSample(int16_t s1, int16_t s2, uint16_t frac) {
-	int32_t value = s1 + (((s2 - s1) * frac) >> 16);
-	if (value < -32767)
-		return -32767;
-	else if (value > 32767)
-		return 32767;
-	else
-		return (int16_t)value;
+void StereoResampler::UpdateFilterBank(int sampleRate) {
+	if (sampleRate == filterSampleRate_)
+		return;
+	filterSampleRate_ = sampleRate;
+
+	// When going down in rate, the cutoff has to go down too, or it'll alias.
+	const double cutoff = FILTER_CUTOFF * std::min(1.0, (double)sampleRate / (double)m_input_sample_rate);
+	const double pi = 3.14159265358979323846;
+	for (int p = 0; p < FILTER_PHASES; ++p) {
+		const double t = (double)p / FILTER_PHASES;
+		double coefs[FILTER_TAPS];
+		double sum = 0.0;
+		for (int k = 0; k < FILTER_TAPS; ++k) {
+			// Distance from the output position, which is t after tap FILTER_TAPS / 2 - 1.
+			const double x = (double)(k - (FILTER_TAPS / 2 - 1)) - t;
+			const double sinc = x == 0.0 ? 1.0 : sin(pi * cutoff * x) / (pi * cutoff * x);
+			// Blackman, reaching zero at FILTER_TAPS / 2 away.
+			const double w = 0.42 + 0.5 * cos(pi * x / (FILTER_TAPS / 2)) + 0.08 * cos(2.0 * pi * x / (FILTER_TAPS / 2));
+			coefs[k] = sinc * w;
+			sum += coefs[k];
+		}
+
+		// Normalize to 1.0 in 2.14, and give any rounding error to the nearest tap so DC is exact.
+		FilterPhase &phase = filterBank_[p];
+		int total = 0;
+		for (int k = 0; k < FILTER_TAPS; ++k) {
+			phase.taps[k] = (int16_t)lrint(coefs[k] / sum * 16384.0);
+			total += phase.taps[k];
+		}
+		phase.taps[t < 0.5 ? FILTER_TAPS / 2 - 1 : FILTER_TAPS / 2] += 16384 - total;
+
+		for (int k = 0; k < FILTER_TAPS; k += 2) {
+			phase.pairs[k * 2 + 0] = phase.taps[k];
+			phase.pairs[k * 2 + 1] = phase.taps[k + 1];
+			phase.pairs[k * 2 + 2] = phase.taps[k];
+			phase.pairs[k * 2 + 3] = phase.taps[k + 1];
+		}
+	}
+}
+
+// Filters FILTER_TAPS interleaved stereo frames from in, into one frame at out.
+template <int taps>
+inline void FilterFrame(const int16_t *in, const int16_t *coefs, const int16_t *pairs, short *out) {
+#if PPSSPP_ARCH(SSE2)
+	static_assert(taps == 8, "Written for 8 taps");
+	// Each madd handles two frames, with both lefts and both rights next to each other.
+	__m128i a = _mm_loadu_si128((const __m128i *)in);
+	__m128i b = _mm_loadu_si128((const __m128i *)(in + 8));
+	a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+	b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+	__m128i acc = _mm_add_epi32(_mm_madd_epi16(a, _mm_loadu_si128((const __m128i *)pairs)), _mm_madd_epi16(b, _mm_loadu_si128((const __m128i *)(pairs + 8))));
+	// Now left, right, left, right - add the halves together.
+	acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+	acc = _mm_srai_epi32(_mm_add_epi32(acc, _mm_set1_epi32(1 << 13)), 14);
+	const int32_t frame = _mm_cvtsi128_si32(_mm_packs_epi32(acc, acc));
+	memcpy(out, &frame, sizeof(frame));
+#elif PPSSPP_ARCH(ARM_NEON)
+	static_assert(taps == 8, "Written for 8 taps");
+	const int16x8x2_t lr = vld2q_s16(in);
+	const int16x8_t c = vld1q_s16(coefs);
+	int32x4_t l = vmull_s16(vget_low_s16(lr.val[0]), vget_low_s16(c));
+	int32x4_t r = vmull_s16(vget_low_s16(lr.val[1]), vget_low_s16(c));
+	l = vmlal_s16(l, vget_high_s16(lr.val[0]), vget_high_s16(c));
+	r = vmlal_s16(r, vget_high_s16(lr.val[1]), vget_high_s16(c));
+	const int32x2_t sum = vpadd_s32(vpadd_s32(vget_low_s32(l), vget_high_s32(l)), vpadd_s32(vget_low_s32(r), vget_high_s32(r)));
+	const int16x4_t frame = vqrshrn_n_s32(vcombine_s32(sum, sum), 14);
+	vst1_lane_s32((int32_t *)out, vreinterpret_s32_s16(frame), 0);
+#else
+	int l = 0;
+	int r = 0;
+	for (int k = 0; k < taps; ++k) {
+		l += in[k * 2] * coefs[k];
+		r += in[k * 2 + 1] * coefs[k];
+	}
+	out[0] = clamp_s16((l + (1 << 13)) >> 14);
+	out[1] = clamp_s16((r + (1 << 13)) >> 14);
+#endif
 }
 
 // Executed from sound stream thread, pulling sound out of the buffer.
@@ -176,13 +273,24 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	// so we will just ignore new written data while interpolating (until it wraps...).
 	// Without this cache, the compiler wouldn't be allowed to optimize the
 	// interpolation loop.
-	u32 indexR = m_indexR.load();
-	u32 indexW = m_indexW.load();
+	u32 indexR = m_indexR.load(std::memory_order_relaxed);
+	u32 indexW = m_indexW.load(std::memory_order_acquire);
 
-	const int INDEX_MASK = (m_maxBufsize * 2 - 1);
+	const int maxBufsize = m_maxBufsize.load(std::memory_order_relaxed);
+	const int INDEX_MASK = (maxBufsize * 2 - 1);
+
+	if (clearRequested_.exchange(false, std::memory_order_acquire)) {
+		indexR = indexW;
+		m_frac = 0;
+		// Nothing left to measure the latency of.
+		marksR_.store(marksW_.load(std::memory_order_acquire), std::memory_order_release);
+	}
 
 	// This is only for debug visualization, not used for anything.
-	lastBufSize_ = ((indexW - indexR) & INDEX_MASK) / 2;
+	const int bufSize = ((indexW - indexR) & INDEX_MASK) / 2;
+	lastBufSize_.store(bufSize, std::memory_order_relaxed);
+	if (bufSize < minBufSize_.load(std::memory_order_relaxed))
+		minBufSize_.store(bufSize, std::memory_order_relaxed);
 
 	// Drift prevention mechanism.
 	float numLeft = (float)(((indexW - indexR) & INDEX_MASK) / 2);
@@ -203,36 +311,55 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	float offset = (m_numLeftI - (float)m_targetBufsize) * CONTROL_FACTOR;
 	if (offset > MAX_FREQ_SHIFT) offset = MAX_FREQ_SHIFT;
 	if (offset < -MAX_FREQ_SHIFT) offset = -MAX_FREQ_SHIFT;
+	// Close enough to the target, no need to resample if the rates match.
+	if (offset > -PASSTHROUGH_FREQ_SHIFT && offset < PASSTHROUGH_FREQ_SHIFT) offset = 0.0f;
 
 	output_sample_rate_ = (float)(m_input_sample_rate + offset);
 	const u32 ratio = (u32)(65536.0 * output_sample_rate_ / (double)sample_rate);
 	ratio_ = ratio;
-	// TODO: consider a higher-quality resampling algorithm.
-	// TODO: Add a fast path for 1:1.
+
+	currentSample = 0;
 	u32 frac = m_frac;
-	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
-		if (((indexW - indexR) & INDEX_MASK) <= 2) {
-			// Ran out!
-			// int missing = numSamples * 2 - currentSample;
-			// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
+	if (ratio == 0x10000) {
+		// Same rate, so just copy, wrapping if needed.  Drops any leftover fraction, less than a sample.
+		u32 available = std::min(((indexW - indexR) & INDEX_MASK) & ~1U, numSamples * 2);
+		if (available < numSamples * 2)
 			underrunCount_++;
-			break;
+		while (currentSample < available) {
+			u32 count = std::min(available - currentSample, (u32)(maxBufsize * 2) - (indexR & INDEX_MASK));
+			memcpy(&samples[currentSample], &m_buffer[indexR & INDEX_MASK], count * sizeof(int16_t));
+			currentSample += count;
+			indexR += count;
+		}
+		frac = 0;
+	} else {
+		UpdateFilterBank(sample_rate);
+		for (; currentSample < numSamples * 2; currentSample += 2) {
+			if (((indexW - indexR) & INDEX_MASK) <= FILTER_TAPS) {
+				// Ran out!
+				underrunCount_++;
+				break;
+			}
+			// The copy of the start after the buffer makes this safe to read past the end.
+			const int16_t *in = &m_buffer[(indexR - (FILTER_TAPS / 2 - 1) * 2) & INDEX_MASK];
+			const FilterPhase &phase = filterBank_[(frac & 0xffff) >> (16 - FILTER_PHASE_BITS)];
+			FilterFrame<FILTER_TAPS>(in, phase.taps, phase.pairs, &samples[currentSample]);
+			frac += ratio;
+			indexR += 2 * (frac >> 16);
+			frac &= 0xffff;
 		}
-		u32 indexR2 = indexR + 2; //next sample
-		s16 l1 = m_buffer[indexR & INDEX_MASK]; //current
-		s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK]; //current
-		s16 l2 = m_buffer[indexR2 & INDEX_MASK]; //next
-		s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK]; //next
-		samples[currentSample] = MixSingleSample(l1, l2, (u16)frac);
-		samples[currentSample + 1] = MixSingleSample(r1, r2, (u16)frac);
-		frac += ratio;
-		indexR += 2 * (frac >> 16);
-		frac &= 0xffff;
 	}
 	m_frac = frac;
 
 	// Let's not count the underrun padding here.
 	outputSampleCount_ += currentSample / 2;
+	const bool underrun = currentSample < numSamples * 2;
+	if (underrun)
+		underrunFrames_ += numSamples - currentSample / 2;
+	// When nothing was there at all, emulation is probably paused or loading, so don't count it.
+	if (lowLatency_.load(std::memory_order_relaxed))
+		AdaptLowLatencyTarget(bufSize, numSamples, sample_rate, underrun && bufSize != 0);
+	UpdateLatency(indexR, numSamples, sample_rate);
 
 	// Padding with the last value to reduce clicking
 	short s[2];
@@ -243,8 +370,8 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 		samples[currentSample + 1] = s[1];
 	}
 
-	// Flush cached variable
-	m_indexR.store(indexR);
+	// Flush cached variable, letting the emulator thread reuse what we read.
+	m_indexR.store(indexR, std::memory_order_release);
 
 	// TODO: What should we actually return here?
 	return currentSample / 2;
@@ -255,13 +382,14 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 	inputSampleCount_ += numSamples;
 
 	UpdateBufferSize();
-	const int INDEX_MASK = (m_maxBufsize * 2 - 1);
+	const int maxBufsize = m_maxBufsize.load(std::memory_order_relaxed);
+	const int INDEX_MASK = (maxBufsize * 2 - 1);
 	// Cache access in non-volatile variable
 	// indexR isn't allowed to cache in the audio throttling loop as it
 	// needs to get updates to not deadlock.
-	u32 indexW = m_indexW.load();
+	u32 indexW = m_indexW.load(std::memory_order_relaxed);
 
-	u32 cap = m_maxBufsize * 2;
+	u32 cap = maxBufsize * 2;
 	// If fast-forwarding, no need to fill up the entire buffer, just screws up timing after releasing the fast-forward button.
 	if (PSP_CoreParameter().fastForward) {
 		cap = m_targetBufsize * 2;
@@ -269,58 +397,176 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 
 	// Check if we have enough free space
 	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (numSamples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >= cap) {
+	if (numSamples * 2 + ((indexW - m_indexR.load(std::memory_order_acquire)) & INDEX_MASK) >= cap) {
 		if (!PSP_CoreParameter().fastForward) {
 			overrunCount_++;
+			overrunFrames_ += numSamples;
 		}
 		// TODO: "Timestretch" by doing a windowed overlap with existing buffer content?
 		return;
 	}
 
 	// Check if we need to roll over to the start of the buffer during the copy.
-	unsigned int indexW_left_samples = m_maxBufsize * 2 - (indexW & INDEX_MASK);
+	unsigned int indexW_left_samples = maxBufsize * 2 - (indexW & INDEX_MASK);
 	if (numSamples * 2 > indexW_left_samples) {
 		ClampBufferToS16WithVolume(&m_buffer[indexW & INDEX_MASK], samples, indexW_left_samples);
 		ClampBufferToS16WithVolume(&m_buffer[0], samples + indexW_left_samples, numSamples * 2 - indexW_left_samples);
 	} else {
 		ClampBufferToS16WithVolume(&m_buffer[indexW & INDEX_MASK], samples, numSamples * 2);
 	}
+	// Keep the copy after the end current, the filter reads it instead of wrapping.
+	memcpy(&m_buffer[maxBufsize * 2], &m_buffer[0], FILTER_TAPS * 2 * sizeof(int16_t));
 
-	m_indexW += numSamples * 2;
+	// Publishes the samples written above.
+	m_indexW.store(indexW + numSamples * 2, std::memory_order_release);
 	lastPushSize_ = numSamples;
+
+	// Remember when these were pushed, so the audio thread can tell how long they waited.
+	// If it's not keeping up, skip some.  The remaining marks are enough to measure by.
+	u32 marksW = marksW_.load(std::memory_order_relaxed);
+	if (marksW - marksR_.load(std::memory_order_acquire) < LATENCY_MARKS) {
+		PushMark &mark = marks_[marksW & (LATENCY_MARKS - 1)];
+		mark.index = indexW + numSamples * 2;
+		mark.time = time_now_d();
+		marksW_.store(marksW + 1, std::memory_order_release);
+	}
+}
+
+// Executed from sound stream thread, after the read index has moved.
+void StereoResampler::UpdateLatency(u32 indexR, unsigned int numSamples, int sampleRate) {
+	u32 marksR = marksR_.load(std::memory_order_relaxed);
+	const u32 marksW = marksW_.load(std::memory_order_acquire);
+	double pushTime = -1.0;
+	// Find the latest push that's now been fully read.
+	while (marksR != marksW && (s32)(indexR - marks_[marksR & (LATENCY_MARKS - 1)].index) >= 0) {
+		pushTime = marks_[marksR & (LATENCY_MARKS - 1)].time;
+		marksR++;
+	}
+	marksR_.store(marksR, std::memory_order_release);
+	if (pushTime < 0.0 || sampleRate <= 0)
+		return;
+
+	// What we just mixed still has to play through the host buffer, assume that's about as big.
+	const double hostLatency = (double)numSamples / (double)sampleRate;
+	const double latencyMs = (time_now_d() - pushTime + hostLatency) * 1000.0;
+	lastLatencyUs_.store((int)(latencyMs * 1000.0), std::memory_order_relaxed);
+	hostFrames_.store((int)numSamples, std::memory_order_relaxed);
+	const int bucket = std::min((int)(latencyMs / LATENCY_BUCKET_MS), LATENCY_BUCKETS - 1);
+	latencyHistogram_[std::max(bucket, 0)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Executed from sound stream thread.
+void StereoResampler::AdaptLowLatencyTarget(int bufSize, unsigned int numSamples, int sampleRate, bool underrun) {
+	int target = lowLatencyTarget_.load(std::memory_order_relaxed);
+	// The whole request has to be there when it comes, plus some for each push to arrive in.
+	const int lowest = std::max(TARGET_BUFSIZE_LOW_LATENCY_MIN, (int)numSamples + LOW_LATENCY_SLACK);
+	// Keep well clear of overruns.
+	const int highest = m_maxBufsize.load(std::memory_order_relaxed) / 2;
+
+	adaptMinBufSize_ = std::min(adaptMinBufSize_, bufSize);
+	adaptFrames_ += numSamples;
+	if (underrun) {
+		// Back off quickly, and start watching again from here.
+		target += std::max(target / 4, LOW_LATENCY_SLACK);
+	} else if (adaptFrames_ >= LOW_LATENCY_ADAPT_FRAMES * sampleRate / 44100) {
+		// Never got below this, so half of it was just sitting there.
+		if (adaptMinBufSize_ > LOW_LATENCY_SLACK * 2)
+			target -= (adaptMinBufSize_ - LOW_LATENCY_SLACK) / 2;
+	} else {
+		return;
+	}
+
+	lowLatencyTarget_.store(std::min(std::max(target, lowest), highest), std::memory_order_relaxed);
+	adaptFrames_ = 0;
+	adaptMinBufSize_ = MAX_BUFSIZE_EXTRA;
+}
+
+float StereoResampler::LatencyPercentile(const u32 *histogram, u32 total, float fraction) {
+	if (total == 0)
+		return 0.0f;
+	const u32 wanted = (u32)ceilf(total * fraction);
+	u32 seen = 0;
+	for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+		seen += histogram[i];
+		if (seen >= wanted)
+			return (float)((i + 1) * LATENCY_BUCKET_MS);
+	}
+	return (float)(LATENCY_BUCKETS * LATENCY_BUCKET_MS);
+}
+
+void StereoResampler::GetAudioDebugStats(AudioDebugStats *stats) {
+	stats->buffered = lastBufSize_.load(std::memory_order_relaxed);
+	stats->watermark = m_targetBufsize;
+	stats->bufsize = m_maxBufsize.load(std::memory_order_relaxed);
+	stats->underrunCount = underrunCountTotal_ + underrunCount_.load(std::memory_order_relaxed);
+	stats->overrunCount = overrunCountTotal_ + overrunCount_.load(std::memory_order_relaxed);
+	stats->underrunFrames = underrunFrames_.load(std::memory_order_relaxed);
+	stats->overrunFrames = overrunFrames_.load(std::memory_order_relaxed);
+	stats->minBuffered = minBufSize_.load(std::memory_order_relaxed);
+	stats->instantSampleRate = (int)output_sample_rate_;
+	stats->targetSampleRate = m_input_sample_rate;
+	stats->lastPushSize = lastPushSize_;
+	stats->queuedFrames = __AudioGetQueuedFrames();
+	stats->hostFrames = hostFrames_.load(std::memory_order_relaxed);
+	stats->lowLatency = lowLatency_.load(std::memory_order_relaxed);
+
+	u32 histogram[LATENCY_BUCKETS];
+	u32 total = 0;
+	for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+		histogram[i] = latencyHistogram_[i].load(std::memory_order_relaxed);
+		total += histogram[i];
+	}
+	stats->latencyCount = total;
+	stats->latencyMs = lastLatencyUs_.load(std::memory_order_relaxed) / 1000.0f;
+	stats->latencyP50Ms = LatencyPercentile(histogram, total, 0.50f);
+	stats->latencyP95Ms = LatencyPercentile(histogram, total, 0.95f);
+	stats->latencyP99Ms = LatencyPercentile(histogram, total, 0.99f);
 }
 
 void StereoResampler::GetAudioDebugStats(char *buf, size_t bufSize) {
 	double elapsed = time_now_d() - startTime_;
 
+	AudioDebugStats stats;
+	GetAudioDebugStats(&stats);
+
 	double effective_input_sample_rate = (double)inputSampleCount_ / elapsed;
 	double effective_output_sample_rate = (double)outputSampleCount_ / elapsed;
 	snprintf(buf, bufSize,
-		"Audio buffer: %d/%d (target: %d)\n"
+		"Audio buffer: %d/%d (target: %d, lowest: %d)\n"
 		"Filtered: %0.2f\n"
-		"Underruns: %d\n"
-		"Overruns: %d\n"
+		"Underruns: %d (%d frames)\n"
+		"Overruns: %d (%d frames)\n"
 		"Sample rate: %d (input: %d)\n"
 		"Effective input sample rate: %0.2f\n"
 		"Effective output sample rate: %0.2f\n"
 		"Push size: %d\n"
-		"Ratio: %0.6f\n",
-		lastBufSize_,
-		m_maxBufsize,
-		m_targetBufsize,
+		"Ratio: %0.6f\n"
+		"Latency: %0.1f ms (p50: %0.0f, p95: %0.0f, p99: %0.0f)\n"
+		"Host buffer: %d, sceAudio queue: %d%s\n",
+		stats.buffered,
+		stats.bufsize,
+		stats.watermark,
+		stats.minBuffered,
 		m_numLeftI,
-		underrunCountTotal_,
-		overrunCountTotal_,
-		(int)output_sample_rate_,
-		m_input_sample_rate,
+		stats.underrunCount,
+		stats.underrunFrames,
+		stats.overrunCount,
+		stats.overrunFrames,
+		stats.instantSampleRate,
+		stats.targetSampleRate,
 		effective_input_sample_rate,
 		effective_output_sample_rate,
-		lastPushSize_,
-		(float)ratio_ / 65536.0f);
-	underrunCountTotal_ += underrunCount_;
-	overrunCountTotal_ += overrunCount_;
-	underrunCount_ = 0;
-	overrunCount_ = 0;
+		stats.lastPushSize,
+		(float)ratio_ / 65536.0f,
+		stats.latencyMs,
+		stats.latencyP50Ms,
+		stats.latencyP95Ms,
+		stats.latencyP99Ms,
+		stats.hostFrames,
+		stats.queuedFrames,
+		stats.lowLatency ? " (low latency)" : "");
+	underrunCountTotal_ += underrunCount_.exchange(0);
+	overrunCountTotal_ += overrunCount_.exchange(0);
 
 	// Use this to remove the bias from the startup.
 	// if (elapsed > 3.0) {
@@ -331,9 +577,14 @@ void StereoResampler::GetAudioDebugStats(char *buf, size_t bufSize) {
 void StereoResampler::ResetStatCounters() {
 	underrunCount_ = 0;
 	overrunCount_ = 0;
+	underrunFrames_ = 0;
+	overrunFrames_ = 0;
+	minBufSize_ = m_maxBufsize.load();
 	underrunCountTotal_ = 0;
 	overrunCountTotal_ = 0;
 	inputSampleCount_ = 0;
 	outputSampleCount_ = 0;
+	for (auto &count : latencyHistogram_)
+		count = 0;
 	startTime_ = time_now_d();
 }
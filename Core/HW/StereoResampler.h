@@ -41,28 +41,57 @@ class StereoResampler {
 	void Clear();
 
 	void GetAudioDebugStats(char *buf, size_t bufSize);
+	// Counters are since the last reset.  Safe to call from any thread.
+	void GetAudioDebugStats(AudioDebugStats *stats);
 	void ResetStatCounters();
 
 private:
 	void UpdateBufferSize();
-
-	int m_maxBufsize;
+	void UpdateFilterBank(int sampleRate);
+	void UpdateLatency(u32 indexR, unsigned int numSamples, int sampleRate);
+	void AdaptLowLatencyTarget(int bufSize, unsigned int numSamples, int sampleRate, bool underrun);
+
+	// Windowed sinc, picked by the top bits of the fraction.  Needs FILTER_TAPS / 2 frames ahead.
+	enum {
+		FILTER_TAPS = 8,
+		FILTER_PHASE_BITS = 8,
+		FILTER_PHASES = 1 << FILTER_PHASE_BITS,
+	};
+	// Each phase has the taps first, and on SSE2 also arranged to match pairs of frames.
+	struct FilterPhase {
+		int16_t taps[FILTER_TAPS];
+		int16_t pairs[FILTER_TAPS * 2];
+	};
+
+	// Only changed by the emulator thread, the buffer is allocated for the largest.
+	std::atomic<int> m_maxBufsize;
 	int m_targetBufsize;
 
 	unsigned int m_input_sample_rate = 44100;
+	// Followed by a copy of the first frames, so filtering never has to wrap.
 	int16_t *m_buffer;
-	std::atomic<u32> m_indexW;
-	std::atomic<u32> m_indexR;
+	FilterPhase *filterBank_;
+	int filterSampleRate_ = 0;
+	// A single producer, single consumer ring: only PushSamples() writes m_indexW, only Mix()
+	// writes m_indexR.  Kept on separate cache lines so the two threads don't fight over them.
+	alignas(64) std::atomic<u32> m_indexW{};
+	alignas(64) std::atomic<u32> m_indexR{};
+	// Clear() asks the audio thread to drop what's buffered, instead of touching it.
+	std::atomic<bool> clearRequested_{};
 	float m_numLeftI = 0.0f;
 
 	u32 m_frac = 0;
 	float output_sample_rate_ = 0.0;
-	int lastBufSize_ = 0;
+	std::atomic<int> lastBufSize_{};
+	std::atomic<int> minBufSize_{};
 	int lastPushSize_ = 0;
 	u32 ratio_ = 0;
 
-	int underrunCount_ = 0;
-	int overrunCount_ = 0;
+	// Written by either side, read and reset by the stats.
+	std::atomic<int> underrunCount_{};
+	std::atomic<int> overrunCount_{};
+	std::atomic<int> underrunFrames_{};
+	std::atomic<int> overrunFrames_{};
 	int underrunCountTotal_ = 0;
 	int overrunCountTotal_ = 0;
 
@@ -72,4 +101,31 @@ class StereoResampler {
 	int64_t outputSampleCount_ = 0;
 
 	double startTime_ = 0.0;
+
+	enum {
+		// Must be a power of 2, enough to cover a full buffer of pushes.
+		LATENCY_MARKS = 256,
+		LATENCY_BUCKETS = 250,
+		LATENCY_BUCKET_MS = 1,
+	};
+	static float LatencyPercentile(const u32 *histogram, u32 total, float fraction);
+
+	// When each push was made, in the same single producer, single consumer way as the samples.
+	struct PushMark {
+		u32 index;
+		double time;
+	};
+	PushMark marks_[LATENCY_MARKS];
+	std::atomic<u32> marksW_{};
+	std::atomic<u32> marksR_{};
+	// From push until played, written by the audio thread.
+	std::atomic<u32> latencyHistogram_[LATENCY_BUCKETS];
+	std::atomic<int> lastLatencyUs_{};
+	std::atomic<int> hostFrames_{};
+
+	// Low latency mode, where the audio thread adjusts the target.
+	std::atomic<bool> lowLatency_{};
+	std::atomic<int> lowLatencyTarget_{};
+	int adaptFrames_ = 0;
+	int adaptMinBufSize_;
 };
@@ -83,6 +83,11 @@ class FileLoader {
 		return ReadAt(absolutePos, 1, bytes, data, flags);
 	}
 
+	// The whole file, if it's mapped into memory.  Stays valid as long as the loader.
+	virtual const u8 *MappedData() {
+		return nullptr;
+	}
+
 	// Cancel any operations that might block, if possible.
 	virtual void Cancel() {}
 
@@ -0,0 +1,244 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#include "Common/Log.h"
+#include "Core/CoreTiming.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/ARM/ArmIRJit.h"
+#include "Core/MIPS/ARM/ArmIRRegCache.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/JitCommon/JitState.h"
+#include "Core/Core.h"
+
+namespace MIPSComp {
+
+using namespace ArmGen;
+using namespace ArmIRJitConstants;
+
+static const bool enableDebug = false;
+static const bool enableDisasm = false;
+
+static void ShowPC(void *membase, void *jitbase) {
+	static int count = 0;
+	if (currentMIPS) {
+		u32 downcount = currentMIPS->downcount;
+		ERROR_LOG(Log::JIT, "[%08x] ShowPC  Downcount : %08x %d %p %p", currentMIPS->pc, downcount, count, membase, jitbase);
+	} else {
+		ERROR_LOG(Log::JIT, "Universe corrupt?");
+	}
+	//if (count > 2000)
+	//	exit(0);
+	count++;
+}
+
+void ArmJitBackend::GenerateFixedCode(MIPSState *mipsState) {
+	// This will be used as a writable scratch area, always 32-bit accessible.
+	const u8 *start = AlignCodePage();
+	if (DebugProfilerEnabled()) {
+		ProtectMemoryPages(start, GetMemoryProtectPageSize(), MEM_PROT_READ | MEM_PROT_WRITE);
+		hooks_.profilerPC = (uint32_t *)GetWritableCodePtr();
+		Write32(0);
+		hooks_.profilerStatus = (IRProfilerStatus *)GetWritableCodePtr();
+		Write32(0);
+	}
+
+	const u8 *disasmStart = AlignCodePage();
+	BeginWrite(GetMemoryProtectPageSize());
+
+	// SCRATCH2 is LR, so these need to save it to return.
+	restoreRoundingMode_ = AlignCode16();
+	{
+		PUSH(1, R_LR);
+		VMRS(SCRATCH2);
+		// We are not in flush-to-zero mode outside the JIT, so let's turn it off.
+		// Assume we're always in round-to-nearest mode beforehand.
+		BIC(SCRATCH2, SCRATCH2, AssumeMakeOperand2((3 | 4) << 22));
+		VMSR(SCRATCH2);
+		POP(1, R_PC);
+	}
+
+	// Must preserve SCRATCH1.
+	applyRoundingMode_ = AlignCode16();
+	{
+		PUSH(2, SCRATCH1, R_LR);
+		LDR(SCRATCH2, CTXREG, offsetof(MIPSState, fcr31));
+
+		TST(SCRATCH2, AssumeMakeOperand2(1 << 24));
+		AND(SCRATCH2, SCRATCH2, Operand2(3));
+		SetCC(CC_NEQ);
+		ADD(SCRATCH2, SCRATCH2, Operand2(4));
+		SetCC(CC_AL);
+
+		// We can skip if the rounding mode is nearest (0) and flush is not set.
+		// (as restoreRoundingMode cleared it out anyway)
+		CMP(SCRATCH2, Operand2(0));
+		FixupBranch skip = B_CC(CC_EQ);
+
+		// MIPS Rounding Mode:       ARM Rounding Mode
+		//   0: Round nearest        0
+		//   1: Round to zero        3
+		//   2: Round up (ceil)      1
+		//   3: Round down (floor)   2
+		AND(SCRATCH1, SCRATCH2, Operand2(3));
+		CMP(SCRATCH1, Operand2(1));
+
+		SetCC(CC_EQ); ADD(SCRATCH2, SCRATCH2, Operand2(2));
+		SetCC(CC_GT); SUB(SCRATCH2, SCRATCH2, Operand2(1));
+		SetCC(CC_AL);
+
+		// Actually change the system FPSCR register.
+		VMRS(SCRATCH1);
+		// Clear both flush-to-zero and rounding before re-setting them.
+		BIC(SCRATCH1, SCRATCH1, AssumeMakeOperand2((3 | 4) << 22));
+		ORR(SCRATCH1, SCRATCH1, Operand2(SCRATCH2, ST_LSL, 22));
+		VMSR(SCRATCH1);
+
+		SetJumpTarget(skip);
+		POP(2, SCRATCH1, R_PC);
+	}
+
+	hooks_.enterDispatcher = (IRNativeFuncNoArg)AlignCode16();
+
+	PUSH(9, R4, R5, R6, R7, R8, R9, R10, R11, R_LR);
+	// Take care to 8-byte align stack for function calls.
+	// We are misaligned here because of an odd number of args for PUSH.
+	SUB(R_SP, R_SP, 4);
+	// Now we are correctly aligned and plan to stay that way.
+	VPUSH(D8, 8);
+
+	// Fixed registers, these are always kept when in Jit context.
+	MOVP2R(MEMBASEREG, Memory::base);
+	MOVP2R(CTXREG, mipsState);
+
+	LoadStaticRegisters();
+	WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+	MovFromPC(SCRATCH1);
+	WriteDebugPC(SCRATCH1);
+	outerLoopPCInSCRATCH1_ = GetCodePtr();
+	MovToPC(SCRATCH1);
+	outerLoop_ = GetCodePtr();
+		SaveStaticRegisters();  // Advance can change the downcount, so must save/restore
+		RestoreRoundingMode(true);
+		WriteDebugProfilerStatus(IRProfilerStatus::TIMER_ADVANCE);
+		QuickCallFunction(SCRATCH1, &CoreTiming::Advance);
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		ApplyRoundingMode(true);
+		LoadStaticRegisters();
+
+		dispatcherCheckCoreState_ = GetCodePtr();
+
+		MOVP2R(SCRATCH1, &coreState);
+		LDR(SCRATCH1, SCRATCH1, 0);
+		CMP(SCRATCH1, 0);
+		FixupBranch badCoreState = B_CC(CC_NEQ);
+
+		// Check downcount.
+		CMP(DOWNCOUNTREG, 0);
+		B_CC(CC_MI, outerLoop_);
+		FixupBranch skipToRealDispatch = B();
+
+		dispatcherPCInSCRATCH1_ = GetCodePtr();
+		MovToPC(SCRATCH1);
+
+		hooks_.dispatcher = GetCodePtr();
+
+			CMP(DOWNCOUNTREG, 0);
+			FixupBranch bail = B_CC(CC_MI);
+			SetJumpTarget(skipToRealDispatch);
+
+			dispatcherNoCheck_ = GetCodePtr();
+
+			// Debug
+			if (enableDebug) {
+				MOV(R0, MEMBASEREG);
+				MOVP2R(R1, GetBasePtr());
+				QuickCallFunction(SCRATCH1, &ShowPC);
+			}
+
+			MovFromPC(SCRATCH1);
+			WriteDebugPC(SCRATCH1);
+			// Memory is always masked on 32-bit.
+			BIC(SCRATCH1, SCRATCH1, Operand2(0xC0, 4));   // &= 0x3FFFFFFF
+			hooks_.dispatchFetch = GetCodePtr();
+			LDR(SCRATCH1, MEMBASEREG, SCRATCH1);
+			AND(SCRATCH2, SCRATCH1, Operand2(0xFF, 4));   // rotation is to the right, in 2-bit increments.
+			CMP(SCRATCH2, Operand2(MIPS_EMUHACK_OPCODE >> 24, 4));
+			FixupBranch skipJump = B_CC(CC_NEQ);
+				// The low 24 bits are the offset from the code base.  We reload it since R9 is allocatable.
+				BIC(SCRATCH1, SCRATCH1, Operand2(0xFF, 4));
+				MOVP2R(SCRATCH2, GetBasePtr());
+				ADD(SCRATCH1, SCRATCH1, SCRATCH2);
+				B(SCRATCH1);
+			SetJumpTarget(skipJump);
+
+			// No block found, let's jit.  We don't need to save static regs, they're all callee saved.
+			RestoreRoundingMode(true);
+			WriteDebugProfilerStatus(IRProfilerStatus::COMPILING);
+			QuickCallFunction(SCRATCH1, &MIPSComp::JitAt);
+			WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+			ApplyRoundingMode(true);
+
+			// Let's just dispatch again, we'll enter the block since we know it's there.
+			B(dispatcherNoCheck_);
+
+		SetJumpTarget(bail);
+
+		MOVP2R(SCRATCH1, &coreState);
+		LDR(SCRATCH1, SCRATCH1, 0);
+		CMP(SCRATCH1, 0);
+		B_CC(CC_EQ, outerLoop_);
+
+	const uint8_t *quitLoop = GetCodePtr();
+	SetJumpTarget(badCoreState);
+
+	WriteDebugProfilerStatus(IRProfilerStatus::NOT_RUNNING);
+	SaveStaticRegisters();
+	RestoreRoundingMode(true);
+
+	VPOP(D8, 8);
+	ADD(R_SP, R_SP, 4);
+	POP(9, R4, R5, R6, R7, R8, R9, R10, R11, R_PC);  // Returns
+
+	hooks_.crashHandler = GetCodePtr();
+	MOVP2R(SCRATCH1, &coreState);
+	MOVI2R(SCRATCH2, CORE_RUNTIME_ERROR);
+	STR(SCRATCH2, SCRATCH1, 0);
+	B(quitLoop);
+
+	// Leave this at the end, add more stuff above.
+	if (enableDisasm) {
+		std::vector<std::string> lines = DisassembleArm2(disasmStart, (int)(GetCodePtr() - disasmStart));
+		for (auto s : lines) {
+			INFO_LOG(Log::JIT, "%s", s.c_str());
+		}
+	}
+
+	// Let's spare the pre-generated code from unprotect-reprotect.
+	FlushLitPool();
+	AlignCodePage();
+	jitStartOffset_ = (int)(GetCodePtr() - start);
+	// Don't forget to zap the instruction cache! This must stay at the end of this function.
+	FlushIcache();
+	EndWrite();
+}
+
+} // namespace MIPSComp
+
+#endif
@@ -0,0 +1,545 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#include "Common/CPUDetect.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/ARM/ArmIRJit.h"
+#include "Core/MIPS/ARM/ArmIRRegCache.h"
+
+// This file contains compilation for integer / arithmetic / logic related instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace ArmGen;
+using namespace ArmIRJitConstants;
+
+void ArmJitBackend::CompIR_Arith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Add:
+		regs_.Map(inst);
+		ADD(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::Sub:
+		regs_.Map(inst);
+		SUB(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::AddConst:
+		regs_.Map(inst);
+		ADDI2R(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant, SCRATCH1);
+		break;
+
+	case IROp::SubConst:
+		regs_.Map(inst);
+		SUBI2R(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant, SCRATCH1);
+		break;
+
+	case IROp::Neg:
+		regs_.Map(inst);
+		RSB(regs_.R(inst.dest), regs_.R(inst.src1), Operand2(0));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Assign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Mov:
+		if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+		}
+		break;
+
+	case IROp::Ext8to32:
+		regs_.Map(inst);
+		SXTB(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	case IROp::Ext16to32:
+		regs_.Map(inst);
+		SXTH(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Bits(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::BSwap16:
+		regs_.Map(inst);
+		REV16(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	case IROp::BSwap32:
+		regs_.Map(inst);
+		REV(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	case IROp::Clz:
+		regs_.Map(inst);
+		CLZ(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	case IROp::ReverseBits:
+		regs_.Map(inst);
+		RBIT(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Compare(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// There's no CSET, so we conditionally overwrite a zero.  Careful, dest may be a src.
+	switch (inst.op) {
+	case IROp::Slt:
+		regs_.Map(inst);
+		CMP(regs_.R(inst.src1), regs_.R(inst.src2));
+		MOV(regs_.R(inst.dest), Operand2(0));
+		SetCC(CC_LT);
+		MOV(regs_.R(inst.dest), Operand2(1));
+		SetCC(CC_AL);
+		break;
+
+	case IROp::SltConst:
+		if (inst.constant == 0) {
+			// Basically, getting the sign bit.
+			regs_.Map(inst);
+			LSR(regs_.R(inst.dest), regs_.R(inst.src1), Operand2(31));
+		} else {
+			regs_.Map(inst);
+			CMPI2R(regs_.R(inst.src1), inst.constant, SCRATCH1);
+			MOV(regs_.R(inst.dest), Operand2(0));
+			SetCC(CC_LT);
+			MOV(regs_.R(inst.dest), Operand2(1));
+			SetCC(CC_AL);
+		}
+		break;
+
+	case IROp::SltU:
+		if (regs_.IsGPRImm(inst.src1) && regs_.GetGPRImm(inst.src1) == 0) {
+			// This is kinda common, same as != 0.  Avoid flushing src1.
+			regs_.SpillLockGPR(inst.src2, inst.dest);
+			regs_.MapGPR(inst.src2);
+			regs_.MapGPR(inst.dest, MIPSMap::NOINIT);
+			CMP(regs_.R(inst.src2), Operand2(0));
+			MOV(regs_.R(inst.dest), Operand2(0));
+			SetCC(CC_NEQ);
+			MOV(regs_.R(inst.dest), Operand2(1));
+			SetCC(CC_AL);
+		} else {
+			regs_.Map(inst);
+			CMP(regs_.R(inst.src1), regs_.R(inst.src2));
+			MOV(regs_.R(inst.dest), Operand2(0));
+			SetCC(CC_LO);
+			MOV(regs_.R(inst.dest), Operand2(1));
+			SetCC(CC_AL);
+		}
+		break;
+
+	case IROp::SltUConst:
+		if (inst.constant == 0) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else {
+			regs_.Map(inst);
+			CMPI2R(regs_.R(inst.src1), inst.constant, SCRATCH1);
+			MOV(regs_.R(inst.dest), Operand2(0));
+			SetCC(CC_LO);
+			MOV(regs_.R(inst.dest), Operand2(1));
+			SetCC(CC_AL);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_CondAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::MovZ:
+		if (inst.dest != inst.src2) {
+			regs_.Map(inst);
+			CMP(regs_.R(inst.src1), Operand2(0));
+			SetCC(CC_EQ);
+			MOV(regs_.R(inst.dest), regs_.R(inst.src2));
+			SetCC(CC_AL);
+		}
+		break;
+
+	case IROp::MovNZ:
+		if (inst.dest != inst.src2) {
+			regs_.Map(inst);
+			CMP(regs_.R(inst.src1), Operand2(0));
+			SetCC(CC_NEQ);
+			MOV(regs_.R(inst.dest), regs_.R(inst.src2));
+			SetCC(CC_AL);
+		}
+		break;
+
+	case IROp::Max:
+	case IROp::Min:
+		if (inst.src1 != inst.src2) {
+			CCFlags cc1 = inst.op == IROp::Max ? CC_GE : CC_LE;
+			CCFlags cc2 = inst.op == IROp::Max ? CC_LT : CC_GT;
+			regs_.Map(inst);
+			CMP(regs_.R(inst.src1), regs_.R(inst.src2));
+			// Neither MOV changes flags, so it's safe if dest overlaps either.
+			if (inst.dest != inst.src1) {
+				SetCC(cc1);
+				MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+			}
+			if (inst.dest != inst.src2) {
+				SetCC(cc2);
+				MOV(regs_.R(inst.dest), regs_.R(inst.src2));
+			}
+			SetCC(CC_AL);
+		} else if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Div(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// Older ARMv7 CPUs (like the Cortex-A8 and A9) don't have integer divide.
+	if (!cpu_info.bIDIVa) {
+		CompIR_Generic(inst);
+		return;
+	}
+
+	switch (inst.op) {
+	case IROp::Div:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::NOINIT }, { 'G', IRREG_HI, 1, MIPSMap::NOINIT } });
+		// INT_MIN divided by -1 = INT_MIN, anything divided by 0 = 0.
+		SDIV(regs_.R(IRREG_LO), regs_.R(inst.src1), regs_.R(inst.src2));
+		MUL(SCRATCH1, regs_.R(inst.src2), regs_.R(IRREG_LO));
+		SUB(regs_.R(IRREG_HI), regs_.R(inst.src1), SCRATCH1);
+
+		// Now some tweaks for divide by zero and overflow.
+		{
+			// Start with divide by zero, remainder is fine.
+			CMP(regs_.R(inst.src2), Operand2(0));
+			FixupBranch skipNonZero = B_CC(CC_NEQ);
+			// mips->lo = numerator < 0 ? 1 : -1
+			MVN(regs_.R(IRREG_LO), Operand2(0));
+			CMP(regs_.R(inst.src1), Operand2(0));
+			SetCC(CC_LT);
+			MOV(regs_.R(IRREG_LO), Operand2(1));
+			SetCC(CC_AL);
+			SetJumpTarget(skipNonZero);
+
+			// For overflow, we end up with remainder as zero, need to fix.
+			MOVI2R(SCRATCH1, 0x80000000);
+			CMP(regs_.R(inst.src1), SCRATCH1);
+			// Only compares if it was equal, so both have to match.
+			SetCC(CC_EQ);
+			CMN(regs_.R(inst.src2), Operand2(1));
+			SetCC(CC_EQ);
+			MVN(regs_.R(IRREG_HI), Operand2(0));
+			SetCC(CC_AL);
+		}
+		break;
+
+	case IROp::DivU:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::NOINIT }, { 'G', IRREG_HI, 1, MIPSMap::NOINIT } });
+		// Anything divided by 0 = 0.
+		UDIV(regs_.R(IRREG_LO), regs_.R(inst.src1), regs_.R(inst.src2));
+		MUL(SCRATCH1, regs_.R(inst.src2), regs_.R(IRREG_LO));
+		SUB(regs_.R(IRREG_HI), regs_.R(inst.src1), SCRATCH1);
+
+		// On divide by zero, we have to update LO - remainder is correct.
+		{
+			CMP(regs_.R(inst.src2), Operand2(0));
+			FixupBranch skipNonZero = B_CC(CC_NEQ);
+			MOVI2R(regs_.R(IRREG_LO), 0xFFFF);
+			CMP(regs_.R(inst.src1), regs_.R(IRREG_LO));
+			// If it's <= 0xFFFF, keep 0xFFFF.  Otherwise, -1.
+			SetCC(CC_HI);
+			MVN(regs_.R(IRREG_LO), Operand2(0));
+			SetCC(CC_AL);
+			SetJumpTarget(skipNonZero);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_HiLo(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// Unlike ARM64, we keep HI and LO in separate regs.
+	switch (inst.op) {
+	case IROp::MtLo:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::NOINIT } });
+		MOV(regs_.R(IRREG_LO), regs_.R(inst.src1));
+		break;
+
+	case IROp::MtHi:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_HI, 1, MIPSMap::NOINIT } });
+		MOV(regs_.R(IRREG_HI), regs_.R(inst.src1));
+		break;
+
+	case IROp::MfLo:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::INIT } });
+		MOV(regs_.R(inst.dest), regs_.R(IRREG_LO));
+		break;
+
+	case IROp::MfHi:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_HI, 1, MIPSMap::INIT } });
+		MOV(regs_.R(inst.dest), regs_.R(IRREG_HI));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Logic(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::And:
+		if (inst.src1 != inst.src2) {
+			regs_.Map(inst);
+			AND(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		} else if (inst.src1 != inst.dest) {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+		}
+		break;
+
+	case IROp::Or:
+		if (inst.src1 != inst.src2) {
+			regs_.Map(inst);
+			ORR(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		} else if (inst.src1 != inst.dest) {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+		}
+		break;
+
+	case IROp::Xor:
+		if (inst.src1 == inst.src2) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else {
+			regs_.Map(inst);
+			EOR(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		}
+		break;
+
+	case IROp::AndConst:
+		regs_.Map(inst);
+		ANDI2R(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant, SCRATCH1);
+		break;
+
+	case IROp::OrConst:
+		regs_.Map(inst);
+		ORI2R(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant, SCRATCH1);
+		break;
+
+	case IROp::XorConst:
+		regs_.Map(inst);
+		EORI2R(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant, SCRATCH1);
+		break;
+
+	case IROp::Not:
+		regs_.Map(inst);
+		MVN(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Mult(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Mult:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::NOINIT }, { 'G', IRREG_HI, 1, MIPSMap::NOINIT } });
+		SMULL(regs_.R(IRREG_LO), regs_.R(IRREG_HI), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::MultU:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::NOINIT }, { 'G', IRREG_HI, 1, MIPSMap::NOINIT } });
+		UMULL(regs_.R(IRREG_LO), regs_.R(IRREG_HI), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::Madd:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::DIRTY }, { 'G', IRREG_HI, 1, MIPSMap::DIRTY } });
+		SMLAL(regs_.R(IRREG_LO), regs_.R(IRREG_HI), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::MaddU:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 1, MIPSMap::DIRTY }, { 'G', IRREG_HI, 1, MIPSMap::DIRTY } });
+		UMLAL(regs_.R(IRREG_LO), regs_.R(IRREG_HI), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::Msub:
+	case IROp::MsubU:
+		// There's no multiply-subtract long, and these are rare.
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Shift(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// Shifting by a register uses the whole bottom byte, so we have to wrap the amount.
+	switch (inst.op) {
+	case IROp::Shl:
+		regs_.Map(inst);
+		AND(SCRATCH1, regs_.R(inst.src2), Operand2(31));
+		LSL(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+		break;
+
+	case IROp::Shr:
+		regs_.Map(inst);
+		AND(SCRATCH1, regs_.R(inst.src2), Operand2(31));
+		LSR(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+		break;
+
+	case IROp::Sar:
+		regs_.Map(inst);
+		AND(SCRATCH1, regs_.R(inst.src2), Operand2(31));
+		ASR(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+		break;
+
+	case IROp::Ror:
+		// Rotates wrap on their own.
+		regs_.Map(inst);
+		MOV(regs_.R(inst.dest), Operand2(regs_.R(inst.src1), ST_ROR, regs_.R(inst.src2)));
+		break;
+
+	case IROp::ShlImm:
+		// Shouldn't happen, but let's be safe of any passes that modify the ops.
+		if (inst.src2 >= 32) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else if (inst.src2 == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), Operand2(regs_.R(inst.src1), ST_LSL, (u8)inst.src2));
+		}
+		break;
+
+	case IROp::ShrImm:
+		// Shouldn't happen, but let's be safe of any passes that modify the ops.
+		if (inst.src2 >= 32) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else if (inst.src2 == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), Operand2(regs_.R(inst.src1), ST_LSR, (u8)inst.src2));
+		}
+		break;
+
+	case IROp::SarImm:
+		// Shouldn't happen, but let's be safe of any passes that modify the ops.
+		if (inst.src2 >= 32) {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), Operand2(regs_.R(inst.src1), ST_ASR, (u8)31));
+		} else if (inst.src2 == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), Operand2(regs_.R(inst.src1), ST_ASR, (u8)inst.src2));
+		}
+		break;
+
+	case IROp::RorImm:
+		if ((inst.src2 & 31) == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOV(regs_.R(inst.dest), regs_.R(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			MOV(regs_.R(inst.dest), Operand2(regs_.R(inst.src1), ST_ROR, (u8)(inst.src2 & 31)));
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
@@ -0,0 +1,374 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#include <cstddef>
+#include "Core/MIPS/MIPSVFPUUtils.h"
+#include "Core/MIPS/ARM/ArmIRJit.h"
+#include "Core/MIPS/ARM/ArmIRRegCache.h"
+
+// This file contains compilation for floating point related instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace ArmGen;
+using namespace ArmIRJitConstants;
+
+void ArmJitBackend::CompIR_FArith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FAdd:
+		regs_.Map(inst);
+		VADD(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FSub:
+		regs_.Map(inst);
+		VSUB(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FMul:
+		regs_.Map(inst);
+		VMUL(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FDiv:
+		regs_.Map(inst);
+		VDIV(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FSqrt:
+		regs_.Map(inst);
+		VSQRT(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FNeg:
+		regs_.Map(inst);
+		VNEG(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_FAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FMov:
+		if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			VMOV(regs_.F(inst.dest), regs_.F(inst.src1));
+		}
+		break;
+
+	case IROp::FAbs:
+		regs_.Map(inst);
+		VABS(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FSign:
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_FCompare(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	constexpr IRReg IRREG_VFPU_CC = IRREG_VFPU_CTRL_BASE + VFPU_CTRL_CC;
+
+	// Sets FPCOND to 1 if cc holds after comparing src1 and src2, 0 otherwise.
+	auto compareToFPCond = [&](CCFlags cc) {
+		regs_.MapWithExtra(inst, { { 'G', IRREG_FPCOND, 1, MIPSMap::NOINIT } });
+		VCMP(regs_.F(inst.src1), regs_.F(inst.src2));
+		VMRS_APSR();
+		MOV(regs_.R(IRREG_FPCOND), Operand2(0));
+		SetCC(cc);
+		MOV(regs_.R(IRREG_FPCOND), Operand2(1));
+		SetCC(CC_AL);
+	};
+
+	switch (inst.op) {
+	case IROp::FCmp:
+		switch (inst.dest) {
+		case IRFpCompareMode::False:
+			regs_.SetGPRImm(IRREG_FPCOND, 0);
+			break;
+
+		case IRFpCompareMode::EitherUnordered:
+			compareToFPCond(CC_VS);
+			break;
+
+		case IRFpCompareMode::EqualOrdered:
+			compareToFPCond(CC_EQ);
+			break;
+
+		case IRFpCompareMode::EqualUnordered:
+			compareToFPCond(CC_EQ);
+			// The flags are still intact, so also set it if unordered.
+			SetCC(CC_VS);
+			MOV(regs_.R(IRREG_FPCOND), Operand2(1));
+			SetCC(CC_AL);
+			break;
+
+		case IRFpCompareMode::LessEqualOrdered:
+			compareToFPCond(CC_LS);
+			break;
+
+		case IRFpCompareMode::LessEqualUnordered:
+			compareToFPCond(CC_LE);
+			break;
+
+		case IRFpCompareMode::LessOrdered:
+			compareToFPCond(CC_LO);
+			break;
+
+		case IRFpCompareMode::LessUnordered:
+			compareToFPCond(CC_LT);
+			break;
+
+		default:
+			_assert_msg_(false, "Unexpected IRFpCompareMode %d", inst.dest);
+		}
+		break;
+
+	case IROp::FCmovVfpuCC:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_VFPU_CC, 1, MIPSMap::INIT } });
+		TSTI2R(regs_.R(IRREG_VFPU_CC), 1 << (inst.src2 & 0xF), SCRATCH1);
+		SetCC((inst.src2 >> 7) & 1 ? CC_NEQ : CC_EQ);
+		VMOV(regs_.F(inst.dest), regs_.F(inst.src1));
+		SetCC(CC_AL);
+		break;
+
+	case IROp::FCmpVfpuBit:
+	case IROp::FCmpVfpuAggregate:
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_FCondAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FMin:
+	case IROp::FMax:
+		// These have special NAN and -0.0f handling, which VFP doesn't match.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_FCvt(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FCvtWS:
+		// The game's rounding mode is already applied to FPSCR.
+		regs_.Map(inst);
+		VCMP(regs_.F(inst.src1), regs_.F(inst.src1));
+		VCVT(regs_.F(inst.dest), regs_.F(inst.src1), TO_INT | IS_SIGNED);
+		VMRS_APSR();
+		// NAN would convert to zero, but should be 0x7FFFFFFF.
+		SetCC(CC_VS);
+		MOVIU2F(regs_.F(inst.dest), 0x7FFFFFFF, SCRATCH1);
+		SetCC(CC_AL);
+		break;
+
+	case IROp::FCvtSW:
+		regs_.Map(inst);
+		VCVT(regs_.F(inst.dest), regs_.F(inst.src1), TO_FLOAT | IS_SIGNED);
+		break;
+
+	case IROp::FCvtScaledWS:
+	case IROp::FCvtScaledSW:
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_FRound(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// ARM rounding mode bits in FPSCR, or -1 to use VCVT's round to zero.
+	int armRound = -1;
+	switch (inst.op) {
+	case IROp::FRound: armRound = 0; break;
+	case IROp::FTrunc: armRound = -1; break;
+	case IROp::FCeil: armRound = 1; break;
+	case IROp::FFloor: armRound = 2; break;
+	default:
+		INVALIDOP;
+		break;
+	}
+
+	regs_.Map(inst);
+	if (armRound != -1) {
+		// Temporarily switch FPSCR to the mode we need, keeping the old value in SCRATCH2.
+		VMRS(SCRATCH2);
+		BIC(SCRATCH1, SCRATCH2, AssumeMakeOperand2(3 << 22));
+		if (armRound != 0)
+			ORR(SCRATCH1, SCRATCH1, AssumeMakeOperand2(armRound << 22));
+		VMSR(SCRATCH1);
+	}
+
+	VCMP(regs_.F(inst.src1), regs_.F(inst.src1));
+	// Luckily, these already saturate.
+	VCVT(regs_.F(inst.dest), regs_.F(inst.src1), TO_INT | IS_SIGNED | (armRound == -1 ? ROUND_TO_ZERO : 0));
+	VMRS_APSR();
+	// Switch to INT_MAX if it was NAN.
+	SetCC(CC_VS);
+	MOVIU2F(regs_.F(inst.dest), 0x7FFFFFFF, SCRATCH1);
+	SetCC(CC_AL);
+
+	if (armRound != -1)
+		VMSR(SCRATCH2);
+}
+
+void ArmJitBackend::CompIR_FSat(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FSat0_1:
+	case IROp::FSatMinus1_1:
+		// These need vfpu_clamp's NAN and -0.0f handling.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_FSpecial(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	auto callFuncF_F = [&](float (*func)(float)) {
+		regs_.FlushBeforeCall();
+		WriteDebugProfilerStatus(IRProfilerStatus::MATH_HELPER);
+
+		// It might be in a non-volatile register.
+		if (regs_.IsFPRMapped(inst.src1)) {
+			int lane = regs_.GetFPRLane(inst.src1);
+			VMOV(S0, (ARMReg)(regs_.F(inst.src1) + lane));
+		} else {
+			int offset = offsetof(MIPSState, f) + inst.src1 * 4;
+			VLDR(S0, CTXREG, offset);
+		}
+#if !defined(__ARM_PCS_VFP)
+		// Soft float calling convention passes floats in integer registers.
+		VMOV(R0, S0);
+#endif
+		QuickCallFunction(SCRATCH2, func);
+#if !defined(__ARM_PCS_VFP)
+		VMOV(S0, R0);
+#endif
+
+		regs_.MapFPR(inst.dest, MIPSMap::NOINIT);
+		VMOV(regs_.F(inst.dest), S0);
+
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+	};
+
+	switch (inst.op) {
+	case IROp::FSin:
+		callFuncF_F(&vfpu_sin);
+		break;
+
+	case IROp::FCos:
+		callFuncF_F(&vfpu_cos);
+		break;
+
+	case IROp::FRSqrt:
+		regs_.Map(inst);
+		MOVI2F(SCRATCHF1, 1.0f, SCRATCH1);
+		VSQRT(regs_.F(inst.dest), regs_.F(inst.src1));
+		VDIV(regs_.F(inst.dest), SCRATCHF1, regs_.F(inst.dest));
+		break;
+
+	case IROp::FRecip:
+		regs_.Map(inst);
+		MOVI2F(SCRATCHF1, 1.0f, SCRATCH1);
+		VDIV(regs_.F(inst.dest), SCRATCHF1, regs_.F(inst.src1));
+		break;
+
+	case IROp::FAsin:
+		callFuncF_F(&vfpu_asin);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_RoundingMode(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::RestoreRoundingMode:
+		RestoreRoundingMode();
+		break;
+
+	case IROp::ApplyRoundingMode:
+		ApplyRoundingMode();
+		break;
+
+	case IROp::UpdateRoundingMode:
+		// We always apply from fcr31, so there's nothing to update.
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
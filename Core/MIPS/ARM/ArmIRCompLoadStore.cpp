@@ -0,0 +1,246 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#include "Core/MIPS/ARM/ArmIRJit.h"
+#include "Core/MIPS/ARM/ArmIRRegCache.h"
+
+// This file contains compilation for load and store instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace ArmGen;
+using namespace ArmIRJitConstants;
+
+
+void ArmJitBackend::PrepareSrc1Address(IRInst inst) {
+	// Memory is always masked on 32-bit, so the address is always an offset from MEMBASEREG.
+	if (regs_.IsGPRImm(inst.src1)) {
+		MOVI2R(SCRATCH1, (regs_.GetGPRImm(inst.src1) + inst.constant) & 0x3FFFFFFF);
+	} else {
+		ADDI2R(SCRATCH1, regs_.R(inst.src1), inst.constant, SCRATCH2);
+		BIC(SCRATCH1, SCRATCH1, Operand2(0xC0, 4));   // &= 0x3FFFFFFF
+	}
+}
+
+void ArmJitBackend::CompIR_CondStore(IRInst inst) {
+	CONDITIONAL_DISABLE;
+	if (inst.op != IROp::Store32Conditional)
+		INVALIDOP;
+
+	// Map everything first, since spilling an imm may use SCRATCH1.
+	regs_.MapWithExtra(inst, { { 'G', IRREG_LLBIT, 1, MIPSMap::INIT } });
+	PrepareSrc1Address(inst);
+
+	CMP(regs_.R(IRREG_LLBIT), Operand2(0));
+	FixupBranch condFailed = B_CC(CC_EQ);
+	STR(regs_.R(inst.src3), MEMBASEREG, SCRATCH1);
+
+	if (inst.dest != MIPS_REG_ZERO) {
+		MOVI2R(regs_.R(inst.dest), 1);
+		FixupBranch finish = B();
+
+		SetJumpTarget(condFailed);
+		MOVI2R(regs_.R(inst.dest), 0);
+		SetJumpTarget(finish);
+	} else {
+		SetJumpTarget(condFailed);
+	}
+}
+
+void ArmJitBackend::CompIR_FLoad(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::LoadFloat:
+		regs_.Map(inst);
+		PrepareSrc1Address(inst);
+		// VLDR has no register offset form.
+		ADD(SCRATCH1, MEMBASEREG, SCRATCH1);
+		VLDR(regs_.F(inst.dest), SCRATCH1, 0);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_FStore(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::StoreFloat:
+		regs_.Map(inst);
+		PrepareSrc1Address(inst);
+		ADD(SCRATCH1, MEMBASEREG, SCRATCH1);
+		VSTR(regs_.F(inst.src3), SCRATCH1, 0);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Load(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	regs_.Map(inst);
+	PrepareSrc1Address(inst);
+
+	// TODO: Safe memory?  Or enough to have crash handler + validate?
+
+	switch (inst.op) {
+	case IROp::Load8:
+		LDRB(regs_.R(inst.dest), MEMBASEREG, SCRATCH1);
+		break;
+
+	case IROp::Load8Ext:
+		LDRSB(regs_.R(inst.dest), MEMBASEREG, SCRATCH1);
+		break;
+
+	case IROp::Load16:
+		LDRH(regs_.R(inst.dest), MEMBASEREG, SCRATCH1);
+		break;
+
+	case IROp::Load16Ext:
+		LDRSH(regs_.R(inst.dest), MEMBASEREG, SCRATCH1);
+		break;
+
+	case IROp::Load32:
+		LDR(regs_.R(inst.dest), MEMBASEREG, SCRATCH1);
+		break;
+
+	case IROp::Load32Linked:
+		if (inst.dest != MIPS_REG_ZERO)
+			LDR(regs_.R(inst.dest), MEMBASEREG, SCRATCH1);
+		regs_.SetGPRImm(IRREG_LLBIT, 1);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_LoadShift(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Load32Left:
+	case IROp::Load32Right:
+		// Should not happen if the pass to split is active.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Store(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	regs_.Map(inst);
+	PrepareSrc1Address(inst);
+
+	// TODO: Safe memory?  Or enough to have crash handler + validate?
+
+	switch (inst.op) {
+	case IROp::Store8:
+		STRB(regs_.R(inst.src3), MEMBASEREG, SCRATCH1);
+		break;
+
+	case IROp::Store16:
+		STRH(regs_.R(inst.src3), MEMBASEREG, SCRATCH1);
+		break;
+
+	case IROp::Store32:
+		STR(regs_.R(inst.src3), MEMBASEREG, SCRATCH1);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_StoreShift(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Store32Left:
+	case IROp::Store32Right:
+		// Should not happen if the pass to split is active.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_VecLoad(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::LoadVec4:
+		regs_.Map(inst);
+		PrepareSrc1Address(inst);
+		ADD(SCRATCH1, MEMBASEREG, SCRATCH1);
+		VLD1(F_32, regs_.FQ(inst.dest), SCRATCH1, 2);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_VecStore(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::StoreVec4:
+		regs_.Map(inst);
+		PrepareSrc1Address(inst);
+		ADD(SCRATCH1, MEMBASEREG, SCRATCH1);
+		VST1(F_32, regs_.FQ(inst.src3), SCRATCH1, 2);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
@@ -0,0 +1,284 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#include "Common/Profiler/Profiler.h"
+#include "Core/Core.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/ReplaceTables.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/ARM/ArmIRJit.h"
+#include "Core/MIPS/ARM/ArmIRRegCache.h"
+
+// This file contains compilation for basic PC/downcount accounting, syscalls, debug funcs, etc.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace ArmGen;
+using namespace ArmIRJitConstants;
+
+void ArmJitBackend::CompIR_Basic(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Downcount:
+		SUBI2R(DOWNCOUNTREG, DOWNCOUNTREG, inst.constant, SCRATCH1);
+		break;
+
+	case IROp::SetConst:
+		regs_.SetGPRImm(inst.dest, inst.constant);
+		break;
+
+	case IROp::SetConstF:
+	{
+		regs_.Map(inst);
+		float f;
+		memcpy(&f, &inst.constant, sizeof(f));
+		MOVI2F(regs_.F(inst.dest), f, SCRATCH1);
+		break;
+	}
+
+	case IROp::SetPC:
+		regs_.Map(inst);
+		MovToPC(regs_.R(inst.src1));
+		break;
+
+	case IROp::SetPCConst:
+		lastConstPC_ = inst.constant;
+		MOVI2R(SCRATCH1, inst.constant);
+		MovToPC(SCRATCH1);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Breakpoint(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Breakpoint:
+	case IROp::MemoryCheck:
+		// Not worth the code size here, the interpreter versions handle these fine.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_System(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Syscall:
+		FlushAll();
+		SaveStaticRegisters();
+
+		WriteDebugProfilerStatus(IRProfilerStatus::SYSCALL);
+#ifdef USE_PROFILER
+		// When profiling, we can't skip CallSyscall, since it times syscalls.
+		MOVI2R(R0, inst.constant);
+		QuickCallFunction(SCRATCH2, &CallSyscall);
+#else
+		// Skip the CallSyscall where possible.
+		{
+			MIPSOpcode op(inst.constant);
+			void *quickFunc = GetQuickSyscallFunc(op);
+			if (quickFunc) {
+				MOVP2R(R0, GetSyscallFuncPointer(op));
+				QuickCallFunction(SCRATCH2, (const void *)quickFunc);
+			} else {
+				MOVI2R(R0, inst.constant);
+				QuickCallFunction(SCRATCH2, &CallSyscall);
+			}
+		}
+#endif
+
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		// This is always followed by an ExitToPC, where we check coreState.
+		break;
+
+	case IROp::SyscallFast:
+	{
+		FlushAll();
+		SaveStaticRegisters();
+
+		WriteDebugProfilerStatus(IRProfilerStatus::SYSCALL);
+		MOVP2R(R0, GetSyscallFuncPointer(MIPSOpcode(inst.constant)));
+		QuickCallFunction(SCRATCH2, &CallSyscallFast);
+		CMP(R0, Operand2(0));
+		FixupBranch keepGoing = B_CC(CC_EQ);
+		// It needed the full syscall handling after all (like a reschedule), so exit like ExitToPC.
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		B(dispatcherCheckCoreState_);
+		SetJumpTarget(keepGoing);
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		break;
+	}
+
+	case IROp::CallReplacement:
+		FlushAll();
+		SaveStaticRegisters();
+		WriteDebugProfilerStatus(IRProfilerStatus::REPLACEMENT);
+		QuickCallFunction(SCRATCH2, (const void *)GetReplacementFunc(inst.constant)->replaceFunc);
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+
+		// Absolute value the result and subtract.
+		CMP(R0, Operand2(0));
+		MOV(SCRATCH1, R0);
+		SetCC(CC_MI);
+		RSB(SCRATCH1, R0, Operand2(0));
+		SetCC(CC_AL);
+		SUB(DOWNCOUNTREG, DOWNCOUNTREG, SCRATCH1);
+
+		// R0 might be the mapped reg, but there's only one.
+		// Set dest reg to the sign of the result.
+		regs_.Map(inst);
+		ASR(regs_.R(inst.dest), R0, 31);
+		break;
+
+	case IROp::Break:
+		FlushAll();
+		// This doesn't naturally have restore/apply around it.
+		RestoreRoundingMode(true);
+		SaveStaticRegisters();
+		MovFromPC(R0);
+		QuickCallFunction(SCRATCH2, &Core_BreakException);
+		LoadStaticRegisters();
+		ApplyRoundingMode(true);
+		MovFromPC(SCRATCH1);
+		ADD(SCRATCH1, SCRATCH1, Operand2(4));
+		B(dispatcherPCInSCRATCH1_);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_Transfer(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::SetCtrlVFPU:
+		regs_.SetGPRImm(IRREG_VFPU_CTRL_BASE + inst.dest, inst.constant);
+		break;
+
+	case IROp::SetCtrlVFPUReg:
+		regs_.Map(inst);
+		MOV(regs_.R(IRREG_VFPU_CTRL_BASE + inst.dest), regs_.R(inst.src1));
+		break;
+
+	case IROp::SetCtrlVFPUFReg:
+		regs_.Map(inst);
+		VMOV(regs_.R(IRREG_VFPU_CTRL_BASE + inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FpCondFromReg:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_FPCOND, 1, MIPSMap::NOINIT } });
+		MOV(regs_.R(IRREG_FPCOND), regs_.R(inst.src1));
+		break;
+
+	case IROp::FpCondToReg:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_FPCOND, 1, MIPSMap::INIT } });
+		MOV(regs_.R(inst.dest), regs_.R(IRREG_FPCOND));
+		break;
+
+	case IROp::FpCtrlFromReg:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_FPCOND, 1, MIPSMap::NOINIT } });
+		ANDI2R(SCRATCH1, regs_.R(inst.src1), 0x0181FFFF, SCRATCH2);
+		// Extract the new fpcond value.
+		UBFX(regs_.R(IRREG_FPCOND), SCRATCH1, 23, 1);
+		STR(SCRATCH1, CTXREG, IRREG_FCR31 * 4);
+		break;
+
+	case IROp::FpCtrlToReg:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_FPCOND, 1, MIPSMap::INIT } });
+		// Load fcr31 and clear the fpcond bit.
+		LDR(regs_.R(inst.dest), CTXREG, IRREG_FCR31 * 4);
+		BFI(regs_.R(inst.dest), regs_.R(IRREG_FPCOND), 23, 1);
+		// Also update mips->fcr31 while we're here.
+		STR(regs_.R(inst.dest), CTXREG, IRREG_FCR31 * 4);
+		break;
+
+	case IROp::VfpuCtrlToReg:
+		regs_.Map(inst);
+		MOV(regs_.R(inst.dest), regs_.R(IRREG_VFPU_CTRL_BASE + inst.src1));
+		break;
+
+	case IROp::FMovFromGPR:
+		if (regs_.IsGPRImm(inst.src1) && regs_.GetGPRImm(inst.src1) == 0) {
+			regs_.MapFPR(inst.dest, MIPSMap::NOINIT);
+			MOVI2F(regs_.F(inst.dest), 0.0f, SCRATCH1);
+		} else {
+			regs_.Map(inst);
+			VMOV(regs_.F(inst.dest), regs_.R(inst.src1));
+		}
+		break;
+
+	case IROp::FMovToGPR:
+		regs_.Map(inst);
+		VMOV(regs_.R(inst.dest), regs_.F(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_ValidateAddress(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::ValidateAddress8:
+	case IROp::ValidateAddress16:
+	case IROp::ValidateAddress32:
+	case IROp::ValidateAddress128:
+		// Only used with debugging options, so the interpreter version is fine.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
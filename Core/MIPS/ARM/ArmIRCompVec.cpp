@@ -0,0 +1,265 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#include "Core/MIPS/ARM/ArmIRJit.h"
+#include "Core/MIPS/ARM/ArmIRRegCache.h"
+
+// This file contains compilation for vector instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace ArmGen;
+using namespace ArmIRJitConstants;
+
+static bool Overlap(IRReg r1, int l1, IRReg r2, int l2) {
+	return r1 < r2 + l2 && r1 + l1 > r2;
+}
+
+// Only Q0-Q7 have S aliases, which is all we allocate.  This gets the S reg of a lane.
+static ARMReg QLane(ARMReg q, int lane) {
+	return (ARMReg)(S0 + (q - Q0) * 4 + lane);
+}
+
+void ArmJitBackend::CompIR_VecArith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4Add:
+		regs_.Map(inst);
+		VADD(F_32, regs_.FQ(inst.dest), regs_.FQ(inst.src1), regs_.FQ(inst.src2));
+		break;
+
+	case IROp::Vec4Sub:
+		regs_.Map(inst);
+		VSUB(F_32, regs_.FQ(inst.dest), regs_.FQ(inst.src1), regs_.FQ(inst.src2));
+		break;
+
+	case IROp::Vec4Mul:
+		regs_.Map(inst);
+		VMUL(F_32, regs_.FQ(inst.dest), regs_.FQ(inst.src1), regs_.FQ(inst.src2));
+		break;
+
+	case IROp::Vec4Div:
+		// NEON has no divide, so do it per lane with VFP.
+		regs_.Map(inst);
+		for (int i = 0; i < 4; ++i)
+			VDIV(QLane(regs_.FQ(inst.dest), i), QLane(regs_.FQ(inst.src1), i), QLane(regs_.FQ(inst.src2), i));
+		break;
+
+	case IROp::Vec4Scale:
+		if (Overlap(inst.dest, 4, inst.src2, 1) || Overlap(inst.src1, 4, inst.src2, 1)) {
+			DISABLE;
+		} else {
+			regs_.Map(inst);
+			// The scalar can be anywhere, so copy it to a known D reg lane.
+			VMOV(SCRATCHF1, regs_.F(inst.src2));
+			VMUL_scalar(F_32, regs_.FQ(inst.dest), regs_.FQ(inst.src1), DScalar(D0, 0));
+		}
+		break;
+
+	case IROp::Vec4Neg:
+		regs_.Map(inst);
+		VNEG(F_32, regs_.FQ(inst.dest), regs_.FQ(inst.src1));
+		break;
+
+	case IROp::Vec4Abs:
+		regs_.Map(inst);
+		VABS(F_32, regs_.FQ(inst.dest), regs_.FQ(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_VecAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4Init:
+		regs_.Map(inst);
+		switch (Vec4Init(inst.src1)) {
+		case Vec4Init::AllZERO:
+			VEOR(regs_.FQ(inst.dest), regs_.FQ(inst.dest), regs_.FQ(inst.dest));
+			break;
+
+		case Vec4Init::AllONE:
+			VMOV_immf(regs_.FQ(inst.dest), 1.0f);
+			break;
+
+		case Vec4Init::AllMinusONE:
+			VMOV_immf(regs_.FQ(inst.dest), -1.0f);
+			break;
+
+		case Vec4Init::Set_1000:
+		case Vec4Init::Set_0100:
+		case Vec4Init::Set_0010:
+		case Vec4Init::Set_0001:
+			VEOR(regs_.FQ(inst.dest), regs_.FQ(inst.dest), regs_.FQ(inst.dest));
+			MOVI2F(QLane(regs_.FQ(inst.dest), inst.src1 - (int)Vec4Init::Set_1000), 1.0f, SCRATCH1);
+			break;
+
+		default:
+			_assert_msg_(false, "Unexpected Vec4Init value %d", inst.src1);
+			DISABLE;
+		}
+		break;
+
+	case IROp::Vec4Shuffle:
+		if (inst.src2 == 0xE4) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				VMOV_neon(regs_.FQ(inst.dest), regs_.FQ(inst.src1));
+			}
+		} else if (inst.src2 == 0x00 || inst.src2 == 0x55 || inst.src2 == 0xAA || inst.src2 == 0xFF) {
+			// This is a broadcast of a single lane.
+			regs_.Map(inst);
+			int lane = inst.src2 & 3;
+			ARMReg srcD = lane < 2 ? D_0(regs_.FQ(inst.src1)) : D_1(regs_.FQ(inst.src1));
+			VDUP(F_32, regs_.FQ(inst.dest), srcD, lane & 1);
+		} else {
+			regs_.Map(inst);
+			ARMReg src = regs_.FQ(inst.src1);
+			if (inst.dest == inst.src1) {
+				// Copy to Q0 (SCRATCHF1-4) so we don't overwrite lanes we still need.
+				VMOV_neon(Q0, src);
+				src = Q0;
+			}
+			for (int i = 0; i < 4; ++i)
+				VMOV(QLane(regs_.FQ(inst.dest), i), QLane(src, (inst.src2 >> (i * 2)) & 3));
+		}
+		break;
+
+	case IROp::Vec4Blend:
+		regs_.Map(inst);
+		// Each lane only reads the same lane of a source, so overlap doesn't matter.
+		for (int i = 0; i < 4; ++i) {
+			IRReg src = ((inst.constant >> i) & 1) ? inst.src2 : inst.src1;
+			if (src != inst.dest)
+				VMOV(QLane(regs_.FQ(inst.dest), i), QLane(regs_.FQ(src), i));
+		}
+		break;
+
+	case IROp::Vec4Mov:
+		if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			VMOV_neon(regs_.FQ(inst.dest), regs_.FQ(inst.src1));
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_VecClamp(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4ClampToZero:
+		regs_.Map(inst);
+		// Treating the floats as signed ints, negative values (including -0.0f) are less than zero.
+		VEOR(Q0, Q0, Q0);
+		VMAX(I_32 | I_SIGNED, regs_.FQ(inst.dest), regs_.FQ(inst.src1), Q0);
+		break;
+
+	case IROp::Vec2ClampToZero:
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_VecHoriz(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4Dot:
+		if (Overlap(inst.dest, 1, inst.src1, 4) || Overlap(inst.dest, 1, inst.src2, 4)) {
+			DISABLE;
+		} else {
+			regs_.Map(inst);
+			VMUL(F_32, Q0, regs_.FQ(inst.src1), regs_.FQ(inst.src2));
+			VPADD(F_32, D0, D0, D1);
+			VPADD(F_32, D0, D0, D0);
+			VMOV(regs_.F(inst.dest), SCRATCHF1);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_VecMatrix(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4MatMul:
+	case IROp::Vec4MatMulTransposed:
+	case IROp::Vec4Transform:
+		// Not generated for this backend (see preferVec4Matrix), but just in case.
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void ArmJitBackend::CompIR_VecPack(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4DuplicateUpperBitsAndShift1:
+	case IROp::Vec2Pack31To16:
+	case IROp::Vec2Pack32To16:
+	case IROp::Vec4Pack31To8:
+	case IROp::Vec4Pack32To8:
+	case IROp::Vec2Unpack16To31:
+	case IROp::Vec2Unpack16To32:
+	case IROp::Vec4Unpack8To32:
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
@@ -0,0 +1,275 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#ifndef offsetof
+#include <cstddef>
+#endif
+
+#include "Common/LogReporting.h"
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRAnalysis.h"
+#include "Core/MIPS/ARM/ArmIRRegCache.h"
+#include "Core/MIPS/JitCommon/JitState.h"
+
+using namespace ArmGen;
+using namespace ArmIRJitConstants;
+
+ArmIRRegCache::ArmIRRegCache(MIPSComp::JitOptions *jo)
+	: IRNativeRegCacheBase(jo) {
+	// The S/D/Q regs overlap, so we use one slot per Q reg.  The numbers don't match ARMReg.
+	config_.totalNativeRegs = NUM_ARM_REGS + NUM_ARM_QREGS;
+	config_.mapFPUSIMD = true;
+	// Q regs are used for both FPU and Vec, so we don't need VREGs.
+	config_.mapUseVRegs = false;
+}
+
+void ArmIRRegCache::Init(ARMXEmitter *emitter) {
+	emit_ = emitter;
+}
+
+const int *ArmIRRegCache::GetAllocationOrder(MIPSLoc type, MIPSMap flags, int &count, int &base) const {
+	if (type == MIPSLoc::REG) {
+		// R7, R10, R11 are fixed, and R12 and R14 are scratch.  See ArmIRJitConstants.
+		base = R0;
+
+		// Callee-saved first, so fewer need to be flushed around calls.
+		static const int allocationOrder[] = {
+			R4, R5, R6, R8, R9, R0, R1, R2, R3,
+		};
+
+		count = ARRAY_SIZE(allocationOrder);
+		return allocationOrder;
+	} else if (type == MIPSLoc::FREG) {
+		base = Q0 - NUM_ARM_REGS;
+
+		// Q0 is reserved for temps.  Q4-Q7 (D8-D15) are callee-saved.
+		static const int allocationOrder[] = {
+			Q4, Q5, Q6, Q7, Q1, Q2, Q3,
+		};
+
+		count = ARRAY_SIZE(allocationOrder);
+		return allocationOrder;
+	} else {
+		_assert_msg_(false, "Allocation order not yet implemented");
+		count = 0;
+		return nullptr;
+	}
+}
+
+void ArmIRRegCache::FlushBeforeCall() {
+	// These registers are not preserved by function calls.
+	for (int i = 0; i <= 3; ++i) {
+		FlushNativeReg(GPRToNativeReg(ARMReg(R0 + i)));
+	}
+#if PPSSPP_PLATFORM(IOS)
+	// On iOS, R9 is volatile.
+	FlushNativeReg(GPRToNativeReg(R9));
+#endif
+	FlushNativeReg(GPRToNativeReg(R12));
+
+	// D8-D15 are saved, which is exactly Q4-Q7.
+	for (int i = 0; i < 4; ++i) {
+		FlushNativeReg(QToNativeReg(ARMReg(Q0 + i)));
+	}
+}
+
+ARMReg ArmIRRegCache::GetAndLockTempGPR() {
+	IRNativeReg reg = AllocateReg(MIPSLoc::REG, MIPSMap::INIT);
+	if (reg != -1) {
+		nr[reg].tempLockIRIndex = irIndex_;
+	}
+	return FromNativeReg(reg);
+}
+
+ARMReg ArmIRRegCache::GetAndLockTempFPR() {
+	IRNativeReg reg = AllocateReg(MIPSLoc::FREG, MIPSMap::INIT);
+	if (reg != -1) {
+		nr[reg].tempLockIRIndex = irIndex_;
+	}
+	return FromNativeReg(reg);
+}
+
+ARMReg ArmIRRegCache::MapWithFPRTemp(const IRInst &inst) {
+	return FromNativeReg(MapWithTemp(inst, MIPSLoc::FREG));
+}
+
+ARMReg ArmIRRegCache::MapGPR(IRReg mipsReg, MIPSMap mapFlags) {
+	_dbg_assert_(IsValidGPR(mipsReg));
+
+	// Okay, not mapped, so we need to allocate an ARM register.
+	IRNativeReg nreg = MapNativeReg(MIPSLoc::REG, mipsReg, 1, mapFlags);
+	return FromNativeReg(nreg);
+}
+
+ARMReg ArmIRRegCache::MapFPR(IRReg mipsReg, MIPSMap mapFlags) {
+	_dbg_assert_(IsValidFPR(mipsReg));
+	_dbg_assert_(mr[mipsReg + 32].loc == MIPSLoc::MEM || mr[mipsReg + 32].loc == MIPSLoc::FREG);
+
+	IRNativeReg nreg = MapNativeReg(MIPSLoc::FREG, mipsReg + 32, 1, mapFlags);
+	if (nreg != -1)
+		return FromNativeReg(nreg);
+	return INVALID_REG;
+}
+
+ARMReg ArmIRRegCache::MapVec4(IRReg first, MIPSMap mapFlags) {
+	_dbg_assert_(IsValidFPR(first));
+	_dbg_assert_((first & 3) == 0);
+	_dbg_assert_(mr[first + 32].loc == MIPSLoc::MEM || mr[first + 32].loc == MIPSLoc::FREG);
+
+	IRNativeReg nreg = MapNativeReg(MIPSLoc::FREG, first + 32, 4, mapFlags);
+	if (nreg != -1)
+		return FromNativeRegQ(nreg);
+	return INVALID_REG;
+}
+
+void ArmIRRegCache::LoadNativeReg(IRNativeReg nreg, IRReg first, int lanes) {
+	_dbg_assert_(first != MIPS_REG_ZERO);
+	int offset = GetMipsRegOffset(first);
+	if (nreg < NUM_ARM_REGS) {
+		// HI and LO are mapped separately, there are no 64-bit GPRs here.
+		_assert_(lanes == 1);
+		emit_->LDR(FromNativeReg(nreg), CTXREG, offset);
+	} else {
+		_dbg_assert_(nreg < NUM_ARM_REGS + NUM_ARM_QREGS);
+		_assert_msg_(mr[first].loc == MIPSLoc::FREG, "Cannot load this type: %d", (int)mr[first].loc);
+		ARMReg q = FromNativeRegQ(nreg);
+		if (lanes == 1) {
+			emit_->VLDR(FromNativeReg(nreg), CTXREG, offset);
+		} else if (lanes == 2) {
+			emit_->VLDR(D_0(q), CTXREG, offset);
+		} else if (lanes == 4) {
+			// VLD1 would need the address in a register, and this doesn't clobber anything.
+			emit_->VLDR(D_0(q), CTXREG, offset);
+			emit_->VLDR(D_1(q), CTXREG, offset + 8);
+		} else {
+			_assert_(false);
+		}
+	}
+}
+
+void ArmIRRegCache::StoreNativeReg(IRNativeReg nreg, IRReg first, int lanes) {
+	_dbg_assert_(first != MIPS_REG_ZERO);
+	int offset = GetMipsRegOffset(first);
+	if (nreg < NUM_ARM_REGS) {
+		_assert_(lanes == 1);
+		_assert_(mr[first].loc == MIPSLoc::REG || mr[first].loc == MIPSLoc::REG_IMM);
+		emit_->STR(FromNativeReg(nreg), CTXREG, offset);
+	} else {
+		_dbg_assert_(nreg < NUM_ARM_REGS + NUM_ARM_QREGS);
+		_assert_msg_(mr[first].loc == MIPSLoc::FREG, "Cannot store this type: %d", (int)mr[first].loc);
+		ARMReg q = FromNativeRegQ(nreg);
+		if (lanes == 1) {
+			emit_->VSTR(FromNativeReg(nreg), CTXREG, offset);
+		} else if (lanes == 2) {
+			emit_->VSTR(D_0(q), CTXREG, offset);
+		} else if (lanes == 4) {
+			emit_->VSTR(D_0(q), CTXREG, offset);
+			emit_->VSTR(D_1(q), CTXREG, offset + 8);
+		} else {
+			_assert_(false);
+		}
+	}
+}
+
+void ArmIRRegCache::SetNativeRegValue(IRNativeReg nreg, uint32_t imm) {
+	_dbg_assert_(nreg >= 0 && nreg < NUM_ARM_REGS);
+	emit_->MOVI2R(FromNativeReg(nreg), imm);
+}
+
+void ArmIRRegCache::StoreRegValue(IRReg mreg, uint32_t imm) {
+	_assert_(IsValidGPRNoZero(mreg));
+	// Try to optimize using a different reg.
+	ARMReg storeReg = INVALID_REG;
+
+	// Could we get lucky?  Check for an exact match in another reg.
+	for (int i = 1; i < TOTAL_MAPPABLE_IRREGS; ++i) {
+		if (mr[i].loc == MIPSLoc::REG_IMM && mr[i].imm == imm) {
+			// Awesome, let's just store this reg.
+			storeReg = FromNativeReg(mr[i].nReg);
+			break;
+		}
+	}
+
+	if (storeReg == INVALID_REG) {
+		emit_->MOVI2R(SCRATCH1, imm);
+		storeReg = SCRATCH1;
+	}
+	emit_->STR(storeReg, CTXREG, GetMipsRegOffset(mreg));
+}
+
+ARMReg ArmIRRegCache::R(IRReg mipsReg) {
+	_dbg_assert_(IsValidGPR(mipsReg));
+	_dbg_assert_(mr[mipsReg].loc == MIPSLoc::REG || mr[mipsReg].loc == MIPSLoc::REG_IMM);
+	if (mr[mipsReg].loc == MIPSLoc::REG || mr[mipsReg].loc == MIPSLoc::REG_IMM) {
+		return FromNativeReg(mr[mipsReg].nReg);
+	} else {
+		ERROR_LOG_REPORT(Log::JIT, "Reg %i not in arm reg", mipsReg);
+		return INVALID_REG;  // BAAAD
+	}
+}
+
+ARMReg ArmIRRegCache::F(IRReg mipsReg) {
+	_dbg_assert_(IsValidFPR(mipsReg));
+	_dbg_assert_(mr[mipsReg + 32].loc == MIPSLoc::FREG);
+	if (mr[mipsReg + 32].loc == MIPSLoc::FREG) {
+		return FromNativeReg(mr[mipsReg + 32].nReg);
+	} else {
+		ERROR_LOG_REPORT(Log::JIT, "Reg %i not in arm reg", mipsReg);
+		return INVALID_REG;  // BAAAD
+	}
+}
+
+ARMReg ArmIRRegCache::FD(IRReg mipsReg) {
+	return D_0(FQ(mipsReg));
+}
+
+ARMReg ArmIRRegCache::FQ(IRReg mipsReg) {
+	_dbg_assert_(IsValidFPR(mipsReg));
+	_dbg_assert_(mr[mipsReg + 32].loc == MIPSLoc::FREG);
+	if (mr[mipsReg + 32].loc == MIPSLoc::FREG) {
+		return FromNativeRegQ(mr[mipsReg + 32].nReg);
+	} else {
+		ERROR_LOG_REPORT(Log::JIT, "Reg %i not in arm reg", mipsReg);
+		return INVALID_REG;  // BAAAD
+	}
+}
+
+IRNativeReg ArmIRRegCache::GPRToNativeReg(ARMReg r) {
+	_dbg_assert_msg_(r >= R0 && r <= R15, "Not a GPR?");
+	return (IRNativeReg)r;
+}
+
+IRNativeReg ArmIRRegCache::QToNativeReg(ARMReg r) {
+	_dbg_assert_msg_(r >= Q0 && r < Q0 + NUM_ARM_QREGS, "Not an allocatable Q reg?");
+	return (IRNativeReg)(NUM_ARM_REGS + (int)(r - Q0));
+}
+
+ARMReg ArmIRRegCache::FromNativeReg(IRNativeReg r) {
+	if (r >= NUM_ARM_REGS)
+		return (ARMReg)(S0 + (r - NUM_ARM_REGS) * 4);
+	return (ARMReg)r;
+}
+
+ARMReg ArmIRRegCache::FromNativeRegQ(IRNativeReg r) {
+	_dbg_assert_msg_(r >= NUM_ARM_REGS && r < NUM_ARM_REGS + NUM_ARM_QREGS, "Not a Q reg?");
+	return (ARMReg)(Q0 + (r - NUM_ARM_REGS));
+}
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(ARM)
+
+#include "Common/ArmEmitter.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/IR/IRRegCache.h"
+
+namespace ArmIRJitConstants {
+
+const ArmGen::ARMReg DOWNCOUNTREG = ArmGen::R7;
+const ArmGen::ARMReg CTXREG = ArmGen::R10;
+const ArmGen::ARMReg MEMBASEREG = ArmGen::R11;
+const ArmGen::ARMReg SCRATCH1 = ArmGen::R12;
+// Note: this is LR, so it's destroyed by any call.
+const ArmGen::ARMReg SCRATCH2 = ArmGen::R14;
+// These all live in Q0, which is never allocated.
+const ArmGen::ARMReg SCRATCHF1 = ArmGen::S0;
+const ArmGen::ARMReg SCRATCHF2 = ArmGen::S1;
+const ArmGen::ARMReg SCRATCHF3 = ArmGen::S2;
+const ArmGen::ARMReg SCRATCHF4 = ArmGen::S3;
+// Q8-Q15 have no S aliases, so they're only used as vector temps.
+const ArmGen::ARMReg SCRATCHQ1 = ArmGen::Q8;
+const ArmGen::ARMReg SCRATCHQ2 = ArmGen::Q9;
+
+} // namespace ArmIRJitConstants
+
+class ArmIRRegCache : public IRNativeRegCacheBase {
+public:
+	ArmIRRegCache(MIPSComp::JitOptions *jo);
+
+	void Init(ArmGen::ARMXEmitter *emitter);
+
+	// Returns an ARM register containing the requested MIPS register.
+	ArmGen::ARMReg MapGPR(IRReg reg, MIPSMap mapFlags = MIPSMap::INIT);
+	ArmGen::ARMReg MapFPR(IRReg reg, MIPSMap mapFlags = MIPSMap::INIT);
+	ArmGen::ARMReg MapVec4(IRReg first, MIPSMap mapFlags = MIPSMap::INIT);
+
+	ArmGen::ARMReg MapWithFPRTemp(const IRInst &inst);
+
+	void FlushBeforeCall();
+
+	ArmGen::ARMReg GetAndLockTempGPR();
+	ArmGen::ARMReg GetAndLockTempFPR();
+
+	ArmGen::ARMReg R(IRReg preg);
+	// Returns the single lane S register.
+	ArmGen::ARMReg F(IRReg preg);
+	ArmGen::ARMReg FD(IRReg preg);
+	ArmGen::ARMReg FQ(IRReg preg);
+
+protected:
+	const int *GetAllocationOrder(MIPSLoc type, MIPSMap flags, int &count, int &base) const override;
+
+	void LoadNativeReg(IRNativeReg nreg, IRReg first, int lanes) override;
+	void StoreNativeReg(IRNativeReg nreg, IRReg first, int lanes) override;
+	void SetNativeRegValue(IRNativeReg nreg, uint32_t imm) override;
+	void StoreRegValue(IRReg mreg, uint32_t imm) override;
+
+private:
+	IRNativeReg GPRToNativeReg(ArmGen::ARMReg r);
+	IRNativeReg QToNativeReg(ArmGen::ARMReg r);
+	ArmGen::ARMReg FromNativeReg(IRNativeReg r);
+	ArmGen::ARMReg FromNativeRegQ(IRNativeReg r);
+
+	ArmGen::ARMXEmitter *emit_ = nullptr;
+
+	enum {
+		NUM_ARM_REGS = 16,
+		// Only Q0-Q7, since those are the ones that we can address as S regs too.
+		NUM_ARM_QREGS = 8,
+	};
+};
+
+#endif
@@ -94,6 +94,10 @@ void DisassembleArm(const u8 *data, int size);
 
 namespace MIPSComp {
 
+static void JitRoundingGuardFailed(Arm64Jit *jit, u32 pc) {
+	jit->RoundingGuardFailed(pc);
+}
+
 using namespace Arm64JitConstants;
 
 void Arm64Jit::GenerateFixedCode(const JitOptions &jo) {
@@ -294,6 +298,18 @@ void Arm64Jit::GenerateFixedCode(const JitOptions &jo) {
 	STR(INDEX_UNSIGNED, SCRATCH2, SCRATCH1_64, 0);
 	B(quitLoop);
 
+	// Blocks that assumed the default rounding mode jump here (with PC in SCRATCH1) when fcr31 disagrees.
+	roundingGuardFailed = GetCodePtr();
+	MovToPC(SCRATCH1);
+	SaveStaticRegisters();
+	RestoreRoundingMode(true);
+	MOVP2R(X0, this);
+	MovFromPC(W1);
+	QuickCallFunction(SCRATCH1_64, (void *)&JitRoundingGuardFailed);
+	ApplyRoundingMode(true);
+	LoadStaticRegisters();
+	B(dispatcherNoCheck);
+
 	// Generate some integer conversion funcs.
 	// MIPS order!
 	static const RoundingMode roundModes[8] = { ROUND_N, ROUND_Z, ROUND_P, ROUND_M, ROUND_N, ROUND_Z, ROUND_P, ROUND_M };
@@ -699,6 +699,22 @@ void Arm64Jit::Comp_Syscall(MIPSOpcode op)
 	FlushAll();
 
 	SaveStaticRegisters();
+
+	// These normally don't switch threads, so just keep going.  Everything was flushed above.
+	if (!js.inDelaySlot && IsFastSyscall(op)) {
+		MOVI2R(X0, (uintptr_t)GetSyscallFuncPointer(op));
+		QuickCallFunction(X1, (void *)&CallSyscallFast);
+		// Non-zero if it needed the full syscall handling after all, like a reschedule.
+		FixupBranch keepGoing = CBZ(W0);
+		LoadStaticRegisters();
+		ApplyRoundingMode();
+		WriteSyscallExit();
+		SetJumpTarget(keepGoing);
+		LoadStaticRegisters();
+		ApplyRoundingMode();
+		return;
+	}
+
 #ifdef USE_PROFILER
 	// When profiling, we can't skip CallSyscall, since it times syscalls.
 	MOVI2R(W0, op.encoding);
@@ -717,7 +733,6 @@ void Arm64Jit::Comp_Syscall(MIPSOpcode op)
 #endif
 	LoadStaticRegisters();
 	ApplyRoundingMode();
-
 	WriteSyscallExit();
 	js.compiling = false;
 }
@@ -280,7 +280,7 @@ void Arm64Jit::Comp_FPU2op(MIPSOpcode op) {
 
 	case 36: //FsI(fd) = (int)  F(fs);            break; //cvt.w.s
 		fpr.MapDirtyIn(fd, fs);
-		if (js.hasSetRounding) {
+		if (js.RoundingMayVary()) {
 			// We're just going to defer to our cached func.  Here's the arg.
 			fp.FMOV(S0, fpr.R(fs));
 
@@ -382,6 +382,9 @@ void Arm64Jit::Comp_mxc1(MIPSOpcode op)
 			RestoreRoundingMode();
 			bool wasImm = gpr.IsImm(rt);
 			u32 immVal = -1;
+			// From here on, the block can't rely on its entry check.
+			if (!wasImm || (gpr.GetImm(rt) & 0x1000003) != 0)
+				js.blockAssumesDefaultRounding = false;
 			if (wasImm) {
 				immVal = gpr.GetImm(rt);
 				gpr.SetImm(MIPS_REG_FPCOND, (immVal >> 23) & 1);
@@ -235,6 +235,25 @@ void Arm64JitBackend::CompIR_System(IRInst inst) {
 		// This is always followed by an ExitToPC, where we check coreState.
 		break;
 
+	case IROp::SyscallFast:
+	{
+		FlushAll();
+		SaveStaticRegisters();
+
+		WriteDebugProfilerStatus(IRProfilerStatus::SYSCALL);
+		MOVP2R(X0, GetSyscallFuncPointer(MIPSOpcode(inst.constant)));
+		QuickCallFunction(SCRATCH2_64, &CallSyscallFast);
+		FixupBranch keepGoing = CBZ(W0);
+		// It needed the full syscall handling after all (like a reschedule), so exit like ExitToPC.
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		B(dispatcherCheckCoreState_);
+		SetJumpTarget(keepGoing);
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		break;
+	}
+
 	case IROp::CallReplacement:
 		FlushAll();
 		SaveStaticRegisters();
@@ -627,6 +627,61 @@ void Arm64JitBackend::CompIR_VecHoriz(IRInst inst) {
 	}
 }
 
+void Arm64JitBackend::CompIR_VecMatrix(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4MatMul:
+	case IROp::Vec4MatMulTransposed:
+	case IROp::Vec4Transform:
+	{
+		// The columns of src1 are used for every output column, so keep them all mapped.
+		ARM64Reg cols[4];
+		regs_.SpillLockFPR(inst.src1, inst.src1 + 4, inst.src1 + 8, inst.src1 + 12);
+		for (int c = 0; c < 4; ++c)
+			cols[c] = regs_.MapVec4(inst.src1 + c * 4);
+
+		// When transposed, each output column takes a lane from every column of src2.
+		ARM64Reg rows[4]{};
+		bool transposed = inst.op == IROp::Vec4MatMulTransposed;
+		if (transposed) {
+			regs_.SpillLockFPR(inst.src2, inst.src2 + 4, inst.src2 + 8, inst.src2 + 12);
+			for (int c = 0; c < 4; ++c)
+				rows[c] = regs_.MapVec4(inst.src2 + c * 4);
+		}
+
+		// Multiply and add separately (no FMLA), to match the interpreter exactly.
+		int columns = inst.op == IROp::Vec4Transform ? 1 : 4;
+		for (int j = 0; j < columns; ++j) {
+			ARM64Reg t = INVALID_REG;
+			if (!transposed) {
+				regs_.SpillLockFPR(inst.src2 + j * 4);
+				t = regs_.MapVec4(inst.src2 + j * 4);
+			}
+
+			// Transform allows dest to overlap, so accumulate in a scratch reg.
+			ARM64Reg destReg = EncodeRegToQuad(SCRATCHF2);
+			if (inst.op != IROp::Vec4Transform)
+				destReg = regs_.MapVec4(inst.dest + j * 4, MIPSMap::NOINIT);
+
+			fp_.FMUL(32, destReg, cols[0], transposed ? rows[0] : t, transposed ? j : 0);
+			for (int c = 1; c < 4; ++c) {
+				fp_.FMUL(32, EncodeRegToQuad(SCRATCHF1), cols[c], transposed ? rows[c] : t, transposed ? j : c);
+				fp_.FADD(32, destReg, destReg, EncodeRegToQuad(SCRATCHF1));
+			}
+
+			if (inst.op == IROp::Vec4Transform)
+				fp_.MOV(regs_.MapVec4(inst.dest, MIPSMap::NOINIT), destReg);
+		}
+		break;
+	}
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
 void Arm64JitBackend::CompIR_VecPack(IRInst inst) {
 	CONDITIONAL_DISABLE;
 
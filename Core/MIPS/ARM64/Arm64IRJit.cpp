@@ -186,12 +186,46 @@ bool Arm64JitBackend::CompileBlock(IRBlockCache *irBlockCache, int block_num, bo
 	return true;
 }
 
+bool Arm64JitBackend::CompileInterpretedBlock(IRBlockCache *irBlockCache, int block_num) {
+	if (GetSpaceLeft() < 0x800)
+		return false;
+
+	IRBlock *block = irBlockCache->GetBlock(block_num);
+	BeginWrite(64);
+
+	const u8 *blockStart = GetCodePointer();
+	block->SetNativeOffset((int)GetOffset(blockStart));
+	WriteDebugPC(block->GetOriginalStart());
+
+	// The dispatcher already checked downcount, and the IR has the Downcount op.
+	SaveStaticRegisters();
+	WriteDebugProfilerStatus(IRProfilerStatus::IR_INTERPRET);
+	MOVP2R(X0, this);
+	MOVI2R(W1, block_num);
+	QuickCallFunction(SCRATCH2_64, &RunInterpretedBlock);
+	WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+	LoadStaticRegisters();
+	B(dispatcherCheckCoreState_);
+
+	int len = (int)GetOffset(GetCodePointer()) - block->GetNativeOffset();
+	if (len < MIN_BLOCK_NORMAL_LEN)
+		ReserveCodeSpace(MIN_BLOCK_NORMAL_LEN - len);
+
+	// Used for size calc only, we never link to these.
+	SetBlockCheckedOffset(block_num, (int)GetOffset(GetCodePointer()));
+	SetBlockInterpreted(block_num, true);
+
+	EndWrite();
+	FlushIcache();
+	return true;
+}
+
 void Arm64JitBackend::WriteConstExit(uint32_t pc) {
 	int block_num = blocks_.GetBlockNumberFromStartAddress(pc);
 	const IRNativeBlock *nativeBlock = GetNativeBlock(block_num);
 
 	int exitStart = (int)GetOffset(GetCodePointer());
-	if (block_num >= 0 && jo.enableBlocklink && nativeBlock && nativeBlock->checkedOffset != 0) {
+	if (block_num >= 0 && jo.enableBlocklink && nativeBlock && nativeBlock->checkedOffset != 0 && !nativeBlock->interpreted) {
 		B(GetBasePtr() + nativeBlock->checkedOffset);
 	} else {
 		MOVI2R(SCRATCH1, pc);
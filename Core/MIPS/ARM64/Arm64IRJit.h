@@ -41,6 +41,7 @@ class Arm64JitBackend : public Arm64Gen::ARM64CodeBlock, public IRNativeBackend
 
 	void GenerateFixedCode(MIPSState *mipsState) override;
 	bool CompileBlock(IRBlockCache *irBlockCache, int block_num, bool preload) override;
+	bool CompileInterpretedBlock(IRBlockCache *irBlockCache, int block_num) override;
 	void ClearAllBlocks() override;
 	void InvalidateBlock(IRBlockCache *irBlockCache, int block_num) override;
 
@@ -111,6 +112,7 @@ class Arm64JitBackend : public Arm64Gen::ARM64CodeBlock, public IRNativeBackend
 	void CompIR_VecClamp(IRInst inst) override;
 	void CompIR_VecHoriz(IRInst inst) override;
 	void CompIR_VecLoad(IRInst inst) override;
+	void CompIR_VecMatrix(IRInst inst) override;
 	void CompIR_VecPack(IRInst inst) override;
 	void CompIR_VecStore(IRInst inst) override;
 	void CompIR_ValidateAddress(IRInst inst) override;
@@ -20,6 +20,7 @@
 #if PPSSPP_ARCH(ARM64)
 
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
@@ -243,6 +244,7 @@ void Arm64Jit::CompileDelaySlot(int flags) {
 
 void Arm64Jit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
+	TRACE_SCOPE("jit_compile");
 	if (GetSpaceLeft() < 0x10000 || blocks.IsFull()) {
 		INFO_LOG(Log::JIT, "Space left: %d", (int)GetSpaceLeft());
 		ClearCache();
@@ -343,6 +345,20 @@ const u8 *Arm64Jit::DoJit(u32 em_address, JitBlock *b) {
 	}
 
 	b->normalEntry = GetCodePtr();
+
+	// Games that set a rounding mode usually do it briefly, so assume the default where we can.
+	// This avoids switching FPCR around calls and conversions.  If it's wrong, we recompile.
+	js.blockAssumesDefaultRounding = false;
+	if (js.hasSetRounding && (mips_->fcr31 & 0x01000003) == 0 && !roundingGuardFailures_.count(em_address)) {
+		js.blockAssumesDefaultRounding = true;
+		LDR(INDEX_UNSIGNED, SCRATCH1, CTXREG, offsetof(MIPSState, fcr31));
+		ANDI2R(SCRATCH1, SCRATCH1, 0x01000003, SCRATCH2);
+		FixupBranch defaultRounding = CBZ(SCRATCH1);
+		MOVI2R(SCRATCH1, js.blockStart);
+		B((const void *)roundingGuardFailed);
+		SetJumpTarget(defaultRounding);
+	}
+
 	// TODO: this needs work
 	MIPSAnalyst::AnalysisResults analysis; // = MIPSAnalyst::Analyze(em_address);
 
@@ -440,6 +456,8 @@ bool Arm64Jit::DescribeCodePtr(const u8 *ptr, std::string &name) {
 		name = "enterDispatcher";
 	else if (ptr == restoreRoundingMode)
 		name = "restoreRoundingMode";
+	else if (ptr == roundingGuardFailed)
+		name = "roundingGuardFailed";
 	else if (ptr == saveStaticRegisters)
 		name = "saveStaticRegisters";
 	else if (ptr == loadStaticRegisters)
@@ -708,7 +726,7 @@ void Arm64Jit::WriteDownCountR(ARM64Reg reg, bool updateFlags) {
 // Destroys SCRATCH2
 void Arm64Jit::RestoreRoundingMode(bool force) {
 	// If the game has never set an interesting rounding mode, we can safely skip this.
-	if (force || js.hasSetRounding) {
+	if (force || js.RoundingMayVary()) {
 		QuickCallFunction(SCRATCH2_64, restoreRoundingMode);
 	}
 }
@@ -716,7 +734,7 @@ void Arm64Jit::RestoreRoundingMode(bool force) {
 // Destroys SCRATCH1 and SCRATCH2
 void Arm64Jit::ApplyRoundingMode(bool force) {
 	// If the game has never set an interesting rounding mode, we can safely skip this.
-	if (force || js.hasSetRounding) {
+	if (force || js.RoundingMayVary()) {
 		QuickCallFunction(SCRATCH2_64, applyRoundingMode);
 	}
 }
@@ -731,6 +749,16 @@ void Arm64Jit::UpdateRoundingMode(u32 fcr31) {
 	QuickCallFunction(SCRATCH2_64, updateRoundingMode);
 }
 
+void Arm64Jit::RoundingGuardFailed(u32 em_address) {
+	// Called from the guard at the start of the block, so it's safe to throw it away.
+	roundingGuardFailures_.insert(em_address);
+	blocks.InvalidateICache(em_address, 4);
+}
+
+static void JitIdleLoop() {
+	CoreTiming::Idle();
+}
+
 // IDEA - could have a WriteDualExit that takes two destinations and two condition flags,
 // and just have conditional that set PC "twice". This only works when we fall back to dispatcher
 // though, as we need to have the SUBS flag set in the end. So with block linking in the mix,
@@ -740,6 +768,12 @@ void Arm64Jit::WriteExit(u32 destination, int exit_num) {
 	_assert_msg_(exit_num < MAX_JIT_BLOCK_EXITS, "Expected a valid exit_num. dest=%08x", destination);
 
 	// NOTE: Can't blindly check for bad destination addresses here, sometimes exits with bad destinations are written intentionally (like breaks).
+	// Everything is flushed for the exit already, so it's safe to call out here.
+	if (destination == js.blockStart && !jo.Disabled(JitDisable::IDLE_LOOPS) && MIPSAnalyst::IsIdleLoop(destination, GetCompilerPC())) {
+		SaveStaticRegisters();
+		QuickCallFunction(SCRATCH1_64, &JitIdleLoop);
+		LoadStaticRegisters();
+	}
 	WriteDownCount();
 	//If nobody has taken care of this yet (this can be removed when all branches are done)
 	JitBlock *b = js.curBlock;
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <unordered_set>
+
 #include "Common/CPUDetect.h"
 #include "Common/ArmCommon.h"
 #include "Common/Arm64Emitter.h"
@@ -180,6 +182,7 @@ class Arm64Jit : public Arm64Gen::ARM64CodeBlock, public JitInterface, public MI
 	void ClearCache() override;
 	void InvalidateCacheAt(u32 em_address, int length = 4) override;
 	void UpdateFCR31() override;
+	void RoundingGuardFailed(u32 em_address);
 
 	void EatPrefix() override { js.EatPrefix(); }
 
@@ -267,6 +270,8 @@ class Arm64Jit : public Arm64Gen::ARM64CodeBlock, public JitInterface, public MI
 	Arm64Gen::ARM64FloatEmitter fp;
 	
 	MIPSState *mips_;
+	// Blocks that failed their default rounding mode check, and got recompiled without it.
+	std::unordered_set<u32> roundingGuardFailures_;
 
 	int dontLogBlocks;
 	int logBlocks;
@@ -289,6 +294,7 @@ class Arm64Jit : public Arm64Gen::ARM64CodeBlock, public JitInterface, public MI
 	const u8 *restoreRoundingMode;
 	const u8 *applyRoundingMode;
 	const u8 *updateRoundingMode;
+	const u8 *roundingGuardFailed;
 
 	const u8 *crashHandler;
 
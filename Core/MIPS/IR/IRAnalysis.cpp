@@ -49,13 +49,17 @@ bool IRReadsFromFPR(const IRInstMeta &inst, int reg, bool *directly) {
 	if (IRReadsFrom(inst, reg, 'F', directly))
 		return true;
 
-	// We also need to check V and 2.  Indirect reads already checked, don't check again.
+	// We also need to check V, M, and 2.  Indirect reads already checked, don't check again.
 	if (inst.m.types[1] == 'V' && reg >= inst.src1 && reg < inst.src1 + 4)
 		return true;
+	if (inst.m.types[1] == 'M' && reg >= inst.src1 && reg < inst.src1 + 16)
+		return true;
 	if (inst.m.types[1] == '2' && reg >= inst.src1 && reg < inst.src1 + 2)
 		return true;
 	if (inst.m.types[2] == 'V' && reg >= inst.src2 && reg < inst.src2 + 4)
 		return true;
+	if (inst.m.types[2] == 'M' && reg >= inst.src2 && reg < inst.src2 + 16)
+		return true;
 	if (inst.m.types[2] == '2' && reg >= inst.src2 && reg < inst.src2 + 2)
 		return true;
 	if ((inst.m.flags & (IRFLAG_SRC3 | IRFLAG_SRC3DST)) != 0) {
@@ -77,7 +81,7 @@ static int IRReadsFromList(const IRInstMeta &inst, IRReg regs[4], char type) {
 	if ((inst.m.flags & (IRFLAG_SRC3 | IRFLAG_SRC3DST)) != 0 && inst.m.types[0] == type)
 		regs[c++] = inst.src3;
 
-	if (inst.op == IROp::Interpret || inst.op == IROp::CallReplacement || inst.op == IROp::Syscall || inst.op == IROp::Break)
+	if (inst.op == IROp::Interpret || inst.op == IROp::CallReplacement || inst.op == IROp::Syscall || inst.op == IROp::SyscallFast || inst.op == IROp::Break)
 		return -1;
 	if (inst.op == IROp::Breakpoint || inst.op == IROp::MemoryCheck)
 		return -1;
@@ -109,12 +113,14 @@ bool IRWritesToFPR(const IRInstMeta &inst, int reg) {
 		return true;
 	if (inst.m.types[0] == 'V' && reg >= inst.dest && reg < inst.dest + 4)
 		return true;
+	if (inst.m.types[0] == 'M' && reg >= inst.dest && reg < inst.dest + 16)
+		return true;
 	if (inst.m.types[0] == '2' && reg >= inst.dest && reg < inst.dest + 2)
 		return true;
 	return false;
 }
 
-int IRDestFPRs(const IRInstMeta &inst, IRReg regs[4]) {
+int IRDestFPRs(const IRInstMeta &inst, IRReg regs[16]) {
 	// Doesn't write to anything.
 	if ((inst.m.flags & IRFLAG_SRC3) != 0)
 		return 0;
@@ -128,6 +134,11 @@ int IRDestFPRs(const IRInstMeta &inst, IRReg regs[4]) {
 			regs[i] = inst.dest + i;
 		return 4;
 	}
+	if (inst.m.types[0] == 'M') {
+		for (int i = 0; i < 16; ++i)
+			regs[i] = inst.dest + i;
+		return 16;
+	}
 	if (inst.m.types[0] == '2') {
 		for (int i = 0; i < 2; ++i)
 			regs[i] = inst.dest + i;
@@ -140,18 +151,22 @@ int IRReadsFromGPRs(const IRInstMeta &inst, IRReg regs[4]) {
 	return IRReadsFromList(inst, regs, 'G');
 }
 
-int IRReadsFromFPRs(const IRInstMeta &inst, IRReg regs[16]) {
+int IRReadsFromFPRs(const IRInstMeta &inst, IRReg regs[32]) {
 	int c = IRReadsFromList(inst, regs, 'F');
 	if (c != 0)
 		return c;
 
-	// We also need to check V and 2.  Indirect reads already checked, don't check again.
-	if (inst.m.types[1] == 'V' || inst.m.types[1] == '2') {
-		for (int i = 0; i < (inst.m.types[1] == 'V' ? 4 : 2); ++i)
+	auto lanesOf = [](char type) {
+		return type == 'M' ? 16 : (type == 'V' ? 4 : 2);
+	};
+
+	// We also need to check V, M, and 2.  Indirect reads already checked, don't check again.
+	if (inst.m.types[1] == 'V' || inst.m.types[1] == 'M' || inst.m.types[1] == '2') {
+		for (int i = 0; i < lanesOf(inst.m.types[1]); ++i)
 			regs[c++] = inst.src1 + i;
 	}
-	if (inst.m.types[2] == 'V' || inst.m.types[2] == '2') {
-		for (int i = 0; i < (inst.m.types[2] == 'V' ? 4 : 2); ++i)
+	if (inst.m.types[2] == 'V' || inst.m.types[2] == 'M' || inst.m.types[2] == '2') {
+		for (int i = 0; i < lanesOf(inst.m.types[2]); ++i)
 			regs[c++] = inst.src2 + i;
 	}
 	if ((inst.m.flags & (IRFLAG_SRC3 | IRFLAG_SRC3DST)) != 0) {
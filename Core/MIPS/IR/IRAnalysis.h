@@ -47,9 +47,9 @@ bool IRReadsFromGPR(const IRInstMeta &inst, int reg, bool *directly = nullptr);
 bool IRWritesToGPR(const IRInstMeta &inst, int reg);
 bool IRWritesToFPR(const IRInstMeta &inst, int reg);
 int IRDestGPR(const IRInstMeta &inst);
-int IRDestFPRs(const IRInstMeta &inst, IRReg regs[4]);
+int IRDestFPRs(const IRInstMeta &inst, IRReg regs[16]);
 int IRReadsFromGPRs(const IRInstMeta &inst, IRReg regs[4]);
-int IRReadsFromFPRs(const IRInstMeta &inst, IRReg regs[16]);
+int IRReadsFromFPRs(const IRInstMeta &inst, IRReg regs[32]);
 
 struct IRSituation {
 	int lookaheadCount;
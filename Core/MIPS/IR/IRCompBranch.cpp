@@ -54,6 +54,15 @@ using namespace MIPSAnalyst;
 namespace MIPSComp
 {
 
+// Call on the taken path of a branch, right before the exit.
+void IRFrontend::CompIdleLoop(u32 targetAddr) {
+	// Only when the loop is the whole block, so a full pass has run each time we get here.
+	if (targetAddr != js.blockStart || (opts.disableFlags & (uint32_t)JitDisable::IDLE_LOOPS) != 0)
+		return;
+	if (MIPSAnalyst::IsIdleLoop(targetAddr, GetCompilerPC()))
+		ir.Write(IROp::IdleLoop);
+}
+
 void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	if (js.inDelaySlot) {
 		ERROR_LOG_REPORT(Log::JIT, "Branch in RSRTComp delay slot at %08x in block starting at %08x", GetCompilerPC(), js.blockStart);
@@ -114,6 +123,12 @@ void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	}
 
 	FlushAll();
+	CompIdleLoop(targetAddr);
+	if (likely && !branchInfo.delaySlotIsBranch && CanContinueBranch(targetAddr)) {
+		// Likely branches are almost always taken, so keep going on that path.
+		AddContinuedBlock(targetAddr);
+		return;
+	}
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -165,6 +180,12 @@ void IRFrontend::BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink,
 
 	// Taken
 	FlushAll();
+	CompIdleLoop(targetAddr);
+	if (likely && !branchInfo.delaySlotIsBranch && CanContinueBranch(targetAddr)) {
+		// Likely branches are almost always taken, so keep going on that path.
+		AddContinuedBlock(targetAddr);
+		return;
+	}
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -244,6 +265,11 @@ void IRFrontend::BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 	}
 
 	FlushAll();
+	if (likely && !branchInfo.delaySlotIsBranch && CanContinueBranch(targetAddr)) {
+		// Likely branches are almost always taken, so keep going on that path.
+		AddContinuedBlock(targetAddr);
+		return;
+	}
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -306,6 +332,11 @@ void IRFrontend::BranchVFPUFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 
 	// Taken
 	FlushAll();
+	if (likely && !branchInfo.delaySlotIsBranch && CanContinueBranch(targetAddr)) {
+		// Likely branches are almost always taken, so keep going on that path.
+		AddContinuedBlock(targetAddr);
+		return;
+	}
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -362,6 +393,10 @@ void IRFrontend::Comp_Jump(MIPSOpcode op) {
 	js.downcountAmount = 0;
 
 	FlushAll();
+	if (CanContinueJump(targetAddr) && (MIPSGetInfo(GetOffsetInstruction(1)) & DELAYSLOT) == 0) {
+		AddContinuedBlock(targetAddr);
+		return;
+	}
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -446,11 +481,19 @@ void IRFrontend::Comp_Syscall(MIPSOpcode op) {
 
 	FlushAll();
 
+	// These normally don't switch threads, so just keep going.  Everything was flushed above.
+	// If one does after all, SyscallFast exits to PC itself.
+	if (!js.inDelaySlot && IsFastSyscall(op)) {
+		RestoreRoundingMode();
+		ir.Write(IROp::SyscallFast, 0, ir.AddConstant(op.encoding));
+		ApplyRoundingMode();
+		return;
+	}
+
 	RestoreRoundingMode();
 	ir.Write(IROp::Syscall, 0, ir.AddConstant(op.encoding));
 	ApplyRoundingMode();
 	ir.Write(IROp::ExitToPC);
-
 	js.compiling = false;
 }
 
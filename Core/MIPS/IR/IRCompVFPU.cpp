@@ -1570,9 +1570,25 @@ namespace MIPSComp {
 
 		// dregs are always consecutive, thanks to our transpose trick.
 		// However, not sure this is always worth it.
+		if (IsMatrixVec4(sz, dregs) && opts.preferVec4Matrix) {
+			// A transposed S is just four columns, which is what the matrix ops want.
+			if (!IsMatrixVec4(sz, sregs)) {
+				IROp matOp = IsMatrixVec4(sz, tregs) ? IROp::Vec4MatMul : IROp::Vec4MatMulTransposed;
+				ir.Write(matOp, dregs[0], sregs[0], tregs[0]);
+				return;
+			} else if (!IsMatrixVec4(sz, tregs)) {
+				// ABc: here Dt = Tt * S has the right layout, so compute that and transpose on the way out.
+				// This uses all 16 vtemps, which is fine since there are no prefixes.
+				ir.Write(IROp::Vec4MatMul, IRVTEMP_PFX_S, tregs[0], sregs[0]);
+				u8 dtregs[16];
+				GetMatrixRegs(dtregs, sz, TransposeMatrixReg(vd));
+				for (int i = 0; i < 16; i++)
+					ir.Write(IROp::FMov, dtregs[i], IRVTEMP_PFX_S + i);
+				return;
+			}
+		}
+
 		if (IsMatrixVec4(sz, dregs)) {
-			// TODO: The interpreter would like proper matrix ops better. Can generate those, and
-			// expand them like this as needed on "real" architectures.
 			int s0 = IRVTEMP_0;
 			int s1 = IRVTEMP_PFX_T;
 			if (!IsMatrixVec4(sz, sregs)) {
@@ -1652,7 +1668,26 @@ namespace MIPSComp {
 		GetVectorRegs(dregs, sz, _VD);
 
 		// SIMD-optimized implementations - if sregs[0..3] is non-consecutive, it's transposed.
-		if (msz == M_4x4 && !IsMatrixVec4(msz, sregs)) {
+		if (msz == M_4x4 && !IsMatrixVec4(msz, sregs) && opts.preferVec4Matrix) {
+			// The transposed matrix is four consecutive columns, so this is a single transform.
+			IRReg t = tregs[0];
+			if (homogenous || !IsVec4(sz, tregs)) {
+				t = IRVTEMP_PFX_T;
+				if (homogenous)
+					ir.Write(IROp::Vec4Init, t, (int)Vec4Init::AllONE);
+				for (int i = 0; i < (homogenous ? 3 : 4); i++)
+					ir.Write(IROp::FMov, t + i, tregs[i]);
+			}
+			ir.Write(IROp::Vec4Transform, IRVTEMP_0, sregs[0], t);
+			if (IsVec4(sz, dregs)) {
+				ir.Write(IROp::Vec4Mov, dregs[0], IRVTEMP_0);
+			} else {
+				for (int i = 0; i < 4; i++) {
+					ir.Write(IROp::FMov, dregs[i], IRVTEMP_0 + i);
+				}
+			}
+			return;
+		} else if (msz == M_4x4 && !IsMatrixVec4(msz, sregs)) {
 			int s0 = IRVTEMP_0;
 			int s1 = IRVTEMP_PFX_S;
 			// For this algorithm, we don't care if tregs are consecutive or not,
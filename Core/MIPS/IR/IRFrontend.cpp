@@ -30,6 +30,7 @@
 #include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/MIPSTracer.h"
 
+#include <algorithm>
 #include <iterator>
 
 namespace MIPSComp {
@@ -117,6 +118,52 @@ void IRFrontend::CompileDelaySlot() {
 	js.inDelaySlot = false;
 }
 
+// Traces only go forward, so the block's range still covers everything it compiled.
+// Skipped code inside the range can cause extra invalidations, so keep it short.
+static const u32 MAX_CONTINUE_RANGE = 0x400;
+// When following a whole function, the range is its end instead.
+static const u32 MAX_FUNCTION_REGION = 0x4000;
+
+u32 IRFrontend::GetContinueLimit(u32 em_address) const {
+	if (opts.functionRegions && g_symbolMap) {
+		u32 funcStart = g_symbolMap->GetFunctionStart(em_address);
+		if (funcStart != SymbolMap::INVALID_ADDRESS) {
+			u32 funcSize = g_symbolMap->GetFunctionSize(funcStart);
+			if (funcSize != SymbolMap::INVALID_ADDRESS && funcStart + funcSize > em_address)
+				return em_address + std::min(funcStart + funcSize - em_address, MAX_FUNCTION_REGION);
+		}
+	}
+	return em_address + MAX_CONTINUE_RANGE;
+}
+
+bool IRFrontend::CanContinueBranch(u32 targetAddr) const {
+	if (!opts.continueBranches || js.numInstructions >= opts.continueMaxInstructions)
+		return false;
+	// The tracer logs blocks by their range, so it'd see the skipped instructions.
+	if (mipsTracer.tracing_enabled)
+		return false;
+	// Must be past the delay slot.
+	if (targetAddr <= js.compilerPC + 4 || targetAddr >= continueLimit_)
+		return false;
+	return Memory::IsValidAddress(targetAddr);
+}
+
+bool IRFrontend::CanContinueJump(u32 targetAddr) const {
+	if (!opts.continueJumps || js.numInstructions >= opts.continueMaxInstructions)
+		return false;
+	if (mipsTracer.tracing_enabled)
+		return false;
+	if (targetAddr <= js.compilerPC + 4 || targetAddr >= continueLimit_)
+		return false;
+	return Memory::IsValidAddress(targetAddr);
+}
+
+void IRFrontend::AddContinuedBlock(u32 dest) {
+	// DoJit() will advance past this, onto dest.
+	js.compilerPC = dest - 4;
+	js.lastContinuedPC = dest;
+}
+
 bool IRFrontend::CheckRounding(u32 blockAddress) {
 	bool cleanSlate = false;
 	if (js.hasSetRounding && !js.lastSetRounding) {
@@ -255,6 +302,8 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 	js.inDelaySlot = false;
 	js.PrefixStart();
 	ir.Clear();
+	if (opts.continueBranches || opts.continueJumps)
+		continueLimit_ = GetContinueLimit(em_address);
 
 	js.numInstructions = 0;
 	while (js.compiling) {
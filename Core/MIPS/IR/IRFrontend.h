@@ -98,6 +98,23 @@ class IRFrontend : public MIPSFrontendInterface {
 	void SetOptions(const IROptions &o) {
 		opts = o;
 	}
+	const IROptions &GetOptions() const {
+		return opts;
+	}
+
+	// Compile-time state that affects the generated IR.
+	bool HasSetRounding() const {
+		return js.hasSetRounding;
+	}
+	bool StartsWithDefaultPrefix() const {
+		return js.startDefaultPrefix;
+	}
+	// For background compiles, to match the state of the main frontend.
+	void SetCompileState(bool startDefaultPrefix, bool hasSetRounding) {
+		js.startDefaultPrefix = startDefaultPrefix;
+		js.hasSetRounding = hasSetRounding;
+		js.lastSetRounding = hasSetRounding;
+	}
 
 private:
 	void RestoreRoundingMode(bool force = false);
@@ -109,6 +126,11 @@ class IRFrontend : public MIPSFrontendInterface {
 
 	u32 GetCompilerPC();
 	void CompileDelaySlot();
+	u32 GetContinueLimit(u32 em_address) const;
+	bool CanContinueBranch(u32 targetAddr) const;
+	void CompIdleLoop(u32 targetAddr);
+	bool CanContinueJump(u32 targetAddr) const;
+	void AddContinuedBlock(u32 dest);
 	void EatInstruction(MIPSOpcode op);
 	MIPSOpcode GetOffsetInstruction(int offset);
 
@@ -138,6 +160,8 @@ class IRFrontend : public MIPSFrontendInterface {
 	JitState js;
 	IRWriter ir;
 	IROptions opts{};
+	// Blocks may continue to targets below this.
+	u32 continueLimit_ = 0;
 
 	int dontLogBlocks = 0;
 	int logBlocks = 0;
@@ -82,6 +82,7 @@ static const IRMeta irMeta[] = {
 	{ IROp::Load16, "Load16", "GGC" },
 	{ IROp::Load16Ext, "Load16Ext", "GGC" },
 	{ IROp::Load32, "Load32", "GGC" },
+	{ IROp::OptLoad32AddConst, "OptLoad32AddConst", "GGGC" },
 	{ IROp::Load32Left, "Load32Left", "GGC", IRFLAG_SRC3DST },
 	{ IROp::Load32Right, "Load32Right", "GGC", IRFLAG_SRC3DST },
 	{ IROp::Load32Linked, "Load32Linked", "GGC" },
@@ -150,6 +151,9 @@ static const IRMeta irMeta[] = {
 	{ IROp::Vec4Dot, "Vec4Dot", "FVV" },
 	{ IROp::Vec4Neg, "Vec4Neg", "VV" },
 	{ IROp::Vec4Abs, "Vec4Abs", "VV" },
+	{ IROp::Vec4MatMul, "Vec4MatMul", "MMM" },
+	{ IROp::Vec4MatMulTransposed, "Vec4MatMulTransposed", "MMM" },
+	{ IROp::Vec4Transform, "Vec4Transform", "VMV" },
 
 		// Pack/Unpack
 	{ IROp::Vec2Unpack16To31, "Vec2Unpack16To31", "2F" },  // Note that the result is shifted down by 1, hence 31
@@ -174,9 +178,15 @@ static const IRMeta irMeta[] = {
 	{ IROp::ExitToConstIfGeZ, "ExitIfGeZ", "CG", IRFLAG_EXIT },
 	{ IROp::ExitToConstIfLeZ, "ExitIfLeZ", "CG", IRFLAG_EXIT },
 	{ IROp::ExitToConstIfLtZ, "ExitIfLtZ", "CG", IRFLAG_EXIT },
+	{ IROp::OptSltExitIfNonZero, "OptSltExitIfNonZero", "GGGC", IRFLAG_EXIT },
+	{ IROp::OptSltExitIfZero, "OptSltExitIfZero", "GGGC", IRFLAG_EXIT },
+	{ IROp::OptSltUExitIfNonZero, "OptSltUExitIfNonZero", "GGGC", IRFLAG_EXIT },
+	{ IROp::OptSltUExitIfZero, "OptSltUExitIfZero", "GGGC", IRFLAG_EXIT },
 	{ IROp::ExitToReg, "ExitToReg", "_G", IRFLAG_EXIT },
 	{ IROp::Syscall, "Syscall", "_C", IRFLAG_EXIT },
+	{ IROp::SyscallFast, "SyscallFast", "_C", IRFLAG_EXIT },
 	{ IROp::Break, "Break", "", IRFLAG_EXIT },
+	{ IROp::IdleLoop, "IdleLoop", "", IRFLAG_BARRIER },
 	{ IROp::SetPC, "SetPC", "_G" },
 	{ IROp::SetPCConst, "SetPC", "_C" },
 	{ IROp::CallReplacement, "CallRepl", "Gr", IRFLAG_BARRIER },
@@ -305,6 +315,13 @@ void DisassembleParam(char *buf, int bufSize, u8 param, char type, u32 constant)
 			snprintf(buf, bufSize, "f%d..f%d", param, param + 3);
 		}
 		break;
+	case 'M':
+		if (param >= 32) {
+			snprintf(buf, bufSize, "vf%d..vf%d", param - 32, param - 32 + 15);
+		} else {
+			snprintf(buf, bufSize, "f%d..f%d", param, param + 15);
+		}
+		break;
 	case '2':
 		if (param >= 32) {
 			snprintf(buf, bufSize, "vf%d,vf%d", param - 32, param - 32 + 1);
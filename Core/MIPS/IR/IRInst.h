@@ -95,6 +95,8 @@ enum class IROp : uint8_t {
 	Load16,
 	Load16Ext,
 	Load32,
+	// Load32 to dest, then src2 += the high 16 bits of the constant.  Offset is the low 16 bits.
+	OptLoad32AddConst,
 	Load32Left,
 	Load32Right,
 	Load32Linked,
@@ -182,6 +184,11 @@ enum class IROp : uint8_t {
 	Vec4Neg,
 	Vec4Abs,
 
+	// 4x4 matrices, as 16 consecutive regs (4 vec4 columns.)  Only Vec4Transform allows dest to overlap sources.
+	Vec4MatMul,  // dest = src1 * src2
+	Vec4MatMulTransposed,  // dest = src1 * transpose(src2)
+	Vec4Transform,  // dest (vec4) = src1 * src2 (vec4)
+
 	// vx2i
 	Vec2Unpack16To31,  // Note that the result is shifted down by 1, hence 31
 	Vec2Unpack16To32,
@@ -217,16 +224,23 @@ enum class IROp : uint8_t {
 	ExitToConstIfGeZ,  // const, reg1, 0
 	ExitToConstIfLtZ,  // const, reg1, 0
 	ExitToConstIfLeZ,  // const, reg1, 0
+	// Slt/SltU to dest, then exit to const based on the result.  Interpreter only.
+	OptSltExitIfNonZero,
+	OptSltExitIfZero,
+	OptSltUExitIfNonZero,
+	OptSltUExitIfZero,
 
 	ExitToConstIfFpTrue,
 	ExitToConstIfFpFalse,
 	ExitToPC,  // Used after a syscall to give us a way to do things before returning.
 
 	Syscall,
+	SyscallFast,  // HLE_FAST_CALL, exits to PC only if it needed more (like a reschedule.)
 	SetPC,  // hack to make syscall returns work
 	SetPCConst,  // hack to make replacement know PC
 	CallReplacement,
 	Break,
+	IdleLoop,  // Skips ahead to the next event.
 
 	// Debugging breakpoints.
 	Breakpoint,
@@ -418,7 +432,14 @@ struct IROptions {
 	bool unalignedLoadStoreVec4;
 	bool preferVec4;
 	bool preferVec4Dot;
+	bool preferVec4Matrix;
 	bool optimizeForInterpreter;
+	// Compile through forward jumps and likely branches, up to continueMaxInstructions.
+	bool continueBranches;
+	bool continueJumps;
+	int continueMaxInstructions;
+	// Allow continuing anywhere forward within the analyzed function, so hot functions become one block.
+	bool functionRegions;
 };
 
 const IRMeta *GetIRMeta(IROp op);
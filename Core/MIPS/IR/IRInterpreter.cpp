@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 #include "ppsspp_config.h"
@@ -50,6 +51,36 @@ alignas(16) static const uint32_t lowBytesMask[4] = {
 	0x000000FF, 0x000000FF, 0x000000FF, 0x000000FF,
 };
 
+// Each column of dest is the columns of m scaled by a column of v (a row if transposed), and summed.
+// Not fused, and in the same order as separate Vec4Scale/Vec4Add ops, so the results match exactly.
+static void IRMatrixMultiply(float *dest, const float *m, const float *v, int columns, bool transposed) {
+	for (int j = 0; j < columns; j++) {
+		// Read these first, they may overlap dest for Vec4Transform.
+		float t[4];
+		for (int c = 0; c < 4; c++)
+			t[c] = transposed ? v[c * 4 + j] : v[j * 4 + c];
+#if defined(_M_SSE)
+		__m128 sum = _mm_mul_ps(_mm_load_ps(&m[0]), _mm_set1_ps(t[0]));
+		for (int c = 1; c < 4; c++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(&m[c * 4]), _mm_set1_ps(t[c])));
+		_mm_store_ps(&dest[j * 4], sum);
+#elif PPSSPP_ARCH(ARM_NEON)
+		float32x4_t sum = vmulq_n_f32(vld1q_f32(&m[0]), t[0]);
+		for (int c = 1; c < 4; c++)
+			sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(&m[c * 4]), t[c]));
+		vst1q_f32(&dest[j * 4], sum);
+#else
+		float sum[4];
+		for (int i = 0; i < 4; i++) {
+			sum[i] = m[i] * t[0];
+			for (int c = 1; c < 4; c++)
+				sum[i] += m[c * 4 + i] * t[c];
+		}
+		memcpy(&dest[j * 4], sum, sizeof(sum));
+#endif
+	}
+}
+
 u32 IRRunBreakpoint(u32 pc) {
 	// Should we skip this breakpoint?
 	uint32_t skipFirst = g_breakpoints.CheckSkipFirst();
@@ -137,57 +168,149 @@ void IRRestoreRounding() {
 }
 
 // We cannot use NEON on ARM32 here until we make it a hard dependency. We can, however, on ARM64.
+// With computed goto, each handler jumps straight to the next one, so the host can predict
+// each of those jumps separately, instead of all going through the one at the top of the switch.
+// Only the common ops get a label, the rest go through the switch as before.
+// Define IR_SWITCH_DISPATCH to compare against the plain switch.
+#if defined(__GNUC__) && !defined(_DEBUG) && !defined(IR_SWITCH_DISPATCH)
+#define IR_THREADED_DISPATCH
+#endif
+
+#ifdef IR_THREADED_DISPATCH
+#define IR_HOT(name) case IROp::name: op_##name
+#define IR_NEXT() { inst++; goto *dispatchTable[(int)inst->op]; }
+#else
+#define IR_HOT(name) case IROp::name
+#define IR_NEXT() break
+#endif
+
 u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
+#ifdef IR_THREADED_DISPATCH
+	static const void *dispatchTable[256];
+	static std::atomic<bool> dispatchReady{};
+	if (!dispatchReady.load(std::memory_order_acquire)) {
+		// Always filled with the same values, so it doesn't matter if two threads race here.
+		for (auto &target : dispatchTable)
+			target = &&dispatch_switch;
+#define IR_HOT_TARGET(name) dispatchTable[(int)IROp::name] = &&op_##name
+		IR_HOT_TARGET(SetConst);
+		IR_HOT_TARGET(Add);
+		IR_HOT_TARGET(Sub);
+		IR_HOT_TARGET(And);
+		IR_HOT_TARGET(Or);
+		IR_HOT_TARGET(Xor);
+		IR_HOT_TARGET(Mov);
+		IR_HOT_TARGET(AddConst);
+		IR_HOT_TARGET(OptAddConst);
+		IR_HOT_TARGET(SubConst);
+		IR_HOT_TARGET(AndConst);
+		IR_HOT_TARGET(OptAndConst);
+		IR_HOT_TARGET(OrConst);
+		IR_HOT_TARGET(OptOrConst);
+		IR_HOT_TARGET(XorConst);
+		IR_HOT_TARGET(Load8);
+		IR_HOT_TARGET(Load8Ext);
+		IR_HOT_TARGET(Load16);
+		IR_HOT_TARGET(Load16Ext);
+		IR_HOT_TARGET(Load32);
+		IR_HOT_TARGET(OptLoad32AddConst);
+		IR_HOT_TARGET(LoadFloat);
+		IR_HOT_TARGET(Store8);
+		IR_HOT_TARGET(Store16);
+		IR_HOT_TARGET(Store32);
+		IR_HOT_TARGET(StoreFloat);
+		IR_HOT_TARGET(ShlImm);
+		IR_HOT_TARGET(ShrImm);
+		IR_HOT_TARGET(SarImm);
+		IR_HOT_TARGET(Shl);
+		IR_HOT_TARGET(Shr);
+		IR_HOT_TARGET(Sar);
+		IR_HOT_TARGET(Slt);
+		IR_HOT_TARGET(SltU);
+		IR_HOT_TARGET(SltConst);
+		IR_HOT_TARGET(SltUConst);
+		IR_HOT_TARGET(MovZ);
+		IR_HOT_TARGET(MovNZ);
+		IR_HOT_TARGET(MfLo);
+		IR_HOT_TARGET(MfHi);
+		IR_HOT_TARGET(FAdd);
+		IR_HOT_TARGET(FSub);
+		IR_HOT_TARGET(FMov);
+		IR_HOT_TARGET(FMovFromGPR);
+		IR_HOT_TARGET(FMovToGPR);
+		IR_HOT_TARGET(OptFCvtSWFromGPR);
+		IR_HOT_TARGET(ExitToConst);
+		IR_HOT_TARGET(ExitToConstIfEq);
+		IR_HOT_TARGET(ExitToConstIfNeq);
+		IR_HOT_TARGET(ExitToConstIfGtZ);
+		IR_HOT_TARGET(ExitToConstIfGeZ);
+		IR_HOT_TARGET(ExitToConstIfLtZ);
+		IR_HOT_TARGET(ExitToConstIfLeZ);
+		IR_HOT_TARGET(OptSltExitIfNonZero);
+		IR_HOT_TARGET(OptSltExitIfZero);
+		IR_HOT_TARGET(OptSltUExitIfNonZero);
+		IR_HOT_TARGET(OptSltUExitIfZero);
+		IR_HOT_TARGET(Downcount);
+		IR_HOT_TARGET(SetPCConst);
+#undef IR_HOT_TARGET
+		dispatchReady.store(true, std::memory_order_release);
+	}
+	goto *dispatchTable[(int)inst->op];
+#endif
+
 	while (true) {
+#ifdef IR_THREADED_DISPATCH
+dispatch_switch:
+#endif
 		switch (inst->op) {
-		case IROp::SetConst:
+		IR_HOT(SetConst):
 			mips->r[inst->dest] = inst->constant;
-			break;
+			IR_NEXT();
 		case IROp::SetConstF:
 			memcpy(&mips->f[inst->dest], &inst->constant, 4);
 			break;
-		case IROp::Add:
+		IR_HOT(Add):
 			mips->r[inst->dest] = mips->r[inst->src1] + mips->r[inst->src2];
-			break;
-		case IROp::Sub:
+			IR_NEXT();
+		IR_HOT(Sub):
 			mips->r[inst->dest] = mips->r[inst->src1] - mips->r[inst->src2];
-			break;
-		case IROp::And:
+			IR_NEXT();
+		IR_HOT(And):
 			mips->r[inst->dest] = mips->r[inst->src1] & mips->r[inst->src2];
-			break;
-		case IROp::Or:
+			IR_NEXT();
+		IR_HOT(Or):
 			mips->r[inst->dest] = mips->r[inst->src1] | mips->r[inst->src2];
-			break;
-		case IROp::Xor:
+			IR_NEXT();
+		IR_HOT(Xor):
 			mips->r[inst->dest] = mips->r[inst->src1] ^ mips->r[inst->src2];
-			break;
-		case IROp::Mov:
+			IR_NEXT();
+		IR_HOT(Mov):
 			mips->r[inst->dest] = mips->r[inst->src1];
-			break;
-		case IROp::AddConst:
+			IR_NEXT();
+		IR_HOT(AddConst):
 			mips->r[inst->dest] = mips->r[inst->src1] + inst->constant;
-			break;
-		case IROp::OptAddConst:  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
+			IR_NEXT();
+		IR_HOT(OptAddConst):  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
 			mips->r[inst->dest] += inst->constant;
-			break;
-		case IROp::SubConst:
+			IR_NEXT();
+		IR_HOT(SubConst):
 			mips->r[inst->dest] = mips->r[inst->src1] - inst->constant;
-			break;
-		case IROp::AndConst:
+			IR_NEXT();
+		IR_HOT(AndConst):
 			mips->r[inst->dest] = mips->r[inst->src1] & inst->constant;
-			break;
-		case IROp::OptAndConst:  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
+			IR_NEXT();
+		IR_HOT(OptAndConst):  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
 			mips->r[inst->dest] &= inst->constant;
-			break;
-		case IROp::OrConst:
+			IR_NEXT();
+		IR_HOT(OrConst):
 			mips->r[inst->dest] = mips->r[inst->src1] | inst->constant;
-			break;
-		case IROp::OptOrConst:
+			IR_NEXT();
+		IR_HOT(OptOrConst):
 			mips->r[inst->dest] |= inst->constant;
-			break;
-		case IROp::XorConst:
+			IR_NEXT();
+		IR_HOT(XorConst):
 			mips->r[inst->dest] = mips->r[inst->src1] ^ inst->constant;
-			break;
+			IR_NEXT();
 		case IROp::Neg:
 			mips->r[inst->dest] = (u32)(-(s32)mips->r[inst->src1]);
 			break;
@@ -204,21 +327,21 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			mips->r[inst->dest] = ReverseBits32(mips->r[inst->src1]);
 			break;
 
-		case IROp::Load8:
+		IR_HOT(Load8):
 			mips->r[inst->dest] = Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Load8Ext:
+			IR_NEXT();
+		IR_HOT(Load8Ext):
 			mips->r[inst->dest] = SignExtend8ToU32(Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant));
-			break;
-		case IROp::Load16:
+			IR_NEXT();
+		IR_HOT(Load16):
 			mips->r[inst->dest] = Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Load16Ext:
+			IR_NEXT();
+		IR_HOT(Load16Ext):
 			mips->r[inst->dest] = SignExtend16ToU32(Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant));
-			break;
-		case IROp::Load32:
+			IR_NEXT();
+		IR_HOT(Load32):
 			mips->r[inst->dest] = Memory::ReadUnchecked_U32(mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT();
 		case IROp::Load32Left:
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
@@ -242,19 +365,23 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 				mips->r[inst->dest] = Memory::ReadUnchecked_U32(mips->r[inst->src1] + inst->constant);
 			mips->llBit = 1;
 			break;
-		case IROp::LoadFloat:
+		IR_HOT(OptLoad32AddConst):
+			mips->r[inst->dest] = Memory::ReadUnchecked_U32(mips->r[inst->src1] + (s16)(inst->constant & 0xFFFF));
+			mips->r[inst->src2] += (s32)inst->constant >> 16;
+			IR_NEXT();
+		IR_HOT(LoadFloat):
 			mips->f[inst->dest] = Memory::ReadUnchecked_Float(mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT();
 
-		case IROp::Store8:
+		IR_HOT(Store8):
 			Memory::WriteUnchecked_U8(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Store16:
+			IR_NEXT();
+		IR_HOT(Store16):
 			Memory::WriteUnchecked_U16(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Store32:
+			IR_NEXT();
+		IR_HOT(Store32):
 			Memory::WriteUnchecked_U32(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT();
 		case IROp::Store32Left:
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
@@ -285,9 +412,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 				mips->r[inst->dest] = 0;
 			}
 			break;
-		case IROp::StoreFloat:
+		IR_HOT(StoreFloat):
 			Memory::WriteUnchecked_Float(mips->f[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT();
 
 		case IROp::LoadVec4:
 		{
@@ -413,6 +540,15 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
+		case IROp::Vec4MatMul:
+		case IROp::Vec4MatMulTransposed:
+			IRMatrixMultiply(&mips->f[inst->dest], &mips->f[inst->src1], &mips->f[inst->src2], 4, inst->op == IROp::Vec4MatMulTransposed);
+			break;
+
+		case IROp::Vec4Transform:
+			IRMatrixMultiply(&mips->f[inst->dest], &mips->f[inst->src1], &mips->f[inst->src2], 1, false);
+			break;
+
 		case IROp::Vec4Neg:
 		{
 #if defined(_M_SSE)
@@ -649,15 +785,15 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			mips->f[inst->dest] = vfpu_asin(mips->f[inst->src1]);
 			break;
 
-		case IROp::ShlImm:
+		IR_HOT(ShlImm):
 			mips->r[inst->dest] = mips->r[inst->src1] << (int)inst->src2;
-			break;
-		case IROp::ShrImm:
+			IR_NEXT();
+		IR_HOT(ShrImm):
 			mips->r[inst->dest] = mips->r[inst->src1] >> (int)inst->src2;
-			break;
-		case IROp::SarImm:
+			IR_NEXT();
+		IR_HOT(SarImm):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] >> (int)inst->src2;
-			break;
+			IR_NEXT();
 		case IROp::RorImm:
 		{
 			u32 x = mips->r[inst->src1];
@@ -666,15 +802,15 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 		}
 		break;
 
-		case IROp::Shl:
+		IR_HOT(Shl):
 			mips->r[inst->dest] = mips->r[inst->src1] << (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Shr:
+			IR_NEXT();
+		IR_HOT(Shr):
 			mips->r[inst->dest] = mips->r[inst->src1] >> (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Sar:
+			IR_NEXT();
+		IR_HOT(Sar):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] >> (mips->r[inst->src2] & 31);
-			break;
+			IR_NEXT();
 		case IROp::Ror:
 		{
 			u32 x = mips->r[inst->src1];
@@ -689,30 +825,30 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::Slt:
+		IR_HOT(Slt):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)mips->r[inst->src2];
-			break;
+			IR_NEXT();
 
-		case IROp::SltU:
+		IR_HOT(SltU):
 			mips->r[inst->dest] = mips->r[inst->src1] < mips->r[inst->src2];
-			break;
+			IR_NEXT();
 
-		case IROp::SltConst:
+		IR_HOT(SltConst):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)inst->constant;
-			break;
+			IR_NEXT();
 
-		case IROp::SltUConst:
+		IR_HOT(SltUConst):
 			mips->r[inst->dest] = mips->r[inst->src1] < inst->constant;
-			break;
+			IR_NEXT();
 
-		case IROp::MovZ:
+		IR_HOT(MovZ):
 			if (mips->r[inst->src1] == 0)
 				mips->r[inst->dest] = mips->r[inst->src2];
-			break;
-		case IROp::MovNZ:
+			IR_NEXT();
+		IR_HOT(MovNZ):
 			if (mips->r[inst->src1] != 0)
 				mips->r[inst->dest] = mips->r[inst->src2];
-			break;
+			IR_NEXT();
 
 		case IROp::Max:
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] > (s32)mips->r[inst->src2] ? mips->r[inst->src1] : mips->r[inst->src2];
@@ -727,12 +863,12 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 		case IROp::MtHi:
 			mips->hi = mips->r[inst->src1];
 			break;
-		case IROp::MfLo:
+		IR_HOT(MfLo):
 			mips->r[inst->dest] = mips->lo;
-			break;
-		case IROp::MfHi:
+			IR_NEXT();
+		IR_HOT(MfHi):
 			mips->r[inst->dest] = mips->hi;
-			break;
+			IR_NEXT();
 
 		case IROp::Mult:
 		{
@@ -822,12 +958,12 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::FAdd:
+		IR_HOT(FAdd):
 			mips->f[inst->dest] = mips->f[inst->src1] + mips->f[inst->src2];
-			break;
-		case IROp::FSub:
+			IR_NEXT();
+		IR_HOT(FSub):
 			mips->f[inst->dest] = mips->f[inst->src1] - mips->f[inst->src2];
-			break;
+			IR_NEXT();
 		case IROp::FMul:
 #if 1
 		{
@@ -882,9 +1018,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			}
 			break;
 
-		case IROp::FMov:
+		IR_HOT(FMov):
 			mips->f[inst->dest] = mips->f[inst->src1];
-			break;
+			IR_NEXT();
 		case IROp::FAbs:
 			mips->f[inst->dest] = fabsf(mips->f[inst->src1]);
 			break;
@@ -1071,15 +1207,15 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::FMovFromGPR:
+		IR_HOT(FMovFromGPR):
 			memcpy(&mips->f[inst->dest], &mips->r[inst->src1], 4);
-			break;
-		case IROp::OptFCvtSWFromGPR:
+			IR_NEXT();
+		IR_HOT(OptFCvtSWFromGPR):
 			mips->f[inst->dest] = (float)(int)mips->r[inst->src1];
-			break;
-		case IROp::FMovToGPR:
+			IR_NEXT();
+		IR_HOT(FMovToGPR):
 			memcpy(&mips->r[inst->dest], &mips->f[inst->src1], 4);
-			break;
+			IR_NEXT();
 		case IROp::OptFMovToGPRShr8:
 		{
 			u32 temp;
@@ -1088,48 +1224,69 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::ExitToConst:
+		IR_HOT(ExitToConst):
 			return inst->constant;
 
 		case IROp::ExitToReg:
 			return mips->r[inst->src1];
 
-		case IROp::ExitToConstIfEq:
+		IR_HOT(ExitToConstIfEq):
 			if (mips->r[inst->src1] == mips->r[inst->src2])
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfNeq:
+			IR_NEXT();
+		IR_HOT(ExitToConstIfNeq):
 			if (mips->r[inst->src1] != mips->r[inst->src2])
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfGtZ:
+			IR_NEXT();
+		IR_HOT(ExitToConstIfGtZ):
 			if ((s32)mips->r[inst->src1] > 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfGeZ:
+			IR_NEXT();
+		IR_HOT(ExitToConstIfGeZ):
 			if ((s32)mips->r[inst->src1] >= 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfLtZ:
+			IR_NEXT();
+		IR_HOT(ExitToConstIfLtZ):
 			if ((s32)mips->r[inst->src1] < 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfLeZ:
+			IR_NEXT();
+		IR_HOT(ExitToConstIfLeZ):
 			if ((s32)mips->r[inst->src1] <= 0)
 				return inst->constant;
-			break;
+			IR_NEXT();
+
+		IR_HOT(OptSltExitIfNonZero):
+			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)mips->r[inst->src2];
+			if (mips->r[inst->dest] != 0)
+				return inst->constant;
+			IR_NEXT();
+		IR_HOT(OptSltExitIfZero):
+			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)mips->r[inst->src2];
+			if (mips->r[inst->dest] == 0)
+				return inst->constant;
+			IR_NEXT();
+		IR_HOT(OptSltUExitIfNonZero):
+			mips->r[inst->dest] = mips->r[inst->src1] < mips->r[inst->src2];
+			if (mips->r[inst->dest] != 0)
+				return inst->constant;
+			IR_NEXT();
+		IR_HOT(OptSltUExitIfZero):
+			mips->r[inst->dest] = mips->r[inst->src1] < mips->r[inst->src2];
+			if (mips->r[inst->dest] == 0)
+				return inst->constant;
+			IR_NEXT();
 
-		case IROp::Downcount:
+		IR_HOT(Downcount):
 			mips->downcount -= (int)inst->constant;
-			break;
+			IR_NEXT();
 
 		case IROp::SetPC:
 			mips->pc = mips->r[inst->src1];
 			break;
 
-		case IROp::SetPCConst:
+		IR_HOT(SetPCConst):
 			mips->pc = inst->constant;
-			break;
+			IR_NEXT();
 
 		case IROp::Syscall:
 			// IROp::SetPC was (hopefully) executed before.
@@ -1141,6 +1298,18 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
+		case IROp::SyscallFast:
+		{
+			MIPSOpcode op(inst->constant);
+			if (CallSyscallFast(GetSyscallFuncPointer(op))) {
+				// It needed the full syscall handling after all, so act like ExitToPC.
+				if (coreState != CORE_RUNNING_CPU)
+					CoreTiming::ForceCheck();
+				return mips->pc;
+			}
+			break;
+		}
+
 		case IROp::ExitToPC:
 			return mips->pc;
 
@@ -1187,6 +1356,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			Core_BreakException(mips->pc);
 			return mips->pc + 4;
 
+		case IROp::IdleLoop:
+			CoreTiming::Idle();
+			break;
+
 		case IROp::Breakpoint:
 			if (IRRunBreakpoint(inst->constant)) {
 				CoreTiming::ForceCheck();
@@ -1227,7 +1400,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		case IROp::LogIRBlock:
 			if (mipsTracer.tracing_enabled) {
-				mipsTracer.executed_blocks.push_back(inst->constant);
+				mipsTracer.log_block(inst->constant);
 			}
 			break;
 
@@ -21,14 +21,21 @@
 
 #include "ext/xxhash.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 
 #include "Common/Log.h"
+#include "Common/File/FileUtil.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/ELF/ParamSFO.h"
+#include "Core/Debugger/Breakpoints.h"
+#include "Core/System.h"
 #include "Core/HLE/sceKernelMemory.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
@@ -47,6 +54,113 @@
 
 namespace MIPSComp {
 
+// Bump this whenever IROp numbering or the meaning of IR instructions changes.
+#define IR_CACHE_MAGIC 0x43524950  // "PIRC"
+#define IR_CACHE_VERSION 5
+
+struct IRCacheHeader {
+	u32 magic;
+	u32 version;
+	u32 buildHash;
+	u32 instSize;
+	u32 flags;
+	u32 disableFlags;
+	u32 numBlocks;
+	u32 reserved;
+};
+
+struct IRCacheBlockHeader {
+	u32 origAddr;
+	u32 origSize;
+	u64 hash;
+	u32 numInstructions;
+	u32 reserved;
+};
+
+static u64 HashMIPSRange(u32 origAddr, u32 origSize) {
+	// This is unfortunate. In case there are emuhacks, we have to make a copy.
+	// If we could hash while reading we could avoid this.
+	std::vector<u32> buffer;
+	buffer.resize(origSize / 4);
+	size_t pos = 0;
+	for (u32 off = 0; off < origSize; off += 4) {
+		// Let's actually hash the replacement, if any.
+		MIPSOpcode instr = Memory::ReadUnchecked_Instruction(origAddr + off, false);
+		buffer[pos++] = instr.encoding;
+	}
+	return XXH3_64bits(&buffer[0], origSize);
+}
+
+struct IRAsyncCompileControl {
+	std::mutex lock;
+	std::condition_variable cond;
+	// Cleared when the jit shuts down, so a task that runs late does nothing.
+	IRJit *jit = nullptr;
+	int running = 0;
+};
+
+class IRCompileTask : public Task {
+public:
+	IRCompileTask(const std::shared_ptr<IRAsyncCompileControl> &control) : control_(control) {}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	TaskPriority Priority() const override {
+		// The emu thread is interpreting while it waits for this.
+		return TaskPriority::HIGH;
+	}
+
+	void Run() override {
+		IRJit *jit;
+		{
+			std::lock_guard<std::mutex> guard(control_->lock);
+			jit = control_->jit;
+			if (!jit)
+				return;
+			control_->running++;
+		}
+
+		jit->RunAsyncCompiles();
+
+		std::lock_guard<std::mutex> guard(control_->lock);
+		control_->running--;
+		control_->cond.notify_all();
+	}
+
+	// Nothing to undo if it never ran, the queue is re-checked on the next block miss.
+	bool Cancellable() override {
+		return true;
+	}
+
+private:
+	std::shared_ptr<IRAsyncCompileControl> control_;
+};
+
+// Runs the interpreter to the end of the block at the current PC, while it's compiled in the background.
+static void InterpretUntilBlockEnd(MIPSState *mips) {
+	u32 lastPC;
+	do {
+		lastPC = mips->pc;
+		// NEVER stop in a delay slot!
+		do {
+			// Replacements are processed here, intentionally.
+			MIPSOpcode op = MIPSOpcode(Memory::Read_U32(mips->pc));
+
+			bool wasInDelaySlot = mips->inDelaySlot;
+			MIPSInterpret(op);
+			mips->downcount -= MIPSGetInstructionCycleEstimate(op);
+
+			// The reason we have to check this is the delay slot hack in Int_Syscall.
+			if (mips->inDelaySlot && wasInDelaySlot) {
+				mips->pc = mips->nextPC;
+				mips->inDelaySlot = false;
+			}
+		} while (mips->inDelaySlot);
+	} while (mips->pc == lastPC + 4 && mips->downcount >= 0 && coreState == CORE_RUNNING_CPU && !MIPS_IS_RUNBLOCK(Memory::ReadUnchecked_U32(mips->pc)));
+}
+
 IRJit::IRJit(MIPSState *mipsState, bool actualJit) : frontend_(mipsState->HasDefaultPrefix()), mips_(mipsState), blocks_(actualJit) {
 	// u32 size = 128 * 1024;
 	InitIR();
@@ -63,21 +177,216 @@ IRJit::IRJit(MIPSState *mipsState, bool actualJit) : frontend_(mipsState->HasDef
 	opts.unalignedLoadStore = false;
 	opts.unalignedLoadStoreVec4 = true;
 	opts.preferVec4 = cpu_info.RiscV_V;
+	opts.preferVec4Matrix = true;
+#elif PPSSPP_ARCH(LOONGARCH64)
+	// Without UAL, unaligned accesses trap to the kernel and are very slow.
+	opts.unalignedLoadStore = cpu_info.LOONGARCH_UAL && (opts.disableFlags & (uint32_t)JitDisable::LSU_UNALIGNED) == 0;
+	opts.unalignedLoadStoreVec4 = true;
+	opts.preferVec4 = cpu_info.LOONGARCH_LSX;
+	// No native matrix ops here yet, so only use them when interpreting.
+	opts.preferVec4Matrix = !actualJit;
 #elif PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64)
 	opts.unalignedLoadStore = (opts.disableFlags & (uint32_t)JitDisable::LSU_UNALIGNED) == 0;
 	opts.unalignedLoadStoreVec4 = true;
 	opts.preferVec4 = true;
+#if PPSSPP_ARCH(ARM64)
+	opts.preferVec4Matrix = true;
+#else
+	// No native matrix ops on ARM32 yet, so only use them when interpreting.
+	opts.preferVec4Matrix = !actualJit;
+#endif
 #else
 	opts.unalignedLoadStore = (opts.disableFlags & (uint32_t)JitDisable::LSU_UNALIGNED) == 0;
 	// TODO: Could allow on x86 pretty easily...
 	opts.unalignedLoadStoreVec4 = false;
 	opts.preferVec4 = true;
+	opts.preferVec4Matrix = true;
 #endif
 	opts.optimizeForInterpreter = jo.optimizeForInterpreter;
+	jo.continueBranches = g_Config.bIRContinueBranches || g_Config.bIRFunctionRegions;
+	jo.continueJumps = g_Config.bIRContinueBranches || g_Config.bIRFunctionRegions;
+	opts.continueBranches = jo.continueBranches;
+	opts.continueJumps = jo.continueJumps;
+	opts.continueMaxInstructions = jo.continueMaxInstructions;
+	opts.functionRegions = g_Config.bIRFunctionRegions;
 	frontend_.SetOptions(opts);
+
+	// The native dispatchers need a block right away, so this is only for the IR interpreter.
+	if (g_Config.bBackgroundJitCompile && !actualJit && g_threadManager.IsInitialized()) {
+		asyncCompile_ = true;
+		asyncFrontend_.reset(new IRFrontend(mipsState->HasDefaultPrefix()));
+		asyncFrontend_->SetOptions(opts);
+		asyncControl_ = std::make_shared<IRAsyncCompileControl>();
+		asyncControl_->jit = this;
+	}
+
+	std::string discID = g_paramSFO.GetDiscID();
+	if (g_Config.bPersistentJitCache && !discID.empty()) {
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+		persistentCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + (actualJit ? ".irjitcache" : ".ircache"));
+		LoadPersistentCache(persistentCachePath_);
+	}
 }
 
 IRJit::~IRJit() {
+	StopAsyncCompiles();
+	if (!persistentCachePath_.empty()) {
+		SavePersistentCache(persistentCachePath_);
+	}
+}
+
+u32 IRJit::GetPersistentCacheFlags() const {
+	// Everything that changes the IR the frontend generates for the same MIPS code.
+	const IROptions &opts = frontend_.GetOptions();
+	u32 flags = 0;
+	flags |= opts.unalignedLoadStore ? 0x01 : 0;
+	flags |= opts.unalignedLoadStoreVec4 ? 0x02 : 0;
+	flags |= opts.preferVec4 ? 0x04 : 0;
+	flags |= opts.preferVec4Dot ? 0x08 : 0;
+	flags |= opts.optimizeForInterpreter ? 0x10 : 0;
+	flags |= opts.continueBranches ? 0x20 : 0;
+	flags |= opts.continueJumps ? 0x40 : 0;
+	flags |= opts.functionRegions ? 0x80 : 0;
+	flags |= frontend_.HasSetRounding() ? 0x100 : 0;
+	flags |= frontend_.StartsWithDefaultPrefix() ? 0x200 : 0;
+	flags |= opts.preferVec4Matrix ? 0x400 : 0;
+	return flags;
+}
+
+void IRJit::LoadPersistentCache(const Path &filename) {
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return;
+
+	IRCacheHeader header{};
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	if (!success || header.magic != IR_CACHE_MAGIC || header.version != IR_CACHE_VERSION) {
+		WARN_LOG(Log::JIT, "IR cache magic or version mismatch, ignoring");
+		fclose(f);
+		return;
+	}
+	if (header.buildHash != (u32)XXH3_64bits(PPSSPP_GIT_VERSION, strlen(PPSSPP_GIT_VERSION)) || header.instSize != sizeof(IRInst)) {
+		INFO_LOG(Log::JIT, "IR cache from a different build, ignoring");
+		fclose(f);
+		return;
+	}
+	if (header.disableFlags != frontend_.GetOptions().disableFlags) {
+		INFO_LOG(Log::JIT, "IR cache was built with different jit flags, ignoring");
+		fclose(f);
+		return;
+	}
+
+	persistentCacheFlags_ = header.flags;
+	for (u32 i = 0; i < header.numBlocks; ++i) {
+		IRCacheBlockHeader blockHeader;
+		if (fread(&blockHeader, sizeof(blockHeader), 1, f) != 1) {
+			success = false;
+			break;
+		}
+		// Sanity check, blocks are never this large.
+		if (blockHeader.numInstructions == 0 || blockHeader.numInstructions > 0x10000 || (blockHeader.origSize & 3) != 0) {
+			success = false;
+			break;
+		}
+		PersistentBlock &block = persistentBlocks_[blockHeader.origAddr];
+		block.origSize = blockHeader.origSize;
+		block.hash = blockHeader.hash;
+		block.instructions.resize(blockHeader.numInstructions);
+		if (fread(&block.instructions[0], sizeof(IRInst), blockHeader.numInstructions, f) != blockHeader.numInstructions) {
+			success = false;
+			break;
+		}
+	}
+	fclose(f);
+
+	if (!success) {
+		WARN_LOG(Log::JIT, "IR cache file was truncated or corrupt, deleting");
+		persistentBlocks_.clear();
+		File::Delete(filename);
+		return;
+	}
+
+	INFO_LOG(Log::JIT, "Loaded %d blocks from the IR cache", (int)persistentBlocks_.size());
+}
+
+void IRJit::SavePersistentCache(const Path &filename) {
+	const u32 flags = GetPersistentCacheFlags();
+	// Entries loaded under different frontend state are stale, but live blocks always match.
+	if (flags != persistentCacheFlags_) {
+		persistentBlocks_.clear();
+	}
+
+	for (int i = 0; i < blocks_.GetNumBlocks(); ++i) {
+		const IRBlock *b = blocks_.GetBlock(i);
+		if (!b->IsValid() || !b->HasHash())
+			continue;
+		u32 start, size;
+		b->GetRange(&start, &size);
+		const IRInst *instructions = blocks_.GetBlockInstructionPtr(*b);
+		PersistentBlock &block = persistentBlocks_[start];
+		block.origSize = size;
+		block.hash = b->GetHash();
+		block.instructions.assign(instructions, instructions + b->GetNumIRInstructions());
+	}
+
+	if (persistentBlocks_.empty())
+		return;
+
+	Path tempPath = File::TempPathFor(filename);
+	FILE *f = File::OpenCFile(tempPath, "wb");
+	if (!f)
+		return;
+
+	IRCacheHeader header{};
+	header.magic = IR_CACHE_MAGIC;
+	header.version = IR_CACHE_VERSION;
+	header.buildHash = (u32)XXH3_64bits(PPSSPP_GIT_VERSION, strlen(PPSSPP_GIT_VERSION));
+	header.instSize = sizeof(IRInst);
+	header.flags = flags;
+	header.disableFlags = frontend_.GetOptions().disableFlags;
+	header.numBlocks = (u32)persistentBlocks_.size();
+	bool writeFailed = fwrite(&header, sizeof(header), 1, f) != 1;
+	for (const auto &iter : persistentBlocks_) {
+		IRCacheBlockHeader blockHeader{};
+		blockHeader.origAddr = iter.first;
+		blockHeader.origSize = iter.second.origSize;
+		blockHeader.hash = iter.second.hash;
+		blockHeader.numInstructions = (u32)iter.second.instructions.size();
+		writeFailed = writeFailed || fwrite(&blockHeader, sizeof(blockHeader), 1, f) != 1;
+		writeFailed = writeFailed || fwrite(iter.second.instructions.data(), sizeof(IRInst), blockHeader.numInstructions, f) != blockHeader.numInstructions;
+		if (writeFailed)
+			break;
+	}
+	fclose(f);
+
+	if (writeFailed || !File::ReplaceFile(tempPath, filename)) {
+		ERROR_LOG(Log::JIT, "Failed to write IR cache, deleting");
+		File::Delete(tempPath);
+	} else {
+		INFO_LOG(Log::JIT, "Saved %d blocks to the IR cache", (int)header.numBlocks);
+	}
+}
+
+bool IRJit::LookupPersistentBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes) {
+	auto iter = persistentBlocks_.find(em_address);
+	if (iter == persistentBlocks_.end())
+		return false;
+
+	// Breakpoints are compiled into the IR, so we can't reuse anything while they're active.
+	if (g_breakpoints.HasBreakPoints() || g_breakpoints.HasMemChecks())
+		return false;
+	if (GetPersistentCacheFlags() != persistentCacheFlags_)
+		return false;
+
+	const PersistentBlock &block = iter->second;
+	if (!Memory::IsValidRange(em_address, block.origSize) || HashMIPSRange(em_address, block.origSize) != block.hash) {
+		// Different code loaded at this address now, the live block will replace it on save.
+		return false;
+	}
+
+	instructions = block.instructions;
+	mipsBytes = block.origSize;
+	return true;
 }
 
 void IRJit::DoState(PointerWrap &p) {
@@ -89,10 +398,21 @@ void IRJit::UpdateFCR31() {
 
 void IRJit::ClearCache() {
 	INFO_LOG(Log::JIT, "IRJit: Clearing the block cache!");
+	std::lock_guard<std::mutex> guard(asyncCompileLock_);
 	blocks_.Clear();
+	if (asyncCompile_) {
+		// Anything queued or in flight was compiled with the old state, let the worker drop it.
+		std::lock_guard<std::mutex> queueGuard(asyncQueueLock_);
+		asyncGeneration_++;
+		asyncQueue_.clear();
+		asyncPending_.clear();
+		asyncResults_.clear();
+	}
 }
 
 void IRJit::InvalidateCacheAt(u32 em_address, int length) {
+	// The async frontend reads blocks and the emuhacks in memory, which this changes.
+	std::lock_guard<std::mutex> guard(asyncCompileLock_);
 	std::vector<int> numbers = blocks_.FindInvalidatedBlockNumbers(em_address, length);
 	if (numbers.empty()) {
 		return;
@@ -115,29 +435,30 @@ void IRJit::Compile(u32 em_address) {
 	_dbg_assert_(compilerEnabled_);
 
 	PROFILE_THIS_SCOPE("jitc");
+	TRACE_SCOPE("jit_compile");
 
-	if (g_Config.bPreloadFunctions) {
-		// Look to see if we've preloaded this block.
-		int block_num = blocks_.FindPreloadBlock(em_address);
-		if (block_num != -1) {
-			IRBlock *block = blocks_.GetBlock(block_num);
-			// Okay, let's link and finalize the block now.
-			int cookie = compileToNative_ ? block->GetNativeOffset() : block->GetIRArenaOffset();
-			block->Finalize(cookie);
-			if (block->IsValid()) {
-				// Success, we're done.
-				FinalizeNativeBlock(&blocks_, block_num);
-				return;
-			}
-		}
+	if (ReuseBlock(em_address))
+		return;
+
+	// Do this before compiling, so the new block doesn't get parked right away.
+	if (blocks_.ShouldAdvanceEpoch() && !mipsTracer.tracing_enabled) {
+		std::lock_guard<std::mutex> guard(asyncCompileLock_);
+		blocks_.AdvanceEpoch();
 	}
 
 	std::vector<IRInst> instructions;
 	u32 mipsBytes;
 	if (!CompileBlock(em_address, instructions, mipsBytes, false)) {
-		// Ran out of block numbers - need to reset.
-		ERROR_LOG(Log::JIT, "Ran out of block numbers, clearing cache");
-		ClearCache();
+		// Ran out of block numbers - try to keep the hot blocks, otherwise need to reset.
+		bool evicted = false;
+		if (!mipsTracer.tracing_enabled) {
+			std::lock_guard<std::mutex> guard(asyncCompileLock_);
+			evicted = blocks_.EvictColdBlocks();
+		}
+		if (!evicted) {
+			ERROR_LOG(Log::JIT, "Ran out of block numbers, clearing cache");
+			ClearCache();
+		}
 		CompileBlock(em_address, instructions, mipsBytes, false);
 	}
 
@@ -148,18 +469,54 @@ void IRJit::Compile(u32 em_address) {
 	}
 }
 
+// Re-arms a block that's still in the cache, either preloaded or parked by AdvanceEpoch().
+bool IRJit::ReuseBlock(u32 em_address) {
+	if (!g_Config.bPreloadFunctions && !blocks_.TracksEpochs())
+		return false;
+
+	int block_num = blocks_.FindPreloadBlock(em_address);
+	if (block_num == -1)
+		return false;
+
+	IRBlock *block = blocks_.GetBlock(block_num);
+	{
+		// Writes the emuhack back, which the async frontend may be reading.
+		std::lock_guard<std::mutex> guard(asyncCompileLock_);
+		// Okay, let's link and finalize the block now.
+		int cookie = compileToNative_ ? block->GetNativeOffset() : block->GetIRArenaOffset();
+		block->Finalize(cookie);
+		if (!block->IsValid())
+			return false;
+
+		// Success, we're done.
+		blocks_.MarkUsed(block_num);
+	}
+	FinalizeNativeBlock(&blocks_, block_num);
+	return true;
+}
+
 // WARNING! This can be called from IRInterpret / the JIT, through the function preload stuff!
 bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
 	_dbg_assert_(compilerEnabled_);
 
-	frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+	if (persistentBlocks_.empty() || !LookupPersistentBlock(em_address, instructions, mipsBytes)) {
+		frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+	}
 	if (instructions.empty()) {
 		_dbg_assert_(preload);
 		// We return true when preloading so it doesn't abort.
 		return preload;
 	}
 
-	int block_num = blocks_.AllocateBlock(em_address, mipsBytes, instructions);
+	return InstallBlock(em_address, instructions, mipsBytes, preload);
+}
+
+bool IRJit::InstallBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload) {
+	int block_num;
+	{
+		std::lock_guard<std::mutex> guard(asyncCompileLock_);
+		block_num = blocks_.AllocateBlock(em_address, mipsBytes, instructions);
+	}
 	if ((block_num & ~MIPS_EMUHACK_VALUE_MASK) != 0) {
 		WARN_LOG(Log::JIT, "Failed to allocate block for %08x (%d instructions)", em_address, (int)instructions.size());
 		// Out of block numbers.  Caller will handle.
@@ -167,7 +524,7 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	}
 
 	IRBlock *b = blocks_.GetBlock(block_num);
-	if (preload || mipsTracer.tracing_enabled) {
+	if (preload || mipsTracer.tracing_enabled || !persistentCachePath_.empty()) {
 		// Hash, then only update page stats, don't link yet.
 		// TODO: Should we always hash?  Then we can reuse blocks.
 		b->UpdateHash();
@@ -181,7 +538,10 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	}
 
 	// Updates stats, also patches the first MIPS instruction into an emuhack if 'preload == false'
-	blocks_.FinalizeBlock(block_num, preload);
+	{
+		std::lock_guard<std::mutex> guard(asyncCompileLock_);
+		blocks_.FinalizeBlock(block_num, preload);
+	}
 	if (!preload)
 		FinalizeNativeBlock(&blocks_, block_num);
 	return true;
@@ -192,6 +552,44 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 
 	PROFILE_THIS_SCOPE("jitc");
 
+	std::vector<PreloadedBlock> blocks;
+	GatherFunctionBlocks(frontend_, start_address, length, blocks);
+	InstallFunctionBlocks(blocks);
+}
+
+void IRJit::CompileFunctions(const std::vector<std::pair<u32, u32>> &ranges) {
+	_dbg_assert_(compilerEnabled_);
+
+	// Installing has to happen on this thread, the tracer also wants to see blocks in order.
+	if (ranges.size() < 2 || !g_threadManager.IsInitialized() || g_threadManager.GetNumLooperThreads() <= 1 || mipsTracer.tracing_enabled) {
+		JitInterface::CompileFunctions(ranges);
+		return;
+	}
+
+	PROFILE_THIS_SCOPE("jitc");
+	TRACE_SCOPE("jit_compile_functions");
+
+	// Nothing touches the block cache while we wait, so the frontends can safely look through emuhacks.
+	const bool startDefaultPrefix = frontend_.StartsWithDefaultPrefix();
+	const bool hasSetRounding = frontend_.HasSetRounding();
+	std::vector<std::vector<PreloadedBlock>> results(ranges.size());
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		IRFrontend frontend(startDefaultPrefix);
+		frontend.SetOptions(frontend_.GetOptions());
+		frontend.SetCompileState(startDefaultPrefix, hasSetRounding);
+		for (int i = l; i < h; ++i) {
+			GatherFunctionBlocks(frontend, ranges[i].first, ranges[i].second, results[i]);
+		}
+	}, 0, (int)ranges.size(), 16, TaskPriority::HIGH);
+
+	for (const std::vector<PreloadedBlock> &blocks : results) {
+		if (!InstallFunctionBlocks(blocks))
+			break;
+	}
+}
+
+// Safe to call from a worker thread, as long as the block cache isn't changing meanwhile.
+void IRJit::GatherFunctionBlocks(IRFrontend &frontend, u32 start_address, u32 length, std::vector<PreloadedBlock> &blocks) {
 	// Note: we don't actually write emuhacks yet, so we can validate hashes.
 	// This way, if the game changes the code afterward, we'll catch even without icache invalidation.
 
@@ -211,18 +609,15 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 			continue;
 		}
 
-		std::vector<IRInst> instructions;
-		u32 mipsBytes;
-		if (!CompileBlock(em_address, instructions, mipsBytes, true)) {
-			// Ran out of block numbers - let's hope there's no more code it needs to run.
-			// Will flush when actually compiling.
-			ERROR_LOG(Log::JIT, "Ran out of block numbers while compiling function");
-			return;
+		PreloadedBlock block;
+		block.em_address = em_address;
+		if (persistentBlocks_.empty() || !LookupPersistentBlock(em_address, block.instructions, block.mipsBytes)) {
+			frontend.DoJit(em_address, block.instructions, block.mipsBytes, true);
 		}
 
 		doneAddresses.insert(em_address);
 
-		for (const IRInst &inst : instructions) {
+		for (const IRInst &inst : block.instructions) {
 			u32 exit = 0;
 
 			switch (inst.op) {
@@ -233,6 +628,10 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 			case IROp::ExitToConstIfGeZ:
 			case IROp::ExitToConstIfLtZ:
 			case IROp::ExitToConstIfLeZ:
+			case IROp::OptSltExitIfNonZero:
+			case IROp::OptSltExitIfZero:
+			case IROp::OptSltUExitIfNonZero:
+			case IROp::OptSltUExitIfZero:
 			case IROp::ExitToConstIfFpTrue:
 			case IROp::ExitToConstIfFpFalse:
 				exit = inst.constant;
@@ -257,12 +656,130 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 		}
 
 		// Also include after the block for jal returns.
-		if (em_address + mipsBytes < start_address + length) {
-			pendingAddresses.push_back(em_address + mipsBytes);
+		if (em_address + block.mipsBytes < start_address + length) {
+			pendingAddresses.push_back(em_address + block.mipsBytes);
 		}
+
+		if (!block.instructions.empty())
+			blocks.push_back(std::move(block));
 	}
 }
 
+bool IRJit::InstallFunctionBlocks(const std::vector<PreloadedBlock> &blocks) {
+	for (const PreloadedBlock &block : blocks) {
+		if (!InstallBlock(block.em_address, block.instructions, block.mipsBytes, true)) {
+			// Ran out of block numbers - let's hope there's no more code it needs to run.
+			// Will flush when actually compiling.
+			ERROR_LOG(Log::JIT, "Ran out of block numbers while compiling function");
+			return false;
+		}
+	}
+	return true;
+}
+
+// Returns false if the block should be compiled right away instead.
+bool IRJit::CompileAsync(u32 em_address) {
+	// These are compiled into the IR, so let's not deal with them changing while queued.
+	if (g_breakpoints.HasBreakPoints() || g_breakpoints.HasMemChecks() || mipsTracer.tracing_enabled)
+		return false;
+	if (ReuseBlock(em_address))
+		return true;
+
+	AsyncCompileResult result;
+	bool found = false;
+	bool startTask = false;
+	{
+		std::lock_guard<std::mutex> guard(asyncQueueLock_);
+		auto it = asyncResults_.find(em_address);
+		if (it != asyncResults_.end()) {
+			result = std::move(it->second);
+			asyncResults_.erase(it);
+			asyncPending_.erase(em_address);
+			found = true;
+		} else if (asyncPending_.find(em_address) == asyncPending_.end()) {
+			// Too much queued probably means the worker is starved, better to just compile.
+			if (asyncPending_.size() >= 64)
+				return false;
+
+			AsyncCompileRequest request;
+			request.em_address = em_address;
+			request.flags = GetPersistentCacheFlags();
+			request.startDefaultPrefix = frontend_.StartsWithDefaultPrefix();
+			request.hasSetRounding = frontend_.HasSetRounding();
+			request.generation = asyncGeneration_;
+			asyncQueue_.push_back(request);
+			asyncPending_.insert(em_address);
+			startTask = !asyncTaskRunning_;
+			asyncTaskRunning_ = true;
+		}
+	}
+
+	if (found) {
+		// The game may have changed the code, or state changed, while it was compiling.
+		if (result.instructions.empty() || result.flags != GetPersistentCacheFlags())
+			return false;
+		if (!Memory::IsValidRange(em_address, result.mipsBytes) || HashMIPSRange(em_address, result.mipsBytes) != result.hash)
+			return false;
+		if (!InstallBlock(em_address, result.instructions, result.mipsBytes, false)) {
+			// Out of block numbers, let Compile() clear it.
+			return false;
+		}
+		return true;
+	}
+
+	if (startTask)
+		g_threadManager.EnqueueTask(new IRCompileTask(asyncControl_));
+
+	InterpretUntilBlockEnd(mips_);
+	return true;
+}
+
+void IRJit::RunAsyncCompiles() {
+	while (!asyncCancel_) {
+		AsyncCompileRequest request;
+		{
+			std::lock_guard<std::mutex> guard(asyncQueueLock_);
+			if (asyncQueue_.empty())
+				break;
+			request = asyncQueue_.back();
+			asyncQueue_.pop_back();
+		}
+
+		AsyncCompileResult result;
+		result.flags = request.flags;
+		{
+			std::lock_guard<std::mutex> guard(asyncCompileLock_);
+			asyncFrontend_->SetCompileState(request.startDefaultPrefix, request.hasSetRounding);
+			asyncFrontend_->DoJit(request.em_address, result.instructions, result.mipsBytes, false);
+			// If it needs a do-over, the main frontend will notice the same when compiling normally.
+			if (asyncFrontend_->CheckRounding(request.em_address))
+				result.instructions.clear();
+			else if (!result.instructions.empty())
+				result.hash = HashMIPSRange(request.em_address, result.mipsBytes);
+		}
+
+		std::lock_guard<std::mutex> guard(asyncQueueLock_);
+		// If the cache was cleared meanwhile, it's no longer pending either.
+		if (request.generation == asyncGeneration_)
+			asyncResults_[request.em_address] = std::move(result);
+	}
+
+	std::lock_guard<std::mutex> guard(asyncQueueLock_);
+	asyncTaskRunning_ = false;
+}
+
+void IRJit::StopAsyncCompiles() {
+	if (!asyncCompile_)
+		return;
+
+	// The worker checks this between blocks, so we only wait for the current one.
+	asyncCancel_ = true;
+	std::unique_lock<std::mutex> guard(asyncControl_->lock);
+	// A task that hasn't started yet (or never will) sees this and returns right away.
+	asyncControl_->jit = nullptr;
+	asyncControl_->cond.wait(guard, [&] { return asyncControl_->running == 0; });
+}
+
 void IRJit::RunLoopUntil(u64 globalticks) {
 	PROFILE_THIS_SCOPE("jit");
 
@@ -315,7 +832,8 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 #ifdef _DEBUG
 				compilerEnabled_ = true;
 #endif
-				Compile(mips->pc);
+				if (!asyncCompile_ || !CompileAsync(mips->pc))
+					Compile(mips->pc);
 #ifdef _DEBUG
 				compilerEnabled_ = false;
 #endif
@@ -343,6 +861,13 @@ void IRJit::UnlinkBlock(u8 *checkedEntry, u32 originalAddress) {
 	Crash();
 }
 
+// We have 24 bits to represent offsets with.
+static const u32 MAX_ARENA_SIZE = 0x1000000 - 1;
+// Blocks get parked this often (in arena growth), to find out which ones still run.
+static const u32 EPOCH_ARENA_STEP = MAX_ARENA_SIZE / 8;
+// Blocks that haven't run for this many epochs get evicted when the arena is full.
+static const u32 COLD_EPOCHS = 2;
+
 void IRBlockCache::Clear() {
 	for (int i = 0; i < (int)blocks_.size(); ++i) {
 		int cookie = compileToNative_ ? blocks_[i].GetNativeOffset() : blocks_[i].GetIRArenaOffset();
@@ -352,13 +877,12 @@ void IRBlockCache::Clear() {
 	byPage_.clear();
 	arena_.clear();
 	arena_.shrink_to_fit();
+	nextEpochOffset_ = EPOCH_ARENA_STEP;
 }
 
-IRBlockCache::IRBlockCache(bool compileToNative) : compileToNative_(compileToNative) {}
+IRBlockCache::IRBlockCache(bool compileToNative) : compileToNative_(compileToNative), nextEpochOffset_(EPOCH_ARENA_STEP) {}
 
 int IRBlockCache::AllocateBlock(int emAddr, u32 origSize, const std::vector<IRInst> &insts) {
-	// We have 24 bits to represent offsets with.
-	const u32 MAX_ARENA_SIZE = 0x1000000 - 1;
 	int offset = (int)arena_.size();
 	if (offset >= MAX_ARENA_SIZE) {
 		WARN_LOG(Log::JIT, "Filled JIT arena, restarting");
@@ -370,9 +894,74 @@ int IRBlockCache::AllocateBlock(int emAddr, u32 origSize, const std::vector<IRIn
 	}
 	int newBlockIndex = (int)blocks_.size();
 	blocks_.push_back(IRBlock(emAddr, origSize, offset, (u32)insts.size()));
+	blocks_.back().SetLastEpoch(epoch_);
 	return newBlockIndex;
 }
 
+void IRBlockCache::AdvanceEpoch() {
+	// Put every block back behind its original op.  The ones that still run get re-armed through
+	// FindPreloadBlock(), which bumps their epoch, so the rest can be told apart when we fill up.
+	for (IRBlock &block : blocks_) {
+		if (!block.IsValid())
+			continue;
+		block.RestoreOriginalFirstOp(block.GetIRArenaOffset());
+		if (!block.HasHash())
+			block.UpdateHash();
+	}
+	epoch_++;
+	nextEpochOffset_ = arena_.size() + EPOCH_ARENA_STEP;
+}
+
+bool IRBlockCache::EvictColdBlocks() {
+	if (!TracksEpochs())
+		return false;
+
+	auto isHot = [&](const IRBlock &block) {
+		return block.IsValid() && block.GetLastEpoch() + COLD_EPOCHS > epoch_;
+	};
+
+	size_t keptSize = 0;
+	for (const IRBlock &block : blocks_) {
+		if (isHot(block))
+			keptSize += block.GetNumIRInstructions();
+	}
+	// Not worth it if we'd just fill up again right away.
+	if (keptSize > MAX_ARENA_SIZE / 2)
+		return false;
+
+	std::vector<IRBlock> kept;
+	std::vector<IRInst> arena;
+	arena.reserve(keptSize);
+	int evictedCount = 0;
+	for (IRBlock &block : blocks_) {
+		const u32 oldOffset = block.GetIRArenaOffset();
+		if (!isHot(block)) {
+			block.Destroy(oldOffset);
+			evictedCount++;
+			continue;
+		}
+
+		// The old cookie would point at some other block after compacting, so swap it out.
+		bool armed = block.RestoreOriginalFirstOp(oldOffset);
+		const IRInst *insts = arena_.data() + oldOffset;
+		block.Relocate((u32)arena.size());
+		arena.insert(arena.end(), insts, insts + block.GetNumIRInstructions());
+		if (armed)
+			block.Finalize(block.GetIRArenaOffset());
+		kept.push_back(std::move(block));
+	}
+
+	INFO_LOG(Log::JIT, "IRBlockCache: Evicted %d cold blocks, kept %d (%d IR instructions)", evictedCount, (int)kept.size(), (int)keptSize);
+
+	blocks_ = std::move(kept);
+	arena_ = std::move(arena);
+	byPage_.clear();
+	for (int i = 0; i < (int)blocks_.size(); ++i)
+		AddBlockToPageLookup(i);
+	nextEpochOffset_ = arena_.size() + EPOCH_ARENA_STEP;
+	return true;
+}
+
 int IRBlockCache::GetBlockNumFromIRArenaOffset(int offset) const {
 	// Block offsets are always in rising order (we don't go back and replace them when invalidated). So we can binary search.
 	int low = 0;
@@ -438,8 +1027,12 @@ void IRBlockCache::FinalizeBlock(int blockIndex, bool preload) {
 		block.Finalize(cookie);
 	}
 
+	AddBlockToPageLookup(blockIndex);
+}
+
+void IRBlockCache::AddBlockToPageLookup(int blockIndex) {
 	u32 startAddr, size;
-	block.GetRange(&startAddr, &size);
+	blocks_[blockIndex].GetRange(&startAddr, &size);
 
 	u32 startPage = AddressToPage(startAddr);
 	u32 endPage = AddressToPage(startAddr + size);
@@ -671,17 +1264,7 @@ void IRBlock::Destroy(int cookie) {
 
 u64 IRBlock::CalculateHash() const {
 	if (origAddr_) {
-		// This is unfortunate. In case there are emuhacks, we have to make a copy.
-		// If we could hash while reading we could avoid this.
-		std::vector<u32> buffer;
-		buffer.resize(origSize_ / 4);
-		size_t pos = 0;
-		for (u32 off = 0; off < origSize_; off += 4) {
-			// Let's actually hash the replacement, if any.
-			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(origAddr_ + off, false);
-			buffer[pos++] = instr.encoding;
-		}
-		return XXH3_64bits(&buffer[0], origSize_);
+		return HashMIPSRange(origAddr_, origSize_);
 	}
 	return 0;
 }
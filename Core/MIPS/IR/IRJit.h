@@ -17,11 +17,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "Common/CommonTypes.h"
 #include "Common/CPUDetect.h"
+#include "Common/File/Path.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/IR/IRRegCache.h"
@@ -59,12 +65,15 @@ class IRBlock {
 		origFirstOpcode_ = b.origFirstOpcode_;
 		nativeOffset_ = b.nativeOffset_;
 		numIRInstructions_ = b.numIRInstructions_;
+		lastEpoch_ = b.lastEpoch_;
 		b.arenaOffset_ = 0xFFFFFFFF;
 	}
 
 	~IRBlock() {}
 
 	u32 GetIRArenaOffset() const { return arenaOffset_; }
+	// Only for compacting the arena, the caller must take care of the cookie.
+	void Relocate(u32 arenaOffset) { arenaOffset_ = arenaOffset; }
 	int GetNumIRInstructions() const { return numIRInstructions_; }
 	MIPSOpcode GetOriginalFirstOp() const { return origFirstOpcode_; }
 	bool HasOriginalFirstOp() const;
@@ -79,10 +88,19 @@ class IRBlock {
 	void UpdateHash() {
 		hash_ = CalculateHash();
 	}
+	bool HasHash() const {
+		return hash_ != 0;
+	}
 	bool HashMatches() const {
 		return origAddr_ && hash_ == CalculateHash();
 	}
 	bool OverlapsRange(u32 addr, u32 size) const;
+	void SetLastEpoch(u32 epoch) {
+		lastEpoch_ = epoch;
+	}
+	u32 GetLastEpoch() const {
+		return lastEpoch_;
+	}
 
 	void GetRange(u32 *start, u32 *size) const {
 		*start = origAddr_;
@@ -114,6 +132,8 @@ class IRBlock {
 	u32 origSize_ = 0;
 	MIPSOpcode origFirstOpcode_ = MIPSOpcode(0x68FFFFFF);
 	u32 numIRInstructions_ = 0;
+	// Block cache epoch this block was last compiled or re-armed in.
+	u32 lastEpoch_ = 0;
 };
 
 class IRBlockCache : public JitBlockCacheDebugInterface {
@@ -159,6 +179,14 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 
 	int FindPreloadBlock(u32 em_address);
 
+	// Native code can't be moved around, so only the IR interpreter evicts blocks incrementally.
+	bool TracksEpochs() const { return !compileToNative_; }
+	bool ShouldAdvanceEpoch() const { return TracksEpochs() && arena_.size() >= nextEpochOffset_; }
+	void AdvanceEpoch();
+	void MarkUsed(int blockNum) { blocks_[blockNum].SetLastEpoch(epoch_); }
+	// Drops blocks that haven't run in a while and compacts the arena. Returns false if that wouldn't free enough.
+	bool EvictColdBlocks();
+
 	// "Cookie" means the 24 bits we inject into the first instruction of each block.
 	int FindByCookie(int cookie);
 
@@ -194,12 +222,17 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 
 private:
 	u32 AddressToPage(u32 addr) const;
+	void AddBlockToPageLookup(int blockNum);
 	bool compileToNative_;
+	u32 epoch_ = 0;
+	size_t nextEpochOffset_ = 0;
 	std::vector<IRBlock> blocks_;
 	std::vector<IRInst> arena_;
 	std::unordered_map<u32, std::vector<int>> byPage_;
 };
 
+struct IRAsyncCompileControl;
+
 class IRJit : public JitInterface {
 public:
 	IRJit(MIPSState *mipsState, bool actualJit);
@@ -213,6 +246,7 @@ class IRJit : public JitInterface {
 
 	void Compile(u32 em_address) override;	// Compiles a block at current MIPS PC
 	void CompileFunction(u32 start_address, u32 length) override;
+	void CompileFunctions(const std::vector<std::pair<u32, u32>> &ranges) override;
 
 	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
 	// Not using a regular block cache.
@@ -237,8 +271,29 @@ class IRJit : public JitInterface {
 	void LinkBlock(u8 *exitPoint, const u8 *checkedEntry) override;
 	void UnlinkBlock(u8 *checkedEntry, u32 originalAddress) override;
 
+	// Called on a worker thread, compiles queued blocks until none are left.
+	void RunAsyncCompiles();
+
 protected:
 	bool CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	bool InstallBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload);
+	bool CompileAsync(u32 em_address);
+	bool ReuseBlock(u32 em_address);
+
+	// Compiled but not yet installed, for preloading whole functions.
+	struct PreloadedBlock {
+		u32 em_address = 0;
+		u32 mipsBytes = 0;
+		std::vector<IRInst> instructions;
+	};
+	void GatherFunctionBlocks(IRFrontend &frontend, u32 start_address, u32 length, std::vector<PreloadedBlock> &blocks);
+	bool InstallFunctionBlocks(const std::vector<PreloadedBlock> &blocks);
+	void StopAsyncCompiles();
+	bool LookupPersistentBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes);
+	void LoadPersistentCache(const Path &filename);
+	void SavePersistentCache(const Path &filename);
+	u32 GetPersistentCacheFlags() const;
+
 	virtual bool CompileNativeBlock(IRBlockCache *irBlockCache, int block_num, bool preload) { return true; }
 	virtual void FinalizeNativeBlock(IRBlockCache *irBlockCache, int block_num) {}
 
@@ -253,6 +308,46 @@ class IRJit : public JitInterface {
 
 	bool compilerEnabled_ = true;
 
+	// IR from previous sessions, keyed by MIPS start address. Validated by hash on use.
+	struct PersistentBlock {
+		u32 origSize;
+		u64 hash;
+		std::vector<IRInst> instructions;
+	};
+	std::unordered_map<u32, PersistentBlock> persistentBlocks_;
+	Path persistentCachePath_;
+	u32 persistentCacheFlags_ = 0;
+
+	// Background compilation, used by the IR interpreter only.
+	struct AsyncCompileRequest {
+		u32 em_address;
+		u32 flags;
+		u32 generation;
+		bool startDefaultPrefix;
+		bool hasSetRounding;
+	};
+	struct AsyncCompileResult {
+		u32 mipsBytes = 0;
+		u64 hash = 0;
+		u32 flags = 0;
+		std::vector<IRInst> instructions;
+	};
+	bool asyncCompile_ = false;
+	std::unique_ptr<IRFrontend> asyncFrontend_;
+	// Held by the worker while compiling, and by us when the block list is reallocated.
+	// The frontend resolves emuhacks through the block list.
+	std::mutex asyncCompileLock_;
+	std::mutex asyncQueueLock_;
+	std::vector<AsyncCompileRequest> asyncQueue_;
+	std::unordered_set<u32> asyncPending_;
+	std::unordered_map<u32, AsyncCompileResult> asyncResults_;
+	// Bumped by ClearCache(), so results compiled against the old cache are dropped.
+	u32 asyncGeneration_ = 0;
+	bool asyncTaskRunning_ = false;
+	std::atomic<bool> asyncCancel_{};
+	// Shared with the queued tasks, which may outlive us if they never get scheduled.
+	std::shared_ptr<IRAsyncCompileControl> asyncControl_;
+
 	// where to write branch-likely trampolines. not used atm
 	// u32 blTrampolines_;
 	// int blTrampolineCount_;
@@ -19,8 +19,10 @@
 #include <climits>
 #include <thread>
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
+#include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/MemMap.h"
@@ -45,6 +47,9 @@ static constexpr double debugStatsFrequency = 5.0;
 
 static std::thread debugProfilerThread;
 std::atomic<bool> debugProfilerThreadStatus = false;
+// Unlike debugSeenPCUsage, never reset, for exporting.
+static constexpr int profilerStatusCount = (int)IRProfilerStatus::IR_INTERPRET + 1;
+static std::atomic<int64_t> debugStatusSamples[profilerStatusCount];
 
 template <int N>
 class IRProfilerTopValues {
@@ -181,6 +186,19 @@ int IRNativeBackend::ReportBadAddress(uint32_t addr, uint32_t alignment, uint32_
 	return 0;
 }
 
+void IRNativeBackend::RunInterpretedBlock(IRNativeBackend *backend, int block_num) {
+	IRBlock *block = backend->blocks_.GetBlockUnchecked(block_num);
+	currentMIPS->pc = IRInterpret(currentMIPS, backend->blocks_.GetBlockInstructionPtr(*block));
+
+	IRNativeBlock &nativeBlock = backend->nativeBlocks_[block_num];
+	if (++nativeBlock.executions == backend->tierUpThreshold_ && block->IsValid()) {
+		// We can't compile here, since a full cache would clear the stub we're returning to.
+		// Instead, drop the emuhack so the dispatcher sends us back to Compile() next time.
+		if (block->RestoreOriginalFirstOp(block->GetNativeOffset()))
+			backend->pendingPromotions_[block->GetOriginalStart()] = block_num;
+	}
+}
+
 IRNativeBackend::IRNativeBackend(IRBlockCache &blocks) : blocks_(blocks) {}
 
 IRNativeBackend::~IRNativeBackend() {
@@ -411,6 +429,12 @@ void IRNativeBackend::CompileIRInst(IRInst inst) {
 		CompIR_VecHoriz(inst);
 		break;
 
+	case IROp::Vec4MatMul:
+	case IROp::Vec4MatMulTransposed:
+	case IROp::Vec4Transform:
+		CompIR_VecMatrix(inst);
+		break;
+
 	case IROp::Vec2Unpack16To31:
 	case IROp::Vec2Unpack16To32:
 	case IROp::Vec4Unpack8To32:
@@ -440,11 +464,17 @@ void IRNativeBackend::CompileIRInst(IRInst inst) {
 		break;
 
 	case IROp::Syscall:
+	case IROp::SyscallFast:
 	case IROp::CallReplacement:
 	case IROp::Break:
 		CompIR_System(inst);
 		break;
 
+	case IROp::IdleLoop:
+		// Rare and calls out anyway, so no point in each backend handling it.
+		CompIR_Generic(inst);
+		break;
+
 	case IROp::Breakpoint:
 	case IROp::MemoryCheck:
 		CompIR_Breakpoint(inst);
@@ -492,6 +522,11 @@ void IRNativeJit::Init(IRNativeBackend &backend) {
 	// Wanted this to be a reference, but vtbls get in the way.  Shouldn't change.
 	hooks_ = backend.GetNativeHooks();
 
+	if (g_Config.iJitTierUpThreshold > 0) {
+		INFO_LOG(Log::JIT, "Tiered compilation enabled, native code after %d executions", g_Config.iJitTierUpThreshold);
+		backend_->SetTierUpThreshold((uint32_t)g_Config.iJitTierUpThreshold);
+	}
+
 	if (enableDebugProfiler && hooks_.profilerPC) {
 		debugProfilerThreadStatus = true;
 		debugProfilerThread = std::thread([&] {
@@ -502,15 +537,49 @@ void IRNativeJit::Init(IRNativeBackend &backend) {
 				if (stat != IRProfilerStatus::NOT_RUNNING && stat != IRProfilerStatus::SYSCALL) {
 					debugSeenPCUsage[std::make_pair(pc, stat)]++;
 				}
+				if ((int)stat >= 0 && (int)stat < profilerStatusCount)
+					debugStatusSamples[(int)stat]++;
 			}
 		});
 	}
 }
 
 bool IRNativeJit::CompileNativeBlock(IRBlockCache *irblockCache, int block_num, bool preload) {
+	if (g_Config.iJitTierUpThreshold > 0)
+		return backend_->CompileInterpretedBlock(irblockCache, block_num);
 	return backend_->CompileBlock(irblockCache, block_num, preload);
 }
 
+void IRNativeJit::Compile(u32 em_address) {
+	int block_num = backend_->TakePendingPromotion(em_address);
+	if (block_num != -1 && PromoteBlock(block_num))
+		return;
+	IRJit::Compile(em_address);
+}
+
+bool IRNativeJit::PromoteBlock(int block_num) {
+	PROFILE_THIS_SCOPE("jitc");
+	TRACE_SCOPE("jit_promote");
+
+	IRBlock *block = blocks_.GetBlock(block_num);
+	// Might've been invalidated since it got hot.
+	if (!block || !block->IsValid())
+		return false;
+
+	// Reuses the existing IR, so this skips the frontend and passes entirely.
+	if (!backend_->CompileBlock(&blocks_, block_num, false)) {
+		// Out of space, IRJit::Compile() will start fresh.
+		ClearCache();
+		return false;
+	}
+	backend_->SetBlockInterpreted(block_num, false);
+
+	block->Finalize(block->GetNativeOffset());
+	// This also relinks any exits that were waiting for this block.
+	FinalizeNativeBlock(&blocks_, block_num);
+	return true;
+}
+
 void IRNativeJit::FinalizeNativeBlock(IRBlockCache *irblockCache, int block_num) {
 	backend_->FinalizeBlock(irblockCache, block_num, jo);
 }
@@ -639,7 +708,7 @@ int IRNativeBackend::OffsetFromCodePtr(const u8 *ptr) {
 
 void IRNativeBackend::FinalizeBlock(IRBlockCache *irBlockCache, int block_num, const JitOptions &jo) {
 	IRBlock *block = irBlockCache->GetBlock(block_num);
-	if (jo.enableBlocklink) {
+	if (jo.enableBlocklink && !nativeBlocks_[block_num].interpreted) {
 		uint32_t pc = block->GetOriginalStart();
 
 		// First, link other blocks to this one now that it's finalized.
@@ -657,7 +726,8 @@ void IRNativeBackend::FinalizeBlock(IRBlockCache *irBlockCache, int block_num, c
 		for (auto &blockExit : outgoing) {
 			int dstBlockNum = blocks_.GetBlockNumberFromStartAddress(blockExit.dest);
 			const IRNativeBlock *nativeBlock = GetNativeBlock(dstBlockNum);
-			if (nativeBlock)
+			// Interpreted stubs don't check downcount, so they can't be linked to.
+			if (nativeBlock && !nativeBlock->interpreted)
 				OverwriteExit(blockExit.offset, blockExit.len, dstBlockNum);
 		}
 	}
@@ -676,6 +746,25 @@ void IRNativeBackend::SetBlockCheckedOffset(int block_num, int offset) {
 	nativeBlocks_[block_num].checkedOffset = offset;
 }
 
+void IRNativeBackend::SetBlockInterpreted(int block_num, bool interpreted) {
+	if (block_num >= (int)nativeBlocks_.size())
+		nativeBlocks_.resize(block_num + 1);
+
+	nativeBlocks_[block_num].interpreted = interpreted;
+	nativeBlocks_[block_num].executions = 0;
+}
+
+int IRNativeBackend::TakePendingPromotion(uint32_t pc) {
+	if (pendingPromotions_.empty())
+		return -1;
+	auto it = pendingPromotions_.find(pc);
+	if (it == pendingPromotions_.end())
+		return -1;
+	int block_num = it->second;
+	pendingPromotions_.erase(it);
+	return block_num;
+}
+
 void IRNativeBackend::AddLinkableExit(int block_num, uint32_t pc, int exitStartOffset, int exitLen) {
 	linksTo_.emplace(pc, block_num);
 
@@ -692,6 +781,7 @@ void IRNativeBackend::EraseAllLinks(int block_num) {
 	if (block_num == -1) {
 		linksTo_.clear();
 		nativeBlocks_.clear();
+		pendingPromotions_.clear();
 	} else {
 		linksTo_.erase(block_num);
 		if (block_num < (int)nativeBlocks_.size())
@@ -727,6 +817,15 @@ JitBlockProfileStats IRNativeBlockCacheDebugInterface::GetBlockProfileStats(int
 	return irBlocks_.GetBlockProfileStats(blockNum);
 }
 
+std::vector<std::pair<const char *, int64_t>> IRNativeBlockCacheDebugInterface::GetProfilerStatusSamples() const {
+	std::vector<std::pair<const char *, int64_t>> samples;
+	if (!enableDebugProfiler)
+		return samples;
+	for (int i = 0; i < profilerStatusCount; ++i)
+		samples.emplace_back(IRProfilerStatusToString((IRProfilerStatus)i), debugStatusSamples[i].load());
+	return samples;
+}
+
 void IRNativeBlockCacheDebugInterface::GetBlockCodeRange(int blockNum, int *startOffset, int *size) const {
 	int blockOffset = irBlocks_.GetBlock(blockNum)->GetNativeOffset();
 	int endOffset = backend_->GetNativeBlock(blockNum)->checkedOffset;
@@ -739,7 +838,15 @@ void IRNativeBlockCacheDebugInterface::GetBlockCodeRange(int blockNum, int *star
 			endOffset = (int)codeBlock_->GetOffset(codeBlock_->GetCodePtr());
 		} else {
 			endOffset = irBlocks_.GetBlock(blockNum + 1)->GetNativeOffset();
-			_assert_msg_(endOffset >= blockOffset, "Next block not sequential, block=%d/%08x, next=%d/%08x", blockNum, blockOffset, blockNum + 1, endOffset);
+		}
+		if (endOffset < blockOffset) {
+			// Tiered compilation recompiles blocks out of order, so find whatever follows it.
+			endOffset = (int)codeBlock_->GetOffset(codeBlock_->GetCodePtr());
+			for (int i = 0; i < GetNumBlocks(); ++i) {
+				int offset = irBlocks_.GetBlock(i)->GetNativeOffset();
+				if (offset > blockOffset && offset < endOffset)
+					endOffset = offset;
+			}
 		}
 	}
 
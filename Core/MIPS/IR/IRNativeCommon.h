@@ -57,6 +57,9 @@ struct IRNativeBlockExit {
 struct IRNativeBlock {
 	int checkedOffset = 0;
 	std::vector<IRNativeBlockExit> exits;
+	// Tiered mode: block is a stub running the IR interpreter, and how often it ran.
+	bool interpreted = false;
+	uint32_t executions = 0;
 };
 
 class IRNativeBackend {
@@ -72,6 +75,8 @@ class IRNativeBackend {
 
 	virtual void GenerateFixedCode(MIPSState *mipsState) = 0;
 	virtual bool CompileBlock(IRBlockCache *irBlockCache, int block_num, bool preload) = 0;
+	// Emits a small stub that runs the block's IR in the interpreter until it's hot.
+	virtual bool CompileInterpretedBlock(IRBlockCache *irBlockCache, int block_num) = 0;
 	virtual void ClearAllBlocks() = 0;
 	virtual void InvalidateBlock(IRBlockCache *irBlockCache, int block_num) = 0;
 	void FinalizeBlock(IRBlockCache *irBlockCache, int block_num, const JitOptions &jo);
@@ -84,6 +89,13 @@ class IRNativeBackend {
 
 	const IRNativeBlock *GetNativeBlock(int block_num) const;
 	void SetBlockCheckedOffset(int block_num, int offset);
+	void SetBlockInterpreted(int block_num, bool interpreted);
+
+	void SetTierUpThreshold(uint32_t threshold) {
+		tierUpThreshold_ = threshold;
+	}
+	// Returns the block number if the interpreted block at this address is ready for native code, or -1.
+	int TakePendingPromotion(uint32_t pc);
 
 	virtual const CodeBlockCommon &CodeBlock() const = 0;
 
@@ -127,6 +139,7 @@ class IRNativeBackend {
 	virtual void CompIR_VecClamp(IRInst inst) = 0;
 	virtual void CompIR_VecHoriz(IRInst inst) = 0;
 	virtual void CompIR_VecLoad(IRInst inst) = 0;
+	virtual void CompIR_VecMatrix(IRInst inst) = 0;
 	virtual void CompIR_VecPack(IRInst inst) = 0;
 	virtual void CompIR_VecStore(IRInst inst) = 0;
 	virtual void CompIR_ValidateAddress(IRInst inst) = 0;
@@ -149,6 +162,9 @@ class IRNativeBackend {
 
 	static int ReportBadAddress(uint32_t addr, uint32_t alignment, uint32_t isWrite);
 
+	// Callback from interpreted block stubs.  Runs the block, sets PC, and counts executions.
+	static void RunInterpretedBlock(IRNativeBackend *backend, int block_num);
+
 	void AddLinkableExit(int block_num, uint32_t pc, int exitStartOffset, int exitLen);
 	void EraseAllLinks(int block_num);
 
@@ -156,6 +172,8 @@ class IRNativeBackend {
 	IRBlockCache &blocks_;
 	std::vector<IRNativeBlock> nativeBlocks_;
 	std::unordered_multimap<uint32_t, int> linksTo_;
+	std::unordered_map<uint32_t, int> pendingPromotions_;
+	uint32_t tierUpThreshold_ = 0;
 };
 
 class IRNativeBlockCacheDebugInterface : public JitBlockCacheDebugInterface {
@@ -167,6 +185,7 @@ class IRNativeBlockCacheDebugInterface : public JitBlockCacheDebugInterface {
 	JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const override;
 	JitBlockMeta GetBlockMeta(int blockNum) const override;
 	JitBlockProfileStats GetBlockProfileStats(int blockNum) const override;
+	std::vector<std::pair<const char *, int64_t>> GetProfilerStatusSamples() const override;
 	void ComputeStats(BlockCacheStats &bcStats) const override;
 	bool IsValidBlock(int blockNum) const override;
 
@@ -194,10 +213,13 @@ class IRNativeJit : public IRJit {
 
 	void UpdateFCR31() override;
 
+	void Compile(u32 em_address) override;
+
 	JitBlockCacheDebugInterface *GetBlockCacheDebugInterface() override;
 
 protected:
 	void Init(IRNativeBackend &backend);
+	bool PromoteBlock(int block_num);
 	bool CompileNativeBlock(IRBlockCache *irBlockCache, int block_num, bool preload) override;
 	void FinalizeNativeBlock(IRBlockCache *irBlockCache, int block_num) override;
 
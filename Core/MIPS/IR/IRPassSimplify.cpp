@@ -822,6 +822,9 @@ bool PropagateConstants(const IRWriter &in, IRWriter &out, const IROptions &opts
 		case IROp::Vec4Blend:
 		case IROp::Vec4Neg:
 		case IROp::Vec4Abs:
+		case IROp::Vec4MatMul:
+		case IROp::Vec4MatMulTransposed:
+		case IROp::Vec4Transform:
 		case IROp::Vec4Pack31To8:
 		case IROp::Vec4Pack32To8:
 		case IROp::Vec2Pack32To16:
@@ -926,7 +929,9 @@ bool PropagateConstants(const IRWriter &in, IRWriter &out, const IROptions &opts
 
 		case IROp::CallReplacement:
 		case IROp::Break:
+		case IROp::IdleLoop:
 		case IROp::Syscall:
+		case IROp::SyscallFast:
 		case IROp::Interpret:
 		case IROp::ExitToConstIfFpFalse:
 		case IROp::ExitToConstIfFpTrue:
@@ -1008,9 +1013,9 @@ bool PurgeTemps(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 
 		bool result = false;
 		*directly = true;
-		for (int i = 0; i < 4; ++i) {
+		for (int i = 0; i < check.fplen; ++i) {
 			bool laneDirectly;
-			if (check.fplen >= i + 1 && IRReadsFromFPR(inst, check.reg - 32 + i, &laneDirectly)) {
+			if (IRReadsFromFPR(inst, check.reg - 32 + i, &laneDirectly)) {
 				result = true;
 				if (!laneDirectly) {
 					*directly = false;
@@ -1093,6 +1098,8 @@ bool PurgeTemps(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 					int srclen = 1;
 					if (type == 'V')
 						srclen = 4;
+					else if (type == 'M')
+						srclen = 16;
 					else if (type == '2')
 						srclen = 2;
 					else if (type != 'F')
@@ -1172,7 +1179,7 @@ bool PurgeTemps(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 				insts[check.index].src1 = 0;
 				check.reg = 0;
 			} else if (IRWritesToFPR(inst, check.reg - 32) && check.fplen >= 1) {
-				IRReg destFPRs[4];
+				IRReg destFPRs[16];
 				int numFPRs = IRDestFPRs(inst, destFPRs);
 
 				if (numFPRs == check.fplen && inst.dest + 32 == check.reg) {
@@ -1234,7 +1241,7 @@ bool PurgeTemps(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 			break;
 		}
 
-		IRReg regs[16];
+		IRReg regs[32];
 		int readGPRs = IRReadsFromGPRs(inst, regs);
 		if (readGPRs == -1) {
 			for (int j = 0; j < 256; ++j)
@@ -1923,6 +1930,14 @@ bool ReduceVec4Flush(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 				isUsed[r + i] = true;
 			break;
 
+		case 'M':
+			_dbg_assert_((r & 3) == 0);
+			for (int i = 0; i < 16; ++i) {
+				isVec4[r + (i & ~3)] = true;
+				isUsed[r + i] = true;
+			}
+			break;
+
 		case '2':
 			downgraded = isVec4[r & ~3];
 			isVec4[r & ~3] = false;
@@ -1948,6 +1963,12 @@ bool ReduceVec4Flush(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 				isVec4Dirty[r] = true;
 				break;
 
+			case 'M':
+				_dbg_assert_((r & 3) == 0);
+				for (int i = 0; i < 16; i += 4)
+					isVec4Dirty[r + i] = true;
+				break;
+
 			case '2':
 				isVec4Dirty[r & ~3] = false;
 				break;
@@ -2012,6 +2033,11 @@ bool ReduceVec4Flush(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 					return true;
 				if (m->types[2] == 'V' && inst.src2 == r)
 					return true;
+				auto inMatrix = [r](char type, IRReg base) {
+					return type == 'M' && r >= base && r < base + 16;
+				};
+				if (inMatrix(m->types[0], inst.dest) || inMatrix(m->types[1], inst.src1) || inMatrix(m->types[2], inst.src2))
+					return true;
 			}
 			return false;
 		};
@@ -2271,6 +2297,45 @@ bool OptimizeForInterpreter(const IRWriter &in, IRWriter &out, const IROptions &
 			}
 			out.Write(inst);
 			break;
+		case IROp::Load32:
+			if (!last) {
+				IRInst next = in.GetInstructions()[i + 1];
+				// A load and then a pointer bump, common in loops over arrays.
+				if (next.op == IROp::AddConst && next.src1 == next.dest && next.dest != MIPS_REG_ZERO &&
+					(s32)inst.constant == (s16)inst.constant && (s32)next.constant == (s16)next.constant) {
+					inst.op = IROp::OptLoad32AddConst;
+					inst.src2 = next.dest;
+					inst.constant = (inst.constant & 0xFFFF) | (next.constant << 16);
+					i++;  // Skip the next instruction.
+				}
+			}
+			out.Write(inst);
+			break;
+		case IROp::Slt:
+		case IROp::SltU:
+			if (!last && inst.dest != MIPS_REG_ZERO) {
+				// The downcount normally sits between the compare and the branch.
+				int nextIndex = i + 1;
+				if (!foundDowncount && in.GetInstructions()[nextIndex].op == IROp::Downcount && nextIndex + 1 < n)
+					nextIndex++;
+				IRInst next = in.GetInstructions()[nextIndex];
+				bool testsDest = (next.src1 == inst.dest && next.src2 == MIPS_REG_ZERO) || (next.src1 == MIPS_REG_ZERO && next.src2 == inst.dest);
+				if ((next.op == IROp::ExitToConstIfNeq || next.op == IROp::ExitToConstIfEq) && testsDest) {
+					if (nextIndex != i + 1) {
+						foundDowncount = true;
+						out.ReplaceConstant(0, in.GetInstructions()[i + 1].constant);
+					}
+					bool nonZero = next.op == IROp::ExitToConstIfNeq;
+					if (inst.op == IROp::Slt)
+						inst.op = nonZero ? IROp::OptSltExitIfNonZero : IROp::OptSltExitIfZero;
+					else
+						inst.op = nonZero ? IROp::OptSltUExitIfNonZero : IROp::OptSltUExitIfZero;
+					inst.constant = next.constant;
+					i = nextIndex;  // Skip what we merged.
+				}
+			}
+			out.Write(inst);
+			break;
 		case IROp::FMovToGPR:
 			if (!last) {
 				IRInst next = in.GetInstructions()[i + 1];
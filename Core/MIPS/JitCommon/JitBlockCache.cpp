@@ -17,11 +17,14 @@
 
 #include "ppsspp_config.h"
 #include <cstddef>
+#include <cstring>
 #include <algorithm>
 
 #include "ext/xxhash.h"
 #include "Common/CommonTypes.h"
+#include "Common/Data/Format/JSONWriter.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/StringUtils.h"
 
 #ifdef _WIN32
 #include "Common/CommonWindows.h"
@@ -32,6 +35,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/Reporting.h"
 #include "Core/Config.h"
+#include "Core/Debugger/SymbolMap.h"
 
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSTables.h"
@@ -122,6 +126,7 @@ void JitBlockCache::Shutdown() {
 void JitBlockCache::Clear() {
 	block_map_.clear();
 	proxyBlockMap_.clear();
+	memset(codePages_, 0, sizeof(codePages_));
 	for (int i = 0; i < num_blocks_; i++)
 		DestroyBlock(i, DestroyType::CLEAR);
 	links_to_.clear();
@@ -220,6 +225,7 @@ void JitBlockCache::AddBlockMap(int block_num) {
 	// Convert the logical address to a physical address for the block map
 	u32 pAddr = b.originalAddress & 0x1FFFFFFF;
 	block_map_[std::make_pair(pAddr + 4 * b.originalSize, pAddr)] = block_num;
+	MarkCodePages(pAddr, pAddr + 4 * b.originalSize);
 }
 
 void JitBlockCache::RemoveBlockMap(int block_num) {
@@ -243,6 +249,30 @@ void JitBlockCache::RemoveBlockMap(int block_num) {
 	}
 }
 
+void JitBlockCache::MarkCodePages(u32 pAddr, u32 pEnd) {
+	const u32 startPage = pAddr >> CODE_PAGE_SHIFT;
+	const u32 endPage = std::min((std::max(pEnd, pAddr + 1) - 1) >> CODE_PAGE_SHIFT, (u32)NUM_CODE_PAGES - 1);
+	for (u32 page = startPage; page <= endPage; ++page)
+		codePages_[page >> 5] |= 1U << (page & 31);
+}
+
+bool JitBlockCache::RangeHasCodePages(u32 pAddr, u32 pEnd) const {
+	if (pEnd <= pAddr)
+		return false;
+	const u32 startPage = pAddr >> CODE_PAGE_SHIFT;
+	const u32 endPage = std::min((pEnd - 1) >> CODE_PAGE_SHIFT, (u32)NUM_CODE_PAGES - 1);
+	for (u32 page = startPage; page <= endPage; ++page) {
+		// Skip whole empty words quickly, large memcpys are common.
+		if ((page & 31) == 0 && codePages_[page >> 5] == 0 && page + 31 <= endPage) {
+			page += 31;
+			continue;
+		}
+		if (codePages_[page >> 5] & (1U << (page & 31)))
+			return true;
+	}
+	return false;
+}
+
 static void ExpandRange(std::pair<u32, u32> &range, u32 newStart, u32 newEnd) {
 	range.first = std::min(range.first, newStart);
 	range.second = std::max(range.second, newEnd);
@@ -381,6 +411,9 @@ int JitBlockCache::GetBlockNumberFromStartAddress(u32 addr, bool realBlocksOnly)
 }
 
 void JitBlockCache::GetBlockNumbersFromAddress(u32 em_address, std::vector<int> *block_numbers) {
+	const u32 pAddr = em_address & 0x1FFFFFFF;
+	if (!RangeHasCodePages(pAddr, pAddr + 4))
+		return;
 	for (int i = 0; i < num_blocks_; i++)
 		if (blocks_[i].ContainsAddress(em_address))
 			block_numbers->push_back(i);
@@ -603,6 +636,12 @@ void JitBlockCache::InvalidateICache(u32 address, const u32 length) {
 		return;
 	}
 
+	if (!RangeHasCodePages(pAddr, pEnd)) {
+		invalidateMisses_++;
+		return;
+	}
+	invalidateHits_++;
+
 	// Blocks may start and end in overlapping ways, and destroying one invalidates iterators.
 	// So after destroying one, we start over.
 	do {
@@ -689,6 +728,8 @@ void JitBlockCache::ComputeStats(BlockCacheStats &bcStats) const {
 	bcStats.minBloat = (float)minBloat;
 	bcStats.maxBloat = (float)maxBloat;
 	bcStats.avgBloat = (float)(totalBloat / (double)num_blocks_);
+	bcStats.invalidateHits = invalidateHits_;
+	bcStats.invalidateMisses = invalidateMisses_;
 }
 
 JitBlockDebugInfo JitBlockCache::GetBlockDebugInfo(int blockNum) const {
@@ -714,3 +755,84 @@ JitBlockDebugInfo JitBlockCache::GetBlockDebugInfo(int blockNum) const {
 #endif
 	return debugInfo;
 }
+
+std::vector<JitBlockProfileEntry> CollectJitBlockProfile(const JitBlockCacheDebugInterface *blockCache) {
+	std::vector<JitBlockProfileEntry> entries;
+	int numBlocks = blockCache->GetNumBlocks();
+	entries.reserve(numBlocks);
+	for (int i = 0; i < numBlocks; ++i) {
+		if (!blockCache->IsValidBlock(i))
+			continue;
+		JitBlockMeta meta = blockCache->GetBlockMeta(i);
+		entries.push_back(JitBlockProfileEntry{ meta.addr, meta.sizeInBytes, blockCache->GetBlockProfileStats(i) });
+	}
+	return entries;
+}
+
+std::string ExportJitBlockProfile(const JitBlockCacheDebugInterface *blockCache, JitProfileFormat format) {
+	std::vector<JitBlockProfileEntry> entries = CollectJitBlockProfile(blockCache);
+	std::vector<std::pair<const char *, int64_t>> samples = blockCache->GetProfilerStatusSamples();
+	auto symbolName = [](u32 addr) {
+		return g_symbolMap ? g_symbolMap->GetDescription(addr) : std::string();
+	};
+
+	if (format == JitProfileFormat::CSV) {
+		// Status rows reuse the executions column for their sample count.
+		std::string csv = "type,address,size,executions,total_ns,name\n";
+		for (const JitBlockProfileEntry &entry : entries) {
+			std::string name = symbolName(entry.addr);
+			// Keep the columns intact, symbol names can in theory contain anything.
+			std::replace(name.begin(), name.end(), ',', ' ');
+			csv += StringFromFormat("block,%08x,%u,%lld,%lld,%s\n", entry.addr, entry.sizeInBytes, (long long)entry.stats.executions, (long long)entry.stats.totalNanos, name.c_str());
+		}
+		for (const auto &sample : samples) {
+			csv += StringFromFormat("status,,,%lld,,%s\n", (long long)sample.second, sample.first);
+		}
+		return csv;
+	}
+
+	// There are no timestamps, so sort by time spent and put the blocks one after another.
+	std::sort(entries.begin(), entries.end(), [](const JitBlockProfileEntry &a, const JitBlockProfileEntry &b) {
+		return a.stats.totalNanos > b.stats.totalNanos;
+	});
+
+	json::JsonWriter json;
+	json.begin();
+	json.pushArray("traceEvents");
+	double ts = 0.0;
+	for (const JitBlockProfileEntry &entry : entries) {
+		if (entry.stats.executions == 0)
+			continue;
+		double dur = (double)entry.stats.totalNanos / 1000.0;
+		json.pushDict();
+		std::string name = symbolName(entry.addr);
+		json.writeString("name", StringFromFormat("%08x %s", entry.addr, name.c_str()));
+		json.writeString("cat", "block");
+		json.writeString("ph", "X");
+		json.writeFloat("ts", ts);
+		json.writeFloat("dur", dur);
+		json.writeInt("pid", 1);
+		json.writeInt("tid", 1);
+		json.pushDict("args");
+		json.writeUint("size", entry.sizeInBytes);
+		json.writeFloat("executions", (double)entry.stats.executions);
+		json.pop();
+		json.pop();
+		ts += dur;
+	}
+	for (const auto &sample : samples) {
+		json.pushDict();
+		json.writeString("name", sample.first);
+		json.writeString("cat", "status");
+		json.writeString("ph", "C");
+		json.writeFloat("ts", 0.0);
+		json.writeInt("pid", 1);
+		json.pushDict("args");
+		json.writeFloat("samples", (double)sample.second);
+		json.pop();
+		json.pop();
+	}
+	json.pop();
+	json.end();
+	return json.str();
+}
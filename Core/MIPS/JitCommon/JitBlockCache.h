@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <map>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <string>
 
@@ -42,6 +43,9 @@ struct BlockCacheStats {
 	u32 minBloatBlock;
 	float maxBloat;
 	u32 maxBloatBlock;
+	// InvalidateICache calls that touched code pages, and ones skipped because they didn't.
+	u64 invalidateHits;
+	u64 invalidateMisses;
 };
 
 enum class DestroyType {
@@ -123,10 +127,28 @@ class JitBlockCacheDebugInterface {
 	virtual void ComputeStats(BlockCacheStats &bcStats) const = 0;
 	virtual bool IsValidBlock(int blockNum) const = 0;
 	virtual bool SupportsProfiling() const { return false; }
+	// Sample counts per profiler category (in jit, compiling, syscall...), empty if there's no sampling profiler.
+	virtual std::vector<std::pair<const char *, int64_t>> GetProfilerStatusSamples() const { return {}; }
 
 	virtual ~JitBlockCacheDebugInterface() {}
 };
 
+struct JitBlockProfileEntry {
+	uint32_t addr;
+	uint32_t sizeInBytes;
+	JitBlockProfileStats stats;
+};
+
+enum class JitProfileFormat {
+	CSV,
+	CHROME_TRACE,
+};
+
+// Valid blocks only, in block number order.
+std::vector<JitBlockProfileEntry> CollectJitBlockProfile(const JitBlockCacheDebugInterface *blockCache);
+// For diffing runs offline, CHROME_TRACE lays the totals out end to end for chrome://tracing / Perfetto.
+std::string ExportJitBlockProfile(const JitBlockCacheDebugInterface *blockCache, JitProfileFormat format);
+
 class JitBlockCache : public JitBlockCacheDebugInterface {
 public:
 	JitBlockCache(MIPSState *mipsState, CodeBlockCommon *codeBlock);
@@ -184,7 +206,7 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 		if (IsValidBlock(blockNum)) {
 			meta.valid = true;
 			meta.addr = blocks_[blockNum].originalAddress;
-			meta.sizeInBytes = blocks_[blockNum].originalSize;
+			meta.sizeInBytes = blocks_[blockNum].originalSize * 4;
 		}
 		return meta;
 	}
@@ -207,6 +229,9 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 
 	void AddBlockMap(int block_num);
 	void RemoveBlockMap(int block_num);
+	// Physical addresses.  Pages are only unmarked on Clear(), so this is conservative.
+	void MarkCodePages(u32 pAddr, u32 pEnd);
+	bool RangeHasCodePages(u32 pAddr, u32 pEnd) const;
 
 	MIPSOpcode GetEmuHackOpForBlock(int block_num) const;
 
@@ -226,6 +251,15 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 	};
 	std::pair<u32, u32> blockMemRanges_[3];
 
+	enum {
+		CODE_PAGE_SHIFT = 10,
+		NUM_CODE_PAGES = 0x20000000 >> CODE_PAGE_SHIFT,
+	};
+	// One bit per page of physical memory that has had a block compiled in it.
+	u32 codePages_[NUM_CODE_PAGES / 32]{};
+	u64 invalidateHits_ = 0;
+	u64 invalidateMisses_ = 0;
+
 	enum {
 		// Where does this number come from?
 		MAX_NUM_BLOCKS = 65536 * 4
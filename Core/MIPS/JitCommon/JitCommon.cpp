@@ -16,13 +16,16 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <algorithm>
 #include <cstdlib>
 #include <mutex>
 
 #include "ext/disarm.h"
 #include "ext/riscv-disas.h"
 #include "ext/udis86/udis86.h"
+#include "ext/xxhash.h"
 
+#include "Common/CPUDetect.h"
 #include "Common/LogReporting.h"
 #include "Common/StringUtils.h"
 #include "Common/Serialize/Serializer.h"
@@ -30,6 +33,7 @@
 
 #include "Core/Util/DisArm64.h"
 #include "Core/Config.h"
+#include "Core/MemMap.h"
 
 #include "Core/MIPS/IR/IRJit.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
@@ -39,6 +43,7 @@
 
 #if PPSSPP_ARCH(ARM)
 #include "../ARM/ArmJit.h"
+#include "../ARM/ArmIRJit.h"
 #elif PPSSPP_ARCH(ARM64)
 #include "../ARM64/Arm64Jit.h"
 #include "../ARM64/Arm64IRJit.h"
@@ -49,6 +54,8 @@
 #include "../MIPS/MipsJit.h"
 #elif PPSSPP_ARCH(RISCV64)
 #include "../RiscV/RiscVJit.h"
+#elif PPSSPP_ARCH(LOONGARCH64)
+#include "../LoongArch64/LoongArch64Jit.h"
 #else
 #include "../fake/FakeJit.h"
 #endif
@@ -77,6 +84,46 @@ namespace MIPSComp {
 		}
 	}
 
+	static u64 HashBlockRange(const JitBlockMeta &meta) {
+		if (!meta.valid || meta.sizeInBytes == 0 || !Memory::IsValidRange(meta.addr, meta.sizeInBytes))
+			return 0;
+		return XXH3_64bits(Memory::GetPointerUnchecked(meta.addr), meta.sizeInBytes);
+	}
+
+	std::vector<u64> HashBlockCode(JitInterface *jit) {
+		std::vector<u64> hashes;
+		JitBlockCacheDebugInterface *blocks = jit->GetBlockCacheDebugInterface();
+		if (!blocks)
+			return hashes;
+
+		hashes.resize(blocks->GetNumBlocks());
+		for (int i = 0; i < (int)hashes.size(); ++i)
+			hashes[i] = HashBlockRange(blocks->GetBlockMeta(i));
+		return hashes;
+	}
+
+	int InvalidateChangedBlockCode(JitInterface *jit, const std::vector<u64> &hashes) {
+		JitBlockCacheDebugInterface *blocks = jit->GetBlockCacheDebugInterface();
+		if (!blocks || blocks->GetNumBlocks() != (int)hashes.size()) {
+			jit->ClearCache();
+			return 0;
+		}
+
+		int kept = 0;
+		for (int i = 0; i < (int)hashes.size(); ++i) {
+			// Invalidating one block can take others with it, so check each time.
+			JitBlockMeta meta = blocks->GetBlockMeta(i);
+			if (!meta.valid)
+				continue;
+			if (hashes[i] != 0 && HashBlockRange(meta) == hashes[i]) {
+				kept++;
+				continue;
+			}
+			jit->InvalidateCacheAt(meta.addr, std::max(meta.sizeInBytes, (uint32_t)4));
+		}
+		return kept;
+	}
+
 	BranchInfo::BranchInfo(u32 pc, MIPSOpcode o, MIPSOpcode delayO, bool al, bool l)
 		: compilerPC(pc), op(o), delaySlotOp(delayO), likely(l), andLink(al) {
 		delaySlotInfo = MIPSGetInfo(delaySlotOp).value;
@@ -105,6 +152,9 @@ namespace MIPSComp {
 
 	JitInterface *CreateNativeJit(MIPSState *mipsState, bool useIR) {
 #if PPSSPP_ARCH(ARM)
+		// The IR backend uses NEON for vector ops.
+		if (useIR && cpu_info.bNEON)
+			return new MIPSComp::ArmIRJit(mipsState);
 		return new MIPSComp::ArmJit(mipsState);
 #elif PPSSPP_ARCH(ARM64)
 		if (useIR)
@@ -118,6 +168,11 @@ namespace MIPSComp {
 		return new MIPSComp::MipsJit(mipsState);
 #elif PPSSPP_ARCH(RISCV64)
 		return new MIPSComp::RiscVJit(mipsState);
+#elif PPSSPP_ARCH(LOONGARCH64)
+		// The native backend maps Vec4 ops to LSX, so it requires it.
+		if (cpu_info.LOONGARCH_LSX)
+			return new MIPSComp::LoongArch64Jit(mipsState);
+		return new MIPSComp::IRJit(mipsState, false);
 #else
 		return new MIPSComp::FakeJit(mipsState);
 #endif
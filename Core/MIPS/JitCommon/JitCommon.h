@@ -19,6 +19,7 @@
 
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -137,6 +138,11 @@ namespace MIPSComp {
 		virtual void RunLoopUntil(u64 globalticks) = 0;
 		virtual void Compile(u32 em_address) = 0;
 		virtual void CompileFunction(u32 start_address, u32 length) { }
+		// Ranges are (start, length) pairs, backends may compile them in parallel.
+		virtual void CompileFunctions(const std::vector<std::pair<u32, u32>> &ranges) {
+			for (const auto &range : ranges)
+				CompileFunction(range.first, range.second);
+		}
 		virtual void ClearCache() = 0;
 		virtual void UpdateFCR31() = 0;
 		virtual MIPSOpcode GetOriginalOp(MIPSOpcode op) = 0;
@@ -177,5 +183,10 @@ namespace MIPSComp {
 
 	void DoDummyJitState(PointerWrap &p);
 
+	// For loading states without throwing away the jit.  Call with emuhacks cleared.
+	std::vector<u64> HashBlockCode(JitInterface *jit);
+	// Invalidates any block whose code no longer matches.  Returns how many were kept.
+	int InvalidateChangedBlockCode(JitInterface *jit, const std::vector<u64> &hashes);
+
 	JitInterface *CreateNativeJit(MIPSState *mipsState, bool useIR);
 }
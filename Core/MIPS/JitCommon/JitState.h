@@ -73,6 +73,8 @@ namespace MIPSComp {
 
 		u8 hasSetRounding = 0;
 		u8 lastSetRounding = 0;
+		// Set when the current block checks on entry that fcr31 is in the default rounding mode.
+		bool blockAssumesDefaultRounding = false;
 		const u8 *currentRoundingFunc = nullptr;
 
 		// VFPU prefix magic
@@ -85,6 +87,11 @@ namespace MIPSComp {
 		PrefixState prefixTFlag = PREFIX_UNKNOWN;
 		PrefixState prefixDFlag = PREFIX_UNKNOWN;
 
+		// Whether the host rounding mode might not be the default here.
+		bool RoundingMayVary() const {
+			return hasSetRounding && !blockAssumesDefaultRounding;
+		}
+
 		void PrefixStart() {
 			if (startDefaultPrefix) {
 				EatPrefix();
@@ -210,8 +217,9 @@ namespace MIPSComp {
 		VFPU_MTX_VMMOV = 0x08000000,
 		VFPU_MTX_VMMUL = 0x10000000,
 		VFPU_MTX_VMSCL = 0x20000000,
+		IDLE_LOOPS = 0x40000000,
 
-		ALL_FLAGS = 0x3FFFFFFF,
+		ALL_FLAGS = 0x7FFFFFFF,
 	};
 
 	struct JitOptions {
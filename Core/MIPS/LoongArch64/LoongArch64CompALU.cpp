@@ -0,0 +1,643 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "Common/CPUDetect.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/LoongArch64/LoongArch64Jit.h"
+#include "Core/MIPS/LoongArch64/LoongArch64RegCache.h"
+
+// This file contains compilation for integer / arithmetic / logic related instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace LoongArch64Gen;
+using namespace LoongArch64JitConstants;
+
+void LoongArch64JitBackend::CompIR_Arith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	bool allowPtrMath = true;
+#ifdef MASKED_PSP_MEMORY
+	// Since we modify it, we can't safely.
+	allowPtrMath = false;
+#endif
+
+	// LoongArch only adds signed immediates, so rewrite a small enough subtract to an add.
+	// We use -2047 and 2048 here because the range swaps.
+	if (inst.op == IROp::SubConst && (int32_t)inst.constant >= -2047 && (int32_t)inst.constant <= 2048) {
+		inst.op = IROp::AddConst;
+		inst.constant = (uint32_t)-(int32_t)inst.constant;
+	}
+
+	switch (inst.op) {
+	case IROp::Add:
+		regs_.Map(inst);
+		ADD_W(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::Sub:
+		regs_.Map(inst);
+		SUB_W(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::AddConst:
+		if ((int32_t)inst.constant >= -2048 && (int32_t)inst.constant <= 2047) {
+			// Typical of stack pointer updates.
+			if (regs_.IsGPRMappedAsPointer(inst.dest) && inst.dest == inst.src1 && allowPtrMath) {
+				regs_.MarkGPRAsPointerDirty(inst.dest);
+				ADDI_D(regs_.RPtr(inst.dest), regs_.RPtr(inst.dest), inst.constant);
+			} else {
+				regs_.Map(inst);
+				ADDI_W(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant);
+				regs_.MarkGPRDirty(inst.dest, true);
+			}
+		} else {
+			regs_.Map(inst);
+			LI(SCRATCH1, (int32_t)inst.constant);
+			ADD_W(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+			regs_.MarkGPRDirty(inst.dest, true);
+		}
+		break;
+
+	case IROp::SubConst:
+		regs_.Map(inst);
+		LI(SCRATCH1, (int32_t)inst.constant);
+		SUB_W(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::Neg:
+		regs_.Map(inst);
+		SUB_W(regs_.R(inst.dest), R_ZERO, regs_.R(inst.src1));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_Logic(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	bool resultNormalized = false;
+	switch (inst.op) {
+	case IROp::And:
+		if (inst.src1 != inst.src2) {
+			regs_.Map(inst);
+			AND(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		} else if (inst.src1 != inst.dest) {
+			regs_.Map(inst);
+			MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+			regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+		}
+		break;
+
+	case IROp::Or:
+		if (inst.src1 != inst.src2) {
+			// If both were normalized before, the result is normalized.
+			resultNormalized = regs_.IsNormalized32(inst.src1) && regs_.IsNormalized32(inst.src2);
+			regs_.Map(inst);
+			OR(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+			regs_.MarkGPRDirty(inst.dest, resultNormalized);
+		} else if (inst.src1 != inst.dest) {
+			regs_.Map(inst);
+			MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+			regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+		}
+		break;
+
+	case IROp::Xor:
+		if (inst.src1 == inst.src2) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else {
+			regs_.Map(inst);
+			XOR(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		}
+		break;
+
+	case IROp::AndConst:
+		resultNormalized = regs_.IsNormalized32(inst.src1);
+		regs_.Map(inst);
+		// Unlike ADDI, the logic immediates are zero extended.
+		if (inst.constant <= 0xFFF) {
+			ANDI(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant);
+		} else {
+			LI(SCRATCH1, (int32_t)inst.constant);
+			AND(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+		}
+		// If the sign bits aren't cleared, and it was normalized before - it still is.
+		if ((inst.constant & 0x80000000) != 0 && resultNormalized)
+			regs_.MarkGPRDirty(inst.dest, true);
+		// Otherwise, if we cleared the sign bits, it's naturally normalized.
+		else if ((inst.constant & 0x80000000) == 0)
+			regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::OrConst:
+		resultNormalized = regs_.IsNormalized32(inst.src1);
+		regs_.Map(inst);
+		if (inst.constant <= 0xFFF) {
+			ORI(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant);
+		} else {
+			LI(SCRATCH1, (int32_t)inst.constant);
+			OR(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+		}
+		// Since our constant is normalized, oring its bits in won't hurt normalization.
+		regs_.MarkGPRDirty(inst.dest, resultNormalized);
+		break;
+
+	case IROp::XorConst:
+		regs_.Map(inst);
+		if (inst.constant <= 0xFFF) {
+			XORI(regs_.R(inst.dest), regs_.R(inst.src1), inst.constant);
+		} else {
+			LI(SCRATCH1, (int32_t)inst.constant);
+			XOR(regs_.R(inst.dest), regs_.R(inst.src1), SCRATCH1);
+		}
+		break;
+
+	case IROp::Not:
+		regs_.Map(inst);
+		NOT(regs_.R(inst.dest), regs_.R(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_Assign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Mov:
+		if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+			regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+		}
+		break;
+
+	case IROp::Ext8to32:
+		regs_.Map(inst);
+		EXT_W_B(regs_.R(inst.dest), regs_.R(inst.src1));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::Ext16to32:
+		regs_.Map(inst);
+		EXT_W_H(regs_.R(inst.dest), regs_.R(inst.src1));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_Bits(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// All of the .W/.2H forms here sign extend their 32-bit result.
+	switch (inst.op) {
+	case IROp::ReverseBits:
+		regs_.Map(inst);
+		BITREV_W(regs_.R(inst.dest), regs_.R(inst.src1));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::BSwap16:
+		regs_.Map(inst);
+		REVB_2H(regs_.R(inst.dest), regs_.R(inst.src1));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::BSwap32:
+		regs_.Map(inst);
+		// Swap the bytes in each half, and then swap the halves.
+		REVB_2H(regs_.R(inst.dest), regs_.R(inst.src1));
+		ROTRI_W(regs_.R(inst.dest), regs_.R(inst.dest), 16);
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::Clz:
+		regs_.Map(inst);
+		// This even sets to 32 when zero, perfect.
+		CLZ_W(regs_.R(inst.dest), regs_.R(inst.src1));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_Shift(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// Like MIPS, the register shifts only use the low 5 bits of the amount.
+	switch (inst.op) {
+	case IROp::Shl:
+		regs_.Map(inst);
+		SLL_W(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::Shr:
+		regs_.Map(inst);
+		SRL_W(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::Sar:
+		regs_.Map(inst);
+		SRA_W(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::Ror:
+		regs_.Map(inst);
+		ROTR_W(regs_.R(inst.dest), regs_.R(inst.src1), regs_.R(inst.src2));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::ShlImm:
+		// Shouldn't happen, but let's be safe of any passes that modify the ops.
+		if (inst.src2 >= 32) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else if (inst.src2 == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+				regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			SLLI_W(regs_.R(inst.dest), regs_.R(inst.src1), inst.src2);
+			regs_.MarkGPRDirty(inst.dest, true);
+		}
+		break;
+
+	case IROp::ShrImm:
+		// Shouldn't happen, but let's be safe of any passes that modify the ops.
+		if (inst.src2 >= 32) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else if (inst.src2 == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+				regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			SRLI_W(regs_.R(inst.dest), regs_.R(inst.src1), inst.src2);
+			regs_.MarkGPRDirty(inst.dest, true);
+		}
+		break;
+
+	case IROp::SarImm:
+		// Shouldn't happen, but let's be safe of any passes that modify the ops.
+		if (inst.src2 >= 32) {
+			regs_.Map(inst);
+			SRAI_W(regs_.R(inst.dest), regs_.R(inst.src1), 31);
+			regs_.MarkGPRDirty(inst.dest, true);
+		} else if (inst.src2 == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+				regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			SRAI_W(regs_.R(inst.dest), regs_.R(inst.src1), inst.src2);
+			regs_.MarkGPRDirty(inst.dest, true);
+		}
+		break;
+
+	case IROp::RorImm:
+		if (inst.src2 == 0) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+				regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+			}
+		} else {
+			regs_.Map(inst);
+			ROTRI_W(regs_.R(inst.dest), regs_.R(inst.src1), inst.src2 & 31);
+			regs_.MarkGPRDirty(inst.dest, true);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_Compare(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	LoongArch64Reg lhs = INVALID_REG;
+	LoongArch64Reg rhs = INVALID_REG;
+	switch (inst.op) {
+	case IROp::Slt:
+		regs_.Map(inst);
+		NormalizeSrc12(inst, &lhs, &rhs, SCRATCH1, SCRATCH2, true);
+
+		SLT(regs_.R(inst.dest), lhs, rhs);
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::SltConst:
+		if (inst.constant == 0) {
+			// Basically, getting the sign bit.  Let's shift instead.
+			regs_.Map(inst);
+			SRLI_W(regs_.R(inst.dest), regs_.R(inst.src1), 31);
+			regs_.MarkGPRDirty(inst.dest, true);
+		} else {
+			regs_.Map(inst);
+			NormalizeSrc1(inst, &lhs, SCRATCH1, false);
+
+			if ((int32_t)inst.constant >= -2048 && (int32_t)inst.constant <= 2047) {
+				SLTI(regs_.R(inst.dest), lhs, (int32_t)inst.constant);
+			} else {
+				LI(SCRATCH2, (int32_t)inst.constant);
+				SLT(regs_.R(inst.dest), lhs, SCRATCH2);
+			}
+			regs_.MarkGPRDirty(inst.dest, true);
+		}
+		break;
+
+	case IROp::SltU:
+		regs_.Map(inst);
+		// It's still fine to sign extend, the biggest just get even bigger.
+		NormalizeSrc12(inst, &lhs, &rhs, SCRATCH1, SCRATCH2, true);
+
+		SLTU(regs_.R(inst.dest), lhs, rhs);
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::SltUConst:
+		if (inst.constant == 0) {
+			regs_.SetGPRImm(inst.dest, 0);
+		} else {
+			regs_.Map(inst);
+			NormalizeSrc1(inst, &lhs, SCRATCH1, false);
+
+			// We sign extend because we're comparing against something normalized.
+			// It's also the most efficient to set.
+			if ((int32_t)inst.constant >= -2048 && (int32_t)inst.constant <= 2047) {
+				SLTUI(regs_.R(inst.dest), lhs, (int32_t)inst.constant);
+			} else {
+				LI(SCRATCH2, (int32_t)inst.constant);
+				SLTU(regs_.R(inst.dest), lhs, SCRATCH2);
+			}
+			regs_.MarkGPRDirty(inst.dest, true);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_CondAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	LoongArch64Reg lhs = INVALID_REG;
+	LoongArch64Reg rhs = INVALID_REG;
+	switch (inst.op) {
+	case IROp::MovZ:
+	case IROp::MovNZ:
+		if (inst.dest == inst.src2)
+			return;
+
+		// We could have a "zero" with wrong upper due to XOR, so we have to normalize.
+		regs_.Map(inst);
+		NormalizeSrc1(inst, &lhs, SCRATCH1, true);
+
+		// MASKEQZ/MASKNEZ let us select without a branch.
+		if (inst.op == IROp::MovZ) {
+			MASKNEZ(SCRATCH2, regs_.R(inst.src2), lhs);
+			MASKEQZ(regs_.R(inst.dest), regs_.R(inst.dest), lhs);
+		} else {
+			MASKEQZ(SCRATCH2, regs_.R(inst.src2), lhs);
+			MASKNEZ(regs_.R(inst.dest), regs_.R(inst.dest), lhs);
+		}
+		OR(regs_.R(inst.dest), regs_.R(inst.dest), SCRATCH2);
+		break;
+
+	case IROp::Max:
+	case IROp::Min:
+		if (inst.src1 != inst.src2) {
+			regs_.Map(inst);
+			NormalizeSrc12(inst, &lhs, &rhs, SCRATCH1, SCRATCH2, true);
+			// There's no scalar MAX/MIN, so compare and select rhs or lhs.
+			// Cheating a bit by using R_RA as a temp...
+			if (inst.op == IROp::Max)
+				SLT(R_RA, lhs, rhs);
+			else
+				SLT(R_RA, rhs, lhs);
+			MASKNEZ(SCRATCH1, lhs, R_RA);
+			MASKEQZ(SCRATCH2, rhs, R_RA);
+			OR(regs_.R(inst.dest), SCRATCH1, SCRATCH2);
+			// Because we had to normalize the inputs, the output is normalized.
+			regs_.MarkGPRDirty(inst.dest, true);
+		} else if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			MOVE(regs_.R(inst.dest), regs_.R(inst.src1));
+			regs_.MarkGPRDirty(inst.dest, regs_.IsNormalized32(inst.src1));
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_HiLo(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::MtLo:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::DIRTY } });
+		BSTRINS_D(regs_.R(IRREG_LO), regs_.R(inst.src1), 31, 0);
+		break;
+
+	case IROp::MtHi:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::DIRTY } });
+		BSTRINS_D(regs_.R(IRREG_LO), regs_.R(inst.src1), 63, 32);
+		break;
+
+	case IROp::MfLo:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::INIT } });
+		// A plain move would leave HI in the upper bits, so might as well normalize.
+		SEXT_W(regs_.R(inst.dest), regs_.R(IRREG_LO));
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	case IROp::MfHi:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::INIT } });
+		SRAI_D(regs_.R(inst.dest), regs_.R(IRREG_LO), 32);
+		regs_.MarkGPRDirty(inst.dest, true);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_Mult(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// MULW.D.W(U) only read the low 32 bits, so no need to normalize.
+	switch (inst.op) {
+	case IROp::Mult:
+		// TODO: Maybe IR could simplify when HI is not needed or clobbered?
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::NOINIT } });
+		MULW_D_W(regs_.R(IRREG_LO), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::MultU:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::NOINIT } });
+		MULW_D_WU(regs_.R(IRREG_LO), regs_.R(inst.src1), regs_.R(inst.src2));
+		break;
+
+	case IROp::Madd:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::DIRTY } });
+		MULW_D_W(SCRATCH1, regs_.R(inst.src1), regs_.R(inst.src2));
+		ADD_D(regs_.R(IRREG_LO), regs_.R(IRREG_LO), SCRATCH1);
+		break;
+
+	case IROp::MaddU:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::DIRTY } });
+		MULW_D_WU(SCRATCH1, regs_.R(inst.src1), regs_.R(inst.src2));
+		ADD_D(regs_.R(IRREG_LO), regs_.R(IRREG_LO), SCRATCH1);
+		break;
+
+	case IROp::Msub:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::DIRTY } });
+		MULW_D_W(SCRATCH1, regs_.R(inst.src1), regs_.R(inst.src2));
+		SUB_D(regs_.R(IRREG_LO), regs_.R(IRREG_LO), SCRATCH1);
+		break;
+
+	case IROp::MsubU:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::DIRTY } });
+		MULW_D_WU(SCRATCH1, regs_.R(inst.src1), regs_.R(inst.src2));
+		SUB_D(regs_.R(IRREG_LO), regs_.R(IRREG_LO), SCRATCH1);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_Div(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// LoongArch doesn't define the result for a zero divisor, so we branch around it.
+	LoongArch64Reg numReg, denomReg;
+	switch (inst.op) {
+	case IROp::Div:
+	{
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::NOINIT } });
+		// DIV.W requires sign extended inputs.
+		NormalizeSrc12(inst, &numReg, &denomReg, SCRATCH1, SCRATCH2, true);
+		LoongArch64Reg loReg = regs_.R(IRREG_LO);
+
+		// Divide by zero: LO = num < 0 ? 1 : -1, HI = num.
+		FixupBranch skipZero = BNEZ(denomReg);
+		// Cheating a bit by using R_RA as a temp...
+		SLT(R_RA, numReg, R_ZERO);
+		SLLI_W(R_RA, R_RA, 1);
+		ADDI_W(loReg, R_RA, -1);
+		BSTRINS_D(loReg, numReg, 63, 32);
+		FixupBranch doneZero = B();
+		SetJumpTarget(skipZero);
+
+		// Overflow: LO = 0x80000000, HI = -1.
+		LI(R_RA, (int32_t)0x80000000);
+		FixupBranch notMostNegative = BNE(numReg, R_RA);
+		LI(R_RA, -1);
+		FixupBranch notNegativeOne = BNE(denomReg, R_RA);
+		BSTRINS_D(R_RA, numReg, 31, 0);
+		MOVE(loReg, R_RA);
+		FixupBranch doneOverflow = B();
+		SetJumpTarget(notNegativeOne);
+		SetJumpTarget(notMostNegative);
+
+		DIV_W(loReg, numReg, denomReg);
+		MOD_W(R_RA, numReg, denomReg);
+		BSTRINS_D(loReg, R_RA, 63, 32);
+
+		SetJumpTarget(doneZero);
+		SetJumpTarget(doneOverflow);
+		break;
+	}
+
+	case IROp::DivU:
+	{
+		regs_.MapWithExtra(inst, { { 'G', IRREG_LO, 2, MIPSMap::NOINIT } });
+		// DIV.WU also requires sign extended inputs.
+		NormalizeSrc12(inst, &numReg, &denomReg, SCRATCH1, SCRATCH2, true);
+		LoongArch64Reg loReg = regs_.R(IRREG_LO);
+
+		// Divide by zero: LO = num <= 0xFFFF ? 0xFFFF : -1, HI = num.
+		FixupBranch skipZero = BNEZ(denomReg);
+		LI(R_RA, 0xFFFF);
+		FixupBranch keepFFFF = BGEU(R_RA, numReg);
+		LI(R_RA, -1);
+		SetJumpTarget(keepFFFF);
+		MOVE(loReg, R_RA);
+		BSTRINS_D(loReg, numReg, 63, 32);
+		FixupBranch doneZero = B();
+		SetJumpTarget(skipZero);
+
+		DIV_WU(loReg, numReg, denomReg);
+		MOD_WU(R_RA, numReg, denomReg);
+		BSTRINS_D(loReg, R_RA, 63, 32);
+
+		SetJumpTarget(doneZero);
+		break;
+	}
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
@@ -0,0 +1,539 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "Core/MIPS/LoongArch64/LoongArch64Jit.h"
+#include "Core/MIPS/LoongArch64/LoongArch64RegCache.h"
+
+// This file contains compilation for floating point related instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace LoongArch64Gen;
+using namespace LoongArch64JitConstants;
+
+void LoongArch64JitBackend::CompIR_FArith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FAdd:
+		regs_.Map(inst);
+		FADD_S(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FSub:
+		regs_.Map(inst);
+		FSUB_S(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FMul:
+		regs_.Map(inst);
+		// We'll assume everyone will make it such that 0 * infinity = NAN properly.
+		// See blame on this comment if that proves untrue.
+		FMUL_S(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FDiv:
+		regs_.Map(inst);
+		FDIV_S(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+		break;
+
+	case IROp::FSqrt:
+		regs_.Map(inst);
+		FSQRT_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FNeg:
+		regs_.Map(inst);
+		FNEG_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_FCondAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+	if (inst.op != IROp::FMin && inst.op != IROp::FMax)
+		INVALIDOP;
+	bool maxCondition = inst.op == IROp::FMax;
+
+	// FMin and FMax are used by VFPU and handle NAN/INF as just a larger exponent.
+	regs_.Map(inst);
+	// If either side is a NAN, it needs to participate in the comparison.
+	FCMP_S(FCond::CUN, FCC0, regs_.F(inst.src1), regs_.F(inst.src2));
+	FixupBranch useNormalCond = BCEQZ(FCC0);
+
+	// Time to use bits... MOVFR2GR sign extends, so SLT compares properly.
+	MOVFR2GR_S(SCRATCH1, regs_.F(inst.src1));
+	MOVFR2GR_S(SCRATCH2, regs_.F(inst.src2));
+
+	// If both are negative, we flip the comparison (not two's compliment.)
+	// We cheat and use RA...
+	AND(R_RA, SCRATCH1, SCRATCH2);
+	SRLI_W(R_RA, R_RA, 31);
+
+	LoongArch64Reg isSrc1LowerReg = regs_.GetAndLockTempGPR();
+	SLT(isSrc1LowerReg, SCRATCH1, SCRATCH2);
+	// Flip the flag (to reverse the min/max) based on if both were negative.
+	XOR(isSrc1LowerReg, isSrc1LowerReg, R_RA);
+	if (maxCondition) {
+		MASKNEZ(SCRATCH1, SCRATCH1, isSrc1LowerReg);
+		MASKEQZ(SCRATCH2, SCRATCH2, isSrc1LowerReg);
+	} else {
+		MASKEQZ(SCRATCH1, SCRATCH1, isSrc1LowerReg);
+		MASKNEZ(SCRATCH2, SCRATCH2, isSrc1LowerReg);
+	}
+	OR(SCRATCH1, SCRATCH1, SCRATCH2);
+
+	MOVGR2FR_W(regs_.F(inst.dest), SCRATCH1);
+	FixupBranch finish = B();
+
+	SetJumpTarget(useNormalCond);
+	if (maxCondition)
+		FMAX_S(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+	else
+		FMIN_S(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.src2));
+	SetJumpTarget(finish);
+}
+
+void LoongArch64JitBackend::CompIR_FAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FMov:
+		if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			FMOV_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		}
+		break;
+
+	case IROp::FAbs:
+		regs_.Map(inst);
+		FABS_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FSign:
+		regs_.Map(inst);
+		MOVFR2GR_S(SCRATCH1, regs_.F(inst.src1));
+		// Shifting out the sign leaves zero only for +/- 0.0.
+		SLLI_W(SCRATCH2, SCRATCH1, 1);
+		// Now build 1.0 with the sign of the source, and mask it out if it was zero.
+		SRLI_W(SCRATCH1, SCRATCH1, 31);
+		LI(R_RA, 1.0f);
+		BSTRINS_W(R_RA, SCRATCH1, 31, 31);
+		MASKEQZ(R_RA, R_RA, SCRATCH2);
+		MOVGR2FR_W(regs_.F(inst.dest), R_RA);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_FRound(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// TODO: If this is followed by a GPR transfer, might want to combine.
+	regs_.Map(inst);
+	// Out of range values saturate like the PSP, but NAN converts to zero.
+	FCMP_S(FCond::CUN, FCC0, regs_.F(inst.src1), regs_.F(inst.src1));
+
+	switch (inst.op) {
+	case IROp::FRound:
+		FTINTRNE_W_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FTrunc:
+		FTINTRZ_W_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FCeil:
+		FTINTRP_W_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FFloor:
+		FTINTRM_W_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+
+	FixupBranch skip = BCEQZ(FCC0);
+	LI(SCRATCH1, 0x7FFFFFFF);
+	MOVGR2FR_W(regs_.F(inst.dest), SCRATCH1);
+	SetJumpTarget(skip);
+}
+
+void LoongArch64JitBackend::CompIR_FCvt(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FCvtWS:
+		regs_.Map(inst);
+		// FCSR tracks fcr31's rounding mode, so FTINT.W.S uses the right one.
+		FCMP_S(FCond::CUN, FCC0, regs_.F(inst.src1), regs_.F(inst.src1));
+		FTINT_W_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		{
+			FixupBranch skip = BCEQZ(FCC0);
+			LI(SCRATCH1, 0x7FFFFFFF);
+			MOVGR2FR_W(regs_.F(inst.dest), SCRATCH1);
+			SetJumpTarget(skip);
+		}
+		break;
+
+	case IROp::FCvtSW:
+		regs_.Map(inst);
+		FFINT_S_W(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FCvtScaledWS:
+		regs_.Map(inst);
+		FCMP_S(FCond::CUN, FCC0, regs_.F(inst.src1), regs_.F(inst.src1));
+		// Prepare the multiplier.
+		LI(SCRATCH1, (float)(1UL << (inst.src2 & 0x1F)));
+		MOVGR2FR_W(SCRATCHF1, SCRATCH1);
+		FMUL_S(regs_.F(inst.dest), regs_.F(inst.src1), SCRATCHF1);
+
+		switch (inst.src2 >> 6) {
+		case 0: FTINTRNE_W_S(regs_.F(inst.dest), regs_.F(inst.dest)); break;
+		case 1: FTINTRZ_W_S(regs_.F(inst.dest), regs_.F(inst.dest)); break;
+		case 2: FTINTRP_W_S(regs_.F(inst.dest), regs_.F(inst.dest)); break;
+		case 3: FTINTRM_W_S(regs_.F(inst.dest), regs_.F(inst.dest)); break;
+		default:
+			_assert_msg_(false, "Invalid rounding mode for FCvtScaledWS");
+		}
+
+		{
+			// Clamping is correct, but NAN needs to become 0x7FFFFFFF.
+			FixupBranch skip = BCEQZ(FCC0);
+			LI(SCRATCH1, 0x7FFFFFFF);
+			MOVGR2FR_W(regs_.F(inst.dest), SCRATCH1);
+			SetJumpTarget(skip);
+		}
+		break;
+
+	case IROp::FCvtScaledSW:
+		regs_.Map(inst);
+		FFINT_S_W(regs_.F(inst.dest), regs_.F(inst.src1));
+
+		// Pre-divide so we can avoid any actual divide.
+		LI(SCRATCH1, 1.0f / (1UL << (inst.src2 & 0x1F)));
+		MOVGR2FR_W(SCRATCHF1, SCRATCH1);
+		FMUL_S(regs_.F(inst.dest), regs_.F(inst.dest), SCRATCHF1);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_FSat(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// Ordered compares are false for NAN, so it will be preserved.
+	switch (inst.op) {
+	case IROp::FSat0_1:
+		regs_.Map(inst);
+		MOVGR2FR_W(SCRATCHF1, R_ZERO);
+		LI(SCRATCH1, 1.0f);
+		MOVGR2FR_W(SCRATCHF2, SCRATCH1);
+
+		// CLE here is intentional to convert -0.0 to +0.0.
+		FCMP_S(FCond::CLE, FCC0, regs_.F(inst.src1), SCRATCHF1);
+		FCMP_S(FCond::CLE, FCC1, SCRATCHF2, regs_.F(inst.src1));
+		FSEL(regs_.F(inst.dest), regs_.F(inst.src1), SCRATCHF1, FCC0);
+		FSEL(regs_.F(inst.dest), regs_.F(inst.dest), SCRATCHF2, FCC1);
+		break;
+
+	case IROp::FSatMinus1_1:
+		regs_.Map(inst);
+		LI(SCRATCH1, -1.0f);
+		MOVGR2FR_W(SCRATCHF1, SCRATCH1);
+		FNEG_S(SCRATCHF2, SCRATCHF1);
+
+		FCMP_S(FCond::CLE, FCC0, regs_.F(inst.src1), SCRATCHF1);
+		FCMP_S(FCond::CLE, FCC1, SCRATCHF2, regs_.F(inst.src1));
+		FSEL(regs_.F(inst.dest), regs_.F(inst.src1), SCRATCHF1, FCC0);
+		FSEL(regs_.F(inst.dest), regs_.F(inst.dest), SCRATCHF2, FCC1);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_FCompare(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	constexpr IRReg IRREG_VFPU_CC = IRREG_VFPU_CTRL_BASE + VFPU_CTRL_CC;
+
+	auto compareToFPCond = [&](FCond cond) {
+		regs_.MapWithExtra(inst, { { 'G', IRREG_FPCOND, 1, MIPSMap::NOINIT } });
+		FCMP_S(cond, FCC0, regs_.F(inst.src1), regs_.F(inst.src2));
+		MOVCF2GR(regs_.R(IRREG_FPCOND), FCC0);
+		regs_.MarkGPRDirty(IRREG_FPCOND, true);
+	};
+
+	// Checks a class of the source, and sets SCRATCH1 to 1 or 0 for a positive check.
+	auto classToScratch1 = [&](uint32_t classMask, bool positive) {
+		regs_.MapFPR(inst.src1);
+		FCLASS_S(SCRATCHF1, regs_.F(inst.src1));
+		MOVFR2GR_S(SCRATCH1, SCRATCHF1);
+		ANDI(SCRATCH1, SCRATCH1, classMask);
+		if (positive)
+			SLTU(SCRATCH1, R_ZERO, SCRATCH1);
+		else
+			SLTUI(SCRATCH1, SCRATCH1, 1);
+	};
+
+	switch (inst.op) {
+	case IROp::FCmp:
+		switch (inst.dest) {
+		case IRFpCompareMode::False:
+			regs_.SetGPRImm(IRREG_FPCOND, 0);
+			break;
+
+		case IRFpCompareMode::EitherUnordered:
+			compareToFPCond(FCond::CUN);
+			break;
+
+		case IRFpCompareMode::EqualOrdered:
+			compareToFPCond(FCond::CEQ);
+			break;
+
+		case IRFpCompareMode::EqualUnordered:
+			compareToFPCond(FCond::CUEQ);
+			break;
+
+		case IRFpCompareMode::LessEqualOrdered:
+			compareToFPCond(FCond::CLE);
+			break;
+
+		case IRFpCompareMode::LessEqualUnordered:
+			compareToFPCond(FCond::CULE);
+			break;
+
+		case IRFpCompareMode::LessOrdered:
+			compareToFPCond(FCond::CLT);
+			break;
+
+		case IRFpCompareMode::LessUnordered:
+			compareToFPCond(FCond::CULT);
+			break;
+
+		default:
+			_assert_msg_(false, "Unexpected IRFpCompareMode %d", inst.dest);
+		}
+		break;
+
+	case IROp::FCmovVfpuCC:
+		regs_.MapWithExtra(inst, { { 'G', IRREG_VFPU_CC, 1, MIPSMap::INIT } });
+		// MOVGR2CF only looks at the lowest bit.
+		if ((inst.src2 & 0xF) == 0) {
+			MOVGR2CF(FCC0, regs_.R(IRREG_VFPU_CC));
+		} else {
+			SRLI_W(SCRATCH1, regs_.R(IRREG_VFPU_CC), inst.src2 & 0xF);
+			MOVGR2CF(FCC0, SCRATCH1);
+		}
+		if ((inst.src2 >> 7) & 1) {
+			FSEL(regs_.F(inst.dest), regs_.F(inst.dest), regs_.F(inst.src1), FCC0);
+		} else {
+			FSEL(regs_.F(inst.dest), regs_.F(inst.src1), regs_.F(inst.dest), FCC0);
+		}
+		break;
+
+	case IROp::FCmpVfpuBit:
+		regs_.MapGPR(IRREG_VFPU_CC, MIPSMap::DIRTY);
+
+		switch (VCondition(inst.dest & 0xF)) {
+		case VC_EQ:
+			regs_.Map(inst);
+			FCMP_S(FCond::CEQ, FCC0, regs_.F(inst.src1), regs_.F(inst.src2));
+			MOVCF2GR(SCRATCH1, FCC0);
+			break;
+		case VC_NE:
+			regs_.Map(inst);
+			FCMP_S(FCond::CUNE, FCC0, regs_.F(inst.src1), regs_.F(inst.src2));
+			MOVCF2GR(SCRATCH1, FCC0);
+			break;
+		case VC_LT:
+			regs_.Map(inst);
+			FCMP_S(FCond::CLT, FCC0, regs_.F(inst.src1), regs_.F(inst.src2));
+			MOVCF2GR(SCRATCH1, FCC0);
+			break;
+		case VC_LE:
+			regs_.Map(inst);
+			FCMP_S(FCond::CLE, FCC0, regs_.F(inst.src1), regs_.F(inst.src2));
+			MOVCF2GR(SCRATCH1, FCC0);
+			break;
+		case VC_GT:
+			regs_.Map(inst);
+			FCMP_S(FCond::CLT, FCC0, regs_.F(inst.src2), regs_.F(inst.src1));
+			MOVCF2GR(SCRATCH1, FCC0);
+			break;
+		case VC_GE:
+			regs_.Map(inst);
+			FCMP_S(FCond::CLE, FCC0, regs_.F(inst.src2), regs_.F(inst.src1));
+			MOVCF2GR(SCRATCH1, FCC0);
+			break;
+		case VC_EZ:
+		case VC_NZ:
+			classToScratch1((uint32_t)FClass::NEG_ZERO | (uint32_t)FClass::POS_ZERO, (inst.dest & 4) == 0);
+			break;
+		case VC_EN:
+		case VC_NN:
+			classToScratch1((uint32_t)FClass::SIGNALING_NAN | (uint32_t)FClass::QUIET_NAN, (inst.dest & 4) == 0);
+			break;
+		case VC_EI:
+		case VC_NI:
+			classToScratch1((uint32_t)FClass::NEG_INF | (uint32_t)FClass::POS_INF, (inst.dest & 4) == 0);
+			break;
+		case VC_ES:
+		case VC_NS:
+			classToScratch1((uint32_t)FClass::SIGNALING_NAN | (uint32_t)FClass::QUIET_NAN | (uint32_t)FClass::NEG_INF | (uint32_t)FClass::POS_INF, (inst.dest & 4) == 0);
+			break;
+		case VC_TR:
+			LI(SCRATCH1, 1);
+			break;
+		case VC_FL:
+			LI(SCRATCH1, 0);
+			break;
+		}
+
+		BSTRINS_W(regs_.R(IRREG_VFPU_CC), SCRATCH1, inst.dest >> 4, inst.dest >> 4);
+		break;
+
+	case IROp::FCmpVfpuAggregate:
+		regs_.MapGPR(IRREG_VFPU_CC, MIPSMap::DIRTY);
+		if (inst.dest == 1) {
+			ANDI(SCRATCH1, regs_.R(IRREG_VFPU_CC), inst.dest);
+			// Negate so 1 becomes all bits set and zero stays zero, then insert as any/all.
+			SUB_W(SCRATCH1, R_ZERO, SCRATCH1);
+		} else {
+			ANDI(SCRATCH1, regs_.R(IRREG_VFPU_CC), inst.dest);
+			// To compare to inst.dest for "all", let's simply subtract it and compare to zero.
+			ADDI_W(SCRATCH2, SCRATCH1, -(int)inst.dest);
+			SLTUI(SCRATCH2, SCRATCH2, 1);
+			// And "any" is just non-zero.
+			SLTU(SCRATCH1, R_ZERO, SCRATCH1);
+			SLLI_W(SCRATCH2, SCRATCH2, 1);
+			OR(SCRATCH1, SCRATCH1, SCRATCH2);
+		}
+
+		// Replace the old any/all bits with our own.
+		BSTRINS_W(regs_.R(IRREG_VFPU_CC), SCRATCH1, 5, 4);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_RoundingMode(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::RestoreRoundingMode:
+		RestoreRoundingMode();
+		break;
+
+	case IROp::ApplyRoundingMode:
+		ApplyRoundingMode();
+		break;
+
+	case IROp::UpdateRoundingMode:
+		// We don't need to do anything, instructions use the FCSR rounding mode.
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_FSpecial(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	auto callFuncF_F = [&](float (*func)(float)) {
+		regs_.FlushBeforeCall();
+		WriteDebugProfilerStatus(IRProfilerStatus::MATH_HELPER);
+
+		// It might be in a non-volatile register.
+		// TODO: May have to handle a transfer if SIMD here.
+		if (regs_.IsFPRMapped(inst.src1)) {
+			FMOV_S(F0, regs_.F(inst.src1));
+		} else {
+			int offset = offsetof(MIPSState, f) + inst.src1 * 4;
+			FLD_S(F0, CTXREG, offset);
+		}
+		QuickCallFunction(func);
+
+		regs_.MapFPR(inst.dest, MIPSMap::NOINIT);
+		// F0 is never allocated, so we always need to move.
+		FMOV_S(regs_.F(inst.dest), F0);
+
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+	};
+
+	switch (inst.op) {
+	case IROp::FSin:
+		callFuncF_F(&vfpu_sin);
+		break;
+
+	case IROp::FCos:
+		callFuncF_F(&vfpu_cos);
+		break;
+
+	case IROp::FRSqrt:
+		regs_.Map(inst);
+		// FRSQRT.S would round only once, so this matches the interpreter better.
+		FSQRT_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		FRECIP_S(regs_.F(inst.dest), regs_.F(inst.dest));
+		break;
+
+	case IROp::FRecip:
+		regs_.Map(inst);
+		FRECIP_S(regs_.F(inst.dest), regs_.F(inst.src1));
+		break;
+
+	case IROp::FAsin:
+		callFuncF_F(&vfpu_asin);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
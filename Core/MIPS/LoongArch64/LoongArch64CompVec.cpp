@@ -0,0 +1,293 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include "Core/MemMap.h"
+#include "Core/MIPS/LoongArch64/LoongArch64Jit.h"
+#include "Core/MIPS/LoongArch64/LoongArch64RegCache.h"
+
+// This file contains compilation for vector instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace LoongArch64Gen;
+using namespace LoongArch64JitConstants;
+
+static bool Overlap(IRReg r1, int l1, IRReg r2, int l2) {
+	return r1 < r2 + l2 && r1 + l1 > r2;
+}
+
+void LoongArch64JitBackend::CompIR_VecAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4Init:
+		regs_.Map(inst);
+		switch (Vec4Init(inst.src1)) {
+		case Vec4Init::AllZERO:
+			VXOR_V(regs_.V(inst.dest), regs_.V(inst.dest), regs_.V(inst.dest));
+			break;
+
+		case Vec4Init::AllONE:
+		case Vec4Init::AllMinusONE:
+			LI(SCRATCH1, Vec4Init(inst.src1) == Vec4Init::AllMinusONE ? -1.0f : 1.0f);
+			VREPLGR2VR_W(regs_.V(inst.dest), SCRATCH1);
+			break;
+
+		case Vec4Init::Set_1000:
+		case Vec4Init::Set_0100:
+		case Vec4Init::Set_0010:
+		case Vec4Init::Set_0001:
+			VXOR_V(regs_.V(inst.dest), regs_.V(inst.dest), regs_.V(inst.dest));
+			LI(SCRATCH1, 1.0f);
+			VINSGR2VR_W(regs_.V(inst.dest), SCRATCH1, inst.src1 - (int)Vec4Init::Set_1000);
+			break;
+
+		default:
+			_assert_msg_(false, "Unexpected Vec4Init value %d", inst.src1);
+			DISABLE;
+		}
+		break;
+
+	case IROp::Vec4Shuffle:
+		if (regs_.GetFPRLaneCount(inst.src1) == 1 && (inst.src1 & 3) == 0 && inst.src2 == 0x00) {
+			// This is a broadcast.  If dest == src1, this won't clear it.
+			regs_.SpillLockFPR(inst.src1);
+			regs_.MapVec4(inst.dest, MIPSMap::NOINIT);
+			VREPLVEI_W(regs_.V(inst.dest), regs_.V(inst.src1), 0);
+		} else if (inst.src2 == 0xE4) {
+			if (inst.dest != inst.src1) {
+				regs_.Map(inst);
+				VOR_V(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src1));
+			}
+		} else {
+			// Luckily, LSX has a shuffle using the same mask format as the IR.
+			regs_.Map(inst);
+			VSHUF4I_W(regs_.V(inst.dest), regs_.V(inst.src1), inst.src2);
+		}
+		break;
+
+	case IROp::Vec4Blend:
+		regs_.Map(inst);
+		if (inst.src1 == inst.src2) {
+			// Shouldn't really happen, just making sure the below doesn't have to think about it.
+			if (inst.dest != inst.src1)
+				VOR_V(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src1));
+			break;
+		}
+
+		// To reduce overlap cases to consider, let's inverse src1/src2 if dest == src2.
+		// Thus, dest could be src1, but no other overlap is possible.
+		if (inst.dest == inst.src2) {
+			std::swap(inst.src1, inst.src2);
+			inst.constant ^= 0xF;
+		}
+
+		if (inst.dest != inst.src1)
+			VOR_V(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src1));
+		for (int i = 0; i < 4; ++i) {
+			if ((inst.constant >> i) & 1)
+				VEXTRINS_W(regs_.V(inst.dest), regs_.V(inst.src2), i, i);
+		}
+		break;
+
+	case IROp::Vec4Mov:
+		if (inst.dest != inst.src1) {
+			regs_.Map(inst);
+			VOR_V(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src1));
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_VecArith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4Add:
+		regs_.Map(inst);
+		VFADD_S(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src2));
+		break;
+
+	case IROp::Vec4Sub:
+		regs_.Map(inst);
+		VFSUB_S(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src2));
+		break;
+
+	case IROp::Vec4Mul:
+		regs_.Map(inst);
+		VFMUL_S(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src2));
+		break;
+
+	case IROp::Vec4Div:
+		regs_.Map(inst);
+		VFDIV_S(regs_.V(inst.dest), regs_.V(inst.src1), regs_.V(inst.src2));
+		break;
+
+	case IROp::Vec4Scale:
+		if (Overlap(inst.dest, 4, inst.src2, 1) || Overlap(inst.src1, 4, inst.src2, 1)) {
+			// Map the scale as part of its vector, and broadcast the lane.
+			regs_.SpillLockFPR(inst.dest, inst.src1);
+			regs_.MapVec4(inst.src1);
+			regs_.MapVec4(inst.src2 & ~3);
+			regs_.MapVec4(inst.dest, MIPSMap::NOINIT);
+			VREPLVEI_W(EncodeRegToV(SCRATCHF1), regs_.V(inst.src2 & ~3), inst.src2 & 3);
+		} else {
+			regs_.Map(inst);
+			VREPLVEI_W(EncodeRegToV(SCRATCHF1), regs_.V(inst.src2), 0);
+		}
+		VFMUL_S(regs_.V(inst.dest), regs_.V(inst.src1), EncodeRegToV(SCRATCHF1));
+		break;
+
+	case IROp::Vec4Neg:
+		regs_.Map(inst);
+		VBITREVI_W(regs_.V(inst.dest), regs_.V(inst.src1), 31);
+		break;
+
+	case IROp::Vec4Abs:
+		regs_.Map(inst);
+		VBITCLRI_W(regs_.V(inst.dest), regs_.V(inst.src1), 31);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_VecHoriz(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	LoongArch64Reg tempReg = EncodeRegToV(SCRATCHF1);
+	LoongArch64Reg swapReg = EncodeRegToV(SCRATCHF2);
+	switch (inst.op) {
+	case IROp::Vec4Dot:
+		if (Overlap(inst.dest, 1, inst.src1, 4) || Overlap(inst.dest, 1, inst.src2, 4)) {
+			// To avoid overlap problems, map a little carefully.
+			regs_.SpillLockFPR(inst.src1, inst.src2);
+			regs_.MapVec4(inst.src1);
+			regs_.MapVec4(inst.src2);
+			regs_.MapVec4(inst.dest & ~3, MIPSMap::DIRTY);
+		} else {
+			regs_.Map(inst);
+		}
+
+		// Pairwise sums, like FADDP: ABCD -> A+B,B+A,C+D,D+C -> (A+B)+(C+D) in lane 0.
+		VFMUL_S(tempReg, regs_.V(inst.src1), regs_.V(inst.src2));
+		VSHUF4I_W(swapReg, tempReg, 0xB1);
+		VFADD_S(tempReg, tempReg, swapReg);
+		VSHUF4I_W(swapReg, tempReg, 0x4E);
+		if (Overlap(inst.dest, 1, inst.src1, 4) || Overlap(inst.dest, 1, inst.src2, 4)) {
+			VFADD_S(tempReg, tempReg, swapReg);
+			VEXTRINS_W(regs_.V(inst.dest & ~3), tempReg, inst.dest & 3, 0);
+		} else {
+			VFADD_S(regs_.V(inst.dest), tempReg, swapReg);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_VecMatrix(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4MatMul:
+	case IROp::Vec4MatMulTransposed:
+	case IROp::Vec4Transform:
+		// Not generated for this backend (see preferVec4Matrix), but just in case.
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_VecPack(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4DuplicateUpperBitsAndShift1:
+		// This operation swizzles the high 8 bits and converts to a signed int.
+		// It's always after Vec4Unpack8To32.
+		// 000A000B000C000D -> AAAABBBBCCCCDDDD and then shift right one (to match INT_MAX.)
+		regs_.Map(inst);
+		// First, shift and OR to get 0A0A0B0B0C0C0D0D.
+		VSRLI_W(EncodeRegToV(SCRATCHF1), regs_.V(inst.src1), 16);
+		VOR_V(EncodeRegToV(SCRATCHF1), EncodeRegToV(SCRATCHF1), regs_.V(inst.src1));
+		// Now again, but by 8.
+		VSRLI_W(regs_.V(inst.dest), EncodeRegToV(SCRATCHF1), 8);
+		VOR_V(regs_.V(inst.dest), regs_.V(inst.dest), EncodeRegToV(SCRATCHF1));
+		// Finally, shift away the sign.  The goal is to saturate 0xFF -> 0x7FFFFFFF.
+		VSRLI_W(regs_.V(inst.dest), regs_.V(inst.dest), 1);
+		break;
+
+	case IROp::Vec2Unpack16To31:
+	case IROp::Vec2Unpack16To32:
+	case IROp::Vec4Unpack8To32:
+	case IROp::Vec4Pack32To8:
+	case IROp::Vec4Pack31To8:
+	case IROp::Vec2Pack32To16:
+	case IROp::Vec2Pack31To16:
+		// TODO: These need byte/halfword picks, which the emitter doesn't have yet.
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void LoongArch64JitBackend::CompIR_VecClamp(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4ClampToZero:
+		regs_.Map(inst);
+		VXOR_V(EncodeRegToV(SCRATCHF1), EncodeRegToV(SCRATCHF1), EncodeRegToV(SCRATCHF1));
+		VMAX_W(regs_.V(inst.dest), regs_.V(inst.src1), EncodeRegToV(SCRATCHF1));
+		break;
+
+	case IROp::Vec2ClampToZero:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
@@ -19,6 +19,7 @@
 #include <limits>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 
 #include "Common/CommonTypes.h"
@@ -36,6 +37,7 @@
 #include "Core/System.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/CoreTiming.h"
+#include "Core/HW/Display.h"
 
 MIPSState mipsr4k;
 MIPSState *currentMIPS = &mipsr4k;
@@ -273,15 +275,32 @@ void MIPSState::DoState(PointerWrap &p) {
 	if (!s)
 		return;
 
-	// Reset the jit if we're loading.
-	if (p.mode == p.MODE_READ)
+	// Reset the jit if we're loading, unless its blocks were already checked against memory.
+	const bool keepJit = p.mode == p.MODE_READ && keepJitOnLoad && MIPSComp::jit;
+	keepJitOnLoad = false;
+	std::vector<u8> jitState;
+	if (keepJit) {
+		CChunkFileReader::MeasureAndSavePtr(*MIPSComp::jit, &jitState);
+		memset(vcmpResult, 0, sizeof(vcmpResult));
+	} else if (p.mode == p.MODE_READ) {
 		Reset();
+	}
 	// Assume we're not saving state during a CPU core reset, so no lock.
 	if (MIPSComp::jit)
 		MIPSComp::jit->DoState(p);
 	else
 		MIPSComp::DoDummyJitState(p);
 
+	if (keepJit) {
+		// Blocks were compiled assuming the old prefix and rounding state.
+		std::vector<u8> loadedJitState;
+		CChunkFileReader::MeasureAndSavePtr(*MIPSComp::jit, &loadedJitState);
+		if (loadedJitState != jitState) {
+			INFO_LOG(Log::JIT, "Jit state changed by load, clearing the block cache");
+			MIPSComp::jit->ClearCache();
+		}
+	}
+
 	DoArray(p, r, sizeof(r) / sizeof(r[0]));
 	DoArray(p, f, sizeof(f) / sizeof(f[0]));
 	if (s <= 2) {
@@ -379,6 +398,7 @@ void MIPSState::InvalidateICache(u32 address, int length) {
 void MIPSState::ClearJitCache() {
 	std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
 	if (MIPSComp::jit) {
+		DisplayNotifyCause(FRAME_CAUSE_JIT_CLEAR);
 		if (coreState == CORE_RUNNING_CPU || insideJit) {
 			pendingClears.emplace_back(0, 0);
 			hasPendingClears = true;
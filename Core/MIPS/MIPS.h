@@ -269,6 +269,8 @@ class MIPSState
 	// Doesn't need save stating.
 	volatile bool insideJit = false;
 	volatile bool hasPendingClears = false;
+	// Set by the state loader once it's checked the jit blocks against the loaded memory.
+	bool keepJitOnLoad = false;
 };
 
 class MIPSDebugInterface;
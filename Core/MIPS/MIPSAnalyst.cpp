@@ -26,7 +26,10 @@
 
 #include "Common/File/FileUtil.h"
 #include "Common/Log.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/Promise.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/MemMap.h"
@@ -78,6 +81,21 @@ namespace std {
 static std::unordered_set<HashMapFunc> hashMap;
 
 static Path hashmapFileName;
+// How many non-hardcoded entries hashmapFileName has, if it matches hashMap.  Otherwise SIZE_MAX.
+static size_t hashMapStoredCount = SIZE_MAX;
+
+// knownfuncs.ini being read in the background during boot.
+static Promise<std::vector<HashMapFunc> *> *hashMapPreload;
+static Path hashMapPreloadFileName;
+
+static size_t CountStoredHashes() {
+	size_t count = 0;
+	for (const HashMapFunc &mf : hashMap) {
+		if (!mf.hardcoded)
+			count++;
+	}
+	return count;
+}
 
 #define MIPSTABLE_IMM_MASK 0xFC000000
 
@@ -628,6 +646,72 @@ namespace MIPSAnalyst {
 		return (info & DELAYSLOT) != 0;
 	}
 
+	bool IsIdleLoop(u32 loopStart, u32 branchAddr) {
+		// Longer loops are unlikely to be only waiting.
+		static const u32 MAX_IDLE_LOOP_INSTRUCTIONS = 16;
+		// Plain ALU ops and loads.  No FPU/VFPU, HI/LO, or anything with other side effects.
+		static const u64 ALLOWED_INFO = MEMTYPE_MASK | IS_CONDMOVE | IN_RS_ADDR | IN_RS_SHIFT | IN_RT | IN_SA | IN_IMM16 | IN_MEM | OUT_RT | OUT_RD;
+		static const u64 ALLOWED_BRANCH_INFO = ALLOWED_INFO | IS_CONDBRANCH | DELAYSLOT | LIKELY;
+
+		if (loopStart > branchAddr || (branchAddr - loopStart) / 4 + 2 > MAX_IDLE_LOOP_INSTRUCTIONS)
+			return false;
+		if (!Memory::IsValidRange(loopStart, branchAddr + 8 - loopStart))
+			return false;
+
+		MIPSOpcode ops[MAX_IDLE_LOOP_INSTRUCTIONS];
+		u32 outputs[MAX_IDLE_LOOP_INSTRUCTIONS];
+		u32 loopWrites = 0;
+		const int count = (int)((branchAddr - loopStart) / 4 + 2);
+		for (int i = 0; i < count; ++i) {
+			const u32 addr = loopStart + i * 4;
+			const MIPSOpcode op = Memory::Read_Opcode_JIT(addr);
+			// Replacements, syscalls, and other hacks all do something.
+			if (MIPS_IS_EMUHACK(op))
+				return false;
+			// COP0, special2 (halt, mfic, etc.), and cache.
+			const u32 major = op >> 26;
+			if (major == 0x10 || major == 0x1C || major == 0x2F)
+				return false;
+
+			const MIPSInfo info = MIPSGetInfo(op);
+			const bool isBranch = addr == branchAddr;
+			// Unknown flags mean a side effect, and no flags at all means break, traps, and the like.
+			if (info.value == 0 || (info.value & ~(isBranch ? ALLOWED_BRANCH_INFO : ALLOWED_INFO)) != 0)
+				return false;
+			if (isBranch && (!(info & IS_CONDBRANCH) || branchAddr + 4 + ((int)(s16)(op & 0xFFFF) << 2) != loopStart))
+				return false;
+
+			u32 out = 0;
+			if (info & OUT_RT)
+				out |= 1U << MIPS_GET_RT(op);
+			if (info & OUT_RD)
+				out |= 1U << MIPS_GET_RD(op);
+			ops[i] = op;
+			outputs[i] = out & ~1U;
+			loopWrites |= outputs[i];
+		}
+
+		// Now make sure each pass is the same as the last, given the same memory.
+		// That means loop-carried registers (like a counter) aren't allowed.
+		u32 written = 0;
+		for (int i = 0; i < count; ++i) {
+			const MIPSOpcode op = ops[i];
+			const MIPSInfo info = MIPSGetInfo(op);
+			u32 in = 0;
+			if (info & IN_RS)
+				in |= 1U << MIPS_GET_RS(op);
+			if (info & IN_RT)
+				in |= 1U << MIPS_GET_RT(op);
+			// These keep the old value when the condition fails.
+			if (info & IS_CONDMOVE)
+				in |= 1U << MIPS_GET_RD(op);
+			if ((in & loopWrites & ~written) != 0)
+				return false;
+			written |= outputs[i];
+		}
+		return true;
+	}
+
 	bool OpWouldChangeMemory(u32 pc, u32 addr, u32 size) {
 		const auto op = Memory::Read_Instruction(pc, true);
 
@@ -868,40 +952,43 @@ namespace MIPSAnalyst {
 		return DetermineRegisterUsage(reg, addr, instrs) == USAGE_CLOBBERED;
 	}
 
-	void HashFunctions() {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-		std::vector<u32> buffer;
+	static void HashFunction(AnalyzedFunction &f, std::vector<u32> &buffer) {
+		if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
+			return;
+		}
 
-		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
-			AnalyzedFunction &f = *iter;
-			if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
-				continue;
+		// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
+		buffer.resize((f.end - f.start + 4) / 4);
+		size_t pos = 0;
+		for (u32 addr = f.start; addr <= f.end; addr += 4) {
+			u32 validbits = 0xFFFFFFFF;
+			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
+			if (MIPS_IS_EMUHACK(instr)) {
+				f.hasHash = false;
+				return;
 			}
 
-			// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
-			buffer.resize((f.end - f.start + 4) / 4);
-			size_t pos = 0;
-			for (u32 addr = f.start; addr <= f.end; addr += 4) {
-				u32 validbits = 0xFFFFFFFF;
-				MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
-				if (MIPS_IS_EMUHACK(instr)) {
-					f.hasHash = false;
-					goto skip;
-				}
+			MIPSInfo flags = MIPSGetInfo(instr);
+			if (flags & IN_IMM16)
+				validbits &= ~0xFFFF;
+			if (flags & IN_IMM26)
+				validbits &= ~0x03FFFFFF;
+			buffer[pos++] = instr & validbits;
+		}
 
-				MIPSInfo flags = MIPSGetInfo(instr);
-				if (flags & IN_IMM16)
-					validbits &= ~0xFFFF;
-				if (flags & IN_IMM26)
-					validbits &= ~0x03FFFFFF;
-				buffer[pos++] = instr & validbits;
-			}
+		f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
+		f.hasHash = true;
+	}
 
-			f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
-			f.hasHash = true;
-skip:
-			;
-		}
+	void HashFunctions() {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+
+		// Each function is hashed on its own, and this runs over every module's functions.
+		ParallelRangeLoop(&g_threadManager, [](int lower, int upper) {
+			std::vector<u32> buffer;
+			for (int i = lower; i < upper; ++i)
+				HashFunction(functions[i], buffer);
+		}, 0, (int)functions.size(), 1024);
 	}
 
 	void PrecompileFunction(u32 startAddr, u32 length) {
@@ -916,19 +1003,27 @@ namespace MIPSAnalyst {
 		if (!g_Config.bPreloadFunctions) {
 			return;
 		}
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 
-		// TODO: Load from cache file if available instead.
+		// Copy the ranges out, the jit may compile them on other threads.
+		std::vector<std::pair<u32, u32>> ranges;
+		{
+			std::lock_guard<std::recursive_mutex> guard(functions_lock);
+			ranges.reserve(functions.size());
+			for (const AnalyzedFunction &f : functions) {
+				ranges.emplace_back(f.start, f.end - f.start + 4);
+			}
+		}
 
 		double st = time_now_d();
-		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
-			const AnalyzedFunction &f = *iter;
-
-			PrecompileFunction(f.start, f.end - f.start + 4);
+		{
+			std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+			if (MIPSComp::jit) {
+				MIPSComp::jit->CompileFunctions(ranges);
+			}
 		}
 		double et = time_now_d();
 
-		NOTICE_LOG(Log::JIT, "Precompiled %d MIPS functions in %0.2f milliseconds", (int)functions.size(), (et - st) * 1000.0);
+		NOTICE_LOG(Log::JIT, "Precompiled %d MIPS functions in %0.2f milliseconds", (int)ranges.size(), (et - st) * 1000.0);
 	}
 
 	static const char *DefaultFunctionName(char buffer[256], u32 startAddr) {
@@ -1020,11 +1115,20 @@ namespace MIPSAnalyst {
 		return furthestJumpbackAddr;
 	}
 
-	bool ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-
-		FunctionsVector new_functions;
+	// The result of looking for function boundaries in a range of code.
+	struct FunctionScan {
+		FunctionsVector functions;
+		// Addresses where a function starts, with nothing of it scanned yet.  The scan's state there
+		// is only the address, so two scans that share one find the same functions after it.
+		std::vector<u32> syncPoints;
+		// Where the scan stopped, one of syncPoints, unless reachedEnd.
+		u32 stoppedAt = 0;
+		bool reachedEnd = false;
+	};
 
+	// Scans from startAddr, which is taken to be the start of a function, until the first function start
+	// at or after stopAddr (or endAddr.)  Only looks at the code, the symbol map is checked afterward.
+	static void FindFunctionBoundaries(u32 startAddr, u32 endAddr, u32 stopAddr, FunctionScan *scan) {
 		AnalyzedFunction currentFunction = {startAddr};
 
 		u32 furthestBranch = 0;
@@ -1035,6 +1139,14 @@ namespace MIPSAnalyst {
 
 		u32 addr;
 		for (addr = startAddr; addr <= endAddr; addr += 4) {
+			if (addr == currentFunction.start) {
+				scan->syncPoints.push_back(addr);
+				if (addr >= stopAddr) {
+					scan->stoppedAt = addr;
+					return;
+				}
+			}
+
 			MIPSOpcode op = Memory::Read_Instruction(addr, true);
 			u32 target = GetBranchTargetNoRA(addr, op);
 			if (target != INVALIDTARGET) {
@@ -1130,22 +1242,7 @@ namespace MIPSAnalyst {
 				currentFunction.end = addr + 4;
 				currentFunction.isStraightLeaf = isStraightLeaf;
 
-				// Check if we already have symbol info starting here.  If so, skip insertion.
-				// We used to use the symbols to find the functions, but sometimes we'd find
-				// wrong ones due to two modules with the same name.
-				u32 existingSize = g_symbolMap->GetFunctionSize(currentFunction.start);
-				if (existingSize != SymbolMap::INVALID_ADDRESS) {
-					currentFunction.foundInSymbolMap = true;
-
-					// If we run into a func with a different size, skip updating the hash map.
-					// This will prevent us saving incorrectly named funcs with wrong hashes.
-					u32 detectedSize = currentFunction.end - currentFunction.start + 4;
-					if (existingSize != detectedSize) {
-						insertSymbols = false;
-					}
-				}
-
-				new_functions.push_back(currentFunction);
+				scan->functions.push_back(currentFunction);
 
 				furthestBranch = 0;
 				addr += 4;
@@ -1160,7 +1257,90 @@ namespace MIPSAnalyst {
 
 		if (addr <= endAddr) {
 			currentFunction.end = addr + 4;
-			new_functions.push_back(currentFunction);
+			scan->functions.push_back(currentFunction);
+		}
+		scan->reachedEnd = true;
+	}
+
+	bool ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+
+		// Big ranges are split into chunks, each scanned from its start as if a function started there.
+		// That's often wrong at first, but the chunk before runs on past the split until it reaches a
+		// function start that the next chunk also found, and from there on they agree.
+		static const u32 SCAN_CHUNK_SIZE = 0x20000;
+		static const u32 SCAN_CHUNK_OVERLAP = 0x4000;
+		static const int MAX_SCAN_CHUNKS = 64;
+		const u32 rangeSize = endAddr >= startAddr ? endAddr - startAddr + 4 : 0;
+		const int numChunks = std::max(1, std::min((int)(rangeSize / SCAN_CHUNK_SIZE), std::min(MAX_SCAN_CHUNKS, g_threadManager.GetNumLooperThreads() * 2)));
+		const u32 chunkSize = (rangeSize / numChunks) & ~3;
+
+		auto chunkStart = [&](int i) {
+			return startAddr + chunkSize * i;
+		};
+		auto chunkStop = [&](int i) {
+			return i + 1 < numChunks ? chunkStart(i + 1) + SCAN_CHUNK_OVERLAP : endAddr + 4;
+		};
+
+		std::vector<FunctionScan> scans(numChunks);
+		if (numChunks == 1) {
+			FindFunctionBoundaries(startAddr, endAddr, endAddr + 4, &scans[0]);
+		} else {
+			ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+				for (int i = lower; i < upper; ++i)
+					FindFunctionBoundaries(chunkStart(i), endAddr, chunkStop(i), &scans[i]);
+			}, 0, numChunks, 1);
+		}
+
+		FunctionsVector new_functions = std::move(scans[0].functions);
+		FunctionScan *current = &scans[0];
+		// Where current started agreeing with what's in new_functions.
+		u32 validFrom = startAddr;
+		for (int next = 1; !current->reachedEnd; ++next) {
+			_dbg_assert_(next < numChunks);
+			const FunctionScan &nextScan = scans[next];
+			auto syncIt = std::lower_bound(current->syncPoints.begin(), current->syncPoints.end(), validFrom);
+			for (; syncIt != current->syncPoints.end(); ++syncIt) {
+				if (std::binary_search(nextScan.syncPoints.begin(), nextScan.syncPoints.end(), *syncIt))
+					break;
+			}
+
+			if (syncIt == current->syncPoints.end()) {
+				// Never agreed, so redo the next chunk from a known function start.
+				FunctionScan redo;
+				validFrom = current->stoppedAt;
+				FindFunctionBoundaries(validFrom, endAddr, chunkStop(next), &redo);
+				new_functions.insert(new_functions.end(), redo.functions.begin(), redo.functions.end());
+				scans[next] = std::move(redo);
+			} else {
+				const u32 syncAddr = *syncIt;
+				validFrom = syncAddr;
+				// Everything from syncAddr on was found by both, take the next chunk's.
+				while (!new_functions.empty() && new_functions.back().start >= syncAddr)
+					new_functions.pop_back();
+				for (const AnalyzedFunction &f : nextScan.functions) {
+					if (f.start >= syncAddr)
+						new_functions.push_back(f);
+				}
+			}
+			current = &scans[next];
+		}
+
+		for (AnalyzedFunction &f : new_functions) {
+			// Check if we already have symbol info starting here.  If so, skip insertion.
+			// We used to use the symbols to find the functions, but sometimes we'd find
+			// wrong ones due to two modules with the same name.
+			u32 existingSize = g_symbolMap->GetFunctionSize(f.start);
+			if (existingSize != SymbolMap::INVALID_ADDRESS) {
+				f.foundInSymbolMap = true;
+
+				// If we run into a func with a different size, skip updating the hash map.
+				// This will prevent us saving incorrectly named funcs with wrong hashes.
+				u32 detectedSize = f.end - f.start + 4;
+				if (existingSize != detectedSize) {
+					insertSymbols = false;
+				}
+			}
 		}
 
 		for (auto iter = new_functions.begin(); iter != new_functions.end(); iter++) {
@@ -1183,7 +1363,8 @@ namespace MIPSAnalyst {
 			LoadBuiltinHashMap();
 			if (g_Config.bFuncHashMap) {
 				Path hashMapFilename = GetSysDirectory(DIRECTORY_SYSTEM) / "knownfuncs.ini";
-				LoadHashMap(hashMapFilename);
+				if (!FinishPreloadHashMap(hashMapFilename))
+					LoadHashMap(hashMapFilename);
 				StoreHashMap(hashMapFilename);
 			}
 			if (insertSymbols) {
@@ -1314,8 +1495,11 @@ namespace MIPSAnalyst {
 			hashmapFileName = GetSysDirectory(DIRECTORY_SYSTEM) / "knownfuncs.ini";
 		else
 			hashmapFileName = Path(filename);
+		hashMapStoredCount = SIZE_MAX;
 	}
 
+	static bool ReadHashMap(const Path &filename, std::vector<HashMapFunc> *funcs);
+
 	void StoreHashMap(Path filename) {
 		if (filename.empty())
 			filename = hashmapFileName;
@@ -1324,8 +1508,21 @@ namespace MIPSAnalyst {
 		if (hashMap.empty()) {
 			return;
 		}
+		// Entries are only ever added, so if the count is the same, so is the file.
+		size_t count = CountStoredHashes();
+		if (filename == hashmapFileName && count == hashMapStoredCount) {
+			return;
+		}
 
-		FILE *file = File::OpenCFile(filename, "wt");
+		// Another instance may have stored functions we don't know yet, keep those.
+		std::vector<HashMapFunc> stored;
+		if (File::Exists(filename) && ReadHashMap(filename, &stored)) {
+			hashMap.insert(stored.begin(), stored.end());
+			count = CountStoredHashes();
+		}
+
+		Path tempPath = File::TempPathFor(filename);
+		FILE *file = File::OpenCFile(tempPath, "wt");
 		if (!file) {
 			WARN_LOG(Log::Loader, "Could not store hash map: %s", filename.c_str());
 			return;
@@ -1336,11 +1533,18 @@ namespace MIPSAnalyst {
 			if (!mf.hardcoded) {
 				if (fprintf(file, "%016llx:%d = %s\n", mf.hash, mf.size, mf.name) <= 0) {
 					WARN_LOG(Log::Loader, "Could not store hash map: %s", filename.c_str());
+					count = SIZE_MAX;
 					break;
 				}
 			}
 		}
 		fclose(file);
+		if (!File::ReplaceFile(tempPath, filename)) {
+			File::Delete(tempPath);
+			count = SIZE_MAX;
+		}
+		hashmapFileName = filename;
+		hashMapStoredCount = count;
 	}
 
 	void ApplyHashMap() {
@@ -1381,13 +1585,13 @@ namespace MIPSAnalyst {
 		}
 	}
 
-	void LoadHashMap(const Path &filename) {
+	// Doesn't touch hashMap, so this can run on another thread.
+	static bool ReadHashMap(const Path &filename, std::vector<HashMapFunc> *funcs) {
 		FILE *file = File::OpenCFile(filename, "rt");
 		if (!file) {
 			WARN_LOG(Log::Loader, "Could not load hash map: %s", filename.c_str());
-			return;
+			return false;
 		}
-		hashmapFileName = filename;
 
 		while (!feof(file)) {
 			HashMapFunc mf = { "" };
@@ -1400,9 +1604,57 @@ namespace MIPSAnalyst {
 				continue;
 			}
 
-			hashMap.insert(mf);
+			funcs->push_back(mf);
 		}
 		fclose(file);
+		return true;
+	}
+
+	static void ApplyLoadedHashMap(const Path &filename, const std::vector<HashMapFunc> &funcs) {
+		hashmapFileName = filename;
+		hashMap.insert(funcs.begin(), funcs.end());
+		// If nothing new was known before, the file is already up to date.
+		size_t count = CountStoredHashes();
+		hashMapStoredCount = count == funcs.size() ? count : SIZE_MAX;
+	}
+
+	void LoadHashMap(const Path &filename) {
+		std::vector<HashMapFunc> funcs;
+		if (ReadHashMap(filename, &funcs))
+			ApplyLoadedHashMap(filename, funcs);
+	}
+
+	void PreloadHashMap() {
+		if (hashMapPreload || !g_Config.bFuncHashMap)
+			return;
+
+		hashMapPreloadFileName = GetSysDirectory(DIRECTORY_SYSTEM) / "knownfuncs.ini";
+		Path filename = hashMapPreloadFileName;
+		hashMapPreload = Promise<std::vector<HashMapFunc> *>::Spawn(&g_threadManager, [filename]() -> std::vector<HashMapFunc> * {
+			TRACE_SCOPE("boot_read_hashmap");
+			std::vector<HashMapFunc> *funcs = new std::vector<HashMapFunc>();
+			if (!ReadHashMap(filename, funcs)) {
+				delete funcs;
+				return nullptr;
+			}
+			return funcs;
+		}, TaskType::IO_BLOCKING, TaskPriority::HIGH);
+	}
+
+	bool FinishPreloadHashMap(const Path &filename) {
+		if (!hashMapPreload)
+			return false;
+
+		std::vector<HashMapFunc> *funcs = hashMapPreload->BlockUntilReady();
+		delete hashMapPreload;
+		hashMapPreload = nullptr;
+
+		bool matches = hashMapPreloadFileName == filename;
+		if (funcs && matches)
+			ApplyLoadedHashMap(filename, *funcs);
+		delete funcs;
+		// If it failed to open, trying again won't help.
+		return matches;
 	}
 
 	std::vector<MIPSGPReg> GetInputRegs(MIPSOpcode op) {
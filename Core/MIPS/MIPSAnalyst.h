@@ -114,6 +114,10 @@ namespace MIPSAnalyst {
 	void SetHashMapFilename(const std::string& filename = "");
 	void LoadBuiltinHashMap();
 	void LoadHashMap(const Path &filename);
+	// Starts reading knownfuncs.ini on a background thread, so it's ready when FinalizeScan() needs it.
+	void PreloadHashMap();
+	// Takes the result of PreloadHashMap(), waiting if needed.  False if there was none for this file.
+	bool FinishPreloadHashMap(const Path &filename);
 	void StoreHashMap(Path filename = Path());
 
 	const char *LookupHash(u64 hash, u32 funcSize);
@@ -136,6 +140,10 @@ namespace MIPSAnalyst {
 	int OpMemoryAccessSize(u32 pc);
 	bool IsOpMemoryWrite(u32 pc);
 	bool OpHasDelaySlot(u32 pc);
+	// True if the conditional branch at branchAddr loops back to loopStart without doing anything but
+	// spin: no stores, calls, or other branches, and no register carried from one pass to the next.
+	// Such a loop can only stop once an event changes memory, so the time until then can be skipped.
+	bool IsIdleLoop(u32 loopStart, u32 branchAddr);
 
 	struct MipsOpcodeInfo {
 		DebugInterface *cpu;
@@ -18,9 +18,11 @@
 #include "Core/MIPS/MIPSTracer.h"
 
 #include <cstring> // for std::memcpy
+#include <zstd.h>
 #include "Core/MIPS/MIPSTables.h" // for MIPSDisAsm
 #include "Core/MemMap.h" // for Memory::GetPointerUnchecked
 #include "Common/File/FileUtil.h" // for the File::OpenCFile
+#include "Common/Thread/ThreadUtil.h" // for SetCurrentThreadName
 
 
 bool TraceBlockStorage::save_block(const u32* instructions, u32 size) {
@@ -61,6 +63,23 @@ void MIPSTracer::prepare_block(const MIPSComp::IRBlock* block, MIPSComp::IRBlock
 	u32 virt_addr, size;
 	block->GetRange(&virt_addr, &size);
 
+	if (stream_output) {
+		// Everything goes to the file, so there's no need for the storage.
+		u32 index = (u32)trace_info.size();
+		trace_info.push_back({ virt_addr, 0 });
+
+		auto mips_instructions_ptr = (const u32*)Memory::GetPointerUnchecked(virt_addr);
+		stream_chunk.push_back(MIPSTRACER_STREAM_BLOCK);
+		stream_chunk.push_back(index);
+		stream_chunk.push_back(virt_addr);
+		stream_chunk.push_back(size / 4);
+		stream_chunk.insert(stream_chunk.end(), mips_instructions_ptr, mips_instructions_ptr + size / 4);
+
+		auto ir_ptr = (IRInst*)blocks.GetBlockInstructionPtr(*block);
+		ir_ptr[1].constant = index;
+		return;
+	}
+
 	u64 hash = block->GetHash();
 	auto it = hash_to_storage_index.find(hash);
 
@@ -100,6 +119,10 @@ void MIPSTracer::prepare_block(const MIPSComp::IRBlock* block, MIPSComp::IRBlock
 }
 
 bool MIPSTracer::flush_to_file() {
+	if (stream_output) {
+		WARN_LOG(Log::JIT, "The MIPSTracer is streaming, stop tracing to finish the file");
+		return false;
+	}
 	if (logging_path.empty()) {
 		WARN_LOG(Log::JIT, "The path is empty, cannot flush the trace!");
 		return false;
@@ -121,6 +144,8 @@ bool MIPSTracer::flush_to_file() {
 	INFO_LOG(Log::JIT, "Trace flushed, closing the file...");
 	std::fclose(output);
 
+	flush_blocks_to_file(logging_path.WithExtraExtension(".blocks"), trace);
+
 	clear();
 	return true;
 }
@@ -148,6 +173,45 @@ void MIPSTracer::flush_block_to_file(const TraceBlockInfo& block_info) {
 	}
 }
 
+bool MIPSTracer::flush_blocks_to_file(const Path& path, const std::vector<u32>& trace) {
+	// The same code may show up under several trace_info entries (see prepare_block), so go by address.
+	std::vector<u32> order;
+	std::unordered_map<u64, u32> counts;
+	for (auto index : trace) {
+		const auto& block_info = trace_info[index];
+		u64 key = ((u64)block_info.virt_address << 32) | block_info.storage_index;
+		auto it = counts.find(key);
+		if (it == counts.end()) {
+			counts.emplace(key, 1);
+			order.push_back(index);
+		} else {
+			it->second++;
+		}
+	}
+
+	FILE* blocks_output = File::OpenCFile(path, "wb");
+	if (!blocks_output) {
+		WARN_LOG(Log::JIT, "MIPSTracer failed to open the file '%s'", path.c_str());
+		return false;
+	}
+
+	const u32 header[3] = { 0x4252544D, 1, (u32)order.size() };
+	std::fwrite(header, sizeof(header), 1, blocks_output);
+	for (auto index : order) {
+		const auto& block_info = trace_info[index];
+		u64 key = ((u64)block_info.virt_address << 32) | block_info.storage_index;
+		// The first entry in storage is the size in bytes, then the opcodes.
+		u32 count = storage[block_info.storage_index] / 4;
+		const u32 block_header[3] = { block_info.virt_address, counts[key], count };
+		std::fwrite(block_header, sizeof(block_header), 1, blocks_output);
+		std::fwrite(&storage.raw_instructions[block_info.storage_index + 1], sizeof(u32), count, blocks_output);
+	}
+	std::fclose(blocks_output);
+
+	INFO_LOG(Log::JIT, "Wrote %d unique blocks to '%s'", (int)order.size(), path.c_str());
+	return true;
+}
+
 void MIPSTracer::start_tracing() {
 	if (!tracing_enabled) {
 		INFO_LOG(Log::JIT, "MIPSTracer enabled");
@@ -155,10 +219,110 @@ void MIPSTracer::start_tracing() {
 	}
 }
 
+bool MIPSTracer::start_streaming(const Path& path) {
+	if (tracing_enabled || stream_output) {
+		WARN_LOG(Log::JIT, "MIPSTracer is already tracing, cannot start streaming");
+		return false;
+	}
+
+	stream_output = File::OpenCFile(path, "wb");
+	if (!stream_output) {
+		WARN_LOG(Log::JIT, "MIPSTracer failed to open the file '%s'", path.c_str());
+		return false;
+	}
+
+	// Indexes in the stream must match its own definitions, so start from scratch.
+	trace_info.clear();
+	stream_done = false;
+	stream_failed = false;
+	stream_chunk.reserve(STREAM_CHUNK_SIZE + 0x1000);
+	stream_chunk.push_back(MIPSTRACER_STREAM_MAGIC);
+	stream_chunk.push_back(MIPSTRACER_STREAM_VERSION);
+	stream_thread = std::thread([this] {
+		SetCurrentThreadName("MIPSTracerStream");
+		stream_writer_thread();
+	});
+
+	INFO_LOG(Log::JIT, "MIPSTracer streaming to '%s'", path.c_str());
+	start_tracing();
+	return true;
+}
+
+void MIPSTracer::submit_stream_chunk() {
+	std::unique_lock<std::mutex> guard(stream_lock);
+	stream_cond.wait(guard, [this] { return stream_queue.size() < STREAM_MAX_QUEUED || stream_failed; });
+	if (stream_failed) {
+		// Nothing more can be written, no point in keeping it.
+		stream_chunk.clear();
+		return;
+	}
+
+	stream_queue.push_back(std::move(stream_chunk));
+	stream_chunk = std::vector<u32>();
+	stream_chunk.reserve(STREAM_CHUNK_SIZE + 0x1000);
+	stream_cond.notify_all();
+}
+
+void MIPSTracer::stream_writer_thread() {
+	ZSTD_CCtx *cctx = ZSTD_createCCtx();
+	std::vector<u8> compressed;
+	size_t total_in = 0;
+	size_t total_out = 0;
+
+	while (true) {
+		std::vector<u32> chunk;
+		{
+			std::unique_lock<std::mutex> guard(stream_lock);
+			stream_cond.wait(guard, [this] { return !stream_queue.empty() || stream_done; });
+			if (stream_queue.empty())
+				break;
+			chunk = std::move(stream_queue.front());
+			stream_queue.pop_front();
+			stream_cond.notify_all();
+		}
+
+		const size_t chunk_bytes = chunk.size() * sizeof(u32);
+		compressed.resize(ZSTD_compressBound(chunk_bytes));
+		// The trace is very repetitive, so a low level is plenty and keeps this thread from falling behind.
+		size_t result = ZSTD_compressCCtx(cctx, compressed.data(), compressed.size(), chunk.data(), chunk_bytes, 1);
+		if (ZSTD_isError(result) || std::fwrite(compressed.data(), 1, result, stream_output) != result) {
+			ERROR_LOG(Log::JIT, "MIPSTracer failed to write the stream, the trace will be truncated");
+			std::lock_guard<std::mutex> guard(stream_lock);
+			stream_failed = true;
+			stream_queue.clear();
+			stream_cond.notify_all();
+			break;
+		}
+		total_in += chunk_bytes;
+		total_out += result;
+	}
+
+	ZSTD_freeCCtx(cctx);
+	INFO_LOG(Log::JIT, "MIPSTracer stream finished: %lld bytes compressed to %lld", (long long)total_in, (long long)total_out);
+}
+
+void MIPSTracer::stop_streaming() {
+	if (!stream_chunk.empty())
+		submit_stream_chunk();
+	{
+		std::lock_guard<std::mutex> guard(stream_lock);
+		stream_done = true;
+		stream_cond.notify_all();
+	}
+	stream_thread.join();
+
+	std::fclose(stream_output);
+	stream_output = nullptr;
+	stream_chunk = std::vector<u32>();
+	trace_info.clear();
+}
+
 void MIPSTracer::stop_tracing() {
 	if (tracing_enabled) {
 		INFO_LOG(Log::JIT, "MIPSTracer disabled");
 		tracing_enabled = false;
+		if (stream_output)
+			stop_streaming();
 
 #ifdef _DEBUG
 		print_stats();
@@ -200,6 +364,11 @@ void MIPSTracer::initialize(u32 storage_capacity, u32 max_trace_size) {
 }
 
 void MIPSTracer::clear() {
+	if (stream_output) {
+		// The indexes in the stream refer to trace_info.
+		WARN_LOG(Log::JIT, "The MIPSTracer is streaming, cannot clear it");
+		return;
+	}
 	executed_blocks.clear();
 	hash_to_storage_index.clear();
 	storage.clear();
@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -67,6 +71,17 @@ struct TraceBlockStorage {
 // The register/memory changes (or thread switches) are not included!
 // Note: the tracer stores the basic blocks inside, which causes the last block to be dumped as a whole,
 // despite the fact that it may not have executed to its end by the time the tracer is stopped.
+//
+// In streaming mode, nothing is kept in memory: the trace goes to disk as it's recorded, compressed on a
+// background thread, so it can run for as long as there's disk space.  The file is a sequence of zstd
+// frames, and once decompressed (e.g. with 'zstd -d') it's a stream of u32 LE.  It starts with 'MTRS'
+// and a version, then each u32 is either the index of an executed block, or MIPSTRACER_STREAM_BLOCK
+// followed by a block's index, address, opcode count and opcodes.  A block is always defined before
+// its first execution.  Tools/mips_trace_stats.py reads these.
+#define MIPSTRACER_STREAM_MAGIC 0x5352544D
+#define MIPSTRACER_STREAM_VERSION 1
+#define MIPSTRACER_STREAM_BLOCK 0xFFFFFFFF
+
 struct MIPSTracer {
 	std::vector<TraceBlockInfo> trace_info;
 
@@ -83,10 +98,28 @@ struct MIPSTracer {
 
 	int in_storage_capacity = 0x10'0000;
 	int in_max_trace_size = 0x10'0000;
+	bool in_streaming = false;
 
 	void start_tracing();
 	void stop_tracing();
 
+	// Starts tracing straight to a compressed file.  Stop with stop_tracing().
+	bool start_streaming(const Path& path);
+	bool is_streaming() const {
+		return stream_output != nullptr;
+	}
+
+	// Called for every executed block, so keep it cheap.
+	void log_block(u32 index) {
+		if (stream_output) {
+			stream_chunk.push_back(index);
+			if (stream_chunk.size() >= STREAM_CHUNK_SIZE)
+				submit_stream_chunk();
+		} else {
+			executed_blocks.push_back(index);
+		}
+	}
+
 	void prepare_block(const MIPSComp::IRBlock* block, MIPSComp::IRBlockCache& blocks);
 	void set_logging_path(std::string path) {
 		logging_path = Path(path);
@@ -97,12 +130,37 @@ struct MIPSTracer {
 
 	bool flush_to_file();
 	void flush_block_to_file(const TraceBlockInfo& block);
+	// Alongside the log, the unique blocks are written with their raw opcodes, for replay benchmarks.
+	// The format is 'MTRB', a version and a block count, followed by each block (in the order they were
+	// first executed) as its address, execution count, opcode count, and then the opcodes.  All u32 LE.
+	bool flush_blocks_to_file(const Path& path, const std::vector<u32>& trace);
 
 	void initialize(u32 storage_capacity, u32 max_trace_size);
 	void clear();
 
 	inline void print_stats() const;
 
+private:
+	// In u32s.  Big enough for zstd to do well, small enough not to lose much in a crash.
+	static constexpr size_t STREAM_CHUNK_SIZE = 0x40000;
+	// If the disk can't keep up, the emulator waits rather than dropping parts of the trace.
+	static constexpr size_t STREAM_MAX_QUEUED = 16;
+
+	void submit_stream_chunk();
+	void stream_writer_thread();
+	void stop_streaming();
+
+	FILE* stream_output = nullptr;
+	std::vector<u32> stream_chunk;
+	std::thread stream_thread;
+	std::mutex stream_lock;
+	std::condition_variable stream_cond;
+	std::deque<std::vector<u32>> stream_queue;
+	bool stream_done = false;
+	bool stream_failed = false;
+
+public:
+
 	MIPSTracer(): trace_info(), executed_blocks(), hash_to_storage_index(), storage(), logging_path() {}
 };
 
@@ -209,6 +209,25 @@ void RiscVJitBackend::CompIR_System(IRInst inst) {
 		// This is always followed by an ExitToPC, where we check coreState.
 		break;
 
+	case IROp::SyscallFast:
+	{
+		FlushAll();
+		SaveStaticRegisters();
+
+		WriteDebugProfilerStatus(IRProfilerStatus::SYSCALL);
+		LI(X10, (uintptr_t)GetSyscallFuncPointer(MIPSOpcode(inst.constant)));
+		QuickCallFunction(&CallSyscallFast, SCRATCH2);
+		FixupBranch keepGoing = BEQ(X10, R_ZERO);
+		// It needed the full syscall handling after all (like a reschedule), so exit like ExitToPC.
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		QuickJ(R_RA, dispatcherCheckCoreState_);
+		SetJumpTarget(keepGoing);
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		break;
+	}
+
 	case IROp::CallReplacement:
 		FlushAll();
 		SaveStaticRegisters();
@@ -39,6 +39,33 @@ static bool Overlap(IRReg r1, int l1, IRReg r2, int l2) {
 	return r1 < r2 + l2 && r1 + l1 > r2;
 }
 
+// The reg cache only knows about scalar FPRs.  When none of the lanes are mapped, it's
+// cheaper to work on the context directly with RVV than to map all of them.
+bool RiscVJitBackend::IsVec4InRAM(IRReg first) {
+	if (!useRVV_)
+		return false;
+	for (int i = 0; i < 4; ++i) {
+		if (!regs_.IsFPRInRAM(first + i))
+			return false;
+	}
+	return true;
+}
+
+void RiscVJitBackend::BeginVec4RVV() {
+	// Nothing else uses vector state, so we don't bother tracking it.
+	VSETIVLI(R_ZERO, 4, VType(32, VLMul::M1, VTail::A, VMask::A));
+}
+
+void RiscVJitBackend::LoadVec4RVV(RiscVReg vreg, IRReg first) {
+	ADDI(SCRATCH1, CTXREG, offsetof(MIPSState, f) + first * 4);
+	VLE_V(32, vreg, SCRATCH1);
+}
+
+void RiscVJitBackend::StoreVec4RVV(RiscVReg vreg, IRReg first) {
+	ADDI(SCRATCH1, CTXREG, offsetof(MIPSState, f) + first * 4);
+	VSE_V(32, vreg, SCRATCH1);
+}
+
 void RiscVJitBackend::CompIR_VecAssign(IRInst inst) {
 	CONDITIONAL_DISABLE;
 
@@ -227,6 +254,36 @@ void RiscVJitBackend::CompIR_VecAssign(IRInst inst) {
 void RiscVJitBackend::CompIR_VecArith(IRInst inst) {
 	CONDITIONAL_DISABLE;
 
+	bool twoVecs = inst.op == IROp::Vec4Add || inst.op == IROp::Vec4Sub || inst.op == IROp::Vec4Mul || inst.op == IROp::Vec4Div;
+	// If the scale is in dest, the mapped copy would go stale.  Rare, so just skip that.
+	bool scaleOverlap = inst.op == IROp::Vec4Scale && Overlap(inst.src2, 1, inst.dest, 4);
+	if (!scaleOverlap && IsVec4InRAM(inst.dest) && IsVec4InRAM(inst.src1) && (!twoVecs || IsVec4InRAM(inst.src2))) {
+		RiscVReg scaleReg = INVALID_REG;
+		if (inst.op == IROp::Vec4Scale) {
+			// Only one lane, so it's fine to map.
+			scaleReg = regs_.MapFPR(inst.src2);
+		}
+
+		BeginVec4RVV();
+		LoadVec4RVV(V1, inst.src1);
+		if (twoVecs)
+			LoadVec4RVV(V2, inst.src2);
+
+		switch (inst.op) {
+		case IROp::Vec4Add: VFADD_VV(V1, V1, V2); break;
+		case IROp::Vec4Sub: VFSUB_VV(V1, V1, V2); break;
+		case IROp::Vec4Mul: VFMUL_VV(V1, V1, V2); break;
+		case IROp::Vec4Div: VFDIV_VV(V1, V1, V2); break;
+		case IROp::Vec4Scale: VFMUL_VF(V1, V1, scaleReg); break;
+		case IROp::Vec4Neg: VFSGNJN_VV(V1, V1, V1); break;
+		case IROp::Vec4Abs: VFSGNJX_VV(V1, V1, V1); break;
+		default: INVALIDOP; break;
+		}
+
+		StoreVec4RVV(V1, inst.dest);
+		return;
+	}
+
 	switch (inst.op) {
 	case IROp::Vec4Add:
 		regs_.Map(inst);
@@ -293,6 +350,21 @@ void RiscVJitBackend::CompIR_VecHoriz(IRInst inst) {
 
 	switch (inst.op) {
 	case IROp::Vec4Dot:
+		if (IsVec4InRAM(inst.src1) && IsVec4InRAM(inst.src2)) {
+			BeginVec4RVV();
+			LoadVec4RVV(V1, inst.src1);
+			LoadVec4RVV(V2, inst.src2);
+			VFMUL_VV(V1, V1, V2);
+			// -0.0 is the identity for addition, and an ordered sum matches the interpreter.
+			LI(SCRATCH1, (int32_t)0x80000000);
+			VMV_S_X(V3, SCRATCH1);
+			VFREDOSUM_VS(V3, V1, V3);
+			// We already loaded the sources, so overlap doesn't matter.
+			regs_.MapFPR(inst.dest, MIPSMap::NOINIT);
+			VFMV_F_S(regs_.F(inst.dest), V3);
+			break;
+		}
+
 		regs_.Map(inst);
 		if (Overlap(inst.dest, 1, inst.src1, 4) || Overlap(inst.dest, 1, inst.src2, 4)) {
 			// This means inst.dest overlaps one of src1 or src2.  We have to do that one first.
@@ -318,6 +390,81 @@ void RiscVJitBackend::CompIR_VecHoriz(IRInst inst) {
 	}
 }
 
+void RiscVJitBackend::CompIR_VecMatrix(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	bool transposed = inst.op == IROp::Vec4MatMulTransposed;
+	int columns = inst.op == IROp::Vec4Transform ? 1 : 4;
+	auto srcElem = [&](int j, int c) -> IRReg {
+		return inst.src2 + (transposed ? c * 4 + j : j * 4 + c);
+	};
+
+	bool srcInRAM = true;
+	bool destInRAM = true;
+	for (int c = 0; c < 4; ++c)
+		srcInRAM = srcInRAM && IsVec4InRAM(inst.src1 + c * 4);
+	for (int j = 0; j < columns; ++j)
+		destInRAM = destInRAM && IsVec4InRAM(inst.dest + j * 4);
+	// For Transform, a mapped copy of src2 would go stale if it's also dest.  Rare, skip.
+	bool overlap = inst.op == IROp::Vec4Transform && Overlap(inst.dest, 4, inst.src2, 4);
+	if (srcInRAM && destInRAM && !overlap) {
+		// v1-v4 hold the columns, and we scale each by a scalar from src2.
+		BeginVec4RVV();
+		for (int c = 0; c < 4; ++c)
+			LoadVec4RVV((RiscVReg)(V1 + c), inst.src1 + c * 4);
+		for (int j = 0; j < columns; ++j) {
+			for (int c = 0; c < 4; ++c) {
+				RiscVReg scaleReg = regs_.MapFPR(srcElem(j, c));
+				if (c == 0) {
+					VFMUL_VF(V5, V1, scaleReg);
+				} else {
+					VFMUL_VF(V6, (RiscVReg)(V1 + c), scaleReg);
+					VFADD_VV(V5, V5, V6);
+				}
+			}
+			StoreVec4RVV(V5, inst.dest + j * 4);
+		}
+		return;
+	}
+
+	switch (inst.op) {
+	case IROp::Vec4MatMul:
+	case IROp::Vec4MatMulTransposed:
+	case IROp::Vec4Transform:
+		// Without temps, we accumulate in dest.  It can overlap for Transform, so skip that.
+		if (inst.op == IROp::Vec4Transform && (Overlap(inst.dest, 4, inst.src1, 16) || Overlap(inst.dest, 4, inst.src2, 4)))
+			DISABLE;
+
+		// Mapping everything at once would be 48 regs, so go one output lane at a time.
+		// Like Vec4Dot, this uses FMADD.
+		for (int j = 0; j < columns; ++j) {
+			for (int i = 0; i < 4; ++i) {
+				IRReg d = inst.dest + j * 4 + i;
+				regs_.SpillLockFPR(d);
+				RiscVReg destReg = regs_.MapFPR(d, MIPSMap::NOINIT);
+				for (int c = 0; c < 4; ++c) {
+					IRReg a = inst.src1 + c * 4 + i;
+					IRReg b = srcElem(j, c);
+					regs_.SpillLockFPR(a, b);
+					RiscVReg aReg = regs_.MapFPR(a);
+					RiscVReg bReg = regs_.MapFPR(b);
+					if (c == 0)
+						FMUL(32, destReg, aReg, bReg);
+					else
+						FMADD(32, destReg, aReg, bReg, destReg);
+					regs_.ReleaseSpillLockFPR(a, b);
+				}
+				regs_.ReleaseSpillLockFPR(d);
+			}
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
 void RiscVJitBackend::CompIR_VecPack(IRInst inst) {
 	CONDITIONAL_DISABLE;
 
@@ -40,6 +40,8 @@ RiscVJitBackend::RiscVJitBackend(JitOptions &jitopt, IRBlockCache &blocks)
 		jo.enablePointerify = false;
 	}
 	jo.optimizeForInterpreter = false;
+	// The reg cache doesn't map vector regs yet, but Vec4 ops can still use them from memory.
+	useRVV_ = cpu_info.RiscV_V && !jo.Disabled(JitDisable::SIMD);
 
 	// Since we store the offset, this is as big as it can be.
 	// We could shift off one bit to double it, would need to change RiscVAsm.
@@ -174,12 +176,46 @@ bool RiscVJitBackend::CompileBlock(IRBlockCache *irBlockCache, int block_num, bo
 	return true;
 }
 
+bool RiscVJitBackend::CompileInterpretedBlock(IRBlockCache *irBlockCache, int block_num) {
+	if (GetSpaceLeft() < 0x800)
+		return false;
+
+	IRBlock *block = irBlockCache->GetBlock(block_num);
+	BeginWrite(64);
+
+	const u8 *blockStart = GetCodePointer();
+	block->SetNativeOffset((int)GetOffset(blockStart));
+	WriteDebugPC(block->GetOriginalStart());
+
+	// The dispatcher already checked downcount, and the IR has the Downcount op.
+	LI(X10, (uintptr_t)this, SCRATCH2);
+	LI(X11, block_num);
+	SaveStaticRegisters();
+	WriteDebugProfilerStatus(IRProfilerStatus::IR_INTERPRET);
+	QuickCallFunction(&RunInterpretedBlock, SCRATCH2);
+	WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+	LoadStaticRegisters();
+	QuickJ(R_RA, dispatcherCheckCoreState_);
+
+	int len = (int)GetOffset(GetCodePointer()) - block->GetNativeOffset();
+	if (len < MIN_BLOCK_NORMAL_LEN)
+		ReserveCodeSpace(MIN_BLOCK_NORMAL_LEN - len);
+
+	// Used for size calc only, we never link to these.
+	SetBlockCheckedOffset(block_num, (int)GetOffset(GetCodePointer()));
+	SetBlockInterpreted(block_num, true);
+
+	EndWrite();
+	FlushIcache();
+	return true;
+}
+
 void RiscVJitBackend::WriteConstExit(uint32_t pc) {
 	int block_num = blocks_.GetBlockNumberFromStartAddress(pc);
 	const IRNativeBlock *nativeBlock = GetNativeBlock(block_num);
 
 	int exitStart = (int)GetOffset(GetCodePointer());
-	if (block_num >= 0 && jo.enableBlocklink && nativeBlock && nativeBlock->checkedOffset != 0) {
+	if (block_num >= 0 && jo.enableBlocklink && nativeBlock && nativeBlock->checkedOffset != 0 && !nativeBlock->interpreted) {
 		QuickJ(SCRATCH1, GetBasePtr() + nativeBlock->checkedOffset);
 	} else {
 		LI(SCRATCH1, pc);
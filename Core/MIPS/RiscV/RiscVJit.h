@@ -37,6 +37,7 @@ class RiscVJitBackend : public RiscVGen::RiscVCodeBlock, public IRNativeBackend
 
 	void GenerateFixedCode(MIPSState *mipsState) override;
 	bool CompileBlock(IRBlockCache *irBlockCache, int block_num, bool preload) override;
+	bool CompileInterpretedBlock(IRBlockCache *irBlockCache, int block_num) override;
 	void ClearAllBlocks() override;
 	void InvalidateBlock(IRBlockCache *irBlockCache, int block_num) override;
 
@@ -102,6 +103,7 @@ class RiscVJitBackend : public RiscVGen::RiscVCodeBlock, public IRNativeBackend
 	void CompIR_VecClamp(IRInst inst) override;
 	void CompIR_VecHoriz(IRInst inst) override;
 	void CompIR_VecLoad(IRInst inst) override;
+	void CompIR_VecMatrix(IRInst inst) override;
 	void CompIR_VecPack(IRInst inst) override;
 	void CompIR_VecStore(IRInst inst) override;
 	void CompIR_ValidateAddress(IRInst inst) override;
@@ -113,6 +115,12 @@ class RiscVJitBackend : public RiscVGen::RiscVCodeBlock, public IRNativeBackend
 	void NormalizeSrc12(IRInst inst, RiscVGen::RiscVReg *lhs, RiscVGen::RiscVReg *rhs, RiscVGen::RiscVReg lhsTempReg, RiscVGen::RiscVReg rhsTempReg, bool allowOverlap);
 	RiscVGen::RiscVReg NormalizeR(IRReg rs, IRReg rd, RiscVGen::RiscVReg tempReg);
 
+	// RVV helpers for Vec4 ops whose lanes are all in the context.  Modify SCRATCH1.
+	bool IsVec4InRAM(IRReg first);
+	void BeginVec4RVV();
+	void LoadVec4RVV(RiscVGen::RiscVReg vreg, IRReg first);
+	void StoreVec4RVV(RiscVGen::RiscVReg vreg, IRReg first);
+
 	JitOptions &jo;
 	RiscVRegCache regs_;
 
@@ -129,6 +137,7 @@ class RiscVJitBackend : public RiscVGen::RiscVCodeBlock, public IRNativeBackend
 	int jitStartOffset_ = 0;
 	int compilingBlockNum_ = -1;
 	int logBlocks_ = 0;
+	bool useRVV_ = false;
 };
 
 class RiscVJit : public IRNativeJit {
@@ -65,6 +65,10 @@ void ImHere() {
 	DEBUG_LOG(Log::CPU, "JIT Here: %08x", currentMIPS->pc);
 }
 
+static void JitRoundingGuardFailed(Jit *jit, u32 pc) {
+	jit->RoundingGuardFailed(pc);
+}
+
 void Jit::GenerateFixedCode(JitOptions &jo) {
 	BeginWrite(GetMemoryProtectPageSize());
 	AlignCodePage();
@@ -223,6 +227,13 @@ void Jit::GenerateFixedCode(JitOptions &jo) {
 	}
 	JMP(quitLoop, true);
 
+	// Blocks that assumed the default rounding mode jump here (with pc set) when fcr31 disagrees.
+	roundingGuardFailed = GetCodePtr();
+	RestoreRoundingMode(true);
+	ABI_CallFunctionPA((const void *)&JitRoundingGuardFailed, this, MIPSSTATE_VAR(pc));
+	ApplyRoundingMode(true);
+	JMP(dispatcherNoCheck, true);
+
 	// Let's spare the pre-generated code from unprotect-reprotect.
 	endOfPregeneratedCode = AlignCodePage();
 	EndWrite();
@@ -828,6 +828,19 @@ void Jit::Comp_Syscall(MIPSOpcode op)
 		MOV(32, MIPSSTATE_VAR(pc), Imm32(GetCompilerPC() + 4));
 	}
 
+	// These normally don't switch threads, so just keep going.  Everything was flushed above.
+	if (!js.inDelaySlot && IsFastSyscall(op)) {
+		ABI_CallFunctionP((const void *)&CallSyscallFast, (void *)GetSyscallFuncPointer(op));
+		// Non-zero if it needed the full syscall handling after all, like a reschedule.
+		TEST(32, R(EAX), R(EAX));
+		FixupBranch keepGoing = J_CC(CC_Z, true);
+		ApplyRoundingMode();
+		WriteSyscallExit();
+		SetJumpTarget(keepGoing);
+		ApplyRoundingMode();
+		return;
+	}
+
 #ifdef USE_PROFILER
 	// When profiling, we can't skip CallSyscall, since it times syscalls.
 	ABI_CallFunctionC(&CallSyscall, op.encoding);
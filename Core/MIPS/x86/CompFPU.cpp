@@ -261,7 +261,7 @@ void Jit::Comp_FPU2op(MIPSOpcode op) {
 		fpr.MapReg(fd, fs == fd, true);
 
 		// Small optimization: 0 is our default mode anyway.
-		if (setMXCSR == 0 && !js.hasSetRounding) {
+		if (setMXCSR == 0 && !js.RoundingMayVary()) {
 			setMXCSR = -1;
 		}
 		if (setMXCSR != -1) {
@@ -445,6 +445,9 @@ void Jit::Comp_mxc1(MIPSOpcode op) {
 		if (fs == 31) {
 			// Must clear before setting, since ApplyRoundingMode() assumes it was cleared.
 			RestoreRoundingMode();
+			// From here on, the block can't rely on its entry check.
+			if (!gpr.IsImm(rt) || (gpr.GetImm(rt) & 0x1000003) != 0)
+				js.blockAssumesDefaultRounding = false;
 			if (gpr.IsImm(rt)) {
 				gpr.SetImm(MIPS_REG_FPCOND, (gpr.GetImm(rt) >> 23) & 1);
 				MOV(32, MIPSSTATE_VAR(fcr31), Imm32(gpr.GetImm(rt) & 0x0181FFFF));
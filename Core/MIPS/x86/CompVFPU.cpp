@@ -1856,7 +1856,7 @@ void Jit::Comp_Vf2i(MIPSOpcode op) {
 	}
 
 	// Small optimization: 0 is our default mode anyway.
-	if (setMXCSR == 0 && !js.hasSetRounding) {
+	if (setMXCSR == 0 && !js.RoundingMayVary()) {
 		setMXCSR = -1;
 	}
 	// Except for truncate, we need to update MXCSR to our preferred rounding mode.
@@ -23,6 +23,7 @@
 
 #include "Common/Math/math_util.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
@@ -217,14 +218,14 @@ void Jit::WriteDowncount(int offset) {
 
 void Jit::RestoreRoundingMode(bool force) {
 	// If the game has never set an interesting rounding mode, we can safely skip this.
-	if (force || js.hasSetRounding) {
+	if (force || js.RoundingMayVary()) {
 		CALL(restoreRoundingMode);
 	}
 }
 
 void Jit::ApplyRoundingMode(bool force) {
 	// If the game has never set an interesting rounding mode, we can safely skip this.
-	if (force || js.hasSetRounding) {
+	if (force || js.RoundingMayVary()) {
 		CALL(applyRoundingMode);
 	}
 }
@@ -237,6 +238,12 @@ void Jit::UpdateRoundingMode(u32 fcr31) {
 	}
 }
 
+void Jit::RoundingGuardFailed(u32 em_address) {
+	// Called from the guard at the start of the block, so it's safe to throw it away.
+	roundingGuardFailures_.insert(em_address);
+	blocks.InvalidateICache(em_address, 4);
+}
+
 void Jit::ClearCache()
 {
 	blocks.Clear();
@@ -300,6 +307,7 @@ void Jit::EatInstruction(MIPSOpcode op) {
 
 void Jit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
+	TRACE_SCOPE("jit_compile");
 	if (GetSpaceLeft() < 0x10000 || blocks.IsFull()) {
 		ClearCache();
 	}
@@ -384,6 +392,18 @@ const u8 *Jit::DoJit(u32 em_address, JitBlock *b) {
 
 	b->normalEntry = GetCodePtr();
 
+	// Games that set a rounding mode usually do it briefly, so assume the default where we can.
+	// This avoids switching MXCSR around calls and conversions.  If it's wrong, we recompile.
+	js.blockAssumesDefaultRounding = false;
+	if (js.hasSetRounding && (mips_->fcr31 & 0x01000003) == 0 && !roundingGuardFailures_.count(em_address)) {
+		js.blockAssumesDefaultRounding = true;
+		TEST(32, MIPSSTATE_VAR(fcr31), Imm32(0x01000003));
+		FixupBranch defaultRounding = J_CC(CC_Z);
+		MOV(32, MIPSSTATE_VAR(pc), Imm32(js.blockStart));
+		JMP(roundingGuardFailed, true);
+		SetJumpTarget(defaultRounding);
+	}
+
 	MIPSAnalyst::AnalysisResults analysis = MIPSAnalyst::Analyze(em_address);
 
 	gpr.Start(mips_, &js, &jo, analysis);
@@ -476,6 +496,8 @@ bool Jit::DescribeCodePtr(const u8 *ptr, std::string &name) {
 		name = "enterDispatcher";
 	else if (ptr == restoreRoundingMode)
 		name = "restoreRoundingMode";
+	else if (ptr == roundingGuardFailed)
+		name = "roundingGuardFailed";
 	else if (ptr == crashHandler)
 		name = "crashHandler";
 	else {
@@ -717,6 +739,10 @@ static void HitInvalidBranch(uint32_t dest) {
 	Core_ExecException(dest, currentMIPS->pc, ExecExceptionType::JUMP);
 }
 
+static void JitIdleLoop() {
+	CoreTiming::Idle();
+}
+
 void Jit::WriteExit(u32 destination, int exit_num) {
 	_assert_msg_(exit_num < MAX_JIT_BLOCK_EXITS, "Expected a valid exit_num. dest=%08x", destination);
 
@@ -741,6 +767,10 @@ void Jit::WriteExit(u32 destination, int exit_num) {
 		SetJumpTarget(skipCheck);
 	}
 
+	// Everything is flushed for the exit already, so it's safe to call out here.
+	if (destination == js.blockStart && !jo.Disabled(JitDisable::IDLE_LOOPS) && MIPSAnalyst::IsIdleLoop(destination, GetCompilerPC()))
+		ABI_CallFunction(&JitIdleLoop);
+
 	WriteDowncount();
 
 	//If nobody has taken care of this yet (this can be removed when all branches are done)
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <unordered_set>
+
 #include "Common/CommonTypes.h"
 #include "Common/Thunk.h"
 #include "Common/x64Emitter.h"
@@ -156,6 +158,7 @@ class Jit : public Gen::XCodeBlock, public JitInterface, public MIPSFrontendInte
 	void RestoreRoundingMode(bool force = false);
 	void ApplyRoundingMode(bool force = false);
 	void UpdateRoundingMode(u32 fcr31 = -1);
+	void RoundingGuardFailed(u32 em_address);
 
 	JitBlockCache *GetBlockCache() override { return &blocks; }
 	JitBlockCacheDebugInterface *GetBlockCacheDebugInterface() override { return &blocks; }
@@ -316,7 +319,8 @@ class Jit : public Gen::XCodeBlock, public JitInterface, public MIPSFrontendInte
 	JitSafeMemFuncs safeMemFuncs;
 
 	MIPSState *mips_;
-
+	// Blocks that failed their default rounding mode check, and got recompiled without it.
+	std::unordered_set<u32> roundingGuardFailures_;
 
 	const u8 *enterDispatcher;
 
@@ -329,6 +333,7 @@ class Jit : public Gen::XCodeBlock, public JitInterface, public MIPSFrontendInte
 
 	const u8 *restoreRoundingMode;
 	const u8 *applyRoundingMode;
+	const u8 *roundingGuardFailed;
 
 	const u8 *endOfPregeneratedCode;
 
@@ -157,10 +157,25 @@ OpArg JitSafeMem::PrepareMemoryOpArg(MemoryOpType type)
 	if (!fast_)
 	{
 		// Is it in physical ram?
-		jit_->CMP(32, R(xaddr_), Imm32(PSP_GetKernelMemoryBase() - offset_));
-		tooLow_ = jit_->J_CC(CC_B);
-		jit_->CMP(32, R(xaddr_), Imm32(PSP_GetUserMemoryEnd() - offset_ - (size_ - 1)));
-		tooHigh_ = jit_->J_CC(CC_AE);
+#ifndef MASKED_PSP_MEMORY
+		if (xaddr_ != EAX) {
+			// The cached/uncached/kernel mirrors are all mapped, so we only need to check the masked address.
+			// Subtracting the base first is fine, it can't borrow into the mirror bits while in range.
+			// That leaves a single unsigned compare for both ends.
+			jit_->LEA(32, EAX, MDisp(xaddr_, offset_ - (s32)PSP_GetKernelMemoryBase()));
+			jit_->AND(32, R(EAX), Imm32(0x3FFFFFFF));
+			jit_->CMP(32, R(EAX), Imm32(PSP_GetUserMemoryEnd() - PSP_GetKernelMemoryBase() - (size_ - 1)));
+			tooHigh_ = jit_->J_CC(CC_AE);
+			hasTooLow_ = false;
+		} else
+#endif
+		{
+			jit_->CMP(32, R(xaddr_), Imm32(PSP_GetKernelMemoryBase() - offset_));
+			tooLow_ = jit_->J_CC(CC_B);
+			jit_->CMP(32, R(xaddr_), Imm32(PSP_GetUserMemoryEnd() - offset_ - (size_ - 1)));
+			tooHigh_ = jit_->J_CC(CC_AE);
+			hasTooLow_ = true;
+		}
 
 		// We may need to jump back up here.
 		safe_ = jit_->GetCodePtr();
@@ -195,7 +210,8 @@ void JitSafeMem::PrepareSlowAccess()
 	// Skip the fast path (which the caller wrote just now.)
 	skip_ = jit_->J(true);
 	needsSkip_ = true;
-	jit_->SetJumpTarget(tooLow_);
+	if (hasTooLow_)
+		jit_->SetJumpTarget(tooLow_);
 	jit_->SetJumpTarget(tooHigh_);
 
 	// Might also be the scratchpad.
@@ -79,6 +79,7 @@ class JitSafeMem {
 	bool needsCheck_;
 	bool needsSkip_;
 	bool fast_;
+	bool hasTooLow_ = false;
 	u32 alignMask_;
 	u32 iaddr_;
 	Gen::X64Reg xaddr_;
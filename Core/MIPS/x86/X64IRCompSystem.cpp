@@ -225,6 +225,25 @@ void X64JitBackend::CompIR_System(IRInst inst) {
 		// This is always followed by an ExitToPC, where we check coreState.
 		break;
 
+	case IROp::SyscallFast:
+	{
+		FlushAll();
+		SaveStaticRegisters();
+
+		WriteDebugProfilerStatus(IRProfilerStatus::SYSCALL);
+		ABI_CallFunctionP((const u8 *)&CallSyscallFast, (void *)GetSyscallFuncPointer(MIPSOpcode(inst.constant)));
+		TEST(32, R(EAX), R(EAX));
+		FixupBranch keepGoing = J_CC(CC_Z, true);
+		// It needed the full syscall handling after all (like a reschedule), so exit like ExitToPC.
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		JMP(dispatcherCheckCoreState_, true);
+		SetJumpTarget(keepGoing);
+		WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+		LoadStaticRegisters();
+		break;
+	}
+
 	case IROp::CallReplacement:
 		FlushAll();
 		SaveStaticRegisters();
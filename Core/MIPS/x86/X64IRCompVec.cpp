@@ -295,6 +295,83 @@ void X64JitBackend::CompIR_VecHoriz(IRInst inst) {
 	}
 }
 
+void X64JitBackend::CompIR_VecMatrix(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4MatMul:
+	case IROp::Vec4MatMulTransposed:
+	case IROp::Vec4Transform:
+	{
+		// The columns of src1 are used for every output column, so keep them all mapped.
+		X64Reg cols[4];
+		regs_.SpillLockFPR(inst.src1, inst.src1 + 4, inst.src1 + 8, inst.src1 + 12);
+		for (int c = 0; c < 4; ++c)
+			cols[c] = regs_.MapVec4(inst.src1 + c * 4);
+
+		X64Reg tempReg = regs_.GetAndLockTempFPR();
+		// Transform allows dest to overlap, so accumulate in a temp.
+		X64Reg accReg = inst.op == IROp::Vec4Transform ? regs_.GetAndLockTempFPR() : INVALID_REG;
+
+		// Only 8 XMM regs on x86-32, so don't hold onto src2 or dest columns once used.
+		auto releaseLock = [&](IRReg first) {
+			if (!Overlap(first, 4, inst.src1, 16))
+				regs_.ReleaseSpillLockFPR(first);
+		};
+
+		bool transposed = inst.op == IROp::Vec4MatMulTransposed;
+		int columns = inst.op == IROp::Vec4Transform ? 1 : 4;
+		for (int j = 0; j < columns; ++j) {
+			X64Reg destReg = accReg;
+			if (inst.op != IROp::Vec4Transform) {
+				regs_.SpillLockFPR(inst.dest + j * 4);
+				destReg = regs_.MapVec4(inst.dest + j * 4, MIPSMap::NOINIT);
+			}
+
+			for (int c = 0; c < 4; ++c) {
+				// Lane c of column j, or lane j of column c when transposed.
+				IRReg srcCol = inst.src2 + (transposed ? c : j) * 4;
+				u8 lane = transposed ? j : c;
+				regs_.SpillLockFPR(srcCol);
+				X64Reg srcReg = regs_.MapVec4(srcCol);
+
+				// Multiply and add separately (no FMA), to match the interpreter exactly.
+				if (cpu_info.bAVX) {
+					VPERMILPS(128, tempReg, R(srcReg), VFPU_SWIZZLE(lane, lane, lane, lane));
+					if (c == 0) {
+						VMULPS(128, destReg, tempReg, R(cols[c]));
+					} else {
+						VMULPS(128, tempReg, tempReg, R(cols[c]));
+						VADDPS(128, destReg, destReg, R(tempReg));
+					}
+				} else {
+					MOVAPS(tempReg, R(srcReg));
+					SHUFPS(tempReg, R(tempReg), VFPU_SWIZZLE(lane, lane, lane, lane));
+					MULPS(tempReg, R(cols[c]));
+					if (c == 0)
+						MOVAPS(destReg, R(tempReg));
+					else
+						ADDPS(destReg, R(tempReg));
+				}
+
+				releaseLock(srcCol);
+			}
+
+			if (inst.op != IROp::Vec4Transform)
+				regs_.ReleaseSpillLockFPR(inst.dest + j * 4);
+		}
+
+		if (inst.op == IROp::Vec4Transform)
+			MOVAPS(regs_.MapVec4(inst.dest, MIPSMap::NOINIT), R(accReg));
+		break;
+	}
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
 void X64JitBackend::CompIR_VecPack(IRInst inst) {
 	CONDITIONAL_DISABLE;
 
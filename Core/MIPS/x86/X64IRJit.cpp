@@ -174,12 +174,39 @@ bool X64JitBackend::CompileBlock(IRBlockCache *irBlockCache, int block_num, bool
 	return true;
 }
 
+bool X64JitBackend::CompileInterpretedBlock(IRBlockCache *irBlockCache, int block_num) {
+	if (GetSpaceLeft() < 0x800)
+		return false;
+
+	IRBlock *block = irBlockCache->GetBlock(block_num);
+	const u8 *blockStart = GetCodePointer();
+	block->SetNativeOffset((int)GetOffset(blockStart));
+	WriteDebugPC(block->GetOriginalStart());
+
+	// The dispatcher already checked downcount, and the IR has the Downcount op.
+	SaveStaticRegisters();
+	WriteDebugProfilerStatus(IRProfilerStatus::IR_INTERPRET);
+	ABI_CallFunctionPA((const void *)&RunInterpretedBlock, (void *)this, Imm32(block_num));
+	WriteDebugProfilerStatus(IRProfilerStatus::IN_JIT);
+	LoadStaticRegisters();
+	JMP(dispatcherCheckCoreState_, true);
+
+	int len = (int)GetOffset(GetCodePointer()) - block->GetNativeOffset();
+	if (len < MIN_BLOCK_NORMAL_LEN)
+		ReserveCodeSpace(MIN_BLOCK_NORMAL_LEN - len);
+
+	// Used for size calc only, we never link to these.
+	SetBlockCheckedOffset(block_num, (int)GetOffset(GetCodePointer()));
+	SetBlockInterpreted(block_num, true);
+	return true;
+}
+
 void X64JitBackend::WriteConstExit(uint32_t pc) {
 	int block_num = blocks_.GetBlockNumberFromStartAddress(pc);
 	const IRNativeBlock *nativeBlock = GetNativeBlock(block_num);
 
 	int exitStart = (int)GetOffset(GetCodePointer());
-	if (block_num >= 0 && jo.enableBlocklink && nativeBlock && nativeBlock->checkedOffset != 0) {
+	if (block_num >= 0 && jo.enableBlocklink && nativeBlock && nativeBlock->checkedOffset != 0 && !nativeBlock->interpreted) {
 		JMP(GetBasePtr() + nativeBlock->checkedOffset, true);
 	} else {
 		MOV(32, R(SCRATCH1), Imm32(pc));
@@ -53,6 +53,7 @@ class X64JitBackend : public Gen::XCodeBlock, public IRNativeBackend {
 
 	void GenerateFixedCode(MIPSState *mipsState) override;
 	bool CompileBlock(IRBlockCache *irBlockCache, int block_num, bool preload) override;
+	bool CompileInterpretedBlock(IRBlockCache *irBlockCache, int block_num) override;
 	void ClearAllBlocks() override;
 	void InvalidateBlock(IRBlockCache *irBlockCache, int block_num) override;
 
@@ -118,6 +119,7 @@ class X64JitBackend : public Gen::XCodeBlock, public IRNativeBackend {
 	void CompIR_VecClamp(IRInst inst) override;
 	void CompIR_VecHoriz(IRInst inst) override;
 	void CompIR_VecLoad(IRInst inst) override;
+	void CompIR_VecMatrix(IRInst inst) override;
 	void CompIR_VecPack(IRInst inst) override;
 	void CompIR_VecStore(IRInst inst) override;
 	void CompIR_ValidateAddress(IRInst inst) override;
@@ -0,0 +1,335 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+
+#include <atomic>
+#include <memory>
+
+#include "Common/Log.h"
+#include "Common/MachineContext.h"
+#include "Common/MemoryUtil.h"
+#include "Core/Config.h"
+#include "Core/MemDirtyTracker.h"
+#include "Core/MemMap.h"
+
+namespace Memory {
+
+bool g_stateOmitsTrackedMemory = false;
+
+static std::atomic<bool> g_tracking{};
+static std::atomic<int> g_users{};
+static std::atomic<int> g_generation{};
+// Bumped on each first write to a page, never reset so stamps from before a restart stay stale.
+static std::atomic<uint64_t> g_writeCounter{ 1 };
+// A spinlock, since it's taken in the fault handler.  Nothing holding it touches PSP memory.
+static std::atomic_flag g_lock = ATOMIC_FLAG_INIT;
+
+// Written under the lock.  Never freed once allocated, so a late fault can still look here.
+static std::unique_ptr<std::atomic<uint8_t>[]> g_pageProtected;
+// Written since the last Collect.  Separate from protection, since Protect can re-arm pages early.
+static std::unique_ptr<std::atomic<uint8_t>[]> g_pageWritten;
+// The write counter as of the last time the page was unprotected.
+static std::unique_ptr<std::atomic<uint64_t>[]> g_pageStamps;
+// Pages temporarily kept writable for host system calls.
+static std::unique_ptr<std::atomic<uint16_t>[]> g_pagePins;
+static std::atomic<uint32_t> g_numPages{};
+static uint32_t g_allocatedPages = 0;
+
+static const uint32_t VRAM_PAGES = VRAM_SIZE >> DIRTY_PAGE_SHIFT;
+
+namespace {
+
+struct SpinGuard {
+	SpinGuard() {
+		while (g_lock.test_and_set(std::memory_order_acquire))
+			continue;
+	}
+	~SpinGuard() {
+		g_lock.clear(std::memory_order_release);
+	}
+};
+
+}  // namespace
+
+static int64_t PageForAddress(uint32_t address) {
+	// All the mirrors map the same pages.
+	address &= 0x3FFFFFFF;
+	if (address >= PSP_GetVidMemBase() && address < PSP_GetVidMemBase() + VRAM_SIZE * 4)
+		return (address & (VRAM_SIZE - 1)) >> DIRTY_PAGE_SHIFT;
+	if (address >= PSP_GetKernelMemoryBase() && address < PSP_GetKernelMemoryBase() + g_MemorySize)
+		return VRAM_PAGES + ((address - PSP_GetKernelMemoryBase()) >> DIRTY_PAGE_SHIFT);
+	return -1;
+}
+
+static int64_t PageForHostPointer(uintptr_t ptr) {
+	const uintptr_t baseAddress = (uintptr_t)base;
+	if (!base || ptr < baseAddress || ptr - baseAddress >= 0x100000000ULL)
+		return -1;
+	return PageForAddress((uint32_t)(ptr - baseAddress));
+}
+
+// Only ranges within one of VRAM or RAM, and not wrapping around a VRAM mirror.
+static bool PageRangeForAddress(uint32_t address, uint32_t size, uint32_t *first, uint32_t *count) {
+	address &= 0x3FFFFFFF;
+	if (size == 0 || size > 0x10000000)
+		return false;
+	int64_t firstPage = PageForAddress(address);
+	int64_t lastPage = PageForAddress(address + size - 1);
+	if (firstPage < 0 || lastPage < firstPage || lastPage >= (int64_t)g_numPages)
+		return false;
+	if (lastPage - firstPage != (int64_t)(((address + size - 1) >> DIRTY_PAGE_SHIFT) - (address >> DIRTY_PAGE_SHIFT)))
+		return false;
+	*first = (uint32_t)firstPage;
+	*count = (uint32_t)(lastPage - firstPage + 1);
+	return true;
+}
+
+uint32_t DirtyTracking_PageAddress(uint32_t page) {
+	if (page < VRAM_PAGES)
+		return PSP_GetVidMemBase() + (page << DIRTY_PAGE_SHIFT);
+	return PSP_GetKernelMemoryBase() + ((page - VRAM_PAGES) << DIRTY_PAGE_SHIFT);
+}
+
+uint32_t DirtyTracking_NumPages() {
+	return g_numPages;
+}
+
+static void SetPagesWritable(uint32_t first, uint32_t count, bool writable) {
+	// VRAM and RAM pages aren't contiguous, so split there.
+	if (first < VRAM_PAGES && first + count > VRAM_PAGES) {
+		SetPagesWritable(first, VRAM_PAGES - first, writable);
+		SetPagesWritable(VRAM_PAGES, first + count - VRAM_PAGES, writable);
+		return;
+	}
+	ProtectRange(DirtyTracking_PageAddress(first), count << DIRTY_PAGE_SHIFT, writable);
+}
+
+bool DirtyTracking_Supported() {
+#if PPSSPP_ARCH(64BIT) && !defined(MASKED_PSP_MEMORY) && defined(MACHINE_CONTEXT_SUPPORTED) && !defined(__LIBRETRO__)
+	// Network system calls write straight into PSP memory, and those can't be caught.
+	return base != nullptr && GetMemoryProtectPageSize() <= DIRTY_PAGE_SIZE && !g_Config.bEnableWlan;
+#else
+	return false;
+#endif
+}
+
+bool DirtyTracking_Start(DirtyTrackingUser user) {
+	if (g_tracking) {
+		g_users |= user;
+		return true;
+	}
+	if (!DirtyTracking_Supported())
+		return false;
+
+	const uint32_t numPages = VRAM_PAGES + (g_MemorySize >> DIRTY_PAGE_SHIFT);
+	SpinGuard guard;
+	if (g_allocatedPages < numPages) {
+		g_pageProtected.reset(new std::atomic<uint8_t>[numPages]);
+		g_pageWritten.reset(new std::atomic<uint8_t>[numPages]);
+		g_pageStamps.reset(new std::atomic<uint64_t>[numPages]);
+		g_pagePins.reset(new std::atomic<uint16_t>[numPages]);
+		g_allocatedPages = numPages;
+	}
+	const uint64_t stamp = ++g_writeCounter;
+	for (uint32_t i = 0; i < numPages; ++i) {
+		g_pageProtected[i] = 1;
+		g_pageWritten[i] = 0;
+		g_pageStamps[i] = stamp;
+		g_pagePins[i] = 0;
+	}
+	g_numPages = numPages;
+	g_users = user;
+	g_tracking = true;
+	g_generation++;
+	SetPagesWritable(0, numPages, false);
+	INFO_LOG(Log::MemMap, "Tracking writes to %d pages of memory", (int)numPages);
+	return true;
+}
+
+void DirtyTracking_StopAll() {
+	if (!g_tracking)
+		return;
+
+	SpinGuard guard;
+	g_tracking = false;
+	g_users = 0;
+	g_generation++;
+	SetPagesWritable(0, g_numPages, true);
+	// From now on, faults in PSP memory are real crashes again.
+	g_numPages = 0;
+}
+
+void DirtyTracking_Stop(DirtyTrackingUser user) {
+	if (!g_tracking || (g_users & user) == 0)
+		return;
+	if ((g_users &= ~user) == 0)
+		DirtyTracking_StopAll();
+}
+
+bool DirtyTracking_Active() {
+	return g_tracking;
+}
+
+bool DirtyTracking_Active(DirtyTrackingUser user) {
+	return g_tracking && (g_users & user) != 0;
+}
+
+int DirtyTracking_Generation() {
+	return g_generation;
+}
+
+void DirtyTracking_Collect(std::vector<uint32_t> *pages) {
+	if (!g_tracking)
+		return;
+
+	SpinGuard guard;
+	const uint32_t numPages = g_numPages;
+	uint32_t runStart = 0;
+	uint32_t runLength = 0;
+	for (uint32_t i = 0; i < numPages; ++i) {
+		if (!g_pageWritten[i].load(std::memory_order_relaxed))
+			continue;
+		pages->push_back(i);
+		// Pinned pages stay writable, so they'll just show up again next time.
+		if (g_pagePins[i].load(std::memory_order_relaxed) != 0)
+			continue;
+
+		g_pageWritten[i].store(0, std::memory_order_relaxed);
+		// Protect may already have re-armed it.
+		if (g_pageProtected[i].load(std::memory_order_relaxed))
+			continue;
+		g_pageProtected[i].store(1, std::memory_order_relaxed);
+		if (runLength != 0 && runStart + runLength == i) {
+			runLength++;
+		} else {
+			if (runLength != 0)
+				SetPagesWritable(runStart, runLength, false);
+			runStart = i;
+			runLength = 1;
+		}
+	}
+	if (runLength != 0)
+		SetPagesWritable(runStart, runLength, false);
+}
+
+uint64_t DirtyTracking_Protect(uint32_t address, uint32_t size) {
+	if (!g_tracking)
+		return 0;
+
+	SpinGuard guard;
+	uint32_t first, count;
+	if (g_numPages == 0 || !PageRangeForAddress(address, size, &first, &count))
+		return 0;
+	uint32_t runStart = 0;
+	uint32_t runLength = 0;
+	for (uint32_t i = first; i < first + count; ++i) {
+		// Pinned pages have to stay writable, so the range just won't count as unchanged.
+		if (g_pageProtected[i].load(std::memory_order_relaxed) || g_pagePins[i].load(std::memory_order_relaxed) != 0)
+			continue;
+
+		g_pageProtected[i].store(1, std::memory_order_relaxed);
+		if (runLength != 0 && runStart + runLength == i) {
+			runLength++;
+		} else {
+			if (runLength != 0)
+				SetPagesWritable(runStart, runLength, false);
+			runStart = i;
+			runLength = 1;
+		}
+	}
+	if (runLength != 0)
+		SetPagesWritable(runStart, runLength, false);
+	return g_writeCounter;
+}
+
+bool DirtyTracking_UnchangedSince(uint32_t address, uint32_t size, uint64_t stamp) {
+	if (!g_tracking || stamp == 0)
+		return false;
+
+	SpinGuard guard;
+	uint32_t first, count;
+	if (g_numPages == 0 || !PageRangeForAddress(address, size, &first, &count))
+		return false;
+	for (uint32_t i = first; i < first + count; ++i) {
+		// A writable page might be written at any time without us hearing about it.
+		if (!g_pageProtected[i].load(std::memory_order_relaxed) || g_pagePins[i].load(std::memory_order_relaxed) != 0)
+			return false;
+		if (g_pageStamps[i].load(std::memory_order_relaxed) > stamp)
+			return false;
+	}
+	return true;
+}
+
+bool DirtyTracking_HandleFault(uintptr_t hostAddress) {
+	// Checked first without the lock, since most faults have nothing to do with this.
+	if (g_numPages == 0)
+		return false;
+	int64_t page = PageForHostPointer(hostAddress);
+	if (page < 0 || page >= (int64_t)g_numPages)
+		return false;
+
+	SpinGuard guard;
+	// If this raced with Stop(), the page is already writable again, so just retry.
+	if (g_numPages == 0)
+		return true;
+	g_pageProtected[page].store(0, std::memory_order_relaxed);
+	g_pageWritten[page].store(1, std::memory_order_relaxed);
+	g_pageStamps[page].store(++g_writeCounter, std::memory_order_relaxed);
+	SetPagesWritable((uint32_t)page, 1, true);
+	return true;
+}
+
+DirtyHostWriteScope::DirtyHostWriteScope(const void *ptr, size_t size) {
+	if (!g_tracking || size == 0)
+		return;
+	int64_t first = PageForHostPointer((uintptr_t)ptr);
+	int64_t last = PageForHostPointer((uintptr_t)ptr + size - 1);
+	if (first < 0 || last < first)
+		return;
+
+	SpinGuard guard;
+	const uint64_t stamp = ++g_writeCounter;
+	for (int64_t i = first; i <= last; ++i) {
+		g_pagePins[i]++;
+		g_pageProtected[i].store(0, std::memory_order_relaxed);
+		g_pageWritten[i].store(1, std::memory_order_relaxed);
+		g_pageStamps[i].store(stamp, std::memory_order_relaxed);
+	}
+	SetPagesWritable((uint32_t)first, (uint32_t)(last - first + 1), true);
+	firstPage_ = first;
+	lastPage_ = last;
+	generation_ = g_generation;
+}
+
+DirtyHostWriteScope::~DirtyHostWriteScope() {
+	if (firstPage_ < 0)
+		return;
+
+	SpinGuard guard;
+	// If tracking restarted meanwhile, the pins were already reset.
+	if (generation_ != g_generation)
+		return;
+	// The host wrote while it was pinned.
+	const uint64_t stamp = ++g_writeCounter;
+	for (int64_t i = firstPage_; i <= lastPage_; ++i) {
+		g_pagePins[i]--;
+		g_pageStamps[i].store(stamp, std::memory_order_relaxed);
+	}
+}
+
+}  // namespace Memory
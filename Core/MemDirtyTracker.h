@@ -0,0 +1,84 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Tracks which pages of RAM and VRAM get written, by write protecting them and catching the
+// first write to each page in the fault handler.  Used by rewind to only copy what changed,
+// and by the texture cache to skip rehashing textures nothing wrote to.
+// The write can come from anywhere - the jit, HLE, or the GPU thread - as long as it's a plain
+// store.  Host system calls writing into PSP memory (like file reads) must use DirtyHostWriteScope.
+namespace Memory {
+
+enum {
+	DIRTY_PAGE_SHIFT = 14,
+	DIRTY_PAGE_SIZE = 1 << DIRTY_PAGE_SHIFT,
+};
+
+// Tracking stays on as long as any of these want it.
+enum DirtyTrackingUser {
+	DIRTY_USER_REWIND = 1,
+	DIRTY_USER_TEXTURES = 2,
+};
+
+// While set, DoState leaves out the tracked memory, since rewind keeps it separately.
+extern bool g_stateOmitsTrackedMemory;
+
+// False if the platform or memory map can't support it, or it's unsafe (like with networking.)
+bool DirtyTracking_Supported();
+// Protects all pages, unless another user already started it.  Returns false if unsupported.
+bool DirtyTracking_Start(DirtyTrackingUser user);
+void DirtyTracking_Stop(DirtyTrackingUser user);
+// For shutdown, when memory goes away regardless of users.
+void DirtyTracking_StopAll();
+bool DirtyTracking_Active();
+bool DirtyTracking_Active(DirtyTrackingUser user);
+// Changes whenever tracking starts or stops, so users know when what they collected is invalid.
+int DirtyTracking_Generation();
+
+// Pages are numbered across VRAM, then RAM.
+uint32_t DirtyTracking_NumPages();
+uint32_t DirtyTracking_PageAddress(uint32_t page);
+// Appends the pages written since the last call, and protects them again.  Only for rewind.
+void DirtyTracking_Collect(std::vector<uint32_t> *pages);
+
+// Protects the pages of a range again, and returns a stamp to check it against later.  Read the
+// range after this, not before.  Returns 0 if the range can't be tracked.
+uint64_t DirtyTracking_Protect(uint32_t address, uint32_t size);
+// True only if nothing can have written to the range since the stamp was returned by Protect.
+bool DirtyTracking_UnchangedSince(uint32_t address, uint32_t size, uint64_t stamp);
+
+// Called by the fault handler.  Returns true if it was the first write to a tracked page.
+bool DirtyTracking_HandleFault(uintptr_t hostAddress);
+
+// Keeps a range writable, and counted as written, for as long as it exists.
+class DirtyHostWriteScope {
+public:
+	DirtyHostWriteScope(const void *ptr, size_t size);
+	~DirtyHostWriteScope();
+
+private:
+	int64_t firstPage_ = -1;
+	int64_t lastPage_ = -1;
+	int generation_ = 0;
+};
+
+}  // namespace Memory
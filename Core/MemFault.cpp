@@ -37,6 +37,7 @@
 #include "Common/Log.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
+#include "Core/MemDirtyTracker.h"
 #include "Core/MemFault.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
@@ -103,6 +104,10 @@ static bool DisassembleNativeAt(const uint8_t *codePtr, int instructionSize, std
 }
 
 bool HandleFault(uintptr_t hostAddress, void *ctx) {
+	// This can come from any thread, so it has to be checked before touching anything else.
+	if (DirtyTracking_HandleFault(hostAddress))
+		return true;
+
 	if (inCrashHandler)
 		return false;
 	inCrashHandler = true;
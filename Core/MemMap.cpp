@@ -26,6 +26,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 
@@ -36,6 +37,7 @@
 #include "Core/HDRemaster.h"
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/MemMap.h"
+#include "Core/MemDirtyTracker.h"
 #include "Core/MemFault.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
@@ -382,17 +384,45 @@ void DoState(PointerWrap &p) {
 		}
 	}
 
-	DoMemoryVoid(p, PSP_GetKernelMemoryBase(), g_MemorySize);
-	p.DoMarker("RAM");
+	// Rewind keeps these separately, only copying the pages that changed.
+	if (!g_stateOmitsTrackedMemory) {
+		DoMemoryVoid(p, PSP_GetKernelMemoryBase(), g_MemorySize);
+		p.DoMarker("RAM");
 
-	DoMemoryVoid(p, PSP_GetVidMemBase(), VRAM_SIZE);
-	p.DoMarker("VRAM");
+		DoMemoryVoid(p, PSP_GetVidMemBase(), VRAM_SIZE);
+		p.DoMarker("VRAM");
+	}
 	DoArray(p, m_pPhysicalScratchPad, SCRATCHPAD_SIZE);
 	p.DoMarker("ScratchPad");
 }
 
+bool ProtectRange(u32 address, u32 size, bool writable) {
+	const uint32_t protFlags = MEM_PROT_READ | (writable ? MEM_PROT_WRITE : 0);
+	bool success = true;
+	// Each view that isn't a mirror starts a new group, each with its own memory.
+	u32 groupStart = 0;
+	u32 groupEnd = 0;
+	for (int i = 0; i < num_views; i++) {
+		const MemoryView &view = views[i];
+		if (!(view.flags & MV_MIRROR_PREVIOUS)) {
+			groupStart = view.virtual_address;
+			groupEnd = view.virtual_address + view.size;
+		}
+		if (view.size == 0 || !*view.out_ptr)
+			continue;
+
+		const u32 start = std::max(address, groupStart);
+		const u32 end = std::min(address + size, groupEnd);
+		if (start < end && !CanIgnoreView(view)) {
+			success = ProtectMemoryPages(*view.out_ptr + (start - groupStart), end - start, protFlags) && success;
+		}
+	}
+	return success;
+}
+
 void Shutdown() {
 	std::lock_guard<std::recursive_mutex> guard(g_shutdownLock);
+	DirtyTracking_StopAll();
 	u32 flags = 0;
 	MemoryMap_Shutdown(flags);
 	base = nullptr;
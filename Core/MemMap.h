@@ -112,6 +112,8 @@ void MemoryMap_Shutdown(u32 flags);
 bool Init();
 void Shutdown();
 void DoState(PointerWrap &p);
+// Changes write access to part of RAM or VRAM, in every view that maps it.
+bool ProtectRange(u32 address, u32 size, bool writable);
 void Clear();
 // False when shutdown has already been called.
 bool IsActive();
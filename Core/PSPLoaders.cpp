@@ -18,6 +18,7 @@
 #include <thread>
 
 #include "Core/Core.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/System/Request.h"
 
@@ -69,6 +70,7 @@ static void UseLargeMem(int memsize) {
 // to determine if the emulator should enable extra memory and
 // double-sized texture coordinates.
 void InitMemoryForGameISO(FileLoader *fileLoader) {
+	TRACE_SCOPE("boot_mount");
 	if (!fileLoader->Exists()) {
 		return;
 	}
@@ -165,6 +167,7 @@ bool ReInitMemoryForGameISO(FileLoader *fileLoader) {
 }
 
 void InitMemoryForGamePBP(FileLoader *fileLoader) {
+	TRACE_SCOPE("boot_mount");
 	if (!fileLoader->Exists()) {
 		return;
 	}
@@ -307,6 +310,7 @@ bool Load_PSP_ISO(FileLoader *fileLoader, std::string *error_string) {
 	// Instead: Use Core_ListenLifecycle() or watch coreState.
 	g_loadingThread = std::thread([bootpath] {
 		SetCurrentThreadName("ExecLoader");
+		TRACE_SCOPE("boot_load_exec");
 		PSP_LoadingLock guard;
 		if (coreState != CORE_POWERUP)
 			return;
@@ -471,6 +475,7 @@ bool Load_PSP_ELF_PBP(FileLoader *fileLoader, std::string *error_string) {
 	// Note: See Load_PSP_ISO for notes about this thread.
 	g_loadingThread = std::thread([finalName] {
 		SetCurrentThreadName("ExecLoader");
+		TRACE_SCOPE("boot_load_exec");
 		PSP_LoadingLock guard;
 		if (coreState != CORE_POWERUP)
 			return;
@@ -502,6 +507,7 @@ bool Load_PSP_GE_Dump(FileLoader *fileLoader, std::string *error_string) {
 	// Note: See Load_PSP_ISO for notes about this thread.
 	g_loadingThread = std::thread([] {
 		SetCurrentThreadName("ExecLoader");
+		TRACE_SCOPE("boot_load_exec");
 		PSP_LoadingLock guard;
 		if (coreState != CORE_POWERUP)
 			return;
@@ -24,17 +24,23 @@
 
 #include <cstring>
 #include <ctime>
+#include <string>
 #include <vector>
 
+#include <zstd.h>
+
 #include "Common/CommonTypes.h"
 #include "Common/Log.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Core/CoreTiming.h"
 #include "Core/Replay.h"
+#include "Core/SaveState.h"
 #include "Core/FileSystems/FileSystem.h"
 #include "Core/HLE/sceCtrl.h"
 #include "Core/HLE/sceKernelTime.h"
 #include "Core/HLE/sceRtc.h"
+#include "Core/HW/Display.h"
 
 enum class ReplayState {
 	IDLE,
@@ -49,6 +55,9 @@ enum class ReplayState {
 //   - ReplayItemHeader (primary event details)
 //   - Side data of bytes listed in header, if SIDEDATA flag set on action.
 //
+// While recording, a KEYFRAME event with a save state is added every so often, so that seeking
+// can start close to where it's going.  See ReplayKeyframeHeader.
+//
 // The header doesn't say how long the replay is, because new events are
 // appended to the file as they occur.  It is usually near, and always less than:
 //
@@ -59,7 +68,7 @@ enum class ReplayState {
 
 static const char * const REPLAY_MAGIC = "PPREPLAY";
 static const int REPLAY_VERSION_MIN = 1;
-static const int REPLAY_VERSION_CURRENT = 1;
+static const int REPLAY_VERSION_CURRENT = 2;
 
 struct ReplayFileHeader {
 	char magic[8];
@@ -112,8 +121,30 @@ struct ReplayFileInfo {
 	s64_le mtime = 0;
 };
 
+// Side data of a KEYFRAME, followed by the zstd compressed state.
+struct ReplayKeyframeHeader {
+	u32_le vcount;
+	u32_le flags;
+	u32_le stateSize;
+	u32_le reserved;
+};
+
 #pragma pack(pop)
 
+enum {
+	// Compressed with the previous keyframe's state as a zstd prefix.
+	KEYFRAME_DELTA = 1,
+	KEYFRAME_SAW_GAME_DIR_WRITE = 2,
+};
+
+// About 10 seconds.
+static const int KEYFRAME_INTERVAL_DEFAULT = 600;
+// Limits how many keyframes have to be decompressed to seek.
+static const int KEYFRAME_FULL_EVERY = 8;
+// The previous state is a whole state back, so the window has to reach that far.
+static const int KEYFRAME_WINDOW_LOG = 28;
+static const size_t NO_KEYFRAME = (size_t)-1;
+
 struct ReplayItem {
 	ReplayItemHeader info;
 	std::vector<uint8_t> data;
@@ -136,6 +167,15 @@ static uint8_t lastAnalog[2][2]{};
 static size_t replayDiskPos = 0;
 static bool diskFailed = false;
 
+static int keyframeInterval = KEYFRAME_INTERVAL_DEFAULT;
+// State of the last keyframe recorded, empty if none yet.
+static std::vector<u8> lastKeyframe;
+static int lastKeyframeVCount = 0;
+static int keyframesSinceFull = 0;
+
+static int seekTarget = -1;
+static size_t seekKeyframe = NO_KEYFRAME;
+
 bool ReplayExecuteBlob(int version, const std::vector<uint8_t> &data) {
 	if (version < REPLAY_VERSION_MIN || version > REPLAY_VERSION_CURRENT) {
 		ERROR_LOG(Log::System, "Bad replay data version: %d", version);
@@ -171,7 +211,7 @@ bool ReplayExecuteBlob(int version, const std::vector<uint8_t> &data) {
 			}
 		}
 
-		replayItems.push_back(item);
+		replayItems.push_back(std::move(item));
 	}
 
 	replayState = ReplayState::EXECUTE;
@@ -252,6 +292,10 @@ void ReplayBeginSave() {
 		// Discard any unexecuted items, but resume from there.
 		// The parameter isn't used here, since we'll always be resizing down.
 		replayItems.resize(replayExecPos, ReplayItem(ReplayItemHeader(ReplayAction::BUTTONS, 0)));
+		// New keyframes can't be deltas against what we executed, that's not kept.
+		lastKeyframe.clear();
+		seekTarget = -1;
+		seekKeyframe = NO_KEYFRAME;
 	}
 
 	replayState = ReplayState::SAVE;
@@ -335,6 +379,12 @@ void ReplayAbort() {
 
 	replayDiskPos = 0;
 	diskFailed = false;
+
+	lastKeyframe.clear();
+	lastKeyframeVCount = 0;
+	keyframesSinceFull = 0;
+	seekTarget = -1;
+	seekKeyframe = NO_KEYFRAME;
 }
 
 bool ReplayIsExecuting() {
@@ -345,6 +395,184 @@ bool ReplayIsSaving() {
 	return replayState == ReplayState::SAVE;
 }
 
+static const ReplayKeyframeHeader *KeyframeHeader(const ReplayItem &item) {
+	if (item.info.action != ReplayAction::KEYFRAME || item.data.size() < sizeof(ReplayKeyframeHeader))
+		return nullptr;
+	return (const ReplayKeyframeHeader *)&item.data[0];
+}
+
+static void ReplaySaveKeyframe(int vcount) {
+	std::vector<u8> state;
+	if (SaveState::SaveToRam(state) != CChunkFileReader::ERROR_NONE) {
+		WARN_LOG(Log::System, "Could not save replay keyframe at vcount %d", vcount);
+		return;
+	}
+
+	const bool delta = !lastKeyframe.empty() && keyframesSinceFull + 1 < KEYFRAME_FULL_EVERY;
+	ZSTD_CCtx *cctx = ZSTD_createCCtx();
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, 1);
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, KEYFRAME_WINDOW_LOG);
+	// Most of the state is the same as last time, but it tends to move around.
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+	if (delta)
+		ZSTD_CCtx_refPrefix(cctx, lastKeyframe.data(), lastKeyframe.size());
+
+	ReplayItem item(ReplayItemHeader(ReplayAction::KEYFRAME, CoreTiming::GetGlobalTimeUs(), (uint32_t)0));
+	item.data.resize(sizeof(ReplayKeyframeHeader) + ZSTD_compressBound(state.size()));
+	size_t compressed = ZSTD_compress2(cctx, &item.data[sizeof(ReplayKeyframeHeader)], item.data.size() - sizeof(ReplayKeyframeHeader), state.data(), state.size());
+	ZSTD_freeCCtx(cctx);
+	if (ZSTD_isError(compressed)) {
+		WARN_LOG(Log::System, "Could not compress replay keyframe: %s", ZSTD_getErrorName(compressed));
+		return;
+	}
+
+	ReplayKeyframeHeader header{};
+	header.vcount = vcount;
+	header.flags = (delta ? KEYFRAME_DELTA : 0) | (replaySawGameDirWrite ? KEYFRAME_SAW_GAME_DIR_WRITE : 0);
+	header.stateSize = (u32)state.size();
+	memcpy(&item.data[0], &header, sizeof(header));
+	item.data.resize(sizeof(ReplayKeyframeHeader) + compressed);
+	item.info.size = (u32)item.data.size();
+	replayItems.push_back(std::move(item));
+
+	DEBUG_LOG(Log::System, "Saved replay keyframe at vcount %d, %d bytes", vcount, (int)compressed);
+	lastKeyframe = std::move(state);
+	lastKeyframeVCount = vcount;
+	keyframesSinceFull = delta ? keyframesSinceFull + 1 : 0;
+}
+
+static bool ReplayDecodeKeyframe(size_t index, std::vector<u8> *state) {
+	// A delta needs every keyframe back to the last full one.
+	std::vector<size_t> chain;
+	for (size_t i = index + 1; i-- > 0; ) {
+		const ReplayKeyframeHeader *header = KeyframeHeader(replayItems[i]);
+		if (!header)
+			continue;
+		chain.push_back(i);
+		if ((header->flags & KEYFRAME_DELTA) == 0)
+			break;
+	}
+	if (chain.empty() || (KeyframeHeader(replayItems[chain.back()])->flags & KEYFRAME_DELTA) != 0) {
+		ERROR_LOG(Log::System, "Replay keyframe is missing the keyframes it depends on");
+		return false;
+	}
+
+	ZSTD_DCtx *dctx = ZSTD_createDCtx();
+	ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, KEYFRAME_WINDOW_LOG);
+	std::vector<u8> previous;
+	bool success = true;
+	for (size_t n = chain.size(); n-- > 0 && success; ) {
+		const ReplayItem &item = replayItems[chain[n]];
+		const ReplayKeyframeHeader *header = KeyframeHeader(item);
+		state->resize(header->stateSize);
+		if (header->flags & KEYFRAME_DELTA)
+			ZSTD_DCtx_refPrefix(dctx, previous.data(), previous.size());
+		size_t result = ZSTD_decompressDCtx(dctx, state->data(), state->size(), &item.data[sizeof(ReplayKeyframeHeader)], item.data.size() - sizeof(ReplayKeyframeHeader));
+		success = !ZSTD_isError(result) && result == state->size();
+		previous.swap(*state);
+	}
+	ZSTD_freeDCtx(dctx);
+
+	if (!success) {
+		ERROR_LOG(Log::System, "Replay keyframe data corrupt");
+		return false;
+	}
+	state->swap(previous);
+	return true;
+}
+
+static bool ReplayLoadKeyframe(size_t index) {
+	std::vector<u8> state;
+	if (!ReplayDecodeKeyframe(index, &state))
+		return false;
+
+	std::string errorString;
+	if (SaveState::LoadFromRam(state, &errorString) != CChunkFileReader::ERROR_NONE) {
+		ERROR_LOG(Log::System, "Could not load replay keyframe: %s", errorString.c_str());
+		return false;
+	}
+
+	// Everything before the keyframe already happened.
+	replayExecPos = index + 1;
+	replayCtrlPos = index + 1;
+	replayDiskPos = index + 1;
+	diskFailed = false;
+	replaySawGameDirWrite = (KeyframeHeader(replayItems[index])->flags & KEYFRAME_SAW_GAME_DIR_WRITE) != 0;
+
+	// The latest input is always applied, so catch up on what it was.
+	lastButtons = 0;
+	memset(lastAnalog, 0, sizeof(lastAnalog));
+	for (size_t i = 0; i < index; ++i) {
+		const auto &item = replayItems[i];
+		if (item.info.action == ReplayAction::BUTTONS)
+			lastButtons = item.info.buttons;
+		else if (item.info.action == ReplayAction::ANALOG)
+			memcpy(lastAnalog, item.info.analog, sizeof(lastAnalog));
+	}
+
+	INFO_LOG(Log::System, "Loaded replay keyframe at vcount %d", (int)KeyframeHeader(replayItems[index])->vcount);
+	return true;
+}
+
+void ReplaySetKeyframeInterval(int vblanks) {
+	keyframeInterval = vblanks;
+}
+
+bool ReplaySeekFrame(int vblank) {
+	if (replayState != ReplayState::EXECUTE)
+		return false;
+
+	size_t found = NO_KEYFRAME;
+	for (size_t i = 0; i < replayItems.size(); ++i) {
+		const ReplayKeyframeHeader *header = KeyframeHeader(replayItems[i]);
+		if (!header)
+			continue;
+		if ((int)header->vcount > vblank)
+			break;
+		found = i;
+	}
+
+	// If we're already past the best keyframe, just keep going from here.
+	const int current = __DisplayGetVCount();
+	if (vblank >= current && (found == NO_KEYFRAME || (int)KeyframeHeader(replayItems[found])->vcount <= current)) {
+		found = NO_KEYFRAME;
+	} else if (found == NO_KEYFRAME) {
+		WARN_LOG(Log::System, "No replay keyframe before vcount %d", vblank);
+		return false;
+	}
+
+	seekTarget = vblank;
+	seekKeyframe = found;
+	return true;
+}
+
+bool ReplayIsSeeking() {
+	return seekTarget >= 0;
+}
+
+void ReplayBeginFrame() {
+	if (replayState == ReplayState::SAVE && keyframeInterval > 0) {
+		const int vcount = __DisplayGetVCount();
+		if (lastKeyframe.empty() || vcount < lastKeyframeVCount || vcount - lastKeyframeVCount >= keyframeInterval)
+			ReplaySaveKeyframe(vcount);
+	}
+
+	if (seekTarget < 0)
+		return;
+	if (seekKeyframe != NO_KEYFRAME) {
+		size_t index = seekKeyframe;
+		seekKeyframe = NO_KEYFRAME;
+		if (!ReplayLoadKeyframe(index)) {
+			seekTarget = -1;
+			return;
+		}
+	}
+	if (replayState != ReplayState::EXECUTE || __DisplayGetVCount() >= seekTarget) {
+		INFO_LOG(Log::System, "Replay seek finished at vcount %d", __DisplayGetVCount());
+		seekTarget = -1;
+	}
+}
+
 static void ReplaySaveCtrl(uint32_t &buttons, uint8_t analog[2][2], uint64_t t) {
 	if (lastButtons != buttons) {
 		replayItems.push_back(ReplayItemHeader(ReplayAction::BUTTONS, t, buttons));
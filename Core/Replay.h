@@ -41,6 +41,9 @@ enum class ReplayAction : uint8_t {
 	RMDIR = 0x48,
 	FREESPACE = 0x49,
 
+	// A save state to seek from, compressed against the previous one.
+	KEYFRAME = 0x90,
+
 	MASK_FILE = 0x40,
 	MASK_SIDEDATA = 0x80,
 };
@@ -65,6 +68,16 @@ bool ReplayFlushFile(const Path &filename);
 // Get current replay data version.
 int ReplayVersion();
 
+// Set how often keyframes are recorded, in vblanks.  0 disables them.
+void ReplaySetKeyframeInterval(int vblanks);
+// Start seeking to a vblank count, from the closest keyframe before it if needed.
+// Only possible while executing.  Returns false if there's no keyframe to start from.
+bool ReplaySeekFrame(int vblank);
+// Returns whether frames are still being run toward a seek target.
+bool ReplayIsSeeking();
+// Call between frames on the emu thread.  Records keyframes, or loads one when seeking.
+void ReplayBeginFrame();
+
 // Abort any execute or record operation in progress.
 void ReplayAbort();
 
@@ -131,6 +131,7 @@ namespace Reporting
 
 	static int CalculateCRCThread() {
 		SetCurrentThreadName("ReportCRC");
+		SetCurrentThreadCoreClass(ThreadCoreClass::EFFICIENCY);
 
 		AndroidJNIThreadContext jniContext;
 
@@ -265,7 +265,9 @@ static uint32_t read_memory_callback(uint32_t address, uint8_t *buffer, uint32_t
 	uint32_t orig_address = address;
 	address += PSP_MEMORY_OFFSET;
 
-	if (!Memory::ValidSize(address, num_bytes)) {
+	// Might be cut short at the end of a memory region, rcheevos handles partial reads.
+	const uint32_t valid_bytes = Memory::ValidSize(address, num_bytes);
+	if (valid_bytes == 0) {
 		// Some achievement packs are really, really spammy.
 		// So we'll just count the bad accesses.
 		Achievements::g_stats.badMemoryAccessCount++;
@@ -277,8 +279,23 @@ static uint32_t read_memory_callback(uint32_t address, uint8_t *buffer, uint32_t
 		return 0;
 	}
 
-	Memory::MemcpyUnchecked(buffer, address, num_bytes);
-	return num_bytes;
+	// Almost all reads are single memrefs of 1, 2 or 4 bytes, once per frame each. Skip the memcpy call for those.
+	const uint8_t *src = Memory::GetPointerUnchecked(address);
+	switch (valid_bytes) {
+	case 1:
+		buffer[0] = src[0];
+		break;
+	case 2:
+		memcpy(buffer, src, 2);
+		break;
+	case 4:
+		memcpy(buffer, src, 4);
+		break;
+	default:
+		memcpy(buffer, src, valid_bytes);
+		break;
+	}
+	return valid_bytes;
 }
 
 // This is the HTTP request dispatcher that is provided to the rc_client. Whenever the client
@@ -20,12 +20,15 @@
 #include <thread>
 #include <mutex>
 
+#include <zstd.h>
+
 #include "Common/Data/Text/I18n.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Data/Text/Parsers.h"
 #include "Common/System/System.h"
 
 #include "Common/File/FileUtil.h"
+#include "Common/Math/SIMDHeaders.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/StringUtils.h"
@@ -44,11 +47,16 @@
 #include "Core/HLE/sceDisplay.h"
 #include "Core/HLE/sceKernel.h"
 #include "Core/HLE/sceUtility.h"
+#include "Core/MemDirtyTracker.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/RetroAchievements.h"
 #include "HW/MemoryStick.h"
+#include "GPU/GeThread.h"
+#include "GPU/GPU.h"
+#include "GPU/GPUCommon.h"
 #include "GPU/GPUState.h"
 
 #ifndef MOBILE_DEVICE
@@ -90,6 +98,37 @@ namespace SaveState
 		void *cbUserData;
 	};
 
+	// The jit patches emuhacks into memory, which mustn't end up in copies of memory.
+	// Runs func with them cleared, then puts them back.  If func replaces memory, only blocks whose
+	// code didn't change are kept, instead of throwing away the whole jit.  Returns blocks kept.
+	template <typename F>
+	static int WithoutEmuHacks(bool replacesMemory, F func) {
+		std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+		if (!MIPSComp::jit) {
+			func();
+			return 0;
+		}
+
+		std::vector<u32> savedBlocks = MIPSComp::jit->SaveAndClearEmuHackOps();
+		std::vector<u64> hashes;
+		if (replacesMemory)
+			hashes = MIPSComp::HashBlockCode(MIPSComp::jit);
+		func();
+		int kept = 0;
+		if (replacesMemory)
+			kept = MIPSComp::InvalidateChangedBlockCode(MIPSComp::jit, hashes);
+		MIPSComp::jit->RestoreSavedEmuHackOps(savedBlocks);
+		return kept;
+	}
+
+	// Same, but also without HLE replacements, for rewind's own copies of memory.
+	template <typename F>
+	static void WithUnpatchedMemory(bool replacesMemory, F func) {
+		auto savedReplacements = SaveAndClearReplacements();
+		WithoutEmuHacks(replacesMemory, func);
+		RestoreSavedReplacements(savedReplacements);
+	}
+
 	CChunkFileReader::Error SaveToRam(std::vector<u8> &data) {
 		SaveStart state;
 		return CChunkFileReader::MeasureAndSavePtr(state, &data);
@@ -100,23 +139,107 @@ namespace SaveState
 		return CChunkFileReader::LoadPtr(&data[0], state, errorString);
 	}
 
+	// Writes a ^ b to out, and returns whether they differed.
+	static bool XorBlock(const u8 *a, const u8 *b, u8 *out, size_t size) {
+		size_t i = 0;
+		bool differs = false;
+#if PPSSPP_ARCH(SSE2)
+		__m128i any = _mm_setzero_si128();
+		for (; i + 16 <= size; i += 16) {
+			__m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+			_mm_storeu_si128((__m128i *)(out + i), x);
+			any = _mm_or_si128(any, x);
+		}
+		differs = _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF;
+#elif PPSSPP_ARCH(ARM_NEON)
+		uint8x16_t any = vdupq_n_u8(0);
+		for (; i + 16 <= size; i += 16) {
+			uint8x16_t x = veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+			vst1q_u8(out + i, x);
+			any = vorrq_u8(any, x);
+		}
+		uint64x2_t any64 = vreinterpretq_u64_u8(any);
+		differs = (vgetq_lane_u64(any64, 0) | vgetq_lane_u64(any64, 1)) != 0;
+#endif
+		u8 rest = 0;
+		for (; i < size; ++i) {
+			out[i] = a[i] ^ b[i];
+			rest |= out[i];
+		}
+		return differs || rest != 0;
+	}
+
 	// This ring buffer of states is for rewind save states, which are kept in RAM.
 	// Save states are compressed against one of two reference saves (bases_), and the reference
 	// is switched to a fresh save every N saves, where N is BASE_USAGE_INTERVAL.
 	// The compression is a simple block based scheme where 0 means to copy a block from the base,
-	// and 1 means that the following bytes are the next block. See Compress/LockedDecompress.
+	// 1 means the following bytes are the next block xored with the base, and 2 means they're the
+	// next block as is.  The result is then run through zstd.  See Compress/LockedDecompress.
+	// Where writes to memory can be tracked, RAM and VRAM are left out of the states.  Instead,
+	// each state logs the pages written after it, as they were when it was saved.  See SyncMemory.
 	class StateRingbuffer {
+		// Pages of memory as they were when a state was saved, only those written after it.
+		// Once it's no longer the latest state, data is kept zstd compressed in packed.
+		struct PageLog {
+			std::vector<u32> pages;
+			std::vector<u8> data;
+			std::vector<bool> logged;
+			std::vector<u8> packed;
+
+			void Pack(ZSTD_CCtx *ctx) {
+				if (data.empty() || !packed.empty())
+					return;
+				packed.resize(ZSTD_compressBound(data.size()));
+				size_t size = ZSTD_compressCCtx(ctx, packed.data(), packed.size(), data.data(), data.size(), ZSTD_COMPRESSION_LEVEL);
+				if (ZSTD_isError(size)) {
+					packed.clear();
+					return;
+				}
+				packed.resize(size);
+				packed.shrink_to_fit();
+				data.clear();
+				data.shrink_to_fit();
+			}
+			void Unpack() {
+				if (packed.empty())
+					return;
+				data.resize(pages.size() * Memory::DIRTY_PAGE_SIZE);
+				size_t size = ZSTD_decompress(data.data(), data.size(), packed.data(), packed.size());
+				_dbg_assert_(!ZSTD_isError(size) && size == data.size());
+				packed.clear();
+				packed.shrink_to_fit();
+			}
+
+			void Add(u32 page, const u8 *src, u32 numPages) {
+				if (logged.size() < numPages)
+					logged.resize(numPages);
+				if (logged[page])
+					return;
+				logged[page] = true;
+				pages.push_back(page);
+				data.insert(data.end(), src, src + Memory::DIRTY_PAGE_SIZE);
+			}
+			void Clear() {
+				pages.clear();
+				data.clear();
+				logged.clear();
+				packed.clear();
+			}
+		};
+
 	public:
 		StateRingbuffer() {
 			size_ = REWIND_NUM_STATES;
 			states_.resize(size_);
 			baseMapping_.resize(size_);
+			pageLogs_.resize(size_);
 		}
 
 		~StateRingbuffer() {
 			if (compressThread_.joinable()) {
 				compressThread_.join();
 			}
+			ZSTD_freeCCtx(cctx_);
 		}
 
 		CChunkFileReader::Error Save()
@@ -128,14 +251,27 @@ namespace SaveState
 			if (compressThread_.joinable())
 				compressThread_.join();
 
+			// If memory was remapped, the logged pages no longer mean anything.
+			if (trackingMemory_ && Memory::DirtyTracking_Generation() != trackingGeneration_)
+				Clear();
+			// Only start with no states, so they're all saved the same way.
+			if (!trackingMemory_ && Empty())
+				StartTrackingMemory();
+
 			std::lock_guard<std::mutex> guard(lock_);
 
+			PageLog *previous = Empty() ? nullptr : &pageLogs_[(next_ - 1 + size_) % size_];
+			if (trackingMemory_)
+				WithUnpatchedMemory(false, [&] { SyncMemory(previous); });
+
 			int n = next_++ % size_;
 			if ((next_ % size_) == first_)
 				++first_;
+			pageLogs_[n].Clear();
 
 			std::vector<u8> *compressBuffer = &buffer_;
 			CChunkFileReader::Error err;
+			Memory::g_stateOmitsTrackedMemory = trackingMemory_;
 
 			if (base_ == -1 || ++baseUsage_ > BASE_USAGE_INTERVAL)
 			{
@@ -147,9 +283,13 @@ namespace SaveState
 			}
 			else
 				err = SaveToRam(buffer_);
+			Memory::g_stateOmitsTrackedMemory = false;
 
+			// The previous state's log won't change now unless we rewind to it, so pack it too.
+			if (previous == &pageLogs_[n])
+				previous = nullptr;
 			if (err == CChunkFileReader::ERROR_NONE)
-				ScheduleCompress(&states_[n], compressBuffer, &bases_[base_]);
+				ScheduleCompress(&states_[n], compressBuffer, &bases_[base_], previous);
 			else
 				states_[n].clear();
 
@@ -159,6 +299,11 @@ namespace SaveState
 
 		CChunkFileReader::Error Restore(std::string *errorString)
 		{
+			if (trackingMemory_ && Memory::DirtyTracking_Generation() != trackingGeneration_) {
+				Clear();
+				return CChunkFileReader::ERROR_BAD_FILE;
+			}
+
 			std::lock_guard<std::mutex> guard(lock_);
 
 			// No valid states left.
@@ -169,22 +314,88 @@ namespace SaveState
 			if (states_[n].empty())
 				return CChunkFileReader::ERROR_BAD_FILE;
 
+			// Memory first, so anything loading the state sees the right contents.
+			if (trackingMemory_)
+				WithUnpatchedMemory(true, [&] { RestoreMemory(pageLogs_[n]); });
+
 			static std::vector<u8> buffer;
 			LockedDecompress(buffer, states_[n], bases_[baseMapping_[n]]);
+			Memory::g_stateOmitsTrackedMemory = trackingMemory_;
 			CChunkFileReader::Error error = LoadFromRam(buffer, errorString);
+			Memory::g_stateOmitsTrackedMemory = false;
 			rewindLastTime_ = time_now_d();
 			return error;
 		}
 
-		void ScheduleCompress(std::vector<u8> *result, const std::vector<u8> *state, const std::vector<u8> *base)
+		void StartTrackingMemory()
+		{
+			if (!Memory::DirtyTracking_Start(Memory::DIRTY_USER_REWIND))
+				return;
+
+			trackingMemory_ = true;
+			trackingGeneration_ = Memory::DirtyTracking_Generation();
+			const u32 numPages = Memory::DirtyTracking_NumPages();
+			shadow_.resize((size_t)numPages * Memory::DIRTY_PAGE_SIZE);
+			WithUnpatchedMemory(false, [&] {
+				for (u32 page = 0; page < numPages; ++page) {
+					const u8 *src = Memory::GetPointerUnchecked(Memory::DirtyTracking_PageAddress(page));
+					memcpy(&shadow_[(size_t)page * Memory::DIRTY_PAGE_SIZE], src, Memory::DIRTY_PAGE_SIZE);
+				}
+			});
+			for (PageLog &log : pageLogs_)
+				log.Clear();
+		}
+
+		// shadow_ holds memory as of the last save or restore, and the latest state's log
+		// holds pages from when it was saved.  So a page written since the last sync, and not yet
+		// in the log, looked like the shadow copy when the latest state was saved.
+		void SyncMemory(PageLog *latest)
+		{
+			dirtyPages_.clear();
+			Memory::DirtyTracking_Collect(&dirtyPages_);
+
+			if (latest)
+				latest->Unpack();
+			const size_t pageSize = Memory::DIRTY_PAGE_SIZE;
+			for (u32 page : dirtyPages_) {
+				u8 *shadow = &shadow_[(size_t)page * pageSize];
+				if (latest)
+					latest->Add(page, shadow, Memory::DirtyTracking_NumPages());
+				memcpy(shadow, Memory::GetPointerUnchecked(Memory::DirtyTracking_PageAddress(page)), pageSize);
+			}
+		}
+
+		void RestoreMemory(PageLog &log)
+		{
+			// Catch the log up to now, then it has every page that differs from the state.
+			SyncMemory(&log);
+
+			const size_t pageSize = Memory::DIRTY_PAGE_SIZE;
+			for (size_t i = 0; i < log.pages.size(); ++i) {
+				const u32 page = log.pages[i];
+				const u8 *data = &log.data[i * pageSize];
+				// These writes get tracked as well, but that's harmless: the shadow already matches.
+				memcpy(Memory::GetPointerWriteUnchecked(Memory::DirtyTracking_PageAddress(page)), data, pageSize);
+				memcpy(&shadow_[(size_t)page * pageSize], data, pageSize);
+			}
+			DEBUG_LOG(Log::SaveState, "Rewind: Restored %d pages of memory", (int)log.pages.size());
+			log.Clear();
+		}
+
+		void ScheduleCompress(std::vector<u8> *result, const std::vector<u8> *state, const std::vector<u8> *base, PageLog *packLog)
 		{
 			if (compressThread_.joinable())
 				compressThread_.join();
 			compressThread_ = std::thread([=]{
 				SetCurrentThreadName("SaveStateCompress");
+				SetCurrentThreadCoreClass(ThreadCoreClass::EFFICIENCY);
 
 				// Should do no I/O, so no JNI thread context needed.
 				Compress(*result, *state, *base);
+				if (packLog) {
+					std::lock_guard<std::mutex> guard(lock_);
+					packLog->Pack(cctx_);
+				}
 			});
 		}
 
@@ -196,51 +407,87 @@ namespace SaveState
 				return;
 
 			double start_time = time_now_d();
-			result.clear();
-			result.reserve(512 * 1024);
+			std::vector<u8> &delta = deltaBuffer_;
+			delta.clear();
+			delta.reserve(512 * 1024);
 			for (size_t i = 0; i < state.size(); i += BLOCK_SIZE)
 			{
 				int blockSize = std::min(BLOCK_SIZE, (int)(state.size() - i));
-				if (i + blockSize > base.size() || memcmp(&state[i], &base[i], blockSize) != 0)
-				{
-					result.push_back(1);
-					result.insert(result.end(), state.begin() + i, state.begin() + i + blockSize);
+				size_t pos = delta.size();
+				if (i + blockSize > base.size()) {
+					delta.push_back(2);
+					delta.insert(delta.end(), state.begin() + i, state.begin() + i + blockSize);
+					continue;
+				}
+
+				// Xor straight into place, and take it back out if nothing changed.
+				delta.resize(pos + 1 + blockSize);
+				if (XorBlock(&state[i], &base[i], &delta[pos + 1], blockSize)) {
+					delta[pos] = 1;
+				} else {
+					delta.resize(pos + 1);
+					delta[pos] = 0;
 				}
-				else
-					result.push_back(0);
 			}
 
+			// Mostly zeros and small changes, which zstd handles very well at its fastest.
+			if (!cctx_)
+				cctx_ = ZSTD_createCCtx();
+			const size_t headerSize = sizeof(u32_le) * 2;
+			result.resize(headerSize + ZSTD_compressBound(delta.size()));
+			size_t packedSize = ZSTD_compressCCtx(cctx_, result.data() + headerSize, result.size() - headerSize, delta.data(), delta.size(), ZSTD_COMPRESSION_LEVEL);
+			if (ZSTD_isError(packedSize)) {
+				ERROR_LOG(Log::SaveState, "Rewind: Failed to compress save: %s", ZSTD_getErrorName(packedSize));
+				result.clear();
+				return;
+			}
+			u32_le sizes[2] = { (u32)state.size(), (u32)delta.size() };
+			memcpy(result.data(), sizes, headerSize);
+			result.resize(headerSize + packedSize);
+			result.shrink_to_fit();
+
 			double taken_s = time_now_d() - start_time;
-			DEBUG_LOG(Log::SaveState, "Rewind: Compressed save from %d bytes to %d in %0.2f ms.", (int)state.size(), (int)result.size(), taken_s * 1000.0);
+			DEBUG_LOG(Log::SaveState, "Rewind: Compressed save from %d bytes to %d (%d before zstd) in %0.2f ms.", (int)state.size(), (int)result.size(), (int)delta.size(), taken_s * 1000.0);
 		}
 
 		void LockedDecompress(std::vector<u8> &result, const std::vector<u8> &compressed, const std::vector<u8> &base)
 		{
 			result.clear();
-			result.reserve(base.size());
-			auto basePos = base.begin();
-			for (size_t i = 0; i < compressed.size(); )
+			const size_t headerSize = sizeof(u32_le) * 2;
+			if (compressed.size() < headerSize)
+				return;
+			u32_le sizes[2];
+			memcpy(sizes, compressed.data(), headerSize);
+
+			std::vector<u8> &delta = deltaBuffer_;
+			delta.resize(sizes[1]);
+			size_t deltaSize = ZSTD_decompress(delta.data(), delta.size(), compressed.data() + headerSize, compressed.size() - headerSize);
+			if (ZSTD_isError(deltaSize) || deltaSize != delta.size()) {
+				ERROR_LOG(Log::SaveState, "Rewind: Failed to decompress save");
+				return;
+			}
+
+			const size_t stateSize = sizes[0];
+			result.resize(stateSize);
+			size_t pos = 0;
+			for (size_t i = 0; i < delta.size() && pos < stateSize; )
 			{
-				if (compressed[i] == 0)
-				{
-					++i;
-					int blockSize = std::min(BLOCK_SIZE, (int)(base.size() - result.size()));
-					result.insert(result.end(), basePos, basePos + blockSize);
-					basePos += blockSize;
-				}
-				else
-				{
-					++i;
-					int blockSize = std::min(BLOCK_SIZE, (int)(compressed.size() - i));
-					result.insert(result.end(), compressed.begin() + i, compressed.begin() + i + blockSize);
+				const u8 type = delta[i++];
+				const size_t blockSize = std::min((size_t)BLOCK_SIZE, stateSize - pos);
+				if (type == 0) {
+					memcpy(&result[pos], &base[pos], blockSize);
+				} else if (i + blockSize <= delta.size()) {
+					if (type == 1)
+						XorBlock(&delta[i], &base[pos], &result[pos], blockSize);
+					else
+						memcpy(&result[pos], &delta[i], blockSize);
 					i += blockSize;
-					// This check is to avoid advancing basePos out of range, which MSVC catches.
-					// When this happens, we're at the end of decoding anyway.
-					if (base.end() - basePos >= blockSize) {
-						basePos += blockSize;
-					}
+				} else {
+					break;
 				}
+				pos += blockSize;
 			}
+			result.resize(pos);
 		}
 
 		void Clear()
@@ -260,6 +507,15 @@ namespace SaveState
 			for (auto &s : states_) {
 				s.clear();
 			}
+			for (PageLog &log : pageLogs_) {
+				log.Clear();
+			}
+			if (trackingMemory_) {
+				Memory::DirtyTracking_Stop(Memory::DIRTY_USER_REWIND);
+				trackingMemory_ = false;
+			}
+			shadow_.clear();
+			shadow_.shrink_to_fit();
 			buffer_.clear();
 			base_ = -1;
 			baseUsage_ = 0;
@@ -296,6 +552,7 @@ namespace SaveState
 
 	private:
 		const int BLOCK_SIZE = 8192;
+		static const int ZSTD_COMPRESSION_LEVEL = 1;
 		const int REWIND_NUM_STATES = 20;
 		// TODO: Instead, based on size of compressed state?
 		const int BASE_USAGE_INTERVAL = 15;
@@ -316,6 +573,16 @@ namespace SaveState
 		int base_ = -1;
 		int baseUsage_ = 0;
 
+		std::vector<PageLog> pageLogs_;
+		// Tracked memory as of the last save or restore.
+		std::vector<u8> shadow_;
+		std::vector<u32> dirtyPages_;
+		// Only used under lock_.
+		std::vector<u8> deltaBuffer_;
+		ZSTD_CCtx *cctx_ = nullptr;
+		bool trackingMemory_ = false;
+		int trackingGeneration_ = 0;
+
 		double rewindLastTime_ = 0.0f;
 	};
 
@@ -366,19 +633,21 @@ namespace SaveState
 			CoreTiming::DoState(p);
 		}
 
+		// Nothing may still be drawing into RAM while we copy it.
+		GeThread::Sync();
+		if (gpu)
+			gpu->FinishBackgroundDraws();
+
 		// Memory is a bit tricky when jit is enabled, since there's emuhacks in it.
 		// These must be saved before copying out memory and restored after.
 		auto savedReplacements = SaveAndClearReplacements();
 		if (MIPSComp::jit && p.mode == p.MODE_WRITE) {
-			std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
-			if (MIPSComp::jit) {
-				std::vector<u32> savedBlocks;
-				savedBlocks = MIPSComp::jit->SaveAndClearEmuHackOps();
-				Memory::DoState(p);
-				MIPSComp::jit->RestoreSavedEmuHackOps(savedBlocks);
-			} else {
-				Memory::DoState(p);
-			}
+			WithoutEmuHacks(false, [&] { Memory::DoState(p); });
+		} else if (MIPSComp::jit && p.mode == p.MODE_READ) {
+			// Keep the blocks whose code the state doesn't change, so loading doesn't stutter.
+			int kept = WithoutEmuHacks(true, [&] { Memory::DoState(p); });
+			currentMIPS->keepJitOnLoad = p.error != p.ERROR_FAILURE;
+			DEBUG_LOG(Log::SaveState, "Kept %d jit blocks", kept);
 		} else {
 			Memory::DoState(p);
 		}
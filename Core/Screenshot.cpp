@@ -18,6 +18,8 @@
 #include "ppsspp_config.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
 
 #include <png.h>
 #include "ext/jpge/jpge.h"
@@ -27,6 +29,7 @@
 #include "Common/File/Path.h"
 #include "Common/Log.h"
 #include "Common/System/Display.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/Screenshot.h"
 #include "Core/System.h"
 #include "GPU/Common/GPUDebugInterface.h"
@@ -66,15 +69,23 @@ class JPEGFileStream : public jpge::output_stream
 	FILE *fp_;
 };
 
-static bool WriteScreenshotToJPEG(const Path &filename, int width, int height, int num_channels, const uint8_t *image_data, const jpge::params &comp_params) {
-	JPEGFileStream dst_stream(filename);
-	if (!dst_stream.Valid()) {
-		ERROR_LOG(Log::IO, "Unable to open screenshot file for writing.");
-		return false;
+class JPEGMemoryStream : public jpge::output_stream {
+public:
+	JPEGMemoryStream(std::vector<uint8_t> &buffer) : buffer_(buffer) {}
+
+	bool put_buf(const void *buf, int len) override {
+		const uint8_t *data = (const uint8_t *)buf;
+		buffer_.insert(buffer_.end(), data, data + len);
+		return true;
 	}
 
+private:
+	std::vector<uint8_t> &buffer_;
+};
+
+static bool EncodeJPEG(jpge::output_stream *dst_stream, int width, int height, int num_channels, const uint8_t *image_data, const jpge::params &comp_params) {
 	jpge::jpeg_encoder dst_image;
-	if (!dst_image.init(&dst_stream, width, height, num_channels, comp_params)) {
+	if (!dst_image.init(dst_stream, width, height, num_channels, comp_params)) {
 		return false;
 	}
 
@@ -90,11 +101,24 @@ static bool WriteScreenshotToJPEG(const Path &filename, int width, int height, i
 		}
 	}
 
+	dst_image.deinit();
+	return true;
+}
+
+static bool WriteScreenshotToJPEG(const Path &filename, int width, int height, int num_channels, const uint8_t *image_data, const jpge::params &comp_params) {
+	JPEGFileStream dst_stream(filename);
 	if (!dst_stream.Valid()) {
-		ERROR_LOG(Log::System, "Screenshot file write failed.");
+		ERROR_LOG(Log::IO, "Unable to open screenshot file for writing.");
+		return false;
 	}
 
-	dst_image.deinit();
+	if (!EncodeJPEG(&dst_stream, width, height, num_channels, image_data, comp_params)) {
+		return false;
+	}
+
+	if (!dst_stream.Valid()) {
+		ERROR_LOG(Log::System, "Screenshot file write failed.");
+	}
 	return dst_stream.Valid();
 }
 
@@ -328,6 +352,53 @@ static GPUDebugBuffer ApplyRotation(const GPUDebugBuffer &buf, DisplayRotation r
 	return rotated;
 }
 
+static std::mutex pendingLock;
+static std::condition_variable pendingCond;
+static int pendingScreenshots = 0;
+
+// Conversion and encoding can take longer than a frame, so they're done here instead, after the readback.
+class ScreenshotSaveTask : public Task {
+public:
+	ScreenshotSaveTask(GPUDebugBuffer &&buf, const Path &filename, ScreenshotFormat fmt, u32 w, u32 h)
+		: buf_(std::move(buf)), filename_(filename), fmt_(fmt), w_(w), h_(h) {}
+
+	TaskType Type() const override { return TaskType::IO_BLOCKING; }
+	TaskPriority Priority() const override { return TaskPriority::NORMAL; }
+
+	void Run() override {
+		u8 *flipbuffer = nullptr;
+		const u8 *buffer = ConvertBufferToScreenshot(buf_, false, flipbuffer, w_, h_);
+		bool success = false;
+		if (buffer) {
+			// Encode first, so that the file is only briefly incomplete (thumbnails may be read any time.)
+			std::vector<uint8_t> encoded;
+			success = Save888RGBScreenshot(encoded, fmt_, buffer, w_, h_);
+			success = success && File::WriteDataToFile(false, encoded.data(), encoded.size(), filename_);
+		}
+		delete[] flipbuffer;
+
+		if (!success) {
+			ERROR_LOG(Log::IO, "Failed to write screenshot %s.", filename_.c_str());
+		}
+
+		std::lock_guard<std::mutex> guard(pendingLock);
+		pendingScreenshots--;
+		pendingCond.notify_all();
+	}
+
+private:
+	GPUDebugBuffer buf_;
+	Path filename_;
+	ScreenshotFormat fmt_;
+	u32 w_;
+	u32 h_;
+};
+
+void WaitForPendingScreenshots() {
+	std::unique_lock<std::mutex> guard(pendingLock);
+	pendingCond.wait(guard, [] { return pendingScreenshots == 0; });
+}
+
 bool TakeGameScreenshot(Draw::DrawContext *draw, const Path &filename, ScreenshotFormat fmt, ScreenshotType type, int *width, int *height, int maxRes) {
 	GPUDebugBuffer buf;
 	bool success = false;
@@ -359,26 +430,28 @@ bool TakeGameScreenshot(Draw::DrawContext *draw, const Path &filename, Screensho
 		return false;
 	}
 
-	if (success) {
-		u8 *flipbuffer = nullptr;
-		const u8 *buffer = ConvertBufferToScreenshot(buf, false, flipbuffer, w, h);
-		success = buffer != nullptr;
-		if (success) {
-			if (width)
-				*width = w;
-			if (height)
-				*height = h;
-
-			success = Save888RGBScreenshot(filename, fmt, buffer, w, h);
-		}
-		delete[] flipbuffer;
+	// Same clamping as ConvertBufferToScreenshot() will do.
+	w = std::min(w, buf.GetStride());
+	h = std::min(h, buf.GetHeight());
+	if (width)
+		*width = w;
+	if (height)
+		*height = h;
+
+	// When not read back, it points straight at PSP RAM, which won't wait for the encoder.
+	if (!buf.IsAllocated()) {
+		GPUDebugBuffer copy;
+		copy.Allocate(buf.GetStride(), buf.GetHeight(), buf.GetFormat(), buf.GetFlipped());
+		memcpy(copy.GetData(), buf.GetData(), buf.GetStride() * buf.GetHeight() * buf.PixelSize());
+		buf = std::move(copy);
 	}
 
-	if (!success) {
-		ERROR_LOG(Log::IO, "Failed to write screenshot.");
+	{
+		std::lock_guard<std::mutex> guard(pendingLock);
+		pendingScreenshots++;
 	}
-
-	return success;
+	g_threadManager.EnqueueTask(new ScreenshotSaveTask(std::move(buf), filename, fmt, w, h));
+	return true;
 }
 
 bool Save888RGBScreenshot(const Path &filename, ScreenshotFormat fmt, const u8 *bufferRGB888, int w, int h) {
@@ -406,6 +479,40 @@ bool Save888RGBScreenshot(const Path &filename, ScreenshotFormat fmt, const u8 *
 	}
 }
 
+bool Save888RGBScreenshot(std::vector<uint8_t> &bufferOut, ScreenshotFormat fmt, const u8 *bufferRGB888, int w, int h) {
+	bufferOut.clear();
+	if (fmt == ScreenshotFormat::PNG) {
+		png_image png{};
+		png.version = PNG_IMAGE_VERSION;
+		png.format = PNG_FORMAT_RGB;
+		png.width = w;
+		png.height = h;
+
+		png_alloc_size_t allocSize = 0;
+		bool success = png_image_write_to_memory(&png, nullptr, &allocSize, 0, bufferRGB888, w * 3, nullptr) != 0;
+		if (success) {
+			bufferOut.resize(allocSize);
+			success = png_image_write_to_memory(&png, bufferOut.data(), &allocSize, 0, bufferRGB888, w * 3, nullptr) != 0 && png.warning_or_error <= 1;
+		}
+		png_image_free(&png);
+
+		if (!success) {
+			ERROR_LOG(Log::IO, "Saving screenshot to PNG produced errors.");
+			bufferOut.clear();
+			return false;
+		}
+		bufferOut.resize(allocSize);
+		return true;
+	} else if (fmt == ScreenshotFormat::JPG) {
+		jpge::params params;
+		params.m_quality = 90;
+		JPEGMemoryStream stream(bufferOut);
+		return EncodeJPEG(&stream, w, h, 3, bufferRGB888, params);
+	} else {
+		return false;
+	}
+}
+
 bool Save8888RGBAScreenshot(const Path &filename, const u8 *buffer, int w, int h) {
 	png_image png{};
 	png.version = PNG_IMAGE_VERSION;
@@ -40,10 +40,13 @@ enum ScreenshotType {
 
 const u8 *ConvertBufferToScreenshot(const GPUDebugBuffer &buf, bool alpha, u8 *&temp, u32 &w, u32 &h);
 
-// Can only be used while in game.
+// Can only be used while in game.  Only the readback is done right away, the file is written in the
+// background, so use WaitForPendingScreenshots() before reading it.  Encoding failures are only logged.
 bool TakeGameScreenshot(Draw::DrawContext *draw, const Path &filename, ScreenshotFormat fmt, ScreenshotType type, int *width = nullptr, int *height = nullptr, int maxRes = -1);
+void WaitForPendingScreenshots();
 
 bool Save888RGBScreenshot(const Path &filename, ScreenshotFormat fmt, const u8 *bufferRGB888, int w, int h);
+bool Save888RGBScreenshot(std::vector<uint8_t> &bufferOut, ScreenshotFormat fmt, const u8 *bufferRGB888, int w, int h);
 bool Save8888RGBAScreenshot(const Path &filename, const u8 *bufferRGBA8888, int w, int h);
 // Overallocate bufferPNG for better encoding speed.
 bool Save8888RGBAScreenshot(std::vector<uint8_t> &bufferPNG, const u8 *bufferRGBA8888, int w, int h);
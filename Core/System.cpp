@@ -36,15 +36,18 @@
 #include "Common/File/Path.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/TimeUtil.h"
 #include "Common/GraphicsContext.h"
 
 #include "Core/RetroAchievements.h"
+#include "Core/MemDirtyTracker.h"
 #include "Core/MemFault.h"
 #include "Core/HDRemaster.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
+#include "Core/Debugger/Breakpoints.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/System.h"
 #include "Core/HLE/HLE.h"
@@ -60,9 +63,13 @@
 #include "Core/Loaders.h"
 #include "Core/PSPLoaders.h"
 #include "Core/ELF/ParamSFO.h"
+#include "Core/Replay.h"
 #include "Core/SaveState.h"
 #include "Common/ExceptionHandlerSetup.h"
+#include "GPU/GeThread.h"
 #include "GPU/GPUCommon.h"
+#include "GPU/GPUState.h"
+#include "GPU/Debugger/Record.h"
 #include "GPU/Debugger/RecordFormat.h"
 #include "Core/RetroAchievements.h"
 
@@ -92,6 +99,7 @@ static volatile bool pspIsInited = false;
 static volatile bool pspIsIniting = false;
 static volatile bool pspIsQuitting = false;
 static volatile bool pspIsRebooting = false;
+static double bootStartTime;
 
 void ResetUIState() {
 	globalUIState = UISTATE_MENU;
@@ -208,6 +216,7 @@ bool DiscIDFromGEDumpPath(const Path &path, FileLoader *fileLoader, std::string
 }
 
 bool CPU_Init(std::string *errorString, FileLoader *loadedFile) {
+	TRACE_SCOPE("boot_cpu_init");
 	coreState = CORE_POWERUP;
 	currentMIPS = &mipsr4k;
 
@@ -232,6 +241,8 @@ bool CPU_Init(std::string *errorString, FileLoader *loadedFile) {
 	g_CoreParameter.fileType = type;
 
 	MIPSAnalyst::Reset();
+	// Read while the disc is mounted and the HLE is set up, it's needed once the executable is scanned.
+	MIPSAnalyst::PreloadHashMap();
 	Replacement_Init();
 
 	bool allowPlugins = true;
@@ -290,7 +301,10 @@ bool CPU_Init(std::string *errorString, FileLoader *loadedFile) {
 	CoreTiming::Init();
 
 	// Init all the HLE modules
-	HLEInit();
+	{
+		TRACE_SCOPE("boot_hle_init");
+		HLEInit();
+	}
 
 	// TODO: Check Game INI here for settings, patches and cheats, and modify coreParameter accordingly
 
@@ -320,6 +334,8 @@ PSP_LoadingLock::~PSP_LoadingLock() {
 }
 
 void CPU_Shutdown() {
+	// Protected pages would crash without the handler, and the shutdown below still writes memory.
+	Memory::DirtyTracking_StopAll();
 	UninstallExceptionHandler();
 
 	// Since we load on a background thread, wait for startup to complete.
@@ -404,6 +420,7 @@ bool PSP_InitStart(const CoreParameter &coreParam, std::string *error_string) {
 	}
 	g_CoreParameter.errorString.clear();
 	pspIsIniting = true;
+	bootStartTime = time_now_d();
 
 	Path filename = g_CoreParameter.fileToStart;
 	FileLoader *loadedFile = ResolveFileLoaderTarget(ConstructFileLoader(filename));
@@ -478,6 +495,8 @@ bool PSP_InitUpdate(std::string *error_string) {
 	pspIsInited = GPU_IsReady();
 	pspIsIniting = !pspIsInited;
 	if (pspIsInited) {
+		Tracer::Instant("boot_complete");
+		INFO_LOG(Log::Boot, "Boot took %0.1f ms", (time_now_d() - bootStartTime) * 1000.0);
 		Core_NotifyLifecycle(CoreLifecycle::START_COMPLETE);
 		pspIsRebooting = false;
 
@@ -580,6 +599,7 @@ void PSP_EndHostFrame() {
 }
 
 void PSP_RunLoopWhileState() {
+	TRACE_SCOPE("emu_frame");
 	// We just run the CPU until we get to vblank. This will quickly sync up pretty nicely.
 	// The actual number of cycles doesn't matter so much here as we will break due to CORE_NEXTFRAME, most of the time hopefully...
 	int blockTicks = usToCycles(1000000 / 10);
@@ -588,8 +608,100 @@ void PSP_RunLoopWhileState() {
 	// TODO: Check for frame timeout?
 }
 
+static bool RunAheadAllowed() {
+	// Ad hoc networking runs in real time, and debugging would see the rolled back frames.
+	if (g_Config.iRunAheadFrames <= 0 || g_Config.bEnableWlan || PSP_CoreParameter().frozen)
+		return false;
+	// Replays would record or consume the input of the rolled back frames.
+	if (ReplayIsExecuting() || ReplayIsSaving())
+		return false;
+	if (Achievements::HardcoreModeActive() || g_breakpoints.HasBreakPoints() || g_breakpoints.HasMemChecks())
+		return false;
+	return coreState == CORE_RUNNING_CPU && gpuDebug && !gpuDebug->GetRecorder()->IsActivePending();
+}
+
+// Returns false if the frame didn't finish, i.e. it hit a break or ran long.
+static bool RunAheadFrame(bool showVideo, bool playAudio) {
+	PSP_CoreParameter().runAheadHideVideo = !showVideo;
+	PSP_CoreParameter().runAheadMuteAudio = !playAudio;
+	if (showVideo)
+		gstate_c.skipDrawReason &= ~SKIPDRAW_SKIPFRAME;
+	else
+		gstate_c.skipDrawReason |= SKIPDRAW_SKIPFRAME;
+
+	PSP_RunLoopWhileState();
+
+	PSP_CoreParameter().runAheadHideVideo = false;
+	PSP_CoreParameter().runAheadMuteAudio = false;
+	return coreState == CORE_NEXTFRAME;
+}
+
+// Runs hidden frames toward a replay seek, unthrottled, for a little while at a time to keep the UI responsive.
+static void RunReplaySeek() {
+	const double endTime = time_now_d() + 0.1;
+	while (RunAheadFrame(false, false)) {
+		coreState = CORE_RUNNING_CPU;
+		ReplayBeginFrame();
+		if (!ReplayIsSeeking() || coreState != CORE_RUNNING_CPU || time_now_d() >= endTime) {
+			if (coreState == CORE_RUNNING_CPU)
+				coreState = CORE_NEXTFRAME;
+			break;
+		}
+	}
+	// The frame after the seek should be drawn.
+	gstate_c.skipDrawReason &= ~SKIPDRAW_SKIPFRAME;
+}
+
+void PSP_RunLoopWithRunAhead() {
+	static std::vector<u8> runAheadState;
+	ReplayBeginFrame();
+	if (ReplayIsSeeking()) {
+		RunReplaySeek();
+		return;
+	}
+	if (!RunAheadAllowed()) {
+		runAheadState.clear();
+		PSP_RunLoopWhileState();
+		return;
+	}
+
+	// The real frame, which is heard but not seen.
+	if (!RunAheadFrame(false, true))
+		return;
+	coreState = CORE_RUNNING_CPU;
+	if (SaveState::SaveToRam(runAheadState) != CChunkFileReader::ERROR_NONE) {
+		coreState = CORE_NEXTFRAME;
+		return;
+	}
+
+	const int frames = g_Config.iRunAheadFrames;
+	for (int i = 1; i <= frames; ++i) {
+		if (!RunAheadFrame(i == frames, false))
+			break;
+		if (i != frames)
+			coreState = CORE_RUNNING_CPU;
+	}
+
+	// Like freeze-frame, this keeps the GPU's framebuffers, so what was just drawn can be shown.
+	std::string errorString;
+	const CoreState ranAheadState = coreState;
+	PSP_CoreParameter().frozen = true;
+	CChunkFileReader::Error error = SaveState::LoadFromRam(runAheadState, &errorString);
+	PSP_CoreParameter().frozen = false;
+	if (error != CChunkFileReader::ERROR_NONE) {
+		ERROR_LOG(Log::SaveState, "Run-ahead failed to roll back (%s), turning it off", errorString.c_str());
+		g_Config.iRunAheadFrames = 0;
+	}
+	// Whatever stopped the frames ahead, like an exception, will simply happen again for real.
+	if (ranAheadState != CORE_POWERDOWN && ranAheadState != CORE_BOOT_ERROR)
+		coreState = CORE_NEXTFRAME;
+}
+
 void PSP_RunLoopFor(int cycles) {
 	Core_RunLoopUntil(CoreTiming::GetTicks() + cycles);
+	// Presenting, savestates and the UI all expect the GE to be done.
+	GeThread::Sync();
+	GeThread::Update();
 }
 
 Path GetSysDirectory(PSPDirectories directoryType) {
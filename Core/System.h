@@ -84,6 +84,10 @@ void PSP_BeginHostFrame();
 void PSP_EndHostFrame();
 void PSP_RunLoopWhileState();
 void PSP_RunLoopFor(int cycles);
+// Same as PSP_RunLoopWhileState(), but emulates g_Config.iRunAheadFrames more frames with the same
+// input and shows the last, then rolls back.  Falls back to a plain frame if it can't.
+// Also records replay keyframes, and runs hidden frames while a replay is seeking.
+void PSP_RunLoopWithRunAhead();
 
 // Used to wait for background loading thread.
 struct PSP_LoadingLock {
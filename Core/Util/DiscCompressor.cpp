@@ -0,0 +1,180 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <zstd.h>
+#include <zdict.h>
+
+#include "Common/File/FileUtil.h"
+#include "Common/Log.h"
+#include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Core/FileSystems/BlockDevices.h"
+#include "Core/Util/DiscCompressor.h"
+
+// Frames compressed at once.  Enough to keep every core busy without holding much of the disc.
+static const u32 FRAMES_PER_BATCH = 256;
+// Dictionaries train well on about a hundred times their size in samples.
+static const u32 DICT_SAMPLE_FACTOR = 100;
+
+static bool ReadFrames(BlockDevice *source, u32 firstFrame, u32 frames, u32 frameSize, u8 *dest) {
+	const u32 blocksPerFrame = frameSize / source->GetBlockSize();
+	const u32 firstBlock = firstFrame * blocksPerFrame;
+	const u32 numBlocks = source->GetNumBlocks();
+	if (firstBlock >= numBlocks)
+		return false;
+	const u32 count = std::min(frames * blocksPerFrame, numBlocks - firstBlock);
+	memset(dest, 0, (size_t)frames * frameSize);
+	return source->ReadBlocks(firstBlock, count, dest);
+}
+
+static std::vector<u8> TrainDictionary(BlockDevice *source, u32 numFrames, const SZSTCompressOptions &options) {
+	// Take frames spread over the whole disc, since files of the same kind tend to be together.
+	const u32 wantFrames = std::min(numFrames, (u32)((u64)options.maxDictSize * DICT_SAMPLE_FACTOR / options.frameSize));
+	if (wantFrames < 8)
+		return std::vector<u8>();
+	const u32 step = numFrames / wantFrames;
+
+	std::vector<u8> samples((size_t)wantFrames * options.frameSize);
+	std::vector<size_t> sampleSizes;
+	for (u32 i = 0; i < wantFrames; ++i) {
+		if (!ReadFrames(source, i * step, 1, options.frameSize, &samples[(size_t)i * options.frameSize]))
+			break;
+		sampleSizes.push_back(options.frameSize);
+	}
+
+	std::vector<u8> dict(options.maxDictSize);
+	size_t dictSize = ZDICT_trainFromBuffer(&dict[0], dict.size(), &samples[0], &sampleSizes[0], (unsigned)sampleSizes.size());
+	if (ZDICT_isError(dictSize)) {
+		// Usually just means the disc is mostly incompressible, which is fine.
+		WARN_LOG(Log::Loader, "SZST: No dictionary: %s", ZDICT_getErrorName(dictSize));
+		return std::vector<u8>();
+	}
+	dict.resize(dictSize);
+	return dict;
+}
+
+bool CompressDiscToSZST(BlockDevice *source, const Path &dest, const SZSTCompressOptions &options, std::string *error, const std::function<void(float)> &progress) {
+	const u32 frameSize = options.frameSize;
+	if ((frameSize & (frameSize - 1)) != 0 || frameSize < (u32)source->GetBlockSize()) {
+		*error = StringFromFormat("Frame size %d must be a power of two, and at least one sector", frameSize);
+		return false;
+	}
+
+	const u64 totalBytes = (u64)source->GetNumBlocks() * source->GetBlockSize();
+	const u32 numFrames = (u32)((totalBytes + frameSize - 1) / frameSize);
+	if (numFrames == 0) {
+		*error = "Empty disc image";
+		return false;
+	}
+
+	std::vector<u8> dict;
+	if (options.trainDictionary)
+		dict = TrainDictionary(source, numFrames, options);
+
+	File::IOFile out(dest, "wb");
+	if (!out.IsOpen()) {
+		*error = "Could not create " + dest.ToVisualString();
+		return false;
+	}
+
+	SZSTHeader hdr{};
+	memcpy(hdr.magic, "SZST", 4);
+	hdr.headerSize = sizeof(hdr);
+	hdr.totalBytes = totalBytes;
+	hdr.frameSize = frameSize;
+	hdr.dictSize = (u32)dict.size();
+	hdr.version = SZST_VERSION;
+
+	// The index gets rewritten at the end, once we know where everything went.
+	std::vector<u64_le> index(numFrames + 1);
+	out.WriteBytes(&hdr, sizeof(hdr));
+	out.WriteArray(&index[0], index.size());
+	if (!dict.empty())
+		out.WriteBytes(&dict[0], dict.size());
+	u64 pos = sizeof(hdr) + index.size() * sizeof(u64_le) + dict.size();
+
+	ZSTD_CDict *cdict = dict.empty() ? nullptr : ZSTD_createCDict(&dict[0], dict.size(), options.level);
+	const size_t bound = ZSTD_compressBound(frameSize);
+
+	std::vector<u8> raw((size_t)FRAMES_PER_BATCH * frameSize);
+	std::vector<u8> compressed(FRAMES_PER_BATCH * bound);
+	std::vector<size_t> compressedSizes(FRAMES_PER_BATCH);
+
+	bool success = true;
+	for (u32 first = 0; first < numFrames && success; first += FRAMES_PER_BATCH) {
+		const u32 frames = std::min(FRAMES_PER_BATCH, numFrames - first);
+		if (!ReadFrames(source, first, frames, frameSize, &raw[0])) {
+			*error = StringFromFormat("Could not read frames %d-%d", first, first + frames - 1);
+			success = false;
+			break;
+		}
+
+		ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+			ZSTD_CCtx *ctx = ZSTD_createCCtx();
+			for (int i = lower; i < upper; ++i) {
+				const u64 frameStart = (u64)(first + i) * frameSize;
+				const size_t srcSize = (size_t)std::min((u64)frameSize, totalBytes - frameStart);
+				const u8 *src = &raw[(size_t)i * frameSize];
+				u8 *dst = &compressed[(size_t)i * bound];
+				if (cdict)
+					compressedSizes[i] = ZSTD_compress_usingCDict(ctx, dst, bound, src, srcSize, cdict);
+				else
+					compressedSizes[i] = ZSTD_compressCCtx(ctx, dst, bound, src, srcSize, options.level);
+			}
+			ZSTD_freeCCtx(ctx);
+		}, 0, (int)frames, 4);
+
+		for (u32 i = 0; i < frames; ++i) {
+			const u64 frameStart = (u64)(first + i) * frameSize;
+			const size_t srcSize = (size_t)std::min((u64)frameSize, totalBytes - frameStart);
+			index[first + i] = pos;
+			// Not worth decompressing if it doesn't get smaller.
+			if (ZSTD_isError(compressedSizes[i]) || compressedSizes[i] >= srcSize) {
+				index[first + i] = pos | SZST_INDEX_PLAIN;
+				success = out.WriteBytes(&raw[(size_t)i * frameSize], srcSize);
+				pos += srcSize;
+			} else {
+				success = out.WriteBytes(&compressed[(size_t)i * bound], compressedSizes[i]);
+				pos += compressedSizes[i];
+			}
+			if (!success)
+				break;
+		}
+
+		if (progress)
+			progress((float)(first + frames) / (float)numFrames);
+	}
+	index[numFrames] = pos;
+	ZSTD_freeCDict(cdict);
+
+	if (success)
+		success = out.Seek(sizeof(hdr), SEEK_SET) && out.WriteArray(&index[0], index.size());
+	if (!success && error->empty())
+		*error = "Could not write " + dest.ToVisualString();
+	out.Close();
+
+	if (!success) {
+		File::Delete(dest);
+		return false;
+	}
+	INFO_LOG(Log::Loader, "SZST: Wrote %s, %lld bytes from %lld (dictionary: %d bytes)", dest.c_str(), pos, totalBytes, (int)dict.size());
+	return true;
+}
@@ -0,0 +1,39 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/File/Path.h"
+
+class BlockDevice;
+
+struct SZSTCompressOptions {
+	// Larger frames compress better, smaller ones waste less work on scattered reads.
+	u32 frameSize = 16 * 1024;
+	int level = 19;
+	// Trains a dictionary on samples of the disc itself, which makes up for most of the small frames.
+	bool trainDictionary = true;
+	u32 maxDictSize = 112 * 1024;
+};
+
+// Writes any readable disc image (ISO, CSO, CHD...) out as a seekable zstd image, see SZSTHeader.
+// Progress, if set, gets called with 0.0 to 1.0 from the calling thread.
+bool CompressDiscToSZST(BlockDevice *source, const Path &dest, const SZSTCompressOptions &options, std::string *error, const std::function<void(float)> &progress = nullptr);
@@ -39,6 +39,7 @@
 #include "Common/System/OSD.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Core/Config.h"
 #include "Core/Loaders.h"
@@ -447,7 +448,7 @@ void GameManager::InstallZipContents(ZipFileTask task) {
 		Path pspGame = GetSysDirectory(DIRECTORY_GAME);
 		INFO_LOG(Log::HLE, "Installing '%s' into '%s'", task.fileName.c_str(), pspGame.c_str());
 		// InstallZipContents contains code to close z.
-		success = ExtractZipContents(z, pspGame, zipInfo, false);
+		success = ExtractZipContents(z, task.fileName, pspGame, zipInfo, false);
 		break;
 	}
 	case ZipFileContents::ISO_FILE:
@@ -470,7 +471,7 @@ void GameManager::InstallZipContents(ZipFileTask task) {
 			} else {
 				// TODO: Can probably remove this, as we now put .nomedia in /TEXTURES directly.
 				File::CreateEmptyFile(dest / ".nomedia");
-				success = ExtractZipContents(z, dest, zipInfo, true);
+				success = ExtractZipContents(z, task.fileName, dest, zipInfo, true);
 			}
 		} else {
 			zip_close(z);
@@ -481,7 +482,7 @@ void GameManager::InstallZipContents(ZipFileTask task) {
 	case ZipFileContents::SAVE_DATA:
 	{
 		Path pspSaveData = GetSysDirectory(DIRECTORY_SAVEDATA);
-		success = ExtractZipContents(z, pspSaveData, zipInfo, false);
+		success = ExtractZipContents(z, task.fileName, pspSaveData, zipInfo, false);
 		break;
 	}
 	default:
@@ -653,7 +654,7 @@ bool ZipExtractFileToMemory(struct zip *z, int fileIndex, std::string *data) {
 	}
 }
 
-bool GameManager::ExtractFile(struct zip *z, int file_index, const Path &outFilename, size_t *bytesCopied, size_t allBytes) {
+bool GameManager::ExtractFile(struct zip *z, int file_index, const Path &outFilename, std::atomic<size_t> *bytesCopied, size_t allBytes) {
 	struct zip_stat zstat;
 	zip_stat_index(z, file_index, 0, &zstat);
 	size_t size = zstat.size;
@@ -694,8 +695,8 @@ bool GameManager::ExtractFile(struct zip *z, int file_index, const Path &outFile
 			}
 			pos += readSize;
 
-			*bytesCopied += readSize;
-			installProgress_ = (float)*bytesCopied / (float)allBytes;
+			size_t copied = bytesCopied->fetch_add(readSize) + readSize;
+			installProgress_ = (float)copied / (float)allBytes;
 		}
 
 		zip_fclose(zf);
@@ -716,9 +717,9 @@ bool GameManager::ExtractFile(struct zip *z, int file_index, const Path &outFile
 }
 
 // Doesn't care what it is, just extracts the whole ZIP to the requested location.
-bool GameManager::ExtractZipContents(struct zip *z, const Path &dest, const ZipFileInfo &info, bool allowRoot) {
+bool GameManager::ExtractZipContents(struct zip *z, const Path &zipFile, const Path &dest, const ZipFileInfo &info, bool allowRoot) {
 	size_t allBytes = 0;
-	size_t bytesCopied = 0;
+	std::atomic<size_t> bytesCopied{};
 
 	auto sy = GetI18NCategory(I18NCat::SYSTEM);
 
@@ -773,8 +774,12 @@ bool GameManager::ExtractZipContents(struct zip *z, const Path &dest, const ZipF
 
 	INFO_LOG(Log::HLE, "Created %d directories", (int)createdDirs.size());
 
-	// Now, loop through again in a second pass, writing files.
-	std::vector<Path> createdFiles;
+	// Now, loop through again in a second pass, collecting the files to write.
+	struct FileToExtract {
+		int index;
+		Path outFilename;
+	};
+	std::vector<FileToExtract> files;
 	for (int i = 0; i < info.numFiles; i++) {
 		const char *fn = zip_get_name(z, i, 0);
 		// Note that we do NOT write files that are not in a directory, to avoid random
@@ -782,22 +787,55 @@ bool GameManager::ExtractZipContents(struct zip *z, const Path &dest, const ZipF
 		if (fileAllowed(fn) && strlen(fn) > (size_t)info.stripChars) {
 			std::string zippedName = fn;
 			fn += info.stripChars;
-			Path outFilename = dest / fn;
 			bool isDir = zippedName.empty() || zippedName.back() == '/';
 			if (isDir)
 				continue;
+			files.push_back(FileToExtract{ i, dest / fn });
+		}
+	}
 
-			if (!ExtractFile(z, i, outFilename, &bytesCopied, allBytes)) {
-				ERROR_LOG(Log::HLE, "Bailing: Failed to extract file: %s -> %s", zippedName.c_str(), outFilename.c_str());
-				goto bail;
-			} else {
-				createdFiles.push_back(outFilename);
+	// The zip handle can't be shared between threads, so each extra worker opens its own.
+	// Workers pull files off a shared counter so a few huge files don't leave the others idle.
+	const int numWorkers = std::min(std::min(g_threadManager.GetNumLooperThreads(), 4), (int)files.size() / 8 + 1);
+	std::vector<uint8_t> extracted(files.size());
+	std::atomic<int> nextFile{};
+	std::atomic<int> filesDone{};
+	std::atomic<bool> failed{};
+	auto extractWorker = [&](int lower, int upper) {
+		for (int w = lower; w < upper; w++) {
+			struct zip *wz = w == 0 ? z : ZipOpenPath(zipFile);
+			if (!wz) {
+				failed = true;
+				return;
+			}
+			int f;
+			while (!failed && (f = nextFile++) < (int)files.size()) {
+				const FileToExtract &file = files[f];
+				if (!ExtractFile(wz, file.index, file.outFilename, &bytesCopied, allBytes)) {
+					ERROR_LOG(Log::HLE, "Bailing: Failed to extract file: %s", file.outFilename.c_str());
+					failed = true;
+					break;
+				}
+				extracted[f] = 1;
+				int done = ++filesDone;
+				g_OSD.SetProgressBar("install", di->T("Installing..."), 0.0f, 1.0f, 0.1f + done / (float)files.size() * 0.9f, 0.1f);
+			}
+			if (wz != z) {
+				zip_close(wz);
 			}
 		}
-		g_OSD.SetProgressBar("install", di->T("Installing..."), 0.0f, 1.0f, 0.1f + (i + 1) / (float)info.numFiles * 0.9f, 0.1f);
+	};
+	if (numWorkers <= 1) {
+		extractWorker(0, 1);
+	} else {
+		ParallelRangeLoop(&g_threadManager, extractWorker, 0, numWorkers, 1);
 	}
 
-	INFO_LOG(Log::HLE, "Unzipped %d files (%d bytes / %d).", info.numFiles, (int)bytesCopied, (int)allBytes);
+	if (failed) {
+		goto bail;
+	}
+
+	INFO_LOG(Log::HLE, "Unzipped %d files (%d bytes / %d) with %d workers.", (int)files.size(), (int)bytesCopied, (int)allBytes, numWorkers);
 	zip_close(z);
 	z = nullptr;
 	return true;
@@ -806,8 +844,9 @@ bool GameManager::ExtractZipContents(struct zip *z, const Path &dest, const ZipF
 	// We end up here if disk is full or couldn't write to storage for some other reason.
 	zip_close(z);
 	// We don't delete the original in this case. Try to delete the files we created so far.
-	for (size_t i = 0; i < createdFiles.size(); i++) {
-		File::Delete(createdFiles[i]);
+	for (size_t i = 0; i < files.size(); i++) {
+		if (extracted[i])
+			File::Delete(files[i].outFilename);
 	}
 	for (auto const &iter : createdDirs) {
 		File::DeleteDir(iter);
@@ -902,7 +941,7 @@ bool GameManager::InstallZippedISO(struct zip *z, int isoFileIndex, const Path &
 	}
 	outputISOFilename = outputISOFilename / name;
 
-	size_t bytesCopied = 0;
+	std::atomic<size_t> bytesCopied{};
 	bool success = false;
 	auto di = GetI18NCategory(I18NCat::DIALOG);
 	g_OSD.SetProgressBar("install", di->T("Installing..."), 0.0f, 0.0f, 0.0f, 0.1f);
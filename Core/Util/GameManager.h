@@ -116,14 +116,14 @@ class GameManager {
 private:
 	void InstallZipContents(ZipFileTask task);
 
-	bool ExtractZipContents(struct zip *z, const Path &dest, const ZipFileInfo &info, bool allowRoot);
+	bool ExtractZipContents(struct zip *z, const Path &zipFile, const Path &dest, const ZipFileInfo &info, bool allowRoot);
 	bool InstallMemstickZip(struct zip *z, const Path &zipFile, const Path &dest, const ZipFileInfo &info);
 	bool InstallZippedISO(struct zip *z, int isoFileIndex, const Path &destDir);
 	void UninstallGame(const std::string &name);
 
 	void InstallDone();
 
-	bool ExtractFile(struct zip *z, int file_index, const Path &outFilename, size_t *bytesCopied, size_t allBytes);
+	bool ExtractFile(struct zip *z, int file_index, const Path &outFilename, std::atomic<size_t> *bytesCopied, size_t allBytes);
 	bool DetectTexturePackDest(struct zip *z, int iniIndex, Path &dest);
 	void SetInstallError(std::string_view err);
 
@@ -1,4 +1,8 @@
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <set>
 #include <vector>
 
 #include "Common/File/Path.h"
@@ -6,6 +10,7 @@
 #include "Common/File/DirListing.h"
 #include "Common/Log.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/Data/Text/I18n.h"
 #include "Common/Data/Text/Parsers.h"
 
@@ -72,6 +77,132 @@ struct FileSuffix {
 	u64 fileSize;
 };
 
+// Lists the files already copied to the destination, so an interrupted move can continue.
+// The first line is the source, so a journal from a different move is ignored.
+static const char *const MOVE_JOURNAL_FILENAME = ".ppsspp_move_journal";
+// The journal is rewritten after this many files. Content URIs can't be appended to.
+static const int MOVE_JOURNAL_BATCH = 32;
+// Files copied at once, including the calling thread. Mostly hides the per-file overhead of Android storage.
+static const int MOVE_COPY_THREADS = 4;
+
+static std::set<std::string> LoadMoveJournal(const Path &journalPath, const Path &moveSrc) {
+	std::set<std::string> copied;
+	std::string data;
+	if (!File::Exists(journalPath) || !File::ReadTextFileToString(journalPath, &data))
+		return copied;
+
+	std::vector<std::string> lines;
+	SplitString(data, '\n', lines);
+	if (lines.empty() || lines[0] != moveSrc.ToString()) {
+		INFO_LOG(Log::System, "Ignoring move journal from a different source");
+		return copied;
+	}
+	for (size_t i = 1; i < lines.size(); i++) {
+		if (!lines[i].empty())
+			copied.insert(lines[i]);
+	}
+	return copied;
+}
+
+namespace {
+
+// Shared between the thread running the move and the extra copy tasks.
+struct MoveCopyState {
+	Path moveSrc;
+	Path moveDest;
+	Path journalPath;
+	std::vector<const FileSuffix *> files;
+	MoveProgressReporter *progressReporter = nullptr;
+	bool dryRun = false;
+
+	std::atomic<size_t> next{};
+	std::atomic<size_t> finished{};
+	std::atomic<size_t> failed{};
+
+	std::mutex journalLock;
+	std::string journal;
+	int unsavedJournalEntries = 0;
+
+	std::mutex doneLock;
+	std::condition_variable doneCond;
+	int runningTasks = 0;
+
+	void CopyFiles();
+	void MarkCopied(const std::string &suffix);
+	void SaveJournal();
+};
+
+void MoveCopyState::CopyFiles() {
+	size_t i;
+	while ((i = next++) < files.size()) {
+		const FileSuffix &fileSuffix = *files[i];
+		progressReporter->SetProgress(StringFromFormat("%s (%s)", fileSuffix.suffix.c_str(), NiceSizeFormat(fileSuffix.fileSize).c_str()),
+			finished, files.size());
+
+		Path from = moveSrc / fileSuffix.suffix;
+		Path to = moveDest / fileSuffix.suffix;
+
+		if (dryRun) {
+			INFO_LOG(Log::System, "dry run: Would have moved '%s' to '%s' (%d bytes)", from.c_str(), to.c_str(), (int)fileSuffix.fileSize);
+		} else {
+			if (File::Exists(to)) {
+				WARN_LOG(Log::System, "Target file '%s' already exists. Will be overwritten", to.c_str());
+			}
+
+			if (!File::Copy(from, to)) {
+				ERROR_LOG(Log::System, "Failed to copy file '%s' to '%s'", from.c_str(), to.c_str());
+				failed++;
+			} else {
+				INFO_LOG(Log::System, "Copied file '%s' to '%s' (size: %d)", from.c_str(), to.c_str(), (int)fileSuffix.fileSize);
+				MarkCopied(fileSuffix.suffix);
+			}
+		}
+		finished++;
+	}
+}
+
+void MoveCopyState::MarkCopied(const std::string &suffix) {
+	std::lock_guard<std::mutex> guard(journalLock);
+	journal += suffix;
+	journal += '\n';
+	if (++unsavedJournalEntries >= MOVE_JOURNAL_BATCH) {
+		File::WriteStringToFile(true, journal, journalPath);
+		unsavedJournalEntries = 0;
+	}
+}
+
+void MoveCopyState::SaveJournal() {
+	std::lock_guard<std::mutex> guard(journalLock);
+	if (unsavedJournalEntries != 0) {
+		File::WriteStringToFile(true, journal, journalPath);
+		unsavedJournalEntries = 0;
+	}
+}
+
+class MoveCopyTask : public Task {
+public:
+	MoveCopyTask(std::shared_ptr<MoveCopyState> state) : state_(std::move(state)) {}
+
+	// Android storage needs the thread attached to JNI.
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+	TaskPriority Priority() const override {
+		return TaskPriority::NORMAL;
+	}
+	void Run() override {
+		state_->CopyFiles();
+		std::lock_guard<std::mutex> guard(state_->doneLock);
+		state_->runningTasks--;
+		state_->doneCond.notify_all();
+	}
+
+private:
+	std::shared_ptr<MoveCopyState> state_;
+};
+
+}  // namespace
+
 static bool ListFileSuffixesRecursively(const Path &root, const Path &folder, std::vector<std::string> &dirSuffixes, std::vector<FileSuffix> &fileSuffixes, MoveProgressReporter &progressReporter) {
 	std::vector<File::FileInfo> files;
 	if (!File::GetFilesInDir(folder, &files)) {
@@ -79,6 +210,9 @@ static bool ListFileSuffixesRecursively(const Path &root, const Path &folder, st
 	}
 
 	for (auto &file : files) {
+		if (file.name == MOVE_JOURNAL_FILENAME) {
+			continue;
+		}
 		if (file.isDirectory) {
 			std::string dirSuffix;
 			if (root.ComputePathTo(file.fullName, dirSuffix)) {
@@ -208,32 +342,48 @@ MoveResult *MoveDirectoryContentsSafe(Path moveSrc, Path moveDest, MoveProgressR
 		}
 	}
 
-	for (size_t i = 0; i < fileSuffixesToMove.size(); i++) {
-		const auto &fileSuffix = fileSuffixesToMove[i];
-		progressReporter.SetProgress(StringFromFormat("%s (%s)", fileSuffix.suffix.c_str(), NiceSizeFormat(fileSuffix.fileSize).c_str()),
-			i, fileSuffixesToMove.size());
-
-		Path from = moveSrc / fileSuffix.suffix;
-		Path to = moveDest / fileSuffix.suffix;
-
-		if (dryRun) {
-			INFO_LOG(Log::System, "dry run: Would have moved '%s' to '%s' (%d bytes)", from.c_str(), to.c_str(), (int)fileSuffix.fileSize);
+	// Skip what an earlier, interrupted move already copied. Those still get verified below.
+	auto copyState = std::make_shared<MoveCopyState>();
+	copyState->moveSrc = moveSrc;
+	copyState->moveDest = moveDest;
+	copyState->journalPath = moveDest / MOVE_JOURNAL_FILENAME;
+	copyState->progressReporter = &progressReporter;
+	copyState->dryRun = dryRun;
+	copyState->journal = moveSrc.ToString() + "\n";
+
+	std::set<std::string> alreadyCopied = LoadMoveJournal(copyState->journalPath, moveSrc);
+	for (const auto &fileSuffix : fileSuffixesToMove) {
+		if (alreadyCopied.count(fileSuffix.suffix)) {
+			copyState->journal += fileSuffix.suffix + "\n";
 		} else {
-			// Remove the "from" prefix from the path.
-			// We have to drop down to string operations for this.
-			if (File::Exists(to)) {
-				WARN_LOG(Log::System, "Target file '%s' already exists. Will be overwritten", to.c_str());
-			}
+			copyState->files.push_back(&fileSuffix);
+		}
+	}
+	if (!alreadyCopied.empty()) {
+		INFO_LOG(Log::System, "Resuming move, %d of %d files already copied", (int)(fileSuffixesToMove.size() - copyState->files.size()), (int)fileSuffixesToMove.size());
+	}
+	if (!dryRun) {
+		File::WriteStringToFile(true, copyState->journal, copyState->journalPath);
+	}
 
-			if (!File::Copy(from, to)) {
-				ERROR_LOG(Log::System, "Failed to copy file '%s' to '%s'", from.c_str(), to.c_str());
-				failedFileCount++;
-				// Should probably just bail?
-			} else {
-				INFO_LOG(Log::System, "Copied file '%s' to '%s' (size: %d)", from.c_str(), to.c_str(), (int)fileSuffix.fileSize);
-			}
+	// This thread copies too, so the move can't stall even if the extra tasks are slow to start.
+	int extraTasks = std::min(MOVE_COPY_THREADS - 1, (int)copyState->files.size() - 1);
+	for (int i = 0; i < extraTasks; i++) {
+		{
+			std::lock_guard<std::mutex> guard(copyState->doneLock);
+			copyState->runningTasks++;
 		}
+		g_threadManager.EnqueueTask(new MoveCopyTask(copyState));
 	}
+	copyState->CopyFiles();
+	{
+		std::unique_lock<std::mutex> guard(copyState->doneLock);
+		copyState->doneCond.wait(guard, [&] { return copyState->runningTasks == 0; });
+	}
+	if (!dryRun) {
+		copyState->SaveJournal();
+	}
+	failedFileCount = copyState->failed;
 
 	if (failedFileCount) {
 		ERROR_LOG(Log::System, "Copy failed (%d files failed)", (int)failedFileCount);
@@ -278,6 +428,9 @@ MoveResult *MoveDirectoryContentsSafe(Path moveSrc, Path moveDest, MoveProgressR
 	}
 
 	INFO_LOG(Log::System, "Verification complete");
+	if (!dryRun) {
+		File::Delete(moveDest / MOVE_JOURNAL_FILENAME);
+	}
 
 	// Delete all the old, now hopefully empty, directories.
 	// Hopefully DeleteDir actually fails if it contains a file...
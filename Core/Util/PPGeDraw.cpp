@@ -34,6 +34,7 @@
 #include "Common/BitScan.h"
 #include "Core/HDRemaster.h"
 #include "GPU/ge_constants.h"
+#include "GPU/GeThread.h"
 #include "GPU/GPUState.h"
 #include "GPU/GPUCommon.h"
 #include "Core/FileSystems/MetaFileSystem.h"
@@ -86,6 +87,14 @@ static u32 paletteSize = sizeof(u16) * 16;
 static u32 vertexStart;
 static u32 vertexCount;
 
+// What this list has already set, so redundant state and draws can be folded away.
+// Only valid between PPGeBegin() and PPGeEnd(), not savestated.
+static u32 dlShadow[256];
+static bool dlShadowValid[256];
+static bool dlClutDirty = true;
+static u32 lastPrimPtr;
+static u32 lastPrimVertexEnd;
+
 // Used for formatting text
 struct AtlasCharVertex
 {
@@ -153,9 +162,57 @@ static void PPGeDecimateTextImages(int age = 97);
 
 void PPGeSetTexture(u32 dataAddr, int width, int height);
 
+static void ResetListShadow() {
+	memset(dlShadowValid, 0, sizeof(dlShadowValid));
+	dlClutDirty = true;
+	lastPrimPtr = 0;
+	lastPrimVertexEnd = 0;
+}
+
+// Pure state: writing the same value twice in a row has no effect, so it can be skipped.
+static bool IsShadowedCmd(u8 cmd) {
+	switch (cmd) {
+	case GE_CMD_BASE:
+	case GE_CMD_TEXTUREMAPENABLE:
+	case GE_CMD_TEXSIZE0:
+	case GE_CMD_TEXMAPMODE:
+	case GE_CMD_TEXMODE:
+	case GE_CMD_TEXFORMAT:
+	case GE_CMD_TEXFILTER:
+	case GE_CMD_TEXWRAP:
+	case GE_CMD_TEXFUNC:
+	case GE_CMD_TEXADDR0:
+	case GE_CMD_TEXBUFWIDTH0:
+	case GE_CMD_CLUTADDR:
+	case GE_CMD_CLUTADDRUPPER:
+	case GE_CMD_CLUTFORMAT:
+	case GE_CMD_SCISSOR1:
+	case GE_CMD_SCISSOR2:
+		return true;
+	default:
+		return false;
+	}
+}
+
 //only 0xFFFFFF of data is used
 static void WriteCmd(u8 cmd, u32 data) {
-	Memory::Write_U32((cmd << 24) | (data & 0xFFFFFF), dlWritePtr);
+	data &= 0xFFFFFF;
+	if (IsShadowedCmd(cmd)) {
+		if (dlShadowValid[cmd] && dlShadow[cmd] == data)
+			return;
+		dlShadow[cmd] = data;
+		dlShadowValid[cmd] = true;
+		if (cmd == GE_CMD_CLUTADDR || cmd == GE_CMD_CLUTADDRUPPER || cmd == GE_CMD_CLUTFORMAT)
+			dlClutDirty = true;
+	} else if (cmd == GE_CMD_LOADCLUT) {
+		// The palette itself never changes, so only reload when the clut state does.
+		if (!dlClutDirty && dlShadowValid[cmd] && dlShadow[cmd] == data)
+			return;
+		dlShadow[cmd] = data;
+		dlShadowValid[cmd] = true;
+		dlClutDirty = false;
+	}
+	Memory::Write_U32((cmd << 24) | data, dlWritePtr);
 	dlWritePtr += 4;
 	_dbg_assert_(dlWritePtr <= dlPtr + dlSize);
 }
@@ -202,7 +259,24 @@ static void EndVertexDataAndDraw(int prim) {
 	_assert_msg_(vertexStart != 0, "Missing matching call to BeginVertexData()");
 	if (vertexCount != 0) {
 		NotifyMemInfo(MemBlockFlags::WRITE, vertexStart, dataWritePtr - vertexStart, "PPGe Vertex");
-		WriteCmdAddrWithBase(GE_CMD_VADDR, vertexStart);
+		// PRIM leaves the vertex address right after the vertices it drew.
+		bool contiguous = lastPrimPtr != 0 && lastPrimVertexEnd == vertexStart;
+		if (contiguous && lastPrimPtr + 4 == dlWritePtr) {
+			// Nothing changed since the last draw, so just extend it.
+			u32 lastPrim = Memory::Read_U32(lastPrimPtr);
+			u32 lastCount = lastPrim & 0xFFFF;
+			if (((lastPrim >> 16) & 7) == (u32)prim && lastCount + vertexCount <= 0xFFFF) {
+				Memory::Write_U32((GE_CMD_PRIM << 24) | (prim << 16) | (lastCount + vertexCount), lastPrimPtr);
+				lastPrimVertexEnd = dataWritePtr;
+				vertexStart = 0;
+				return;
+			}
+		}
+		if (!contiguous) {
+			WriteCmdAddrWithBase(GE_CMD_VADDR, vertexStart);
+		}
+		lastPrimPtr = dlWritePtr;
+		lastPrimVertexEnd = dataWritePtr;
 		WriteCmd(GE_CMD_PRIM, (prim << 16) | vertexCount);
 	}
 	vertexStart = 0;
@@ -381,6 +455,8 @@ void __PPGeDoState(PointerWrap &p)
 
 	Do(p, vertexStart);
 	Do(p, vertexCount);
+	if (p.mode == p.MODE_READ)
+		ResetListShadow();
 
 	Do(p, char_lines);
 	Do(p, char_lines_metrics);
@@ -420,9 +496,13 @@ void PPGeBegin()
 	if (!dlPtr)
 		return;
 
+	// The last list might still be reading these buffers.
+	GeThread::Sync();
+
 	// Reset write pointers to start of command and data buffers.
 	dlWritePtr = dlPtr;
 	dataWritePtr = dataPtr;
+	ResetListShadow();
 
 	// Set up the correct states for UI drawing
 	WriteCmd(GE_CMD_OFFSETADDR, 0);
@@ -45,6 +45,7 @@ enum class ServerStatus {
 
 static const char *REPORT_HOSTNAME = "report.ppsspp.org";
 static const int REPORT_PORT = 80;
+static const int HTTP_WORKER_THREADS = 4;
 
 static std::thread serverThread;
 static ServerStatus serverStatus;
@@ -125,7 +126,7 @@ static bool RegisterServer(int port) {
 
 bool RemoteISOFileSupported(const std::string &filename) {
 	// Disc-like files.
-	if (endsWithNoCase(filename, ".cso") || endsWithNoCase(filename, ".iso") || endsWithNoCase(filename, ".chd")) {
+	if (endsWithNoCase(filename, ".cso") || endsWithNoCase(filename, ".iso") || endsWithNoCase(filename, ".chd") || endsWithNoCase(filename, ".szst")) {
 		return true;
 	}
 	// May work - but won't have supporting files.
@@ -202,6 +203,51 @@ static Path LocalFromRemotePath(const std::string &path) {
 	}
 }
 
+struct ByteRange {
+	s64 begin;
+	s64 last;
+};
+
+// Parses a Range header like "bytes=0-99,200-299,500-,-100".  Open ended ranges are resolved against the file size.
+static bool ParseByteRanges(const std::string &header, s64 sz, std::vector<ByteRange> *ranges) {
+	if (!startsWith(header, "bytes="))
+		return false;
+
+	std::vector<std::string_view> specs;
+	SplitString(std::string_view(header).substr(6), ',', specs);
+	// There's no good reason to ask for lots at once.
+	if (specs.empty() || specs.size() > 64)
+		return false;
+
+	for (std::string_view spec : specs) {
+		std::string trimmed(StripSpaces(spec));
+		char *end = nullptr;
+		ByteRange range;
+		if (!trimmed.empty() && trimmed[0] == '-') {
+			// The last N bytes.
+			s64 count = strtoll(trimmed.c_str() + 1, &end, 10);
+			if (*end != '\0' || count <= 0)
+				return false;
+			range.begin = std::max((s64)0, sz - count);
+			range.last = sz - 1;
+		} else {
+			range.begin = strtoll(trimmed.c_str(), &end, 10);
+			if (end == trimmed.c_str() || *end != '-')
+				return false;
+			const char *lastStr = end + 1;
+			if (*lastStr == '\0') {
+				range.last = sz - 1;
+			} else {
+				range.last = strtoll(lastStr, &end, 10);
+				if (*end != '\0')
+					return false;
+			}
+		}
+		ranges->push_back(range);
+	}
+	return true;
+}
+
 static void DiscHandler(const http::ServerRequest &request, const Path &filename) {
 	s64 sz = File::GetFileSize(filename);
 	if (sz == 0) {
@@ -215,44 +261,61 @@ static void DiscHandler(const http::ServerRequest &request, const Path &filename
 	if (request.Method() == http::RequestHeader::HEAD) {
 		request.WriteHttpResponseHeader("1.0", 200, sz, "application/octet-stream", "Accept-Ranges: bytes\r\n");
 	} else if (request.GetHeader("range", &range)) {
-		s64 begin = 0, last = 0;
-		if (sscanf(range.c_str(), "bytes=%lld-%lld", &begin, &last) != 2) {
+		std::vector<ByteRange> ranges;
+		if (!ParseByteRanges(range, sz, &ranges)) {
 			request.WriteHttpResponseHeader("1.0", 400, -1, "text/plain");
 			request.Out()->Push("Could not understand range request.");
 			return;
 		}
 
-		if (begin < 0 || begin > last || last >= sz) {
-			request.WriteHttpResponseHeader("1.0", 416, -1, "text/plain");
-			request.Out()->Push("Range goes outside of file.");
-			return;
+		for (const ByteRange &r : ranges) {
+			if (r.begin < 0 || r.begin > r.last || r.last >= sz) {
+				request.WriteHttpResponseHeader("1.0", 416, -1, "text/plain");
+				request.Out()->Push("Range goes outside of file.");
+				return;
+			}
 		}
 
 		FILE *fp = File::OpenCFile(filename, "rb");
-		if (!fp || fseek(fp, begin, SEEK_SET) != 0) {
+		if (!fp) {
 			request.WriteHttpResponseHeader("1.0", 500, -1, "text/plain");
 			request.Out()->Push("File access failed.");
-			if (fp) {
-				fclose(fp);
-			}
 			return;
 		}
 
-		s64 len = last - begin + 1;
-		char contentRange[1024];
-		snprintf(contentRange, sizeof(contentRange), "Content-Range: bytes %lld-%lld/%lld\r\n", begin, last, sz);
-		request.WriteHttpResponseHeader("1.0", 206, len, "application/octet-stream", contentRange);
-
-		const size_t CHUNK_SIZE = 16 * 1024;
-		char *buf = new char[CHUNK_SIZE];
-		for (s64 pos = 0; pos < len; pos += CHUNK_SIZE) {
-			s64 chunklen = std::min(len - pos, (s64)CHUNK_SIZE);
-			if (fread(buf, chunklen, 1, fp) != 1)
-				break;
-			request.Out()->Push(buf, chunklen);
+		bool success = true;
+		if (ranges.size() == 1) {
+			s64 len = ranges[0].last - ranges[0].begin + 1;
+			char contentRange[1024];
+			snprintf(contentRange, sizeof(contentRange), "Content-Range: bytes %lld-%lld/%lld\r\n", ranges[0].begin, ranges[0].last, sz);
+			request.WriteHttpResponseHeader("1.0", 206, len, "application/octet-stream", contentRange);
+			success = request.WriteFileRange(fp, ranges[0].begin, len);
+		} else {
+			// Each range gets its own part, so the length has to account for their headers too.
+			static const char *const BOUNDARY = "PPSSPP_BYTERANGES";
+			std::vector<std::string> partHeaders;
+			const std::string footer = StringFromFormat("--%s--\r\n", BOUNDARY);
+			s64 len = footer.size();
+			for (const ByteRange &r : ranges) {
+				partHeaders.push_back(StringFromFormat("--%s\r\nContent-Type: application/octet-stream\r\nContent-Range: bytes %lld-%lld/%lld\r\n\r\n", BOUNDARY, r.begin, r.last, sz));
+				len += partHeaders.back().size() + (r.last - r.begin + 1) + 2;
+			}
+
+			std::string mimeType = StringFromFormat("multipart/byteranges; boundary=%s", BOUNDARY);
+			request.WriteHttpResponseHeader("1.0", 206, len, mimeType.c_str());
+			for (size_t i = 0; i < ranges.size() && success; ++i) {
+				request.Out()->Push(partHeaders[i]);
+				success = request.WriteFileRange(fp, ranges[i].begin, ranges[i].last - ranges[i].begin + 1);
+				request.Out()->Push("\r\n");
+			}
+			request.Out()->Push(footer);
 		}
 		fclose(fp);
-		delete[] buf;
+
+		if (!success) {
+			// The headers already promised more, so the client will notice.
+			WARN_LOG(Log::Loader, "Failed to send all of %s for %s", range.c_str(), filename.c_str());
+		}
 		request.Out()->Flush();
 	} else {
 		request.WriteHttpResponseHeader("1.0", 418, -1, "text/plain");
@@ -407,7 +470,8 @@ static void ExecuteWebServer() {
 
 	AndroidJNIThreadContext context;  // Destructor detaches.
 
-	auto http = new http::Server(new NewThreadExecutor());
+	// Serving is mostly waiting on the network and disk, a few threads go a long way.
+	auto http = new http::Server(new ThreadPoolExecutor(HTTP_WORKER_THREADS));
 	http->RegisterHandler("/", &HandleListing);
 	// This lists all the (current) recent ISOs.
 	http->SetFallbackHandler(&HandleFallback);
@@ -3,6 +3,7 @@
 #include <cstdint>
 
 #include "Common/Math/CrossSIMD.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "GPU/Common/DepthRaster.h"
 #include "GPU/Math3D.h"
 #include "Common/Math/math_util.h"
@@ -13,14 +14,14 @@ DepthScissor DepthScissor::Tile(int tile, int numTiles) const {
 		return *this;
 	}
 	// First tiling algorithm: Split into vertical slices.
-	int w = x2 - x1;
+	// The triangle rasterizer loads and stores groups of four pixels aligned to four pixels, so the
+	// inner slice edges are aligned the same way, otherwise neighbouring tiles could race on a group.
+	int w = x2 - x1 + 1;
 	int tileW = (w / numTiles) & ~3;  // Round to four pixels.
 
-	// TODO: Should round x1 to four pixels as well! except the first one
-
 	DepthScissor scissor;
-	scissor.x1 = x1 + tileW * tile;
-	scissor.x2 = (tile == numTiles - 1) ? x2 : (x1 + tileW * (tile + 1));
+	scissor.x1 = (tile == 0) ? x1 : ((x1 + tileW * tile) & ~3);
+	scissor.x2 = (tile == numTiles - 1) ? x2 : (((x1 + tileW * (tile + 1)) & ~3) - 1);  // Inclusive
 	scissor.y1 = y1;
 	scissor.y2 = y2;
 	return scissor;
@@ -164,7 +165,7 @@ void DepthRaster4Triangles(int stats[3], uint16_t *depthBuf, int stride, DepthSc
 	for (int t = 0; t < 4; t++) {
 		// Check for bad triangle.
 		// Using operator[] on the vectors actually seems to result in pretty good code.
-		if (maxX[t] <= minX[t] || maxY[t] <= minY[t]) {
+		if (maxX[t] < minX[t] || maxY[t] < minY[t]) {
 			// No pixels, or outside screen.
 			// Most of these are now gone in the initial pass, but not all since we cull
 			// in 4-groups there.
@@ -554,8 +555,8 @@ int DepthRasterClipIndexedTriangles(int *tx, int *ty, float *tz, const float *tr
 	return outCount;
 }
 
-// Rasterizes screen-space vertices.
-void DepthRasterScreenVerts(uint16_t *depth, int depthStride, const int *tx, const int *ty, const float *tz, int count, const DepthDraw &draw, const DepthScissor scissor, bool lowQ) {
+// Rasterizes screen-space vertices within one tile. stats is indexed by TriangleStat, only thread-local state is touched.
+static void DepthRasterScreenVertsTile(int stats[3], uint16_t *depth, int depthStride, const int *tx, const int *ty, const float *tz, int count, const DepthDraw &draw, const DepthScissor scissor, bool lowQ) {
 	// Prim should now be either TRIANGLES or RECTs.
 	_dbg_assert_(draw.prim == GE_PRIM_RECTANGLES || draw.prim == GE_PRIM_TRIANGLES);
 
@@ -567,11 +568,10 @@ void DepthRasterScreenVerts(uint16_t *depth, int depthStride, const int *tx, con
 			// We remove the subpixel information here.
 			DepthRasterRect(depth, depthStride, scissor, tx[i], ty[i], tx[i + 1], ty[i + 1], z, draw.compareMode);
 		}
-		gpuStats.numDepthRasterPrims += count / 2;
+		stats[(int)TriangleStat::OK] += count / 2;
 		break;
 	case GE_PRIM_TRIANGLES:
 	{
-		int stats[3]{};
 		// Batches of 4 triangles, as output by the clip function.
 		if (lowQ) {
 			switch (draw.compareMode) {
@@ -622,12 +622,42 @@ void DepthRasterScreenVerts(uint16_t *depth, int depthStride, const int *tx, con
 			}
 			}
 		}
-		gpuStats.numDepthRasterNoPixels += stats[(int)TriangleStat::NoPixels];
-		gpuStats.numDepthRasterTooSmall += stats[(int)TriangleStat::SmallOrBackface];
-		gpuStats.numDepthRasterPrims += stats[(int)TriangleStat::OK];
 		break;
 	}
 	default:
 		_dbg_assert_(false);
 	}
 }
+
+int DepthRasterTileCount(const DepthScissor scissor, int count) {
+	if (count < DEPTH_RASTER_PARALLEL_MIN_VERTS) {
+		return 1;
+	}
+	// Don't bother splitting into very narrow slices, triangles get set up once per tile.
+	int maxTilesForWidth = (scissor.x2 - scissor.x1 + 1) / 64;
+	return std::max(1, std::min(std::min(g_threadManager.GetNumLooperThreads(), maxTilesForWidth), (int)MAX_DEPTH_RASTER_TILES));
+}
+
+void DepthRasterScreenVerts(uint16_t *depth, int depthStride, const int *tx, const int *ty, const float *tz, int count, const DepthDraw &draw, const DepthScissor scissor, bool lowQ, int numTiles) {
+	_dbg_assert_(numTiles >= 1 && numTiles <= MAX_DEPTH_RASTER_TILES);
+
+	int stats[MAX_DEPTH_RASTER_TILES][3]{};
+	if (numTiles <= 1) {
+		DepthRasterScreenVertsTile(stats[0], depth, depthStride, tx, ty, tz, count, draw, scissor, lowQ);
+	} else {
+		// Like the software renderer's bins, each tile is a vertical slice of the scissor that only
+		// one thread writes to, so the depth buffer needs no synchronization.
+		ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+			for (int tile = lower; tile < upper; tile++) {
+				DepthRasterScreenVertsTile(stats[tile], depth, depthStride, tx, ty, tz, count, draw, scissor.Tile(tile, numTiles), lowQ);
+			}
+		}, 0, numTiles, 1);
+	}
+
+	// Primitives that cross tile edges are counted once per tile.
+	for (int tile = 0; tile < numTiles; tile++) {
+		gpuStats.numDepthRasterNoPixels += stats[tile][(int)TriangleStat::NoPixels];
+		gpuStats.numDepthRasterTooSmall += stats[tile][(int)TriangleStat::SmallOrBackface];
+		gpuStats.numDepthRasterPrims += stats[tile][(int)TriangleStat::OK];
+	}
+}
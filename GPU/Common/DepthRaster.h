@@ -56,4 +56,13 @@ int DepthRasterClipIndexedRectangles(int *tx, int *ty, float *tz, const float *t
 void DecodeAndTransformForDepthRaster(float *dest, const float *worldviewproj, const void *vertexData, int indexLowerBound, int indexUpperBound, VertexDecoder *dec, u32 vertTypeID);
 void TransformPredecodedForDepthRaster(float *dest, const float *worldviewproj, const void *decodedVertexData, VertexDecoder *dec, int count);
 void ConvertPredecodedThroughForDepthRaster(float *dest, const void *decodedVertexData, VertexDecoder *dec, int count);
-void DepthRasterScreenVerts(uint16_t *depth, int depthStride, const int *tx, const int *ty, const float *tz, int count, const DepthDraw &draw, const DepthScissor scissor, bool lowQ);
+
+enum {
+	MAX_DEPTH_RASTER_TILES = 8,
+	// Below this many screen vertices, a draw is not worth splitting across threads.
+	DEPTH_RASTER_PARALLEL_MIN_VERTS = 12 * 32,
+};
+
+// Picks how many vertical slices to rasterize a draw in, in parallel. Returns 1 for small draws.
+int DepthRasterTileCount(const DepthScissor scissor, int count);
+void DepthRasterScreenVerts(uint16_t *depth, int depthStride, const int *tx, const int *ty, const float *tz, int count, const DepthDraw &draw, const DepthScissor scissor, bool lowQ, int numTiles);
@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <cfloat>
 
+#include "Common/Data/Collections/FrameArena.h"
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/LogReporting.h"
@@ -27,12 +28,15 @@
 #include "Common/TimeUtil.h"
 #include "Core/System.h"
 #include "Core/Config.h"
+#include "Core/HDRemaster.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/SplineCommon.h"
 #include "GPU/Common/DepthRaster.h"
 #include "GPU/Common/VertexDecoderCommon.h"
 #include "GPU/Common/SoftwareTransformCommon.h"
+#include "GPU/Common/TextureCacheCommon.h"
 #include "GPU/ge_constants.h"
+#include "GPU/GPUCommon.h"
 #include "GPU/GPUState.h"
 
 #define QUAD_INDICES_MAX 65536
@@ -139,8 +143,8 @@ void DrawEngineCommon::DispatchSubmitImm(GEPrimitiveType prim, TransformedVertex
 		uint32_t color;
 		float xyz[3];
 	};
-	std::vector<ImmVertex> temp;
-	temp.resize(vertexCount);
+	FrameArena::Scope arenaScope(g_gpuFrameArena);
+	ImmVertex *temp = g_gpuFrameArena.AllocateArray<ImmVertex>(vertexCount);
 	uint32_t color1Used = 0;
 	for (int i = 0; i < vertexCount; i++) {
 		// Since we're sending through, scale back up to w/h.
@@ -627,6 +631,43 @@ int DrawEngineCommon::ComputeNumVertsToDecode() const {
 	return sum;
 }
 
+// Through mode draws with texel texcoords, that software transform divides by the texture size at flush.
+bool DrawEngineCommon::IsAtlasCandidate(u32 vertTypeID) const {
+	if (!(vertTypeID & GE_VTYPE_THROUGH_MASK) || gstate.isModeClear() || !gstate.isTextureMapEnabled())
+		return false;
+	if (gstate_c.submitType != SubmitType::DRAW || g_DoubleTextureCoordinates)
+		return false;
+	if (vertTypeID & (GE_VTYPE_WEIGHT_MASK | GE_VTYPE_MORPHCOUNT_MASK))
+		return false;
+	const u32 tc = vertTypeID & GE_VTYPE_TC_MASK;
+	return tc == GE_VTYPE_TC_16BIT || tc == GE_VTYPE_TC_FLOAT;
+}
+
+// The atlas has no room to wrap around, so each draw has to stay within the texture.
+bool DrawEngineCommon::AtlasTexCoordsInside(const void *verts, VertexDecoder *dec, u32 vertTypeID, int lowerBound, int upperBound) const {
+	const float maxU = (float)gstate.getTextureWidth(0);
+	const float maxV = (float)gstate.getTextureHeight(0);
+	const int stride = dec->VertexSize();
+	const u8 *tc = (const u8 *)verts + lowerBound * stride + dec->tcoff;
+	if ((vertTypeID & GE_VTYPE_TC_MASK) == GE_VTYPE_TC_16BIT) {
+		for (int i = lowerBound; i <= upperBound; i++, tc += stride) {
+			const u16_le *uv = (const u16_le *)tc;
+			if (uv[0] > maxU || uv[1] > maxV)
+				return false;
+		}
+	} else {
+		for (int i = lowerBound; i <= upperBound; i++, tc += stride) {
+			const float_le *uv = (const float_le *)tc;
+			const float u = uv[0];
+			const float v = uv[1];
+			// Written so that NaN fails too.
+			if (!(u >= 0.0f && u <= maxU && v >= 0.0f && v <= maxV))
+				return false;
+		}
+	}
+	return true;
+}
+
 // Takes a list of consecutive PRIM opcodes, and extends the current draw call to include them.
 // This is just a performance optimization.
 int DrawEngineCommon::ExtendNonIndexedPrim(const uint32_t *cmd, const uint32_t *stall, VertexDecoder *dec, u32 vertTypeID, bool clockwise, int *bytesRead, bool isTriangle) {
@@ -654,6 +695,9 @@ int DrawEngineCommon::ExtendNonIndexedPrim(const uint32_t *cmd, const uint32_t *
 		if (numDrawInds_ >= MAX_DEFERRED_DRAW_INDS || vertexCountInDrawCalls_ + offset + vertexCount > VERTEX_BUFFER_MAX) {
 			break;
 		}
+		if (atlasBatch_ && (vertexCount == 0 || !AtlasTexCoordsInside(dv.verts, dec, vertTypeID, offset, offset + vertexCount - 1))) {
+			break;
+		}
 		DeferredInds &di = drawInds_[numDrawInds_++];
 		di.indexType = 0;
 		di.prim = newPrim;
@@ -736,6 +780,28 @@ bool DrawEngineCommon::SubmitPrim(const void *verts, const void *inds, GEPrimiti
 		}
 	}
 
+	AtlasOffset atlasOffset{};
+	if (atlasTexCache_ || atlasBatch_) {
+		bool useAtlas = false;
+		if (atlasTexCache_ && (atlasBatch_ || numDrawVerts_ == 0) && IsAtlasCandidate(vertTypeID)) {
+			u16 lb;
+			u16 ub;
+			GetIndexBounds(inds, vertexCount, vertTypeID, &lb, &ub);
+			useAtlas = AtlasTexCoordsInside(verts, dec_, vertTypeID, lb, ub) && atlasTexCache_->GetAtlasSlot(numDrawVerts_ == 0, &atlasOffset.x, &atlasOffset.y);
+		}
+		if (atlasBatch_ && !useAtlas && numDrawVerts_ != 0) {
+			// The queued draws were made with another texture, that's already been replaced in gstate.
+			Flush();
+		}
+		if (numDrawVerts_ == 0) {
+			if (useAtlas || atlasBatch_) {
+				// Make the flush pick up the atlas, or the real texture again.
+				gstate_c.Dirty(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
+			}
+			atlasBatch_ = useAtlas;
+		}
+	}
+
 	bool applySkin = dec_->skinInDecode;
 
 	DeferredInds &di = drawInds_[numDrawInds_++];
@@ -757,7 +823,8 @@ bool DrawEngineCommon::SubmitPrim(const void *verts, const void *inds, GEPrimiti
 	_dbg_assert_(numDrawVerts_ <= MAX_DEFERRED_DRAW_VERTS);
 	_dbg_assert_(numDrawInds_ <= MAX_DEFERRED_DRAW_INDS);
 
-	if (inds && numDrawVerts_ > decodeVertsCounter_ && drawVerts_[numDrawVerts_ - 1].verts == verts && !applySkin) {
+	if (inds && numDrawVerts_ > decodeVertsCounter_ && drawVerts_[numDrawVerts_ - 1].verts == verts && !applySkin &&
+		(!atlasBatch_ || (drawAtlasOffsets_[numDrawVerts_ - 1].x == atlasOffset.x && drawAtlasOffsets_[numDrawVerts_ - 1].y == atlasOffset.y))) {
 		// Same vertex pointer as a previous un-decoded draw call - let's just extend the decode!
 		di.vertDecodeIndex = numDrawVerts_ - 1;
 		u16 lb;
@@ -770,6 +837,7 @@ bool DrawEngineCommon::SubmitPrim(const void *verts, const void *inds, GEPrimiti
 			dv.indexUpperBound = ub;
 	} else {
 		// Record a new draw, and a new index gen.
+		drawAtlasOffsets_[numDrawVerts_] = atlasOffset;
 		DeferredVerts &dv = drawVerts_[numDrawVerts_++];
 		dv.verts = verts;
 		dv.vertexCount = vertexCount;
@@ -791,6 +859,10 @@ bool DrawEngineCommon::SubmitPrim(const void *verts, const void *inds, GEPrimiti
 
 void DrawEngineCommon::BeginFrame() {
 	applySkinInDecode_ = g_Config.bSoftwareSkinning;
+	// Don't switch in the middle of a batch, SubmitPrim takes care of the texture state when it ends.
+	if (numDrawVerts_ == 0) {
+		atlasTexCache_ = g_Config.bBatchSpriteTextures ? gpuCommon_->GetTextureCacheCommon() : nullptr;
+	}
 	if (!depthTransformed_ && useDepthRaster_) {
 		depthTransformed_ = (float *)AllocateMemoryPages(DEPTH_TRANSFORMED_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
 		depthScreenVerts_ = (int *)AllocateMemoryPages(DEPTH_SCREENVERTS_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
@@ -819,7 +891,22 @@ void DrawEngineCommon::DecodeVerts(VertexDecoder *dec, u8 *dest) {
 		}
 
 		// Decode the verts (and at the same time apply morphing/skinning). Simple.
-		dec->DecodeVerts(dest + numDecodedVerts_ * stride, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+		// A null dest means the decoded data is already cached, so only the offsets are needed.
+		if (dest) {
+			u8 *decoded = dest + numDecodedVerts_ * stride;
+			dec->DecodeVerts(decoded, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+			if (atlasBatch_) {
+				// Through mode texcoords are still in texels here, just move them to the slot.
+				const float offsetU = drawAtlasOffsets_[i].x;
+				const float offsetV = drawAtlasOffsets_[i].y;
+				u8 *uvs = decoded + dec->GetDecVtxFmt().uvoff;
+				for (int v = indexLowerBound; v <= indexUpperBound; v++, uvs += stride) {
+					float *uv = (float *)uvs;
+					uv[0] += offsetU;
+					uv[1] += offsetV;
+				}
+			}
+		}
 		numDecodedVerts_ += indexUpperBound - indexLowerBound + 1;
 	}
 	decodeVertsCounter_ = i;
@@ -856,6 +943,33 @@ int DrawEngineCommon::DecodeInds() {
 	return indexGen.VertexCount();
 }
 
+// Like DecodeInds, but all the draws must be triangle strips (see CanDrawStripsWithRestart.)
+// Always decodes all of them at once.
+int DrawEngineCommon::DecodeIndsStripRestart() {
+	for (int i = 0; i < numDrawInds_; i++) {
+		const DeferredInds &di = drawInds_[i];
+
+		int indexOffset = drawVertexOffsets_[di.vertDecodeIndex] + di.offset;
+		switch (di.indexType) {
+		case GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT:
+			indexGen.AddStripRestart(di.vertexCount, indexOffset, di.clockwise);
+			break;
+		case GE_VTYPE_IDX_8BIT >> GE_VTYPE_IDX_SHIFT:
+			indexGen.TranslateStripRestart(di.vertexCount, (const u8 *)di.inds, indexOffset, di.clockwise);
+			break;
+		case GE_VTYPE_IDX_16BIT >> GE_VTYPE_IDX_SHIFT:
+			indexGen.TranslateStripRestart(di.vertexCount, (const u16_le *)di.inds, indexOffset, di.clockwise);
+			break;
+		case GE_VTYPE_IDX_32BIT >> GE_VTYPE_IDX_SHIFT:
+			indexGen.TranslateStripRestart(di.vertexCount, (const u32_le *)di.inds, indexOffset, di.clockwise);
+			break;
+		}
+	}
+	decodeIndsCounter_ = numDrawInds_;
+
+	return indexGen.VertexCount();
+}
+
 bool DrawEngineCommon::CanUseHardwareTransform(int prim) const {
 	if (!useHWTransform_)
 		return false;
@@ -1110,16 +1224,14 @@ void DrawEngineCommon::FlushQueuedDepth() {
 		const float *vertices = depthTransformed_ + 4 * draw.vertexOffset;
 		const uint16_t *indices = depthIndices_ + draw.indexOffset;
 
-		DepthScissor tileScissor = draw.scissor.Tile(0, 1);
-
 		{
 			TimeCollector collectStat(&gpuStats.msCullDepth, collectStats);
 			switch (draw.prim) {
 			case GE_PRIM_RECTANGLES:
-				outVertCount = DepthRasterClipIndexedRectangles(tx, ty, tz, vertices, indices, draw, tileScissor);
+				outVertCount = DepthRasterClipIndexedRectangles(tx, ty, tz, vertices, indices, draw, draw.scissor);
 				break;
 			case GE_PRIM_TRIANGLES:
-				outVertCount = DepthRasterClipIndexedTriangles(tx, ty, tz, vertices, indices, draw, tileScissor);
+				outVertCount = DepthRasterClipIndexedTriangles(tx, ty, tz, vertices, indices, draw, draw.scissor);
 				break;
 			default:
 				_dbg_assert_(false);
@@ -1128,7 +1240,8 @@ void DrawEngineCommon::FlushQueuedDepth() {
 		}
 		{
 			TimeCollector collectStat(&gpuStats.msRasterizeDepth, collectStats);
-			DepthRasterScreenVerts((uint16_t *)Memory::GetPointerWrite(draw.depthAddr), draw.depthStride, tx, ty, tz, outVertCount, draw, tileScissor, lowQ);
+			const int numTiles = DepthRasterTileCount(draw.scissor, outVertCount);
+			DepthRasterScreenVerts((uint16_t *)Memory::GetPointerWrite(draw.depthAddr), draw.depthStride, tx, ty, tz, outVertCount, draw, draw.scissor, lowQ, numTiles);
 		}
 	}
 
@@ -29,6 +29,7 @@
 #include "GPU/Common/VertexDecoderCommon.h"
 
 class VertexDecoder;
+class TextureCacheCommon;
 struct DepthDraw;
 
 enum {
@@ -143,6 +144,10 @@ class DrawEngineCommon {
 	int GetNumDrawCalls() const {
 		return numDrawVerts_;
 	}
+	// The queued draws sample from the sprite atlas, so they don't depend on the current texture.
+	bool IsAtlasBatch() const {
+		return atlasBatch_ && numDrawVerts_ > 0;
+	}
 
 	VertexDecoder *GetVertexDecoder(u32 vertTypeID) {
 		VertexDecoder *dec;
@@ -172,9 +177,13 @@ class DrawEngineCommon {
 
 	void DecodeVerts(VertexDecoder *dec, u8 *dest);
 	int DecodeInds();
+	int DecodeIndsStripRestart();
 
 	int ComputeNumVertsToDecode() const;
 
+	bool IsAtlasCandidate(u32 vertTypeID) const;
+	bool AtlasTexCoordsInside(const void *verts, VertexDecoder *dec, u32 vertTypeID, int lowerBound, int upperBound) const;
+
 	void ApplyFramebufferRead(FBOTexState *fboTexState);
 
 	void DepthRasterTransform(GEPrimitiveType prim, VertexDecoder *dec, uint32_t vertTypeID, int vertexCount);
@@ -252,12 +261,23 @@ class DrawEngineCommon {
 		}
 	}
 
+	// Only merged triangle strips, which can then be drawn as strips separated by restart indices.
+	inline bool CanDrawStripsWithRestart() const {
+		return supportsPrimitiveRestart_ && !useDepthRaster_ && seenPrims_ == (1 << GE_PRIM_TRIANGLE_STRIP) &&
+			decodeIndsCounter_ == 0 && numDecodedVerts_ < IndexGenerator::RESTART_INDEX;
+	}
+
 	inline void DecodeIndsAndGetData(GEPrimitiveType *prim, int *numVerts, int *maxIndex, bool *useElements, bool forceIndexed) {
 		if (!forceIndexed && CollectedPureDraw()) {
 			*prim = drawInds_[0].prim;
 			*numVerts = numDecodedVerts_;
 			*maxIndex = numDecodedVerts_;
 			*useElements = false;
+		} else if (CanDrawStripsWithRestart()) {
+			*numVerts = DecodeIndsStripRestart();
+			*maxIndex = numDecodedVerts_;
+			*prim = GE_PRIM_TRIANGLE_STRIP;
+			*useElements = true;
 		} else {
 			int vertexCount = DecodeInds();
 			*numVerts = vertexCount;
@@ -273,6 +293,8 @@ class DrawEngineCommon {
 
 	bool useHWTransform_ = false;
 	bool useHWTessellation_ = false;
+	// Set by backends that restart strips at IndexGenerator::RESTART_INDEX in indexed strip draws.
+	bool supportsPrimitiveRestart_ = false;
 	// Used to prevent unnecessary flushing in softgpu.
 	bool flushOnParams_ = true;
 
@@ -317,6 +339,17 @@ class DrawEngineCommon {
 	uint32_t drawVertexOffsets_[MAX_DEFERRED_DRAW_VERTS];
 	DeferredInds drawInds_[MAX_DEFERRED_DRAW_INDS];
 
+	// Through mode sprite batching, see TextureCacheCommon::GetAtlasSlot. Null while disabled.
+	TextureCacheCommon *atlasTexCache_ = nullptr;
+	// Whether the current batch (or the last one, if empty) draws from the atlas.
+	bool atlasBatch_ = false;
+	// Texel offsets into the atlas, per drawVerts_ entry. Not in DeferredVerts, which gets hashed.
+	struct AtlasOffset {
+		u16 x;
+		u16 y;
+	};
+	AtlasOffset drawAtlasOffsets_[MAX_DEFERRED_DRAW_VERTS];
+
 	VertexDecoder *dec_ = nullptr;
 	u32 lastVType_ = -1;  // corresponds to dec_.  Could really just pick it out of dec_...
 	int numDrawVerts_ = 0;
@@ -106,6 +106,8 @@ bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLangu
 	bool enableColorTest = id.Bit(FS_BIT_COLOR_TEST);
 	bool colorTestAgainstZero = id.Bit(FS_BIT_COLOR_AGAINST_ZERO);
 	bool doTextureProjection = id.Bit(FS_BIT_DO_TEXTURE_PROJ);
+	// Alpha and color test driven by u_fragTestFlags instead of the bits above, which will be off.
+	bool genericTests = id.Bit(FS_BIT_GENERIC_TESTS);
 
 	bool ubershader = id.Bit(FS_BIT_UBERSHADER);
 	// ubershader-controlled bits. If ubershader is on, these will not be used below (and will be false).
@@ -120,6 +122,10 @@ bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLangu
 		*errorString = "We only do array textures for framebuffers in Vulkan.";
 		return false;
 	}
+	if (compat.shaderLanguage != ShaderLanguage::GLSL_VULKAN && genericTests) {
+		*errorString = "Generic test shaders are only used in Vulkan.";
+		return false;
+	}
 
 	bool flatBug = bugs.Has(Draw::Bugs::BROKEN_FLAT_IN_SHADER) && g_Config.bVendorBugChecksEnabled;
 
@@ -226,10 +232,10 @@ bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLangu
 			WRITE(p, "layout (location = 0) in highp vec3 v_texcoord;\n");
 		}
 
-		if (enableAlphaTest && !alphaTestAgainstZero) {
+		if ((enableAlphaTest && !alphaTestAgainstZero) || genericTests) {
 			WRITE(p, "int roundAndScaleTo255i(in highp float x) { return int(floor(x * 255.0 + 0.5)); }\n");
 		}
-		if (enableColorTest && !colorTestAgainstZero) {
+		if ((enableColorTest && !colorTestAgainstZero) || genericTests) {
 			WRITE(p, "uint roundAndScaleTo8x4(in highp vec3 x) { uvec3 u = uvec3(floor(x * 255.0 + 0.5)); return u.r | (u.g << 8) | (u.b << 16); }\n");
 			WRITE(p, "uint packFloatsTo8x4(in vec3 x) { uvec3 u = uvec3(x); return u.r | (u.g << 8) | (u.b << 16); }\n");
 		}
@@ -899,7 +905,7 @@ bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLangu
 
 			// We only need a clamp if the color will be further processed. Otherwise the hardware color conversion will clamp for us.
 			if (ubershader) {
-				if (enableFog || enableColorTest || replaceBlend != REPLACE_BLEND_NO || simulateLogicOpType != LOGICOPTYPE_NORMAL || colorWriteMask || blueToAlpha) {
+				if (enableFog || enableColorTest || genericTests || replaceBlend != REPLACE_BLEND_NO || simulateLogicOpType != LOGICOPTYPE_NORMAL || colorWriteMask || blueToAlpha) {
 					WRITE(p, "  v.rgb = clamp(v.rgb * u_texNoAlphaMul.y, 0.0, 1.0);\n");
 				} else {
 					WRITE(p, "  v.rgb *= u_texNoAlphaMul.y;\n");
@@ -1032,6 +1038,31 @@ bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLangu
 			}
 		}
 
+		if (genericTests) {
+			*fragmentShaderFlags |= FragmentShaderFlags::USES_DISCARD;
+
+			// See PackFragmentTestFlags. Same math as the bitwise paths above.
+			WRITE(p, "  bool testFailed = false;\n");
+			WRITE(p, "  if ((u_fragTestFlags & 0x08u) != 0u) {\n");
+			WRITE(p, "    uint aFunc = u_fragTestFlags & 0x07u;\n");
+			WRITE(p, "    int aValue = roundAndScaleTo255i(v.a) & int(u_alphacolormask >> 0x18u);\n");
+			WRITE(p, "    int aRef = int(u_alphacolorref >> 0x18u);\n");
+			WRITE(p, "    bool aPass = aFunc == 1u || (aFunc == 2u && aValue == aRef) || (aFunc == 3u && aValue != aRef) ||\n");
+			WRITE(p, "      (aFunc == 4u && aValue < aRef) || (aFunc == 5u && aValue <= aRef) || (aFunc == 6u && aValue > aRef) || (aFunc == 7u && aValue >= aRef);\n");
+			WRITE(p, "    testFailed = !aPass;\n");
+			WRITE(p, "  }\n");
+			WRITE(p, "  if ((u_fragTestFlags & 0x40u) != 0u) {\n");
+			WRITE(p, "    uint cFunc = (u_fragTestFlags >> 4u) & 0x03u;\n");
+			WRITE(p, "    uint cValue = roundAndScaleTo8x4(v.rgb) & u_alphacolormask;\n");
+			WRITE(p, "    uint cRef = (u_alphacolorref & u_alphacolormask) & 0xFFFFFFu;\n");
+			WRITE(p, "    bool cPass = cFunc == 1u || (cFunc == 2u && cValue == cRef) || (cFunc == 3u && cValue != cRef);\n");
+			WRITE(p, "    testFailed = testFailed || !cPass;\n");
+			WRITE(p, "  }\n");
+			WRITE(p, "  if (testFailed) {\n");
+			WRITE(p, "    if ((u_fragTestFlags & 0x80u) != 0u) { v.a = 0.0; } else { DISCARD; }\n");
+			WRITE(p, "  }\n");
+		}
+
 		if (replaceBlend == REPLACE_BLEND_2X_SRC) {
 			WRITE(p, "  v.rgb = v.rgb * 2.0;\n");
 		}
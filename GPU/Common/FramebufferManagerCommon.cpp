@@ -23,6 +23,7 @@
 #include "ext/imgui/imgui_impl_thin3d.h"
 
 #include "Common/GPU/thin3d.h"
+#include "Common/Data/Collections/FrameArena.h"
 #include "Common/Data/Collections/TinySet.h"
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/LogReporting.h"
@@ -35,6 +36,7 @@
 #include "Core/Core.h"
 #include "Core/CoreParameter.h"
 #include "Core/Debugger/MemBlockInfo.h"
+#include "Core/HW/Display.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
 #include "GPU/Common/PresentationCommon.h"
@@ -72,6 +74,8 @@ FramebufferManagerCommon::~FramebufferManagerCommon() {
 	}
 	bvfbs_.clear();
 
+	DecimateFramebufferPool(true);
+
 	delete presentation_;
 	delete[] convBuf_;
 }
@@ -94,14 +98,20 @@ bool FramebufferManagerCommon::UpdateRenderSize(int msaaLevel) {
 	}
 
 	bool newBuffered = !g_Config.bSkipBufferEffects;
-	const bool newSettings = bloomHack_ != effectiveBloomHack || useBufferedRendering_ != newBuffered;
+	const bool newSettings = bloomHack_ != effectiveBloomHack || bloomHackScale_ != g_Config.iBloomHackScale || useBufferedRendering_ != newBuffered;
 
 	renderWidth_ = (float)PSP_CoreParameter().renderWidth;
 	renderHeight_ = (float)PSP_CoreParameter().renderHeight;
-	renderScaleFactor_ = (float)PSP_CoreParameter().renderScaleFactor;
+	if (renderScaleFactor_ != PSP_CoreParameter().renderScaleFactor) {
+		renderScaleSeq_++;
+	}
+	renderScaleFactor_ = PSP_CoreParameter().renderScaleFactor;
+	configuredScaleFactor_ = renderScaleFactor_;
+	dynRes_ = DynamicResolutionState();
 	msaaLevel_ = msaaLevel;
 
 	bloomHack_ = effectiveBloomHack;
+	bloomHackScale_ = g_Config.iBloomHackScale;
 	useBufferedRendering_ = newBuffered;
 
 	presentation_->UpdateRenderSize(renderWidth_, renderHeight_);
@@ -122,10 +132,97 @@ void FramebufferManagerCommon::CheckPostShaders() {
 
 void FramebufferManagerCommon::BeginFrame() {
 	DecimateFBOs();
+	UpdateDynamicResolution();
 	presentation_->BeginFrame();
 	currentRenderVfb_ = nullptr;
 }
 
+void FramebufferManagerCommon::UpdateDynamicResolution() {
+	// Upscaling and SSAA post shaders depend on a specific render resolution, so leave those alone.
+	if (!g_Config.bDynamicResolution || !useBufferedRendering_ || configuredScaleFactor_ <= 1 || postShaderIsUpscalingFilter_ || postShaderIsSupersampling_) {
+		if (renderScaleFactor_ != configuredScaleFactor_) {
+			SetDynamicRenderScale(configuredScaleFactor_);
+		}
+		return;
+	}
+
+	const auto &history = draw_->FrameTimeHistory();
+	if (history.MaxIndex() < 3) {
+		return;
+	}
+
+	// The frame that just began has no timings yet, so look at the one before it.
+	const FrameTimeData &data = history.Back(1);
+	const FrameTimeData &prev = history.Back(2);
+	if (data.frameId == dynRes_.lastFrameId || prev.frameId + 1 != data.frameId || data.frameBegin == 0.0 || prev.frameBegin == 0.0) {
+		return;
+	}
+	dynRes_.lastFrameId = data.frameId;
+
+	const double period = data.frameBegin - prev.frameBegin;
+	// Fast-forwarded, unthrottled or paused frames say nothing about the frame budget.
+	if (PSP_CoreParameter().fastForward || PSP_CoreParameter().fpsLimit != FPSLimit::NORMAL || period <= 0.0 || period > 0.25) {
+		dynRes_.frames = 0;
+		dynRes_.periodSum = 0.0;
+		dynRes_.fenceWaitSum = 0.0;
+		return;
+	}
+
+	// Time spent blocked on the frame fence is time the GPU was still busy with an older frame.
+	// Backends that don't wait on a fence report zero here, and so never scale down.
+	dynRes_.periodSum += period;
+	dynRes_.fenceWaitSum += std::max(0.0, data.afterFenceWait - data.frameBegin);
+
+	const int WINDOW_FRAMES = 30;
+	if (++dynRes_.frames < WINDOW_FRAMES) {
+		return;
+	}
+
+	const double avgPeriod = dynRes_.periodSum / dynRes_.frames;
+	const double avgFenceWait = dynRes_.fenceWaitSum / dynRes_.frames;
+	dynRes_.frames = 0;
+	dynRes_.periodSum = 0.0;
+	dynRes_.fenceWaitSum = 0.0;
+
+	const double target = 1.0 / 59.94;
+	const bool gpuBound = avgPeriod > target * 1.05 && avgFenceWait > target * 0.1;
+	const bool headroom = avgPeriod < target * 1.02 && avgFenceWait < target * 0.02;
+
+	if (gpuBound) {
+		if (dynRes_.justScaledUp) {
+			// Going up didn't hold, so wait longer before trying again.
+			dynRes_.windowsToScaleUp = std::min(dynRes_.windowsToScaleUp * 2, 64);
+		}
+		dynRes_.justScaledUp = false;
+		dynRes_.goodWindows = 0;
+		if (renderScaleFactor_ > 1) {
+			SetDynamicRenderScale(renderScaleFactor_ - 1);
+		}
+		return;
+	}
+
+	if (dynRes_.justScaledUp) {
+		dynRes_.windowsToScaleUp = std::max(dynRes_.windowsToScaleUp / 2, 4);
+		dynRes_.justScaledUp = false;
+	}
+
+	if (!headroom) {
+		dynRes_.goodWindows = 0;
+	} else if (renderScaleFactor_ < configuredScaleFactor_ && ++dynRes_.goodWindows >= dynRes_.windowsToScaleUp) {
+		dynRes_.goodWindows = 0;
+		dynRes_.justScaledUp = true;
+		SetDynamicRenderScale(renderScaleFactor_ + 1);
+	}
+}
+
+void FramebufferManagerCommon::SetDynamicRenderScale(int scale) {
+	DEBUG_LOG(Log::FrameBuf, "Dynamic resolution: render scale %d -> %d", renderScaleFactor_, scale);
+	renderScaleFactor_ = scale;
+	// Framebuffers pick up the new scale lazily, as they're next bound for rendering.
+	// The presentation chain stays at the configured size and just stretches the smaller image.
+	renderScaleSeq_++;
+}
+
 bool FramebufferManagerCommon::PresentedThisFrame() const {
 	return presentation_->PresentedThisFrame();
 }
@@ -505,13 +602,29 @@ VirtualFramebuffer *FramebufferManagerCommon::DoSetRenderFrameBuffer(Framebuffer
 			vfb->lastFrameNewSize = gpuStats.numFlips;
 		}
 
-		if (!resized && renderScaleFactor_ != 1 && vfb->renderScaleFactor == 1) {
+		if (!resized && vfb->renderScaleFactor < renderScaleFactor_) {
 			// Might be time to change this framebuffer - have we used depth?
 			if ((vfb->usageFlags & FB_USAGE_COLOR_MIXED_DEPTH) && !PSP_CoreParameter().compat.flags().ForceLowerResolutionForEffectsOn) {
 				ResizeFramebufFBO(vfb, vfb->width, vfb->height, true);
+				resized = true;
 				_assert_(vfb->renderScaleFactor != 1);
 			}
 		}
+
+		if (!resized && vfb->renderScaleSeq != renderScaleSeq_) {
+			// The render scale changed (dynamic resolution) since this was created. Nothing is bound yet, so this is a safe point.
+			ResizeFramebufFBO(vfb, vfb->bufferWidth, vfb->bufferHeight, true);
+		}
+	}
+
+	if (skipDrawReason & SKIPDRAW_FAST_FORWARD) {
+		// Nobody will see this frame, so only keep drawing to buffers that get read back or used as CLUTs.
+		if (vfb && (vfb->usageFlags & (FB_USAGE_DOWNLOAD | FB_USAGE_CLUT))) {
+			gstate_c.skipDrawReason &= ~SKIPDRAW_SKIPFRAME;
+		} else {
+			gstate_c.skipDrawReason |= SKIPDRAW_SKIPFRAME;
+		}
+		skipDrawReason = gstate_c.skipDrawReason;
 	}
 
 	// None found? Create one.
@@ -677,7 +790,8 @@ struct CopySource {
 // or to use image copies when possible (which may make it easier for the driver to preserve early-Z, but on the other hand, will cost additional memory
 // bandwidth on tilers due to the load operation, which we might otherwise be able to skip).
 void FramebufferManagerCommon::CopyToDepthFromOverlappingFramebuffers(VirtualFramebuffer *dest) {
-	std::vector<CopySource> sources;
+	FrameArena::Scope arenaScope(g_gpuFrameArena);
+	ArenaVector<CopySource> sources(g_gpuFrameArena);
 	for (auto src : vfbs_) {
 		if (src == dest)
 			continue;
@@ -773,7 +887,8 @@ void FramebufferManagerCommon::CopyToColorFromOverlappingFramebuffers(VirtualFra
 		return;
 	}
 
-	std::vector<CopySource> sources;
+	FrameArena::Scope arenaScope(g_gpuFrameArena);
+	ArenaVector<CopySource> sources(g_gpuFrameArena);
 	for (auto src : vfbs_) {
 		// Discard old and equal potential inputs.
 		if (src == dst || src->colorBindSeq < dst->colorBindSeq) {
@@ -950,7 +1065,7 @@ void FramebufferManagerCommon::DestroyFramebuf(VirtualFramebuffer *v) {
 	// Notify the texture cache of both the color and depth buffers.
 	textureCache_->NotifyFramebuffer(v, NOTIFY_FB_DESTROYED);
 	if (v->fbo) {
-		v->fbo->Release();
+		RecycleFramebuffer(v->fbo);
 		v->fbo = nullptr;
 	}
 
@@ -1107,7 +1222,7 @@ void FramebufferManagerCommon::NotifyRenderFramebufferSwitched(VirtualFramebuffe
 		if (vfb->fbo) {
 			// This should only happen very briefly when toggling useBufferedRendering_.
 			textureCache_->NotifyFramebuffer(vfb, NOTIFY_FB_DESTROYED);
-			vfb->fbo->Release();
+			RecycleFramebuffer(vfb->fbo);
 			vfb->fbo = nullptr;
 		}
 
@@ -1724,7 +1839,7 @@ void FramebufferManagerCommon::DecimateFBOs() {
 	currentRenderVfb_ = nullptr;
 
 	for (auto iter : fbosToDelete_) {
-		iter->Release();
+		RecycleFramebuffer(iter);
 	}
 	fbosToDelete_.clear();
 
@@ -1752,7 +1867,7 @@ void FramebufferManagerCommon::DecimateFBOs() {
 	for (auto it = tempFBOs_.begin(); it != tempFBOs_.end(); ) {
 		int age = frameLastFramebufUsed_ - it->second.last_frame_used;
 		if (age > FBO_OLD_AGE) {
-			it->second.fbo->Release();
+			RecycleFramebuffer(it->second.fbo);
 			it = tempFBOs_.erase(it);
 		} else {
 			++it;
@@ -1783,6 +1898,8 @@ void FramebufferManagerCommon::DecimateFBOs() {
 			++it;
 		}
 	}
+
+	DecimateFramebufferPool(false);
 }
 
 // Requires width/height to be set already.
@@ -1828,11 +1945,16 @@ void FramebufferManagerCommon::ResizeFramebufFBO(VirtualFramebuffer *vfb, int w,
 	}
 
 	if (force1x && g_Config.iInternalResolution != 1) {
-		vfb->renderScaleFactor = 1;
-		vfb->renderWidth = vfb->bufferWidth;
-		vfb->renderHeight = vfb->bufferHeight;
+		// Doesn't have to go all the way down to 1x, at high resolutions 2x still saves most of the work
+		// while looking a lot less blocky.
+		int lowScale = std::min(std::max(bloomHackScale_, 1), renderScaleFactor_);
+		vfb->renderScaleFactor = lowScale;
+		vfb->renderScaleSeq = renderScaleSeq_;
+		vfb->renderWidth = (u16)(vfb->bufferWidth * lowScale);
+		vfb->renderHeight = (u16)(vfb->bufferHeight * lowScale);
 	} else {
 		vfb->renderScaleFactor = renderScaleFactor_;
+		vfb->renderScaleSeq = renderScaleSeq_;
 		vfb->renderWidth = (u16)(vfb->bufferWidth * renderScaleFactor_);
 		vfb->renderHeight = (u16)(vfb->bufferHeight * renderScaleFactor_);
 	}
@@ -1852,7 +1974,7 @@ void FramebufferManagerCommon::ResizeFramebufFBO(VirtualFramebuffer *vfb, int w,
 
 	if (!useBufferedRendering_) {
 		if (vfb->fbo) {
-			vfb->fbo->Release();
+			RecycleFramebuffer(vfb->fbo);
 			vfb->fbo = nullptr;
 		}
 		return;
@@ -1866,9 +1988,7 @@ void FramebufferManagerCommon::ResizeFramebufFBO(VirtualFramebuffer *vfb, int w,
 	char tag[128];
 	size_t len = FormatFramebufferName(vfb, tag, sizeof(tag));
 
-	gpuStats.numFBOsCreated++;
-
-	vfb->fbo = draw_->CreateFramebuffer({ vfb->renderWidth, vfb->renderHeight, 1, GetFramebufferLayers(), msaaLevel_, true, tag });
+	vfb->fbo = AcquireFramebuffer({ vfb->renderWidth, vfb->renderHeight, 1, GetFramebufferLayers(), msaaLevel_, true, tag });
 	if (Memory::IsVRAMAddress(vfb->fb_address) && vfb->fb_stride != 0) {
 		NotifyMemInfo(MemBlockFlags::ALLOC, vfb->fb_address, vfb->BufferByteSize(RASTER_COLOR), tag, len);
 	}
@@ -2192,11 +2312,7 @@ bool FramebufferManagerCommon::NotifyFramebufferCopy(u32 src, u32 dst, int size,
 		if (srcH == 0 || srcY + srcH > srcBuffer->bufferHeight) {
 			WARN_LOG_ONCE(btdcpyheight, Log::FrameBuf, "Memcpy fbo download %08x -> %08x skipped, %d+%d is taller than %d", src, dst, srcY, srcH, srcBuffer->bufferHeight);
 		} else if (GetSkipGPUReadbackMode() == SkipGPUReadbackMode::NO_SKIP && (!srcBuffer->memoryUpdated || channel == RASTER_DEPTH)) {
-			Draw::ReadbackMode readbackMode = Draw::ReadbackMode::BLOCK;
-			if (PSP_CoreParameter().compat.flags().AllowDelayedReadbacks) {
-				readbackMode = Draw::ReadbackMode::OLD_DATA_OK;
-			}
-			ReadFramebufferToMemory(srcBuffer, 0, srcY, srcBuffer->width, srcH, channel, readbackMode);
+			ReadFramebufferToMemory(srcBuffer, 0, srcY, srcBuffer->width, srcH, channel, GetCopyReadbackMode());
 			srcBuffer->usageFlags = (srcBuffer->usageFlags | FB_USAGE_DOWNLOAD) & ~FB_USAGE_DOWNLOAD_CLEAR;
 		}
 		return false;
@@ -2397,6 +2513,7 @@ VirtualFramebuffer *FramebufferManagerCommon::CreateRAMFramebuffer(uint32_t fbAd
 	vfb->newHeight = vfb->height;
 	vfb->lastFrameNewSize = gpuStats.numFlips;
 	vfb->renderScaleFactor = renderScaleFactor_;
+	vfb->renderScaleSeq = renderScaleSeq_;
 	vfb->renderWidth = (u16)(vfb->width * renderScaleFactor_);
 	vfb->renderHeight = (u16)(vfb->height * renderScaleFactor_);
 	vfb->bufferWidth = vfb->width;
@@ -2410,7 +2527,7 @@ VirtualFramebuffer *FramebufferManagerCommon::CreateRAMFramebuffer(uint32_t fbAd
 	snprintf(name, sizeof(name), "%08x_%s_RAM", vfb->Address(channel), RasterChannelToString(channel));
 	textureCache_->NotifyFramebuffer(vfb, NOTIFY_FB_CREATED);
 	bool createDepthBuffer = format == GE_FORMAT_DEPTH16;
-	vfb->fbo = draw_->CreateFramebuffer({ vfb->renderWidth, vfb->renderHeight, 1, GetFramebufferLayers(), 0, createDepthBuffer, name });
+	vfb->fbo = AcquireFramebuffer({ vfb->renderWidth, vfb->renderHeight, 1, GetFramebufferLayers(), 0, createDepthBuffer, name });
 	vfbs_.push_back(vfb);
 
 	u32 byteSize = vfb->BufferByteSize(channel);
@@ -2468,7 +2585,7 @@ VirtualFramebuffer *FramebufferManagerCommon::FindDownloadTempBuffer(VirtualFram
 		snprintf(name, sizeof(name), "download_temp_%08x_%s", vfb->Address(channel), RasterChannelToString(channel));
 
 		// We always create a color-only framebuffer here - readbacks of depth convert to color while translating the values.
-		nvfb->fbo = draw_->CreateFramebuffer({ nvfb->bufferWidth, nvfb->bufferHeight, 1, 1, 0, false, name });
+		nvfb->fbo = AcquireFramebuffer({ nvfb->bufferWidth, nvfb->bufferHeight, 1, 1, 0, false, name });
 		if (!nvfb->fbo) {
 			ERROR_LOG(Log::FrameBuf, "Error creating FBO! %d x %d", nvfb->renderWidth, nvfb->renderHeight);
 			delete nvfb;
@@ -2703,7 +2820,36 @@ bool FramebufferManagerCommon::NotifyBlockTransferBefore(u32 dstBasePtr, int dst
 			GeBufferFormatToString(srcRect.vfb->Format(srcRect.channel)), GeBufferFormatToString(dstRect.vfb->Format(dstRect.channel)),
 			width, height);
 
-		// TODO
+		// Color to color with different formats. The bytes are copied as-is, so we can reinterpret them
+		// on the GPU with the same shaders as overlapping framebuffers, including 16<->32 bit changes.
+		if (srcRect.vfb && srcRect.channel == RASTER_COLOR && dstRect.channel == RASTER_COLOR) {
+			GEBufferFormat srcFormat = srcRect.vfb->fb_format;
+			GEBufferFormat dstFormat = dstRect.vfb->fb_format;
+			int srcBpp = BufferFormatBytesPerPixel(srcFormat);
+			int dstBpp = BufferFormatBytesPerPixel(dstFormat);
+			if (srcRect.x_bytes % srcBpp == 0 && srcRect.w_bytes % srcBpp == 0 && dstRect.x_bytes % dstBpp == 0 && srcRect.w_bytes % dstBpp == 0) {
+				float scaleFactorX = 1.0f;
+				Draw2DPipeline *pipeline = GetReinterpretPipeline(srcFormat, dstFormat, &scaleFactorX);
+				if (pipeline) {
+					const int srcScale = srcRect.vfb->renderScaleFactor;
+					const int dstScale = dstRect.vfb->renderScaleFactor;
+					float srcX1 = (float)(srcRect.x_bytes / srcBpp) * srcScale;
+					float srcX2 = srcX1 + (float)(srcRect.w_bytes / srcBpp) * srcScale;
+					float srcY1 = (float)srcRect.y * srcScale;
+					float dstX1 = (float)(dstRect.x_bytes / dstBpp) * dstScale;
+					float dstX2 = dstX1 + (float)(srcRect.w_bytes / dstBpp) * dstScale;
+					float dstY1 = (float)dstRect.y * dstScale;
+
+					FlushBeforeCopy();
+					BlitUsingRaster(srcRect.vfb->fbo, srcX1, srcY1, srcX2, srcY1 + height * srcScale,
+						dstRect.vfb->fbo, dstX1, dstY1, dstX2, dstY1 + height * dstScale, false, dstScale, pipeline, reinterpretStrings[(int)srcFormat][(int)dstFormat]);
+					gpuStats.numReinterpretCopies++;
+					RebindFramebuffer("RebindFramebuffer - Reinterpret block transfer");
+					SetColorUpdated(dstRect.vfb, skipDrawReason);
+					return true;
+				}
+			}
+		}
 
 		// No need to actually do the memory copy behind, probably.
 		return true;
@@ -2743,11 +2889,7 @@ bool FramebufferManagerCommon::NotifyBlockTransferBefore(u32 dstBasePtr, int dst
 				if (tooTall) {
 					WARN_LOG_ONCE(btdheight, Log::G3D, "Block transfer download %08x -> %08x dangerous, %d+%d is taller than %d", srcBasePtr, dstBasePtr, srcRect.y, srcRect.h, srcRect.vfb->bufferHeight);
 				}
-				Draw::ReadbackMode readbackMode = Draw::ReadbackMode::BLOCK;
-				if (PSP_CoreParameter().compat.flags().AllowDelayedReadbacks) {
-					readbackMode = Draw::ReadbackMode::OLD_DATA_OK;
-				}
-				ReadFramebufferToMemory(srcRect.vfb, static_cast<int>(srcX * srcXFactor), srcY, static_cast<int>(srcRect.w_bytes * srcXFactor), srcRect.h, RASTER_COLOR, readbackMode);
+				ReadFramebufferToMemory(srcRect.vfb, static_cast<int>(srcX * srcXFactor), srcY, static_cast<int>(srcRect.w_bytes * srcXFactor), srcRect.h, RASTER_COLOR, GetCopyReadbackMode());
 				srcRect.vfb->usageFlags = (srcRect.vfb->usageFlags | FB_USAGE_DOWNLOAD) & ~FB_USAGE_DOWNLOAD_CLEAR;
 			}
 		}
@@ -2765,6 +2907,20 @@ SkipGPUReadbackMode FramebufferManagerCommon::GetSkipGPUReadbackMode() {
 	}
 }
 
+// For readbacks done for memcpys and block transfers, so the CPU doesn't wait for the GPU.
+// The compat flag returns the data from the previous time the same framebuffer was read, while the
+// setting has the backend write the current data to memory once the GPU is done with it, a few frames later.
+// Only some backends (Vulkan) support either, the rest treat them as blocking.
+Draw::ReadbackMode FramebufferManagerCommon::GetCopyReadbackMode() {
+	if (PSP_CoreParameter().compat.flags().AllowDelayedReadbacks) {
+		return Draw::ReadbackMode::OLD_DATA_OK;
+	}
+	if (g_Config.bDelayedGPUReadbacks) {
+		return Draw::ReadbackMode::DEFERRED;
+	}
+	return Draw::ReadbackMode::BLOCK;
+}
+
 void FramebufferManagerCommon::NotifyBlockTransferAfter(u32 dstBasePtr, int dstStride, int dstX, int dstY, u32 srcBasePtr, int srcStride, int srcX, int srcY, int width, int height, int bpp, u32 skipDrawReason) {
 	// If it's a block transfer direct to the screen, and we're not using buffers, draw immediately.
 	// We may still do a partial block draw below if this doesn't pass.
@@ -2865,6 +3021,10 @@ void FramebufferManagerCommon::NotifyConfigChanged() {
 }
 
 void FramebufferManagerCommon::DestroyAllFBOs() {
+	// Deferred readbacks would otherwise land in memory that's been reset or loaded from a state.
+	if (draw_) {
+		draw_->DiscardDeferredReadbacks();
+	}
 	DiscardFramebufferCopy();
 	currentRenderVfb_ = nullptr;
 	displayFramebuf_ = nullptr;
@@ -2883,15 +3043,17 @@ void FramebufferManagerCommon::DestroyAllFBOs() {
 	bvfbs_.clear();
 
 	for (auto &tempFB : tempFBOs_) {
-		tempFB.second.fbo->Release();
+		RecycleFramebuffer(tempFB.second.fbo);
 	}
 	tempFBOs_.clear();
 
 	for (auto &iter : fbosToDelete_) {
-		iter->Release();
+		RecycleFramebuffer(iter);
 	}
 	fbosToDelete_.clear();
 
+	DecimateFramebufferPool(true);
+
 	for (auto &iter : drawPixelsCache_) {
 		iter.tex->Release();
 	}
@@ -2921,7 +3083,7 @@ Draw::Framebuffer *FramebufferManagerCommon::GetTempFBO(TempFBO reason, u16 w, u
 	char name[128];
 	snprintf(name, sizeof(name), "tempfbo_%s_%dx%d", TempFBOReasonToString(reason), w / renderScaleFactor_, h / renderScaleFactor_);
 
-	Draw::Framebuffer *fbo = draw_->CreateFramebuffer({ w, h, 1, GetFramebufferLayers(), 0, z_stencil, name });
+	Draw::Framebuffer *fbo = AcquireFramebuffer({ w, h, 1, GetFramebufferLayers(), 0, z_stencil, name });
 	if (!fbo) {
 		return nullptr;
 	}
@@ -2931,6 +3093,66 @@ Draw::Framebuffer *FramebufferManagerCommon::GetTempFBO(TempFBO reason, u16 w, u
 	return fbo;
 }
 
+static u64 FramebufferPoolKey(int width, int height, int numLayers, int multiSampleLevel, bool z_stencil) {
+	return ((u64)width << 32) | ((u64)height << 16) | ((u64)numLayers << 8) | ((u64)multiSampleLevel << 1) | (z_stencil ? 1 : 0);
+}
+
+Draw::Framebuffer *FramebufferManagerCommon::AcquireFramebuffer(const Draw::FramebufferDesc &desc) {
+	const u64 key = FramebufferPoolKey(desc.width, desc.height, desc.numLayers, desc.multiSampleLevel, desc.z_stencil);
+	for (auto it = fboPool_.begin(); it != fboPool_.end(); ++it) {
+		// Framebuffers released this frame might still be referenced by queued work, so leave them alone.
+		if (it->key == key && it->last_frame_released != gpuStats.numFlips) {
+			Draw::Framebuffer *fbo = it->fbo;
+			fboPool_.erase(it);
+			fbo->UpdateTag(desc.tag);
+			fboPoolKeys_[fbo] = key;
+			gpuStats.numFBOsRecycled++;
+			return fbo;
+		}
+	}
+
+	Draw::Framebuffer *fbo = draw_->CreateFramebuffer(desc);
+	if (fbo) {
+		fboPoolKeys_[fbo] = key;
+		gpuStats.numFBOsCreated++;
+	}
+	return fbo;
+}
+
+void FramebufferManagerCommon::RecycleFramebuffer(Draw::Framebuffer *fbo) {
+	auto it = fboPoolKeys_.find(fbo);
+	if (it == fboPoolKeys_.end()) {
+		// Not from the pool, we don't know what it looks like.
+		fbo->Release();
+		return;
+	}
+
+	fboPool_.push_back({ fbo, it->second, gpuStats.numFlips });
+	fboPoolKeys_.erase(it);
+
+	if (fboPool_.size() > FBO_POOL_MAX_SIZE) {
+		// Oldest first.
+		fboPool_.front().fbo->Release();
+		fboPool_.erase(fboPool_.begin());
+	}
+}
+
+void FramebufferManagerCommon::DecimateFramebufferPool(bool releaseAll) {
+	for (auto it = fboPool_.begin(); it != fboPool_.end(); ) {
+		int age = frameLastFramebufUsed_ - it->last_frame_released;
+		if (releaseAll || age > FBO_OLD_AGE) {
+			it->fbo->Release();
+			it = fboPool_.erase(it);
+		} else {
+			++it;
+		}
+	}
+	if (releaseAll) {
+		// Anything still in here was released behind our back.
+		fboPoolKeys_.clear();
+	}
+}
+
 void FramebufferManagerCommon::UpdateFramebufUsage(VirtualFramebuffer *vfb) const {
 	auto checkFlag = [&](u16 flag, int last_frame) {
 		if (vfb->usageFlags & flag) {
@@ -3170,6 +3392,10 @@ void FramebufferManagerCommon::ReadbackFramebuffer(VirtualFramebuffer *vfb, int
 
 	if (channel == RASTER_DEPTH) {
 		_assert_msg_(vfb && vfb->z_address != 0 && vfb->z_stride != 0, "Depth buffer invalid");
+		// Depth is converted on the CPU from a temporary buffer, so it can't be written out later.
+		if (mode == Draw::ReadbackMode::DEFERRED) {
+			mode = Draw::ReadbackMode::BLOCK;
+		}
 		ReadbackDepthbuffer(vfb->fbo,
 			x * vfb->renderScaleFactor, y * vfb->renderScaleFactor,
 			w * vfb->renderScaleFactor, h * vfb->renderScaleFactor, (uint16_t *)destPtr, stride, w, h, mode);
@@ -3183,6 +3409,7 @@ void FramebufferManagerCommon::ReadbackFramebuffer(VirtualFramebuffer *vfb, int
 
 	if (mode == Draw::ReadbackMode::BLOCK) {
 		gpuStats.numBlockingReadbacks++;
+		DisplayNotifyCause(FRAME_CAUSE_READBACK);
 	} else {
 		gpuStats.numReadbacks++;
 	}
@@ -3254,7 +3481,8 @@ void FramebufferManagerCommon::FlushBeforeCopy() {
 	}
 }
 
-// TODO: Replace with with depal, reading the palette from the texture on the GPU directly.
+// Normally the palette is read from the framebuffer on the GPU directly (see TextureCacheCommon::LoadClut),
+// this is only needed when recording or with the AllowDownloadCLUT compat flag.
 void FramebufferManagerCommon::DownloadFramebufferForClut(u32 fb_address, u32 loadBytes) {
 	VirtualFramebuffer *vfb = GetVFBAt(fb_address);
 	if (vfb && vfb->fb_stride != 0) {
@@ -3285,7 +3513,10 @@ void FramebufferManagerCommon::DownloadFramebufferForClut(u32 fb_address, u32 lo
 			vfb->clutUpdatedBytes = loadBytes;
 
 			// This function now handles scaling down internally.
-			ReadbackFramebuffer(vfb, x, y, w, h, RASTER_COLOR, Draw::ReadbackMode::BLOCK);
+			// Old data here means a palette that's a frame behind, so this only honors the user setting,
+			// not the compat flag (which was added for block transfers.)
+			Draw::ReadbackMode mode = g_Config.bDelayedGPUReadbacks ? Draw::ReadbackMode::OLD_DATA_OK : Draw::ReadbackMode::BLOCK;
+			ReadbackFramebuffer(vfb, x, y, w, h, RASTER_COLOR, mode);
 
 			textureCache_->ForgetLastTexture();
 			RebindFramebuffer("RebindFramebuffer - DownloadFramebufferForClut");
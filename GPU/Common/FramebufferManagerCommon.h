@@ -109,6 +109,8 @@ struct VirtualFramebuffer {
 
 	// The scale factor at which we are rendering (to achieve higher resolution).
 	u8 renderScaleFactor;
+	// The manager's renderScaleSeq_ when renderScaleFactor was chosen. If it differs, the FBO gets resized on next bind.
+	int renderScaleSeq;
 
 	u16 usageFlags;
 
@@ -363,6 +365,7 @@ class FramebufferManagerCommon {
 	void DrawPixels(VirtualFramebuffer *vfb, int dstX, int dstY, const u8 *srcPixels, GEBufferFormat srcPixelFormat, int srcStride, int width, int height, RasterChannel channel, const char *tag);
 
 	size_t NumVFBs() const { return vfbs_.size(); }
+	size_t NumPooledFBOs() const { return fboPool_.size(); }
 
 	u32 PrevDisplayFramebufAddr() const {
 		return prevDisplayFramebuf_ ? prevDisplayFramebuf_->fb_address : 0;
@@ -446,6 +449,13 @@ class FramebufferManagerCommon {
 
 	Draw::Framebuffer *GetTempFBO(TempFBO reason, u16 w, u16 h);
 
+	// Framebuffer pool. Instead of being released right away, framebuffers go back to the pool and are
+	// reused by a later request with the same size, layer count, MSAA level and depth, saving the cost
+	// (and the VRAM fragmentation) of reallocating. Unused pooled framebuffers are released after a few frames.
+	Draw::Framebuffer *AcquireFramebuffer(const Draw::FramebufferDesc &desc);
+	void RecycleFramebuffer(Draw::Framebuffer *fbo);
+	void DecimateFramebufferPool(bool releaseAll);
+
 	// Debug features
 	virtual bool GetFramebuffer(u32 fb_address, int fb_stride, GEBufferFormat format, GPUDebugBuffer &buffer, int maxRes);
 	virtual bool GetDepthbuffer(u32 fb_address, int fb_stride, u32 z_address, int z_stride, GPUDebugBuffer &buffer);
@@ -524,6 +534,9 @@ class FramebufferManagerCommon {
 
 	void ResizeFramebufFBO(VirtualFramebuffer *vfb, int w, int h, bool force = false, bool skipCopy = false);
 
+	void UpdateDynamicResolution();
+	void SetDynamicRenderScale(int scale);
+
 	static bool ShouldDownloadFramebufferColor(const VirtualFramebuffer *vfb);
 	static bool ShouldDownloadFramebufferDepth(const VirtualFramebuffer *vfb);
 	void DownloadFramebufferOnSwitch(VirtualFramebuffer *vfb);
@@ -554,6 +567,7 @@ class FramebufferManagerCommon {
 	}
 
 	static SkipGPUReadbackMode GetSkipGPUReadbackMode();
+	static Draw::ReadbackMode GetCopyReadbackMode();
 
 	PresentationCommon *presentation_ = nullptr;
 
@@ -601,11 +615,27 @@ class FramebufferManagerCommon {
 
 	int msaaLevel_ = 0;
 	int renderScaleFactor_ = 1;
+	// The scale from the settings. With dynamic resolution, renderScaleFactor_ may drop below it.
+	int configuredScaleFactor_ = 1;
+	int renderScaleSeq_ = 0;
 	int pixelWidth_ = 0;
 	int pixelHeight_ = 0;
 	int bloomHack_ = 0;
+	int bloomHackScale_ = 1;
 	bool updatePostShaders_ = false;
 
+	// Frame time tracking for dynamic resolution, summed over a window of frames.
+	struct DynamicResolutionState {
+		uint64_t lastFrameId = 0;
+		int frames = 0;
+		double periodSum = 0.0;
+		double fenceWaitSum = 0.0;
+		int goodWindows = 0;
+		int windowsToScaleUp = 4;
+		bool justScaledUp = false;
+	};
+	DynamicResolutionState dynRes_;
+
 	Draw::DataFormat preferredPixelsFormat_ = Draw::DataFormat::R8G8B8A8_UNORM;
 
 	struct TempFBOInfo {
@@ -617,9 +647,20 @@ class FramebufferManagerCommon {
 
 	std::vector<Draw::Framebuffer *> fbosToDelete_;
 
+	struct PooledFramebuffer {
+		Draw::Framebuffer *fbo;
+		u64 key;
+		int last_frame_released;
+	};
+
+	std::vector<PooledFramebuffer> fboPool_;
+	// Pool keys of the framebuffers currently handed out by AcquireFramebuffer.
+	std::unordered_map<Draw::Framebuffer *, u64> fboPoolKeys_;
+
 	// Aggressively delete unused FBOs to save gpu memory.
 	enum {
 		FBO_OLD_AGE = 5,
+		FBO_POOL_MAX_SIZE = 8,
 		FBO_OLD_USAGE_FLAG = 15,
 	};
 
@@ -180,6 +180,11 @@ struct GPUDebugBuffer {
 		return fmt_;
 	}
 
+	// If not, the data belongs to someone else, like PSP RAM.
+	bool IsAllocated() const {
+		return alloc_;
+	}
+
 	u32 PixelSize() const;
 
 private:
@@ -354,3 +354,48 @@ void IndexGenerator::TranslatePrim(int prim, int numInds, const u32_le *inds, in
 	case GE_PRIM_RECTANGLES: TranslateRectangles<u32_le>(numInds, inds, indexOffset); break;  // Same
 	}
 }
+
+// Starts a new strip in restart mode. The first triangle of a strip is wound like the clockwise
+// case of AddStrip, so for counter-clockwise we repeat the first index, making a degenerate triangle
+// that flips the winding of the rest.
+inline void IndexGenerator::BeginStripRestart(int firstIndex, bool clockwise) {
+	u16 *outInds = inds_;
+	if (outInds != indsBase_)
+		*outInds++ = RESTART_INDEX;
+	if (!clockwise)
+		*outInds++ = firstIndex;
+	inds_ = outInds;
+}
+
+void IndexGenerator::AddStripRestart(int numVerts, int indexOffset, bool clockwise) {
+	if (numVerts < 3)
+		return;
+	BeginStripRestart(indexOffset, clockwise);
+	u16 *outInds = inds_;
+	for (int i = 0; i < numVerts; i++)
+		*outInds++ = indexOffset + i;
+	inds_ = outInds;
+}
+
+template <class ITypeLE>
+void IndexGenerator::TranslateStripRestartT(int numInds, const ITypeLE *inds, int indexOffset, bool clockwise) {
+	if (numInds < 3)
+		return;
+	BeginStripRestart(indexOffset + inds[0], clockwise);
+	u16 *outInds = inds_;
+	for (int i = 0; i < numInds; i++)
+		*outInds++ = indexOffset + inds[i];
+	inds_ = outInds;
+}
+
+void IndexGenerator::TranslateStripRestart(int numInds, const u8 *inds, int indexOffset, bool clockwise) {
+	TranslateStripRestartT<u8>(numInds, inds, indexOffset, clockwise);
+}
+
+void IndexGenerator::TranslateStripRestart(int numInds, const u16_le *inds, int indexOffset, bool clockwise) {
+	TranslateStripRestartT<u16_le>(numInds, inds, indexOffset, clockwise);
+}
+
+void IndexGenerator::TranslateStripRestart(int numInds, const u32_le *inds, int indexOffset, bool clockwise) {
+	TranslateStripRestartT<u32_le>(numInds, inds, indexOffset, clockwise);
+}
@@ -48,11 +48,22 @@ class IndexGenerator {
 		}
 	}
 
+	// Generated by the *Restart functions between strips. Needs primitive restart support, and
+	// the vertex count must stay below it.
+	static const u16 RESTART_INDEX = 0xFFFF;
+
 	void AddPrim(int prim, int vertexCount, int indexOffset, bool clockwise);
 	void TranslatePrim(int prim, int numInds, const u8 *inds, int indexOffset, bool clockwise);
 	void TranslatePrim(int prim, int numInds, const u16_le *inds, int indexOffset, bool clockwise);
 	void TranslatePrim(int prim, int numInds, const u32_le *inds, int indexOffset, bool clockwise);
 
+	// These keep triangle strips as strips, separated by RESTART_INDEX, instead of converting
+	// them to lists. That's less than half the indices for anything but single triangles.
+	void AddStripRestart(int numVerts, int indexOffset, bool clockwise);
+	void TranslateStripRestart(int numInds, const u8 *inds, int indexOffset, bool clockwise);
+	void TranslateStripRestart(int numInds, const u16_le *inds, int indexOffset, bool clockwise);
+	void TranslateStripRestart(int numInds, const u32_le *inds, int indexOffset, bool clockwise);
+
 	// This is really the number of generated indices, or 3x the number of triangles.
 	int VertexCount() const { return (int)(inds_ - indsBase_); }
 
@@ -87,6 +98,10 @@ class IndexGenerator {
 	template <class ITypeLE>
 	inline void TranslateRectangles(int numVerts, const ITypeLE *inds, int indexOffset);
 
+	template <class ITypeLE>
+	void TranslateStripRestartT(int numInds, const ITypeLE *inds, int indexOffset, bool clockwise);
+	inline void BeginStripRestart(int firstIndex, bool clockwise);
+
 	u16 *indsBase_;
 	u16 *inds_;
 
@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <cmath>
 #include <set>
+#include <sstream>
 #include <cstdint>
 #include "Common/GPU/thin3d.h"
 
@@ -27,6 +28,7 @@
 #include "Common/File/VFS/VFS.h"
 #include "Common/VR/PPSSPPVR.h"
 #include "Common/Log.h"
+#include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
@@ -193,6 +195,32 @@ void PresentationCommon::GetCardboardSettings(CardboardSettings *cardboardSettin
 	cardboardSettings->screenHeight = cardboardScreenHeight;
 }
 
+static const UniformBufferDesc postShaderDesc{ sizeof(PostShaderUniforms), {
+	{ "gl_HalfPixel", 0, -1, UniformType::FLOAT4, offsetof(PostShaderUniforms, gl_HalfPixel) },
+	{ "u_texelDelta", 1, 1, UniformType::FLOAT2, offsetof(PostShaderUniforms, texelDelta) },
+	{ "u_pixelDelta", 2, 2, UniformType::FLOAT2, offsetof(PostShaderUniforms, pixelDelta) },
+	{ "u_time", 3, 3, UniformType::FLOAT4, offsetof(PostShaderUniforms, time) },
+	{ "u_timeDelta", 4, 4, UniformType::FLOAT4, offsetof(PostShaderUniforms, timeDelta) },
+	{ "u_setting", 5, 5, UniformType::FLOAT4, offsetof(PostShaderUniforms, setting) },
+	{ "u_video", 6, 6, UniformType::FLOAT1, offsetof(PostShaderUniforms, video) },
+} };
+
+// Declarations every post shader may use, matching postShaderDesc. When fusing, these are emitted once up front.
+static const char *const standardPostShaderDecls[] = {
+	"uniform sampler2D sampler0;",
+	"uniform vec2 u_texelDelta;",
+	"uniform vec2 u_pixelDelta;",
+	"uniform vec4 u_time;",
+	"uniform vec4 u_timeDelta;",
+	"uniform vec4 u_setting;",
+	"uniform float u_video;",
+	"varying vec2 v_texcoord0;",
+};
+
+static const char *const settingValueSuffixes[4] = {
+	"SettingCurrentValue1", "SettingCurrentValue2", "SettingCurrentValue3", "SettingCurrentValue4",
+};
+
 static float GetShaderSettingValue(const ShaderInfo *shaderInfo, int i, const char *nameSuffix) {
 	std::string key = shaderInfo->section + nameSuffix;
 	auto it = g_Config.mPostShaderSetting.find(key);
@@ -243,6 +271,92 @@ static std::string ReadShaderSrc(const Path &filename) {
 	return src;
 }
 
+static bool IsIdentifierChar(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static size_t FindWord(const std::string &src, const std::string &word, size_t start) {
+	size_t pos = src.find(word, start);
+	while (pos != std::string::npos) {
+		bool startOk = pos == 0 || !IsIdentifierChar(src[pos - 1]);
+		bool endOk = pos + word.size() >= src.size() || !IsIdentifierChar(src[pos + word.size()]);
+		if (startOk && endOk)
+			return pos;
+		pos = src.find(word, pos + 1);
+	}
+	return std::string::npos;
+}
+
+static bool ContainsWord(const std::string &src, const std::string &word) {
+	return FindWord(src, word, 0) != std::string::npos;
+}
+
+static std::string ReplaceWord(std::string src, const std::string &word, const std::string &replacement) {
+	size_t pos = FindWord(src, word, 0);
+	while (pos != std::string::npos) {
+		src.replace(pos, word.size(), replacement);
+		pos = FindWord(src, word, pos + replacement.size());
+	}
+	return src;
+}
+
+// Replaces "texture2D(sampler0," (with any spacing) by the given call.
+static std::string ReplaceInputSamples(std::string src, const std::string &replacement) {
+	size_t pos = FindWord(src, "texture2D", 0);
+	while (pos != std::string::npos) {
+		size_t p = src.find_first_not_of(" \t", pos + 9);
+		if (p != std::string::npos && src[p] == '(') {
+			p = src.find_first_not_of(" \t", p + 1);
+			if (p != std::string::npos && src.compare(p, 8, "sampler0") == 0) {
+				p = src.find_first_not_of(" \t", p + 8);
+				if (p != std::string::npos && src[p] == ',') {
+					src.replace(pos, p + 1 - pos, replacement);
+					pos = FindWord(src, "texture2D", pos + replacement.size());
+					continue;
+				}
+			}
+		}
+		pos = FindWord(src, "texture2D", pos + 9);
+	}
+	return src;
+}
+
+static std::string StripStandardPostShaderDecls(const std::string &src) {
+	std::string result;
+	std::string line;
+	std::stringstream instream(src);
+	while (std::getline(instream, line)) {
+		std::string compact;
+		for (char c : line) {
+			if (c != ' ' && c != '\t' && c != '\r')
+				compact += c;
+		}
+		bool standard = false;
+		for (const char *decl : standardPostShaderDecls) {
+			std::string compactDecl;
+			for (const char *c = decl; *c; ++c) {
+				if (*c != ' ')
+					compactDecl += *c;
+			}
+			if (compact == compactDecl) {
+				standard = true;
+				break;
+			}
+		}
+		if (!standard)
+			result += line + "\n";
+	}
+	return result;
+}
+
+// Whether next can run as part of the same pass as prev, reading prev's output color directly.
+static bool CanFusePostShader(const ShaderInfo *prev, const ShaderInfo *next) {
+	if (!next->perPixel || next->usePreviousFrame || next->isUpscalingFilter || next->SSAAFilterLevel >= 2)
+		return false;
+	// Must run at the same resolution and with the same vertex shader, since those come from prev.
+	return next->outputResolution == prev->outputResolution && next->vertexShaderFile == prev->vertexShaderFile;
+}
+
 // Note: called on resize and settings changes.
 // Also takes care of making sure the appropriate stereo shader is compiled.
 bool PresentationCommon::UpdatePostShader() {
@@ -275,19 +389,43 @@ bool PresentationCommon::UpdatePostShader() {
 	bool usePreviousFrame = false;
 	bool usePreviousAtOutputResolution = false;
 	for (size_t i = 0; i < shaderInfo.size(); ++i) {
-		const ShaderInfo *next = i + 1 < shaderInfo.size() ? shaderInfo[i + 1] : nullptr;
+		// Simple per-pixel shaders following this one can run in the same pass, saving a full-screen
+		// read and write each.
+		std::vector<const ShaderInfo *> fused;
+		while (i + 1 + fused.size() < shaderInfo.size() && CanFusePostShader(shaderInfo[i], shaderInfo[i + 1 + fused.size()])) {
+			fused.push_back(shaderInfo[i + 1 + fused.size()]);
+		}
+
 		Draw::Pipeline *postPipeline = nullptr;
+		if (!fused.empty()) {
+			std::vector<const ShaderInfo *> passes{ shaderInfo[i] };
+			passes.insert(passes.end(), fused.begin(), fused.end());
+			if (!CompileFusedPostShader(passes, &postPipeline)) {
+				// Just run them separately, then.
+				fused.clear();
+			}
+		}
+
+		size_t nextIndex = i + 1 + fused.size();
+		const ShaderInfo *next = nextIndex < shaderInfo.size() ? shaderInfo[nextIndex] : nullptr;
 		if (!BuildPostShader(shaderInfo[i], next, &postPipeline)) {
 			DestroyPostShader();
 			return false;
 		}
 		_dbg_assert_(postPipeline);
+		for (const ShaderInfo *info : fused) {
+			fusedShaderInfo_.push_back(*info);
+			for (int j = 0; j < 4; ++j) {
+				fusedShaderSettings_.push_back(GetShaderSettingValue(info, j, settingValueSuffixes[j]));
+			}
+		}
 		postShaderPipelines_.push_back(postPipeline);
 		postShaderInfo_.push_back(*shaderInfo[i]);
 		if (shaderInfo[i]->usePreviousFrame) {
 			usePreviousFrame = true;
 			usePreviousAtOutputResolution = shaderInfo[i]->outputResolution;
 		}
+		i = nextIndex - 1;
 	}
 
 	if (usePreviousFrame) {
@@ -339,16 +477,6 @@ bool PresentationCommon::CompilePostShader(const ShaderInfo *shaderInfo, Draw::P
 		return false;
 	}
 
-	UniformBufferDesc postShaderDesc{ sizeof(PostShaderUniforms), {
-		{ "gl_HalfPixel", 0, -1, UniformType::FLOAT4, offsetof(PostShaderUniforms, gl_HalfPixel) },
-		{ "u_texelDelta", 1, 1, UniformType::FLOAT2, offsetof(PostShaderUniforms, texelDelta) },
-		{ "u_pixelDelta", 2, 2, UniformType::FLOAT2, offsetof(PostShaderUniforms, pixelDelta) },
-		{ "u_time", 3, 3, UniformType::FLOAT4, offsetof(PostShaderUniforms, time) },
-		{ "u_timeDelta", 4, 4, UniformType::FLOAT4, offsetof(PostShaderUniforms, timeDelta) },
-		{ "u_setting", 5, 5, UniformType::FLOAT4, offsetof(PostShaderUniforms, setting) },
-		{ "u_video", 6, 6, UniformType::FLOAT1, offsetof(PostShaderUniforms, video) },
-	} };
-
 	Draw::Pipeline *pipeline = CreatePipeline({ vs, fs }, true, &postShaderDesc);
 
 	fs->Release();
@@ -361,8 +489,91 @@ bool PresentationCommon::CompilePostShader(const ShaderInfo *shaderInfo, Draw::P
 	return true;
 }
 
+bool PresentationCommon::CompileFusedPostShader(const std::vector<const ShaderInfo *> &passes, Draw::Pipeline **outPipeline) const {
+	_assert_(passes.size() >= 2);
+
+	std::string vsSourceGLSL = ReadShaderSrc(passes[0]->vertexShaderFile);
+	if (vsSourceGLSL.empty()) {
+		return false;
+	}
+
+	// The standard declarations go first, once. Each pass then becomes a function, run in order,
+	// and the per-pixel ones read the color from the previous instead of sampling.
+	std::string fsSourceGLSL =
+		"#ifdef GL_ES\n"
+		"precision mediump float;\n"
+		"precision mediump int;\n"
+		"#endif\n";
+	for (const char *decl : standardPostShaderDecls) {
+		fsSourceGLSL += std::string(decl) + "\n";
+	}
+	fsSourceGLSL += "vec4 ppsspp_input;\n";
+	fsSourceGLSL += "vec4 ppsspp_prev(vec2 uv) { return ppsspp_input; }\n";
+
+	std::string mainSource = "void main() {\n";
+	for (size_t i = 0; i < passes.size(); ++i) {
+		std::string src = ReadShaderSrc(passes[i]->fragmentShaderFile);
+		if (src.empty() || src.find("#version") != std::string::npos) {
+			return false;
+		}
+		src = StripStandardPostShaderDecls(src);
+
+		std::string passName = StringFromFormat("ppsspp_pass%d", (int)i);
+		src = ReplaceWord(src, "main", passName);
+		if (i != 0) {
+			src = ReplaceInputSamples(src, "ppsspp_prev(");
+			if (ContainsWord(src, "sampler0")) {
+				// Uses the input in some way we can't redirect, not really per-pixel.
+				return false;
+			}
+
+			// The uniforms only have room for one set of settings, so the others are baked in.
+			std::string settingName = StringFromFormat("u_setting%d", (int)i);
+			src = ReplaceWord(src, "u_setting", settingName);
+			fsSourceGLSL += StringFromFormat("const vec4 %s = vec4(%g, %g, %g, %g);\n", settingName.c_str(),
+				GetShaderSettingValue(passes[i], 0, settingValueSuffixes[0]), GetShaderSettingValue(passes[i], 1, settingValueSuffixes[1]),
+				GetShaderSettingValue(passes[i], 2, settingValueSuffixes[2]), GetShaderSettingValue(passes[i], 3, settingValueSuffixes[3]));
+			mainSource += "\tppsspp_input = gl_FragColor;\n";
+		}
+		fsSourceGLSL += src + "\n";
+		mainSource += "\t" + passName + "();\n";
+	}
+	fsSourceGLSL += mainSource + "}\n";
+
+	std::string vsError;
+	std::string fsError;
+	Draw::ShaderModule *vs = CompileShaderModule(ShaderStage::Vertex, GLSL_1xx, vsSourceGLSL, &vsError);
+	Draw::ShaderModule *fs = CompileShaderModule(ShaderStage::Fragment, GLSL_1xx, fsSourceGLSL, &fsError);
+	if (!fs || !vs) {
+		// Not an error as such, the caller will fall back to separate passes.
+		INFO_LOG(Log::FrameBuf, "Unable to fuse post-processing shaders starting at %s:\n%s\n%s", passes[0]->section.c_str(), vsError.c_str(), fsError.c_str());
+		return false;
+	}
+
+	Draw::Pipeline *pipeline = CreatePipeline({ vs, fs }, true, &postShaderDesc);
+	fs->Release();
+	vs->Release();
+
+	if (!pipeline)
+		return false;
+
+	*outPipeline = pipeline;
+	return true;
+}
+
+bool PresentationCommon::FusedPostShaderSettingsChanged() const {
+	for (size_t i = 0; i < fusedShaderInfo_.size(); ++i) {
+		for (int j = 0; j < 4; ++j) {
+			if (GetShaderSettingValue(&fusedShaderInfo_[i], j, settingValueSuffixes[j]) != fusedShaderSettings_[i * 4 + j])
+				return true;
+		}
+	}
+	return false;
+}
+
 bool PresentationCommon::BuildPostShader(const ShaderInfo * shaderInfo, const ShaderInfo * next, Draw::Pipeline **outPipeline) {
-	if (!CompilePostShader(shaderInfo, outPipeline)) {
+	// Might already have been compiled, fused with the following passes.
+	if (!*outPipeline && !CompilePostShader(shaderInfo, outPipeline)) {
 		return false;
 	}
 
@@ -557,6 +768,8 @@ void PresentationCommon::DestroyPostShader() {
 	DoReleaseVector(postShaderFramebuffers_);
 	DoReleaseVector(previousFramebuffers_);
 	postShaderInfo_.clear();
+	fusedShaderInfo_.clear();
+	fusedShaderSettings_.clear();
 	postShaderFBOUsage_.clear();
 }
 
@@ -634,6 +847,11 @@ void PresentationCommon::UpdateUniforms(bool hasVideo) {
 void PresentationCommon::CopyToOutput(OutputFlags flags, int uvRotation, float u0, float v0, float u1, float v1) {
 	draw_->Invalidate(InvalidationFlags::CACHED_RENDER_STATE);
 
+	// Settings of fused passes are baked into the shader, so we need to rebuild when they change.
+	if (usePostShader_ && FusedPostShaderSettingsChanged()) {
+		UpdatePostShader();
+	}
+
 	// TODO: If shader objects have been created by now, we might have received errors.
 	// GLES can have the shader fail later, shader->failed / shader->error.
 	// This should auto-disable usePostShader_ and call ShowPostShaderError().
@@ -830,7 +1048,10 @@ void PresentationCommon::CopyToOutput(OutputFlags flags, int uvRotation, float u
 				postShaderFramebuffer = previousFramebuffers_[previousIndex_];
 			}
 
-			draw_->BindFramebufferAsRenderTarget(postShaderFramebuffer, { Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, "PostShader");
+			// Numbered, so GPU timings can tell the passes apart.  The tag has to stay valid, so no formatting.
+			static const char *const postShaderTags[] = { "PostShader1", "PostShader2", "PostShader3", "PostShader4", "PostShader5", "PostShader6", "PostShader7", "PostShader8" };
+			const char *postShaderTag = i < ARRAY_SIZE(postShaderTags) ? postShaderTags[i] : "PostShader";
+			draw_->BindFramebufferAsRenderTarget(postShaderFramebuffer, { Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, postShaderTag);
 
 			// Pick vertices 8-11 for the first pass.
 			int vertOffset = i == 0 ? (int)sizeof(Vertex) * 8 : (int)sizeof(Vertex) * 4;
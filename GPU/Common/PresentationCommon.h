@@ -132,7 +132,9 @@ class PresentationCommon {
 	Draw::ShaderModule *CompileShaderModule(ShaderStage stage, ShaderLanguage lang, const std::string &src, std::string *errorString) const;
 	Draw::Pipeline *CreatePipeline(std::vector<Draw::ShaderModule *> shaders, bool postShader, const UniformBufferDesc *uniformDesc) const;
 	bool CompilePostShader(const ShaderInfo *shaderInfo, Draw::Pipeline **outPipeline) const;
+	bool CompileFusedPostShader(const std::vector<const ShaderInfo *> &passes, Draw::Pipeline **outPipeline) const;
 	bool BuildPostShader(const ShaderInfo *shaderInfo, const ShaderInfo *next, Draw::Pipeline **outPipeline);
+	bool FusedPostShaderSettingsChanged() const;
 	bool AllocateFramebuffer(int w, int h);
 
 	bool BindSource(int binding, bool bindStereo);
@@ -151,6 +153,9 @@ class PresentationCommon {
 	std::vector<Draw::Framebuffer *> postShaderFramebuffers_;
 	std::vector<ShaderInfo> postShaderInfo_;
 	std::vector<Draw::Framebuffer *> previousFramebuffers_;
+	// Passes that were fused into the one before them, and the settings baked into that shader.
+	std::vector<ShaderInfo> fusedShaderInfo_;
+	std::vector<float> fusedShaderSettings_;
 	
 	Draw::Pipeline *stereoPipeline_ = nullptr;
 	ShaderInfo *stereoShaderInfo_ = nullptr;
@@ -23,13 +23,17 @@
 
 #include "ext/basis_universal/basisu_transcoder.h"
 #include "ext/basis_universal/basisu_file_headers.h"
+#include "ext/xxhash.h"
 
 #include "GPU/Common/ReplacedTexture.h"
 #include "GPU/Common/TextureReplacer.h"
 
 #include "Common/Data/Format/DDSLoad.h"
+#include "Common/Data/Format/DDSSave.h"
 #include "Common/Data/Format/ZIMLoad.h"
 #include "Common/Data/Format/PNGLoad.h"
+#include "Common/File/FileUtil.h"
+#include "Common/StringUtils.h"
 #include "Common/Thread/ParallelLoop.h"
 #include "Common/Thread/Waitable.h"
 #include "Common/Thread/ThreadManager.h"
@@ -38,6 +42,9 @@
 
 #define MK_FOURCC(str) (str[0] | ((uint8_t)str[1] << 8) | ((uint8_t)str[2] << 16) | ((uint8_t)str[3] << 24))
 
+// Transcoded DDS files store this, the hash of the source PNG and the alpha status in the reserved header words.
+#define TRANSCODE_MAGIC MK_FOURCC("PPTC")
+
 static ReplacedImageType IdentifyMagic(const uint8_t magic[4]) {
 	if (memcmp((const char *)magic, "ZIMG", 4) == 0)
 		return ReplacedImageType::ZIM;
@@ -134,6 +141,10 @@ void ReplacedTexture::PurgeIfNotUsedSinceTime(double t) {
 	}
 
 	data_.clear();
+	// Prepare() gets new references when reloading, and this also drops any mappings.
+	for (auto &level : levels_) {
+		vfs_->ReleaseFile(level.fileRef);
+	}
 	levels_.clear();
 	fmt = Draw::DataFormat::UNDEFINED;
 	alphaStatus_ = ReplacedTextureAlpha::UNKNOWN;
@@ -212,7 +223,36 @@ void ReplacedTexture::Prepare(VFSBackend *vfs) {
 	if (desc_.filenames.empty()) {
 		result = LoadLevelResult::DONE;
 	}
-	for (int i = 0; i < std::min(MAX_REPLACEMENT_MIP_LEVELS, (int)desc_.filenames.size()); ++i) {
+
+	// If we've block compressed this PNG before and it hasn't changed since, skip decoding it.
+	// Only the top level file is hashed, separate mip files are assumed to change along with it.
+	Path transcodePath;
+	uint64_t sourceHash = 0;
+	bool loadedTranscoded = false;
+	if (!desc_.transcodeDir.empty() && !desc_.filenames.empty() && endsWithNoCase(desc_.filenames[0], ".png")) {
+		VFSFileReference *fileRef = vfs_->GetFile(desc_.filenames[0].c_str());
+		size_t fileSize;
+		VFSOpenFile *openFile = fileRef ? vfs_->OpenFileForRead(fileRef, &fileSize) : nullptr;
+		if (openFile) {
+			std::string pngdata;
+			pngdata.resize(fileSize);
+			pngdata.resize(vfs_->Read(openFile, &pngdata[0], fileSize));
+			vfs_->CloseFile(openFile);
+			sourceHash = XXH3_64bits(pngdata.data(), pngdata.size());
+
+			const std::string &name = desc_.filenames[0];
+			transcodePath = desc_.transcodeDir / (name.substr(0, name.size() - 4) + ".dds");
+			loadedTranscoded = LoadTranscoded(transcodePath, sourceHash);
+			if (loadedTranscoded) {
+				result = LoadLevelResult::DONE;
+			}
+		}
+		if (fileRef) {
+			vfs_->ReleaseFile(fileRef);
+		}
+	}
+
+	for (int i = 0; !loadedTranscoded && i < std::min(MAX_REPLACEMENT_MIP_LEVELS, (int)desc_.filenames.size()); ++i) {
 		if (State() == ReplacementState::CANCEL_INIT) {
 			break;
 		}
@@ -270,6 +310,10 @@ void ReplacedTexture::Prepare(VFSBackend *vfs) {
 		return;
 	}
 
+	if (!transcodePath.empty() && !loadedTranscoded && fmt == Draw::DataFormat::R8G8B8A8_UNORM) {
+		Transcode(transcodePath, sourceHash);
+	}
+
 	// Update the level dimensions.
 	for (auto &level : levels_) {
 		level.fullW = (level.w * desc_.w) / desc_.newW;
@@ -581,12 +625,40 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 
 		data_.resize(numMips);
 
+		// If the file is a loose file or stored uncompressed in a zip, we can skip the copy
+		// and upload straight from the mapping. That requires all the levels to be present.
+		size_t headerSize = sizeof(header) + (ddsDX10 ? sizeof(header10) : 0);
+		size_t mappedSize = 0;
+		const uint8_t *mapped = vfs_->MapFile(fileRef, &mappedSize);
+		if (mapped) {
+			size_t totalSize = headerSize;
+			int w = level.w, h = level.h;
+			for (int i = 0; i < numMips; i++) {
+				totalSize += RoundUpTo4(w) * RoundUpTo4(h) * blockSize / 16;
+				w = std::max(w / 2, 1);
+				h = std::max(h / 2, 1);
+			}
+			if (totalSize > mappedSize) {
+				mapped = nullptr;
+			}
+		}
+
 		// A DDS File can contain multiple mipmaps.
 		levels_.reserve(numMips);
+		const uint8_t *mappedLevel = mapped ? mapped + headerSize : nullptr;
 		for (int i = 0; i < numMips; i++) {
 			std::vector<uint8_t> &out = data_[mipLevel + i];
 
 			int bytesToRead = RoundUpTo4(level.w) * RoundUpTo4(level.h) * blockSize / 16;
+			if (mappedLevel) {
+				level.mappedData = mappedLevel;
+				mappedLevel += bytesToRead;
+				levels_.push_back(level);
+				level.w = std::max(level.w / 2, 1);
+				level.h = std::max(level.h / 2, 1);
+				level.fileRef = nullptr;
+				continue;
+			}
 			out.resize(bytesToRead);
 
 			size_t read_bytes = vfs_->Read(openFile, &out[0], bytesToRead);
@@ -597,8 +669,7 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 			levels_.push_back(level);
 			level.w = std::max(level.w / 2, 1);
 			level.h = std::max(level.h / 2, 1);
-			if (i != 0)
-				level.fileRef = nullptr;  // We only provide a fileref on level 0 if we have mipmaps.
+			level.fileRef = nullptr;  // We only provide a fileref on level 0 if we have mipmaps.
 		}
 		vfs_->CloseFile(openFile);
 
@@ -706,6 +777,104 @@ ReplacedTexture::LoadLevelResult ReplacedTexture::LoadLevelData(VFSFileReference
 	return LoadLevelResult::LOAD_ERROR;
 }
 
+bool ReplacedTexture::LoadTranscoded(const Path &path, uint64_t sourceHash) {
+	FILE *f = File::OpenCFile(path, "rb");
+	if (!f) {
+		return false;
+	}
+
+	DDSHeader header;
+	bool good = fread(&header, sizeof(header), 1, f) == 1;
+	good = good && header.dwMagic == MK_FOURCC("DDS ") && header.dwReserved1[0] == TRANSCODE_MAGIC;
+	good = good && header.dwReserved1[1] == (uint32_t)sourceHash && header.dwReserved1[2] == (uint32_t)(sourceHash >> 32);
+	good = good && header.dwMipMapCount >= 1 && header.dwMipMapCount <= MAX_REPLACEMENT_MIP_LEVELS;
+	good = good && header.dwWidth > 0 && header.dwWidth <= 16384 && header.dwHeight > 0 && header.dwHeight <= 16384;
+
+	Draw::DataFormat format = Draw::DataFormat::UNDEFINED;
+	if (good && header.ddspf.dwFourCC == MK_FOURCC("DXT1")) {
+		format = Draw::DataFormat::BC1_RGBA_UNORM_BLOCK;
+	} else if (good && header.ddspf.dwFourCC == MK_FOURCC("DXT5")) {
+		format = Draw::DataFormat::BC3_UNORM_BLOCK;
+	}
+
+	if (format == Draw::DataFormat::UNDEFINED) {
+		// Stale or foreign file, we'll overwrite it after decoding the PNG.
+		fclose(f);
+		return false;
+	}
+
+	int blockSize = 0;
+	Draw::DataFormatIsBlockCompressed(format, &blockSize);
+
+	std::vector<std::vector<uint8_t>> data(header.dwMipMapCount);
+	std::vector<ReplacedTextureLevel> levels;
+	ReplacedTextureLevel level;
+	level.w = header.dwWidth;
+	level.h = header.dwHeight;
+	for (uint32_t i = 0; i < header.dwMipMapCount; i++) {
+		size_t bytesToRead = RoundUpTo4(level.w) * RoundUpTo4(level.h) * blockSize / 16;
+		data[i].resize(bytesToRead);
+		if (fread(&data[i][0], 1, bytesToRead, f) != bytesToRead) {
+			WARN_LOG(Log::TexReplacement, "Transcoded replacement '%s' is truncated", path.c_str());
+			fclose(f);
+			return false;
+		}
+		levels.push_back(level);
+		level.w = std::max(level.w / 2, 1);
+		level.h = std::max(level.h / 2, 1);
+	}
+	fclose(f);
+
+	data_ = std::move(data);
+	levels_ = std::move(levels);
+	fmt = format;
+	alphaStatus_ = (ReplacedTextureAlpha)header.dwReserved1[3];
+	return true;
+}
+
+// Block compresses the decoded levels, uses them from now on, and saves them for the next run.
+void ReplacedTexture::Transcode(const Path &path, uint64_t sourceHash) {
+	if ((levels_[0].w & 3) != 0 || (levels_[0].h & 3) != 0) {
+		// D3D11 can't take these without padding, let's not bother.
+		return;
+	}
+
+	// BC1 can't do partial alpha, and we only write four-color blocks anyway.
+	const bool opaque = alphaStatus_ == ReplacedTextureAlpha::FULL;
+	const int blockSize = opaque ? 8 : 16;
+
+	std::vector<std::vector<uint8_t>> encoded(levels_.size());
+	for (size_t i = 0; i < levels_.size(); i++) {
+		const ReplacedTextureLevel &level = levels_[i];
+		encoded[i].resize(BCEncodedSize(level.w, level.h, blockSize));
+		if (opaque) {
+			EncodeBC1(data_[i].data(), level.w, level.h, level.w * 4, encoded[i].data());
+		} else {
+			EncodeBC3(data_[i].data(), level.w, level.h, level.w * 4, encoded[i].data());
+		}
+	}
+
+	const uint32_t userData[4] = { TRANSCODE_MAGIC, (uint32_t)sourceHash, (uint32_t)(sourceHash >> 32), (uint32_t)alphaStatus_ };
+	const uint32_t fourCC = opaque ? MK_FOURCC("DXT1") : MK_FOURCC("DXT5");
+
+	// Write to a temporary file first, so an interrupted write can't leave a truncated cache file behind.
+	// The name is per process, since several instances may share the texture pack.
+	Path tempPath = File::TempPathFor(path);
+	File::CreateFullPath(path.NavigateUp());
+	FILE *f = File::OpenCFile(tempPath, "wb");
+	if (f) {
+		bool success = SaveDDS(f, levels_[0].w, levels_[0].h, fourCC, encoded, userData, 4);
+		fclose(f);
+		if (!success || !File::ReplaceFile(tempPath, path)) {
+			WARN_LOG(Log::TexReplacement, "Failed to save transcoded replacement '%s'", path.c_str());
+			File::Delete(tempPath);
+		}
+	}
+
+	data_ = std::move(encoded);
+	fmt = opaque ? Draw::DataFormat::BC1_RGBA_UNORM_BLOCK : Draw::DataFormat::BC3_UNORM_BLOCK;
+}
+
 bool ReplacedTexture::CopyLevelTo(int level, uint8_t *out, size_t outDataSize, int rowPitch) {
 	_assert_msg_((size_t)level < levels_.size(), "Invalid miplevel");
 	_assert_msg_(out != nullptr && rowPitch > 0, "Invalid out/pitch");
@@ -726,9 +895,17 @@ bool ReplacedTexture::CopyLevelTo(int level, uint8_t *out, size_t outDataSize, i
 	std::lock_guard<std::mutex> guard(lock_);
 
 	const ReplacedTextureLevel &info = levels_[level];
-	const std::vector<uint8_t> &data = data_[level];
+	const uint8_t *data = data_[level].data();
+	size_t dataSize = data_[level].size();
+	if (info.mappedData) {
+		// Block compressed levels may point into a mapped file instead, see LoadLevelData.
+		int blockSize = 0;
+		Draw::DataFormatIsBlockCompressed(fmt, &blockSize);
+		data = info.mappedData;
+		dataSize = (size_t)RoundUpTo4(info.w) * RoundUpTo4(info.h) * blockSize / 16;
+	}
 
-	if (data.empty()) {
+	if (dataSize == 0) {
 		WARN_LOG(Log::TexReplacement, "Level %d is empty", level);
 		return false;
 	}
@@ -747,13 +924,13 @@ bool ReplacedTexture::CopyLevelTo(int level, uint8_t *out, size_t outDataSize, i
 			return false;
 		}
 
-		_assert_msg_(data.size() == info.w * info.h * 4, "Data has wrong size");
+		_assert_msg_(dataSize == info.w * info.h * 4, "Data has wrong size");
 
 		if (rowPitch == info.w * 4) {
 #ifdef PARALLEL_COPY
-			ParallelMemcpy(&g_threadManager, out, data.data(), info.w * 4 * info.h);
+			ParallelMemcpy(&g_threadManager, out, data, info.w * 4 * info.h);
 #else
-			memcpy(out, data.data(), info.w * 4 * info.h);
+			memcpy(out, data, info.w * 4 * info.h);
 #endif
 		} else {
 #ifdef PARALLEL_COPY
@@ -761,7 +938,7 @@ bool ReplacedTexture::CopyLevelTo(int level, uint8_t *out, size_t outDataSize, i
 			ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
 				int extraPixels = outW - info.w;
 				for (int y = l; y < h; ++y) {
-					memcpy((uint8_t *)out + rowPitch * y, data.data() + info.w * 4 * y, info.w * 4);
+					memcpy((uint8_t *)out + rowPitch * y, data + info.w * 4 * y, info.w * 4);
 					// Fill the rest of the line with black.
 					memset((uint8_t *)out + rowPitch * y + info.w * 4, 0, extraPixels * 4);
 				}
@@ -769,7 +946,7 @@ bool ReplacedTexture::CopyLevelTo(int level, uint8_t *out, size_t outDataSize, i
 #else
 			int extraPixels = outW - info.w;
 			for (int y = 0; y < info.h; ++y) {
-				memcpy((uint8_t *)out + rowPitch * y, data.data() + info.w * 4 * y, info.w * 4);
+				memcpy((uint8_t *)out + rowPitch * y, data + info.w * 4 * y, info.w * 4);
 				memset((uint8_t *)out + rowPitch * y + info.w * 4, 0, extraPixels * 4);
 			}
 #endif
@@ -784,7 +961,7 @@ bool ReplacedTexture::CopyLevelTo(int level, uint8_t *out, size_t outDataSize, i
 		// Only parallel copy in the simple case for now.
 		if (info.w == outW && info.h == outH) {
 			// TODO: Add sanity checks here for other formats?
-			ParallelMemcpy(&g_threadManager, out, data.data(), data.size());
+			ParallelMemcpy(&g_threadManager, out, data, dataSize);
 			return true;
 		}
 #endif
@@ -798,7 +975,7 @@ bool ReplacedTexture::CopyLevelTo(int level, uint8_t *out, size_t outDataSize, i
 
 		// Copy all the known blocks, and zero-fill out the lines.
 		for (int y = 0; y < inBlocksH; y++) {
-			const uint8_t *input = data.data() + y * inBlocksW * blockSize;
+			const uint8_t *input = data + y * inBlocksW * blockSize;
 			uint8_t *output = (uint8_t *)out + y * outBlocksW * blockSize;
 			memcpy(output, input, inBlocksW * blockSize);
 			memset(output + inBlocksW * blockSize, 0, paddingBlocksX * blockSize);
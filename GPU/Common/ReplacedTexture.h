@@ -79,6 +79,8 @@ struct ReplacementDesc {
 	TextureFiltering forceFiltering;
 	std::string hashfiles;
 	Path basePath;
+	// If not empty, PNG replacements are block compressed on first load and cached in this directory.
+	Path transcodeDir;
 	std::vector<std::string> filenames;
 	std::string logId;
 	GPUFormatSupport formatSupport;
@@ -107,6 +109,10 @@ struct ReplacedTextureLevel {
 	// To be able to reload, we need to be able to reopen, unfortunate we can't use zip_file_t.
 	// TODO: This really belongs on the level in the cache, not in the individual ReplacedTextureLevel objects.
 	VFSFileReference *fileRef = nullptr;
+
+	// If set, the level data is read straight from a memory mapped file instead of data_.
+	// The mapping belongs to the level 0 fileRef and lives until that's released.
+	const uint8_t *mappedData = nullptr;
 };
 
 class ReplacedTexture {
@@ -187,6 +193,8 @@ class ReplacedTexture {
 
 	void Prepare(VFSBackend *vfs);
 	LoadLevelResult LoadLevelData(VFSFileReference *fileRef, const std::string &filename, int level, Draw::DataFormat *pixelFormat);
+	bool LoadTranscoded(const Path &path, uint64_t sourceHash);
+	void Transcode(const Path &path, uint64_t sourceHash);
 	void PurgeIfNotUsedSinceTime(double t);
 
 	std::vector<std::vector<uint8_t>> data_;
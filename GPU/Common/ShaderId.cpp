@@ -1,10 +1,16 @@
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <array>
+#include <set>
 
 #include "Common/GPU/thin3d.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/Log.h"
 #include "Common/StringUtils.h"
 #include "Core/Config.h"
+#include "Core/System.h"
 
 #include "GPU/ge_constants.h"
 #include "GPU/GPU.h"
@@ -196,6 +202,7 @@ std::string FragmentShaderDesc(const FShaderID &id) {
 	if (id.Bit(FS_BIT_BGRA_TEXTURE)) desc << "BGRA ";
 	if (id.Bit(FS_BIT_UBERSHADER)) desc << "FragUber ";
 	if (id.Bit(FS_BIT_DEPTH_TEST_NEVER)) desc << "DepthNever ";
+	if (id.Bit(FS_BIT_GENERIC_TESTS)) desc << "GenericTests ";
 	switch ((ShaderDepalMode)id.Bits(FS_BIT_SHADER_DEPAL_MODE, 2)) {
 	case ShaderDepalMode::OFF: break;
 	case ShaderDepalMode::NORMAL: desc << "Depal ";  break;
@@ -276,6 +283,37 @@ bool FragmentIdNeedsFramebufferRead(const FShaderID &id) {
 		(ReplaceBlendType)id.Bits(FS_BIT_REPLACE_BLEND, 3) == REPLACE_BLEND_READ_FRAMEBUFFER;
 }
 
+bool GetGenericTestsFragmentShaderID(const FShaderID &id, FShaderID *generic) {
+	if (id.Bit(FS_BIT_CLEARMODE) || id.Bit(FS_BIT_GENERIC_TESTS))
+		return false;
+	if (!id.Bit(FS_BIT_ALPHA_TEST) && !id.Bit(FS_BIT_COLOR_TEST))
+		return false;
+
+	FShaderID out = id;
+	out.SetBit(FS_BIT_ALPHA_TEST, false);
+	out.SetBits(FS_BIT_ALPHA_TEST_FUNC, 3, 0);
+	out.SetBit(FS_BIT_ALPHA_AGAINST_ZERO, false);
+	out.SetBit(FS_BIT_COLOR_TEST, false);
+	out.SetBits(FS_BIT_COLOR_TEST_FUNC, 2, 0);
+	out.SetBit(FS_BIT_COLOR_AGAINST_ZERO, false);
+	out.SetBit(FS_BIT_TEST_DISCARD_TO_ZERO, false);
+	out.SetBit(FS_BIT_GENERIC_TESTS);
+	*generic = out;
+	return true;
+}
+
+uint32_t PackFragmentTestFlags(const FShaderID &id) {
+	// Must match the decoding in the fragment shader generator.
+	uint32_t flags = 0;
+	if (id.Bit(FS_BIT_ALPHA_TEST))
+		flags |= 0x08 | id.Bits(FS_BIT_ALPHA_TEST_FUNC, 3);
+	if (id.Bit(FS_BIT_COLOR_TEST))
+		flags |= 0x40 | (id.Bits(FS_BIT_COLOR_TEST_FUNC, 2) << 4);
+	if (id.Bit(FS_BIT_TEST_DISCARD_TO_ZERO))
+		flags |= 0x80;
+	return flags;
+}
+
 inline u32 SanitizeBlendMode(GEBlendMode mode) {
 	if (mode > GE_BLENDMODE_ABSDIFF)
 		return GE_BLENDMODE_MUL_AND_ADD;  // Not sure what the undefined modes are.
@@ -471,3 +509,120 @@ void ComputeGeometryShaderID(GShaderID *id_out, const Draw::Bugs &bugs, int prim
 
 	*id_out = id;
 }
+
+#define SHADER_ID_LIST_MAGIC 0x44495350  // "PSID"
+// Bump this when the meaning of any VShaderBit or FShaderBit changes.
+#define SHADER_ID_LIST_VERSION 1
+// The lists we read are from our own files, but they're user accessible.
+#define SHADER_ID_LIST_MAX 4096
+
+struct ShaderIDListHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numVertexShaders;
+	uint32_t numFragmentShaders;
+};
+
+Path ShaderIDListPath(const std::string &discID) {
+	return GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".shaderids");
+}
+
+bool LoadShaderIDList(const Path &filename, ShaderIDList *list) {
+	list->vertex.clear();
+	list->fragment.clear();
+
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return false;
+
+	ShaderIDListHeader header{};
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	success = success && header.magic == SHADER_ID_LIST_MAGIC && header.version == SHADER_ID_LIST_VERSION;
+	success = success && header.numVertexShaders <= SHADER_ID_LIST_MAX && header.numFragmentShaders <= SHADER_ID_LIST_MAX;
+	if (success) {
+		list->vertex.resize(header.numVertexShaders);
+		list->fragment.resize(header.numFragmentShaders);
+		success = fread(list->vertex.data(), sizeof(VShaderID), list->vertex.size(), f) == list->vertex.size();
+		success = success && fread(list->fragment.data(), sizeof(FShaderID), list->fragment.size(), f) == list->fragment.size();
+	}
+	fclose(f);
+
+	if (!success) {
+		WARN_LOG(Log::G3D, "Ignoring bad or old shader ID list '%s'", filename.c_str());
+		list->vertex.clear();
+		list->fragment.clear();
+	}
+	return success;
+}
+
+// The new ones go first, so if we hit the limit it's old ones that are dropped.
+template <class T>
+static int MergeShaderIDs(const std::vector<T> &ids, std::vector<T> *old) {
+	std::set<T> seen(old->begin(), old->end());
+	std::vector<T> merged;
+	int added = 0;
+	for (const T &id : ids) {
+		if (merged.size() < SHADER_ID_LIST_MAX && seen.insert(id).second) {
+			merged.push_back(id);
+			added++;
+		}
+	}
+	if (added == 0)
+		return 0;
+	for (const T &id : *old) {
+		if (merged.size() >= SHADER_ID_LIST_MAX)
+			break;
+		merged.push_back(id);
+	}
+	*old = std::move(merged);
+	return added;
+}
+
+void SaveShaderIDList(const Path &filename, const ShaderIDList &list) {
+	ShaderIDList merged;
+	LoadShaderIDList(filename, &merged);
+	int added = MergeShaderIDs(list.vertex, &merged.vertex);
+	added += MergeShaderIDs(list.fragment, &merged.fragment);
+	if (added == 0)
+		return;
+
+	Path tempPath = File::TempPathFor(filename);
+	FILE *f = File::OpenCFile(tempPath, "wb");
+	if (!f)
+		return;
+	ShaderIDListHeader header{ SHADER_ID_LIST_MAGIC, SHADER_ID_LIST_VERSION, (uint32_t)merged.vertex.size(), (uint32_t)merged.fragment.size() };
+	fwrite(&header, sizeof(header), 1, f);
+	fwrite(merged.vertex.data(), sizeof(VShaderID), merged.vertex.size(), f);
+	fwrite(merged.fragment.data(), sizeof(FShaderID), merged.fragment.size(), f);
+	fclose(f);
+	if (!File::ReplaceFile(tempPath, filename)) {
+		File::Delete(tempPath);
+		return;
+	}
+	INFO_LOG(Log::G3D, "Saved %d new shader IDs to '%s'", added, filename.c_str());
+}
+
+void FilterShaderIDList(ShaderIDList *list) {
+	const bool stereo = gstate_c.Use(GPU_USE_SINGLE_PASS_STEREO);
+	const bool lightUbershader = gstate_c.Use(GPU_USE_LIGHT_UBERSHADER);
+	const bool fragmentUbershader = gstate_c.Use(GPU_USE_FRAGMENT_UBERSHADER);
+	const bool arrays = gstate_c.Use(GPU_USE_FRAMEBUFFER_ARRAYS);
+	const bool fetch = gstate_c.Use(GPU_USE_FRAMEBUFFER_FETCH);
+
+	auto &vertex = list->vertex;
+	vertex.erase(std::remove_if(vertex.begin(), vertex.end(), [&](const VShaderID &id) {
+		// Clearly corrupt, see the GLES cache.
+		if (id.Bit(VS_BIT_IS_THROUGH) && id.Bit(VS_BIT_USE_HW_TRANSFORM))
+			return true;
+		return (id.Bit(VS_BIT_SIMPLE_STEREO) && !stereo) || (id.Bit(VS_BIT_LIGHT_UBERSHADER) && !lightUbershader);
+	}), vertex.end());
+
+	auto &fragment = list->fragment;
+	fragment.erase(std::remove_if(fragment.begin(), fragment.end(), [&](const FShaderID &id) {
+		if (id.Bit(FS_BIT_STEREO) && !stereo)
+			return true;
+		if (id.Bit(FS_BIT_UBERSHADER) && !fragmentUbershader)
+			return true;
+		return (id.Bit(FS_BIT_SAMPLE_ARRAY_TEXTURE) && !arrays) || (id.Bit(FS_BIT_USE_FRAMEBUFFER_FETCH) && !fetch);
+	}), fragment.end());
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <cstring>
 #include <cstdint>
+#include <vector>
 
 #include "Common/CommonFuncs.h"
 
@@ -103,6 +104,7 @@ enum FShaderBit : uint8_t {
 	FS_BIT_USE_FRAMEBUFFER_FETCH = 59,
 	FS_BIT_UBERSHADER = 60,
 	FS_BIT_DEPTH_TEST_NEVER = 61,  // Only used on Mali. Set when depth == NEVER. We forcibly avoid writing to depth in this case, since it crashes the driver.
+	FS_BIT_GENERIC_TESTS = 62,  // Alpha and color test are read from u_fragTestFlags. Only for fallback shaders, see GetGenericTestsFragmentShaderID.
 };
 
 static inline FShaderBit operator +(FShaderBit bit, int i) {
@@ -296,3 +298,28 @@ std::string GeometryShaderDesc(const GShaderID &id);
 
 // For sanity checking.
 bool FragmentIdNeedsFramebufferRead(const FShaderID &id);
+
+// A fragment shader ID with the alpha and color test bits replaced by FS_BIT_GENERIC_TESTS,
+// so that one shader covers all the test variants of id. Returns false if id doesn't use the tests.
+// Requires bitwise ops in the shader language.
+bool GetGenericTestsFragmentShaderID(const FShaderID &id, FShaderID *generic);
+// The value of u_fragTestFlags that makes a FS_BIT_GENERIC_TESTS shader behave like id.
+uint32_t PackFragmentTestFlags(const FShaderID &id);
+
+class Path;
+
+// The shaders a game has used, in a form every backend understands.  Each backend saves it next to
+// its own cache, so when there's no cache for the current backend (just switched, or it doesn't have
+// one), the shaders are still generated up front instead of stuttering in during play.
+// Compiled code (SPIR-V, DXBC, GL program binaries) isn't shared, it's specific to the backend and driver.
+struct ShaderIDList {
+	std::vector<VShaderID> vertex;
+	std::vector<FShaderID> fragment;
+};
+
+Path ShaderIDListPath(const std::string &discID);
+bool LoadShaderIDList(const Path &filename, ShaderIDList *list);
+// Adds to what's already in the file, so it collects the shaders from all backends.
+void SaveShaderIDList(const Path &filename, const ShaderIDList &list);
+// Drops the IDs that need features the current use flags rule out, they would never be looked up.
+void FilterShaderIDList(ShaderIDList *list);
@@ -33,7 +33,7 @@ struct alignas(16) UB_VS_FS_Base {
 	uint32_t spline_counts; uint32_t depal_mask_shift_off_fmt;  // 4 params packed into one.
 	uint32_t colorWriteMask; float mipBias;
 	// Fragment data
-	float texNoAlpha; float texMul; float padding[2];  // this vec4 will hold ubershader stuff. We won't use integer flags in the fragment shader.
+	float texNoAlpha; float texMul; uint32_t fragTestFlags; float padding;  // this vec4 holds ubershader stuff. fragTestFlags is only read by FS_BIT_GENERIC_TESTS shaders.
 	float fogColor[3]; uint32_t alphaColorRef;
 	float texEnvColor[3]; uint32_t colorTestMask;
 	float texClamp[4];
@@ -59,7 +59,7 @@ R"(  mat4 u_proj;
   uint u_depal_mask_shift_off_fmt;
   uint u_colorWriteMask;
   float u_mipBias;
-  vec2 u_texNoAlphaMul; float pad1; float pad2;
+  vec2 u_texNoAlphaMul; uint u_fragTestFlags; float pad2;
   vec3 u_fogcolor;  uint u_alphacolorref;
   vec3 u_texenv;    uint u_alphacolormask;
   vec4 u_texclamp;
@@ -16,6 +16,10 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "Common/Common.h"
 #include "Common/CPUDetect.h"
 #include "Common/Profiler/Profiler.h"
@@ -435,6 +439,22 @@ void SoftwareTessellation(OutputBuffers &output, const Surface &surface, u32 ori
 template void SoftwareTessellation<BezierSurface>(OutputBuffers &output, const BezierSurface &surface, u32 origVertType, const ControlPoints &points);
 template void SoftwareTessellation<SplineSurface>(OutputBuffers &output, const SplineSurface &surface, u32 origVertType, const ControlPoints &points);
 
+struct HardwareTessGrid {
+	// The knot types only affect the weights, so they don't matter here.
+	static u64 ToKey(const SurfaceInfo &surface) {
+		// Tess factors and patch counts all fit in 8 bits (after Init.)  0 is never valid.
+		u64 key = 1ULL << 40;
+		key |= (u64)(surface.tess_u & 0xFF) | ((u64)(surface.tess_v & 0xFF) << 8);
+		key |= ((u64)(surface.num_patches_u & 0xFF) << 16) | ((u64)(surface.num_patches_v & 0xFF) << 24);
+		key |= (u64)(surface.primType & 3) << 32;
+		return key;
+	}
+
+	u64 key = 0;
+	std::vector<SimpleVertex> vertices;
+	std::vector<u16> indices;
+};
+
 template<class Surface>
 static void HardwareTessellation(OutputBuffers &output, const Surface &surface, u32 origVertType,
 	const SimpleVertex *const *points, TessellationDataTransfer *tessDataTransfer) {
@@ -446,7 +466,19 @@ static void HardwareTessellation(OutputBuffers &output, const Surface &surface,
 	weights.size_v = WeightType::CalcSize(surface.tess_v, surface.num_points_v);
 	tessDataTransfer->SendDataToShader(points, surface.num_points_u, surface.num_points_v, origVertType, weights);
 
+	// The input grid only depends on the shape of the surface, not on the control points.
+	// Games with lots of patches tend to reuse the same shape, so keep the last one around.
+	static HardwareTessGrid lastGrid;
+	u64 gridKey = HardwareTessGrid::ToKey(surface);
+	if (lastGrid.key == gridKey) {
+		memcpy(output.vertices, lastGrid.vertices.data(), lastGrid.vertices.size() * sizeof(SimpleVertex));
+		memcpy(output.indices, lastGrid.indices.data(), lastGrid.indices.size() * sizeof(u16));
+		output.count = (int)lastGrid.indices.size();
+		return;
+	}
+
 	// Generating simple input vertices for the spline-computing vertex shader.
+	int numVerts = 0;
 	float inv_u = 1.0f / (float)surface.tess_u;
 	float inv_v = 1.0f / (float)surface.tess_v;
 	for (int patch_u = 0; patch_u < surface.num_patches_u; ++patch_u) {
@@ -457,7 +489,9 @@ static void HardwareTessellation(OutputBuffers &output, const Surface &surface,
 				const int index_u = surface.GetIndexU(patch_u, tile_u);
 				for (int tile_v = start_v; tile_v <= surface.tess_v; ++tile_v) {
 					const int index_v = surface.GetIndexV(patch_v, tile_v);
-					SimpleVertex &vert = output.vertices[surface.GetIndex(index_u, index_v, patch_u, patch_v)];
+					const int index = surface.GetIndex(index_u, index_v, patch_u, patch_v);
+					numVerts = std::max(numVerts, index + 1);
+					SimpleVertex &vert = output.vertices[index];
 					// Index for the weights
 					vert.pos.x = index_u;
 					vert.pos.y = index_v;
@@ -472,6 +506,10 @@ static void HardwareTessellation(OutputBuffers &output, const Surface &surface,
 		}
 	}
 	surface.BuildIndex(output.indices, output.count);
+
+	lastGrid.key = gridKey;
+	lastGrid.vertices.assign(output.vertices, output.vertices + numVerts);
+	lastGrid.indices.assign(output.indices, output.indices + output.count);
 }
 
 } // namespace Spline
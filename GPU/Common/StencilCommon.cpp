@@ -35,43 +35,52 @@ static u8 StencilBits5551(const u8 *ptr8, u32 numPixels) {
 	return 0;
 }
 
-static u8 StencilBits4444(const u8 *ptr8, u32 numPixels) {
+// Also returns the bits set in every pixel in commonBits.
+static u8 StencilBits4444(const u8 *ptr8, u32 numPixels, u8 &commonBits) {
 	const u32 *ptr = (const u32 *)ptr8;
 	u32 bits = 0;
+	u32 common = 0xFFFFFFFF;
 
 	for (u32 i = 0; i < numPixels / 2; ++i) {
 		bits |= ptr[i];
+		common &= ptr[i];
 	}
 
+	commonBits = ((common >> 12) & 0xF) & (common >> 28);
 	return ((bits >> 12) & 0xF) | (bits >> 28);
 }
 
-static u8 StencilBits8888(const u8 *ptr8, u32 numPixels) {
+static u8 StencilBits8888(const u8 *ptr8, u32 numPixels, u8 &commonBits) {
 	const u32 *ptr = (const u32 *)ptr8;
 	u32 bits = 0;
+	u32 common = 0xFFFFFFFF;
 
 	for (u32 i = 0; i < numPixels; ++i) {
 		bits |= ptr[i];
+		common &= ptr[i];
 	}
 
+	commonBits = common >> 24;
 	return bits >> 24;
 }
 
-static bool CheckStencilBits(const u8 *src, const VirtualFramebuffer *dstBuffer, int &values, u8 &usedBits) {
+static bool CheckStencilBits(const u8 *src, const VirtualFramebuffer *dstBuffer, int &values, u8 &usedBits, u8 &commonBits) {
+	commonBits = 0;
 	switch (dstBuffer->fb_format) {
 	case GE_FORMAT_565:
 		// Well, this doesn't make much sense.
 		return false;
 	case GE_FORMAT_5551:
+		// Only one pass anyway, so we don't bother with commonBits.
 		usedBits = StencilBits5551(src, dstBuffer->fb_stride * dstBuffer->bufferHeight);
 		values = 2;
 		break;
 	case GE_FORMAT_4444:
-		usedBits = StencilBits4444(src, dstBuffer->fb_stride * dstBuffer->bufferHeight);
+		usedBits = StencilBits4444(src, dstBuffer->fb_stride * dstBuffer->bufferHeight, commonBits);
 		values = 16;
 		break;
 	case GE_FORMAT_8888:
-		usedBits = StencilBits8888(src, dstBuffer->fb_stride * dstBuffer->bufferHeight);
+		usedBits = StencilBits8888(src, dstBuffer->fb_stride * dstBuffer->bufferHeight, commonBits);
 		values = 256;
 		break;
 	case GE_FORMAT_INVALID:
@@ -184,6 +193,7 @@ bool FramebufferManagerCommon::PerformWriteStencilFromMemory(u32 addr, int size,
 
 	int values = 0;
 	u8 usedBits = 0;
+	u8 commonBits = 0;
 	bool useExportShader = draw_->GetDeviceCaps().fragmentShaderStencilWriteSupported;
 
 	const u8 *src = Memory::GetPointer(addr);
@@ -191,7 +201,7 @@ bool FramebufferManagerCommon::PerformWriteStencilFromMemory(u32 addr, int size,
 		return false;
 
 	// Could skip this when doing useExportShader, but then we couldn't optimize usedBits == 0.
-	if (!CheckStencilBits(src, dstBuffer, values, usedBits))
+	if (!CheckStencilBits(src, dstBuffer, values, usedBits, commonBits))
 		return false;
 
 	if (usedBits == 0) {
@@ -325,9 +335,20 @@ bool FramebufferManagerCommon::PerformWriteStencilFromMemory(u32 addr, int size,
 		draw_->UpdateDynamicUniformBuffer(&ub, sizeof(ub));
 		draw_->DrawUP(positions, 3);
 	} else {
+		// Bits set in every pixel don't need a discard pass each, we can clear them in directly.
+		// If we also need to write alpha, keep one of their passes to cover every pixel.
+		u8 passBits = usedBits & ~commonBits;
+		if (commonBits != 0) {
+			int clearValue = dstBuffer->fb_format == GE_FORMAT_4444 ? ((commonBits << 4) | commonBits) : commonBits;
+			draw_->Clear(Aspect::STENCIL_BIT, 0, 0.0f, clearValue);
+			if (!(flags & WriteStencil::IGNORE_ALPHA)) {
+				passBits |= commonBits & -commonBits;
+			}
+		}
+
 		for (int i = 1; i < values; i += i) {
-			if (!(usedBits & i)) {
-				// It's already zero, let's skip it.
+			if (!(passBits & i)) {
+				// It's already zero (or cleared in), let's skip it.
 				continue;
 			}
 			StencilUB ub{};
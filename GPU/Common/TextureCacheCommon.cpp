@@ -18,21 +18,27 @@
 #include "ppsspp_config.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "Common/Common.h"
 #include "Common/Data/Convert/ColorConv.h"
+#include "Common/Data/Collections/FrameArena.h"
 #include "Common/Data/Collections/TinySet.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/LogReporting.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtils.h"
 #include "Common/Math/SIMDHeaders.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Common/TimeUtil.h"
 #include "Common/Math/math_util.h"
 #include "Common/GPU/thin3d.h"
 #include "Core/HDRemaster.h"
 #include "Core/Config.h"
+#include "Core/HW/Display.h"
 #include "Core/Debugger/MemBlockInfo.h"
+#include "Core/MemDirtyTracker.h"
 #include "Core/System.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
 #include "GPU/Common/TextureCacheCommon.h"
@@ -42,6 +48,7 @@
 #include "GPU/Debugger/Record.h"
 #include "GPU/GPUState.h"
 #include "Core/Util/PPGeDraw.h"
+#include "ext/xxhash.h"
 
 #include "ext/imgui/imgui.h"
 #include "ext/imgui/imgui_internal.h"
@@ -66,6 +73,14 @@
 #define TEXCACHE_MIN_PRESSURE 16 * 1024 * 1024  // Total in VRAM
 #define TEXCACHE_SECOND_MIN_PRESSURE 4 * 1024 * 1024
 
+// When over the memory budget, evict down to this fraction below it, to avoid evicting a little every frame.
+#define TEXCACHE_BUDGET_SLACK_DIVISOR 8
+
+// Below this, the threading overhead isn't worth it.
+#define PARALLEL_DECODE_MIN_PIXELS (256 * 256)
+// In 8-row blocks.
+#define PARALLEL_DECODE_MIN_BLOCK_ROWS 8
+
 // Just for reference
 
 // PSP Color formats:
@@ -114,6 +129,7 @@ TextureCacheCommon::TextureCacheCommon(Draw::DrawContext *draw, Draw2D *draw2D)
 }
 
 TextureCacheCommon::~TextureCacheCommon() {
+	Memory::DirtyTracking_Stop(Memory::DIRTY_USER_TEXTURES);
 	delete textureShaderCache_;
 
 	FreeAlignedMemory(clutBufConverted_);
@@ -126,6 +142,11 @@ void TextureCacheCommon::StartFrame() {
 	textureShaderCache_->Decimate();
 	timesInvalidatedAllThisFrame_ = 0;
 	replacementTimeThisFrame_ = 0.0;
+	atlasUsedThisFrame_ = false;
+
+	if (!g_Config.bTextureWriteTracking && Memory::DirtyTracking_Active(Memory::DIRTY_USER_TEXTURES)) {
+		Memory::DirtyTracking_Stop(Memory::DIRTY_USER_TEXTURES);
+	}
 
 	if ((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::DEBUG_STATS) {
 		gpuStats.numReplacerTrackedTex = replacer_.GetNumTrackedTextures();
@@ -141,7 +162,14 @@ void TextureCacheCommon::StartFrame() {
 		Clear(true);
 		clearCacheNextFrame_ = false;
 	} else {
-		Decimate(nullptr, false);
+		const bool pressure = IsUnderMemoryPressure();
+		if (pressure && !lowMemoryMode_) {
+			// Same as when an allocation fails, but we got here before it did.
+			WARN_LOG(Log::G3D, "Texture cache is near the GPU memory budget; switching to low memory mode");
+			lowMemoryMode_ = true;
+			decimationCounter_ = 0;
+		}
+		Decimate(nullptr, pressure);
 	}
 }
 
@@ -386,6 +414,8 @@ void TextureCacheCommon::UpdateMaxSeenV(TexCacheEntry *entry, bool throughMode)
 }
 
 TexCacheEntry *TextureCacheCommon::SetTexture() {
+	nextAtlasTexture_ = false;
+
 	u8 level = 0;
 	if (IsFakeMipmapChange()) {
 		level = std::max(0, gstate.getTexLevelOffset16() / 16);
@@ -561,6 +591,7 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 
 		if (match) {
 			// got one!
+			gpuStats.numTextureCacheHits++;
 			gstate_c.curTextureWidth = w;
 			gstate_c.curTextureHeight = h;
 			gstate_c.SetTextureIsVideo(false);
@@ -657,6 +688,7 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	}
 
 	// We have to decode it, let's setup the cache entry first.
+	gpuStats.numTextureCacheMisses++;
 	entry->addr = texaddr;
 	entry->minihash = minihash;
 	entry->dim = dim;
@@ -781,13 +813,18 @@ bool TextureCacheCommon::GetBestFramebufferCandidate(const TextureDefinition &en
 
 // Removes old textures.
 void TextureCacheCommon::Decimate(TexCacheEntry *exceptThisOne, bool forcePressure) {
+	// This is cheap when under budget, so check it every time rather than every few frames.
+	EnforceMemoryBudget(exceptThisOne);
+
 	if (--decimationCounter_ <= 0) {
 		decimationCounter_ = TEXCACHE_DECIMATION_INTERVAL;
 	} else {
 		return;
 	}
 
-	if (forcePressure || cacheSizeEstimate_ >= TEXCACHE_MIN_PRESSURE) {
+	// With a memory budget, EnforceMemoryBudget does the evicting and we only kill by age when forced.
+	const bool hasBudget = CacheMemoryBudget() != 0;
+	if (forcePressure || (!hasBudget && cacheSizeEstimate_ >= TEXCACHE_MIN_PRESSURE)) {
 		const u32 had = cacheSizeEstimate_;
 
 		ForgetLastTexture();
@@ -820,9 +857,7 @@ void TextureCacheCommon::Decimate(TexCacheEntry *exceptThisOne, bool forcePressu
 			}
 			// In low memory mode, we kill them all since secondary cache is disabled.
 			if (lowMemoryMode_ || iter->second->lastFrame + TEXTURE_SECOND_KILL_AGE < gpuStats.numFlips) {
-				ReleaseTexture(iter->second.get(), true);
-				secondCacheSizeEstimate_ -= EstimateTexMemoryUsage(iter->second.get());
-				secondCache_.erase(iter++);
+				DeleteSecondTexture(iter++);
 			} else {
 				++iter;
 			}
@@ -835,6 +870,63 @@ void TextureCacheCommon::Decimate(TexCacheEntry *exceptThisOne, bool forcePressu
 	replacer_.Decimate(forcePressure ? ReplacerDecimateMode::FORCE_PRESSURE : ReplacerDecimateMode::NEW_FRAME);
 }
 
+u64 TextureCacheCommon::CacheMemoryBudget() const {
+	if (g_Config.iTexCacheBudgetMB <= 0)
+		return 0;
+	return (u64)g_Config.iTexCacheBudgetMB * 1024 * 1024;
+}
+
+// Evicts the least recently used textures, from both caches, until we're back under the budget.
+void TextureCacheCommon::EnforceMemoryBudget(TexCacheEntry *exceptThisOne) {
+	const u64 budget = CacheMemoryBudget();
+	if (budget == 0 || CacheMemoryUsage() <= budget)
+		return;
+
+	const u64 had = CacheMemoryUsage();
+	const u64 target = budget - budget / TEXCACHE_BUDGET_SLACK_DIVISOR;
+
+	struct Candidate {
+		TexCache::iterator iter;
+		int lastFrame;
+		bool second;
+	};
+	FrameArena::Scope arenaScope(g_gpuFrameArena);
+	ArenaVector<Candidate> candidates(g_gpuFrameArena);
+	candidates.reserve(cache_.size() + secondCache_.size());
+	for (auto iter = cache_.begin(); iter != cache_.end(); ++iter) {
+		// Textures used this frame may still be needed by queued draws, and would just get rebuilt.
+		if (iter->second.get() != exceptThisOne && iter->second->lastFrame < gpuStats.numFlips) {
+			candidates.push_back({ iter, iter->second->lastFrame, false });
+		}
+	}
+	for (auto iter = secondCache_.begin(); iter != secondCache_.end(); ++iter) {
+		if (iter->second.get() != exceptThisOne && iter->second->lastFrame < gpuStats.numFlips) {
+			candidates.push_back({ iter, iter->second->lastFrame, true });
+		}
+	}
+
+	// Oldest first. On ties, drop the secondary cache's speculative copies before live entries.
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+		if (a.lastFrame != b.lastFrame)
+			return a.lastFrame < b.lastFrame;
+		return a.second && !b.second;
+	});
+
+	ForgetLastTexture();
+	for (const Candidate &candidate : candidates) {
+		if (CacheMemoryUsage() <= target)
+			break;
+		if (candidate.second) {
+			DeleteSecondTexture(candidate.iter);
+		} else {
+			DeleteTexture(candidate.iter);
+		}
+		gpuStats.numTexturesEvicted++;
+	}
+
+	VERBOSE_LOG(Log::G3D, "Texture cache over budget, evicted %d bytes - now %d bytes", (int)(had - CacheMemoryUsage()), (int)CacheMemoryUsage());
+}
+
 void TextureCacheCommon::DecimateVideos() {
 	for (auto iter = videos_.begin(); iter != videos_.end(); ) {
 		if (iter->flips + VIDEO_DECIMATE_AGE < gpuStats.numFlips) {
@@ -860,6 +952,9 @@ bool TextureCacheCommon::IsVideo(u32 texaddr) const {
 
 void TextureCacheCommon::HandleTextureChange(TexCacheEntry *const entry, const char *reason, bool initialMatch, bool doDelete) {
 	cacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
+	// Either the texture is released below, or it was archived in the secondary cache, which counts it now.
+	cacheMemoryUsage_ -= entry->memoryUsage;
+	entry->memoryUsage = 0;
 	entry->numInvalidated++;
 	gpuStats.numTextureInvalidations++;
 	DEBUG_LOG(Log::G3D, "Texture different or overwritten, reloading at %08x: %s", entry->addr, reason);
@@ -1407,6 +1502,7 @@ void TextureCacheCommon::LoadClut(u32 clutAddr, u32 loadBytes, GPURecord::Record
 
 			framebufferManager_->RebindFramebuffer("after_copy_clut_to_temp");
 			clutRenderFormat_ = chosenFramebuffer->fb_format;
+			dynamicClutFboFormat_ = 0xFFFFFFFF;
 		}
 		NotifyMemInfo(MemBlockFlags::ALLOC, clutAddr, loadBytes, "CLUT");
 	}
@@ -1537,6 +1633,38 @@ u32 TextureCacheCommon::EstimateTexMemoryUsage(const TexCacheEntry *entry) {
 	return pixelSize << (dimW + dimH);
 }
 
+u32 TextureCacheCommon::TextureMemoryUsage(int w, int h, int depth, int levels, int bytesPerPixel, int blockSize) {
+	u64 total = 0;
+	for (int i = 0; i < levels; i++) {
+		int lw = std::max(w >> i, 1);
+		int lh = std::max(h >> i, 1);
+		if (blockSize != 0) {
+			total += (u64)((lw + 3) / 4) * ((lh + 3) / 4) * blockSize;
+		} else {
+			total += (u64)lw * lh * bytesPerPixel;
+		}
+	}
+	total *= depth;
+	return total > 0xFFFFFFFF ? 0xFFFFFFFF : (u32)total;
+}
+
+u32 TextureCacheCommon::TextureMemoryUsage(int w, int h, int depth, int levels, Draw::DataFormat fmt) {
+	int blockSize = 0;
+	if (Draw::DataFormatIsBlockCompressed(fmt, &blockSize)) {
+		return TextureMemoryUsage(w, h, depth, levels, 0, blockSize);
+	}
+	return TextureMemoryUsage(w, h, depth, levels, (int)Draw::DataFormatSizeInBytes(fmt), 0);
+}
+
+void TextureCacheCommon::SetEntryMemoryUsage(TexCacheEntry *entry, u32 bytes) {
+	cacheMemoryUsage_ -= entry->memoryUsage;
+	entry->memoryUsage = bytes;
+	cacheMemoryUsage_ += bytes;
+	// This is called once per texture built, and what we upload is about this size (except for generated mips.)
+	gpuStats.numTextureBytesUploaded += bytes;
+	gpuStats.numTextureBytesUploadedByFormat[entry->format & 0xF] += bytes;
+}
+
 ReplacedTexture *TextureCacheCommon::FindReplacement(TexCacheEntry *entry, int *w, int *h, int *d) {
 	if (*d != 1) {
 		// We don't yet support replacing 3D textures.
@@ -1687,6 +1815,45 @@ static CheckAlphaResult DecodeDXTBlocks(uint8_t *out, int outPitch, uint32_t tex
 	}
 }
 
+template <typename DXTBlock, int n>
+static CheckAlphaResult RepackDXTBlocks(uint8_t *out, int outPitch, uint32_t texaddr, const uint8_t *texptr, int w, int h, int bufw) {
+	const DXTBlock *src = (const DXTBlock *)texptr;
+	const int blocksW = (w + 3) / 4;
+	const int blocksH = (h + 3) / 4;
+	// Native DXT is only used when bufw >= w.
+	const int srcBlocksW = bufw / 4;
+
+	int validBlocksH = blocksH;
+	if (!Memory::IsValidRange(texaddr, blocksH * srcBlocksW * sizeof(DXTBlock))) {
+		ERROR_LOG_REPORT(Log::G3D, "DXT%d texture extends beyond valid RAM: %08x + %d x %d", n, texaddr, bufw, h);
+		uint32_t limited = Memory::ValidSize(texaddr, blocksH * srcBlocksW * sizeof(DXTBlock));
+		validBlocksH = ((int)limited / sizeof(DXTBlock)) / srcBlocksW;
+	}
+
+	bool anyNonFullAlpha = false;
+	for (int by = 0; by < blocksH; by++) {
+		uint8_t *dst = out + outPitch * by;
+		const DXTBlock *row = src + by * srcBlocksW;
+		if (by >= validBlocksH) {
+			// Fill the rest with transparent black blocks rather than garbage.
+			memset(dst, 0, blocksW * sizeof(DXTBlock));
+			anyNonFullAlpha = true;
+		} else if constexpr (n == 1) {
+			ConvertDXT1ToBC1(dst, (const DXT1Block *)row, blocksW, &anyNonFullAlpha);
+		} else if constexpr (n == 3) {
+			ConvertDXT3ToBC2(dst, (const DXT3Block *)row, blocksW);
+		} else if constexpr (n == 5) {
+			ConvertDXT5ToBC3(dst, (const DXT5Block *)row, blocksW);
+		}
+	}
+
+	if constexpr (n == 1) {
+		return anyNonFullAlpha ? CHECKALPHA_ANY : CHECKALPHA_FULL;
+	} else {
+		return CHECKALPHA_ANY;
+	}
+}
+
 inline u32 ClutFormatToFullAlpha(GEPaletteFormat fmt, bool reverseColors) {
 	switch (fmt) {
 	case GE_CMODE_16BIT_ABGR4444: return reverseColors ? 0x000F : 0xF000;
@@ -1719,6 +1886,38 @@ static void Expand4To8Bits(u8 *dest, const u8 *src, int srcWidth) {
 }
 
 CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, TexDecodeFlags flags) {
+	int w = gstate.getTextureWidth(level);
+	int h = gstate.getTextureHeight(level);
+	const uint32_t byteSize = (textureBitsPerPixel[format] * bufw * h) / 8;
+
+	char buf[128];
+	size_t len = snprintf(buf, sizeof(buf), "Tex_%08x_%dx%d_%s", texaddr, w, h, GeTextureFormatToString(format, clutformat));
+	NotifyMemInfo(MemBlockFlags::TEXTURE, texaddr, byteSize, buf, len);
+
+	// Expanding the CLUT writes to expandClut_, so those can't be split up.
+	bool expandsClut = (flags & TexDecodeFlags::EXPAND32) && (flags & TexDecodeFlags::TO_CLUT8) == 0 && format >= GE_TFMT_CLUT4 && format <= GE_TFMT_CLUT32;
+	// Repacking DXT blocks is just a copy, and the pitch is per row of blocks, so not worth splitting either.
+	bool toBC = (flags & TexDecodeFlags::TO_BC) != 0;
+	if (w * h < PARALLEL_DECODE_MIN_PIXELS || expandsClut || toBC || g_threadManager.GetNumLooperThreads() <= 1) {
+		return DecodeTextureRows(out, outPitch, format, clutformat, texaddr, level, bufw, w, h, flags, tmpTexBuf32_);
+	}
+
+	// Split into bands of whole swizzle (and DXT) blocks, so each band starts at a simple offset in RAM.
+	const int blockRows = (h + 7) / 8;
+	std::atomic<bool> allFull(true);
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		AlignedVector<u32, 16> tmpBuf;
+		int y = lower * 8;
+		int rows = std::min(upper * 8, h) - y;
+		u32 bandAddr = texaddr + (textureBitsPerPixel[format] * bufw * y) / 8;
+		if (DecodeTextureRows(out + outPitch * y, outPitch, format, clutformat, bandAddr, level, bufw, w, rows, flags, tmpBuf) != CHECKALPHA_FULL)
+			allFull = false;
+	}, 0, blockRows, PARALLEL_DECODE_MIN_BLOCK_ROWS, TaskPriority::HIGH);
+
+	return allFull ? CHECKALPHA_FULL : CHECKALPHA_ANY;
+}
+
+CheckAlphaResult TextureCacheCommon::DecodeTextureRows(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, int w, int h, TexDecodeFlags flags, AlignedVector<u32, 16> &tmpBuf) {
 	u32 alphaSum = 0xFFFFFFFF;
 	u32 fullAlphaMask = 0x0;
 
@@ -1726,9 +1925,14 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 	bool reverseColors = (flags & TexDecodeFlags::REVERSE_COLORS) != 0;
 	bool toClut8 = (flags & TexDecodeFlags::TO_CLUT8) != 0;
 
+	bool toBC = (flags & TexDecodeFlags::TO_BC) != 0;
+
 	if (toClut8 && format != GE_TFMT_CLUT8 && format != GE_TFMT_CLUT4) {
 		_dbg_assert_(false);
 	}
+	if (toBC && (format < GE_TFMT_DXT1 || format > GE_TFMT_DXT5)) {
+		_dbg_assert_(false);
+	}
 
 	bool swizzled = gstate.isTextureSwizzled();
 	if ((texaddr & 0x00600000) != 0 && Memory::IsVRAMAddress(texaddr)) {
@@ -1742,14 +1946,7 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 		// Note that (texaddr & 0x00600000) == 0x00600000 is very likely to be depth texturing.
 	}
 
-	int w = gstate.getTextureWidth(level);
-	int h = gstate.getTextureHeight(level);
 	const u8 *texptr = Memory::GetPointer(texaddr);
-	const uint32_t byteSize = (textureBitsPerPixel[format] * bufw * h) / 8;
-
-	char buf[128];
-	size_t len = snprintf(buf, sizeof(buf), "Tex_%08x_%dx%d_%s", texaddr, w, h, GeTextureFormatToString(format, clutformat));
-	NotifyMemInfo(MemBlockFlags::TEXTURE, texaddr, byteSize, buf, len);
 
 	switch (format) {
 	case GE_TFMT_CLUT4:
@@ -1758,9 +1955,9 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 		const int clutSharingOffset = mipmapShareClut ? 0 : level * 16;
 
 		if (swizzled) {
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw / 2, texptr, bufw, h, 0);
-			texptr = (u8 *)tmpTexBuf32_.data();
+			tmpBuf.resize(bufw * ((h + 7) & ~7));
+			UnswizzleFromMem(tmpBuf.data(), bufw / 2, texptr, bufw, h, 0);
+			texptr = (u8 *)tmpBuf.data();
 		}
 
 		if (toClut8) {
@@ -1844,9 +2041,9 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 	case GE_TFMT_CLUT8:
 		if (toClut8) {
 			if (gstate.isTextureSwizzled()) {
-				tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-				UnswizzleFromMem(tmpTexBuf32_.data(), bufw, texptr, bufw, h, 1);
-				texptr = (u8 *)tmpTexBuf32_.data();
+				tmpBuf.resize(bufw * ((h + 7) & ~7));
+				UnswizzleFromMem(tmpBuf.data(), bufw, texptr, bufw, h, 1);
+				texptr = (u8 *)tmpBuf.data();
 			}
 			// After deswizzling, we are in the correct format and can just copy.
 			for (int y = 0; y < h; ++y) {
@@ -1855,13 +2052,13 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 			// We can't know anything about alpha.
 			return CHECKALPHA_ANY;
 		}
-		return ReadIndexedTex(out, outPitch, level, texptr, 1, bufw, reverseColors, expandTo32bit);
+		return ReadIndexedTex(out, outPitch, level, texptr, 1, bufw, w, h, reverseColors, expandTo32bit, tmpBuf);
 
 	case GE_TFMT_CLUT16:
-		return ReadIndexedTex(out, outPitch, level, texptr, 2, bufw, reverseColors, expandTo32bit);
+		return ReadIndexedTex(out, outPitch, level, texptr, 2, bufw, w, h, reverseColors, expandTo32bit, tmpBuf);
 
 	case GE_TFMT_CLUT32:
-		return ReadIndexedTex(out, outPitch, level, texptr, 4, bufw, reverseColors, expandTo32bit);
+		return ReadIndexedTex(out, outPitch, level, texptr, 4, bufw, w, h, reverseColors, expandTo32bit, tmpBuf);
 
 	case GE_TFMT_4444:
 	case GE_TFMT_5551:
@@ -1895,9 +2092,9 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 			}
 		}*/ else {
 			// We don't have enough space for all rows in out, so use a temp buffer.
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 2, texptr, bufw, h, 2);
-			const u8 *unswizzled = (u8 *)tmpTexBuf32_.data();
+			tmpBuf.resize(bufw * ((h + 7) & ~7));
+			UnswizzleFromMem(tmpBuf.data(), bufw * 2, texptr, bufw, h, 2);
+			const u8 *unswizzled = (u8 *)tmpBuf.data();
 
 			fullAlphaMask = TfmtRawToFullAlpha(format);
 			if (expandTo32bit) {
@@ -1944,9 +2141,9 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 				ReverseColors(out, out, format, h * outPitch / 4, useBGRA);
 			}
 		}*/ else {
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 4, texptr, bufw, h, 4);
-			const u8 *unswizzled = (u8 *)tmpTexBuf32_.data();
+			tmpBuf.resize(bufw * ((h + 7) & ~7));
+			UnswizzleFromMem(tmpBuf.data(), bufw * 4, texptr, bufw, h, 4);
+			const u8 *unswizzled = (u8 *)tmpBuf.data();
 
 			fullAlphaMask = TfmtRawToFullAlpha(format);
 			if (reverseColors) {
@@ -1963,12 +2160,18 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 		break;
 
 	case GE_TFMT_DXT1:
+		if (toBC)
+			return RepackDXTBlocks<DXT1Block, 1>(out, outPitch, texaddr, texptr, w, h, bufw);
 		return DecodeDXTBlocks<DXT1Block, 1>(out, outPitch, texaddr, texptr, w, h, bufw, reverseColors);
 
 	case GE_TFMT_DXT3:
+		if (toBC)
+			return RepackDXTBlocks<DXT3Block, 3>(out, outPitch, texaddr, texptr, w, h, bufw);
 		return DecodeDXTBlocks<DXT3Block, 3>(out, outPitch, texaddr, texptr, w, h, bufw, reverseColors);
 
 	case GE_TFMT_DXT5:
+		if (toBC)
+			return RepackDXTBlocks<DXT5Block, 5>(out, outPitch, texaddr, texptr, w, h, bufw);
 		return DecodeDXTBlocks<DXT5Block, 5>(out, outPitch, texaddr, texptr, w, h, bufw, reverseColors);
 
 	default:
@@ -1979,14 +2182,11 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 	return AlphaSumIsFull(alphaSum, fullAlphaMask) ? CHECKALPHA_FULL : CHECKALPHA_ANY;
 }
 
-CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool reverseColors, bool expandTo32Bit) {
-	int w = gstate.getTextureWidth(level);
-	int h = gstate.getTextureHeight(level);
-
+CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, int w, int h, bool reverseColors, bool expandTo32Bit, AlignedVector<u32, 16> &tmpBuf) {
 	if (gstate.isTextureSwizzled()) {
-		tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-		UnswizzleFromMem(tmpTexBuf32_.data(), bufw * bytesPerIndex, texptr, bufw, h, bytesPerIndex);
-		texptr = (u8 *)tmpTexBuf32_.data();
+		tmpBuf.resize(bufw * ((h + 7) & ~7));
+		UnswizzleFromMem(tmpBuf.data(), bufw * bytesPerIndex, texptr, bufw, h, bytesPerIndex);
+		texptr = (u8 *)tmpBuf.data();
 	}
 
 	// Misshitsu no Sacrifice has separate CLUT data, this is a hack to allow it.
@@ -2081,6 +2281,12 @@ CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int l
 }
 
 void TextureCacheCommon::ApplyTexture() {
+	if (nextAtlasTexture_) {
+		nextAtlasTexture_ = false;
+		ApplyAtlasTexture();
+		return;
+	}
+
 	TexCacheEntry *entry = nextTexture_;
 	if (!entry) {
 		// Maybe we bound a framebuffer?
@@ -2118,7 +2324,10 @@ void TextureCacheCommon::ApplyTexture() {
 			int w = gstate.getTextureWidth(0);
 			int h = gstate.getTextureHeight(0);
 			bool swizzled = gstate.isTextureSwizzled();
-			entry->fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, swizzled, GETextureFormat(entry->format), entry);
+			double hashStart = time_now_d();
+			entry->fullhash = HashTexture(entry, w, h, swizzled, &entry->writeStamp, &entry->writeStampSize);
+			gpuStats.msTextureHashing += time_now_d() - hashStart;
+			gpuStats.numTexturesHashed++;
 
 			// TODO: Here we could check the secondary cache; maybe the texture is in there?
 			// We would need to abort the build if so.
@@ -2170,6 +2379,191 @@ void TextureCacheCommon::ApplyTexture() {
 	}
 }
 
+void TextureCacheCommon::ClearAtlas() {
+	atlasSlots_.clear();
+	atlasShelfX_ = 0;
+	atlasShelfY_ = 0;
+	atlasShelfHeight_ = 0;
+	atlasFull_ = false;
+	atlasVersion_++;
+}
+
+bool TextureCacheCommon::AllocateAtlasSlot(int w, int h, u16 *x, u16 *y) {
+	// One texel of padding on each side, so linear filtering at the edges clamps like the original.
+	const int slotW = w + 2;
+	const int slotH = h + 2;
+	if (atlasShelfX_ + slotW > ATLAS_SIZE) {
+		atlasShelfX_ = 0;
+		atlasShelfY_ += atlasShelfHeight_;
+		atlasShelfHeight_ = 0;
+	}
+	if (atlasShelfY_ + slotH > ATLAS_SIZE) {
+		atlasFull_ = true;
+		return false;
+	}
+	*x = atlasShelfX_ + 1;
+	*y = atlasShelfY_ + 1;
+	atlasShelfX_ += slotW;
+	atlasShelfHeight_ = std::max(atlasShelfHeight_, slotH);
+	return true;
+}
+
+bool TextureCacheCommon::GetAtlasSlot(bool newBatch, u16 *x, u16 *y) {
+	// Anything that would build the texture differently from a plain decode stays on the normal path.
+	if (replacer_.Enabled() || standardScaleFactor_ != 1 || IsFakeMipmapChange() || gstate.getTextureMaxLevel() != 0)
+		return false;
+
+	const u32 texaddr = gstate.getTextureAddress(0);
+	const int w = gstate.getTextureWidth(0);
+	const int h = gstate.getTextureHeight(0);
+	const GETextureFormat format = gstate.getTextureFormat();
+	if (w > ATLAS_MAX_TEXTURE_SIZE || h > ATLAS_MAX_TEXTURE_SIZE || format >= GE_TFMT_DXT1)
+		return false;
+	const bool hasClut = gstate.isTextureFormatIndexed();
+	if (hasClut && clutRenderAddress_ != 0xFFFFFFFF)
+		return false;
+	if (Memory::IsVRAMAddress(texaddr) && (texaddr & 0x00600000) != 0)
+		return false;
+
+	// Linear filtering would blend with the padding, where the original texture wraps around.
+	const bool mayFilter = (gstate.texfilter & 1) != 0 || gstate.isMagnifyFilteringEnabled() ||
+		g_Config.iTexFiltering == TEX_FILTER_FORCE_LINEAR || g_Config.iTexFiltering == TEX_FILTER_AUTO_MAX_QUALITY;
+	if (mayFilter && (!gstate.isTexCoordClampedS() || !gstate.isTexCoordClampedT()))
+		return false;
+
+	const int bufw = GetTextureBufw(0, texaddr, format);
+	const bool swizzled = gstate.isTextureSwizzled();
+	const u32 sizeInRAM = (textureBitsPerPixel[format] * bufw * (swizzled ? ((h + 7) & ~7) : h)) >> 3;
+	if (!Memory::IsValidRange(texaddr, sizeInRAM) || IsVideo(texaddr))
+		return false;
+
+	TextureDefinition def{};
+	def.addr = texaddr;
+	def.dim = gstate.getTextureDimension(0);
+	def.format = format;
+	def.bufw = bufw;
+	AttachCandidate candidate;
+	if (GetBestFramebufferCandidate(def, 0, &candidate))
+		return false;
+
+	u32 cluthash = 0;
+	if (hasClut) {
+		if (clutLastFormat_ != gstate.clutformat) {
+			UpdateCurrentClut(gstate.getClutPaletteFormat(), gstate.getClutIndexStartPos(), gstate.isClutIndexSimple());
+		}
+		cluthash = clutHash_ ^ gstate.clutformat;
+	}
+	const u64 seed = ((u64)cluthash << 32) | ((u32)def.dim | ((u32)format << 16) | ((u32)swizzled << 20) | ((u32)bufw << 21));
+	const u64 key = XXH3_64bits_withSeed(Memory::GetPointerUnchecked(texaddr), sizeInRAM, seed);
+	gpuStats.numTextureDataBytesHashed += sizeInRAM;
+
+	auto iter = atlasSlots_.find(key);
+	if (iter != atlasSlots_.end()) {
+		*x = iter->second.x;
+		*y = iter->second.y;
+		return true;
+	}
+
+	if (atlasFull_) {
+		// Only start over when nothing drawn this frame is still using the old slots.
+		if (!newBatch || atlasUsedThisFrame_)
+			return false;
+		ClearAtlas();
+	}
+	if (!AllocateAtlasSlot(w, h, x, y))
+		return false;
+
+	if (atlasPixels_.empty()) {
+		atlasPixels_.resize(ATLAS_SIZE * ATLAS_SIZE);
+	}
+	u32 *origin = &atlasPixels_[*y * ATLAS_SIZE + *x];
+	DecodeTextureLevel((u8 *)origin, ATLAS_SIZE * sizeof(u32), format, gstate.getClutPaletteFormat(), texaddr, 0, bufw, TexDecodeFlags::EXPAND32);
+	gpuStats.numTexturesDecoded++;
+
+	// Replicate the edges into the padding.
+	memcpy(origin - ATLAS_SIZE, origin, w * sizeof(u32));
+	memcpy(origin + h * ATLAS_SIZE, origin + (h - 1) * ATLAS_SIZE, w * sizeof(u32));
+	for (int row = -1; row <= h; row++) {
+		u32 *line = origin + row * ATLAS_SIZE;
+		line[-1] = line[0];
+		line[w] = line[w - 1];
+	}
+
+	atlasSlots_[key] = AtlasSlot{ *x, *y };
+	atlasVersion_++;
+	return true;
+}
+
+void TextureCacheCommon::SetAtlasTexture() {
+	gstate_c.curTextureWidth = ATLAS_SIZE;
+	gstate_c.curTextureHeight = ATLAS_SIZE;
+	gstate_c.SetNeedShaderTexclamp(false);
+	gstate_c.skipDrawReason &= ~SKIPDRAW_BAD_FB_TEXTURE;
+	gstate_c.SetTextureIsVideo(false);
+	gstate_c.SetTextureIs3D(false);
+	gstate_c.SetTextureIsArray(false);
+	gstate_c.SetTextureIsFramebuffer(false);
+
+	failedTexture_ = false;
+	nextTexture_ = nullptr;
+	nextFramebufferTexture_ = nullptr;
+	nextNeedsRebuild_ = false;
+	nextAtlasTexture_ = true;
+}
+
+void TextureCacheCommon::ApplyAtlasTexture() {
+	ForgetLastTexture();
+
+	const int index = draw_->GetFrameCount() % ATLAS_FRAMES;
+	const uint8_t *pixels = (const uint8_t *)atlasPixels_.data();
+	if (!atlasTextures_[index]) {
+		Draw::TextureDesc desc{
+			Draw::TextureType::LINEAR2D,
+			Draw::DataFormat::R8G8B8A8_UNORM,
+			ATLAS_SIZE,
+			ATLAS_SIZE,
+			1,
+			1,
+			false,
+			Draw::TextureSwizzle::DEFAULT,
+			"SpriteAtlas",
+			{ pixels },
+			nullptr,
+		};
+		atlasTextures_[index] = draw_->CreateTexture(desc);
+		if (!atlasTextures_[index]) {
+			ERROR_LOG(Log::G3D, "Failed to create sprite atlas texture");
+			BindTexture(nullptr);
+			return;
+		}
+		gpuStats.numTextureBytesUploaded += ATLAS_SIZE * ATLAS_SIZE * sizeof(u32);
+	} else if (atlasTextureVersions_[index] != atlasVersion_) {
+		draw_->UpdateTextureLevels(atlasTextures_[index], &pixels, nullptr, 1);
+		gpuStats.numTextureBytesUploaded += ATLAS_SIZE * ATLAS_SIZE * sizeof(u32);
+	}
+	atlasTextureVersions_[index] = atlasVersion_;
+	atlasUsedThisFrame_ = true;
+
+	SamplerCacheKey key = GetSamplingParams(0, nullptr);
+	// GetAtlasSlot only accepts draws that stay within the texture, and the padding covers the edges.
+	key.sClamp = true;
+	key.tClamp = true;
+	key.mipEnable = false;
+	key.mipFilt = 0;
+	key.maxLevel = 0;
+	key.minLevel = 0;
+	key.lodBias = 0;
+	key.aniso = false;
+	key.texture3d = false;
+	BindAtlasTexture(atlasTextures_[index], key);
+
+	gstate_c.SetTextureFullAlpha(false);
+	gstate_c.SetTextureIs3D(false);
+	gstate_c.SetTextureIsArray(false);
+	gstate_c.SetTextureIsBGRA(false);
+	gstate_c.SetUseShaderDepal(ShaderDepalMode::OFF);
+}
+
 // Can we depalettize at all? This refers to both in-fragment-shader depal and "traditional" depal through a separate pass.
 static bool CanDepalettize(GETextureFormat texFormat, GEBufferFormat bufferFormat) {
 	if (IsClutFormat(texFormat)) {
@@ -2272,14 +2666,7 @@ void TextureCacheCommon::ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer
 			smoothedDepal = CanUseSmoothDepal(gstate, framebuffer->fb_format, clutTexture);
 		} else {
 			// The CLUT texture is dynamic, it's the framebuffer pointed to by clutRenderAddress.
-			// Instead of texturing directly from that, we copy to a temporary CLUT texture.
-			GEBufferFormat expectedCLUTBufferFormat = (GEBufferFormat)clutFormat;
-
-			// OK, figure out what format we want our framebuffer in, so it can be reinterpreted if needed.
-			// If no reinterpretation is needed, we'll automatically just get a copy shader.
-			float scaleFactorX = 1.0f;
-			Draw2DPipeline *reinterpret = framebufferManager_->GetReinterpretPipeline(clutRenderFormat_, expectedCLUTBufferFormat, &scaleFactorX);
-			framebufferManager_->BlitUsingRaster(dynamicClutTemp_, 0.0f, 0.0f, 512.0f, 1.0f, dynamicClutFbo_, 0.0f, 0.0f, scaleFactorX * 512.0f, 1.0f, false, 1.0f, reinterpret, "reinterpret_clut");
+			ReinterpretDynamicClut(clutFormat);
 		}
 
 		if (useShaderDepal) {
@@ -2382,11 +2769,16 @@ void TextureCacheCommon::ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer
 		draw_->BindFramebufferAsTexture(depalFBO, 0, Draw::Aspect::COLOR_BIT, Draw::ALL_LAYERS);
 		BoundFramebufferTexture();
 
-		const u32 bytesPerColor = clutFormat == GE_CMODE_32BIT_ABGR8888 ? sizeof(u32) : sizeof(u16);
-		const u32 clutTotalColors = clutMaxBytes_ / bytesPerColor;
+		if (clutRenderAddress_ == 0xFFFFFFFF) {
+			const u32 bytesPerColor = clutFormat == GE_CMODE_32BIT_ABGR8888 ? sizeof(u32) : sizeof(u16);
+			const u32 clutTotalColors = clutMaxBytes_ / bytesPerColor;
 
-		CheckAlphaResult alphaStatus = CheckCLUTAlpha((const uint8_t *)clutBufRaw_, clutFormat, clutTotalColors);
-		gstate_c.SetTextureFullAlpha(alphaStatus == CHECKALPHA_FULL);
+			CheckAlphaResult alphaStatus = CheckCLUTAlpha((const uint8_t *)clutBufRaw_, clutFormat, clutTotalColors);
+			gstate_c.SetTextureFullAlpha(alphaStatus == CHECKALPHA_FULL);
+		} else {
+			// The palette only lives on the GPU, clutBufRaw_ is stale, so we don't know about alpha at all.
+			gstate_c.SetTextureFullAlpha(false);
+		}
 
 		draw_->Invalidate(InvalidationFlags::CACHED_RENDER_STATE);
 		shaderManager_->DirtyLastShader();
@@ -2406,6 +2798,26 @@ void TextureCacheCommon::ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer
 	gstate_c.Dirty(DIRTY_ALL_RENDER_STATE);
 }
 
+// Prepares dynamicClutFbo_ from the framebuffer CLUT copied in LoadClut, entirely on the GPU.
+// Instead of texturing directly from the framebuffer, we copy to a temporary CLUT texture, reinterpreting
+// the pixels to the palette format if needed. This is only redone when the CLUT or its format changes.
+void TextureCacheCommon::ReinterpretDynamicClut(GEPaletteFormat clutFormat) {
+	if (dynamicClutFboFormat_ == (u32)clutFormat) {
+		return;
+	}
+
+	// All entries from clutFormat correspond directly to buffer formats.
+	GEBufferFormat expectedCLUTBufferFormat = (GEBufferFormat)clutFormat;
+
+	// OK, figure out what format we want our framebuffer in, so it can be reinterpreted if needed.
+	// If no reinterpretation is needed, we'll automatically just get a copy shader.
+	float scaleFactorX = 1.0f;
+	Draw2DPipeline *reinterpret = framebufferManager_->GetReinterpretPipeline(clutRenderFormat_, expectedCLUTBufferFormat, &scaleFactorX);
+	framebufferManager_->BlitUsingRaster(
+		dynamicClutTemp_, 0.0f, 0.0f, 512.0f, 1.0f, dynamicClutFbo_, 0.0f, 0.0f, scaleFactorX * 512.0f, 1.0f, false, 1.0f, reinterpret, "reinterpret_clut");
+	dynamicClutFboFormat_ = (u32)clutFormat;
+}
+
 // Applies depal to a normal (non-framebuffer) texture, pre-decoded to CLUT8 format.
 void TextureCacheCommon::ApplyTextureDepal(TexCacheEntry *entry) {
 	uint32_t clutMode = gstate.clutformat & 0xFFFFFF;
@@ -2423,15 +2835,7 @@ void TextureCacheCommon::ApplyTextureDepal(TexCacheEntry *entry) {
 	u32 depthUpperBits = 0;
 
 	// The CLUT texture is dynamic, it's the framebuffer pointed to by clutRenderAddress.
-	// Instead of texturing directly from that, we copy to a temporary CLUT texture.
-	GEBufferFormat expectedCLUTBufferFormat = (GEBufferFormat)clutFormat;  // All entries from clutFormat correspond directly to buffer formats.
-
-	// OK, figure out what format we want our framebuffer in, so it can be reinterpreted if needed.
-	// If no reinterpretation is needed, we'll automatically just get a copy shader.
-	float scaleFactorX = 1.0f;
-	Draw2DPipeline *reinterpret = framebufferManager_->GetReinterpretPipeline(clutRenderFormat_, expectedCLUTBufferFormat, &scaleFactorX);
-	framebufferManager_->BlitUsingRaster(
-		dynamicClutTemp_, 0.0f, 0.0f, 512.0f, 1.0f, dynamicClutFbo_, 0.0f, 0.0f, scaleFactorX * 512.0f, 1.0f, false, 1.0f, reinterpret, "reinterpret_clut");
+	ReinterpretDynamicClut(clutFormat);
 
 	Draw2DPipeline *textureShader = textureShaderCache_->GetDepalettizeShader(clutMode, GE_TFMT_CLUT8, GE_FORMAT_CLUT8, false, 0);
 	gstate_c.SetUseShaderDepal(ShaderDepalMode::OFF);
@@ -2484,9 +2888,6 @@ void TextureCacheCommon::ApplyTextureDepal(TexCacheEntry *entry) {
 	draw_->BindFramebufferAsTexture(depalFBO, 0, Draw::Aspect::COLOR_BIT, 0);
 	BoundFramebufferTexture();
 
-	const u32 bytesPerColor = clutFormat == GE_CMODE_32BIT_ABGR8888 ? sizeof(u32) : sizeof(u16);
-	const u32 clutTotalColors = clutMaxBytes_ / bytesPerColor;
-
 	// We don't know about alpha at all.
 	gstate_c.SetTextureFullAlpha(false);
 
@@ -2517,6 +2918,8 @@ void TextureCacheCommon::Clear(bool delete_them) {
 		secondCache_.clear();
 		cacheSizeEstimate_ = 0;
 		secondCacheSizeEstimate_ = 0;
+		cacheMemoryUsage_ = 0;
+		secondCacheMemoryUsage_ = 0;
 	}
 	videos_.clear();
 
@@ -2528,14 +2931,56 @@ void TextureCacheCommon::Clear(bool delete_them) {
 		dynamicClutTemp_->Release();
 		dynamicClutTemp_ = nullptr;
 	}
+	dynamicClutFboFormat_ = 0xFFFFFFFF;
+
+	for (int i = 0; i < ATLAS_FRAMES; i++) {
+		if (atlasTextures_[i]) {
+			atlasTextures_[i]->Release();
+			atlasTextures_[i] = nullptr;
+		}
+	}
 }
 
 void TextureCacheCommon::DeleteTexture(TexCache::iterator it) {
 	ReleaseTexture(it->second.get(), true);
 	cacheSizeEstimate_ -= EstimateTexMemoryUsage(it->second.get());
+	cacheMemoryUsage_ -= it->second->memoryUsage;
 	cache_.erase(it);
 }
 
+void TextureCacheCommon::DeleteSecondTexture(TexCache::iterator it) {
+	ReleaseTexture(it->second.get(), true);
+	secondCacheSizeEstimate_ -= EstimateTexMemoryUsage(it->second.get());
+	secondCacheMemoryUsage_ -= it->second->memoryUsage;
+	secondCache_.erase(it);
+}
+
+// Smaller textures mostly share their pages with other data, so tracking them would mostly add faults.
+static const u32 TEXCACHE_MIN_TRACKED_SIZE = 4 * Memory::DIRTY_PAGE_SIZE;
+
+bool TextureCacheCommon::TrackTextureWrites(const TexCacheEntry *entry, u32 hashSize) {
+	if (!g_Config.bTextureWriteTracking || replacer_.Enabled() || hashSize < TEXCACHE_MIN_TRACKED_SIZE)
+		return false;
+	if (entry->status & (TexCacheEntry::STATUS_CHANGE_FREQUENT | TexCacheEntry::STATUS_VIDEO | TexCacheEntry::STATUS_UNTRACKED_WRITES))
+		return false;
+	return Memory::DirtyTracking_Active(Memory::DIRTY_USER_TEXTURES) || Memory::DirtyTracking_Start(Memory::DIRTY_USER_TEXTURES);
+}
+
+u32 TextureCacheCommon::HashTexture(TexCacheEntry *entry, int w, int h, bool swizzled, u64 *writeStamp, u32 *writeStampSize) {
+	const GETextureFormat format = GETextureFormat(entry->format);
+	*writeStamp = 0;
+	*writeStampSize = 0;
+	if (!replacer_.Enabled()) {
+		const u32 hashSize = QuickTexHashSize(entry->bufw, h, swizzled, format, entry);
+		if (TrackTextureWrites(entry, hashSize)) {
+			// Protect before hashing, so any write from here on counts as a change.
+			*writeStamp = Memory::DirtyTracking_Protect(entry->addr, hashSize);
+			*writeStampSize = *writeStamp != 0 ? hashSize : 0;
+		}
+	}
+	return QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, swizzled, format, entry);
+}
+
 bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 	int w = gstate.getTextureWidth(0);
 	int h = gstate.getTextureHeight(0);
@@ -2546,16 +2991,38 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 	if (isVideo && g_Config.bTextureBackoffCache) {
 		// Attempt to ensure the hash doesn't incorrectly match in if the video stops.
 		entry->fullhash = (entry->fullhash + 0xA535A535) * 11 + (entry->fullhash & 4);
+		entry->writeStamp = 0;
 		return false;
 	}
 
 	u32 fullhash;
-	{
+	u64 writeStamp = 0;
+	u32 writeStampSize = 0;
+	if (entry->writeStamp != 0 && !replacer_.Enabled() &&
+		entry->writeStampSize == QuickTexHashSize(entry->bufw, h, swizzled, GETextureFormat(entry->format), entry) &&
+		Memory::DirtyTracking_UnchangedSince(entry->addr, entry->writeStampSize, entry->writeStamp)) {
+		// Nothing has written to it since it was hashed.
+		fullhash = entry->fullhash;
+		writeStamp = entry->writeStamp;
+		writeStampSize = entry->writeStampSize;
+		gpuStats.numTextureHashesSkipped++;
+	} else {
 		PROFILE_THIS_SCOPE("texhash");
-		fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, swizzled, GETextureFormat(entry->format), entry);
+		const bool wasTracked = entry->writeStamp != 0;
+		double hashStart = time_now_d();
+		fullhash = HashTexture(entry, w, h, swizzled, &writeStamp, &writeStampSize);
+		gpuStats.msTextureHashing += time_now_d() - hashStart;
+		gpuStats.numTexturesHashed++;
+
+		if (wasTracked && fullhash == entry->fullhash) {
+			// Something else shares its pages, so tracking would only cost faults.
+			entry->status |= TexCacheEntry::STATUS_UNTRACKED_WRITES;
+		}
 	}
 
 	if (fullhash == entry->fullhash) {
+		entry->writeStamp = writeStamp;
+		entry->writeStampSize = writeStampSize;
 		if (g_Config.bTextureBackoffCache && !isVideo) {
 			if (entry->GetHashStatus() != TexCacheEntry::STATUS_HASHING && entry->numFrames > TexCacheEntry::FRAMES_REGAIN_TRUST) {
 				// Reset to STATUS_HASHING.
@@ -2591,6 +3058,9 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 
 					// Now just use our archived texture, instead of entry.
 					nextTexture_ = secondEntry;
+					secondEntry->writeStamp = writeStamp;
+					secondEntry->writeStampSize = writeStampSize;
+					entry->writeStamp = 0;
 					return true;
 				}
 			} else {
@@ -2598,11 +3068,13 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 				// Let's save this in the secondary cache in case it gets used again.
 				secondKey = entry->fullhash | ((u64)entry->cluthash << 32);
 				secondCacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
+				secondCacheMemoryUsage_ += entry->memoryUsage;
 
 				// If the entry already exists in the secondary texture cache, drop it nicely.
 				auto oldIter = secondCache_.find(secondKey);
 				if (oldIter != secondCache_.end()) {
 					ReleaseTexture(oldIter->second.get(), true);
+					secondCacheMemoryUsage_ -= oldIter->second->memoryUsage;
 				}
 
 				// Archive the entire texture entry as is, since we'll use its params if it is seen again.
@@ -2618,6 +3090,8 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 
 	// We know it failed, so update the full hash right away.
 	entry->fullhash = fullhash;
+	entry->writeStamp = writeStamp;
+	entry->writeStampSize = writeStampSize;
 	return false;
 }
 
@@ -2669,6 +3143,7 @@ void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type
 				// Just random values to force the hash not to match.
 				entry->fullhash = (entry->fullhash ^ 0x12345678) + 13;
 				entry->minihash = (entry->minihash ^ 0x89ABCDEF) + 89;
+				entry->writeStamp = 0;
 			}
 			if (type != GPU_INVALIDATE_ALL) {
 				gpuStats.numTextureInvalidations++;
@@ -2708,6 +3183,19 @@ void TextureCacheCommon::InvalidateAll(GPUInvalidationType /*unused*/) {
 	}
 }
 
+void TextureCacheCommon::RehashAll() {
+	ForgetLastTexture();
+	for (auto &iter : cache_) {
+		TexCacheEntry *entry = iter.second.get();
+		if (entry->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE)
+			entry->SetHashStatus(TexCacheEntry::STATUS_HASHING);
+		// Forces the full hash check, even without a texture image change.
+		entry->status |= TexCacheEntry::STATUS_CLUT_RECHECK;
+		entry->framesUntilNextFullHash = 0;
+	}
+	videos_.clear();
+}
+
 void TextureCacheCommon::ClearNextFrame() {
 	clearCacheNextFrame_ = true;
 }
@@ -2722,8 +3210,53 @@ std::string AttachCandidate::ToString() const {
 		this->match.xOffset, this->match.yOffset, this->match.reinterpret ? "true" : "false");
 }
 
+// Checks if the DXT texture can skip decoding, and be uploaded in the equivalent BC format instead.
+static Draw::DataFormat ChooseNativeDXTFormat(Draw::DrawContext *draw, const BuildTexturePlan &plan, GETextureFormat format) {
+	Draw::DataFormat bcFormat;
+	switch (format) {
+	case GE_TFMT_DXT1: bcFormat = Draw::DataFormat::BC1_RGBA_UNORM_BLOCK; break;
+	case GE_TFMT_DXT3: bcFormat = Draw::DataFormat::BC2_UNORM_BLOCK; break;
+	case GE_TFMT_DXT5: bcFormat = Draw::DataFormat::BC3_UNORM_BLOCK; break;
+	default: return Draw::DataFormat::UNDEFINED;
+	}
+	if ((draw->GetDataFormatSupport(bcFormat) & Draw::FMT_TEXTURE) == 0)
+		return Draw::DataFormat::UNDEFINED;
+	// Some APIs require the top level to be whole blocks.
+	if ((plan.w & 3) != 0 || (plan.h & 3) != 0)
+		return Draw::DataFormat::UNDEFINED;
+
+	for (int i = 0; i < plan.levelsToLoad; i++) {
+		int w = gstate.getTextureWidth(i);
+		int h = gstate.getTextureHeight(i);
+		int mipW, mipH;
+		plan.GetMipSize(i, &mipW, &mipH);
+		u32 texaddr = gstate.getTextureAddress(i);
+		int bufw = GetTextureBufw(i, texaddr, format);
+		if (w != mipW || h != mipH || bufw < w)
+			return Draw::DataFormat::UNDEFINED;
+		if (format == GE_TFMT_DXT1)
+			continue;
+
+		// Only some blocks of DXT3/DXT5 decode the same way as BC2/BC3, so check them all.
+		const int blocksW = (w + 3) / 4;
+		const int blocksH = (h + 3) / 4;
+		const int blockSize = 16;
+		if (!Memory::IsValidRange(texaddr, blocksH * (bufw / 4) * blockSize))
+			return Draw::DataFormat::UNDEFINED;
+		const u8 *texptr = Memory::GetPointerUnchecked(texaddr);
+		for (int by = 0; by < blocksH; by++) {
+			const u8 *row = texptr + by * (bufw / 4) * blockSize;
+			bool match = format == GE_TFMT_DXT3 ? DXTColorsMatchBC((const DXT3Block *)row, blocksW) : DXTColorsMatchBC((const DXT5Block *)row, blocksW);
+			if (!match)
+				return Draw::DataFormat::UNDEFINED;
+		}
+	}
+	return bcFormat;
+}
+
 bool TextureCacheCommon::PrepareBuildTexture(BuildTexturePlan &plan, TexCacheEntry *entry) {
 	gpuStats.numTexturesDecoded++;
+	gpuStats.numTexturesDecodedByFormat[entry->format & 0xF]++;
 
 	// For the estimate, we assume cluts always point to 8888 for simplicity.
 	cacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
@@ -2950,6 +3483,10 @@ bool TextureCacheCommon::PrepareBuildTexture(BuildTexturePlan &plan, TexCacheEnt
 		plan.maxPossibleLevels = log2i(std::max(plan.createW, plan.createH)) + 1;
 	}
 
+	if (!plan.doReplace && !plan.saveTexture && plan.scaleFactor == 1 && plan.depth == 1 && plan.baseLevelSrc == 0 && !plan.isVideo && plan.levelsToCreate == plan.levelsToLoad) {
+		plan.nativeDXTFormat = ChooseNativeDXTFormat(draw_, plan, (GETextureFormat)entry->format);
+	}
+
 	if (plan.levelsToCreate == 1) {
 		entry->status |= TexCacheEntry::STATUS_NO_MIPS;
 	} else {
@@ -2967,6 +3504,7 @@ void TextureCacheCommon::LoadTextureLevel(TexCacheEntry &entry, uint8_t *data, s
 	int h = gstate.getTextureHeight(srcLevel);
 
 	PROFILE_THIS_SCOPE("decodetex");
+	TRACE_SCOPE("texture_decode");
 
 	if (plan.doReplace) {
 		plan.replaced->GetSize(srcLevel, &w, &h);
@@ -2996,14 +3534,23 @@ void TextureCacheCommon::LoadTextureLevel(TexCacheEntry &entry, uint8_t *data, s
 		if (entry.status & TexCacheEntry::STATUS_CLUT_GPU) {
 			texDecFlags |= TexDecodeFlags::TO_CLUT8;
 		}
+		if (plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED && dstFmt == plan.nativeDXTFormat) {
+			texDecFlags = TexDecodeFlags::TO_BC;
+		}
 
+		double decodeStart = time_now_d();
 		CheckAlphaResult alphaResult = DecodeTextureLevel((u8 *)pixelData, decPitch, tfmt, clutformat, texaddr, srcLevel, bufw, texDecFlags);
+		const double decodeTime = time_now_d() - decodeStart;
+		gpuStats.msTextureDecoding += decodeTime;
+		DisplayNotifyPhase(FramePhase::TEXTURE, decodeTime);
 		entry.SetAlphaStatus(alphaResult, srcLevel);
 
 		int scaledW = w, scaledH = h;
 		if (plan.scaleFactor > 1) {
 			// Note that this updates w and h!
+			double scaleStart = time_now_d();
 			scaler_.ScaleAlways((u32 *)data, pixelData, w, h, &scaledW, &scaledH, plan.scaleFactor);
+			gpuStats.msTextureScaling += time_now_d() - scaleStart;
 			pixelData = (u32 *)data;
 
 			decPitch = scaledW * sizeof(u32);
@@ -3144,10 +3691,11 @@ void TextureCacheCommon::DrawImGuiDebug(uint64_t &selectedTextureId) const {
 	}
 
 	if (ImGui::CollapsingHeader("Texture Cache State", nullptr, ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Text("Cache: %d textures, size est %d", (int)cache_.size(), cacheSizeEstimate_);
+		ImGui::Text("Cache: %d textures, size est %d, %d kB", (int)cache_.size(), cacheSizeEstimate_, (int)(cacheMemoryUsage_ / 1024));
 		if (!secondCache_.empty()) {
-			ImGui::Text("Second: %d textures, size est %d", (int)secondCache_.size(), secondCacheSizeEstimate_);
+			ImGui::Text("Second: %d textures, size est %d, %d kB", (int)secondCache_.size(), secondCacheSizeEstimate_, (int)(secondCacheMemoryUsage_ / 1024));
 		}
+		ImGui::Text("Memory budget: %d kB", (int)(CacheMemoryBudget() / 1024));
 		ImGui::Text("Standard/shader scale factor: %d/%d", standardScaleFactor_, shaderScaleFactor_);
 		ImGui::Text("Texels scaled this frame: %d", texelsScaledThisFrame_);
 		ImGui::Text("Low memory mode: %d", (int)lowMemoryMode_);
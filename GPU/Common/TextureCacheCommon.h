@@ -18,6 +18,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -55,6 +56,8 @@ enum class TexDecodeFlags {
 	EXPAND32 = 1,
 	REVERSE_COLORS = 2,
 	TO_CLUT8 = 4,
+	// Copies DXT blocks into the matching BC layout, outPitch is then the size of a row of blocks.
+	TO_BC = 8,
 };
 ENUM_CLASS_BITOPS(TexDecodeFlags);
 
@@ -152,6 +155,7 @@ struct TexCacheEntry {
 		STATUS_CLUT_VARIANTS = 0x08,   // Has multiple CLUT variants.
 		STATUS_CHANGE_FREQUENT = 0x10, // Changes often (less than 6 frames in between.)
 		STATUS_CLUT_RECHECK = 0x20,    // Another texture with same addr had a hashfail.
+		STATUS_UNTRACKED_WRITES = 0x40,  // Its pages get written without changing it, so write tracking doesn't help.
 		STATUS_TO_SCALE = 0x80,        // Pending texture scaling in a later frame.
 		STATUS_IS_SCALED_OR_REPLACED = 0x100,  // Has been scaled already (ignored for replacement checks).
 		STATUS_TO_REPLACE = 0x0200,    // Pending texture replacement.
@@ -198,7 +202,12 @@ struct TexCacheEntry {
 	u32 framesUntilNextFullHash;
 	u32 fullhash;
 	u32 cluthash;
+	// With write tracking, the stamp from when fullhash was computed and the size hashed. 0 if untracked.
+	u64 writeStamp;
+	u32 writeStampSize;
 	u16 maxSeenV;
+	// Exact size of the backend texture in bytes, including mips. Counted against the memory budget.
+	u32 memoryUsage;
 	ReplacedTexture *replacedTexture;
 
 	TexStatus GetHashStatus() {
@@ -317,6 +326,10 @@ struct BuildTexturePlan {
 	// TODO: Expand32 should probably also be decided in PrepareBuildTexture.
 	bool decodeToClut8;
 
+	// If not UNDEFINED, the DXT blocks are uploaded as is in this BC format instead of being decoded.
+	// Backends that can't do this for some reason (like generating mips) must ignore it.
+	Draw::DataFormat nativeDXTFormat = Draw::DataFormat::UNDEFINED;
+
 	void GetMipSize(int level, int *w, int *h) const {
 		if (doReplace) {
 			replaced->GetSize(level, w, h);
@@ -351,8 +364,18 @@ class TextureCacheCommon {
 
 	void ApplyTexture();
 	bool SetOffsetTexture(u32 yOffset);
+
+	// Through mode sprites with small textures can be drawn from a shared atlas instead, so that the
+	// draw engine doesn't need to flush on every texture change. Returns false if the current texture
+	// can't be placed there. Otherwise, x/y is where its texels start in the atlas.
+	bool GetAtlasSlot(bool newBatch, u16 *x, u16 *y);
+	// Used instead of SetTexture when the queued draws got their texcoords from GetAtlasSlot.
+	void SetAtlasTexture();
 	void Invalidate(u32 addr, int size, GPUInvalidationType type);
 	void InvalidateAll(GPUInvalidationType type);
+	// Any texture's memory may have changed, e.g. after loading a state.  Rehashes each on next use,
+	// keeping those that still match.
+	void RehashAll();
 	void ClearNextFrame();
 
 	TextureShaderCache *GetTextureShaderCache() { return textureShaderCache_; }
@@ -370,6 +393,11 @@ class TextureCacheCommon {
 	size_t NumLoadedTextures() const {
 		return cache_.size();
 	}
+	// Bytes of texture memory held by the primary and secondary caches.
+	u64 CacheMemoryUsage() const {
+		return cacheMemoryUsage_ + secondCacheMemoryUsage_;
+	}
+	u64 CacheMemoryBudget() const;
 
 	bool IsFakeMipmapChange() {
 		return PSP_CoreParameter().compat.flags().FakeMipmapChange && gstate.getTexLevelMode() == GE_TEXLEVEL_MODE_CONST;
@@ -380,6 +408,8 @@ class TextureCacheCommon {
 	virtual bool GetCurrentTextureDebug(GPUDebugBuffer &buffer, int level, bool *isFramebuffer) { return false; }
 
 	virtual void StartFrame();
+	// Backends that can query the driver's memory budget return true when close to it.
+	virtual bool IsUnderMemoryPressure() const { return false; }
 
 	virtual void DeviceLost() = 0;
 	virtual void DeviceRestore(Draw::DrawContext *draw) = 0;
@@ -394,21 +424,33 @@ class TextureCacheCommon {
 	virtual void Unbind() = 0;
 	virtual void ReleaseTexture(TexCacheEntry *entry, bool delete_them) = 0;
 	void DeleteTexture(TexCache::iterator it);
+	void DeleteSecondTexture(TexCache::iterator it);
 	void Decimate(TexCacheEntry *exceptThisOne, bool forcePressure);  // forcePressure defaults to false.
+	void EnforceMemoryBudget(TexCacheEntry *exceptThisOne);
 
 	void ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer, GETextureFormat texFormat, RasterChannel channel);
 	void ApplyTextureDepal(TexCacheEntry *entry);
+	void ReinterpretDynamicClut(GEPaletteFormat clutFormat);
 
 	void HandleTextureChange(TexCacheEntry *const entry, const char *reason, bool initialMatch, bool doDelete);
 	virtual void BuildTexture(TexCacheEntry *const entry) = 0;
 	virtual void UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) = 0;
 	bool CheckFullHash(TexCacheEntry *entry, bool &doDelete);
+	// Like QuickTexHash, but with write tracking also protects the memory first, for CheckFullHash to skip later.
+	u32 HashTexture(TexCacheEntry *entry, int w, int h, bool swizzled, u64 *writeStamp, u32 *writeStampSize);
+	bool TrackTextureWrites(const TexCacheEntry *entry, u32 hashSize);
 
 	virtual void BindAsClutTexture(Draw::Texture *tex, bool smooth) {}
+	virtual void BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) {}
+	void ApplyAtlasTexture();
+	bool AllocateAtlasSlot(int w, int h, u16 *x, u16 *y);
+	void ClearAtlas();
 
+	// Large levels are decoded in bands on worker threads.
 	CheckAlphaResult DecodeTextureLevel(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, TexDecodeFlags flags);
+	CheckAlphaResult DecodeTextureRows(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, int w, int h, TexDecodeFlags flags, AlignedVector<u32, 16> &tmpBuf);
 	static void UnswizzleFromMem(u32 *dest, u32 destPitch, const u8 *texptr, u32 bufw, u32 height, u32 bytesPerPixel);
-	CheckAlphaResult ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool reverseColors, bool expandTo32Bit);
+	CheckAlphaResult ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, int w, int h, bool reverseColors, bool expandTo32Bit, AlignedVector<u32, 16> &tmpBuf);
 	ReplacedTexture *FindReplacement(TexCacheEntry *entry, int *w, int *h, int *d);
 	void PollReplacement(TexCacheEntry *entry, int *w, int *h, int *d);
 
@@ -426,6 +468,12 @@ class TextureCacheCommon {
 	}
 
 	static u32 EstimateTexMemoryUsage(const TexCacheEntry *entry);
+	// Exact size of a texture as created by the backend. blockSize is non-zero for block compressed
+	// formats, and is then the size in bytes of a 4x4 block.
+	static u32 TextureMemoryUsage(int w, int h, int depth, int levels, int bytesPerPixel, int blockSize);
+	static u32 TextureMemoryUsage(int w, int h, int depth, int levels, Draw::DataFormat fmt);
+	// Backends call this once the texture for the entry has been created.
+	void SetEntryMemoryUsage(TexCacheEntry *entry, u32 bytes);
 
 	SamplerCacheKey GetSamplingParams(int maxLevel, const TexCacheEntry *entry);
 	SamplerCacheKey GetFramebufferSamplingParams(u16 bufferWidth, u16 bufferHeight);
@@ -445,26 +493,28 @@ class TextureCacheCommon {
 
 	static CheckAlphaResult CheckCLUTAlpha(const uint8_t *pixelData, GEPaletteFormat clutFmt, int w);
 
-	static inline u32 QuickTexHash(TextureReplacer &replacer, u32 addr, int bufw, int w, int h, bool swizzled, GETextureFormat format, const TexCacheEntry *entry) {
-		if (replacer.Enabled()) {
-			return replacer.ComputeHash(addr, bufw, w, h, swizzled, format, entry->maxSeenV);
-		}
-
+	static inline u32 QuickTexHashSize(int bufw, int h, bool swizzled, GETextureFormat format, const TexCacheEntry *entry) {
 		if (h == 512 && entry->maxSeenV < 512 && entry->maxSeenV != 0) {
 			h = (int)entry->maxSeenV;
 		}
 
-		u32 sizeInRAM;
 		if (swizzled) {
 			// In swizzle mode, textures are stored in rectangular blocks with the height 8.
 			// That means that for a 64x4 texture, like in issue #9308, we would only hash half of the texture!
 			// In theory, we should make sure to only hash half of each block, but in reality it's not likely that
 			// games are using that memory for anything else. So we'll just make sure to compute the full size to hash.
 			// To do that, we just use the same calculation but round the height upwards to the nearest multiple of 8.
-			sizeInRAM = (textureBitsPerPixel[format] * bufw * ((h + 7) & ~7)) >> 3;
-		} else {
-			sizeInRAM = (textureBitsPerPixel[format] * bufw * h) >> 3;
+			return (textureBitsPerPixel[format] * bufw * ((h + 7) & ~7)) >> 3;
 		}
+		return (textureBitsPerPixel[format] * bufw * h) >> 3;
+	}
+
+	static inline u32 QuickTexHash(TextureReplacer &replacer, u32 addr, int bufw, int w, int h, bool swizzled, GETextureFormat format, const TexCacheEntry *entry) {
+		if (replacer.Enabled()) {
+			return replacer.ComputeHash(addr, bufw, w, h, swizzled, format, entry->maxSeenV);
+		}
+
+		const u32 sizeInRAM = QuickTexHashSize(bufw, h, swizzled, format, entry);
 		const u32 *checkp = (const u32 *)Memory::GetPointer(addr);
 
 		gpuStats.numTextureDataBytesHashed += sizeInRAM;
@@ -501,9 +551,11 @@ class TextureCacheCommon {
 
 	TexCache cache_;
 	u32 cacheSizeEstimate_ = 0;
+	u64 cacheMemoryUsage_ = 0;
 
 	TexCache secondCache_;
 	u32 secondCacheSizeEstimate_ = 0;
+	u64 secondCacheMemoryUsage_ = 0;
 
 	struct VideoInfo {
 		u32 addr;
@@ -516,6 +568,7 @@ class TextureCacheCommon {
 	AlignedVector<u32, 16> tmpTexBufRearrange_;
 
 	TexCacheEntry *nextTexture_ = nullptr;
+	bool nextAtlasTexture_ = false;
 	bool failedTexture_ = false;
 	VirtualFramebuffer *nextFramebufferTexture_ = nullptr;
 	RasterChannel nextFramebufferTextureChannel_ = RASTER_COLOR;
@@ -541,6 +594,31 @@ class TextureCacheCommon {
 	// Facilities for GPU depal of static textures.
 	Draw::Framebuffer *dynamicClutTemp_ = nullptr;
 	Draw::Framebuffer *dynamicClutFbo_ = nullptr;
+	// Palette format dynamicClutFbo_ currently holds, 0xFFFFFFFF after a new CLUT load.
+	u32 dynamicClutFboFormat_ = 0xFFFFFFFF;
+
+	// Sprite atlas, see GetAtlasSlot. Slots are keyed by a hash of the texture data and CLUT.
+	// Slots are never reused within a frame, so draws that were already flushed stay valid.
+	// Each frame uploads into its own texture, to not touch one the GPU is still reading from.
+	enum {
+		ATLAS_SIZE = 512,
+		ATLAS_MAX_TEXTURE_SIZE = 64,
+		ATLAS_FRAMES = 4,
+	};
+	struct AtlasSlot {
+		u16 x;
+		u16 y;
+	};
+	std::unordered_map<u64, AtlasSlot> atlasSlots_;
+	std::vector<u32> atlasPixels_;
+	Draw::Texture *atlasTextures_[ATLAS_FRAMES]{};
+	u32 atlasTextureVersions_[ATLAS_FRAMES]{};
+	u32 atlasVersion_ = 0;
+	int atlasShelfX_ = 0;
+	int atlasShelfY_ = 0;
+	int atlasShelfHeight_ = 0;
+	bool atlasFull_ = false;
+	bool atlasUsedThisFrame_ = false;
 
 	int standardScaleFactor_;
 	int shaderScaleFactor_ = 0;
@@ -20,6 +20,7 @@
 #include "ext/xxhash.h"
 
 #include "Common/Common.h"
+#include "Common/CPUDetect.h"
 #include "Common/Log.h"
 #include "Common/Math/SIMDHeaders.h"
 
@@ -28,6 +29,19 @@
 
 #include "Common/Math/SIMDHeaders.h"
 
+#if PPSSPP_ARCH(SSE2)
+// For pshufb and the AVX2 gathers, both used only after checking cpu_info.
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+#define TARGET_SSSE3 [[gnu::target("ssse3")]]
+#define TARGET_AVX2 [[gnu::target("avx2")]]
+#else
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#endif
+
 const u8 textureBitsPerPixel[16] = {
 	16,  //GE_TFMT_5650,
 	16,  //GE_TFMT_5551,
@@ -99,10 +113,14 @@ static u32 QuickTexHashNEON(const void *checkp, u32 size) {
 		const u32 *p = (const u32 *)checkp;
 		const u32 *pend = p + size / 4;
 		while (p < pend) {
-			cursor = vreinterpretq_u32_u16(vmlaq_u16(vreinterpretq_u16_u32(cursor), vreinterpretq_u16_u32(vld1q_u32(&p[4 * 0])), cursor2));
+			// Multiply separately rather than with vmla, so the multiplies stay off the dependency chain through cursor.
+			// The result is the same, the accumulate latency just hurt on in-order cores.
+			uint16x8_t chunk0 = vmulq_u16(vreinterpretq_u16_u32(vld1q_u32(&p[4 * 0])), cursor2);
+			uint16x8_t chunk3 = vmulq_u16(vreinterpretq_u16_u32(vld1q_u32(&p[4 * 3])), cursor2);
+			cursor = vreinterpretq_u32_u16(vaddq_u16(vreinterpretq_u16_u32(cursor), chunk0));
 			cursor = veorq_u32(cursor, vld1q_u32(&p[4 * 1]));
 			cursor = vaddq_u32(cursor, vld1q_u32(&p[4 * 2]));
-			cursor = veorq_u32(cursor, vreinterpretq_u32_u16(vmulq_u16(vreinterpretq_u16_u32(vld1q_u32(&p[4 * 3])), cursor2)));
+			cursor = veorq_u32(cursor, vreinterpretq_u32_u16(chunk3));
 			cursor2 = vaddq_u16(cursor2, update);
 
 			p += 4 * 4;
@@ -644,6 +662,77 @@ void DecodeDXT5Block(u32 *dst, const DXT5Block *src, int pitch, int width, int h
 	dxt.WriteColorsDXT5(dst, src, pitch, width, height);
 }
 
+void ConvertDXT1ToBC1(u8 *dst, const DXT1Block *src, int count, bool *anyNonFullAlpha) {
+	for (int i = 0; i < count; i++) {
+		// BC1 has the two colors first, then the same index bytes.
+		const u8 *block = (const u8 *)&src[i];
+		memcpy(dst, block + 4, 4);
+		memcpy(dst + 4, block, 4);
+		if (src[i].color1 <= src[i].color2) {
+			u32 lines;
+			memcpy(&lines, src[i].lines, 4);
+			// Any index 3, which is transparent black in three-color mode.
+			if (lines & (lines >> 1) & 0x55555555)
+				*anyNonFullAlpha = true;
+		}
+		dst += 8;
+	}
+}
+
+void ConvertDXT3ToBC2(u8 *dst, const DXT3Block *src, int count) {
+	for (int i = 0; i < count; i++) {
+		const u8 *block = (const u8 *)&src[i];
+		memcpy(dst, block + 8, 8);
+		memcpy(dst + 8, block + 4, 4);
+		memcpy(dst + 12, block, 4);
+		dst += 16;
+	}
+}
+
+void ConvertDXT5ToBC3(u8 *dst, const DXT5Block *src, int count) {
+	for (int i = 0; i < count; i++) {
+		// The PSP stores the two alpha values last, and the 48 index bits as a u32 followed by a u16.
+		// Both are little endian, so the index bytes are already in BC3 order.
+		const u8 *block = (const u8 *)&src[i];
+		dst[0] = src[i].alpha1;
+		dst[1] = src[i].alpha2;
+		memcpy(dst + 2, block + 8, 6);
+		memcpy(dst + 8, block + 4, 4);
+		memcpy(dst + 12, block, 4);
+		dst += 16;
+	}
+}
+
+static inline bool DXTColorMatchesBC(const DXT1Block *src) {
+	u16 c1 = src->color1;
+	u16 c2 = src->color2;
+	if (c1 > c2)
+		return true;
+	u32 lines;
+	memcpy(&lines, src->lines, 4);
+	// Index 3 is black in three-color mode.
+	if (lines & (lines >> 1) & 0x55555555)
+		return false;
+	// Index 2 is the average, which is only the same when both colors are.
+	return c1 == c2 || ((lines >> 1) & ~lines & 0x55555555) == 0;
+}
+
+bool DXTColorsMatchBC(const DXT3Block *src, int count) {
+	for (int i = 0; i < count; i++) {
+		if (!DXTColorMatchesBC(&src[i].color))
+			return false;
+	}
+	return true;
+}
+
+bool DXTColorsMatchBC(const DXT5Block *src, int count) {
+	for (int i = 0; i < count; i++) {
+		if (!DXTColorMatchesBC(&src[i].color))
+			return false;
+	}
+	return true;
+}
+
 #ifdef _M_SSE
 inline u32 SSEReduce32And(__m128i value) {
 	value = _mm_and_si128(value, _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));
@@ -811,3 +900,259 @@ void CheckMask32(const u32 *src, int width, u32 *outMask) {
 	}
 	*outMask &= (u32)mask;
 }
+
+// CLUT lookups for the naked index case. The SIMD kernels handle whole blocks and return
+// how many pixels they did, ANDing the colors into *mask. The rest is left to the scalar loops.
+
+#ifdef _M_SSE
+// A 16-entry table can be looked up with pshufb, one table per byte of the color.
+TARGET_SSSE3
+static int DeIndexTexture4SSSE3(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *mask) {
+	const __m128i lowMask = _mm_set1_epi16(0x00FF);
+	const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+	const __m128i c0 = _mm_loadu_si128((const __m128i *)clut);
+	const __m128i c1 = _mm_loadu_si128((const __m128i *)(clut + 8));
+	const __m128i tableLo = _mm_packus_epi16(_mm_and_si128(c0, lowMask), _mm_and_si128(c1, lowMask));
+	const __m128i tableHi = _mm_packus_epi16(_mm_srli_epi16(c0, 8), _mm_srli_epi16(c1, 8));
+
+	__m128i wideMask = _mm_set1_epi32(0xFFFFFFFF);
+	int i = 0;
+	for (; i + 32 <= length; i += 32) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(indexed + i / 2));
+		__m128i lo = _mm_and_si128(in, nibbleMask);
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), nibbleMask);
+		// The low nibble is the first pixel.
+		__m128i idx[2] = { _mm_unpacklo_epi8(lo, hi), _mm_unpackhi_epi8(lo, hi) };
+		for (int j = 0; j < 2; j++) {
+			__m128i l = _mm_shuffle_epi8(tableLo, idx[j]);
+			__m128i h = _mm_shuffle_epi8(tableHi, idx[j]);
+			__m128i color0 = _mm_unpacklo_epi8(l, h);
+			__m128i color1 = _mm_unpackhi_epi8(l, h);
+			_mm_storeu_si128((__m128i *)(dest + i + j * 16), color0);
+			_mm_storeu_si128((__m128i *)(dest + i + j * 16 + 8), color1);
+			wideMask = _mm_and_si128(wideMask, _mm_and_si128(color0, color1));
+		}
+	}
+	*mask &= SSEReduce16And(wideMask);
+	return i;
+}
+
+TARGET_SSSE3
+static int DeIndexTexture4SSSE3(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *mask) {
+	const __m128i lowMask = _mm_set1_epi32(0x000000FF);
+	const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+	__m128i c[4];
+	for (int k = 0; k < 4; k++)
+		c[k] = _mm_loadu_si128((const __m128i *)(clut + k * 4));
+	__m128i table[4];
+	for (int b = 0; b < 4; b++) {
+		__m128i p[4];
+		for (int k = 0; k < 4; k++)
+			p[k] = _mm_and_si128(_mm_srli_epi32(c[k], b * 8), lowMask);
+		table[b] = _mm_packus_epi16(_mm_packs_epi32(p[0], p[1]), _mm_packs_epi32(p[2], p[3]));
+	}
+
+	__m128i wideMask = _mm_set1_epi32(0xFFFFFFFF);
+	int i = 0;
+	for (; i + 32 <= length; i += 32) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(indexed + i / 2));
+		__m128i lo = _mm_and_si128(in, nibbleMask);
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), nibbleMask);
+		__m128i idx[2] = { _mm_unpacklo_epi8(lo, hi), _mm_unpackhi_epi8(lo, hi) };
+		for (int j = 0; j < 2; j++) {
+			__m128i b0 = _mm_shuffle_epi8(table[0], idx[j]);
+			__m128i b1 = _mm_shuffle_epi8(table[1], idx[j]);
+			__m128i b2 = _mm_shuffle_epi8(table[2], idx[j]);
+			__m128i b3 = _mm_shuffle_epi8(table[3], idx[j]);
+			__m128i b01lo = _mm_unpacklo_epi8(b0, b1);
+			__m128i b01hi = _mm_unpackhi_epi8(b0, b1);
+			__m128i b23lo = _mm_unpacklo_epi8(b2, b3);
+			__m128i b23hi = _mm_unpackhi_epi8(b2, b3);
+			__m128i color[4] = {
+				_mm_unpacklo_epi16(b01lo, b23lo),
+				_mm_unpackhi_epi16(b01lo, b23lo),
+				_mm_unpacklo_epi16(b01hi, b23hi),
+				_mm_unpackhi_epi16(b01hi, b23hi),
+			};
+			for (int k = 0; k < 4; k++) {
+				_mm_storeu_si128((__m128i *)(dest + i + j * 16 + k * 4), color[k]);
+				wideMask = _mm_and_si128(wideMask, color[k]);
+			}
+		}
+	}
+	*mask &= SSEReduce32And(wideMask);
+	return i;
+}
+
+// Gathers are not fast, but still beat the scalar loop on most AVX2 chips.
+TARGET_AVX2
+static int DeIndexTexture8AVX2(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *mask) {
+	__m256i wideMask = _mm256_set1_epi32(0xFFFFFFFF);
+	int i = 0;
+	for (; i + 8 <= length; i += 8) {
+		__m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indexed + i)));
+		__m256i color = _mm256_i32gather_epi32((const int *)clut, idx, 4);
+		_mm256_storeu_si256((__m256i *)(dest + i), color);
+		wideMask = _mm256_and_si256(wideMask, color);
+	}
+	*mask &= SSEReduce32And(_mm_and_si128(_mm256_castsi256_si128(wideMask), _mm256_extracti128_si256(wideMask, 1)));
+	return i;
+}
+
+TARGET_AVX2
+static int DeIndexTexture8AVX2(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *mask) {
+	// Gather the aligned pair containing each entry, so we never read past the end of the CLUT.
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+	__m256i wideMask = _mm256_set1_epi32(0xFFFFFFFF);
+	int i = 0;
+	for (; i + 16 <= length; i += 16) {
+		__m256i color[2];
+		for (int j = 0; j < 2; j++) {
+			__m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indexed + i + j * 8)));
+			__m256i pair = _mm256_i32gather_epi32((const int *)clut, _mm256_srli_epi32(idx, 1), 4);
+			__m256i shift = _mm256_slli_epi32(_mm256_and_si256(idx, one), 4);
+			color[j] = _mm256_and_si256(_mm256_srlv_epi32(pair, shift), lowMask);
+		}
+		// packus works within 128-bit lanes, so fix up the order afterwards.
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(color[0], color[1]), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256((__m256i *)(dest + i), packed);
+		wideMask = _mm256_and_si256(wideMask, packed);
+	}
+	*mask &= SSEReduce16And(_mm_and_si128(_mm256_castsi256_si128(wideMask), _mm256_extracti128_si256(wideMask, 1)));
+	return i;
+}
+#endif
+
+#if PPSSPP_ARCH(ARM64_NEON)
+static inline u32 NEONReduce8And(uint8x16_t value) {
+	uint64x2_t value64 = vreinterpretq_u64_u8(value);
+	u64 mask = vgetq_lane_u64(value64, 0) & vgetq_lane_u64(value64, 1);
+	mask &= mask >> 32;
+	mask &= mask >> 16;
+	mask &= mask >> 8;
+	return (u32)(mask & 0xFF);
+}
+
+// tbl does the 16-entry lookup, and the interleaving stores put the bytes of each color back together.
+static int DeIndexTexture4NEON(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *mask) {
+	uint8x16x2_t table = vld2q_u8((const u8 *)clut);
+	uint8x16_t maskLo = vdupq_n_u8(0xFF);
+	uint8x16_t maskHi = vdupq_n_u8(0xFF);
+	int i = 0;
+	for (; i + 32 <= length; i += 32) {
+		uint8x16_t in = vld1q_u8(indexed + i / 2);
+		uint8x16_t lo = vandq_u8(in, vdupq_n_u8(0x0F));
+		uint8x16_t hi = vshrq_n_u8(in, 4);
+		uint8x16_t idx[2] = { vzip1q_u8(lo, hi), vzip2q_u8(lo, hi) };
+		for (int j = 0; j < 2; j++) {
+			uint8x16x2_t color;
+			color.val[0] = vqtbl1q_u8(table.val[0], idx[j]);
+			color.val[1] = vqtbl1q_u8(table.val[1], idx[j]);
+			vst2q_u8((u8 *)(dest + i + j * 16), color);
+			maskLo = vandq_u8(maskLo, color.val[0]);
+			maskHi = vandq_u8(maskHi, color.val[1]);
+		}
+	}
+	*mask &= NEONReduce8And(maskLo) | (NEONReduce8And(maskHi) << 8);
+	return i;
+}
+
+static int DeIndexTexture4NEON(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *mask) {
+	uint8x16x4_t table = vld4q_u8((const u8 *)clut);
+	uint8x16_t byteMask[4];
+	for (int b = 0; b < 4; b++)
+		byteMask[b] = vdupq_n_u8(0xFF);
+	int i = 0;
+	for (; i + 32 <= length; i += 32) {
+		uint8x16_t in = vld1q_u8(indexed + i / 2);
+		uint8x16_t lo = vandq_u8(in, vdupq_n_u8(0x0F));
+		uint8x16_t hi = vshrq_n_u8(in, 4);
+		uint8x16_t idx[2] = { vzip1q_u8(lo, hi), vzip2q_u8(lo, hi) };
+		for (int j = 0; j < 2; j++) {
+			uint8x16x4_t color;
+			for (int b = 0; b < 4; b++) {
+				color.val[b] = vqtbl1q_u8(table.val[b], idx[j]);
+				byteMask[b] = vandq_u8(byteMask[b], color.val[b]);
+			}
+			vst4q_u8((u8 *)(dest + i + j * 16), color);
+		}
+	}
+	u32 reduced = 0;
+	for (int b = 0; b < 4; b++)
+		reduced |= NEONReduce8And(byteMask[b]) << (b * 8);
+	*mask &= reduced;
+	return i;
+}
+#endif
+
+template <typename ClutT>
+static void DeIndexTexture4Tail(ClutT *dest, const u8 *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+	ClutT alphaSum = (ClutT)(-1);
+	while (length >= 2) {
+		u8 index = *indexed++;
+		ClutT color0 = clut[index & 0xf];
+		ClutT color1 = clut[index >> 4];
+		*dest++ = color0;
+		*dest++ = color1;
+		alphaSum &= color0 & color1;
+		length -= 2;
+	}
+	if (length) {  // Last pixel. Can really only happen in 1xY textures, but making this work generically.
+		ClutT color0 = clut[*indexed & 0xf];
+		*dest = color0;
+		alphaSum &= color0;
+	}
+	*outAlphaSum &= (u32)alphaSum;
+}
+
+template <typename ClutT>
+static void DeIndexTexture8Tail(ClutT *dest, const u8 *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+	ClutT alphaSum = (ClutT)(-1);
+	DO_NOT_VECTORIZE_LOOP
+	for (int i = 0; i < length; ++i) {
+		ClutT color = clut[indexed[i]];
+		alphaSum &= color;
+		dest[i] = color;
+	}
+	*outAlphaSum &= (u32)alphaSum;
+}
+
+template <typename ClutT>
+static void DeIndexTexture4SimpleImpl(ClutT *dest, const u8 *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+	int done = 0;
+#ifdef _M_SSE
+	if (cpu_info.bSSSE3)
+		done = DeIndexTexture4SSSE3(dest, indexed, length, clut, outAlphaSum);
+#elif PPSSPP_ARCH(ARM64_NEON)
+	done = DeIndexTexture4NEON(dest, indexed, length, clut, outAlphaSum);
+#endif
+	// The SIMD paths always do an even number of pixels.
+	DeIndexTexture4Tail(dest + done, indexed + done / 2, length - done, clut, outAlphaSum);
+}
+
+template <typename ClutT>
+static void DeIndexTexture8SimpleImpl(ClutT *dest, const u8 *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+	int done = 0;
+#ifdef _M_SSE
+	if (cpu_info.bAVX2)
+		done = DeIndexTexture8AVX2(dest, indexed, length, clut, outAlphaSum);
+#endif
+	DeIndexTexture8Tail(dest + done, indexed + done, length - done, clut, outAlphaSum);
+}
+
+void DeIndexTexture4Simple(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+	DeIndexTexture4SimpleImpl(dest, indexed, length, clut, outAlphaSum);
+}
+
+void DeIndexTexture4Simple(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+	DeIndexTexture4SimpleImpl(dest, indexed, length, clut, outAlphaSum);
+}
+
+void DeIndexTexture8Simple(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+	DeIndexTexture8SimpleImpl(dest, indexed, length, clut, outAlphaSum);
+}
+
+void DeIndexTexture8Simple(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+	DeIndexTexture8SimpleImpl(dest, indexed, length, clut, outAlphaSum);
+}
@@ -68,6 +68,17 @@ void DecodeDXT1Block(u32 *dst, const DXT1Block *src, int pitch, int width, int h
 void DecodeDXT3Block(u32 *dst, const DXT3Block *src, int pitch, int width, int height);
 void DecodeDXT5Block(u32 *dst, const DXT5Block *src, int pitch, int width, int height);
 
+// PSP DXT blocks hold the same data as BC1/BC2/BC3 blocks, just in a different order, so these only shuffle bytes.
+// Converts count blocks. anyNonFullAlpha is set if a three-color DXT1 block uses the transparent index.
+void ConvertDXT1ToBC1(u8 *dst, const DXT1Block *src, int count, bool *anyNonFullAlpha);
+void ConvertDXT3ToBC2(u8 *dst, const DXT3Block *src, int count);
+void ConvertDXT5ToBC3(u8 *dst, const DXT5Block *src, int count);
+
+// The PSP picks three-color mode for DXT3/DXT5 colors too, while BC2/BC3 always decode four colors.
+// Returns false if any of the blocks uses an index that would decode differently as BC2/BC3.
+bool DXTColorsMatchBC(const DXT3Block *src, int count);
+bool DXTColorsMatchBC(const DXT5Block *src, int count);
+
 uint32_t GetDXT1Texel(const DXT1Block *src, int x, int y);
 uint32_t GetDXT3Texel(const DXT3Block *src, int x, int y);
 uint32_t GetDXT5Texel(const DXT5Block *src, int x, int y);
@@ -106,6 +117,14 @@ inline CheckAlphaResult CheckAlpha32Rect(const u32 *pixelData, int stride, int w
 	return AlphaSumIsFull(alphaSum, fullAlphaMask) ? CHECKALPHA_FULL : CHECKALPHA_ANY;
 }
 
+// CLUT lookups without any index shift, mask or offset, for 4-bit and 8-bit indices.
+// These use SIMD where available, and AND all the written colors into outAlphaSum.
+// The 8-bit versions require a full 256-entry CLUT to be readable.
+void DeIndexTexture4Simple(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum);
+void DeIndexTexture4Simple(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum);
+void DeIndexTexture8Simple(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum);
+void DeIndexTexture8Simple(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum);
+
 template <typename IndexT, typename ClutT>
 inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const IndexT *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
 	// Usually, there is no special offset, mask, or shift.
@@ -114,12 +133,9 @@ inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const IndexT *indexed, int
 	ClutT alphaSum = (ClutT)(-1);
 
 	if (nakedIndex) {
-		if (sizeof(IndexT) == 1) {
-			for (int i = 0; i < length; ++i) {
-				ClutT color = clut[*indexed++];
-				alphaSum &= color;
-				*dest++ = color;
-			}
+		if constexpr (sizeof(IndexT) == 1) {
+			DeIndexTexture8Simple(dest, (const u8 *)indexed, length, clut, outAlphaSum);
+			return;
 		} else {
 			for (int i = 0; i < length; ++i) {
 				ClutT color = clut[(*indexed++) & 0xFF];
@@ -151,21 +167,8 @@ inline void DeIndexTexture4(/*WRITEONLY*/ ClutT *dest, const u8 *indexed, int le
 
 	ClutT alphaSum = (ClutT)(-1);
 	if (nakedIndex) {
-		while (length >= 2) {
-			u8 index = *indexed++;
-			ClutT color0 = clut[index & 0xf];
-			ClutT color1 = clut[index >> 4];
-			*dest++ = color0;
-			*dest++ = color1;
-			alphaSum &= color0 & color1;
-			length -= 2;
-		}
-		if (length) {  // Last pixel. Can really only happen in 1xY textures, but making this work generically.
-			u8 index = *indexed++;
-			ClutT color0 = clut[index & 0xf];
-			*dest = color0;
-			alphaSum &= color0;
-		}
+		DeIndexTexture4Simple(dest, indexed, length, clut, outAlphaSum);
+		return;
 	} else {
 		while (length >= 2) {
 			u8 index = *indexed++;
@@ -17,6 +17,8 @@
 
 #include "ppsspp_config.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <png.h>
@@ -31,6 +33,7 @@
 #include "Common/File/VFS/ZipFileReader.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/VFS/VFS.h"
+#include "Common/LogReporting.h"
 #include "Common/StringUtils.h"
 #include "Common/System/OSD.h"
 #include "Common/Thread/ThreadManager.h"
@@ -44,6 +47,12 @@
 static const std::string INI_FILENAME = "textures.ini";
 static const std::string ZIP_FILENAME = "textures.zip";
 static const std::string NEW_TEXTURE_DIR = "new/";
+static const std::string TRANSCODE_DIR = "transcoded";
+// Kept next to the pack rather than inside, since zip packs are read-only.
+static const std::string PREFETCH_FILENAME = "textures.prefetch";
+// How many upcoming replacements in the log to start loading when we hit a logged one.
+static const size_t PREFETCH_AHEAD = 8;
+static const double PREFETCH_SAVE_INTERVAL = 10.0;
 static const int VERSION = 1;
 static const double MAX_CACHE_SIZE = 4.0;
 static bool basisu_initialized = false;
@@ -61,6 +70,7 @@ TextureReplacer::TextureReplacer(Draw::DrawContext *draw) {
 }
 
 TextureReplacer::~TextureReplacer() {
+	SavePrefetchLog();
 	for (auto iter : levelCache_) {
 		delete iter.second;
 	}
@@ -68,11 +78,18 @@ TextureReplacer::~TextureReplacer() {
 }
 
 void TextureReplacer::NotifyConfigChanged() {
+	// Write out what we have so far while basePath_ is still the old one, the log is reloaded below if still enabled.
+	SavePrefetchLog();
+	prefetchLog_.clear();
+	prefetchIndex_.clear();
+	prefetchSaved_ = 0;
+
 	gameID_ = g_paramSFO.GetDiscID();
 
 	bool wasReplaceEnabled = replaceEnabled_;
 	replaceEnabled_ = g_Config.bReplaceTextures;
 	saveEnabled_ = g_Config.bSaveNewTextures;
+	prefetchEnabled_ = g_Config.bReplaceTexturesPrefetch;
 	if (replaceEnabled_ || saveEnabled_) {
 		basePath_ = GetSysDirectory(DIRECTORY_TEXTURES) / gameID_;
 		replaceEnabled_ = replaceEnabled_ && File::IsDirectory(basePath_);
@@ -100,6 +117,9 @@ void TextureReplacer::NotifyConfigChanged() {
 			ERROR_LOG(Log::G3D, "ERROR: %s", error.c_str());
 			g_OSD.Show(OSDType::MESSAGE_ERROR, error, 5.0f);
 		}
+		if (replaceEnabled_ && prefetchEnabled_) {
+			LoadPrefetchLog();
+		}
 	} else if (saveEnabled_) {
 		// Even if just saving is enabled, it makes sense to load the ini to get the correct
 		// settings for saving. See issue #19086
@@ -603,6 +623,18 @@ ReplacedTexture *TextureReplacer::FindReplacement(u64 cachekey, u32 hash, int w,
 		return it->second.texture;
 	}
 
+	ReplacedTexture *texture = CreateReplacement(replacementKey, w, h);
+	if (prefetchEnabled_ && replaceEnabled_ && vfs_) {
+		Prefetch(replacementKey, w, h, texture);
+	}
+	return texture;
+}
+
+// Looks up or creates the texture for a key that's not in cache_ yet, and adds it.
+ReplacedTexture *TextureReplacer::CreateReplacement(const ReplacementCacheKey &replacementKey, int w, int h) {
+	u64 cachekey = replacementKey.cachekey;
+	u32 hash = replacementKey.hash;
+
 	ReplacementDesc desc;
 	desc.newW = w;
 	desc.newH = h;
@@ -669,6 +701,9 @@ ReplacedTexture *TextureReplacer::FindReplacement(u64 cachekey, u32 hash, int w,
 	// Final path - we actually need a new replacement texture, because we haven't seen "hashfiles" before.
 	desc.basePath = basePath_;
 	desc.formatSupport = formatSupport_;
+	if (g_Config.bReplaceTexturesTranscode && formatSupport_.bc123) {
+		desc.transcodeDir = basePath_ / TRANSCODE_DIR;
+	}
 
 	ReplacedTexture *texture = new ReplacedTexture(vfs_, desc);
 
@@ -682,14 +717,121 @@ ReplacedTexture *TextureReplacer::FindReplacement(u64 cachekey, u32 hash, int w,
 	return texture;
 }
 
-static bool WriteTextureToPNG(png_imagep image, const Path &filename, int convert_to_8bit, const void *buffer, png_int_32 row_stride, const void *colormap) {
+void TextureReplacer::Prefetch(const ReplacementCacheKey &replacementKey, int w, int h, ReplacedTexture *texture) {
+	auto pos = prefetchIndex_.find(replacementKey);
+	if (pos == prefetchIndex_.end()) {
+		// Not seen on an earlier run, record it. Ignored textures aren't worth logging.
+		if (texture) {
+			prefetchIndex_[replacementKey] = prefetchLog_.size();
+			prefetchLog_.push_back(ReplacementPrefetchEntry{ replacementKey, w, h });
+		}
+		return;
+	}
+
+	// The game is likely to request the same textures in the same order as last time,
+	// so start loading the ones that came right after this one in the background.
+	size_t end = std::min(pos->second + 1 + PREFETCH_AHEAD, prefetchLog_.size());
+	for (size_t i = pos->second + 1; i < end; i++) {
+		const ReplacementPrefetchEntry &entry = prefetchLog_[i];
+		if (cache_.find(entry.key) != cache_.end()) {
+			// Already requested or prefetched.
+			continue;
+		}
+		ReplacedTexture *next = CreateReplacement(entry.key, entry.w, entry.h);
+		if (next) {
+			// A zero budget only kicks off the load task, doesn't wait for it.
+			next->Poll(0.0);
+		}
+	}
+}
+
+void TextureReplacer::LoadPrefetchLog() {
+	FILE *f = File::OpenCFile(basePath_ / PREFETCH_FILENAME, "r");
+	if (!f) {
+		return;
+	}
+
+	char line[128];
+	while (fgets(line, sizeof(line), f)) {
+		unsigned long long cachekey;
+		unsigned int hash;
+		int w, h;
+		if (sscanf(line, "%16llx %8x %d %d", &cachekey, &hash, &w, &h) != 4 || w <= 0 || h <= 0) {
+			continue;
+		}
+		ReplacementCacheKey key((u64)cachekey, (u32)hash);
+		if (prefetchIndex_.find(key) != prefetchIndex_.end()) {
+			continue;
+		}
+		prefetchIndex_[key] = prefetchLog_.size();
+		prefetchLog_.push_back(ReplacementPrefetchEntry{ key, w, h });
+	}
+	fclose(f);
+
+	prefetchSaved_ = prefetchLog_.size();
+	INFO_LOG(Log::TexReplacement, "Loaded prefetch log with %d replacements", (int)prefetchLog_.size());
+}
+
+void TextureReplacer::SavePrefetchLog() {
+	lastPrefetchSave_ = time_now_d();
+	if (prefetchSaved_ >= prefetchLog_.size()) {
+		return;
+	}
+
+	// We only ever add to the end, so just append the new entries.
+	FILE *f = File::OpenCFile(basePath_ / PREFETCH_FILENAME, "a");
+	if (!f) {
+		WARN_LOG(Log::TexReplacement, "Failed to write prefetch log in '%s'", basePath_.ToVisualString().c_str());
+		// Don't retry every time.
+		prefetchSaved_ = prefetchLog_.size();
+		return;
+	}
+	for (size_t i = prefetchSaved_; i < prefetchLog_.size(); i++) {
+		const ReplacementPrefetchEntry &entry = prefetchLog_[i];
+		fprintf(f, "%016llx %08x %d %d\n", (unsigned long long)entry.key.cachekey, entry.key.hash, entry.w, entry.h);
+	}
+	fclose(f);
+	prefetchSaved_ = prefetchLog_.size();
+}
+
+// libpng reports errors with longjmp, so nothing with a destructor may live in this function.
+static bool EncodeTexturePNG(FILE *fp, const u8 *rgbaData, int w, int h, int compressionLevel) {
+	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	if (!png_ptr) {
+		return false;
+	}
+	png_infop info_ptr = png_create_info_struct(png_ptr);
+	if (!info_ptr) {
+		png_destroy_write_struct(&png_ptr, nullptr);
+		return false;
+	}
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		png_destroy_write_struct(&png_ptr, &info_ptr);
+		return false;
+	}
+
+	png_init_io(png_ptr, fp);
+	png_set_compression_level(png_ptr, compressionLevel);
+	png_set_IHDR(png_ptr, info_ptr, w, h, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	// Same as the simplified API wrote before.
+	png_set_sRGB(png_ptr, info_ptr, PNG_sRGB_INTENT_PERCEPTUAL);
+	png_write_info(png_ptr, info_ptr);
+	for (int y = 0; y < h; y++) {
+		png_write_row(png_ptr, rgbaData + y * w * 4);
+	}
+	png_write_end(png_ptr, nullptr);
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+	return true;
+}
+
+static bool WriteTextureToPNG(const Path &filename, const u8 *rgbaData, int w, int h, int compressionLevel) {
 	FILE *fp = File::OpenCFile(filename, "wb");
 	if (!fp) {
 		ERROR_LOG(Log::TexReplacement, "Save texture: Unable to open texture file '%s' for writing.", filename.c_str());
 		return false;
 	}
 
-	if (png_image_write_to_stdio(image, fp, convert_to_8bit, buffer, row_stride, colormap)) {
+	if (EncodeTexturePNG(fp, rgbaData, w, h, compressionLevel)) {
 		fclose(fp);
 		return true;
 	} else {
@@ -701,6 +843,12 @@ static bool WriteTextureToPNG(png_imagep image, const Path &filename, int conver
 	}
 }
 
+// Limits on saves waiting for a worker. Past these, new textures are dropped rather than stalling the game.
+static const int MAX_PENDING_TEXTURE_SAVES = 256;
+static const size_t MAX_PENDING_TEXTURE_SAVE_BYTES = 256 * 1024 * 1024;
+static std::atomic<int> g_pendingTextureSaves;
+static std::atomic<size_t> g_pendingTextureSaveBytes;
+
 // We save textures on threadpool tasks since it's a fire-and-forget task, and both I/O and png compression
 // can be pretty slow.
 class SaveTextureTask : public Task {
@@ -715,10 +863,16 @@ class SaveTextureTask : public Task {
 	Path saveFilename;
 
 	u32 replacedInfoHash = 0;
+	int compressionLevel = 6;
 
-	SaveTextureTask(u8 *_rgbaData) : rgbaData(_rgbaData) {}
+	SaveTextureTask(u8 *_rgbaData, size_t size) : rgbaData(_rgbaData), size_(size) {
+		g_pendingTextureSaves++;
+		g_pendingTextureSaveBytes += size_;
+	}
 	~SaveTextureTask() {
 		free(rgbaData);
+		g_pendingTextureSaves--;
+		g_pendingTextureSaveBytes -= size_;
 	}
 
 	// This must be set to I/O blocking because of Android storage (so we attach the thread to JNI), while being CPU heavy too.
@@ -750,21 +904,16 @@ class SaveTextureTask : public Task {
 		// going to write to to .png.
 		saveFilename = saveFilename.WithReplacedExtension(".png");
 
-		png_image png{};
-		png.version = PNG_IMAGE_VERSION;
-		png.format = PNG_FORMAT_RGBA;
-		png.width = w;
-		png.height = h;
-		bool success = WriteTextureToPNG(&png, saveFilename, 0, rgbaData, w * 4, nullptr);
-		png_image_free(&png);
-		if (png.warning_or_error >= 2) {
-			ERROR_LOG(Log::TexReplacement, "Saving texture to PNG produced errors.");
-		} else if (success) {
+		bool success = WriteTextureToPNG(saveFilename, rgbaData, w, h, compressionLevel);
+		if (success) {
 			NOTICE_LOG(Log::TexReplacement, "Saving texture for replacement: %08x / %dx%d in '%s'", replacedInfoHash, w, h, saveFilename.ToVisualString().c_str());
 		} else {
 			ERROR_LOG(Log::TexReplacement, "Failed to write '%s'", saveFilename.c_str());
 		}
 	}
+
+private:
+	size_t size_;
 };
 
 bool TextureReplacer::WillSave(const ReplacedTextureDecodeInfo &replacedInfo) const {
@@ -846,6 +995,12 @@ void TextureReplacer::NotifyTextureDecoded(ReplacedTexture *texture, const Repla
 
 
 	size_t saveBufSize = w * h * 4;
+	if (g_pendingTextureSaves >= MAX_PENDING_TEXTURE_SAVES || g_pendingTextureSaveBytes + saveBufSize > MAX_PENDING_TEXTURE_SAVE_BYTES) {
+		// The workers are behind. Drop this one rather than stall, it'll be retried if the texture is decoded again.
+		WARN_LOG_N_TIMES(texsavequeue, 10, Log::TexReplacement, "Texture save queue full, skipping %08x", replacedInfo.hash);
+		return;
+	}
+
 	u8 *saveBuf = (u8 *)malloc(saveBufSize);
 	if (!saveBuf) {
 		ERROR_LOG(Log::TexReplacement, "Failed to allocated %d bytes of memory for saving a texture", (int)saveBufSize);
@@ -858,7 +1013,7 @@ void TextureReplacer::NotifyTextureDecoded(ReplacedTexture *texture, const Repla
 		memcpy(saveBuf + y * w * 4, (const u8 *)data + y * srcPitch, w * 4);
 	}
 
-	SaveTextureTask *task = new SaveTextureTask(std::move(saveBuf));
+	SaveTextureTask *task = new SaveTextureTask(saveBuf, saveBufSize);
 
 	task->filename = basePath_ / hashfile;
 	task->saveFilename = newTextureDir_ / hashfile;
@@ -866,6 +1021,7 @@ void TextureReplacer::NotifyTextureDecoded(ReplacedTexture *texture, const Repla
 	task->w = w;
 	task->h = h;
 	task->replacedInfoHash = replacedInfo.hash;
+	task->compressionLevel = std::max(0, std::min(9, g_Config.iSaveTextureCompressionLevel));
 	g_threadManager.EnqueueTask(task);  // We don't care about waiting for the task. It'll be fine.
 
 	// Remember that we've saved this for next time.
@@ -908,6 +1064,10 @@ void TextureReplacer::Decimate(ReplacerDecimateMode mode) {
 		WARN_LOG(Log::TexReplacement, "Decimated replacements older than %fs, currently using %f GB of RAM", age, totalSizeGB);
 	}
 	lastTextureCacheSizeGB_ = totalSizeGB;
+
+	if (time_now_d() > lastPrefetchSave_ + PREFETCH_SAVE_INTERVAL) {
+		SavePrefetchLog();
+	}
 }
 
 template <typename Key, typename Value>
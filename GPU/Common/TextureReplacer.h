@@ -77,6 +77,13 @@ namespace std {
 	};
 }
 
+// A replacement as first requested, in the order of the prefetch log.
+struct ReplacementPrefetchEntry {
+	ReplacementCacheKey key;
+	int w;
+	int h;
+};
+
 struct ReplacedTextureDecodeInfo {
 	u64 cachekey;
 	u32 hash;
@@ -130,6 +137,11 @@ class TextureReplacer {
 
 protected:
 	bool FindFiltering(u64 cachekey, u32 hash, TextureFiltering *forceFiltering);
+	ReplacedTexture *CreateReplacement(const ReplacementCacheKey &replacementKey, int w, int h);
+
+	void LoadPrefetchLog();
+	void SavePrefetchLog();
+	void Prefetch(const ReplacementCacheKey &replacementKey, int w, int h, ReplacedTexture *texture);
 
 	bool LoadIni(std::string *error);
 	bool LoadIniValues(IniFile &ini, VFSBackend *dir, bool isOverride, std::string *error);
@@ -149,6 +161,7 @@ class TextureReplacer {
 	bool ignoreAddress_ = false;
 	bool reduceHash_ = false;
 	bool ignoreMipmap_ = false;
+	bool prefetchEnabled_ = false;
 	int skipLastDXT1Blocks128x64_ = 0;
 
 	float reduceHashGlobalValue = 0.5f; // Global value for textures dump pngs of all sizes, 0.5 by default but can be set in textures.ini
@@ -177,4 +190,11 @@ class TextureReplacer {
 	// the key is either from aliases_, in which case it's a |-separated sequence of texture filenames of the levels of a texture.
 	// alternatively the key is from the generated texture filename.
 	std::unordered_map<std::string, ReplacedTexture *> levelCache_;
+
+	// Order in which replacements were first requested, from earlier runs followed by new ones from this run.
+	std::vector<ReplacementPrefetchEntry> prefetchLog_;
+	std::unordered_map<ReplacementCacheKey, size_t> prefetchIndex_;
+	// Entries before this are already in the file.
+	size_t prefetchSaved_ = 0;
+	double lastPrefetchSave_ = 0.0;
 };
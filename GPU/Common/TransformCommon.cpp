@@ -50,6 +50,12 @@ Lighter::Lighter(int vertType) {
 		lconv[l] = getFloat24(gstate.lconv[l]);
 		int i = l * 3;
 		if (gstate.isLightChanEnabled(l)) {
+			LightInfo &info = lights_[numLights_++];
+			info.index = l;
+			info.type = gstate.getLightType(l);
+			info.doSpecular = gstate.isUsingSpecularLight(l);
+			info.poweredDiffuse = gstate.isUsingPoweredDiffuseLight(l);
+
 			lpos[l] = Vec3fFromGE(&gstate.lpos[i]);
 			ldir[l] = Vec3fFromGE(&gstate.ldir[i]);
 			latt[l] = Vec3fFromGE(&gstate.latt[i]);
@@ -90,12 +96,9 @@ void Lighter::Light(float colorOut0[4], float colorOut1[4], const float colorIn[
 	Color4 lightSum0 = globalAmbient * *ambient + materialEmissive;
 	Color4 lightSum1(0, 0, 0, 0);
 
-	for (int l = 0; l < 4; l++) {
-		// can we skip this light?
-		if (!gstate.isLightChanEnabled(l))
-			continue;
-
-		GELightType type = gstate.getLightType(l);
+	for (int n = 0; n < numLights_; n++) {
+		const int l = lights_[n].index;
+		const GELightType type = lights_[n].type;
 
 		Vec3f toLight(0, 0, 0);
 		Vec3f lightDir(0, 0, 0);
@@ -105,8 +108,8 @@ void Lighter::Light(float colorOut0[4], float colorOut1[4], const float colorIn[
 		else
 			toLight = lpos[l] - pos;
 
-		bool doSpecular = gstate.isUsingSpecularLight(l);
-		bool poweredDiffuse = gstate.isUsingPoweredDiffuseLight(l);
+		const bool doSpecular = lights_[n].doSpecular;
+		const bool poweredDiffuse = lights_[n].poweredDiffuse;
 
 		float distanceToLight = toLight.Length();
 		float dot = 0.0f;
@@ -161,10 +164,8 @@ void Lighter::Light(float colorOut0[4], float colorOut1[4], const float colorIn[
 			}
 		}
 
-		if (gstate.isLightChanEnabled(l)) {
-			Color4 lightAmbient(lcolor[0][l], 0.0f);
-			lightSum0 += (lightAmbient * *ambient + diff) * lightScale;
-		}
+		Color4 lightAmbient(lcolor[0][l], 0.0f);
+		lightSum0 += (lightAmbient * *ambient + diff) * lightScale;
 	}
 
 	// The colors must eventually be clamped, but we expect the caller to do that.
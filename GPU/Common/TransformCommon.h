@@ -85,6 +85,16 @@ class Lighter {
 	bool doShadeMapping_;
 	int materialUpdate_;
 
+	// Enabled lights with their flags, so the per-vertex loop doesn't have to decode gstate.
+	struct LightInfo {
+		int index;
+		GELightType type;
+		bool doSpecular;
+		bool poweredDiffuse;
+	};
+	LightInfo lights_[4];
+	int numLights_ = 0;
+
 	// Converted light parameters
 	Vec3f lpos[4];  // Used by shade UV mapping
 	Vec3f ldir[4];
@@ -1098,10 +1098,79 @@ static const StepFunction posstep_through[4] = {
 	&VertexDecoder::Step_PosFloatThrough,
 };
 
+// The step loop, with the steps known at compile time so they can be inlined.
+template <StepFunction... Steps>
+static void DecodeStepsInline(const VertexDecoder *dec, const u8 *ptr, u8 *decoded, int count) {
+	const int size = dec->VertexSize();
+	const int stride = dec->GetDecVtxFmt().stride;
+	for (; count; count--) {
+		(Steps(dec, ptr, decoded), ...);
+		ptr += size;
+		decoded += stride;
+	}
+}
+
+struct InlineStepsLookup {
+	StepFunction steps[5];
+	int numSteps;
+	InlineStepsDecoder func;
+};
+
+template <StepFunction... Steps>
+static constexpr InlineStepsLookup MakeInlineSteps() {
+	return InlineStepsLookup{ { Steps... }, (int)sizeof...(Steps), &DecodeStepsInline<Steps...> };
+}
+
+// The most common step sequences, see the counts in VertexDecoderHandwritten.cpp.
+// Only matters when there's no jit (iOS, or the jit is disabled.)
+static const InlineStepsLookup inlineStepsTable[] = {
+	// Tekken 6, Midnight Club
+	MakeInlineSteps<&VertexDecoder::Step_TcU8Prescale, &VertexDecoder::Step_Color565, &VertexDecoder::Step_PosS16>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcU8Prescale, &VertexDecoder::Step_Color5551, &VertexDecoder::Step_PosS16>(),
+	// Wipeout Pure
+	MakeInlineSteps<&VertexDecoder::Step_TcFloatPrescale, &VertexDecoder::Step_Color8888, &VertexDecoder::Step_NormalS8, &VertexDecoder::Step_PosS16>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcFloatPrescale, &VertexDecoder::Step_Color8888, &VertexDecoder::Step_NormalS8ToFloat, &VertexDecoder::Step_PosS16>(),
+	// Flatout, Burnout Dominator
+	MakeInlineSteps<&VertexDecoder::Step_TcU16Prescale, &VertexDecoder::Step_NormalS8, &VertexDecoder::Step_PosS16>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcU16Prescale, &VertexDecoder::Step_NormalS8ToFloat, &VertexDecoder::Step_PosS16>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcU16Prescale, &VertexDecoder::Step_Color5551, &VertexDecoder::Step_PosS16>(),
+	// Test Drive
+	MakeInlineSteps<&VertexDecoder::Step_PosS16>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcFloatPrescale, &VertexDecoder::Step_Color8888, &VertexDecoder::Step_NormalFloat, &VertexDecoder::Step_PosFloat>(),
+	// God of War
+	MakeInlineSteps<&VertexDecoder::Step_TcU16Prescale, &VertexDecoder::Step_Color8888, &VertexDecoder::Step_NormalS8, &VertexDecoder::Step_PosFloat>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcU16Prescale, &VertexDecoder::Step_Color8888, &VertexDecoder::Step_NormalS8ToFloat, &VertexDecoder::Step_PosFloat>(),
+	// Through mode, mostly 2D and UI.
+	MakeInlineSteps<&VertexDecoder::Step_TcU16ThroughToFloat, &VertexDecoder::Step_Color8888, &VertexDecoder::Step_PosS16Through>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcU16ThroughToFloat, &VertexDecoder::Step_PosS16Through>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcFloatThrough, &VertexDecoder::Step_Color8888, &VertexDecoder::Step_PosFloatThrough>(),
+	MakeInlineSteps<&VertexDecoder::Step_TcFloatThrough, &VertexDecoder::Step_PosFloatThrough>(),
+	MakeInlineSteps<&VertexDecoder::Step_Color8888, &VertexDecoder::Step_PosS16Through>(),
+	MakeInlineSteps<&VertexDecoder::Step_Color8888, &VertexDecoder::Step_PosFloatThrough>(),
+};
+
+static InlineStepsDecoder LookupInlineSteps(const StepFunction *steps, int numSteps) {
+	for (const auto &entry : inlineStepsTable) {
+		if (entry.numSteps != numSteps)
+			continue;
+		bool match = true;
+		for (int i = 0; i < numSteps; i++) {
+			if (entry.steps[i] != steps[i]) {
+				match = false;
+				break;
+			}
+		}
+		if (match)
+			return entry.func;
+	}
+	return nullptr;
+}
+
 void VertexDecoder::SetVertexType(u32 fmt, const VertexDecoderOptions &options, VertexDecoderJitCache *jitCache) {
 	fmt_ = fmt;
 	throughmode = (fmt & GE_VTYPE_THROUGH) != 0;
 	numSteps_ = 0;
+	inlineSteps_ = nullptr;
 
 	biggest = 0;
 	size = 0;
@@ -1305,6 +1374,9 @@ void VertexDecoder::SetVertexType(u32 fmt, const VertexDecoderOptions &options,
 
 	_assert_msg_(decFmt.uvfmt == DEC_FLOAT_2 || decFmt.uvfmt == DEC_NONE, "Reader only supports float UV");
 
+	// Cheap, and a good fallback if the handwritten decoders and the jit below don't apply.
+	inlineSteps_ = LookupInlineSteps(steps_, numSteps_);
+
 	// Only use the handwritten decoders if we have SSE or NEON. Don't want to use these on RISC-V, probably?
 #if PPSSPP_ARCH(ARM_NEON) || PPSSPP_ARCH(SSE2)
 	// See GetVertTypeID
@@ -1358,14 +1430,18 @@ void VertexDecoder::DecodeVerts(u8 *decodedptr, const void *verts, const UVScale
 		const u8 *ptr = startPtr;
 		u8 *decoded = decodedptr;
 		prescaleUV_ = uvScaleOffset;
-		// Interpret the decode steps
-		for (; count; count--) {
-			const int steps = numSteps_;
-			for (int i = 0; i < steps; i++) {
-				steps_[i](this, ptr, decoded);
+		if (inlineSteps_) {
+			inlineSteps_(this, ptr, decoded, count);
+		} else {
+			// Interpret the decode steps
+			for (; count; count--) {
+				const int steps = numSteps_;
+				for (int i = 0; i < steps; i++) {
+					steps_[i](this, ptr, decoded);
+				}
+				ptr += size;
+				decoded += stride;
 			}
-			ptr += size;
-			decoded += stride;
 		}
 		if (jitted_ && validateJit) {
 			CompareToJit(startPtr, decodedptr, indexUpperBound - indexLowerBound + 1, uvScaleOffset);
@@ -39,6 +39,8 @@
 #include "Common/x64Emitter.h"
 #elif PPSSPP_ARCH(RISCV64)
 #include "Common/RiscVEmitter.h"
+#elif PPSSPP_ARCH(LOONGARCH64)
+#include "Common/LoongArch64Emitter.h"
 #else
 #include "Common/FakeEmitter.h"
 #endif
@@ -336,6 +338,8 @@ struct JitLookup {
 int TranslateNumBones(int bones);
 
 typedef void (*JittedVertexDecoder)(const u8 *src, u8 *dst, int count, const UVScale *uvScaleOffset);
+// A fixed sequence of steps with the loop around them, compiled ahead of time for common formats.
+typedef void (*InlineStepsDecoder)(const VertexDecoder *dec, const u8 *ptr, u8 *decoded, int count);
 
 struct VertexDecoderOptions {
 	bool expandAllWeightsToFloat;
@@ -468,6 +472,8 @@ class VertexDecoder {
 	mutable const UVScale *prescaleUV_ = nullptr;
 	JittedVertexDecoder jitted_ = 0;
 	int32_t jittedSize_ = 0;
+	// Used instead of interpreting steps_ when there's no jit, if the sequence is a known one.
+	InlineStepsDecoder inlineSteps_ = nullptr;
 
 	// "Immutable" state, set at startup
 
@@ -530,6 +536,8 @@ class VertexDecoder {
 #define VERTEXDECODER_JIT_BACKEND Gen::XCodeBlock
 #elif PPSSPP_ARCH(RISCV64)
 #define VERTEXDECODER_JIT_BACKEND RiscVGen::RiscVCodeBlock
+#elif PPSSPP_ARCH(LOONGARCH64)
+#define VERTEXDECODER_JIT_BACKEND LoongArch64Gen::LoongArch64CodeBlock
 #endif
 
 
@@ -542,6 +550,10 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	JittedVertexDecoder Compile(const VertexDecoder &dec, int32_t *jittedSize);
 	void Clear();
 
+	// Allows decoding two vertices per loop iteration for some formats (currently x86-64 only.)
+	// Affects decoders compiled after the call.
+	void SetAllowWide(bool allow) { allowWide_ = allow; }
+
 	void Jit_WeightsU8();
 	void Jit_WeightsU16();
 	void Jit_WeightsU8ToFloat();
@@ -617,8 +629,24 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	void Jit_Color565Morph();
 	void Jit_Color5551Morph();
 
+	// Wide steps decode the same component of two consecutive vertices at once.
+	void Jit_TcU8ToFloatWide();
+	void Jit_TcU16ToFloatWide();
+	void Jit_TcU8PrescaleWide();
+	void Jit_TcU16PrescaleWide();
+	void Jit_TcFloatPrescaleWide();
+
 private:
 	bool CompileStep(const VertexDecoder &dec, int i);
+	bool IsWideStep(const VertexDecoder &dec, int i) const;
+	void CompileWideStep(const VertexDecoder &dec, int i);
+	void Jit_WideLoadTcU8();
+	void Jit_WideLoadTcU16();
+	void Jit_WideStoreTc();
+#if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+	Gen::OpArg WideSrc(int v, int off) const;
+	Gen::OpArg WideDst(int v, int off) const;
+#endif
 	void Jit_ApplyWeights();
 	void Jit_WriteMatrixMul(int outOff, bool pos);
 	void Jit_WriteMorphColor(int outOff, bool checkAlpha = true);
@@ -631,6 +659,7 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	void Jit_AnyFloatMorph(int srcoff, int dstoff);
 
 	const VertexDecoder *dec_ = nullptr;
+	bool allowWide_ = true;
 #if PPSSPP_ARCH(ARM64)
 	Arm64Gen::ARM64FloatEmitter fp;
 #endif
@@ -644,5 +673,6 @@ class VertexDecoderJitCache : public FakeGen::FakeXCodeBlock {
 		return nullptr;
 	}
 	void Clear();
+	void SetAllowWide(bool allow) {}
 };
 #endif
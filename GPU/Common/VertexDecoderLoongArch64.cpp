@@ -0,0 +1,1463 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(LOONGARCH64)
+
+#include <cstring>
+#include <utility>
+#include "Common/CPUDetect.h"
+#include "Common/Log.h"
+#include "Common/LoongArch64Emitter.h"
+#include "Core/HDRemaster.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+#include "GPU/GPUState.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+
+static const float by128 = 1.0f / 128.0f;
+static const float by32768 = 1.0f / 32768.0f;
+static const float const65535 = 65535.0f;
+
+using namespace LoongArch64Gen;
+
+static const LoongArch64Reg srcReg = R4;  // a0
+static const LoongArch64Reg dstReg = R5;  // a1
+static const LoongArch64Reg counterReg = R6;  // a2
+
+static const LoongArch64Reg tempReg1 = R7;  // a3
+static const LoongArch64Reg tempReg2 = R8;
+static const LoongArch64Reg tempReg3 = R9;
+static const LoongArch64Reg scratchReg = R10;
+
+static const LoongArch64Reg morphBaseReg = R12;  // t0
+
+static const LoongArch64Reg fullAlphaReg = R11;
+static const LoongArch64Reg boundsMinUReg = R13;
+static const LoongArch64Reg boundsMinVReg = R14;
+static const LoongArch64Reg boundsMaxUReg = R15;
+static const LoongArch64Reg boundsMaxVReg = R16;
+
+// Everything here is caller saved (F0-F23), so there's nothing to save.
+static const LoongArch64Reg fpScratchReg1 = F8;
+static const LoongArch64Reg fpScratchReg2 = F9;
+static const LoongArch64Reg fpScratchReg3 = F10;
+static const LoongArch64Reg fpSrc[4] = { F11, F12, F13, F14 };
+static const LoongArch64Reg fpScratchReg4 = F15;
+static const LoongArch64Reg fpExtra[4] = { F16, F17, F18, F19 };
+
+struct UVScaleRegs {
+	struct {
+		LoongArch64Reg u;
+		LoongArch64Reg v;
+	} scale;
+	struct {
+		LoongArch64Reg u;
+		LoongArch64Reg v;
+	} offset;
+};
+
+static const UVScaleRegs prescaleRegs = { { F0, F1 }, { F2, F3 } };
+static const LoongArch64Reg by128Reg = F4;
+static const LoongArch64Reg by32768Reg = F5;
+// Warning: usually not valid.
+static const LoongArch64Reg const65535Reg = F6;
+
+struct MorphValues {
+	float by128[8];
+	float by32768[8];
+	float asFloat[8];
+	float color4[8];
+	float color5[8];
+	float color6[8];
+};
+enum class MorphValuesIndex {
+	BY_128 = 0,
+	BY_32768 = 1,
+	AS_FLOAT = 2,
+	COLOR_4 = 3,
+	COLOR_5 = 4,
+	COLOR_6 = 5,
+};
+static MorphValues morphValues;
+static float skinMatrix[12];
+
+static uint32_t GetMorphValueUsage(uint32_t vtype) {
+	uint32_t morphFlags = 0;
+	switch (vtype & GE_VTYPE_TC_MASK) {
+	case GE_VTYPE_TC_8BIT: morphFlags |= 1 << (int)MorphValuesIndex::BY_128; break;
+	case GE_VTYPE_TC_16BIT: morphFlags |= 1 << (int)MorphValuesIndex::BY_32768; break;
+	case GE_VTYPE_TC_FLOAT: morphFlags |= 1 << (int)MorphValuesIndex::AS_FLOAT; break;
+	}
+	switch (vtype & GE_VTYPE_COL_MASK) {
+	case GE_VTYPE_COL_565: morphFlags |= (1 << (int)MorphValuesIndex::COLOR_5) | (1 << (int)MorphValuesIndex::COLOR_6); break;
+	case GE_VTYPE_COL_5551: morphFlags |= 1 << (int)MorphValuesIndex::COLOR_5; break;
+	case GE_VTYPE_COL_4444: morphFlags |= 1 << (int)MorphValuesIndex::COLOR_4; break;
+	case GE_VTYPE_COL_8888: morphFlags |= 1 << (int)MorphValuesIndex::AS_FLOAT; break;
+	}
+	switch (vtype & GE_VTYPE_NRM_MASK) {
+	case GE_VTYPE_NRM_8BIT: morphFlags |= 1 << (int)MorphValuesIndex::BY_128; break;
+	case GE_VTYPE_NRM_16BIT: morphFlags |= 1 << (int)MorphValuesIndex::BY_32768; break;
+	case GE_VTYPE_NRM_FLOAT: morphFlags |= 1 << (int)MorphValuesIndex::AS_FLOAT; break;
+	}
+	switch (vtype & GE_VTYPE_POS_MASK) {
+	case GE_VTYPE_POS_8BIT: morphFlags |= 1 << (int)MorphValuesIndex::BY_128; break;
+	case GE_VTYPE_POS_16BIT: morphFlags |= 1 << (int)MorphValuesIndex::BY_32768; break;
+	case GE_VTYPE_POS_FLOAT: morphFlags |= 1 << (int)MorphValuesIndex::AS_FLOAT; break;
+	}
+	return morphFlags;
+}
+
+// TODO: Use LSX, where supported.
+
+static const JitLookup jitLookup[] = {
+	{&VertexDecoder::Step_WeightsU8, &VertexDecoderJitCache::Jit_WeightsU8},
+	{&VertexDecoder::Step_WeightsU16, &VertexDecoderJitCache::Jit_WeightsU16},
+	{&VertexDecoder::Step_WeightsFloat, &VertexDecoderJitCache::Jit_WeightsFloat},
+	{&VertexDecoder::Step_WeightsU8Skin, &VertexDecoderJitCache::Jit_WeightsU8Skin},
+	{&VertexDecoder::Step_WeightsU16Skin, &VertexDecoderJitCache::Jit_WeightsU16Skin},
+	{&VertexDecoder::Step_WeightsFloatSkin, &VertexDecoderJitCache::Jit_WeightsFloatSkin},
+
+	{&VertexDecoder::Step_TcU8ToFloat, &VertexDecoderJitCache::Jit_TcU8ToFloat},
+	{&VertexDecoder::Step_TcU16ToFloat, &VertexDecoderJitCache::Jit_TcU16ToFloat},
+	{&VertexDecoder::Step_TcFloat, &VertexDecoderJitCache::Jit_TcFloat},
+
+	{&VertexDecoder::Step_TcU16ThroughToFloat, &VertexDecoderJitCache::Jit_TcU16ThroughToFloat},
+	{&VertexDecoder::Step_TcFloatThrough, &VertexDecoderJitCache::Jit_TcFloatThrough},
+
+	{&VertexDecoder::Step_TcU8Prescale, &VertexDecoderJitCache::Jit_TcU8Prescale},
+	{&VertexDecoder::Step_TcU16Prescale, &VertexDecoderJitCache::Jit_TcU16Prescale},
+	// We use the same jit code whether doubling or not.
+	{&VertexDecoder::Step_TcU16DoublePrescale, &VertexDecoderJitCache::Jit_TcU16Prescale},
+	{&VertexDecoder::Step_TcFloatPrescale, &VertexDecoderJitCache::Jit_TcFloatPrescale},
+
+	{&VertexDecoder::Step_TcU8MorphToFloat, &VertexDecoderJitCache::Jit_TcU8MorphToFloat},
+	{&VertexDecoder::Step_TcU16MorphToFloat, &VertexDecoderJitCache::Jit_TcU16MorphToFloat},
+	{&VertexDecoder::Step_TcFloatMorph, &VertexDecoderJitCache::Jit_TcFloatMorph},
+	{&VertexDecoder::Step_TcU8PrescaleMorph, &VertexDecoderJitCache::Jit_TcU8PrescaleMorph},
+	{&VertexDecoder::Step_TcU16PrescaleMorph, &VertexDecoderJitCache::Jit_TcU16PrescaleMorph},
+	{&VertexDecoder::Step_TcU16DoublePrescaleMorph, &VertexDecoderJitCache::Jit_TcU16PrescaleMorph},
+	{&VertexDecoder::Step_TcFloatPrescaleMorph, &VertexDecoderJitCache::Jit_TcFloatPrescaleMorph},
+
+	{&VertexDecoder::Step_NormalS8, &VertexDecoderJitCache::Jit_NormalS8},
+	{&VertexDecoder::Step_NormalS16, &VertexDecoderJitCache::Jit_NormalS16},
+	{&VertexDecoder::Step_NormalFloat, &VertexDecoderJitCache::Jit_NormalFloat},
+	{&VertexDecoder::Step_NormalS8Skin, &VertexDecoderJitCache::Jit_NormalS8Skin},
+	{&VertexDecoder::Step_NormalS16Skin, &VertexDecoderJitCache::Jit_NormalS16Skin},
+	{&VertexDecoder::Step_NormalFloatSkin, &VertexDecoderJitCache::Jit_NormalFloatSkin},
+
+	{&VertexDecoder::Step_NormalS8Morph, &VertexDecoderJitCache::Jit_NormalS8Morph},
+	{&VertexDecoder::Step_NormalS16Morph, &VertexDecoderJitCache::Jit_NormalS16Morph},
+	{&VertexDecoder::Step_NormalFloatMorph, &VertexDecoderJitCache::Jit_NormalFloatMorph},
+	{&VertexDecoder::Step_NormalS8MorphSkin, &VertexDecoderJitCache::Jit_NormalS8MorphSkin},
+	{&VertexDecoder::Step_NormalS16MorphSkin, &VertexDecoderJitCache::Jit_NormalS16MorphSkin},
+	{&VertexDecoder::Step_NormalFloatMorphSkin, &VertexDecoderJitCache::Jit_NormalFloatMorphSkin},
+
+	{&VertexDecoder::Step_PosS8, &VertexDecoderJitCache::Jit_PosS8},
+	{&VertexDecoder::Step_PosS16, &VertexDecoderJitCache::Jit_PosS16},
+	{&VertexDecoder::Step_PosFloat, &VertexDecoderJitCache::Jit_PosFloat},
+	{&VertexDecoder::Step_PosS8Skin, &VertexDecoderJitCache::Jit_PosS8Skin},
+	{&VertexDecoder::Step_PosS16Skin, &VertexDecoderJitCache::Jit_PosS16Skin},
+	{&VertexDecoder::Step_PosFloatSkin, &VertexDecoderJitCache::Jit_PosFloatSkin},
+
+	{&VertexDecoder::Step_PosS8Through, &VertexDecoderJitCache::Jit_PosS8Through},
+	{&VertexDecoder::Step_PosS16Through, &VertexDecoderJitCache::Jit_PosS16Through},
+	{&VertexDecoder::Step_PosFloatThrough, &VertexDecoderJitCache::Jit_PosFloatThrough},
+
+	{&VertexDecoder::Step_PosS8Morph, &VertexDecoderJitCache::Jit_PosS8Morph},
+	{&VertexDecoder::Step_PosS16Morph, &VertexDecoderJitCache::Jit_PosS16Morph},
+	{&VertexDecoder::Step_PosFloatMorph, &VertexDecoderJitCache::Jit_PosFloatMorph},
+	{&VertexDecoder::Step_PosS8MorphSkin, &VertexDecoderJitCache::Jit_PosS8MorphSkin},
+	{&VertexDecoder::Step_PosS16MorphSkin, &VertexDecoderJitCache::Jit_PosS16MorphSkin},
+	{&VertexDecoder::Step_PosFloatMorphSkin, &VertexDecoderJitCache::Jit_PosFloatMorphSkin},
+
+	{&VertexDecoder::Step_Color8888, &VertexDecoderJitCache::Jit_Color8888},
+	{&VertexDecoder::Step_Color4444, &VertexDecoderJitCache::Jit_Color4444},
+	{&VertexDecoder::Step_Color565, &VertexDecoderJitCache::Jit_Color565},
+	{&VertexDecoder::Step_Color5551, &VertexDecoderJitCache::Jit_Color5551},
+
+	{&VertexDecoder::Step_Color8888Morph, &VertexDecoderJitCache::Jit_Color8888Morph},
+	{&VertexDecoder::Step_Color4444Morph, &VertexDecoderJitCache::Jit_Color4444Morph},
+	{&VertexDecoder::Step_Color565Morph, &VertexDecoderJitCache::Jit_Color565Morph},
+	{&VertexDecoder::Step_Color5551Morph, &VertexDecoderJitCache::Jit_Color5551Morph},
+};
+
+JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int32_t *jittedSize) {
+	dec_ = &dec;
+
+	BeginWrite(4096);
+	const u8 *start = AlignCode16();
+
+	bool log = false;
+	bool prescaleStep = false;
+	bool posThroughStep = false;
+
+	// Look for prescaled texcoord steps
+	for (int i = 0; i < dec.numSteps_; i++) {
+		if (dec.steps_[i] == &VertexDecoder::Step_TcU8Prescale ||
+			dec.steps_[i] == &VertexDecoder::Step_TcU16Prescale ||
+			dec.steps_[i] == &VertexDecoder::Step_TcU16DoublePrescale ||
+			dec.steps_[i] == &VertexDecoder::Step_TcFloatPrescale ||
+			dec.steps_[i] == &VertexDecoder::Step_TcU8PrescaleMorph ||
+			dec.steps_[i] == &VertexDecoder::Step_TcU16PrescaleMorph ||
+			dec.steps_[i] == &VertexDecoder::Step_TcU16DoublePrescaleMorph ||
+			dec.steps_[i] == &VertexDecoder::Step_TcFloatPrescaleMorph) {
+			prescaleStep = true;
+		}
+		if (dec.steps_[i] == &VertexDecoder::Step_PosFloatThrough) {
+			posThroughStep = true;
+		}
+	}
+
+	// TODO: Only load these when needed?
+	LI(scratchReg, by128);
+	MOVGR2FR_W(by128Reg, scratchReg);
+	LI(scratchReg, by32768);
+	MOVGR2FR_W(by32768Reg, scratchReg);
+	if (posThroughStep) {
+		LI(scratchReg, const65535);
+		MOVGR2FR_W(const65535Reg, scratchReg);
+	}
+
+	// Keep the scale/offset in a few fp registers if we need it.
+	if (prescaleStep) {
+		// tempReg1 happens to be the fourth argument register.
+		FLD_S(prescaleRegs.scale.u, tempReg1, 0);
+		FLD_S(prescaleRegs.scale.v, tempReg1, 4);
+		FLD_S(prescaleRegs.offset.u, tempReg1, 8);
+		FLD_S(prescaleRegs.offset.v, tempReg1, 12);
+		if ((dec.VertexType() & GE_VTYPE_TC_MASK) == GE_VTYPE_TC_8BIT) {
+			FMUL_S(prescaleRegs.scale.u, prescaleRegs.scale.u, by128Reg);
+			FMUL_S(prescaleRegs.scale.v, prescaleRegs.scale.v, by128Reg);
+		} else if ((dec.VertexType() & GE_VTYPE_TC_MASK) == GE_VTYPE_TC_16BIT) {
+			LoongArch64Reg multipler = g_DoubleTextureCoordinates ? fpScratchReg1 : by32768Reg;
+			if (g_DoubleTextureCoordinates) {
+				FADD_S(fpScratchReg1, by32768Reg, by32768Reg);
+			}
+			FMUL_S(prescaleRegs.scale.u, prescaleRegs.scale.u, multipler);
+			FMUL_S(prescaleRegs.scale.v, prescaleRegs.scale.v, multipler);
+		}
+	}
+
+	if (dec_->morphcount > 1) {
+		uint32_t morphFlags = GetMorphValueUsage(dec.VertexType());
+
+		auto storePremultiply = [&](LoongArch64Reg factorReg, MorphValuesIndex index, int n) {
+			FMUL_S(fpScratchReg2, fpScratchReg1, factorReg);
+			FST_S(fpScratchReg2, morphBaseReg, ((int)index * 8 + n) * 4);
+		};
+
+		LI(morphBaseReg, &morphValues);
+		LI(tempReg1, &gstate_c.morphWeights[0]);
+
+		if ((morphFlags & (1 << (int)MorphValuesIndex::COLOR_4)) != 0) {
+			LI(scratchReg, 255.0f / 15.0f);
+			MOVGR2FR_W(fpExtra[0], scratchReg);
+		}
+		if ((morphFlags & (1 << (int)MorphValuesIndex::COLOR_5)) != 0) {
+			LI(scratchReg, 255.0f / 31.0f);
+			MOVGR2FR_W(fpExtra[1], scratchReg);
+		}
+		if ((morphFlags & (1 << (int)MorphValuesIndex::COLOR_6)) != 0) {
+			LI(scratchReg, 255.0f / 63.0f);
+			MOVGR2FR_W(fpExtra[2], scratchReg);
+		}
+
+		// Premultiply the values we need and store them so we can reuse.
+		for (int n = 0; n < dec_->morphcount; n++) {
+			FLD_S(fpScratchReg1, tempReg1, n * 4);
+
+			if ((morphFlags & (1 << (int)MorphValuesIndex::BY_128)) != 0)
+				storePremultiply(by128Reg, MorphValuesIndex::BY_128, n);
+			if ((morphFlags & (1 << (int)MorphValuesIndex::BY_32768)) != 0)
+				storePremultiply(by32768Reg, MorphValuesIndex::BY_32768, n);
+			if ((morphFlags & (1 << (int)MorphValuesIndex::AS_FLOAT)) != 0)
+				FST_S(fpScratchReg1, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+			if ((morphFlags & (1 << (int)MorphValuesIndex::COLOR_4)) != 0)
+				storePremultiply(fpExtra[0], MorphValuesIndex::COLOR_4, n);
+			if ((morphFlags & (1 << (int)MorphValuesIndex::COLOR_5)) != 0)
+				storePremultiply(fpExtra[1], MorphValuesIndex::COLOR_5, n);
+			if ((morphFlags & (1 << (int)MorphValuesIndex::COLOR_6)) != 0)
+				storePremultiply(fpExtra[2], MorphValuesIndex::COLOR_6, n);
+		}
+	} else if (dec_->skinInDecode) {
+		LI(morphBaseReg, &skinMatrix[0]);
+	}
+
+	if (dec.col) {
+		// Or LB and skip the conditional?  This is probably cheaper.
+		LI(fullAlphaReg, 0xFF);
+	}
+
+	if (dec.tc && dec.throughmode) {
+		// TODO: Smarter, only when doing bounds.
+		LI(tempReg1, &gstate_c.vertBounds.minU);
+		LD_HU(boundsMinUReg, tempReg1, offsetof(KnownVertexBounds, minU));
+		LD_HU(boundsMaxUReg, tempReg1, offsetof(KnownVertexBounds, maxU));
+		LD_HU(boundsMinVReg, tempReg1, offsetof(KnownVertexBounds, minV));
+		LD_HU(boundsMaxVReg, tempReg1, offsetof(KnownVertexBounds, maxV));
+	}
+
+	const u8 *loopStart = GetCodePtr();
+	for (int i = 0; i < dec.numSteps_; i++) {
+		if (!CompileStep(dec, i)) {
+			EndWrite();
+			// Reset the code ptr (effectively undoing what we generated) and return zero to indicate that we failed.
+			ResetCodePtr(GetOffset(start));
+			char temp[1024]{};
+			dec.ToString(temp, true);
+			ERROR_LOG(Log::G3D, "Could not compile vertex decoder, failed at step %d: %s", i, temp);
+			return nullptr;
+		}
+	}
+
+	ADDI_D(srcReg, srcReg, dec.VertexSize());
+	ADDI_D(dstReg, dstReg, dec.decFmt.stride);
+	ADDI_D(counterReg, counterReg, -1);
+	BLT(R_ZERO, counterReg, loopStart);
+
+	if (dec.col) {
+		LI(tempReg1, &gstate_c.vertexFullAlpha);
+		FixupBranch skip = BNEZ(fullAlphaReg);
+		ST_B(fullAlphaReg, tempReg1, 0);
+		SetJumpTarget(skip);
+	}
+
+	if (dec.tc && dec.throughmode) {
+		// TODO: Smarter, only when doing bounds.
+		LI(tempReg1, &gstate_c.vertBounds.minU);
+		ST_H(boundsMinUReg, tempReg1, offsetof(KnownVertexBounds, minU));
+		ST_H(boundsMaxUReg, tempReg1, offsetof(KnownVertexBounds, maxU));
+		ST_H(boundsMinVReg, tempReg1, offsetof(KnownVertexBounds, minV));
+		ST_H(boundsMaxVReg, tempReg1, offsetof(KnownVertexBounds, maxV));
+	}
+
+	RET();
+
+	FlushIcache();
+
+	if (log) {
+		char temp[1024]{};
+		dec.ToString(temp, true);
+		INFO_LOG(Log::JIT, "=== %s (%d bytes) ===", temp, (int)(GetCodePtr() - start));
+		// No disassembler yet, so just dump the instruction words.
+		for (const u8 *p = start; p < GetCodePtr(); p += 4) {
+			u32 word;
+			memcpy(&word, p, sizeof(word));
+			INFO_LOG(Log::JIT, "LA: %08x", word);
+		}
+		INFO_LOG(Log::JIT, "==========");
+	}
+
+	*jittedSize = (int)(GetCodePtr() - start);
+	EndWrite();
+	return (JittedVertexDecoder)start;
+}
+
+bool VertexDecoderJitCache::CompileStep(const VertexDecoder &dec, int step) {
+	// See if we find a matching JIT function.
+	for (size_t i = 0; i < ARRAY_SIZE(jitLookup); i++) {
+		if (dec.steps_[step] == jitLookup[i].func) {
+			((*this).*jitLookup[i].jitFunc)();
+			return true;
+		}
+	}
+	return false;
+}
+
+void VertexDecoderJitCache::Jit_WeightsU8() {
+	// Just copy a byte at a time.  Would be nice if we knew if misaligned access was fast.
+	// If it's not fast, it can crash or hit a software trap (100x slower.)
+	int j;
+	for (j = 0; j < dec_->nweights; j++) {
+		LD_B(tempReg1, srcReg, dec_->weightoff + j);
+		ST_B(tempReg1, dstReg, dec_->decFmt.w0off + j);
+	}
+	// We zero out any weights up to a multiple of 4.
+	while (j & 3) {
+		ST_B(R_ZERO, dstReg, dec_->decFmt.w0off + j);
+		j++;
+	}
+}
+
+void VertexDecoderJitCache::Jit_WeightsU16() {
+	int j;
+	for (j = 0; j < dec_->nweights; j++) {
+		LD_H(tempReg1, srcReg, dec_->weightoff + j * 2);
+		ST_H(tempReg1, dstReg, dec_->decFmt.w0off + j * 2);
+	}
+	while (j & 3) {
+		ST_H(R_ZERO, dstReg, dec_->decFmt.w0off + j * 2);
+		j++;
+	}
+}
+
+void VertexDecoderJitCache::Jit_WeightsFloat() {
+	int j;
+	for (j = 0; j < dec_->nweights; j++) {
+		LD_W(tempReg1, srcReg, dec_->weightoff + j * 4);
+		ST_W(tempReg1, dstReg, dec_->decFmt.w0off + j * 4);
+	}
+	while (j & 3) {
+		ST_W(R_ZERO, dstReg, dec_->decFmt.w0off + j * 4);
+		j++;
+	}
+}
+
+void VertexDecoderJitCache::Jit_WeightsU8Skin() {
+	Jit_ApplyWeights();
+}
+
+void VertexDecoderJitCache::Jit_WeightsU16Skin() {
+	Jit_ApplyWeights();
+}
+
+void VertexDecoderJitCache::Jit_WeightsFloatSkin() {
+	Jit_ApplyWeights();
+}
+
+void VertexDecoderJitCache::Jit_ApplyWeights() {
+	int weightSize = 4;
+	switch (dec_->weighttype) {
+	case 1: weightSize = 1; break;
+	case 2: weightSize = 2; break;
+	case 3: weightSize = 4; break;
+	default:
+		_assert_(false);
+		break;
+	}
+
+	const LoongArch64Reg boneMatrixReg = tempReg1;
+	// If we are doing morph + skin, we abuse morphBaseReg.
+	const LoongArch64Reg skinMatrixReg = morphBaseReg;
+	const LoongArch64Reg loopEndReg = tempReg3;
+
+	LI(boneMatrixReg, &gstate.boneMatrix[0]);
+	if (dec_->morphcount > 1)
+		LI(skinMatrixReg, &skinMatrix[0]);
+	if (weightSize == 4)
+		MOVGR2FR_W(fpScratchReg3, R_ZERO);
+
+	for (int j = 0; j < 12; j += 2)
+		ST_D(R_ZERO, skinMatrixReg, j * 4);
+
+	// Now let's loop through each weight.  This is the end point.
+	ADDI_D(loopEndReg, srcReg, dec_->nweights * weightSize);
+	const u8 *weightLoop = GetCodePointer();
+
+	FixupBranch skipZero;
+
+	switch (weightSize) {
+	case 1:
+		LD_BU(scratchReg, srcReg, dec_->weightoff);
+		skipZero = std::move(BEQZ(scratchReg));
+		MOVGR2FR_W(fpScratchReg4, scratchReg);
+		FFINT_S_W(fpScratchReg4, fpScratchReg4);
+		FMUL_S(fpScratchReg4, fpScratchReg4, by128Reg);
+		break;
+	case 2:
+		LD_HU(scratchReg, srcReg, dec_->weightoff);
+		skipZero = std::move(BEQZ(scratchReg));
+		MOVGR2FR_W(fpScratchReg4, scratchReg);
+		FFINT_S_W(fpScratchReg4, fpScratchReg4);
+		FMUL_S(fpScratchReg4, fpScratchReg4, by32768Reg);
+		break;
+	case 4:
+		FLD_S(fpScratchReg4, srcReg, dec_->weightoff);
+		FCMP_S(FCond::CEQ, FCC0, fpScratchReg3, fpScratchReg4);
+		skipZero = std::move(BCNEZ(FCC0));
+		break;
+	default:
+		_assert_(false);
+		break;
+	}
+
+	// This is the loop where we add up the skinMatrix itself by the weight.
+	for (int j = 0; j < 12; j += 4) {
+		for (int i = 0; i < 4; ++i)
+			FLD_S(fpSrc[i], boneMatrixReg, (j + i) * 4);
+		for (int i = 0; i < 4; ++i)
+			FLD_S(fpExtra[i], skinMatrixReg, (j + i) * 4);
+		for (int i = 0; i < 4; ++i)
+			FMADD_S(fpExtra[i], fpSrc[i], fpScratchReg4, fpExtra[i]);
+		for (int i = 0; i < 4; ++i)
+			FST_S(fpExtra[i], skinMatrixReg, (j + i) * 4);
+	}
+
+	SetJumpTarget(skipZero);
+
+	// Okay, now return back for the next weight.
+	ADDI_D(boneMatrixReg, boneMatrixReg, 12 * 4);
+	ADDI_D(srcReg, srcReg, weightSize);
+	BLT(srcReg, loopEndReg, weightLoop);
+
+	// Undo the changes to srcReg.
+	ADDI_D(srcReg, srcReg, dec_->nweights * -weightSize);
+
+	// Restore if we abused this.
+	if (dec_->morphcount > 1)
+		LI(morphBaseReg, &morphValues);
+}
+
+void VertexDecoderJitCache::Jit_TcU8ToFloat() {
+	Jit_AnyU8ToFloat(dec_->tcoff, 16);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU16ToFloat() {
+	Jit_AnyU16ToFloat(dec_->tcoff, 32);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcFloat() {
+	// Just copy 64 bits.  Might be nice if we could detect misaligned load perf.
+	LD_W(tempReg1, srcReg, dec_->tcoff);
+	LD_W(tempReg2, srcReg, dec_->tcoff + 4);
+	ST_W(tempReg1, dstReg, dec_->decFmt.uvoff);
+	ST_W(tempReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU16ThroughToFloat() {
+	LD_HU(tempReg1, srcReg, dec_->tcoff + 0);
+	LD_HU(tempReg2, srcReg, dec_->tcoff + 2);
+
+	// No scalar integer min/max, so use branches.  Both sides are zero extended.
+	auto updateSide = [&](LoongArch64Reg src, bool greater, LoongArch64Reg dst) {
+		FixupBranch skip = BGEU(greater ? dst : src, greater ? src : dst);
+		MOVE(dst, src);
+		SetJumpTarget(skip);
+	};
+
+	updateSide(tempReg1, false, boundsMinUReg);
+	updateSide(tempReg1, true, boundsMaxUReg);
+	updateSide(tempReg2, false, boundsMinVReg);
+	updateSide(tempReg2, true, boundsMaxVReg);
+
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatThrough() {
+	// Just copy 64 bits.  Might be nice if we could detect misaligned load perf.
+	LD_W(tempReg1, srcReg, dec_->tcoff);
+	LD_W(tempReg2, srcReg, dec_->tcoff + 4);
+	ST_W(tempReg1, dstReg, dec_->decFmt.uvoff);
+	ST_W(tempReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU8Prescale() {
+	LD_BU(tempReg1, srcReg, dec_->tcoff + 0);
+	LD_BU(tempReg2, srcReg, dec_->tcoff + 1);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	FMADD_S(fpSrc[0], fpSrc[0], prescaleRegs.scale.u, prescaleRegs.offset.u);
+	FMADD_S(fpSrc[1], fpSrc[1], prescaleRegs.scale.v, prescaleRegs.offset.v);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU16Prescale() {
+	LD_HU(tempReg1, srcReg, dec_->tcoff + 0);
+	LD_HU(tempReg2, srcReg, dec_->tcoff + 2);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	FMADD_S(fpSrc[0], fpSrc[0], prescaleRegs.scale.u, prescaleRegs.offset.u);
+	FMADD_S(fpSrc[1], fpSrc[1], prescaleRegs.scale.v, prescaleRegs.offset.v);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatPrescale() {
+	FLD_S(fpSrc[0], srcReg, dec_->tcoff + 0);
+	FLD_S(fpSrc[1], srcReg, dec_->tcoff + 4);
+	FMADD_S(fpSrc[0], fpSrc[0], prescaleRegs.scale.u, prescaleRegs.offset.u);
+	FMADD_S(fpSrc[1], fpSrc[1], prescaleRegs.scale.v, prescaleRegs.offset.v);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU8MorphToFloat() {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_128 * 8 + 0) * 4);
+	LD_BU(tempReg1, srcReg, dec_->tcoff + 0);
+	LD_BU(tempReg2, srcReg, dec_->tcoff + 1);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_128 * 8 + n) * 4);
+		LD_BU(tempReg1, srcReg, dec_->onesize_ * n + dec_->tcoff + 0);
+		LD_BU(tempReg2, srcReg, dec_->onesize_ * n + dec_->tcoff + 1);
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		MOVGR2FR_W(fpScratchReg2, tempReg2);
+		FFINT_S_W(fpScratchReg2, fpScratchReg2);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+	}
+
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU16MorphToFloat() {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_32768 * 8 + 0) * 4);
+	LD_HU(tempReg1, srcReg, dec_->tcoff + 0);
+	LD_HU(tempReg2, srcReg, dec_->tcoff + 2);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_32768 * 8 + n) * 4);
+		LD_HU(tempReg1, srcReg, dec_->onesize_ * n + dec_->tcoff + 0);
+		LD_HU(tempReg2, srcReg, dec_->onesize_ * n + dec_->tcoff + 2);
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		MOVGR2FR_W(fpScratchReg2, tempReg2);
+		FFINT_S_W(fpScratchReg2, fpScratchReg2);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+	}
+
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatMorph() {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + 0) * 4);
+	FLD_S(fpSrc[0], srcReg, dec_->tcoff + 0);
+	FLD_S(fpSrc[1], srcReg, dec_->tcoff + 4);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+		FLD_S(fpScratchReg1, srcReg, dec_->onesize_ * n + dec_->tcoff + 0);
+		FLD_S(fpScratchReg2, srcReg, dec_->onesize_ * n + dec_->tcoff + 4);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+	}
+
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU8PrescaleMorph() {
+	// We use AS_FLOAT since by128 is already baked into precale.
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + 0) * 4);
+	LD_BU(tempReg1, srcReg, dec_->tcoff + 0);
+	LD_BU(tempReg2, srcReg, dec_->tcoff + 1);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+		LD_BU(tempReg1, srcReg, dec_->onesize_ * n + dec_->tcoff + 0);
+		LD_BU(tempReg2, srcReg, dec_->onesize_ * n + dec_->tcoff + 1);
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		MOVGR2FR_W(fpScratchReg2, tempReg2);
+		FFINT_S_W(fpScratchReg2, fpScratchReg2);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+	}
+
+	FMADD_S(fpSrc[0], fpSrc[0], prescaleRegs.scale.u, prescaleRegs.offset.u);
+	FMADD_S(fpSrc[1], fpSrc[1], prescaleRegs.scale.v, prescaleRegs.offset.v);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU16PrescaleMorph() {
+	// We use AS_FLOAT since by32768 is already baked into precale.
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + 0) * 4);
+	LD_HU(tempReg1, srcReg, dec_->tcoff + 0);
+	LD_HU(tempReg2, srcReg, dec_->tcoff + 2);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+		LD_HU(tempReg1, srcReg, dec_->onesize_ * n + dec_->tcoff + 0);
+		LD_HU(tempReg2, srcReg, dec_->onesize_ * n + dec_->tcoff + 2);
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		MOVGR2FR_W(fpScratchReg2, tempReg2);
+		FFINT_S_W(fpScratchReg2, fpScratchReg2);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+	}
+
+	FMADD_S(fpSrc[0], fpSrc[0], prescaleRegs.scale.u, prescaleRegs.offset.u);
+	FMADD_S(fpSrc[1], fpSrc[1], prescaleRegs.scale.v, prescaleRegs.offset.v);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatPrescaleMorph() {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + 0) * 4);
+	FLD_S(fpSrc[0], srcReg, dec_->tcoff + 0);
+	FLD_S(fpSrc[1], srcReg, dec_->tcoff + 4);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+		FLD_S(fpScratchReg1, srcReg, dec_->onesize_ * n + dec_->tcoff + 0);
+		FLD_S(fpScratchReg2, srcReg, dec_->onesize_ * n + dec_->tcoff + 4);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+	}
+
+	FMADD_S(fpSrc[0], fpSrc[0], prescaleRegs.scale.u, prescaleRegs.offset.u);
+	FMADD_S(fpSrc[1], fpSrc[1], prescaleRegs.scale.v, prescaleRegs.offset.v);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.uvoff);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_NormalS8() {
+	LD_B(tempReg1, srcReg, dec_->nrmoff + 0);
+	LD_B(tempReg2, srcReg, dec_->nrmoff + 1);
+	LD_B(tempReg3, srcReg, dec_->nrmoff + 2);
+	ST_B(tempReg1, dstReg, dec_->decFmt.nrmoff + 0);
+	ST_B(tempReg2, dstReg, dec_->decFmt.nrmoff + 1);
+	ST_B(tempReg3, dstReg, dec_->decFmt.nrmoff + 2);
+	ST_B(R_ZERO, dstReg, dec_->decFmt.nrmoff + 3);
+}
+
+void VertexDecoderJitCache::Jit_NormalS16() {
+	LD_H(tempReg1, srcReg, dec_->nrmoff + 0);
+	LD_H(tempReg2, srcReg, dec_->nrmoff + 2);
+	LD_H(tempReg3, srcReg, dec_->nrmoff + 4);
+	ST_H(tempReg1, dstReg, dec_->decFmt.nrmoff + 0);
+	ST_H(tempReg2, dstReg, dec_->decFmt.nrmoff + 2);
+	ST_H(tempReg3, dstReg, dec_->decFmt.nrmoff + 4);
+	ST_H(R_ZERO, dstReg, dec_->decFmt.nrmoff + 6);
+}
+
+void VertexDecoderJitCache::Jit_NormalFloat() {
+	// Just copy 12 bytes, play with over read/write later.
+	LD_W(tempReg1, srcReg, dec_->nrmoff + 0);
+	LD_W(tempReg2, srcReg, dec_->nrmoff + 4);
+	LD_W(tempReg3, srcReg, dec_->nrmoff + 8);
+	ST_W(tempReg1, dstReg, dec_->decFmt.nrmoff + 0);
+	ST_W(tempReg2, dstReg, dec_->decFmt.nrmoff + 4);
+	ST_W(tempReg3, dstReg, dec_->decFmt.nrmoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_NormalS8Skin() {
+	Jit_AnyS8ToFloat(dec_->nrmoff);
+	Jit_WriteMatrixMul(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_NormalS16Skin() {
+	Jit_AnyS16ToFloat(dec_->nrmoff);
+	Jit_WriteMatrixMul(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_NormalFloatSkin() {
+	FLD_S(fpSrc[0], srcReg, dec_->nrmoff + 0);
+	FLD_S(fpSrc[1], srcReg, dec_->nrmoff + 4);
+	FLD_S(fpSrc[2], srcReg, dec_->nrmoff + 8);
+	Jit_WriteMatrixMul(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_NormalS8Morph() {
+	Jit_AnyS8Morph(dec_->nrmoff, dec_->decFmt.nrmoff);
+}
+
+void VertexDecoderJitCache::Jit_NormalS16Morph() {
+	Jit_AnyS16Morph(dec_->nrmoff, dec_->decFmt.nrmoff);
+}
+
+void VertexDecoderJitCache::Jit_NormalFloatMorph() {
+	Jit_AnyFloatMorph(dec_->nrmoff, dec_->decFmt.nrmoff);
+}
+
+void VertexDecoderJitCache::Jit_NormalS8MorphSkin() {
+	Jit_AnyS8Morph(dec_->nrmoff, -1);
+	Jit_WriteMatrixMul(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_NormalS16MorphSkin() {
+	Jit_AnyS16Morph(dec_->nrmoff, -1);
+	Jit_WriteMatrixMul(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_NormalFloatMorphSkin() {
+	Jit_AnyFloatMorph(dec_->nrmoff, -1);
+	Jit_WriteMatrixMul(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_PosS8() {
+	Jit_AnyS8ToFloat(dec_->posoff);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.posoff + 0);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.posoff + 4);
+	FST_S(fpSrc[2], dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS16() {
+	Jit_AnyS16ToFloat(dec_->posoff);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.posoff + 0);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.posoff + 4);
+	FST_S(fpSrc[2], dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosFloat() {
+	// Just copy 12 bytes, play with over read/write later.
+	LD_W(tempReg1, srcReg, dec_->posoff + 0);
+	LD_W(tempReg2, srcReg, dec_->posoff + 4);
+	LD_W(tempReg3, srcReg, dec_->posoff + 8);
+	ST_W(tempReg1, dstReg, dec_->decFmt.posoff + 0);
+	ST_W(tempReg2, dstReg, dec_->decFmt.posoff + 4);
+	ST_W(tempReg3, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS8Skin() {
+	Jit_AnyS8ToFloat(dec_->posoff);
+	Jit_WriteMatrixMul(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_PosS16Skin() {
+	Jit_AnyS16ToFloat(dec_->posoff);
+	Jit_WriteMatrixMul(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_PosFloatSkin() {
+	FLD_S(fpSrc[0], srcReg, dec_->posoff + 0);
+	FLD_S(fpSrc[1], srcReg, dec_->posoff + 4);
+	FLD_S(fpSrc[2], srcReg, dec_->posoff + 8);
+	Jit_WriteMatrixMul(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_PosS8Through() {
+	// 8-bit positions in throughmode always decode to 0, depth included.
+	ST_W(R_ZERO, dstReg, dec_->decFmt.posoff + 0);
+	ST_W(R_ZERO, dstReg, dec_->decFmt.posoff + 4);
+	ST_W(R_ZERO, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS16Through() {
+	// Start with X and Y (which are signed.)
+	LD_H(tempReg1, srcReg, dec_->posoff + 0);
+	LD_H(tempReg2, srcReg, dec_->posoff + 2);
+	// This one, Z, has to be unsigned.
+	LD_HU(tempReg3, srcReg, dec_->posoff + 4);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	MOVGR2FR_W(fpSrc[2], tempReg3);
+	FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FST_S(fpSrc[0], dstReg, dec_->decFmt.posoff + 0);
+	FST_S(fpSrc[1], dstReg, dec_->decFmt.posoff + 4);
+	FST_S(fpSrc[2], dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosFloatThrough() {
+	// Start by copying 8 bytes, then handle Z separately to clamp it.
+	LD_W(tempReg1, srcReg, dec_->posoff + 0);
+	LD_W(tempReg2, srcReg, dec_->posoff + 4);
+	FLD_S(fpSrc[2], srcReg, dec_->posoff + 8);
+	ST_W(tempReg1, dstReg, dec_->decFmt.posoff + 0);
+	ST_W(tempReg2, dstReg, dec_->decFmt.posoff + 4);
+
+	// Load the constant zero and clamp.  Maybe could static alloc zero, but fairly cheap...
+	MOVGR2FR_W(fpScratchReg1, R_ZERO);
+	FMAX_S(fpSrc[2], fpSrc[2], fpScratchReg1);
+	FMIN_S(fpSrc[2], fpSrc[2], const65535Reg);
+	FST_S(fpSrc[2], dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS8Morph() {
+	Jit_AnyS8Morph(dec_->posoff, dec_->decFmt.posoff);
+}
+
+void VertexDecoderJitCache::Jit_PosS16Morph() {
+	Jit_AnyS16Morph(dec_->posoff, dec_->decFmt.posoff);
+}
+
+void VertexDecoderJitCache::Jit_PosFloatMorph() {
+	Jit_AnyFloatMorph(dec_->posoff, dec_->decFmt.posoff);
+}
+
+void VertexDecoderJitCache::Jit_PosS8MorphSkin() {
+	Jit_AnyS8Morph(dec_->posoff, -1);
+	Jit_WriteMatrixMul(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_PosS16MorphSkin() {
+	Jit_AnyS16Morph(dec_->posoff, -1);
+	Jit_WriteMatrixMul(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_PosFloatMorphSkin() {
+	Jit_AnyFloatMorph(dec_->posoff, -1);
+	Jit_WriteMatrixMul(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_Color8888() {
+	LD_WU(tempReg1, srcReg, dec_->coloff);
+
+	// Set tempReg2=-1 if full alpha, 0 otherwise.
+	SRLI_D(tempReg2, tempReg1, 24);
+	SLTUI(tempReg2, tempReg2, 0xFF);
+	ADDI_D(tempReg2, tempReg2, -1);
+
+	// Now use that as a mask to clear fullAlpha.
+	AND(fullAlphaReg, fullAlphaReg, tempReg2);
+
+	ST_W(tempReg1, dstReg, dec_->decFmt.c0off);
+}
+
+void VertexDecoderJitCache::Jit_Color4444() {
+	LD_HU(tempReg1, srcReg, dec_->coloff);
+
+	// Red...
+	ANDI(tempReg2, tempReg1, 0x0F);
+	// Move green left to position 8.
+	ANDI(tempReg3, tempReg1, 0xF0);
+	SLLI_D(tempReg3, tempReg3, 4);
+	OR(tempReg2, tempReg2, tempReg3);
+	// ANDI is zero extended here, so blue can be masked in place.
+	ANDI(tempReg3, tempReg1, 0xF00);
+	SLLI_D(tempReg3, tempReg3, 8);
+	OR(tempReg2, tempReg2, tempReg3);
+	// And now alpha, which is all that's left after shifting out 12.
+	SRLI_D(tempReg1, tempReg1, 12);
+	SLLI_D(tempReg3, tempReg1, 24);
+	OR(tempReg2, tempReg2, tempReg3);
+
+	// Now we swizzle.
+	SLLI_D(tempReg3, tempReg2, 4);
+	OR(tempReg2, tempReg2, tempReg3);
+
+	// Color is down, now let's say the fullAlphaReg flag from tempReg1 (still has alpha.)
+	// Set tempReg1=-1 if full alpha, 0 otherwise.
+	SLTUI(tempReg1, tempReg1, 0x0F);
+	ADDI_D(tempReg1, tempReg1, -1);
+
+	// Now use that as a mask to clear fullAlpha.
+	AND(fullAlphaReg, fullAlphaReg, tempReg1);
+
+	ST_W(tempReg2, dstReg, dec_->decFmt.c0off);
+}
+
+void VertexDecoderJitCache::Jit_Color565() {
+	LD_HU(tempReg1, srcReg, dec_->coloff);
+
+	// Start by extracting green.
+	SRLI_D(tempReg2, tempReg1, 5);
+	ANDI(tempReg2, tempReg2, 0x3F);
+	// And now swizzle 6 -> 8, using a wall to clear bits.
+	SRLI_D(tempReg3, tempReg2, 4);
+	SLLI_D(tempReg3, tempReg3, 8);
+	SLLI_D(tempReg2, tempReg2, 2 + 8);
+	OR(tempReg2, tempReg2, tempReg3);
+
+	// Now pull blue out using a wall to isolate it.
+	SRLI_D(tempReg3, tempReg1, 11);
+	// And now isolate red and combine them.
+	ANDI(tempReg1, tempReg1, 0x1F);
+	SLLI_D(tempReg3, tempReg3, 16);
+	OR(tempReg1, tempReg1, tempReg3);
+	// Now we swizzle them together.
+	SRLI_D(tempReg3, tempReg1, 2);
+	SLLI_D(tempReg1, tempReg1, 3);
+	OR(tempReg1, tempReg1, tempReg3);
+	// But we have to clear the bits now which is annoying.
+	LI(tempReg3, 0x00FF00FF);
+	AND(tempReg1, tempReg1, tempReg3);
+
+	// Now add green back in, and then make an alpha FF and add it too.
+	OR(tempReg1, tempReg1, tempReg2);
+	LI(tempReg3, (s32)0xFF000000);
+	OR(tempReg1, tempReg1, tempReg3);
+
+	ST_W(tempReg1, dstReg, dec_->decFmt.c0off);
+}
+
+void VertexDecoderJitCache::Jit_Color5551() {
+	LD_HU(tempReg1, srcReg, dec_->coloff);
+
+	// Separate each color.
+	SRLI_D(tempReg2, tempReg1, 5);
+	SRLI_D(tempReg3, tempReg1, 10);
+
+	// Set scratchReg to -1 if the alpha bit is set.
+	SLLI_W(scratchReg, tempReg1, 16);
+	SRAI_W(scratchReg, scratchReg, 31);
+	// Now we can mask the flag.
+	AND(fullAlphaReg, fullAlphaReg, scratchReg);
+
+	// Let's move alpha into position.
+	SLLI_D(scratchReg, scratchReg, 24);
+
+	// Mask each.
+	ANDI(tempReg1, tempReg1, 0x1F);
+	ANDI(tempReg2, tempReg2, 0x1F);
+	ANDI(tempReg3, tempReg3, 0x1F);
+	// And shift into position.
+	SLLI_D(tempReg2, tempReg2, 8);
+	SLLI_D(tempReg3, tempReg3, 16);
+	// Combine RGB together.
+	OR(tempReg1, tempReg1, tempReg2);
+	OR(tempReg1, tempReg1, tempReg3);
+	// Swizzle our 5 -> 8
+	SRLI_D(tempReg2, tempReg1, 2);
+	SLLI_D(tempReg1, tempReg1, 3);
+	// Mask out the overflow in tempReg2 and combine.
+	LI(tempReg3, 0x00070707);
+	AND(tempReg2, tempReg2, tempReg3);
+	OR(tempReg1, tempReg1, tempReg2);
+
+	// Add in alpha and we're done.
+	OR(tempReg1, tempReg1, scratchReg);
+
+	ST_W(tempReg1, dstReg, dec_->decFmt.c0off);
+}
+
+void VertexDecoderJitCache::Jit_Color8888Morph() {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + 0) * 4);
+	LD_WU(tempReg1, srcReg, dec_->coloff);
+	for (int i = 0; i < 3; ++i) {
+		ANDI(tempReg2, tempReg1, 0xFF);
+		MOVGR2FR_W(fpSrc[i], tempReg2);
+		FFINT_S_W(fpSrc[i], fpSrc[i]);
+		SRLI_D(tempReg1, tempReg1, 8);
+		FMUL_S(fpSrc[i], fpSrc[i], fpScratchReg4);
+	}
+	MOVGR2FR_W(fpSrc[3], tempReg1);
+	FFINT_S_W(fpSrc[3], fpSrc[3]);
+	FMUL_S(fpSrc[3], fpSrc[3], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+		LD_WU(tempReg1, srcReg, dec_->onesize_ * n + dec_->coloff);
+		for (int i = 0; i < 3; ++i) {
+			ANDI(tempReg2, tempReg1, 0xFF);
+			MOVGR2FR_W(fpScratchReg1, tempReg2);
+			FFINT_S_W(fpScratchReg1, fpScratchReg1);
+			SRLI_D(tempReg1, tempReg1, 8);
+			FMADD_S(fpSrc[i], fpScratchReg1, fpScratchReg4, fpSrc[i]);
+		}
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		FMADD_S(fpSrc[3], fpScratchReg1, fpScratchReg4, fpSrc[3]);
+	}
+
+	Jit_WriteMorphColor(dec_->decFmt.c0off, true);
+}
+
+void VertexDecoderJitCache::Jit_Color4444Morph() {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::COLOR_4 * 8 + 0) * 4);
+	LD_HU(tempReg1, srcReg, dec_->coloff);
+	for (int i = 0; i < 3; ++i) {
+		ANDI(tempReg2, tempReg1, 0xF);
+		MOVGR2FR_W(fpSrc[i], tempReg2);
+		FFINT_S_W(fpSrc[i], fpSrc[i]);
+		SRLI_D(tempReg1, tempReg1, 4);
+		FMUL_S(fpSrc[i], fpSrc[i], fpScratchReg4);
+	}
+	MOVGR2FR_W(fpSrc[3], tempReg1);
+	FFINT_S_W(fpSrc[3], fpSrc[3]);
+	FMUL_S(fpSrc[3], fpSrc[3], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::COLOR_4 * 8 + n) * 4);
+		LD_HU(tempReg1, srcReg, dec_->onesize_ * n + dec_->coloff);
+		for (int i = 0; i < 3; ++i) {
+			ANDI(tempReg2, tempReg1, 0xF);
+			MOVGR2FR_W(fpScratchReg1, tempReg2);
+			FFINT_S_W(fpScratchReg1, fpScratchReg1);
+			SRLI_D(tempReg1, tempReg1, 4);
+			FMADD_S(fpSrc[i], fpScratchReg1, fpScratchReg4, fpSrc[i]);
+		}
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		FMADD_S(fpSrc[3], fpScratchReg1, fpScratchReg4, fpSrc[3]);
+	}
+
+	Jit_WriteMorphColor(dec_->decFmt.c0off, true);
+}
+
+void VertexDecoderJitCache::Jit_Color565Morph() {
+	FLD_S(fpScratchReg3, morphBaseReg, ((int)MorphValuesIndex::COLOR_5 * 8 + 0) * 4);
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::COLOR_6 * 8 + 0) * 4);
+	LD_HU(tempReg1, srcReg, dec_->coloff);
+
+	ANDI(tempReg2, tempReg1, 0x1F);
+	MOVGR2FR_W(fpSrc[0], tempReg2);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	SRLI_D(tempReg1, tempReg1, 5);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg3);
+
+	ANDI(tempReg2, tempReg1, 0x3F);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	SRLI_D(tempReg1, tempReg1, 6);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+
+	MOVGR2FR_W(fpSrc[2], tempReg1);
+
+	FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FMUL_S(fpSrc[2], fpSrc[2], fpScratchReg3);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg3, morphBaseReg, ((int)MorphValuesIndex::COLOR_5 * 8 + n) * 4);
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::COLOR_6 * 8 + n) * 4);
+		LD_HU(tempReg1, srcReg, dec_->onesize_ * n + dec_->coloff);
+
+		ANDI(tempReg2, tempReg1, 0x1F);
+		MOVGR2FR_W(fpScratchReg1, tempReg2);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		SRLI_D(tempReg1, tempReg1, 5);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg3, fpSrc[0]);
+
+		ANDI(tempReg2, tempReg1, 0x3F);
+		MOVGR2FR_W(fpScratchReg1, tempReg2);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		SRLI_D(tempReg1, tempReg1, 6);
+		FMADD_S(fpSrc[1], fpScratchReg1, fpScratchReg4, fpSrc[1]);
+
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		FMADD_S(fpSrc[2], fpScratchReg1, fpScratchReg3, fpSrc[2]);
+	}
+
+	Jit_WriteMorphColor(dec_->decFmt.c0off, false);
+}
+
+void VertexDecoderJitCache::Jit_Color5551Morph() {
+	FLD_S(fpScratchReg3, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + 0) * 4);
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::COLOR_5 * 8 + 0) * 4);
+	LD_HU(tempReg1, srcReg, dec_->coloff);
+	for (int i = 0; i < 3; ++i) {
+		ANDI(tempReg2, tempReg1, 0x1F);
+		MOVGR2FR_W(fpSrc[i], tempReg2);
+		FFINT_S_W(fpSrc[i], fpSrc[i]);
+		SRLI_D(tempReg1, tempReg1, 5);
+		FMUL_S(fpSrc[i], fpSrc[i], fpScratchReg4);
+	}
+
+	// We accumulate alpha to [0, 1] and then scale up to 255 later.
+	MOVGR2FR_W(fpSrc[3], tempReg1);
+	FFINT_S_W(fpSrc[3], fpSrc[3]);
+	FMUL_S(fpSrc[3], fpSrc[3], fpScratchReg3);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg3, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::COLOR_5 * 8 + n) * 4);
+		LD_HU(tempReg1, srcReg, dec_->onesize_ * n + dec_->coloff);
+		for (int i = 0; i < 3; ++i) {
+			ANDI(tempReg2, tempReg1, 0x1F);
+			MOVGR2FR_W(fpScratchReg1, tempReg2);
+			FFINT_S_W(fpScratchReg1, fpScratchReg1);
+			SRLI_D(tempReg1, tempReg1, 5);
+			FMADD_S(fpSrc[i], fpScratchReg1, fpScratchReg4, fpSrc[i]);
+		}
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		FMADD_S(fpSrc[3], fpScratchReg1, fpScratchReg3, fpSrc[3]);
+	}
+
+	LI(scratchReg, 255.0f);
+	MOVGR2FR_W(fpScratchReg2, scratchReg);
+	FMUL_S(fpSrc[3], fpSrc[3], fpScratchReg2);
+
+	Jit_WriteMorphColor(dec_->decFmt.c0off, true);
+}
+
+void VertexDecoderJitCache::Jit_WriteMorphColor(int outOff, bool checkAlpha) {
+	// Clamp to [0, 255] as floats, since we have FMIN/FMAX.  Better than branching, probably...
+	LI(scratchReg, 255.0f);
+	MOVGR2FR_W(fpScratchReg1, R_ZERO);
+	MOVGR2FR_W(fpScratchReg2, scratchReg);
+	for (int i = 0; i < (checkAlpha ? 4 : 3); ++i) {
+		FMAX_S(fpSrc[i], fpSrc[i], fpScratchReg1);
+		FMIN_S(fpSrc[i], fpSrc[i], fpScratchReg2);
+	}
+
+	// After the clamp, a signed conversion is fine.
+	FTINTRZ_W_S(fpSrc[0], fpSrc[0]);
+	MOVFR2GR_S(tempReg1, fpSrc[0]);
+	for (int i = 1; i < (checkAlpha ? 4 : 3); ++i) {
+		FTINTRZ_W_S(fpSrc[i], fpSrc[i]);
+		MOVFR2GR_S(tempReg2, fpSrc[i]);
+		// If it's alpha, set tempReg3 as a flag.
+		if (i == 3)
+			SLTUI(tempReg3, tempReg2, 0xFF);
+		SLLI_D(tempReg2, tempReg2, i * 8);
+		OR(tempReg1, tempReg1, tempReg2);
+	}
+
+	if (!checkAlpha) {
+		// For 565 only, we need to force alpha to 0xFF.
+		LI(scratchReg, (s32)0xFF000000);
+		OR(tempReg1, tempReg1, scratchReg);
+	}
+
+	if (checkAlpha) {
+		// Now use the flag we set earlier to update fullAlphaReg.
+		// We translate it to a mask, tempReg3=-1 if full alpha, 0 otherwise.
+		ADDI_D(tempReg3, tempReg3, -1);
+		AND(fullAlphaReg, fullAlphaReg, tempReg3);
+	}
+
+	ST_W(tempReg1, dstReg, outOff);
+}
+
+void VertexDecoderJitCache::Jit_AnyS8ToFloat(int srcoff) {
+	LD_B(tempReg1, srcReg, srcoff + 0);
+	LD_B(tempReg2, srcReg, srcoff + 1);
+	LD_B(tempReg3, srcReg, srcoff + 2);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	MOVGR2FR_W(fpSrc[2], tempReg3);
+	FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FMUL_S(fpSrc[0], fpSrc[0], by128Reg);
+	FMUL_S(fpSrc[1], fpSrc[1], by128Reg);
+	FMUL_S(fpSrc[2], fpSrc[2], by128Reg);
+}
+
+void VertexDecoderJitCache::Jit_AnyS16ToFloat(int srcoff) {
+	LD_H(tempReg1, srcReg, srcoff + 0);
+	LD_H(tempReg2, srcReg, srcoff + 2);
+	LD_H(tempReg3, srcReg, srcoff + 4);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	MOVGR2FR_W(fpSrc[2], tempReg3);
+	FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FMUL_S(fpSrc[0], fpSrc[0], by32768Reg);
+	FMUL_S(fpSrc[1], fpSrc[1], by32768Reg);
+	FMUL_S(fpSrc[2], fpSrc[2], by32768Reg);
+}
+
+void VertexDecoderJitCache::Jit_AnyU8ToFloat(int srcoff, u32 bits) {
+	_dbg_assert_msg_((bits & ~(16 | 8)) == 0, "Bits must be a multiple of 8.");
+	_dbg_assert_msg_(bits >= 8 && bits <= 24, "Bits must be a between 8 and 24.");
+
+	LD_BU(tempReg1, srcReg, srcoff + 0);
+	if (bits >= 16)
+		LD_BU(tempReg2, srcReg, srcoff + 1);
+	if (bits >= 24)
+		LD_BU(tempReg3, srcReg, srcoff + 2);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	if (bits >= 16)
+		MOVGR2FR_W(fpSrc[1], tempReg2);
+		FFINT_S_W(fpSrc[1], fpSrc[1]);
+	if (bits >= 24)
+		MOVGR2FR_W(fpSrc[2], tempReg3);
+		FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FMUL_S(fpSrc[0], fpSrc[0], by128Reg);
+	if (bits >= 16)
+		FMUL_S(fpSrc[1], fpSrc[1], by128Reg);
+	if (bits >= 24)
+		FMUL_S(fpSrc[2], fpSrc[2], by128Reg);
+}
+
+void VertexDecoderJitCache::Jit_AnyU16ToFloat(int srcoff, u32 bits) {
+	_dbg_assert_msg_((bits & ~(32 | 16)) == 0, "Bits must be a multiple of 16.");
+	_dbg_assert_msg_(bits >= 16 && bits <= 48, "Bits must be a between 16 and 48.");
+
+	LD_HU(tempReg1, srcReg, srcoff + 0);
+	if (bits >= 32)
+		LD_HU(tempReg2, srcReg, srcoff + 2);
+	if (bits >= 48)
+		LD_HU(tempReg3, srcReg, srcoff + 4);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	if (bits >= 32)
+		MOVGR2FR_W(fpSrc[1], tempReg2);
+		FFINT_S_W(fpSrc[1], fpSrc[1]);
+	if (bits >= 48)
+		MOVGR2FR_W(fpSrc[2], tempReg3);
+		FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FMUL_S(fpSrc[0], fpSrc[0], by32768Reg);
+	if (bits >= 32)
+		FMUL_S(fpSrc[1], fpSrc[1], by32768Reg);
+	if (bits >= 48)
+		FMUL_S(fpSrc[2], fpSrc[2], by32768Reg);
+}
+
+void VertexDecoderJitCache::Jit_AnyS8Morph(int srcoff, int dstoff) {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_128 * 8 + 0) * 4);
+	LD_B(tempReg1, srcReg, srcoff + 0);
+	LD_B(tempReg2, srcReg, srcoff + 1);
+	LD_B(tempReg3, srcReg, srcoff + 2);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	MOVGR2FR_W(fpSrc[2], tempReg3);
+	FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+	FMUL_S(fpSrc[2], fpSrc[2], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_128 * 8 + n) * 4);
+		LD_B(tempReg1, srcReg, dec_->onesize_ * n + srcoff + 0);
+		LD_B(tempReg2, srcReg, dec_->onesize_ * n + srcoff + 1);
+		LD_B(tempReg3, srcReg, dec_->onesize_ * n + srcoff + 2);
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		MOVGR2FR_W(fpScratchReg2, tempReg2);
+		FFINT_S_W(fpScratchReg2, fpScratchReg2);
+		MOVGR2FR_W(fpScratchReg3, tempReg3);
+		FFINT_S_W(fpScratchReg3, fpScratchReg3);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+		FMADD_S(fpSrc[2], fpScratchReg3, fpScratchReg4, fpSrc[2]);
+	}
+
+	if (dstoff >= 0) {
+		FST_S(fpSrc[0], dstReg, dstoff + 0);
+		FST_S(fpSrc[1], dstReg, dstoff + 4);
+		FST_S(fpSrc[2], dstReg, dstoff + 8);
+	}
+}
+
+void VertexDecoderJitCache::Jit_AnyS16Morph(int srcoff, int dstoff) {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_32768 * 8 + 0) * 4);
+	LD_H(tempReg1, srcReg, srcoff + 0);
+	LD_H(tempReg2, srcReg, srcoff + 2);
+	LD_H(tempReg3, srcReg, srcoff + 4);
+	MOVGR2FR_W(fpSrc[0], tempReg1);
+	FFINT_S_W(fpSrc[0], fpSrc[0]);
+	MOVGR2FR_W(fpSrc[1], tempReg2);
+	FFINT_S_W(fpSrc[1], fpSrc[1]);
+	MOVGR2FR_W(fpSrc[2], tempReg3);
+	FFINT_S_W(fpSrc[2], fpSrc[2]);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+	FMUL_S(fpSrc[2], fpSrc[2], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::BY_32768 * 8 + n) * 4);
+		LD_H(tempReg1, srcReg, dec_->onesize_ * n + srcoff + 0);
+		LD_H(tempReg2, srcReg, dec_->onesize_ * n + srcoff + 2);
+		LD_H(tempReg3, srcReg, dec_->onesize_ * n + srcoff + 4);
+		MOVGR2FR_W(fpScratchReg1, tempReg1);
+		FFINT_S_W(fpScratchReg1, fpScratchReg1);
+		MOVGR2FR_W(fpScratchReg2, tempReg2);
+		FFINT_S_W(fpScratchReg2, fpScratchReg2);
+		MOVGR2FR_W(fpScratchReg3, tempReg3);
+		FFINT_S_W(fpScratchReg3, fpScratchReg3);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+		FMADD_S(fpSrc[2], fpScratchReg3, fpScratchReg4, fpSrc[2]);
+	}
+
+	if (dstoff >= 0) {
+		FST_S(fpSrc[0], dstReg, dstoff + 0);
+		FST_S(fpSrc[1], dstReg, dstoff + 4);
+		FST_S(fpSrc[2], dstReg, dstoff + 8);
+	}
+}
+
+void VertexDecoderJitCache::Jit_AnyFloatMorph(int srcoff, int dstoff) {
+	FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + 0) * 4);
+	FLD_S(fpSrc[0], srcReg, srcoff + 0);
+	FLD_S(fpSrc[1], srcReg, srcoff + 4);
+	FLD_S(fpSrc[2], srcReg, srcoff + 8);
+	FMUL_S(fpSrc[0], fpSrc[0], fpScratchReg4);
+	FMUL_S(fpSrc[1], fpSrc[1], fpScratchReg4);
+	FMUL_S(fpSrc[2], fpSrc[2], fpScratchReg4);
+
+	for (int n = 1; n < dec_->morphcount; n++) {
+		FLD_S(fpScratchReg4, morphBaseReg, ((int)MorphValuesIndex::AS_FLOAT * 8 + n) * 4);
+		FLD_S(fpScratchReg1, srcReg, dec_->onesize_ * n + srcoff + 0);
+		FLD_S(fpScratchReg2, srcReg, dec_->onesize_ * n + srcoff + 4);
+		FLD_S(fpScratchReg3, srcReg, dec_->onesize_ * n + srcoff + 8);
+		FMADD_S(fpSrc[0], fpScratchReg1, fpScratchReg4, fpSrc[0]);
+		FMADD_S(fpSrc[1], fpScratchReg2, fpScratchReg4, fpSrc[1]);
+		FMADD_S(fpSrc[2], fpScratchReg3, fpScratchReg4, fpSrc[2]);
+	}
+
+	if (dstoff >= 0) {
+		FST_S(fpSrc[0], dstReg, dstoff + 0);
+		FST_S(fpSrc[1], dstReg, dstoff + 4);
+		FST_S(fpSrc[2], dstReg, dstoff + 8);
+	}
+}
+
+void VertexDecoderJitCache::Jit_WriteMatrixMul(int dstoff, bool pos) {
+	const LoongArch64Reg fpDst[3] = { fpScratchReg1, fpScratchReg2, fpScratchReg3 };
+
+	// When using morph + skin, we don't keep skinMatrix in a reg.
+	LoongArch64Reg skinMatrixReg = morphBaseReg;
+	if (dec_->morphcount > 1) {
+		LI(scratchReg, &skinMatrix[0]);
+		skinMatrixReg = scratchReg;
+	}
+
+	// First, take care of the 3x3 portion of the matrix.
+	for (int y = 0; y < 3; ++y) {
+		for (int x = 0; x < 3; ++x) {
+			FLD_S(fpScratchReg4, skinMatrixReg, (y * 3 + x) * 4);
+			if (y == 0)
+				FMUL_S(fpDst[x], fpSrc[y], fpScratchReg4);
+			else
+				FMADD_S(fpDst[x], fpSrc[y], fpScratchReg4, fpDst[x]);
+		}
+	}
+
+	// For normal, z is 0 so we skip.
+	if (pos) {
+		for (int x = 0; x < 3; ++x)
+			FLD_S(fpSrc[x], skinMatrixReg, (9 + x) * 4);
+		for (int x = 0; x < 3; ++x)
+			FADD_S(fpDst[x], fpDst[x], fpSrc[x]);
+	}
+
+	for (int x = 0; x < 3; ++x)
+		FST_S(fpDst[x], dstReg, dstoff + x * 4);
+}
+
+#endif // PPSSPP_ARCH(LOONGARCH64)
@@ -93,6 +93,11 @@ static const X64Reg fpScratchReg2 = XMM2;
 static const X64Reg fpScratchReg3 = XMM3;
 static const X64Reg fpScratchReg4 = XMM4;
 
+// Only used by the wide steps, which never run together with skinning (the only other user of XMM8/XMM9.)
+// The UVs of both vertices are in one register there, so these hold the scale and offset twice.
+static const X64Reg fpWideScaleReg = XMM8;
+static const X64Reg fpWideOffsetReg = XMM9;
+
 // We're gonna keep the current skinning matrix in 4 XMM regs. Fortunately we easily
 // have space for that now.
 
@@ -168,6 +173,17 @@ static const JitLookup jitLookup[] = {
 	{&VertexDecoder::Step_Color5551Morph, &VertexDecoderJitCache::Jit_Color5551Morph},
 };
 
+// Steps that have a version decoding two vertices at once. Texcoords are only two components,
+// so two vertices fill an SSE register. The three and four component conversions gain nothing
+// from 256-bit registers, the lane shuffling costs more than the saved arithmetic.
+static const JitLookup jitLookupWide[] = {
+	{&VertexDecoder::Step_TcU8ToFloat, &VertexDecoderJitCache::Jit_TcU8ToFloatWide},
+	{&VertexDecoder::Step_TcU16ToFloat, &VertexDecoderJitCache::Jit_TcU16ToFloatWide},
+	{&VertexDecoder::Step_TcU8Prescale, &VertexDecoderJitCache::Jit_TcU8PrescaleWide},
+	{&VertexDecoder::Step_TcU16Prescale, &VertexDecoderJitCache::Jit_TcU16PrescaleWide},
+	{&VertexDecoder::Step_TcFloatPrescale, &VertexDecoderJitCache::Jit_TcFloatPrescaleWide},
+};
+
 JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int32_t *jittedSize) {
 	dec_ = &dec;
 	BeginWrite(4096);
@@ -246,6 +262,27 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		}
 	}
 
+	// Decode two vertices per iteration if there's something worth converting that way.
+	// Skinning needs XMM8/XMM9, so that stays one vertex at a time. With normals the texcoords are too
+	// small a part of the work, and the bigger loop measured slower, so this is mostly for 2D formats.
+	bool wide = false;
+	bool wideSteps[ARRAY_SIZE(dec.steps_)]{};
+#if PPSSPP_ARCH(AMD64)
+	if (allowWide_ && cpu_info.bSSE4_1 && !dec.skinInDecode && !dec.nrm) {
+		for (int i = 0; i < dec.numSteps_; i++) {
+			wideSteps[i] = IsWideStep(dec, i);
+			wide = wide || wideSteps[i];
+		}
+	}
+#endif
+
+	if (wide && prescaleStep) {
+		MOVAPS(fpWideScaleReg, R(fpScaleOffsetReg));
+		SHUFPS(fpWideScaleReg, R(fpWideScaleReg), _MM_SHUFFLE(1, 0, 1, 0));
+		MOVAPS(fpWideOffsetReg, R(fpScaleOffsetReg));
+		SHUFPS(fpWideOffsetReg, R(fpWideOffsetReg), _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
 	// Add code to convert matrices to 4x4.
 	// Later we might want to do this when the matrices are loaded instead.
 	// Can't touch fpScaleOffsetReg (XMM0) in here!
@@ -273,6 +310,44 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		}
 	}
 
+	FixupBranch skipWide;
+	FixupBranch skipTail;
+	if (wide) {
+		CMP(32, R(counterReg), Imm8(2));
+		skipWide = J_CC(CC_L, true);
+
+		// Some regular steps store beyond their component, which is fine as long as each vertex is
+		// written in step order and the first vertex before the second. So the wide steps run in
+		// their place in the second vertex, and store exactly their components.
+		JumpTarget wideLoopStart = NopAlignCode16();
+		for (int v = 0; v < 2; v++) {
+			if (v == 1) {
+				ADD(PTRBITS, R(srcReg), Imm32(dec.VertexSize()));
+				ADD(PTRBITS, R(dstReg), Imm32(dec.decFmt.stride));
+			}
+			for (int i = 0; i < dec.numSteps_; i++) {
+				if (wideSteps[i]) {
+					if (v == 1)
+						CompileWideStep(dec, i);
+				} else if (!CompileStep(dec, i)) {
+					EndWrite();
+					ResetCodePtr(GetOffset(start));
+					return 0;
+				}
+			}
+		}
+		ADD(PTRBITS, R(srcReg), Imm32(dec.VertexSize()));
+		ADD(PTRBITS, R(dstReg), Imm32(dec.decFmt.stride));
+		SUB(32, R(counterReg), Imm8(2));
+		CMP(32, R(counterReg), Imm8(2));
+		J_CC(CC_GE, wideLoopStart, true);
+
+		// Then the last vertex, if there's an odd number of them.
+		SetJumpTarget(skipWide);
+		TEST(32, R(counterReg), R(counterReg));
+		skipTail = J_CC(CC_Z, true);
+	}
+
 	// Let's not bother with a proper stack frame. We just grab the arguments and go.
 	JumpTarget loopStart = NopAlignCode16();
 	for (int i = 0; i < dec.numSteps_; i++) {
@@ -289,6 +364,10 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	SUB(32, R(counterReg), Imm8(1));
 	J_CC(CC_NZ, loopStart, true);
 
+	if (wide) {
+		SetJumpTarget(skipTail);
+	}
+
 	// Writeback alpha reg
 #if PPSSPP_ARCH(AMD64)
 	if (dec.col) {
@@ -777,12 +856,18 @@ void VertexDecoderJitCache::Jit_TcFloat() {
 }
 
 void VertexDecoderJitCache::Jit_TcU8Prescale() {
-	// TODO: The first five instructions could be done in 1 or 2 in SSE4
-	MOVZX(32, 8, tempReg1, MDisp(srcReg, dec_->tcoff));
-	MOVZX(32, 8, tempReg2, MDisp(srcReg, dec_->tcoff + 1));
-	CVTSI2SS(fpScratchReg, R(tempReg1));
-	CVTSI2SS(fpScratchReg2, R(tempReg2));
-	UNPCKLPS(fpScratchReg, R(fpScratchReg2));
+	// Zero extend so the unused lanes are zero, rather than whatever was left in there (possibly denormals,
+	// which are very slow to multiply.)
+	MOVZX(32, 16, tempReg1, MDisp(srcReg, dec_->tcoff));
+	MOVD_xmm(fpScratchReg, R(tempReg1));
+	if (cpu_info.bSSE4_1) {
+		PMOVZXBD(fpScratchReg, R(fpScratchReg));
+	} else {
+		PXOR(fpScratchReg2, R(fpScratchReg2));
+		PUNPCKLBW(fpScratchReg, R(fpScratchReg2));
+		PUNPCKLWD(fpScratchReg, R(fpScratchReg2));
+	}
+	CVTDQ2PS(fpScratchReg, R(fpScratchReg));
 	// TODO: These are a lot of nasty consecutive dependencies. Can probably be made faster
 	// if we can spare another register to avoid the shuffle, like on ARM.
 	MULPS(fpScratchReg, R(fpScaleOffsetReg));
@@ -1731,4 +1816,104 @@ bool VertexDecoderJitCache::CompileStep(const VertexDecoder &dec, int step) {
 	return false;
 }
 
+bool VertexDecoderJitCache::IsWideStep(const VertexDecoder &dec, int step) const {
+	for (size_t i = 0; i < ARRAY_SIZE(jitLookupWide); i++) {
+		if (dec.steps_[step] == jitLookupWide[i].func) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void VertexDecoderJitCache::CompileWideStep(const VertexDecoder &dec, int step) {
+	for (size_t i = 0; i < ARRAY_SIZE(jitLookupWide); i++) {
+		if (dec.steps_[step] == jitLookupWide[i].func) {
+			((*this).*jitLookupWide[i].jitFunc)();
+			return;
+		}
+	}
+	_dbg_assert_msg_(false, "CompileWideStep: Not a wide step");
+}
+
+// The wide steps run with srcReg and dstReg pointing at the second vertex.
+OpArg VertexDecoderJitCache::WideSrc(int v, int off) const {
+	return MDisp(srcReg, (v - 1) * (int)dec_->VertexSize() + off);
+}
+
+OpArg VertexDecoderJitCache::WideDst(int v, int off) const {
+	return MDisp(dstReg, (v - 1) * (int)dec_->decFmt.stride + off);
+}
+
+// Loads the texcoords of both vertices as ints into XMM1, as u0 v0 u1 v1.
+void VertexDecoderJitCache::Jit_WideLoadTcU8() {
+	MOVZX(32, 16, tempReg1, WideSrc(0, dec_->tcoff));
+	MOVZX(32, 16, tempReg2, WideSrc(1, dec_->tcoff));
+	SHL(32, R(tempReg2), Imm8(16));
+	OR(32, R(tempReg1), R(tempReg2));
+	MOVD_xmm(XMM1, R(tempReg1));
+	PMOVZXBD(XMM1, R(XMM1));
+}
+
+void VertexDecoderJitCache::Jit_WideLoadTcU16() {
+	MOV(32, R(tempReg1), WideSrc(0, dec_->tcoff));
+	MOV(32, R(tempReg2), WideSrc(1, dec_->tcoff));
+	SHL(64, R(tempReg2), Imm8(32));
+	OR(64, R(tempReg1), R(tempReg2));
+	MOVQ_xmm(XMM1, R(tempReg1));
+	PMOVZXWD(XMM1, R(XMM1));
+}
+
+void VertexDecoderJitCache::Jit_WideStoreTc() {
+	MOVQ_xmm(WideDst(0, dec_->decFmt.uvoff), XMM3);
+	MOVHPS(WideDst(1, dec_->decFmt.uvoff), XMM3);
+}
+
+void VertexDecoderJitCache::Jit_TcU8ToFloatWide() {
+	Jit_WideLoadTcU8();
+	CVTDQ2PS(XMM3, R(XMM1));
+	if (RipAccessible(&by128)) {
+		MULPS(XMM3, M(&by128));  // rip accessible
+	} else {
+		MOV(PTRBITS, R(tempReg1), ImmPtr(&by128));
+		MULPS(XMM3, MatR(tempReg1));
+	}
+	Jit_WideStoreTc();
+}
+
+void VertexDecoderJitCache::Jit_TcU16ToFloatWide() {
+	Jit_WideLoadTcU16();
+	CVTDQ2PS(XMM3, R(XMM1));
+	if (RipAccessible(&by32768)) {
+		MULPS(XMM3, M(&by32768));  // rip accessible
+	} else {
+		MOV(PTRBITS, R(tempReg1), ImmPtr(&by32768));
+		MULPS(XMM3, MatR(tempReg1));
+	}
+	Jit_WideStoreTc();
+}
+
+void VertexDecoderJitCache::Jit_TcU8PrescaleWide() {
+	Jit_WideLoadTcU8();
+	CVTDQ2PS(XMM3, R(XMM1));
+	MULPS(XMM3, R(fpWideScaleReg));
+	ADDPS(XMM3, R(fpWideOffsetReg));
+	Jit_WideStoreTc();
+}
+
+void VertexDecoderJitCache::Jit_TcU16PrescaleWide() {
+	Jit_WideLoadTcU16();
+	CVTDQ2PS(XMM3, R(XMM1));
+	MULPS(XMM3, R(fpWideScaleReg));
+	ADDPS(XMM3, R(fpWideOffsetReg));
+	Jit_WideStoreTc();
+}
+
+void VertexDecoderJitCache::Jit_TcFloatPrescaleWide() {
+	MOVQ_xmm(XMM3, WideSrc(0, dec_->tcoff));
+	MOVHPS(XMM3, WideSrc(1, dec_->tcoff));
+	MULPS(XMM3, R(fpWideScaleReg));
+	ADDPS(XMM3, R(fpWideOffsetReg));
+	Jit_WideStoreTc();
+}
+
 #endif // PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
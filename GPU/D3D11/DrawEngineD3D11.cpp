@@ -20,6 +20,8 @@
 #include "Common/Profiler/Profiler.h"
 
 #include "Core/Config.h"
+#include "Core/HW/Display.h"
+#include "Core/System.h"
 
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
@@ -69,6 +71,8 @@ DrawEngineD3D11::DrawEngineD3D11(Draw::DrawContext *draw, ID3D11Device *device,
 	context1_ = (ID3D11DeviceContext1 *)draw->GetNativeObject(Draw::NativeObject::CONTEXT_EX);
 	decOptions_.expandAllWeightsToFloat = true;
 	decOptions_.expand8BitNormalsToFloat = true;
+	// Indexed strips with 16-bit indices always restart at 0xFFFF in D3D11.
+	supportsPrimitiveRestart_ = true;
 
 	InitDeviceObjects();
 }
@@ -93,6 +97,8 @@ void DrawEngineD3D11::ClearInputLayoutMap() {
 			il->Release();
 	});
 	inputLayoutMap_.Clear();
+	// A new layout could get the same address.
+	bound_ = {};
 }
 
 void DrawEngineD3D11::NotifyConfigChanged() {
@@ -234,6 +240,7 @@ void DrawEngineD3D11::BeginFrame() {
 	pushInds_->Reset();
 
 	lastRenderStepId_ = -1;
+	bound_ = {};
 }
 
 // In D3D, we're synchronous and state carries over so all we reset here on a new step is the viewport/scissor.
@@ -241,15 +248,44 @@ void DrawEngineD3D11::Invalidate(InvalidationCallbackFlags flags) {
 	if (flags & InvalidationCallbackFlags::RENDER_PASS_STATE) {
 		gstate_c.Dirty(DIRTY_VIEWPORTSCISSOR_STATE | DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
 	}
+	if (flags & (InvalidationCallbackFlags::RENDER_PASS_STATE | InvalidationCallbackFlags::CACHED_RENDER_STATE)) {
+		// Something else may have used the context.
+		bound_ = {};
+	}
+}
+
+void DrawEngineD3D11::BindShadersAndLayout(D3D11VertexShader *vshader, D3D11FragmentShader *fshader, ID3D11InputLayout *inputLayout, D3D11_PRIMITIVE_TOPOLOGY topology) {
+	// Consecutive draws very often share all of these, and each call costs driver time.
+	if (bound_.ps != fshader->GetShader()) {
+		context_->PSSetShader(fshader->GetShader(), nullptr, 0);
+		bound_.ps = fshader->GetShader();
+	}
+	if (bound_.vs != vshader->GetShader()) {
+		context_->VSSetShader(vshader->GetShader(), nullptr, 0);
+		bound_.vs = vshader->GetShader();
+	}
+	if (bound_.inputLayout != inputLayout) {
+		context_->IASetInputLayout(inputLayout);
+		bound_.inputLayout = inputLayout;
+	}
+	if (bound_.topology != topology) {
+		context_->IASetPrimitiveTopology(topology);
+		bound_.topology = topology;
+	}
 }
 
 void DrawEngineD3D11::Flush() {
 	if (!numDrawVerts_) {
 		return;
 	}
+	FramePhaseTimer phaseTimer(FramePhase::DRAW, coreCollectDebugStats);
 	bool textureNeedsApply = false;
 	if (gstate_c.IsDirty(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS) && !gstate.isModeClear() && gstate.isTextureMapEnabled()) {
-		textureCache_->SetTexture();
+		if (atlasBatch_) {
+			textureCache_->SetAtlasTexture();
+		} else {
+			textureCache_->SetTexture();
+		}
 		gstate_c.Clean(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
 		textureNeedsApply = true;
 	} else if (gstate.getTextureAddress(0) == (gstate.getFrameBufRawAddress() | 0x04000000)) {
@@ -296,14 +332,14 @@ void DrawEngineD3D11::Flush() {
 		D3D11FragmentShader *fshader;
 		shaderManager_->GetShaders(prim, dec_, &vshader, &fshader, pipelineState_, useHWTransform, useHWTessellation_, decOptions_.expandAllWeightsToFloat, applySkinInDecode_);
 		ID3D11InputLayout *inputLayout = SetupDecFmtForDraw(vshader, dec_->GetDecVtxFmt(), dec_->VertexType());
-		context_->PSSetShader(fshader->GetShader(), nullptr, 0);
-		context_->VSSetShader(vshader->GetShader(), nullptr, 0);
+		BindShadersAndLayout(vshader, fshader, inputLayout, d3d11prim[prim]);
 		shaderManager_->UpdateUniforms(framebufferManager_->UseBufferedRendering());
-		shaderManager_->BindUniforms();
+		if (!bound_.uniforms) {
+			shaderManager_->BindUniforms();
+			bound_.uniforms = true;
+		}
 
-		context_->IASetInputLayout(inputLayout);
 		UINT stride = dec_->GetDecVtxFmt().stride;
-		context_->IASetPrimitiveTopology(d3d11prim[prim]);
 
 		if (!vb_) {
 			// Push!
@@ -430,10 +466,11 @@ void DrawEngineD3D11::Flush() {
 			D3D11VertexShader *vshader;
 			D3D11FragmentShader *fshader;
 			shaderManager_->GetShaders(prim, swDec, &vshader, &fshader, pipelineState_, false, false, decOptions_.expandAllWeightsToFloat, true);
-			context_->PSSetShader(fshader->GetShader(), nullptr, 0);
-			context_->VSSetShader(vshader->GetShader(), nullptr, 0);
 			shaderManager_->UpdateUniforms(framebufferManager_->UseBufferedRendering());
-			shaderManager_->BindUniforms();
+			if (!bound_.uniforms) {
+				shaderManager_->BindUniforms();
+				bound_.uniforms = true;
+			}
 
 			// We really do need a vertex layout for each vertex shader (or at least check its ID bits for what inputs it uses)!
 			// Some vertex shaders ignore one of the inputs, and then the layout created from it will lack it, which will be a problem for others.
@@ -443,8 +480,7 @@ void DrawEngineD3D11::Flush() {
 				ASSERT_SUCCESS(device_->CreateInputLayout(TransformedVertexElements, ARRAY_SIZE(TransformedVertexElements), vshader->bytecode().data(), vshader->bytecode().size(), &layout));
 				inputLayoutMap_.Insert(key, layout);
 			}
-			context_->IASetInputLayout(layout);
-			context_->IASetPrimitiveTopology(d3d11prim[prim]);
+			BindShadersAndLayout(vshader, fshader, layout, d3d11prim[prim]);
 
 			UINT stride = sizeof(TransformedVertex);
 			UINT vOffset = 0;
@@ -90,6 +90,7 @@ class DrawEngineD3D11 : public DrawEngineCommon {
 	void ApplyDrawStateLate(bool applyStencilRef, uint8_t stencilRef);
 
 	ID3D11InputLayout *SetupDecFmtForDraw(D3D11VertexShader *vshader, const DecVtxFormat &decFmt, u32 pspFmt);
+	void BindShadersAndLayout(D3D11VertexShader *vshader, D3D11FragmentShader *fshader, ID3D11InputLayout *inputLayout, D3D11_PRIMITIVE_TOPOLOGY topology);
 
 	Draw::DrawContext *draw_;  // Used for framebuffer related things exclusively.
 	ID3D11Device *device_;
@@ -126,6 +127,17 @@ class DrawEngineD3D11 : public DrawEngineCommon {
 	DenseHashMap<uint64_t, ID3D11DepthStencilState *> depthStencilCache_;
 	DenseHashMap<uint32_t, ID3D11RasterizerState *> rasterCache_;
 
+	// What we last bound on the context, to skip redundant calls. thin3d shares the context, so this
+	// is reset whenever it invalidates its own state cache, and on each render pass.
+	struct BoundState {
+		ID3D11VertexShader *vs;
+		ID3D11PixelShader *ps;
+		ID3D11InputLayout *inputLayout;
+		D3D11_PRIMITIVE_TOPOLOGY topology;
+		bool uniforms;
+	};
+	BoundState bound_{};
+
 	// Keep the depth state between ApplyDrawState and ApplyDrawStateLate
 	ID3D11RasterizerState *rasterState_ = nullptr;
 	ID3D11BlendState *blendState_ = nullptr;
@@ -18,9 +18,15 @@
 #include <string>
 
 #include "Common/Log.h"
+#include "Common/File/FileUtil.h"
 #include "Common/GraphicsContext.h"
 #include "Common/Profiler/Profiler.h"
 
+#include "Core/Config.h"
+#include "Core/Core.h"
+#include "Core/System.h"
+#include "Core/ELF/ParamSFO.h"
+
 #include "GPU/GPUState.h"
 
 #include "GPU/Common/FramebufferManagerCommon.h"
@@ -75,12 +81,64 @@ GPU_D3D11::GPU_D3D11(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 	// Some of our defaults are different from hw defaults, let's assert them.
 	// We restore each frame anyway, but here is convenient for tests.
 	textureCache_->NotifyConfigChanged();
+
+	// Load shader cache.  The DXBC cache only has what a D3D11 run compiled, the ID list may also
+	// have shaders the other backends have seen.
+	std::string discID = g_paramSFO.GetDiscID();
+	if (discID.size()) {
+		if (g_Config.bShaderCache) {
+			File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+			shaderCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".d3d11shadercache");
+			shaderIDListPath_ = ShaderIDListPath(discID);
+			ShaderIDList idList;
+			FILE *f = File::OpenCFile(shaderCachePath_, "rb");
+			if (f) {
+				bool success = shaderManagerD3D11_->LoadCache(f, &idList);
+				fclose(f);
+				if (!success) {
+					WARN_LOG(Log::G3D, "Bad D3D11 shader cache, deleting");
+					File::Delete(shaderCachePath_);
+				}
+			}
+			ShaderIDList sharedList;
+			if (LoadShaderIDList(shaderIDListPath_, &sharedList)) {
+				idList.vertex.insert(idList.vertex.end(), sharedList.vertex.begin(), sharedList.vertex.end());
+				idList.fragment.insert(idList.fragment.end(), sharedList.fragment.begin(), sharedList.fragment.end());
+			}
+			if (!idList.vertex.empty() || !idList.fragment.empty()) {
+				FilterShaderIDList(&idList);
+				shaderManagerD3D11_->PrecompileShaderIDList(idList);
+				// We're compiling now, clear if they changed.
+				gstate_c.useFlagsChanged = false;
+			}
+		} else {
+			INFO_LOG(Log::G3D, "Shader cache disabled. Not loading.");
+		}
+	}
 }
 
 GPU_D3D11::~GPU_D3D11() {
+	if (shaderIDListPath_.Valid()) {
+		SaveCache();
+	}
 	stockD3D11.Destroy();
 }
 
+void GPU_D3D11::SaveCache() {
+	ShaderIDList idList;
+	shaderManagerD3D11_->GetShaderIDList(&idList);
+	SaveShaderIDList(shaderIDListPath_, idList);
+
+	Path tempPath = File::TempPathFor(shaderCachePath_);
+	FILE *f = File::OpenCFile(tempPath, "wb");
+	if (f) {
+		shaderManagerD3D11_->SaveCache(f);
+		fclose(f);
+		if (!File::ReplaceFile(tempPath, shaderCachePath_))
+			File::Delete(tempPath);
+	}
+}
+
 u32 GPU_D3D11::CheckGPUFeatures() const {
 	u32 features = GPUCommonHW::CheckGPUFeatures();
 
@@ -126,6 +184,12 @@ void GPU_D3D11::BeginHostFrame() {
 
 	shaderManager_->DirtyLastShader();
 
+	// Save the ID list from time to time, like the GLES shader cache.
+	const int saveShaderCacheFrameInterval = 32767;
+	if (shaderIDListPath_.Valid() && !(gpuStats.numFlips & saveShaderCacheFrameInterval) && coreState == CORE_RUNNING_CPU) {
+		SaveCache();
+	}
+
 	framebufferManager_->BeginFrame();
 	gstate_c.Dirty(DIRTY_PROJTHROUGHMATRIX);
 
@@ -21,6 +21,8 @@
 #include <vector>
 #include <d3d11.h>
 
+#include "Common/File/Path.h"
+
 #include "GPU/GPUCommonHW.h"
 #include "GPU/D3D11/DrawEngineD3D11.h"
 #include "GPU/Common/VertexDecoderCommon.h"
@@ -45,6 +47,7 @@ class GPU_D3D11 : public GPUCommonHW {
 
 private:
 	void BeginHostFrame() override;
+	void SaveCache();
 
 	ID3D11Device *device_;
 	ID3D11DeviceContext *context_;
@@ -53,4 +56,7 @@ class GPU_D3D11 : public GPUCommonHW {
 	TextureCacheD3D11 *textureCacheD3D11_;
 	DrawEngineD3D11 drawEngine_;
 	ShaderManagerD3D11 *shaderManagerD3D11_;
+
+	Path shaderCachePath_;
+	Path shaderIDListPath_;
 };
@@ -21,21 +21,34 @@
 #include <D3Dcompiler.h>
 
 #include <map>
+#include <memory>
+#include <set>
 
 #include "Common/GPU/thin3d.h"
 #include "Common/Log.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/TimeUtil.h"
 #include "Common/CommonTypes.h"
+#include "Core/HW/Display.h"
+#include "Core/System.h"
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
 #include "GPU/Common/VertexShaderGenerator.h"
 #include "GPU/D3D11/ShaderManagerD3D11.h"
 #include "GPU/D3D11/D3D11Util.h"
+#include "ext/xxhash.h"
 
-D3D11FragmentShader::D3D11FragmentShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, FShaderID id, const char *code, bool useHWTransform)
+D3D11FragmentShader::D3D11FragmentShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, FShaderID id, const char *code, bool useHWTransform, std::vector<uint8_t> *cachedBytecode)
 	: device_(device), useHWTransform_(useHWTransform), id_(id) {
 	source_ = code;
 
-	module_ = CreatePixelShaderD3D11(device, code, strlen(code), featureLevel);
+	if (cachedBytecode && !cachedBytecode->empty()) {
+		bytecode_ = std::move(*cachedBytecode);
+		if (FAILED(device->CreatePixelShader(bytecode_.data(), bytecode_.size(), nullptr, &module_)))
+			module_ = nullptr;
+	}
+	if (!module_)
+		module_ = CreatePixelShaderD3D11(device, code, strlen(code), &bytecode_, featureLevel);
 	if (!module_)
 		failed_ = true;
 }
@@ -56,11 +69,17 @@ std::string D3D11FragmentShader::GetShaderString(DebugShaderStringType type) con
 	}
 }
 
-D3D11VertexShader::D3D11VertexShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, VShaderID id, const char *code, bool useHWTransform)
+D3D11VertexShader::D3D11VertexShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, VShaderID id, const char *code, bool useHWTransform, std::vector<uint8_t> *cachedBytecode)
 	: device_(device), useHWTransform_(useHWTransform), id_(id) {
 	source_ = code;
 
-	module_ = CreateVertexShaderD3D11(device, code, strlen(code), &bytecode_, featureLevel);
+	if (cachedBytecode && !cachedBytecode->empty()) {
+		bytecode_ = std::move(*cachedBytecode);
+		if (FAILED(device->CreateVertexShader(bytecode_.data(), bytecode_.size(), nullptr, &module_)))
+			module_ = nullptr;
+	}
+	if (!module_)
+		module_ = CreateVertexShaderD3D11(device, code, strlen(code), &bytecode_, featureLevel);
 	if (!module_)
 		failed_ = true;
 }
@@ -142,23 +161,36 @@ uint64_t ShaderManagerD3D11::UpdateUniforms(bool useBufferedRendering) {
 	uint64_t dirty = gstate_c.GetDirtyUniforms();
 	if (dirty != 0) {
 		D3D11_MAPPED_SUBRESOURCE map;
+		// Dirty doesn't mean changed, skip the upload (and the buffer rename) if the contents match the last one.
 		if (dirty & DIRTY_BASE_UNIFORMS) {
 			BaseUpdateUniforms(&ub_base, dirty, true, useBufferedRendering);
-			context_->Map(push_base, 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-			memcpy(map.pData, &ub_base, sizeof(ub_base));
-			context_->Unmap(push_base, 0);
+			uint64_t hash = XXH3_64bits(&ub_base, sizeof(ub_base));
+			if (hash != uploadedBaseHash_) {
+				context_->Map(push_base, 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+				memcpy(map.pData, &ub_base, sizeof(ub_base));
+				context_->Unmap(push_base, 0);
+				uploadedBaseHash_ = hash;
+			}
 		}
 		if (dirty & DIRTY_LIGHT_UNIFORMS) {
 			LightUpdateUniforms(&ub_lights, dirty);
-			context_->Map(push_lights, 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-			memcpy(map.pData, &ub_lights, sizeof(ub_lights));
-			context_->Unmap(push_lights, 0);
+			uint64_t hash = XXH3_64bits(&ub_lights, sizeof(ub_lights));
+			if (hash != uploadedLightsHash_) {
+				context_->Map(push_lights, 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+				memcpy(map.pData, &ub_lights, sizeof(ub_lights));
+				context_->Unmap(push_lights, 0);
+				uploadedLightsHash_ = hash;
+			}
 		}
 		if (dirty & DIRTY_BONE_UNIFORMS) {
 			BoneUpdateUniforms(&ub_bones, dirty);
-			context_->Map(push_bones, 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-			memcpy(map.pData, &ub_bones, sizeof(ub_bones));
-			context_->Unmap(push_bones, 0);
+			uint64_t hash = XXH3_64bits(&ub_bones, sizeof(ub_bones));
+			if (hash != uploadedBonesHash_) {
+				context_->Map(push_bones, 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+				memcpy(map.pData, &ub_bones, sizeof(ub_bones));
+				context_->Unmap(push_bones, 0);
+				uploadedBonesHash_ = hash;
+			}
 		}
 	}
 	gstate_c.CleanUniforms();
@@ -202,6 +234,7 @@ void ShaderManagerD3D11::GetShaders(int prim, VertexDecoder *decoder, D3D11Verte
 	D3D11VertexShader *vs;
 	if (vsIter == vsCache_.end()) {
 		// Vertex shader not in cache. Let's compile it.
+		FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 		std::string genErrorString;
 		uint32_t attrMask;
 		uint64_t uniformMask;
@@ -219,6 +252,7 @@ void ShaderManagerD3D11::GetShaders(int prim, VertexDecoder *decoder, D3D11Verte
 	D3D11FragmentShader *fs;
 	if (fsIter == fsCache_.end()) {
 		// Fragment shader not in cache. Let's compile it.
+		FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 		std::string genErrorString;
 		uint64_t uniformMask;
 		FragmentShaderFlags flags;
@@ -239,6 +273,188 @@ void ShaderManagerD3D11::GetShaders(int prim, VertexDecoder *decoder, D3D11Verte
 	*fshader = fs;
 }
 
+void ShaderManagerD3D11::GetShaderIDList(ShaderIDList *list) {
+	for (const auto &iter : vsCache_) {
+		if (!iter.second->Failed())
+			list->vertex.push_back(iter.first);
+	}
+	for (const auto &iter : fsCache_) {
+		if (!iter.second->Failed())
+			list->fragment.push_back(iter.first);
+	}
+}
+
+D3D11VertexShader *ShaderManagerD3D11::PrecompileVertexShader(const VShaderID &id, char *buffer) {
+	std::string genErrorString;
+	uint32_t attrMask;
+	uint64_t uniformMask;
+	VertexShaderFlags flags;
+	if (!GenerateVertexShader(id, buffer, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &attrMask, &uniformMask, &flags, &genErrorString))
+		return nullptr;
+	_assert_msg_(strlen(buffer) < CODE_BUFFER_SIZE, "VS length error: %d", (int)strlen(buffer));
+
+	// Each ID is only handled once, so it's safe to take from the cache on any thread.
+	std::vector<uint8_t> *cached = nullptr;
+	auto iter = cachedVS_.find(id);
+	if (iter != cachedVS_.end() && iter->second.sourceHash == XXH3_64bits(buffer, strlen(buffer)))
+		cached = &iter->second.bytecode;
+	return new D3D11VertexShader(device_, featureLevel_, id, buffer, id.Bit(VS_BIT_USE_HW_TRANSFORM), cached);
+}
+
+D3D11FragmentShader *ShaderManagerD3D11::PrecompileFragmentShader(const FShaderID &id, char *buffer) {
+	std::string genErrorString;
+	uint64_t uniformMask;
+	FragmentShaderFlags flags;
+	if (!GenerateFragmentShader(id, buffer, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &uniformMask, &flags, &genErrorString))
+		return nullptr;
+	_assert_msg_(strlen(buffer) < CODE_BUFFER_SIZE, "FS length error: %d", (int)strlen(buffer));
+
+	std::vector<uint8_t> *cached = nullptr;
+	auto iter = cachedFS_.find(id);
+	if (iter != cachedFS_.end() && iter->second.sourceHash == XXH3_64bits(buffer, strlen(buffer)))
+		cached = &iter->second.bytecode;
+	return new D3D11FragmentShader(device_, featureLevel_, id, buffer, false, cached);
+}
+
+void ShaderManagerD3D11::PrecompileShaderIDList(const ShaderIDList &list) {
+	double start = time_now_d();
+
+	std::set<VShaderID> vsSet;
+	for (const VShaderID &id : list.vertex) {
+		if (vsCache_.find(id) == vsCache_.end())
+			vsSet.insert(id);
+	}
+	std::set<FShaderID> fsSet;
+	for (const FShaderID &id : list.fragment) {
+		if (fsCache_.find(id) == fsCache_.end())
+			fsSet.insert(id);
+	}
+	std::vector<VShaderID> vsids(vsSet.begin(), vsSet.end());
+	std::vector<FShaderID> fsids(fsSet.begin(), fsSet.end());
+
+	// D3D11 devices and D3DCompile are free threaded, so spread them out.
+	const int numVS = (int)vsids.size();
+	std::vector<D3D11VertexShader *> vs(vsids.size());
+	std::vector<D3D11FragmentShader *> fs(fsids.size());
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		std::unique_ptr<char[]> buffer(new char[CODE_BUFFER_SIZE]);
+		for (int i = lower; i < upper; i++) {
+			if (i < numVS)
+				vs[i] = PrecompileVertexShader(vsids[i], buffer.get());
+			else
+				fs[i - numVS] = PrecompileFragmentShader(fsids[i - numVS], buffer.get());
+		}
+	}, 0, numVS + (int)fsids.size(), 4);
+
+	// Failed ones are left to GetShaders, like without the list.
+	int vsCount = 0;
+	int fsCount = 0;
+	for (size_t i = 0; i < vs.size(); i++) {
+		if (vs[i] && !vs[i]->Failed()) {
+			vsCache_[vsids[i]] = vs[i];
+			vsCount++;
+		} else {
+			delete vs[i];
+		}
+	}
+	for (size_t i = 0; i < fs.size(); i++) {
+		if (fs[i] && !fs[i]->Failed()) {
+			fsCache_[fsids[i]] = fs[i];
+			fsCount++;
+		} else {
+			delete fs[i];
+		}
+	}
+	cachedVS_.clear();
+	cachedFS_.clear();
+
+	NOTICE_LOG(Log::G3D, "Precompile: Created %d vertex and %d fragment shaders in %0.1f milliseconds", vsCount, fsCount, 1000 * (time_now_d() - start));
+}
+
+#define CACHE_HEADER_MAGIC 0x31314433  // "3D11"
+#define CACHE_VERSION 1
+
+struct D3D11CacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t compilerVersion;
+	uint32_t featureLevel;
+	uint32_t numVertexShaders;
+	uint32_t numFragmentShaders;
+};
+
+template <class T, class M>
+static bool ReadCachedBytecode(FILE *f, uint32_t count, M *cache, std::vector<T> *ids) {
+	for (uint32_t i = 0; i < count; i++) {
+		T id;
+		uint64_t sourceHash;
+		uint32_t size;
+		if (fread(&id, sizeof(id), 1, f) != 1 || fread(&sourceHash, sizeof(sourceHash), 1, f) != 1 || fread(&size, sizeof(size), 1, f) != 1)
+			return false;
+		if (size == 0 || size > 1024 * 1024)
+			return false;
+		auto &entry = (*cache)[id];
+		entry.sourceHash = sourceHash;
+		entry.bytecode.resize(size);
+		if (fread(entry.bytecode.data(), 1, size, f) != size)
+			return false;
+		ids->push_back(id);
+	}
+	return true;
+}
+
+template <class T, class S>
+static void WriteCachedBytecode(FILE *f, const std::map<T, S *> &shaders) {
+	for (const auto &[id, shader] : shaders) {
+		if (shader->Failed() || shader->bytecode().empty())
+			continue;
+		uint64_t sourceHash = XXH3_64bits(shader->source().data(), shader->source().size());
+		uint32_t size = (uint32_t)shader->bytecode().size();
+		fwrite(&id, sizeof(id), 1, f);
+		fwrite(&sourceHash, sizeof(sourceHash), 1, f);
+		fwrite(&size, sizeof(size), 1, f);
+		fwrite(shader->bytecode().data(), 1, size, f);
+	}
+}
+
+bool ShaderManagerD3D11::LoadCache(FILE *f, ShaderIDList *ids) {
+	D3D11CacheHeader header{};
+	if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != CACHE_HEADER_MAGIC || header.version != CACHE_VERSION)
+		return false;
+	// DXBC doesn't depend on the driver, but the profile does depend on the feature level.
+	if (header.compilerVersion != D3D_COMPILER_VERSION || header.featureLevel != (uint32_t)featureLevel_)
+		return false;
+	if (header.numVertexShaders > 4096 || header.numFragmentShaders > 4096)
+		return false;
+
+	bool success = ReadCachedBytecode(f, header.numVertexShaders, &cachedVS_, &ids->vertex);
+	success = success && ReadCachedBytecode(f, header.numFragmentShaders, &cachedFS_, &ids->fragment);
+	if (!success) {
+		cachedVS_.clear();
+		cachedFS_.clear();
+		ids->vertex.clear();
+		ids->fragment.clear();
+	}
+	return success;
+}
+
+void ShaderManagerD3D11::SaveCache(FILE *f) {
+	auto countValid = [](const auto &shaders) {
+		uint32_t count = 0;
+		for (const auto &[id, shader] : shaders) {
+			if (!shader->Failed() && !shader->bytecode().empty())
+				count++;
+		}
+		return count;
+	};
+
+	D3D11CacheHeader header{ CACHE_HEADER_MAGIC, CACHE_VERSION, D3D_COMPILER_VERSION, (uint32_t)featureLevel_, countValid(vsCache_), countValid(fsCache_) };
+	fwrite(&header, sizeof(header), 1, f);
+	WriteCachedBytecode(f, vsCache_);
+	WriteCachedBytecode(f, fsCache_);
+	INFO_LOG(Log::G3D, "Saved %d vertex and %d fragment shaders to the D3D11 shader cache", header.numVertexShaders, header.numFragmentShaders);
+}
+
 std::vector<std::string> ShaderManagerD3D11::DebugGetShaderIDs(DebugShaderType type) {
 	std::string id;
 	std::vector<std::string> ids;
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <cstdio>
 #include <map>
+#include <vector>
 
 #include <d3d11.h>
 
@@ -32,10 +34,12 @@ class D3D11PushBuffer;
 
 class D3D11FragmentShader {
 public:
-	D3D11FragmentShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, FShaderID id, const char *code, bool useHWTransform);
+	// If cachedBytecode is set, it's tried (and taken) first, and code is only compiled if the device rejects it.
+	D3D11FragmentShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, FShaderID id, const char *code, bool useHWTransform, std::vector<uint8_t> *cachedBytecode = nullptr);
 	~D3D11FragmentShader();
 
 	const std::string &source() const { return source_; }
+	const std::vector<uint8_t> &bytecode() const { return bytecode_; }
 
 	bool Failed() const { return failed_; }
 	bool UseHWTransform() const { return useHWTransform_; }
@@ -48,6 +52,7 @@ class D3D11FragmentShader {
 
 	ID3D11Device *device_;
 	std::string source_;
+	std::vector<uint8_t> bytecode_;
 	bool failed_ = false;
 	bool useHWTransform_;
 	FShaderID id_;
@@ -55,7 +60,7 @@ class D3D11FragmentShader {
 
 class D3D11VertexShader {
 public:
-	D3D11VertexShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, VShaderID id, const char *code, bool useHWTransform);
+	D3D11VertexShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, VShaderID id, const char *code, bool useHWTransform, std::vector<uint8_t> *cachedBytecode = nullptr);
 	~D3D11VertexShader();
 
 	const std::string &source() const { return source_; }
@@ -106,8 +111,26 @@ class ShaderManagerD3D11 : public ShaderManagerCommon {
 	bool IsLightDirty() { return true; }
 	bool IsBoneDirty() { return true; }
 
+	// The cache keeps the compiled DXBC, which works on any D3D11 device.  LoadCache() only reads it,
+	// PrecompileShaderIDList() then uses it for the shaders whose HLSL hasn't changed.
+	bool LoadCache(FILE *f, ShaderIDList *ids);
+	void SaveCache(FILE *f);
+
+	void GetShaderIDList(ShaderIDList *list);
+	// Runs on the thread pool, and waits until done.
+	void PrecompileShaderIDList(const ShaderIDList &list);
+
 private:
 	void Clear();
+	D3D11VertexShader *PrecompileVertexShader(const VShaderID &id, char *buffer);
+	D3D11FragmentShader *PrecompileFragmentShader(const FShaderID &id, char *buffer);
+
+	struct CachedBytecode {
+		uint64_t sourceHash;
+		std::vector<uint8_t> bytecode;
+	};
+	std::map<VShaderID, CachedBytecode> cachedVS_;
+	std::map<FShaderID, CachedBytecode> cachedFS_;
 
 	ID3D11Device *device_;
 	ID3D11DeviceContext *context_;
@@ -130,6 +153,10 @@ class ShaderManagerD3D11 : public ShaderManagerCommon {
 	ID3D11Buffer *push_base;
 	ID3D11Buffer *push_lights;
 	ID3D11Buffer *push_bones;
+	// Hashes of what's currently in the buffers above. The buffers start out empty, so 0 never matches in practice.
+	uint64_t uploadedBaseHash_ = 0;
+	uint64_t uploadedLightsHash_ = 0;
+	uint64_t uploadedBonesHash_ = 0;
 
 	D3D11FragmentShader *lastFShader_ = nullptr;
 	D3D11VertexShader *lastVShader_ = nullptr;
@@ -245,6 +245,13 @@ void TextureCacheD3D11::BindAsClutTexture(Draw::Texture *tex, bool smooth) {
 	context_->PSSetSamplers(3, 1, smooth ? &stockD3D11.samplerLinear2DClamp : &stockD3D11.samplerPoint2DClamp);
 }
 
+void TextureCacheD3D11::BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) {
+	ID3D11ShaderResourceView *textureView = (ID3D11ShaderResourceView *)draw_->GetNativeObject(Draw::NativeObject::TEXTURE_VIEW, tex);
+	context_->PSSetShaderResources(0, 1, &textureView);
+	lastBoundTexture = textureView;
+	ApplySamplingParams(key);
+}
+
 void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 	BuildTexturePlan plan;
 	if (!PrepareBuildTexture(plan, entry)) {
@@ -255,6 +262,8 @@ void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 	DXGI_FORMAT dstFmt = GetDestFormat(GETextureFormat(entry->format), gstate.getClutPaletteFormat());
 	if (plan.doReplace) {
 		dstFmt = ToDXGIFormat(plan.replaced->Format());
+	} else if (plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED) {
+		dstFmt = ToDXGIFormat(plan.nativeDXTFormat);
 	} else if (plan.scaleFactor > 1 || plan.saveTexture) {
 		dstFmt = DXGI_FORMAT_B8G8R8A8_UNORM;
 	} else if (plan.decodeToClut8) {
@@ -277,7 +286,7 @@ void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 		levels = plan.depth;
 	}
 
-	Draw::DataFormat texFmt = FromD3D11Format(dstFmt);
+	Draw::DataFormat texFmt = plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED ? plan.nativeDXTFormat : FromD3D11Format(dstFmt);
 
 	for (int i = 0; i < levels; i++) {
 		int srcLevel = (i == 0) ? plan.baseLevelSrc : i;
@@ -300,6 +309,11 @@ void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 				stride = std::max(mipWidth * bpp, 16);
 				dataSize = stride * mipHeight;
 			}
+		} else if (plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED) {
+			int blockSize = 0;
+			Draw::DataFormatIsBlockCompressed(plan.nativeDXTFormat, &blockSize);
+			stride = ((mipWidth + 3) / 4) * blockSize;
+			dataSize = stride * ((mipHeight + 3) / 4);
 		} else {
 			int bpp = 0;
 			if (plan.scaleFactor > 1) {
@@ -386,6 +400,7 @@ void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 	ASSERT_SUCCESS(device_->CreateShaderResourceView(texture, nullptr, &view));
 	entry->texturePtr = texture;
 	entry->textureView = view;
+	SetEntryMemoryUsage(entry, TextureMemoryUsage(tw, th, plan.depth, plan.depth == 1 ? levels : 1, texFmt));
 
 	for (int i = 0; i < 12; i++) {
 		if (subresData[i].pSysMem) {
@@ -410,7 +425,7 @@ void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 		if (!Draw::DataFormatIsBlockCompressed(plan.replaced->Format(), nullptr)) {
 			entry->status |= TexCacheEntry::STATUS_BGRA;
 		}
-	} else {
+	} else if (plan.nativeDXTFormat == Draw::DataFormat::UNDEFINED) {
 		entry->status |= TexCacheEntry::STATUS_BGRA;
 	}
 }
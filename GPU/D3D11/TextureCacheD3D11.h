@@ -60,6 +60,7 @@ class TextureCacheD3D11 : public TextureCacheCommon {
 	void Unbind() override;
 	void ReleaseTexture(TexCacheEntry *entry, bool delete_them) override;
 	void BindAsClutTexture(Draw::Texture *tex, bool smooth) override;
+	void BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) override;
 	void ApplySamplingParams(const SamplerCacheKey &key) override;
 	void *GetNativeTextureView(const TexCacheEntry *entry, bool flat) const override;
 
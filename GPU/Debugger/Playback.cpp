@@ -29,6 +29,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/Log.h"
 #include "Common/Thread/ThreadUtil.h"
+#include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -83,6 +84,10 @@ static Operation g_opToExec;
 static u32 g_retVal;
 static bool g_opDone = true;
 
+// Written by the replay thread, which is always joined before anyone reads them.
+static int benchmarkRuns = 0;
+static ReplayTimings timings;
+
 // Runs on operation thread
 u32 ExecuteOnMain(Operation opToExec) {
 	{
@@ -707,6 +712,48 @@ DumpExecute::~DumpExecute() {
 	mapping_.Reset();
 }
 
+static ReplayTimingClass TimingClass(CommandType type) {
+	switch (type) {
+	case CommandType::VERTICES:
+	case CommandType::INDICES:
+		return ReplayTimingClass::VERTICES;
+
+	case CommandType::CLUTADDR:
+	case CommandType::CLUT:
+	case CommandType::FRAMEBUF0:
+	case CommandType::FRAMEBUF1:
+	case CommandType::FRAMEBUF2:
+	case CommandType::FRAMEBUF3:
+	case CommandType::FRAMEBUF4:
+	case CommandType::FRAMEBUF5:
+	case CommandType::FRAMEBUF6:
+	case CommandType::FRAMEBUF7:
+	case CommandType::TEXTURE0:
+	case CommandType::TEXTURE1:
+	case CommandType::TEXTURE2:
+	case CommandType::TEXTURE3:
+	case CommandType::TEXTURE4:
+	case CommandType::TEXTURE5:
+	case CommandType::TEXTURE6:
+	case CommandType::TEXTURE7:
+		return ReplayTimingClass::TEXTURES;
+
+	case CommandType::TRANSFERSRC:
+	case CommandType::MEMSET:
+	case CommandType::MEMCPYDEST:
+	case CommandType::MEMCPYDATA:
+	case CommandType::EDRAMTRANS:
+		return ReplayTimingClass::TRANSFERS;
+
+	case CommandType::DISPLAY:
+		return ReplayTimingClass::DISPLAY;
+
+	default:
+		// Registers and init submit or sync lists, so this is where the GE's time goes.
+		return ReplayTimingClass::LISTS;
+	}
+}
+
 ReplayResult DumpExecute::Run() {
 	// Start with the default value.
 	if (gpu)
@@ -716,9 +763,18 @@ ReplayResult DumpExecute::Run() {
 		SyncStall();
 	}
 
+	const bool timing = benchmarkRuns > 0;
+	double lastTime = timing ? time_now_d() : 0.0;
 	int start = resumeIndex_ >= 0 ? resumeIndex_ : 0;
 	for (size_t i = start; i < commands_.size(); i++) {
 		const Command &cmd = commands_[i];
+		if (timing && i != (size_t)start) {
+			// Charge the time since the last command to it.
+			double now = time_now_d();
+			timings.classSeconds[(int)TimingClass(commands_[i - 1].type)] += now - lastTime;
+			lastTime = now;
+		}
+
 		switch (cmd.type) {
 		case CommandType::INIT:
 			Init(cmd.ptr, cmd.sz);
@@ -796,7 +852,14 @@ ReplayResult DumpExecute::Run() {
 		}
 	}
 
+	if (timing && (size_t)start < commands_.size()) {
+		double now = time_now_d();
+		timings.classSeconds[(int)TimingClass(commands_.back().type)] += now - lastTime;
+		lastTime = now;
+	}
 	SubmitListEnd();
+	if (timing)
+		timings.classSeconds[(int)ReplayTimingClass::LISTS] += time_now_d() - lastTime;
 	return ReplayResult::Done;
 }
 
@@ -939,7 +1002,10 @@ ReplayResult RunMountedReplay(const std::string &filename) {
 		replayThread = std::thread([version]() {
 			SetCurrentThreadName("Replay");
 			DumpExecute executor(lastExecPushbuf, lastExecCommands, version);
+			double startTime = time_now_d();
 			GPURecord::ReplayResult retval = executor.Run();
+			if (benchmarkRuns > 0 && retval == ReplayResult::Done)
+				timings.runSeconds.push_back(time_now_d() - startTime);
 			// Finish up
 			ExecuteOnMain(Operation{ OpType::Done });
 		});
@@ -1012,4 +1078,28 @@ ReplayResult RunMountedReplay(const std::string &filename) {
 	return ReplayResult::Done;
 }
 
+void SetReplayBenchmarkRuns(int runs) {
+	benchmarkRuns = runs;
+	timings = ReplayTimings();
+}
+
+bool ReplayBenchmarkNeedsMoreRuns() {
+	return (int)timings.runSeconds.size() < benchmarkRuns;
+}
+
+const ReplayTimings &GetReplayTimings() {
+	return timings;
+}
+
+const char *ReplayTimingClassName(ReplayTimingClass c) {
+	switch (c) {
+	case ReplayTimingClass::LISTS: return "Display lists";
+	case ReplayTimingClass::VERTICES: return "Vertex uploads";
+	case ReplayTimingClass::TEXTURES: return "Texture uploads";
+	case ReplayTimingClass::TRANSFERS: return "Block transfers";
+	case ReplayTimingClass::DISPLAY: return "Display";
+	default: return "?";
+	}
+}
+
 }  // namespace GPURecord
@@ -19,6 +19,7 @@
 
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 namespace GPURecord {
 
@@ -31,4 +32,25 @@ enum class ReplayResult {
 void WriteRunDumpCode(u32 addr);
 ReplayResult RunMountedReplay(const std::string &filename);
 
+// What the time replaying a dump went into.  LISTS includes the GE running the display lists.
+enum class ReplayTimingClass {
+	LISTS,
+	VERTICES,
+	TEXTURES,
+	TRANSFERS,
+	DISPLAY,
+	COUNT,
+};
+
+struct ReplayTimings {
+	std::vector<double> runSeconds;
+	double classSeconds[(int)ReplayTimingClass::COUNT]{};
+};
+
+// For benchmarking.  Headless keeps replaying the dump until it has timed this many runs.
+void SetReplayBenchmarkRuns(int runs);
+bool ReplayBenchmarkNeedsMoreRuns();
+const ReplayTimings &GetReplayTimings();
+const char *ReplayTimingClassName(ReplayTimingClass c);
+
 }  // namespace GPURecord
@@ -22,6 +22,9 @@
 
 #include "Common/GPU/D3D9/D3D9StateCache.h"
 
+#include "Core/HW/Display.h"
+#include "Core/System.h"
+
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
 
@@ -225,9 +228,14 @@ void DrawEngineDX9::Flush() {
 	if (!numDrawVerts_) {
 		return;
 	}
+	FramePhaseTimer phaseTimer(FramePhase::DRAW, coreCollectDebugStats);
 	bool textureNeedsApply = false;
 	if (gstate_c.IsDirty(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS) && !gstate.isModeClear() && gstate.isTextureMapEnabled()) {
-		textureCache_->SetTexture();
+		if (atlasBatch_) {
+			textureCache_->SetAtlasTexture();
+		} else {
+			textureCache_->SetTexture();
+		}
 		gstate_c.Clean(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
 		textureNeedsApply = true;
 	} else if (gstate.getTextureAddress(0) == (gstate.getFrameBufRawAddress() | 0x04000000)) {
@@ -38,6 +38,8 @@
 #include "Common/StringUtils.h"
 
 #include "Core/Config.h"
+#include "Core/HW/Display.h"
+#include "Core/System.h"
 #include "GPU/Math3D.h"
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
@@ -578,6 +580,7 @@ VSShader *ShaderManagerDX9::ApplyShader(bool useHWTransform, bool useHWTessellat
 	VSShader *vs = nullptr;
 	if (vsIter == vsCache_.end())	{
 		// Vertex shader not in cache. Let's compile it.
+		FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 		std::string genErrorString;
 		uint32_t attrMask;
 		uint64_t uniformMask;
@@ -622,6 +625,7 @@ VSShader *ShaderManagerDX9::ApplyShader(bool useHWTransform, bool useHWTessellat
 	PSShader *fs;
 	if (fsIter == fsCache_.end())	{
 		// Fragment shader not in cache. Let's compile it.
+		FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 		std::string errorString;
 		uint64_t uniformMask;
 		FragmentShaderFlags flags;
@@ -46,6 +46,9 @@ Draw::DataFormat FromD3D9Format(u32 fmt) {
 	case D3DFMT_A1R5G5B5: return Draw::DataFormat::A1R5G5B5_UNORM_PACK16;
 	case D3DFMT_R5G6B5: return Draw::DataFormat::R5G6B5_UNORM_PACK16;
 	case D3DFMT_A8: return Draw::DataFormat::R8_UNORM;
+	case D3DFMT_DXT1: return Draw::DataFormat::BC1_RGBA_UNORM_BLOCK;
+	case D3DFMT_DXT3: return Draw::DataFormat::BC2_UNORM_BLOCK;
+	case D3DFMT_DXT5: return Draw::DataFormat::BC3_UNORM_BLOCK;
 	case D3DFMT_A8R8G8B8: default: return Draw::DataFormat::R8G8B8A8_UNORM;
 	}
 }
@@ -223,6 +226,13 @@ void TextureCacheDX9::BindAsClutTexture(Draw::Texture *tex, bool smooth) {
 	device_->SetSamplerState(1, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
 }
 
+void TextureCacheDX9::BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) {
+	LPDIRECT3DBASETEXTURE9 texture = (LPDIRECT3DBASETEXTURE9)draw_->GetNativeObject(Draw::NativeObject::TEXTURE_VIEW, tex);
+	device_->SetTexture(0, texture);
+	lastBoundTexture = texture;
+	ApplySamplingParams(key);
+}
+
 void TextureCacheDX9::BuildTexture(TexCacheEntry *const entry) {
 	BuildTexturePlan plan;
 	if (!PrepareBuildTexture(plan, entry)) {
@@ -233,6 +243,8 @@ void TextureCacheDX9::BuildTexture(TexCacheEntry *const entry) {
 	D3DFORMAT dstFmt = GetDestFormat(GETextureFormat(entry->format), gstate.getClutPaletteFormat());
 	if (plan.doReplace) {
 		dstFmt = ToD3D9Format(plan.replaced->Format());
+	} else if (plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED) {
+		dstFmt = ToD3D9Format(plan.nativeDXTFormat);
 	} else if (plan.scaleFactor > 1 || plan.saveTexture) {
 		dstFmt = D3DFMT_A8R8G8B8;
 	} else if (plan.decodeToClut8) {
@@ -275,6 +287,7 @@ void TextureCacheDX9::BuildTexture(TexCacheEntry *const entry) {
 		// What to do here?
 		return;
 	}
+	SetEntryMemoryUsage(entry, TextureMemoryUsage(tw, th, plan.depth, levels, FromD3D9Format(dstFmt)));
 
 	if (plan.depth == 1) {
 		// Regular loop.
@@ -323,7 +336,7 @@ void TextureCacheDX9::BuildTexture(TexCacheEntry *const entry) {
 		if (!Draw::DataFormatIsBlockCompressed(plan.replaced->Format(), nullptr)) {
 			entry->status |= TexCacheEntry::STATUS_BGRA;
 		}
-	} else {
+	} else if (plan.nativeDXTFormat == Draw::DataFormat::UNDEFINED) {
 		entry->status |= TexCacheEntry::STATUS_BGRA;
 	}
 }
@@ -51,6 +51,7 @@ class TextureCacheDX9 : public TextureCacheCommon {
 	void Unbind() override;
 	void ReleaseTexture(TexCacheEntry *entry, bool delete_them) override;
 	void BindAsClutTexture(Draw::Texture *tex, bool smooth) override;
+	void BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) override;
 	void *GetNativeTextureView(const TexCacheEntry *entry, bool flat) const override;
 
 private:
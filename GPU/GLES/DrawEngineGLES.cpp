@@ -22,6 +22,9 @@
 #include "Common/GPU/OpenGL/GLDebugLog.h"
 #include "Common/Profiler/Profiler.h"
 
+#include "Core/HW/Display.h"
+#include "Core/System.h"
+
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
 
@@ -223,6 +226,7 @@ void DrawEngineGLES::Flush() {
 	if (!numDrawVerts_) {
 		return;
 	}
+	FramePhaseTimer phaseTimer(FramePhase::DRAW, coreCollectDebugStats);
 	PROFILE_THIS_SCOPE("flush");
 	FrameData &frameData = frameData_[render_->GetCurFrame()];
 	VShaderID vsid;
@@ -243,7 +247,11 @@ void DrawEngineGLES::Flush() {
 
 	bool textureNeedsApply = false;
 	if (gstate_c.IsDirty(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS) && !gstate.isModeClear() && gstate.isTextureMapEnabled()) {
-		textureCache_->SetTexture();
+		if (atlasBatch_) {
+			textureCache_->SetAtlasTexture();
+		} else {
+			textureCache_->SetTexture();
+		}
 		gstate_c.Clean(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
 		textureNeedsApply = true;
 	} else if (gstate.getTextureAddress(0) == (gstate.getFrameBufRawAddress() | 0x04000000)) {
@@ -459,7 +467,8 @@ void DrawEngineGLES::Flush() {
 // TODO: Refactor this to a single USE flag.
 bool DrawEngineGLES::SupportsHWTessellation() {
 	bool hasTexelFetch = gl_extensions.GLES3 || (!gl_extensions.IsGLES && gl_extensions.VersionGEThan(3, 3, 0)) || gl_extensions.EXT_gpu_shader4;
-	return hasTexelFetch && gstate_c.UseAll(GPU_USE_VERTEX_TEXTURE_FETCH | GPU_USE_TEXTURE_FLOAT | GPU_USE_INSTANCE_RENDERING);
+	// Note: the tessellation shader doesn't draw instanced, so there's no need to require instancing.
+	return hasTexelFetch && gstate_c.UseAll(GPU_USE_VERTEX_TEXTURE_FETCH | GPU_USE_TEXTURE_FLOAT);
 }
 
 bool DrawEngineGLES::UpdateUseHWTessellation(bool enable) const {
@@ -93,6 +93,10 @@ GPU_GLES::GPU_GLES(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 		if (g_Config.bShaderCache) {
 			File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
 			shaderCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".glshadercache");
+			shaderIDListPath_ = ShaderIDListPath(discID);
+			programBinaryPath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".glprogbin");
+			shaderManagerGL_->LoadProgramBinaries(programBinaryPath_);
+			bool loaded = false;
 			// Actually precompiled by IsReady() since we're single-threaded.
 			File::IOFile f(shaderCachePath_, "rb");
 			if (f.IsOpen()) {
@@ -104,10 +108,18 @@ GPU_GLES::GPU_GLES(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 					// We're compiling now, clear if they changed.
 					gstate_c.useFlagsChanged = false;
 
-					if (shaderManagerGL_->LoadCache(f))
+					loaded = shaderManagerGL_->LoadCache(f);
+					if (loaded)
 						NOTICE_LOG(Log::G3D, "Precompiling the shader cache from '%s'", shaderCachePath_.c_str());
 				}
 			}
+
+			// Maybe another backend has seen this game before.
+			ShaderIDList idList;
+			if (!loaded && LoadShaderIDList(shaderIDListPath_, &idList)) {
+				FilterShaderIDList(&idList);
+				shaderManagerGL_->PrecompileShaderIDList(idList);
+			}
 		} else {
 			INFO_LOG(Log::G3D, "Shader cache disabled. Not loading.");
 		}
@@ -129,7 +141,7 @@ GPU_GLES::~GPU_GLES() {
 
 	if (shaderCachePath_.Valid() && draw_) {
 		if (g_Config.bShaderCache) {
-			shaderManagerGL_->SaveCache(shaderCachePath_, &drawEngine_);
+			SaveCache();
 		} else {
 			INFO_LOG(Log::G3D, "Shader cache disabled. Not saving.");
 		}
@@ -137,6 +149,14 @@ GPU_GLES::~GPU_GLES() {
 	fragmentTestCache_.Clear();
 }
 
+void GPU_GLES::SaveCache() {
+	shaderManagerGL_->SaveCache(shaderCachePath_, &drawEngine_);
+	shaderManagerGL_->SaveProgramBinaries(programBinaryPath_);
+	ShaderIDList idList;
+	shaderManagerGL_->GetShaderIDList(&idList);
+	SaveShaderIDList(shaderIDListPath_, idList);
+}
+
 // Take the raw GL extension and versioning data and turn into feature flags.
 // TODO: This should use DrawContext::GetDeviceCaps() more and more, and eventually
 // this can be shared between all the backends.
@@ -248,7 +268,7 @@ void GPU_GLES::BeginHostFrame() {
 
 	const int saveShaderCacheFrameInterval = 32767;  // power of 2 - 1. About every 10 minutes at 60fps.
 	if (shaderCachePath_.Valid() && !(gpuStats.numFlips & saveShaderCacheFrameInterval) && coreState == CORE_RUNNING_CPU) {
-		shaderManagerGL_->SaveCache(shaderCachePath_, &drawEngine_);
+		SaveCache();
 	}
 	shaderManagerGL_->DirtyLastShader();
 
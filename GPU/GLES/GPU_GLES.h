@@ -52,6 +52,7 @@ class GPU_GLES : public GPUCommonHW {
 
 private:
 	void BuildReportingInfo() override;
+	void SaveCache();
 
 	FramebufferManagerGLES *framebufferManagerGL_;
 	TextureCacheGLES *textureCacheGL_;
@@ -60,4 +61,6 @@ class GPU_GLES : public GPUCommonHW {
 	ShaderManagerGLES *shaderManagerGL_;
 
 	Path shaderCachePath_;
+	Path shaderIDListPath_;
+	Path programBinaryPath_;
 };
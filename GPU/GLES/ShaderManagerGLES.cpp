@@ -31,6 +31,7 @@
 #include "Common/Math/math_util.h"
 #include "Common/Math/lin/matrix4x4.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/GPU/Shader.h"
 #include "Common/GPU/thin3d.h"
 #include "Common/GPU/OpenGL/GLRenderManager.h"
@@ -41,7 +42,10 @@
 #include "Common/Log.h"
 #include "Common/File/FileUtil.h"
 #include "Common/TimeUtil.h"
+#include "ext/xxhash.h"
 #include "Core/Config.h"
+#include "Core/HW/Display.h"
+#include "Core/System.h"
 #include "GPU/Math3D.h"
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
@@ -54,8 +58,10 @@ using namespace Lin;
 Shader::Shader(GLRenderManager *render, const char *code, const std::string &desc, const ShaderDescGLES &params)
 	  : render_(render), useHWTransform_(params.useHWTransform), attrMask_(params.attrMask), uniformMask_(params.uniformMask) {
 	PROFILE_THIS_SCOPE("shadercomp");
+	TRACE_SCOPE("shader_compile");
 	isFragment_ = params.glShaderType == GL_FRAGMENT_SHADER;
 	source_ = code;
+	sourceHash_ = XXH3_64bits(source_.data(), source_.size());
 #ifdef SHADERLOG
 #ifdef _WIN32
 	OutputDebugStringUTF8(code);
@@ -70,9 +76,10 @@ Shader::~Shader() {
 	render_->DeleteShader(shader);
 }
 
-LinkedShader::LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading)
+LinkedShader::LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading, GLRProgramBinary *binary, bool retrieveBinary)
 		: render_(render), useHWTransform_(useHWTransform) {
 	PROFILE_THIS_SCOPE("shaderlink");
+	TRACE_SCOPE("shader_link");
 
 	_assert_(render);
 	_assert_(vs);
@@ -206,7 +213,9 @@ LinkedShader::LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs,
 		flags.useClipDistance0 = true;
 	}
 
-	program = render->CreateProgram(shaders, semantics, queries, initialize, nullptr, flags);
+	flags.retrieveBinary = retrieveBinary;
+
+	program = render->CreateProgram(shaders, semantics, queries, initialize, nullptr, flags, binary);
 
 	// The rest, use the "dirty" mechanism.
 	dirtyUniforms = DIRTY_ALL_UNIFORMS;
@@ -687,7 +696,7 @@ void LinkedShader::UpdateUniforms(const ShaderID &vsid, bool useBufferedRenderin
 static constexpr size_t CODE_BUFFER_SIZE = 32768;
 
 ShaderManagerGLES::ShaderManagerGLES(Draw::DrawContext *draw)
-	  : ShaderManagerCommon(draw), fsCache_(16), vsCache_(16) {
+	  : ShaderManagerCommon(draw), linkedShaderMap_(16), fsCache_(16), vsCache_(16) {
 	render_ = (GLRenderManager *)draw->GetNativeObject(Draw::NativeObject::RENDER_MANAGER);
 	codeBuffer_ = new char[CODE_BUFFER_SIZE];
 	lastFSID_.set_invalid();
@@ -710,6 +719,7 @@ void ShaderManagerGLES::Clear() {
 		delete shader;
 	});
 	linkedShaderCache_.clear();
+	linkedShaderMap_.Clear();
 	fsCache_.Clear();
 	vsCache_.Clear();
 	DirtyLastShader();
@@ -776,6 +786,20 @@ Shader *ShaderManagerGLES::CompileVertexShader(VShaderID VSID) {
 	return new Shader(render_, codeBuffer_, desc, params);
 }
 
+LinkedShader *ShaderManagerGLES::CreateLinkedShader(VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool preloading) {
+	GLRProgramBinary *binary = nullptr;
+	auto iter = programBinaries_.find(std::make_pair(VSID, FSID));
+	if (iter != programBinaries_.end() && programBinariesUseFlags_ == gstate_c.GetUseFlags()) {
+		if (iter->second.vsHash == vs->GetSourceHash() && iter->second.fsHash == fs->GetSourceHash())
+			binary = &iter->second.binary;
+	}
+	LinkedShader *ls = new LinkedShader(render_, VSID, vs, FSID, fs, vs->UseHWTransform(), preloading, binary, useProgramBinaries_);
+	// It's been moved into the program, if it was used.
+	if (iter != programBinaries_.end())
+		programBinaries_.erase(iter);
+	return ls;
+}
+
 Shader *ShaderManagerGLES::ApplyVertexShader(bool useHWTransform, bool useHWTessellation, VertexDecoder *decoder, bool weightsAsFloat, bool useSkinInDecode, VShaderID *VSID) {
 	if (gstate_c.IsDirty(DIRTY_VERTEXSHADER_STATE)) {
 		gstate_c.Clean(DIRTY_VERTEXSHADER_STATE);
@@ -798,6 +822,7 @@ Shader *ShaderManagerGLES::ApplyVertexShader(bool useHWTransform, bool useHWTess
 	}
 
 	// Vertex shader not in cache. Let's compile it.
+	FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 	vs = CompileVertexShader(*VSID);
 	if (!vs) {
 		ERROR_LOG(Log::G3D, "Vertex shader generation failed, falling back to software transform");
@@ -847,6 +872,7 @@ LinkedShader *ShaderManagerGLES::ApplyFragmentShader(VShaderID VSID, Shader *vs,
 	Shader *fs;
 	if (!fsCache_.Get(FSID, &fs)) {
 		// Fragment shader not in cache. Let's compile it.
+		FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 		// Can't really tell if we succeeded since the compile is on the GPU thread later.
 		// Could fail to generate, in which case we're kinda screwed.
 		fs = CompileFragmentShader(FSID);
@@ -857,20 +883,18 @@ LinkedShader *ShaderManagerGLES::ApplyFragmentShader(VShaderID VSID, Shader *vs,
 		fsCache_.Insert(FSID, fs);
 	}
 
-	// Okay, we have both shaders. Let's see if there's a linked one.
-	LinkedShader *ls = nullptr;
-
+	// Deferred dirtying! Stamp the uniforms dirtied since the last switch, linked shaders pick it up when used.
+	switchCounter_++;
 	u64 switchDirty = shaderSwitchDirtyUniforms_;
-	for (auto iter = linkedShaderCache_.begin(); iter != linkedShaderCache_.end(); ++iter) {
-		// Deferred dirtying! Let's see if we can make this even more clever later.
-		iter->ls->dirtyUniforms |= switchDirty;
-
-		if (iter->vs == vs && iter->fs == fs) {
-			ls = iter->ls;
-		}
+	for (int i = 0; switchDirty != 0; i++, switchDirty >>= 1) {
+		if (switchDirty & 1)
+			uniformDirtyStamp_[i] = switchCounter_;
 	}
 	shaderSwitchDirtyUniforms_ = 0;
 
+	// Okay, we have both shaders. Let's see if there's a linked one.
+	LinkedShader *ls = linkedShaderMap_.GetOrNull(LinkedShaderKey{ vs, fs });
+
 	if (ls == nullptr) {
 		_dbg_assert_(FSID.Bit(FS_BIT_LMODE) == VSID.Bit(VS_BIT_LMODE));
 		_dbg_assert_(FSID.Bit(FS_BIT_FLATSHADE) == VSID.Bit(VS_BIT_FLATSHADE));
@@ -881,19 +905,35 @@ LinkedShader *ShaderManagerGLES::ApplyFragmentShader(VShaderID VSID, Shader *vs,
 		}
 
 		// Check if we can link these.
-		ls = new LinkedShader(render_, VSID, vs, FSID, fs, vs->UseHWTransform());
+		DisplayNotifyCause(FRAME_CAUSE_SHADER_COMPILE);
+		ls = CreateLinkedShader(VSID, vs, FSID, fs, false);
 		ls->use(VSID);
-		const LinkedShaderCacheEntry entry(vs, fs, ls);
-		linkedShaderCache_.push_back(entry);
+		AddLinkedShader(vs, fs, ls);
 	} else {
+		ls->dirtyUniforms |= UniformsDirtiedSince(ls->switchStamp);
 		ls->use(VSID);
 	}
+	ls->switchStamp = switchCounter_;
 	ls->UpdateUniforms(VSID, useBufferedRendering, draw_->GetShaderLanguageDesc());
 
 	lastShader_ = ls;
 	return ls;
 }
 
+void ShaderManagerGLES::AddLinkedShader(Shader *vs, Shader *fs, LinkedShader *ls) {
+	linkedShaderCache_.push_back(LinkedShaderCacheEntry(vs, fs, ls));
+	linkedShaderMap_.Insert(LinkedShaderKey{ vs, fs }, ls);
+}
+
+uint64_t ShaderManagerGLES::UniformsDirtiedSince(uint64_t stamp) const {
+	uint64_t dirty = 0;
+	for (int i = 0; i < 64; i++) {
+		if (uniformDirtyStamp_[i] > stamp)
+			dirty |= 1ULL << i;
+	}
+	return dirty;
+}
+
 std::string Shader::GetShaderString(DebugShaderStringType type, ShaderID id) const {
 	switch (type) {
 	case SHADER_STRING_SOURCE_CODE:
@@ -1138,9 +1178,8 @@ bool ShaderManagerGLES::LoadCache(File::IOFile &f) {
 		vsCache_.Get(vsid, &vs);
 		fsCache_.Get(fsid, &fs);
 		if (vs && fs) {
-			LinkedShader *ls = new LinkedShader(render_, vsid, vs, fsid, fs, vs->UseHWTransform(), true);
-			LinkedShaderCacheEntry entry(vs, fs, ls);
-			linkedShaderCache_.push_back(entry);
+			LinkedShader *ls = CreateLinkedShader(vsid, vs, fsid, fs, true);
+			AddLinkedShader(vs, fs, ls);
 		}
 	}
 
@@ -1153,12 +1192,49 @@ bool ShaderManagerGLES::LoadCache(File::IOFile &f) {
 	return true;
 }
 
+void ShaderManagerGLES::GetShaderIDList(ShaderIDList *list) {
+	vsCache_.Iterate([&](const VShaderID &id, Shader *shader) {
+		list->vertex.push_back(id);
+	});
+	fsCache_.Iterate([&](const FShaderID &id, Shader *shader) {
+		list->fragment.push_back(id);
+	});
+}
+
+// Without our own cache, there's nothing to link - programs are linked as they're needed,
+// but the shaders are at least compiled already.
+void ShaderManagerGLES::PrecompileShaderIDList(const ShaderIDList &list) {
+	double start = time_now_d();
+	int vsCount = 0;
+	int fsCount = 0;
+	for (const VShaderID &id : list.vertex) {
+		if (vsCache_.ContainsKey(id))
+			continue;
+		Shader *vs = CompileVertexShader(id);
+		if (vs) {
+			vsCache_.Insert(id, vs);
+			vsCount++;
+		}
+	}
+	for (const FShaderID &id : list.fragment) {
+		if (fsCache_.ContainsKey(id))
+			continue;
+		Shader *fs = CompileFragmentShader(id);
+		if (fs) {
+			fsCache_.Insert(id, fs);
+			fsCount++;
+		}
+	}
+	NOTICE_LOG(Log::G3D, "Precompile: Compiled %d vertex and %d fragment shaders from the shader ID list in %0.1f milliseconds", vsCount, fsCount, 1000 * (time_now_d() - start));
+}
+
 void ShaderManagerGLES::SaveCache(const Path &filename, DrawEngineGLES *drawEngine) {
 	if (linkedShaderCache_.empty()) {
 		return;
 	}
 	INFO_LOG(Log::G3D, "Saving the shader cache to '%s'", filename.c_str());
-	FILE *f = File::OpenCFile(filename, "wb");
+	Path tempPath = File::TempPathFor(filename);
+	FILE *f = File::OpenCFile(tempPath, "wb");
 	if (!f) {
 		// Can't save, give up for now.
 		return;
@@ -1194,4 +1270,132 @@ void ShaderManagerGLES::SaveCache(const Path &filename, DrawEngineGLES *drawEngi
 		fwrite(&fsid, 1, sizeof(fsid), f);
 	}
 	fclose(f);
+	if (!File::ReplaceFile(tempPath, filename))
+		File::Delete(tempPath);
+}
+
+#define PROGRAM_BINARY_MAGIC 0x42475050  // "PPGB"
+#define PROGRAM_BINARY_VERSION 1
+
+struct ProgramBinaryHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t useFlags;
+	uint32_t numPrograms;
+	uint32_t driverKeySize;
+};
+
+struct ProgramBinaryEntryHeader {
+	VShaderID vsid;
+	FShaderID fsid;
+	uint64_t vsHash;
+	uint64_t fsHash;
+	uint32_t format;
+	uint32_t size;
+};
+
+// Drivers should reject binaries from other versions, but not all of them do it reliably.
+std::string ShaderManagerGLES::ProgramBinaryDriverKey() const {
+	std::string version = render_->GetGLString(GL_VERSION);
+	if (version.empty())
+		return "";
+	return render_->GetGLString(GL_VENDOR) + "|" + render_->GetGLString(GL_RENDERER) + "|" + version;
+}
+
+void ShaderManagerGLES::LoadProgramBinaries(const Path &filename) {
+	programBinaries_.clear();
+	useProgramBinaries_ = false;
+	std::string driverKey = ProgramBinaryDriverKey();
+	if (!gl_extensions.ARB_get_program_binary || driverKey.empty())
+		return;
+	useProgramBinaries_ = true;
+
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return;
+
+	ProgramBinaryHeader header{};
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	success = success && header.magic == PROGRAM_BINARY_MAGIC && header.version == PROGRAM_BINARY_VERSION;
+	success = success && header.driverKeySize == driverKey.size() && header.numPrograms <= 1000;
+	if (success) {
+		std::string key;
+		key.resize(header.driverKeySize);
+		success = fread(&key[0], 1, key.size(), f) == key.size() && key == driverKey;
+		if (!success)
+			INFO_LOG(Log::G3D, "GL driver changed, not using the saved program binaries");
+	}
+
+	for (uint32_t i = 0; success && i < header.numPrograms; i++) {
+		ProgramBinaryEntryHeader entry;
+		if (fread(&entry, sizeof(entry), 1, f) != 1 || entry.size == 0 || entry.size > 16 * 1024 * 1024) {
+			success = false;
+			break;
+		}
+		ProgramBinaryEntry &binary = programBinaries_[std::make_pair(entry.vsid, entry.fsid)];
+		binary.vsHash = entry.vsHash;
+		binary.fsHash = entry.fsHash;
+		binary.binary.format = entry.format;
+		binary.binary.data.resize(entry.size);
+		success = fread(binary.binary.data.data(), 1, entry.size, f) == entry.size;
+	}
+	fclose(f);
+	// The bindings in the program depend on more than the IDs, so these are only used with the same flags.
+	programBinariesUseFlags_ = header.useFlags;
+
+	if (!success) {
+		programBinaries_.clear();
+		File::Delete(filename);
+	} else {
+		NOTICE_LOG(Log::G3D, "Loaded %d program binaries from '%s'", (int)programBinaries_.size(), filename.c_str());
+	}
+}
+
+void ShaderManagerGLES::SaveProgramBinaries(const Path &filename) {
+	if (!useProgramBinaries_ || linkedShaderCache_.empty())
+		return;
+	std::string driverKey = ProgramBinaryDriverKey();
+
+	// Only the ones the render thread has linked (or loaded) by now.
+	std::map<const Shader *, VShaderID> vsids;
+	std::map<const Shader *, FShaderID> fsids;
+	vsCache_.Iterate([&](const VShaderID &id, Shader *shader) {
+		vsids[shader] = id;
+	});
+	fsCache_.Iterate([&](const FShaderID &id, Shader *shader) {
+		fsids[shader] = id;
+	});
+	std::vector<const LinkedShaderCacheEntry *> entries;
+	for (const auto &iter : linkedShaderCache_) {
+		if (iter.ls->program->GetBinary() && vsids.count(iter.vs) && fsids.count(iter.fs))
+			entries.push_back(&iter);
+	}
+	if (entries.empty())
+		return;
+
+	Path tempPath = File::TempPathFor(filename);
+	FILE *f = File::OpenCFile(tempPath, "wb");
+	if (!f)
+		return;
+	ProgramBinaryHeader header{ PROGRAM_BINARY_MAGIC, PROGRAM_BINARY_VERSION, gstate_c.GetUseFlags(), (uint32_t)entries.size(), (uint32_t)driverKey.size() };
+	fwrite(&header, sizeof(header), 1, f);
+	fwrite(driverKey.data(), 1, driverKey.size(), f);
+	for (const LinkedShaderCacheEntry *iter : entries) {
+		const GLRProgramBinary *binary = iter->ls->program->GetBinary();
+		ProgramBinaryEntryHeader entry;
+		entry.vsid = vsids[iter->vs];
+		entry.fsid = fsids[iter->fs];
+		entry.vsHash = iter->vs->GetSourceHash();
+		entry.fsHash = iter->fs->GetSourceHash();
+		entry.format = binary->format;
+		entry.size = (uint32_t)binary->data.size();
+		fwrite(&entry, sizeof(entry), 1, f);
+		fwrite(binary->data.data(), 1, binary->data.size(), f);
+	}
+	fclose(f);
+	if (!File::ReplaceFile(tempPath, filename)) {
+		File::Delete(tempPath);
+		return;
+	}
+	INFO_LOG(Log::G3D, "Saved %d program binaries to '%s'", (int)entries.size(), filename.c_str());
 }
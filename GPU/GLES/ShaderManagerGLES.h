@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <map>
 #include <vector>
 
 #include "Common/Data/Collections/Hashmaps.h"
@@ -37,7 +38,7 @@ class IOFile;
 
 class LinkedShader {
 public:
-	LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading = false);
+	LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading = false, GLRProgramBinary *binary = nullptr, bool retrieveBinary = false);
 	~LinkedShader();
 
 	void use(const ShaderID &VSID) const;
@@ -52,6 +53,8 @@ class LinkedShader {
 	GLRProgram *program;
 	uint64_t availableUniforms;
 	uint64_t dirtyUniforms = 0;
+	// Value of the manager's switch counter when this was last made current, see ShaderManagerGLES::uniformDirtyStamp_.
+	uint64_t switchStamp = 0;
 
 	// Present attributes in the shader.
 	int attrMask;  // 1 << ATTR_ ... or-ed together.
@@ -147,10 +150,12 @@ class Shader {
 
 	uint32_t GetAttrMask() const { return attrMask_; }
 	uint64_t GetUniformMask() const { return uniformMask_; }
+	uint64_t GetSourceHash() const { return sourceHash_; }
 
 private:
 	GLRenderManager *render_;
 	std::string source_;
+	uint64_t sourceHash_;
 	bool useHWTransform_;
 	bool isFragment_;
 	uint32_t attrMask_; // only used in vertex shaders
@@ -185,10 +190,20 @@ class ShaderManagerGLES : public ShaderManagerCommon {
 	bool LoadCache(File::IOFile &f);
 	void SaveCache(const Path &filename, DrawEngineGLES *drawEngine);
 
+	// Linked programs from glGetProgramBinary.  In a separate file, since they're only good for the same driver.
+	// Load before LoadCache(), so the programs it links can use them.
+	void LoadProgramBinaries(const Path &filename);
+	void SaveProgramBinaries(const Path &filename);
+
+	void GetShaderIDList(ShaderIDList *list);
+	void PrecompileShaderIDList(const ShaderIDList &list);
+
 private:
 	void Clear();
 	Shader *CompileFragmentShader(FShaderID id);
 	Shader *CompileVertexShader(VShaderID id);
+	LinkedShader *CreateLinkedShader(VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool preloading);
+	std::string ProgramBinaryDriverKey() const;
 
 	struct LinkedShaderCacheEntry {
 		LinkedShaderCacheEntry(Shader *vs_, Shader *fs_, LinkedShader *ls_)
@@ -200,8 +215,19 @@ class ShaderManagerGLES : public ShaderManagerCommon {
 	};
 	typedef std::vector<LinkedShaderCacheEntry> LinkedShaderCache;
 
+	struct LinkedShaderKey {
+		Shader *vs;
+		Shader *fs;
+	};
+	typedef DenseHashMap<LinkedShaderKey, LinkedShader *> LinkedShaderMap;
+
+	void AddLinkedShader(Shader *vs, Shader *fs, LinkedShader *ls);
+	uint64_t UniformsDirtiedSince(uint64_t stamp) const;
+
 	GLRenderManager *render_;
+	// The vector keeps creation order for the disk cache, the map is for lookups on shader switches.
 	LinkedShaderCache linkedShaderCache_;
+	LinkedShaderMap linkedShaderMap_;
 
 	bool lastVShaderSame_ = false;
 
@@ -210,6 +236,10 @@ class ShaderManagerGLES : public ShaderManagerCommon {
 
 	LinkedShader *lastShader_ = nullptr;
 	u64 shaderSwitchDirtyUniforms_ = 0;
+	// Instead of pushing the dirty uniforms to every linked shader on each switch, remember when each
+	// uniform bit was last dirtied, and let the linked shader we switch to catch up.
+	uint64_t switchCounter_ = 0;
+	uint64_t uniformDirtyStamp_[64]{};
 	char *codeBuffer_;
 
 	typedef DenseHashMap<FShaderID, Shader *> FSCache;
@@ -217,4 +247,14 @@ class ShaderManagerGLES : public ShaderManagerCommon {
 
 	typedef DenseHashMap<VShaderID, Shader *> VSCache;
 	VSCache vsCache_;
+
+	// The sources are checked too, in case the shader generator changed.
+	struct ProgramBinaryEntry {
+		uint64_t vsHash;
+		uint64_t fsHash;
+		GLRProgramBinary binary;
+	};
+	std::map<std::pair<VShaderID, FShaderID>, ProgramBinaryEntry> programBinaries_;
+	uint32_t programBinariesUseFlags_ = 0;
+	bool useProgramBinaries_ = false;
 };
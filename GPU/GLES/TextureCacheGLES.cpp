@@ -217,6 +217,13 @@ void TextureCacheGLES::BindAsClutTexture(Draw::Texture *tex, bool smooth) {
 	render_->SetTextureSampler(TEX_SLOT_CLUT, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, smooth ? GL_LINEAR : GL_NEAREST, smooth ? GL_LINEAR : GL_NEAREST, 0.0f);
 }
 
+void TextureCacheGLES::BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) {
+	GLRTexture *glrTex = (GLRTexture *)draw_->GetNativeObject(Draw::NativeObject::TEXTURE_VIEW, tex);
+	render_->BindTexture(0, glrTex);
+	lastBoundTexture = glrTex;
+	ApplySamplingParams(key);
+}
+
 void TextureCacheGLES::BuildTexture(TexCacheEntry *const entry) {
 	BuildTexturePlan plan;
 	if (!PrepareBuildTexture(plan, entry)) {
@@ -238,6 +245,8 @@ void TextureCacheGLES::BuildTexture(TexCacheEntry *const entry) {
 	if (plan.doReplace) {
 		plan.replaced->GetSize(plan.baseLevelSrc, &tw, &th);
 		dstFmt = plan.replaced->Format();
+	} else if (plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED) {
+		dstFmt = plan.nativeDXTFormat;
 	} else if (plan.scaleFactor > 1 || plan.saveTexture) {
 		dstFmt = Draw::DataFormat::R8G8B8A8_UNORM;
 	} else if (plan.decodeToClut8) {
@@ -272,6 +281,7 @@ void TextureCacheGLES::BuildTexture(TexCacheEntry *const entry) {
 	}
 
 	if (plan.depth == 1) {
+		SetEntryMemoryUsage(entry, TextureMemoryUsage(tw, th, 1, plan.levelsToCreate, dstFmt));
 		for (int i = 0; i < plan.levelsToLoad; i++) {
 			int srcLevel = i == 0 ? plan.baseLevelSrc : i;
 
@@ -296,6 +306,11 @@ void TextureCacheGLES::BuildTexture(TexCacheEntry *const entry) {
 					stride = mipWidth * bpp;
 					dataSize = stride * mipHeight;
 				}
+			} else if (plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED) {
+				int blockSize = 0;
+				Draw::DataFormatIsBlockCompressed(dstFmt, &blockSize);
+				stride = ((mipWidth + 3) / 4) * blockSize;
+				dataSize = stride * ((mipHeight + 3) / 4);
 			} else {
 				int bpp = 0;
 				if (plan.scaleFactor > 1) {
@@ -341,6 +356,7 @@ void TextureCacheGLES::BuildTexture(TexCacheEntry *const entry) {
 		}
 
 		render_->TextureImage(entry->textureName, 0, plan.w * plan.scaleFactor, plan.h * plan.scaleFactor, plan.depth, dstFmt, data, GLRAllocType::ALIGNED);
+		SetEntryMemoryUsage(entry, TextureMemoryUsage(plan.w * plan.scaleFactor, plan.h * plan.scaleFactor, plan.depth, 1, dstFmt));
 
 		// Signal that we support depth textures so use it as one.
 		entry->status |= TexCacheEntry::STATUS_3D;
@@ -19,6 +19,8 @@
 
 #include "Common/TimeUtil.h"
 #include "Common/GraphicsContext.h"
+#include "Common/Profiler/Tracer.h"
+#include "Common/Data/Collections/FrameArena.h"
 #include "Core/Core.h"
 #include "Core/System.h"
 
@@ -40,6 +42,7 @@
 #endif
 
 GPUStatistics gpuStats;
+FrameArena g_gpuFrameArena;
 GPUCommon *gpu;
 GPUDebugInterface *gpuDebug;
 
@@ -64,6 +67,7 @@ bool GPU_IsStarted() {
 }
 
 bool GPU_Init(GraphicsContext *ctx, Draw::DrawContext *draw) {
+	TRACE_SCOPE("boot_gpu_init");
 	const auto &gpuCore = PSP_CoreParameter().gpuCore;
 	_assert_(draw || gpuCore == GPUCORE_SOFTWARE);
 #if PPSSPP_PLATFORM(UWP)
@@ -21,6 +21,7 @@
 #include <cstring>
 #include <cstdint>
 
+class FrameArena;
 class GPUCommon;
 class GPUDebugInterface;
 class GraphicsContext;
@@ -38,6 +39,7 @@ enum SkipDrawReasonFlags {
 	SKIPDRAW_NON_DISPLAYED_FB = 2,   // Skip drawing to FBO:s that have not been displayed.
 	SKIPDRAW_BAD_FB_TEXTURE = 4,
 	SKIPDRAW_WINDOW_MINIMIZED = 8, // Don't draw when the host window is minimized.
+	SKIPDRAW_FAST_FORWARD = 16,  // Frame won't be shown. SKIPDRAW_SKIPFRAME is then set per render target, see DoSetRenderFrameBuffer.
 };
 
 enum class ShaderDepalMode {
@@ -82,16 +84,29 @@ struct GPUStatistics {
 		numVertsSubmitted = 0;
 		numVertsDecoded = 0;
 		numUncachedVertsDrawn = 0;
+		numCachedVertsDrawn = 0;
 		numTextureInvalidations = 0;
 		numTextureInvalidationsByFramebuffer = 0;
 		numTexturesHashed = 0;
+		numTextureHashesSkipped = 0;
+		numTextureChangesBatched = 0;
 		numTextureDataBytesHashed = 0;
 		numFlushes = 0;
 		numBBOXJumps = 0;
 		numPlaneUpdates = 0;
 		numTexturesDecoded = 0;
+		numTexturesEvicted = 0;
+		numTextureCacheHits = 0;
+		numTextureCacheMisses = 0;
+		numTextureBytesUploaded = 0;
+		memset(numTexturesDecodedByFormat, 0, sizeof(numTexturesDecodedByFormat));
+		memset(numTextureBytesUploadedByFormat, 0, sizeof(numTextureBytesUploadedByFormat));
+		msTextureHashing = 0.0;
+		msTextureDecoding = 0.0;
+		msTextureScaling = 0.0;
 		numFramebufferEvaluations = 0;
 		numFBOsCreated = 0;
+		numFBOsRecycled = 0;
 		numBlockingReadbacks = 0;
 		numReadbacks = 0;
 		numUploads = 0;
@@ -134,13 +149,27 @@ struct GPUStatistics {
 	int numVertsSubmitted;
 	int numVertsDecoded;
 	int numUncachedVertsDrawn;
+	int numCachedVertsDrawn;
 	int numTextureInvalidations;
 	int numTextureInvalidationsByFramebuffer;
 	int numTexturesHashed;
+	int numTextureHashesSkipped;
+	int numTextureChangesBatched;
 	int numTextureDataBytesHashed;
 	int numTexturesDecoded;
+	int numTexturesEvicted;
+	int numTextureCacheHits;
+	int numTextureCacheMisses;
+	int numTextureBytesUploaded;
+	// Indexed by GETextureFormat.
+	int numTexturesDecodedByFormat[16];
+	int numTextureBytesUploadedByFormat[16];
+	double msTextureHashing;
+	double msTextureDecoding;
+	double msTextureScaling;
 	int numFramebufferEvaluations;
 	int numFBOsCreated;
+	int numFBOsRecycled;
 	int numBlockingReadbacks;
 	int numReadbacks;
 	int numUploads;
@@ -174,6 +203,8 @@ struct GPUStatistics {
 };
 
 extern GPUStatistics gpuStats;
+// Scratch memory for whichever thread is running the GE.  See FrameArena.h.
+extern FrameArena g_gpuFrameArena;
 extern GPUCommon *gpu;
 extern GPUDebugInterface *gpuDebug;
 
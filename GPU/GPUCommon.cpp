@@ -3,8 +3,10 @@
 #include <algorithm>  // std::remove
 
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 
 #include "Common/GraphicsContext.h"
+#include "Common/Data/Collections/FrameArena.h"
 #include "Common/LogReporting.h"
 #include "Common/Math/SIMDHeaders.h"
 #include "Common/Serialize/Serializer.h"
@@ -12,6 +14,7 @@
 #include "Common/Serialize/SerializeList.h"
 #include "Common/TimeUtil.h"
 #include "GPU/GeDisasm.h"
+#include "GPU/GeThread.h"
 #include "GPU/GPU.h"
 #include "GPU/GPUCommon.h"
 #include "GPU/GPUState.h"
@@ -19,6 +22,7 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/Debugger/MemBlockInfo.h"
+#include "Core/HW/Display.h"
 #include "Core/MemMap.h"
 #include "Core/Reporting.h"
 #include "Core/HLE/HLE.h"
@@ -60,6 +64,8 @@ GPUCommon::GPUCommon(GraphicsContext *gfxCtx, Draw::DrawContext *draw) :
 }
 
 void GPUCommon::BeginHostFrame() {
+	// The GE is synced between host frames, so nothing's using this now.
+	g_gpuFrameArena.EndFrame();
 	ReapplyGfxState();
 
 	// TODO: Assume config may have changed - maybe move to resize.
@@ -170,6 +176,7 @@ void GPUCommon::DumpNextFrame() {
 }
 
 u32 GPUCommon::DrawSync(int mode) {
+	GeThread::Sync();
 	gpuStats.numDrawSyncs++;
 
 	if (mode < 0 || mode > 1)
@@ -220,6 +227,7 @@ void GPUCommon::CheckDrawSync() {
 }
 
 int GPUCommon::ListSync(int listid, int mode) {
+	GeThread::Sync();
 	gpuStats.numListSyncs++;
 
 	if (listid < 0 || listid >= DisplayListMaxCount)
@@ -266,6 +274,7 @@ int GPUCommon::ListSync(int listid, int mode) {
 }
 
 int GPUCommon::GetStack(int index, u32 stackPtr) {
+	GeThread::Sync();
 	if (!currentList) {
 		// Seems like it doesn't return an error code?
 		return 0;
@@ -298,6 +307,7 @@ static void CopyMatrix24(u32_le *result, const float *mtx, u32 count, u32 cmdbit
 }
 
 bool GPUCommon::GetMatrix24(GEMatrixType type, u32_le *result, u32 cmdbits) {
+	GeThread::Sync();
 	switch (type) {
 	case GE_MTX_BONE0:
 	case GE_MTX_BONE1:
@@ -345,6 +355,7 @@ void GPUCommon::ResetMatrices() {
 }
 
 u32 GPUCommon::EnqueueList(u32 listpc, u32 stall, int subIntrBase, PSPPointer<PspGeListArgs> args, bool head, bool *runList) {
+	GeThread::Sync();
 	*runList = false;
 
 	// TODO Check the stack values in missing arg and ajust the stack depth
@@ -461,6 +472,7 @@ u32 GPUCommon::EnqueueList(u32 listpc, u32 stall, int subIntrBase, PSPPointer<Ps
 }
 
 u32 GPUCommon::DequeueList(int listid) {
+	GeThread::Sync();
 	if (listid < 0 || listid >= DisplayListMaxCount || dls[listid].state == PSP_GE_DL_STATE_NONE)
 		return SCE_KERNEL_ERROR_INVALID_ID;
 
@@ -483,6 +495,7 @@ u32 GPUCommon::DequeueList(int listid) {
 }
 
 u32 GPUCommon::UpdateStall(int listid, u32 newstall, bool *runList) {
+	GeThread::Sync();
 	*runList = false;
 	if (listid < 0 || listid >= DisplayListMaxCount || dls[listid].state == PSP_GE_DL_STATE_NONE)
 		return SCE_KERNEL_ERROR_INVALID_ID;
@@ -497,6 +510,7 @@ u32 GPUCommon::UpdateStall(int listid, u32 newstall, bool *runList) {
 }
 
 u32 GPUCommon::Continue(bool *runList) {
+	GeThread::Sync();
 	*runList = false;
 	if (!currentList)
 		return 0;
@@ -538,6 +552,7 @@ u32 GPUCommon::Continue(bool *runList) {
 }
 
 u32 GPUCommon::Break(int mode) {
+	GeThread::Sync();
 	if (mode < 0 || mode > 1)
 		return SCE_KERNEL_ERROR_INVALID_MODE;
 
@@ -602,6 +617,7 @@ u32 GPUCommon::Break(int mode) {
 }
 
 void GPUCommon::PSPFrame() {
+	GeThread::Sync();
 	immCount_ = 0;
 	if (dumpNextFrame_) {
 		NOTICE_LOG(Log::G3D, "DUMPING THIS FRAME");
@@ -670,6 +686,7 @@ void GPUCommon::UpdatePC(u32 currentPC, u32 newPC) {
 }
 
 void GPUCommon::ReapplyGfxState() {
+	GeThread::Sync();
 	// The commands are embedded in the command memory so we can just reexecute the words. Convenient.
 	// To be safe we pass 0xFFFFFFFF as the diff.
 
@@ -707,6 +724,7 @@ void GPUCommon::ReapplyGfxState() {
 }
 
 uint32_t GPUCommon::SetAddrTranslation(uint32_t value) {
+	GeThread::Sync();
 	std::swap(edramTranslation_, value);
 	return value;
 }
@@ -732,8 +750,12 @@ int GPUCommon::GetNextListIndex() {
 
 // This is now called when coreState == CORE_RUNNING_GE, in addition to from the various sceGe commands.
 DLResult GPUCommon::ProcessDLQueue() {
+	// When debugging, this runs here even if there's a GE thread, so it must finish first.
+	GeThread::Sync();
+	TRACE_SCOPE("ge_lists");
 	if (!resumingFromDebugBreak_) {
-		startingTicks = CoreTiming::GetTicks();
+		// The GE thread can't look at the CPU's ticks, they're moving.
+		startingTicks = GeThread::OnThread() ? GeThread::KickTicks() : CoreTiming::GetTicks();
 		cyclesExecuted = 0;
 
 		// ?? Seems to be correct behaviour to process the list anyway?
@@ -744,6 +766,7 @@ DLResult GPUCommon::ProcessDLQueue() {
 	}
 
 	TimeCollector collectStat(&gpuStats.msProcessingDisplayLists, coreCollectDebugStats);
+	FramePhaseTimer phaseTimer(FramePhase::GE, coreCollectDebugStats);
 
 	for (int listIndex = GetNextListIndex(); listIndex != -1; listIndex = GetNextListIndex()) {
 		DisplayList &list = dls[listIndex];
@@ -1441,6 +1464,7 @@ struct DisplayList_v2 {
 };
 
 void GPUCommon::DoState(PointerWrap &p) {
+	GeThread::Sync();
 	auto s = p.Section("GPUCommon", 1, 6);
 	if (!s)
 		return;
@@ -1523,10 +1547,12 @@ void GPUCommon::DoState(PointerWrap &p) {
 }
 
 void GPUCommon::InterruptStart(int listid) {
+	GeThread::Sync();
 	interruptRunning = true;
 }
 
 void GPUCommon::InterruptEnd(int listid) {
+	GeThread::Sync();
 	interruptRunning = false;
 	isbreak = false;
 
@@ -1553,6 +1579,7 @@ void GPUCommon::InterruptEnd(int listid) {
 
 // TODO: Maybe cleaner to keep this in GE and trigger the clear directly?
 void GPUCommon::SyncEnd(GPUSyncType waitType, int listid, bool wokeThreads) {
+	GeThread::Sync();
 	if (waitType == GPU_SYNC_DRAW && wokeThreads)
 	{
 		for (int i = 0; i < DisplayListMaxCount; ++i) {
@@ -1904,6 +1931,7 @@ void GPUCommon::DoBlockTransfer(u32 skipDrawReason) {
 }
 
 bool GPUCommon::PerformMemoryCopy(u32 dest, u32 src, int size, GPUCopyFlag flags) {
+	GeThread::Sync();
 	/*
 	// TODO: Should add this. But let's do it after the 1.18 release.
 	if (dest == 0 || src == 0) {
@@ -1944,6 +1972,7 @@ bool GPUCommon::PerformMemoryCopy(u32 dest, u32 src, int size, GPUCopyFlag flags
 }
 
 bool GPUCommon::PerformMemorySet(u32 dest, u8 v, int size) {
+	GeThread::Sync();
 	// This may indicate a memset, usually to 0, of a framebuffer.
 	if (framebufferManager_->MayIntersectFramebufferColor(dest)) {
 		Memory::Memset(dest, v, size, "GPUMemset");
@@ -1961,6 +1990,7 @@ bool GPUCommon::PerformMemorySet(u32 dest, u8 v, int size) {
 }
 
 bool GPUCommon::PerformReadbackToMemory(u32 dest, int size) {
+	GeThread::Sync();
 	if (Memory::IsVRAMAddress(dest)) {
 		return PerformMemoryCopy(dest, dest, size, GPUCopyFlag::FORCE_DST_MATCH_MEM);
 	}
@@ -1968,6 +1998,7 @@ bool GPUCommon::PerformReadbackToMemory(u32 dest, int size) {
 }
 
 bool GPUCommon::PerformWriteColorFromMemory(u32 dest, int size) {
+	GeThread::Sync();
 	if (Memory::IsVRAMAddress(dest)) {
 		recorder_.NotifyUpload(dest, size);
 		return PerformMemoryCopy(dest, dest, size, GPUCopyFlag::FORCE_SRC_MATCH_MEM | GPUCopyFlag::DEBUG_NOTIFIED);
@@ -1976,6 +2007,7 @@ bool GPUCommon::PerformWriteColorFromMemory(u32 dest, int size) {
 }
 
 void GPUCommon::PerformWriteFormattedFromMemory(u32 addr, int size, int frameWidth, GEBufferFormat format) {
+	GeThread::Sync();
 	if (Memory::IsVRAMAddress(addr)) {
 		framebufferManager_->PerformWriteFormattedFromMemory(addr, size, frameWidth, format);
 	}
@@ -1984,6 +2016,7 @@ void GPUCommon::PerformWriteFormattedFromMemory(u32 addr, int size, int frameWid
 }
 
 bool GPUCommon::PerformWriteStencilFromMemory(u32 dest, int size, WriteStencil flags) {
+	GeThread::Sync();
 	if (framebufferManager_->MayIntersectFramebufferColor(dest)) {
 		framebufferManager_->PerformWriteStencilFromMemory(dest, size, flags);
 		return true;
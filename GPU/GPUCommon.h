@@ -16,6 +16,7 @@
 #include "GPU/Debugger/Breakpoints.h"
 #include "GPU/Common/ShaderCommon.h"
 #include "GPU/Common/GPUDebugInterface.h"
+#include "GPU/GeThread.h"
 #include "GPU/GPUDefinitions.h"
 
 #if defined(__ANDROID__)
@@ -156,6 +157,7 @@ enum {
 	FLAG_READS_PC = 16,
 	FLAG_WRITES_PC = 32,
 	FLAG_DIRTYONCHANGE = 64,  // NOTE: Either this or FLAG_EXECUTE*, not both!
+	FLAG_TEXTURECHANGE = 128,  // Only selects the texture, no flush needed while the draw engine batches from the sprite atlas.
 };
 
 struct TransformedVertex {
@@ -223,6 +225,7 @@ class GPUCommon : public GPUDebugInterface {
 	void InterruptEnd(int listid);
 	void SyncEnd(GPUSyncType waitType, int listid, bool wokeThreads);
 	void EnableInterrupts(bool enable) {
+		GeThread::Sync();
 		interruptsEnabled_ = enable;
 	}
 
@@ -248,6 +251,8 @@ class GPUCommon : public GPUDebugInterface {
 	virtual bool GetMatrix24(GEMatrixType type, u32_le *result, u32 cmdbits);
 	virtual void ResetMatrices();
 	virtual void DoState(PointerWrap &p);
+	// Waits for any drawing still running in the background, before RAM is saved or replaced.
+	virtual void FinishBackgroundDraws() {}
 	bool BusyDrawing();
 	u32 Continue(bool *runList);
 	u32 Break(int mode);
@@ -1,5 +1,6 @@
 #include "Common/Profiler/Profiler.h"
 
+#include "Common/Data/Collections/FrameArena.h"
 #include "Common/GPU/thin3d.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/System/System.h"
@@ -8,6 +9,7 @@
 #include "Core/Config.h"
 #include "Core/Util/PPGeDraw.h"
 
+#include "GPU/GeThread.h"
 #include "GPU/GPUCommonHW.h"
 #include "GPU/Common/SplineCommon.h"
 #include "GPU/Common/DrawEngineCommon.h"
@@ -56,7 +58,7 @@ const CommonCommandTableEntry commonCommandTable[] = {
 	// Changing the vertex type requires us to flush.
 	{ GE_CMD_VERTEXTYPE, FLAG_FLUSHBEFOREONCHANGE | FLAG_EXECUTEONCHANGE, 0, &GPUCommonHW::Execute_VertexType },
 
-	{ GE_CMD_LOADCLUT, FLAG_FLUSHBEFOREONCHANGE | FLAG_EXECUTE, 0, &GPUCommonHW::Execute_LoadClut},
+	{ GE_CMD_LOADCLUT, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE | FLAG_EXECUTE, 0, &GPUCommonHW::Execute_LoadClut},
 
 	// These two are actually processed in CMD_END.
 	{ GE_CMD_SIGNAL },
@@ -138,7 +140,7 @@ const CommonCommandTableEntry commonCommandTable[] = {
 	{ GE_CMD_TEXOFFSETU },
 	{ GE_CMD_TEXOFFSETV },
 
-	{ GE_CMD_TEXSIZE0, FLAG_FLUSHBEFOREONCHANGE | FLAG_EXECUTE, 0, &GPUCommonHW::Execute_TexSize0 },
+	{ GE_CMD_TEXSIZE0, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE | FLAG_EXECUTE, 0, &GPUCommonHW::Execute_TexSize0 },
 	{ GE_CMD_TEXSIZE1, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXSIZE2, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXSIZE3, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
@@ -146,10 +148,10 @@ const CommonCommandTableEntry commonCommandTable[] = {
 	{ GE_CMD_TEXSIZE5, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXSIZE6, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXSIZE7, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
-	{ GE_CMD_TEXFORMAT, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_IMAGE },
+	{ GE_CMD_TEXFORMAT, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE, DIRTY_TEXTURE_IMAGE },
 	{ GE_CMD_TEXLEVEL, FLAG_EXECUTEONCHANGE, DIRTY_TEXTURE_PARAMS, &GPUCommonHW::Execute_TexLevel },
 	{ GE_CMD_TEXLODSLOPE, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
-	{ GE_CMD_TEXADDR0, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_IMAGE },
+	{ GE_CMD_TEXADDR0, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE, DIRTY_TEXTURE_IMAGE },
 	{ GE_CMD_TEXADDR1, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXADDR2, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXADDR3, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
@@ -157,7 +159,7 @@ const CommonCommandTableEntry commonCommandTable[] = {
 	{ GE_CMD_TEXADDR5, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXADDR6, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXADDR7, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
-	{ GE_CMD_TEXBUFWIDTH0, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_IMAGE },
+	{ GE_CMD_TEXBUFWIDTH0, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE, DIRTY_TEXTURE_IMAGE },
 	{ GE_CMD_TEXBUFWIDTH1, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXBUFWIDTH2, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 	{ GE_CMD_TEXBUFWIDTH3, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
@@ -167,9 +169,9 @@ const CommonCommandTableEntry commonCommandTable[] = {
 	{ GE_CMD_TEXBUFWIDTH7, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS },
 
 	// These must flush on change, so that LoadClut doesn't have to always flush.
-	{ GE_CMD_CLUTADDR, FLAG_FLUSHBEFOREONCHANGE },
-	{ GE_CMD_CLUTADDRUPPER, FLAG_FLUSHBEFOREONCHANGE },
-	{ GE_CMD_CLUTFORMAT, FLAG_FLUSHBEFOREONCHANGE, DIRTY_TEXTURE_PARAMS | DIRTY_DEPAL },
+	{ GE_CMD_CLUTADDR, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE },
+	{ GE_CMD_CLUTADDRUPPER, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE },
+	{ GE_CMD_CLUTFORMAT, FLAG_FLUSHBEFOREONCHANGE | FLAG_TEXTURECHANGE, DIRTY_TEXTURE_PARAMS | DIRTY_DEPAL },
 
 	// Morph weights. TODO: Remove precomputation?
 	{ GE_CMD_MORPHWEIGHT0, FLAG_FLUSHBEFOREONCHANGE | FLAG_EXECUTEONCHANGE, 0, &GPUCommon::Execute_MorphWeight },
@@ -512,6 +514,7 @@ void GPUCommonHW::BeginHostFrame() {
 }
 
 void GPUCommonHW::SetDisplayFramebuffer(u32 framebuf, u32 stride, GEBufferFormat format) {
+	GeThread::Sync();
 	framebufferManager_->SetDisplayFramebuffer(framebuf, stride, format);
 	NotifyDisplay(framebuf, stride, format);
 }
@@ -519,6 +522,10 @@ void GPUCommonHW::SetDisplayFramebuffer(u32 framebuf, u32 stride, GEBufferFormat
 void GPUCommonHW::CheckFlushOp(int cmd, u32 diff) {
 	const u8 cmdFlags = cmdInfo_[cmd].flags;
 	if (diff && (cmdFlags & FLAG_FLUSHBEFOREONCHANGE)) {
+		if ((cmdFlags & FLAG_TEXTURECHANGE) && drawEngineCommon_->IsAtlasBatch()) {
+			gpuStats.numTextureChangesBatched++;
+			return;
+		}
 		if (dumpThisFrame_) {
 			NOTICE_LOG(Log::G3D, "================ FLUSH ================");
 		}
@@ -531,6 +538,7 @@ void GPUCommonHW::PreExecuteOp(u32 op, u32 diff) {
 }
 
 void GPUCommonHW::CopyDisplayToOutput(bool reallyDirty) {
+	GeThread::Sync();
 	drawEngineCommon_->FlushQueuedDepth();
 	// Flush anything left over.
 	drawEngineCommon_->Flush();
@@ -548,12 +556,14 @@ bool GPUCommonHW::PresentedThisFrame() const {
 }
 
 void GPUCommonHW::DoState(PointerWrap &p) {
+	GeThread::Sync();
 	GPUCommon::DoState(p);
 
 	// TODO: Some of these things may not be necessary.
 	// None of these are necessary when saving.
 	if (p.mode == p.MODE_READ && !PSP_CoreParameter().frozen) {
-		textureCache_->Clear(true);
+		// Textures whose memory the state didn't change can be kept.
+		textureCache_->RehashAll();
 
 		gstate_c.Dirty(DIRTY_TEXTURE_IMAGE);
 		framebufferManager_->DestroyAllFBOs();
@@ -775,6 +785,7 @@ void GPUCommonHW::CheckDepthUsage(VirtualFramebuffer *vfb) {
 }
 
 void GPUCommonHW::InvalidateCache(u32 addr, int size, GPUInvalidationType type) {
+	GeThread::Sync();
 	if (size > 0)
 		textureCache_->Invalidate(addr, size, type);
 	else
@@ -790,6 +801,7 @@ void GPUCommonHW::InvalidateCache(u32 addr, int size, GPUInvalidationType type)
 }
 
 bool GPUCommonHW::FramebufferDirty() {
+	GeThread::Sync();
 	VirtualFramebuffer *vfb = framebufferManager_->GetDisplayVFB();
 	if (vfb) {
 		bool dirty = vfb->dirtyAfterDisplay;
@@ -800,6 +812,7 @@ bool GPUCommonHW::FramebufferDirty() {
 }
 
 bool GPUCommonHW::FramebufferReallyDirty() {
+	GeThread::Sync();
 	VirtualFramebuffer *vfb = framebufferManager_->GetDisplayVFB();
 	if (vfb) {
 		bool dirty = vfb->reallyDirtyAfterDisplay;
@@ -832,6 +845,11 @@ void GPUCommonHW::FastRunLoop(DisplayList &list) {
 	}
 
 	const CommandInfo *cmdInfo = cmdInfo_;
+	// Runs of plain state changes (lights, materials, blending...) are the bulk of most lists.
+	// Their dirty flags are gathered here, and only committed before something could look at them.
+	uint64_t pendingDirty = 0;
+	// Nothing can be queued to draw after a flush, until a handler runs.  Saves flushing every change.
+	bool flushed = false;
 	int dc = downcount;
 	for (; dc > 0; --dc) {
 		// We know that display list PCs have the upper nibble == 0 - no need to mask the pointer
@@ -841,28 +859,41 @@ void GPUCommonHW::FastRunLoop(DisplayList &list) {
 		const u32 diff = op ^ gstate.cmdmem[cmd];
 		if (diff == 0) {
 			if (info.flags & FLAG_EXECUTE) {
+				gstate_c.Dirty(pendingDirty);
+				pendingDirty = 0;
 				downcount = dc;
 				(this->*info.func)(op, diff);
 				dc = downcount;
+				flushed = false;
 			}
 		} else {
 			uint64_t flags = info.flags;
-			if (flags & FLAG_FLUSHBEFOREONCHANGE) {
-				drawEngineCommon_->Flush();
+			if ((flags & FLAG_FLUSHBEFOREONCHANGE) && !flushed) {
+				if ((flags & FLAG_TEXTURECHANGE) && drawEngineCommon_->IsAtlasBatch()) {
+					// The queued draws sample from the sprite atlas, what they need from the texture is already there.
+					gpuStats.numTextureChangesBatched++;
+				} else {
+					gstate_c.Dirty(pendingDirty);
+					pendingDirty = 0;
+					drawEngineCommon_->Flush();
+					flushed = true;
+				}
 			}
 			gstate.cmdmem[cmd] = op;
 			if (flags & (FLAG_EXECUTE | FLAG_EXECUTEONCHANGE)) {
+				gstate_c.Dirty(pendingDirty);
+				pendingDirty = 0;
 				downcount = dc;
 				(this->*info.func)(op, diff);
 				dc = downcount;
+				flushed = false;
 			} else {
-				uint64_t dirty = flags >> 8;
-				if (dirty)
-					gstate_c.Dirty(dirty);
+				pendingDirty |= flags >> 8;
 			}
 		}
 		list.pc += 4;
 	}
+	gstate_c.Dirty(pendingDirty);
 	downcount = 0;
 }
 
@@ -1779,30 +1810,51 @@ void GPUCommonHW::Execute_TexFlush(u32 op, u32 diff) {
 }
 
 u32 GPUCommonHW::DrawSync(int mode) {
+	GeThread::Sync();
 	drawEngineCommon_->FlushQueuedDepth();
 	return GPUCommon::DrawSync(mode);
 }
 
 int GPUCommonHW::ListSync(int listid, int mode) {
+	GeThread::Sync();
 	drawEngineCommon_->FlushQueuedDepth();
 	return GPUCommon::ListSync(listid, mode);
 }
 
 size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 	float vertexAverageCycles = gpuStats.numVertsSubmitted > 0 ? (float)gpuStats.vertexGPUCycles / (float)gpuStats.numVertsSubmitted : 0.0f;
+
+	// Only list the formats that were actually decoded this frame.
+	char texFormats[256] = "";
+	size_t texFormatsLen = 0;
+	for (size_t i = 0; i < ARRAY_SIZE(gpuStats.numTexturesDecodedByFormat) && texFormatsLen < sizeof(texFormats); i++) {
+		if (gpuStats.numTexturesDecodedByFormat[i] == 0)
+			continue;
+		texFormatsLen += snprintf(texFormats + texFormatsLen, sizeof(texFormats) - texFormatsLen, "%s%s %d (%d kB)", texFormatsLen ? ", " : "",
+			GeTextureFormatToString((GETextureFormat)i), gpuStats.numTexturesDecodedByFormat[i], gpuStats.numTextureBytesUploadedByFormat[i] / 1024);
+	}
+
+	const FrameArena::Stats &arenaStats = g_gpuFrameArena.LastFrameStats();
+
 	return snprintf(buffer, size,
 		"DL processing time: %0.2f ms, %d drawsync, %d listsync\n"
 		"Draw: %d (%d dec, %d culled), flushes %d, clears %d, bbox jumps %d (%d updates)\n"
-		"Vertices: %d dec: %d drawn: %d\n"
-		"FBOs active: %d (evaluations: %d, created %d)\n"
+		"Vertices: %d dec: %d drawn: %d cached: %d\n"
+		"FBOs active: %d (evaluations: %d, created %d, recycled %d, pooled %d)\n"
 		"Textures: %d, dec: %d, invalidated: %d, hashed: %d kB, clut %d\n"
+		"Texture memory: %d kB (budget %d kB), evicted %d\n"
+		"Tex cache: %d hits, %d misses, %d rehashed (%0.2f ms), %d unchanged\n"
+		"Sprite atlas: %d texture changes batched\n"
+		"Tex decode: %0.2f ms, scale: %0.2f ms, upload: %d kB\n"
+		"Tex formats: %s\n"
 		"readbacks %d (%d non-block), upload %d (cached %d), depal %d\n"
 		"block transfers: %d\n"
 		"replacer: tracks %d references, %d unique textures\n"
 		"Cpy: depth %d, color %d, reint %d, blend %d, self %d\n"
 		"GPU cycles: %d (%0.1f per vertex)\n"
 		"Z-rast: %0.2f+%0.2f+%0.2f (total %0.2f/%0.2f) ms\n"
-		"Z-rast: %d prim, %d nopix, %d small, %d earlysize, %d zcull, %d box\n%s",
+		"Z-rast: %d prim, %d nopix, %d small, %d earlysize, %d zcull, %d box\n"
+		"Scratch: %d allocs, %d kB, peak %d kB of %d kB, %d heap\n%s",
 		gpuStats.msProcessingDisplayLists * 1000.0f,
 		gpuStats.numDrawSyncs,
 		gpuStats.numListSyncs,
@@ -1816,14 +1868,30 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 		gpuStats.numVertsSubmitted,
 		gpuStats.numVertsDecoded,
 		gpuStats.numUncachedVertsDrawn,
+		gpuStats.numCachedVertsDrawn,
 		(int)framebufferManager_->NumVFBs(),
 		gpuStats.numFramebufferEvaluations,
 		gpuStats.numFBOsCreated,
+		gpuStats.numFBOsRecycled,
+		(int)framebufferManager_->NumPooledFBOs(),
 		(int)textureCache_->NumLoadedTextures(),
 		gpuStats.numTexturesDecoded,
 		gpuStats.numTextureInvalidations,
 		gpuStats.numTextureDataBytesHashed / 1024,
 		gpuStats.numClutTextures,
+		(int)(textureCache_->CacheMemoryUsage() / 1024),
+		(int)(textureCache_->CacheMemoryBudget() / 1024),
+		gpuStats.numTexturesEvicted,
+		gpuStats.numTextureCacheHits,
+		gpuStats.numTextureCacheMisses,
+		gpuStats.numTexturesHashed,
+		gpuStats.msTextureHashing * 1000.0,
+		gpuStats.numTextureHashesSkipped,
+		gpuStats.numTextureChangesBatched,
+		gpuStats.msTextureDecoding * 1000.0,
+		gpuStats.msTextureScaling * 1000.0,
+		gpuStats.numTextureBytesUploaded / 1024,
+		texFormats,
 		gpuStats.numBlockingReadbacks,
 		gpuStats.numReadbacks,
 		gpuStats.numUploads,
@@ -1850,6 +1918,11 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 		gpuStats.numDepthRasterEarlySize,
 		gpuStats.numDepthRasterZCulled,
 		gpuStats.numDepthEarlyBoxCulled,
+		arenaStats.allocs,
+		(int)(arenaStats.bytes / 1024),
+		(int)(arenaStats.peak / 1024),
+		(int)(g_gpuFrameArena.Capacity() / 1024),
+		arenaStats.blockAllocs,
 		debugRecording_ ? "(debug-recording)" : ""
 	);
 }
@@ -0,0 +1,133 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Common/Log.h"
+#include "Common/Thread/ThreadUtil.h"
+#include "Core/Config.h"
+#include "Core/System.h"
+#include "Core/HLE/sceGe.h"
+#include "GPU/GeThread.h"
+#include "GPU/GPUCommon.h"
+
+namespace GeThread {
+
+static std::thread thread;
+static std::mutex lock;
+static std::condition_variable cond;
+static std::atomic<bool> active{};
+// Both protected by lock.
+static bool busy = false;
+static bool quit = false;
+static uint64_t kickTicks = 0;
+static thread_local bool onThread = false;
+
+static void ThreadFunc() {
+	SetCurrentThreadName("GeThread");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
+	AttachThreadToJNI();
+	onThread = true;
+
+	std::unique_lock<std::mutex> guard(lock);
+	while (true) {
+		cond.wait(guard, [] { return busy || quit; });
+		if (quit)
+			break;
+
+		guard.unlock();
+		DLResult result = gpu->ProcessDLQueue();
+		// Debugging always processes the queue on the emu thread instead.
+		_dbg_assert_(result != DLResult::DebugBreak);
+		guard.lock();
+
+		busy = false;
+		cond.notify_all();
+	}
+
+	DetachThreadFromJNI();
+}
+
+void Update() {
+	const bool wanted = g_Config.bGeThread && gpu && PSP_CoreParameter().gpuCore != GPUCORE_SOFTWARE;
+	if (wanted == active)
+		return;
+
+	if (wanted) {
+		INFO_LOG(Log::G3D, "Starting GE thread");
+		busy = false;
+		quit = false;
+		thread = std::thread(&ThreadFunc);
+		active = true;
+	} else {
+		Shutdown();
+	}
+}
+
+void Shutdown() {
+	if (!active)
+		return;
+
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		cond.wait(guard, [] { return !busy; });
+		quit = true;
+		cond.notify_all();
+	}
+	thread.join();
+	active = false;
+	INFO_LOG(Log::G3D, "Stopped GE thread");
+}
+
+bool Active() {
+	return active;
+}
+
+bool OnThread() {
+	return onThread;
+}
+
+void Kick(uint64_t ticks) {
+	_dbg_assert_(active && !onThread);
+	// Normally it's already idle, since whatever queued the list had to sync.
+	Sync();
+
+	std::lock_guard<std::mutex> guard(lock);
+	kickTicks = ticks;
+	busy = true;
+	cond.notify_all();
+}
+
+uint64_t KickTicks() {
+	return kickTicks;
+}
+
+void Sync() {
+	if (!active || onThread)
+		return;
+
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		cond.wait(guard, [] { return !busy; });
+	}
+	__GeRunDeferredTriggers();
+}
+
+}  // namespace GeThread
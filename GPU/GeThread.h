@@ -0,0 +1,44 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+
+// Experimental: processes display lists on a thread of their own, in parallel with the CPU.
+// Only one thread touches the GPU at a time.  Anything else that looks at GPU state, or at what
+// the GE drew, must Sync() first.  GPUCommon does that in the entry points HLE uses, so mostly
+// only code reading gstate directly needs to care.
+namespace GeThread {
+
+// Starts or stops the thread to match the config.  Call while synced.
+void Update();
+// Stops the thread, dropping anything it signaled that wasn't delivered yet.
+void Shutdown();
+
+bool Active();
+// True on the GE thread itself, where Sync() does nothing.
+bool OnThread();
+
+// Processes the display list queue on the GE thread, as if started at ticks.
+void Kick(uint64_t ticks);
+// The ticks passed to the current Kick().  Only meaningful on the GE thread.
+uint64_t KickTicks();
+// Waits until the GE thread is idle, then lets sceGe deliver the interrupts and syncs it queued.
+void Sync();
+
+}  // namespace GeThread
@@ -18,15 +18,19 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
 
+#include "Common/Math/CrossSIMD.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/Thread/ThreadManager.h"
 #include "Common/TimeUtil.h"
 #include "Core/System.h"
 #include "GPU/Common/TextureDecoder.h"
 #include "GPU/Software/BinManager.h"
+#include "GPU/Software/HiZBuffer.h"
 #include "GPU/Software/Rasterizer.h"
 #include "GPU/Software/RasterizerRectangle.h"
+#include "GPU/Software/RenderScale.h"
 
 // Sometimes useful for debugging.
 static constexpr bool FORCE_SINGLE_THREAD = false;
@@ -94,12 +98,31 @@ static inline void DrawBinItem(const BinItem &item, const RasterizerState &state
 		DrawPoint(item.v0, item.range, state);
 		break;
 	}
+
+	// Clears set exact bounds themselves, anything else writing depth widens them.
+	if (state.hiZ && state.pixelID.depthWrite && item.type != BinItemType::CLEAR_RECT) {
+		int zmin = item.v0.screenpos.z;
+		int zmax = item.v0.screenpos.z;
+		if (item.type != BinItemType::POINT) {
+			zmin = std::min(zmin, (int)item.v1.screenpos.z);
+			zmax = std::max(zmax, (int)item.v1.screenpos.z);
+		}
+		if (item.type == BinItemType::TRIANGLE) {
+			zmin = std::min(zmin, (int)item.v2.screenpos.z);
+			zmax = std::max(zmax, (int)item.v2.screenpos.z);
+		}
+
+		DrawingCoords tl = TransformUnit::ScreenToDrawing(item.range.x1, item.range.y1);
+		DrawingCoords br = TransformUnit::ScreenToDrawing(item.range.x2, item.range.y2);
+		// Interpolated depth can be off by one.
+		state.hiZ->Expand(tl.x, tl.y, br.x, br.y, zmin - 1, zmax + 1);
+	}
 }
 
 class DrawBinItemsTask : public Task {
 public:
-	DrawBinItemsTask(BinWaitable *notify, BinManager::BinItemQueue &items, std::atomic<bool> &status, const BinManager::BinStateQueue &states)
-		: notify_(notify), items_(items), status_(status), states_(states) {
+	DrawBinItemsTask(BinWaitable *notify, BinManager *binner, int index)
+		: notify_(notify), binner_(binner), index_(index) {
 	}
 
 	TaskType Type() const override {
@@ -113,9 +136,11 @@ class DrawBinItemsTask : public Task {
 
 	void Run() override {
 		ProcessItems();
-		status_ = false;
+		binner_->taskStatus_[index_] = false;
 		// In case of any atomic issues, do another pass.
 		ProcessItems();
+		// Before going idle, help with any bins still waiting on a busy thread.
+		binner_->StealTaskItems(index_);
 		notify_->Drain();
 	}
 
@@ -125,17 +150,14 @@ class DrawBinItemsTask : public Task {
 
 private:
 	void ProcessItems() {
-		while (!items_.Empty()) {
-			const BinItem &item = items_.PeekNext();
-			DrawBinItem(item, states_[item.stateIndex]);
-			items_.SkipNext();
-		}
+		// If another thread stole our bin, wait for it so nothing gets left behind.
+		while (!binner_->DrawTaskItems(index_))
+			std::this_thread::yield();
 	}
 
 	BinWaitable *notify_;
-	BinManager::BinItemQueue &items_;
-	std::atomic<bool> &status_;
-	const BinManager::BinStateQueue &states_;
+	BinManager *binner_;
+	int index_;
 };
 
 constexpr int BinManager::MAX_POSSIBLE_TASKS;
@@ -149,12 +171,15 @@ BinManager::BinManager() {
 	waitable_ = new BinWaitable();
 	for (auto &s : taskStatus_)
 		s = false;
+	for (auto &s : taskDrawing_)
+		s = false;
+	steals_ = 0;
 
-	int maxInitTasks = std::min(g_threadManager.GetNumLooperThreads(), MAX_POSSIBLE_TASKS);
-	for (int i = 0; i < maxInitTasks; ++i) {
+	taskQueueCount_ = std::min(g_threadManager.GetNumLooperThreads() * BINS_PER_THREAD, MAX_POSSIBLE_TASKS);
+	for (int i = 0; i < taskQueueCount_; ++i) {
 		taskQueues_[i].Setup();
 		for (DrawBinItemsTask *&task : taskLists_[i].tasks)
-			task = new DrawBinItemsTask(waitable_, taskQueues_[i], taskStatus_[i], states_);
+			task = new DrawBinItemsTask(waitable_, this, i);
 	}
 	states_.Setup();
 	cluts_.Setup();
@@ -162,6 +187,8 @@ BinManager::BinManager() {
 }
 
 BinManager::~BinManager() {
+	// Anything kicked might still be drawing.
+	waitable_->Wait();
 	delete waitable_;
 
 	for (int i = 0; i < MAX_POSSIBLE_TASKS; ++i) {
@@ -172,6 +199,8 @@ BinManager::~BinManager() {
 
 void BinManager::UpdateState() {
 	PROFILE_THIS_SCOPE("bin_state");
+	// These were set up for the old state and scissor.
+	SubmitTriangleBatch();
 	if (HasDirty(SoftDirty::PIXEL_ALL | SoftDirty::SAMPLER_ALL | SoftDirty::RAST_ALL)) {
 		if (states_.Full())
 			Flush("states");
@@ -180,6 +209,7 @@ void BinManager::UpdateState() {
 		// When new funcs are compiled, we need to flush if WX exclusive.
 		ComputeRasterizerState(&states_[stateIndex_], this);
 		states_[stateIndex_].samplerID.cached.clut = cluts_[clutIndex_].readable;
+		states_[stateIndex_].hiZ = activeHiZ_;
 		creatingState_ = false;
 
 		ClearDirty(SoftDirty::PIXEL_ALL | SoftDirty::SAMPLER_ALL | SoftDirty::RAST_ALL);
@@ -188,6 +218,7 @@ void BinManager::UpdateState() {
 	if (lastFlipstats_ != gpuStats.numFlips) {
 		lastFlipstats_ = gpuStats.numFlips;
 		ResetStats();
+		UpdateLoadStats();
 	}
 
 	const auto &state = State();
@@ -201,14 +232,15 @@ void BinManager::UpdateState() {
 
 		scissor_.x1 = screenScissorTL.x;
 		scissor_.y1 = screenScissorTL.y;
-		scissor_.x2 = screenScissorBR.x + SCREEN_SCALE_FACTOR - 1;
-		scissor_.y2 = screenScissorBR.y + SCREEN_SCALE_FACTOR - 1;
+		scissor_.x2 = screenScissorBR.x + SCREEN_SCALE_FACTOR * RenderScale::Factor() - 1;
+		scissor_.y2 = screenScissorBR.y + SCREEN_SCALE_FACTOR * RenderScale::Factor() - 1;
 
 		// If we're about to texture from something still pending (i.e. depth), flush.
 		if (HasTextureWrite(state))
 			Flush("tex");
 
 		// Okay, now update what's pending.
+		UpdateHiZ();
 		MarkPendingWrites(state);
 
 		ClearDirty(SoftDirty::BINNER_RANGE);
@@ -328,6 +360,68 @@ void BinManager::MarkPendingReads(const Rasterizer::RasterizerState &state) {
 	}
 }
 
+void BinManager::UpdateHiZ() {
+	constexpr uint32_t mirrorMask = 0x041FFFFF;
+	const uint32_t depthAddr = gstate.getDepthBufAddress() & mirrorMask;
+	const uint16_t depthStride = gstate.DepthBufStride();
+
+	if (!activeHiZ_ || !activeHiZ_->Matches(depthAddr, depthStride)) {
+		// Changing the depth buffer already flushes, so nothing queued can still be using the old one.
+		Flush("depthbuf");
+
+		int slot = -1;
+		for (int i = 0; i < HIZ_SLOTS; ++i) {
+			if (hiZ_[i].Matches(depthAddr, depthStride))
+				slot = i;
+		}
+		if (slot == -1) {
+			slot = 0;
+			for (int i = 1; i < HIZ_SLOTS; ++i) {
+				if (hiZLastUse_[i] < hiZLastUse_[slot])
+					slot = i;
+			}
+			hiZ_[slot].Reset(depthAddr, depthStride);
+		}
+
+		activeHiZ_ = &hiZ_[slot];
+		hiZLastUse_[slot] = ++hiZUseCounter_;
+		states_[stateIndex_].hiZ = activeHiZ_;
+	}
+
+	// Whatever made it unreliable happened before anything now queued, so start over.
+	if (!activeHiZ_->Enabled() && queueRange_.x1 == 0x7FFFFFFF)
+		activeHiZ_->Reset();
+
+	const int width = std::min(gstate.getScissorX2(), gstate.getRegionX2()) + 1;
+	const int rows = std::min(gstate.getScissorY2(), gstate.getRegionY2()) + 1;
+	activeHiZ_->GrowRows(rows);
+	// Drawing past the stride wraps into the next row, which the tiles don't account for.
+	if (width > depthStride)
+		activeHiZ_->Disable();
+
+	// Color (or another depth buffer) drawn over a tracked depth buffer changes it behind our back.
+	const uint32_t bpp = gstate.FrameBufFormat() == GE_FORMAT_8888 ? 4 : 2;
+	const uint32_t colorAddr = gstate.getFrameBufAddress() & mirrorMask;
+	const uint32_t colorEnd = colorAddr + gstate.FrameBufStride() * bpp * rows;
+	const uint32_t depthEnd = depthAddr + depthStride * 2 * rows;
+	for (auto &hiZ : hiZ_) {
+		if (hiZ.Overlaps(colorAddr, colorEnd) || (&hiZ != activeHiZ_ && hiZ.Overlaps(depthAddr, depthEnd)))
+			hiZ.Disable();
+	}
+}
+
+void BinManager::InvalidateHiZ(uint32_t addr, int bytes) {
+	constexpr uint32_t mirrorMask = 0x041FFFFF;
+	const uint32_t start = addr & mirrorMask;
+	for (auto &hiZ : hiZ_) {
+		if (bytes < 0 || hiZ.Overlaps(start, start + bytes))
+			hiZ.Disable();
+	}
+
+	// Gives UpdateHiZ() a chance to reset it, if nothing's queued.
+	dirty_ |= SoftDirty::BINNER_RANGE;
+}
+
 void BinManager::MarkPendingWrites(const Rasterizer::RasterizerState &state) {
 	DrawingCoords scissorTL(gstate.getScissorX1(), gstate.getScissorY1());
 	DrawingCoords scissorBR(std::min(gstate.getScissorX2(), gstate.getRegionX2()), std::min(gstate.getScissorY2(), gstate.getRegionY2()));
@@ -337,6 +431,15 @@ void BinManager::MarkPendingWrites(const Rasterizer::RasterizerState &state) {
 	pendingWrites_[0].Expand(gstate.getFrameBufAddress() & mirrorMask, bpp, gstate.FrameBufStride(), scissorTL, scissorBR);
 	if (state.pixelID.depthWrite)
 		pendingWrites_[1].Expand(gstate.getDepthBufAddress() & mirrorMask, 2, gstate.DepthBufStride(), scissorTL, scissorBR);
+
+	if (RenderScale::Factor() != 1) {
+		const bool useDepth = state.pixelID.depthWrite || state.pixelID.DepthTestFunc() != GE_COMP_ALWAYS;
+		if (!RenderScale::PrepareTargets(scissorTL, scissorBR, useDepth, queueRange_.x1 == 0x7FFFFFFF)) {
+			// Need to switch or grow the scaled buffers, which can't happen under queued draws.
+			Flush("renderscale");
+			MarkPendingWrites(state);
+		}
+	}
 }
 
 inline void BinDirtyRange::Expand(uint32_t newBase, uint32_t bpp, uint32_t stride, const DrawingCoords &tl, const DrawingCoords &br) {
@@ -375,23 +478,44 @@ void BinManager::UpdateClut(const void *src) {
 }
 
 void BinManager::AddTriangle(const VertexData &v0, const VertexData &v1, const VertexData &v2) {
-	Vec2<int> d01((int)v0.screenpos.x - (int)v1.screenpos.x, (int)v0.screenpos.y - (int)v1.screenpos.y);
-	Vec2<int> d02((int)v0.screenpos.x - (int)v2.screenpos.x, (int)v0.screenpos.y - (int)v2.screenpos.y);
-	Vec2<int> d12((int)v1.screenpos.x - (int)v2.screenpos.x, (int)v1.screenpos.y - (int)v2.screenpos.y);
+	const int t = triBatchCount_++;
+	triBatch_[t * 3 + 0] = v0;
+	triBatch_[t * 3 + 1] = v1;
+	triBatch_[t * 3 + 2] = v2;
+	triBatchX_[t] = v0.screenpos.x;
+	triBatchY_[t] = v0.screenpos.y;
+	triBatchX_[TRIANGLE_BATCH + t] = v1.screenpos.x;
+	triBatchY_[TRIANGLE_BATCH + t] = v1.screenpos.y;
+	triBatchX_[TRIANGLE_BATCH * 2 + t] = v2.screenpos.x;
+	triBatchY_[TRIANGLE_BATCH * 2 + t] = v2.screenpos.y;
+
+	if (triBatchCount_ == TRIANGLE_BATCH)
+		SubmitTriangleBatch();
+}
 
-	// Drop primitives which are not in CCW order by checking the cross product.
-	static_assert(SCREEN_SCALE_FACTOR <= 16, "Fails if scale factor is too high");
-	if (d01.x * d02.y - d01.y * d02.x < 0)
-		return;
-	// If all points have identical coords, we'll have 0 weights and not skip properly, so skip here.
-	if ((d01.x == 0 && d02.x == 0) || (d01.y == 0 && d02.y == 0))
+void BinManager::SubmitTriangleBatch() {
+	const int count = triBatchCount_;
+	if (count == 0)
 		return;
+	triBatchCount_ = 0;
 
-	// Was it fully outside the scissor?
-	const BinCoords range = Range(v0, v1, v2);
-	if (range.Invalid())
-		return;
+	// Unused slots get all zero coords, which are always dropped.
+	for (int t = count; t < TRIANGLE_BATCH; ++t) {
+		for (int v = 0; v < 3; ++v) {
+			triBatchX_[TRIANGLE_BATCH * v + t] = 0;
+			triBatchY_[TRIANGLE_BATCH * v + t] = 0;
+		}
+	}
+
+	BinCoords ranges[TRIANGLE_BATCH];
+	const int mask = SetupTriangles4(triBatchX_, triBatchY_, scissor_, ranges);
+	for (int t = 0; t < count; ++t) {
+		if (mask & (1 << t))
+			PushTriangle(triBatch_[t * 3 + 0], triBatch_[t * 3 + 1], triBatch_[t * 3 + 2], ranges[t]);
+	}
+}
 
+void BinManager::PushTriangle(const VertexData &v0, const VertexData &v1, const VertexData &v2, const BinCoords &range) {
 	if (queue_.Full())
 		Drain();
 	queue_.Push(BinItem{ BinItemType::TRIANGLE, stateIndex_, range, v0, v1, v2 });
@@ -400,6 +524,7 @@ void BinManager::AddTriangle(const VertexData &v0, const VertexData &v1, const V
 }
 
 void BinManager::AddClearRect(const VertexData &v0, const VertexData &v1) {
+	SubmitTriangleBatch();
 	const BinCoords range = Range(v0, v1);
 	if (range.Invalid())
 		return;
@@ -412,6 +537,7 @@ void BinManager::AddClearRect(const VertexData &v0, const VertexData &v1) {
 }
 
 void BinManager::AddRect(const VertexData &v0, const VertexData &v1) {
+	SubmitTriangleBatch();
 	const BinCoords range = Range(v0, v1);
 	if (range.Invalid())
 		return;
@@ -424,6 +550,7 @@ void BinManager::AddRect(const VertexData &v0, const VertexData &v1) {
 }
 
 void BinManager::AddSprite(const VertexData &v0, const VertexData &v1) {
+	SubmitTriangleBatch();
 	const BinCoords range = Range(v0, v1);
 	if (range.Invalid())
 		return;
@@ -436,6 +563,7 @@ void BinManager::AddSprite(const VertexData &v0, const VertexData &v1) {
 }
 
 void BinManager::AddLine(const VertexData &v0, const VertexData &v1) {
+	SubmitTriangleBatch();
 	const BinCoords range = Range(v0, v1);
 	if (range.Invalid())
 		return;
@@ -448,6 +576,7 @@ void BinManager::AddLine(const VertexData &v0, const VertexData &v1) {
 }
 
 void BinManager::AddPoint(const VertexData &v0) {
+	SubmitTriangleBatch();
 	const BinCoords range = Range(v0);
 	if (range.Invalid())
 		return;
@@ -469,7 +598,7 @@ void BinManager::Drain(bool flushing) {
 
 		// Always bin the entire possible range, but focus on the drawn area.
 		ScreenCoords tl(0, 0, 0);
-		ScreenCoords br(1024 * SCREEN_SCALE_FACTOR, 1024 * SCREEN_SCALE_FACTOR, 0);
+		ScreenCoords br(1024 * SCREEN_SCALE_FACTOR * RenderScale::Factor(), 1024 * SCREEN_SCALE_FACTOR * RenderScale::Factor(), 0);
 
 		if (pendingOverlap_ && maxTasks_ == 1 && flushing && queue_.Size() == 1 && !FORCE_SINGLE_THREAD) {
 			// If the drawing is 1:1, we can potentially use threads.  It's worth checking.
@@ -480,20 +609,37 @@ void BinManager::Drain(bool flushing) {
 		}
 
 		taskRanges_.clear();
+		// Self-rendering must stay on one thread, otherwise split wider than threads so they can steal.
+		const int binCount = maxTasks_ == 1 ? 1 : std::min(maxTasks_ * BINS_PER_THREAD, taskQueueCount_);
 		if (h2 >= 18 && w2 >= h2 * 4) {
-			int bin_w = std::max(4, (w2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
-			taskRanges_.push_back(BinCoords{ tl.x, tl.y, queueRange_.x1 + bin_w - 1, br.y - 1 });
-			for (int x = queueRange_.x1 + bin_w; x <= queueRange_.x2; x += bin_w) {
-				int x2 = x + bin_w > queueRange_.x2 ? br.x : x + bin_w;
-				taskRanges_.push_back(BinCoords{ x, tl.y, x2 - 1, br.y - 1 });
+			// Prefer to balance by last frame's load, since hotspots would otherwise hold up the drain.
+			SplitByLoad(taskEdges_, lastLoadX_, queueRange_.x1, queueRange_.x2, binCount);
+			if (taskEdges_.empty()) {
+				int bin_w = std::max(4, (w2 + binCount - 1) / binCount) * SCREEN_SCALE_FACTOR * 2;
+				for (int x = queueRange_.x1 + bin_w; x <= queueRange_.x2; x += bin_w)
+					taskEdges_.push_back(x);
+			}
+
+			int x1 = tl.x;
+			for (int x : taskEdges_) {
+				taskRanges_.push_back(BinCoords{ x1, tl.y, x - 1, br.y - 1 });
+				x1 = x;
 			}
+			taskRanges_.push_back(BinCoords{ x1, tl.y, br.x - 1, br.y - 1 });
 		} else if (h2 >= 18 && w2 >= 18) {
-			int bin_h = std::max(4, (h2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
-			taskRanges_.push_back(BinCoords{ tl.x, tl.y, br.x - 1, queueRange_.y1 + bin_h - 1 });
-			for (int y = queueRange_.y1 + bin_h; y <= queueRange_.y2; y += bin_h) {
-				int y2 = y + bin_h > queueRange_.y2 ? br.y : y + bin_h;
-				taskRanges_.push_back(BinCoords{ tl.x, y, br.x - 1, y2 - 1 });
+			SplitByLoad(taskEdges_, lastLoadY_, queueRange_.y1, queueRange_.y2, binCount);
+			if (taskEdges_.empty()) {
+				int bin_h = std::max(4, (h2 + binCount - 1) / binCount) * SCREEN_SCALE_FACTOR * 2;
+				for (int y = queueRange_.y1 + bin_h; y <= queueRange_.y2; y += bin_h)
+					taskEdges_.push_back(y);
+			}
+
+			int y1 = tl.y;
+			for (int y : taskEdges_) {
+				taskRanges_.push_back(BinCoords{ tl.x, y1, br.x - 1, y - 1 });
+				y1 = y;
 			}
+			taskRanges_.push_back(BinCoords{ tl.x, y1, br.x - 1, br.y - 1 });
 		}
 
 		tasksSplit_ = true;
@@ -549,7 +695,7 @@ void BinManager::Drain(bool flushing) {
 
 			waitable_->Fill();
 			taskStatus_[i] = true;
-			g_threadManager.EnqueueTaskOnThread(i, taskLists_[i].Next());
+			g_threadManager.EnqueueTaskOnThread(i % maxTasks_, taskLists_[i].Next());
 			enqueues_++;
 		}
 
@@ -558,6 +704,7 @@ void BinManager::Drain(bool flushing) {
 }
 
 void BinManager::Flush(const char *reason) {
+	SubmitTriangleBatch();
 	if (queueRange_.x1 == 0x7FFFFFFF)
 		return;
 
@@ -566,6 +713,7 @@ void BinManager::Flush(const char *reason) {
 		st = time_now_d();
 	Drain(true);
 	waitable_->Wait();
+	RenderScale::Resolve();
 	taskRanges_.clear();
 	tasksSplit_ = false;
 
@@ -601,6 +749,15 @@ void BinManager::Flush(const char *reason) {
 	}
 }
 
+void BinManager::Kick() {
+	SubmitTriangleBatch();
+	if (queueRange_.x1 == 0x7FFFFFFF)
+		return;
+
+	// The pending reads and writes stay marked, so anything touching them later still flushes.
+	Drain(true);
+}
+
 void BinManager::OptimizePendingStates(uint16_t first, uint16_t last) {
 	// We can sometimes hit this when compiling new funcs while creating a state.
 	// At that point, the state isn't loaded fully yet, so don't touch it.
@@ -617,6 +774,31 @@ void BinManager::OptimizePendingStates(uint16_t first, uint16_t last) {
 	}
 }
 
+bool BinManager::DrawTaskItems(int index) {
+	bool expected = false;
+	if (!taskDrawing_[index].compare_exchange_strong(expected, true))
+		return false;
+
+	BinItemQueue &items = taskQueues_[index];
+	while (!items.Empty()) {
+		const BinItem &item = items.PeekNext();
+		DrawBinItem(item, states_[item.stateIndex]);
+		items.SkipNext();
+	}
+	taskDrawing_[index] = false;
+	return true;
+}
+
+void BinManager::StealTaskItems(int skipIndex) {
+	// Bins never overlap, so any bin nobody's drawing right now is safe to take.
+	for (int i = 0; i < taskQueueCount_; ++i) {
+		if (i == skipIndex || taskQueues_[i].Empty())
+			continue;
+		if (DrawTaskItems(i))
+			steals_++;
+	}
+}
+
 bool BinManager::HasPendingWrite(uint32_t start, uint32_t stride, uint32_t w, uint32_t h) {
 	// We can only write to VRAM.
 	if (!Memory::IsVRAMAddress(start))
@@ -701,12 +883,12 @@ void BinManager::GetStats(char *buffer, size_t bufsize) {
 		"Slowest frame flush: %s (%0.4f)\n"
 		"Slowest recent flush: %s (%0.4f)\n"
 		"Total flush time: %0.4f (%05.2f%%, last 2: %05.2f%%)\n"
-		"Thread enqueues: %d, count %d",
+		"Thread enqueues: %d, count %d, steals %d",
 		slowestFlushReason_, slowestFlushTime_,
 		slowestTotalReason, slowestTotalTime,
 		slowestRecentReason, slowestRecentTime,
 		allTotal, allTotal * (6000.0 / 1.001), recentTotal * (3000.0 / 1.001),
-		enqueues_, mostThreads_);
+		enqueues_, mostThreads_, steals_.load());
 }
 
 void BinManager::ResetStats() {
@@ -716,6 +898,126 @@ void BinManager::ResetStats() {
 	slowestFlushTime_ = 0.0;
 	enqueues_ = 0;
 	mostThreads_ = 0;
+	steals_ = 0;
+}
+
+void BinManager::AddLoad(const BinCoords &range) {
+	const int shift = LOAD_BUCKET_SHIFT + RenderScale::Shift();
+	const int bx1 = std::max(0, std::min(range.x1 >> shift, LOAD_BUCKETS - 1));
+	const int by1 = std::max(0, std::min(range.y1 >> shift, LOAD_BUCKETS - 1));
+	const int bx2 = std::max(bx1, std::min(range.x2 >> shift, LOAD_BUCKETS - 1));
+	const int by2 = std::max(by1, std::min(range.y2 >> shift, LOAD_BUCKETS - 1));
+
+	// Just using the pixel area of the bounds, spread evenly over the strips it covers.
+	const int64_t area = (int64_t)(range.x2 - range.x1 + 1) * (range.y2 - range.y1 + 1) / (SCREEN_SCALE_FACTOR * SCREEN_SCALE_FACTOR);
+	const int64_t perX = area / (bx2 - bx1 + 1);
+	const int64_t perY = area / (by2 - by1 + 1);
+	loadDeltaX_[bx1] += perX;
+	loadDeltaX_[bx2 + 1] -= perX;
+	loadDeltaY_[by1] += perY;
+	loadDeltaY_[by2 + 1] -= perY;
+}
+
+void BinManager::UpdateLoadStats() {
+	int64_t x = 0;
+	int64_t y = 0;
+	for (int b = 0; b < LOAD_BUCKETS; ++b) {
+		x += loadDeltaX_[b];
+		y += loadDeltaY_[b];
+		lastLoadX_[b] = x;
+		lastLoadY_[b] = y;
+	}
+
+	memset(loadDeltaX_, 0, sizeof(loadDeltaX_));
+	memset(loadDeltaY_, 0, sizeof(loadDeltaY_));
+}
+
+void BinManager::SplitByLoad(std::vector<int> &edges, const int64_t *load, int start, int end, int count) {
+	edges.clear();
+	const int shift = LOAD_BUCKET_SHIFT + RenderScale::Shift();
+	const int b1 = std::max(0, std::min(start >> shift, LOAD_BUCKETS - 1));
+	const int b2 = std::max(b1, std::min(end >> shift, LOAD_BUCKETS - 1));
+
+	int64_t total = 0;
+	for (int b = b1; b <= b2; ++b)
+		total += load[b];
+	// Without any stats, leave it to the caller to split evenly.
+	if (total == 0 || count <= 1)
+		return;
+
+	int64_t sum = 0;
+	for (int b = b1; b < b2 && (int)edges.size() < count - 1; ++b) {
+		sum += load[b];
+		// Start a new bin each time we pass another 1/count of the load.
+		if (sum * count >= total * (int64_t)(edges.size() + 1))
+			edges.push_back((b + 1) << shift);
+	}
+}
+
+bool SetupTriangle(const ScreenCoords &v0, const ScreenCoords &v1, const ScreenCoords &v2, const BinCoords &scissor, BinCoords &range) {
+	Vec2<int> d01(v0.x - v1.x, v0.y - v1.y);
+	Vec2<int> d02(v0.x - v2.x, v0.y - v2.y);
+
+	// Drop primitives which are not in CCW order by checking the cross product.
+	static_assert(SCREEN_SCALE_FACTOR <= 16, "Fails if scale factor is too high");
+	if (d01.x * d02.y - d01.y * d02.x < 0)
+		return false;
+	// If all points have identical coords, we'll have 0 weights and not skip properly, so skip here.
+	if ((d01.x == 0 && d02.x == 0) || (d01.y == 0 && d02.y == 0))
+		return false;
+
+	range.x1 = std::max(std::min(std::min(v0.x, v1.x), v2.x) & ~(SCREEN_SCALE_FACTOR - 1), scissor.x1);
+	range.y1 = std::max(std::min(std::min(v0.y, v1.y), v2.y) & ~(SCREEN_SCALE_FACTOR - 1), scissor.y1);
+	range.x2 = std::min(std::max(std::max(v0.x, v1.x), v2.x) | (SCREEN_SCALE_FACTOR - 1), scissor.x2);
+	range.y2 = std::min(std::max(std::max(v0.y, v1.y), v2.y) | (SCREEN_SCALE_FACTOR - 1), scissor.y2);
+	// Was it fully outside the scissor?
+	return !range.Invalid();
+}
+
+int SetupTriangles4(const int *x, const int *y, const BinCoords &scissor, BinCoords ranges[4]) {
+#if PPSSPP_ARCH(SSE2) || PPSSPP_ARCH(ARM_NEON)
+	const Vec4S32 x0 = Vec4S32::Load(x), x1 = Vec4S32::Load(x + 4), x2 = Vec4S32::Load(x + 8);
+	const Vec4S32 y0 = Vec4S32::Load(y), y1 = Vec4S32::Load(y + 4), y2 = Vec4S32::Load(y + 8);
+	const Vec4S32 d01x = x0 - x1, d01y = y0 - y1;
+	const Vec4S32 d02x = x0 - x2, d02y = y0 - y2;
+	const Vec4S32 zero = Vec4S32::Zero();
+
+	// Same tests as SetupTriangle(), as lane masks.
+	Vec4S32 drop = (d01x * d02y - d01y * d02x).CompareLt(zero);
+	drop = drop | (d01x | d02x).CompareEq(zero) | (d01y | d02y).CompareEq(zero);
+
+	const Vec4S32 lowMask = Vec4S32::Splat(~(SCREEN_SCALE_FACTOR - 1));
+	const Vec4S32 highBits = Vec4S32::Splat(SCREEN_SCALE_FACTOR - 1);
+	Vec4S32 minX = (x0.Min(x1).Min(x2) & lowMask).Max(Vec4S32::Splat(scissor.x1));
+	Vec4S32 minY = (y0.Min(y1).Min(y2) & lowMask).Max(Vec4S32::Splat(scissor.y1));
+	Vec4S32 maxX = (x0.Max(x1).Max(x2) | highBits).Min(Vec4S32::Splat(scissor.x2));
+	Vec4S32 maxY = (y0.Max(y1).Max(y2) | highBits).Min(Vec4S32::Splat(scissor.y2));
+	drop = drop | maxX.CompareLt(minX) | maxY.CompareLt(minY);
+
+	alignas(16) int out[5][4];
+	minX.StoreAligned(out[0]);
+	minY.StoreAligned(out[1]);
+	maxX.StoreAligned(out[2]);
+	maxY.StoreAligned(out[3]);
+	drop.StoreAligned(out[4]);
+
+	int mask = 0;
+	for (int t = 0; t < 4; ++t) {
+		if (out[4][t] != 0)
+			continue;
+		ranges[t] = BinCoords{ out[0][t], out[1][t], out[2][t], out[3][t] };
+		mask |= 1 << t;
+	}
+	return mask;
+#else
+	int mask = 0;
+	for (int t = 0; t < 4; ++t) {
+		ScreenCoords v0(x[t], y[t], 0), v1(x[t + 4], y[t + 4], 0), v2(x[t + 8], y[t + 8], 0);
+		if (SetupTriangle(v0, v1, v2, scissor, ranges[t]))
+			mask |= 1 << t;
+	}
+	return mask;
+#endif
 }
 
 inline BinCoords BinCoords::Intersect(const BinCoords &range) const {
@@ -731,15 +1033,6 @@ BinCoords BinManager::Scissor(BinCoords range) {
 	return range.Intersect(scissor_);
 }
 
-BinCoords BinManager::Range(const VertexData &v0, const VertexData &v1, const VertexData &v2) {
-	BinCoords range;
-	range.x1 = std::min(std::min(v0.screenpos.x, v1.screenpos.x), v2.screenpos.x) & ~(SCREEN_SCALE_FACTOR - 1);
-	range.y1 = std::min(std::min(v0.screenpos.y, v1.screenpos.y), v2.screenpos.y) & ~(SCREEN_SCALE_FACTOR - 1);
-	range.x2 = std::max(std::max(v0.screenpos.x, v1.screenpos.x), v2.screenpos.x) | (SCREEN_SCALE_FACTOR - 1);
-	range.y2 = std::max(std::max(v0.screenpos.y, v1.screenpos.y), v2.screenpos.y) | (SCREEN_SCALE_FACTOR - 1);
-	return Scissor(range);
-}
-
 BinCoords BinManager::Range(const VertexData &v0, const VertexData &v1) {
 	BinCoords range;
 	range.x1 = std::min(v0.screenpos.x, v1.screenpos.x) & ~(SCREEN_SCALE_FACTOR - 1);
@@ -759,12 +1052,14 @@ BinCoords BinManager::Range(const VertexData &v0) {
 }
 
 void BinManager::Expand(const BinCoords &range) {
+	AddLoad(range);
+
 	queueRange_.x1 = std::min(queueRange_.x1, range.x1);
 	queueRange_.y1 = std::min(queueRange_.y1, range.y1);
 	queueRange_.x2 = std::max(queueRange_.x2, range.x2);
 	queueRange_.y2 = std::max(queueRange_.y2, range.y2);
 
-	if (maxTasks_ == 1 || (queueRange_.y2 - queueRange_.y1 >= 224 * SCREEN_SCALE_FACTOR && enqueues_ < 36 * maxTasks_)) {
+	if (maxTasks_ == 1 || (queueRange_.y2 - queueRange_.y1 >= 224 * SCREEN_SCALE_FACTOR * RenderScale::Factor() && enqueues_ < 36 * maxTasks_)) {
 		if (pendingOverlap_)
 			Flush("expand");
 		else
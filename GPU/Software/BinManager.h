@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <unordered_map>
+#include "GPU/Software/HiZBuffer.h"
 #include "GPU/Software/Rasterizer.h"
 
 struct BinWaitable;
@@ -46,6 +47,13 @@ struct BinCoords {
 	BinCoords Intersect(const BinCoords &range) const;
 };
 
+// Drops backfacing and degenerate triangles, and finds the scissored range of the rest.
+// Returns false if the triangle shouldn't be drawn.
+bool SetupTriangle(const ScreenCoords &v0, const ScreenCoords &v1, const ScreenCoords &v2, const BinCoords &scissor, BinCoords &range);
+// The same for four triangles at once, with screen positions ordered as x[vert * 4 + tri].
+// Returns a bit for each triangle to draw.
+int SetupTriangles4(const int *x, const int *y, const BinCoords &scissor, BinCoords ranges[4]);
+
 struct BinItem {
 	BinItemType type;
 	uint16_t stateIndex;
@@ -203,9 +211,14 @@ class BinManager {
 
 	void Drain(bool flushing = false);
 	void Flush(const char *reason);
+	// Hands everything queued to the threads without waiting.  It all stays pending until Flush().
+	void Kick();
 	bool HasPendingWrite(uint32_t start, uint32_t stride, uint32_t w, uint32_t h);
 	// Assumes you've also checked for a write (writes are partial so are automatically reads.)
 	bool HasPendingRead(uint32_t start, uint32_t stride, uint32_t w, uint32_t h);
+	// Stops trusting the hi-Z bounds of depth buffers overlapping memory written outside drawing.
+	// Pass bytes < 0 to invalidate all of them.
+	void InvalidateHiZ(uint32_t addr, int bytes);
 
 	void GetStats(char *buffer, size_t bufsize);
 	void ResetStats();
@@ -230,12 +243,21 @@ class BinManager {
 #else
 	static constexpr int MAX_POSSIBLE_TASKS = 64;
 #endif
+	// More bins than threads, so an idle thread can steal a whole bin from a busy one.
+	static constexpr int BINS_PER_THREAD = 2;
+	// Load stats are kept in strips of 16 pixels, along each axis.
+	static constexpr int LOAD_BUCKETS = 64;
+	static constexpr int LOAD_BUCKET_SHIFT = 8;
 	// This is about 1MB of state data.
 	static constexpr int QUEUED_STATES = 4096;
 	// These are 1KB each, so half an MB.
 	static constexpr int QUEUED_CLUTS = 512;
-	// About 360 KB, but we have usually 16 or less of them, so 5 MB - 22 MB.
+	// About 360 KB, but we have usually 32 or less of them (two per thread), so 10 MB - 44 MB.
 	static constexpr int QUEUED_PRIMS = 2048;
+	// Depth buffers to keep hi-Z bounds for, i.e. the main one and a few render targets.
+	static constexpr int HIZ_SLOTS = 4;
+	// Triangles are culled and bounded in groups, to use SIMD.
+	static constexpr int TRIANGLE_BATCH = 4;
 
 	typedef BinQueue<Rasterizer::RasterizerState, QUEUED_STATES> BinStateQueue;
 	typedef BinQueue<BinClut, QUEUED_CLUTS> BinClutQueue;
@@ -254,14 +276,30 @@ class BinManager {
 	int maxTasks_ = 1;
 	bool tasksSplit_ = false;
 	std::vector<BinCoords> taskRanges_;
+	std::vector<int> taskEdges_;
+	int taskQueueCount_ = 0;
 	BinItemQueue taskQueues_[MAX_POSSIBLE_TASKS];
 	BinTaskList taskLists_[MAX_POSSIBLE_TASKS];
+	// Set while a task is enqueued or running for the bin.
 	std::atomic<bool> taskStatus_[MAX_POSSIBLE_TASKS];
+	// Set while some thread is drawing the bin's items, whether it's the owner or not.
+	std::atomic<bool> taskDrawing_[MAX_POSSIBLE_TASKS];
 	BinWaitable *waitable_ = nullptr;
 
 	BinDirtyRange pendingWrites_[2]{};
+
+	Rasterizer::HiZBuffer hiZ_[HIZ_SLOTS];
+	int hiZLastUse_[HIZ_SLOTS]{};
+	int hiZUseCounter_ = 0;
+	Rasterizer::HiZBuffer *activeHiZ_ = nullptr;
 	std::unordered_map<uint32_t, BinDirtyRange> pendingReads_;
 
+	// Triangles waiting for setup, all using the current state.  Always submitted before anything else.
+	VertexData triBatch_[TRIANGLE_BATCH * 3];
+	int triBatchX_[TRIANGLE_BATCH * 3];
+	int triBatchY_[TRIANGLE_BATCH * 3];
+	int triBatchCount_ = 0;
+
 	bool pendingOverlap_ = false;
 	bool creatingState_ = false;
 	uint16_t pendingStateIndex_ = 0;
@@ -273,17 +311,33 @@ class BinManager {
 	int lastFlipstats_ = 0;
 	int enqueues_ = 0;
 	int mostThreads_ = 0;
+	std::atomic<int> steals_;
+
+	// Pixel area drawn per strip, spread evenly using a difference array, for this and the last frame.
+	int64_t loadDeltaX_[LOAD_BUCKETS + 1]{};
+	int64_t loadDeltaY_[LOAD_BUCKETS + 1]{};
+	int64_t lastLoadX_[LOAD_BUCKETS]{};
+	int64_t lastLoadY_[LOAD_BUCKETS]{};
 
 	void MarkPendingReads(const Rasterizer::RasterizerState &state);
 	void MarkPendingWrites(const Rasterizer::RasterizerState &state);
+	void UpdateHiZ();
+	void SubmitTriangleBatch();
+	void PushTriangle(const VertexData &v0, const VertexData &v1, const VertexData &v2, const BinCoords &range);
 	bool HasTextureWrite(const Rasterizer::RasterizerState &state);
 	static bool IsExactSelfRender(const Rasterizer::RasterizerState &state, const BinItem &item);
 	void OptimizePendingStates(uint16_t first, uint16_t last);
 	BinCoords Scissor(BinCoords range);
-	BinCoords Range(const VertexData &v0, const VertexData &v1, const VertexData &v2);
 	BinCoords Range(const VertexData &v0, const VertexData &v1);
 	BinCoords Range(const VertexData &v0);
 	void Expand(const BinCoords &range);
+	void AddLoad(const BinCoords &range);
+	void UpdateLoadStats();
+	static void SplitByLoad(std::vector<int> &edges, const int64_t *load, int start, int end, int count);
+
+	// Returns false if another thread is already drawing this bin.
+	bool DrawTaskItems(int index);
+	void StealTaskItems(int skipIndex);
 
 	friend class DrawBinItemsTask;
 };
@@ -46,6 +46,14 @@ void Shutdown() {
 	jitCache = nullptr;
 }
 
+void GetCompiledIDs(std::vector<PixelFuncID> &ids) {
+	jitCache->GetCompiledIDs(ids);
+}
+
+bool Precompile(const PixelFuncID &id) {
+	return jitCache->Precompile(id);
+}
+
 bool DescribeCodePtr(const u8 *ptr, std::string &name) {
 	if (!jitCache->IsInSpace(ptr)) {
 		return false;
@@ -334,6 +342,101 @@ bool CheckDepthTestPassed(GEComparison func, int x, int y, int stride, u16 z) {
 	return DepthTestPassed(func, x, y, stride, z);
 }
 
+Vec4<int> SOFTRAST_CALL CheckDepthTestPassed4(const Vec4<int> &mask, GEComparison func, int x, int y, int stride, Vec4<int> z) {
+	// Skip the depth buffer read if we're masked already.
+#if defined(_M_SSE)
+	__m128i result = SAFE_M128I(mask.ivec);
+	int maskbits = _mm_movemask_epi8(result);
+	if (maskbits >= 0xFFFF)
+		return mask;
+#else
+	Vec4<int> result = mask;
+	if (mask.x < 0 && mask.y < 0 && mask.z < 0 && mask.w < 0)
+		return result;
+#endif
+
+	// Read in the existing depth values.
+#if defined(_M_SSE)
+	// Tried using flags from maskbits to skip dwords... seemed neutral.
+	__m128i refz = _mm_cvtsi32_si128(*(u32 *)depthbuf.Get16Ptr(x, y, stride));
+	refz = _mm_unpacklo_epi32(refz, _mm_cvtsi32_si128(*(u32 *)depthbuf.Get16Ptr(x, y + 1, stride)));
+	refz = _mm_unpacklo_epi16(refz, _mm_setzero_si128());
+#else
+	Vec4<int> refz(depthbuf.Get16(x, y, stride), depthbuf.Get16(x + 1, y, stride), depthbuf.Get16(x, y + 1, stride), depthbuf.Get16(x + 1, y + 1, stride));
+#endif
+
+	switch (func) {
+	case GE_COMP_NEVER:
+#if defined(_M_SSE)
+		result = _mm_set1_epi32(-1);
+#else
+		result = Vec4<int>::AssignToAll(-1);
+#endif
+		break;
+
+	case GE_COMP_ALWAYS:
+		break;
+
+	case GE_COMP_EQUAL:
+#if defined(_M_SSE)
+		result = _mm_or_si128(result, _mm_xor_si128(_mm_cmpeq_epi32(z.ivec, refz), _mm_set1_epi32(-1)));
+#else
+		for (int i = 0; i < 4; ++i)
+			result[i] |= z[i] != refz[i] ? -1 : 0;
+#endif
+		break;
+
+	case GE_COMP_NOTEQUAL:
+#if defined(_M_SSE)
+		result = _mm_or_si128(result, _mm_cmpeq_epi32(z.ivec, refz));
+#else
+		for (int i = 0; i < 4; ++i)
+			result[i] |= z[i] == refz[i] ? -1 : 0;
+#endif
+		break;
+
+	case GE_COMP_LESS:
+#if defined(_M_SSE)
+		result = _mm_or_si128(result, _mm_cmpgt_epi32(z.ivec, refz));
+		result = _mm_or_si128(result, _mm_cmpeq_epi32(z.ivec, refz));
+#else
+		for (int i = 0; i < 4; ++i)
+			result[i] |= z[i] >= refz[i] ? -1 : 0;
+#endif
+		break;
+
+	case GE_COMP_LEQUAL:
+#if defined(_M_SSE)
+		result = _mm_or_si128(result, _mm_cmpgt_epi32(z.ivec, refz));
+#else
+		for (int i = 0; i < 4; ++i)
+			result[i] |= z[i] > refz[i] ? -1 : 0;
+#endif
+		break;
+
+	case GE_COMP_GREATER:
+#if defined(_M_SSE)
+		result = _mm_or_si128(result, _mm_cmplt_epi32(z.ivec, refz));
+		result = _mm_or_si128(result, _mm_cmpeq_epi32(z.ivec, refz));
+#else
+		for (int i = 0; i < 4; ++i)
+			result[i] |= z[i] <= refz[i] ? -1 : 0;
+#endif
+		break;
+
+	case GE_COMP_GEQUAL:
+#if defined(_M_SSE)
+		result = _mm_or_si128(result, _mm_cmplt_epi32(z.ivec, refz));
+#else
+		for (int i = 0; i < 4; ++i)
+			result[i] |= z[i] < refz[i] ? -1 : 0;
+#endif
+		break;
+	}
+
+	return result;
+}
+
 static inline u32 ApplyLogicOp(GELogicOp op, u32 old_color, u32 new_color) {
 	// All of the operations here intentionally preserve alpha/stencil.
 	switch (op) {
@@ -661,6 +764,63 @@ static Vec3<int> AlphaBlendingResult(const PixelFuncID &pixelID, const Vec4<int>
 	}
 }
 
+static inline void ApplyFog(const PixelFuncID &pixelID, Vec4<int> &prim_color, int fog) {
+	Vec3<int> fogColor = Vec3<int>::FromRGB(pixelID.cached.fogColor);
+	// This is very similar to the BLEND texfunc, and simply always rounds up.
+	static constexpr Vec3<int> roundup = Vec3<int>::AssignToAll(255);
+	fogColor = (prim_color.rgb() * fog + fogColor * (255 - fog) + roundup) / 256;
+	prim_color.r() = fogColor.r();
+	prim_color.g() = fogColor.g();
+	prim_color.b() = fogColor.b();
+}
+
+template <bool clearMode, GEBufferFormat fbFormat>
+static inline void BlendAndWriteColor(int x, int y, Vec4<int> prim_color, u8 stencil, uint32_t targetWriteMask, const PixelFuncID &pixelID) {
+	const u32 old_color = GetPixelColor(fbFormat, pixelID.cached.framebufStride, x, y);
+	u32 new_color;
+
+	// Dithering happens before the logic op and regardless of framebuffer format or clear mode.
+	// We do it while alpha blending because it happens before clamping.
+	if (pixelID.alphaBlend && !clearMode) {
+		const Vec4<int> dst = Vec4<int>::FromRGBA(old_color);
+		Vec3<int> blended = AlphaBlendingResult(pixelID, prim_color, dst);
+		if (pixelID.dithering) {
+			blended += Vec3<int>::AssignToAll(pixelID.cached.ditherMatrix[(y & 3) * 4 + (x & 3)]);
+		}
+
+		// ToRGB() always automatically clamps.
+		new_color = blended.ToRGB();
+		new_color |= stencil << 24;
+	} else {
+		if (pixelID.dithering) {
+			// We'll discard alpha anyway.
+			prim_color += Vec4<int>::AssignToAll(pixelID.cached.ditherMatrix[(y & 3) * 4 + (x & 3)]);
+		}
+
+#if defined(_M_SSE) || PPSSPP_ARCH(ARM64_NEON)
+		new_color = Vec3<int>(prim_color.ivec).ToRGB();
+		new_color |= stencil << 24;
+#else
+		new_color = Vec4<int>(prim_color.r(), prim_color.g(), prim_color.b(), stencil).ToRGBA();
+#endif
+	}
+
+	// Logic ops are applied after blending (if blending is enabled.)
+	if (pixelID.applyLogicOp && !clearMode) {
+		// Logic ops don't affect stencil, which happens inside ApplyLogicOp.
+		new_color = ApplyLogicOp(pixelID.cached.logicOp, old_color, new_color);
+	}
+
+	if (clearMode) {
+		if (!pixelID.ColorClear())
+			new_color = (new_color & 0xFF000000) | (old_color & 0x00FFFFFF);
+		if (!pixelID.StencilClear())
+			new_color = (new_color & 0x00FFFFFF) | (old_color & 0xFF000000);
+	}
+
+	SetPixelColor(fbFormat, pixelID.cached.framebufStride, x, y, new_color, old_color, targetWriteMask);
+}
+
 template <bool clearMode, GEBufferFormat fbFormat>
 void SOFTRAST_CALL DrawSinglePixel(int x, int y, int z, int fog, Vec4IntArg color_in, const PixelFuncID &pixelID) {
 	Vec4<int> prim_color = Vec4<int>(color_in).Clamp(0, 255);
@@ -674,15 +834,8 @@ void SOFTRAST_CALL DrawSinglePixel(int x, int y, int z, int fog, Vec4IntArg colo
 			return;
 
 	// Fog is applied prior to color test.
-	if (pixelID.applyFog && !clearMode) {
-		Vec3<int> fogColor = Vec3<int>::FromRGB(pixelID.cached.fogColor);
-		// This is very similar to the BLEND texfunc, and simply always rounds up.
-		static constexpr Vec3<int> roundup = Vec3<int>::AssignToAll(255);
-		fogColor = (prim_color.rgb() * fog + fogColor * (255 - fog) + roundup) / 256;
-		prim_color.r() = fogColor.r();
-		prim_color.g() = fogColor.g();
-		prim_color.b() = fogColor.b();
-	}
+	if (pixelID.applyFog && !clearMode)
+		ApplyFog(pixelID, prim_color, fog);
 
 	if (pixelID.colorTest && !clearMode)
 		if (!ColorTestPassed(pixelID, prim_color.rgb()))
@@ -719,49 +872,80 @@ void SOFTRAST_CALL DrawSinglePixel(int x, int y, int z, int fog, Vec4IntArg colo
 	if (pixelID.depthWrite && !clearMode)
 		SetPixelDepth(x, y, pixelID.cached.depthbufStride, z);
 
-	const u32 old_color = GetPixelColor(fbFormat, pixelID.cached.framebufStride, x, y);
-	u32 new_color;
-
-	// Dithering happens before the logic op and regardless of framebuffer format or clear mode.
-	// We do it while alpha blending because it happens before clamping.
-	if (pixelID.alphaBlend && !clearMode) {
-		const Vec4<int> dst = Vec4<int>::FromRGBA(old_color);
-		Vec3<int> blended = AlphaBlendingResult(pixelID, prim_color, dst);
-		if (pixelID.dithering) {
-			blended += Vec3<int>::AssignToAll(pixelID.cached.ditherMatrix[(y & 3) * 4 + (x & 3)]);
-		}
+	BlendAndWriteColor<clearMode, fbFormat>(x, y, prim_color, stencil, targetWriteMask, pixelID);
+}
 
-		// ToRGB() always automatically clamps.
-		new_color = blended.ToRGB();
-		new_color |= stencil << 24;
-	} else {
-		if (pixelID.dithering) {
-			// We'll discard alpha anyway.
-			prim_color += Vec4<int>::AssignToAll(pixelID.cached.ditherMatrix[(y & 3) * 4 + (x & 3)]);
+template <bool clearMode, GEBufferFormat fbFormat>
+void SOFTRAST_CALL DrawQuadPixels(int x, int y, Vec4IntArg z_in, Vec4IntArg fog_in, const Vec4<int> *colors, Vec4IntArg mask_in, const PixelFuncID &pixelID) {
+	const Vec4<int> z = Vec4<int>(z_in);
+	const Vec4<int> fog = Vec4<int>(fog_in);
+	Vec4<int> mask = Vec4<int>(mask_in);
+
+	// Stencil ops write even when tests fail, so let the single pixel path deal with those.
+	if (pixelID.stencilTest && !clearMode) {
+		for (int i = 0; i < 4; ++i) {
+			if (mask[i] >= 0)
+				DrawSinglePixel<clearMode, fbFormat>(x + (i & 1), y + (i / 2), z[i], fog[i], ToVec4IntArg(colors[i]), pixelID);
 		}
+		return;
+	}
 
-#if defined(_M_SSE) || PPSSPP_ARCH(ARM64_NEON)
-		new_color = Vec3<int>(prim_color.ivec).ToRGB();
-		new_color |= stencil << 24;
+	if (pixelID.applyDepthRange && !pixelID.earlyZChecks) {
+		const Vec4<int> minz = Vec4<int>::AssignToAll(pixelID.cached.minz);
+		const Vec4<int> maxz = Vec4<int>::AssignToAll(pixelID.cached.maxz);
+#if defined(_M_SSE)
+		mask.ivec = _mm_or_si128(mask.ivec, _mm_or_si128(_mm_cmplt_epi32(z.ivec, minz.ivec), _mm_cmpgt_epi32(z.ivec, maxz.ivec)));
+#elif PPSSPP_ARCH(ARM64_NEON)
+		uint32x4_t outside = vorrq_u32(vcltq_s32(z.ivec, minz.ivec), vcgtq_s32(z.ivec, maxz.ivec));
+		mask.ivec = vorrq_s32(mask.ivec, vreinterpretq_s32_u32(outside));
 #else
-		new_color = Vec4<int>(prim_color.r(), prim_color.g(), prim_color.b(), stencil).ToRGBA();
+		for (int i = 0; i < 4; ++i)
+			mask[i] |= z[i] < minz[i] || z[i] > maxz[i] ? -1 : 0;
 #endif
 	}
 
-	// Logic ops are applied after blending (if blending is enabled.)
-	if (pixelID.applyLogicOp && !clearMode) {
-		// Logic ops don't affect stencil, which happens inside ApplyLogicOp.
-		new_color = ApplyLogicOp(pixelID.cached.logicOp, old_color, new_color);
-	}
+	Vec4<int> prim_color[4];
+	for (int i = 0; i < 4; ++i) {
+		if (mask[i] < 0)
+			continue;
+		prim_color[i] = colors[i].Clamp(0, 255);
 
-	if (clearMode) {
-		if (!pixelID.ColorClear())
-			new_color = (new_color & 0xFF000000) | (old_color & 0x00FFFFFF);
-		if (!pixelID.StencilClear())
-			new_color = (new_color & 0x00FFFFFF) | (old_color & 0xFF000000);
+		if (pixelID.AlphaTestFunc() != GE_COMP_ALWAYS && !clearMode) {
+			if (!AlphaTestPassed(pixelID, prim_color[i].a())) {
+				mask[i] = -1;
+				continue;
+			}
+		}
+
+		// Fog is applied prior to color test.
+		if (pixelID.applyFog && !clearMode)
+			ApplyFog(pixelID, prim_color[i], fog[i]);
+
+		if (pixelID.colorTest && !clearMode) {
+			if (!ColorTestPassed(pixelID, prim_color[i].rgb()))
+				mask[i] = -1;
+		}
 	}
 
-	SetPixelColor(fbFormat, pixelID.cached.framebufStride, x, y, new_color, old_color, targetWriteMask);
+	// All four lanes are compared at once, and this skips the read if they're all masked already.
+	if (!clearMode && !pixelID.earlyZChecks && pixelID.DepthTestFunc() != GE_COMP_ALWAYS)
+		mask = CheckDepthTestPassed4(mask, pixelID.DepthTestFunc(), x, y, pixelID.cached.depthbufStride, z);
+
+	const bool writeDepth = clearMode ? pixelID.DepthClear() : pixelID.depthWrite;
+	uint32_t targetWriteMask = pixelID.applyColorWriteMask ? pixelID.cached.colorWriteMask : 0;
+	for (int i = 0; i < 4; ++i) {
+		if (mask[i] < 0)
+			continue;
+
+		const int px = x + (i & 1);
+		const int py = y + (i / 2);
+		if (writeDepth)
+			SetPixelDepth(px, py, pixelID.cached.depthbufStride, z[i]);
+
+		// In clear mode, it uses the alpha color as stencil.
+		u8 stencil = clearMode ? prim_color[i].a() : GetPixelStencil(fbFormat, pixelID.cached.framebufStride, px, py);
+		BlendAndWriteColor<clearMode, fbFormat>(px, py, prim_color[i], stencil, targetWriteMask, pixelID);
+	}
 }
 
 SingleFunc GetSingleFunc(const PixelFuncID &id, BinManager *binner) {
@@ -773,6 +957,12 @@ SingleFunc GetSingleFunc(const PixelFuncID &id, BinManager *binner) {
 	return jitCache->GenericSingle(id);
 }
 
+QuadFunc GetQuadFunc(const PixelFuncID &id, SingleFunc single) {
+	if (single != PixelJitCache::GenericSingle(id))
+		return nullptr;
+	return PixelJitCache::GenericQuad(id);
+}
+
 SingleFunc PixelJitCache::GenericSingle(const PixelFuncID &id) {
 	if (id.clearMode) {
 		switch (id.fbFormat) {
@@ -800,6 +990,33 @@ SingleFunc PixelJitCache::GenericSingle(const PixelFuncID &id) {
 	return nullptr;
 }
 
+QuadFunc PixelJitCache::GenericQuad(const PixelFuncID &id) {
+	if (id.clearMode) {
+		switch (id.fbFormat) {
+		case GE_FORMAT_565:
+			return &DrawQuadPixels<true, GE_FORMAT_565>;
+		case GE_FORMAT_5551:
+			return &DrawQuadPixels<true, GE_FORMAT_5551>;
+		case GE_FORMAT_4444:
+			return &DrawQuadPixels<true, GE_FORMAT_4444>;
+		case GE_FORMAT_8888:
+			return &DrawQuadPixels<true, GE_FORMAT_8888>;
+		}
+	}
+	switch (id.fbFormat) {
+	case GE_FORMAT_565:
+		return &DrawQuadPixels<false, GE_FORMAT_565>;
+	case GE_FORMAT_5551:
+		return &DrawQuadPixels<false, GE_FORMAT_5551>;
+	case GE_FORMAT_4444:
+		return &DrawQuadPixels<false, GE_FORMAT_4444>;
+	case GE_FORMAT_8888:
+		return &DrawQuadPixels<false, GE_FORMAT_8888>;
+	}
+	_assert_(false);
+	return nullptr;
+}
+
 thread_local PixelJitCache::LastCache PixelJitCache::lastSingle_;
 int PixelJitCache::clearGen_ = 0;
 
@@ -849,6 +1066,30 @@ void PixelJitCache::Flush() {
 	compileQueue_.clear();
 }
 
+void PixelJitCache::GetCompiledIDs(std::vector<PixelFuncID> &ids) {
+	std::unique_lock<std::mutex> guard(jitCacheLock);
+	ids.reserve(ids.size() + addresses_.size());
+	for (const auto &it : addresses_)
+		ids.push_back(it.first);
+}
+
+bool PixelJitCache::Precompile(const PixelFuncID &id) {
+#if (PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(ARM64_NEON)) && !PPSSPP_PLATFORM(UWP)
+	if (!g_Config.bSoftwareRenderingJit)
+		return false;
+
+	std::unique_lock<std::mutex> guard(jitCacheLock);
+	// Compile() clears when space runs low, which isn't safe while drawing.  Leave room for new funcs too.
+	if (GetSpaceLeft() < 65536 * 2)
+		return false;
+	if (!cache_.ContainsKey(std::hash<PixelFuncID>()(id)))
+		Compile(id);
+	return true;
+#else
+	return false;
+#endif
+}
+
 SingleFunc PixelJitCache::GetSingle(const PixelFuncID &id, BinManager *binner) {
 	if (!g_Config.bSoftwareRenderingJit)
 		return nullptr;
@@ -900,7 +1141,7 @@ void PixelJitCache::Compile(const PixelFuncID &id) {
 		Clear();
 	}
 
-#if PPSSPP_ARCH(AMD64) && !PPSSPP_PLATFORM(UWP)
+#if (PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(ARM64_NEON)) && !PPSSPP_PLATFORM(UWP)
 	addresses_[id] = GetCodePointer();
 	SingleFunc func = CompileSingle(id);
 	cache_.Insert(std::hash<PixelFuncID>()(id), func);
@@ -41,12 +41,23 @@ namespace Rasterizer {
 
 typedef void (SOFTRAST_CALL *SingleFunc)(int x, int y, int z, int fog, Vec4IntArg color_in, const PixelFuncID &pixelID);
 SingleFunc GetSingleFunc(const PixelFuncID &id, BinManager *binner);
+// Draws a 2x2 quad (lanes are x, x+1, then the same on y+1.)  Lanes with a negative mask are skipped.
+typedef void (SOFTRAST_CALL *QuadFunc)(int x, int y, Vec4IntArg z, Vec4IntArg fog, const Math3D::Vec4<int> *colors, Vec4IntArg mask, const PixelFuncID &pixelID);
+// Returns nullptr if single is jitted, since calling it per pixel will be faster.
+QuadFunc GetQuadFunc(const PixelFuncID &id, SingleFunc single);
 
 void Init();
 void FlushJit();
 void Shutdown();
 
+// Lists what's been compiled, so the next run can compile it ahead of time.
+void GetCompiledIDs(std::vector<PixelFuncID> &ids);
+// Compiles now if there's room, returns false if not.  Unsafe with draws in flight on W^X platforms.
+bool Precompile(const PixelFuncID &id);
+
 bool CheckDepthTestPassed(GEComparison func, int x, int y, int stride, u16 z);
+// Same as above for a 2x2 quad, but returns a mask (negative for failed lanes.)
+Math3D::Vec4<int> SOFTRAST_CALL CheckDepthTestPassed4(const Math3D::Vec4<int> &mask, GEComparison func, int x, int y, int stride, Math3D::Vec4<int> z);
 
 bool DescribeCodePtr(const u8 *ptr, std::string &name);
 
@@ -67,9 +78,13 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	// Returns a pointer to the code to run.
 	SingleFunc GetSingle(const PixelFuncID &id, BinManager *binner);
 	static SingleFunc GenericSingle(const PixelFuncID &id);
+	static QuadFunc GenericQuad(const PixelFuncID &id);
 	void Clear() override;
 	void Flush();
 
+	void GetCompiledIDs(std::vector<PixelFuncID> &ids);
+	bool Precompile(const PixelFuncID &id);
+
 	std::string DescribeCodePtr(const u8 *ptr) override;
 
 private:
@@ -144,6 +159,14 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	std::vector<Gen::FixupBranch> skipStandardWrites_;
 	int stackIDOffset_ = 0;
 	bool colorIs16Bit_ = false;
+#elif PPSSPP_ARCH(ARM64_NEON)
+	void Discard();
+	void Discard(CCFlags cc);
+
+	// Used for any test failure.
+	std::vector<Arm64Gen::FixupBranch> discards_;
+	// Set while the color is expanded to 32-bit lanes for blending, before clamping.
+	bool colorIs32Bit_ = false;
 #endif
 };
 
@@ -0,0 +1,1282 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+
+#if PPSSPP_ARCH(ARM64_NEON)
+
+#include "Common/Arm64Emitter.h"
+#include "Common/LogReporting.h"
+#include "GPU/GPUState.h"
+#include "GPU/Software/DrawPixel.h"
+#include "GPU/Software/SoftGpu.h"
+#include "GPU/ge_constants.h"
+
+using namespace Arm64Gen;
+
+namespace Rasterizer {
+
+SingleFunc PixelJitCache::CompileSingle(const PixelFuncID &id) {
+	// Stencil testing and logic ops aren't implemented here yet, so those use the generic path.
+	if (id.applyLogicOp || (id.stencilTest && !id.clearMode))
+		return nullptr;
+
+	// Setup the reg cache and disallow spill for arguments.
+	regCache_.SetupABI({
+		RegCache::GEN_ARG_X,
+		RegCache::GEN_ARG_Y,
+		RegCache::GEN_ARG_Z,
+		RegCache::GEN_ARG_FOG,
+		RegCache::VEC_ARG_COLOR,
+		RegCache::GEN_ARG_ID,
+	});
+
+	const u8 *resetPos = GetCodePointer();
+	bool success = true;
+
+	// We have plenty of caller saved regs, so nothing needs to be saved.
+	_assert_(regCache_.Has(RegCache::GEN_ARG_ID));
+	WriteProlog(0, {}, {});
+
+	// Start with the depth range.
+	success = success && Jit_ApplyDepthRange(id);
+
+	// Next, let's clamp the color (might affect alpha test, and everything expects it clamped.)
+	// We simply narrow to 4x8-bit with saturation.  Everything else expects color in this format.
+	Describe("ClampColor");
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	fp.SQXTUN(16, argColorReg, argColorReg);
+	fp.UQXTN(8, argColorReg, argColorReg);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	colorIs32Bit_ = false;
+
+	success = success && Jit_AlphaTest(id);
+	// Fog is applied prior to color test.  Maybe before alpha test too, but it doesn't affect it...
+	success = success && Jit_ApplyFog(id);
+	success = success && Jit_ColorTest(id);
+
+	if (!id.clearMode)
+		success = success && Jit_DepthTest(id);
+	success = success && Jit_WriteDepth(id);
+
+	success = success && Jit_AlphaBlend(id);
+	success = success && Jit_Dither(id);
+	success = success && Jit_WriteColor(id);
+
+	for (auto &fixup : discards_) {
+		SetJumpTarget(fixup);
+	}
+	discards_.clear();
+
+	// Anything else still retained, we're done with now.
+	static const RegCache::Purpose retained[] = {
+		RegCache::GEN_ARG_X,
+		RegCache::GEN_ARG_Y,
+		RegCache::GEN_ARG_Z,
+		RegCache::GEN_ARG_FOG,
+		RegCache::VEC_ARG_COLOR,
+		RegCache::GEN_ARG_ID,
+		RegCache::GEN_COLOR_OFF,
+		RegCache::GEN_DEPTH_OFF,
+	};
+	for (RegCache::Purpose p : retained) {
+		if (regCache_.Has(p))
+			regCache_.ForceRelease(p);
+	}
+
+	if (!success) {
+		ERROR_LOG_REPORT(Log::G3D, "Could not compile pixel func: %s", DescribePixelFuncID(id).c_str());
+
+		regCache_.Reset(false);
+		EndWrite();
+		ResetCodePtr(GetOffset(resetPos));
+		return nullptr;
+	}
+
+	const u8 *start = WriteFinalizedEpilog();
+	regCache_.Reset(true);
+	return (SingleFunc)start;
+}
+
+RegCache::Reg PixelJitCache::GetPixelID() {
+	// With 8 arg regs, the ID is always in a register.
+	return regCache_.Find(RegCache::GEN_ARG_ID);
+}
+
+void PixelJitCache::UnlockPixelID(RegCache::Reg &r) {
+	regCache_.Unlock(r, RegCache::GEN_ARG_ID);
+}
+
+RegCache::Reg PixelJitCache::GetColorOff(const PixelFuncID &id) {
+	if (!regCache_.Has(RegCache::GEN_COLOR_OFF)) {
+		Describe("GetColorOff");
+		if (id.useStandardStride && !id.dithering) {
+			bool loadDepthOff = id.depthWrite || (id.DepthTestFunc() != GE_COMP_ALWAYS && !id.earlyZChecks);
+			ARM64Reg argYReg = regCache_.Find(RegCache::GEN_ARG_Y);
+			ARM64Reg argXReg = regCache_.Find(RegCache::GEN_ARG_X);
+
+			// In this mode, we force argXReg to the off, and throw away argYReg.
+			// Writing the 32-bit reg also clears the top bits, which may be garbage.
+			ADD(DecodeReg(argXReg), DecodeReg(argXReg), DecodeReg(argYReg), ArithOption(DecodeReg(argYReg), ST_LSL, 9));
+
+			// Now add the pointer for the color buffer.
+			MOVP2R(argYReg, &fb.data);
+			if (loadDepthOff) {
+				ARM64Reg depthTemp = regCache_.Alloc(RegCache::GEN_TEMP_HELPER);
+				MOVP2R(depthTemp, &depthbuf.data);
+				LDR(INDEX_UNSIGNED, depthTemp, depthTemp, 0);
+				LDR(INDEX_UNSIGNED, argYReg, argYReg, 0);
+				ADD(argYReg, argYReg, argXReg, ArithOption(argXReg, ST_LSL, id.FBFormat() == GE_FORMAT_8888 ? 2 : 1));
+
+				// Depth is always 16-bit, so we can just reuse argXReg for the depth offset.
+				ADD(argXReg, depthTemp, argXReg, ArithOption(argXReg, ST_LSL, 1));
+				regCache_.Release(depthTemp, RegCache::GEN_TEMP_HELPER);
+			} else {
+				LDR(INDEX_UNSIGNED, argYReg, argYReg, 0);
+				ADD(argYReg, argYReg, argXReg, ArithOption(argXReg, ST_LSL, id.FBFormat() == GE_FORMAT_8888 ? 2 : 1));
+			}
+
+			// With that, argYOff is now GEN_COLOR_OFF.
+			regCache_.Unlock(argYReg, RegCache::GEN_ARG_Y);
+			regCache_.Change(RegCache::GEN_ARG_Y, RegCache::GEN_COLOR_OFF);
+			// Retain it, because we can't recalculate this.
+			regCache_.ForceRetain(RegCache::GEN_COLOR_OFF);
+
+			// Same deal for the depth offset, unless we won't need it at all.
+			regCache_.Unlock(argXReg, RegCache::GEN_ARG_X);
+			if (loadDepthOff) {
+				regCache_.Change(RegCache::GEN_ARG_X, RegCache::GEN_DEPTH_OFF);
+				regCache_.ForceRetain(RegCache::GEN_DEPTH_OFF);
+			} else {
+				regCache_.ForceRelease(RegCache::GEN_ARG_X);
+			}
+
+			return regCache_.Find(RegCache::GEN_COLOR_OFF);
+		}
+
+		ARM64Reg argYReg = regCache_.Find(RegCache::GEN_ARG_Y);
+		ARM64Reg argXReg = regCache_.Find(RegCache::GEN_ARG_X);
+		ARM64Reg r = regCache_.Alloc(RegCache::GEN_COLOR_OFF);
+		if (id.useStandardStride) {
+			ADD(DecodeReg(r), DecodeReg(argXReg), DecodeReg(argYReg), ArithOption(DecodeReg(argYReg), ST_LSL, 9));
+		} else {
+			ARM64Reg idReg = GetPixelID();
+			LDRH(INDEX_UNSIGNED, DecodeReg(r), idReg, offsetof(PixelFuncID, cached.framebufStride));
+			UnlockPixelID(idReg);
+
+			MADD(DecodeReg(r), DecodeReg(r), DecodeReg(argYReg), DecodeReg(argXReg));
+		}
+		regCache_.Unlock(argYReg, RegCache::GEN_ARG_Y);
+		regCache_.Unlock(argXReg, RegCache::GEN_ARG_X);
+
+		ARM64Reg temp = regCache_.Alloc(RegCache::GEN_TEMP_HELPER);
+		MOVP2R(temp, &fb.data);
+		LDR(INDEX_UNSIGNED, temp, temp, 0);
+		ADD(r, temp, r, ArithOption(r, ST_LSL, id.FBFormat() == GE_FORMAT_8888 ? 2 : 1));
+		regCache_.Release(temp, RegCache::GEN_TEMP_HELPER);
+
+		return r;
+	}
+	return regCache_.Find(RegCache::GEN_COLOR_OFF);
+}
+
+RegCache::Reg PixelJitCache::GetDepthOff(const PixelFuncID &id) {
+	if (!regCache_.Has(RegCache::GEN_DEPTH_OFF)) {
+		// If both color and depth use 512, the offsets are the same.
+		if (id.useStandardStride && !id.dithering) {
+			// Calculate once inside GetColorOff().
+			ARM64Reg colorOffReg = GetColorOff(id);
+			regCache_.Unlock(colorOffReg, RegCache::GEN_COLOR_OFF);
+			return regCache_.Find(RegCache::GEN_DEPTH_OFF);
+		}
+
+		Describe("GetDepthOff");
+		ARM64Reg argYReg = regCache_.Find(RegCache::GEN_ARG_Y);
+		ARM64Reg argXReg = regCache_.Find(RegCache::GEN_ARG_X);
+		ARM64Reg r = regCache_.Alloc(RegCache::GEN_DEPTH_OFF);
+		if (id.useStandardStride) {
+			ADD(DecodeReg(r), DecodeReg(argXReg), DecodeReg(argYReg), ArithOption(DecodeReg(argYReg), ST_LSL, 9));
+		} else {
+			ARM64Reg idReg = GetPixelID();
+			LDRH(INDEX_UNSIGNED, DecodeReg(r), idReg, offsetof(PixelFuncID, cached.depthbufStride));
+			UnlockPixelID(idReg);
+
+			MADD(DecodeReg(r), DecodeReg(r), DecodeReg(argYReg), DecodeReg(argXReg));
+		}
+		regCache_.Unlock(argYReg, RegCache::GEN_ARG_Y);
+		regCache_.Unlock(argXReg, RegCache::GEN_ARG_X);
+
+		ARM64Reg temp = regCache_.Alloc(RegCache::GEN_TEMP_HELPER);
+		MOVP2R(temp, &depthbuf.data);
+		LDR(INDEX_UNSIGNED, temp, temp, 0);
+		ADD(r, temp, r, ArithOption(r, ST_LSL, 1));
+		regCache_.Release(temp, RegCache::GEN_TEMP_HELPER);
+
+		return r;
+	}
+	return regCache_.Find(RegCache::GEN_DEPTH_OFF);
+}
+
+RegCache::Reg PixelJitCache::GetDestStencil(const PixelFuncID &id) {
+	// Stencil tests use the generic path for now, see CompileSingle().
+	_assert_msg_(false, "Not yet implemented");
+	return INVALID_REG;
+}
+
+void PixelJitCache::Discard() {
+	discards_.push_back(B());
+}
+
+void PixelJitCache::Discard(CCFlags cc) {
+	discards_.push_back(B(cc));
+}
+
+void PixelJitCache::WriteConstantPool(const PixelFuncID &id) {
+	// Blend factors are applied at 32-bit, using immediates, so there's nothing to pool.
+}
+
+bool PixelJitCache::Jit_ApplyDepthRange(const PixelFuncID &id) {
+	if (id.applyDepthRange && !id.earlyZChecks) {
+		Describe("ApplyDepthR");
+		ARM64Reg argZReg = regCache_.Find(RegCache::GEN_ARG_Z);
+		ARM64Reg idReg = GetPixelID();
+		ARM64Reg rangeReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+
+		// We expanded this to 32 bits, so it's convenient to compare.
+		LDR(INDEX_UNSIGNED, DecodeReg(rangeReg), idReg, offsetof(PixelFuncID, cached.minz));
+		CMP(DecodeReg(argZReg), DecodeReg(rangeReg));
+		Discard(CC_LT);
+
+		// We load the low 16 bits, but compare all 32 of z.  Above handles < 0.
+		LDR(INDEX_UNSIGNED, DecodeReg(rangeReg), idReg, offsetof(PixelFuncID, cached.maxz));
+		CMP(DecodeReg(argZReg), DecodeReg(rangeReg));
+		Discard(CC_GT);
+
+		regCache_.Release(rangeReg, RegCache::GEN_TEMP0);
+		UnlockPixelID(idReg);
+		regCache_.Unlock(argZReg, RegCache::GEN_ARG_Z);
+	}
+
+	// Since this is early on, try to free up the z reg if we don't need it anymore.
+	if (id.clearMode && !id.DepthClear())
+		regCache_.ForceRelease(RegCache::GEN_ARG_Z);
+	else if (!id.clearMode && !id.depthWrite && (id.DepthTestFunc() == GE_COMP_ALWAYS || id.earlyZChecks))
+		regCache_.ForceRelease(RegCache::GEN_ARG_Z);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_AlphaTest(const PixelFuncID &id) {
+	// Take care of ALWAYS/NEVER first.  ALWAYS is common, means disabled.
+	Describe("AlphaTest");
+	switch (id.AlphaTestFunc()) {
+	case GE_COMP_NEVER:
+		Discard();
+		return true;
+
+	case GE_COMP_ALWAYS:
+		return true;
+
+	default:
+		break;
+	}
+
+	// Load alpha into its own general reg.
+	ARM64Reg alphaReg;
+	if (regCache_.Has(RegCache::GEN_SRC_ALPHA)) {
+		alphaReg = regCache_.Find(RegCache::GEN_SRC_ALPHA);
+	} else {
+		alphaReg = regCache_.Alloc(RegCache::GEN_SRC_ALPHA);
+		_assert_(!colorIs32Bit_);
+		ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+		fp.UMOV(8, DecodeReg(alphaReg), argColorReg, 3);
+		regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	}
+
+	if (id.hasAlphaTestMask) {
+		// Note: we leave the ALPHA purpose untouched and free it, because later code may reuse.
+		ARM64Reg idReg = GetPixelID();
+		ARM64Reg maskedReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+
+		LDRB(INDEX_UNSIGNED, DecodeReg(maskedReg), idReg, offsetof(PixelFuncID, cached.alphaTestMask));
+		UnlockPixelID(idReg);
+		AND(DecodeReg(maskedReg), DecodeReg(maskedReg), DecodeReg(alphaReg));
+		regCache_.Unlock(alphaReg, RegCache::GEN_SRC_ALPHA);
+
+		// Okay now do the rest using the masked reg, which we modified.
+		alphaReg = maskedReg;
+	}
+
+	// We hardcode the ref into this jit func.
+	CMP(DecodeReg(alphaReg), id.alphaTestRef);
+	if (id.hasAlphaTestMask)
+		regCache_.Release(alphaReg, RegCache::GEN_TEMP0);
+	else
+		regCache_.Unlock(alphaReg, RegCache::GEN_SRC_ALPHA);
+
+	switch (id.AlphaTestFunc()) {
+	case GE_COMP_NEVER:
+	case GE_COMP_ALWAYS:
+		break;
+
+	case GE_COMP_EQUAL:
+		Discard(CC_NEQ);
+		break;
+
+	case GE_COMP_NOTEQUAL:
+		Discard(CC_EQ);
+		break;
+
+	case GE_COMP_LESS:
+		Discard(CC_HS);
+		break;
+
+	case GE_COMP_LEQUAL:
+		Discard(CC_HI);
+		break;
+
+	case GE_COMP_GREATER:
+		Discard(CC_LS);
+		break;
+
+	case GE_COMP_GEQUAL:
+		Discard(CC_LO);
+		break;
+	}
+
+	return true;
+}
+
+bool PixelJitCache::Jit_ColorTest(const PixelFuncID &id) {
+	if (!id.colorTest || id.clearMode)
+		return true;
+
+	Describe("ColorTest");
+	ARM64Reg idReg = GetPixelID();
+	ARM64Reg funcReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+	ARM64Reg maskReg = regCache_.Alloc(RegCache::GEN_TEMP1);
+	ARM64Reg refReg = regCache_.Alloc(RegCache::GEN_TEMP2);
+
+	// First, load the registers: mask and ref.  These aren't aligned.
+	LDUR(DecodeReg(maskReg), idReg, offsetof(PixelFuncID, cached.colorTestMask));
+	LDUR(DecodeReg(refReg), idReg, offsetof(PixelFuncID, cached.colorTestRef));
+
+	// Temporarily abuse funcReg to grab the color, and mask it.
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	_assert_(!colorIs32Bit_);
+	fp.FMOV(DecodeReg(funcReg), EncodeRegToSingle(argColorReg));
+	AND(DecodeReg(maskReg), DecodeReg(maskReg), DecodeReg(funcReg));
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	// Now that we're setup, get the func and follow it.
+	LDRB(INDEX_UNSIGNED, DecodeReg(funcReg), idReg, offsetof(PixelFuncID, cached.colorTestFunc));
+	UnlockPixelID(idReg);
+
+	CMP(DecodeReg(funcReg), GE_COMP_ALWAYS);
+	// Discard for GE_COMP_NEVER...
+	Discard(CC_LO);
+	FixupBranch skip = B(CC_EQ);
+
+	CMP(DecodeReg(funcReg), GE_COMP_EQUAL);
+	FixupBranch doEqual = B(CC_EQ);
+	CMP(DecodeReg(funcReg), GE_COMP_NOTEQUAL);
+	// Any other func always passes.
+	FixupBranch skip2 = B(CC_NEQ);
+	regCache_.Release(funcReg, RegCache::GEN_TEMP0);
+
+	// The not equal path here... if they are equal, we discard.
+	CMP(DecodeReg(refReg), DecodeReg(maskReg));
+	Discard(CC_EQ);
+	FixupBranch skip3 = B();
+
+	SetJumpTarget(doEqual);
+	CMP(DecodeReg(refReg), DecodeReg(maskReg));
+	Discard(CC_NEQ);
+
+	regCache_.Release(maskReg, RegCache::GEN_TEMP1);
+	regCache_.Release(refReg, RegCache::GEN_TEMP2);
+
+	SetJumpTarget(skip);
+	SetJumpTarget(skip2);
+	SetJumpTarget(skip3);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_ApplyFog(const PixelFuncID &id) {
+	if (!id.applyFog) {
+		// Okay, anyone can use the fog register then.
+		regCache_.ForceRelease(RegCache::GEN_ARG_FOG);
+		return true;
+	}
+
+	// Load fog color and expand to 16 bit.  The high lane matches up with A, and is ignored.
+	Describe("ApplyFog");
+	ARM64Reg fogColorReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+	ARM64Reg idReg = GetPixelID();
+	fp.LDR(32, INDEX_UNSIGNED, EncodeRegToSingle(fogColorReg), idReg, offsetof(PixelFuncID, cached.fogColor));
+	UnlockPixelID(idReg);
+	fp.UXTL(8, fogColorReg, fogColorReg);
+
+	// Broadcast the fog value at 16 bit, and load some 255s for later.
+	ARM64Reg fogMultReg = regCache_.Alloc(RegCache::VEC_TEMP2);
+	ARM64Reg invertReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+	ARM64Reg argFogReg = regCache_.Find(RegCache::GEN_ARG_FOG);
+	fp.DUP(16, fogMultReg, DecodeReg(argFogReg));
+	fp.MOVI(16, invertReg, 0xFF);
+	regCache_.Unlock(argFogReg, RegCache::GEN_ARG_FOG);
+	// We can free up the actual fog reg now.
+	regCache_.ForceRelease(RegCache::GEN_ARG_FOG);
+
+	// Expand (we clamped) color to 16 bit as well, so we can multiply with fog.
+	// We work on a copy, so the original A is kept as-is in argColorReg.
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	ARM64Reg colorReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	_assert_(!colorIs32Bit_);
+	fp.UXTL(8, colorReg, argColorReg);
+
+	// Our goal here is to calculate this formula:
+	// (argColor * fog + fogColor * (255 - fog) + 255) / 256
+
+	// Now we multiply the existing color by fog...
+	fp.MUL(16, colorReg, colorReg, fogMultReg);
+	// Before inversing, let's add that 255 we loaded in as well, since we have it.
+	fp.ADD(16, colorReg, colorReg, invertReg);
+	// And then inverse the fog value using those 255s, and multiply by fog color.
+	fp.SUB(16, invertReg, invertReg, fogMultReg);
+	fp.MUL(16, fogColorReg, fogColorReg, invertReg);
+	// At this point, colorReg and fogColorReg are multiplied at 16-bit, so we need to sum.
+	fp.ADD(16, colorReg, colorReg, fogColorReg);
+	regCache_.Release(fogColorReg, RegCache::VEC_TEMP1);
+	regCache_.Release(fogMultReg, RegCache::VEC_TEMP2);
+	regCache_.Release(invertReg, RegCache::VEC_TEMP3);
+
+	// Now we simply divide by 256 while narrowing back to 8 bit.
+	fp.SHRN(8, colorReg, colorReg, 8);
+
+	// Okay, copy back only RGB, leaving A alone.
+	fp.INS(16, argColorReg, 0, colorReg, 0);
+	fp.INS(8, argColorReg, 2, colorReg, 2);
+	regCache_.Release(colorReg, RegCache::VEC_TEMP0);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_StencilAndDepthTest(const PixelFuncID &id) {
+	_assert_msg_(false, "Not yet implemented");
+	return false;
+}
+
+bool PixelJitCache::Jit_StencilTest(const PixelFuncID &id, RegCache::Reg stencilReg, RegCache::Reg maskedReg) {
+	_assert_msg_(false, "Not yet implemented");
+	return false;
+}
+
+bool PixelJitCache::Jit_DepthTestForStencil(const PixelFuncID &id, RegCache::Reg stencilReg) {
+	_assert_msg_(false, "Not yet implemented");
+	return false;
+}
+
+bool PixelJitCache::Jit_ApplyStencilOp(const PixelFuncID &id, GEStencilOp op, RegCache::Reg stencilReg) {
+	_assert_msg_(false, "Not yet implemented");
+	return false;
+}
+
+bool PixelJitCache::Jit_WriteStencilOnly(const PixelFuncID &id, RegCache::Reg stencilReg) {
+	_assert_msg_(false, "Not yet implemented");
+	return false;
+}
+
+bool PixelJitCache::Jit_DepthTest(const PixelFuncID &id) {
+	if (id.DepthTestFunc() == GE_COMP_ALWAYS || id.earlyZChecks)
+		return true;
+
+	if (id.DepthTestFunc() == GE_COMP_NEVER) {
+		Discard();
+		// This should be uncommon, just keep going to have shared cleanup...
+	}
+
+	ARM64Reg depthOffReg = GetDepthOff(id);
+	Describe("DepthTest");
+	ARM64Reg argZReg = regCache_.Find(RegCache::GEN_ARG_Z);
+	ARM64Reg depthReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+	LDRH(INDEX_UNSIGNED, DecodeReg(depthReg), depthOffReg, 0);
+	// Only the low 16 bits are compared (and written), so it's safe to truncate z.
+	UXTH(DecodeReg(argZReg), DecodeReg(argZReg));
+	CMP(DecodeReg(argZReg), DecodeReg(depthReg));
+	regCache_.Release(depthReg, RegCache::GEN_TEMP0);
+	regCache_.Unlock(depthOffReg, RegCache::GEN_DEPTH_OFF);
+	regCache_.Unlock(argZReg, RegCache::GEN_ARG_Z);
+
+	// We discard the opposite of the passing test.
+	switch (id.DepthTestFunc()) {
+	case GE_COMP_NEVER:
+	case GE_COMP_ALWAYS:
+		break;
+
+	case GE_COMP_EQUAL:
+		Discard(CC_NEQ);
+		break;
+
+	case GE_COMP_NOTEQUAL:
+		Discard(CC_EQ);
+		break;
+
+	case GE_COMP_LESS:
+		Discard(CC_HS);
+		break;
+
+	case GE_COMP_LEQUAL:
+		Discard(CC_HI);
+		break;
+
+	case GE_COMP_GREATER:
+		Discard(CC_LS);
+		break;
+
+	case GE_COMP_GEQUAL:
+		Discard(CC_LO);
+		break;
+	}
+
+	// If we're not writing, we don't need Z anymore.  We'll free GEN_DEPTH_OFF in Jit_WriteDepth().
+	if (!id.depthWrite)
+		regCache_.ForceRelease(RegCache::GEN_ARG_Z);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_WriteDepth(const PixelFuncID &id) {
+	// Clear mode shares depthWrite for DepthClear().
+	if (id.depthWrite) {
+		ARM64Reg depthOffReg = GetDepthOff(id);
+		Describe("WriteDepth");
+		ARM64Reg argZReg = regCache_.Find(RegCache::GEN_ARG_Z);
+		STRH(INDEX_UNSIGNED, DecodeReg(argZReg), depthOffReg, 0);
+		regCache_.Unlock(depthOffReg, RegCache::GEN_DEPTH_OFF);
+		regCache_.Unlock(argZReg, RegCache::GEN_ARG_Z);
+		regCache_.ForceRelease(RegCache::GEN_ARG_Z);
+	}
+
+	// We can free up this reg if we force locked it.
+	if (regCache_.Has(RegCache::GEN_DEPTH_OFF)) {
+		regCache_.ForceRelease(RegCache::GEN_DEPTH_OFF);
+	}
+
+	return true;
+}
+
+bool PixelJitCache::Jit_AlphaBlend(const PixelFuncID &id) {
+	if (!id.alphaBlend)
+		return true;
+
+	// Check if we need to load and prep factors.
+	PixelBlendState blendState;
+	ComputePixelBlendState(blendState, id);
+
+	bool success = true;
+
+	// Step 1: Load and expand dest color.
+	ARM64Reg dstReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	if (!blendState.readsDstPixel) {
+		// Let's load colorOff just for registers to be consistent.
+		ARM64Reg colorOff = GetColorOff(id);
+		regCache_.Unlock(colorOff, RegCache::GEN_COLOR_OFF);
+
+		fp.EOR(dstReg, dstReg, dstReg);
+	} else if (id.FBFormat() == GE_FORMAT_8888) {
+		ARM64Reg colorOff = GetColorOff(id);
+		Describe("AlphaBlend");
+		fp.LDR(32, INDEX_UNSIGNED, EncodeRegToSingle(dstReg), colorOff, 0);
+		regCache_.Unlock(colorOff, RegCache::GEN_COLOR_OFF);
+	} else {
+		ARM64Reg colorOff = GetColorOff(id);
+		Describe("AlphaBlend");
+		ARM64Reg dstGenReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+		LDRH(INDEX_UNSIGNED, DecodeReg(dstGenReg), colorOff, 0);
+		regCache_.Unlock(colorOff, RegCache::GEN_COLOR_OFF);
+
+		ARM64Reg temp1Reg = regCache_.Alloc(RegCache::GEN_TEMP1);
+		ARM64Reg temp2Reg = regCache_.Alloc(RegCache::GEN_TEMP2);
+
+		switch (id.fbFormat) {
+		case GE_FORMAT_565:
+			success = success && Jit_ConvertFrom565(id, dstGenReg, temp1Reg, temp2Reg);
+			break;
+
+		case GE_FORMAT_5551:
+			success = success && Jit_ConvertFrom5551(id, dstGenReg, temp1Reg, temp2Reg, blendState.usesDstAlpha);
+			break;
+
+		case GE_FORMAT_4444:
+			success = success && Jit_ConvertFrom4444(id, dstGenReg, temp1Reg, temp2Reg, blendState.usesDstAlpha);
+			break;
+
+		case GE_FORMAT_8888:
+			break;
+		}
+
+		Describe("AlphaBlend");
+		fp.FMOV(EncodeRegToSingle(dstReg), DecodeReg(dstGenReg));
+
+		regCache_.Release(dstGenReg, RegCache::GEN_TEMP0);
+		regCache_.Release(temp1Reg, RegCache::GEN_TEMP1);
+		regCache_.Release(temp2Reg, RegCache::GEN_TEMP2);
+	}
+
+	// Step 2: Load and apply factors.
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	if (blendState.usesFactors) {
+		ARM64Reg srcFactorReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+		ARM64Reg dstFactorReg = regCache_.Alloc(RegCache::VEC_TEMP2);
+
+		// We apply these at 32-bit, because the products don't fit in 16 bits.
+		if (!colorIs32Bit_) {
+			fp.UXTL(8, argColorReg, argColorReg);
+			fp.UXTL(16, argColorReg, argColorReg);
+		}
+		fp.UXTL(8, dstReg, dstReg);
+		fp.UXTL(16, dstReg, dstReg);
+		colorIs32Bit_ = true;
+
+		// Okay, now grab our factors.  Don't bother if they're known values.
+		if (id.AlphaBlendSrc() < PixelBlendFactor::ZERO)
+			success = success && Jit_BlendFactor(id, srcFactorReg, dstReg, id.AlphaBlendSrc());
+		if (id.AlphaBlendDst() < PixelBlendFactor::ZERO)
+			success = success && Jit_DstBlendFactor(id, srcFactorReg, dstFactorReg, dstReg);
+
+		// Skip multiplying by factors if we can.
+		bool multiplySrc = id.AlphaBlendSrc() != PixelBlendFactor::ZERO && id.AlphaBlendSrc() != PixelBlendFactor::ONE;
+		bool multiplyDst = id.AlphaBlendDst() != PixelBlendFactor::ZERO && id.AlphaBlendDst() != PixelBlendFactor::ONE;
+
+		// This calculates ((v * 2 + 1) * (f * 2 + 1)) >> 10, which rounds like the hardware does.
+		// Note that ONE is exact with this formula, which is why we can skip it.
+		if (multiplySrc) {
+			fp.SHL(32, argColorReg, argColorReg, 1);
+			fp.ORR(32, argColorReg, 1);
+			fp.SHL(32, srcFactorReg, srcFactorReg, 1);
+			fp.ORR(32, srcFactorReg, 1);
+			fp.MUL(32, argColorReg, argColorReg, srcFactorReg);
+			fp.USHR(32, argColorReg, argColorReg, 10);
+		} else if (id.AlphaBlendSrc() == PixelBlendFactor::ZERO) {
+			fp.EOR(argColorReg, argColorReg, argColorReg);
+		}
+
+		if (multiplyDst) {
+			fp.SHL(32, dstReg, dstReg, 1);
+			fp.ORR(32, dstReg, 1);
+			fp.SHL(32, dstFactorReg, dstFactorReg, 1);
+			fp.ORR(32, dstFactorReg, 1);
+			fp.MUL(32, dstReg, dstReg, dstFactorReg);
+			fp.USHR(32, dstReg, dstReg, 10);
+		} else if (id.AlphaBlendDst() == PixelBlendFactor::ZERO) {
+			// No need to add or subtract zero, unless we're negating.
+			// This is common for bloom preparation.
+			if (id.AlphaBlendEq() == GE_BLENDMODE_MUL_AND_SUBTRACT_REVERSE)
+				fp.EOR(dstReg, dstReg, dstReg);
+		}
+
+		regCache_.Release(srcFactorReg, RegCache::VEC_TEMP1);
+		regCache_.Release(dstFactorReg, RegCache::VEC_TEMP2);
+	} else if (colorIs32Bit_) {
+		// If it's expanded, shrink and clamp for our min/max/absdiff handling.
+		fp.SQXTUN(16, argColorReg, argColorReg);
+		fp.UQXTN(8, argColorReg, argColorReg);
+		colorIs32Bit_ = false;
+	}
+
+	// Step 3: Apply equation.
+	// Note: below, we completely ignore what happens to the alpha bits.
+	// It won't matter, since we'll replace those with stencil anyway.
+	// The MUL modes are done at signed 32-bit, and clamped when narrowing again.
+	ARM64Reg tempReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+	switch (id.AlphaBlendEq()) {
+	case GE_BLENDMODE_MUL_AND_ADD:
+		if (id.AlphaBlendDst() != PixelBlendFactor::ZERO)
+			fp.ADD(32, argColorReg, argColorReg, dstReg);
+		break;
+
+	case GE_BLENDMODE_MUL_AND_SUBTRACT:
+		if (id.AlphaBlendDst() != PixelBlendFactor::ZERO)
+			fp.SUB(32, argColorReg, argColorReg, dstReg);
+		break;
+
+	case GE_BLENDMODE_MUL_AND_SUBTRACT_REVERSE:
+		fp.SUB(32, argColorReg, dstReg, argColorReg);
+		break;
+
+	case GE_BLENDMODE_MIN:
+		fp.UMIN(8, argColorReg, argColorReg, dstReg);
+		break;
+
+	case GE_BLENDMODE_MAX:
+		fp.UMAX(8, argColorReg, argColorReg, dstReg);
+		break;
+
+	case GE_BLENDMODE_ABSDIFF:
+		// The difference is simply max - min, which can't underflow.
+		fp.UMAX(8, tempReg, argColorReg, dstReg);
+		fp.UMIN(8, argColorReg, argColorReg, dstReg);
+		fp.SUB(8, argColorReg, tempReg, argColorReg);
+		break;
+	}
+
+	regCache_.Release(dstReg, RegCache::VEC_TEMP0);
+	regCache_.Release(tempReg, RegCache::VEC_TEMP1);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	return success;
+}
+
+bool PixelJitCache::Jit_BlendFactor(const PixelFuncID &id, RegCache::Reg factorReg, RegCache::Reg dstReg, PixelBlendFactor factor) {
+	ARM64Reg idReg = INVALID_REG;
+	ARM64Reg tempReg = INVALID_REG;
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+
+	// Everything below expects an expanded 32-bit color
+	_assert_(colorIs32Bit_);
+
+	// Between source and dest factors, only DSTCOLOR, INVDSTCOLOR, and FIXA differ.
+	// In those cases, it uses SRCCOLOR, INVSRCCOLOR, and FIXB respectively.
+
+	// Load the invert constant first off, if needed.
+	switch (factor) {
+	case PixelBlendFactor::INVOTHERCOLOR:
+	case PixelBlendFactor::INVSRCALPHA:
+	case PixelBlendFactor::INVDSTALPHA:
+	case PixelBlendFactor::DOUBLEINVSRCALPHA:
+	case PixelBlendFactor::DOUBLEINVDSTALPHA:
+		fp.MOVI(32, factorReg, 0xFF);
+		break;
+
+	default:
+		break;
+	}
+
+	switch (factor) {
+	case PixelBlendFactor::OTHERCOLOR:
+		fp.MOV(factorReg, dstReg);
+		break;
+
+	case PixelBlendFactor::INVOTHERCOLOR:
+		fp.SUB(32, factorReg, factorReg, dstReg);
+		break;
+
+	case PixelBlendFactor::SRCALPHA:
+		fp.DUP(32, factorReg, argColorReg, 3);
+		break;
+
+	case PixelBlendFactor::INVSRCALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+
+		fp.DUP(32, tempReg, argColorReg, 3);
+		fp.SUB(32, factorReg, factorReg, tempReg);
+		break;
+
+	case PixelBlendFactor::DSTALPHA:
+		fp.DUP(32, factorReg, dstReg, 3);
+		break;
+
+	case PixelBlendFactor::INVDSTALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+
+		fp.DUP(32, tempReg, dstReg, 3);
+		fp.SUB(32, factorReg, factorReg, tempReg);
+		break;
+
+	case PixelBlendFactor::DOUBLESRCALPHA:
+		fp.DUP(32, factorReg, argColorReg, 3);
+		fp.SHL(32, factorReg, factorReg, 1);
+		break;
+
+	case PixelBlendFactor::DOUBLEINVSRCALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+
+		// This one saturates at zero, so clamp the doubled alpha to 255 first.
+		fp.DUP(32, tempReg, argColorReg, 3);
+		fp.SHL(32, tempReg, tempReg, 1);
+		fp.UMIN(32, tempReg, tempReg, factorReg);
+		fp.SUB(32, factorReg, factorReg, tempReg);
+		break;
+
+	case PixelBlendFactor::DOUBLEDSTALPHA:
+		fp.DUP(32, factorReg, dstReg, 3);
+		fp.SHL(32, factorReg, factorReg, 1);
+		break;
+
+	case PixelBlendFactor::DOUBLEINVDSTALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+
+		fp.DUP(32, tempReg, dstReg, 3);
+		fp.SHL(32, tempReg, tempReg, 1);
+		fp.UMIN(32, tempReg, tempReg, factorReg);
+		fp.SUB(32, factorReg, factorReg, tempReg);
+		break;
+
+	case PixelBlendFactor::ZERO:
+		// Special value meaning zero.
+		fp.EOR(factorReg, factorReg, factorReg);
+		break;
+
+	case PixelBlendFactor::ONE:
+		// Special value meaning all 255s.
+		fp.MOVI(32, factorReg, 0xFF);
+		break;
+
+	case PixelBlendFactor::FIX:
+	default:
+		idReg = GetPixelID();
+		// This isn't aligned, so use an unscaled load.
+		fp.LDUR(32, EncodeRegToSingle(factorReg), idReg, offsetof(PixelFuncID, cached.alphaBlendSrc));
+		fp.UXTL(8, factorReg, factorReg);
+		fp.UXTL(16, factorReg, factorReg);
+		break;
+	}
+
+	if (idReg != INVALID_REG)
+		UnlockPixelID(idReg);
+	if (tempReg != INVALID_REG)
+		regCache_.Release(tempReg, RegCache::VEC_TEMP3);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_DstBlendFactor(const PixelFuncID &id, RegCache::Reg srcFactorReg, RegCache::Reg dstFactorReg, RegCache::Reg dstReg) {
+	bool success = true;
+	ARM64Reg idReg = INVALID_REG;
+	ARM64Reg tempReg = INVALID_REG;
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+
+	// Everything below expects an expanded 32-bit color
+	_assert_(colorIs32Bit_);
+
+	PixelBlendState blendState;
+	ComputePixelBlendState(blendState, id);
+
+	// We might be able to reuse srcFactorReg for dst, in some cases.
+	switch (id.AlphaBlendDst()) {
+	case PixelBlendFactor::OTHERCOLOR:
+		fp.MOV(dstFactorReg, argColorReg);
+		break;
+
+	case PixelBlendFactor::INVOTHERCOLOR:
+		fp.MOVI(32, dstFactorReg, 0xFF);
+		fp.SUB(32, dstFactorReg, dstFactorReg, argColorReg);
+		break;
+
+	case PixelBlendFactor::SRCALPHA:
+	case PixelBlendFactor::INVSRCALPHA:
+	case PixelBlendFactor::DSTALPHA:
+	case PixelBlendFactor::INVDSTALPHA:
+	case PixelBlendFactor::DOUBLESRCALPHA:
+	case PixelBlendFactor::DOUBLEINVSRCALPHA:
+	case PixelBlendFactor::DOUBLEDSTALPHA:
+	case PixelBlendFactor::DOUBLEINVDSTALPHA:
+	case PixelBlendFactor::ZERO:
+	case PixelBlendFactor::ONE:
+		// These are all equivalent for src factor, so reuse that logic.
+		if (id.AlphaBlendSrc() == id.AlphaBlendDst()) {
+			fp.MOV(dstFactorReg, srcFactorReg);
+		} else if (blendState.dstFactorIsInverse) {
+			// The doubled factors saturate, so clamp before inverting.
+			tempReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+			fp.MOVI(32, dstFactorReg, 0xFF);
+			fp.UMIN(32, tempReg, srcFactorReg, dstFactorReg);
+			fp.SUB(32, dstFactorReg, dstFactorReg, tempReg);
+		} else {
+			success = success && Jit_BlendFactor(id, dstFactorReg, dstReg, id.AlphaBlendDst());
+		}
+		break;
+
+	case PixelBlendFactor::FIX:
+	default:
+		idReg = GetPixelID();
+		fp.LDUR(32, EncodeRegToSingle(dstFactorReg), idReg, offsetof(PixelFuncID, cached.alphaBlendDst));
+		fp.UXTL(8, dstFactorReg, dstFactorReg);
+		fp.UXTL(16, dstFactorReg, dstFactorReg);
+		break;
+	}
+
+	if (idReg != INVALID_REG)
+		UnlockPixelID(idReg);
+	if (tempReg != INVALID_REG)
+		regCache_.Release(tempReg, RegCache::VEC_TEMP3);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	return success;
+}
+
+bool PixelJitCache::Jit_Dither(const PixelFuncID &id) {
+	if (!id.dithering)
+		return true;
+
+	Describe("Dither");
+	ARM64Reg valueReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+
+	// Load the row dither matrix entry (will still need to get the X.)
+	ARM64Reg argYReg = regCache_.Find(RegCache::GEN_ARG_Y);
+	ANDI2R(DecodeReg(valueReg), DecodeReg(argYReg), 3);
+
+	// At this point, we're done with depth and y, so let's grab GEN_COLOR_OFF and retain it.
+	// Then we can modify x and throw it away too, which is our actual goal.
+	ARM64Reg colorOffReg = GetColorOff(id);
+	Describe("Dither");
+	regCache_.Unlock(colorOffReg, RegCache::GEN_COLOR_OFF);
+	regCache_.ForceRetain(RegCache::GEN_COLOR_OFF);
+	// And get rid of y, we can use for other regs.
+	regCache_.Unlock(argYReg, RegCache::GEN_ARG_Y);
+	regCache_.ForceRelease(RegCache::GEN_ARG_Y);
+
+	ARM64Reg argXReg = regCache_.Find(RegCache::GEN_ARG_X);
+	ANDI2R(DecodeReg(argXReg), DecodeReg(argXReg), 3);
+
+	// Sum up (x + y * 4) to valueReg, and then read from the ID's ditherMatrix.
+	ADD(DecodeReg(valueReg), DecodeReg(argXReg), DecodeReg(valueReg), ArithOption(DecodeReg(valueReg), ST_LSL, 2));
+	regCache_.Unlock(argXReg, RegCache::GEN_ARG_X);
+	regCache_.ForceRelease(RegCache::GEN_ARG_X);
+
+	ARM64Reg idReg = GetPixelID();
+	ADD(valueReg, idReg, valueReg);
+	LDRSB(INDEX_UNSIGNED, DecodeReg(valueReg), valueReg, offsetof(PixelFuncID, cached.ditherMatrix));
+	UnlockPixelID(idReg);
+
+	// Now we want to broadcast RGB, but keep A as 0.
+	ARM64Reg vecValueReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	if (colorIs32Bit_) {
+		// Still expanded from blending, so add before clamping.
+		fp.DUP(32, vecValueReg, DecodeReg(valueReg));
+		fp.INS(32, vecValueReg, 3, WZR);
+		fp.ADD(32, argColorReg, argColorReg, vecValueReg);
+	} else {
+		// We use 16-bit because we need a signed add, but then we also clamp immediately.
+		fp.DUP(16, vecValueReg, DecodeReg(valueReg));
+		fp.INS(16, vecValueReg, 3, WZR);
+		fp.UXTL(8, argColorReg, argColorReg);
+		fp.ADD(16, argColorReg, argColorReg, vecValueReg);
+		fp.SQXTUN(8, argColorReg, argColorReg);
+	}
+	regCache_.Release(valueReg, RegCache::GEN_TEMP0);
+	regCache_.Release(vecValueReg, RegCache::VEC_TEMP0);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_WriteColor(const PixelFuncID &id) {
+	ARM64Reg colorOff = GetColorOff(id);
+	Describe("WriteColor");
+	if (regCache_.Has(RegCache::GEN_ARG_X)) {
+		// We normally toss x and y during dithering or useStandardStride with no dithering.
+		// Free up the regs now to get more reg space.
+		regCache_.ForceRelease(RegCache::GEN_ARG_X);
+		regCache_.ForceRelease(RegCache::GEN_ARG_Y);
+
+		// But make sure we don't lose GEN_COLOR_OFF, we'll be lost without that now.
+		regCache_.ForceRetain(RegCache::GEN_COLOR_OFF);
+	}
+
+	// Convert back to 8888 and clamp.
+	ARM64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	if (colorIs32Bit_) {
+		fp.SQXTUN(16, argColorReg, argColorReg);
+		fp.UQXTN(8, argColorReg, argColorReg);
+		colorIs32Bit_ = false;
+	}
+
+	// Figure out which bits of the existing pixel we need to keep, at the destination bit depth.
+	uint32_t alphaMask = 0;
+	uint32_t colorMask = 0;
+	switch (id.fbFormat) {
+	case GE_FORMAT_565:
+		colorMask = 0xFFFF;
+		break;
+	case GE_FORMAT_5551:
+		alphaMask = 0x8000;
+		colorMask = 0x7FFF;
+		break;
+	case GE_FORMAT_4444:
+		alphaMask = 0xF000;
+		colorMask = 0x0FFF;
+		break;
+	case GE_FORMAT_8888:
+		alphaMask = 0xFF000000;
+		colorMask = 0x00FFFFFF;
+		break;
+	}
+
+	// Without a stencil test, the existing stencil bits are always kept outside clear mode.
+	uint32_t fixedKeepMask = alphaMask;
+	if (id.clearMode) {
+		fixedKeepMask = 0;
+		if (!id.ColorClear())
+			fixedKeepMask |= colorMask;
+		if (!id.StencilClear())
+			fixedKeepMask |= alphaMask;
+	}
+
+	if (fixedKeepMask == (alphaMask | colorMask)) {
+		// Nothing to write at all.
+		regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+		regCache_.ForceRelease(RegCache::VEC_ARG_COLOR);
+		regCache_.Unlock(colorOff, RegCache::GEN_COLOR_OFF);
+		regCache_.ForceRelease(RegCache::GEN_COLOR_OFF);
+		return true;
+	}
+
+	ARM64Reg colorReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+	fp.FMOV(DecodeReg(colorReg), EncodeRegToSingle(argColorReg));
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	regCache_.ForceRelease(RegCache::VEC_ARG_COLOR);
+
+	ARM64Reg temp1Reg = regCache_.Alloc(RegCache::GEN_TEMP1);
+	ARM64Reg temp2Reg = regCache_.Alloc(RegCache::GEN_TEMP2);
+	bool convertAlpha = id.clearMode && id.StencilClear();
+
+	bool success = true;
+
+	// Step 1: Convert the color into colorReg.
+	switch (id.fbFormat) {
+	case GE_FORMAT_565:
+		success = success && Jit_ConvertTo565(id, colorReg, temp1Reg, temp2Reg);
+		break;
+
+	case GE_FORMAT_5551:
+		success = success && Jit_ConvertTo5551(id, colorReg, temp1Reg, temp2Reg, convertAlpha);
+		break;
+
+	case GE_FORMAT_4444:
+		success = success && Jit_ConvertTo4444(id, colorReg, temp1Reg, temp2Reg, convertAlpha);
+		break;
+
+	case GE_FORMAT_8888:
+		break;
+	}
+
+	// Step 2: Load write mask if needed, and combine with what we're keeping.
+	// Note that we apply the write mask at the destination bit depth.
+	Describe("WriteColor");
+	ARM64Reg maskReg = INVALID_REG;
+	if (id.applyColorWriteMask) {
+		maskReg = regCache_.Alloc(RegCache::GEN_TEMP3);
+		// Load the pre-converted and combined write mask.
+		ARM64Reg idReg = GetPixelID();
+		LDR(INDEX_UNSIGNED, DecodeReg(maskReg), idReg, offsetof(PixelFuncID, cached.colorWriteMask));
+		UnlockPixelID(idReg);
+		if (fixedKeepMask != 0)
+			ORRI2R(DecodeReg(maskReg), DecodeReg(maskReg), fixedKeepMask, DecodeReg(temp2Reg));
+	} else if (fixedKeepMask != 0 && fixedKeepMask != 0xFF000000) {
+		maskReg = regCache_.Alloc(RegCache::GEN_TEMP3);
+		MOVI2R(DecodeReg(maskReg), fixedKeepMask);
+	}
+
+	// Step 3: Merge in the kept bits from the old pixel: new ^ ((new ^ old) & mask).
+	if (maskReg != INVALID_REG) {
+		if (id.fbFormat == GE_FORMAT_8888)
+			LDR(INDEX_UNSIGNED, DecodeReg(temp1Reg), colorOff, 0);
+		else
+			LDRH(INDEX_UNSIGNED, DecodeReg(temp1Reg), colorOff, 0);
+		EOR(DecodeReg(temp1Reg), DecodeReg(temp1Reg), DecodeReg(colorReg));
+		AND(DecodeReg(temp1Reg), DecodeReg(temp1Reg), DecodeReg(maskReg));
+		EOR(DecodeReg(colorReg), DecodeReg(colorReg), DecodeReg(temp1Reg));
+	}
+
+	// Step 4: Write.
+	switch (id.fbFormat) {
+	case GE_FORMAT_565:
+	case GE_FORMAT_5551:
+	case GE_FORMAT_4444:
+		STRH(INDEX_UNSIGNED, DecodeReg(colorReg), colorOff, 0);
+		break;
+
+	case GE_FORMAT_8888:
+		if (maskReg == INVALID_REG && fixedKeepMask == 0xFF000000) {
+			// We want to set 24 bits only, since we're not changing stencil.
+			// Two writes are cheaper than reading in the old stencil.
+			STRH(INDEX_UNSIGNED, DecodeReg(colorReg), colorOff, 0);
+			LSR(DecodeReg(colorReg), DecodeReg(colorReg), 16);
+			STRB(INDEX_UNSIGNED, DecodeReg(colorReg), colorOff, 2);
+		} else {
+			STR(INDEX_UNSIGNED, DecodeReg(colorReg), colorOff, 0);
+		}
+		break;
+	}
+
+	regCache_.Unlock(colorOff, RegCache::GEN_COLOR_OFF);
+	regCache_.ForceRelease(RegCache::GEN_COLOR_OFF);
+	regCache_.Release(colorReg, RegCache::GEN_TEMP0);
+	regCache_.Release(temp1Reg, RegCache::GEN_TEMP1);
+	regCache_.Release(temp2Reg, RegCache::GEN_TEMP2);
+	if (maskReg != INVALID_REG)
+		regCache_.Release(maskReg, RegCache::GEN_TEMP3);
+
+	return success;
+}
+
+bool PixelJitCache::Jit_ApplyLogicOp(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg maskReg) {
+	// Logic ops use the generic path for now, see CompileSingle().
+	_assert_msg_(false, "Not yet implemented");
+	return false;
+}
+
+bool PixelJitCache::Jit_ConvertTo565(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg) {
+	Describe("ConvertTo565");
+	ARM64Reg color = DecodeReg(colorReg);
+	ARM64Reg temp1 = DecodeReg(temp1Reg);
+	ARM64Reg temp2 = DecodeReg(temp2Reg);
+
+	// Take the top 5 bits of red, then insert green and blue above it.
+	UBFX(temp1, color, 3, 5);
+	LSR(temp2, color, 10);
+	BFI(temp1, temp2, 5, 6);
+	LSR(temp2, color, 19);
+	BFI(temp1, temp2, 11, 5);
+	MOV(color, temp1);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_ConvertTo5551(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg, bool keepAlpha) {
+	Describe("ConvertTo5551");
+	ARM64Reg color = DecodeReg(colorReg);
+	ARM64Reg temp1 = DecodeReg(temp1Reg);
+	ARM64Reg temp2 = DecodeReg(temp2Reg);
+
+	UBFX(temp1, color, 3, 5);
+	LSR(temp2, color, 11);
+	BFI(temp1, temp2, 5, 5);
+	LSR(temp2, color, 19);
+	BFI(temp1, temp2, 10, 5);
+	if (keepAlpha) {
+		LSR(temp2, color, 31);
+		BFI(temp1, temp2, 15, 1);
+	}
+	MOV(color, temp1);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_ConvertTo4444(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg, bool keepAlpha) {
+	Describe("ConvertTo4444");
+	ARM64Reg color = DecodeReg(colorReg);
+	ARM64Reg temp1 = DecodeReg(temp1Reg);
+	ARM64Reg temp2 = DecodeReg(temp2Reg);
+
+	UBFX(temp1, color, 4, 4);
+	LSR(temp2, color, 12);
+	BFI(temp1, temp2, 4, 4);
+	LSR(temp2, color, 20);
+	BFI(temp1, temp2, 8, 4);
+	if (keepAlpha) {
+		LSR(temp2, color, 28);
+		BFI(temp1, temp2, 12, 4);
+	}
+	MOV(color, temp1);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_ConvertFrom565(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg) {
+	Describe("ConvertFrom565");
+	ARM64Reg color = DecodeReg(colorReg);
+	ARM64Reg temp1 = DecodeReg(temp1Reg);
+	ARM64Reg temp2 = DecodeReg(temp2Reg);
+
+	// For each channel, shift to the top of 8 bits and then replicate the top bits down.
+	// Red goes to temp1 directly, the rest are merged in from temp2.
+	UBFX(temp1, color, 0, 5);
+	LSL(temp1, temp1, 3);
+	ORR(temp1, temp1, temp1, ArithOption(temp1, ST_LSR, 5));
+
+	UBFX(temp2, color, 5, 6);
+	LSL(temp2, temp2, 2);
+	ORR(temp2, temp2, temp2, ArithOption(temp2, ST_LSR, 6));
+	ORR(temp1, temp1, temp2, ArithOption(temp2, ST_LSL, 8));
+
+	UBFX(temp2, color, 11, 5);
+	LSL(temp2, temp2, 3);
+	ORR(temp2, temp2, temp2, ArithOption(temp2, ST_LSR, 5));
+	ORR(color, temp1, temp2, ArithOption(temp2, ST_LSL, 16));
+
+	return true;
+}
+
+bool PixelJitCache::Jit_ConvertFrom5551(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg, bool keepAlpha) {
+	Describe("ConvertFrom5551");
+	ARM64Reg color = DecodeReg(colorReg);
+	ARM64Reg temp1 = DecodeReg(temp1Reg);
+	ARM64Reg temp2 = DecodeReg(temp2Reg);
+
+	UBFX(temp1, color, 0, 5);
+	LSL(temp1, temp1, 3);
+	ORR(temp1, temp1, temp1, ArithOption(temp1, ST_LSR, 5));
+
+	UBFX(temp2, color, 5, 5);
+	LSL(temp2, temp2, 3);
+	ORR(temp2, temp2, temp2, ArithOption(temp2, ST_LSR, 5));
+	ORR(temp1, temp1, temp2, ArithOption(temp2, ST_LSL, 8));
+
+	UBFX(temp2, color, 10, 5);
+	LSL(temp2, temp2, 3);
+	ORR(temp2, temp2, temp2, ArithOption(temp2, ST_LSR, 5));
+	ORR(temp1, temp1, temp2, ArithOption(temp2, ST_LSL, 16));
+
+	if (keepAlpha) {
+		// Sign extend the top bit to get either 0 or 0xFFFFFFFF, then shift into place.
+		SBFM(temp2, color, 15, 15);
+		ORR(color, temp1, temp2, ArithOption(temp2, ST_LSL, 24));
+	} else {
+		MOV(color, temp1);
+	}
+
+	return true;
+}
+
+bool PixelJitCache::Jit_ConvertFrom4444(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg, bool keepAlpha) {
+	Describe("ConvertFrom4444");
+	ARM64Reg color = DecodeReg(colorReg);
+	ARM64Reg temp1 = DecodeReg(temp1Reg);
+	ARM64Reg temp2 = DecodeReg(temp2Reg);
+
+	// Each nibble simply gets duplicated: 0x0000ABGR -> 0xAABBGGRR.
+	UBFX(temp1, color, 0, 4);
+	ORR(temp1, temp1, temp1, ArithOption(temp1, ST_LSL, 4));
+
+	UBFX(temp2, color, 4, 4);
+	ORR(temp2, temp2, temp2, ArithOption(temp2, ST_LSL, 4));
+	ORR(temp1, temp1, temp2, ArithOption(temp2, ST_LSL, 8));
+
+	UBFX(temp2, color, 8, 4);
+	ORR(temp2, temp2, temp2, ArithOption(temp2, ST_LSL, 4));
+	ORR(temp1, temp1, temp2, ArithOption(temp2, ST_LSL, 16));
+
+	if (keepAlpha) {
+		UBFX(temp2, color, 12, 4);
+		ORR(temp2, temp2, temp2, ArithOption(temp2, ST_LSL, 4));
+		ORR(color, temp1, temp2, ArithOption(temp2, ST_LSL, 24));
+	} else {
+		MOV(color, temp1);
+	}
+
+	return true;
+}
+
+};
+
+#endif
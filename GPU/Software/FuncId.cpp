@@ -21,6 +21,7 @@
 #include "GPU/Common/TextureDecoder.h"
 #include "GPU/GPUState.h"
 #include "GPU/Software/FuncId.h"
+#include "GPU/Software/RenderScale.h"
 
 static_assert(sizeof(SamplerID) == sizeof(SamplerID::fullKey) + sizeof(SamplerID::cached) + sizeof(SamplerID::pad), "Bad sampler ID size");
 static_assert(sizeof(PixelFuncID) == sizeof(PixelFuncID::fullKey) + sizeof(PixelFuncID::cached), "Bad pixel func ID size");
@@ -56,7 +57,7 @@ void ComputePixelFuncID(PixelFuncID *id) {
 	// Dither happens even in clear mode.
 	id->dithering = gstate.isDitherEnabled();
 	id->fbFormat = gstate.FrameBufFormat();
-	id->useStandardStride = gstate.FrameBufStride() == 512;
+	id->useStandardStride = gstate.FrameBufStride() * RenderScale::Factor() == 512;
 	id->applyColorWriteMask = gstate.getColorMask() != 0;
 
 	id->clearMode = gstate.isModeClear();
@@ -188,7 +189,7 @@ void ComputePixelFuncID(PixelFuncID *id) {
 	}
 
 	if (id->useStandardStride && (id->depthTestFunc != GE_COMP_ALWAYS || id->depthWrite))
-		id->useStandardStride = gstate.DepthBufStride() == 512;
+		id->useStandardStride = gstate.DepthBufStride() * RenderScale::Factor() == 512;
 
 	// Cache some values for later convenience.
 	if (id->dithering) {
@@ -228,8 +229,9 @@ void ComputePixelFuncID(PixelFuncID *id) {
 		id->cached.logicOp = gstate.getLogicOp();
 	id->cached.minz = gstate.getDepthRangeMin();
 	id->cached.maxz = gstate.getDepthRangeMax();
-	id->cached.framebufStride = gstate.FrameBufStride();
-	id->cached.depthbufStride = gstate.DepthBufStride();
+	// With a render scale, these are the strides of the shadow buffers we actually draw to.
+	id->cached.framebufStride = gstate.FrameBufStride() * RenderScale::Factor();
+	id->cached.depthbufStride = gstate.DepthBufStride() * RenderScale::Factor();
 
 	if (id->hasStencilTestMask) {
 		// Without the mask applied, unlike the one in the key.
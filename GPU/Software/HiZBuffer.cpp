@@ -0,0 +1,128 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include "GPU/Software/HiZBuffer.h"
+#include "GPU/Software/RenderScale.h"
+
+namespace Rasterizer {
+
+void HiZBuffer::Reset(uint32_t addr, uint16_t stride) {
+	addr_ = addr;
+	stride_ = stride;
+	usedRows_ = 0;
+	Reset();
+}
+
+void HiZBuffer::Reset() {
+	const int size = (1024 >> TILE_SHIFT) * RenderScale::Factor();
+	if (!tiles_ || columns_ != size) {
+		columns_ = size;
+		rows_ = size;
+		tiles_.reset(new std::atomic<uint32_t>[columns_ * rows_]);
+	}
+
+	for (int i = 0; i < columns_ * rows_; ++i)
+		tiles_[i].store(UNKNOWN, std::memory_order_relaxed);
+	enabled_ = true;
+}
+
+void HiZBuffer::GrowRows(int rows) {
+	usedRows_ = std::max(usedRows_, rows);
+}
+
+bool HiZBuffer::Overlaps(uint32_t start, uint32_t end) const {
+	if (!tiles_)
+		return false;
+	const uint32_t bufEnd = addr_ + stride_ * 2 * usedRows_;
+	return start < bufEnd && addr_ < end;
+}
+
+inline void HiZBuffer::ExpandTile(std::atomic<uint32_t> &tile, uint32_t zmin, uint32_t zmax) {
+	// Bins can share a tile along their edges, so other threads may be widening it too.
+	uint32_t cur = tile.load(std::memory_order_relaxed);
+	while (true) {
+		uint32_t next = std::min(cur & 0xFFFF, zmin) | (std::max(cur >> 16, zmax) << 16);
+		if (next == cur || tile.compare_exchange_weak(cur, next, std::memory_order_relaxed))
+			break;
+	}
+}
+
+void HiZBuffer::Expand(int x1, int y1, int x2, int y2, int zmin, int zmax) {
+	if (!enabled_)
+		return;
+
+	const int tx1 = std::max(x1, 0) >> TILE_SHIFT;
+	const int ty1 = std::max(y1, 0) >> TILE_SHIFT;
+	const int tx2 = std::min(x2 >> TILE_SHIFT, columns_ - 1);
+	const int ty2 = std::min(y2 >> TILE_SHIFT, rows_ - 1);
+	const uint32_t lo = std::clamp(zmin, 0, 0xFFFF);
+	const uint32_t hi = std::clamp(zmax, 0, 0xFFFF);
+
+	for (int ty = ty1; ty <= ty2; ++ty) {
+		for (int tx = tx1; tx <= tx2; ++tx)
+			ExpandTile(tiles_[ty * columns_ + tx], lo, hi);
+	}
+}
+
+void HiZBuffer::Fill(int x1, int y1, int x2, int y2, uint16_t z) {
+	if (!enabled_)
+		return;
+
+	const int tx1 = std::max(x1, 0) >> TILE_SHIFT;
+	const int ty1 = std::max(y1, 0) >> TILE_SHIFT;
+	const int tx2 = std::min(x2 >> TILE_SHIFT, columns_ - 1);
+	const int ty2 = std::min(y2 >> TILE_SHIFT, rows_ - 1);
+
+	for (int ty = ty1; ty <= ty2; ++ty) {
+		const bool fullY = ty * TILE_SIZE >= y1 && ty * TILE_SIZE + TILE_SIZE - 1 <= y2;
+		for (int tx = tx1; tx <= tx2; ++tx) {
+			const bool fullX = tx * TILE_SIZE >= x1 && tx * TILE_SIZE + TILE_SIZE - 1 <= x2;
+			// A whole tile is only ever drawn by one bin, so nothing else can write it meanwhile.
+			if (fullX && fullY)
+				tiles_[ty * columns_ + tx].store(z | ((uint32_t)z << 16), std::memory_order_relaxed);
+			else
+				ExpandTile(tiles_[ty * columns_ + tx], z, z);
+		}
+	}
+}
+
+bool HiZBuffer::Rejects(int tx, int ty, GEComparison func, int zmin, int zmax) const {
+	if (tx < 0 || ty < 0 || tx >= columns_ || ty >= rows_)
+		return false;
+
+	const uint32_t tile = tiles_[ty * columns_ + tx].load(std::memory_order_relaxed);
+	const int lo = (int)(tile & 0xFFFF);
+	const int hi = (int)(tile >> 16);
+
+	switch (func) {
+	case GE_COMP_EQUAL:
+		return zmax < lo || zmin > hi;
+	case GE_COMP_LESS:
+		return zmin >= hi;
+	case GE_COMP_LEQUAL:
+		return zmin > hi;
+	case GE_COMP_GREATER:
+		return zmax <= lo;
+	case GE_COMP_GEQUAL:
+		return zmax < lo;
+	default:
+		return false;
+	}
+}
+
+}  // namespace Rasterizer
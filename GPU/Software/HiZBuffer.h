@@ -0,0 +1,92 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "GPU/ge_constants.h"
+
+namespace Rasterizer {
+
+// Coarse depth bounds for a depth buffer, in tiles of 16x16 drawing pixels.
+// Every depth value in a tile is known to be within its min and max, so a triangle that would fail
+// the depth test against that whole range can skip the tile without reading any depth.
+// Only a depth clear covering a whole tile tightens it, other depth writes just widen the bounds.
+class HiZBuffer {
+public:
+	static constexpr int TILE_SHIFT = 4;
+	static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+	// Drawing coordinates go up to 1024 times the render scale, which is at most 4.
+	static constexpr int MAX_TILES = 4096 / TILE_SIZE;
+
+	// These only happen with nothing queued.  Tiles start out unknown, which rejects nothing.
+	void Reset(uint32_t addr, uint16_t stride);
+	void Reset();
+
+	// For writes we can't track.  Nothing is rejected until the next reset.
+	void Disable() {
+		enabled_ = false;
+	}
+	bool Enabled() const {
+		return enabled_;
+	}
+
+	bool Matches(uint32_t addr, uint16_t stride) const {
+		return tiles_ && addr_ == addr && stride_ == stride;
+	}
+	// Rows of the buffer that may be drawn to, for VRAM overlap checks.
+	void GrowRows(int rows);
+	bool Overlaps(uint32_t start, uint32_t end) const;
+
+	// Widens the bounds of tiles touching the area, in inclusive drawing coords.
+	void Expand(int x1, int y1, int x2, int y2, int zmin, int zmax);
+	// Tiles fully inside the area now hold only z.  Those partially inside are widened.
+	void Fill(int x1, int y1, int x2, int y2, uint16_t z);
+
+	int Columns() const {
+		return columns_;
+	}
+	int Rows() const {
+		return rows_;
+	}
+	// True if no depth value in the tile can pass func for any z within [zmin, zmax].
+	bool Rejects(int tx, int ty, GEComparison func, int zmin, int zmax) const;
+
+	static bool CanReject(GEComparison func) {
+		return func != GE_COMP_NEVER && func != GE_COMP_ALWAYS && func != GE_COMP_NOTEQUAL;
+	}
+
+private:
+	// Packed as min | (max << 16).
+	static constexpr uint32_t UNKNOWN = 0xFFFF0000;
+
+	void ExpandTile(std::atomic<uint32_t> &tile, uint32_t zmin, uint32_t zmax);
+
+	std::unique_ptr<std::atomic<uint32_t>[]> tiles_;
+	int columns_ = 0;
+	int rows_ = 0;
+	std::atomic<bool> enabled_{};
+
+	uint32_t addr_ = 0;
+	uint16_t stride_ = 0;
+	int usedRows_ = 0;
+};
+
+}  // namespace Rasterizer
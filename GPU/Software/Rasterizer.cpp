@@ -31,7 +31,9 @@
 #include "GPU/Common/TextureDecoder.h"
 #include "GPU/Software/BinManager.h"
 #include "GPU/Software/DrawPixel.h"
+#include "GPU/Software/HiZBuffer.h"
 #include "GPU/Software/Rasterizer.h"
+#include "GPU/Software/RenderScale.h"
 #include "GPU/Software/Sampler.h"
 #include "GPU/Software/SoftGpu.h"
 #include "GPU/Software/TransformUnit.h"
@@ -112,6 +114,7 @@ static inline Vec4<float> Interpolate(const float &c0, const float &c1, const fl
 void ComputeRasterizerState(RasterizerState *state, BinManager *binner) {
 	ComputePixelFuncID(&state->pixelID);
 	state->drawPixel = Rasterizer::GetSingleFunc(state->pixelID, binner);
+	state->drawQuad = Rasterizer::GetQuadFunc(state->pixelID, state->drawPixel);
 
 	state->enableTextures = gstate.isTextureMapEnabled() && !state->pixelID.clearMode;
 	if (state->enableTextures) {
@@ -435,6 +438,7 @@ static bool ApplyStateOptimizations(RasterizerState *state, const RasterizerStat
 		// Can't compile during runtime.  This failing is a bit of a problem when undoing...
 		if (drawPixel) {
 			state->drawPixel = drawPixel;
+			state->drawQuad = Rasterizer::GetQuadFunc(pixelID, drawPixel);
 			memcpy(&state->pixelID, &pixelID, sizeof(PixelFuncID));
 			state->flags = ReplacePixelIDFlags(state->flags, optimize) | RasterizerStateFlags::OPTIMIZED;
 			changed = true;
@@ -686,101 +690,6 @@ static inline void ApplyTexturing(const RasterizerState &state, Vec4<int> *prim_
 	}
 }
 
-static inline Vec4<int> SOFTRAST_CALL CheckDepthTestPassed4(const Vec4<int> &mask, GEComparison func, int x, int y, int stride, Vec4<int> z) {
-	// Skip the depth buffer read if we're masked already.
-#if defined(_M_SSE)
-	__m128i result = SAFE_M128I(mask.ivec);
-	int maskbits = _mm_movemask_epi8(result);
-	if (maskbits >= 0xFFFF)
-		return mask;
-#else
-	Vec4<int> result = mask;
-	if (mask.x < 0 && mask.y < 0 && mask.z < 0 && mask.w < 0)
-		return result;
-#endif
-
-	// Read in the existing depth values.
-#if defined(_M_SSE)
-	// Tried using flags from maskbits to skip dwords... seemed neutral.
-	__m128i refz = _mm_cvtsi32_si128(*(u32 *)depthbuf.Get16Ptr(x, y, stride));
-	refz = _mm_unpacklo_epi32(refz, _mm_cvtsi32_si128(*(u32 *)depthbuf.Get16Ptr(x, y + 1, stride)));
-	refz = _mm_unpacklo_epi16(refz, _mm_setzero_si128());
-#else
-	Vec4<int> refz(depthbuf.Get16(x, y, stride), depthbuf.Get16(x + 1, y, stride), depthbuf.Get16(x, y + 1, stride), depthbuf.Get16(x + 1, y + 1, stride));
-#endif
-
-	switch (func) {
-	case GE_COMP_NEVER:
-#if defined(_M_SSE)
-		result = _mm_set1_epi32(-1);
-#else
-		result = Vec4<int>::AssignToAll(-1);
-#endif
-		break;
-
-	case GE_COMP_ALWAYS:
-		break;
-
-	case GE_COMP_EQUAL:
-#if defined(_M_SSE)
-		result = _mm_or_si128(result, _mm_xor_si128(_mm_cmpeq_epi32(z.ivec, refz), _mm_set1_epi32(-1)));
-#else
-		for (int i = 0; i < 4; ++i)
-			result[i] |= z[i] != refz[i] ? -1 : 0;
-#endif
-		break;
-
-	case GE_COMP_NOTEQUAL:
-#if defined(_M_SSE)
-		result = _mm_or_si128(result, _mm_cmpeq_epi32(z.ivec, refz));
-#else
-		for (int i = 0; i < 4; ++i)
-			result[i] |= z[i] == refz[i] ? -1 : 0;
-#endif
-		break;
-
-	case GE_COMP_LESS:
-#if defined(_M_SSE)
-		result = _mm_or_si128(result, _mm_cmpgt_epi32(z.ivec, refz));
-		result = _mm_or_si128(result, _mm_cmpeq_epi32(z.ivec, refz));
-#else
-		for (int i = 0; i < 4; ++i)
-			result[i] |= z[i] >= refz[i] ? -1 : 0;
-#endif
-		break;
-
-	case GE_COMP_LEQUAL:
-#if defined(_M_SSE)
-		result = _mm_or_si128(result, _mm_cmpgt_epi32(z.ivec, refz));
-#else
-		for (int i = 0; i < 4; ++i)
-			result[i] |= z[i] > refz[i] ? -1 : 0;
-#endif
-		break;
-
-	case GE_COMP_GREATER:
-#if defined(_M_SSE)
-		result = _mm_or_si128(result, _mm_cmplt_epi32(z.ivec, refz));
-		result = _mm_or_si128(result, _mm_cmpeq_epi32(z.ivec, refz));
-#else
-		for (int i = 0; i < 4; ++i)
-			result[i] |= z[i] <= refz[i] ? -1 : 0;
-#endif
-		break;
-
-	case GE_COMP_GEQUAL:
-#if defined(_M_SSE)
-		result = _mm_or_si128(result, _mm_cmplt_epi32(z.ivec, refz));
-#else
-		for (int i = 0; i < 4; ++i)
-			result[i] |= z[i] < refz[i] ? -1 : 0;
-#endif
-		break;
-	}
-
-	return result;
-}
-
 template <bool useSSE4>
 struct TriangleEdge {
 	Vec4<int> Start(const ScreenCoords &v0, const ScreenCoords &v1, const ScreenCoords &origin);
@@ -969,6 +878,61 @@ static inline Vec4<float> EdgeRecip(const Vec4<int> &w0, const Vec4<int> &w1, co
 #endif
 }
 
+// The depth plane of a triangle, to find its depth range within each hi-Z tile.
+struct HiZPlane {
+	void Init(const VertexData &v0, const VertexData &v1, const VertexData &v2) {
+		zmin = std::min(std::min(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z);
+		zmax = std::max(std::max(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z);
+
+		const double dx1 = v1.screenpos.x - v0.screenpos.x, dy1 = v1.screenpos.y - v0.screenpos.y;
+		const double dx2 = v2.screenpos.x - v0.screenpos.x, dy2 = v2.screenpos.y - v0.screenpos.y;
+		const double dz1 = v1.screenpos.z - v0.screenpos.z, dz2 = v2.screenpos.z - v0.screenpos.z;
+		const double denom = dx1 * dy2 - dx2 * dy1;
+		sloped = denom != 0.0 && zmin != zmax;
+		if (sloped) {
+			dzdx = (dz1 * dy2 - dz2 * dy1) / denom;
+			dzdy = (dx1 * dz2 - dx2 * dz1) / denom;
+			z0 = v0.screenpos.z - dzdx * v0.screenpos.x - dzdy * v0.screenpos.y;
+		} else {
+			dzdx = 0.0;
+			dzdy = 0.0;
+			z0 = zmin;
+		}
+	}
+
+	// Flags each tile in [tx1, tx2] of tile row ty where the whole triangle would fail the depth test.
+	void RejectRow(const HiZBuffer &hiZ, GEComparison func, int ty, int tx1, int tx2, uint8_t *reject) const {
+		// Interpolation truncates, so allow a little slack.
+		int lo = zmin - 1;
+		int hi = zmax + 1;
+		// Pixel centers are within the tile, but pad by a pixel to be safe.
+		constexpr double TILE_SPAN = HiZBuffer::TILE_SIZE * SCREEN_SCALE_FACTOR;
+		const double y1 = ty * TILE_SPAN - SCREEN_SCALE_FACTOR;
+		const double y2 = y1 + TILE_SPAN + SCREEN_SCALE_FACTOR * 2;
+		const double rowLo = z0 + dzdy * (dzdy > 0.0 ? y1 : y2);
+		const double rowHi = z0 + dzdy * (dzdy > 0.0 ? y2 : y1);
+
+		for (int tx = tx1; tx <= tx2; ++tx) {
+			if (sloped) {
+				const double x1 = tx * TILE_SPAN - SCREEN_SCALE_FACTOR;
+				const double x2 = x1 + TILE_SPAN + SCREEN_SCALE_FACTOR * 2;
+				const double tileLo = rowLo + dzdx * (dzdx > 0.0 ? x1 : x2);
+				const double tileHi = rowHi + dzdx * (dzdx > 0.0 ? x2 : x1);
+				lo = std::max(zmin - 1, (int)std::max(tileLo - 2.0, -1.0));
+				hi = std::min(zmax + 1, (int)std::min(tileHi + 2.0, 65536.0));
+			}
+			reject[tx - tx1] = hiZ.Rejects(tx, ty, func, lo, hi) ? 1 : 0;
+		}
+	}
+
+	double dzdx;
+	double dzdy;
+	double z0;
+	int zmin;
+	int zmax;
+	bool sloped;
+};
+
 template <bool clearMode, bool useSSE4>
 void DrawTriangleSlice(
 	const VertexData& v0, const VertexData& v1, const VertexData& v2,
@@ -1027,6 +991,23 @@ void DrawTriangleSlice(
 	const Vec4<int> minz = Vec4<int>::AssignToAll(pixelID.cached.minz);
 	const Vec4<int> maxz = Vec4<int>::AssignToAll(pixelID.cached.maxz);
 
+	// Drawing coordinates wrap at 1024 pixels, times the render scale.
+	const int wrapMaskX = RenderScale::Factor() * 1024 - 1;
+
+	// Whole hi-Z tiles the triangle can't pass the depth test in are skipped.
+	const HiZBuffer *hiZ = nullptr;
+	if constexpr (!clearMode) {
+		if (pixelID.earlyZChecks && state.hiZ && state.hiZ->Enabled() && HiZBuffer::CanReject(pixelID.DepthTestFunc()))
+			hiZ = state.hiZ;
+	}
+	HiZPlane hiZPlane;
+	uint8_t hiZReject[HiZBuffer::MAX_TILES];
+	const int hiZCol1 = (int)(minX / SCREEN_SCALE_FACTOR) >> HiZBuffer::TILE_SHIFT;
+	const int hiZCol2 = std::min((int)(maxX / SCREEN_SCALE_FACTOR) >> HiZBuffer::TILE_SHIFT, hiZCol1 + HiZBuffer::MAX_TILES - 1);
+	int hiZRow = -1;
+	if (hiZ)
+		hiZPlane.Init(v0, v1, v2);
+
 	for (int64_t curY = minY; curY <= maxY; curY += SCREEN_SCALE_FACTOR * 2,
 										w0_base = e0.StepY(w0_base),
 										w1_base = e1.StepY(w1_base),
@@ -1046,19 +1027,47 @@ void DrawTriangleSlice(
 		w0 = e0.StepXTimes(w0, skipX);
 		w1 = e1.StepXTimes(w1, skipX);
 		w2 = e2.StepXTimes(w2, skipX);
-		p.x = (p.x + 2 * skipX) & 0x3FF;
+		p.x = (p.x + 2 * skipX) & wrapMaskX;
 
 		// TODO: Maybe we can clip the edges instead?
 		int scissorYPlus1 = curY + SCREEN_SCALE_FACTOR > maxY ? -1 : 0;
 		Vec4<int> scissor_mask = Vec4<int>(0, rowMaxX - rowMinX - SCREEN_SCALE_FACTOR, scissorYPlus1, (rowMaxX - rowMinX - SCREEN_SCALE_FACTOR) | scissorYPlus1);
 		Vec4<int> scissor_step = Vec4<int>(0, -(SCREEN_SCALE_FACTOR * 2), 0, -(SCREEN_SCALE_FACTOR * 2));
 
+		// Quads straddling two tile rows don't get checked.
+		bool hiZActive = false;
+		if (hiZ && (p.y & (HiZBuffer::TILE_SIZE - 1)) != HiZBuffer::TILE_SIZE - 1) {
+			int ty = p.y >> HiZBuffer::TILE_SHIFT;
+			if (ty != hiZRow) {
+				hiZPlane.RejectRow(*hiZ, pixelID.DepthTestFunc(), ty, hiZCol1, hiZCol2, hiZReject);
+				hiZRow = ty;
+			}
+			hiZActive = true;
+		}
+
 		for (int64_t curX = rowMinX; curX <= rowMaxX; curX += SCREEN_SCALE_FACTOR * 2,
 			w0 = e0.StepX(w0),
 			w1 = e1.StepX(w1),
 			w2 = e2.StepX(w2),
 			scissor_mask = scissor_mask + scissor_step,
-			p.x = (p.x + 2) & 0x3FF) {
+			p.x = (p.x + 2) & wrapMaskX) {
+
+			if (hiZActive) {
+				const int col = p.x >> HiZBuffer::TILE_SHIFT;
+				// Quads left entirely inside this tile, including this one.
+				const int quads = (HiZBuffer::TILE_SIZE - (p.x & (HiZBuffer::TILE_SIZE - 1))) >> 1;
+				if (quads > 0 && col >= hiZCol1 && col <= hiZCol2 && hiZReject[col - hiZCol1]) {
+					// Skip to the last of them, the loop steps past it.
+					const int skip = quads - 1;
+					w0 = e0.StepXTimes(w0, skip);
+					w1 = e1.StepXTimes(w1, skip);
+					w2 = e2.StepXTimes(w2, skip);
+					scissor_mask = scissor_mask + scissor_step * skip;
+					p.x = (p.x + 2 * skip) & wrapMaskX;
+					curX += SCREEN_SCALE_FACTOR * 2 * skip;
+					continue;
+				}
+			}
 
 			// If p is on or inside all edges, render pixel
 			Vec4<int> mask = MakeMask(w0, w1, w2, bias0, bias1, bias2, scissor_mask);
@@ -1167,6 +1176,13 @@ void DrawTriangleSlice(
 				}
 
 				PROFILE_THIS_SCOPE("draw_tri_px");
+#if !defined(SOFTGPU_MEMORY_TAGGING_DETAILED)
+				if (state.drawQuad) {
+					state.drawQuad(p.x, p.y, ToVec4IntArg(z), ToVec4IntArg(fog), prim_color, ToVec4IntArg(mask), pixelID);
+					continue;
+				}
+#endif
+
 				DrawingCoords subp = p;
 				for (int i = 0; i < 4; ++i) {
 					if (mask[i] < 0) {
@@ -1311,6 +1327,8 @@ void DrawRectangle(const VertexData &v0, const VertexData &v1, const BinCoords &
 	std::string ztag = StringFromFormat("DisplayListRZ_%08x", state.listPC);
 #endif
 
+	// Drawing coordinates wrap at 1024 pixels, times the render scale.
+	const int wrapMaskX = RenderScale::Factor() * 1024 - 1;
 	for (int64_t curY = minY; curY < maxY; curY += SCREEN_SCALE_FACTOR * 2, rowST += sty) {
 		DrawingCoords p = TransformUnit::ScreenToDrawing(minX, curY);
 
@@ -1322,7 +1340,7 @@ void DrawRectangle(const VertexData &v0, const VertexData &v1, const BinCoords &
 		for (int64_t curX = minX; curX < maxX; curX += SCREEN_SCALE_FACTOR * 2,
 			st += stx,
 			scissor_mask += scissor_step,
-			p.x = (p.x + 2) & 0x3FF) {
+			p.x = (p.x + 2) & wrapMaskX) {
 			Vec4<int> mask = scissor_mask;
 
 			Vec4<int> prim_color[4];
@@ -1367,6 +1385,13 @@ void DrawRectangle(const VertexData &v0, const VertexData &v1, const BinCoords &
 			}
 
 			PROFILE_THIS_SCOPE("draw_rect_px");
+#if !defined(SOFTGPU_MEMORY_TAGGING_DETAILED)
+			if (state.drawQuad) {
+				state.drawQuad(p.x, p.y, ToVec4IntArg(z), ToVec4IntArg(fog), prim_color, ToVec4IntArg(mask), state.pixelID);
+				continue;
+			}
+#endif
+
 			DrawingCoords subp = p;
 			for (int i = 0; i < 4; ++i) {
 				if (mask[i] < 0) {
@@ -1520,6 +1545,9 @@ void ClearRectangle(const VertexData &v0, const VertexData &v1, const BinCoords
 			}
 		}
 
+		if (state.hiZ)
+			state.hiZ->Fill(pprime.x, pprime.y, pend.x, pend.y, z);
+
 #if defined(SOFTGPU_MEMORY_TAGGING_DETAILED) || defined(SOFTGPU_MEMORY_TAGGING_BASIC)
 		std::string tag = StringFromFormat("DisplayListXZ_%08x", state.listPC);
 		for (int y = pprime.y; y <= pend.y; ++y) {
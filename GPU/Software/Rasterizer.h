@@ -34,6 +34,8 @@ class BinManager;
 
 namespace Rasterizer {
 
+class HiZBuffer;
+
 enum class RasterizerStateFlags {
 	NONE = 0,
 	VERTEX_NON_FULL_WHITE = 0x0001,
@@ -69,6 +71,8 @@ struct RasterizerState {
 	PixelFuncID pixelID;
 	SamplerID samplerID;
 	SingleFunc drawPixel;
+	// Only set when drawPixel isn't jitted.
+	QuadFunc drawQuad;
 	Sampler::LinearFunc linear;
 	Sampler::NearestFunc nearest;
 	uint32_t texaddr[8]{};
@@ -77,6 +81,8 @@ struct RasterizerState {
 	float textureLodSlope;
 	RasterizerStateFlags flags = RasterizerStateFlags::NONE;
 	RasterizerStateFlags lastFlags = RasterizerStateFlags::INVALID;
+	// Depth bounds for the depth buffer, kept up to date by the binner.
+	HiZBuffer *hiZ = nullptr;
 
 	struct {
 		uint8_t maxTexLevel : 3;
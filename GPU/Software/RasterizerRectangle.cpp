@@ -2,6 +2,7 @@
 
 #include "ppsspp_config.h"
 #include <cmath>
+#include <algorithm>
 
 #include "Common/Common.h"
 #include "Common/Data/Convert/ColorConv.h"
@@ -15,6 +16,7 @@
 #include "GPU/Software/BinManager.h"
 #include "GPU/Software/DrawPixel.h"
 #include "GPU/Software/Rasterizer.h"
+#include "GPU/Software/RenderScale.h"
 #include "GPU/Software/Sampler.h"
 #include "GPU/Software/SoftGpu.h"
 #include "Common/Math/SIMDHeaders.h"
@@ -215,61 +217,222 @@ static inline Vec4IntResult SOFTRAST_CALL ModulateRGBA(Vec4IntArg prim_in, Vec4I
 	return ToVec4IntResult(out);
 }
 
+// Blends four 8888 pixels at once, the same as DrawSinglePixel32() on each.
+// With alphaTestZero, pixels with zero alpha are left alone.
+template <bool alphaBlend, bool alphaTestZero>
+static inline void DrawPixels4(u32 *dst, const u32 *src) {
+#if defined(_M_SSE)
+	const __m128i s = _mm_loadu_si128((const __m128i *)src);
+	const __m128i d = _mm_loadu_si128((const __m128i *)dst);
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i srcAlpha = _mm_and_si128(s, alphaMask);
+
+	__m128i color = s;
+	if (alphaBlend) {
+		// Same math as StandardAlphaBlend(), two pixels per register.
+		const __m128i z = _mm_setzero_si128();
+		const __m128i half = _mm_set1_epi16(1 << 3);
+		const __m128i full = _mm_set1_epi16(255);
+		__m128i blended[2];
+		for (int i = 0; i < 2; ++i) {
+			const __m128i s16 = i == 0 ? _mm_unpacklo_epi8(s, z) : _mm_unpackhi_epi8(s, z);
+			const __m128i d16 = i == 0 ? _mm_unpacklo_epi8(d, z) : _mm_unpackhi_epi8(d, z);
+			const __m128i a16 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+			const __m128i sf = _mm_add_epi16(_mm_slli_epi16(a16, 4), half);
+			const __m128i df = _mm_add_epi16(_mm_slli_epi16(_mm_sub_epi16(full, a16), 4), half);
+			const __m128i sv = _mm_mulhi_epi16(_mm_add_epi16(_mm_slli_epi16(s16, 4), half), sf);
+			const __m128i dv = _mm_mulhi_epi16(_mm_add_epi16(_mm_slli_epi16(d16, 4), half), df);
+			blended[i] = _mm_adds_epi16(sv, dv);
+		}
+
+		// Opaque pixels aren't blended at all.
+		const __m128i opaque = _mm_cmpeq_epi32(srcAlpha, alphaMask);
+		color = _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, _mm_packus_epi16(blended[0], blended[1])));
+	}
+
+	// Dest alpha is always kept.
+	color = _mm_or_si128(_mm_andnot_si128(alphaMask, color), _mm_and_si128(d, alphaMask));
+	if (alphaTestZero) {
+		const __m128i skip = _mm_cmpeq_epi32(srcAlpha, _mm_setzero_si128());
+		color = _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, color));
+	}
+	_mm_storeu_si128((__m128i *)dst, color);
+#elif PPSSPP_ARCH(ARM64_NEON)
+	const uint32x4_t s = vld1q_u32(src);
+	const uint32x4_t d = vld1q_u32(dst);
+	const uint32x4_t alphaMask = vdupq_n_u32(0xFF000000);
+	const uint32x4_t srcAlpha = vandq_u32(s, alphaMask);
+
+	uint32x4_t color = s;
+	if (alphaBlend) {
+		static const uint8_t alphaIndices[16] = { 3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15 };
+		const uint8x16_t s8 = vreinterpretq_u8_u32(s);
+		const uint8x16_t d8 = vreinterpretq_u8_u32(d);
+		const uint8x16_t a8 = vqtbl1q_u8(s8, vld1q_u8(alphaIndices));
+
+		// Same math as StandardAlphaBlend(), (2s + 1) * (2a + 1) >> 10 on each side.
+		// Pre-shifting by 5 lets vqdmulh do the multiply and shift in 16 bits.
+		const uint16x8_t one = vdupq_n_u16(1);
+		uint8x8_t blended[2];
+		for (int i = 0; i < 2; ++i) {
+			const uint16x8_t s16 = vmovl_u8(i == 0 ? vget_low_u8(s8) : vget_high_u8(s8));
+			const uint16x8_t d16 = vmovl_u8(i == 0 ? vget_low_u8(d8) : vget_high_u8(d8));
+			const uint16x8_t a16 = vmovl_u8(i == 0 ? vget_low_u8(a8) : vget_high_u8(a8));
+
+			const int16x8_t sf = vreinterpretq_s16_u16(vaddq_u16(vshlq_n_u16(a16, 1), one));
+			const int16x8_t df = vreinterpretq_s16_u16(vaddq_u16(vshlq_n_u16(vsubq_u16(vdupq_n_u16(255), a16), 1), one));
+			const int16x8_t sv = vreinterpretq_s16_u16(vshlq_n_u16(vaddq_u16(vshlq_n_u16(s16, 1), one), 5));
+			const int16x8_t dv = vreinterpretq_s16_u16(vshlq_n_u16(vaddq_u16(vshlq_n_u16(d16, 1), one), 5));
+			blended[i] = vqmovun_s16(vqaddq_s16(vqdmulhq_s16(sv, sf), vqdmulhq_s16(dv, df)));
+		}
+
+		// Opaque pixels aren't blended at all.
+		const uint32x4_t opaque = vceqq_u32(srcAlpha, alphaMask);
+		color = vbslq_u32(opaque, s, vreinterpretq_u32_u8(vcombine_u8(blended[0], blended[1])));
+	}
+
+	// Dest alpha is always kept.
+	color = vbslq_u32(alphaMask, d, color);
+	if (alphaTestZero)
+		color = vbslq_u32(vceqq_u32(srcAlpha, vdupq_n_u32(0)), d, color);
+	vst1q_u32(dst, color);
+#else
+	for (int i = 0; i < 4; ++i) {
+		if (!alphaTestZero || (src[i] >> 24) != 0)
+			DrawSinglePixel32<alphaBlend>(&dst[i], src[i]);
+	}
+#endif
+}
+
+template <bool alphaBlend, bool alphaTestZero>
+static inline void DrawPixels(u32 *dst, const u32 *src, int count) {
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+		DrawPixels4<alphaBlend, alphaTestZero>(dst + i, src + i);
+	for (; i < count; ++i) {
+		if (!alphaTestZero || (src[i] >> 24) != 0)
+			DrawSinglePixel32<alphaBlend>(&dst[i], src[i]);
+	}
+}
+
+// Modulates four texture colors by the prim color, the same as ModulateRGBA() and ToRGBA() on each.
+static inline void ModulateColors4(u32 *colors, u32 prim, const SamplerID &samplerID) {
+#if defined(_M_SSE)
+	const __m128i z = _mm_setzero_si128();
+	const __m128i c = _mm_loadu_si128((const __m128i *)colors);
+	const __m128i p = _mm_unpacklo_epi8(_mm_set1_epi32(prim), z);
+	const __m128i pboost = _mm_add_epi16(_mm_slli_epi16(p, 4), _mm_set1_epi16(1 << 4));
+	const __m128i rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+	__m128i result[2];
+	for (int i = 0; i < 2; ++i) {
+		__m128i t = _mm_slli_epi16(i == 0 ? _mm_unpacklo_epi8(c, z) : _mm_unpackhi_epi8(c, z), 4);
+		if (samplerID.useColorDoubling)
+			t = _mm_add_epi16(t, _mm_and_si128(t, rgbMask));
+		result[i] = _mm_mulhi_epi16(pboost, t);
+	}
+	_mm_storeu_si128((__m128i *)colors, _mm_packus_epi16(result[0], result[1]));
+#elif PPSSPP_ARCH(ARM64_NEON)
+	const uint8x16_t c8 = vld1q_u8((const uint8_t *)colors);
+	const uint16x4_t pboost = vadd_u16(vget_low_u16(vmovl_u8(vcreate_u8(prim))), vdup_n_u16(1));
+
+	uint8x8_t result[2];
+	for (int i = 0; i < 2; ++i) {
+		uint16x8_t t = vmovl_u8(i == 0 ? vget_low_u8(c8) : vget_high_u8(c8));
+		if (samplerID.useColorDoubling) {
+			static const int16_t rgbDouble[8] = { 1, 1, 1, 0, 1, 1, 1, 0 };
+			t = vshlq_u16(t, vld1q_s16(rgbDouble));
+		}
+		// Doubled colors can overflow 16 bits, so multiply into 32.
+		const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(t), pboost), 8);
+		const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(t), pboost), 8);
+		result[i] = vqmovn_u16(vcombine_u16(lo, hi));
+	}
+	vst1q_u8((uint8_t *)colors, vcombine_u8(result[0], result[1]));
+#else
+	const Vec4<int> prim_color = Vec4<int>::FromRGBA(prim);
+	for (int i = 0; i < 4; ++i) {
+		Vec4<int> tex_color = Vec4<int>::FromRGBA(colors[i]);
+		colors[i] = Vec4<int>(ModulateRGBA(ToVec4IntArg(prim_color), ToVec4IntArg(tex_color), samplerID)).ToRGBA();
+	}
+#endif
+}
+
+// Pixels of a sprite row handled at once: first all fetched, then modulated, then blended.
+static constexpr int SPRITE_CHUNK = 64;
+
+// Draws pos0 to pos1 of a sprite starting at origin, with each texel covering 1 << shift pixels on each axis.
 template <GEBufferFormat fmt, bool isWhite, bool alphaBlend, bool alphaTestZero>
-static void DrawSpriteTex(const DrawingCoords &pos0, const DrawingCoords &pos1, int s_start, int t_start, int ds, int dt, u32 color0, const RasterizerState &state, Sampler::FetchFunc fetchFunc) {
+static void DrawSpriteTex(const DrawingCoords &pos0, const DrawingCoords &pos1, const DrawingCoords &origin, int s_start, int t_start, int ds, int dt, int shiftX, int shiftY, u32 color0, const RasterizerState &state, Sampler::FetchFunc fetchFunc) {
 	const u8 *texptr = state.texptr[0];
 	uint16_t texbufw = state.texbufw[0];
+	const int stride = state.pixelID.cached.framebufStride;
 
-	int t = t_start;
-	const Vec4<int> c0 = Vec4<int>::FromRGBA(color0);
+	alignas(16) u32 colors[SPRITE_CHUNK];
+	alignas(16) u32 dest[SPRITE_CHUNK];
 	for (int y = pos0.y; y < pos1.y; y++) {
-		int s = s_start;
-		u16 *pixel16 = fb.Get16Ptr(pos0.x, y, state.pixelID.cached.framebufStride);
-		u32 *pixel32 = fb.Get32Ptr(pos0.x, y, state.pixelID.cached.framebufStride);
-		for (int x = pos0.x; x < pos1.x; x++) {
-			Vec4<int> tex_color = fetchFunc(s, t, texptr, texbufw, 0, state.samplerID);
-			if (isWhite) {
-				if (!alphaTestZero || tex_color.a() != 0) {
-					u32 tex_color32 = tex_color.ToRGBA();
-					if (fmt == GE_FORMAT_8888)
-						DrawSinglePixel32<alphaBlend>(pixel32, tex_color32);
-					else
-						DrawSinglePixel<fmt, alphaBlend>(pixel16, tex_color32);
-				}
-			} else {
-				Vec4<int> prim_color = c0;
-				prim_color = Vec4<int>(ModulateRGBA(ToVec4IntArg(prim_color), ToVec4IntArg(tex_color), state.samplerID));
-				if (!alphaTestZero || prim_color.a() > 0) {
-					if (fmt == GE_FORMAT_8888)
-						DrawSinglePixel32<alphaBlend>(pixel32, prim_color.ToRGBA());
-					else
-						DrawSinglePixel<fmt, alphaBlend>(pixel16, prim_color.ToRGBA());
+		const int t = t_start + ((y - origin.y) >> shiftY) * dt;
+		for (int x = pos0.x; x < pos1.x; x += SPRITE_CHUNK) {
+			const int count = std::min(SPRITE_CHUNK, pos1.x - x);
+
+			// When scaled up, each texel is only fetched once.
+			int lastS = 0;
+			for (int i = 0; i < count; ++i) {
+				const int s = s_start + ((x + i - origin.x) >> shiftX) * ds;
+				if (i != 0 && s == lastS) {
+					colors[i] = colors[i - 1];
+					continue;
 				}
+				colors[i] = Vec4<int>(fetchFunc(s, t, texptr, texbufw, 0, state.samplerID)).ToRGBA();
+				lastS = s;
+			}
+
+			if (!isWhite) {
+				for (int i = count; i < ((count + 3) & ~3); ++i)
+					colors[i] = 0;
+				for (int i = 0; i < count; i += 4)
+					ModulateColors4(&colors[i], color0, state.samplerID);
+			}
+
+			if (fmt == GE_FORMAT_8888) {
+				DrawPixels<alphaBlend, alphaTestZero>(fb.Get32Ptr(x, y, stride), colors, count);
+				continue;
+			}
+
+			// The round trip through 8888 is lossless, so untouched pixels stay the same.
+			u16 *row = fb.Get16Ptr(x, y, stride);
+			switch (fmt) {
+			case GE_FORMAT_565: ConvertRGB565ToRGBA8888(dest, row, count); break;
+			case GE_FORMAT_5551: ConvertRGBA5551ToRGBA8888(dest, row, count); break;
+			case GE_FORMAT_4444: ConvertRGBA4444ToRGBA8888(dest, row, count); break;
+			default: break;
+			}
+			DrawPixels<alphaBlend, alphaTestZero>(dest, colors, count);
+			switch (fmt) {
+			case GE_FORMAT_565: ConvertRGBA8888ToRGB565(row, dest, count); break;
+			case GE_FORMAT_5551: ConvertRGBA8888ToRGBA5551(row, dest, count); break;
+			case GE_FORMAT_4444: ConvertRGBA8888ToRGBA4444(row, dest, count); break;
+			default: break;
 			}
-			s += ds;
-			if (fmt == GE_FORMAT_8888)
-				pixel32++;
-			else
-				pixel16++;
 		}
-		t += dt;
 	}
 }
 
 template <bool isWhite, bool alphaBlend, bool alphaTestZero>
-static void DrawSpriteTex(const DrawingCoords &pos0, const DrawingCoords &pos1, int s_start, int t_start, int ds, int dt, u32 color0, const RasterizerState &state, Sampler::FetchFunc fetchFunc) {
+static void DrawSpriteTex(const DrawingCoords &pos0, const DrawingCoords &pos1, const DrawingCoords &origin, int s_start, int t_start, int ds, int dt, int shiftX, int shiftY, u32 color0, const RasterizerState &state, Sampler::FetchFunc fetchFunc) {
 	switch (state.pixelID.FBFormat()) {
 	case GE_FORMAT_565:
-		DrawSpriteTex<GE_FORMAT_565, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, s_start, t_start, ds, dt, color0, state, fetchFunc);
+		DrawSpriteTex<GE_FORMAT_565, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, color0, state, fetchFunc);
 		break;
 	case GE_FORMAT_5551:
-		DrawSpriteTex<GE_FORMAT_5551, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, s_start, t_start, ds, dt, color0, state, fetchFunc);
+		DrawSpriteTex<GE_FORMAT_5551, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, color0, state, fetchFunc);
 		break;
 	case GE_FORMAT_4444:
-		DrawSpriteTex<GE_FORMAT_4444, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, s_start, t_start, ds, dt, color0, state, fetchFunc);
+		DrawSpriteTex<GE_FORMAT_4444, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, color0, state, fetchFunc);
 		break;
 	case GE_FORMAT_8888:
-		DrawSpriteTex<GE_FORMAT_8888, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, s_start, t_start, ds, dt, color0, state, fetchFunc);
+		DrawSpriteTex<GE_FORMAT_8888, isWhite, alphaBlend, alphaTestZero>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, color0, state, fetchFunc);
 		break;
 	default:
 		// Invalid, don't draw anything...
@@ -278,14 +441,39 @@ static void DrawSpriteTex(const DrawingCoords &pos0, const DrawingCoords &pos1,
 }
 
 template <bool isWhite>
-static inline void DrawSpriteTex(const DrawingCoords &pos0, const DrawingCoords &pos1, int s_start, int t_start, int ds, int dt, u32 color0, const RasterizerState &state, Sampler::FetchFunc fetchFunc) {
+static inline void DrawSpriteTex(const DrawingCoords &pos0, const DrawingCoords &pos1, const DrawingCoords &origin, int s_start, int t_start, int ds, int dt, int shiftX, int shiftY, u32 color0, const RasterizerState &state, Sampler::FetchFunc fetchFunc) {
 	// Standard alpha blending implies skipping alpha zero.
 	if (state.pixelID.alphaBlend)
-		DrawSpriteTex<isWhite, true, true>(pos0, pos1, s_start, t_start, ds, dt, color0, state, fetchFunc);
+		DrawSpriteTex<isWhite, true, true>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, color0, state, fetchFunc);
 	else if (state.pixelID.AlphaTestFunc() != GE_COMP_ALWAYS)
-		DrawSpriteTex<isWhite, false, true>(pos0, pos1, s_start, t_start, ds, dt, color0, state, fetchFunc);
+		DrawSpriteTex<isWhite, false, true>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, color0, state, fetchFunc);
 	else
-		DrawSpriteTex<isWhite, false, false>(pos0, pos1, s_start, t_start, ds, dt, color0, state, fetchFunc);
+		DrawSpriteTex<isWhite, false, false>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, color0, state, fetchFunc);
+}
+
+// Whether a textured sprite can use DrawSpriteTex(), which also handles scaled sprites.
+static bool UseSpriteBlit(const RasterizerState &state) {
+	const SamplerID &samplerID = state.samplerID;
+	if (!UseDrawSinglePixel(state.pixelID) || !samplerID.useTextureAlpha)
+		return false;
+	return samplerID.TexFunc() == GE_TEXFUNC_MODULATE || samplerID.TexFunc() == GE_TEXFUNC_REPLACE;
+}
+
+// Drawing pixels per texel of a sprite, as a shift.  Returns -1 if not a power of two up to 8.
+static inline int SpriteScaleShift(int screenDiff, int texDiff) {
+	texDiff = std::abs(texDiff);
+	for (int shift = 0; shift <= 3; ++shift) {
+		if (screenDiff == (texDiff << shift))
+			return shift;
+	}
+	return -1;
+}
+
+static inline void GetSpriteScale(const VertexData &v0, const VertexData &v1, int *shiftX, int *shiftY) {
+	int udiff = (v1.texturecoords.x - v0.texturecoords.x) * (float)SCREEN_SCALE_FACTOR;
+	int vdiff = (v1.texturecoords.y - v0.texturecoords.y) * (float)SCREEN_SCALE_FACTOR;
+	*shiftX = SpriteScaleShift(v1.screenpos.x - v0.screenpos.x, udiff);
+	*shiftY = SpriteScaleShift(v1.screenpos.y - v0.screenpos.y, vdiff);
 }
 
 template <GEBufferFormat fmt, bool alphaBlend>
@@ -377,23 +565,31 @@ void DrawSprite(const VertexData &v0, const VertexData &v1, const BinCoords &ran
 		// First clip the right and bottom sides, since we don't need to adjust the deltas.
 		if (pos1.x > scissorBR.x) pos1.x = scissorBR.x + 1;
 		if (pos1.y > scissorBR.y) pos1.y = scissorBR.y + 1;
-		// Now clip the other sides.
-		if (pos0.x < scissorTL.x) {
-			s_start += (scissorTL.x - pos0.x) * ds;
-			pos0.x = scissorTL.x;
-		}
-		if (pos0.y < scissorTL.y) {
-			t_start += (scissorTL.y - pos0.y) * dt;
-			pos0.y = scissorTL.y;
-		}
 
-		if (UseDrawSinglePixel(pixelID) && (samplerID.TexFunc() == GE_TEXFUNC_MODULATE || samplerID.TexFunc() == GE_TEXFUNC_REPLACE) && samplerID.useTextureAlpha) {
+		if (UseSpriteBlit(state)) {
+			// This finds texels from the offset to the origin, so it handles scaling the same way.
+			const DrawingCoords origin = pos0;
+			if (pos0.x < scissorTL.x) pos0.x = scissorTL.x;
+			if (pos0.y < scissorTL.y) pos0.y = scissorTL.y;
+
+			int shiftX, shiftY;
+			GetSpriteScale(v0, v1, &shiftX, &shiftY);
 			if (isWhite || samplerID.TexFunc() == GE_TEXFUNC_REPLACE) {
-				DrawSpriteTex<true>(pos0, pos1, s_start, t_start, ds, dt, v1.color0, state, fetchFunc);
+				DrawSpriteTex<true>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, v1.color0, state, fetchFunc);
 			} else {
-				DrawSpriteTex<false>(pos0, pos1, s_start, t_start, ds, dt, v1.color0, state, fetchFunc);
+				DrawSpriteTex<false>(pos0, pos1, origin, s_start, t_start, ds, dt, shiftX, shiftY, v1.color0, state, fetchFunc);
 			}
 		} else {
+			// Only 1:1 sprites get here.  Now clip the other sides.
+			if (pos0.x < scissorTL.x) {
+				s_start += (scissorTL.x - pos0.x) * ds;
+				pos0.x = scissorTL.x;
+			}
+			if (pos0.y < scissorTL.y) {
+				t_start += (scissorTL.y - pos0.y) * dt;
+				pos0.y = scissorTL.y;
+			}
+
 			float dsf = ds * (1.0f / (float)(1 << state.samplerID.width0Shift));
 			float dtf = dt * (1.0f / (float)(1 << state.samplerID.height0Shift));
 			float sf_start = s_start * (1.0f / (float)(1 << state.samplerID.width0Shift));
@@ -489,8 +685,8 @@ bool RectangleFastPath(const VertexData &v0, const VertexData &v1, BinManager &b
 	g_DarkStalkerStretch = DSStretch::Off;
 
 	// Eliminate the stretch blit in DarkStalkers.
-	// We compensate for that when blitting the framebuffer in SoftGpu.cpp.
-	if (PSP_CoreParameter().compat.flags().DarkStalkersPresentHack && v0.texturecoords.x == 64.0f && v0.texturecoords.y == 16.0f && v1.texturecoords.x == 448.0f && v1.texturecoords.y == 240.0f) {
+	// We compensate for that when blitting the framebuffer in SoftGpu.cpp, which only handles 1x.
+	if (PSP_CoreParameter().compat.flags().DarkStalkersPresentHack && RenderScale::Factor() == 1 && v0.texturecoords.x == 64.0f && v0.texturecoords.y == 16.0f && v1.texturecoords.x == 448.0f && v1.texturecoords.y == 240.0f) {
 		// check for save/load dialog.
 		if (!currentDialogActive) {
 			if (v0.screenpos.x + gstate.getOffsetX16() == 0x7100 && v0.screenpos.y + gstate.getOffsetY16() == 0x7780 && v1.screenpos.x + gstate.getOffsetX16() == 0x8f00 && v1.screenpos.y + gstate.getOffsetY16() == 0x8880) {
@@ -516,10 +712,9 @@ bool RectangleFastPath(const VertexData &v0, const VertexData &v1, BinManager &b
 	}
 
 	// Check for 1:1 texture mapping. In that case we can call DrawSprite.
+	// It can also blit sprites scaled up by a power of two, which includes 1:1 at a render scale.
 	int xdiff = v1.screenpos.x - v0.screenpos.x;
 	int ydiff = v1.screenpos.y - v0.screenpos.y;
-	int udiff = (v1.texturecoords.x - v0.texturecoords.x) * (float)SCREEN_SCALE_FACTOR;
-	int vdiff = (v1.texturecoords.y - v0.texturecoords.y) * (float)SCREEN_SCALE_FACTOR;
 
 	// Currently only works for TL/BR, which is the most common but not required.
 	bool orient_check = xdiff >= 0 && ydiff >= 0;
@@ -528,7 +723,10 @@ bool RectangleFastPath(const VertexData &v0, const VertexData &v1, BinManager &b
 	bool coord_check = true;
 	if (state.enableTextures) {
 		state_check = state_check && NoClampOrWrap(state, v0.texturecoords.uv()) && NoClampOrWrap(state, v1.texturecoords.uv());
-		coord_check = (xdiff == udiff || xdiff == -udiff) && (ydiff == vdiff || ydiff == -vdiff);
+		int shiftX, shiftY;
+		GetSpriteScale(v0, v1, &shiftX, &shiftY);
+		// Only the blit path handles scaled sprites.
+		coord_check = (shiftX == 0 && shiftY == 0) || (shiftX >= 0 && shiftY >= 0 && UseSpriteBlit(state));
 	}
 	// This doesn't work well with offset drawing, see #15876.  Through never has a subpixel offset.
 	bool subpixel_check = ((v0.screenpos.x | v0.screenpos.y | v1.screenpos.x | v1.screenpos.y) & 0xF) == 0;
@@ -0,0 +1,351 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "Common/Common.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Core/Config.h"
+#include "Core/MemMap.h"
+#include "GPU/GPUState.h"
+#include "GPU/Software/RenderScale.h"
+#include "GPU/Software/SoftGpu.h"
+#include "GPU/Software/TransformUnit.h"
+
+namespace RenderScale {
+
+int g_factor = 1;
+int g_shift = 0;
+
+// A few targets is plenty, games usually ping-pong between two or three.
+static constexpr int MAX_SHADOWS = 8;
+// Rows are allocated in steps, so growing scissors don't reallocate every draw.
+static constexpr int ROW_ALIGN = 16;
+
+struct Shadow {
+	uint32_t addr = 0;
+	int stride = 0;
+	GEBufferFormat fmt = GE_FORMAT_8888;
+	bool depth = false;
+	// Native rows allocated, and how many of those are backed by valid memory.
+	int rows = 0;
+	int vramRows = 0;
+	uint64_t lastUse = 0;
+
+	std::vector<uint8_t> scaled;
+	// What we last saw in or wrote to VRAM, to notice when something else changed it.
+	std::vector<uint8_t> native;
+
+	// Native rows already checked against VRAM since the last flush.
+	int syncedY1 = 0;
+	int syncedY2 = -1;
+	// Native area drawn to since the last flush.
+	int dirtyX1 = 0x7FFF;
+	int dirtyY1 = 0x7FFF;
+	int dirtyX2 = -1;
+	int dirtyY2 = -1;
+
+	int Bpp() const {
+		return depth || fmt != GE_FORMAT_8888 ? 2 : 4;
+	}
+	bool Matches(uint32_t a, int s, GEBufferFormat f, bool d) const {
+		return rows != 0 && addr == a && stride == s && depth == d && (d || fmt == f);
+	}
+};
+
+static Shadow shadows[MAX_SHADOWS];
+static Shadow *boundColor;
+static Shadow *boundDepth;
+static uint64_t useCounter;
+
+// Channels are averaged when downsampling.  The rest (alpha/stencil, depth) comes from one sample.
+struct ChannelMasks {
+	uint32_t avg[3];
+	uint32_t keep;
+};
+
+static ChannelMasks MasksFor(const Shadow &s) {
+	if (s.depth)
+		return { { 0, 0, 0 }, 0xFFFF };
+	switch (s.fmt) {
+	case GE_FORMAT_565: return { { 0x001F, 0x07E0, 0xF800 }, 0 };
+	case GE_FORMAT_5551: return { { 0x001F, 0x03E0, 0x7C00 }, 0x8000 };
+	case GE_FORMAT_4444: return { { 0x000F, 0x00F0, 0x0F00 }, 0xF000 };
+	default: return { { 0x000000FF, 0x0000FF00, 0x00FF0000 }, 0xFF000000 };
+	}
+}
+
+template <typename T>
+static void UpsampleRows(Shadow &s, int y1, int y2, bool force) {
+	const int n = g_factor;
+	const int scaledStride = s.stride * n;
+	const T *vram = (const T *)Memory::GetPointer(s.addr);
+	for (int y = y1; y <= y2; ++y) {
+		const T *src = vram + y * s.stride;
+		T *old = (T *)s.native.data() + y * s.stride;
+		if (!force && memcmp(src, old, s.stride * sizeof(T)) == 0)
+			continue;
+
+		// Only replace what changed, so we keep the detail of anything else on the row.
+		T *dst = (T *)s.scaled.data() + y * n * scaledStride;
+		for (int x = 0; x < s.stride; ++x) {
+			if (!force && src[x] == old[x])
+				continue;
+			for (int sy = 0; sy < n; ++sy) {
+				T *block = dst + sy * scaledStride + x * n;
+				for (int sx = 0; sx < n; ++sx)
+					block[sx] = src[x];
+			}
+			old[x] = src[x];
+		}
+	}
+}
+
+static void SyncRows(Shadow &s, int y1, int y2, bool force) {
+	y2 = std::min(y2, s.vramRows - 1);
+	if (y1 > y2)
+		return;
+	if (s.Bpp() == 4)
+		UpsampleRows<uint32_t>(s, y1, y2, force);
+	else
+		UpsampleRows<uint16_t>(s, y1, y2, force);
+}
+
+// Makes sure rows y1-y2 reflect VRAM, checking each row only once per flush.
+static void SyncRange(Shadow &s, int y1, int y2) {
+	if (s.syncedY1 > s.syncedY2) {
+		SyncRows(s, y1, y2, false);
+		s.syncedY1 = y1;
+		s.syncedY2 = y2;
+		return;
+	}
+
+	if (y1 < s.syncedY1)
+		SyncRows(s, y1, s.syncedY1 - 1, false);
+	if (y2 > s.syncedY2)
+		SyncRows(s, s.syncedY2 + 1, y2, false);
+	s.syncedY1 = std::min(s.syncedY1, y1);
+	s.syncedY2 = std::max(s.syncedY2, y2);
+}
+
+static void Allocate(Shadow &s, int rows) {
+	rows = (rows + ROW_ALIGN - 1) & ~(ROW_ALIGN - 1);
+	if (rows <= s.rows)
+		return;
+
+	const int n = g_factor;
+	const int bpp = s.Bpp();
+	const size_t rowBytes = (size_t)s.stride * bpp;
+	// Pad for draws that run past the stride on the last row, like they would into VRAM.
+	const size_t scaledBytes = rows * n * rowBytes * n + 1024 * n * bpp;
+
+	const int oldRows = s.rows;
+	s.scaled.resize(scaledBytes);
+	s.native.resize(rows * rowBytes);
+	s.rows = rows;
+	s.vramRows = rowBytes == 0 ? 0 : std::min(rows, (int)(Memory::ValidSize(s.addr, (u32)(rows * rowBytes)) / rowBytes));
+
+	// Anything new starts out as whatever is in VRAM.
+	SyncRows(s, oldRows, s.vramRows - 1, true);
+}
+
+static Shadow *FindOrCreate(uint32_t addr, int stride, GEBufferFormat fmt, bool depth) {
+	Shadow *oldest = &shadows[0];
+	for (Shadow &s : shadows) {
+		if (s.Matches(addr, stride, fmt, depth))
+			return &s;
+		// Never evict a bound one, it may be waiting to resolve.
+		if (&s == boundColor || &s == boundDepth)
+			continue;
+		if (oldest == boundColor || oldest == boundDepth || s.lastUse < oldest->lastUse)
+			oldest = &s;
+	}
+
+	*oldest = Shadow();
+	oldest->addr = addr;
+	oldest->stride = stride;
+	oldest->fmt = fmt;
+	oldest->depth = depth;
+	return oldest;
+}
+
+static void MarkDirty(Shadow &s, const DrawingCoords &tl, const DrawingCoords &br) {
+	s.dirtyX1 = std::min(s.dirtyX1, (int)tl.x);
+	s.dirtyY1 = std::min(s.dirtyY1, (int)tl.y);
+	s.dirtyX2 = std::max(s.dirtyX2, (int)br.x);
+	s.dirtyY2 = std::max(s.dirtyY2, (int)br.y);
+}
+
+static void ClearDirty(Shadow &s) {
+	s.dirtyX1 = 0x7FFF;
+	s.dirtyY1 = 0x7FFF;
+	s.dirtyX2 = -1;
+	s.dirtyY2 = -1;
+	s.syncedY1 = 0;
+	s.syncedY2 = -1;
+}
+
+static bool PrepareTarget(Shadow *&bound, FormatBuffer &buf, uint32_t addr, int stride, GEBufferFormat fmt, bool depth, const DrawingCoords &tl, const DrawingCoords &br, bool idle) {
+	// Zero stride is degenerate, just give each row its own pixel.
+	stride = std::max(stride, 1);
+	const bool isBound = bound && bound->Matches(addr, stride, fmt, depth) && buf.data == bound->scaled.data();
+	if (!isBound || br.y >= bound->rows) {
+		// Both switching and growing move the buffer out from under queued draws.
+		if (!idle)
+			return false;
+
+		Shadow *s = FindOrCreate(addr, stride, fmt, depth);
+		Allocate(*s, br.y + 1);
+		bound = s;
+		buf.data = s->scaled.data();
+	}
+
+	bound->lastUse = ++useCounter;
+	SyncRange(*bound, tl.y, br.y);
+	MarkDirty(*bound, tl, br);
+	return true;
+}
+
+bool PrepareTargets(const DrawingCoords &tl, const DrawingCoords &br, bool useDepth, bool idle) {
+	if (tl.x > br.x || tl.y > br.y)
+		return true;
+
+	uint32_t fbAddr = gstate.getFrameBufAddress() & 0x041FFFFF;
+	if (!PrepareTarget(boundColor, fb, fbAddr, gstate.FrameBufStride(), gstate.FrameBufFormat(), false, tl, br, idle))
+		return false;
+	if (useDepth) {
+		uint32_t zAddr = gstate.getDepthBufAddress() & 0x041FFFF0;
+		if (!PrepareTarget(boundDepth, depthbuf, zAddr, gstate.DepthBufStride(), GE_FORMAT_565, true, tl, br, idle))
+			return false;
+	}
+	return true;
+}
+
+template <typename T>
+static void DownsampleRows(Shadow &s, const ChannelMasks &m, int x1, int x2, int y1, int y2) {
+	const int n = g_factor;
+	const int sampleShift = g_shift * 2;
+	const int scaledStride = s.stride * n;
+	T *vram = (T *)Memory::GetPointerWrite(s.addr);
+	for (int y = y1; y < y2; ++y) {
+		T *dst = vram + y * s.stride;
+		T *old = (T *)s.native.data() + y * s.stride;
+		const T *src = (const T *)s.scaled.data() + y * n * scaledStride;
+		for (int x = x1; x <= x2; ++x) {
+			const T *block = src + x * n;
+			uint32_t sum0 = 0, sum1 = 0, sum2 = 0;
+			for (int sy = 0; sy < n; ++sy) {
+				for (int sx = 0; sx < n; ++sx) {
+					uint32_t c = block[sy * scaledStride + sx];
+					sum0 += c & m.avg[0];
+					sum1 += c & m.avg[1];
+					sum2 += c & m.avg[2];
+				}
+			}
+
+			T value = (T)((block[0] & m.keep) | ((sum0 >> sampleShift) & m.avg[0]) | ((sum1 >> sampleShift) & m.avg[1]) | ((sum2 >> sampleShift) & m.avg[2]));
+			dst[x] = value;
+			old[x] = value;
+		}
+	}
+}
+
+static void ResolveShadow(Shadow &s) {
+	const int x1 = std::max(s.dirtyX1, 0);
+	const int x2 = std::min(s.dirtyX2, s.stride - 1);
+	const int y1 = std::max(s.dirtyY1, 0);
+	const int y2 = std::min(s.dirtyY2, s.vramRows - 1);
+	ClearDirty(s);
+	if (x1 > x2 || y1 > y2)
+		return;
+
+	const ChannelMasks masks = MasksFor(s);
+	const bool wide = s.Bpp() == 4;
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		if (wide)
+			DownsampleRows<uint32_t>(s, masks, x1, x2, l, h);
+		else
+			DownsampleRows<uint16_t>(s, masks, x1, x2, l, h);
+	}, y1, y2 + 1, 16);
+}
+
+void Resolve() {
+	if (g_factor == 1)
+		return;
+
+	if (boundColor)
+		ResolveShadow(*boundColor);
+	if (boundDepth)
+		ResolveShadow(*boundDepth);
+	// Anything might have changed VRAM before the next draw, so sync again then.
+	for (Shadow &s : shadows) {
+		s.syncedY1 = 0;
+		s.syncedY2 = -1;
+	}
+}
+
+const uint8_t *GetDisplayBuffer(uint32_t addr, int stride, GEBufferFormat fmt, int height, int *scaledStride) {
+	if (g_factor == 1 || !Memory::IsVRAMAddress(addr) || stride <= 0)
+		return nullptr;
+
+	addr &= 0x041FFFFF;
+	for (Shadow &s : shadows) {
+		if (!s.Matches(addr, stride, fmt, false) || s.vramRows < height)
+			continue;
+
+		// If the CPU or a block transfer drew something, pick that up too.
+		SyncRows(s, 0, height - 1, false);
+		*scaledStride = stride * g_factor;
+		return s.scaled.data();
+	}
+	return nullptr;
+}
+
+static int ConfigFactor() {
+	return 1 << std::clamp(g_Config.iSoftwareRenderScale, 0, 2);
+}
+
+bool NeedsUpdate() {
+	return ConfigFactor() != g_factor;
+}
+
+bool Update() {
+	int factor = ConfigFactor();
+	if (factor == g_factor)
+		return false;
+
+	Shutdown();
+	g_factor = factor;
+	g_shift = factor == 4 ? 2 : (factor == 2 ? 1 : 0);
+
+	// Point back at VRAM, the next draw will bind shadows again if needed.
+	fb.data = Memory::GetPointerWrite(gstate.getFrameBufAddress());
+	depthbuf.data = Memory::GetPointerWrite(gstate.getDepthBufAddress() & 0x041FFFF0);
+	return true;
+}
+
+void Shutdown() {
+	for (Shadow &s : shadows)
+		s = Shadow();
+	boundColor = nullptr;
+	boundDepth = nullptr;
+	useCounter = 0;
+}
+
+}  // namespace RenderScale
@@ -0,0 +1,58 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+
+#include "GPU/ge_constants.h"
+
+struct DrawingCoords;
+
+// Internal resolution for the software renderer.
+// Above 1x, drawing coordinates are multiplied and the color and depth targets are drawn into
+// larger shadow buffers instead of VRAM.  Those are downsampled back into VRAM on each flush, so
+// anything reading VRAM (textures, block transfers, the CPU) still sees a native sized image.
+namespace RenderScale {
+
+extern int g_factor;
+extern int g_shift;
+
+// Multiplier for drawing coordinates: 1, 2, or 4.  Only changes while nothing is queued.
+inline int Factor() {
+	return g_factor;
+}
+inline int Shift() {
+	return g_shift;
+}
+
+// True if the config asks for a different factor.
+bool NeedsUpdate();
+// Picks up a config change.  Only call with nothing queued.  Returns true if the factor changed.
+bool Update();
+void Shutdown();
+
+// Binds the shadows for the current targets and marks the scissor area as drawn.
+// Returns false if the binner must flush first, i.e. to switch or grow a shadow.
+bool PrepareTargets(const DrawingCoords &tl, const DrawingCoords &br, bool useDepth, bool idle);
+// Downsamples anything drawn since the last flush into VRAM.  Call once rasterization finishes.
+void Resolve();
+
+// Returns the scaled image of a displayed framebuffer, or nullptr to use VRAM as is.
+const uint8_t *GetDisplayBuffer(uint32_t addr, int stride, GEBufferFormat fmt, int height, int *scaledStride);
+
+}  // namespace RenderScale
@@ -54,6 +54,14 @@ void Shutdown() {
 	jitCache = nullptr;
 }
 
+void GetCompiledIDs(std::vector<SamplerID> &ids) {
+	jitCache->GetCompiledIDs(ids);
+}
+
+bool Precompile(const SamplerID &id) {
+	return jitCache->Precompile(id);
+}
+
 bool DescribeCodePtr(const u8 *ptr, std::string &name) {
 	if (!jitCache->IsInSpace(ptr)) {
 		return false;
@@ -159,6 +167,36 @@ void SamplerJitCache::Flush() {
 	compileQueue_.clear();
 }
 
+void SamplerJitCache::GetCompiledIDs(std::vector<SamplerID> &ids) {
+	std::unique_lock<std::mutex> guard(jitCacheLock);
+	// Each ID compiles the fetch, nearest, and linear variants together, so just list one of them.
+	for (const auto &it : addresses_) {
+		if (!it.first.linear && !it.first.fetch)
+			ids.push_back(it.first);
+	}
+}
+
+bool SamplerJitCache::Precompile(const SamplerID &id) {
+#if PPSSPP_ARCH(AMD64) && !PPSSPP_PLATFORM(UWP)
+	if (!g_Config.bSoftwareRenderingJit)
+		return false;
+
+	SamplerID nearestID = id;
+	nearestID.linear = false;
+	nearestID.fetch = false;
+
+	std::unique_lock<std::mutex> guard(jitCacheLock);
+	// Compile() clears when space runs low, which isn't safe while drawing.  Leave room for new funcs too.
+	if (GetSpaceLeft() < 16384 * 2)
+		return false;
+	if (!cache_.ContainsKey(std::hash<SamplerID>()(nearestID)))
+		Compile(nearestID);
+	return true;
+#else
+	return false;
+#endif
+}
+
 NearestFunc SamplerJitCache::GetByID(const SamplerID &id, size_t key, BinManager *binner) {
 	std::unique_lock<std::mutex> guard(jitCacheLock);
 	
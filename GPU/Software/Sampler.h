@@ -21,6 +21,7 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "Common/Data/Collections/Hashmaps.h"
 #include "GPU/Math3D.h"
 #include "GPU/Software/FuncId.h"
@@ -50,6 +51,11 @@ void Init();
 void FlushJit();
 void Shutdown();
 
+// Lists what's been compiled, so the next run can compile it ahead of time.
+void GetCompiledIDs(std::vector<SamplerID> &ids);
+// Compiles now if there's room, returns false if not.  Unsafe with draws in flight on W^X platforms.
+bool Precompile(const SamplerID &id);
+
 bool DescribeCodePtr(const u8 *ptr, std::string &name);
 
 class SamplerJitCache : public Rasterizer::CodeBlock {
@@ -63,6 +69,9 @@ class SamplerJitCache : public Rasterizer::CodeBlock {
 	void Clear() override;
 	void Flush();
 
+	void GetCompiledIDs(std::vector<SamplerID> &ids);
+	bool Precompile(const SamplerID &id);
+
 	std::string DescribeCodePtr(const u8 *ptr) override;
 
 private:
@@ -16,7 +16,13 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <set>
+
+#include "ext/xxhash.h"
 #include "Common/System/Display.h"
+#include "Common/File/FileUtil.h"
+#include "Common/MemoryUtil.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Common/Thread/Waitable.h"
 #include "Common/GPU/OpenGL/GLFeatures.h"
 
 #include "GPU/GPUState.h"
@@ -30,6 +36,7 @@
 #include "Core/Core.h"
 #include "Core/System.h"
 #include "Core/Debugger/MemBlockInfo.h"
+#include "Core/ELF/ParamSFO.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/Util/PPGeDraw.h"
@@ -38,6 +45,7 @@
 
 #include "GPU/Software/DrawPixel.h"
 #include "GPU/Software/Rasterizer.h"
+#include "GPU/Software/RenderScale.h"
 #include "GPU/Software/Sampler.h"
 #include "GPU/Software/SoftGpu.h"
 #include "GPU/Software/TransformUnit.h"
@@ -429,6 +437,15 @@ SoftGPU::SoftGPU(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 
 	Rasterizer::Init();
 	Sampler::Init();
+
+	// Load the funcs this game used last time, so they're ready before the first draws.
+	std::string discID = g_paramSFO.GetDiscID();
+	if (discID.size()) {
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+		jitCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".softjitcache");
+		LoadJitCache(jitCachePath_);
+	}
+
 	drawEngine_ = new SoftwareDrawEngine();
 	if (!drawEngine_)
 		return;
@@ -479,13 +496,155 @@ SoftGPU::~SoftGPU() {
 		fbTex = nullptr;
 	}
 
+	CancelJitPrecompile();
+	if (jitCachePath_.Valid())
+		SaveJitCache(jitCachePath_);
+
 	delete presentation_;
 	delete drawEngine_;
 
+	RenderScale::Shutdown();
 	Sampler::Shutdown();
 	Rasterizer::Shutdown();
 }
 
+static const u32 JIT_CACHE_MAGIC = 0x54494A53;  // SJIT
+static const u32 JIT_CACHE_VERSION = 1;
+// Way more than any game uses, anything above is a corrupt file.
+static const u32 JIT_CACHE_MAX_IDS = 4096;
+
+struct JitCacheHeader {
+	u32 magic;
+	u32 version;
+	u32 pixelCount;
+	u32 samplerCount;
+};
+
+class JitPrecompileTask : public Task {
+public:
+	JitPrecompileTask(std::vector<PixelFuncID> &&pixelIDs, std::vector<SamplerID> &&samplerIDs, std::atomic<bool> *cancel, LimitedWaitable *waitable)
+		: pixelIDs_(std::move(pixelIDs)), samplerIDs_(std::move(samplerIDs)), cancel_(cancel), waitable_(waitable) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	TaskPriority Priority() const override {
+		// Emulation and drawing should win over this, it's only to avoid hitches.
+		return TaskPriority::LOW;
+	}
+
+	void Run() override {
+		Compile(pixelIDs_, samplerIDs_, cancel_);
+		waitable_->Notify();
+	}
+
+	static void Compile(const std::vector<PixelFuncID> &pixelIDs, const std::vector<SamplerID> &samplerIDs, std::atomic<bool> *cancel) {
+		// Samplers first, they're more expensive to compile.
+		for (const SamplerID &id : samplerIDs) {
+			if (cancel->load() || !Sampler::Precompile(id))
+				break;
+		}
+		for (const PixelFuncID &id : pixelIDs) {
+			if (cancel->load() || !Rasterizer::Precompile(id))
+				break;
+		}
+	}
+
+private:
+	std::vector<PixelFuncID> pixelIDs_;
+	std::vector<SamplerID> samplerIDs_;
+	std::atomic<bool> *cancel_;
+	LimitedWaitable *waitable_;
+};
+
+void SoftGPU::LoadJitCache(const Path &filename) {
+	if (!g_Config.bShaderCache || !g_Config.bSoftwareRenderingJit)
+		return;
+
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return;
+
+	JitCacheHeader header{};
+	bool result = fread(&header, sizeof(header), 1, f) == 1;
+	result = result && header.magic == JIT_CACHE_MAGIC && header.version == JIT_CACHE_VERSION;
+	result = result && header.pixelCount <= JIT_CACHE_MAX_IDS && header.samplerCount <= JIT_CACHE_MAX_IDS;
+
+	std::vector<PixelFuncID> pixelIDs;
+	std::vector<SamplerID> samplerIDs;
+	if (result) {
+		pixelIDs.resize(header.pixelCount);
+		for (auto &id : pixelIDs)
+			result = result && fread(&id.fullKey, sizeof(id.fullKey), 1, f) == 1;
+		samplerIDs.resize(header.samplerCount);
+		for (auto &id : samplerIDs)
+			result = result && fread(&id.fullKey, sizeof(id.fullKey), 1, f) == 1;
+	}
+	fclose(f);
+
+	if (!result) {
+		WARN_LOG(Log::G3D, "Incompatible software renderer JIT cache - rebuilding.");
+		File::Delete(filename);
+		return;
+	}
+
+	INFO_LOG(Log::G3D, "Precompiling %d pixel and %d sampler funcs", (int)pixelIDs.size(), (int)samplerIDs.size());
+	jitPrecompileCancel_ = false;
+	if (PlatformIsWXExclusive()) {
+		// Can't write code while other threads might be running it, but nothing is drawing yet.
+		JitPrecompileTask::Compile(pixelIDs, samplerIDs, &jitPrecompileCancel_);
+		return;
+	}
+
+	jitPrecompileWaitable_ = new LimitedWaitable();
+	g_threadManager.EnqueueTask(new JitPrecompileTask(std::move(pixelIDs), std::move(samplerIDs), &jitPrecompileCancel_, jitPrecompileWaitable_));
+}
+
+void SoftGPU::CancelJitPrecompile() {
+	if (!jitPrecompileWaitable_)
+		return;
+
+	jitPrecompileCancel_ = true;
+	jitPrecompileWaitable_->WaitAndRelease();
+	jitPrecompileWaitable_ = nullptr;
+}
+
+void SoftGPU::SaveJitCache(const Path &filename) {
+	if (!g_Config.bShaderCache || !g_Config.bSoftwareRenderingJit)
+		return;
+
+	std::vector<PixelFuncID> pixelIDs;
+	std::vector<SamplerID> samplerIDs;
+	Rasterizer::GetCompiledIDs(pixelIDs);
+	Sampler::GetCompiledIDs(samplerIDs);
+	if (pixelIDs.empty() && samplerIDs.empty())
+		return;
+
+	pixelIDs.resize(std::min(pixelIDs.size(), (size_t)JIT_CACHE_MAX_IDS));
+	samplerIDs.resize(std::min(samplerIDs.size(), (size_t)JIT_CACHE_MAX_IDS));
+
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f)
+		return;
+
+	JitCacheHeader header{ JIT_CACHE_MAGIC, JIT_CACHE_VERSION, (u32)pixelIDs.size(), (u32)samplerIDs.size() };
+	bool result = fwrite(&header, sizeof(header), 1, f) == 1;
+	for (const auto &id : pixelIDs)
+		result = result && fwrite(&id.fullKey, sizeof(id.fullKey), 1, f) == 1;
+	for (const auto &id : samplerIDs)
+		result = result && fwrite(&id.fullKey, sizeof(id.fullKey), 1, f) == 1;
+	fclose(f);
+
+	if (!result) {
+		WARN_LOG(Log::G3D, "Failed to write software renderer JIT cache");
+		File::Delete(filename);
+	} else {
+		INFO_LOG(Log::G3D, "Saved software renderer JIT cache");
+	}
+}
+
 void SoftGPU::SetDisplayFramebuffer(u32 framebuf, u32 stride, GEBufferFormat format) {
 	// Seems like this can point into RAM, but should be VRAM if not in RAM.
 	displayFramebuf_ = (framebuf & 0xFF000000) == 0 ? 0x44000000 | framebuf : framebuf;
@@ -497,16 +656,41 @@ void SoftGPU::SetDisplayFramebuffer(u32 framebuf, u32 stride, GEBufferFormat for
 
 DSStretch g_DarkStalkerStretch;
 
-void SoftGPU::ConvertTextureDescFrom16(Draw::TextureDesc &desc, int srcwidth, int srcheight, const uint16_t *overrideData) {
+bool SoftGPU::CheckDisplayTextureUpToDate(u32 addr, const u8 *scaledData, int scaledStride, int srcwidth, int srcheight, bool hasPostShader) {
+	const u32 bpp = displayFormat_ == GE_FORMAT_8888 ? 4 : 2;
+	const u32 stride = scaledData ? scaledStride : (displayStride_ == 0 ? srcwidth : displayStride_);
+	if (srcwidth <= 0 || srcheight <= 0 || (!scaledData && !Memory::IsValidRange(addr, (stride * (srcheight - 1) + srcwidth) * bpp))) {
+		fbTexHash_ = 0;
+		return false;
+	}
+
+	const u32 bytes = (stride * (srcheight - 1) + srcwidth) * bpp;
+	// Everything else that affects how the texture is created goes into the seed.
+	u64 seed = ((u64)addr << 32) ^ ((u64)stride << 16) ^ ((u64)displayFormat_ << 12) ^ ((u64)srcwidth << 1) ^ ((u64)srcheight << 40) ^ (hasPostShader ? 1 : 0);
+	u64 hash = XXH3_64bits_withSeed(scaledData ? scaledData : Memory::GetPointerUnchecked(addr), bytes, seed);
+	bool upToDate = fbTex != nullptr && hash == fbTexHash_;
+	fbTexHash_ = hash;
+	return upToDate;
+}
+
+void SoftGPU::ConvertTextureDescFrom16(Draw::TextureDesc &desc, int srcwidth, int srcheight, const uint16_t *overrideData, int overrideStride) {
+	desc.width = srcwidth;
+	desc.height = srcheight;
+	if (fbTexUpToDate_) {
+		// Same data as last time, no need to convert again. The texture won't be recreated anyway.
+		return;
+	}
+
 	// TODO: This should probably be converted in a shader instead..
 	fbTexBuffer_.resize(srcwidth * srcheight);
 	const uint16_t *displayBuffer = overrideData;
 	if (!displayBuffer)
 		displayBuffer = (const uint16_t *)Memory::GetPointer(displayFramebuf_);
 
+	const int stride = overrideStride != 0 ? overrideStride : displayStride_;
 	for (int y = 0; y < srcheight; ++y) {
 		u32 *buf_line = &fbTexBuffer_[y * srcwidth];
-		const u16 *fb_line = &displayBuffer[y * displayStride_];
+		const u16 *fb_line = &displayBuffer[y * stride];
 
 		switch (displayFormat_) {
 		case GE_FORMAT_565:
@@ -527,8 +711,6 @@ void SoftGPU::ConvertTextureDescFrom16(Draw::TextureDesc &desc, int srcwidth, in
 		}
 	}
 
-	desc.width = srcwidth;
-	desc.height = srcheight;
 	desc.initData.push_back((uint8_t *)fbTexBuffer_.data());
 }
 
@@ -541,11 +723,6 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 	float v0 = 0.0f;
 	float v1 = 1.0f;
 
-	if (fbTex) {
-		fbTex->Release();
-		fbTex = nullptr;
-	}
-
 	// For accuracy, try to handle 0 stride - sometimes used.
 	if (displayStride_ == 0) {
 		srcheight = 1;
@@ -565,7 +742,23 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 	OutputFlags outputFlags = g_Config.iDisplayFilter == SCALE_NEAREST ? OutputFlags::NEAREST : OutputFlags::LINEAR;
 	bool hasPostShader = presentation_ && presentation_->HasPostShader();
 
-	if (PSP_CoreParameter().compat.flags().DarkStalkersPresentHack && displayFormat_ == GE_FORMAT_5551 && g_DarkStalkerStretch != DSStretch::Off) {
+	const bool darkStalkersHack = PSP_CoreParameter().compat.flags().DarkStalkersPresentHack && displayFormat_ == GE_FORMAT_5551 && g_DarkStalkerStretch != DSStretch::Off;
+
+	// With a render scale, show the detailed image rather than what was downsampled into VRAM.
+	int scaledStride = 0;
+	const u8 *scaledData = nullptr;
+	if (!darkStalkersHack && displayStride_ != 0)
+		scaledData = RenderScale::GetDisplayBuffer(displayFramebuf_, displayStride_, displayFormat_, srcheight, &scaledStride);
+	if (scaledData) {
+		srcwidth *= RenderScale::Factor();
+		srcheight *= RenderScale::Factor();
+	}
+
+	// If nothing was drawn to the displayed memory since last time, we can keep last frame's texture
+	// and skip both the conversion and the upload.
+	fbTexUpToDate_ = CheckDisplayTextureUpToDate(darkStalkersHack ? 0x04088000 : displayFramebuf_, scaledData, scaledStride, srcwidth, srcheight, hasPostShader);
+
+	if (darkStalkersHack) {
 		const u8 *data = Memory::GetPointerWrite(0x04088000);
 		bool fillDesc = true;
 		if (draw_->GetDataFormatSupport(Draw::DataFormat::A1B5G5R5_UNORM_PACK16) & Draw::FMT_TEXTURE) {
@@ -595,13 +788,13 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 		hasImage = false;
 		u1 = 1.0f;
 	} else if (displayFormat_ == GE_FORMAT_8888) {
-		const u8 *data = Memory::GetPointer(displayFramebuf_);
-		desc.width = displayStride_ == 0 ? srcwidth : displayStride_;
+		const u8 *data = scaledData ? scaledData : Memory::GetPointer(displayFramebuf_);
+		desc.width = scaledData ? scaledStride : (displayStride_ == 0 ? srcwidth : displayStride_);
 		desc.height = srcheight;
 		desc.initData.push_back(data);
 		desc.format = Draw::DataFormat::R8G8B8A8_UNORM;
 	} else if (displayFormat_ == GE_FORMAT_5551) {
-		const u8 *data = Memory::GetPointer(displayFramebuf_);
+		const u8 *data = scaledData ? scaledData : Memory::GetPointer(displayFramebuf_);
 		bool fillDesc = true;
 		if (draw_->GetDataFormatSupport(Draw::DataFormat::A1B5G5R5_UNORM_PACK16) & Draw::FMT_TEXTURE) {
 			// The perfect one.
@@ -611,26 +804,34 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 			desc.format = Draw::DataFormat::A1R5G5B5_UNORM_PACK16;
 			outputFlags |= OutputFlags::RB_SWIZZLE;
 		} else {
-			ConvertTextureDescFrom16(desc, srcwidth, srcheight);
+			ConvertTextureDescFrom16(desc, srcwidth, srcheight, (const uint16_t *)data, scaledStride);
 			u1 = 1.0f;
 			fillDesc = false;
 		}
 		if (fillDesc) {
-			desc.width = displayStride_ == 0 ? srcwidth : displayStride_;
+			desc.width = scaledData ? scaledStride : (displayStride_ == 0 ? srcwidth : displayStride_);
 			desc.height = srcheight;
 			desc.initData.push_back(data);
 		}
 	} else {
-		ConvertTextureDescFrom16(desc, srcwidth, srcheight);
+		ConvertTextureDescFrom16(desc, srcwidth, srcheight, (const uint16_t *)scaledData, scaledStride);
 		u1 = 1.0f;
 	}
 	if (!hasImage) {
+		if (fbTex) {
+			fbTex->Release();
+			fbTex = nullptr;
+		}
 		draw_->BindFramebufferAsRenderTarget(nullptr, { Draw::RPAction::CLEAR, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, "CopyToCurrentFboFromDisplayRam");
 		presentation_->NotifyPresent();
 		return;
 	}
 
-	fbTex = draw_->CreateTexture(desc);
+	if (!fbTexUpToDate_) {
+		if (fbTex)
+			fbTex->Release();
+		fbTex = draw_->CreateTexture(desc);
+	}
 
 	switch (GetGPUBackend()) {
 	case GPUBackend::OPENGL:
@@ -649,7 +850,18 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 }
 
 void SoftGPU::CopyDisplayToOutput(bool reallyDirty) {
-	drawEngine_->transformUnit.Flush(this, "output");
+	if (UsePipelining() && !RenderScale::NeedsUpdate()) {
+		// Only wait for drawing into what's displayed, the next frame's targets can keep going.
+		const u32 bpp = displayFormat_ == GE_FORMAT_8888 ? 4 : 2;
+		drawEngine_->transformUnit.FlushIfOverlap(this, "output", false, displayFramebuf_, displayStride_ * bpp, FB_WIDTH * bpp, FB_HEIGHT);
+	} else {
+		drawEngine_->transformUnit.Flush(this, "output");
+		// Nothing is queued now, so it's safe to pick up a new render scale.
+		if (RenderScale::Update())
+			dirtyFlags_ |= SoftDirty::PIXEL_BASIC | SoftDirty::PIXEL_CACHED | SoftDirty::BINNER_RANGE;
+	}
+	// The CPU might write depth directly without telling us, so don't keep hi-Z bounds across frames.
+	drawEngine_->transformUnit.InvalidateHiZ(0, -1);
 	// The display always shows 480x272.
 	CopyToCurrentFboFromDisplayRam(FB_WIDTH, FB_HEIGHT);
 	MarkDirty(displayFramebuf_, displayStride_, 272, displayFormat_, SoftGPUVRAMDirty::CLEAR);
@@ -844,6 +1056,7 @@ void SoftGPU::Execute_BlockTransferStart(u32 op, u32 diff) {
 	}
 
 	DoBlockTransfer(gstate_c.skipDrawReason);
+	drawEngine_->transformUnit.InvalidateHiZ(dst, ((height - 1) * dstStride + width) * bpp);
 
 	// Could theoretically dirty the framebuffer.
 	MarkDirty(dst, dstSize, SoftGPUVRAMDirty::DIRTY | SoftGPUVRAMDirty::REALLY_DIRTY);
@@ -1268,30 +1481,53 @@ void SoftGPU::Execute_Call(u32 op, u32 diff) {
 	}
 }
 
+bool SoftGPU::UsePipelining() const {
+	// The Ge debugger and recorder expect to see drawing finished each time they stop.
+	return g_Config.bSoftwareRenderingPipelined && useFastRunLoop_ && !recorder_.IsActive();
+}
+
 void SoftGPU::FinishDeferred() {
 	// Need to flush before going back to CPU, so drawing is appropriately visible.
-	drawEngine_->transformUnit.Flush(this, "finish");
+	// When pipelining, we only flush once something actually touches what's still pending.
+	if (UsePipelining())
+		drawEngine_->transformUnit.Kick();
+	else
+		drawEngine_->transformUnit.Flush(this, "finish");
 }
 
 int SoftGPU::ListSync(int listid, int mode) {
 	// Take this as a cue that we need to finish drawing.
-	drawEngine_->transformUnit.Flush(this, "listsync");
+	if (UsePipelining())
+		drawEngine_->transformUnit.Kick();
+	else
+		drawEngine_->transformUnit.Flush(this, "listsync");
 	return GPUCommon::ListSync(listid, mode);
 }
 
 u32 SoftGPU::DrawSync(int mode) {
 	// Take this as a cue that we need to finish drawing.
-	drawEngine_->transformUnit.Flush(this, "drawsync");
+	if (UsePipelining())
+		drawEngine_->transformUnit.Kick();
+	else
+		drawEngine_->transformUnit.Flush(this, "drawsync");
 	return GPUCommon::DrawSync(mode);
 }
 
+void SoftGPU::FinishBackgroundDraws() {
+	drawEngine_->transformUnit.Flush(this, "background");
+}
+
 void SoftGPU::GetStats(char *buffer, size_t bufsize) {
 	drawEngine_->transformUnit.GetStats(buffer, bufsize);
 }
 
 void SoftGPU::InvalidateCache(u32 addr, int size, GPUInvalidationType type)
 {
-	// Nothing to invalidate.
+	// Only the hi-Z bounds, in case this was a write to a depth buffer.
+	if (type == GPU_INVALIDATE_ALL || size < 0)
+		drawEngine_->transformUnit.InvalidateHiZ(0, -1);
+	else if (Memory::IsVRAMAddress(addr))
+		drawEngine_->transformUnit.InvalidateHiZ(addr, size);
 }
 
 void SoftGPU::PerformWriteFormattedFromMemory(u32 addr, int size, int width, GEBufferFormat format)
@@ -1300,7 +1536,9 @@ void SoftGPU::PerformWriteFormattedFromMemory(u32 addr, int size, int width, GEB
 }
 
 bool SoftGPU::PerformMemoryCopy(u32 dest, u32 src, int size, GPUCopyFlag flags) {
-	// Nothing to update.
+	// Drawing may still be running, if pipelining.  Nothing to update otherwise.
+	drawEngine_->transformUnit.FlushIfOverlap(this, "memcpy", false, src, size, size, 1);
+	drawEngine_->transformUnit.FlushIfOverlap(this, "memcpy", true, dest, size, size, 1);
 	InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
 	if (!(flags & GPUCopyFlag::DEBUG_NOTIFIED))
 		recorder_.NotifyMemcpy(dest, src, size);
@@ -1311,7 +1549,8 @@ bool SoftGPU::PerformMemoryCopy(u32 dest, u32 src, int size, GPUCopyFlag flags)
 
 bool SoftGPU::PerformMemorySet(u32 dest, u8 v, int size)
 {
-	// Nothing to update.
+	// Drawing may still be running, if pipelining.  Nothing to update otherwise.
+	drawEngine_->transformUnit.FlushIfOverlap(this, "memset", true, dest, size, size, 1);
 	InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
 	recorder_.NotifyMemset(dest, v, size);
 	// Let's just be safe.
@@ -1321,14 +1560,16 @@ bool SoftGPU::PerformMemorySet(u32 dest, u8 v, int size)
 
 bool SoftGPU::PerformReadbackToMemory(u32 dest, int size)
 {
-	// Nothing to update.
+	// The CPU is about to read this, so drawing to it must be done.
+	drawEngine_->transformUnit.FlushIfOverlap(this, "readback", false, dest, size, size, 1);
 	InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
 	return false;
 }
 
 bool SoftGPU::PerformWriteColorFromMemory(u32 dest, int size)
 {
-	// Nothing to update.
+	// Drawing may still be running, if pipelining.  Nothing to update otherwise.
+	drawEngine_->transformUnit.FlushIfOverlap(this, "upload", true, dest, size, size, 1);
 	InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
 	recorder_.NotifyUpload(dest, size);
 	return false;
@@ -1370,7 +1611,8 @@ bool SoftGPU::GetCurrentFramebuffer(GPUDebugBuffer &buffer, GPUDebugFramebufferT
 	int stride = gstate.FrameBufStride();
 	DrawingCoords size = GetTargetSize(stride);
 	GEBufferFormat fmt = gstate.FrameBufFormat();
-	const u8 *src = fb.data;
+	// Not fb.data, which may be a scaled buffer.  VRAM is up to date after each flush.
+	const u8 *src = Memory::GetPointer(gstate.getFrameBufAddress());
 
 	if (!Memory::IsValidAddress(displayFramebuf_))
 		return false;
@@ -1405,7 +1647,7 @@ bool SoftGPU::GetCurrentDepthbuffer(GPUDebugBuffer &buffer) {
 	buffer.Allocate(size.x, size.y, GPU_DBG_FORMAT_16BIT);
 
 	const int depth = 2;
-	const u8 *src = depthbuf.data;
+	const u8 *src = Memory::GetPointer(gstate.getDepthBufAddress() & 0x041FFFF0);
 	u8 *dst = buffer.GetData();
 	for (int16_t y = 0; y < size.y; ++y) {
 		memcpy(dst, src, size.x * depth);
@@ -1415,16 +1657,16 @@ bool SoftGPU::GetCurrentDepthbuffer(GPUDebugBuffer &buffer) {
 	return true;
 }
 
-static inline u8 GetPixelStencil(GEBufferFormat fmt, int fbStride, int x, int y) {
+static inline u8 GetPixelStencil(const FormatBuffer &buf, GEBufferFormat fmt, int fbStride, int x, int y) {
 	if (fmt == GE_FORMAT_565) {
 		// Always treated as 0 for comparison purposes.
 		return 0;
 	} else if (fmt == GE_FORMAT_5551) {
-		return ((fb.Get16(x, y, fbStride) & 0x8000) != 0) ? 0xFF : 0;
+		return ((buf.Get16(x, y, fbStride) & 0x8000) != 0) ? 0xFF : 0;
 	} else if (fmt == GE_FORMAT_4444) {
-		return Convert4To8(fb.Get16(x, y, fbStride) >> 12);
+		return Convert4To8(buf.Get16(x, y, fbStride) >> 12);
 	} else {
-		return fb.Get32(x, y, fbStride) >> 24;
+		return buf.Get32(x, y, fbStride) >> 24;
 	}
 }
 
@@ -1432,10 +1674,12 @@ bool SoftGPU::GetCurrentStencilbuffer(GPUDebugBuffer &buffer) {
 	DrawingCoords size = GetTargetSize(gstate.FrameBufStride());
 	buffer.Allocate(size.x, size.y, GPU_DBG_FORMAT_8BIT);
 
+	FormatBuffer vram;
+	vram.data = Memory::GetPointerWrite(gstate.getFrameBufAddress());
 	u8 *row = buffer.GetData();
 	for (int16_t y = 0; y < size.y; ++y) {
 		for (int16_t x = 0; x < size.x; ++x) {
-			row[x] = GetPixelStencil(gstate.FrameBufFormat(), gstate.FrameBufStride(), x, y);
+			row[x] = GetPixelStencil(vram, gstate.FrameBufFormat(), gstate.FrameBufStride(), x, y);
 		}
 		row += size.x;
 	}
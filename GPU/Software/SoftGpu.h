@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include "Common/File/Path.h"
 #include "GPU/GPUCommon.h"
 #include "GPU/Common/GPUDebugInterface.h"
 #include "Common/GPU/thin3d.h"
@@ -111,6 +113,7 @@ static inline SoftDirty operator ~(const SoftDirty &v) {
 	return SoftDirty(~(uint64_t)v);
 }
 
+class LimitedWaitable;
 class PresentationCommon;
 class SoftwareDrawEngine;
 
@@ -133,6 +136,7 @@ class SoftGPU : public GPUCommon {
 	void FinishDeferred() override;
 	int ListSync(int listid, int mode) override;
 	u32 DrawSync(int mode) override;
+	void FinishBackgroundDraws() override;
 	void UpdateCmdInfo() override {}
 
 	void SetDisplayFramebuffer(u32 framebuf, u32 stride, GEBufferFormat format) override;
@@ -215,11 +219,18 @@ class SoftGPU : public GPUCommon {
 protected:
 	void FastRunLoop(DisplayList &list) override;
 	void CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight);
-	void ConvertTextureDescFrom16(Draw::TextureDesc &desc, int srcwidth, int srcheight, const uint16_t *overrideData = nullptr);
+	void ConvertTextureDescFrom16(Draw::TextureDesc &desc, int srcwidth, int srcheight, const uint16_t *overrideData = nullptr, int overrideStride = 0);
+	bool CheckDisplayTextureUpToDate(u32 addr, const u8 *scaledData, int scaledStride, int srcwidth, int srcheight, bool hasPostShader);
 
 	void BuildReportingInfo() override {}
 
 private:
+	void LoadJitCache(const Path &filename);
+	void SaveJitCache(const Path &filename);
+	void CancelJitPrecompile();
+	// Whether to let drawing continue in the background while the CPU runs.
+	bool UsePipelining() const;
+
 	void MarkDirty(uint32_t addr, uint32_t stride, uint32_t height, GEBufferFormat fmt, SoftGPUVRAMDirty value);
 	void MarkDirty(uint32_t addr, uint32_t bytes, SoftGPUVRAMDirty value);
 	bool ClearDirty(uint32_t addr, uint32_t stride, uint32_t height, GEBufferFormat fmt, SoftGPUVRAMDirty value);
@@ -240,6 +251,13 @@ class SoftGPU : public GPUCommon {
 
 	Draw::Texture *fbTex = nullptr;
 	std::vector<u32> fbTexBuffer_;
+	// Hash of the displayed memory fbTex was created from, to skip uploads when it hasn't changed.
+	u64 fbTexHash_ = 0;
+	bool fbTexUpToDate_ = false;
+
+	Path jitCachePath_;
+	LimitedWaitable *jitPrecompileWaitable_ = nullptr;
+	std::atomic<bool> jitPrecompileCancel_{};
 };
 
 // TODO: These shouldn't be global.
@@ -24,6 +24,7 @@
 #include "Common/Math/math_util.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/VertexDecoderCommon.h"
@@ -33,6 +34,7 @@
 #include "GPU/Software/Clipper.h"
 #include "GPU/Software/Lighting.h"
 #include "GPU/Software/RasterizerRectangle.h"
+#include "GPU/Software/RenderScale.h"
 #include "GPU/Software/TransformUnit.h"
 
 // For the SSE4 stuff
@@ -123,8 +125,8 @@ void SoftwareDrawEngine::DispatchSubmitImm(GEPrimitiveType prim, TransformedVert
 		vert.v.color0 = buffer[i].color0_32;
 		vert.v.color1 = gstate.isUsingSecondaryColor() && !gstate.isModeThrough() ? buffer[i].color1_32 : 0;
 		vert.v.fogdepth = buffer[i].fog;
-		vert.v.screenpos.x = (int)(buffer[i].x * 16.0f);
-		vert.v.screenpos.y = (int)(buffer[i].y * 16.0f);
+		vert.v.screenpos.x = (int)(buffer[i].x * 16.0f) * RenderScale::Factor();
+		vert.v.screenpos.y = (int)(buffer[i].y * 16.0f) * RenderScale::Factor();
 		vert.v.screenpos.z = (u16)(u32)buffer[i].z;
 
 		transformUnit.SubmitImmVertex(vert, this);
@@ -189,6 +191,13 @@ static ScreenCoords ClipToScreenInternal(Vec3f scaled, const ClipCoords &coords,
 	// 16 = 0xFFFF / 4095.9375
 	// Round up at 0.625 to the nearest subpixel.
 	static_assert(SCREEN_SCALE_FACTOR == 16, "Currently only supports scale 16");
+	const int renderScale = RenderScale::Factor();
+	if (renderScale != 1) {
+		// Subpixels are relative to the scaled pixels, so apply the offset first.
+		int x = (int)((scaled.x * 16.0f - gstate.getOffsetX16()) * renderScale + 0.375f);
+		int y = (int)((scaled.y * 16.0f - gstate.getOffsetY16()) * renderScale + 0.375f);
+		return ScreenCoords(x, y, scaled.z);
+	}
 	int x = (int)(scaled.x * 16.0f + 0.375f - gstate.getOffsetX16());
 	int y = (int)(scaled.y * 16.0f + 0.375f - gstate.getOffsetY16());
 	return ScreenCoords(x, y, scaled.z);
@@ -221,8 +230,8 @@ ScreenCoords TransformUnit::ClipToScreen(const ClipCoords &coords, bool *outside
 
 ScreenCoords TransformUnit::DrawingToScreen(const DrawingCoords &coords, u16 z) {
 	ScreenCoords ret;
-	ret.x = (u32)coords.x * SCREEN_SCALE_FACTOR;
-	ret.y = (u32)coords.y * SCREEN_SCALE_FACTOR;
+	ret.x = (u32)coords.x * SCREEN_SCALE_FACTOR * RenderScale::Factor();
+	ret.y = (u32)coords.y * SCREEN_SCALE_FACTOR * RenderScale::Factor();
 	ret.z = z;
 	return ret;
 }
@@ -358,28 +367,25 @@ static inline float Dot43(const Vec4f &a, const Vec3f &b) {
 	return Dot(a, Vec4f(b, 1.0f));
 }
 
-ClipVertexData TransformUnit::ReadVertex(const VertexReader &vreader, const TransformState &state) {
+ClipVertexData TransformUnit::ReadVertex(const VertexReader &vreader, const TransformState &state, VertexCarry &carry) {
 	PROFILE_THIS_SCOPE("read_vert");
-	// If we ever thread this, we'll have to change this.
 	ClipVertexData vertex;
 
 	ModelCoords pos;
 	// VertexDecoder normally scales z, but we want it unscaled.
 	vreader.ReadPosThroughZ16(pos.AsArray());
 
-	static Vec3Packedf lastTC;
 	if (state.readUV) {
 		vreader.ReadUV(vertex.v.texturecoords.AsArray());
 		vertex.v.texturecoords.q() = 0.0f;
-		lastTC = vertex.v.texturecoords;
+		carry.texturecoords = vertex.v.texturecoords;
 	} else {
-		vertex.v.texturecoords = lastTC;
+		vertex.v.texturecoords = carry.texturecoords;
 	}
 
-	static Vec3f lastnormal;
 	if (vreader.hasNormal())
-		vreader.ReadNrm(lastnormal.AsArray());
-	Vec3f normal = lastnormal;
+		vreader.ReadNrm(carry.normal.AsArray());
+	Vec3f normal = carry.normal;
 	if (state.negateNormals)
 		normal = -normal;
 
@@ -467,8 +473,8 @@ ClipVertexData TransformUnit::ReadVertex(const VertexReader &vreader, const Tran
 		if (state.enableLighting)
 			Lighting::Process(vertex.v, worldpos, worldnormal, state.lightingState);
 	} else {
-		vertex.v.screenpos.x = (int)(pos[0] * SCREEN_SCALE_FACTOR);
-		vertex.v.screenpos.y = (int)(pos[1] * SCREEN_SCALE_FACTOR);
+		vertex.v.screenpos.x = (int)(pos[0] * SCREEN_SCALE_FACTOR) * RenderScale::Factor();
+		vertex.v.screenpos.y = (int)(pos[1] * SCREEN_SCALE_FACTOR) * RenderScale::Factor();
 		vertex.v.screenpos.z = pos[2];
 		vertex.v.clipw = 1.0f;
 		vertex.v.fogdepth = 1.0f;
@@ -499,7 +505,9 @@ class SoftwareVertexReader {
 
 		// If we're only using a subset of verts, it's better to decode with random access (usually.)
 		// However, if we're reusing a lot of verts, we should read and cache them.
-		useCache_ = useIndices_ && vertex_count > (upperBound_ - lowerBound_ + 1);
+		// Large draws are also cached, so they can be transformed in parallel.
+		const int range = upperBound_ - lowerBound_ + 1;
+		useCache_ = (useIndices_ && vertex_count > range) || (range >= PARALLEL_MIN_VERTS && range <= vertex_count);
 		if (useCache_ && (int)cached_.size() < upperBound_ - lowerBound_ + 1)
 			cached_.resize(std::max(128, upperBound_ - lowerBound_ + 1));
 	}
@@ -516,26 +524,47 @@ class SoftwareVertexReader {
 		if (!useCache_)
 			return;
 
-		for (int i = 0; i < upperBound_ - lowerBound_ + 1; ++i) {
-			vreader_.Goto(i);
-			cached_[i] = transform_.ReadVertex(vreader_, transformState_);
+		const int count = upperBound_ - lowerBound_ + 1;
+		if (count < PARALLEL_MIN_VERTS) {
+			for (int i = 0; i < count; ++i) {
+				vreader_.Goto(i);
+				cached_[i] = transform_.ReadVertex(vreader_, transformState_, transform_.carry_);
+			}
+			return;
 		}
+
+		// Within a draw, the carried UV and normal are either always read or always written.
+		// So each chunk can start from the same values, and the last chunk has the final ones.
+		const TransformUnit::VertexCarry startCarry = transform_.carry_;
+		ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+			VertexReader vreader = vreader_;
+			TransformUnit::VertexCarry carry = startCarry;
+			for (int i = lower; i < upper; ++i) {
+				vreader.Goto(i);
+				cached_[i] = transform_.ReadVertex(vreader, transformState_, carry);
+			}
+			if (upper == count)
+				transform_.carry_ = carry;
+		}, 0, count, PARALLEL_MIN_VERTS / 2);
 	}
 
 	inline ClipVertexData Read(int vtx) {
+		if (useCache_)
+			return cached_[useIndices_ ? conv_(vtx) - lowerBound_ : vtx];
+
 		if (useIndices_) {
-			if (useCache_) {
-				return cached_[conv_(vtx) - lowerBound_];
-			}
 			vreader_.Goto(conv_(vtx) - lowerBound_);
 		} else {
 			vreader_.Goto(vtx);
 		}
 
-		return transform_.ReadVertex(vreader_, transformState_);
+		return transform_.ReadVertex(vreader_, transformState_, transform_.carry_);
 	};
 
 protected:
+	// Below this, threading costs more than it saves.
+	static constexpr int PARALLEL_MIN_VERTS = 512;
+
 	VertexReader vreader_;
 	const IndexConverter conv_;
 	const TransformState &transformState_;
@@ -902,6 +931,13 @@ void TransformUnit::Flush(GPUCommon *common, const char *reason) {
 	hasDraws_ = false;
 }
 
+void TransformUnit::Kick() {
+	if (!hasDraws_)
+		return;
+
+	binner_->Kick();
+}
+
 void TransformUnit::GetStats(char *buffer, size_t bufsize) {
 	// TODO: More stats?
 	binner_->GetStats(buffer, bufsize);
@@ -921,6 +957,10 @@ void TransformUnit::NotifyClutUpdate(const void *src) {
 	binner_->UpdateClut(src);
 }
 
+void TransformUnit::InvalidateHiZ(uint32_t addr, int bytes) {
+	binner_->InvalidateHiZ(addr, bytes);
+}
+
 // TODO: This probably is not the best interface.
 // Also, we should try to merge this into the similar function in DrawEngineCommon.
 bool TransformUnit::GetCurrentDrawAsDebugVertices(int count, std::vector<GPUDebugVertex> &vertices, std::vector<u16> &indices) {
@@ -1023,8 +1063,8 @@ bool TransformUnit::GetCurrentDrawAsDebugVertices(int count, std::vector<GPUDebu
 				vertices[i].u = 0.0f;
 				vertices[i].v = 0.0f;
 			}
-			vertices[i].x = (float)screenPos.x / SCREEN_SCALE_FACTOR;
-			vertices[i].y = (float)screenPos.y / SCREEN_SCALE_FACTOR;
+			vertices[i].x = (float)screenPos.x / (SCREEN_SCALE_FACTOR * RenderScale::Factor());
+			vertices[i].y = (float)screenPos.y / (SCREEN_SCALE_FACTOR * RenderScale::Factor());
 			vertices[i].z = screenPos.z <= 0 || screenPos.z >= 0xFFFF ? z : (float)screenPos.z;
 		}
 
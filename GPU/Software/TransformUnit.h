@@ -142,8 +142,11 @@ class TransformUnit {
 	static bool GetCurrentDrawAsDebugVertices(int count, std::vector<GPUDebugVertex> &vertices, std::vector<u16> &indices);
 
 	void Flush(GPUCommon *common, const char *reason);
+	// Starts drawing everything queued in the background, but leaves it pending until a flush.
+	void Kick();
 	void FlushIfOverlap(GPUCommon *common, const char *reason, bool modifying, uint32_t addr, uint32_t stride, uint32_t w, uint32_t h);
 	void NotifyClutUpdate(const void *src);
+	void InvalidateHiZ(uint32_t addr, int bytes);
 
 	void GetStats(char *buffer, size_t bufsize);
 
@@ -151,7 +154,13 @@ class TransformUnit {
 	SoftDirty GetDirty();
 
 private:
-	ClipVertexData ReadVertex(const VertexReader &vreader, const TransformState &state);
+	// Vertices without their own UV or normal reuse the last ones read.
+	struct VertexCarry {
+		Vec3Packedf texturecoords;
+		Vec3f normal;
+	};
+
+	ClipVertexData ReadVertex(const VertexReader &vreader, const TransformState &state, VertexCarry &carry);
 	void SendTriangle(CullType cullType, const ClipVertexData *verts, int provoking = 2);
 
 	u8 *decoded_ = nullptr;
@@ -162,6 +171,7 @@ class TransformUnit {
 	// This is the index of the next vert in data (or higher, may need modulus.)
 	int data_index_ = 0;
 	GEPrimitiveType prev_prim_ = GE_PRIM_POINTS;
+	VertexCarry carry_{};
 	bool hasDraws_ = false;
 	bool isImmDraw_ = false;
 
@@ -20,9 +20,13 @@
 
 #include "Common/Profiler/Profiler.h"
 #include "Common/GPU/Vulkan/VulkanRenderManager.h"
+#include "ext/xxhash.h"
 
 #include "Common/Log.h"
 
+#include "Core/Config.h"
+#include "Core/HW/Display.h"
+#include "Core/System.h"
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
 
@@ -47,10 +51,23 @@ enum {
 	TRANSFORMED_VERTEX_BUFFER_SIZE = VERTEX_BUFFER_MAX * sizeof(TransformedVertex)
 };
 
+enum {
+	VERTEX_CACHE_BUFFER_SIZE = 8 * 1024 * 1024,
+	// Number of identical full hashes (on separate draws) before we decode into the cache.
+	VAI_HASHES_BEFORE_CACHING = 2,
+	// Like the texture cache, we back off full hashing the longer an entry has stayed the same.
+	VAI_MAX_DRAWS_BETWEEN_FULL_HASHES = 24,
+	VAI_KILL_AGE = 120,
+	VAI_UNRELIABLE_KILL_AGE = 240,
+	VAI_DECIMATION_INTERVAL = 17,
+};
+
 DrawEngineVulkan::DrawEngineVulkan(Draw::DrawContext *draw)
-	: draw_(draw) {
+	: draw_(draw), vai_(256) {
 	decOptions_.expandAllWeightsToFloat = false;
 	decOptions_.expand8BitNormalsToFloat = false;
+	// Vulkan always restarts strips in indexed draws, see the pipeline setup.
+	supportsPrimitiveRestart_ = true;
 }
 
 void DrawEngineVulkan::InitDeviceObjects() {
@@ -131,6 +148,9 @@ void DrawEngineVulkan::DestroyDeviceObjects() {
 		pushIndex_ = nullptr;
 	}
 
+	ClearVertexCache();
+	DestroyVertexCacheBuffer();
+
 	if (samplerSecondaryNearest_ != VK_NULL_HANDLE)
 		vulkan->Delete().QueueDeleteSampler(samplerSecondaryNearest_);
 	if (samplerSecondaryLinear_ != VK_NULL_HANDLE)
@@ -152,6 +172,29 @@ void DrawEngineVulkan::DeviceRestore(Draw::DrawContext *draw) {
 	InitDeviceObjects();
 }
 
+// Pushes the indices, unless the same ones were already pushed this frame.
+uint32_t DrawEngineVulkan::PushIndices(const u16 *inds, int count, VkBuffer *ibuf) {
+	uint32_t size = (uint32_t)(count * sizeof(uint16_t));
+	// Hashing small ones costs about as much as copying them.
+	if (count < 64) {
+		return (uint32_t)pushIndex_->Push(inds, size, 4, ibuf);
+	}
+
+	u64 hash = XXH3_64bits(inds, size);
+	PushedIndices &slot = pushedIndices_[hash % PUSHED_INDICES_SLOTS];
+	if (slot.buf != VK_NULL_HANDLE && slot.hash == hash && slot.size == size) {
+		*ibuf = slot.buf;
+		return slot.offset;
+	}
+
+	uint32_t offset = (uint32_t)pushIndex_->Push(inds, size, 4, ibuf);
+	slot.hash = hash;
+	slot.size = size;
+	slot.offset = offset;
+	slot.buf = *ibuf;
+	return offset;
+}
+
 void DrawEngineVulkan::BeginFrame() {
 	DrawEngineCommon::BeginFrame();
 
@@ -164,11 +207,17 @@ void DrawEngineVulkan::BeginFrame() {
 	// pushUBO is the thin3d push pool, don't need to BeginFrame again.
 	pushVertex_->BeginFrame();
 	pushIndex_->BeginFrame();
+	memset(pushedIndices_, 0, sizeof(pushedIndices_));
 
 	tessDataTransferVulkan->SetPushPool(pushUBO_);
 
 	DirtyAllUBOs();
 
+	if (--decimationCounter_ <= 0) {
+		decimationCounter_ = VAI_DECIMATION_INTERVAL;
+		DecimateVertexCache();
+	}
+
 	AssertEmpty();
 }
 
@@ -187,6 +236,8 @@ void DrawEngineVulkan::DirtyAllUBOs() {
 	lightBuf = VK_NULL_HANDLE;
 	boneBuf = VK_NULL_HANDLE;
 	dirtyUniforms_ = DIRTY_BASE_UNIFORMS | DIRTY_LIGHT_UNIFORMS | DIRTY_BONE_UNIFORMS;
+	// Previously pushed blocks may belong to a push pool frame that's been recycled.
+	shaderManager_->ResetPushedUBOs();
 	imageView = VK_NULL_HANDLE;
 	sampler = VK_NULL_HANDLE;
 	gstate_c.Dirty(DIRTY_TEXTURE_IMAGE);
@@ -211,6 +262,7 @@ void DrawEngineVulkan::Flush() {
 	if (!numDrawVerts_) {
 		return;
 	}
+	FramePhaseTimer phaseTimer(FramePhase::DRAW, coreCollectDebugStats);
 
 	VulkanRenderManager *renderManager = (VulkanRenderManager *)draw_->GetNativeObject(Draw::NativeObject::RENDER_MANAGER);
 
@@ -222,7 +274,11 @@ void DrawEngineVulkan::Flush() {
 
 	bool textureNeedsApply = false;
 	if (gstate_c.IsDirty(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS) && !gstate.isModeClear() && gstate.isTextureMapEnabled()) {
-		textureCache_->SetTexture();
+		if (atlasBatch_) {
+			textureCache_->SetAtlasTexture();
+		} else {
+			textureCache_->SetTexture();
+		}
 		gstate_c.Clean(DIRTY_TEXTURE_IMAGE | DIRTY_TEXTURE_PARAMS);
 		// NOTE: After this is set, we MUST call ApplyTexture before returning.
 		textureNeedsApply = true;
@@ -255,7 +311,7 @@ void DrawEngineVulkan::Flush() {
 			VkDeviceSize size = numDecodedVerts_ * dec_->GetDecVtxFmt().stride;
 			u8 *dest = (u8 *)pushVertex_->Allocate(size, 4, &vbuf, &vbOffset);
 			memcpy(dest, decoded_, size);
-		} else {
+		} else if (!g_Config.bVertexCache || dec_->morphcount > 1 || !LookupVertexCache(&vbuf, &vbOffset)) {
 			// Figure out how much pushbuffer space we need to allocate.
 			int vertsToDecode = ComputeNumVertsToDecode();
 			// Decode directly into the pushbuffer
@@ -301,9 +357,10 @@ void DrawEngineVulkan::Flush() {
 				ResetAfterDraw();
 				return;
 			}
+			VulkanPipeline *fallback = GetFallbackPipeline(renderManager, pipeline, &dec_->decFmt, vshader, fshader, gshader, true);
 			BindShaderBlendTex();  // This might cause copies so important to do before BindPipeline.
 
-			if (!renderManager->BindPipeline(pipeline->pipeline, pipeline->pipelineFlags, pipelineLayout_)) {
+			if (!BindPipeline(renderManager, pipeline, fallback)) {
 				renderManager->ReportBadStateForDraw();
 				ResetAfterDraw();
 				return;
@@ -365,7 +422,7 @@ void DrawEngineVulkan::Flush() {
 		};
 		if (useElements) {
 			VkBuffer ibuf;
-			u32 ibOffset = (uint32_t)pushIndex_->Push(decIndex_, sizeof(uint16_t) * vertexCount, 4, &ibuf);
+			u32 ibOffset = PushIndices(decIndex_, vertexCount, &ibuf);
 			renderManager->DrawIndexed(descSetIndex, ARRAY_SIZE(dynamicUBOOffsets), dynamicUBOOffsets, vbuf, vbOffset, ibuf, ibOffset, vertexCount, 1);
 		} else {
 			renderManager->Draw(descSetIndex, ARRAY_SIZE(dynamicUBOOffsets), dynamicUBOOffsets, vbuf, vbOffset, vertexCount);
@@ -492,9 +549,10 @@ void DrawEngineVulkan::Flush() {
 					ResetAfterDraw();
 					return;
 				}
+				VulkanPipeline *fallback = GetFallbackPipeline(renderManager, pipeline, &swDec->decFmt, vshader, fshader, gshader, false);
 				BindShaderBlendTex();  // This might cause copies so super important to do before BindPipeline.
 
-				if (!renderManager->BindPipeline(pipeline->pipeline, pipeline->pipelineFlags, pipelineLayout_)) {
+				if (!BindPipeline(renderManager, pipeline, fallback)) {
 					renderManager->ReportBadStateForDraw();
 					ResetAfterDraw();
 					return;
@@ -576,6 +634,201 @@ void DrawEngineVulkan::Flush() {
 	gpuCommon_->NotifyFlush();
 }
 
+// Identifies the draw list by its vertex pointers, ranges and decoder, not by content.
+u64 DrawEngineVulkan::ComputeVertexCacheKey() const {
+	u64 seed = (u64)(uintptr_t)dec_ ^ ((u64)dec_->VertexType() << 32);
+	return XXH3_64bits_withSeed(drawVerts_, sizeof(DeferredVerts) * numDrawVerts_, seed);
+}
+
+u64 DrawEngineVulkan::ComputeVertexDataHash() const {
+	int vertexSize = dec_->VertexSize();
+	u64 hash = 0;
+	for (int i = 0; i < numDrawVerts_; i++) {
+		const DeferredVerts &dv = drawVerts_[i];
+		const u8 *start = (const u8 *)dv.verts + dv.indexLowerBound * vertexSize;
+		size_t size = (dv.indexUpperBound + 1 - dv.indexLowerBound) * vertexSize;
+		hash = XXH3_64bits_withSeed(start, size, hash);
+	}
+	return hash;
+}
+
+// Only samples a few words per draw, to catch the common case of a game rewriting its vertices cheaply.
+u32 DrawEngineVulkan::ComputeVertexDataMiniHash() const {
+	int vertexSize = dec_->VertexSize();
+	u32 hash = 0;
+	for (int i = 0; i < numDrawVerts_; i++) {
+		const DeferredVerts &dv = drawVerts_[i];
+		const u8 *start = (const u8 *)dv.verts + dv.indexLowerBound * vertexSize;
+		size_t words = (dv.indexUpperBound + 1 - dv.indexLowerBound) * vertexSize / 4;
+		size_t step = words / 16 + 1;
+		for (size_t w = 0; w < words; w += step) {
+			u32 word;
+			memcpy(&word, start + w * 4, 4);
+			hash = (hash ^ word) * 0x9E3779B1;
+		}
+	}
+	return hash;
+}
+
+u8 *DrawEngineVulkan::AllocateVertexCache(size_t size, VkBuffer *vbuf, uint32_t *vbOffset) {
+	size = (size + 15) & ~15;
+	if (size > VERTEX_CACHE_BUFFER_SIZE / 8) {
+		// Not worth filling the cache with a single draw.
+		return nullptr;
+	}
+
+	if (vertexCacheBuf_ != VK_NULL_HANDLE && vertexCacheUsed_ + size > VERTEX_CACHE_BUFFER_SIZE) {
+		// Full. Entries point into the old buffer, which may still be in use by frames in flight,
+		// so we start over with a fresh one rather than overwriting it.
+		ClearVertexCache();
+		DestroyVertexCacheBuffer();
+	}
+
+	if (vertexCacheBuf_ == VK_NULL_HANDLE) {
+		VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+
+		VkBufferCreateInfo b{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		b.size = VERTEX_CACHE_BUFFER_SIZE;
+		b.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		b.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VmaAllocationCreateInfo allocCreateInfo{};
+		allocCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+		VmaAllocationInfo allocInfo{};
+		VkResult result = vmaCreateBuffer(vulkan->Allocator(), &b, &allocCreateInfo, &vertexCacheBuf_, &vertexCacheAlloc_, &allocInfo);
+		if (result != VK_SUCCESS) {
+			WARN_LOG(Log::G3D, "Failed to create vertex cache buffer (%s)", VulkanResultToString(result));
+			vertexCacheBuf_ = VK_NULL_HANDLE;
+			return nullptr;
+		}
+		result = vmaMapMemory(vulkan->Allocator(), vertexCacheAlloc_, (void **)&vertexCacheWritePtr_);
+		if (result != VK_SUCCESS) {
+			WARN_LOG(Log::G3D, "Failed to map vertex cache buffer (%s)", VulkanResultToString(result));
+			vulkan->Delete().QueueDeleteBufferAllocation(vertexCacheBuf_, vertexCacheAlloc_);
+			vertexCacheWritePtr_ = nullptr;
+			return nullptr;
+		}
+		vertexCacheUsed_ = 0;
+	}
+
+	*vbuf = vertexCacheBuf_;
+	*vbOffset = (uint32_t)vertexCacheUsed_;
+	u8 *ptr = vertexCacheWritePtr_ + vertexCacheUsed_;
+	vertexCacheUsed_ += size;
+	return ptr;
+}
+
+// Returns true if the vertices of the current draw list are now in the cache buffer, in which case
+// the decode bookkeeping has been done too. Otherwise the caller decodes as usual.
+bool DrawEngineVulkan::LookupVertexCache(VkBuffer *vbuf, uint32_t *vbOffset) {
+	u64 key = ComputeVertexCacheKey();
+	VertexArrayInfo *vai = vai_.GetOrNull(key);
+	if (!vai) {
+		vai = new VertexArrayInfo();
+		vai_.Insert(key, vai);
+	}
+
+	if (vai->lastFrame != gpuStats.numFlips) {
+		vai->numFrames++;
+		vai->lastFrame = gpuStats.numFlips;
+	}
+
+	switch (vai->status) {
+	case VertexArrayInfo::VAI_NEW:
+		vai->hash = ComputeVertexDataHash();
+		vai->numHashes = 1;
+		vai->status = VertexArrayInfo::VAI_HASHING;
+		return false;
+
+	case VertexArrayInfo::VAI_HASHING:
+	{
+		if (ComputeVertexDataHash() != vai->hash) {
+			vai->status = VertexArrayInfo::VAI_UNRELIABLE;
+			return false;
+		}
+		if (++vai->numHashes < VAI_HASHES_BEFORE_CACHING) {
+			return false;
+		}
+		size_t size = ComputeNumVertsToDecode() * dec_->GetDecVtxFmt().stride;
+		u8 *dest = AllocateVertexCache(size, &vai->vbuf, &vai->vbOffset);
+		if (!dest) {
+			vai->status = VertexArrayInfo::VAI_UNRELIABLE;
+			return false;
+		}
+		// The decoder clears vertexFullAlpha if it sees any translucent vertex, remember that for later draws.
+		bool prevFullAlpha = gstate_c.vertexFullAlpha;
+		gstate_c.vertexFullAlpha = true;
+		DecodeVerts(dec_, dest);
+		vai->vertexFullAlpha = gstate_c.vertexFullAlpha;
+		gstate_c.vertexFullAlpha = prevFullAlpha && vai->vertexFullAlpha;
+		vai->minihash = ComputeVertexDataMiniHash();
+		vai->drawsUntilNextFullHash = 1;
+		vai->status = VertexArrayInfo::VAI_RELIABLE;
+		break;
+	}
+
+	case VertexArrayInfo::VAI_RELIABLE:
+		if (vai->drawsUntilNextFullHash <= 0) {
+			if (ComputeVertexDataHash() != vai->hash) {
+				vai->status = VertexArrayInfo::VAI_UNRELIABLE;
+				return false;
+			}
+			vai->drawsUntilNextFullHash = std::min((int)VAI_MAX_DRAWS_BETWEEN_FULL_HASHES, vai->numFrames);
+		} else {
+			vai->drawsUntilNextFullHash--;
+			if (ComputeVertexDataMiniHash() != vai->minihash) {
+				vai->status = VertexArrayInfo::VAI_UNRELIABLE;
+				return false;
+			}
+		}
+		// Already decoded, just compute the offsets for the index decode.
+		DecodeVerts(dec_, nullptr);
+		gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && vai->vertexFullAlpha;
+		gpuStats.numCachedVertsDrawn += numDecodedVerts_;
+		break;
+
+	case VertexArrayInfo::VAI_UNRELIABLE:
+	default:
+		return false;
+	}
+
+	*vbuf = vai->vbuf;
+	*vbOffset = vai->vbOffset;
+	return true;
+}
+
+void DrawEngineVulkan::DecimateVertexCache() {
+	int threshold = gpuStats.numFlips - VAI_KILL_AGE;
+	int unreliableThreshold = gpuStats.numFlips - VAI_UNRELIABLE_KILL_AGE;
+	vai_.IterateMut([&](u64 key, VertexArrayInfo *vai) {
+		// Unreliable entries stick around a bit longer so we don't keep rehashing data that changes every frame,
+		// but they do eventually get another chance.
+		bool unreliable = vai->status == VertexArrayInfo::VAI_UNRELIABLE;
+		if (vai->lastFrame < (unreliable ? unreliableThreshold : threshold) || (unreliable && vai->numFrames > VAI_UNRELIABLE_KILL_AGE)) {
+			delete vai;
+			vai_.Remove(key);
+		}
+	});
+	vai_.Maintain();
+}
+
+void DrawEngineVulkan::ClearVertexCache() {
+	vai_.Iterate([](u64 key, VertexArrayInfo *vai) {
+		delete vai;
+	});
+	vai_.Clear();
+}
+
+void DrawEngineVulkan::DestroyVertexCacheBuffer() {
+	if (vertexCacheBuf_ == VK_NULL_HANDLE) {
+		return;
+	}
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+	vmaUnmapMemory(vulkan->Allocator(), vertexCacheAlloc_);
+	vulkan->Delete().QueueDeleteBufferAllocation(vertexCacheBuf_, vertexCacheAlloc_);
+	vertexCacheWritePtr_ = nullptr;
+	vertexCacheUsed_ = 0;
+}
+
 void DrawEngineVulkan::ResetAfterDraw() {
 	indexGen.Reset();
 	numDecodedVerts_ = 0;
@@ -59,6 +59,9 @@ class ShaderManagerVulkan;
 class PipelineManagerVulkan;
 class TextureCacheVulkan;
 class FramebufferManagerVulkan;
+class VulkanVertexShader;
+class VulkanFragmentShader;
+class VulkanGeometryShader;
 
 class VulkanContext;
 class VulkanPushPool;
@@ -165,6 +168,8 @@ class DrawEngineVulkan : public DrawEngineCommon {
 	void Invalidate(InvalidationCallbackFlags flags);
 
 	void ApplyDrawStateLate(VulkanRenderManager *renderManager, bool applyStencilRef, uint8_t stencilRef, bool useBlendConstant);
+	bool BindPipeline(VulkanRenderManager *renderManager, VulkanPipeline *pipeline, VulkanPipeline *fallback = nullptr);
+	VulkanPipeline *GetFallbackPipeline(VulkanRenderManager *renderManager, VulkanPipeline *pipeline, const DecVtxFormat *decFmt, VulkanVertexShader *vshader, VulkanFragmentShader *fshader, VulkanGeometryShader *gshader, bool useHWTransform);
 	void ConvertStateToVulkanKey(FramebufferManagerVulkan &fbManager, ShaderManagerVulkan *shaderManager, int prim, VulkanPipelineRasterStateKey &key, VulkanDynamicState &dynState);
 	void BindShaderBlendTex();
 
@@ -174,6 +179,19 @@ class DrawEngineVulkan : public DrawEngineCommon {
 
 	NO_INLINE void ResetAfterDraw();
 
+	// Vertex cache. Keeps decoded vertices in GPU memory across frames for draws
+	// that keep submitting the same, unchanged vertex data.
+	bool LookupVertexCache(VkBuffer *vbuf, uint32_t *vbOffset);
+	u64 ComputeVertexCacheKey() const;
+	u64 ComputeVertexDataHash() const;
+	u32 ComputeVertexDataMiniHash() const;
+	u8 *AllocateVertexCache(size_t size, VkBuffer *vbuf, uint32_t *vbOffset);
+	void DecimateVertexCache();
+	void ClearVertexCache();
+	void DestroyVertexCacheBuffer();
+
+	uint32_t PushIndices(const u16 *inds, int count, VkBuffer *ibuf);
+
 	Draw::DrawContext *draw_;
 
 	// We use a shared descriptor set layouts for all PSP draws.
@@ -237,4 +255,45 @@ class DrawEngineVulkan : public DrawEngineCommon {
 
 	// Hardware tessellation
 	TessellationDataTransferVulkan *tessDataTransferVulkan;
+
+	struct VertexArrayInfo {
+		enum Status : uint8_t {
+			VAI_NEW,
+			VAI_HASHING,
+			VAI_RELIABLE,  // Decoded into the cache buffer, mostly only mini-hashed from now on.
+			VAI_UNRELIABLE,  // Changed while being hashed, so we don't cache it.
+		};
+
+		Status status = VAI_NEW;
+		bool vertexFullAlpha = true;
+		u64 hash = 0;
+		u32 minihash = 0;
+		VkBuffer vbuf = VK_NULL_HANDLE;
+		uint32_t vbOffset = 0;
+		int numHashes = 0;
+		int numFrames = 0;
+		int drawsUntilNextFullHash = 0;
+		int lastFrame = 0;
+	};
+
+	DenseHashMap<u64, VertexArrayInfo *> vai_;
+	int decimationCounter_ = 0;
+
+	// Never reset per frame, instead entries are bump-allocated until the buffer is full,
+	// at which point all entries are dropped and the buffer is replaced.
+	VkBuffer vertexCacheBuf_ = VK_NULL_HANDLE;
+	VmaAllocation vertexCacheAlloc_ = VK_NULL_HANDLE;
+	u8 *vertexCacheWritePtr_ = nullptr;
+	size_t vertexCacheUsed_ = 0;
+
+	// Index data already pushed this frame, by hash. Flushes often generate the exact same
+	// indices (the same mesh, decoded to the start of the buffer), those can share one copy.
+	struct PushedIndices {
+		u64 hash;
+		uint32_t size;
+		uint32_t offset;
+		VkBuffer buf;
+	};
+	enum { PUSHED_INDICES_SLOTS = 64 };
+	PushedIndices pushedIndices_[PUSHED_INDICES_SLOTS]{};
 };
@@ -23,6 +23,8 @@
 #include "Common/Log.h"
 #include "Common/File/FileUtil.h"
 #include "Common/GraphicsContext.h"
+#include "Common/Data/Text/I18n.h"
+#include "Common/System/OSD.h"
 
 #include "Core/Config.h"
 #include "Core/Reporting.h"
@@ -87,6 +89,7 @@ GPU_Vulkan::GPU_Vulkan(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 	if (discID.size()) {
 		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
 		shaderCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".vkshadercache");
+		shaderIDListPath_ = ShaderIDListPath(discID);
 		LoadCache(shaderCachePath_);
 	}
 }
@@ -99,10 +102,18 @@ void GPU_Vulkan::LoadCache(const Path &filename) {
 
 	// Actually precompiled by IsReady() since we're single-threaded.
 	FILE *f = File::OpenCFile(filename, "rb");
-	if (!f)
+	if (!f) {
+		// Maybe another backend has seen this game before.
+		ShaderIDList idList;
+		if (LoadShaderIDList(shaderIDListPath_, &idList)) {
+			FilterShaderIDList(&idList);
+			shaderManagerVulkan_->PrecompileShaderIDList(idList);
+		}
 		return;
+	}
 
-	// First compile shaders to SPIR-V, then load the pipeline cache and recreate the pipelines.
+	// First compile shaders to SPIR-V, then load the pipeline cache and queue up the pipelines,
+	// which are then recreated in the background from BeginHostFrame.
 	// It's when recreating the pipelines that the pipeline cache is useful - in the ideal case,
 	// it can just memcpy the finished shader binaries out of the pipeline cache file.
 	bool result = shaderManagerVulkan_->LoadCacheFlags(f, &drawEngine_);
@@ -147,25 +158,38 @@ void GPU_Vulkan::SaveCache(const Path &filename) {
 		return;
 	}
 
-	FILE *f = File::OpenCFile(filename, "wb");
+	// Other instances may share the cache directory, so never let them see a half written file.
+	Path tempPath = File::TempPathFor(filename);
+	FILE *f = File::OpenCFile(tempPath, "wb");
 	if (!f)
 		return;
 	shaderManagerVulkan_->SaveCache(f, &drawEngine_);
 	// WARNING: See comment in LoadCache if you are tempted to flip the second parameter to true.
 	pipelineManager_->SavePipelineCache(f, false, shaderManagerVulkan_, draw_);
-	INFO_LOG(Log::G3D, "Saved Vulkan pipeline cache");
 	fclose(f);
+	if (File::ReplaceFile(tempPath, filename))
+		INFO_LOG(Log::G3D, "Saved Vulkan pipeline cache");
+	else
+		File::Delete(tempPath);
+
+	ShaderIDList idList;
+	shaderManagerVulkan_->GetShaderIDList(&idList);
+	SaveShaderIDList(shaderIDListPath_, idList);
 }
 
 GPU_Vulkan::~GPU_Vulkan() {
 	if (draw_) {
 		VulkanRenderManager *rm = (VulkanRenderManager *)draw_->GetNativeObject(Draw::NativeObject::RENDER_MANAGER);
+		// Don't queue up any more, whatever is left is saved back to the cache below.
+		pipelineManager_->CancelPrecompile();
 		// This now also does a hard sync with the render thread, so that we can safely delete our pipeline layout below.
 		rm->StopThreads();
 		rm->CheckNothingPending();
 	}
 
 	SaveCache(shaderCachePath_);
+	if (showingPrecompileProgress_)
+		g_OSD.RemoveProgressBar("vkprecompile", false, 0.0f);
 
 	// StopThreads should have ensured that no pipelines are queued to compile at this point. So we can tear it down.
 	delete pipelineManager_;
@@ -293,9 +317,31 @@ void GPU_Vulkan::BeginHostFrame() {
 
 	framebufferManager_->BeginFrame();
 
+	// The texture cache trims itself continuously while under pressure. Pooled framebuffers are only
+	// kept around for reuse, so drop them once when we first get close to the budget.
+	const bool memoryPressure = vulkan->IsUnderMemoryPressure();
+	if (memoryPressure && !memoryPressure_) {
+		WARN_LOG(Log::G3D, "Near GPU memory budget (%d / %d MB), releasing pooled framebuffers", (int)(vulkan->GetDeviceLocalMemoryUsage() >> 20), (int)(vulkan->GetDeviceLocalMemoryBudget() >> 20));
+		framebufferManager_->DecimateFramebufferPool(true);
+	}
+	memoryPressure_ = memoryPressure;
+
 	shaderManagerVulkan_->DirtyLastShader();
 	gstate_c.Dirty(DIRTY_ALL);
 
+	VulkanRenderManager *rm = (VulkanRenderManager *)draw_->GetNativeObject(Draw::NativeObject::RENDER_MANAGER);
+	pipelineManager_->PrecompileStep(rm, shaderManagerVulkan_);
+	if (pipelineManager_->IsPrecompiling()) {
+		int done, total;
+		pipelineManager_->GetPrecompileProgress(&done, &total);
+		auto gr = GetI18NCategory(I18NCat::GRAPHICS);
+		g_OSD.SetProgressBar("vkprecompile", gr->T("Precompiling shaders"), 0.0f, (float)total, (float)done, 0.5f);
+		showingPrecompileProgress_ = true;
+	} else if (showingPrecompileProgress_) {
+		g_OSD.RemoveProgressBar("vkprecompile", true, 0.5f);
+		showingPrecompileProgress_ = false;
+	}
+
 	if (gstate_c.useFlagsChanged) {
 		// TODO: It'd be better to recompile them in the background, probably?
 		// This most likely means that saw equal depth changed.
@@ -303,6 +349,7 @@ void GPU_Vulkan::BeginHostFrame() {
 		// TODO: Not all shaders need to be recompiled. In fact, quite few? Of course, depends on
 		// the use flag change.. This is a major frame rate hitch in the start of a race in Outrun.
 		shaderManager_->ClearShaders();
+		pipelineManager_->CancelPrecompile();
 		pipelineManager_->Clear();
 		framebufferManager_->ClearAllDepthBuffers();
 		gstate_c.useFlagsChanged = false;
@@ -428,6 +475,10 @@ void GPU_Vulkan::DeviceLost() {
 	if (shaderCachePath_.Valid()) {
 		SaveCache(shaderCachePath_);
 	}
+	if (showingPrecompileProgress_) {
+		g_OSD.RemoveProgressBar("vkprecompile", false, 0.0f);
+		showingPrecompileProgress_ = false;
+	}
 	DestroyDeviceObjects();
 	pipelineManager_->DeviceLost();
 
@@ -457,15 +508,20 @@ void GPU_Vulkan::GetStats(char *buffer, size_t bufsize) {
 	const DrawEngineVulkanStats &drawStats = drawEngine_.GetStats();
 	char texStats[256];
 	textureCacheVulkan_->GetStats(texStats, sizeof(texStats));
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 	snprintf(buffer, bufsize,
 		"Vertex, Fragment, Pipelines loaded: %i, %i, %i\n"
 		"Pushbuffer space used: Vtx %d, Idx %d\n"
+		"GPU memory: %d / %d MB%s\n"
 		"%s\n",
 		shaderManagerVulkan_->GetNumVertexShaders(),
 		shaderManagerVulkan_->GetNumFragmentShaders(),
 		pipelineManager_->GetNumPipelines(),
 		drawStats.pushVertexSpaceUsed,
 		drawStats.pushIndexSpaceUsed,
+		(int)(vulkan->GetDeviceLocalMemoryUsage() >> 20),
+		(int)(vulkan->GetDeviceLocalMemoryBudget() >> 20),
+		vulkan->IsUnderMemoryPressure() ? " (under pressure)" : "",
 		texStats
 	);
 }
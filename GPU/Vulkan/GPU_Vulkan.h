@@ -81,4 +81,7 @@ class GPU_Vulkan : public GPUCommonHW {
 	PipelineManagerVulkan *pipelineManager_;
 
 	Path shaderCachePath_;
+	Path shaderIDListPath_;
+	bool showingPrecompileProgress_ = false;
+	bool memoryPressure_ = false;
 };
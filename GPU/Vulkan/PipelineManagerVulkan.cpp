@@ -1,6 +1,7 @@
+#include <algorithm>
 #include <cstring>
+#include <map>
 #include <memory>
-#include <set>
 #include <sstream>
 
 #include "Common/Profiler/Profiler.h"
@@ -11,6 +12,8 @@
 #include "GPU/Vulkan/PipelineManagerVulkan.h"
 #include "GPU/Vulkan/ShaderManagerVulkan.h"
 #include "GPU/Common/ShaderId.h"
+#include "GPU/GPU.h"
+#include "Core/HW/Display.h"
 #include "Common/GPU/thin3d.h"
 #include "Common/GPU/Vulkan/VulkanRenderManager.h"
 #include "Common/GPU/Vulkan/VulkanQueueRunner.h"
@@ -56,12 +59,15 @@ void PipelineManagerVulkan::Clear() {
 }
 
 void PipelineManagerVulkan::InvalidateMSAAPipelines() {
+	// The queued variants were filtered for the old MSAA level.
+	CancelPrecompile();
 	pipelines_.Iterate([&](const VulkanPipelineKey &key, VulkanPipeline *value) {
 		value->pipeline->DestroyVariants(vulkan_, true);
 	});
 }
 
 void PipelineManagerVulkan::DeviceLost() {
+	CancelPrecompile();
 	Clear();
 	if (pipelineCache_ != VK_NULL_HANDLE)
 		vulkan_->Delete().QueueDeletePipelineCache(pipelineCache_);
@@ -212,6 +218,8 @@ static VulkanPipeline *CreateVulkanPipeline(VulkanRenderManager *renderManager,
 
 	PROFILE_THIS_SCOPE("pipelinebuild");
 	bool useBlendConstant = false;
+	// With this, the depth/stencil and cull state in the key are never used, they've been cleared by the caller.
+	bool dynamicDepthStencil = (pipelineFlags & PipelineFlags::USES_DYNAMIC_DEPTH_STENCIL) != 0;
 
 	VkPipelineColorBlendAttachmentState &blend0 = desc->blend0;
 	blend0.blendEnable = key.blendEnable;
@@ -261,11 +269,20 @@ static VulkanPipeline *CreateVulkanPipeline(VulkanRenderManager *renderManager,
 	}
 	dynamicStates[numDyn++] = VK_DYNAMIC_STATE_SCISSOR;
 	dynamicStates[numDyn++] = VK_DYNAMIC_STATE_VIEWPORT;
-	if (key.stencilTestEnable) {
+	if (key.stencilTestEnable || dynamicDepthStencil) {
 		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_STENCIL_WRITE_MASK;
 		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK;
 		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_STENCIL_REFERENCE;
 	}
+	if (dynamicDepthStencil) {
+		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_CULL_MODE_EXT;
+		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT;
+		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT;
+		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT;
+		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT;
+		dynamicStates[numDyn++] = VK_DYNAMIC_STATE_STENCIL_OP_EXT;
+	}
+	_dbg_assert_((size_t)numDyn <= ARRAY_SIZE(desc->dynamicStates));
 
 	VkPipelineDynamicStateCreateInfo &ds = desc->ds;
 	ds.flags = 0;
@@ -346,6 +363,7 @@ static VulkanPipeline *CreateVulkanPipeline(VulkanRenderManager *renderManager,
 	if (gs) {
 		pipelineFlags |= PipelineFlags::USES_GEOMETRY_SHADER;
 	}
+	// With dynamic depth/stencil, the draw engine adds this flag at bind time instead.
 	if (dss.depthTestEnable || dss.stencilTestEnable) {
 		pipelineFlags |= PipelineFlags::USES_DEPTH_STENCIL;
 	}
@@ -353,13 +371,49 @@ static VulkanPipeline *CreateVulkanPipeline(VulkanRenderManager *renderManager,
 	return vulkanPipeline;
 }
 
-VulkanPipeline *PipelineManagerVulkan::GetOrCreatePipeline(VulkanRenderManager *renderManager, VKRPipelineLayout *layout, const VulkanPipelineRasterStateKey &rasterKey, const DecVtxFormat *decFmt, VulkanVertexShader *vs, VulkanFragmentShader *fs, VulkanGeometryShader *gs, bool useHwTransform, u32 variantBitmask, int multiSampleLevel, bool cacheLoad) {
+bool PipelineManagerVulkan::UseDynamicDepthStencil() const {
+	return vulkan_->GetDeviceFeatures().enabled.extendedDynamicState.extendedDynamicState;
+}
+
+void PipelineManagerVulkan::StripDynamicState(VulkanPipelineRasterStateKey *key) {
+	key->depthTestEnable = 0;
+	key->depthWriteEnable = 0;
+	key->depthCompareOp = 0;
+	key->stencilTestEnable = 0;
+	key->stencilCompareOp = 0;
+	key->stencilPassOp = 0;
+	key->stencilFailOp = 0;
+	key->stencilDepthFailOp = 0;
+	key->cullMode = 0;
+}
+
+VKRDynamicDepthStencil PipelineManagerVulkan::GetDynamicDepthStencil(const VulkanPipelineRasterStateKey &key) {
+	VKRDynamicDepthStencil state;
+	state.cullMode = key.cullMode;
+	state.depthTestEnable = key.depthTestEnable;
+	state.depthWriteEnable = key.depthTestEnable && key.depthWriteEnable;
+	state.depthCompareOp = key.depthTestEnable ? key.depthCompareOp : VK_COMPARE_OP_ALWAYS;
+	state.stencilTestEnable = key.stencilTestEnable;
+	state.stencilCompareOp = key.stencilTestEnable ? key.stencilCompareOp : VK_COMPARE_OP_ALWAYS;
+	state.stencilPassOp = key.stencilPassOp;
+	state.stencilFailOp = key.stencilFailOp;
+	state.stencilDepthFailOp = key.stencilDepthFailOp;
+	return state;
+}
+
+VulkanPipeline *PipelineManagerVulkan::GetOrCreatePipeline(VulkanRenderManager *renderManager, VKRPipelineLayout *layout, const VulkanPipelineRasterStateKey &fullRasterKey, const DecVtxFormat *decFmt, VulkanVertexShader *vs, VulkanFragmentShader *fs, VulkanGeometryShader *gs, bool useHwTransform, u32 variantBitmask, int multiSampleLevel, bool cacheLoad) {
 	if (!pipelineCache_) {
 		VkPipelineCacheCreateInfo pc{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
 		VkResult res = vkCreatePipelineCache(vulkan_->GetDevice(), &pc, nullptr, &pipelineCache_);
 		_assert_(VK_SUCCESS == res);
 	}
 
+	// With extended dynamic state, one pipeline covers all the depth/stencil/cull combinations.
+	bool dynamicDepthStencil = UseDynamicDepthStencil();
+	VulkanPipelineRasterStateKey rasterKey = fullRasterKey;
+	if (dynamicDepthStencil)
+		StripDynamicState(&rasterKey);
+
 	VulkanPipelineKey key{};
 
 	key.raster = rasterKey;
@@ -371,9 +425,15 @@ VulkanPipeline *PipelineManagerVulkan::GetOrCreatePipeline(VulkanRenderManager *
 
 	VulkanPipeline *pipeline;
 	if (pipelines_.Get(key, &pipeline)) {
+		if (pipeline && !cacheLoad)
+			pipeline->lastUsedFrame = gpuStats.numFlips;
 		return pipeline;
 	}
 
+	// The pipeline compiles on another thread, but the draws using it will have to wait.
+	if (!cacheLoad)
+		DisplayNotifyCause(FRAME_CAUSE_SHADER_COMPILE);
+
 	PipelineFlags pipelineFlags = (PipelineFlags)0;
 	if (fs->Flags() & FragmentShaderFlags::USES_DISCARD) {
 		pipelineFlags |= PipelineFlags::USES_DISCARD;
@@ -384,6 +444,9 @@ VulkanPipeline *PipelineManagerVulkan::GetOrCreatePipeline(VulkanRenderManager *
 	if (vs->Flags() & VertexShaderFlags::MULTI_VIEW) {
 		pipelineFlags |= PipelineFlags::USES_MULTIVIEW;
 	}
+	if (dynamicDepthStencil) {
+		pipelineFlags |= PipelineFlags::USES_DYNAMIC_DEPTH_STENCIL;
+	}
 
 	VkSampleCountFlagBits sampleCount = MultiSampleLevelToFlagBits(multiSampleLevel);
 
@@ -391,6 +454,12 @@ VulkanPipeline *PipelineManagerVulkan::GetOrCreatePipeline(VulkanRenderManager *
 		renderManager, pipelineCache_, layout, pipelineFlags, sampleCount,
 		rasterKey, decFmt, vs, fs, gs, useHwTransform, variantBitmask, cacheLoad);
 
+	if (pipeline) {
+		pipeline->createdFrame = gpuStats.numFlips;
+		if (!cacheLoad)
+			pipeline->lastUsedFrame = gpuStats.numFlips;
+	}
+
 	// If the above failed, we got a null pipeline. We still insert it to keep track.
 	pipelines_.Insert(key, pipeline);
 
@@ -617,21 +686,6 @@ struct VkPipelineCacheHeader {
 	uint8_t uuid[VK_UUID_SIZE];
 };
 
-struct StoredVulkanPipelineKey {
-	VulkanPipelineRasterStateKey raster;
-	VShaderID vShaderID;
-	FShaderID fShaderID;
-	GShaderID gShaderID;
-	uint32_t vtxFmtId;
-	uint32_t variants;
-	bool useHWTransform;  // TODO: Still needed?
-
-	// For std::set. Better zero-initialize the struct properly for this to work.
-	bool operator < (const StoredVulkanPipelineKey &other) const {
-		return memcmp(this, &other, sizeof(*this)) < 0;
-	}
-};
-
 // If you're looking for how to invalidate the cache, it's done in ShaderManagerVulkan, look for CACHE_VERSION and increment it.
 // (Header of the same file this is stored in).
 void PipelineManagerVulkan::SavePipelineCache(FILE *file, bool saveRawPipelineCache, ShaderManagerVulkan *shaderManager, Draw::DrawContext *drawContext) {
@@ -665,7 +719,17 @@ void PipelineManagerVulkan::SavePipelineCache(FILE *file, bool saveRawPipelineCa
 	// Since we don't include the full pipeline key, there can be duplicates,
 	// caused by things like switching from buffered to non-buffered rendering.
 	// Make sure the set of pipelines we write is "unique".
-	std::set<StoredVulkanPipelineKey> keys;
+	// Each one is stored with its age, the number of frames since it was last drawn with, so the
+	// next run can precompile the most recently used ones first.
+	std::map<StoredVulkanPipelineKey, uint32_t> keys;
+	const uint32_t curFrame = (uint32_t)gpuStats.numFlips;
+	auto addKey = [&](const StoredVulkanPipelineKey &key, uint32_t age) {
+		auto iter = keys.find(key);
+		if (iter == keys.end())
+			keys[key] = age;
+		else
+			iter->second = std::min(iter->second, age);
+	};
 
 	pipelines_.Iterate([&](const VulkanPipelineKey &pkey, VulkanPipeline *value) {
 		if (failed)
@@ -694,16 +758,23 @@ void PipelineManagerVulkan::SavePipelineCache(FILE *file, bool saveRawPipelineCa
 			// NOTE: This is not a vtype, but a decoded vertex format.
 			key.vtxFmtId = pkey.vtxFmtId;
 		}
-		keys.insert(key);
+		uint32_t age = value->lastUsedFrame >= 0 ? curFrame - (uint32_t)value->lastUsedFrame : value->cachedAge + curFrame;
+		addKey(key, age);
 	});
 
+	// Keep the ones we didn't get around to precompiling, too.
+	for (size_t i = precompileIndex_; i < precompileQueue_.size(); i++) {
+		addKey(precompileQueue_[i].key, precompileQueue_[i].age + curFrame);
+	}
+
 	// Write the number of pipelines.
 	size = (uint32_t)keys.size();
 	writeFailed = writeFailed || fwrite(&size, sizeof(size), 1, file) != 1;
 
 	// Write the pipelines.
-	for (auto &key : keys) {
-		writeFailed = writeFailed || fwrite(&key, sizeof(key), 1, file) != 1;
+	for (auto &iter : keys) {
+		writeFailed = writeFailed || fwrite(&iter.first, sizeof(iter.first), 1, file) != 1;
+		writeFailed = writeFailed || fwrite(&iter.second, sizeof(iter.second), 1, file) != 1;
 	}
 
 	if (failed) {
@@ -782,58 +853,103 @@ bool PipelineManagerVulkan::LoadPipelineCache(FILE *file, bool loadRawPipelineCa
 	// Read the number of pipelines.
 	bool failed = fread(&size, sizeof(size), 1, file) != 1;
 
-	NOTICE_LOG(Log::G3D, "Creating %d pipelines from cache (%dx MSAA)...", size, (1 << multiSampleLevel));
-	int pipelineCreateFailCount = 0;
-	int shaderFailCount = 0;
+	// The pipelines aren't created here, just queued up for PrecompileStep, so we don't block the game start.
+	precompileQueue_.clear();
+	precompileIndex_ = 0;
+	precompileCancelled_ = false;
+	precompileFailCount_ = 0;
+	precompileLayout_ = layout;
+	precompileMultiSampleLevel_ = multiSampleLevel;
+
 	for (uint32_t i = 0; i < size; i++) {
 		if (failed) {
 			break;
 		}
-		StoredVulkanPipelineKey key;
-		failed = failed || fread(&key, sizeof(key), 1, file) != 1;
+		PrecompileEntry entry;
+		failed = failed || fread(&entry.key, sizeof(entry.key), 1, file) != 1;
+		failed = failed || fread(&entry.age, sizeof(entry.age), 1, file) != 1;
 		if (failed) {
 			ERROR_LOG(Log::G3D, "Truncated Vulkan pipeline cache file, stopping.");
 			break;
 		}
 
-		if (key.raster.topology == VK_PRIMITIVE_TOPOLOGY_POINT_LIST || key.raster.topology == VK_PRIMITIVE_TOPOLOGY_LINE_LIST) {
+		if (entry.key.raster.topology == VK_PRIMITIVE_TOPOLOGY_POINT_LIST || entry.key.raster.topology == VK_PRIMITIVE_TOPOLOGY_LINE_LIST) {
 			WARN_LOG(Log::G3D, "Bad raster key in cache, ignoring");
 			continue;
 		}
+		precompileQueue_.push_back(entry);
+	}
 
-		VulkanVertexShader *vs = shaderManager->GetVertexShaderFromID(key.vShaderID);
-		VulkanFragmentShader *fs = shaderManager->GetFragmentShaderFromID(key.fShaderID);
-		VulkanGeometryShader *gs = shaderManager->GetGeometryShaderFromID(key.gShaderID);
-		if (!vs || !fs || (!gs && key.gShaderID.Bit(GS_BIT_ENABLED))) {
-			// We just ignore this one, it'll get created later if needed.
-			// Probably some useFlags mismatch.
-			WARN_LOG(Log::G3D, "Failed to find vs or fs in pipeline %d in cache, skipping pipeline", (int)i);
-			continue;
-		}
+	// Most recently used first. Stable, so equal ages keep the saved order.
+	std::stable_sort(precompileQueue_.begin(), precompileQueue_.end(), [](const PrecompileEntry &a, const PrecompileEntry &b) {
+		return a.age < b.age;
+	});
+
+	NOTICE_LOG(Log::G3D, "Queued %d pipelines from cache for precompilation (%dx MSAA).", (int)precompileQueue_.size(), (1 << multiSampleLevel));
+	// We just ignore any failures.
+	return true;
+}
 
-		// Avoid creating multisampled shaders if it's not enabled, as that results in an invalid combination.
-		// Note that variantsToBuild is NOT directly a RenderPassType! instead, it's a collection of (1 << RenderPassType).
-		u32 variantsToBuild = key.variants;
-		if (multiSampleLevel == 0) {
-			for (u32 i = 0; i < (int)RenderPassType::TYPE_COUNT; i++) {
-				if (RenderPassTypeHasMultisample((RenderPassType)i)) {
-					variantsToBuild &= ~(1 << i);
-				}
+VulkanPipeline *PipelineManagerVulkan::CreateFromStoredKey(VulkanRenderManager *renderManager, ShaderManagerVulkan *shaderManager, const StoredVulkanPipelineKey &key) {
+	VulkanVertexShader *vs = shaderManager->GetVertexShaderFromID(key.vShaderID);
+	VulkanFragmentShader *fs = shaderManager->GetFragmentShaderFromID(key.fShaderID);
+	VulkanGeometryShader *gs = shaderManager->GetGeometryShaderFromID(key.gShaderID);
+	if (!vs || !fs || (!gs && key.gShaderID.Bit(GS_BIT_ENABLED))) {
+		// We just ignore this one, it'll get created later if needed.
+		// Probably some useFlags mismatch.
+		WARN_LOG(Log::G3D, "Failed to find vs or fs for pipeline in cache, skipping pipeline");
+		return nullptr;
+	}
+
+	// Avoid creating multisampled shaders if it's not enabled, as that results in an invalid combination.
+	// Note that variantsToBuild is NOT directly a RenderPassType! instead, it's a collection of (1 << RenderPassType).
+	u32 variantsToBuild = key.variants;
+	if (precompileMultiSampleLevel_ == 0) {
+		for (u32 i = 0; i < (int)RenderPassType::TYPE_COUNT; i++) {
+			if (RenderPassTypeHasMultisample((RenderPassType)i)) {
+				variantsToBuild &= ~(1 << i);
 			}
 		}
+	}
+
+	DecVtxFormat fmt;
+	fmt.InitializeFromID(key.vtxFmtId);
+	return GetOrCreatePipeline(
+		renderManager, precompileLayout_, key.raster, key.useHWTransform ? &fmt : 0, vs, fs, gs, key.useHWTransform, variantsToBuild, precompileMultiSampleLevel_, true);
+}
+
+// Limits how many precompiles can be waiting on the compile threads, so that pipelines
+// missing at draw time don't end up queued behind the whole cache.
+static const int PRECOMPILE_MAX_PENDING = 32;
+
+void PipelineManagerVulkan::PrecompileStep(VulkanRenderManager *renderManager, ShaderManagerVulkan *shaderManager) {
+	if (!IsPrecompiling())
+		return;
 
-		DecVtxFormat fmt;
-		fmt.InitializeFromID(key.vtxFmtId);
-		VulkanPipeline *pipeline = GetOrCreatePipeline(
-			rm, layout, key.raster, key.useHWTransform ? &fmt : 0, vs, fs, gs, key.useHWTransform, variantsToBuild, multiSampleLevel, true);
-		if (!pipeline) {
-			pipelineCreateFailCount += 1;
+	bool queued = false;
+	while (precompileIndex_ < precompileQueue_.size() && renderManager->GetNumPrecompilesPending() < PRECOMPILE_MAX_PENDING) {
+		const PrecompileEntry &entry = precompileQueue_[precompileIndex_++];
+		VulkanPipeline *pipeline = CreateFromStoredKey(renderManager, shaderManager, entry.key);
+		if (pipeline) {
+			if (pipeline->lastUsedFrame < 0)
+				pipeline->cachedAge = entry.age;
+		} else {
+			precompileFailCount_++;
 		}
+		queued = true;
 	}
 
-	rm->NudgeCompilerThread();
+	if (queued)
+		renderManager->NudgeCompilerThread();
 
-	NOTICE_LOG(Log::G3D, "Recreated Vulkan pipeline cache (%d pipelines, %d failed).", (int)size, pipelineCreateFailCount);
-	// We just ignore any failures.
-	return true;
+	if (precompileIndex_ >= precompileQueue_.size()) {
+		NOTICE_LOG(Log::G3D, "Recreated Vulkan pipeline cache (%d pipelines, %d failed).", (int)precompileQueue_.size(), precompileFailCount_);
+	}
+}
+
+void PipelineManagerVulkan::CancelPrecompile() {
+	if (IsPrecompiling()) {
+		INFO_LOG(Log::G3D, "Cancelled pipeline precompilation (%d/%d done).", (int)precompileIndex_, (int)precompileQueue_.size());
+	}
+	precompileCancelled_ = true;
 }
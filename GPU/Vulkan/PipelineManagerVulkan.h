@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "Common/Data/Collections/Hashmaps.h"
 #include "Common/Thread/Promise.h"
@@ -76,8 +77,31 @@ struct VulkanPipeline {
 	bool UsesGeometryShader() const { return (pipelineFlags & PipelineFlags::USES_GEOMETRY_SHADER) != 0; }
 	bool UsesDiscard() const { return (pipelineFlags & PipelineFlags::USES_DISCARD) != 0; }
 	bool UsesFlatShading() const { return (pipelineFlags & PipelineFlags::USES_FLAT_SHADING) != 0; }
+	bool UsesDynamicDepthStencil() const { return (pipelineFlags & PipelineFlags::USES_DYNAMIC_DEPTH_STENCIL) != 0; }
 
 	u32 GetVariantsBitmask() const;
+
+	// Frame (gpuStats.numFlips) of the last draw using this pipeline, or -1 if none this session.
+	int lastUsedFrame = -1;
+	// How many frames before the cache was saved it was last used, if it came from the cache.
+	u32 cachedAge = 0;
+	// Frame (gpuStats.numFlips) this pipeline was created, whether for a draw or from the cache.
+	int createdFrame = 0;
+};
+
+struct StoredVulkanPipelineKey {
+	VulkanPipelineRasterStateKey raster;
+	VShaderID vShaderID;
+	FShaderID fShaderID;
+	GShaderID gShaderID;
+	uint32_t vtxFmtId;
+	uint32_t variants;
+	bool useHWTransform;  // TODO: Still needed?
+
+	// For std::set. Better zero-initialize the struct properly for this to work.
+	bool operator < (const StoredVulkanPipelineKey &other) const {
+		return memcmp(this, &other, sizeof(*this)) < 0;
+	}
 };
 
 class PipelineManagerVulkan {
@@ -89,6 +113,12 @@ class PipelineManagerVulkan {
 	VulkanPipeline *GetOrCreatePipeline(VulkanRenderManager *renderManager, VKRPipelineLayout *layout, const VulkanPipelineRasterStateKey &rasterKey, const DecVtxFormat *decFmt, VulkanVertexShader *vs, VulkanFragmentShader *fs, VulkanGeometryShader *gs, bool useHwTransform, u32 variantMask, int multiSampleLevel, bool cacheLoad);
 	int GetNumPipelines() const { return (int)pipelines_.size(); }
 
+	// With VK_EXT_extended_dynamic_state, cull mode and depth/stencil state are left out of the pipelines
+	// and have to be set with VulkanRenderManager::SetDynamicDepthStencil after binding.
+	bool UseDynamicDepthStencil() const;
+	static void StripDynamicState(VulkanPipelineRasterStateKey *key);
+	static VKRDynamicDepthStencil GetDynamicDepthStencil(const VulkanPipelineRasterStateKey &key);
+
 	void Clear();
 
 	void DeviceLost();
@@ -103,8 +133,35 @@ class PipelineManagerVulkan {
 	void SavePipelineCache(FILE *file, bool saveRawPipelineCache, ShaderManagerVulkan *shaderManager, Draw::DrawContext *drawContext);
 	bool LoadPipelineCache(FILE *file, bool loadRawPipelineCache, ShaderManagerVulkan *shaderManager, Draw::DrawContext *drawContext, VKRPipelineLayout *layout, int multiSampleLevel);
 
+	// Pipelines loaded from the cache are created in the background, most recently used first.
+	// Call once per frame to queue more as the previous ones finish compiling.
+	void PrecompileStep(VulkanRenderManager *renderManager, ShaderManagerVulkan *shaderManager);
+	// Stops queueing, the remaining pipelines are still saved to the cache.
+	void CancelPrecompile();
+	bool IsPrecompiling() const {
+		return !precompileCancelled_ && precompileIndex_ < precompileQueue_.size();
+	}
+	void GetPrecompileProgress(int *done, int *total) const {
+		*done = (int)precompileIndex_;
+		*total = (int)precompileQueue_.size();
+	}
+
 private:
+	struct PrecompileEntry {
+		StoredVulkanPipelineKey key;
+		u32 age;
+	};
+
+	VulkanPipeline *CreateFromStoredKey(VulkanRenderManager *renderManager, ShaderManagerVulkan *shaderManager, const StoredVulkanPipelineKey &key);
+
 	DenseHashMap<VulkanPipelineKey, VulkanPipeline *> pipelines_;
 	VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
 	VulkanContext *vulkan_;
+
+	std::vector<PrecompileEntry> precompileQueue_;
+	size_t precompileIndex_ = 0;
+	bool precompileCancelled_ = false;
+	int precompileFailCount_ = 0;
+	VKRPipelineLayout *precompileLayout_ = nullptr;
+	int precompileMultiSampleLevel_ = 0;
 };
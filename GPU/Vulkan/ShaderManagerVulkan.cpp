@@ -21,18 +21,22 @@
 
 #include "Common/LogReporting.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/GPU/thin3d.h"
 #include "Common/MemoryUtil.h"
 
 #include "Common/StringUtils.h"
 #include "Common/GPU/Vulkan/VulkanContext.h"
 #include "Common/Log.h"
+#include "Core/HW/Display.h"
+#include "Core/System.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/FragmentShaderGenerator.h"
 #include "GPU/Common/VertexShaderGenerator.h"
 #include "GPU/Common/GeometryShaderGenerator.h"
 #include "GPU/Vulkan/ShaderManagerVulkan.h"
 #include "GPU/Vulkan/DrawEngineVulkan.h"
+#include "ext/xxhash.h"
 
 // Most drivers treat vkCreateShaderModule as pretty much a memcpy. What actually
 // takes time here, and makes this worthy of parallelization, is GLSLtoSPV.
@@ -41,6 +45,7 @@
 static Promise<VkShaderModule> *CompileShaderModuleAsync(VulkanContext *vulkan, VkShaderStageFlagBits stage, const char *code, std::string *tag) {
 	auto compile = [=] {
 		PROFILE_THIS_SCOPE("shadercomp");
+		TRACE_SCOPE("shader_compile");
 
 		std::string errorMessage;
 		std::vector<uint32_t> spirv;
@@ -279,6 +284,25 @@ uint64_t ShaderManagerVulkan::UpdateUniforms(bool useBufferedRendering) {
 	return dirty;
 }
 
+uint32_t ShaderManagerVulkan::PushUBO(int slot, const void *data, size_t size, VulkanPushPool *dest, VkBuffer *buf) {
+	// Even when the dirty flags are set, the contents often match a block pushed a few draws ago.
+	const uint64_t hash = XXH3_64bits(data, size);
+	PushedUBO &pushed = pushedUBOs_[slot][hash & (PUSHED_UBO_CACHE_SIZE - 1)];
+	if (pushed.buf != VK_NULL_HANDLE && pushed.hash == hash) {
+		*buf = pushed.buf;
+		return pushed.offset;
+	}
+
+	pushed.offset = (uint32_t)dest->Push(data, size, uboAlignment_, buf);
+	pushed.hash = hash;
+	pushed.buf = *buf;
+	return pushed.offset;
+}
+
+void ShaderManagerVulkan::ResetPushedUBOs() {
+	memset(pushedUBOs_, 0, sizeof(pushedUBOs_));
+}
+
 void ShaderManagerVulkan::GetShaders(int prim, VertexDecoder *decoder, VulkanVertexShader **vshader, VulkanFragmentShader **fshader, VulkanGeometryShader **gshader, const ComputedPipelineState &pipelineState, bool useHWTransform, bool useHWTessellation, bool weightsAsFloat, bool useSkinInDecode) {
 	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 
@@ -292,6 +316,7 @@ void ShaderManagerVulkan::GetShaders(int prim, VertexDecoder *decoder, VulkanVer
 			vs = lastVShader_;
 		} else if (!vsCache_.Get(VSID, &vs)) {
 			// Vertex shader not in cache. Let's compile it.
+			FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 			std::string genErrorString;
 			uint64_t uniformMask = 0;  // Not used
 			uint32_t attributeMask = 0;  // Not used
@@ -322,6 +347,7 @@ void ShaderManagerVulkan::GetShaders(int prim, VertexDecoder *decoder, VulkanVer
 			fs = lastFShader_;
 		} else if (!fsCache_.Get(FSID, &fs)) {
 			// Fragment shader not in cache. Let's compile it.
+			FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 			std::string genErrorString;
 			uint64_t uniformMask = 0;  // Not used
 			FragmentShaderFlags flags{};
@@ -334,6 +360,13 @@ void ShaderManagerVulkan::GetShaders(int prim, VertexDecoder *decoder, VulkanVer
 		}
 		lastFShader_ = fs;
 		lastFSID_ = FSID;
+
+		// Used by the generic tests variant, if it's bound instead of fs while fs compiles.
+		uint32_t fragTestFlags = PackFragmentTestFlags(FSID);
+		if (uniforms_->ub_base.fragTestFlags != fragTestFlags) {
+			uniforms_->ub_base.fragTestFlags = fragTestFlags;
+			gstate_c.Dirty(DIRTY_ALPHACOLORREF);
+		}
 	} else {
 		FSID = lastFSID_;
 		fs = lastFShader_;
@@ -351,6 +384,7 @@ void ShaderManagerVulkan::GetShaders(int prim, VertexDecoder *decoder, VulkanVer
 		} else if (GSID.Bit(GS_BIT_ENABLED)) {
 			if (!gsCache_.Get(GSID, &gs)) {
 				// Geometry shader not in cache. Let's compile it.
+				FramePhaseTimer phaseTimer(FramePhase::SHADER, coreCollectDebugStats, FRAME_CAUSE_SHADER_COMPILE);
 				std::string genErrorString;
 				bool success = GenerateGeometryShader(GSID, codeBuffer_, compat_, draw_->GetBugs(), &genErrorString);
 				_assert_msg_(success, "GS gen error: %s", genErrorString.c_str());
@@ -379,6 +413,27 @@ void ShaderManagerVulkan::GetShaders(int prim, VertexDecoder *decoder, VulkanVer
 	_dbg_assert_msg_((*vshader)->UseHWTransform() == useHWTransform, "Bad vshader was computed");
 }
 
+VulkanFragmentShader *ShaderManagerVulkan::GetGenericTestsFragmentShader(const FShaderID &id) {
+	FShaderID genericID;
+	if (!GetGenericTestsFragmentShaderID(id, &genericID))
+		return nullptr;
+
+	VulkanFragmentShader *fs = nullptr;
+	if (!fsCache_.Get(genericID, &fs)) {
+		VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+		std::string genErrorString;
+		uint64_t uniformMask = 0;  // Not used
+		FragmentShaderFlags flags{};
+		bool success = GenerateFragmentShader(genericID, codeBuffer_, compat_, draw_->GetBugs(), &uniformMask, &flags, &genErrorString);
+		_assert_msg_(success, "FS gen error: %s", genErrorString.c_str());
+		_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "FS length error: %d", (int)strlen(codeBuffer_));
+
+		fs = new VulkanFragmentShader(vulkan, genericID, flags, codeBuffer_);
+		fsCache_.Insert(genericID, fs);
+	}
+	return fs;
+}
+
 std::vector<std::string> ShaderManagerVulkan::DebugGetShaderIDs(DebugShaderType type) {
 	std::vector<std::string> ids;
 	switch (type) {
@@ -491,7 +546,7 @@ enum class VulkanCacheDetectFlags {
 };
 
 #define CACHE_HEADER_MAGIC 0xff51f420 
-#define CACHE_VERSION 52
+#define CACHE_VERSION 53
 
 struct VulkanCacheHeader {
 	uint32_t magic;
@@ -617,6 +672,53 @@ bool ShaderManagerVulkan::LoadCache(FILE *f) {
 	return true;
 }
 
+void ShaderManagerVulkan::GetShaderIDList(ShaderIDList *list) {
+	vsCache_.Iterate([&](const VShaderID &id, VulkanVertexShader *shader) {
+		list->vertex.push_back(id);
+	});
+	fsCache_.Iterate([&](const FShaderID &id, VulkanFragmentShader *shader) {
+		list->fragment.push_back(id);
+	});
+}
+
+// Only the shaders, pipelines are created as they're needed.
+void ShaderManagerVulkan::PrecompileShaderIDList(const ShaderIDList &list) {
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+	int vsCount = 0;
+	int fsCount = 0;
+	int failCount = 0;
+	for (const VShaderID &id : list.vertex) {
+		if (vsCache_.ContainsKey(id))
+			continue;
+		std::string genErrorString;
+		uint32_t attributeMask = 0;
+		uint64_t uniformMask = 0;
+		VertexShaderFlags flags;
+		if (!GenerateVertexShader(id, codeBuffer_, compat_, draw_->GetBugs(), &attributeMask, &uniformMask, &flags, &genErrorString)) {
+			failCount++;
+			continue;
+		}
+		_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "VS length error: %d", (int)strlen(codeBuffer_));
+		vsCache_.Insert(id, new VulkanVertexShader(vulkan, id, flags, codeBuffer_, id.Bit(VS_BIT_USE_HW_TRANSFORM)));
+		vsCount++;
+	}
+	for (const FShaderID &id : list.fragment) {
+		if (fsCache_.ContainsKey(id))
+			continue;
+		std::string genErrorString;
+		uint64_t uniformMask = 0;
+		FragmentShaderFlags flags;
+		if (!GenerateFragmentShader(id, codeBuffer_, compat_, draw_->GetBugs(), &uniformMask, &flags, &genErrorString)) {
+			failCount++;
+			continue;
+		}
+		_assert_msg_(strlen(codeBuffer_) < CODE_BUFFER_SIZE, "FS length error: %d", (int)strlen(codeBuffer_));
+		fsCache_.Insert(id, new VulkanFragmentShader(vulkan, id, flags, codeBuffer_));
+		fsCount++;
+	}
+	NOTICE_LOG(Log::G3D, "Queued %d vertex and %d fragment shaders from the shader ID list (%d failed to generate)", vsCount, fsCount, failCount);
+}
+
 void ShaderManagerVulkan::SaveCache(FILE *f, DrawEngineVulkan *drawEngine) {
 	VulkanCacheHeader header{};
 	header.magic = CACHE_HEADER_MAGIC;
@@ -131,6 +131,10 @@ class ShaderManagerVulkan : public ShaderManagerCommon {
 	VulkanFragmentShader *GetFragmentShaderFromID(FShaderID id) { return fsCache_.GetOrNull(id); }
 	VulkanGeometryShader *GetGeometryShaderFromID(GShaderID id) { return gsCache_.GetOrNull(id); }
 
+	// Returns a variant of the fragment shader with uniform-driven alpha/color tests, or nullptr if it has none.
+	// Used as a stand-in while the specialized shader compiles.
+	VulkanFragmentShader *GetGenericTestsFragmentShader(const FShaderID &id);
+
 	VulkanVertexShader *GetVertexShaderFromModule(VkShaderModule module);
 	VulkanFragmentShader *GetFragmentShaderFromModule(VkShaderModule module);
 	VulkanGeometryShader *GetGeometryShaderFromModule(VkShaderModule module);
@@ -140,30 +144,51 @@ class ShaderManagerVulkan : public ShaderManagerCommon {
 
 	uint64_t UpdateUniforms(bool useBufferedRendering);
 
-	// TODO: Avoid copying these buffers if same as last draw, can still point to it assuming we're still in the same pushbuffer.
 	// Applies dirty changes and copies the buffer.
 	bool IsBaseDirty() { return true; }
 	bool IsLightDirty() { return true; }
 	bool IsBoneDirty() { return true; }
 
-	uint32_t PushBaseBuffer(VulkanPushPool *dest, VkBuffer *buf) const {
-		return dest->Push(&uniforms_->ub_base, sizeof(uniforms_->ub_base), uboAlignment_, buf);
+	// If the same contents were already pushed recently, these return the earlier offset and buffer instead
+	// of pushing again. Call ResetPushedUBOs() whenever the push pool may have moved on to a new frame.
+	uint32_t PushBaseBuffer(VulkanPushPool *dest, VkBuffer *buf) {
+		return PushUBO(UBO_SLOT_BASE, &uniforms_->ub_base, sizeof(uniforms_->ub_base), dest, buf);
 	}
-	uint32_t PushLightBuffer(VulkanPushPool *dest, VkBuffer *buf) const {
-		return dest->Push(&uniforms_->ub_lights, sizeof(uniforms_->ub_lights), uboAlignment_, buf);
+	uint32_t PushLightBuffer(VulkanPushPool *dest, VkBuffer *buf) {
+		return PushUBO(UBO_SLOT_LIGHTS, &uniforms_->ub_lights, sizeof(uniforms_->ub_lights), dest, buf);
 	}
 	// TODO: Only push half the bone buffer if we only have four bones.
-	uint32_t PushBoneBuffer(VulkanPushPool *dest, VkBuffer *buf) const {
-		return dest->Push(&uniforms_->ub_bones, sizeof(uniforms_->ub_bones), uboAlignment_, buf);
+	uint32_t PushBoneBuffer(VulkanPushPool *dest, VkBuffer *buf) {
+		return PushUBO(UBO_SLOT_BONES, &uniforms_->ub_bones, sizeof(uniforms_->ub_bones), dest, buf);
 	}
+	void ResetPushedUBOs();
 
 	static bool LoadCacheFlags(FILE *f, DrawEngineVulkan *drawEngine);
 	bool LoadCache(FILE *f);
 	void SaveCache(FILE *f, DrawEngineVulkan *drawEngine);
 
+	void GetShaderIDList(ShaderIDList *list);
+	void PrecompileShaderIDList(const ShaderIDList &list);
+
 private:
 	void Clear();
 
+	enum {
+		UBO_SLOT_BASE,
+		UBO_SLOT_LIGHTS,
+		UBO_SLOT_BONES,
+		UBO_SLOT_COUNT,
+
+		// Direct mapped by hash. Games tend to flip between a handful of matrices and light setups.
+		PUSHED_UBO_CACHE_SIZE = 16,
+	};
+	struct PushedUBO {
+		uint64_t hash;
+		VkBuffer buf;
+		uint32_t offset;
+	};
+	uint32_t PushUBO(int slot, const void *data, size_t size, VulkanPushPool *dest, VkBuffer *buf);
+
 	ShaderLanguageDesc compat_;
 
 	typedef DenseHashMap<FShaderID, VulkanFragmentShader *> FSCache;
@@ -180,6 +205,7 @@ class ShaderManagerVulkan : public ShaderManagerCommon {
 	uint64_t uboAlignment_;
 
 	Uniforms *uniforms_;
+	PushedUBO pushedUBOs_[UBO_SLOT_COUNT][PUSHED_UBO_CACHE_SIZE]{};
 
 	VulkanFragmentShader *lastFShader_ = nullptr;
 	VulkanVertexShader *lastVShader_ = nullptr;
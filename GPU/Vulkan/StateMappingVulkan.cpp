@@ -20,6 +20,7 @@
 #include "Common/GPU/Vulkan/VulkanLoader.h"
 #include "Common/GPU/Vulkan/VulkanRenderManager.h"
 
+#include "GPU/GPU.h"
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
 #include "GPU/Common/GPUStateUtils.h"
@@ -27,6 +28,7 @@
 #include "GPU/Vulkan/FramebufferManagerVulkan.h"
 #include "GPU/Vulkan/ShaderManagerVulkan.h"
 #include "GPU/Vulkan/DrawEngineVulkan.h"
+#include "GPU/Vulkan/PipelineManagerVulkan.h"
 
 // These tables all fit into u8s.
 static const VkBlendFactor vkBlendFactorLookup[(size_t)BlendFactor::COUNT] = {
@@ -378,6 +380,44 @@ void DrawEngineVulkan::BindShaderBlendTex() {
 	}
 }
 
+// Pipelines created this recently might still be compiling when the frame is submitted.
+static const int FALLBACK_PIPELINE_FRAMES = 5;
+
+VulkanPipeline *DrawEngineVulkan::GetFallbackPipeline(VulkanRenderManager *renderManager, VulkanPipeline *pipeline, const DecVtxFormat *decFmt, VulkanVertexShader *vshader, VulkanFragmentShader *fshader, VulkanGeometryShader *gshader, bool useHWTransform) {
+	if (gpuStats.numFlips - pipeline->createdFrame > FALLBACK_PIPELINE_FRAMES)
+		return nullptr;
+	VulkanFragmentShader *genericFS = shaderManager_->GetGenericTestsFragmentShader(fshader->GetID());
+	if (!genericFS)
+		return nullptr;
+	VulkanPipeline *fallback = pipelineManager_->GetOrCreatePipeline(renderManager, pipelineLayout_, pipelineKey_, decFmt, vshader, genericFS, gshader, useHWTransform, 0, framebufferManager_->GetMSAALevel(), false);
+	if (!fallback || !fallback->pipeline || fallback == pipeline)
+		return nullptr;
+	return fallback;
+}
+
+bool DrawEngineVulkan::BindPipeline(VulkanRenderManager *renderManager, VulkanPipeline *pipeline, VulkanPipeline *fallback) {
+	// The render pass must be set up for whichever of the two ends up bound.
+	PipelineFlags flags = pipeline->pipelineFlags;
+	VKRGraphicsPipeline *fallbackPipeline = nullptr;
+	if (fallback) {
+		flags |= fallback->pipelineFlags;
+		fallbackPipeline = fallback->pipeline;
+	}
+
+	if (!pipeline->UsesDynamicDepthStencil())
+		return renderManager->BindPipeline(pipeline->pipeline, flags, pipelineLayout_, fallbackPipeline);
+
+	// The pipeline doesn't know if depth/stencil will be used, so we tell the render pass here.
+	if (pipelineKey_.depthTestEnable || pipelineKey_.stencilTestEnable)
+		flags |= PipelineFlags::USES_DEPTH_STENCIL;
+	if (!renderManager->BindPipeline(pipeline->pipeline, flags, pipelineLayout_, fallbackPipeline))
+		return false;
+	renderManager->SetDynamicDepthStencil(PipelineManagerVulkan::GetDynamicDepthStencil(pipelineKey_));
+	// The stencil masks are always dynamic in these pipelines, so they must be set even if stencil is off.
+	renderManager->SetStencilParams(dynState_.stencilWriteMask, dynState_.stencilCompareMask, dynState_.stencilRef);
+	return true;
+}
+
 void DrawEngineVulkan::ApplyDrawStateLate(VulkanRenderManager *renderManager, bool applyStencilRef, uint8_t stencilRef, bool useBlendConstant) {
 	if (gstate_c.IsDirty(DIRTY_VIEWPORTSCISSOR_STATE)) {
 		renderManager->SetScissor(dynState_.scissor.x, dynState_.scissor.y, dynState_.scissor.width, dynState_.scissor.height);
@@ -35,6 +35,7 @@
 #include "Common/GPU/Vulkan/VulkanMemory.h"
 
 #include "Core/Config.h"
+#include "Core/HW/Display.h"
 
 #include "GPU/ge_constants.h"
 #include "GPU/GPUState.h"
@@ -58,6 +59,9 @@ const char *uploadShader = R"(
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// The scale factor of the texture shader, for shaders that support several.
+#define TEX_SCALE %d
+
 // 8x8 is the most common compute shader workgroup size, and works great on all major
 // hardware vendors.
 layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
@@ -224,6 +228,12 @@ void TextureCacheVulkan::DeviceLost() {
 
 	computeShaderManager_.DeviceLost();
 
+	if (computePush_) {
+		computePush_->Destroy();
+		delete computePush_;
+		computePush_ = nullptr;
+	}
+
 	nextTexture_ = nullptr;
 	draw_ = nullptr;
 	Unbind();
@@ -251,6 +261,10 @@ void TextureCacheVulkan::DeviceRestore(Draw::DrawContext *draw) {
 	CompileScalingShader();
 
 	computeShaderManager_.DeviceRestore(draw);
+
+	if (vulkan->HasAsyncComputeQueue()) {
+		computePush_ = new VulkanPushPool(vulkan, "computeUpload", 4 * 1024 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	}
 }
 
 void TextureCacheVulkan::NotifyConfigChanged() {
@@ -291,7 +305,7 @@ void TextureCacheVulkan::CompileScalingShader() {
 		return;
 
 	std::string shaderSource = ReadShaderSrc(shaderInfo->computeShaderFile);
-	std::string fullUploadShader = StringFromFormat(uploadShader, shaderSource.c_str());
+	std::string fullUploadShader = StringFromFormat(uploadShader, shaderInfo->scaleFactor, shaderSource.c_str());
 
 	std::string error;
 	uploadCS_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_COMPUTE_BIT, fullUploadShader.c_str(), &error);
@@ -327,9 +341,14 @@ static const VkFilter MagFiltVK[2] = {
 
 void TextureCacheVulkan::StartFrame() {
 	TextureCacheCommon::StartFrame();
-	// TODO: For low memory detection, maybe use some indication from VMA.
-	// Maybe see https://gpuopen-librariesandsdks.github.io/VulkanMemoryAllocator/html/staying_within_budget.html#staying_within_budget_querying_for_budget .
 	computeShaderManager_.BeginFrame();
+	if (computePush_)
+		computePush_->BeginFrame();
+}
+
+bool TextureCacheVulkan::IsUnderMemoryPressure() const {
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+	return vulkan && vulkan->IsUnderMemoryPressure();
 }
 
 void TextureCacheVulkan::UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) {
@@ -396,6 +415,12 @@ void TextureCacheVulkan::BindAsClutTexture(Draw::Texture *tex, bool smooth) {
 	drawEngine_->SetDepalTexture(clutTexture, smooth);
 }
 
+void TextureCacheVulkan::BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) {
+	imageView_ = (VkImageView)draw_->GetNativeObject(Draw::NativeObject::TEXTURE_VIEW, tex);
+	curSampler_ = samplerCache_.GetOrCreateSampler(key);
+	drawEngine_->SetDepalTexture(VK_NULL_HANDLE, false);
+}
+
 static Draw::DataFormat FromVulkanFormat(VkFormat fmt) {
 	switch (fmt) {
 	case VULKAN_8888_FORMAT: default: return Draw::DataFormat::R8G8B8A8_UNORM;
@@ -451,6 +476,8 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 	// and similar, which don't really need it.
 	// Also, if using replacements, check that we really can generate mips for this format - that's not possible for compressed ones.
 	if (g_Config.iTexFiltering == TEX_FILTER_AUTO_MAX_QUALITY && plan.w <= 256 && plan.h <= 256 && (!plan.doReplace || plan.replaced->Format() == Draw::DataFormat::R8G8B8A8_UNORM)) {
+		// Mip generation needs the decoded texture, same as above.
+		plan.nativeDXTFormat = Draw::DataFormat::UNDEFINED;
 		// Boost the number of mipmaps.
 		if (plan.maxPossibleLevels > plan.levelsToCreate) { // TODO: Should check against levelsToLoad, no?
 			// We have to generate mips with a shader. This requires decoding to R8G8B8A8_UNORM format to avoid extra complications.
@@ -469,6 +496,9 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		Draw::DataFormat fmt = plan.replaced->Format();
 		bcFormat = Draw::DataFormatIsBlockCompressed(fmt, &bcAlign);
 		actualFmt = ToVulkanFormat(fmt);
+	} else if (plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED) {
+		bcFormat = Draw::DataFormatIsBlockCompressed(plan.nativeDXTFormat, &bcAlign);
+		actualFmt = ToVulkanFormat(plan.nativeDXTFormat);
 	}
 
 	bool computeUpload = false;
@@ -487,10 +517,19 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		}
 	}
 
+	// With an async compute queue, the upscaling runs there, overlapping with rendering, and the
+	// init commands wait for it before generating mips and transitioning for sampling.
+	VkCommandBuffer cmdCompute = cmdInit;
 	if (computeUpload) {
 		usage |= VK_IMAGE_USAGE_STORAGE_BIT;
 		imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		if (computePush_) {
+			VkCommandBuffer cmd = (VkCommandBuffer)draw_->GetNativeObject(Draw::NativeObject::COMPUTE_COMMANDBUFFER);
+			if (cmd != VK_NULL_HANDLE)
+				cmdCompute = cmd;
+		}
 	}
+	bool asyncCompute = cmdCompute != cmdInit;
 
 	if (plan.saveTexture) {
 		INFO_LOG(Log::G3D, "About to save texture (%dx%d)", plan.createW, plan.createH);
@@ -511,8 +550,8 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 	VulkanTexture *image = entry->vkTex;
 
 	VulkanBarrierBatch barrier;
-	bool allocSuccess = image->CreateDirect(plan.createW, plan.createH, plan.depth, plan.levelsToCreate, actualFmt, imageLayout, usage, &barrier, mapping);
-	barrier.Flush(cmdInit);
+	bool allocSuccess = image->CreateDirect(plan.createW, plan.createH, plan.depth, plan.levelsToCreate, actualFmt, imageLayout, usage, &barrier, mapping, asyncCompute);
+	barrier.Flush(cmdCompute);
 	if (!allocSuccess && !lowMemoryMode_) {
 		WARN_LOG_REPORT(Log::G3D, "Texture cache ran out of GPU memory; switching to low memory mode");
 		lowMemoryMode_ = true;
@@ -531,11 +570,15 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 
 		// Turn off texture replacement for this texture.
 		plan.replaced = nullptr;
+		plan.nativeDXTFormat = Draw::DataFormat::UNDEFINED;
 
 		plan.createW /= plan.scaleFactor;
 		plan.createH /= plan.scaleFactor;
 		plan.scaleFactor = 1;
 		actualFmt = dstFmt;
+		// No storage usage on this one, so it's a plain upload.
+		computeUpload = false;
+		asyncCompute = false;
 
 		allocSuccess = image->CreateDirect(plan.createW, plan.createH, plan.depth, plan.levelsToCreate, actualFmt, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &barrier, mapping);
 		barrier.Flush(cmdInit);
@@ -551,6 +594,10 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		return;
 	}
 
+	// If we fell back above, the replacement is gone and so is any block compression.
+	const bool bcCreated = bcFormat && (plan.replaced != nullptr || plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED);
+	SetEntryMemoryUsage(entry, TextureMemoryUsage(plan.createW, plan.createH, plan.depth, plan.levelsToCreate, VkFormatBytesPerPixel(actualFmt), bcCreated ? bcAlign : 0));
+
 	VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
 		"Texture Upload (%08x) video=%d", entry->addr, plan.isVideo);
 
@@ -588,6 +635,7 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		int pushAlignment = std::max(16, (int)vulkan->GetPhysicalDeviceProperties().properties.limits.optimalBufferCopyOffsetAlignment);
 		void *data;
 		std::vector<uint8_t> saveData;
+		VulkanPushPool *levelPush = pushBuffer;
 
 		// Simple wrapper to avoid reading back from VRAM (very, very expensive).
 		auto loadLevel = [&](int sz, int srcLevel, int lstride, int lfactor) {
@@ -595,11 +643,11 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 				saveData.resize(sz);
 				data = &saveData[0];
 			} else {
-				data = pushBuffer->Allocate(sz, pushAlignment, &texBuf, &bufferOffset);
+				data = levelPush->Allocate(sz, pushAlignment, &texBuf, &bufferOffset);
 			}
-			LoadVulkanTextureLevel(*entry, (uint8_t *)data, lstride, srcLevel, lfactor, actualFmt);
+			LoadVulkanTextureLevel(*entry, (uint8_t *)data, lstride, srcLevel, lfactor, actualFmt, plan.nativeDXTFormat != Draw::DataFormat::UNDEFINED);
 			if (plan.saveTexture)
-				bufferOffset = pushBuffer->Push(&saveData[0], sz, pushAlignment, &texBuf);
+				bufferOffset = levelPush->Push(&saveData[0], sz, pushAlignment, &texBuf);
 		};
 
 		bool dataScaled = true;
@@ -624,10 +672,17 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 				// 3D texturing.
 				loadLevel(uploadSize, i, byteStride, plan.scaleFactor);
 				entry->vkTex->CopyBufferToMipLevel(cmdInit, &copyBatch, 0, mipWidth, mipHeight, i, texBuf, bufferOffset, pixelStride);
+			} else if (bcCreated) {
+				// DXT blocks repacked as is, one row of blocks per stride.
+				int blockStride = ((mipWidth + 3) / 4) * bcAlign;
+				loadLevel(blockStride * ((mipHeight + 3) / 4), i, blockStride, 1);
+				entry->vkTex->CopyBufferToMipLevel(cmdInit, &copyBatch, i, mipWidth, mipHeight, 0, texBuf, bufferOffset, (mipWidth + 3) & ~3);
 			} else if (computeUpload) {
 				int srcBpp = VkFormatBytesPerPixel(dstFmt);
 				int srcStride = mipUnscaledWidth * srcBpp;
 				int srcSize = srcStride * mipUnscaledHeight;
+				if (asyncCompute)
+					levelPush = computePush_;
 				loadLevel(srcSize, i == 0 ? plan.baseLevelSrc : i, srcStride, 1);
 				dataScaled = false;
 
@@ -635,13 +690,18 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 				VkImageView view = entry->vkTex->CreateViewForMip(i);
 				VkDescriptorSet descSet = computeShaderManager_.GetDescriptorSet(view, texBuf, bufferOffset, srcSize);
 				struct Params { int x; int y; } params{ mipUnscaledWidth, mipUnscaledHeight };
-				VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-					"Compute Upload: %dx%d->%dx%d", mipUnscaledWidth, mipUnscaledHeight, mipWidth, mipHeight);
-				vkCmdBindPipeline(cmdInit, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipeline(uploadCS_));
-				vkCmdBindDescriptorSets(cmdInit, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipelineLayout(), 0, 1, &descSet, 0, nullptr);
-				vkCmdPushConstants(cmdInit, computeShaderManager_.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
-				vkCmdDispatch(cmdInit, (mipUnscaledWidth + 7) / 8, (mipUnscaledHeight + 7) / 8, 1);
-				VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+				// The profiler's timestamps are on the graphics queue.
+				if (!asyncCompute) {
+					VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						"Compute Upload: %dx%d->%dx%d", mipUnscaledWidth, mipUnscaledHeight, mipWidth, mipHeight);
+				}
+				vkCmdBindPipeline(cmdCompute, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipeline(uploadCS_));
+				vkCmdBindDescriptorSets(cmdCompute, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipelineLayout(), 0, 1, &descSet, 0, nullptr);
+				vkCmdPushConstants(cmdCompute, computeShaderManager_.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+				vkCmdDispatch(cmdCompute, (mipUnscaledWidth + 7) / 8, (mipUnscaledHeight + 7) / 8, 1);
+				if (!asyncCompute) {
+					VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+				}
 				vulkan->Delete().QueueDeleteImageView(view);
 			} else {
 				loadLevel(uploadSize, i == 0 ? plan.baseLevelSrc : i, byteStride, plan.scaleFactor);
@@ -723,7 +783,7 @@ VkFormat TextureCacheVulkan::GetDestFormat(GETextureFormat format, GEPaletteForm
 	}
 }
 
-void TextureCacheVulkan::LoadVulkanTextureLevel(TexCacheEntry &entry, uint8_t *writePtr, int rowPitch, int level, int scaleFactor, VkFormat dstFmt) {
+void TextureCacheVulkan::LoadVulkanTextureLevel(TexCacheEntry &entry, uint8_t *writePtr, int rowPitch, int level, int scaleFactor, VkFormat dstFmt, bool toBC) {
 	int w = gstate.getTextureWidth(level);
 	int h = gstate.getTextureHeight(level);
 
@@ -746,6 +806,9 @@ void TextureCacheVulkan::LoadVulkanTextureLevel(TexCacheEntry &entry, uint8_t *w
 	if (entry.status & TexCacheEntry::STATUS_CLUT_GPU) {
 		texDecFlags |= TexDecodeFlags::TO_CLUT8;
 	}
+	if (toBC) {
+		texDecFlags = TexDecodeFlags::TO_BC;
+	}
 
 	if (scaleFactor > 1) {
 		tmpTexBufRearrange_.resize(std::max(bufw, w) * h);
@@ -757,7 +820,11 @@ void TextureCacheVulkan::LoadVulkanTextureLevel(TexCacheEntry &entry, uint8_t *w
 		decPitch = rowPitch;
 	}
 
+	double decodeStart = time_now_d();
 	CheckAlphaResult alphaResult = DecodeTextureLevel((u8 *)pixelData, decPitch, tfmt, clutformat, texaddr, level, bufw, texDecFlags);
+	const double decodeTime = time_now_d() - decodeStart;
+	gpuStats.msTextureDecoding += decodeTime;
+	DisplayNotifyPhase(FramePhase::TEXTURE, decodeTime);
 	entry.SetAlphaStatus(alphaResult, level);
 
 	if (scaleFactor > 1) {
@@ -767,7 +834,9 @@ void TextureCacheVulkan::LoadVulkanTextureLevel(TexCacheEntry &entry, uint8_t *w
 		uint8_t *scaleBuf = (uint8_t *)AllocateAlignedMemory(allocBytes, 16);
 		_assert_msg_(scaleBuf, "Failed to allocate %d aligned bytes for texture scaler", (int)allocBytes);
 
+		double scaleStart = time_now_d();
 		scaler_.ScaleAlways((u32 *)scaleBuf, pixelData, w, h, &w, &h, scaleFactor);
+		gpuStats.msTextureScaling += time_now_d() - scaleStart;
 		pixelData = (u32 *)writePtr;
 
 		// We always end up at 8888.  Other parts assume this.
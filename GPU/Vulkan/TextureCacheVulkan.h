@@ -57,6 +57,7 @@ class TextureCacheVulkan : public TextureCacheCommon {
 	~TextureCacheVulkan();
 
 	void StartFrame() override;
+	bool IsUnderMemoryPressure() const override;
 
 	void DeviceLost() override;
 	void DeviceRestore(Draw::DrawContext *draw) override;
@@ -90,11 +91,12 @@ class TextureCacheVulkan : public TextureCacheCommon {
 	void Unbind() override;
 	void ReleaseTexture(TexCacheEntry *entry, bool delete_them) override;
 	void BindAsClutTexture(Draw::Texture *tex, bool smooth) override;
+	void BindAtlasTexture(Draw::Texture *tex, const SamplerCacheKey &key) override;
 	void ApplySamplingParams(const SamplerCacheKey &key) override;
 	void BoundFramebufferTexture() override;
 
 private:
-	void LoadVulkanTextureLevel(TexCacheEntry &entry, uint8_t *writePtr, int rowPitch,  int level, int scaleFactor, VkFormat dstFmt);
+	void LoadVulkanTextureLevel(TexCacheEntry &entry, uint8_t *writePtr, int rowPitch,  int level, int scaleFactor, VkFormat dstFmt, bool toBC);
 	static VkFormat GetDestFormat(GETextureFormat format, GEPaletteFormat clutFormat) ;
 	void UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) override;
 
@@ -112,6 +114,8 @@ class TextureCacheVulkan : public TextureCacheCommon {
 
 	std::string textureShader_;
 	VkShaderModule uploadCS_ = VK_NULL_HANDLE;
+	// Source data for compute uploads on the async compute queue, only ever read by that queue.
+	VulkanPushPool *computePush_ = nullptr;
 
 	// Bound state to emulate an API similar to the others
 	VkImageView imageView_ = VK_NULL_HANDLE;
@@ -0,0 +1,238 @@
+#!/usr/bin/env python
+# Builds hot path and coverage histograms from a streamed MIPSTracer trace (.mtrs).
+#
+# Record one with the MIPSTracer in Developer Tools, with "Stream the trace to a compressed file" checked.
+# Then:
+#   python Tools/mips_trace_stats.py trace.txt.mtrs [--top 30] [--aot-list hot.txt] [--aot-coverage 95]
+#
+# Needs zstd to decompress: Python 3.14's compression.zstd, the zstandard package, or the zstd command.
+#
+# The output:
+#  - Hot blocks: by instructions executed, which is what an optimization would save on.
+#  - Hot paths: the most common block-to-block transitions, and greedy chains of them starting from
+#    the hottest blocks.  These are candidates for trace formation.
+#  - Coverage: how much code ran in each 64 KB region, and overall.
+# --aot-list writes the addresses of the hottest blocks, covering the given percent of executed
+# instructions, one hex address per line, for compiling ahead of time.
+
+import argparse
+import array
+import subprocess
+import sys
+from collections import Counter, defaultdict
+
+STREAM_MAGIC = 0x5352544D
+STREAM_VERSION = 1
+STREAM_BLOCK = 0xFFFFFFFF
+
+READ_SIZE = 1 << 22
+REGION_SHIFT = 16
+
+
+def open_decompressed(filename):
+  try:
+    from compression import zstd
+    return zstd.open(filename, 'rb')
+  except ImportError:
+    pass
+  try:
+    import zstandard
+    return zstandard.ZstdDecompressor().stream_reader(open(filename, 'rb'), read_across_frames=True)
+  except ImportError:
+    pass
+  try:
+    proc = subprocess.Popen(['zstd', '-dc', filename], stdout=subprocess.PIPE)
+  except OSError:
+    print('Cannot decompress: install zstandard (pip install zstandard) or the zstd command.')
+    sys.exit(1)
+  return proc.stdout
+
+
+def read_words(f):
+  leftover = b''
+  while True:
+    data = f.read(READ_SIZE)
+    if not data:
+      break
+    data = leftover + data
+    usable = len(data) & ~3
+    leftover = data[usable:]
+    words = array.array('I')
+    words.frombytes(data[:usable])
+    if sys.byteorder != 'little':
+      words.byteswap()
+    yield words
+
+
+class Trace:
+  def __init__(self):
+    # Block index -> (address, opcode count).
+    self.blocks = {}
+    self.executions = Counter()
+    self.edges = Counter()
+    self.total_blocks = 0
+
+
+def parse(filename):
+  trace = Trace()
+  header = []
+  pending = None
+  last = None
+  for words in read_words(open_decompressed(filename)):
+    i = 0
+    n = len(words)
+    if len(header) < 2:
+      while len(header) < 2 and i < n:
+        header.append(words[i])
+        i += 1
+      if len(header) == 2 and (header[0] != STREAM_MAGIC or header[1] != STREAM_VERSION):
+        print('%s is not a MIPSTracer stream (or is a newer version)' % filename)
+        sys.exit(1)
+
+    executions = trace.executions
+    edges = trace.edges
+    while i < n:
+      if pending is not None:
+        # In the middle of a block definition: marker, index, address, count, opcodes.
+        need = 3 - len(pending) if len(pending) < 3 else 3 + pending[2] - len(pending)
+        take = min(need, n - i)
+        pending.extend(words[i:i + take])
+        i += take
+        if len(pending) >= 3 and len(pending) == 3 + pending[2]:
+          trace.blocks[pending[0]] = (pending[1], pending[2])
+          pending = None
+        continue
+
+      w = words[i]
+      i += 1
+      if w == STREAM_BLOCK:
+        pending = []
+        continue
+      executions[w] += 1
+      if last is not None:
+        edges[(last, w)] += 1
+      last = w
+      trace.total_blocks += 1
+  return trace
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Hot path and coverage histograms for MIPSTracer streams.')
+  parser.add_argument('trace', help='a .mtrs file')
+  parser.add_argument('--top', type=int, default=30, help='how many entries to show in each list')
+  parser.add_argument('--aot-list', default=None, help='write the hottest block addresses here')
+  parser.add_argument('--aot-coverage', type=float, default=95.0, help='percent of executed instructions the list should cover')
+  args = parser.parse_args()
+
+  trace = parse(args.trace)
+  if not trace.total_blocks:
+    print('The trace is empty.')
+    return 1
+
+  # The same address can be compiled several times (e.g. after invalidation), so merge by address.
+  by_address = Counter()
+  sizes = {}
+  for index, count in trace.executions.items():
+    if index not in trace.blocks:
+      continue
+    address, size = trace.blocks[index]
+    by_address[address] += count
+    sizes[address] = max(size, sizes.get(address, 0))
+
+  instructions = Counter({a: c * sizes[a] for a, c in by_address.items()})
+  total_instructions = sum(instructions.values())
+  print('%d blocks executed, %d instructions, %d unique blocks' % (trace.total_blocks, total_instructions, len(by_address)))
+
+  print('')
+  print('Hot blocks (by instructions executed):')
+  print('  %-10s %6s %14s %8s %8s' % ('address', 'size', 'executions', 'percent', 'cumul.'))
+  cumulative = 0
+  for address, count in instructions.most_common(args.top):
+    cumulative += count
+    print('  %08x   %6d %14d %7.2f%% %7.2f%%' % (address, sizes[address], by_address[address], 100.0 * count / total_instructions, 100.0 * cumulative / total_instructions))
+
+  # Blocks needed to cover a given share of the executed instructions.
+  print('')
+  ordered = instructions.most_common()
+  for target in (50, 90, 95, 99):
+    cumulative = 0
+    for n, (address, count) in enumerate(ordered):
+      cumulative += count
+      if cumulative * 100.0 >= target * total_instructions:
+        print('  %d%% of instructions are in the %d hottest blocks' % (target, n + 1))
+        break
+
+  def address_of(index):
+    block = trace.blocks.get(index)
+    return block[0] if block else None
+
+  edges = Counter()
+  for (a, b), count in trace.edges.items():
+    edges[(address_of(a), address_of(b))] += count
+  successors = defaultdict(Counter)
+  for (a, b), count in edges.items():
+    successors[a][b] += count
+
+  print('')
+  print('Hot paths (block to block):')
+  for (a, b), count in edges.most_common(args.top):
+    if a is None or b is None:
+      continue
+    share = 100.0 * count / by_address[a] if by_address[a] else 0.0
+    print('  %08x -> %08x %14d  (%5.1f%% of exits)' % (a, b, count, share))
+
+  print('')
+  print('Hot chains (following the most common exit while it is taken at least 90% of the time):')
+  seen = set()
+  shown = 0
+  for address, _ in ordered:
+    if shown >= min(args.top, 10):
+      break
+    if address in seen:
+      continue
+    chain = [address]
+    seen.add(address)
+    current = address
+    while len(chain) < 32 and successors[current]:
+      nxt, count = successors[current].most_common(1)[0]
+      if nxt is None or nxt in chain or count * 10 < by_address[current] * 9:
+        break
+      chain.append(nxt)
+      seen.add(nxt)
+      current = nxt
+    length = sum(sizes.get(a, 0) for a in chain)
+    print('  %s  (%d instructions)' % (' -> '.join('%08x' % a for a in chain), length))
+    shown += 1
+
+  # Coverage, counting each instruction address once.
+  covered = set()
+  for address, size in sizes.items():
+    covered.update(range(address, address + size * 4, 4))
+  regions = Counter(a >> REGION_SHIFT for a in covered)
+  region_instructions = Counter()
+  for address, count in instructions.items():
+    region_instructions[address >> REGION_SHIFT] += count
+
+  print('')
+  print('Coverage by 64 KB region:')
+  print('  %-10s %12s %8s %14s' % ('region', 'unique ops', 'filled', 'executed ops'))
+  ops_per_region = (1 << REGION_SHIFT) // 4
+  for region in sorted(regions):
+    print('  %08x   %12d %7.2f%% %14d' % (region << REGION_SHIFT, regions[region], 100.0 * regions[region] / ops_per_region, region_instructions[region]))
+  print('  %d unique instructions executed (%d KB of code)' % (len(covered), len(covered) * 4 // 1024))
+
+  if args.aot_list:
+    cumulative = 0
+    with open(args.aot_list, 'w') as f:
+      for address, count in ordered:
+        f.write('%08x\n' % address)
+        cumulative += count
+        if cumulative * 100.0 >= args.aot_coverage * total_instructions:
+          break
+    print('')
+    print('Wrote %s' % args.aot_list)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
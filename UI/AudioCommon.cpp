@@ -1,4 +1,6 @@
+#include "Common/Profiler/Tracer.h"
 #include "Common/System/System.h"
+#include "Core/HLE/__sceAudio.h"
 #include "Core/HW/StereoResampler.h"  // TODO: doesn't belong in Core/HW...
 #include "UI/AudioCommon.h"
 #include "UI/BackgroundAudio.h"
@@ -8,6 +10,7 @@ StereoResampler g_resampler;
 // numFrames is number of stereo frames.
 // This is called from *outside* the emulator thread.
 int __AudioMix(int16_t *outStereo, int numFrames, int sampleRateHz) {
+	TRACE_SCOPE("audio_mix");
 	int validFrames = g_resampler.Mix(outStereo, numFrames, false, sampleRateHz);
 
 	// Mix sound effects on top.
@@ -24,6 +27,10 @@ void System_AudioGetDebugStats(char *buf, size_t bufSize) {
 	}
 }
 
+void System_AudioGetDebugStats(AudioDebugStats *stats) {
+	g_resampler.GetAudioDebugStats(stats);
+}
+
 void System_AudioClear() {
 	g_resampler.Clear();
 }
@@ -3,6 +3,7 @@
 #include "Common/System/System.h"
 #include "Common/Data/Text/I18n.h"
 #include "Common/CPUDetect.h"
+#include "Common/StringUtils.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/HW/Display.h"
 #include "Core/FrameTiming.h"
@@ -124,6 +125,135 @@ static void DrawFrameTimes(UIContext *ctx, const Bounds &bounds) {
 	ctx->RebindTexture();
 }
 
+static void DrawFrameTimeline(UIContext *ctx, const Bounds &bounds) {
+	FontID ubuntu24("UBUNTU24");
+	double *sleepHistory;
+	int valid, pos;
+	const double *history = __DisplayGetFrameTimes(&valid, &pos, &sleepHistory);
+	const FrameBreakdown *breakdown = __DisplayGetFrameBreakdown();
+	if (valid == 0)
+		return;
+	// Until the history wraps, pos == valid and the oldest frame is at 0.
+	const int first = valid == pos ? 0 : pos;
+	auto frameIndex = [&](int i) {
+		return (first + i) % valid;
+	};
+
+	struct Layer {
+		const char *name;
+		uint32_t color;
+	};
+	static const Layer layers[] = {
+		{ "CPU", 0xFF3FC03F },
+		{ "GE", 0xFFFF8F3F },
+		{ "Draw", 0xFFFFFF3F },
+		{ "Texture", 0xFF3FFFFF },
+		{ "Shader", 0xFFFF3FFF },
+		{ "Wait", 0x7F7F7F7F },
+		{ "Other", 0xFF505050 },
+	};
+	static const char *causeNames[] = { "shader compile", "JIT clear", "readback", "audio underrun" };
+	const int waitLayer = (int)FramePhase::COUNT;
+
+	// Spikes are relative to the typical frame, since the target rate varies.
+	std::vector<double> sorted(history, history + valid);
+	std::nth_element(sorted.begin(), sorted.begin() + valid / 2, sorted.end());
+	const double median = sorted[valid / 2];
+
+	const float scale = 7000.0f;
+	const float barWidth = std::max(1.0f, std::floor((bounds.w - 120.0f) / valid));
+	const float left = bounds.x + 10.0f;
+	const float bottom = bounds.y2() - 10.0f;
+
+	ctx->Flush();
+	ctx->BeginNoTex();
+	for (int i = 0; i < valid; ++i) {
+		const int index = frameIndex(i);
+		const FrameBreakdown &frame = breakdown[index];
+		float values[ARRAY_SIZE(layers)];
+		float known = 0.0f;
+		for (int j = 0; j < (int)FramePhase::COUNT; ++j) {
+			values[j] = frame.phases[j];
+			known += values[j];
+		}
+		values[waitLayer] = (float)sleepHistory[index];
+		known += values[waitLayer];
+		values[waitLayer + 1] = std::max(0.0f, (float)history[index] - known);
+
+		float y = bottom;
+		const float x = left + i * barWidth;
+		for (int j = 0; j < (int)ARRAY_SIZE(layers); ++j) {
+			const float h = values[j] * scale;
+			if (h > 0.0f)
+				ctx->Draw()->Rect(x, y - h, barWidth, h, layers[j].color);
+			y -= h;
+		}
+		if (frame.causes & FRAME_CAUSE_AUDIO_UNDERRUN)
+			ctx->Draw()->Rect(x, bottom + 2.0f, barWidth, 6.0f, 0xFF3F3FFF);
+	}
+	const float right = left + valid * barWidth;
+	ctx->Draw()->hLine(left, bottom - 0.0333f * scale, right, 0xFF3f3Fff);
+	ctx->Draw()->hLine(left, bottom - 0.0167f * scale, right, 0xFF3f3Fff);
+
+	ctx->Flush();
+	ctx->Begin();
+	ctx->BindFontTexture();
+	ctx->Draw()->SetFontScale(0.5f, 0.5f);
+	ctx->Draw()->DrawText(ubuntu24, "33.3ms", right + 4, bottom - 0.0333f * scale, 0xFF3f3Fff, ALIGN_VCENTER | FLAG_DYNAMIC_ASCII);
+	ctx->Draw()->DrawText(ubuntu24, "16.7ms", right + 4, bottom - 0.0167f * scale, 0xFF3f3Fff, ALIGN_VCENTER | FLAG_DYNAMIC_ASCII);
+
+	float legendX = left;
+	for (const Layer &layer : layers) {
+		ctx->Draw()->DrawText(ubuntu24, layer.name, legendX, bounds.y + 50, layer.color | 0xFF000000, FLAG_DYNAMIC_ASCII);
+		legendX += 90.0f;
+	}
+	ctx->Draw()->DrawText(ubuntu24, "Audio underrun", legendX, bounds.y + 50, 0xFF3F3FFF, FLAG_DYNAMIC_ASCII);
+
+	// Label the spikes, either with what was marked, or the phase that took the longest.
+	float lastLabelX = -1000.0f;
+	for (int i = 0; i < valid; ++i) {
+		const int index = frameIndex(i);
+		const double frameTime = history[index];
+		if (frameTime < median * 1.5 || frameTime < median + 0.004)
+			continue;
+		const float x = left + i * barWidth;
+		if (x - lastLabelX < 80.0f)
+			continue;
+
+		const FrameBreakdown &frame = breakdown[index];
+		std::string label;
+		for (int j = 0; j < (int)ARRAY_SIZE(causeNames); ++j) {
+			if (frame.causes & (1 << j)) {
+				if (!label.empty())
+					label += ", ";
+				label += causeNames[j];
+			}
+		}
+		if (label.empty()) {
+			int worst = 0;
+			float known = frame.phases[0];
+			for (int j = 1; j < (int)FramePhase::COUNT; ++j) {
+				known += frame.phases[j];
+				if (frame.phases[j] > frame.phases[worst])
+					worst = j;
+			}
+			// Waiting doesn't cause spikes, but the host (UI, present, etc.) might have.
+			if ((float)(frameTime - sleepHistory[index]) - known > frame.phases[worst])
+				worst = waitLayer + 1;
+			label = layers[worst].name;
+		}
+		label = StringFromFormat("%0.1fms: %s", frameTime * 1000.0, label.c_str());
+
+		const float top = std::max(bounds.y + 70.0f, bottom - (float)frameTime * (float)scale - 4.0f);
+		ctx->Draw()->DrawText(ubuntu24, label, x, top, 0xFFFFFFFF, ALIGN_BOTTOMLEFT | FLAG_DYNAMIC_ASCII);
+		lastLabelX = x;
+	}
+
+	ctx->Draw()->SetFontScale(1.0f, 1.0f);
+	ctx->Flush();
+	ctx->RebindTexture();
+}
+
 static void DrawFrameTiming(UIContext *ctx, const Bounds &bounds) {
 	FontID ubuntu24("UBUNTU24");
 
@@ -133,10 +263,18 @@ static void DrawFrameTiming(UIContext *ctx, const Bounds &bounds) {
 	ctx->BindFontTexture();
 	ctx->Draw()->SetFontScale(0.5f, 0.5f);
 
-	snprintf(statBuf, sizeof(statBuf),
+	int len = snprintf(statBuf, sizeof(statBuf),
 		"Mode (interval): %s (%d)",
 		Draw::PresentModeToString(g_frameTiming.presentMode),
 		g_frameTiming.presentInterval);
+	if (g_frameTiming.hasPresentFeedback) {
+		snprintf(statBuf + len, sizeof(statBuf) - len,
+			"\nPresent latency: %0.1f ms (margin %0.1f ms), refresh %0.2f Hz, pacing offset %0.2f ms",
+			g_frameTiming.presentLatency * 1000.0,
+			g_frameTiming.presentMargin * 1000.0,
+			g_frameTiming.refreshPeriod > 0.0 ? 1.0 / g_frameTiming.refreshPeriod : 0.0,
+			g_frameTiming.pacingOffset * 1000.0);
+	}
 
 	ctx->Draw()->DrawTextRect(ubuntu24, statBuf, bounds.x + 10, bounds.y + 50, bounds.w - 20, bounds.h - 30, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
 
@@ -230,6 +368,10 @@ void DrawDebugOverlay(UIContext *ctx, const Bounds &bounds, DebugOverlay overlay
 	case DebugOverlay::FRAME_TIMING:
 		DrawFrameTiming(ctx, ctx->GetLayoutBounds());
 		break;
+	case DebugOverlay::FRAME_TIMELINE:
+		if (inGame)
+			DrawFrameTimeline(ctx, ctx->GetLayoutBounds());
+		break;
 	case DebugOverlay::Audio:
 		DrawAudioDebugStats(ctx, ctx->GetLayoutBounds());
 		break;
@@ -35,6 +35,7 @@
 #include "Common/GPU/OpenGL/GLFeatures.h"
 
 #include "Common/File/AndroidStorage.h"
+#include "Common/File/FileUtil.h"
 #include "Common/Data/Text/I18n.h"
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Net/HTTPClient.h"
@@ -45,6 +46,7 @@
 #include "Common/UI/IconCache.h"
 #include "Common/Data/Text/Parsers.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 
 #include "Common/Log/LogManager.h"
 #include "Common/CPUDetect.h"
@@ -92,6 +94,7 @@ static const char *g_debugOverlayList[] = {
 	"Debug stats",
 	"Draw Frametimes Graph",
 	"Frame timing",
+	"Frame timeline",
 #ifdef USE_PROFILER
 	"Frame profile",
 #endif
@@ -164,6 +167,38 @@ void DevMenuScreen::CreatePopupContents(UI::ViewGroup *parent) {
 		return UI::EVENT_DONE;
 	});
 
+	if (!Tracer::Active()) {
+		items->Add(new Choice(dev->T("Start tracing")))->OnClick.Add([this](UI::EventParams &e) {
+			Tracer::Start();
+			TriggerFinish(DR_OK);
+			return UI::EVENT_DONE;
+		});
+	} else {
+		items->Add(new Choice(dev->T("Stop tracing and save")))->OnClick.Add([this](UI::EventParams &e) {
+			Tracer::Stop();
+			const Path dumpDir = GetSysDirectory(DIRECTORY_DUMP);
+			File::CreateFullPath(dumpDir);
+			Path tracePath;
+			for (int n = 1; n < 10000; ++n) {
+				tracePath = dumpDir / StringFromFormat("trace_%04d.json", n);
+				if (!File::Exists(tracePath))
+					break;
+			}
+			if (File::WriteStringToFile(true, Tracer::ExportChromeJSON(), tracePath)) {
+				NOTICE_LOG(Log::System, "Trace saved at '%s'", tracePath.c_str());
+				if (System_GetPropertyBool(SYSPROP_CAN_SHOW_FILE)) {
+					System_ShowFileInFolder(tracePath);
+				} else {
+					g_OSD.Show(OSDType::MESSAGE_SUCCESS, tracePath.ToVisualString(), 7.0f);
+				}
+			} else {
+				g_OSD.Show(OSDType::MESSAGE_ERROR, tracePath.ToVisualString(), 7.0f);
+			}
+			TriggerFinish(DR_OK);
+			return UI::EVENT_DONE;
+		});
+	}
+
 	// This one is not very useful these days, and only really on desktop. Hide it on other platforms.
 	if (System_GetPropertyInt(SYSPROP_DEVICE_TYPE) == DEVICE_TYPE_DESKTOP) {
 		items->Add(new Choice(dev->T("Dump next frame to log")))->OnClick.Add([](UI::EventParams &e) {
@@ -429,6 +464,7 @@ static const JitDisableFlag jitDisableFlags[] = {
 	{ MIPSComp::JitDisable::CACHE_POINTERS, "Cached pointers" },
 	{ MIPSComp::JitDisable::REGALLOC_GPR, "GPR Regalloc across instructions" },
 	{ MIPSComp::JitDisable::REGALLOC_FPR, "FPR Regalloc across instructions" },
+	{ MIPSComp::JitDisable::IDLE_LOOPS, "Idle loop skipping" },
 };
 
 void JitDebugScreen::CreateViews() {
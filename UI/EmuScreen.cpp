@@ -1521,7 +1521,7 @@ ScreenRenderFlags EmuScreen::render(ScreenRenderMode mode) {
 		}
 	}
 
-	PSP_UpdateDebugStats((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::DEBUG_STATS || g_Config.bLogFrameDrops);
+	PSP_UpdateDebugStats((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::DEBUG_STATS || (DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::FRAME_TIMELINE || g_Config.bLogFrameDrops);
 
 	if (doFrameAdvance_.exchange(false)) {
 		if (!Achievements::WarnUserIfHardcoreModeActive(false)) {
@@ -1551,7 +1551,7 @@ ScreenRenderFlags EmuScreen::render(ScreenRenderMode mode) {
 				draw->BindFramebufferAsRenderTarget(nullptr, { RPAction::CLEAR, RPAction::CLEAR, RPAction::CLEAR, clearColor }, "EmuScreen_SavestateRebind");
 			}
 		}
-		PSP_RunLoopWhileState();
+		PSP_RunLoopWithRunAhead();
 
 		// Hopefully, after running, coreState is now CORE_NEXTFRAME
 		switch (coreState) {
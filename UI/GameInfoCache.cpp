@@ -21,14 +21,17 @@
 #include <map>
 #include <memory>
 #include <algorithm>
+#include <ctime>
 
 #include "Common/GPU/thin3d.h"
 #include "Common/Thread/ThreadManager.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/Path.h"
+#include "Common/File/DirListing.h"
 #include "Common/Render/ManagedTexture.h"
 #include "Common/StringUtils.h"
+#include "Common/Swap.h"
 #include "Common/TimeUtil.h"
 #include "Core/FileSystems/ISOFileSystem.h"
 #include "Core/FileSystems/DirectoryFileSystem.h"
@@ -44,18 +47,39 @@
 
 GameInfoCache *g_gameInfoCache;
 
-void GameInfoTex::Clear() {
-	if (!data.empty()) {
-		data.clear();
-		dataLoaded = false;
+// Icon textures beyond this are released, least recently drawn first, and decoded again when needed.
+// Big libraries would otherwise keep every icon they've ever scrolled past in VRAM.
+static const size_t MAX_RESIDENT_ICONS = 256;
+// Anything drawn this recently is likely still on screen.
+static const double ICON_EVICT_MIN_AGE = 2.0;
+
+void GameInfoTex::DecodeImage() {
+	if (!dataLoaded || imageLoaded)
+		return;
+	if (!data.empty() && !image.LoadTextureLevelsFromFileData((const uint8_t *)data.data(), data.size())) {
+		image.Free();
 	}
+	imageLoaded = true;
+}
+
+void GameInfoTex::ReleaseTexture() {
 	if (texture) {
 		texture->Release();
 		texture = nullptr;
 	}
+	image.Free();
+	imageLoaded = false;
 	timeLoaded = 0.0;
 }
 
+void GameInfoTex::Clear() {
+	if (!data.empty()) {
+		data.clear();
+		dataLoaded = false;
+	}
+	ReleaseTexture();
+}
+
 GameInfo::GameInfo(const Path &gamePath) : filePath_(gamePath) {
 	// here due to a forward decl.
 	fileType = IdentifiedFileType::UNKNOWN;
@@ -361,32 +385,29 @@ void GameInfo::SetTitle(const std::string &newTitle) {
 }
 
 void GameInfo::FinishPendingTextureLoads(Draw::DrawContext *draw) {
-	if (draw && icon.dataLoaded && !icon.texture) {
-		SetupTexture(draw, icon);
+	// Icons are often drawn smaller than they are, so they get mips.
+	if (draw && icon.imageLoaded && !icon.texture) {
+		SetupTexture(draw, icon, true);
 	}
-	if (draw && pic0.dataLoaded && !pic0.texture) {
-		SetupTexture(draw, pic0);
+	if (draw && pic0.imageLoaded && !pic0.texture) {
+		SetupTexture(draw, pic0, false);
 	}
-	if (draw && pic1.dataLoaded && !pic1.texture) {
-		SetupTexture(draw, pic1);
+	if (draw && pic1.imageLoaded && !pic1.texture) {
+		SetupTexture(draw, pic1, false);
 	}
 }
 
-void GameInfo::SetupTexture(Draw::DrawContext *thin3d, GameInfoTex &tex) {
+void GameInfo::SetupTexture(Draw::DrawContext *thin3d, GameInfoTex &tex, bool generateMips) {
 	if (tex.timeLoaded) {
 		// Failed before, skip.
 		return;
 	}
-	if (tex.data.empty()) {
-		tex.timeLoaded = time_now_d();
-		return;
+	if (tex.image.levels[0]) {
+		tex.texture = CreateTextureFromTempImage(thin3d, tex.image, generateMips, GetTitle().c_str());
+		tex.image.Free();
 	}
-	using namespace Draw;
-	// TODO: Use TempImage to semi-load the image in the worker task, then here we
-	// could just call CreateTextureFromTempImage.
-	tex.texture = CreateTextureFromFileData(thin3d, (const uint8_t *)tex.data.data(), tex.data.size(), ImageFileType::DETECT, false, GetTitle().c_str());
 	tex.timeLoaded = time_now_d();
-	if (!tex.texture) {
+	if (!tex.texture && !tex.data.empty()) {
 		ERROR_LOG(Log::G3D, "Failed creating texture (%s) from %d-byte file", GetTitle().c_str(), (int)tex.data.size());
 	}
 }
@@ -453,10 +474,350 @@ static bool ReadVFSToString(const char *filename, std::string *contents, std::mu
 	return true;
 }
 
+// Keeps the PARAM.SFO and icon of games on disk between runs, so the game list can be drawn
+// right away instead of opening every file again.  Entries are keyed by path, and only trusted
+// while the size and mtime of the file still match.
+class GameInfoDB {
+public:
+	explicit GameInfoDB(const Path &filename) : filename_(filename) {}
+
+	void Load();
+	void Save();
+
+	// Fills in a new info from its entry, if any.  Returns the flags that are now ready.
+	GameInfoFlags Apply(GameInfo *info);
+	// Remembers the info if it's a game with its PARAM.SFO and icon loaded.
+	void Store(GameInfo *info);
+	// Returns false, and forgets the entry, if the file changed or is gone.
+	bool Revalidate(GameInfo *info);
+
+private:
+	struct Entry {
+		u64 size = 0;
+		u64 mtime = 0;
+		u32 lastUsed = 0;
+		IdentifiedFileType fileType = IdentifiedFileType::UNKNOWN;
+		int discTotal = 0;
+		int discNumber = 0;
+		int region = 0;
+		std::string id;
+		std::string idVersion;
+		std::string title;
+		std::string sfo;
+		std::string icon;
+	};
+
+	static bool IsCacheable(const Path &path, IdentifiedFileType fileType);
+	static bool StatFile(const Path &path, IdentifiedFileType fileType, u64 *size, u64 *mtime);
+
+	enum {
+		DB_VERSION = 1,
+		MAX_ENTRIES = 4096,
+		// Entries not shown for this long are dropped on save.
+		EXPIRE_SECONDS = 180 * 24 * 60 * 60,
+	};
+
+	std::mutex lock_;
+	std::map<std::string, Entry> entries_;
+	Path filename_;
+	bool dirty_ = false;
+};
+
+static const char * const GAMEINFODB_MAGIC = "ppssppGI";
+
+static void AppendU32(std::string *out, u32 value) {
+	u32_le v = value;
+	out->append((const char *)&v, sizeof(v));
+}
+
+static void AppendU64(std::string *out, u64 value) {
+	u64_le v = value;
+	out->append((const char *)&v, sizeof(v));
+}
+
+static void AppendString(std::string *out, const std::string &str) {
+	AppendU32(out, (u32)str.size());
+	out->append(str);
+}
+
+namespace {
+
+struct DBReader {
+	const char *pos;
+	const char *end;
+	bool ok = true;
+
+	u32 U32() {
+		u32_le v = 0;
+		Take(&v, sizeof(v));
+		return v;
+	}
+	u64 U64() {
+		u64_le v = 0;
+		Take(&v, sizeof(v));
+		return v;
+	}
+	std::string String() {
+		u32 size = U32();
+		if (!ok || (size_t)(end - pos) < size) {
+			ok = false;
+			return std::string();
+		}
+		std::string str(pos, size);
+		pos += size;
+		return str;
+	}
+	void Take(void *dest, size_t size) {
+		if (!ok || (size_t)(end - pos) < size) {
+			ok = false;
+			return;
+		}
+		memcpy(dest, pos, size);
+		pos += size;
+	}
+};
+
+}  // namespace
+
+bool GameInfoDB::IsCacheable(const Path &path, IdentifiedFileType fileType) {
+	// Remote files can't be checked cheaply, and other types are cheap to load or change often.
+	if (path.Type() != PathType::NATIVE && path.Type() != PathType::CONTENT_URI)
+		return false;
+	switch (fileType) {
+	case IdentifiedFileType::PSP_ISO:
+	case IdentifiedFileType::PSP_ISO_NP:
+	case IdentifiedFileType::PSP_PBP:
+	case IdentifiedFileType::PSP_PBP_DIRECTORY:
+	case IdentifiedFileType::PSP_DISC_DIRECTORY:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool GameInfoDB::StatFile(const Path &path, IdentifiedFileType fileType, u64 *size, u64 *mtime) {
+	File::FileInfo info;
+	// For a directory with an EBOOT.PBP, it's the EBOOT that matters.
+	Path statPath = fileType == IdentifiedFileType::PSP_PBP_DIRECTORY ? ResolvePBPFile(path) : path;
+	if (!File::GetFileInfo(statPath, &info) || !info.exists)
+		return false;
+	*size = info.size;
+	*mtime = info.mtime;
+	return true;
+}
+
+void GameInfoDB::Load() {
+	std::string data;
+	if (!File::ReadBinaryFileToString(filename_, &data))
+		return;
+
+	DBReader reader{ data.data(), data.data() + data.size() };
+	char magic[8]{};
+	reader.Take(magic, sizeof(magic));
+	u32 version = reader.U32();
+	u32 count = reader.U32();
+	if (!reader.ok || memcmp(magic, GAMEINFODB_MAGIC, sizeof(magic)) != 0 || version != DB_VERSION || count > MAX_ENTRIES) {
+		WARN_LOG(Log::Loader, "Ignoring invalid game info cache %s", filename_.c_str());
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock_);
+	for (u32 i = 0; i < count && reader.ok; ++i) {
+		std::string path = reader.String();
+		Entry entry;
+		entry.size = reader.U64();
+		entry.mtime = reader.U64();
+		entry.lastUsed = reader.U32();
+		entry.fileType = (IdentifiedFileType)reader.U32();
+		entry.discTotal = (s32)reader.U32();
+		entry.discNumber = (s32)reader.U32();
+		entry.region = (s32)reader.U32();
+		entry.id = reader.String();
+		entry.idVersion = reader.String();
+		entry.title = reader.String();
+		entry.sfo = reader.String();
+		entry.icon = reader.String();
+		if (reader.ok)
+			entries_[path] = std::move(entry);
+	}
+	if (!reader.ok) {
+		WARN_LOG(Log::Loader, "Game info cache %s was truncated", filename_.c_str());
+		entries_.clear();
+	}
+	INFO_LOG(Log::Loader, "Loaded %d entries from the game info cache", (int)entries_.size());
+}
+
+void GameInfoDB::Save() {
+	std::lock_guard<std::mutex> guard(lock_);
+	if (!dirty_)
+		return;
+
+	const u32 now = (u32)time(nullptr);
+	for (auto it = entries_.begin(); it != entries_.end(); ) {
+		if (now - it->second.lastUsed > (u32)EXPIRE_SECONDS)
+			it = entries_.erase(it);
+		else
+			++it;
+	}
+	while (entries_.size() > MAX_ENTRIES) {
+		auto oldest = std::min_element(entries_.begin(), entries_.end(), [](const auto &a, const auto &b) {
+			return a.second.lastUsed < b.second.lastUsed;
+		});
+		entries_.erase(oldest);
+	}
+
+	std::string data;
+	data.append(GAMEINFODB_MAGIC, 8);
+	AppendU32(&data, DB_VERSION);
+	AppendU32(&data, (u32)entries_.size());
+	for (const auto &it : entries_) {
+		const Entry &entry = it.second;
+		AppendString(&data, it.first);
+		AppendU64(&data, entry.size);
+		AppendU64(&data, entry.mtime);
+		AppendU32(&data, entry.lastUsed);
+		AppendU32(&data, (u32)entry.fileType);
+		AppendU32(&data, (u32)entry.discTotal);
+		AppendU32(&data, (u32)entry.discNumber);
+		AppendU32(&data, (u32)entry.region);
+		AppendString(&data, entry.id);
+		AppendString(&data, entry.idVersion);
+		AppendString(&data, entry.title);
+		AppendString(&data, entry.sfo);
+		AppendString(&data, entry.icon);
+	}
+
+	File::CreateFullPath(filename_.NavigateUp());
+	if (!File::WriteDataToFile(false, data.data(), data.size(), filename_)) {
+		ERROR_LOG(Log::Loader, "Failed to write game info cache %s", filename_.c_str());
+		return;
+	}
+	dirty_ = false;
+}
+
+GameInfoFlags GameInfoDB::Apply(GameInfo *info) {
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = entries_.find(info->GetFilePath().ToString());
+	if (it == entries_.end())
+		return (GameInfoFlags)0;
+
+	Entry &entry = it->second;
+	entry.lastUsed = (u32)time(nullptr);
+	dirty_ = true;
+
+	std::lock_guard<std::mutex> infoGuard(info->lock);
+	info->fileType = entry.fileType;
+	info->paramSFO.ReadSFO((const u8 *)entry.sfo.data(), entry.sfo.size());
+	info->title = entry.title;
+	info->id = entry.id;
+	info->id_version = entry.idVersion;
+	info->disc_total = entry.discTotal;
+	info->disc_number = entry.discNumber;
+	info->region = entry.region;
+
+	GameInfoFlags flags = GameInfoFlags::FILE_TYPE | GameInfoFlags::PARAM_SFO;
+	if (!entry.icon.empty()) {
+		info->icon.data = entry.icon;
+		info->icon.dataLoaded = true;
+		flags |= GameInfoFlags::ICON;
+	}
+	info->MarkReadyNoLock(flags);
+	return flags;
+}
+
+void GameInfoDB::Store(GameInfo *info) {
+	const GameInfoFlags wanted = GameInfoFlags::FILE_TYPE | GameInfoFlags::PARAM_SFO | GameInfoFlags::ICON;
+	if (!info->Ready(wanted) || !IsCacheable(info->GetFilePath(), info->fileType))
+		return;
+
+	Entry entry;
+	if (!StatFile(info->GetFilePath(), info->fileType, &entry.size, &entry.mtime))
+		return;
+
+	{
+		std::lock_guard<std::mutex> infoGuard(info->lock);
+		if (!info->icon.dataLoaded)
+			return;
+		entry.fileType = info->fileType;
+		entry.discTotal = info->disc_total;
+		entry.discNumber = info->disc_number;
+		entry.region = info->region;
+		entry.id = info->id;
+		entry.idVersion = info->id_version;
+		entry.title = info->title;
+		entry.icon = info->icon.data;
+
+		u8 *sfo = nullptr;
+		size_t sfoSize = 0;
+		info->paramSFO.WriteSFO(&sfo, &sfoSize);
+		entry.sfo.assign((const char *)sfo, sfoSize);
+		delete[] sfo;
+	}
+	entry.lastUsed = (u32)time(nullptr);
+
+	std::lock_guard<std::mutex> guard(lock_);
+	entries_[info->GetFilePath().ToString()] = std::move(entry);
+	dirty_ = true;
+}
+
+bool GameInfoDB::Revalidate(GameInfo *info) {
+	const std::string key = info->GetFilePath().ToString();
+	u64 size = 0, mtime = 0;
+	bool exists = StatFile(info->GetFilePath(), info->fileType, &size, &mtime);
+
+	std::lock_guard<std::mutex> guard(lock_);
+	auto it = entries_.find(key);
+	if (it == entries_.end())
+		return false;
+	if (exists && it->second.size == size && it->second.mtime == mtime)
+		return true;
+
+	INFO_LOG(Log::Loader, "Game info cache entry for %s is out of date", info->GetFilePath().ToVisualString().c_str());
+	entries_.erase(it);
+	dirty_ = true;
+	return false;
+}
+
+// Checks a game filled in from the GameInfoDB against the file, at low priority.
+class GameInfoRevalidateItem : public Task {
+public:
+	GameInfoRevalidateItem(std::shared_ptr<GameInfoDB> db, std::shared_ptr<GameInfo> info)
+		: db_(db), info_(info) {}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+
+	TaskPriority Priority() const override {
+		return TaskPriority::LOW;
+	}
+
+	void Run() override {
+		if (!db_->Revalidate(info_.get())) {
+			info_->cacheStale = true;
+			return;
+		}
+
+		std::string id;
+		{
+			std::lock_guard<std::mutex> lock(info_->lock);
+			id = info_->id;
+		}
+		// This isn't cached, since the config can come and go independently of the game.
+		info_->hasConfig = g_Config.hasGameConfig(id);
+	}
+
+private:
+	std::shared_ptr<GameInfoDB> db_;
+	std::shared_ptr<GameInfo> info_;
+
+	DISALLOW_COPY_AND_ASSIGN(GameInfoRevalidateItem);
+};
+
 class GameInfoWorkItem : public Task {
 public:
-	GameInfoWorkItem(const Path &gamePath, std::shared_ptr<GameInfo> &info, GameInfoFlags flags)
-		: gamePath_(gamePath), info_(info), flags_(flags) {}
+	GameInfoWorkItem(const Path &gamePath, std::shared_ptr<GameInfo> &info, GameInfoFlags flags, std::shared_ptr<GameInfoDB> db)
+		: gamePath_(gamePath), info_(info), flags_(flags), db_(db) {}
 
 	~GameInfoWorkItem() {
 		info_->DisposeFileLoader();
@@ -828,20 +1189,62 @@ class GameInfoWorkItem : public Task {
 			info_->gameSizeUncompressed = info_->GetSizeUncompressedInBytes();
 		}
 
+		// Decode the images while we're here, so only the upload is left for the main thread.
+		if (flags_ & GameInfoFlags::ICON) {
+			info_->icon.DecodeImage();
+		}
+		if (flags_ & GameInfoFlags::BG) {
+			info_->pic0.DecodeImage();
+			info_->pic1.DecodeImage();
+		}
+
 		// Time to update the flags.
-		std::unique_lock<std::mutex> lock(info_->lock);
-		info_->MarkReadyNoLock(flags_);
-		// INFO_LOG(Log::System, "Completed writing info for %s", info_->GetTitle().c_str());
+		{
+			std::unique_lock<std::mutex> lock(info_->lock);
+			info_->MarkReadyNoLock(flags_);
+			// INFO_LOG(Log::System, "Completed writing info for %s", info_->GetTitle().c_str());
+		}
+
+		if (db_ && (flags_ & (GameInfoFlags::PARAM_SFO | GameInfoFlags::ICON))) {
+			db_->Store(info_.get());
+		}
 	}
 
 private:
 	Path gamePath_;
 	std::shared_ptr<GameInfo> info_;
 	GameInfoFlags flags_{};
+	std::shared_ptr<GameInfoDB> db_;
 
 	DISALLOW_COPY_AND_ASSIGN(GameInfoWorkItem);
 };
 
+// Decodes an icon whose data we already have, either from the persistent cache or because its
+// texture was released to save memory. ICON is kept pending meanwhile, so nothing clears it under us.
+class GameInfoDecodeItem : public Task {
+public:
+	GameInfoDecodeItem(std::shared_ptr<GameInfo> info) : info_(info) {}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	TaskPriority Priority() const override {
+		return TaskPriority::NORMAL;
+	}
+
+	void Run() override {
+		info_->icon.DecodeImage();
+		std::lock_guard<std::mutex> lock(info_->lock);
+		info_->pendingFlags &= ~GameInfoFlags::ICON;
+	}
+
+private:
+	std::shared_ptr<GameInfo> info_;
+
+	DISALLOW_COPY_AND_ASSIGN(GameInfoDecodeItem);
+};
+
 GameInfoCache::GameInfoCache() {
 	Init();
 }
@@ -851,10 +1254,14 @@ GameInfoCache::~GameInfoCache() {
 	Shutdown();
 }
 
-void GameInfoCache::Init() {}
+void GameInfoCache::Init() {
+	db_ = std::make_shared<GameInfoDB>(GetSysDirectory(DIRECTORY_APP_CACHE) / "GameInfoCache.db");
+	db_->Load();
+}
 
 void GameInfoCache::Shutdown() {
 	CancelAll();
+	db_->Save();
 }
 
 void GameInfoCache::Clear() {
@@ -892,6 +1299,29 @@ void GameInfoCache::FlushBGs() {
 	}
 }
 
+void GameInfoCache::TrimIconTextures(double now) {
+	std::vector<GameInfo *> resident;
+	std::lock_guard<std::mutex> lock(mapLock_);
+	for (auto &iter : info_) {
+		if (iter.second->icon.texture)
+			resident.push_back(iter.second.get());
+	}
+	if (resident.size() <= MAX_RESIDENT_ICONS)
+		return;
+
+	std::sort(resident.begin(), resident.end(), [](const GameInfo *a, const GameInfo *b) {
+		return a->lastAccessedTime < b->lastAccessedTime;
+	});
+	size_t count = resident.size() - MAX_RESIDENT_ICONS;
+	for (size_t i = 0; i < count; i++) {
+		GameInfo *info = resident[i];
+		if (now - info->lastAccessedTime < ICON_EVICT_MIN_AGE)
+			break;
+		std::lock_guard<std::mutex> infoLock(info->lock);
+		info->icon.ReleaseTexture();
+	}
+}
+
 void GameInfoCache::PurgeType(IdentifiedFileType fileType) {
 	bool retry = false;
 	int retryCount = 10;
@@ -940,6 +1370,15 @@ std::shared_ptr<GameInfo> GameInfoCache::GetInfo(Draw::DrawContext *draw, const
 	// This is always needed to determine the method to get the other info, so make sure it's computed first.
 	wantFlags |= GameInfoFlags::FILE_TYPE;
 
+	// Textures can only be released on the main thread, which is the one with a draw context.
+	if (draw) {
+		double now = time_now_d();
+		if (now - lastTrimTime_ > 1.0) {
+			lastTrimTime_ = now;
+			TrimIconTextures(now);
+		}
+	}
+
 	mapLock_.lock();
 
 	auto iter = info_.find(pathStr);
@@ -951,29 +1390,64 @@ std::shared_ptr<GameInfo> GameInfoCache::GetInfo(Draw::DrawContext *draw, const
 		info->FinishPendingTextureLoads(draw);
 		info->lastAccessedTime = time_now_d();
 		GameInfoFlags wanted = (GameInfoFlags)0;
+		bool decodeIcon = false;
 		{
 			// Careful now!
 			std::unique_lock<std::mutex> lock(info->lock);
+			// The file changed since it was cached, so drop everything and load it again.
+			// Textures can only be released here on the main thread, which has a draw context.
+			if (draw && info->cacheStale && info->pendingFlags == (GameInfoFlags)0) {
+				info->icon.Clear();
+				info->pic0.Clear();
+				info->pic1.Clear();
+				info->sndFileData.clear();
+				info->sndDataLoaded = false;
+				info->hasFlags = (GameInfoFlags)0;
+				info->cacheStale = false;
+			}
+			// The icon data is here, but not decoded: it came from the persistent cache, or its texture was released.
+			if (draw && (wantFlags & GameInfoFlags::ICON) && (info->hasFlags & GameInfoFlags::ICON) && !(info->pendingFlags & GameInfoFlags::ICON) &&
+				info->icon.dataLoaded && !info->icon.imageLoaded) {
+				info->pendingFlags |= GameInfoFlags::ICON;
+				decodeIcon = true;
+			}
 			GameInfoFlags hasFlags = info->hasFlags | info->pendingFlags;  // We don't want to re-fetch data that we have, so or in pendingFlags.
 			wanted = (GameInfoFlags)((int)wantFlags & ~(int)hasFlags);  // & is reserved for testing. ugh.
 			info->pendingFlags |= wanted;
 		}
+		if (decodeIcon) {
+			g_threadManager.EnqueueTask(new GameInfoDecodeItem(info));
+		}
 		if (wanted != (GameInfoFlags)0) {
 			// We're missing info that we want. Go get it!
-			GameInfoWorkItem *item = new GameInfoWorkItem(gamePath, info, wanted);
+			GameInfoWorkItem *item = new GameInfoWorkItem(gamePath, info, wanted, db_);
 			g_threadManager.EnqueueTask(item);
 		}
 		return info;
 	}
 
 	std::shared_ptr<GameInfo> info = std::make_shared<GameInfo>(gamePath);
-	info->pendingFlags = wantFlags;
+	// Whatever the persistent cache has is ready right away, and checked against the file later.
+	GameInfoFlags cached = db_->Apply(info.get());
+	GameInfoFlags wanted = (GameInfoFlags)((int)wantFlags & ~(int)cached);
+	const bool decodeIcon = draw && (wantFlags & GameInfoFlags::ICON) && (cached & GameInfoFlags::ICON);
+	info->pendingFlags = wanted;
+	if (decodeIcon)
+		info->pendingFlags |= GameInfoFlags::ICON;
 	info->lastAccessedTime = time_now_d();
 	info_.insert(std::make_pair(pathStr, info));
 	mapLock_.unlock();
 
-	// Just get all the stuff we wanted.
-	GameInfoWorkItem *item = new GameInfoWorkItem(gamePath, info, wantFlags);
-	g_threadManager.EnqueueTask(item);
+	if (cached != (GameInfoFlags)0) {
+		g_threadManager.EnqueueTask(new GameInfoRevalidateItem(db_, info));
+	}
+	if (decodeIcon) {
+		g_threadManager.EnqueueTask(new GameInfoDecodeItem(info));
+	}
+	if (wanted != (GameInfoFlags)0) {
+		// Just get all the stuff we wanted.
+		GameInfoWorkItem *item = new GameInfoWorkItem(gamePath, info, wanted, db_);
+		g_threadManager.EnqueueTask(item);
+	}
 	return info;
 }
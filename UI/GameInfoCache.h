@@ -24,6 +24,7 @@
 #include <atomic>
 
 #include "Common/Thread/Event.h"
+#include "Common/Render/ManagedTexture.h"
 #include "Core/ELF/ParamSFO.h"
 #include "Common/File/Path.h"
 
@@ -66,13 +67,21 @@ enum class IdentifiedFileType;
 
 struct GameInfoTex {
 	std::string data;
+	// Decoded from data on a worker thread, so the main thread only has to upload it.
+	TempImage image;
 	Draw::Texture *texture = nullptr;
 	// The time at which the Icon and the BG were loaded.
 	// Can be useful to fade them in smoothly once they appear.
 	// Also, timeLoaded != 0 && texture == nullptr means that the load failed.
 	double timeLoaded = 0.0;
 	std::atomic<bool> dataLoaded{};
+	// Set once image is decoded (or failed to decode), and is ready for upload.
+	std::atomic<bool> imageLoaded{};
 
+	// Called from the worker tasks after data is loaded.
+	void DecodeImage();
+	// Can ONLY be called from the main thread! Keeps the data, so it can be decoded again later.
+	void ReleaseTexture();
 	// Can ONLY be called from the main thread!
 	void Clear();
 	bool Failed() const {
@@ -171,6 +180,8 @@ class GameInfo {
 	std::atomic<bool> sndDataLoaded{};
 
 	double lastAccessedTime = 0.0;
+	// Set when the file no longer matches what was loaded from the persistent cache.
+	std::atomic<bool> cacheStale{};
 
 	u64 gameSizeUncompressed = 0;
 	u64 gameSizeOnDisk = 0;  // compressed size, in case of CSO
@@ -186,13 +197,17 @@ class GameInfo {
 	std::shared_ptr<FileLoader> fileLoader;
 	Path filePath_;
 
-	void SetupTexture(Draw::DrawContext *draw, GameInfoTex &tex);
+	void SetupTexture(Draw::DrawContext *draw, GameInfoTex &tex, bool generateMips);
 
 private:
 	DISALLOW_COPY_AND_ASSIGN(GameInfo);
 	friend class GameInfoWorkItem;
+	friend class GameInfoDecodeItem;
+	friend class GameInfoDB;
 };
 
+class GameInfoDB;
+
 class GameInfoCache {
 public:
 	GameInfoCache();
@@ -215,11 +230,15 @@ class GameInfoCache {
 private:
 	void Init();
 	void Shutdown();
+	void TrimIconTextures(double now);
 
 	// Maps ISO path to info. Need to use shared_ptr as we can return these pointers - 
 	// and if they get destructed while being in use, that's bad.
 	std::map<std::string, std::shared_ptr<GameInfo> > info_;
 	std::mutex mapLock_;
+	// Remembers the title and icon of games across runs, shared with the work items.
+	std::shared_ptr<GameInfoDB> db_;
+	double lastTrimTime_ = 0.0;
 };
 
 // This one can be global, no good reason not to.
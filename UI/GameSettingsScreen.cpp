@@ -326,11 +326,25 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 		return !g_Config.bSoftwareRendering && !g_Config.bSkipBufferEffects;
 	});
 
+	// Only Vulkan reports how long we wait for the GPU, which is what the scaling is driven by.
+	if (GetGPUBackend() == GPUBackend::VULKAN) {
+		CheckBox *dynamicResolution = graphicsSettings->Add(new CheckBox(&g_Config.bDynamicResolution, gr->T("Dynamic resolution", "Dynamic resolution (lower it when the GPU can't keep up)")));
+		dynamicResolution->SetEnabledFunc([] {
+			return !g_Config.bSoftwareRendering && !g_Config.bSkipBufferEffects && g_Config.iInternalResolution != 1;
+		});
+	}
+
 	int deviceType = System_GetPropertyInt(SYSPROP_DEVICE_TYPE);
 
 	if (deviceType != DEVICE_TYPE_VR) {
 		CheckBox *softwareGPU = graphicsSettings->Add(new CheckBox(&g_Config.bSoftwareRendering, gr->T("Software Rendering", "Software Rendering (slow)")));
 		softwareGPU->SetEnabled(!PSP_IsInited());
+
+		static const char *softwareScales[] = { "1x PSP", "2x PSP", "4x PSP" };
+		PopupMultiChoice *softwareScale = graphicsSettings->Add(new PopupMultiChoice(&g_Config.iSoftwareRenderScale, gr->T("Software rendering resolution"), softwareScales, 0, ARRAY_SIZE(softwareScales), I18NCat::GRAPHICS, screenManager()));
+		softwareScale->SetEnabledPtr(&g_Config.bSoftwareRendering);
+		CheckBox *softwarePipelined = graphicsSettings->Add(new CheckBox(&g_Config.bSoftwareRenderingPipelined, gr->T("Software rendering pipelining", "Software rendering pipelining (faster, may glitch)")));
+		softwarePipelined->SetEnabledPtr(&g_Config.bSoftwareRendering);
 	}
 
 	if (draw->GetDeviceCaps().multiSampleLevelsMask != 1) {
@@ -459,6 +473,13 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 	PopupMultiChoice *skipGPUReadbacks = graphicsSettings->Add(new PopupMultiChoice(&g_Config.iSkipGPUReadbackMode, gr->T("Skip GPU Readbacks"), skipGpuReadbackModes, 0, ARRAY_SIZE(skipGpuReadbackModes), I18NCat::GRAPHICS, screenManager()));
 	skipGPUReadbacks->SetDisabledPtr(&g_Config.bSoftwareRendering);
 
+	CheckBox *delayedReadbacks = graphicsSettings->Add(new CheckBox(&g_Config.bDelayedGPUReadbacks, gr->T("Delayed GPU readbacks", "Delayed GPU readbacks (speedup)")));
+	delayedReadbacks->SetDisabledPtr(&g_Config.bSoftwareRendering);
+	delayedReadbacks->OnClick.Add([=](EventParams &e) {
+		settingInfo_->Show(gr->T("Delayed GPU readbacks Tip", "Avoids waiting for the GPU when games read back rendered images, but the data reaches memory a few frames late. Vulkan only"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+
 	static const char *depthRasterModes[] = { "Auto (default)", "Low", "Off", "Always on" };
 
 	PopupMultiChoice *depthRasterMode = graphicsSettings->Add(new PopupMultiChoice(&g_Config.iDepthRasterMode, gr->T("Lens flare occlusion"), depthRasterModes, 0, ARRAY_SIZE(depthRasterModes), I18NCat::GRAPHICS, screenManager()));
@@ -471,6 +492,20 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 		return UI::EVENT_CONTINUE;
 	});
 
+	CheckBox *texWriteTracking = graphicsSettings->Add(new CheckBox(&g_Config.bTextureWriteTracking, gr->T("Skip rehashing unchanged textures")));
+	texWriteTracking->SetDisabledPtr(&g_Config.bSoftwareRendering);
+	texWriteTracking->OnClick.Add([=](EventParams& e) {
+		settingInfo_->Show(gr->T("Skip rehashing unchanged textures Tip", "Watches memory writes to only rehash large textures that were written to. Not used with networking"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+
+	CheckBox *batchSprites = graphicsSettings->Add(new CheckBox(&g_Config.bBatchSpriteTextures, gr->T("Batch 2D sprites")));
+	batchSprites->SetDisabledPtr(&g_Config.bSoftwareRendering);
+	batchSprites->OnClick.Add([=](EventParams& e) {
+		settingInfo_->Show(gr->T("Batch 2D sprites Tip", "Draws small 2D textures from a shared atlas, so sprites and text need fewer draw calls"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+
 	static const char *quality[] = { "Low", "Medium", "High" };
 	PopupMultiChoice *beziersChoice = graphicsSettings->Add(new PopupMultiChoice(&g_Config.iSplineBezierQuality, gr->T("LowCurves", "Spline/Bezier curves quality"), quality, 0, ARRAY_SIZE(quality), I18NCat::GRAPHICS, screenManager()));
 	beziersChoice->OnChoice.Add([=](EventParams &e) {
@@ -496,6 +531,16 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 		inflightChoice->OnChoice.Handle(this, &GameSettingsScreen::OnInflightFramesChoice);
 	}
 
+	if (GetGPUBackend() == GPUBackend::VULKAN) {
+		// Only Vulkan reports actual present times for now.
+		CheckBox *lowLatencyPacing = graphicsSettings->Add(new CheckBox(&g_Config.bLowLatencyPacing, gr->T("Low latency frame pacing")));
+		lowLatencyPacing->OnClick.Add([=](EventParams &e) {
+			settingInfo_->Show(gr->T("Low latency frame pacing Tip", "Starts frames closer to the display refresh when they'd otherwise wait in line, lowering input lag. Needs VSync."), e.v);
+			return UI::EVENT_CONTINUE;
+		});
+		lowLatencyPacing->SetEnabledPtr(&g_Config.bVSync);
+	}
+
 	if (GetGPUBackend() == GPUBackend::VULKAN) {
 		const bool usable = draw->GetDeviceCaps().geometryShaderSupported && !draw->GetBugs().Has(Draw::Bugs::GEOMETRY_SHADERS_SLOW_OR_BROKEN);
 		const bool vertexSupported = draw->GetDeviceCaps().clipDistanceSupported && draw->GetDeviceCaps().cullDistanceSupported;
@@ -620,6 +665,11 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 	bloomHack->SetEnabledFunc([] {
 		return !g_Config.bSoftwareRendering && g_Config.iInternalResolution != 1;
 	});
+	static const char *bloomHackScales[] = { "1x PSP", "2x PSP", "3x PSP" };
+	PopupMultiChoice *bloomHackScale = graphicsSettings->Add(new PopupMultiChoice(&g_Config.iBloomHackScale, gr->T("Resolution for lowered effects"), bloomHackScales, 1, ARRAY_SIZE(bloomHackScales), I18NCat::GRAPHICS, screenManager()));
+	bloomHackScale->SetEnabledFunc([] {
+		return !g_Config.bSoftwareRendering && g_Config.iBloomHack != 0 && g_Config.iInternalResolution != 1;
+	});
 
 	graphicsSettings->Add(new ItemHeader(gr->T("Overlay Information")));
 	BitCheckBox *showFPSCtr = graphicsSettings->Add(new BitCheckBox(&g_Config.iShowStatusFlags, (int)ShowStatusFlags::FPS_COUNTER, gr->T("Show FPS Counter")));
@@ -706,6 +756,11 @@ void GameSettingsScreen::CreateAudioSettings(UI::ViewGroup *audioSettings) {
 	}
 #endif
 
+	CheckBox *lowLatencyAudio = audioSettings->Add(new CheckBox(&g_Config.bLowLatencyAudio, a->T("Low latency audio (may crackle)")));
+	lowLatencyAudio->SetEnabledFunc([] {
+		return g_Config.bEnableSound && !g_Config.bExtraAudioBuffering;
+	});
+
 	std::vector<std::string> micList = Microphone::getDeviceList();
 	if (!micList.empty()) {
 		audioSettings->Add(new ItemHeader(a->T("Microphone")));
@@ -929,6 +984,7 @@ void GameSettingsScreen::CreateNetworkingSettings(UI::ViewGroup *networkingSetti
 	networkingSettings->Add(new ItemHeader(n->T("AdHoc Server")));
 	networkingSettings->Add(new CheckBox(&g_Config.bEnableAdhocServer, n->T("Enable built-in PRO Adhoc Server", "Enable built-in PRO Adhoc Server")));
 	networkingSettings->Add(new ChoiceWithValueDisplay(&g_Config.proAdhocServer, n->T("Change proAdhocServer Address", "Change proAdhocServer Address (localhost = multiple instance)"), I18NCat::NONE))->OnClick.Handle(this, &GameSettingsScreen::OnChangeproAdhocServerAddress);
+	networkingSettings->Add(new CheckBox(&g_Config.bAdhocRelay, n->T("Relay packets through the Adhoc Server", "Relay packets through the Adhoc Server (no port-forwarding, needs server support)")));
 
 	networkingSettings->Add(new ItemHeader(n->T("UPnP (port-forwarding)")));
 	networkingSettings->Add(new CheckBox(&g_Config.bEnableUPnP, n->T("Enable UPnP", "Enable UPnP (need a few seconds to detect)")));
@@ -1239,6 +1295,10 @@ void GameSettingsScreen::CreateSystemSettings(UI::ViewGroup *systemSettings) {
 
 	systemSettings->Add(new CheckBox(&g_Config.bFastMemory, sy->T("Fast Memory", "Fast Memory")))->OnClick.Handle(this, &GameSettingsScreen::OnJitAffectingSetting);
 	systemSettings->Add(new CheckBox(&g_Config.bIgnoreBadMemAccess, sy->T("Ignore bad memory accesses")));
+	// Mixes each grain while the game keeps running, mainly helps phones with many weak cores.
+	systemSettings->Add(new CheckBox(&g_Config.bSeparateSASThread, sy->T("Mix audio on a separate thread")));
+	// Only used for videos opened afterward.
+	systemSettings->Add(new CheckBox(&g_Config.bHardwareVideoDecode, sy->T("Hardware video decoding")));
 
 	static const char *ioTimingMethods[] = { "Fast (lag on slow storage)", "Host (bugs, less lag)", "Simulate UMD delays", "Simulate UMD slow reading speed"};
 	View *ioTimingMethod = systemSettings->Add(new PopupMultiChoice(&g_Config.iIOTimingMethod, sy->T("IO timing method"), ioTimingMethods, 0, ARRAY_SIZE(ioTimingMethods), I18NCat::SYSTEM, screenManager()));
@@ -1252,6 +1312,10 @@ void GameSettingsScreen::CreateSystemSettings(UI::ViewGroup *systemSettings) {
 	PopupSliderChoice *rewindInterval = systemSettings->Add(new PopupSliderChoice(&g_Config.iRewindSnapshotInterval, 0, 60, 0, sy->T("Rewind Snapshot Interval"), screenManager(), di->T("seconds, 0:off")));
 	rewindInterval->SetFormat(di->T("%d seconds"));
 	rewindInterval->SetZeroLabel(sy->T("Off"));
+	// Rolls back every frame, which ad hoc networking can't survive.
+	PopupSliderChoice *runAhead = systemSettings->Add(new PopupSliderChoice(&g_Config.iRunAheadFrames, 0, 4, 0, sy->T("Run-ahead frames"), screenManager()));
+	runAhead->SetZeroLabel(sy->T("Off"));
+	runAhead->SetDisabledPtr(&g_Config.bEnableWlan);
 
 	systemSettings->Add(new ItemHeader(sy->T("General")));
 
@@ -1312,6 +1376,7 @@ void GameSettingsScreen::CreateSystemSettings(UI::ViewGroup *systemSettings) {
 	systemSettings->Add(new ItemHeader(sy->T("Recording")));
 	systemSettings->Add(new CheckBox(&g_Config.bDumpFrames, sy->T("Record Display")));
 	systemSettings->Add(new CheckBox(&g_Config.bUseFFV1, sy->T("Use Lossless Video Codec (FFV1)")));
+	systemSettings->Add(new CheckBox(&g_Config.bHardwareVideoEncoder, sy->T("Use hardware video encoder (H.264)")))->SetDisabledPtr(&g_Config.bUseFFV1);
 	systemSettings->Add(new CheckBox(&g_Config.bDumpVideoOutput, sy->T("Use output buffer (with overlay) for recording")));
 	systemSettings->Add(new CheckBox(&g_Config.bDumpAudio, sy->T("Record Audio")));
 	systemSettings->Add(new CheckBox(&g_Config.bSaveLoadResetsAVdumping, sy->T("Reset Recording on Save/Load State")));
@@ -1805,6 +1870,8 @@ void DeveloperToolsScreen::CreateViews() {
 
 	list->Add(new ItemHeader(dev->T("Texture Replacement")));
 	list->Add(new CheckBox(&g_Config.bSaveNewTextures, dev->T("Save new textures")));
+	PopupSliderChoice *saveCompression = list->Add(new PopupSliderChoice(&g_Config.iSaveTextureCompressionLevel, 0, 9, 6, dev->T("PNG compression level for saved textures"), 1, screenManager()));
+	saveCompression->SetEnabledPtr(&g_Config.bSaveNewTextures);
 	list->Add(new CheckBox(&g_Config.bReplaceTextures, dev->T("Replace textures")));
 
 	Choice *createTextureIni = list->Add(new Choice(dev->T("Create/Open textures.ini file for current game")));
@@ -1875,6 +1942,9 @@ void DeveloperToolsScreen::CreateViews() {
 		});
 	}
 
+	CheckBox *geThread = list->Add(new CheckBox(&g_Config.bGeThread, dev->T("Separate GE thread (experimental)")));
+	geThread->SetDisabledPtr(&g_Config.bSoftwareRendering);
+
 	if (GetGPUBackend() == GPUBackend::VULKAN && SupportsCustomDriver()) {
 		auto driverChoice = list->Add(new Choice(gr->T("Adreno Driver Manager")));
 		driverChoice->OnClick.Add([=](UI::EventParams &e) {
@@ -1925,10 +1995,9 @@ void DeveloperToolsScreen::CreateViews() {
 		});
 #endif
 
-	static const char *ffModes[] = { "Render all frames", "", "Frame Skipping" };
+	static const char *ffModes[] = { "Render all frames", "Skip rendering hidden frames", "Frame Skipping" };
 	PopupMultiChoice *ffMode = list->Add(new PopupMultiChoice(&g_Config.iFastForwardMode, dev->T("Fast-forward mode"), ffModes, 0, ARRAY_SIZE(ffModes), I18NCat::GRAPHICS, screenManager()));
 	ffMode->SetEnabledFunc([]() { return !g_Config.bVSync; });
-	ffMode->HideChoice(1);  // not used
 
 	auto displayRefreshRate = list->Add(new PopupSliderChoice(&g_Config.iDisplayRefreshRate, 60, 1000, 60, dev->T("Display refresh rate"), 1, screenManager()));
 	displayRefreshRate->SetFormat(si->T("%d Hz"));
@@ -1955,6 +2024,11 @@ void DeveloperToolsScreen::CreateViews() {
 	MIPSTracerPath_ = mipsTracer.get_logging_path();
 	MIPSTracerPath = list->Add(new InfoItem(dev->T("Current log file"), MIPSTracerPath_));
 
+	CheckBox *streaming = list->Add(new CheckBox(&mipsTracer.in_streaming, dev->T("Stream the trace to a compressed file")));
+	streaming->SetEnabledFunc([]() {
+		return !mipsTracer.tracing_enabled;
+	});
+
 	PopupSliderChoice* storage_capacity = list->Add(
 		new PopupSliderChoice(
 			&mipsTracer.in_storage_capacity, 0x4'0000, 0x40'0000, 0x10'0000, dev->T("Storage capacity"), 0x10000, screenManager()
@@ -2183,7 +2257,14 @@ UI::EventReturn DeveloperToolsScreen::OnMIPSTracerEnabled(UI::EventParams &e) {
 		u32 trace_size = mipsTracer.in_max_trace_size;
 
 		mipsTracer.initialize(capacity, trace_size);
-		mipsTracer.start_tracing();
+		if (mipsTracer.in_streaming) {
+			// Saved next to the log, since the log itself isn't written in this mode.
+			Path path(mipsTracer.get_logging_path());
+			if (path.empty() || !mipsTracer.start_streaming(path.WithExtraExtension(".mtrs")))
+				MIPSTracerEnabled_ = false;
+		} else {
+			mipsTracer.start_tracing();
+		}
 	}
 	else {
 		mipsTracer.stop_tracing();
@@ -103,10 +103,10 @@ void DrawSchedulerView(ImConfig &cfg) {
 	}
 	s64 ticks = CoreTiming::GetTicks();
 	if (ImGui::BeginChild("event_list", ImVec2(300.0f, 0.0))) {
-		const CoreTiming::Event *event = CoreTiming::GetFirstEvent();
-		while (event) {
-			ImGui::Text("%s (%lld): %d", CoreTiming::GetEventTypes()[event->type].name, event->time - ticks, (int)event->userdata);
-			event = event->next;
+		static std::vector<CoreTiming::BaseEvent> events;
+		CoreTiming::GetScheduledEvents(&events);
+		for (const CoreTiming::BaseEvent &event : events) {
+			ImGui::Text("%s (%lld): %d", CoreTiming::GetEventTypes()[event.type].name, event.time - ticks, (int)event.userdata);
 		}
 		ImGui::EndChild();
 	}
@@ -357,6 +357,12 @@ void JitCompareScreen::UpdateDisasm() {
 			100.0 * bcStats.avgBloat,
 			100.0 * bcStats.minBloat, bcStats.minBloatBlock,
 			100.0 * bcStats.maxBloat, bcStats.maxBloatBlock);
+		if (bcStats.invalidateHits + bcStats.invalidateMisses != 0) {
+			size_t len = strlen(stats);
+			snprintf(stats + len, sizeof(stats) - len,
+				"Invalidations: %llu hit code, %llu skipped\n",
+				(unsigned long long)bcStats.invalidateHits, (unsigned long long)bcStats.invalidateMisses);
+		}
 
 		statsContainer_->Add(new TextView(stats));
 	}
@@ -70,6 +70,7 @@
 #include "Common/Math/math_util.h"
 #include "Common/Math/lin/matrix4x4.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/VFS/ZipFileReader.h"
@@ -581,6 +582,11 @@ void NativeInit(int argc, const char *argv[], const char *savegame_dir, const ch
 					gotoGameSettings = true;
 				if (!strcmp(argv[i], "--developertools"))
 					gotoDeveloperTools = true;
+				if (!strncmp(argv[i], "--cache-dir=", strlen("--cache-dir=")) && strlen(argv[i]) > strlen("--cache-dir=")) {
+					// Lets several instances on one machine share their shader and jit caches.
+					g_Config.appCacheDirectory = Path(std::string(argv[i] + strlen("--cache-dir=")));
+					DiskCachingFileLoaderCache::SetCacheDir(g_Config.appCacheDirectory);
+				}
 				if (!strncmp(argv[i], "--appendconfig=", strlen("--appendconfig=")) && strlen(argv[i]) > strlen("--appendconfig=")) {
 					g_Config.SetAppendedConfigIni(Path(std::string(argv[i] + strlen("--appendconfig="))));
 					g_Config.LoadAppendedConfig();
@@ -995,6 +1001,7 @@ static void SendMouseDeltaAxis();
 
 void NativeFrame(GraphicsContext *graphicsContext) {
 	PROFILE_END_FRAME();
+	TRACE_SCOPE("native_frame");
 
 	if (System_GetPropertyInt(SYSPROP_DEVICE_TYPE) == DEVICE_TYPE_DESKTOP) {
 		if (g_windowHidden && g_Config.bPauseWhenMinimized) {
@@ -1093,6 +1100,7 @@ void NativeFrame(GraphicsContext *graphicsContext) {
 
 	// This, between EndFrame and Present, is where we should actually wait to do present time management.
 	// There might not be a meaningful distinction here for all backends..
+	g_frameTiming.UpdatePresentFeedback(g_draw);
 	g_frameTiming.PostSubmit();
 
 	if (renderCounter < 10 && ++renderCounter == 10) {
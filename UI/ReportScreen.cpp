@@ -184,6 +184,7 @@ ScreenRenderFlags ReportScreen::render(ScreenRenderMode mode) {
 			screenshotFilename_ = path / ".reporting.jpg";
 			if (TakeGameScreenshot(screenManager()->getDrawContext(), screenshotFilename_, ScreenshotFormat::JPG, SCREENSHOT_DISPLAY, nullptr, nullptr, 4)) {
 				// Redo the views already, now with a screenshot included.
+				WaitForPendingScreenshots();
 				RecreateViews();
 			} else {
 				// Good news (?), the views are good as-is without a screenshot.
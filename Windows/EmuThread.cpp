@@ -123,6 +123,7 @@ static bool Run(GraphicsContext *ctx) {
 
 static void EmuThreadFunc(GraphicsContext *graphicsContext) {
 	SetCurrentThreadName("EmuThread");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 
 	// There's no real requirement that NativeInit happen on this thread.
 	// We just call the update/render loop here.
@@ -199,6 +200,7 @@ bool CreateGraphicsBackend(std::string *error_message, GraphicsContext **ctx) {
 void MainThreadFunc() {
 	// We'll start up a separate thread we'll call Emu
 	SetCurrentThreadName(useEmuThread ? "RenderThread" : "EmuThread");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 
 	SetConsolePosition();
 
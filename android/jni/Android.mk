@@ -299,6 +299,8 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/Data/Format/JSONWriter.cpp \
   $(SRC)/Common/Data/Format/DDSLoad.cpp \
   $(SRC)/Common/Data/Format/DDSLoad.h \
+  $(SRC)/Common/Data/Format/DDSSave.cpp \
+  $(SRC)/Common/Data/Format/DDSSave.h \
   $(SRC)/Common/Data/Format/PNGLoad.cpp \
   $(SRC)/Common/Data/Format/PNGLoad.h \
   $(SRC)/Common/Data/Format/ZIMLoad.cpp \
@@ -350,6 +352,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Common/Net/URL.cpp \
   $(SRC)/Common/Net/WebsocketServer.cpp \
   $(SRC)/Common/Profiler/Profiler.cpp \
+  $(SRC)/Common/Profiler/Tracer.cpp \
   $(SRC)/Common/System/Display.cpp \
   $(SRC)/Common/System/Request.cpp \
   $(SRC)/Common/System/OSD.cpp \
@@ -435,6 +438,15 @@ ARCH_FILES := \
   $(SRC)/Core/MIPS/ARM/ArmCompVFPUNEON.cpp \
   $(SRC)/Core/MIPS/ARM/ArmCompVFPUNEONUtil.cpp \
   $(SRC)/Core/MIPS/ARM/ArmCompReplace.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRAsm.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRCompALU.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRCompBranch.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRCompFPU.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRCompLoadStore.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRCompSystem.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRCompVec.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRJit.cpp \
+  $(SRC)/Core/MIPS/ARM/ArmIRRegCache.cpp \
   $(SRC)/Core/MIPS/ARM/ArmAsm.cpp \
   $(SRC)/Core/MIPS/ARM/ArmJit.cpp \
   $(SRC)/Core/MIPS/ARM/ArmRegCache.cpp \
@@ -464,6 +476,7 @@ ARCH_FILES := \
   $(SRC)/Core/MIPS/ARM64/Arm64IRRegCache.cpp \
   $(SRC)/Core/Util/DisArm64.cpp \
   $(SRC)/GPU/Common/VertexDecoderArm64.cpp \
+  $(SRC)/GPU/Software/DrawPixelArm64.cpp \
   Arm64EmitterTest.cpp
 endif
 
@@ -517,6 +530,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/GPU/GPUState.cpp \
   $(SRC)/GPU/GeConstants.cpp \
   $(SRC)/GPU/GeDisasm.cpp \
+  $(SRC)/GPU/GeThread.cpp \
   $(SRC)/GPU/Common/Draw2D.cpp \
   $(SRC)/GPU/Common/TextureShaderCommon.cpp \
   $(SRC)/GPU/Common/DepalettizeShaderCommon.cpp \
@@ -566,10 +580,12 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/GPU/Software/Clipper.cpp \
   $(SRC)/GPU/Software/DrawPixel.cpp.arm \
   $(SRC)/GPU/Software/FuncId.cpp \
+  $(SRC)/GPU/Software/HiZBuffer.cpp \
   $(SRC)/GPU/Software/Lighting.cpp \
   $(SRC)/GPU/Software/Rasterizer.cpp.arm \
   $(SRC)/GPU/Software/RasterizerRectangle.cpp.arm \
   $(SRC)/GPU/Software/RasterizerRegCache.cpp \
+  $(SRC)/GPU/Software/RenderScale.cpp \
   $(SRC)/GPU/Software/Sampler.cpp \
   $(SRC)/GPU/Software/SoftGpu.cpp \
   $(SRC)/GPU/Software/TransformUnit.cpp \
@@ -608,7 +624,9 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/FileLoaders/HTTPFileLoader.cpp \
   $(SRC)/Core/FileLoaders/LocalFileLoader.cpp \
   $(SRC)/Core/FileLoaders/RamCachingFileLoader.cpp \
+  $(SRC)/Core/FileLoaders/ReadAheadTrace.cpp \
   $(SRC)/Core/FileLoaders/RetryingFileLoader.cpp \
+  $(SRC)/Core/MemDirtyTracker.cpp \
   $(SRC)/Core/MemFault.cpp \
   $(SRC)/Core/MemMap.cpp \
   $(SRC)/Core/MemMapFunctions.cpp \
@@ -626,6 +644,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/Debugger/MemBlockInfo.cpp \
   $(SRC)/Core/Debugger/SymbolMap.cpp \
   $(SRC)/Core/Debugger/WebSocket.cpp \
+  $(SRC)/Core/Debugger/WebSocket/AudioSubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/BreakpointSubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/CPUCoreSubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/ClientConfigSubscriber.cpp \
@@ -644,6 +663,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/Debugger/WebSocket/ReplaySubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/SteppingBroadcaster.cpp \
   $(SRC)/Core/Debugger/WebSocket/SteppingSubscriber.cpp \
+  $(SRC)/Core/Debugger/WebSocket/StreamSubscriber.cpp \
   $(SRC)/Core/Debugger/WebSocket/WebSocketUtils.cpp \
   $(SRC)/Core/Dialog/PSPDialog.cpp \
   $(SRC)/Core/Dialog/PSPGamedataInstallDialog.cpp \
@@ -747,6 +767,7 @@ EXEC_AND_LIB_FILES := \
   $(SRC)/Core/Util/AudioFormat.cpp \
   $(SRC)/Core/Util/MemStick.cpp \
   $(SRC)/Core/Util/PortManager.cpp \
+  $(SRC)/Core/Util/DiscCompressor.cpp \
   $(SRC)/Core/Util/GameDB.cpp \
   $(SRC)/Core/Util/GameManager.cpp \
   $(SRC)/Core/Util/BlockAllocator.cpp \
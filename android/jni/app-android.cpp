@@ -260,6 +260,7 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *pjvm, void *reserved) {
 // Only used in OpenGL mode.
 static void EmuThreadFunc() {
 	SetCurrentThreadName("EmuThread");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 
 	// Name the thread in the JVM, because why not (might result in better debug output in Play Console).
 	// TODO: Do something clever with getEnv() and stored names from SetCurrentThreadName?
@@ -1150,6 +1151,7 @@ extern "C" void Java_org_ppsspp_ppsspp_NativeRenderer_displayRender(JNIEnv *env,
 	if (!hasSetThreadName) {
 		hasSetThreadName = true;
 		SetCurrentThreadName("AndroidRender");
+		SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 	}
 
 	if (IsVREnabled() && !StartVRRender())
@@ -1563,6 +1565,7 @@ extern "C" void JNICALL Java_org_ppsspp_ppsspp_NativeActivity_requestExitVulkanR
 // TODO: Merge with the Win32 EmuThread and so on, and the Java EmuThread?
 static void VulkanEmuThread(ANativeWindow *wnd) {
 	SetCurrentThreadName("EmuThread");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 
 	AndroidJNIThreadContext ctx;
 	JNIEnv *env = getEnv();
@@ -1279,6 +1279,215 @@ rijndael_encrypt(rijndael_ctx *ctx, const u8 *src, u8 *dst)
 	rijndaelEncrypt(ctx->ek, ctx->Nr, src, dst);
 }
 
+/* Hardware AES (AES-NI / ARMv8 crypto extensions) for the bulk CBC paths.
+ * The caller decides through AES_set_hw_enabled() from the CPU detection. */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AES_HW_X86 1
+#include <wmmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define AES_HW_TARGET __attribute__((target("aes,sse2")))
+#else
+#define AES_HW_TARGET
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define AES_HW_ARM64 1
+#include <arm_neon.h>
+#if defined(__clang__)
+#define AES_HW_TARGET __attribute__((target("aes")))
+#elif defined(__GNUC__)
+#define AES_HW_TARGET __attribute__((target("+crypto")))
+#else
+#define AES_HW_TARGET
+#endif
+#endif
+
+static int aes_hw_enabled = 0;
+
+void AES_set_hw_enabled(int enabled)
+{
+#if defined(AES_HW_X86) || defined(AES_HW_ARM64)
+	aes_hw_enabled = enabled;
+#else
+	aes_hw_enabled = 0;
+#endif
+}
+
+/* The software schedule keeps round keys as big-endian words, the instructions want bytes. */
+static void aes_hw_round_keys(const u32 *ek, int Nr, u8 *out)
+{
+	int i;
+	for (i = 0; i < 4 * (Nr + 1); i++)
+	{
+		out[i * 4 + 0] = (u8)(ek[i] >> 24);
+		out[i * 4 + 1] = (u8)(ek[i] >> 16);
+		out[i * 4 + 2] = (u8)(ek[i] >> 8);
+		out[i * 4 + 3] = (u8)ek[i];
+	}
+}
+
+#if defined(AES_HW_X86)
+
+/* CBC with a zero IV like the software version. dst may be NULL to only compute the chain (CMAC). */
+AES_HW_TARGET static void aes_hw_cbc_encrypt(const AES_ctx *ctx, const u8 *src, u8 *dst, int blocks, u8 *chain)
+{
+	u8 keyBytes[16 * (AES_MAXROUNDS + 1)];
+	__m128i rk[AES_MAXROUNDS + 1];
+	__m128i state;
+	int i, r;
+	const int Nr = ctx->Nr;
+
+	aes_hw_round_keys(ctx->ek, Nr, keyBytes);
+	for (r = 0; r <= Nr; r++)
+		rk[r] = _mm_loadu_si128((const __m128i *)(keyBytes + r * 16));
+
+	state = _mm_loadu_si128((const __m128i *)chain);
+	for (i = 0; i < blocks; i++)
+	{
+		state = _mm_xor_si128(state, _mm_loadu_si128((const __m128i *)(src + i * 16)));
+		state = _mm_xor_si128(state, rk[0]);
+		for (r = 1; r < Nr; r++)
+			state = _mm_aesenc_si128(state, rk[r]);
+		state = _mm_aesenclast_si128(state, rk[Nr]);
+		if (dst)
+			_mm_storeu_si128((__m128i *)(dst + i * 16), state);
+	}
+	_mm_storeu_si128((__m128i *)chain, state);
+}
+
+/* Unlike encryption, blocks are independent, so we interleave four at a time. Works in place. */
+AES_HW_TARGET static void aes_hw_cbc_decrypt(const AES_ctx *ctx, const u8 *src, u8 *dst, int blocks)
+{
+	u8 keyBytes[16 * (AES_MAXROUNDS + 1)];
+	__m128i rk[AES_MAXROUNDS + 1];
+	__m128i prev = _mm_setzero_si128();
+	int i, r;
+	const int Nr = ctx->Nr;
+
+	aes_hw_round_keys(ctx->ek, Nr, keyBytes);
+	rk[0] = _mm_loadu_si128((const __m128i *)(keyBytes + Nr * 16));
+	for (r = 1; r < Nr; r++)
+		rk[r] = _mm_aesimc_si128(_mm_loadu_si128((const __m128i *)(keyBytes + (Nr - r) * 16)));
+	rk[Nr] = _mm_loadu_si128((const __m128i *)keyBytes);
+
+	for (i = 0; i + 4 <= blocks; i += 4)
+	{
+		const __m128i c0 = _mm_loadu_si128((const __m128i *)(src + i * 16 + 0));
+		const __m128i c1 = _mm_loadu_si128((const __m128i *)(src + i * 16 + 16));
+		const __m128i c2 = _mm_loadu_si128((const __m128i *)(src + i * 16 + 32));
+		const __m128i c3 = _mm_loadu_si128((const __m128i *)(src + i * 16 + 48));
+		__m128i s0 = _mm_xor_si128(c0, rk[0]);
+		__m128i s1 = _mm_xor_si128(c1, rk[0]);
+		__m128i s2 = _mm_xor_si128(c2, rk[0]);
+		__m128i s3 = _mm_xor_si128(c3, rk[0]);
+		for (r = 1; r < Nr; r++)
+		{
+			s0 = _mm_aesdec_si128(s0, rk[r]);
+			s1 = _mm_aesdec_si128(s1, rk[r]);
+			s2 = _mm_aesdec_si128(s2, rk[r]);
+			s3 = _mm_aesdec_si128(s3, rk[r]);
+		}
+		s0 = _mm_xor_si128(_mm_aesdeclast_si128(s0, rk[Nr]), prev);
+		s1 = _mm_xor_si128(_mm_aesdeclast_si128(s1, rk[Nr]), c0);
+		s2 = _mm_xor_si128(_mm_aesdeclast_si128(s2, rk[Nr]), c1);
+		s3 = _mm_xor_si128(_mm_aesdeclast_si128(s3, rk[Nr]), c2);
+		_mm_storeu_si128((__m128i *)(dst + i * 16 + 0), s0);
+		_mm_storeu_si128((__m128i *)(dst + i * 16 + 16), s1);
+		_mm_storeu_si128((__m128i *)(dst + i * 16 + 32), s2);
+		_mm_storeu_si128((__m128i *)(dst + i * 16 + 48), s3);
+		prev = c3;
+	}
+	for (; i < blocks; i++)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i *)(src + i * 16));
+		__m128i s = _mm_xor_si128(c, rk[0]);
+		for (r = 1; r < Nr; r++)
+			s = _mm_aesdec_si128(s, rk[r]);
+		s = _mm_xor_si128(_mm_aesdeclast_si128(s, rk[Nr]), prev);
+		_mm_storeu_si128((__m128i *)(dst + i * 16), s);
+		prev = c;
+	}
+}
+
+#elif defined(AES_HW_ARM64)
+
+AES_HW_TARGET static void aes_hw_cbc_encrypt(const AES_ctx *ctx, const u8 *src, u8 *dst, int blocks, u8 *chain)
+{
+	u8 keyBytes[16 * (AES_MAXROUNDS + 1)];
+	uint8x16_t rk[AES_MAXROUNDS + 1];
+	uint8x16_t state;
+	int i, r;
+	const int Nr = ctx->Nr;
+
+	aes_hw_round_keys(ctx->ek, Nr, keyBytes);
+	for (r = 0; r <= Nr; r++)
+		rk[r] = vld1q_u8(keyBytes + r * 16);
+
+	state = vld1q_u8(chain);
+	for (i = 0; i < blocks; i++)
+	{
+		state = veorq_u8(state, vld1q_u8(src + i * 16));
+		for (r = 0; r < Nr - 1; r++)
+			state = vaesmcq_u8(vaeseq_u8(state, rk[r]));
+		state = veorq_u8(vaeseq_u8(state, rk[Nr - 1]), rk[Nr]);
+		if (dst)
+			vst1q_u8(dst + i * 16, state);
+	}
+	vst1q_u8(chain, state);
+}
+
+AES_HW_TARGET static void aes_hw_cbc_decrypt(const AES_ctx *ctx, const u8 *src, u8 *dst, int blocks)
+{
+	u8 keyBytes[16 * (AES_MAXROUNDS + 1)];
+	uint8x16_t rk[AES_MAXROUNDS + 1];
+	uint8x16_t prev = vdupq_n_u8(0);
+	int i, r;
+	const int Nr = ctx->Nr;
+
+	aes_hw_round_keys(ctx->ek, Nr, keyBytes);
+	rk[0] = vld1q_u8(keyBytes + Nr * 16);
+	for (r = 1; r < Nr; r++)
+		rk[r] = vaesimcq_u8(vld1q_u8(keyBytes + (Nr - r) * 16));
+	rk[Nr] = vld1q_u8(keyBytes);
+
+	for (i = 0; i + 4 <= blocks; i += 4)
+	{
+		const uint8x16_t c0 = vld1q_u8(src + i * 16 + 0);
+		const uint8x16_t c1 = vld1q_u8(src + i * 16 + 16);
+		const uint8x16_t c2 = vld1q_u8(src + i * 16 + 32);
+		const uint8x16_t c3 = vld1q_u8(src + i * 16 + 48);
+		uint8x16_t s0 = c0, s1 = c1, s2 = c2, s3 = c3;
+		for (r = 0; r < Nr - 1; r++)
+		{
+			s0 = vaesimcq_u8(vaesdq_u8(s0, rk[r]));
+			s1 = vaesimcq_u8(vaesdq_u8(s1, rk[r]));
+			s2 = vaesimcq_u8(vaesdq_u8(s2, rk[r]));
+			s3 = vaesimcq_u8(vaesdq_u8(s3, rk[r]));
+		}
+		s0 = veorq_u8(veorq_u8(vaesdq_u8(s0, rk[Nr - 1]), rk[Nr]), prev);
+		s1 = veorq_u8(veorq_u8(vaesdq_u8(s1, rk[Nr - 1]), rk[Nr]), c0);
+		s2 = veorq_u8(veorq_u8(vaesdq_u8(s2, rk[Nr - 1]), rk[Nr]), c1);
+		s3 = veorq_u8(veorq_u8(vaesdq_u8(s3, rk[Nr - 1]), rk[Nr]), c2);
+		vst1q_u8(dst + i * 16 + 0, s0);
+		vst1q_u8(dst + i * 16 + 16, s1);
+		vst1q_u8(dst + i * 16 + 32, s2);
+		vst1q_u8(dst + i * 16 + 48, s3);
+		prev = c3;
+	}
+	for (; i < blocks; i++)
+	{
+		const uint8x16_t c = vld1q_u8(src + i * 16);
+		uint8x16_t s = c;
+		for (r = 0; r < Nr - 1; r++)
+			s = vaesimcq_u8(vaesdq_u8(s, rk[r]));
+		s = veorq_u8(veorq_u8(vaesdq_u8(s, rk[Nr - 1]), rk[Nr]), prev);
+		vst1q_u8(dst + i * 16, s);
+		prev = c;
+	}
+}
+
+#endif
+
 int AES_set_key(AES_ctx *ctx, const u8 *key, int bits)
 {
 	return rijndael_set_key((rijndael_ctx *)ctx, key, bits);
@@ -1309,6 +1518,14 @@ void AES_cbc_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
 	u8 block_buff[16];
 	
 	int i;
+#if defined(AES_HW_X86) || defined(AES_HW_ARM64)
+	if (aes_hw_enabled)
+	{
+		memset(block_buff, 0, 16);
+		aes_hw_cbc_encrypt(ctx, src, dst, (size + 15) / 16, block_buff);
+		return;
+	}
+#endif
 	for(i = 0; i < size; i+=16)
 	{
 		//step 1: copy block to dst
@@ -1331,6 +1548,14 @@ void AES_cbc_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
 	u8 block_buff_previous[16];
 	int i;
 	
+#if defined(AES_HW_X86) || defined(AES_HW_ARM64)
+	if (aes_hw_enabled)
+	{
+		// Like below, the first block is always decrypted.
+		aes_hw_cbc_decrypt(ctx, src, dst, size > 16 ? (size + 15) / 16 : 1);
+		return;
+	}
+#endif
 	memcpy(block_buff, src, 16);
 	memcpy(block_buff_previous, src, 16);
 	AES_decrypt(ctx, src, dst);
@@ -1449,6 +1674,13 @@ void AES_CMAC (AES_ctx *ctx, unsigned char *input, int length, unsigned char *ma
     }
 
     for ( i=0; i<16; i++ ) X[i] = 0;
+#if defined(AES_HW_X86) || defined(AES_HW_ARM64)
+    if (aes_hw_enabled)
+    {
+        aes_hw_cbc_encrypt(ctx, input, NULL, n - 1, X);
+        n = 1;
+    }
+#endif
     for ( i=0; i<n-1; i++ ) 
     {
         xor_128(X,&input[16*i],Y); /* Y := Mi (+) X  */
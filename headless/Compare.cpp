@@ -32,6 +32,7 @@
 #include "GPU/GPUState.h"
 #include "GPU/Common/GPUDebugInterface.h"
 #include "GPU/Common/TextureDecoder.h"
+#include "ext/xxhash.h"
 
 
 bool teamCityMode = false;
@@ -181,6 +182,13 @@ Path ExpectedScreenshotFromFilename(const Path &bootFilename) {
 	return bootFilename.WithReplacedExtension(".expected.bmp");
 }
 
+Path ExpectedFrameHashesFromFilename(const Path &bootFilename) {
+	std::string extension = bootFilename.GetFileExtension();
+	if (extension.empty())
+		return bootFilename.WithExtraExtension(".framehashes");
+	return bootFilename.WithReplacedExtension(".framehashes");
+}
+
 static std::string ChopFront(std::string s, std::string front)
 {
 	if (s.size() >= front.size())
@@ -563,3 +571,72 @@ void ScreenshotComparer::PlotVisualComparison(u32 *dst, u32 offset, u32 actual,
 
 	dst[offset + w_ * 2 + 1] = (reference & 0x00FFFFFF) | alpha;
 }
+
+void FrameHashLog::AddFrame() {
+	const static u32 FRAME_WIDTH = 480;
+	const static u32 FRAME_HEIGHT = 272;
+
+	GPUDebugBuffer buffer;
+	if (!gpuDebug || !gpuDebug->GetCurrentFramebuffer(buffer, GPU_DBG_FRAMEBUF_DISPLAY, 1)) {
+		hashes_.push_back(0);
+		return;
+	}
+
+	// The rest of the stride can be anything, so only hash the visible rows.
+	const u32 pixelSize = buffer.PixelSize();
+	const u32 rowBytes = std::min(buffer.GetStride(), FRAME_WIDTH) * pixelSize;
+	const u32 h = std::min(buffer.GetHeight(), FRAME_HEIGHT);
+	XXH3_state_t *state = XXH3_createState();
+	XXH3_64bits_reset_withSeed(state, (XXH64_hash_t)buffer.GetFormat());
+	for (u32 y = 0; y < h; ++y) {
+		// Always hash top to bottom, whatever way the buffer is.
+		const u32 row = buffer.GetFlipped() ? buffer.GetHeight() - 1 - y : y;
+		XXH3_64bits_update(state, buffer.GetData() + row * buffer.GetStride() * pixelSize, rowBytes);
+	}
+	hashes_.push_back(XXH3_64bits_digest(state));
+	XXH3_freeState(state);
+}
+
+bool FrameHashLog::Save(const Path &filename) {
+	std::string data;
+	data.reserve(hashes_.size() * 17);
+	for (u64 hash : hashes_)
+		data += StringFromFormat("%016llx\n", (unsigned long long)hash);
+	return File::WriteStringToFile(true, data, filename);
+}
+
+int FrameHashLog::Compare(const Path &filename, std::string *error) {
+	std::string data;
+	if (!File::ReadTextFileToString(filename, &data)) {
+		*error = "Unable to read frame hashes: " + filename.ToVisualString();
+		return 0;
+	}
+
+	std::vector<std::string> lines;
+	SplitString(data, '\n', lines);
+	size_t frame = 0;
+	for (const std::string &line : lines) {
+		if (line.empty() || line[0] == '\r')
+			continue;
+		unsigned long long expected = 0;
+		if (sscanf(line.c_str(), "%llx", &expected) != 1) {
+			*error = "Frame hashes corrupt: " + filename.ToVisualString();
+			return (int)frame;
+		}
+		if (frame >= hashes_.size()) {
+			*error = StringFromFormat("Ran only %d frames, expected more", (int)hashes_.size());
+			return (int)frame;
+		}
+		if (hashes_[frame] != expected) {
+			*error = StringFromFormat("Frame %d differs (%016llx, expected %016llx)", (int)frame, (unsigned long long)hashes_[frame], expected);
+			return (int)frame;
+		}
+		frame++;
+	}
+
+	if (frame < hashes_.size()) {
+		*error = StringFromFormat("Ran %d frames, expected only %d", (int)hashes_.size(), (int)frame);
+		return (int)frame;
+	}
+	return -1;
+}
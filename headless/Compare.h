@@ -30,6 +30,7 @@ void GitHubActionsPrint(const char *type, const char *fmt, ...);
 
 Path ExpectedFromFilename(const Path &bootFilename);
 Path ExpectedScreenshotFromFilename(const Path &bootFilename);
+Path ExpectedFrameHashesFromFilename(const Path &bootFilename);
 std::string GetTestName(const Path &bootFilename);
 
 bool CompareOutput(const Path &bootFilename, const std::string &output, bool verbose);
@@ -63,3 +64,21 @@ class ScreenshotComparer {
 	u32 w_;
 	u32 h_;
 };
+
+// A hash of the displayed image for each frame, as a much cheaper check than screenshots that
+// also finds the first frame that changed.  Saved as text with one hash per line.
+class FrameHashLog {
+public:
+	// Hashes the visible part of the display framebuffer.
+	void AddFrame();
+	void Clear() {
+		hashes_.clear();
+	}
+
+	bool Save(const Path &filename);
+	// Returns the first frame that differs from the log in filename, or -1 if none do.
+	int Compare(const Path &filename, std::string *error);
+
+private:
+	std::vector<u64> hashes_;
+};
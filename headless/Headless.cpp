@@ -5,14 +5,25 @@
 // > --root pspautotests/tests/../ --compare --timeout=5 --graphics=software pspautotests/tests/cpu/cpu_alu/cpu_alu.prx
 
 #include "ppsspp_config.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
 #if PPSSPP_PLATFORM(ANDROID)
 #include <jni.h>
 #endif
 
+#if !PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(ANDROID)
+#define HEADLESS_JOBS_SUPPORTED
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
 #include "Common/Profiler/Profiler.h"
+#include "Common/Profiler/Tracer.h"
 #include "Common/System/NativeApp.h"
 #include "Common/System/Request.h"
 #include "Common/System/System.h"
@@ -28,6 +39,7 @@
 #include "Common/File/VFS/ZipFileReader.h"
 #include "Common/File/VFS/DirectoryReader.h"
 #include "Common/File/FileUtil.h"
+#include "Common/StringUtils.h"
 #include "Common/GraphicsContext.h"
 #include "Common/TimeUtil.h"
 #include "Common/Thread/ThreadManager.h"
@@ -37,9 +49,16 @@
 #include "Core/CoreTiming.h"
 #include "Core/System.h"
 #include "Core/WebServer.h"
+#include "Core/Loaders.h"
+#include "Core/FileSystems/BlockDevices.h"
+#include "Core/HLE/__sceAudio.h"
 #include "Core/HLE/sceUtility.h"
+#include "Core/MIPS/JitCommon/JitBlockCache.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/SaveState.h"
+#include "Core/Util/DiscCompressor.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/Debugger/Playback.h"
 #include "Common/Log.h"
 #include "Common/Log/LogManager.h"
 
@@ -111,6 +130,7 @@ bool System_MakeRequest(SystemRequestType type, int requestId, const std::string
 void System_AskForPermission(SystemPermission permission) {}
 PermissionStatus System_GetPermissionStatus(SystemPermission permission) { return PERMISSION_STATUS_GRANTED; }
 void System_AudioGetDebugStats(char *buf, size_t bufSize) { if (buf) buf[0] = '\0'; }
+void System_AudioGetDebugStats(AudioDebugStats *stats) { *stats = {}; }
 void System_AudioClear() {}
 void System_AudioPushSamples(const s32 *audio, int numSamples) {}
 
@@ -138,6 +158,10 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  --screenshot=FILE     compare against a screenshot\n");
 	fprintf(stderr, "  --max-mse=NUMBER      maximum allowed MSE error for screenshot\n");
 	fprintf(stderr, "  --timeout=SECONDS     abort test it if takes longer than SECONDS\n");
+	fprintf(stderr, "  --jit-profile=FILE    write jit block stats after each test (.json for chrome trace)\n");
+	fprintf(stderr, "  --trace=FILE          write a chrome trace of all threads at exit\n");
+	fprintf(stderr, "  --frame-hashes        compare a hash of each frame with file.framehashes\n");
+	fprintf(stderr, "  --write-frame-hashes  write a hash of each frame to file.framehashes\n");
 
 	fprintf(stderr, "  -v, --verbose         show the full passed/failed result\n");
 	fprintf(stderr, "  -i                    use the interpreter\n");
@@ -145,11 +169,38 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  -j                    use jit (default)\n");
 	fprintf(stderr, "  -c, --compare         compare with output in file.expected\n");
 	fprintf(stderr, "  --bench               run multiple times and output speed\n");
+	fprintf(stderr, "  --bench-dump=N        replay a GE dump N times and output frame time stats\n");
+	fprintf(stderr, "  --compress=FILE.szst  write the disc image given as a seekable zstd image, and exit\n");
+	fprintf(stderr, "  --turbo               don't create a host graphics context or present frames\n");
+	fprintf(stderr, "  --jobs=N              run the tests in N processes at once\n");
+	fprintf(stderr, "  --threads=N           use at most N worker threads\n");
+	fprintf(stderr, "  --cache-dir=PATH      share shader and jit caches with other instances\n");
 	fprintf(stderr, "\nSee headless.txt for details.\n");
 
 	return 1;
 }
 
+static int CompressDisc(const Path &src, const Path &dest) {
+	std::unique_ptr<FileLoader> loader(ConstructFileLoader(src));
+	std::unique_ptr<BlockDevice> device(constructBlockDevice(loader.get()));
+	if (!device) {
+		fprintf(stderr, "Could not open disc image %s\n", src.c_str());
+		return 1;
+	}
+
+	std::string error;
+	bool success = CompressDiscToSZST(device.get(), dest, SZSTCompressOptions(), &error, [](float progress) {
+		printf("\r%d%%", (int)(progress * 100.0f));
+		fflush(stdout);
+	});
+	printf("\n");
+	if (!success) {
+		fprintf(stderr, "Compression failed: %s\n", error.c_str());
+		return 1;
+	}
+	return 0;
+}
+
 static HeadlessHost *getHost(GPUCore gpuCore) {
 	switch (gpuCore) {
 	case GPUCORE_SOFTWARE:
@@ -167,11 +218,65 @@ static HeadlessHost *getHost(GPUCore gpuCore) {
 struct AutoTestOptions {
 	double timeout;
 	double maxScreenshotError;
+	const char *jitProfileFilename;
+	int benchDumpRuns;
 	bool compare : 1;
 	bool verbose : 1;
 	bool bench : 1;
+	bool turbo : 1;
+	bool frameHashes : 1;
+	bool writeFrameHashes : 1;
 };
 
+static void WriteJitProfile(const Path &filename) {
+	std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+	JitBlockCacheDebugInterface *blockCache = MIPSComp::jit ? MIPSComp::jit->GetBlockCacheDebugInterface() : nullptr;
+	if (!blockCache) {
+		fprintf(stderr, "No jit block cache to profile, not writing %s\n", filename.c_str());
+		return;
+	}
+
+	JitProfileFormat format = filename.GetFileExtension() == ".json" ? JitProfileFormat::CHROME_TRACE : JitProfileFormat::CSV;
+	if (!File::WriteStringToFile(true, ExportJitBlockProfile(blockCache, format), filename))
+		fprintf(stderr, "Failed to write jit profile to %s\n", filename.c_str());
+}
+
+static const char *GPUCoreName(GPUCore core) {
+	switch (core) {
+	case GPUCORE_GLES: return "gles";
+	case GPUCORE_SOFTWARE: return "software";
+	case GPUCORE_DIRECTX9: return "directx9";
+	case GPUCORE_DIRECTX11: return "directx11";
+	case GPUCORE_VULKAN: return "vulkan";
+	default: return "unknown";
+	}
+}
+
+static void PrintDumpBenchmark(const CoreParameter &coreParameter) {
+	const GPURecord::ReplayTimings &timings = GPURecord::GetReplayTimings();
+	const std::string testName = GetTestName(coreParameter.fileToStart);
+	if (timings.runSeconds.empty()) {
+		printf("  %s - no GE dump runs were timed\n", testName.c_str());
+		return;
+	}
+
+	std::vector<double> sorted = timings.runSeconds;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&](double p) {
+		return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))] * 1000.0;
+	};
+	const int runs = (int)sorted.size();
+	printf("  %s (%s) - %d runs, ms: min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n", testName.c_str(), GPUCoreName(coreParameter.gpuCore), runs, sorted.front() * 1000.0, percentile(0.5), percentile(0.9), percentile(0.99), sorted.back() * 1000.0);
+
+	double total = 0.0;
+	for (double seconds : timings.classSeconds)
+		total += seconds;
+	for (int i = 0; i < (int)GPURecord::ReplayTimingClass::COUNT; ++i) {
+		double seconds = timings.classSeconds[i];
+		printf("    %-16s %9.3f ms/run (%5.1f%%)\n", GPURecord::ReplayTimingClassName((GPURecord::ReplayTimingClass)i), seconds * 1000.0 / runs, total > 0.0 ? seconds * 100.0 / total : 0.0);
+	}
+}
+
 bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const AutoTestOptions &opt) {
 	// Kinda ugly, trying to guesstimate the test name from filename...
 	currentTestName = GetTestName(coreParameter.fileToStart);
@@ -180,6 +285,8 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 	if (opt.compare || opt.bench)
 		coreParameter.collectDebugOutput = &output;
 
+	GPURecord::SetReplayBenchmarkRuns(opt.benchDumpRuns);
+
 	std::string error_string;
 	if (!PSP_InitStart(coreParameter, &error_string)) {
 		fprintf(stderr, "Failed to start '%s'. Error: %s\n", coreParameter.fileToStart.c_str(), error_string.c_str());
@@ -212,6 +319,7 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 	if (draw)
 		draw->BeginFrame(Draw::DebugFlags::NONE);
 
+	FrameHashLog frameHashes;
 	bool passed = true;
 	double deadline = time_now_d() + opt.timeout;
 	coreState = coreParameter.startBreak ? CORE_STEPPING_CPU : CORE_RUNNING_CPU;
@@ -223,7 +331,10 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 		// If we were rendering, this might be a nice time to do something about it.
 		if (coreState == CORE_NEXTFRAME) {
 			coreState = CORE_RUNNING_CPU;
-			headlessHost->SwapBuffers();
+			if (opt.frameHashes || opt.writeFrameHashes)
+				frameHashes.AddFrame();
+			if (!opt.turbo)
+				headlessHost->SwapBuffers();
 		}
 		if (coreState == CORE_STEPPING_CPU && !coreParameter.startBreak) {
 			break;
@@ -258,6 +369,25 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 		draw->EndFrame();
 	}
 
+	if (opt.jitProfileFilename)
+		WriteJitProfile(Path(std::string(opt.jitProfileFilename)));
+	if (opt.benchDumpRuns > 0)
+		PrintDumpBenchmark(coreParameter);
+
+	const Path frameHashesFilename = ExpectedFrameHashesFromFilename(coreParameter.fileToStart);
+	if (opt.writeFrameHashes && passed) {
+		if (!frameHashes.Save(frameHashesFilename))
+			fprintf(stderr, "Failed to write frame hashes to %s\n", frameHashesFilename.c_str());
+	} else if (opt.frameHashes && passed) {
+		std::string error;
+		if (frameHashes.Compare(frameHashesFilename, &error) >= 0) {
+			printf("  Frame hashes: %s\n", error.c_str());
+			TeamCityPrint("testFailed name='%s' message='Frame hashes differ'", currentTestName.c_str());
+			GitHubActionsPrint("error", "Frame hashes differ for %s: %s", currentTestName.c_str(), error.c_str());
+			passed = false;
+		}
+	}
+
 	PSP_Shutdown();
 
 	if (!opt.bench)
@@ -293,6 +423,88 @@ std::vector<std::string> ReadFromListFile(const std::string &listFilename) {
 	return testFilenames;
 }
 
+#ifdef HEADLESS_JOBS_SUPPORTED
+// All the emulator state is global, so tests run in parallel by running ourselves several times.
+// Each job gets every Nth test, and its output is printed in order once they're all done.
+static int RunTestJobs(const std::vector<std::string> &jobArgs, const std::vector<std::string> &testFilenames, int jobs, bool compare) {
+	struct Job {
+		pid_t pid;
+		FILE *output;
+	};
+
+	std::vector<Job> running;
+	bool failed = false;
+	for (int j = 0; j < jobs && j < (int)testFilenames.size(); ++j) {
+		std::vector<std::string> args = jobArgs;
+		for (size_t i = j; i < testFilenames.size(); i += jobs)
+			args.push_back(testFilenames[i]);
+		std::vector<char *> argv;
+		for (std::string &arg : args)
+			argv.push_back(&arg[0]);
+		argv.push_back(nullptr);
+
+		FILE *output = tmpfile();
+		if (!output) {
+			perror("Unable to create job output file");
+			failed = true;
+			break;
+		}
+
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, fileno(output), STDOUT_FILENO);
+		pid_t pid;
+		int err = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+		posix_spawn_file_actions_destroy(&actions);
+		if (err != 0) {
+			fprintf(stderr, "Unable to start job: %s\n", strerror(err));
+			fclose(output);
+			failed = true;
+			break;
+		}
+		running.push_back(Job{ pid, output });
+	}
+
+	int passedCount = 0;
+	int failedCount = 0;
+	std::vector<std::string> failedTests;
+	for (const Job &job : running) {
+		int status = 0;
+		if (waitpid(job.pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			failed = true;
+
+		// The summary is combined, everything else is passed on as is.
+		rewind(job.output);
+		char line[2048];
+		bool inFailedList = false;
+		while (fgets(line, sizeof(line), job.output)) {
+			int p, f;
+			if (compare && sscanf(line, "%d tests passed, %d tests failed.", &p, &f) == 2) {
+				passedCount += p;
+				failedCount += f;
+			} else if (compare && !strcmp(line, "Failed tests:\n")) {
+				inFailedList = true;
+			} else if (inFailedList) {
+				failedTests.push_back(line);
+			} else {
+				fputs(line, stdout);
+			}
+		}
+		fclose(job.output);
+	}
+
+	if (compare) {
+		printf("%d tests passed, %d tests failed.\n", passedCount, failedCount);
+		if (!failedTests.empty()) {
+			printf("Failed tests:\n");
+			for (const std::string &line : failedTests)
+				fputs(line.c_str(), stdout);
+		}
+	}
+	return failed ? 1 : 0;
+}
+#endif
+
 int main(int argc, const char* argv[])
 {
 	PROFILE_INIT();
@@ -319,14 +531,23 @@ int main(int argc, const char* argv[])
 	int debuggerPort = -1;
 	bool newAtrac = false;
 	bool outputDebugStringLog = false;
+	int jobs = 1;
+	int maxThreads = 0;
+	// Everything but the tests and --jobs, to pass on to each job.
+	std::vector<std::string> jobArgs{ argv[0] };
 
 	std::vector<std::string> testFilenames;
 	const char *mountIso = nullptr;
 	const char *mountRoot = nullptr;
 	const char *screenshotFilename = nullptr;
+	const char *compressTo = nullptr;
+	const char *traceFilename = nullptr;
+	const char *cacheDir = nullptr;
 
 	for (int i = 1; i < argc; i++)
 	{
+		const int argStart = i;
+		bool passToJobs = true;
 		if (!strcmp(argv[i], "-m") || !strcmp(argv[i], "--mount"))
 		{
 			if (++i >= argc)
@@ -355,6 +576,8 @@ int main(int argc, const char* argv[])
 			testOptions.compare = true;
 		else if (!strcmp(argv[i], "--bench"))
 			testOptions.bench = true;
+		else if (!strncmp(argv[i], "--bench-dump=", strlen("--bench-dump=")) && strlen(argv[i]) > strlen("--bench-dump="))
+			testOptions.benchDumpRuns = std::max(1, atoi(argv[i] + strlen("--bench-dump=")));
 		else if (!strcmp(argv[i], "-v") || !strcmp(argv[i], "--verbose"))
 			testOptions.verbose = true;
 		else if (!strcmp(argv[i], "--new-atrac"))
@@ -389,16 +612,44 @@ int main(int argc, const char* argv[])
 			testOptions.timeout = strtod(argv[i] + strlen("--timeout="), nullptr);
 		else if (!strncmp(argv[i], "--max-mse=", strlen("--max-mse=")) && strlen(argv[i]) > strlen("--max-mse="))
 			testOptions.maxScreenshotError = strtod(argv[i] + strlen("--max-mse="), nullptr);
-		else if (!strncmp(argv[i], "--debugger=", strlen("--debugger=")) && strlen(argv[i]) > strlen("--debugger="))
+		else if (!strncmp(argv[i], "--jit-profile=", strlen("--jit-profile=")) && strlen(argv[i]) > strlen("--jit-profile="))
+			testOptions.jitProfileFilename = argv[i] + strlen("--jit-profile=");
+		else if (!strncmp(argv[i], "--trace=", strlen("--trace=")) && strlen(argv[i]) > strlen("--trace=")) {
+			traceFilename = argv[i] + strlen("--trace=");
+			passToJobs = false;
+		} else if (!strncmp(argv[i], "--debugger=", strlen("--debugger=")) && strlen(argv[i]) > strlen("--debugger="))
 			debuggerPort = (int)strtoul(argv[i] + strlen("--debugger="), NULL, 10);
 		else if (!strcmp(argv[i], "--teamcity"))
 			teamCityMode = true;
 		else if (!strncmp(argv[i], "--state=", strlen("--state=")) && strlen(argv[i]) > strlen("--state="))
 			stateToLoad = argv[i] + strlen("--state=");
-		else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h"))
+		else if (!strncmp(argv[i], "--compress=", strlen("--compress=")) && strlen(argv[i]) > strlen("--compress="))
+			compressTo = argv[i] + strlen("--compress=");
+		else if (!strncmp(argv[i], "--cache-dir=", strlen("--cache-dir=")) && strlen(argv[i]) > strlen("--cache-dir="))
+			cacheDir = argv[i] + strlen("--cache-dir=");
+		else if (!strcmp(argv[i], "--turbo"))
+			testOptions.turbo = true;
+		else if (!strcmp(argv[i], "--frame-hashes"))
+			testOptions.frameHashes = true;
+		else if (!strcmp(argv[i], "--write-frame-hashes"))
+			testOptions.writeFrameHashes = true;
+		else if (!strncmp(argv[i], "--jobs=", strlen("--jobs=")) && strlen(argv[i]) > strlen("--jobs=")) {
+			jobs = std::max(1, atoi(argv[i] + strlen("--jobs=")));
+			passToJobs = false;
+		} else if (!strncmp(argv[i], "--threads=", strlen("--threads=")) && strlen(argv[i]) > strlen("--threads=")) {
+			maxThreads = std::max(1, atoi(argv[i] + strlen("--threads=")));
+			passToJobs = false;
+		} else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h"))
 			return printUsage(argv[0], NULL);
-		else
+		else {
 			testFilenames.push_back(argv[i]);
+			passToJobs = false;
+		}
+
+		if (passToJobs) {
+			for (int j = argStart; j <= i; ++j)
+				jobArgs.push_back(argv[j]);
+		}
 	}
 
 	if (testFilenames.size() == 1 && testFilenames[0][0] == '@')
@@ -407,6 +658,19 @@ int main(int argc, const char* argv[])
 	if (testFilenames.empty())
 		return printUsage(argv[0], argc <= 1 ? NULL : "No executables specified");
 
+	if (jobs > 1) {
+		if (debuggerPort > 0 || compressTo || traceFilename)
+			return printUsage(argv[0], "--jobs can't be used with --debugger, --compress or --trace");
+#ifdef HEADLESS_JOBS_SUPPORTED
+		// Split the threads too, or the software renderer in each job will fight over cores.
+		int jobThreads = maxThreads > 0 ? maxThreads : std::max(1, cpu_info.logical_cpu_count / jobs);
+		jobArgs.push_back(StringFromFormat("--threads=%d", jobThreads));
+		return RunTestJobs(jobArgs, testFilenames, jobs, testOptions.compare);
+#else
+		fprintf(stderr, "--jobs isn't supported on this platform, running tests one at a time\n");
+#endif
+	}
+
 	g_Config.bEnableLogging = (fullLog || outputDebugStringLog);
 	g_logManager.Init(&g_Config.bEnableLogging, outputDebugStringLog);
 
@@ -421,9 +685,24 @@ int main(int argc, const char* argv[])
 	}
 
 	// Needs to be after log so we don't interfere with test output.
-	g_threadManager.Init(cpu_info.num_cores, cpu_info.logical_cpu_count);
+	if (maxThreads > 0)
+		g_threadManager.Init(std::min(cpu_info.num_cores, maxThreads), std::min(cpu_info.logical_cpu_count, maxThreads));
+	else
+		g_threadManager.Init(cpu_info.num_cores, cpu_info.logical_cpu_count);
+
+	if (compressTo) {
+		if (testFilenames.size() != 1)
+			return printUsage(argv[0], "--compress takes exactly one disc image");
+		return CompressDisc(Path(testFilenames[0]), Path(std::string(compressTo)));
+	}
 
-	HeadlessHost *headlessHost = getHost(gpuCore);
+	if (traceFilename)
+		Tracer::Start();
+
+	// Without a host context, only the software renderer works, straight into VRAM.
+	if (testOptions.turbo)
+		gpuCore = GPUCORE_SOFTWARE;
+	HeadlessHost *headlessHost = testOptions.turbo ? new HeadlessHost() : getHost(gpuCore);
 	g_headlessHost = headlessHost;
 
 	std::string error_string;
@@ -483,6 +762,8 @@ int main(int argc, const char* argv[])
 	g_Config.iGlobalVolume = VOLUME_FULL;
 	g_Config.iReverbVolume = VOLUME_FULL;
 	g_Config.internalDataDirectory.clear();
+	if (cacheDir)
+		g_Config.appCacheDirectory = Path(std::string(cacheDir));
 	g_Config.bUseExperimentalAtrac = newAtrac;
 
 	Path exePath = File::GetExeDirectory();
@@ -594,6 +875,12 @@ int main(int argc, const char* argv[])
 		ShutdownWebServer();
 	}
 
+	if (traceFilename) {
+		Tracer::Stop();
+		if (!File::WriteStringToFile(true, Tracer::ExportChromeJSON(), Path(std::string(traceFilename))))
+			fprintf(stderr, "Unable to write trace to %s\n", traceFilename);
+	}
+
 	headlessHost->ShutdownGraphics();
 	delete headlessHost;
 	headlessHost = nullptr;
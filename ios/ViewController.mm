@@ -174,6 +174,7 @@ - (void)viewSafeAreaInsetsDidChange {
 // that runs game logic.
 void GLRenderLoop(IOSGLESContext *graphicsContext) {
 	SetCurrentThreadName("EmuThreadGL");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 	renderLoopRunning = true;
 
 	NativeInitGraphics(graphicsContext);
@@ -245,6 +245,7 @@ - (void)appWillTerminate:(NSNotification *)notification
 // Should be very similar to the Android one, probably mergeable.
 void VulkanRenderLoop(IOSVulkanContext *graphicsContext, CAMetalLayer *metalLayer) {
 	SetCurrentThreadName("EmuThreadVulkan");
+	SetCurrentThreadCoreClass(ThreadCoreClass::PERFORMANCE);
 	INFO_LOG(Log::G3D, "Entering EmuThreadVulkan");
 
 	if (!graphicsContext) {
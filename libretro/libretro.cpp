@@ -1288,7 +1288,7 @@ void retro_get_system_info(struct retro_system_info *info)
    info->library_name     = "PPSSPP";
    info->library_version  = PPSSPP_GIT_VERSION;
    info->need_fullpath    = true;
-   info->valid_extensions = "elf|iso|cso|prx|pbp|chd";
+   info->valid_extensions = "elf|iso|cso|prx|pbp|chd|szst";
 }
 
 void retro_get_system_av_info(struct retro_system_av_info *info)
@@ -1952,6 +1952,7 @@ void System_AudioPushSamples(const int32_t *audio, int numSamples) {
 }
 
 void System_AudioGetDebugStats(char *buf, size_t bufSize) { if (buf) buf[0] = '\0'; }
+void System_AudioGetDebugStats(AudioDebugStats *stats) { *stats = {}; }
 void System_AudioClear() {}
 
 #if PPSSPP_PLATFORM(ANDROID) || PPSSPP_PLATFORM(IOS)
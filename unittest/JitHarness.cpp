@@ -16,9 +16,13 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <cstdlib>
+#include <set>
 
 #include "ppsspp_config.h"
 
+#include "Common/File/FileUtil.h"
+#include "Common/StringUtils.h"
 #include "Common/System/NativeApp.h"
 #include "Common/System/System.h"
 #include "Common/TimeUtil.h"
@@ -32,6 +36,7 @@
 #include "Core/MIPS/MIPSTables.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 #include "Core/MemMap.h"
+#include "Core/MemMapHelpers.h"
 #include "Core/Core.h"
 #include "Core/System.h"
 #include "Core/CoreTiming.h"
@@ -225,3 +230,425 @@ bool TestJit() {
 
 	return jit_speed >= interp_speed;
 }
+
+bool TestIRInterpreter() {
+	SetupJitHarness();
+
+	g_Config.bFastMemory = true;
+	const u32 base = PSP_GetUserMemoryBase();
+	const u32 dataAddr = 0x08900000;
+	const int count = 1000;
+	for (int i = 0; i < count; ++i)
+		Memory::Write_U32(i, dataAddr + i * 4);
+
+	// A typical loop over an array: load, pointer bump, and compare and branch.
+	char loopBranch[64];
+	snprintf(loopBranch, sizeof(loopBranch), "bne t2, zero, 0x%08x", base + 16);
+	const char *lines[] = {
+		"lui a0, 0x0890",
+		"ori a1, zero, 0",
+		"ori a2, zero, 1000",
+		"ori t1, zero, 0",
+		"lw t0, 0(a0)",
+		"addiu a0, a0, 4",
+		"addu a1, a1, t0",
+		"addiu t1, t1, 1",
+		"slt t2, t1, a2",
+		loopBranch,
+		"nop",
+	};
+
+	bool success = true;
+	u32 addr = base;
+	for (const char *line : lines) {
+		if (!MIPSAsm::MipsAssembleOpcode(line, currentDebugMIPS, addr)) {
+			printf("ERROR: %s\n", MIPSAsm::GetAssembleError().c_str());
+			success = false;
+		}
+		addr += 4;
+	}
+	Memory::Write_U32(MIPS_MAKE_SYSCALL("UnitTestFakeSyscalls", "UnitTestTerminator"), addr);
+	Memory::Write_U32(MIPS_MAKE_BREAK(1), addr + 4);
+	Memory::Write_U32(MIPS_MAKE_JR_RA(), addr + 8);
+
+	const u32 expected = count * (count - 1) / 2;
+	double interp_speed = 0.0, ir_speed = 0.0;
+	if (success) {
+		interp_speed = ExecCPUTest();
+		if (currentMIPS->r[MIPS_REG_A1] != expected) {
+			printf("Interpreter summed %08x, expected %08x\n", currentMIPS->r[MIPS_REG_A1], expected);
+			success = false;
+		}
+		mipsr4k.UpdateCore(CPUCore::IR_INTERPRETER);
+		ir_speed = ExecCPUTest();
+		if (currentMIPS->r[MIPS_REG_A1] != expected) {
+			printf("IR interpreter summed %08x, expected %08x\n", currentMIPS->r[MIPS_REG_A1], expected);
+			success = false;
+		}
+		// Build with IR_SWITCH_DISPATCH defined to compare against plain switch dispatch.
+		printf("IR interpreter was %fx faster than interp on an array loop.\n\n", ir_speed / interp_speed);
+	}
+
+	DestroyJitHarness();
+
+	return success;
+}
+
+// Runs the code at the user memory base until it hits the terminator, over and over for at least minSeconds.
+// Returns runs per second.  The first run isn't counted, so compiling isn't either.
+static double BenchCPURuns(double minSeconds) {
+	auto runOnce = []() {
+		currentMIPS->pc = PSP_GetUserMemoryBase();
+		coreState = CORE_RUNNING_CPU;
+		while (coreState == CORE_RUNNING_CPU) {
+			mipsr4k.RunLoopUntil(1000000);
+		}
+	};
+
+	runOnce();
+	int runs = 0;
+	double st = time_now_d();
+	double elapsed;
+	do {
+		runOnce();
+		++runs;
+	} while ((elapsed = time_now_d() - st) < minSeconds);
+	return runs / elapsed;
+}
+
+struct CPUBenchWorkload {
+	const char *name;
+	// Assembled at the user memory base.  Must leave a checksum in v0, and end with %s for the terminator.
+	const char *code;
+};
+
+// These should run for a few milliseconds in the interpreter, and must be deterministic.
+// FPU and VFPU values are kept exact (small integers and permutations) so all backends agree.
+static const CPUBenchWorkload cpuBenchWorkloads[] = {
+	{ "int_alu", R"(
+	li t0, 10000
+	li v0, 0x12345678
+	li v1, 0
+loop:
+	addu v1, v1, t0
+	xor v0, v0, v1
+	sll t1, v0, 3
+	srl t2, v0, 29
+	or v0, t1, t2
+	subu v0, v0, v1
+	mult v0, t0
+	mflo t3
+	addu v0, v0, t3
+	andi t4, v0, 0x1F
+	sllv t5, v0, t4
+	sra t6, t5, 2
+	slt t7, t6, v1
+	addu v0, v0, t7
+	seb t8, v0
+	clz t9, t8
+	ext t8, v0, 4, 8
+	min t9, t9, t8
+	addu v0, v0, t9
+	addiu t0, t0, -1
+	bnez t0, loop
+	nop
+%s)" },
+	{ "fpu", R"(
+	li t0, 10000
+	li v0, 0
+	li t1, 0x3F800000
+	mtc1 t1, f1
+	li t1, 0x3F000000
+	mtc1 t1, f2
+	li t1, 0x40400000
+	mtc1 t1, f7
+	mtc1 zero, f0
+	mtc1 zero, f8
+loop:
+	add.s f0, f0, f1
+	mul.s f3, f0, f2
+	sub.s f4, f3, f1
+	div.s f5, f4, f7
+	add.s f8, f8, f5
+	mul.s f8, f8, f2
+	sqrt.s f6, f0
+	add.s f8, f8, f6
+	c.lt.s f8, f0
+	bc1f skip
+	nop
+	neg.s f8, f8
+skip:
+	abs.s f8, f8
+	cvt.w.s f9, f8
+	mfc1 t2, f9
+	addu v0, v0, t2
+	addiu t0, t0, -1
+	bnez t0, loop
+	nop
+	mfc1 t3, f8
+	xor v0, v0, t3
+%s)" },
+	{ "vfpu_matrix", R"(
+	li t0, 5000
+	lui a0, 0x0890
+	lv.q C100, 0(a0)
+	lv.q C110, 16(a0)
+	lv.q C120, 32(a0)
+	lv.q C130, 48(a0)
+	lv.q C200, 64(a0)
+	lv.q C210, 80(a0)
+	lv.q C220, 96(a0)
+	lv.q C230, 112(a0)
+	vzero.s S310
+loop:
+	vmmul.q M000, M100, M200
+	vmmul.q M100, M000, M200
+	vdot.q S300, C000, C100
+	vadd.s S310, S310, S300
+	vadd.q C030, C000, C100
+	vmul.q C030, C030, C030
+	addiu t0, t0, -1
+	bnez t0, loop
+	nop
+	mfv v0, S310
+	mfv t1, S033
+	xor v0, v0, t1
+%s)" },
+	{ "memory", R"(
+	lui a0, 0x0890
+	lui a1, 0x08A0
+	li t0, 4096
+	li v0, 0
+loop:
+	lw t1, 0(a0)
+	lw t2, 4(a0)
+	lhu t3, 8(a0)
+	lb t4, 12(a0)
+	addu v0, v0, t1
+	xor v0, v0, t2
+	addu v0, v0, t3
+	subu v0, v0, t4
+	sw t1, 0(a1)
+	sw v0, 4(a1)
+	sh t3, 8(a1)
+	sb t4, 12(a1)
+	addiu a0, a0, 16
+	addiu a1, a1, 16
+	addiu t0, t0, -1
+	bnez t0, loop
+	nop
+%s)" },
+	{ "branchy", R"(
+	li t0, 10000
+	li t1, 12345
+	li t5, 1103515245
+	li v0, 0
+loop:
+	multu t1, t5
+	mflo t1
+	addiu t1, t1, 12345
+	srl t2, t1, 16
+	andi t3, t2, 1
+	beqz t3, skip1
+	nop
+	addiu v0, v0, 3
+skip1:
+	andi t3, t2, 6
+	bnez t3, skip2
+	nop
+	xor v0, v0, t2
+skip2:
+	sltiu t4, t2, 0x4000
+	beql t4, zero, skip3
+	addu v0, v0, t2
+	subu v0, v0, t2
+skip3:
+	andi t3, t2, 0x30
+	bnez t3, skip4
+	nop
+	jal func
+	nop
+skip4:
+	addiu t0, t0, -1
+	bnez t0, loop
+	nop
+	b done
+	nop
+func:
+	addu v0, v0, t1
+	jr ra
+	nop
+done:
+%s)" },
+};
+
+static void SetupCPUBenchData() {
+	const u32 dataAddr = 0x08900000;
+	// For vfpu_matrix: small integers in M100, and a permutation matrix in M200.
+	for (int i = 0; i < 16; ++i)
+		Memory::Write_Float((float)(i + 1), dataAddr + i * 4);
+	static const int permutation[4] = { 2, 0, 3, 1 };
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j)
+			Memory::Write_Float(permutation[i] == j ? 1.0f : 0.0f, dataAddr + 64 + (i * 4 + j) * 4);
+	}
+	// For memory: 64 KB of noise, after the matrices.
+	u32 seed = 0x1234;
+	for (u32 addr = dataAddr + 128; addr < dataAddr + 128 + 0x10000; addr += 4) {
+		seed = seed * 1103515245 + 12345;
+		Memory::Write_U32(seed, addr);
+	}
+}
+
+struct CPUBenchTraceBlock {
+	u32 address;
+	u32 executions;
+	std::vector<u32> ops;
+};
+
+// Reads the ".blocks" file MIPSTracer writes next to its log.
+static bool LoadCPUBenchTrace(const Path &path, std::vector<CPUBenchTraceBlock> &blocks) {
+	FILE *f = File::OpenCFile(path, "rb");
+	if (!f) {
+		printf("Could not open trace %s\n", path.c_str());
+		return false;
+	}
+
+	u32 header[3]{};
+	bool success = fread(header, sizeof(header), 1, f) == 1 && header[0] == 0x4252544D && header[1] == 1;
+	std::set<u32> seen;
+	for (u32 i = 0; success && i < header[2]; ++i) {
+		u32 blockHeader[3];
+		if (fread(blockHeader, sizeof(blockHeader), 1, f) != 1 || blockHeader[2] > 0x10000) {
+			success = false;
+			break;
+		}
+		CPUBenchTraceBlock block{ blockHeader[0], blockHeader[1] };
+		block.ops.resize(blockHeader[2]);
+		if (fread(block.ops.data(), sizeof(u32), block.ops.size(), f) != block.ops.size()) {
+			success = false;
+			break;
+		}
+		// Without the game's memory layout, only plain RAM can be used.  Overlays can give duplicates, keep the first.
+		if (!Memory::IsValidRange(block.address, (u32)block.ops.size() * 4) || !seen.insert(block.address).second)
+			continue;
+		blocks.push_back(std::move(block));
+	}
+	fclose(f);
+
+	if (!success)
+		printf("Trace %s is not a valid MIPSTracer blocks file\n", path.c_str());
+	return success && !blocks.empty();
+}
+
+// Traces don't include register or memory state, so they can't be run.  Instead, this times compiling
+// the blocks the game actually ran, which is what hitches when new code shows up.  Returns blocks per second.
+static double BenchCPUTraceCompile(const std::vector<CPUBenchTraceBlock> &blocks, double minSeconds) {
+	double elapsed = 0.0;
+	int rounds = 0;
+	do {
+		MIPSComp::jit->ClearCache();
+		for (const auto &block : blocks) {
+			for (size_t i = 0; i < block.ops.size(); ++i)
+				Memory::Write_U32(block.ops[i], block.address + (u32)i * 4);
+		}
+
+		double st = time_now_d();
+		for (const auto &block : blocks)
+			MIPSComp::jit->Compile(block.address);
+		elapsed += time_now_d() - st;
+		++rounds;
+	} while (elapsed < minSeconds && rounds < 1000);
+	MIPSComp::jit->ClearCache();
+	return (double)blocks.size() * rounds / elapsed;
+}
+
+// Set PPSSPP_BENCH_CSV to a file to append results to, for comparing across commits with
+// unittest/plot_cpu_benchmark.py.  Set PPSSPP_BENCH_TRACE to a MIPSTracer ".blocks" file to also
+// time compiling a real game's code.
+bool TestCPUBenchmark() {
+	SetupJitHarness();
+	g_Config.bFastMemory = true;
+
+	struct CoreInfo {
+		CPUCore core;
+		const char *name;
+	};
+	static const CoreInfo cores[] = {
+		{ CPUCore::INTERPRETER, "interpreter" },
+		{ CPUCore::IR_INTERPRETER, "ir_interpreter" },
+		{ CPUCore::JIT, "jit" },
+#if !PPSSPP_PLATFORM(MAC)
+		{ CPUCore::JIT_IR, "jit_ir" },
+#endif
+	};
+
+	FILE *csv = nullptr;
+	const char *csvFilename = getenv("PPSSPP_BENCH_CSV");
+	if (csvFilename && csvFilename[0])
+		csv = File::OpenCFile(Path(csvFilename), "a");
+	auto report = [&](const char *benchmark, const char *core, double value, const char *unit) {
+		printf("%-16s %-16s %12.1f %s\n", benchmark, core, value, unit);
+		if (csv)
+			fprintf(csv, "%s,%s,%s,%f,%s\n", PPSSPP_GIT_VERSION, benchmark, core, value, unit);
+	};
+
+	char terminator[128];
+	snprintf(terminator, sizeof(terminator), "\t.word 0x%08x\n\t.word 0x%08x\n\t.word 0x%08x\n", MIPS_MAKE_SYSCALL("UnitTestFakeSyscalls", "UnitTestTerminator"), MIPS_MAKE_BREAK(1), MIPS_MAKE_JR_RA());
+
+	bool success = true;
+	const u32 base = PSP_GetUserMemoryBase();
+	const u32 codeSize = 0x1000;
+	for (const auto &workload : cpuBenchWorkloads) {
+		mipsr4k.UpdateCore(CPUCore::INTERPRETER);
+		Memory::Memset(base, 0, codeSize);
+		SetupCPUBenchData();
+		if (!MIPSAsm::MipsAssembleOpcode(StringFromFormat(workload.code, terminator).c_str(), currentDebugMIPS, base)) {
+			printf("%s: ERROR: %s\n", workload.name, MIPSAsm::GetAssembleError().c_str());
+			success = false;
+			continue;
+		}
+		// Jits leave their marks in memory, so keep a clean copy.
+		std::vector<u32> code(codeSize / 4);
+		for (u32 i = 0; i < (u32)code.size(); ++i)
+			code[i] = Memory::Read_U32(base + i * 4);
+
+		u32 expected = 0;
+		for (const auto &core : cores) {
+			mipsr4k.UpdateCore(core.core);
+			for (u32 i = 0; i < (u32)code.size(); ++i)
+				Memory::Write_U32(code[i], base + i * 4);
+			if (MIPSComp::jit)
+				MIPSComp::jit->ClearCache();
+
+			report(workload.name, core.name, BenchCPURuns(0.25), "runs/s");
+			const u32 checksum = currentMIPS->r[MIPS_REG_V0];
+			if (core.core == CPUCore::INTERPRETER) {
+				expected = checksum;
+			} else if (checksum != expected) {
+				printf("%s: %s got %08x, interpreter got %08x\n", workload.name, core.name, checksum, expected);
+				success = false;
+			}
+		}
+	}
+
+	const char *traceFilename = getenv("PPSSPP_BENCH_TRACE");
+	std::vector<CPUBenchTraceBlock> traceBlocks;
+	if (traceFilename && traceFilename[0] && LoadCPUBenchTrace(Path(traceFilename), traceBlocks)) {
+		printf("Trace has %d blocks\n", (int)traceBlocks.size());
+		for (const auto &core : cores) {
+			if (core.core == CPUCore::INTERPRETER)
+				continue;
+			mipsr4k.UpdateCore(core.core);
+			report("trace_compile", core.name, BenchCPUTraceCompile(traceBlocks, 0.5), "blocks/s");
+		}
+	}
+
+	if (csv)
+		fclose(csv);
+	printf("\n");
+
+	DestroyJitHarness();
+
+	return success;
+}
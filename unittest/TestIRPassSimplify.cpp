@@ -166,6 +166,24 @@ static const IRVerification tests[] = {
 		},
 		{ &PropagateConstants },
 	},
+	{
+		"InterpreterSuperinstructions",
+		{
+			{ IROp::Load32, { MIPS_REG_T0 }, MIPS_REG_A0, 0, 0xFFFFFFFC },
+			{ IROp::AddConst, { MIPS_REG_A0 }, MIPS_REG_A0, 0, 4 },
+			{ IROp::Slt, { MIPS_REG_T2 }, MIPS_REG_T1, MIPS_REG_A2 },
+			{ IROp::Downcount, { 0 }, 0, 0, 7 },
+			{ IROp::ExitToConstIfNeq, { 0 }, MIPS_REG_T2, MIPS_REG_ZERO, 0x08804000 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804020 },
+		},
+		{
+			{ IROp::Downcount, { 0 }, 0, 0, 7 },
+			{ IROp::OptLoad32AddConst, { MIPS_REG_T0 }, MIPS_REG_A0, MIPS_REG_A0, 0x0004FFFC },
+			{ IROp::OptSltExitIfNonZero, { MIPS_REG_T2 }, MIPS_REG_T1, MIPS_REG_A2, 0x08804000 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804020 },
+		},
+		{ &OptimizeForInterpreter },
+	},
 };
 
 bool TestIRPassSimplify() {
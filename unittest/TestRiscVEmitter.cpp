@@ -29,6 +29,7 @@ bool TestRiscVEmitter() {
 	cpu_info.RiscV_D = true;
 	cpu_info.RiscV_F = true;
 	cpu_info.RiscV_M = true;
+	cpu_info.RiscV_V = true;
 
 	u32 code[1024];
 	RiscVEmitter emitter((u8 *)code, (u8 *)code);
@@ -70,5 +71,38 @@ bool TestRiscVEmitter() {
 		EXPECT_EQ_HEX(code[i], expected[i]);
 	}
 
+	// Vector ops, as used for Vec4 in the jit.
+	emitter.SetCodePointer((u8 *)code, (u8 *)code);
+	emitter.VSETIVLI(R_ZERO, 4, VType(32, VLMul::M1, VTail::A, VMask::A));
+	emitter.VLE_V(32, V1, X10);
+	emitter.VFADD_VV(V1, V1, V2);
+	emitter.VFMUL_VF(V3, V1, F10);
+	emitter.VFREDOSUM_VS(V4, V1, V5);
+	emitter.VFMV_F_S(F10, V4);
+	emitter.VSE_V(32, V1, X10);
+	emitter.VFSGNJN_VV(V1, V2, V2);
+	emitter.VMV_S_X(V5, X0);
+	emitter.VFMV_S_F(V5, F10);
+
+	static constexpr uint32_t expectedVec[] = {
+		0xcd027057,
+		0x02056087,
+		0x021110d7,
+		0x921551d7,
+		0x0e129257,
+		0x42401557,
+		0x020560a7,
+		0x262110d7,
+		0x420062d7,
+		0x420552d7,
+	};
+
+	len = (u32 *)emitter.GetWritableCodePtr() - code;
+	EXPECT_EQ_INT(len, ARRAY_SIZE(expectedVec));
+
+	for (ptrdiff_t i = 0; i < len; ++i) {
+		EXPECT_EQ_HEX(code[i], expectedVec[i]);
+	}
+
 	return true;
 }
@@ -1,6 +1,7 @@
 #include <thread>
 #include <vector>
 #include <cstdio>
+#include <cstring>
 
 #include "Common/Log.h"
 #include "Common/TimeUtil.h"
@@ -11,6 +12,7 @@
 #include "Common/Thread/ParallelLoop.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Thread/Waitable.h"
+#include "Common/Thread/WorkStealingDeque.h"
 
 #include "UnitTest.h"
 
@@ -64,6 +66,143 @@ bool TestParallelLoop(ThreadManager *threadMan) {
 	return true;
 }
 
+// Every item must come out exactly once, whether popped by the owner or stolen.
+bool TestWorkStealingDeque() {
+	const int ITEMS = 200000;
+	const int THIEVES = 3;
+	WorkStealingDeque<uintptr_t, 64> deque;
+	std::vector<std::atomic<int>> taken(ITEMS + 1);
+	std::atomic<bool> done{};
+
+	std::vector<std::thread> thieves;
+	for (int i = 0; i < THIEVES; i++) {
+		thieves.push_back(std::thread([&] {
+			uintptr_t item;
+			while (!done) {
+				if (deque.Steal(&item))
+					taken[item]++;
+			}
+		}));
+	}
+
+	uintptr_t item;
+	for (int i = 1; i <= ITEMS; i++) {
+		while (!deque.Push(i)) {
+			// Full, make room.
+			if (deque.Pop(&item))
+				taken[item]++;
+		}
+		if ((i % 3) == 0 && deque.Pop(&item))
+			taken[item]++;
+	}
+	while (deque.Pop(&item))
+		taken[item]++;
+	// Pop can lose the last item to a thief, so wait for them to see it's empty before checking.
+	done = true;
+	for (auto &thread : thieves)
+		thread.join();
+
+	EXPECT_TRUE(deque.Empty());
+	EXPECT_EQ_INT(taken[0], 0);
+	for (int i = 1; i <= ITEMS; i++) {
+		EXPECT_EQ_INT(taken[i], 1);
+	}
+	return true;
+}
+
+// The first chunks are much slower than the rest, so the other threads should steal the remainder.
+bool TestUnevenParallelLoop(ThreadManager *threadMan) {
+	const int COUNT = 4096;
+	std::atomic<int64_t> sum{};
+	std::vector<std::atomic<int>> visited(COUNT);
+	auto start = Instant::Now();
+	ParallelRangeLoop(threadMan, [&](int lower, int upper) {
+		if (lower == 0)
+			sleep_ms(50, "test-uneven");
+		for (int i = lower; i < upper; i++) {
+			visited[i]++;
+			sum += i;
+		}
+	}, 0, COUNT, 16);
+	printf("Uneven loop elapsed: %0.3f\n", start.ElapsedSeconds());
+
+	EXPECT_TRUE(sum == (int64_t)COUNT * (COUNT - 1) / 2);
+	for (int i = 0; i < COUNT; i++) {
+		EXPECT_EQ_INT(visited[i], 1);
+	}
+	return true;
+}
+
+template <size_t N>
+struct PooledBlob : public PoolAllocated {
+	PooledBlob(uint8_t v) {
+		memset(data, v, sizeof(data));
+	}
+	bool Check(uint8_t v) const {
+		for (uint8_t b : data) {
+			if (b != v)
+				return false;
+		}
+		return true;
+	}
+	uint8_t data[N];
+};
+
+// Allocated on one thread and freed on others, like tasks are.
+template <size_t N>
+static bool TestPoolAllocatedSize(ThreadManager *threadMan) {
+	const int COUNT = 2000;
+	std::vector<PooledBlob<N> *> blobs(COUNT);
+	std::atomic<int> bad{};
+	for (int round = 0; round < 4; ++round) {
+		for (int i = 0; i < COUNT; ++i)
+			blobs[i] = new PooledBlob<N>((uint8_t)(i + round));
+		ParallelRangeLoop(threadMan, [&](int lower, int upper) {
+			for (int i = lower; i < upper; ++i) {
+				if (!blobs[i]->Check((uint8_t)(i + round)))
+					bad++;
+				delete blobs[i];
+			}
+		}, 0, COUNT, 64);
+	}
+	EXPECT_EQ_INT(bad, 0);
+	return true;
+}
+
+bool TestPoolAllocated(ThreadManager *threadMan) {
+	// The first few are in the pooled size classes, the last is too big for them.
+	return TestPoolAllocatedSize<8>(threadMan) && TestPoolAllocatedSize<64>(threadMan) &&
+		TestPoolAllocatedSize<200>(threadMan) && TestPoolAllocatedSize<1000>(threadMan);
+}
+
+class SpawningTask : public Task {
+public:
+	SpawningTask(ThreadManager *threadMan, int depth, WaitableCounter *counter) : threadMan_(threadMan), depth_(depth), counter_(counter) {}
+	TaskType Type() const override { return TaskType::CPU_COMPUTE; }
+	TaskPriority Priority() const override { return TaskPriority::NORMAL; }
+	void Run() override {
+		// These get pushed on this worker's own deque.
+		if (depth_ > 0) {
+			threadMan_->EnqueueTask(new SpawningTask(threadMan_, depth_ - 1, counter_));
+			threadMan_->EnqueueTask(new SpawningTask(threadMan_, depth_ - 1, counter_));
+		}
+		counter_->Count();
+	}
+
+private:
+	ThreadManager *threadMan_;
+	int depth_;
+	WaitableCounter *counter_;
+};
+
+bool TestNestedTasks(ThreadManager *threadMan) {
+	const int DEPTH = 12;
+	WaitableCounter *counter = new WaitableCounter((2 << DEPTH) - 1);
+	threadMan->EnqueueTask(new SpawningTask(threadMan, DEPTH, counter));
+	counter->WaitAndRelease();
+	return true;
+}
+
 const size_t THREAD_COUNT = 9;
 const size_t ITERATIONS = 40000;
 
@@ -132,9 +271,25 @@ bool TestThreadManager() {
 
 	Promise<ResultObject *> *object(Promise<ResultObject *>::Spawn(&manager, &ResultProducer, TaskType::IO_BLOCKING));
 
+	if (!TestWorkStealingDeque()) {
+		return false;
+	}
+
 	if (!TestParallelLoop(&manager)) {
 		return false;
 	}
+
+	if (!TestUnevenParallelLoop(&manager)) {
+		return false;
+	}
+
+	if (!TestNestedTasks(&manager)) {
+		return false;
+	}
+
+	if (!TestPoolAllocated(&manager)) {
+		return false;
+	}
 	sleep_ms(100, "test-threadman");
 
 	ResultObject *result = object->BlockUntilReady();
@@ -152,5 +307,6 @@ bool TestThreadManager() {
 		return false;
 	}
 
+	manager.Teardown();
 	return true;
 }
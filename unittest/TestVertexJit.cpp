@@ -403,6 +403,45 @@ static bool TestVertexFloatThrough() {
 	return !dec.HasFailed();
 }
 
+// Several vertices, so the x86-64 jit decodes the texcoords two at a time, with an odd one left over.
+static bool TestVertexMultiple() {
+	VertexDecoderTestHarness dec;
+	int vtype = GE_VTYPE_POS_16BIT | GE_VTYPE_TC_16BIT;
+
+	for (int i = 0; i < 3; ++i) {
+		dec.Add16(i * 8192, 32768 - i * 4096);
+		dec.Add16(i, 0, 32768);
+	}
+
+	for (int jit = 0; jit <= 1; ++jit) {
+		dec.Execute(vtype, 2, jit == 1);
+		for (int i = 0; i < 3; ++i) {
+			dec.AssertFloat("TestVertexMultiple-TC", i * 0.25f, 1.0f - i * 0.125f);
+			dec.AssertFloat("TestVertexMultiple-Pos", i / 32768.0f, 0.0f, -1.0f);
+		}
+	}
+
+	vtype = GE_VTYPE_POS_16BIT | GE_VTYPE_TC_8BIT | GE_VTYPE_COL_8888 | GE_VTYPE_THROUGH;
+	for (int i = 0; i < 5; ++i) {
+		dec.Add8(i * 32, 128 - i * 16);
+		dec.Add8(0, 0);
+		dec.Add8(1, 2, 3, i);
+		dec.Add16(10, 20, 30);
+		dec.Add16(0);
+	}
+
+	for (int jit = 0; jit <= 1; ++jit) {
+		dec.Execute(vtype, 4, jit == 1);
+		for (int i = 0; i < 5; ++i) {
+			dec.AssertFloat("TestVertexMultiple-TC8", i * 0.25f, 1.0f - i * 0.125f);
+			dec.Assert8("TestVertexMultiple-Col", 1, 2, 3, i);
+			dec.AssertFloat("TestVertexMultiple-PosThrough", 10.0f, 20.0f, 30.0f);
+		}
+	}
+
+	return !dec.HasFailed();
+}
+
 static bool TestVertexColor8888() {
 	VertexDecoderTestHarness dec;
 	int vtype = GE_VTYPE_POS_FLOAT | GE_VTYPE_COL_8888;
@@ -649,6 +688,8 @@ static VertexTestFunc vertdecTestFuncs[] = {
 	&TestVertex16Through,
 	&TestVertexFloatThrough,
 
+	&TestVertexMultiple,
+
 	&TestVertexColor8888,
 	&TestVertexColor4444,
 	&TestVertexColor5551,
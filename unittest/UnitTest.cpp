@@ -38,6 +38,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <functional>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -48,6 +49,7 @@
 
 #include "Common/Data/Collections/TinySet.h"
 #include "Common/Data/Collections/FastVec.h"
+#include "Common/Data/Collections/FrameArena.h"
 #include "Common/Data/Collections/CharQueue.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Data/Text/Parsers.h"
@@ -67,8 +69,10 @@
 #include "Common/Render/DrawBuffer.h"
 #include "Common/System/NativeApp.h"
 #include "Common/System/System.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Data/Format/IniFile.h"
+#include "Common/Data/Random/Rng.h"
 #include "Common/TimeUtil.h"
 
 #include "Common/ArmEmitter.h"
@@ -81,11 +85,14 @@
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/VFS/DirectoryReader.h"
 #include "Core/FileSystems/ISOFileSystem.h"
+#include "Core/HLE/__sceAudio.h"
 #include "Core/MemMap.h"
 #include "Core/KeyMap.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
+#include "GPU/Common/DepthRaster.h"
 #include "GPU/Common/TextureDecoder.h"
 #include "GPU/Common/GPUStateUtils.h"
+#include "GPU/Software/BinManager.h"
 
 #include "Common/File/AndroidContentURI.h"
 
@@ -113,6 +120,7 @@ bool System_GetPropertyBool(SystemProperty prop) {
 void System_Notify(SystemNotification notification) {}
 void System_PostUIMessage(UIMessage message, const std::string &param) {}
 void System_AudioGetDebugStats(char *buf, size_t bufSize) { if (buf) buf[0] = '\0'; }
+void System_AudioGetDebugStats(AudioDebugStats *stats) { *stats = {}; }
 void System_AudioClear() {}
 void System_AudioPushSamples(const s32 *audio, int numSamples) {}
 
@@ -424,6 +432,46 @@ bool TestFastVec() {
 	return true;
 }
 
+bool TestFrameArena() {
+	FrameArena arena(1024);
+	{
+		FrameArena::Scope scope(arena);
+		uint8_t *a = arena.AllocateArray<uint8_t>(3);
+		uint32_t *b = arena.AllocateArray<uint32_t>(10);
+		EXPECT_TRUE(((uintptr_t)b & 15) == 0);
+		EXPECT_TRUE((uint8_t *)b >= a + 3);
+		{
+			FrameArena::Scope inner(arena);
+			// Bigger than a block, so it gets its own.
+			uint8_t *big = arena.AllocateArray<uint8_t>(5000);
+			memset(big, 0xAA, 5000);
+			EXPECT_TRUE(arena.Capacity() >= 1024 + 5000);
+		}
+		// The inner scope gave its memory back, so this continues right after b.
+		uint32_t *c = arena.AllocateArray<uint32_t>(1);
+		EXPECT_TRUE((uint8_t *)c >= (uint8_t *)(b + 10) && (uint8_t *)c < (uint8_t *)(b + 10) + 16);
+
+		ArenaVector<int> vec(arena);
+		for (int i = 0; i < 300; i++)
+			vec.push_back(i);
+		EXPECT_EQ_INT(vec[299], 299);
+	}
+	arena.EndFrame();
+	EXPECT_EQ_INT(arena.LastFrameStats().blockAllocs, 2);
+	EXPECT_TRUE(arena.LastFrameStats().peak >= 5000);
+
+	// Everything was released, so the same memory is used again.
+	{
+		FrameArena::Scope scope(arena);
+		arena.Allocate(100);
+		arena.Allocate(2000);
+	}
+	arena.EndFrame();
+	EXPECT_EQ_INT(arena.LastFrameStats().allocs, 2);
+	EXPECT_EQ_INT(arena.LastFrameStats().blockAllocs, 0);
+	return true;
+}
+
 bool TestVFPUSinCos() {
 	float sine, cosine;
 	// Needed for VFPU tables.
@@ -626,6 +674,100 @@ bool TestQuickTexHash() {
 	return true;
 }
 
+template <typename ClutT, int bits>
+static bool CheckDeIndexTexture(const u8 *indexed, const ClutT *clut, ClutT *dest, int length) {
+	u32 alphaSum = 0xFFFFFFFF;
+	if (bits == 4)
+		DeIndexTexture4Simple(dest, indexed, length, clut, &alphaSum);
+	else
+		DeIndexTexture8Simple(dest, indexed, length, clut, &alphaSum);
+
+	ClutT expectedSum = (ClutT)-1;
+	for (int i = 0; i < length; i++) {
+		int index = bits == 4 ? (indexed[i / 2] >> ((i & 1) * 4)) & 0xF : indexed[i];
+		if (dest[i] != clut[index]) {
+			printf("DeIndexTexture%d (%d-bit CLUT): pixel %d of %d was %08x, expected %08x\n", bits, (int)sizeof(ClutT) * 8, i, length, dest[i], clut[index]);
+			return false;
+		}
+		expectedSum &= clut[index];
+	}
+	EXPECT_EQ_HEX(alphaSum, (u32)expectedSum);
+	return true;
+}
+
+template <typename ClutT, int bits>
+static double TimeDeIndexTexture(const u8 *indexed, const ClutT *clut, ClutT *dest, int length) {
+	u32 alphaSum = 0xFFFFFFFF;
+	int total = 0;
+	double st = time_now_d();
+	do {
+		for (int j = 0; j < 1000; ++j) {
+			if (bits == 4)
+				DeIndexTexture4Simple(dest, indexed, length, clut, &alphaSum);
+			else
+				DeIndexTexture8Simple(dest, indexed, length, clut, &alphaSum);
+			++total;
+		}
+	} while (time_now_d() - st < 0.1);
+	return total / (time_now_d() - st);
+}
+
+bool TestDeIndexTexture() {
+	static const int MAX_LENGTH = 512;
+	u8 indexed[MAX_LENGTH];
+	u16 clut16[256];
+	u32 clut32[256];
+	u16 dest16[MAX_LENGTH];
+	u32 dest32[MAX_LENGTH];
+
+	u32 seed = 0x1234567;
+	auto next = [&]() {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	};
+	for (int i = 0; i < MAX_LENGTH; i++)
+		indexed[i] = (u8)next();
+	for (int i = 0; i < 256; i++) {
+		// Mostly with full alpha, so the alpha sum has something to find.
+		clut16[i] = (u16)(next() | 0xF000);
+		clut32[i] = next() | 0xFF000000;
+	}
+
+	// Compare whichever SIMD paths this CPU has against the plain loops, at awkward lengths too.
+	bool savedSSSE3 = cpu_info.bSSSE3;
+	bool savedAVX2 = cpu_info.bAVX2;
+	double rate[2][4];
+	for (int simd = 0; simd < 2; simd++) {
+		cpu_info.bSSSE3 = simd ? savedSSSE3 : false;
+		cpu_info.bAVX2 = simd ? savedAVX2 : false;
+		for (int length = 1; length <= MAX_LENGTH; length += length < 40 ? 1 : 37) {
+			bool success = CheckDeIndexTexture<u16, 4>(indexed, clut16, dest16, length);
+			success = success && CheckDeIndexTexture<u32, 4>(indexed, clut32, dest32, length);
+			success = success && CheckDeIndexTexture<u16, 8>(indexed, clut16, dest16, length);
+			success = success && CheckDeIndexTexture<u32, 8>(indexed, clut32, dest32, length);
+			if (!success) {
+				cpu_info.bSSSE3 = savedSSSE3;
+				cpu_info.bAVX2 = savedAVX2;
+				return false;
+			}
+		}
+
+		rate[simd][0] = TimeDeIndexTexture<u16, 4>(indexed, clut16, dest16, MAX_LENGTH);
+		rate[simd][1] = TimeDeIndexTexture<u32, 4>(indexed, clut32, dest32, MAX_LENGTH);
+		rate[simd][2] = TimeDeIndexTexture<u16, 8>(indexed, clut16, dest16, MAX_LENGTH);
+		rate[simd][3] = TimeDeIndexTexture<u32, 8>(indexed, clut32, dest32, MAX_LENGTH);
+	}
+	cpu_info.bSSSE3 = savedSSSE3;
+	cpu_info.bAVX2 = savedAVX2;
+
+	// On ARM64, NEON is always used, so both rows are the same.
+	static const char *const names[4] = { "CLUT4 -> 16-bit", "CLUT4 -> 32-bit", "CLUT8 -> 16-bit", "CLUT8 -> 32-bit" };
+	for (int i = 0; i < 4; i++) {
+		printf("%s: %0.1f Mpix/s, %0.1f Mpix/s without SSSE3/AVX2 (%0.2fx)\n", names[i], rate[1][i] * MAX_LENGTH / 1000000.0, rate[0][i] * MAX_LENGTH / 1000000.0, rate[1][i] / rate[0][i]);
+	}
+	return true;
+}
+
 bool TestCLZ() {
 	static const uint32_t input[] = {
 		0xFFFFFFFF,
@@ -927,6 +1069,166 @@ static bool TestDepthMath() {
 	return true;
 }
 
+// Checks that rasterizing in parallel tiles matches doing it in one go, and measures the cost of both.
+static bool TestDepthRaster() {
+	if (!g_threadManager.IsInitialized()) {
+		g_threadManager.Init(cpu_info.num_cores, cpu_info.logical_cpu_count);
+	}
+
+	const int width = 480;
+	const int height = 272;
+	const int stride = 512;
+	const int numTris = 4 * 256;
+	const int count = numTris * 3;
+
+	// Screen vertices are stored in groups of four triangles, as output by DepthRasterClipIndexedTriangles.
+	int *tx = (int *)AllocateAlignedMemory(count * sizeof(int), 16);
+	int *ty = (int *)AllocateAlignedMemory(count * sizeof(int), 16);
+	float *tz = (float *)AllocateAlignedMemory(count * sizeof(float), 16);
+	uint16_t *single = new uint16_t[stride * height];
+	uint16_t *tiled = new uint16_t[stride * height];
+
+	GMRng rng;
+	rng.Init(0x1337);
+	for (int group = 0; group < count; group += 12) {
+		for (int t = 0; t < 4; t++) {
+			int x[3], y[3];
+			for (int v = 0; v < 3; v++) {
+				x[v] = rng.R32() % width;
+				y[v] = rng.R32() % height;
+				tx[group + v * 4 + t] = x[v];
+				ty[group + v * 4 + t] = y[v];
+				tz[group + v * 4 + t] = (float)(rng.R32() % 65536);
+			}
+			// Make them all front facing, so they're not culled.
+			if ((x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]) < 0) {
+				std::swap(tx[group + 4 + t], tx[group + 8 + t]);
+				std::swap(ty[group + 4 + t], ty[group + 8 + t]);
+				std::swap(tz[group + 4 + t], tz[group + 8 + t]);
+			}
+		}
+	}
+
+	DepthDraw draw{};
+	draw.prim = GE_PRIM_TRIANGLES;
+	draw.compareMode = ZCompareMode::Greater;
+	draw.depthStride = stride;
+	draw.vertexCount = count;
+	DepthScissor scissor{ 0, 0, width - 1, height - 1 };
+	const int numTiles = std::max(2, std::min(g_threadManager.GetNumLooperThreads(), (int)MAX_DEPTH_RASTER_TILES));
+
+	memset(single, 0, stride * height * sizeof(uint16_t));
+	memset(tiled, 0, stride * height * sizeof(uint16_t));
+	DepthRasterScreenVerts(single, stride, tx, ty, tz, count, draw, scissor, false, 1);
+	DepthRasterScreenVerts(tiled, stride, tx, ty, tz, count, draw, scissor, false, numTiles);
+
+	int written = 0;
+	int mismatches = 0;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			int a = single[y * stride + x];
+			int b = tiled[y * stride + x];
+			written += a != 0;
+			// Z is interpolated from a different starting point in each tile, allow for (approximate reciprocal) rounding.
+			if (abs(a - b) > 16) {
+				mismatches++;
+			}
+		}
+	}
+	EXPECT_TRUE(written > width * height / 2);
+	EXPECT_EQ_INT(mismatches, 0);
+
+	const int tileCounts[2] = { 1, numTiles };
+	for (int tiles : tileCounts) {
+		int iterations = 0;
+		double st = time_now_d();
+		do {
+			DepthRasterScreenVerts(tiled, stride, tx, ty, tz, count, draw, scissor, false, tiles);
+			iterations++;
+		} while (time_now_d() - st < 0.1);
+		double elapsed = time_now_d() - st;
+		printf("DepthRaster, %d tiles: %0.2f Mtris/s\n", tiles, (double)numTris * iterations / elapsed / 1000000.0);
+	}
+
+	delete[] single;
+	delete[] tiled;
+	FreeAlignedMemory(tx);
+	FreeAlignedMemory(ty);
+	FreeAlignedMemory(tz);
+	return true;
+}
+
+// Checks that the four wide triangle setup in the software renderer's binner matches the scalar one, and measures both.
+static bool TestSoftGPUTriangleSetup() {
+	const int numTris = 4 * 256;
+	const BinCoords scissor{ 16 * 16, 8 * 16, 464 * 16 - 1, 264 * 16 - 1 };
+
+	// Ordered as x[vert * 4 + tri] in each group of four.
+	std::vector<int> x(numTris * 3), y(numTris * 3);
+	GMRng rng;
+	rng.Init(0x1337);
+	for (int group = 0; group < numTris * 3; group += 12) {
+		for (int i = 0; i < 12; i++) {
+			// A bit past the screen on each side, so some are scissored away.
+			x[group + i] = rng.R32() % (544 * 16) - 32 * 16;
+			y[group + i] = rng.R32() % (336 * 16) - 32 * 16;
+		}
+		// Make some degenerate, which must be dropped.
+		if ((group / 12) % 8 == 0) {
+			x[group + 4] = x[group];
+			x[group + 8] = x[group];
+		}
+	}
+
+	int drawn = 0;
+	int mismatches = 0;
+	for (int group = 0; group < numTris * 3; group += 12) {
+		BinCoords ranges[4];
+		int mask = SetupTriangles4(&x[group], &y[group], scissor, ranges);
+		for (int t = 0; t < 4; t++) {
+			ScreenCoords v0(x[group + t], y[group + t], 0);
+			ScreenCoords v1(x[group + 4 + t], y[group + 4 + t], 0);
+			ScreenCoords v2(x[group + 8 + t], y[group + 8 + t], 0);
+			BinCoords range;
+			bool draw = SetupTriangle(v0, v1, v2, scissor, range);
+			if (draw != ((mask & (1 << t)) != 0)) {
+				mismatches++;
+			} else if (draw) {
+				drawn++;
+				if (range.x1 != ranges[t].x1 || range.y1 != ranges[t].y1 || range.x2 != ranges[t].x2 || range.y2 != ranges[t].y2)
+					mismatches++;
+			}
+		}
+	}
+	EXPECT_TRUE(drawn > numTris / 4);
+	EXPECT_EQ_INT(mismatches, 0);
+
+	for (int wide = 0; wide < 2; wide++) {
+		int iterations = 0;
+		int total = 0;
+		double st = time_now_d();
+		do {
+			for (int group = 0; group < numTris * 3; group += 12) {
+				BinCoords ranges[4];
+				if (wide) {
+					total += SetupTriangles4(&x[group], &y[group], scissor, ranges);
+					continue;
+				}
+				for (int t = 0; t < 4; t++) {
+					ScreenCoords v0(x[group + t], y[group + t], 0);
+					ScreenCoords v1(x[group + 4 + t], y[group + 4 + t], 0);
+					ScreenCoords v2(x[group + 8 + t], y[group + 8 + t], 0);
+					total += SetupTriangle(v0, v1, v2, scissor, ranges[t]) ? 1 : 0;
+				}
+			}
+			iterations++;
+		} while (time_now_d() - st < 0.1);
+		double elapsed = time_now_d() - st;
+		printf("Triangle setup, %s: %0.2f Mtris/s (%d)\n", wide ? "4 wide" : "scalar", (double)numTris * iterations / elapsed / 1000000.0, total & 1);
+	}
+	return true;
+}
+
 bool TestInputMapping() {
 	InputMapping mapping;
 	mapping.deviceId = DEVICE_ID_PAD_0;
@@ -1005,6 +1307,27 @@ bool TestIniFile() {
 	line2.Reconstruct(&temp);
 
 	EXPECT_EQ_STR(testLine2, temp);
+
+	IniFile ini;
+	EXPECT_TRUE(ini.LoadFromString("[General]\r\nZeta = 1\nalpha = 2\nAlpha = 3\n# comment\n[Other]\nKey = x"));
+	Section *general = ini.GetSection("General");
+	EXPECT_TRUE(general != nullptr);
+	int value = 0;
+	EXPECT_TRUE(general->Get("ALPHA", &value, 0));
+	// The first of duplicate keys wins.
+	EXPECT_EQ_INT(value, 2);
+	EXPECT_TRUE(general->Get("zeta", &value, 0));
+	EXPECT_EQ_INT(value, 1);
+	EXPECT_FALSE(general->Exists("Beta"));
+	general->Set("Beta", 4);
+	EXPECT_TRUE(general->Get("beta", &value, 0));
+	EXPECT_EQ_INT(value, 4);
+	EXPECT_TRUE(general->Delete("alpha"));
+	EXPECT_TRUE(general->Get("Alpha", &value, 0));
+	EXPECT_EQ_INT(value, 3);
+	std::string str;
+	EXPECT_TRUE(ini.Get("Other", "key", &str, ""));
+	EXPECT_EQ_STR(str, std::string("x"));
 	return true;
 }
 
@@ -1039,6 +1362,107 @@ bool TestColorConv() {
 		EXPECT_EQ_INT(reference, value);
 	}
 
+	// YUV: the SIMD paths should match the plain one, which is used for short rows.
+	static const int WIDTH = 480;
+	u8 y[WIDTH], u[WIDTH / 2], v[WIDTH / 2];
+	u32 seed = 0x1234567;
+	for (int i = 0; i < WIDTH; i++) {
+		seed = seed * 1103515245 + 12345;
+		y[i] = (u8)(seed >> 8);
+		if ((i & 1) == 0) {
+			u[i / 2] = (u8)(seed >> 16);
+			v[i / 2] = (u8)(seed >> 24);
+		}
+	}
+	// Full white, black, and a primary, to check the range.
+	y[0] = 235; u[0] = 128; v[0] = 128;
+	y[2] = 16; u[1] = 128; v[1] = 128;
+	y[4] = 82; u[2] = 90; v[2] = 240;
+
+	u32 rgba[WIDTH];
+	u16 rgb565[WIDTH];
+	ConvertYUV420ToRGBA8888(rgba, y, u, v, WIDTH);
+	ConvertYUV420ToRGB565(rgb565, y, u, v, WIDTH);
+	EXPECT_EQ_HEX(rgba[0], 0x00FFFFFF);
+	EXPECT_EQ_HEX(rgba[2], 0x00000000);
+	EXPECT_TRUE((rgba[4] & 0xFF) >= 0xFD && (rgba[4] & 0xFFFF00) <= 0x000300);
+	for (int i = 0; i < WIDTH; i += 2) {
+		u32 single32[2];
+		u16 single16[2];
+		ConvertYUV420ToRGBA8888(single32, y + i, u + i / 2, v + i / 2, 2);
+		ConvertYUV420ToRGB565(single16, y + i, u + i / 2, v + i / 2, 2);
+		EXPECT_EQ_HEX(rgba[i], single32[0]);
+		EXPECT_EQ_HEX(rgba[i + 1], single32[1]);
+		EXPECT_EQ_HEX(rgb565[i], single16[0]);
+		EXPECT_EQ_HEX(rgb565[i + 1], single16[1]);
+	}
+
+	int rows = 0;
+	double st = time_now_d();
+	do {
+		for (int j = 0; j < 272; ++j)
+			ConvertYUV420ToRGBA8888(rgba, y, u, v, WIDTH);
+		rows += 272;
+	} while (time_now_d() - st < 0.1);
+	printf("ConvertYUV420ToRGBA8888: %0.2f Mpixels/s\n", (double)rows * WIDTH / (time_now_d() - st) / 1000000.0);
+
+	// The buffer converters should match the single pixel functions, also when unaligned or short.
+	alignas(16) u32 src32[WIDTH + 4];
+	alignas(16) u16 src16[WIDTH + 8];
+	alignas(16) u32 dst32[WIDTH + 4];
+	alignas(16) u16 dst16[WIDTH + 8];
+	for (int i = 0; i < WIDTH + 4; i++) {
+		seed = seed * 1103515245 + 12345;
+		src32[i] = seed ^ (seed << 13);
+	}
+	for (int i = 0; i < WIDTH + 8; i++)
+		src16[i] = (u16)src32[i % (WIDTH + 4)] ^ (u16)(src32[i % (WIDTH + 4)] >> 16);
+
+	const u32 sizes[] = { WIDTH, WIDTH - 1, 7, 1 };
+	for (u32 offset = 0; offset < 2; offset++) {
+		for (u32 size : sizes) {
+			ConvertRGBA8888ToRGB565(dst16 + offset, src32 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst16[offset + i], RGBA8888toRGB565(src32[offset + i]));
+			ConvertRGBA8888ToRGBA4444(dst16 + offset, src32 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst16[offset + i], RGBA8888toRGBA4444(src32[offset + i]));
+			ConvertBGRA8888ToRGB565(dst16 + offset, src32 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst16[offset + i], BGRA8888toRGB565(src32[offset + i]));
+			ConvertBGRA8888ToRGBA4444(dst16 + offset, src32 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst16[offset + i], BGRA8888toRGBA4444(src32[offset + i]));
+			ConvertRGBA8888ToRGBA5551(dst16 + offset, src32 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst16[offset + i], RGBA8888toRGBA5551(src32[offset + i]));
+
+			ConvertRGB565ToRGBA8888(dst32 + offset, src16 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst32[offset + i], RGB565ToRGBA8888(src16[offset + i]));
+			ConvertRGBA5551ToRGBA8888(dst32 + offset, src16 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst32[offset + i], RGBA5551ToRGBA8888(src16[offset + i]));
+			ConvertRGBA4444ToRGBA8888(dst32 + offset, src16 + offset, size);
+			for (u32 i = 0; i < size; i++)
+				EXPECT_EQ_HEX(dst32[offset + i], RGBA4444ToRGBA8888(src16[offset + i]));
+		}
+	}
+
+	auto measure = [&](const char *name, const std::function<void()> &func) {
+		int lines = 0;
+		double start = time_now_d();
+		do {
+			for (int j = 0; j < 272; ++j)
+				func();
+			lines += 272;
+		} while (time_now_d() - start < 0.1);
+		printf("%s: %0.2f Mpixels/s\n", name, (double)lines * WIDTH / (time_now_d() - start) / 1000000.0);
+	};
+	measure("ConvertRGBA8888ToRGB565", [&] { ConvertRGBA8888ToRGB565(dst16, src32, WIDTH); });
+	measure("ConvertBGRA8888ToRGBA4444", [&] { ConvertBGRA8888ToRGBA4444(dst16, src32, WIDTH); });
+	measure("ConvertRGBA5551ToRGBA8888", [&] { ConvertRGBA5551ToRGBA8888(dst32, src16, WIDTH); });
+
 	return true;
 }
 
@@ -1182,9 +1606,12 @@ TestItem availableTests[] = {
 	TEST_ITEM(Parsers),
 	TEST_ITEM(IRPassSimplify),
 	TEST_ITEM(Jit),
+	TEST_ITEM(IRInterpreter),
+	TEST_ITEM(CPUBenchmark),
 	TEST_ITEM(MatrixTranspose),
 	TEST_ITEM(ParseLBN),
 	TEST_ITEM(QuickTexHash),
+	TEST_ITEM(DeIndexTexture),
 	TEST_ITEM(CLZ),
 	TEST_ITEM(MemMap),
 	TEST_ITEM(ShaderGenerators),
@@ -1195,8 +1622,11 @@ TestItem availableTests[] = {
 	TEST_ITEM(WrapText),
 	TEST_ITEM(TinySet),
 	TEST_ITEM(FastVec),
+	TEST_ITEM(FrameArena),
 	TEST_ITEM(SmallDataConvert),
 	TEST_ITEM(DepthMath),
+	TEST_ITEM(DepthRaster),
+	TEST_ITEM(SoftGPUTriangleSetup),
 	TEST_ITEM(InputMapping),
 	TEST_ITEM(EscapeMenuString),
 	TEST_ITEM(VFS),
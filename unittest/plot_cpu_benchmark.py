@@ -0,0 +1,113 @@
+#!/usr/bin/env python
+# Compares CPU benchmark results across versions, and plots them if matplotlib is installed.
+#
+# Collect results by running the unit test for each commit, appending to the same file:
+#   PPSSPP_BENCH_CSV=bench.csv ./PPSSPPUnitTest CPUBenchmark
+# Then:
+#   python unittest/plot_cpu_benchmark.py bench.csv [--threshold 5] [--output bench.png]
+#
+# Exits with 1 if the latest version is slower than the one before it by more than the threshold.
+
+import argparse
+import csv
+import sys
+from collections import OrderedDict
+
+
+def load(filename):
+  versions = []
+  # (benchmark, core) -> version -> list of values
+  results = OrderedDict()
+  units = {}
+  with open(filename, newline='') as f:
+    for row in csv.reader(f):
+      if len(row) != 5:
+        continue
+      version, benchmark, core, value, unit = row
+      try:
+        value = float(value)
+      except ValueError:
+        continue
+      # Versions are ordered by when they were first benchmarked.
+      if version not in versions:
+        versions.append(version)
+      key = (benchmark, core)
+      results.setdefault(key, OrderedDict()).setdefault(version, []).append(value)
+      units[key] = unit
+  return versions, results, units
+
+
+def median(values):
+  values = sorted(values)
+  mid = len(values) // 2
+  if len(values) % 2:
+    return values[mid]
+  return (values[mid - 1] + values[mid]) / 2.0
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Compare PPSSPP CPU benchmark results across versions.')
+  parser.add_argument('csv', help='file written through PPSSPP_BENCH_CSV')
+  parser.add_argument('--threshold', type=float, default=5.0, help='percent slower to count as a regression')
+  parser.add_argument('--output', default=None, help='save a plot here (needs matplotlib)')
+  args = parser.parse_args()
+
+  versions, results, units = load(args.csv)
+  if not results:
+    print('No results in %s' % args.csv)
+    return 1
+
+  regressions = []
+  for key, byVersion in results.items():
+    benchmark, core = key
+    ordered = [(v, median(byVersion[v])) for v in versions if v in byVersion]
+    print('%s / %s (%s)' % (benchmark, core, units[key]))
+    prev = None
+    for version, value in ordered:
+      change = ''
+      if prev is not None and prev > 0:
+        percent = (value - prev) / prev * 100.0
+        change = '%+.1f%%' % percent
+        if percent < -args.threshold:
+          change += '  <-- regression'
+          if version == versions[-1]:
+            regressions.append((benchmark, core, percent))
+      print('  %-40s %14.1f %s' % (version, value, change))
+      prev = value
+
+  if args.output:
+    try:
+      import matplotlib
+      matplotlib.use('Agg')
+      import matplotlib.pyplot as plt
+    except ImportError:
+      print('matplotlib is not installed, skipping the plot')
+    else:
+      benchmarks = list(OrderedDict.fromkeys(b for b, _ in results.keys()))
+      fig, axes = plt.subplots(len(benchmarks), 1, figsize=(10, 3 * len(benchmarks)), squeeze=False)
+      for ax, benchmark in zip(axes[:, 0], benchmarks):
+        for (b, core), byVersion in results.items():
+          if b != benchmark:
+            continue
+          xs = [i for i, v in enumerate(versions) if v in byVersion]
+          ys = [median(byVersion[versions[i]]) for i in xs]
+          ax.plot(xs, ys, marker='o', label=core)
+          ax.set_ylabel(units[(b, core)])
+        ax.set_title(benchmark)
+        ax.set_xticks(range(len(versions)))
+        ax.set_xticklabels(versions, rotation=30, ha='right', fontsize='small')
+        ax.legend(fontsize='small')
+      fig.tight_layout()
+      fig.savefig(args.output)
+      print('Saved %s' % args.output)
+
+  if regressions:
+    print('')
+    for benchmark, core, percent in regressions:
+      print('REGRESSION: %s / %s is %.1f%% slower' % (benchmark, core, -percent))
+    return 1
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())